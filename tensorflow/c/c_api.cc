@@ -194,7 +194,10 @@ TF_Tensor* TF_NewTensor(TF_DataType dtype, const int64_t* dims, int num_dims,
 
   TF_ManagedBuffer* buf = new TF_ManagedBuffer;
   buf->len_ = len;
-  if (reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+  // TF_STRING data is decoded into a new buffer anyway (see
+  // TF_Tensor_DecodeStrings), so it is never copied for alignment.
+  if (dtype != TF_STRING &&
+      reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
     // Copy the data into a buffer that satisfies Eigen's alignment
     // requirements.
     buf->data_ = allocate_tensor("TF_NewTensor", len);
@@ -211,6 +214,8 @@ TF_Tensor* TF_NewTensor(TF_DataType dtype, const int64_t* dims, int num_dims,
   return new TF_Tensor{dtype, TensorShape(dimvec), buf};
 }
 
+size_t TF_TensorDefaultAlignment() { return EIGEN_MAX_ALIGN_BYTES; }
+
 TF_Tensor* TF_TensorMaybeMove(TF_Tensor* tensor) {
   // It is safe to move the Tensor if and only if we own the unique reference to
   // it. In that case, we might as well not delete and reallocate, but a future
@@ -405,8 +410,9 @@ bool TF_Tensor_DecodeStrings(TF_Tensor* src, Tensor* dst, TF_Status* status) {
   *dst = Tensor(static_cast<DataType>(src->dtype), src->shape);
   auto dstarray = dst->flat<tensorflow::string>();
   for (tensorflow::int64 i = 0; i < num_elements; ++i) {
-    tensorflow::uint64 offset =
-        reinterpret_cast<const tensorflow::uint64*>(input)[i];
+    // The buffer of a TF_STRING tensor may be unaligned (see TF_NewTensor).
+    tensorflow::uint64 offset;
+    std::memcpy(&offset, input + i * sizeof(offset), sizeof(offset));
     if (static_cast<ptrdiff_t>(offset) >= (limit - data_start)) {
       status->status = InvalidArgument("Malformed TF_STRING tensor; element ",
                                        i, " out of range");
@@ -223,6 +223,11 @@ typedef struct TF_Tensor TF_Tensor;
 //      (*deallocator)(data, len, deallocator_arg)
 // Clients must provide a custom deallocator function so they can pass in
 // memory managed by something like numpy.
+//
+// The data is used in place, without copying, if it is aligned to
+// TF_TensorDefaultAlignment() bytes or if the type is TF_STRING. Otherwise it
+// is copied into a newly allocated aligned buffer and the deallocator is
+// called right away.
 TF_CAPI_EXPORT extern TF_Tensor* TF_NewTensor(
     TF_DataType, const int64_t* dims, int num_dims, void* data, size_t len,
     void (*deallocator)(void* data, size_t len, void* arg),
@@ -241,6 +246,10 @@ TF_CAPI_EXPORT extern TF_Tensor* TF_AllocateTensor(TF_DataType,
                                                    const int64_t* dims,
                                                    int num_dims, size_t len);
 
+// Returns the alignment, in bytes, that the data passed to TF_NewTensor must
+// have to be used without copying.
+TF_CAPI_EXPORT extern size_t TF_TensorDefaultAlignment();
+
 // Deletes `tensor` and returns a new TF_Tensor with the same content if
 // possible. Returns nullptr and leaves `tensor` untouched if not.
 TF_CAPI_EXPORT extern TF_Tensor* TF_TensorMaybeMove(TF_Tensor* tensor);
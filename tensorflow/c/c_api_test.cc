@@ -95,6 +95,61 @@ TEST(CAPI, Tensor) {
   EXPECT_TRUE(deallocator_called);
 }
 
+// Records the call without freeing the data, which is owned by the test.
+static void FlagDeallocator(void* data, size_t, void* arg) {
+  *reinterpret_cast<bool*>(arg) = true;
+}
+
+TEST(CAPI, UnalignedTensorIsCopied) {
+  const size_t alignment = TF_TensorDefaultAlignment();
+  const int num_bytes = 6 * sizeof(float);
+  char* buffer = reinterpret_cast<char*>(
+      tensorflow::cpu_allocator()->AllocateRaw(alignment, num_bytes + 4));
+  float* values = reinterpret_cast<float*>(buffer + 4);
+  for (int i = 0; i < 6; ++i) values[i] = i;
+  int64_t dims[] = {2, 3};
+  bool deallocator_called = false;
+  TF_Tensor* t = TF_NewTensor(TF_FLOAT, dims, 2, values, num_bytes,
+                              &FlagDeallocator, &deallocator_called);
+  // The original buffer is released as soon as it has been copied.
+  EXPECT_TRUE(deallocator_called);
+  EXPECT_NE(static_cast<void*>(values), TF_TensorData(t));
+  EXPECT_EQ(0, reinterpret_cast<intptr_t>(TF_TensorData(t)) % alignment);
+  EXPECT_EQ(0, memcmp(values, TF_TensorData(t), num_bytes));
+  TF_DeleteTensor(t);
+  tensorflow::cpu_allocator()->DeallocateRaw(buffer);
+}
+
+TEST(CAPI, UnalignedStringTensorIsNotCopied) {
+  const size_t alignment = TF_TensorDefaultAlignment();
+  const string s = "hello";
+  const size_t offsets_bytes = sizeof(tensorflow::uint64);
+  const size_t num_bytes = offsets_bytes + TF_StringEncodedSize(s.size());
+  char* buffer = reinterpret_cast<char*>(
+      tensorflow::cpu_allocator()->AllocateRaw(alignment, num_bytes + 4));
+  char* data = buffer + 4;
+  memset(data, 0, offsets_bytes);
+  TF_Status* status = TF_NewStatus();
+  TF_StringEncode(s.data(), s.size(), data + offsets_bytes,
+                  num_bytes - offsets_bytes, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  int64_t dims[] = {1};
+  bool deallocator_called = false;
+  TF_Tensor* t = TF_NewTensor(TF_STRING, dims, 1, data, num_bytes,
+                              &FlagDeallocator, &deallocator_called);
+  EXPECT_FALSE(deallocator_called);
+  EXPECT_EQ(static_cast<void*>(data), TF_TensorData(t));
+
+  Tensor decoded;
+  ASSERT_TRUE(TF_Tensor_DecodeStrings(t, &decoded, status));
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(s, decoded.flat<string>()(0));
+  TF_DeleteStatus(status);
+  TF_DeleteTensor(t);
+  EXPECT_TRUE(deallocator_called);
+  tensorflow::cpu_allocator()->DeallocateRaw(buffer);
+}
+
 TEST(CAPI, AllocateTensor) {
   const int num_bytes = 6 * sizeof(float);
   int64_t dims[] = {2, 3};
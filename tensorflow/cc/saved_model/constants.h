@@ -24,6 +24,10 @@ constexpr char kSavedModelAssetsDirectory[] = "assets";
 /// SavedModel assets key for graph collection-def.
 constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
+/// SavedModel assets.extra directory, holding files used by the loader rather
+/// than the graph.
+constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
+
 /// SavedModel proto filename.
 constexpr char kSavedModelFilenamePb[] = "saved_model.pb";
 
@@ -42,6 +46,10 @@ constexpr char kSavedModelVariablesDirectory[] = "variables";
 /// SavedModel variables filename.
 constexpr char kSavedModelVariablesFilename[] = "variables";
 
+/// SavedModel warmup requests filename, in the assets.extra directory.
+constexpr char kSavedModelWarmupRequestsFilename[] =
+    "saved_model_warmup_requests";
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CC_SAVED_MODEL_CONSTANTS_H_
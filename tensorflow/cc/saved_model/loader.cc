@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <functional>
 #include <unordered_set>
 
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
@@ -39,9 +41,42 @@ auto* load_latency = monitoring::Counter<1>::New(
     "/tensorflow/cc/saved_model/load_latency",
     "Latency in microseconds for SavedModels that were successfully loaded.",
     "model_path");
+// Only labelled by stage: a cell per export directory would never be released
+// as new model versions are loaded.
+auto* load_stage_latency = monitoring::Counter<1>::New(
+    "/tensorflow/cc/saved_model/load_stage_latency",
+    "Latency in microseconds of each stage of loading SavedModels.", "stage");
 constexpr char kLoadAttemptFail[] = "fail";
 constexpr char kLoadAttemptSuccess[] = "success";
 
+// The stages of loading a SavedModel, as reported by load_stage_latency.
+constexpr char kLoadStageReadMetaGraph[] = "read_meta_graph";
+constexpr char kLoadStageCreateSession[] = "create_session";
+constexpr char kLoadStageRestore[] = "restore";
+constexpr char kLoadStageInit[] = "init";
+constexpr char kLoadStageWarmup[] = "warmup";
+
+// The maximum number of warmup requests replayed.
+constexpr int kMaxWarmupRequests = 1000;
+
+// Runs 'stage_fn', the stage 'stage' of loading a SavedModel, and reports how
+// long it took.
+Status RunLoadStage(const char* stage,
+                    const std::function<Status()>& stage_fn) {
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  const Status status = stage_fn();
+  const uint64 end_microseconds = Env::Default()->NowMicros();
+  // Avoid clock skew.
+  const uint64 latency_microseconds =
+      end_microseconds > start_microseconds
+          ? end_microseconds - start_microseconds
+          : 0;
+  LOG(INFO) << "SavedModel load stage " << stage << " took "
+            << latency_microseconds << " microseconds.";
+  load_stage_latency->GetCell(stage)->IncrementBy(latency_microseconds);
+  return status;
+}
+
 Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
@@ -61,10 +96,13 @@ Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto) {
                     export_dir);
 }
 
-Status FindMetaGraphDefToLoad(const SavedModel& saved_model_proto,
+// Moves the meta graph def matching 'tags' out of 'saved_model_proto', rather
+// than copying it, since its graph can be large.
+Status FindMetaGraphDefToLoad(SavedModel* saved_model_proto,
                               const std::unordered_set<string>& tags,
                               MetaGraphDef* meta_graph_def_to_load) {
-  for (const MetaGraphDef& meta_graph_def : saved_model_proto.meta_graphs()) {
+  for (MetaGraphDef& meta_graph_def :
+       *saved_model_proto->mutable_meta_graphs()) {
     // Get tags from the meta_graph_def.
     std::unordered_set<string> graph_tags;
     for (const string& tag : meta_graph_def.meta_info_def().tags()) {
@@ -72,7 +110,7 @@ Status FindMetaGraphDefToLoad(const SavedModel& saved_model_proto,
     }
     // Match with the set of tags provided.
     if (graph_tags == tags) {
-      *meta_graph_def_to_load = meta_graph_def;
+      meta_graph_def_to_load->Swap(&meta_graph_def);
       return Status::OK();
     }
   }
@@ -80,6 +118,16 @@ Status FindMetaGraphDefToLoad(const SavedModel& saved_model_proto,
                 "Could not find meta graph def matching supplied tags.");
 }
 
+// Labels the RestoreV2 nodes of 'graph_def' to run the kernel that restores
+// from memory mappings of the checkpoint.
+void UseMappedRestores(GraphDef* graph_def) {
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "RestoreV2") {
+      (*node.mutable_attr())["_kernel"].set_s("mmap");
+    }
+  }
+}
+
 Status LoadMetaGraphIntoSession(const MetaGraphDef& meta_graph_def,
                                 const SessionOptions& session_options,
                                 std::unique_ptr<Session>* session) {
@@ -198,6 +246,84 @@ Status RunLegacyInitOp(const RunOptions& run_options, const string& export_dir,
   return Status::OK();
 }
 
+// Runs a warmup request through the signature it names.
+Status RunWarmupRequest(const RunOptions& run_options,
+                        const MetaGraphDef& meta_graph_def,
+                        const SavedModelWarmupRequest& request,
+                        Session* session) {
+  const auto& signature_def_map = meta_graph_def.signature_def();
+  const auto signature_it = signature_def_map.find(request.signature_name());
+  if (signature_it == signature_def_map.end()) {
+    return errors::InvalidArgument("Warmup request for unknown signature: ",
+                                   request.signature_name());
+  }
+  const SignatureDef& signature_def = signature_it->second;
+  std::vector<std::pair<string, Tensor>> inputs;
+  for (const auto& input : request.inputs()) {
+    const auto tensor_info_it = signature_def.inputs().find(input.first);
+    if (tensor_info_it == signature_def.inputs().end()) {
+      return errors::InvalidArgument("Warmup request for unknown input ",
+                                     input.first, " of signature ",
+                                     request.signature_name());
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(input.second)) {
+      return errors::InvalidArgument("Invalid tensor for warmup input ",
+                                     input.first);
+    }
+    inputs.emplace_back(tensor_info_it->second.name(), tensor);
+  }
+  std::vector<string> output_names;
+  for (const auto& output : signature_def.outputs()) {
+    output_names.push_back(output.second.name());
+  }
+  std::vector<Tensor> outputs;
+  RunMetadata run_metadata;
+  return session->Run(run_options, inputs, output_names, {}, &outputs,
+                      &run_metadata);
+}
+
+// Replays the warmup requests of the SavedModel at 'export_dir', if it has any.
+// Executors are created, kernels autotuned and allocator pools grown on the
+// first run of a signature, which would otherwise slow down the first
+// requests served.
+Status RunWarmup(const RunOptions& run_options, const string& export_dir,
+                 const MetaGraphDef& meta_graph_def, Session* session) {
+  const string warmup_path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(warmup_path).ok()) {
+    return Status::OK();
+  }
+  LOG(INFO) << "Running warmup requests on SavedModel bundle.";
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(warmup_path, &file));
+  io::RecordReader reader(file.get());
+  int num_requests = 0;
+  uint64 offset = 0;
+  string record;
+  for (;;) {
+    const Status read_status = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(read_status)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(read_status);
+    if (num_requests == kMaxWarmupRequests) {
+      return errors::InvalidArgument("More than ", kMaxWarmupRequests,
+                                     " warmup requests in ", warmup_path);
+    }
+    SavedModelWarmupRequest request;
+    if (!request.ParseFromString(record)) {
+      return errors::DataLoss("Invalid warmup request in ", warmup_path);
+    }
+    TF_RETURN_IF_ERROR(
+        RunWarmupRequest(run_options, meta_graph_def, request, session));
+    ++num_requests;
+  }
+  LOG(INFO) << "Ran " << num_requests << " warmup requests.";
+  return Status::OK();
+}
+
 Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
                         std::vector<AssetFileDef>* asset_file_defs) {
   const auto& collection_def_map = meta_graph_def.collection_def();
@@ -219,6 +345,7 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              const SavedModelLoadOptions& load_options,
                               SavedModelBundle* const bundle) {
   if (!MaybeSavedModelDirectory(export_dir)) {
     return Status(error::Code::NOT_FOUND,
@@ -226,33 +353,46 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   }
   LOG(INFO) << "Loading SavedModel from: " << export_dir;
 
-  SavedModel saved_model_proto;
-  TF_RETURN_IF_ERROR(ReadSavedModel(export_dir, &saved_model_proto));
-
-  TF_RETURN_IF_ERROR(
-      FindMetaGraphDefToLoad(saved_model_proto, tags, &bundle->meta_graph_def));
+  TF_RETURN_IF_ERROR(RunLoadStage(kLoadStageReadMetaGraph, [&]() -> Status {
+    SavedModel saved_model_proto;
+    TF_RETURN_IF_ERROR(ReadSavedModel(export_dir, &saved_model_proto));
+    TF_RETURN_IF_ERROR(FindMetaGraphDefToLoad(&saved_model_proto, tags,
+                                              &bundle->meta_graph_def));
+    if (load_options.map_variables) {
+      UseMappedRestores(bundle->meta_graph_def.mutable_graph_def());
+    }
+    return Status::OK();
+  }));
 
-  TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
-      bundle->meta_graph_def, session_options, &bundle->session));
+  TF_RETURN_IF_ERROR(RunLoadStage(kLoadStageCreateSession, [&]() -> Status {
+    return LoadMetaGraphIntoSession(bundle->meta_graph_def, session_options,
+                                    &bundle->session);
+  }));
 
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
       GetAssetFileDefs(bundle->meta_graph_def, &asset_file_defs));
-  TF_RETURN_IF_ERROR(
-      RunRestore(run_options, export_dir,
-                 bundle->meta_graph_def.saver_def().restore_op_name(),
-                 bundle->meta_graph_def.saver_def().filename_tensor_name(),
-                 asset_file_defs, bundle->session.get()));
-  if (HasMainOp(bundle->meta_graph_def)) {
-    TF_RETURN_IF_ERROR(RunMainOp(run_options, export_dir,
-                                 bundle->meta_graph_def, asset_file_defs,
-                                 bundle->session.get()));
-  } else {
-    TF_RETURN_IF_ERROR(RunLegacyInitOp(run_options, export_dir,
-                                       bundle->meta_graph_def, asset_file_defs,
-                                       bundle->session.get()));
-  }
-  return Status::OK();
+  // RestoreV2 reads the variables of a restore op concurrently, and the
+  // session runs the independent restore and init ops, e.g. those of different
+  // lookup tables, concurrently on its inter-op thread pool.
+  TF_RETURN_IF_ERROR(RunLoadStage(kLoadStageRestore, [&]() -> Status {
+    return RunRestore(run_options, export_dir,
+                      bundle->meta_graph_def.saver_def().restore_op_name(),
+                      bundle->meta_graph_def.saver_def().filename_tensor_name(),
+                      asset_file_defs, bundle->session.get());
+  }));
+  TF_RETURN_IF_ERROR(RunLoadStage(kLoadStageInit, [&]() -> Status {
+    if (HasMainOp(bundle->meta_graph_def)) {
+      return RunMainOp(run_options, export_dir, bundle->meta_graph_def,
+                       asset_file_defs, bundle->session.get());
+    }
+    return RunLegacyInitOp(run_options, export_dir, bundle->meta_graph_def,
+                           asset_file_defs, bundle->session.get());
+  }));
+  return RunLoadStage(kLoadStageWarmup, [&]() -> Status {
+    return RunWarmup(run_options, export_dir, bundle->meta_graph_def,
+                     bundle->session.get());
+  });
 }
 
 }  // namespace
@@ -261,10 +401,19 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle) {
+  return LoadSavedModel(session_options, run_options, export_dir, tags,
+                        SavedModelLoadOptions(), bundle);
+}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const SavedModelLoadOptions& load_options,
+                      SavedModelBundle* const bundle) {
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status = LoadSavedModelInternal(
+      session_options, run_options, export_dir, tags, load_options, bundle);
   const uint64 load_latency_microsecs = [&]() -> uint64 {
     const uint64 end_microseconds = Env::Default()->NowMicros();
     // Avoid clock skew.
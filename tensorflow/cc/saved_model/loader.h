@@ -43,13 +43,44 @@ struct SavedModelBundle {
   SavedModelBundle() = default;
 };
 
+/// Options of LoadSavedModel() beyond those of the session it creates.
+struct SavedModelLoadOptions {
+  /// Whether to restore the variables from read-only memory mappings of the
+  /// variables files rather than read them into memory. The variables whose
+  /// data is aligned in the files then alias the mappings, so that the
+  /// processes serving the same SavedModel on a host share one copy of them
+  /// in the page cache; the others are copied. Checkpoints written by SaveV2
+  /// with data_alignment=64 have all their non-string tensors aligned.
+  ///
+  /// Only for local SavedModels whose variables are never written once
+  /// restored, e.g. those loaded for inference. The RestoreV2 nodes of the
+  /// loaded meta graph def are labeled to run their "mmap" kernel.
+  bool map_variables = false;
+};
+
 /// Loads a SavedModel from the specified export directory. The meta graph def
 /// to be loaded is identified by the supplied tags, corresponding exactly to
 /// the set of tags used at SavedModel build time. Returns a SavedModel bundle
 /// with a session and the requested meta graph def, if found.
+///
+/// To optimize the graph for inference, set `inference_optimization` and
+/// `constant_folding` in the rewrite options of `session_options`.
+///
+/// If the SavedModel has an `assets.extra/saved_model_warmup_requests` file of
+/// `SavedModelWarmupRequest` TFRecords, the requests are run once each after
+/// the model is initialized, and the load fails if any of them fails. This
+/// keeps the cost of creating executors, autotuning kernels and growing
+/// allocator pools off the first requests served.
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle);
+
+/// Same as above, with the options in `load_options`.
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
+                      const SavedModelLoadOptions& load_options,
                       SavedModelBundle* const bundle);
 
 /// Checks whether the provided directory could contain a SavedModel. Note that
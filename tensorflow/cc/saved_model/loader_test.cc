@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -91,6 +93,51 @@ class LoaderTest : public ::testing::Test {
         outputs[0],
         test::AsTensor<float>({2, 2.5, 3, 3.5}, TensorShape({4, 1})));
   }
+
+  // Copies the sharded half plus two SavedModel to a temporary directory named
+  // 'name', with 'requests' as its warmup requests. Returns the directory.
+  string CopySavedModelWithWarmupRequests(
+      const string& name,
+      const std::vector<SavedModelWarmupRequest>& requests) {
+    const string src_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+    const string dst_dir = io::JoinPath(testing::TmpDir(), name);
+    Env* env = Env::Default();
+    for (const string& dir :
+         {kSavedModelAssetsDirectory, kSavedModelAssetsExtraDirectory,
+          kSavedModelVariablesDirectory}) {
+      TF_CHECK_OK(env->RecursivelyCreateDir(io::JoinPath(dst_dir, dir)));
+    }
+    for (const string& file :
+         {"saved_model.pb", "assets/foo.txt", "variables/variables.index",
+          "variables/variables.data-00000-of-00001"}) {
+      string contents;
+      TF_CHECK_OK(
+          ReadFileToString(env, io::JoinPath(src_dir, file), &contents));
+      TF_CHECK_OK(
+          WriteStringToFile(env, io::JoinPath(dst_dir, file), contents));
+    }
+    std::unique_ptr<WritableFile> warmup_file;
+    TF_CHECK_OK(env->NewWritableFile(
+        io::JoinPath(dst_dir, kSavedModelAssetsExtraDirectory,
+                     kSavedModelWarmupRequestsFilename),
+        &warmup_file));
+    io::RecordWriter writer(warmup_file.get());
+    for (const SavedModelWarmupRequest& request : requests) {
+      TF_CHECK_OK(writer.WriteRecord(request.SerializeAsString()));
+    }
+    TF_CHECK_OK(warmup_file->Close());
+    return dst_dir;
+  }
+
+  SavedModelWarmupRequest MakeWarmupRequest(const string& signature_name,
+                                            const string& input_key) {
+    SavedModelWarmupRequest request;
+    request.set_signature_name(signature_name);
+    test::AsTensor<string>({MakeSerializedExample(1)}, TensorShape({1}))
+        .AsProtoTensorContent(&(*request.mutable_inputs())[input_key]);
+    return request;
+  }
 };
 
 // Test for resource leaks related to TensorFlow session closing requirements
@@ -179,6 +226,56 @@ TEST_F(LoaderTest, MainOpFormat) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, MapVariables) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+  SavedModelLoadOptions load_options;
+  load_options.map_variables = true;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, load_options, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+  int num_restores = 0;
+  for (const NodeDef& node : bundle.meta_graph_def.graph_def().node()) {
+    if (node.op() == "RestoreV2") {
+      ++num_restores;
+      EXPECT_EQ("mmap", node.attr().at("_kernel").s());
+    }
+  }
+  EXPECT_GT(num_restores, 0);
+}
+
+TEST_F(LoaderTest, WarmupRequests) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir = CopySavedModelWithWarmupRequests(
+      "warmup", {MakeWarmupRequest("regress_x_to_y", kRegressInputs),
+                 MakeWarmupRequest("regress_x_to_y", kRegressInputs)});
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, InvalidWarmupRequest) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir = CopySavedModelWithWarmupRequests(
+      "invalid_warmup", {MakeWarmupRequest("missing-signature", "inputs")});
+  Status st = LoadSavedModel(session_options, run_options, export_dir,
+                             {kSavedModelTagServe}, &bundle);
+  EXPECT_FALSE(st.ok());
+  EXPECT_TRUE(StringPiece(st.error_message())
+                  .contains("Warmup request for unknown signature"))
+      << st.error_message();
+}
+
 TEST_F(LoaderTest, InvalidExportPath) {
   SavedModelBundle bundle;
   RunOptions run_options;
@@ -44,6 +44,13 @@ static double NowMicros() {
   return static_cast<uint64>(tv.tv_sec) * 1000000 + tv.tv_usec;
 }
 
+// Returns the median of `per_iter_us`, which isn't empty.
+static int64 MedianMicros(const std::vector<int64>& per_iter_us) {
+  std::vector<int64> sorted_us(per_iter_us);
+  std::sort(sorted_us.begin(), sorted_us.end());
+  return sorted_us[sorted_us.size() / 2];
+}
+
 void DumpStatsToStdout(const Stats& stats) {
   // Compute stats.
   std::vector<int64> sorted_us(stats.per_iter_us);
@@ -109,6 +116,14 @@ void DumpStatsToStdout(const Stats& stats) {
   }
 }
 
+void DumpSpeedupToStdout(const Stats& baseline, const Stats& stats) {
+  const int64 baseline_us = MedianMicros(baseline.per_iter_us);
+  const int64 us = MedianMicros(stats.per_iter_us);
+  printf("Median speedup: %.3fx (%lld us vs %lld us)\n",
+         us > 0 ? static_cast<double>(baseline_us) / us : 0.0, baseline_us,
+         us);
+}
+
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
   // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
   const int64 max_us = (options.max_micros <= 0 && options.max_iters <= 0)
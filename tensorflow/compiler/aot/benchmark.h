@@ -56,6 +56,11 @@ struct Stats {
 // form.
 void DumpStatsToStdout(const Stats& stats);
 
+// DumpSpeedupToStdout printfs to stdout the speedup of the median iteration of
+// `stats` over the median iteration of `baseline`, e.g. of a multi-threaded
+// run over a single-threaded one.
+void DumpSpeedupToStdout(const Stats& baseline, const Stats& stats);
+
 // BenchmarkFn is the signature of the function generated by tfcompile.
 typedef std::function<void()> BenchmarkFn;
 
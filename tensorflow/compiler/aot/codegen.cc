@@ -438,7 +438,9 @@ class {{CLASS}} {
     tensorflow::tfcompile::runtime::FreeContiguous(alloc_temps_);
   }
 
-  // Sets the thread pool to use during the Run call.
+  // Sets the thread pool to use during the Run call. The loops of code
+  // generated with tfcompile --max_parallelism > 1 are split across its
+  // threads.
   {{CLASS}}& set_thread_pool(const Eigen::ThreadPoolDevice* pool) {
     run_options_.set_intra_op_thread_pool(pool);
 {{CONTEXT_SET_THREAD_POOL}}
@@ -414,6 +414,7 @@ Status CompileGraph(std::unique_ptr<Graph> graph, const MainFlags& flags,
       flags.target_triple, flags.target_cpu, flags.target_features,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
+  aot_opts.set_max_parallelism(flags.max_parallelism);
   return CompileXla(client, computation, aot_opts, compile_result);
 }
 
@@ -51,6 +51,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"max_parallelism", &flags->max_parallelism,
+       "Number of threads the loops of the generated code may be split "
+       "across.  The loops run in the Eigen thread pool passed to the "
+       "set_thread_pool method of the generated class, or single-threaded if "
+       "there is none.  The default of 1 generates single-threaded loops."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
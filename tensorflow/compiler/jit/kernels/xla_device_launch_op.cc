@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/kernels/xla_device_launch_op.h"
 
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_device_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -42,8 +43,9 @@ Status BuildCompilationCache(ResourceMgr* rm, XlaCompilationCache** cache) {
     return s;
   }
   core::ScopedUnref metadata_ref(metadata);
-  *cache =
-      new XlaCompilationCache(metadata->client(), metadata->jit_device_type());
+  *cache = new XlaCompilationCache(
+      metadata->client(), metadata->jit_device_type(),
+      legacy_flags::GetXlaLaunchOpFlags()->tf_xla_persistent_cache_dir);
   return Status::OK();
 }
 
@@ -62,23 +64,6 @@ XlaDeviceLaunchOp::XlaDeviceLaunchOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr("Nresources", &num_resource_args_));
 }
 
-std::vector<OptionalTensor> SnapshotResourceVariables(OpKernelContext* ctx,
-                                                      int num_variables) {
-  std::vector<OptionalTensor> snapshot(num_variables);
-  int first_variable = ctx->num_inputs() - num_variables;
-  for (int i = 0; i < num_variables; ++i) {
-    Var* variable = nullptr;
-    ResourceHandle handle = HandleFromInput(ctx, first_variable + i);
-    if (LookupResource(ctx, handle, &variable).ok()) {
-      mutex_lock lock(*variable->mu());
-      snapshot[i].name = handle.name();
-      snapshot[i].present = true;
-      snapshot[i].value = *variable->tensor();
-    }
-  }
-  return snapshot;
-}
-
 void XlaDeviceLaunchOp::Compute(OpKernelContext* ctx) {
   VLOG(1) << "XlaDeviceLaunch::Compute "
           << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_local_launch_op.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_local_runtime_context.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -30,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -38,6 +45,116 @@ namespace gpu = perftools::gputools;
 
 namespace tensorflow {
 
+namespace {
+
+auto* padded_runs = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/shape_bucketing/padded_runs",
+    "The number of XLA computations run on padded inputs.");
+
+auto* batch_rows = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/shape_bucketing/batch_rows",
+    "The number of rows of the batches of the padded XLA computations.");
+
+auto* padding_rows = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/shape_bucketing/padding_rows",
+    "The number of rows padding the batches of the XLA computations.");
+
+// Returns the batch arguments in `inputs`: the non-constant arguments whose
+// first dimension is the first dimension `*batch_size` of the first
+// non-constant argument with one. Sets `*batch_size` to -1 if there are no
+// arguments to pad.
+std::vector<bool> BatchArgs(const std::vector<Tensor>& inputs,
+                            int num_constant_args, int64* batch_size) {
+  std::vector<bool> batch_args(inputs.size(), false);
+  *batch_size = -1;
+  for (int i = num_constant_args; i < inputs.size(); ++i) {
+    if (inputs[i].dims() == 0) continue;
+    if (*batch_size < 0) {
+      *batch_size = inputs[i].dim_size(0);
+    }
+    if (inputs[i].dim_size(0) == *batch_size) {
+      if (!DataTypeCanUseMemcpy(inputs[i].dtype())) {
+        *batch_size = -1;
+        break;
+      }
+      batch_args[i] = true;
+    }
+  }
+  if (*batch_size <= 0) {
+    *batch_size = -1;
+    batch_args.assign(inputs.size(), false);
+  }
+  return batch_args;
+}
+
+// Returns true if all the outputs of `kernel` have `size` rows.
+bool HasBatchOutputs(const XlaCompiler::CompilationResult& kernel,
+                     int64 size) {
+  for (const XlaCompiler::OutputDescription& output : kernel.outputs) {
+    const TensorShape& shape =
+        output.is_constant ? output.constant_value.shape() : output.shape;
+    if (shape.dims() == 0 || shape.dim_size(0) != size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns `inputs` with the resource variable handles at their end replaced by
+// the values of `variables`, the snapshot the function was compiled for.
+// Uninitialized variables are left empty, since they aren't passed to the
+// computation.
+std::vector<Tensor> WithVariableValues(
+    const std::vector<Tensor>& inputs,
+    const std::vector<OptionalTensor>& variables) {
+  std::vector<Tensor> values = inputs;
+  const int first_variable = inputs.size() - variables.size();
+  for (int i = 0; i < variables.size(); ++i) {
+    values[first_variable + i] =
+        variables[i].present ? variables[i].value : Tensor();
+  }
+  return values;
+}
+
+// Builds xla::ShapedBuffers that point directly to the Tensor buffers of the
+// `inputs` of `kernel`, followed by one pointing at `runtime_context` if the
+// kernel requires it.
+void BuildArgumentBuffers(
+    xla::LocalClient* client, const XlaCompiler::CompilationResult& kernel,
+    const std::vector<Tensor>& inputs, XlaLocalRuntimeContext* runtime_context,
+    std::vector<std::unique_ptr<xla::ShapedBuffer>>* arg_buffers,
+    std::vector<xla::ShapedBuffer*>* arg_ptrs) {
+  arg_buffers->reserve(kernel.xla_input_shapes.size() + 1);
+  for (int i = 0; i < kernel.xla_input_shapes.size(); ++i) {
+    int arg_num = kernel.input_mapping[i];
+    const xla::Shape& shape = kernel.xla_input_shapes[i];
+    gpu::DeviceMemoryBase dmem(
+        const_cast<char*>(inputs[arg_num].tensor_data().data()),
+        inputs[arg_num].tensor_data().size());
+    arg_buffers->push_back(
+        xla::ShapedBuffer::MakeArrayShapedBuffer(
+            shape, client->platform(), client->default_device_ordinal(), dmem)
+            .ConsumeValueOrDie());
+  }
+
+  // Make the final parameter point at runtime_context.
+  if (kernel.requires_runtime_context) {
+    gpu::DeviceMemoryBase runtime_context_dmem(runtime_context,
+                                               sizeof(*runtime_context));
+    arg_buffers->push_back(
+        xla::ShapedBuffer::MakeArrayShapedBuffer(
+            xla::ShapeUtil::MakeOpaqueShape(), client->platform(),
+            client->default_device_ordinal(), runtime_context_dmem)
+            .ConsumeValueOrDie());
+  }
+  arg_ptrs->clear();
+  for (const auto& arg_buffer : *arg_buffers) {
+    arg_ptrs->push_back(arg_buffer.get());
+  }
+}
+
+}  // namespace
+
 // Adapter class that wraps a Tensorflow allocator as an XLA allocator.
 // Assumes that the Tensorflow allocator permits asynchronous deallocation:
 // see comment on `AllowsAsynchronousDeallocation()`.
@@ -135,7 +252,16 @@ Status XlaAllocator::MakeTensorFromBuffer(gpu::DeviceMemoryBase buffer,
 }
 
 XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx), device_type_(ctx->device_type()) {
+    : AsyncOpKernel(ctx),
+      device_type_(ctx->device_type()),
+      compile_in_background_(
+          legacy_flags::GetXlaLaunchOpFlags()->tf_xla_async_compilation),
+      fusion_tuning_candidates_(
+          legacy_flags::GetXlaLaunchOpFlags()->tf_xla_fusion_tuning) {
+  OP_REQUIRES_OK(
+      ctx, ParseShapeBucketSizes(
+               legacy_flags::GetXlaLaunchOpFlags()->tf_xla_shape_buckets,
+               &bucket_sizes_));
   const NameAttrList* func;
   OP_REQUIRES_OK(ctx, ctx->GetAttr("function", &func));
   function_ = *func;
@@ -143,11 +269,7 @@ XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr("Tconstants", &constant_types));
   num_constant_args_ = constant_types.size();
 
-  int num_resource_args;
-  OP_REQUIRES_OK(ctx, ctx->GetAttr("Nresources", &num_resource_args));
-  OP_REQUIRES(ctx, num_resource_args == 0,
-              errors::Unimplemented(
-                  "XlaLocalLaunchOp does not support resource variables"));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr("Nresources", &num_resource_args_));
   if (device_type_ == DeviceType(DEVICE_CPU)) {
     platform_id_ = gpu::host::kHostPlatformId;
   } else if (device_type_ == DeviceType(DEVICE_GPU)) {
@@ -180,27 +302,27 @@ Status XlaLocalLaunchOp::BuildCompilationCache(OpKernelContext* ctx,
                                    device_type_.type());
   }
   *cache = new XlaCompilationCache(
-      client.ValueOrDie(), DeviceType(registration->compilation_device_name));
+      client.ValueOrDie(), DeviceType(registration->compilation_device_name),
+      legacy_flags::GetXlaLaunchOpFlags()->tf_xla_persistent_cache_dir);
   return Status::OK();
 }
 
-void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
+void XlaLocalLaunchOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   VLOG(1) << "XlaLocalLaunchOp::Compute "
           << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
-  OP_REQUIRES(ctx, rm, errors::Internal("No resource manager."));
-
-  gpu::Stream* stream =
-      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  OP_REQUIRES_ASYNC(ctx, rm, errors::Internal("No resource manager."), done);
 
   XlaCompilationCache* cache;
-  OP_REQUIRES_OK(ctx, rm->LookupOrCreate<XlaCompilationCache>(
-                          rm->default_container(), "xla_cache", &cache,
-                          [this, ctx](XlaCompilationCache** cache) {
-                            return BuildCompilationCache(ctx, cache);
-                          }));
+  OP_REQUIRES_OK_ASYNC(ctx,
+                       rm->LookupOrCreate<XlaCompilationCache>(
+                           rm->default_container(), "xla_cache", &cache,
+                           [this, ctx](XlaCompilationCache** cache) {
+                             return BuildCompilationCache(ctx, cache);
+                           }),
+                       done);
   // Hold the reference to the JIT during evaluation. (We could probably
   // free it sooner because the ResourceMgr will retain a reference, but
   // this is more obviously correct.)
@@ -216,10 +338,246 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   options.allow_cpu_custom_calls = (platform_id_ == gpu::host::kHostPlatformId);
   options.local_executable_has_hybrid_result = true;
 
+  const std::vector<OptionalTensor> variables =
+      SnapshotResourceVariables(ctx, num_resource_args_);
+
+  std::vector<Tensor> inputs;
+  inputs.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    inputs.push_back(ctx->input(i));
+  }
+  std::vector<Tensor> padded_inputs = inputs;
+  int64 batch_size = -1;
+  if (!bucket_sizes_.empty() && num_resource_args_ == 0) {
+    OP_REQUIRES_OK_ASYNC(ctx, PadInputs(ctx, &padded_inputs, &batch_size),
+                         done);
+  }
+
   const XlaCompiler::CompilationResult* kernel;
   xla::LocalExecutable* executable;
-  OP_REQUIRES_OK(ctx, cache->Compile(options, function_, num_constant_args_, {},
-                                     ctx, &kernel, &executable));
+  auto compile = [&](const std::vector<Tensor>& args) {
+    if (compile_in_background_) {
+      return cache->CompileInBackground(options, function_, num_constant_args_,
+                                        variables, ctx, &kernel, &executable,
+                                        &args);
+    }
+    FusionTuning fusion_tuning;
+    fusion_tuning.max_candidates = fusion_tuning_candidates_;
+    fusion_tuning.run = [this, ctx, client, &args, &variables](
+        const XlaCompiler::CompilationResult& result,
+        xla::LocalExecutable* executable, xla::ExecutionProfile* profile,
+        xla::HloExecutionProfile* hlo_profile) {
+      return ProfileExecutable(ctx, client, result, executable,
+                               WithVariableValues(args, variables), profile,
+                               hlo_profile);
+    };
+    return cache->Compile(
+        options, function_, num_constant_args_, variables, ctx, &kernel,
+        &executable, &args,
+        fusion_tuning_candidates_ > 0 ? &fusion_tuning : nullptr);
+  };
+  Status status = compile(padded_inputs);
+  if (batch_size >= 0 &&
+      (!status.ok() ||
+       (kernel != nullptr &&
+        !HasBatchOutputs(*kernel,
+                         ShapeBucketSize(bucket_sizes_, batch_size))))) {
+    // The analysis accepted a function which can't run on padded inputs.
+    VLOG(1) << "Can't pad the inputs of " << function_.name() << ": "
+            << status;
+    DisablePadding(inputs);
+    padded_inputs = inputs;
+    batch_size = -1;
+    status = compile(padded_inputs);
+  }
+  OP_REQUIRES_OK_ASYNC(ctx, status, done);
+  if (kernel == nullptr) {
+    // The computation is still being compiled.
+    RunFunction(ctx, std::move(done));
+    return;
+  }
+  if (batch_size >= 0) {
+    padded_runs->GetCell()->IncrementBy(1);
+    batch_rows->GetCell()->IncrementBy(batch_size);
+    padding_rows->GetCell()->IncrementBy(
+        ShapeBucketSize(bucket_sizes_, batch_size) - batch_size);
+  }
+  RunExecutable(ctx, client, kernel, executable,
+                WithVariableValues(padded_inputs, variables), batch_size);
+  done();
+}
+
+Status XlaLocalLaunchOp::PadInputs(OpKernelContext* ctx,
+                                   std::vector<Tensor>* inputs,
+                                   int64* batch_size) {
+  *batch_size = -1;
+  int64 size;
+  const std::vector<bool> batch_args =
+      BatchArgs(*inputs, num_constant_args_, &size);
+  if (size < 0) {
+    return Status::OK();
+  }
+  const int64 bucket_size = ShapeBucketSize(bucket_sizes_, size);
+  // An empty batch has no row to pad it with.
+  if (size == 0 || bucket_size == size || !IsRowWise(ctx, batch_args)) {
+    return Status::OK();
+  }
+  VLOG(2) << "Padding the batch of " << size << " to " << bucket_size;
+
+  gpu::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  for (int i = 0; i < inputs->size(); ++i) {
+    if (!batch_args[i]) continue;
+    const Tensor& input = (*inputs)[i];
+    TensorShape shape = input.shape();
+    shape.set_dim(0, bucket_size);
+    Tensor padded;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), shape, &padded));
+    const uint64 input_bytes = input.TotalBytes();
+    const uint64 padding_bytes = padded.TotalBytes() - input_bytes;
+    if (padding_bytes > 0) {
+      // Every padding row is a copy of the last row of the batch, so that
+      // the padding can't make an op fail, e.g. divide by zero or raise
+      // floating point errors, unless the batch itself does. The copies
+      // double the filled part of the padding each time.
+      char* dst = static_cast<char*>(DMAHelper::base(&padded));
+      const char* src = static_cast<const char*>(DMAHelper::base(&input));
+      const uint64 row_bytes = input_bytes / size;
+      auto copy = [stream](char* to, const char* from, uint64 bytes) {
+        if (stream) {
+          gpu::DeviceMemoryBase gpu_from(const_cast<char*>(from), bytes);
+          gpu::DeviceMemoryBase gpu_to(to, bytes);
+          stream->ThenMemcpyD2D(&gpu_to, gpu_from, bytes);
+        } else {
+          memcpy(to, from, bytes);
+        }
+      };
+      char* padding = dst + input_bytes;
+      copy(dst, src, input_bytes);
+      copy(padding, src + input_bytes - row_bytes, row_bytes);
+      for (uint64 filled = row_bytes; filled < padding_bytes;) {
+        const uint64 bytes = std::min(filled, padding_bytes - filled);
+        copy(padding + filled, padding, bytes);
+        filled += bytes;
+      }
+    }
+    (*inputs)[i] = padded;
+  }
+  *batch_size = size;
+  return Status::OK();
+}
+
+bool XlaLocalLaunchOp::IsRowWise(OpKernelContext* ctx,
+                                 const std::vector<bool>& batch_args) {
+  {
+    mutex_lock lock(mu_);
+    auto it = row_wise_.find(batch_args);
+    if (it != row_wise_.end()) {
+      return it->second;
+    }
+  }
+  bool row_wise = false;
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  FunctionLibraryRuntime::Handle handle;
+  Status status = lib->Instantiate(function_.name(),
+                                   AttrSlice(&function_.attr()), &handle);
+  if (status.ok()) {
+    const FunctionBody* fbody = lib->GetFunctionBody(handle);
+    row_wise = fbody != nullptr && IsComputedRowWise(*fbody->graph, batch_args);
+  } else {
+    VLOG(1) << "Can't instantiate " << function_.name() << ": " << status;
+  }
+  VLOG(1) << "The inputs of " << function_.name()
+          << (row_wise ? " can" : " can't") << " be padded";
+  mutex_lock lock(mu_);
+  row_wise_.emplace(batch_args, row_wise);
+  return row_wise;
+}
+
+void XlaLocalLaunchOp::DisablePadding(const std::vector<Tensor>& inputs) {
+  int64 batch_size;
+  std::vector<bool> batch_args =
+      BatchArgs(inputs, num_constant_args_, &batch_size);
+  mutex_lock lock(mu_);
+  row_wise_[batch_args] = false;
+}
+
+void XlaLocalLaunchOp::RunFunction(OpKernelContext* ctx, DoneCallback done) {
+  VLOG(1) << "Running the TensorFlow function "
+          << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  FunctionLibraryRuntime::Handle handle;
+  OP_REQUIRES_OK_ASYNC(
+      ctx, lib->Instantiate(function_.name(), AttrSlice(&function_.attr()),
+                            &handle),
+      done);
+
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = ctx->step_id();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.step_container = ctx->step_container();
+  opts.runner = ctx->runner();
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  std::vector<Tensor>* rets = new std::vector<Tensor>;
+  lib->Run(opts, handle, args, rets, [ctx, done, rets](const Status& status) {
+    if (!status.ok()) {
+      ctx->SetStatus(status);
+    } else if (rets->size() != ctx->num_outputs()) {
+      ctx->SetStatus(errors::Internal(
+          "The function of _XlaLaunch returned ", rets->size(),
+          " tensor(s) instead of ", ctx->num_outputs()));
+    } else {
+      for (size_t i = 0; i < rets->size(); ++i) {
+        ctx->set_output(i, (*rets)[i]);
+      }
+    }
+    delete rets;
+    done();
+  });
+}
+
+Status XlaLocalLaunchOp::ProfileExecutable(
+    OpKernelContext* ctx, xla::LocalClient* client,
+    const XlaCompiler::CompilationResult& kernel,
+    xla::LocalExecutable* executable, const std::vector<Tensor>& inputs,
+    xla::ExecutionProfile* profile, xla::HloExecutionProfile* hlo_profile) {
+  // The outputs are released with the allocator.
+  XlaAllocator xla_allocator(client->platform(), ctx);
+  XlaLocalRuntimeContext local_runtime_context;
+  std::vector<std::unique_ptr<xla::ShapedBuffer>> arg_buffers;
+  std::vector<xla::ShapedBuffer*> arg_ptrs;
+  BuildArgumentBuffers(client, kernel, inputs, &local_runtime_context,
+                       &arg_buffers, &arg_ptrs);
+  xla::ExecutableRunOptions run_options;
+  run_options.set_stream(ctx->op_device_context()
+                             ? ctx->op_device_context()->stream()
+                             : nullptr);
+  run_options.set_allocator(&xla_allocator);
+  run_options.set_intra_op_thread_pool(&ctx->eigen_cpu_device());
+  run_options.set_execution_profile(profile);
+  run_options.set_hlo_execution_profile(hlo_profile);
+  auto run_result = executable->Run(arg_ptrs, run_options);
+  if (!run_result.ok()) {
+    return run_result.status();
+  }
+  if (local_runtime_context.error) {
+    return errors::InvalidArgument("Compiled kernel returned error: ",
+                                   local_runtime_context.error_msg);
+  }
+  return Status::OK();
+}
+
+void XlaLocalLaunchOp::RunExecutable(
+    OpKernelContext* ctx, xla::LocalClient* client,
+    const XlaCompiler::CompilationResult* kernel,
+    xla::LocalExecutable* executable, const std::vector<Tensor>& inputs,
+    int64 batch_size) {
+  gpu::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
 
   VLOG(1) << "Executing XLA Computation...";
 
@@ -230,38 +588,10 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   std::unique_ptr<xla::ShapedBuffer> output;
   bool output_is_tuple;
   if (!kernel->computation->IsNull()) {
-    // Build xla::ShapedBuffers that point directly to the Tensor buffers.
     std::vector<std::unique_ptr<xla::ShapedBuffer>> arg_buffers;
-    arg_buffers.reserve(kernel->xla_input_shapes.size() + 1);
-    arg_buffers.resize(kernel->xla_input_shapes.size());
-    std::vector<xla::ShapedBuffer*> arg_ptrs(arg_buffers.size());
-
-    // Pass remaining parameters.
-    for (int i = 0; i < kernel->xla_input_shapes.size(); ++i) {
-      int arg_num = kernel->input_mapping[i];
-      const xla::Shape& shape = kernel->xla_input_shapes[i];
-      gpu::DeviceMemoryBase dmem(
-          const_cast<char*>(ctx->input(arg_num).tensor_data().data()),
-          ctx->input(arg_num).tensor_data().size());
-
-      arg_buffers[i] =
-          xla::ShapedBuffer::MakeArrayShapedBuffer(
-              shape, client->platform(), client->default_device_ordinal(), dmem)
-              .ConsumeValueOrDie();
-      arg_ptrs[i] = arg_buffers[i].get();
-    }
-
-    // Make the final parameter point at local_runtime_context.
-    if (kernel->requires_runtime_context) {
-      gpu::DeviceMemoryBase local_runtime_context_dmem(
-          &local_runtime_context, sizeof(local_runtime_context));
-      arg_buffers.push_back(
-          xla::ShapedBuffer::MakeArrayShapedBuffer(
-              xla::ShapeUtil::MakeOpaqueShape(), client->platform(),
-              client->default_device_ordinal(), local_runtime_context_dmem)
-              .ConsumeValueOrDie());
-      arg_ptrs.push_back(arg_buffers.back().get());
-    }
+    std::vector<xla::ShapedBuffer*> arg_ptrs;
+    BuildArgumentBuffers(client, *kernel, inputs, &local_runtime_context,
+                         &arg_buffers, &arg_ptrs);
 
     // Execute the computation.
     VLOG(2) << "Executing computation.";
@@ -297,7 +627,10 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   for (int i = 0; i < ctx->num_outputs(); ++i) {
     if (kernel->outputs[i].is_constant) {
       // Output is a constant
-      const Tensor& const_tensor = kernel->outputs[i].constant_value;
+      const Tensor const_tensor =
+          batch_size >= 0
+              ? kernel->outputs[i].constant_value.Slice(0, batch_size)
+              : kernel->outputs[i].constant_value;
       const size_t total_bytes = const_tensor.TotalBytes();
       if (stream && total_bytes > 0) {
         // Copy host -> device. (Empty tensors don't have backing buffers.)
@@ -330,6 +663,10 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
       OP_REQUIRES_OK(ctx, xla_allocator.MakeTensorFromBuffer(
                               buffer, ctx->expected_output_dtype(i), shape,
                               &output_tensor));
+      if (batch_size >= 0) {
+        // The rows of the padding are dropped without copying the others.
+        output_tensor = output_tensor.Slice(0, batch_size);
+      }
       ctx->set_output(i, output_tensor);
       ++output_num;
     }
@@ -339,6 +676,40 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
     }
   }
 
+  // Apply variable updates, if any. They follow the non-constant outputs, and
+  // their buffers become the tensors of the variables as they are.
+  VLOG(2) << "Applying variable updates";
+  OP_REQUIRES(ctx, kernel->variable_updates.empty() || output != nullptr,
+              errors::Internal("Variable updates without a computation."));
+  for (const XlaCompiler::VariableUpdate& write : kernel->variable_updates) {
+    OP_REQUIRES(ctx,
+                write.input_index >= 0 && write.input_index < ctx->num_inputs(),
+                errors::Internal("Invalid input index for variable write."));
+    gpu::DeviceMemoryBase buffer;
+    if (output_is_tuple) {
+      buffer = output->buffer({output_num});
+    } else {
+      CHECK_EQ(0, output_num);
+      buffer = output->buffer({});
+    }
+    Tensor value;
+    OP_REQUIRES_OK(ctx, xla_allocator.MakeTensorFromBuffer(
+                            buffer, write.type, write.shape, &value));
+    Var* variable = nullptr;
+    OP_REQUIRES_OK(ctx, LookupOrCreateResource<Var>(
+                            ctx, HandleFromInput(ctx, write.input_index),
+                            &variable, [&write](Var** ptr) {
+                              *ptr = new Var(write.type);
+                              return Status::OK();
+                            }));
+    core::ScopedUnref variable_ref(variable);
+    mutex_lock lock(*variable->mu());
+    OP_REQUIRES(ctx, variable->tensor()->dtype() == write.type,
+                errors::Internal("Mismatched type in variable write"));
+    *variable->tensor() = value;
+    ++output_num;
+  }
+
   VLOG(1) << "Done";
 }
 
@@ -349,8 +720,10 @@ XlaLocalLaunchOp::~XlaLocalLaunchOp() {
 REGISTER_KERNEL_BUILDER(Name("_XlaLaunch").Device(DEVICE_CPU),
                         XlaLocalLaunchOp);
 
-REGISTER_KERNEL_BUILDER(
-    Name("_XlaLaunch").Device(DEVICE_GPU).HostMemory("constants"),
-    XlaLocalLaunchOp);
+REGISTER_KERNEL_BUILDER(Name("_XlaLaunch")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("constants")
+                            .HostMemory("resources"),
+                        XlaLocalLaunchOp);
 
 }  // namespace tensorflow
@@ -16,12 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_KERNELS_XLA_LOCAL_LAUNCH_OP_H_
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_LOCAL_LAUNCH_OP_H_
 
+#include <map>
+#include <vector>
+
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace tensorflow {
@@ -35,21 +40,87 @@ namespace tensorflow {
 // XlaLocalLaunchOp uses xla::LocalClient::Compile() and
 // xla::LocalExecutable::Run(), and passes arguments into/out of XLA in device
 // memory.
-class XlaLocalLaunchOp : public OpKernel {
+//
+// The resource variables of the function are compiled into it: their current
+// values are passed to the executable in place as arguments, and the values
+// the computation assigns to them become the new tensors of the variables
+// without being copied, so that e.g. the forward and backward passes and the
+// optimizer updates of a training step can run as a single executable.
+//
+// With --tf_xla_async_compilation (see legacy_flags/xla_launch_op_flags.h),
+// the new signatures are compiled in the background instead of blocking the
+// step, and the op runs the original TensorFlow function until the compiled
+// executable is ready.
+//
+// If --tf_xla_shape_buckets lists bucket sizes, the batch arguments, i.e. the
+// non-constant arguments sharing the first dimension of the first one, are
+// padded to the next bucket size with copies of their last row when the
+// function computes its outputs row-wise, so that a single executable serves
+// all the batch sizes of a bucket. The outputs are sliced back to the batch
+// size. Functions with resource variables aren't padded.
+//
+// If --tf_xla_fusion_tuning is set to a positive number, the executables are
+// profiled on the inputs of their first run and rebuilt without each of this
+// number of their slowest fusions, keeping the fastest executable. This
+// doesn't apply to the background compilation.
+class XlaLocalLaunchOp : public AsyncOpKernel {
  public:
   explicit XlaLocalLaunchOp(OpKernelConstruction* ctx);
   ~XlaLocalLaunchOp() override;
 
-  void Compute(OpKernelContext* ctx) override;
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override;
 
  private:
   // Builds a XlaCompilationCache class suitable for the current device.
   Status BuildCompilationCache(OpKernelContext* ctx,
                                XlaCompilationCache** compiler);
 
+  // Runs the compiled `kernel` and `executable` on `inputs`, in which the
+  // resource variables are replaced by their values, and applies the variable
+  // updates. If `batch_size` isn't negative, the inputs are padded and the
+  // outputs are sliced to their first `batch_size` rows.
+  void RunExecutable(OpKernelContext* ctx, xla::LocalClient* client,
+                     const XlaCompiler::CompilationResult* kernel,
+                     xla::LocalExecutable* executable,
+                     const std::vector<Tensor>& inputs, int64 batch_size);
+
+  // Runs `executable`, built from `kernel`, on `inputs` and discards its
+  // outputs, writing its execution profiles to `profile` and `hlo_profile`.
+  Status ProfileExecutable(OpKernelContext* ctx, xla::LocalClient* client,
+                           const XlaCompiler::CompilationResult& kernel,
+                           xla::LocalExecutable* executable,
+                           const std::vector<Tensor>& inputs,
+                           xla::ExecutionProfile* profile,
+                           xla::HloExecutionProfile* hlo_profile);
+
+  // Pads the batch arguments in `inputs` to their bucket size, if the function
+  // can be run on padded arguments. Sets `*batch_size` to the size of the
+  // batch if the arguments were padded, or to -1 otherwise.
+  Status PadInputs(OpKernelContext* ctx, std::vector<Tensor>* inputs,
+                   int64* batch_size);
+
+  // Returns true if the function computes its outputs row-wise from the
+  // arguments `i` such that `batch_args[i]` is true.
+  bool IsRowWise(OpKernelContext* ctx, const std::vector<bool>& batch_args);
+
+  // Stops padding the batch arguments of the unpadded `inputs`, e.g. after a
+  // failed compilation.
+  void DisablePadding(const std::vector<Tensor>& inputs);
+
+  // Runs the TensorFlow function instead of its compilation.
+  void RunFunction(OpKernelContext* ctx, DoneCallback done);
+
   DeviceType device_type_;
   NameAttrList function_;
   int num_constant_args_;
+  int num_resource_args_;
+  bool compile_in_background_;
+  int64 fusion_tuning_candidates_;
+  std::vector<int64> bucket_sizes_;
+
+  // The results of IsRowWise(), by batch arguments.
+  mutex mu_;
+  std::map<std::vector<bool>, bool> row_wise_ GUARDED_BY(mu_);
 
   perftools::gputools::Platform::Id platform_id_;
 
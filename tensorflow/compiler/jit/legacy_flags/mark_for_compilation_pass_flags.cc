@@ -38,6 +38,8 @@ static void AllocateFlags() {
   flags->tf_xla_auto_jit = 0;
   flags->tf_xla_min_cluster_size = 2;
   flags->tf_xla_max_cluster_size = std::numeric_limits<int32>::max();
+  flags->tf_xla_min_cluster_bytes_saved = 0;
+  flags->tf_xla_cluster_compile_budget = std::numeric_limits<int32>::max();
   flags->tf_xla_clustering_debug = false;
   flag_list = new std::vector<Flag>({
       Flag("tf_xla_auto_jit", &flags->tf_xla_auto_jit,
@@ -51,6 +53,16 @@ static void AllocateFlags() {
            "for compilation."),
       Flag("tf_xla_max_cluster_size", &flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_min_cluster_bytes_saved",
+           &flags->tf_xla_min_cluster_bytes_saved,
+           "Minimum estimated number of bytes an XLA compilation saves "
+           "moving between its operators. Ignored for operators placed on an "
+           "XLA device or operators explicitly marked for compilation."),
+      Flag("tf_xla_cluster_compile_budget",
+           &flags->tf_xla_cluster_compile_budget,
+           "Maximum total number of operators in the XLA compilations of a "
+           "graph, bounding their compile time. The compilations saving the "
+           "most bytes are kept. Ignored like tf_xla_min_cluster_size."),
       Flag("tf_xla_clustering_debug", &flags->tf_xla_clustering_debug,
            "Dump graphs during XLA compilation."),
   });
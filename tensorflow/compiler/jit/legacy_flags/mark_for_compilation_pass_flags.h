@@ -45,6 +45,14 @@ typedef struct {
                                   // marked for compilation.
   int32 tf_xla_max_cluster_size;  // Maximum number of operators in an XLA
                                   // compilation.
+  int64 tf_xla_min_cluster_bytes_saved;  // Minimum estimated number of bytes
+                                         // an XLA compilation saves moving
+                                         // between its operators. Ignored
+                                         // like tf_xla_min_cluster_size.
+  int32 tf_xla_cluster_compile_budget;  // Maximum total number of operators
+                                        // in the XLA compilations of a graph,
+                                        // bounding their compile time. The
+                                        // most profitable ones are kept.
   bool tf_xla_clustering_debug;   // Dump graphs during XLA compilation.
 } MarkForCompilationPassFlags;
 
@@ -0,0 +1,79 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Legacy flags for the XLA bridge's _XlaLaunch kernels.
+
+#include <mutex>
+#include <vector>
+
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
+#include "tensorflow/compiler/xla/legacy_flags/parse_flags_from_env.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace legacy_flags {
+
+// Pointers to the parsed value of the flags and flag descriptors, initialized
+// via flags_init.
+static XlaLaunchOpFlags* flags;
+static std::vector<Flag>* flag_list;
+static std::once_flag flags_init;
+
+// Allocate *flags.  Called via call_once(&flags_init,...).
+static void AllocateFlags() {
+  flags = new XlaLaunchOpFlags;
+  flags->tf_xla_persistent_cache_dir = "";
+  flags->tf_xla_async_compilation = false;
+  flags->tf_xla_shape_buckets = "";
+  flags->tf_xla_fusion_tuning = 0;
+  flag_list = new std::vector<Flag>({
+      Flag("tf_xla_persistent_cache_dir", &flags->tf_xla_persistent_cache_dir,
+           "If non-empty, the directory in which the _XlaLaunch kernels "
+           "cache their compiled executables across processes."),
+      Flag("tf_xla_async_compilation", &flags->tf_xla_async_compilation,
+           "If true, the _XlaLaunch kernels compile the new signatures in the "
+           "background, and run the original function until the compiled "
+           "executable is ready."),
+      Flag("tf_xla_shape_buckets", &flags->tf_xla_shape_buckets,
+           "Comma-separated, increasing batch sizes, e.g. \"1,2,4,8\". If "
+           "non-empty, the _XlaLaunch kernels pad the batch arguments of the "
+           "row-wise functions to the next of these sizes, so that an "
+           "executable serves all the batch sizes of a bucket."),
+      Flag("tf_xla_fusion_tuning", &flags->tf_xla_fusion_tuning,
+           "If positive, the _XlaLaunch kernels profile a new executable on "
+           "the inputs of its first run and rebuild it without each of this "
+           "number of its slowest fusions, keeping the fastest executable."),
+  });
+  xla::legacy_flags::ParseFlagsFromEnv(*flag_list);
+}
+
+// Append to *append_to flag definitions associated with the XLA bridge's
+// _XlaLaunch kernels.
+void AppendXlaLaunchOpFlags(std::vector<Flag>* append_to) {
+  std::call_once(flags_init, &AllocateFlags);
+  append_to->insert(append_to->end(), flag_list->begin(), flag_list->end());
+}
+
+// Return a pointer to the XlaLaunchOpFlags struct;
+// repeated calls return the same pointer.
+// This should be called only after Flags::Parse() has returned.
+XlaLaunchOpFlags* GetXlaLaunchOpFlags() {
+  std::call_once(flags_init, &AllocateFlags);
+  return flags;
+}
+
+}  // namespace legacy_flags
+}  // namespace tensorflow
@@ -0,0 +1,53 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
+#define TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
+
+// Legacy flags for the XLA bridge's _XlaLaunch kernels.
+
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace legacy_flags {
+
+// Append to *flag_list flag definitions associated with the XLA bridge's
+// _XlaLaunch kernels.
+void AppendXlaLaunchOpFlags(std::vector<tensorflow::Flag>* flag_list);
+
+// The values of flags associated with the XLA bridge's _XlaLaunch kernels.
+typedef struct {
+  string tf_xla_persistent_cache_dir;  // Directory of the persistent cache
+                                       // of the compiled executables, if any.
+  bool tf_xla_async_compilation;       // Compile the new signatures in the
+                                       // background.
+  string tf_xla_shape_buckets;         // Comma-separated batch sizes the
+                                       // batch arguments are padded to.
+  int64 tf_xla_fusion_tuning;          // Number of fusions tried unfused
+                                       // when an executable is built.
+} XlaLaunchOpFlags;
+
+// Return a pointer to the XlaLaunchOpFlags struct;
+// repeated calls return the same pointer.
+// This should be called only after Flags::Parse() has returned.
+XlaLaunchOpFlags* GetXlaLaunchOpFlags();
+
+}  // namespace legacy_flags
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
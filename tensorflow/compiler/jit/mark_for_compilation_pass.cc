@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/mark_for_compilation_pass.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <limits>
@@ -31,9 +32,14 @@ limitations under the License.
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/control_flow.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -211,6 +217,127 @@ struct Cluster {
   // Identifies the node that represents this cluster in the cycle detection
   // graph.
   int representative = -1;
+
+  // The IDs of the nodes producing the tensors of dynamic shape which the
+  // nodes of the cluster consume, see IsDynamicShapeBoundary().
+  std::unordered_set<int> dynamic_shape_producers;
+};
+
+// Estimates the benefit of clustering the nodes of a graph from the
+// properties of its tensors inferred statically by Grappler. Nothing is known
+// about the tensors if the inference fails, e.g. for graphs calling functions.
+class ClusteringCostModel {
+ public:
+  explicit ClusteringCostModel(const Graph& graph) {
+    grappler::GrapplerItem item;
+    graph.ToGraphDef(&item.graph);
+    properties_.reset(new grappler::GraphProperties(item));
+    Status status = properties_->InferStatically();
+    if (!status.ok()) {
+      VLOG(1) << "Can't infer the shapes of the graph to cluster: " << status;
+      properties_.reset();
+    }
+  }
+
+  // Returns the size in bytes of the tensor on the data edge `edge`, or 0 if
+  // its shape isn't known statically.
+  int64 EdgeBytes(const Edge& edge) const {
+    const OpInfo::TensorProperties* tensor = OutputProperties(edge);
+    if (tensor == nullptr || !IsFullyDefined(*tensor)) {
+      return 0;
+    }
+    return TensorShape(tensor->shape()).num_elements() *
+           DataTypeSize(tensor->dtype());
+  }
+
+  // Does the shape of the tensor on the data edge `edge` depend on values only
+  // known at run time, while the shapes of the inputs of its source are
+  // known? Clustering the source of the edge with its destination would force
+  // XLA to compile the cluster for each of the shapes of the tensor.
+  bool IsDynamicShapeBoundary(const Edge& edge) const {
+    const OpInfo::TensorProperties* tensor = OutputProperties(edge);
+    if (tensor == nullptr || IsFullyDefined(*tensor)) {
+      return false;
+    }
+    const std::vector<OpInfo::TensorProperties> inputs =
+        properties_->GetInputProperties(edge.src()->name());
+    return !inputs.empty() &&
+           std::all_of(inputs.begin(), inputs.end(),
+                       [](const OpInfo::TensorProperties& input) {
+                         return IsFullyDefined(input);
+                       });
+  }
+
+  // Returns the Grappler estimate of the execution time of `node`.
+  grappler::Costs::Duration ExecutionTime(const Node& node) {
+    OpInfo op_info;
+    op_info.set_op(node.type_string());
+    *op_info.mutable_attr() = node.def().attr();
+    if (properties_ != nullptr) {
+      for (const OpInfo::TensorProperties& input :
+           properties_->GetInputProperties(node.name())) {
+        *op_info.add_inputs() = input;
+      }
+    }
+    *op_info.mutable_device() =
+        GetDeviceProperties(node.assigned_device_name());
+    return estimator_.PredictCosts(op_info).execution_time;
+  }
+
+ private:
+  static bool IsFullyDefined(const OpInfo::TensorProperties& tensor) {
+    return PartialTensorShape(tensor.shape()).IsFullyDefined();
+  }
+
+  // Returns the properties of the tensor on the data edge `edge`, if known.
+  const OpInfo::TensorProperties* OutputProperties(const Edge& edge) const {
+    if (properties_ == nullptr || edge.IsControlEdge()) {
+      return nullptr;
+    }
+    auto it = outputs_.find(edge.src());
+    if (it == outputs_.end()) {
+      it = outputs_
+               .emplace(edge.src(),
+                        properties_->GetOutputProperties(edge.src()->name()))
+               .first;
+    }
+    if (edge.src_output() >= it->second.size()) {
+      return nullptr;
+    }
+    return &it->second[edge.src_output()];
+  }
+
+  // Returns the properties of the device named `device`, as used by Grappler.
+  const DeviceProperties& GetDeviceProperties(const string& device) {
+    auto it = devices_.find(device);
+    if (it == devices_.end()) {
+      DeviceNameUtils::ParsedName parsed;
+      DeviceNameUtils::ParseFullName(device, &parsed);
+      it = devices_.emplace(device, grappler::GetDeviceInfo(parsed)).first;
+    }
+    return it->second;
+  }
+
+  std::unique_ptr<grappler::GraphProperties> properties_;
+  grappler::OpLevelCostEstimator estimator_;
+  mutable std::unordered_map<const Node*,
+                             std::vector<OpInfo::TensorProperties>>
+      outputs_;
+  std::unordered_map<string, DeviceProperties> devices_;
+};
+
+// The expected profitability of compiling a cluster.
+struct ClusterProfit {
+  // The number of nodes in the cluster.
+  int num_nodes = 0;
+
+  // The estimated number of bytes of the tensors passed between the nodes of
+  // the cluster, which the compilation needn't write to and read back from
+  // memory.
+  int64 bytes_saved = 0;
+
+  // The Grappler estimate of the execution time of the nodes of the cluster.
+  grappler::Costs::Duration execution_time;
 };
 
 }  // anonymous namespace
@@ -298,6 +425,18 @@ Status MarkForCompilationPass::RunImpl(
                                            : Env::Default(),
       is_compilable_fn, &compilation_candidates));
 
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+  if (compilation_candidates.empty()) {
+    // Avoids inferring the shapes of the graph for nothing.
+    if (flags->tf_xla_clustering_debug) {
+      dump_graph::DumpGraphToFile("mark_for_compilation", **options.graph,
+                                  options.flib_def);
+    }
+    return Status::OK();
+  }
+  ClusteringCostModel cost_model(*graph);
+
   GraphCycles cycles;
   for (int i = 0; i < graph->num_node_ids(); ++i) {
     // We rely on the node IDs in the cycle detection graph being consecutive
@@ -380,12 +519,15 @@ Status MarkForCompilationPass::RunImpl(
   for (Node* node : compilation_candidates) {
     Cluster& cluster = clusters[node->id()].Get();
     cluster.representative = node->id();
+    for (const Edge* edge : node->in_edges()) {
+      if (compilation_candidates.count(edge->src()) > 0 &&
+          cost_model.IsDynamicShapeBoundary(*edge)) {
+        cluster.dynamic_shape_producers.insert(edge->src()->id());
+      }
+    }
     worklist.push_back(&clusters[node->id()]);
   }
 
-  legacy_flags::MarkForCompilationPassFlags* flags =
-      legacy_flags::GetMarkForCompilationPassFlags();
-
   // Repeatedly contract edges between clusters that are on the same device,
   // provided the contraction would not create a cycle.
   while (!worklist.empty()) {
@@ -443,6 +585,17 @@ Status MarkForCompilationPass::RunImpl(
         continue;
       }
 
+      // Don't cluster the consumers of tensors of dynamic shape with their
+      // producers.
+      const std::unordered_set<int>& dynamic_shape_producers =
+          clusters[to].Get().dynamic_shape_producers;
+      if (std::any_of(dynamic_shape_producers.begin(),
+                      dynamic_shape_producers.end(), [&clusters, from](int id) {
+                        return clusters[id].Get().representative == from;
+                      })) {
+        continue;
+      }
+
       // If contracting the edge would create a cycle, bail out.
       // However, just because we can't merge the clusters now does not mean
       // we won't be able to merge them in the future.
@@ -452,18 +605,69 @@ Status MarkForCompilationPass::RunImpl(
 
       // Merge the clusters. ContractEdge uses 'from' as the number of the
       // merged node, so make sure 'from' is the chosen representative.
+      std::unordered_set<int> to_dynamic_shape_producers =
+          std::move(clusters[to].Get().dynamic_shape_producers);
       clusters[from].Merge(&clusters[to]);
+      clusters[from].Get().dynamic_shape_producers.insert(
+          to_dynamic_shape_producers.begin(), to_dynamic_shape_producers.end());
 
       worklist.push_back(&clusters[from]);
       break;
     }
   }
 
-  // Count the number of elements in each cluster.
-  std::vector<int> cluster_sizes(graph->num_node_ids());
-  for (const Node* n : compilation_candidates) {
+  // Estimate the profitability of each cluster.
+  std::unordered_map<int, ClusterProfit> profits;
+  for (Node* n : compilation_candidates) {
     int cluster = clusters[n->id()].Get().representative;
-    cluster_sizes[cluster]++;
+    ClusterProfit& profit = profits[cluster];
+    ++profit.num_nodes;
+    profit.execution_time += cost_model.ExecutionTime(*n);
+    for (const Edge* edge : n->in_edges()) {
+      if (!edge->IsControlEdge() &&
+          compilation_candidates.count(edge->src()) > 0 &&
+          clusters[edge->src()->id()].Get().representative == cluster) {
+        profit.bytes_saved += cost_model.EdgeBytes(*edge);
+      }
+    }
+  }
+
+  // Choose the clusters worth compiling, if compilation is enabled: those with
+  // at least flags->tf_xla_min_cluster_size elements saving at least
+  // flags->tf_xla_min_cluster_bytes_saved bytes, the ones saving the most
+  // bytes first, until flags->tf_xla_cluster_compile_budget elements are
+  // compiled.
+  std::vector<int> profitable_clusters;
+  for (const auto& cluster_and_profit : profits) {
+    const ClusterProfit& profit = cluster_and_profit.second;
+    if (profit.num_nodes >= flags->tf_xla_min_cluster_size &&
+        profit.bytes_saved >= flags->tf_xla_min_cluster_bytes_saved) {
+      profitable_clusters.push_back(cluster_and_profit.first);
+    }
+  }
+  std::sort(profitable_clusters.begin(), profitable_clusters.end(),
+            [&profits](int a, int b) {
+              const ClusterProfit& profit_a = profits[a];
+              const ClusterProfit& profit_b = profits[b];
+              if (profit_a.bytes_saved != profit_b.bytes_saved) {
+                return profit_a.bytes_saved > profit_b.bytes_saved;
+              }
+              if (profit_a.num_nodes != profit_b.num_nodes) {
+                return profit_a.num_nodes > profit_b.num_nodes;
+              }
+              return a < b;
+            });
+  std::unordered_set<int> compiled_clusters;
+  int64 compiled_nodes = 0;
+  for (int cluster : profitable_clusters) {
+    const int num_nodes = profits[cluster].num_nodes;
+    if (compiled_nodes + num_nodes > flags->tf_xla_cluster_compile_budget) {
+      VLOG(1) << "Not compiling a cluster of " << num_nodes
+              << " nodes: the compile budget is exhausted";
+      continue;
+    }
+    compiled_nodes += num_nodes;
+    compiled_clusters.insert(cluster);
   }
 
   // Names for each cluster.
@@ -472,9 +676,8 @@ Status MarkForCompilationPass::RunImpl(
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
-  // * have more than flags->tf_xla_min_cluster_size elements (applicable only
-  //   if compilation is enabled, otherwise there will be no such candidates).
-  const int min_cluster_size = flags->tf_xla_min_cluster_size;
+  // * were chosen above (applicable only if compilation is enabled, otherwise
+  //   there will be no such candidates).
   for (Node* n : compilation_candidates) {
     int cluster = clusters[n->id()].Get().representative;
 
@@ -496,13 +699,17 @@ Status MarkForCompilationPass::RunImpl(
     const XlaOpRegistry::DeviceRegistration* registration;
     XlaOpRegistry::GetCompilationDevice(device_type.type(), &registration);
 
-    // Or compile if this is a cluster of >= min_cluster_size compilable
-    // operators.
-    if (cluster_sizes[cluster] >= min_cluster_size || marked_for_compilation ||
+    // Or compile if this is a profitable cluster of compilable operators.
+    if (compiled_clusters.count(cluster) > 0 || marked_for_compilation ||
         registration->requires_compilation) {
       string& name = cluster_names[cluster];
       if (name.empty()) {
         name = strings::StrCat("cluster_", cluster_sequence_num++);
+        const ClusterProfit& profit = profits[cluster];
+        VLOG(1) << "Cluster " << name << ": " << profit.num_nodes
+                << " nodes, an estimated " << profit.bytes_saved
+                << " bytes saved and " << profit.execution_time.count()
+                << "ns of execution time";
       }
       n->AddAttr(kXlaClusterAttr, name);
     }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/mark_for_compilation_pass.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/legacy_flags/mark_for_compilation_pass_flags.h"
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/control_flow_ops_internal.h"
@@ -455,5 +456,104 @@ TEST(XlaCompilationTest, CyclesWithDifferentScopesAndBridge) {
   EXPECT_EQ(clusters["B"], clusters["C"]);
 }
 
+TEST(XlaCompilationTest, CompileBudget) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  {
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a =
+        ops::SourceOp("UncompilableNullary", builder.opts().WithName("A"));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    Node* c = ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+    Node* d =
+        ops::UnaryOp("UncompilableUnary", c, builder.opts().WithName("D"));
+    Node* e = ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    ops::UnaryOp("Relu", e, builder.opts().WithName("F"));
+    TF_EXPECT_OK(builder.ToGraph(graph.get()));
+  }
+
+  // Only one of the two clusters fits in a budget of two operators.
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+  const int32 old_budget = flags->tf_xla_cluster_compile_budget;
+  flags->tf_xla_cluster_compile_budget = 2;
+  MarkForCompilation(&graph);
+  flags->tf_xla_cluster_compile_budget = old_budget;
+
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(2, clusters.size());
+  EXPECT_EQ(clusters.count("B"), clusters.count("C"));
+  EXPECT_EQ(clusters.count("E"), clusters.count("F"));
+  EXPECT_NE(clusters.count("B"), clusters.count("E"));
+}
+
+TEST(XlaCompilationTest, MinClusterBytesSaved) {
+  // Each Relu output is a float[2, 2] kept on device: 32 bytes in total.
+  auto build_graph = [](std::unique_ptr<Graph>* graph) {
+    graph->reset(new Graph(OpRegistry::Global()));
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a = ops::SourceOp(
+        "Const", builder.opts()
+                     .WithName("A")
+                     .WithAttr("dtype", DT_FLOAT)
+                     .WithAttr("value", Tensor(DT_FLOAT, TensorShape({2, 2}))));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+    TF_CHECK_OK(builder.ToGraph(graph->get()));
+  };
+
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+  const int64 old_min_bytes = flags->tf_xla_min_cluster_bytes_saved;
+
+  std::unique_ptr<Graph> graph;
+  build_graph(&graph);
+  flags->tf_xla_min_cluster_bytes_saved = 32;
+  MarkForCompilation(&graph);
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(3, clusters.size());
+  EXPECT_EQ(clusters["A"], clusters["B"]);
+  EXPECT_EQ(clusters["B"], clusters["C"]);
+
+  build_graph(&graph);
+  flags->tf_xla_min_cluster_bytes_saved = 33;
+  MarkForCompilation(&graph);
+  EXPECT_TRUE(GetClusters(*graph).empty());
+
+  flags->tf_xla_min_cluster_bytes_saved = old_min_bytes;
+}
+
+TEST(XlaCompilationTest, DynamicShapeBoundary) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  {
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a = ops::SourceOp(
+        "Const", builder.opts()
+                     .WithName("A")
+                     .WithAttr("dtype", DT_FLOAT)
+                     .WithAttr("value", Tensor(DT_FLOAT, TensorShape({4}))));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    Node* shape = ops::SourceOp("Placeholder",
+                                builder.opts()
+                                    .WithName("Shape")
+                                    .WithAttr("dtype", DT_INT32)
+                                    .WithAttr("shape", TensorShape({2})));
+    Node* c = ops::BinaryOp("Reshape", b, shape, builder.opts().WithName("C"));
+    Node* d = ops::UnaryOp("Relu", c, builder.opts().WithName("D"));
+    ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    TF_EXPECT_OK(builder.ToGraph(graph.get()));
+  }
+
+  MarkForCompilation(&graph);
+  auto clusters = GetClusters(*graph);
+
+  // The shape of C depends on the value of Shape, so C ends the cluster it
+  // belongs to rather than being compiled with its consumers.
+  EXPECT_EQ(5, clusters.size());
+  EXPECT_EQ(clusters["A"], clusters["B"]);
+  EXPECT_EQ(clusters["B"], clusters["C"]);
+  EXPECT_EQ(clusters["D"], clusters["E"]);
+  EXPECT_NE(clusters["C"], clusters["D"]);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,181 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The ops computing each element of their outputs from the elements of their
+// inputs at the same position, up to broadcasting.
+const std::unordered_set<string>* const kElementwiseOps =
+    new std::unordered_set<string>({
+        "Abs", "Add", "AddN", "BiasAdd", "Cast", "Ceil", "CheckNumerics", "Cos",
+        "Div", "Elu", "Equal", "Exp", "Floor", "FloorDiv", "FloorMod",
+        "Greater", "GreaterEqual", "Identity", "IsFinite", "IsInf", "IsNan",
+        "Less", "LessEqual", "Log", "Log1p", "LogicalAnd", "LogicalNot",
+        "LogicalOr", "Maximum", "Minimum", "Mul", "Neg", "NotEqual", "OnesLike",
+        "Pow", "PreventGradient", "RealDiv", "Reciprocal", "Relu", "Relu6",
+        "Round", "Rsqrt", "Select", "Selu", "Sigmoid", "Sign", "Sin",
+        "Snapshot", "Softplus", "Softsign", "Sqrt", "Square",
+        "SquaredDifference", "StopGradient", "Sub", "Tanh", "ZerosLike",
+    });
+
+// The reductions along the axes given by their second input.
+const std::unordered_set<string>* const kReductionOps =
+    new std::unordered_set<string>({"All", "Any", "ArgMax", "ArgMin", "Max",
+                                    "Mean", "Min", "Prod", "Sum"});
+
+// Returns true if `node` is a Const node of positive integers.
+bool IsPositiveConstant(const Node* node) {
+  Tensor value;
+  if (!node->IsConstant() ||
+      !GetNodeAttr(node->attrs(), "value", &value).ok()) {
+    return false;
+  }
+  if (value.dtype() == DT_INT32) {
+    auto values = value.flat<int32>();
+    return std::all_of(values.data(), values.data() + values.size(),
+                       [](int32 v) { return v > 0; });
+  }
+  if (value.dtype() == DT_INT64) {
+    auto values = value.flat<int64>();
+    return std::all_of(values.data(), values.data() + values.size(),
+                       [](int64 v) { return v > 0; });
+  }
+  return false;
+}
+
+// Returns true if `node`, one of whose inputs depends on the rows of the batch
+// arguments, computes the rows of its outputs from the same rows of these
+// inputs. `inputs` are the producers of the inputs of `node`, and
+// `input_is_batch` tell whether they depend on the batch arguments.
+bool IsRowWise(const Node* node, const std::vector<const Node*>& inputs,
+               const std::vector<bool>& input_is_batch) {
+  const string& op = node->type_string();
+  if (kElementwiseOps->count(op) > 0) {
+    return true;
+  }
+  if (op == "MatMul") {
+    bool transpose_a;
+    return input_is_batch[0] && !input_is_batch[1] &&
+           GetNodeAttr(node->attrs(), "transpose_a", &transpose_a).ok() &&
+           !transpose_a;
+  }
+  // The batch is the first dimension with both the NHWC and NCHW layouts, and
+  // the convolutions and poolings can't stride or pool along it.
+  if (op == "Conv2D" || op == "DepthwiseConv2dNative") {
+    return input_is_batch[0] && !input_is_batch[1];
+  }
+  if (op == "AvgPool" || op == "MaxPool") {
+    return true;
+  }
+  // The softmaxes are computed along the last dimension of matrices.
+  if (op == "Softmax" || op == "LogSoftmax") {
+    return true;
+  }
+  if (kReductionOps->count(op) > 0) {
+    return input_is_batch[0] && !input_is_batch[1] &&
+           IsPositiveConstant(inputs[1]);
+  }
+  if (op == "ConcatV2") {
+    const int axis = inputs.size() - 1;
+    for (int i = 0; i < axis; ++i) {
+      if (!input_is_batch[i]) return false;
+    }
+    return !input_is_batch[axis] && IsPositiveConstant(inputs[axis]);
+  }
+  return false;
+}
+
+}  // namespace
+
+Status ParseShapeBucketSizes(StringPiece text,
+                             std::vector<int64>* bucket_sizes) {
+  bucket_sizes->clear();
+  if (text.empty()) {
+    return Status::OK();
+  }
+  if (!str_util::SplitAndParseAsInts(text, ',', bucket_sizes)) {
+    return errors::InvalidArgument("Invalid shape bucket sizes: ", text);
+  }
+  for (int64 size : *bucket_sizes) {
+    if (size <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket size ", size);
+    }
+  }
+  std::sort(bucket_sizes->begin(), bucket_sizes->end());
+  return Status::OK();
+}
+
+int64 ShapeBucketSize(const std::vector<int64>& bucket_sizes, int64 size) {
+  auto bucket_size =
+      std::lower_bound(bucket_sizes.begin(), bucket_sizes.end(), size);
+  return bucket_size == bucket_sizes.end() ? size : *bucket_size;
+}
+
+bool IsComputedRowWise(const Graph& graph,
+                       const std::vector<bool>& batch_args) {
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  // Whether the outputs of each node depend on the rows of the batch
+  // arguments.
+  std::vector<bool> is_batch(graph.num_node_ids(), false);
+  for (const Node* node : order) {
+    if (!node->IsOp()) continue;
+    std::vector<const Node*> inputs(node->num_inputs(), nullptr);
+    for (const Edge* edge : node->in_edges()) {
+      if (!edge->IsControlEdge()) {
+        inputs[edge->dst_input()] = edge->src();
+      }
+    }
+    std::vector<bool> input_is_batch(inputs.size());
+    bool depends_on_batch = false;
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (inputs[i] == nullptr) return false;
+      input_is_batch[i] = is_batch[inputs[i]->id()];
+      depends_on_batch = depends_on_batch || input_is_batch[i];
+    }
+
+    if (node->type_string() == "_Arg") {
+      int index;
+      if (!GetNodeAttr(node->attrs(), "index", &index).ok()) return false;
+      is_batch[node->id()] = index < batch_args.size() && batch_args[index];
+    } else if (node->type_string() == "_Retval") {
+      // The outputs are sliced along their first dimension.
+      if (!depends_on_batch) return false;
+    } else if (depends_on_batch) {
+      if (!IsRowWise(node, inputs, input_is_batch)) {
+        VLOG(2) << "Can't pad the inputs of " << node->name() << " ("
+                << node->type_string() << ")";
+        return false;
+      }
+      is_batch[node->id()] = true;
+    }
+  }
+  return true;
+}
+
+}  // namespace tensorflow
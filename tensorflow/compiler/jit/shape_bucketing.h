@@ -0,0 +1,57 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Shape bucketing bounds the number of XLA compilations of the functions run
+// with variable batch sizes: the arguments of the batch size are padded along
+// their first dimension up to the next of a few bucket sizes, and the outputs
+// of the computation compiled for the bucket size are sliced back to the batch
+// size. This is only correct for the functions computing each row of their
+// outputs from the same rows of these arguments.
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Parses the comma-separated, positive bucket sizes in `text`, e.g.
+// "1,2,4,8,16,32,64,128", into `bucket_sizes`, in increasing order. The
+// _XlaLaunch ops take them from --tf_xla_shape_buckets, and disable shape
+// bucketing if it is empty.
+Status ParseShapeBucketSizes(StringPiece text,
+                             std::vector<int64>* bucket_sizes);
+
+// Returns the smallest of the sorted `bucket_sizes` that is at least `size`,
+// or `size` if there is none.
+int64 ShapeBucketSize(const std::vector<int64>& bucket_sizes, int64 size);
+
+// Returns true if each row of the outputs of `graph`, the body of a function
+// with _Arg and _Retval nodes, is computed from the same rows of the arguments
+// `i` such that `batch_args[i]` is true, and from the other arguments, i.e. if
+// these arguments can be padded or sliced along their first dimension. The
+// analysis is conservative: it only accepts the elementwise ops, and the
+// matrix multiplications, convolutions, poolings, softmaxes, reductions and
+// concatenations which don't mix the rows.
+bool IsComputedRowWise(const Graph& graph, const std::vector<bool>& batch_args);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
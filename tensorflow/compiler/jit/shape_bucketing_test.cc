@@ -0,0 +1,104 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/function_ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ShapeBucketingTest, ParseShapeBucketSizes) {
+  std::vector<int64> bucket_sizes;
+  TF_EXPECT_OK(ParseShapeBucketSizes("", &bucket_sizes));
+  EXPECT_TRUE(bucket_sizes.empty());
+
+  TF_EXPECT_OK(ParseShapeBucketSizes("8,1,32", &bucket_sizes));
+  EXPECT_EQ(std::vector<int64>({1, 8, 32}), bucket_sizes);
+
+  EXPECT_FALSE(ParseShapeBucketSizes("1,x", &bucket_sizes).ok());
+  EXPECT_FALSE(ParseShapeBucketSizes("4,0", &bucket_sizes).ok());
+}
+
+TEST(ShapeBucketingTest, ShapeBucketSize) {
+  const std::vector<int64> bucket_sizes = {1, 8, 32};
+  EXPECT_EQ(1, ShapeBucketSize(bucket_sizes, 1));
+  EXPECT_EQ(8, ShapeBucketSize(bucket_sizes, 2));
+  EXPECT_EQ(8, ShapeBucketSize(bucket_sizes, 8));
+  EXPECT_EQ(32, ShapeBucketSize(bucket_sizes, 9));
+  EXPECT_EQ(33, ShapeBucketSize(bucket_sizes, 33));
+  EXPECT_EQ(5, ShapeBucketSize({}, 5));
+}
+
+// Converts the graph of `root` into a Graph.
+std::unique_ptr<Graph> ToGraph(const Scope& root) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_CHECK_OK(root.ToGraph(graph.get()));
+  return graph;
+}
+
+TEST(ShapeBucketingTest, AcceptsRowWiseGraph) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto x = ops::_Arg(root.WithOpName("x"), DT_FLOAT, 0);
+  auto w = ops::_Arg(root.WithOpName("w"), DT_FLOAT, 1);
+  auto b = ops::_Arg(root.WithOpName("b"), DT_FLOAT, 2);
+  auto y = ops::MatMul(root.WithOpName("y"), x, w);
+  auto z = ops::BiasAdd(root.WithOpName("z"), y, b);
+  auto r = ops::Relu(root.WithOpName("r"), z);
+  auto s = ops::Sum(root.WithOpName("s"), r, 1);
+  ops::_Retval(root.WithOpName("r0"), r, 0);
+  ops::_Retval(root.WithOpName("r1"), s, 1);
+  std::unique_ptr<Graph> graph = ToGraph(root);
+
+  EXPECT_TRUE(IsComputedRowWise(*graph, {true, false, false}));
+  // The weights aren't a batch.
+  EXPECT_FALSE(IsComputedRowWise(*graph, {true, true, false}));
+  // The outputs must be batches.
+  EXPECT_FALSE(IsComputedRowWise(*graph, {false, false, false}));
+}
+
+TEST(ShapeBucketingTest, RejectsGraphsMixingRows) {
+  {
+    Scope root = Scope::NewRootScope().ExitOnError();
+    auto x = ops::_Arg(root.WithOpName("x"), DT_FLOAT, 0);
+    auto s = ops::Sum(root.WithOpName("s"), x, 0);
+    ops::_Retval(root.WithOpName("r"), s, 0);
+    EXPECT_FALSE(IsComputedRowWise(*ToGraph(root), {true}));
+  }
+  {
+    Scope root = Scope::NewRootScope().ExitOnError();
+    auto x = ops::_Arg(root.WithOpName("x"), DT_FLOAT, 0);
+    auto r = ops::Reshape(root.WithOpName("r"), x, {-1});
+    ops::_Retval(root.WithOpName("y"), r, 0);
+    EXPECT_FALSE(IsComputedRowWise(*ToGraph(root), {true}));
+  }
+  {
+    Scope root = Scope::NewRootScope().ExitOnError();
+    auto x = ops::_Arg(root.WithOpName("x"), DT_FLOAT, 0);
+    auto w = ops::_Arg(root.WithOpName("w"), DT_FLOAT, 1);
+    auto y = ops::MatMul(root.WithOpName("y"), x, w,
+                         ops::MatMul::TransposeA(true));
+    ops::_Retval(root.WithOpName("r"), y, 0);
+    EXPECT_FALSE(IsComputedRowWise(*ToGraph(root), {true, false}));
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
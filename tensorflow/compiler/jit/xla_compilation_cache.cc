@@ -15,31 +15,88 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <algorithm>
 #include <numeric>
+#include <unordered_set>
 
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/tf2xla/dump_graph.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/type_util.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/service/instruction_fusion.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 
+std::vector<OptionalTensor> SnapshotResourceVariables(OpKernelContext* ctx,
+                                                      int num_variables) {
+  std::vector<OptionalTensor> snapshot(num_variables);
+  int first_variable = ctx->num_inputs() - num_variables;
+  for (int i = 0; i < num_variables; ++i) {
+    Var* variable = nullptr;
+    ResourceHandle handle = HandleFromInput(ctx, first_variable + i);
+    if (LookupResource(ctx, handle, &variable).ok()) {
+      core::ScopedUnref variable_ref(variable);
+      mutex_lock lock(*variable->mu());
+      snapshot[i].name = handle.name();
+      snapshot[i].present = true;
+      snapshot[i].value = *variable->tensor();
+    }
+  }
+  return snapshot;
+}
+
+namespace {
+
+auto* cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/xla_compilation_cache/hits",
+    "The number of XLA compilations found in the compilation caches.");
+
+auto* cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/xla_compilation_cache/misses",
+    "The number of XLA compilations not found in the compilation caches.");
+
+auto* persistent_cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/xla_compilation_cache/persistent_cache_hits",
+    "The number of XLA compilations loaded from the persistent caches.");
+
+auto* persistent_cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/xla_compilation_cache/persistent_cache_misses",
+    "The number of XLA compilations not found in the persistent caches.");
+
+// The number of times each executable is run to measure its execution time
+// when tuning the fusions.
+const int kFusionTuningRuns = 3;
+
+}  // namespace
+
 XlaCompilationCache::XlaCompilationCache(xla::Client* client,
-                                         DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+                                         DeviceType device_type,
+                                         string persistent_cache_dir)
+    : client_(client),
+      device_type_(std::move(device_type)),
+      persistent_cache_dir_(std::move(persistent_cache_dir)) {}
 XlaCompilationCache::~XlaCompilationCache() = default;
 
 string XlaCompilationCache::DebugString() {
@@ -93,30 +150,30 @@ uint64 XlaCompilationCache::Signature::Hash::operator()(
 
 Status XlaCompilationCache::BuildSignature(
     const NameAttrList& function, int num_constant_args,
-    const std::vector<OptionalTensor>& variable_args, OpKernelContext* ctx,
-    Signature* signature) {
+    const std::vector<OptionalTensor>& variable_args,
+    const std::vector<Tensor>& inputs, Signature* signature) {
   signature->name = Canonicalize(function.name(), AttrSlice(&function.attr()));
   signature->arg_values.resize(num_constant_args);
 
-  signature->arg_types.reserve(ctx->num_inputs() - num_constant_args);
+  signature->arg_types.reserve(inputs.size() - num_constant_args);
 
   // Inputs are in the order: constants, non-constants, resource variables.
   int input_num = 0;
   // Use the values of compile time constants in the signature->
   while (input_num < num_constant_args) {
-    signature->arg_values[input_num] = ctx->input(input_num);
+    signature->arg_values[input_num] = inputs[input_num];
     ++input_num;
   }
   // Add the types and shapes of the remaining arguments.
-  while (input_num < ctx->num_inputs() - variable_args.size()) {
-    signature->arg_types.emplace_back(ctx->input_dtype(input_num),
-                                      ctx->input(input_num).shape());
+  while (input_num < inputs.size() - variable_args.size()) {
+    signature->arg_types.emplace_back(inputs[input_num].dtype(),
+                                      inputs[input_num].shape());
     ++input_num;
   }
   // For variable signatures, use the type and shape of the variable's
   // current value.
   for (const OptionalTensor& variable : variable_args) {
-    TF_RET_CHECK(input_num < ctx->num_inputs());
+    TF_RET_CHECK(input_num < inputs.size());
     if (variable.present) {
       signature->arg_types.emplace_back(variable.value.dtype(),
                                         variable.value.shape());
@@ -130,20 +187,240 @@ Status XlaCompilationCache::BuildSignature(
 
 namespace {
 
-// Builds a XlaCompiler::Argument vector from the arguments to the _XlaLaunch
+// Appends the definition of the function `name` and of the functions it calls,
+// which aren't in `visited` yet, to `key`.
+void AppendFunctionDefinitions(const FunctionLibraryDefinition& flib_def,
+                               const string& name,
+                               std::unordered_set<string>* visited,
+                               string* key) {
+  const FunctionDef* fdef = flib_def.Find(name);
+  if (fdef == nullptr || !visited->insert(name).second) {
+    return;
+  }
+  // Unlike the binary serialization, the text format orders the attr maps.
+  strings::StrAppend(key, ";", fdef->DebugString());
+  for (const NodeDef& node : fdef->node_def()) {
+    AppendFunctionDefinitions(flib_def, node.op(), visited, key);
+    for (const auto& attr : node.attr()) {
+      if (attr.second.has_func()) {
+        AppendFunctionDefinitions(flib_def, attr.second.func().name(), visited,
+                                  key);
+      }
+    }
+  }
+}
+
+// Appends the type and the shape of a tensor to `key`.
+void AppendTypeAndShape(DataType type, const TensorShape& shape, string* key) {
+  strings::StrAppend(key, ";", DataTypeString(type), shape.DebugString());
+}
+
+void TypeAndShapeToProto(DataType type, const TensorShape& shape,
+                         XlaCompilationCacheTensorShape* proto) {
+  proto->set_type(type);
+  for (int64 dim : shape.dim_sizes()) {
+    proto->add_dims(dim);
+  }
+}
+
+Status TypeAndShapeFromProto(const XlaCompilationCacheTensorShape& proto,
+                             DataType* type, TensorShape* shape) {
+  if (!DataType_IsValid(proto.type())) {
+    return errors::DataLoss("Invalid type ", proto.type());
+  }
+  *type = static_cast<DataType>(proto.type());
+  std::vector<int64> dims(proto.dims().begin(), proto.dims().end());
+  return TensorShapeUtils::MakeShape(dims, shape);
+}
+
+// Converts a compilation result to a persistent cache entry.
+Status CompilationResultToProto(const XlaCompiler::CompilationResult& result,
+                                XlaCompilationCacheEntry* entry) {
+  for (int input : result.input_mapping) {
+    entry->add_input_mapping(input);
+  }
+  entry->set_requires_runtime_context(result.requires_runtime_context);
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *entry->add_xla_input_shapes() = shape;
+  }
+  entry->set_tuple_arg(result.tuple_arg);
+  *entry->mutable_xla_output_shape() = result.xla_output_shape;
+  for (const XlaCompiler::OutputDescription& output : result.outputs) {
+    XlaCompilationCacheEntry::Output* proto = entry->add_outputs();
+    TypeAndShapeToProto(output.type, output.shape, proto->mutable_shape());
+    proto->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      TensorProto value;
+      output.constant_value.AsProtoTensorContent(&value);
+      value.SerializeToString(proto->mutable_constant_value());
+    }
+  }
+  for (const XlaCompiler::VariableUpdate& update : result.variable_updates) {
+    XlaCompilationCacheEntry::VariableUpdate* proto =
+        entry->add_variable_updates();
+    proto->set_input_index(update.input_index);
+    TypeAndShapeToProto(update.type, update.shape, proto->mutable_shape());
+    proto->set_modified(update.modified);
+  }
+  if (!result.computation->IsNull()) {
+    auto snapshot = result.computation->Snapshot();
+    if (!snapshot.ok()) {
+      return snapshot.status();
+    }
+    entry->mutable_computation()->Swap(snapshot.ValueOrDie().get());
+  }
+  for (const string& name : result.unfused_instructions) {
+    entry->add_unfused_instructions(name);
+  }
+  entry->set_fusion_tuned(result.fusion_tuned);
+  return Status::OK();
+}
+
+// Converts a persistent cache entry back to a compilation result, loading the
+// XLA computation into `client`.
+Status CompilationResultFromProto(const XlaCompilationCacheEntry& entry,
+                                  xla::Client* client,
+                                  XlaCompiler::CompilationResult* result) {
+  result->input_mapping.assign(entry.input_mapping().begin(),
+                               entry.input_mapping().end());
+  result->requires_runtime_context = entry.requires_runtime_context();
+  result->xla_input_shapes.assign(entry.xla_input_shapes().begin(),
+                                  entry.xla_input_shapes().end());
+  result->tuple_arg = entry.tuple_arg();
+  result->xla_output_shape = entry.xla_output_shape();
+  result->outputs.resize(entry.outputs_size());
+  for (int i = 0; i < entry.outputs_size(); ++i) {
+    const XlaCompilationCacheEntry::Output& proto = entry.outputs(i);
+    XlaCompiler::OutputDescription& output = result->outputs[i];
+    TF_RETURN_IF_ERROR(
+        TypeAndShapeFromProto(proto.shape(), &output.type, &output.shape));
+    output.is_constant = proto.is_constant();
+    if (output.is_constant) {
+      TensorProto value;
+      if (!value.ParseFromString(proto.constant_value()) ||
+          !output.constant_value.FromProto(value)) {
+        return errors::DataLoss("Invalid value of the constant output ", i);
+      }
+    }
+  }
+  result->variable_updates.resize(entry.variable_updates_size());
+  for (int i = 0; i < entry.variable_updates_size(); ++i) {
+    const XlaCompilationCacheEntry::VariableUpdate& proto =
+        entry.variable_updates(i);
+    XlaCompiler::VariableUpdate& update = result->variable_updates[i];
+    update.input_index = proto.input_index();
+    TF_RETURN_IF_ERROR(
+        TypeAndShapeFromProto(proto.shape(), &update.type, &update.shape));
+    update.modified = proto.modified();
+  }
+  if (entry.has_computation()) {
+    auto computation = client->LoadSnapshot(entry.computation());
+    if (!computation.ok()) {
+      return computation.status();
+    }
+    result->computation =
+        std::make_shared<xla::Computation>(computation.ConsumeValueOrDie());
+  } else {
+    result->computation = std::make_shared<xla::Computation>();
+  }
+  result->unfused_instructions.assign(entry.unfused_instructions().begin(),
+                                      entry.unfused_instructions().end());
+  result->fusion_tuned = entry.fusion_tuned();
+  return Status::OK();
+}
+
+}  // namespace
+
+string XlaCompilationCache::PersistentCacheKey(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const Signature& signature) const {
+  string key = strings::StrCat(
+      TF_VERSION_STRING, ";", tf_git_version(), ";", device_type_.type(), ";",
+      options.graph_def_version, ";", options.allow_cpu_custom_calls, ";",
+      options.local_executable_has_hybrid_result, ";",
+      options.resolve_compile_time_constants, ";", signature.name);
+  for (const auto& arg : signature.arg_types) {
+    AppendTypeAndShape(arg.first, arg.second, &key);
+  }
+  for (const Tensor& value : signature.arg_values) {
+    AppendTypeAndShape(value.dtype(), value.shape(), &key);
+    strings::StrAppend(&key, ";", value.tensor_data());
+  }
+  std::unordered_set<string> visited;
+  AppendFunctionDefinitions(*options.flib_def, function.name(), &visited,
+                            &key);
+  return key;
+}
+
+string XlaCompilationCache::PersistentCachePath(const string& key) const {
+  return io::JoinPath(
+      persistent_cache_dir_,
+      strings::StrCat(strings::Hex(Fingerprint64(key), strings::ZERO_PAD_16),
+                      ".xla_compilation"));
+}
+
+bool XlaCompilationCache::LoadCompilationResult(
+    const string& key, XlaCompiler::CompilationResult* result) {
+  Env* env = Env::Default();
+  const string path = PersistentCachePath(key);
+  if (!env->FileExists(path).ok()) {
+    return false;
+  }
+  XlaCompilationCacheEntry entry;
+  XlaCompiler::CompilationResult loaded;
+  Status status = ReadBinaryProto(env, path, &entry);
+  if (status.ok() && entry.key() != key) {
+    status = errors::FailedPrecondition("The entry has a different key");
+  }
+  if (status.ok()) {
+    status = CompilationResultFromProto(entry, client_, &loaded);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Couldn't load the XLA compilation cache entry " << path
+                 << ": " << status;
+    return false;
+  }
+  VLOG(1) << "Loaded the XLA compilation cache entry " << path;
+  *result = std::move(loaded);
+  return true;
+}
+
+Status XlaCompilationCache::StoreCompilationResult(
+    const string& key, const XlaCompiler::CompilationResult& result) {
+  XlaCompilationCacheEntry entry;
+  entry.set_key(key);
+  TF_RETURN_IF_ERROR(CompilationResultToProto(result, &entry));
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_dir_));
+  // Write to a temporary file first so that the processes sharing the cache
+  // never read partially written entries.
+  const string path = PersistentCachePath(key);
+  const string temp_path =
+      strings::StrCat(path, ".", strings::Hex(random::New64()), ".tmp");
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
+  Status status = env->RenameFile(temp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return status;
+}
+
+namespace {
+
+// Builds a XlaCompiler::Argument vector from the `inputs` of the _XlaLaunch
 // op. The first `num_constant_args` arguments must be host-memory Tensors.
 Status BuildArguments(int num_constant_args,
                       const std::vector<OptionalTensor>& variable_args,
-                      OpKernelContext* ctx,
+                      const std::vector<Tensor>& inputs,
                       std::vector<XlaCompiler::Argument>* args) {
-  args->resize(ctx->num_inputs());
+  args->resize(inputs.size());
 
   int input_num = 0;
 
   // Handles compile-time constants.
-  TF_RET_CHECK(num_constant_args <= ctx->num_inputs());
+  TF_RET_CHECK(num_constant_args <= inputs.size());
   while (input_num < num_constant_args) {
-    const Tensor& input = ctx->input(input_num);
+    const Tensor& input = inputs[input_num];
     TF_RET_CHECK(input.dtype() != DT_RESOURCE);
     XlaCompiler::Argument& arg = (*args)[input_num];
     arg.kind = XlaCompiler::Argument::kConstant;
@@ -156,10 +433,10 @@ Status BuildArguments(int num_constant_args,
   // Handles the non-constant arguments.
   int num_variable_args = variable_args.size();
   int num_nonconst_args =
-      ctx->num_inputs() - num_variable_args - num_constant_args;
+      inputs.size() - num_variable_args - num_constant_args;
   TF_RET_CHECK(num_nonconst_args >= 0);
   while (input_num < num_constant_args + num_nonconst_args) {
-    const Tensor& input = ctx->input(input_num);
+    const Tensor& input = inputs[input_num];
     TF_RET_CHECK(input.dtype() != DT_RESOURCE);
     XlaCompiler::Argument& arg = (*args)[input_num];
     if (input.NumElements() > 0) {
@@ -174,9 +451,9 @@ Status BuildArguments(int num_constant_args,
   }
 
   // Handles resource variables.
-  TF_RET_CHECK(input_num + num_variable_args == ctx->num_inputs());
+  TF_RET_CHECK(input_num + num_variable_args == inputs.size());
   for (int variable_id = 0; variable_id < num_variable_args; ++variable_id) {
-    const Tensor& input = ctx->input(input_num);
+    const Tensor& input = inputs[input_num];
     TF_RET_CHECK(input.dtype() == DT_RESOURCE);
 
     XlaCompiler::Argument& arg = (*args)[input_num];
@@ -209,16 +486,175 @@ Status XlaCompilationCache::Compile(
     int num_constant_args, const std::vector<OptionalTensor>& variable_args,
     OpKernelContext* ctx,
     const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable, const std::vector<Tensor>* inputs,
+    const FusionTuning* fusion_tuning) {
+  return CompileImpl(options, function, num_constant_args, variable_args, ctx,
+                     inputs, /*compile_in_background=*/false, fusion_tuning,
+                     compilation_result, executable);
+}
+
+Status XlaCompilationCache::CompileInBackground(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+    OpKernelContext* ctx,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable, const std::vector<Tensor>* inputs) {
+  return CompileImpl(options, function, num_constant_args, variable_args, ctx,
+                     inputs, /*compile_in_background=*/true,
+                     /*fusion_tuning=*/nullptr, compilation_result,
+                     executable);
+}
+
+void XlaCompilationCache::MaybeStoreCompilationResult(
+    const string& key, const NameAttrList& function,
+    const XlaCompiler::CompilationResult& result) {
+  if (persistent_cache_dir_.empty()) {
+    return;
+  }
+  Status status = StoreCompilationResult(key, result);
+  if (!status.ok()) {
+    LOG(WARNING) << "Couldn't store the XLA compilation of "
+                 << Canonicalize(function.name(), AttrSlice(&function.attr()))
+                 << " in the persistent cache: " << status;
+  }
+}
+
+void XlaCompilationCache::StartBackgroundCompilation(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    std::vector<XlaCompiler::Argument> args, const string& persistent_key,
+    Entry* entry) {
+  VLOG(1) << "Compiling "
+          << Canonicalize(function.name(), AttrSlice(&function.attr()))
+          << " in the background";
+  entry->compiling = true;
+  const bool compiled = entry->compiled;
+  XlaCompiler::CompilationResult result;
+  if (compiled) {
+    result = entry->compilation_result;
+  }
+  // The function library of the caller may be destroyed before the
+  // compilation is done.
+  std::shared_ptr<FunctionLibraryDefinition> flib_def(
+      new FunctionLibraryDefinition(*options.flib_def));
+  // Keep the cache, hence the entry, alive until the compilation is done.
+  Ref();
+  Env::Default()->SchedClosure([this, options, function, args, persistent_key,
+                                entry, compiled, result, flib_def]() mutable {
+    XlaCompiler::Options compiler_options = options;
+    compiler_options.flib_def = flib_def.get();
+    XlaCompiler compiler(compiler_options);
+    Status status;
+    if (!compiled) {
+      status = compiler.CompileFunction(XlaCompiler::CompileOptions(), function,
+                                        args, &result);
+      if (status.ok()) {
+        MaybeStoreCompilationResult(persistent_key, function, result);
+      }
+    }
+    std::unique_ptr<xla::LocalExecutable> executable;
+    if (status.ok() && !result.computation->IsNull()) {
+      status = compiler.BuildExecutable(result, &executable);
+    }
+    {
+      mutex_lock entry_lock(entry->mu);
+      if (!compiled) {
+        entry->compiled = true;
+        entry->compilation_result = std::move(result);
+      }
+      entry->compilation_status = status;
+      entry->executable = std::move(executable);
+      entry->compiling = false;
+    }
+    entry->compiling_done.notify_all();
+    Unref();
+  });
+}
+
+Status XlaCompilationCache::TuneFusion(const XlaCompiler::Options& options,
+                                       const FusionTuning& fusion_tuning,
+                                       Entry* entry) {
+  XlaCompiler::CompilationResult& result = entry->compilation_result;
+  // Returns the shortest execution time of several runs of `executable`.
+  auto time_executable = [&](xla::LocalExecutable* executable,
+                             int64* time_ns) -> Status {
+    *time_ns = kint64max;
+    for (int i = 0; i < kFusionTuningRuns; ++i) {
+      xla::ExecutionProfile profile;
+      TF_RETURN_IF_ERROR(fusion_tuning.run(result, executable, &profile,
+                                           /*hlo_profile=*/nullptr));
+      *time_ns = std::min<int64>(*time_ns, profile.compute_time_ns());
+    }
+    return Status::OK();
+  };
+
+  XlaCompiler compiler(options);
+  std::unique_ptr<xla::LocalExecutable> profiled;
+  TF_RETURN_IF_ERROR(compiler.BuildExecutable(
+      result, result.unfused_instructions, /*hlo_profiling=*/true, &profiled));
+  xla::ExecutionProfile profile;
+  xla::HloExecutionProfile hlo_profile;
+  TF_RETURN_IF_ERROR(
+      fusion_tuning.run(result, profiled.get(), &profile, &hlo_profile));
+  std::vector<std::vector<string>> candidates;
+  for (const xla::HloInstruction* fusion :
+       xla::InstructionFusion::SlowestFusions(profiled->executable()->module(),
+                                              hlo_profile,
+                                              fusion_tuning.max_candidates)) {
+    std::vector<string> names =
+        xla::InstructionFusion::FusedInstructionNames(*fusion);
+    if (!names.empty()) {
+      candidates.push_back(std::move(names));
+    }
+  }
+
+  // Unfuses the slow fusions one by one, keeping those which pay off.
+  int64 best_time_ns;
+  TF_RETURN_IF_ERROR(time_executable(entry->executable.get(), &best_time_ns));
+  for (const std::vector<string>& names : candidates) {
+    std::vector<string> unfused_instructions = result.unfused_instructions;
+    unfused_instructions.insert(unfused_instructions.end(), names.begin(),
+                                names.end());
+    std::unique_ptr<xla::LocalExecutable> candidate;
+    TF_RETURN_IF_ERROR(compiler.BuildExecutable(
+        result, unfused_instructions, /*hlo_profiling=*/false, &candidate));
+    int64 time_ns;
+    TF_RETURN_IF_ERROR(time_executable(candidate.get(), &time_ns));
+    VLOG(1) << "Unfusing " << str_util::Join(names, ", ") << " takes "
+            << time_ns << "ns instead of " << best_time_ns << "ns";
+    if (time_ns < best_time_ns) {
+      best_time_ns = time_ns;
+      result.unfused_instructions = std::move(unfused_instructions);
+      entry->executable = std::move(candidate);
+    }
+  }
+  return Status::OK();
+}
+
+Status XlaCompilationCache::CompileImpl(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+    OpKernelContext* ctx, const std::vector<Tensor>* inputs,
+    bool compile_in_background, const FusionTuning* fusion_tuning,
+    const XlaCompiler::CompilationResult** compilation_result,
     xla::LocalExecutable** executable) {
   VLOG(1) << "XlaCompilationCache::Compile " << DebugString();
 
+  std::vector<Tensor> ctx_inputs;
+  if (inputs == nullptr) {
+    ctx_inputs.reserve(ctx->num_inputs());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      ctx_inputs.push_back(ctx->input(i));
+    }
+    inputs = &ctx_inputs;
+  }
+
   if (VLOG_IS_ON(2)) {
-    VLOG(2) << "num_inputs=" << ctx->num_inputs()
+    VLOG(2) << "num_inputs=" << inputs->size()
             << " num_constant_args=" << num_constant_args
             << " num_variable_args=" << variable_args.size();
-    for (int i = 0; i < ctx->num_inputs(); i++) {
-      TensorShape shape = ctx->input(i).shape();
-      VLOG(2) << i << ": dtype=" << DataTypeString(ctx->input_dtype(i))
+    for (int i = 0; i < inputs->size(); i++) {
+      TensorShape shape = (*inputs)[i].shape();
+      VLOG(2) << i << ": dtype=" << DataTypeString((*inputs)[i].dtype())
               << " present=" << ctx->has_input(i)
               << " shape=" << shape.DebugString();
     }
@@ -233,11 +669,11 @@ Status XlaCompilationCache::Compile(
     }
   }
 
-  TF_RET_CHECK(num_constant_args + variable_args.size() <= ctx->num_inputs());
+  TF_RET_CHECK(num_constant_args + variable_args.size() <= inputs->size());
 
   Signature signature;
   TF_RETURN_IF_ERROR(BuildSignature(function, num_constant_args, variable_args,
-                                    ctx, &signature));
+                                    *inputs, &signature));
 
   VLOG(2) << "Signature: " << SignatureDebugString(signature);
   // The outer lock protects the existence of the cache entry. It does not
@@ -248,7 +684,10 @@ Status XlaCompilationCache::Compile(
     // Find or create a cache entry.
     std::unique_ptr<Entry>& e = cache_[signature];
     if (!e) {
+      cache_misses->GetCell()->IncrementBy(1);
       e.reset(new Entry);
+    } else {
+      cache_hits->GetCell()->IncrementBy(1);
     }
     entry = e.get();
   }
@@ -257,27 +696,83 @@ Status XlaCompilationCache::Compile(
   // TODO(phawkins): this locking will need to be restructured when we implement
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
+  if (entry->compiling) {
+    if (compile_in_background) {
+      *compilation_result = nullptr;
+      if (executable) *executable = nullptr;
+      return Status::OK();
+    }
+    while (entry->compiling) {
+      entry->compiling_done.wait(entry_lock);
+    }
+  }
+  // Look for the compilation result in the persistent cache first.
+  string persistent_key;
+  if (!entry->compiled && !persistent_cache_dir_.empty()) {
+    persistent_key = PersistentCacheKey(options, function, signature);
+    if (LoadCompilationResult(persistent_key, &entry->compilation_result)) {
+      persistent_cache_hits->GetCell()->IncrementBy(1);
+      entry->compiled = true;
+    } else {
+      persistent_cache_misses->GetCell()->IncrementBy(1);
+    }
+  }
   if (!entry->compiled) {
     // Do the actual JIT compilation without holding the lock (it can take
     // a long time.)
     std::vector<XlaCompiler::Argument> args;
     TF_RETURN_IF_ERROR(
-        BuildArguments(num_constant_args, variable_args, ctx, &args));
-
+        BuildArguments(num_constant_args, variable_args, *inputs, &args));
+
+    if (compile_in_background) {
+      StartBackgroundCompilation(options, function, std::move(args),
+                                 persistent_key, entry);
+      *compilation_result = nullptr;
+      if (executable) *executable = nullptr;
+      return Status::OK();
+    }
     XlaCompiler compiler(options);
     entry->compiled = true;
     entry->compilation_status =
         compiler.CompileFunction(XlaCompiler::CompileOptions(), function, args,
                                  &entry->compilation_result);
+    if (entry->compilation_status.ok()) {
+      MaybeStoreCompilationResult(persistent_key, function,
+                                  entry->compilation_result);
+    }
   }
   *compilation_result = &entry->compilation_result;
   if (entry->compilation_status.ok() && executable) {
     if (entry->executable == nullptr &&
         !entry->compilation_result.computation->IsNull()) {
+      if (compile_in_background) {
+        StartBackgroundCompilation(options, function, {}, "", entry);
+        *compilation_result = nullptr;
+        *executable = nullptr;
+        return Status::OK();
+      }
       XlaCompiler compiler(options);
       entry->compilation_status = compiler.BuildExecutable(
           entry->compilation_result, &entry->executable);
     }
+    if (fusion_tuning != nullptr && entry->executable != nullptr &&
+        !entry->compilation_result.fusion_tuned) {
+      // The executable is kept as is if the tuning fails.
+      entry->compilation_result.fusion_tuned = true;
+      Status status = TuneFusion(options, *fusion_tuning, entry);
+      if (status.ok()) {
+        if (!persistent_cache_dir_.empty()) {
+          MaybeStoreCompilationResult(
+              PersistentCacheKey(options, function, signature), function,
+              entry->compilation_result);
+        }
+      } else {
+        LOG(WARNING) << "Couldn't tune the fusions of "
+                     << Canonicalize(function.name(),
+                                     AttrSlice(&function.attr()))
+                     << ": " << status;
+      }
+    }
     *executable = entry->executable.get();
   }
 
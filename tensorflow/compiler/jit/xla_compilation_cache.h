@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 
+#include <functional>
+
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/service/hlo_execution_profile.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -36,6 +39,31 @@ struct OptionalTensor {
   Tensor value;          // If present, what is the Tensor's value?
 };
 
+// Takes a snapshot of the values of resource variable arguments, which are
+// the last `num_variables` arguments. We snapshot tensors that back
+// resource variables since concurrent updates may modify the shape, and it is
+// important that the shapes used for compilation match the true shapes of the
+// buffers.
+std::vector<OptionalTensor> SnapshotResourceVariables(OpKernelContext* ctx,
+                                                      int num_variables);
+
+// Describes how to run the executables of a compilation on the inputs it was
+// compiled for, to choose its fusion decisions by profiling it.
+struct FusionTuning {
+  // The number of slowest fusions of the profiled executable which are tried
+  // unfused.
+  int64 max_candidates = 0;
+
+  // Runs `executable`, built from `result`, once and blocks until it is done.
+  // Writes the execution time to `profile`, and the per-HLO cycles to
+  // `hlo_profile` if the executable was built with HLO profiling.
+  std::function<Status(const XlaCompiler::CompilationResult& result,
+                       xla::LocalExecutable* executable,
+                       xla::ExecutionProfile* profile,
+                       xla::HloExecutionProfile* hlo_profile)>
+      run;
+};
+
 // The XlaCompilationCache class caches the results of the XlaCompiler class,
 // which converts a Tensorflow graph into a compiled XLA compilation.
 //
@@ -44,9 +72,26 @@ struct OptionalTensor {
 //
 // Currently no cache eviction policy is implemented and the cache grows without
 // bound.
+//
+// The results of the XlaCompiler can also be persisted in a directory, e.g.
+// the one named by the --tf_xla_persistent_cache_dir flag (see
+// jit/legacy_flags/xla_launch_op_flags.h) for the _XlaLaunch kernels, from
+// which the caches of later processes read them back instead of translating
+// the same functions again. The XLA computations are
+// persisted rather than the executables, which can't be serialized, so the
+// executables are still built by each process.
+//
+// Compile() can also tune the fusion decisions of the executables: the first
+// time an executable is built, it profiles the executable, tries building it
+// again without each of its slowest fusions and keeps the fastest executable.
+// The fusion decisions are stored in the persistent cache with the
+// computation.
 class XlaCompilationCache : public ResourceBase {
  public:
-  XlaCompilationCache(xla::Client* client, DeviceType device_type);
+  // If `persistent_cache_dir` is non-empty, the compilation results are also
+  // stored in and loaded from this directory.
+  XlaCompilationCache(xla::Client* client, DeviceType device_type,
+                      string persistent_cache_dir = "");
   ~XlaCompilationCache() override;
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -60,13 +105,31 @@ class XlaCompilationCache : public ResourceBase {
   // be non-null. If `executable` is non-null, also builds an
   // xla::LocalExecutable and sets `executable to point to it. The resulting
   // executable pointer may be null if the computation has no non-constant
-  // outputs.
+  // outputs. If `inputs` is non-null, the function is compiled for these
+  // tensors instead of the inputs of `ctx`, e.g. for padded inputs. If
+  // `fusion_tuning` is non-null, the fusion decisions of the executable are
+  // tuned with it unless they were tuned already.
   Status Compile(const XlaCompiler::Options& options,
                  const NameAttrList& function, int num_constant_args,
                  const std::vector<OptionalTensor>& variable_args,
                  OpKernelContext* ctx,
                  const XlaCompiler::CompilationResult** compilation_result,
-                 xla::LocalExecutable** executable);
+                 xla::LocalExecutable** executable,
+                 const std::vector<Tensor>* inputs = nullptr,
+                 const FusionTuning* fusion_tuning = nullptr);
+
+  // Like Compile(), but doesn't wait for the XLA computation and its executable
+  // to be built: if they aren't built yet, starts building them in the
+  // background and sets `*compilation_result` and `*executable` to null, in
+  // which case the caller is expected to run the function some other way.
+  // Later calls return the compilation result once it is built.
+  Status CompileInBackground(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+      OpKernelContext* ctx,
+      const XlaCompiler::CompilationResult** compilation_result,
+      xla::LocalExecutable** executable,
+      const std::vector<Tensor>* inputs = nullptr);
 
   xla::Client* client() const { return client_; }
   const DeviceType& device_type() const { return device_type_; }
@@ -76,6 +139,7 @@ class XlaCompilationCache : public ResourceBase {
  private:
   xla::Client* const client_;
   const DeviceType device_type_;
+  const string persistent_cache_dir_;
 
   // Describes the types, shapes and any compile-time constant arguments
   // to a kernel. Key that uniquely identifies a compilation output.
@@ -96,10 +160,46 @@ class XlaCompilationCache : public ResourceBase {
   };
   static string SignatureDebugString(const Signature& sig);
 
-  // Builds the signature for a compilation.
+  // Builds the signature for a compilation of `function` for `inputs`.
   Status BuildSignature(const NameAttrList& function, int num_constant_args,
                         const std::vector<OptionalTensor>& variable_args,
-                        OpKernelContext* ctx, Signature* signature);
+                        const std::vector<Tensor>& inputs,
+                        Signature* signature);
+
+  // Implements Compile() and CompileInBackground().
+  Status CompileImpl(const XlaCompiler::Options& options,
+                     const NameAttrList& function, int num_constant_args,
+                     const std::vector<OptionalTensor>& variable_args,
+                     OpKernelContext* ctx, const std::vector<Tensor>* inputs,
+                     bool compile_in_background,
+                     const FusionTuning* fusion_tuning,
+                     const XlaCompiler::CompilationResult** compilation_result,
+                     xla::LocalExecutable** executable);
+
+  // Returns the key identifying the compilation of `signature` with `options`
+  // across processes. Unlike the signature, it includes the definitions of the
+  // functions, which may differ between the graphs run by the processes.
+  string PersistentCacheKey(const XlaCompiler::Options& options,
+                            const NameAttrList& function,
+                            const Signature& signature) const;
+
+  // Returns the path of the persistent cache entry for `key`.
+  string PersistentCachePath(const string& key) const;
+
+  // Reads the compilation result stored with `key` in the persistent cache.
+  // Returns false if there is no such entry, or if it can't be loaded.
+  bool LoadCompilationResult(const string& key,
+                             XlaCompiler::CompilationResult* result);
+
+  // Writes `result` to the persistent cache with `key`.
+  Status StoreCompilationResult(const string& key,
+                                const XlaCompiler::CompilationResult& result);
+
+  // Writes `result` to the persistent cache with `key`, if there is one,
+  // logging the failures.
+  void MaybeStoreCompilationResult(
+      const string& key, const NameAttrList& function,
+      const XlaCompiler::CompilationResult& result);
 
   // The value associated with a cache entry.
   struct Entry {
@@ -108,6 +208,12 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is the entry being compiled, or its executable being built, in the
+    // background? The other fields are only modified by the background
+    // compilation until it is done.
+    bool compiling GUARDED_BY(mu) = false;
+    condition_variable compiling_done;
+
     // Did compilation succeed?
     Status compilation_status GUARDED_BY(mu);
 
@@ -119,6 +225,20 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable GUARDED_BY(mu);
   };
 
+  // Builds the computation of `entry` from `args`, unless it was already
+  // compiled, and its executable in the background.
+  void StartBackgroundCompilation(const XlaCompiler::Options& options,
+                                  const NameAttrList& function,
+                                  std::vector<XlaCompiler::Argument> args,
+                                  const string& persistent_key, Entry* entry)
+      EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+
+  // Tunes the fusion decisions of the executable of `entry` with
+  // `fusion_tuning`, replacing the executable with the fastest one.
+  Status TuneFusion(const XlaCompiler::Options& options,
+                    const FusionTuning& fusion_tuning, Entry* entry)
+      EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+
   mutex mu_;
   std::unordered_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       GUARDED_BY(mu_);
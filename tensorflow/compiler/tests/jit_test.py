@@ -35,7 +35,9 @@ from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import gradients_impl
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import nn_ops
+from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.platform import test
+from tensorflow.python.training import gradient_descent
 
 jit_scope = jit.experimental_jit_scope
 
@@ -409,6 +411,29 @@ class XlaCompilationTest(test.TestCase):
       result = session.run(u, {x: np.float32(2)})
       self.assertAllClose(result, np.float32(63), rtol=1e-1)
 
+  def testTrainingStep(self):
+    """Tests that a training step compiles with its variable updates."""
+
+    with self.test_session() as sess:
+      x = array_ops.placeholder(dtypes.float32)
+      w0 = np.array([[1, 2], [3, 4]], np.float32)
+      w = resource_variable_ops.ResourceVariable(w0)
+      with jit_scope():
+        loss = math_ops.reduce_sum(math_ops.square(math_ops.matmul(x, w)))
+        train = gradient_descent.GradientDescentOptimizer(0.1).minimize(loss)
+      w.initializer.run()
+
+      dx = np.array([[1, -1]], np.float32)
+      run_metadata = config_pb2.RunMetadata()
+      sess.run(train, {x: dx},
+               run_metadata=run_metadata,
+               options=config_pb2.RunOptions(
+                   trace_level=config_pb2.RunOptions.FULL_TRACE))
+      self.assert_(MetadataHasXlaLaunch(run_metadata))
+      # d(sum((x w)^2))/dw = 2 x^T (x w)
+      expected = w0 - 0.1 * 2 * dx.T.dot(dx.dot(w0))
+      self.assertAllClose(expected, w.eval())
+
   def testGradient(self):
     """Tests that the backprop function is properly compiled."""
 
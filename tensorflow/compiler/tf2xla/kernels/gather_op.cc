@@ -13,8 +13,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include "tensorflow/compiler/tf2xla/shape_util.h"
-#include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
 #include "tensorflow/compiler/tf2xla/xla_op_kernel.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -48,55 +46,16 @@ class GatherOp : public XlaOpKernel {
                                 DataTypeString(index_type), " indexing: ",
                                 params_shape.dim_size(0), " > ", limit));
 
-    // The result shape is indices.shape + params.shape[1:].
-    TensorShape result_shape = indices_shape;
-    for (int i = 1; i < params_shape.dims(); i++) {
-      result_shape.AddDim(params_shape.dim_size(i));
-    }
-
-    XlaContext& tc = XlaContext::Get(ctx);
-    OP_REQUIRES(
-        ctx, tc.allow_cpu_custom_calls(),
-        errors::InvalidArgument("Gather op requires CustomCall on CPU"));
-
-    xla::ComputationBuilder& b = *ctx->builder();
-
-    // Call gather_xla_float_kernel (from gather_op_kernel_float.cc).
-    // XLA passes <out> to the function, so it is not included here.
-    std::vector<xla::ComputationDataHandle> args;
-    args.push_back(tc.GetOrCreateRuntimeContextParameter());
-    args.push_back(b.ConstantLiteral(
-        *xla::LiteralUtil::CreateR0<int64>(indices_shape.num_elements())));
-    args.push_back(b.ConstantLiteral(
-        *xla::LiteralUtil::CreateR0<int64>(params_shape.dim_size(0))));
-    args.push_back(b.ConstantLiteral(*xla::LiteralUtil::CreateR0<int64>(
-        params_shape.num_elements() / params_shape.dim_size(0))));
-    args.push_back(ctx->Input(0));
-    args.push_back(ctx->Input(1));
-
-    xla::Shape xla_out_shape;
-    OP_REQUIRES_OK(
-        ctx, TensorShapeToXLAShape(DT_FLOAT, result_shape, &xla_out_shape));
-
-    // Call the custom code with args:
-    xla::ComputationDataHandle output;
-    if (index_type == DT_INT32) {
-      output = b.CustomCall("gather_float_int32_xla_impl", args, xla_out_shape);
-    } else {
-      output = b.CustomCall("gather_float_int64_xla_impl", args, xla_out_shape);
-    }
-
-    ctx->SetOutput(0, output);
+    // The result shape is indices.shape + params.shape[1:]; the native gather
+    // emits it as a single loop, which can be fused with its consumers.
+    ctx->SetOutput(0, ctx->builder()->Gather(ctx->Input(0), ctx->Input(1)));
   }
 
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(GatherOp);
 };
 
-REGISTER_XLA_OP(Name("Gather")
-                    .TypeConstraint("Tparams", DT_FLOAT)
-                    .Device(DEVICE_CPU_XLA_JIT),
-                GatherOp);
+REGISTER_XLA_OP(Name("Gather"), GatherOp);
 
 }  // namespace
 }  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/type_util.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -161,6 +162,14 @@ Status XlaCompiler::CompileFunction(
 Status XlaCompiler::BuildExecutable(
     const XlaCompiler::CompilationResult& result,
     std::unique_ptr<xla::LocalExecutable>* executable) {
+  return BuildExecutable(result, result.unfused_instructions,
+                         /*hlo_profiling=*/false, executable);
+}
+
+Status XlaCompiler::BuildExecutable(
+    const XlaCompiler::CompilationResult& result,
+    const std::vector<string>& unfused_instructions, bool hlo_profiling,
+    std::unique_ptr<xla::LocalExecutable>* executable) {
   VLOG(2) << "Compiling to local executable";
   xla::Shape opaque_shape = xla::ShapeUtil::MakeOpaqueShape();
 
@@ -180,6 +189,12 @@ Status XlaCompiler::BuildExecutable(
   build_options.set_result_layout(result.xla_output_shape);
   build_options.set_has_hybrid_result(
       options_.local_executable_has_hybrid_result);
+  build_options.set_hlo_profiling(hlo_profiling);
+  xla::DebugOptions debug_options;
+  for (const string& name : unfused_instructions) {
+    debug_options.add_xla_unfused_instructions(name);
+  }
+  build_options.set_debug_options(debug_options);
 
   auto compile_result = local_client->Compile(*result.computation,
                                               argument_layouts, build_options);
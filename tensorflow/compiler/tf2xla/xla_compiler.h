@@ -180,6 +180,14 @@ class XlaCompiler {
     // The XLA computation built from the tensorflow subgraph. May be null
     // if the output consists solely of compile-time constants.
     std::shared_ptr<xla::Computation> computation;
+
+    // The names of the HLO instructions which aren't fused into their users
+    // when the computation is built into an executable, e.g. as chosen by
+    // profile-guided fusion tuning.
+    std::vector<string> unfused_instructions;
+
+    // Were the fusion decisions of the executable tuned already?
+    bool fusion_tuned = false;
   };
 
   struct Options {
@@ -265,6 +273,14 @@ class XlaCompiler {
   Status BuildExecutable(const CompilationResult& result,
                          std::unique_ptr<xla::LocalExecutable>* executable);
 
+  // Like BuildExecutable(), but doesn't fuse the `unfused_instructions` instead
+  // of those of `result`, and instruments the executable to collect per-HLO
+  // profiles if `hlo_profiling` is true.
+  Status BuildExecutable(const CompilationResult& result,
+                         const std::vector<string>& unfused_instructions,
+                         bool hlo_profiling,
+                         std::unique_ptr<xla::LocalExecutable>* executable);
+
   const Options& options() const { return options_; }
   xla::Client* client() const { return options_.client; }
   XlaCompilationDevice* device() const { return device_; }
@@ -81,7 +81,7 @@ XlaOpRegistry::~XlaOpRegistry() = default;
       registration.compilation_device_name = DEVICE_CPU_XLA_JIT;
       registration.requires_compilation = false;
       registration.enable_jit_by_default = false;
-      registration.compile_resource_ops = false;
+      registration.compile_resource_ops = true;
     }
     if (IsPlatformSupported(perftools::gputools::cuda::kCudaPlatformId)) {
       DeviceRegistration& registration =
@@ -89,7 +89,7 @@ XlaOpRegistry::~XlaOpRegistry() = default;
       registration.compilation_device_name = DEVICE_GPU_XLA_JIT;
       registration.requires_compilation = false;
       registration.enable_jit_by_default = true;
-      registration.compile_resource_ops = false;
+      registration.compile_resource_ops = true;
     }
     return nullptr;
   }();
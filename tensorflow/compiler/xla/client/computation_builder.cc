@@ -327,6 +327,27 @@ ComputationDataHandle ComputationBuilder::DynamicUpdateSlice(
   return ParseOpResponse(s, &response);
 }
 
+ComputationDataHandle ComputationBuilder::Gather(
+    const ComputationDataHandle& operand,
+    const ComputationDataHandle& indices) {
+  if (!first_error_.ok() || !PrepareComputation().ok()) {
+    return ComputationDataHandle();
+  }
+
+  GatherRequest request;
+  *request.mutable_operand() = operand;
+  *request.mutable_indices() = indices;
+  OpRequest op_request;
+  *op_request.mutable_computation() = computation_.handle();
+  *op_request.mutable_gather_request() = request;
+  AddOpMetadata(&op_request);
+  OpResponse response;
+
+  VLOG(2) << "making gather request";
+  Status s = client_->stub()->Op(&op_request, &response);
+  return ParseOpResponse(s, &response);
+}
+
 ComputationDataHandle ComputationBuilder::ConcatInDim(
     tensorflow::gtl::ArraySlice<ComputationDataHandle> operands,
     int64 dimension) {
@@ -249,6 +249,20 @@ class ComputationBuilder {
       const ComputationDataHandle& operand, const ComputationDataHandle& update,
       const ComputationDataHandle& start_indices);
 
+  // Enqueues a gather instruction onto the computation: gathers the slices of
+  // 'operand' along dimension 0 at the positions given by the elements of the
+  // integral array 'indices'. The result has the dimensions of 'indices'
+  // followed by the dimensions of 'operand' other than the first, e.g.
+  //
+  //   [1 2]
+  //   [3 4]     indices = {2, 0}  =>  [5 6]
+  //   [5 6]                           [1 2]
+  //
+  // Indices are clamped to [0, operand dimension 0 size - 1] to prevent them
+  // from generating out-of-bound array accesses.
+  ComputationDataHandle Gather(const ComputationDataHandle& operand,
+                               const ComputationDataHandle& indices);
+
   // Enqueues a concatenate instruction onto the computation. 'operands' must
   // have >= 1 entry.
   ComputationDataHandle ConcatInDim(
@@ -67,6 +67,24 @@ bool ExecutableBuildOptions::has_hybrid_result() const {
   return has_hybrid_result_;
 }
 
+ExecutableBuildOptions& ExecutableBuildOptions::set_hlo_profiling(
+    bool hlo_profiling) {
+  hlo_profiling_ = hlo_profiling;
+  return *this;
+}
+
+bool ExecutableBuildOptions::hlo_profiling() const { return hlo_profiling_; }
+
+ExecutableBuildOptions& ExecutableBuildOptions::set_debug_options(
+    const DebugOptions& debug_options) {
+  debug_options_ = debug_options;
+  return *this;
+}
+
+const DebugOptions& ExecutableBuildOptions::debug_options() const {
+  return debug_options_;
+}
+
 namespace {
 StatusOr<Backend::StreamPtr> BorrowStreamForDevice(int device_ordinal,
                                                    Backend* backend) {
@@ -202,6 +220,30 @@ StatusOr<std::unique_ptr<ShapedBuffer>> LocalExecutable::Run(
       &service_options, options.execution_profile(), arguments);
 }
 
+StatusOr<std::unique_ptr<ShapedBuffer>> LocalExecutable::RunAsync(
+    const tensorflow::gtl::ArraySlice<const ShapedBuffer*> arguments,
+    const ExecutableRunOptions& options) {
+  if (options.stream() == nullptr) {
+    return InvalidArgument("a stream must be provided to RunAsync");
+  }
+  if (options.execution_profile() != nullptr) {
+    return InvalidArgument(
+        "execution profiles can't be collected by RunAsync, which doesn't "
+        "wait for the computation to complete");
+  }
+  TF_RETURN_IF_ERROR(ValidateExecutionOptions(arguments, options, *backend_));
+
+  ServiceExecutableRunOptions service_options(
+      options, backend_->StreamBorrower(),
+      backend_->eigen_intra_op_thread_pool());
+
+  if (executable_->dumping()) {
+    return ExecuteAndDump(&service_options, arguments);
+  }
+  return executable_->ExecuteOnStream(&service_options, arguments,
+                                      /*hlo_execution_profile=*/nullptr);
+}
+
 StatusOr<std::unique_ptr<ShapedBuffer>> LocalExecutable::ExecuteAndDump(
     const ServiceExecutableRunOptions* run_options,
     const tensorflow::gtl::ArraySlice<const ShapedBuffer*> arguments) {
@@ -292,7 +334,9 @@ StatusOr<std::unique_ptr<LocalExecutable>> LocalClient::Compile(
       std::unique_ptr<Executable> executable,
       local_service_->CompileExecutable(computation.handle(), argument_layouts,
                                         options.result_layout(), device_ordinal,
-                                        options.has_hybrid_result()));
+                                        options.has_hybrid_result(),
+                                        options.hlo_profiling(),
+                                        options.debug_options()));
   return WrapUnique(new LocalExecutable(std::move(executable),
                                         local_service_->mutable_backend(),
                                         device_ordinal, options));
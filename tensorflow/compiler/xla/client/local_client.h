@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/local_service.h"
 #include "tensorflow/compiler/xla/service/shaped_buffer.h"
 #include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -67,12 +68,23 @@ class ExecutableBuildOptions {
   ExecutableBuildOptions& set_has_hybrid_result(bool has_hybrid_result);
   bool has_hybrid_result() const;
 
+  // If set, the executable is instrumented to collect per-HLO cycle counts,
+  // which are written to the HloExecutionProfile of its ExecutableRunOptions.
+  ExecutableBuildOptions& set_hlo_profiling(bool hlo_profiling);
+  bool hlo_profiling() const;
+
+  // The debug options the HLO module of the executable is compiled with.
+  ExecutableBuildOptions& set_debug_options(const DebugOptions& debug_options);
+  const DebugOptions& debug_options() const;
+
  private:
   perftools::gputools::Platform* platform_ = nullptr;
   int device_ordinal_ = -1;
   Shape result_layout_;
   bool result_layout_set_ = false;
   bool has_hybrid_result_ = true;
+  bool hlo_profiling_ = false;
+  DebugOptions debug_options_;
 };
 
 class LocalExecutable {
@@ -83,6 +95,19 @@ class LocalExecutable {
       const tensorflow::gtl::ArraySlice<const ShapedBuffer*> arguments,
       const ExecutableRunOptions& options);
 
+  // Like Run, but returns as soon as the computation is enqueued on
+  // options.stream(), which must be set, without waiting for it to complete.
+  // The result is available once the stream has executed the computation.
+  // Arguments may still be being transferred on the stream, e.g. by
+  // TransferManager::TransferLiteralsToDeviceAsync. Execution profiles are
+  // not supported. Backends which run computations on the host thread, such
+  // as the CPU backend, wait for the stream and run synchronously; on GPU, the
+  // kernels are launched without waiting if the allocator allows asynchronous
+  // deallocation.
+  StatusOr<std::unique_ptr<ShapedBuffer>> RunAsync(
+      const tensorflow::gtl::ArraySlice<const ShapedBuffer*> arguments,
+      const ExecutableRunOptions& options);
+
   // Return the layout (contained in a shape) of the result produced by the
   // computation.
   const Shape& result_layout() const {
@@ -41,6 +41,7 @@ namespace xla {
 
 class DeviceMemoryAllocator;
 class ExecutionProfile;
+class HloExecutionProfile;
 
 // Class containing options for running a LocalExecutable.
 class ExecutableRunOptions {
@@ -79,6 +80,12 @@ class ExecutableRunOptions {
   ExecutionProfile* execution_profile() const;
   ExecutableRunOptions& set_execution_profile(ExecutionProfile* profile);
 
+  // If set, and the executable was built with HLO profiling enabled, the
+  // cycles taken by each HLO instruction are written to 'profile'.
+  HloExecutionProfile* hlo_execution_profile() const;
+  ExecutableRunOptions& set_hlo_execution_profile(
+      HloExecutionProfile* profile);
+
  private:
   DeviceMemoryAllocator* allocator_ = nullptr;
   int device_ordinal_ = -1;
@@ -86,6 +93,7 @@ class ExecutableRunOptions {
   tensorflow::thread::ThreadPool* inter_op_thread_pool_ = nullptr;
   const Eigen::ThreadPoolDevice* intra_op_thread_pool_ = nullptr;
   ExecutionProfile* execution_profile_ = nullptr;
+  HloExecutionProfile* hlo_execution_profile_ = nullptr;
 };
 
 }  // namespace xla
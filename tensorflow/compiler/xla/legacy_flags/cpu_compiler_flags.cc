@@ -41,6 +41,7 @@ static void AllocateFlags() {
   flags->xla_cpu_embed_ir = false;
   flags->xla_cpu_parallel = false;
   flags->xla_cpu_dump_debug_json_to = "";
+  flags->xla_cpu_llvm_compile_threads = 0;
   flag_list = new std::vector<tensorflow::Flag>({
       tensorflow::Flag(
           "xla_cpu_llvm_opt_level", &flags->xla_cpu_llvm_opt_level,
@@ -57,6 +58,12 @@ static void AllocateFlags() {
       tensorflow::Flag("xla_cpu_dump_debug_json_to",
                        &flags->xla_cpu_dump_debug_json_to,
                        "Dump debug JSON to this directory."),
+      tensorflow::Flag(
+          "xla_cpu_llvm_compile_threads", &flags->xla_cpu_llvm_compile_threads,
+          "The number of threads the externally visible functions, e.g. "
+          "those of --xla_cpu_parallel, are split across to be compiled in "
+          "parallel. 0 means one thread per core, 1 compiles them in a single "
+          "LLVM module."),
   });
   ParseFlagsFromEnv(*flag_list);
 }
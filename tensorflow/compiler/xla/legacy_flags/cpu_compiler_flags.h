@@ -42,6 +42,8 @@ typedef struct {
                           // CpuExecutable
   bool xla_cpu_parallel;  // Use the multi-threaded CPU backend.
   string xla_cpu_dump_debug_json_to;  // Dump debug JSON to this directory.
+  int32 xla_cpu_llvm_compile_threads;  // The number of threads compiling the
+                                       // functions; 0 means one per core.
 } CpuCompilerFlags;
 
 // Return a pointer to the CpuCompilerFlags struct;
@@ -37,6 +37,12 @@ static void AllocateFlags() {
   flags = new CpuRuntimeFlags;
   flags->xla_cpu_use_eigen = true;
   flags->xla_cpu_multi_thread_eigen = true;
+  flags->xla_cpu_use_mkl = true;
+  // A 64x64x64 dot. The tiled loops run on one thread while Eigen splits the
+  // larger products over the intra-op threads, so the loops only pay off
+  // where the saved call and the fused epilogue outweigh the parallelism.
+  flags->xla_cpu_max_llvm_ir_gemm_size = 64 * 64 * 64;
+  flags->xla_cpu_infeed_capacity = 0;
   flag_list = new std::vector<tensorflow::Flag>({
       tensorflow::Flag(
           "xla_cpu_use_eigen", &flags->xla_cpu_use_eigen,
@@ -48,6 +54,25 @@ static void AllocateFlags() {
           "When generating calls to Eigen for matmul and conv, should "
           "single or multi-threaded eigen be used? "
           "Only used when --xla_cpu_use_eigen is true."),
+      tensorflow::Flag(
+          "xla_cpu_use_mkl", &flags->xla_cpu_use_mkl,
+          "Call MKL instead of Eigen for the matrix multiplications that "
+          "aren't emitted in LLVM IR, when XLA is built with MKL. Without "
+          "MKL, the calls go to Eigen regardless."),
+      tensorflow::Flag(
+          "xla_cpu_max_llvm_ir_gemm_size",
+          &flags->xla_cpu_max_llvm_ir_gemm_size,
+          "Matrix multiplications of at most this many multiply-adds (m*n*k) "
+          "are emitted as tiled loops in LLVM IR, which can be fused with "
+          "their elementwise consumers, instead of calls to Eigen. The loops "
+          "are single-threaded, so raising this mostly helps on one core. 0 "
+          "disables the tiled loops."),
+      tensorflow::Flag(
+          "xla_cpu_infeed_capacity", &flags->xla_cpu_infeed_capacity,
+          "The maximum number of buffers waiting in the infeed queue: "
+          "enqueuing more blocks until the computation dequeues one, so that "
+          "the host prepares at most this many buffers ahead. 0 leaves the "
+          "queue unbounded."),
   });
   ParseFlagsFromEnv(*flag_list);
 }
@@ -38,6 +38,17 @@ typedef struct {
   // When generating calls to Eigen for matmul and conv, should single or
   // multi-threaded eigen be used?  Only used when --xla_cpu_use_eigen is true.
   bool xla_cpu_multi_thread_eigen;
+  // Call MKL instead of Eigen for the matrix multiplications that aren't
+  // emitted in LLVM IR, when XLA is built with MKL.
+  bool xla_cpu_use_mkl;
+  // The matrix multiplications of at most this many multiply-adds are emitted
+  // as tiled loops in LLVM IR, which can be fused with their elementwise
+  // consumers, instead of calls to Eigen. The loops are single-threaded. 0
+  // disables the tiled loops.
+  tensorflow::int64 xla_cpu_max_llvm_ir_gemm_size;
+  // The maximum number of buffers waiting in the infeed queue: enqueuing more
+  // blocks until the computation dequeues one. 0 leaves the queue unbounded.
+  tensorflow::int64 xla_cpu_infeed_capacity;
 } CpuRuntimeFlags;
 
 // Return a pointer to the CpuRuntimeFlags struct;
@@ -39,6 +39,9 @@ static void AllocateFlags() {
   flags->xla_gpu_embed_ir = false;
   flags->xla_cuda_data_dir = "./cuda_sdk_lib";
   flags->xla_gpu_dump_debug_json_to = "";
+  flags->xla_gpu_llvm_compile_threads = 0;
+  flags->xla_gpu_memory_limit_bytes = 0;
+  flags->xla_gpu_max_recompute_flops_per_byte = 4;
   flag_list = new std::vector<tensorflow::Flag>({
       tensorflow::Flag(
           "xla_gpu_embed_ir", &flags->xla_gpu_embed_ir,
@@ -53,6 +56,22 @@ static void AllocateFlags() {
       tensorflow::Flag("xla_gpu_dump_debug_json_to",
                        &flags->xla_gpu_dump_debug_json_to,
                        "Dump debug JSON to this directory."),
+      tensorflow::Flag(
+          "xla_gpu_llvm_compile_threads", &flags->xla_gpu_llvm_compile_threads,
+          "The number of threads the kernels are split across to be compiled "
+          "to PTX in parallel. 0 means one thread per core, 1 compiles them "
+          "in a single LLVM module."),
+      tensorflow::Flag(
+          "xla_gpu_memory_limit_bytes", &flags->xla_gpu_memory_limit_bytes,
+          "If positive, HLO instructions are rematerialized to keep the peak "
+          "memory use of the computation below this many bytes. 0 disables "
+          "rematerialization."),
+      tensorflow::Flag(
+          "xla_gpu_max_recompute_flops_per_byte",
+          &flags->xla_gpu_max_recompute_flops_per_byte,
+          "Instructions whose recompute costs more flops per byte of memory "
+          "saved, such as dots and convolutions, are never rematerialized. "
+          "Negative means no limit."),
   });
   ParseFlagsFromEnv(*flag_list);
 }
@@ -42,6 +42,16 @@ typedef struct {
   string xla_ptxas_path;     // The path to ptxas.  Required to log stats of
                              // the ptx.
   string xla_gpu_dump_debug_json_to;  // Dump debug JSON to this directory.
+  int32 xla_gpu_llvm_compile_threads;  // The number of threads compiling the
+                                       // kernels to PTX; 0 means one per core.
+  int64 xla_gpu_memory_limit_bytes;  // If positive, rematerialize HLO
+                                     // instructions to keep peak memory use
+                                     // below this many bytes.
+  int64 xla_gpu_max_recompute_flops_per_byte;  // The most flops per byte of
+                                               // memory saved which
+                                               // rematerialization may
+                                               // recompute; negative means no
+                                               // limit.
 } GpuCompilerFlags;
 
 // Return a pointer to the GpuCompilerFlags struct;
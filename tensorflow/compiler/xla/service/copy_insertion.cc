@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 
@@ -40,6 +41,110 @@ namespace {
 using tensorflow::gtl::FlatMap;
 using tensorflow::gtl::FlatSet;
 
+auto* copied_bytes = tensorflow::monitoring::Counter<0>::New(
+    "/tensorflow/compiler/xla/copy_insertion/copied_bytes",
+    "The number of bytes copied by one execution of each copy inserted by "
+    "copy insertion, e.g. by one iteration of a while body.");
+
+// Returns the bytes copied by a deep copy of a value of shape 'shape'.
+int64 CopiedBytes(const Shape& shape) {
+  int64 bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      shape, [&bytes](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (!ShapeUtil::IsTuple(subshape)) {
+          bytes += ShapeUtil::ByteSizeOf(subshape);
+        }
+      });
+  return bytes;
+}
+
+// Returns the operand of 'instruction' which it updates in place, if it is a
+// DynamicUpdateSlice, or a loop fusion whose root is a DynamicUpdateSlice of
+// a fused parameter used nowhere else. Returns nullptr otherwise.
+HloInstruction* GetInPlaceUpdatedOperand(HloInstruction* instruction) {
+  if (instruction->opcode() == HloOpcode::kDynamicUpdateSlice) {
+    return instruction->mutable_operand(0);
+  }
+  if (instruction->opcode() != HloOpcode::kFusion ||
+      instruction->fusion_kind() != HloInstruction::FusionKind::kLoop) {
+    return nullptr;
+  }
+  const HloInstruction* root = instruction->fused_expression_root();
+  if (root->opcode() != HloOpcode::kDynamicUpdateSlice) {
+    return nullptr;
+  }
+  const HloInstruction* fused_operand = root->operand(0);
+  if (fused_operand->opcode() != HloOpcode::kParameter ||
+      fused_operand->user_count() != 1 ||
+      root->OperandIndices(fused_operand).size() != 1) {
+    return nullptr;
+  }
+  HloInstruction* operand =
+      instruction->mutable_operand(fused_operand->parameter_number());
+  return instruction->OperandIndices(operand).size() == 1 ? operand : nullptr;
+}
+
+// Adds control dependencies to the while body 'body', so that the other
+// readers of each loop state element which an instruction updates in place
+// execute before the update. Liveness then lets the update share the buffer
+// of the loop state across iterations, instead of needing a copy of it at the
+// body root. Elements with readers depending on the update, or reached through
+// aliases such as bitcasts, are left alone. Returns whether 'body' changed.
+StatusOr<bool> OrderReadsBeforeInPlaceUpdates(HloComputation* body) {
+  HloInstruction* root = body->root_instruction();
+  HloInstruction* loop_state = body->parameter_instruction(0);
+  if (root->opcode() != HloOpcode::kTuple) {
+    return false;
+  }
+  bool changed = false;
+  std::unique_ptr<HloComputation::ReachabilityMap> reachability =
+      body->ComputeTransitiveOperands();
+  for (int64 i = 0; i < root->operand_count(); ++i) {
+    HloInstruction* update = root->mutable_operand(i);
+    HloInstruction* updated = GetInPlaceUpdatedOperand(update);
+    if (updated == nullptr ||
+        updated->opcode() != HloOpcode::kGetTupleElement ||
+        updated->operand(0) != loop_state || updated->tuple_index() != i) {
+      continue;
+    }
+    std::vector<HloInstruction*> readers;
+    bool can_order = true;
+    for (HloInstruction* element : loop_state->users()) {
+      if (element->opcode() != HloOpcode::kGetTupleElement) {
+        // The whole loop state escapes, possibly to readers of element 'i'.
+        can_order = false;
+        break;
+      }
+      if (element->tuple_index() != i) {
+        continue;
+      }
+      for (HloInstruction* reader : element->users()) {
+        if (reader == update || reachability->IsReachable(update, reader)) {
+          continue;
+        }
+        if (reader->opcode() == HloOpcode::kBitcast ||
+            reader->opcode() == HloOpcode::kTuple ||
+            reachability->IsReachable(reader, update)) {
+          can_order = false;
+          break;
+        }
+        readers.push_back(reader);
+      }
+    }
+    if (!can_order || readers.empty()) {
+      continue;
+    }
+    for (HloInstruction* reader : readers) {
+      VLOG(2) << "Ordering " << reader->name() << " before the in-place update "
+              << update->name() << " of loop state element " << i;
+      TF_RETURN_IF_ERROR(reader->AddControlDependencyTo(update));
+    }
+    reachability = body->ComputeTransitiveOperands();
+    changed = true;
+  }
+  return changed;
+}
+
 // InstructionCopier encapsulates indices at which to copy 'instruction'.
 // All 'instruction' users in 'copy_users' are updated to use the copy.
 //
@@ -521,6 +626,7 @@ StatusOr<HloInstruction*> CopyInsertion::FindOrInsertCopy(HloInstruction* hlo) {
   if (copy_it == inserted_copies_.end()) {
     HloInstruction* copy = hlo->parent()->DeepCopyInstruction(hlo).ValueOrDie();
     inserted_copies_.insert({hlo, copy});
+    copied_bytes->GetCell()->IncrementBy(CopiedBytes(hlo->shape()));
     return copy;
   } else {
     return copy_it->second;
@@ -531,25 +637,35 @@ StatusOr<bool> CopyInsertion::Run(HloModule* module) {
   bool changed = false;
   VLOG(2) << "CopyInsertion for module " << module->name();
 
-  TF_ASSIGN_OR_RETURN(
-      std::unique_ptr<BufferLiveness> liveness,
-      BufferLiveness::Run(module, MakeUnique<DependencyHloOrdering>(module)));
-  const auto& points_to_analysis = liveness->points_to_analysis();
-  XLA_VLOG_LINES(2, points_to_analysis.ToString());
-  XLA_VLOG_LINES(2, module->ToString());
-
-  // Gather all while body computations and while instructions.
+  // Gather all while body computations and while instructions, as well as the
+  // copies which are already there.
   FlatSet<const HloComputation*> while_body_computations;
   std::vector<HloInstruction*> while_instructions;
+  FlatSet<const HloInstruction*> existing_copies;
   for (auto& computation : module->computations()) {
     for (auto& instruction : computation->instructions()) {
       if (instruction->opcode() == HloOpcode::kWhile) {
         while_body_computations.insert(instruction->while_body());
         while_instructions.push_back(instruction.get());
+      } else if (instruction->opcode() == HloOpcode::kCopy) {
+        existing_copies.insert(instruction.get());
       }
     }
   }
 
+  for (HloInstruction* while_hlo : while_instructions) {
+    TF_ASSIGN_OR_RETURN(
+        bool ordered, OrderReadsBeforeInPlaceUpdates(while_hlo->while_body()));
+    changed |= ordered;
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<BufferLiveness> liveness,
+      BufferLiveness::Run(module, MakeUnique<DependencyHloOrdering>(module)));
+  const auto& points_to_analysis = liveness->points_to_analysis();
+  XLA_VLOG_LINES(2, points_to_analysis.ToString());
+  XLA_VLOG_LINES(2, module->ToString());
+
   // Collect instruction buffer indices to copy in 'instructions_to_copy'.
   std::vector<InstructionCopier> instructions_to_copy;
 
@@ -627,6 +743,19 @@ StatusOr<bool> CopyInsertion::Run(HloModule* module) {
     }
   }
 
+  int64 module_copied_bytes = 0;
+  for (auto& computation : module->computations()) {
+    for (auto& instruction : computation->instructions()) {
+      if (instruction->opcode() == HloOpcode::kCopy &&
+          existing_copies.count(instruction.get()) == 0) {
+        module_copied_bytes += CopiedBytes(instruction->shape());
+      }
+    }
+  }
+  VLOG(1) << "Copies inserted in module " << module->name() << " copy "
+          << module_copied_bytes << " bytes";
+  copied_bytes->GetCell()->IncrementBy(module_copied_bytes);
+
   VLOG(3) << "After copy insertion for module " << module->name();
   XLA_VLOG_LINES(3, module->ToString());
 
@@ -567,6 +567,61 @@ class WhileCopyInsertionTest : public CopyInsertionTest {
     return builder.Build();
   }
 
+  // Builds a While body computation which updates tuple element 1 in place,
+  // while another tuple element reads its value from before the update.
+  // EX:
+  // Body({in0, in1, in2})
+  //   out0 = Add(in0, 1)
+  //   out1 = DynamicUpdateSlice(in1, {1, 1}, Reshape(in0))
+  //   out2 = Add(in2, in1)           // Or Add(out1, in1) if 'dependent'.
+  //   Tuple(out0, out1, out2)
+  std::unique_ptr<HloComputation> BuildInPlaceUpdateBodyComputation(
+      bool dependent) {
+    auto builder = HloComputation::Builder(TestName() + ".Body");
+    auto loop_state = builder.AddInstruction(HloInstruction::CreateParameter(
+        0, in_place_loop_state_shape_, "loop_state"));
+    auto induction_variable =
+        builder.AddInstruction(HloInstruction::CreateGetTupleElement(
+            induction_variable_shape_, loop_state, 0));
+    auto inc = builder.AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::CreateR0<int32>(1)));
+    auto add0 = builder.AddInstruction(HloInstruction::CreateBinary(
+        induction_variable->shape(), HloOpcode::kAdd, induction_variable, inc));
+    auto data = builder.AddInstruction(
+        HloInstruction::CreateGetTupleElement(data_shape_, loop_state, 1));
+    auto update = builder.AddInstruction(HloInstruction::CreateConstant(
+        LiteralUtil::CreateR1<float>({1.f, 1.f})));
+    auto starts = builder.AddInstruction(HloInstruction::CreateReshape(
+        ShapeUtil::MakeShape(S32, {1}), induction_variable));
+    auto dus = builder.AddInstruction(HloInstruction::CreateDynamicUpdateSlice(
+        data_shape_, data, update, starts));
+    auto sum = builder.AddInstruction(
+        HloInstruction::CreateGetTupleElement(data_shape_, loop_state, 2));
+    auto add2 = builder.AddInstruction(HloInstruction::CreateBinary(
+        data_shape_, HloOpcode::kAdd, dependent ? dus : sum, data));
+    builder.AddInstruction(HloInstruction::CreateTuple({add0, dus, add2}));
+    return builder.Build();
+  }
+
+  // Builds a While instruction using 'condition' and 'body' sub-computations,
+  // whose loop state has the shape 'in_place_loop_state_shape_'.
+  HloInstruction* BuildInPlaceUpdateWhileInstruction(HloComputation* condition,
+                                                     HloComputation* body) {
+    auto builder = HloComputation::Builder(TestName() + ".While");
+    auto induction_var_init = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, induction_variable_shape_, "iter"));
+    auto data_init = builder.AddInstruction(
+        HloInstruction::CreateParameter(1, data_shape_, "data"));
+    auto sum_init = builder.AddInstruction(
+        HloInstruction::CreateParameter(2, data_shape_, "sum"));
+    auto loop_state_init = builder.AddInstruction(HloInstruction::CreateTuple(
+        {induction_var_init, data_init, sum_init}));
+    auto while_hlo = builder.AddInstruction(HloInstruction::CreateWhile(
+        in_place_loop_state_shape_, condition, body, loop_state_init));
+    module_.AddEntryComputation(builder.Build());
+    return while_hlo;
+  }
+
   // Builds a While instruction using 'condition' and 'body' sub-computations.
   // Init operand is initialized to zeros of appropriate shape.
   HloInstruction* BuildWhileInstruction(HloComputation* condition,
@@ -699,6 +754,8 @@ class WhileCopyInsertionTest : public CopyInsertionTest {
       ShapeUtil::MakeTupleShape({data_shape_, data_shape_});
   Shape nested_loop_state_shape_ = ShapeUtil::MakeTupleShape(
       {induction_variable_shape_, nested_tuple_shape_});
+  Shape in_place_loop_state_shape_ = ShapeUtil::MakeTupleShape(
+      {induction_variable_shape_, data_shape_, data_shape_});
   Shape condition_result_shape_ = ShapeUtil::MakeShape(PRED, {});
 };
 
@@ -1116,5 +1173,65 @@ TEST_F(WhileCopyInsertionTest, InitPointsToNonDistinctUsedByTwoWhileLoops) {
   EXPECT_TRUE(points_to2.IsDistinct());
 }
 
+// Tests while body computation with an in-place update of tuple element 1,
+// whose previous value is read by an independent tuple element:
+//
+//   While.Body({in0, in1, in2})
+//     out0 = Add(in0, 1)
+//     out1 = DynamicUpdateSlice(in1, {1, 1}, Reshape(in0))
+//     out2 = Add(in2, in1)
+//     Tuple(out0, out1, out2)
+//
+// CopyInsertion pass should order 'out2' before 'out1' instead of copying
+// 'out1', and convert the root instruction to:
+//
+//     Tuple(Copy(out0), out1, out2)
+//
+TEST_F(WhileCopyInsertionTest, InPlaceUpdateOrdersReadsBeforeUpdate) {
+  auto condition = module_.AddEmbeddedComputation(BuildConditionComputation());
+  auto body = module_.AddEmbeddedComputation(
+      BuildInPlaceUpdateBodyComputation(/*dependent=*/false));
+  BuildInPlaceUpdateWhileInstruction(condition, body);
+
+  HloInstruction* old_root = body->root_instruction();
+  HloInstruction* dus = old_root->mutable_operand(1);
+  HloInstruction* add2 = old_root->mutable_operand(2);
+  InsertCopies(&module_);
+
+  EXPECT_THAT(body->root_instruction(),
+              op::Tuple(op::Copy(old_root->operand(0)), dus, add2));
+  EXPECT_THAT(dus->control_predecessors(), UnorderedElementsAre(add2));
+}
+
+// Tests while body computation with an in-place update of tuple element 1,
+// whose previous value is read by an instruction which depends on the update:
+//
+//   While.Body({in0, in1, in2})
+//     out0 = Add(in0, 1)
+//     out1 = DynamicUpdateSlice(in1, {1, 1}, Reshape(in0))
+//     out2 = Add(out1, in1)
+//     Tuple(out0, out1, out2)
+//
+// CopyInsertion pass can't order the read before the update, and should
+// convert the root instruction to:
+//
+//     Tuple(Copy(out0), Copy(out1), out2)
+//
+TEST_F(WhileCopyInsertionTest, InPlaceUpdateWithDependentRead) {
+  auto condition = module_.AddEmbeddedComputation(BuildConditionComputation());
+  auto body = module_.AddEmbeddedComputation(
+      BuildInPlaceUpdateBodyComputation(/*dependent=*/true));
+  BuildInPlaceUpdateWhileInstruction(condition, body);
+
+  HloInstruction* old_root = body->root_instruction();
+  HloInstruction* dus = old_root->mutable_operand(1);
+  InsertCopies(&module_);
+
+  EXPECT_THAT(body->root_instruction(),
+              op::Tuple(op::Copy(old_root->operand(0)), op::Copy(dus),
+                        old_root->operand(2)));
+  EXPECT_TRUE(dus->control_predecessors().empty());
+}
+
 }  // namespace
 }  // namespace xla
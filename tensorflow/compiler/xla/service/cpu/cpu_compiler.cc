@@ -18,6 +18,7 @@ limitations under the License.
 #include <stddef.h>
 #include <string.h>
 #include <map>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -55,6 +56,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/layout_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
@@ -81,6 +83,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace se = ::perftools::gputools;
 
@@ -304,6 +307,14 @@ llvm::CodeGenOpt::Level CodeGenOptLevel() {
   }
 }
 
+// Returns the maximum number of threads a module is compiled on.
+int CompileThreads() {
+  legacy_flags::CpuCompilerFlags* flags = legacy_flags::GetCpuCompilerFlags();
+  return flags->xla_cpu_llvm_compile_threads > 0
+             ? flags->xla_cpu_llvm_compile_threads
+             : tensorflow::port::NumSchedulableCPUs();
+}
+
 }  // namespace
 
 StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
@@ -316,7 +327,7 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
   auto llvm_module =
       MakeUnique<llvm::Module>("__compute_module", *llvm_context);
   auto jit = MakeUnique<SimpleOrcJIT>(CompilerTargetOptions(module->config()),
-                                      CodeGenOptLevel());
+                                      CodeGenOptLevel(), CompileThreads());
   llvm_module->setDataLayout(jit->data_layout());
   llvm_module->setTargetTriple(jit->target_triple().getTriple());
 
@@ -382,9 +393,18 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
     }
 
     IrEmitter ir_emitter(*module, *assignment, llvm_module.get(),
-                         &hlo_to_profile_idx);
+                         &hlo_to_profile_idx, jit->target_machine());
     std::unique_ptr<std::map<HloInstruction*, string>> function_names(
         new std::map<HloInstruction*, string>());
+    // Partitioning the computations into tasks is disabled when profiling, as
+    // the tasks of a computation would update its profile counters
+    // concurrently.
+    ParallelTaskAssignment task_assignment(
+        CpuExecutable::ShapeSizeBytes,
+        /*max_parallelism=*/hlo_to_profile_idx.empty()
+            ? tensorflow::port::NumSchedulableCPUs()
+            : 1);
+    std::map<HloInstruction*, int64> task_counts;
     for (auto embedded_computation :
          computation->MakeEmbeddedComputationsList()) {
       auto parallel_computation_iter =
@@ -393,12 +413,26 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
       // IR generation purposes.
       bool computation_is_parallel =
           parallel_computation_iter != parallel_computations.end();
-      TF_ASSIGN_OR_RETURN(
-          llvm::Function * ir_function,
-          ir_emitter.EmitComputation(
-              embedded_computation, embedded_computation->name(),
-              /*is_entry_computation=*/computation_is_parallel,
-              /*instruction_order=*/nullptr));
+      int64 task_count = 1;
+      if (computation_is_parallel) {
+        TF_ASSIGN_OR_RETURN(
+            task_count,
+            task_assignment.GetTargetTaskCount(*embedded_computation));
+      }
+      llvm::Function* ir_function;
+      if (task_count > 1) {
+        TF_ASSIGN_OR_RETURN(ir_function,
+                            ir_emitter.EmitPartitionedComputation(
+                                embedded_computation,
+                                embedded_computation->name()));
+      } else {
+        TF_ASSIGN_OR_RETURN(
+            ir_function,
+            ir_emitter.EmitComputation(
+                embedded_computation, embedded_computation->name(),
+                /*is_entry_computation=*/computation_is_parallel,
+                /*instruction_order=*/nullptr));
+      }
       // If this computation is parallel, remember it in the function name map.
       // This way we know what function to execute when we try to run code for
       // the Call instruction.
@@ -406,6 +440,9 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
         HloInstruction* call_instruction = parallel_computation_iter->second;
         InsertOrDie(function_names.get(), call_instruction,
                     llvm_ir::AsString(ir_function->getName()));
+        if (task_count > 1) {
+          InsertOrDie(&task_counts, call_instruction, task_count);
+        }
       }
     }
 
@@ -418,8 +455,8 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
     jit->AddModule(std::move(llvm_module));
     cpu_executable.reset(new ParallelCpuExecutable(
         std::move(jit), std::move(assignment), std::move(module),
-        std::move(function_names), std::move(hlo_to_profile_idx),
-        std::move(aligned_constants)));
+        std::move(function_names), std::move(task_counts),
+        std::move(hlo_to_profile_idx), std::move(aligned_constants)));
 
     if (flags->xla_cpu_embed_ir) {
       static_cast<CpuExecutable&>(*cpu_executable)
@@ -453,7 +490,7 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
     // GetEmbeddedComputations guarantees that a called computation occurs
     // before a caller computation.
     IrEmitter ir_emitter(*module, *assignment, llvm_module.get(),
-                         &hlo_to_profile_idx);
+                         &hlo_to_profile_idx, jit->target_machine());
     for (auto embedded_computation :
          computation->MakeEmbeddedComputationsList()) {
       TF_RETURN_IF_ERROR(
@@ -590,6 +627,19 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
 
     TF_RETURN_IF_ERROR(RunHloPasses(module, dump_hlo));
 
+    // The entry computation is emitted as a single function, so the
+    // instructions whose loops are split across threads are outlined into
+    // functions of their own, called once per task.
+    ParallelTaskAssignment task_assignment(ShapeSizeBytesFunction(),
+                                           options.max_parallelism());
+    std::map<HloInstruction*, int64> task_counts;
+    TF_ASSIGN_OR_RETURN(task_counts,
+                        task_assignment.OutlinePartitionedInstructions(module));
+    std::set<const HloComputation*> partitioned_computations;
+    for (const auto& call_and_task_count : task_counts) {
+      partitioned_computations.insert(call_and_task_count.first->to_apply());
+    }
+
     TF_ASSIGN_OR_RETURN(
         SequentialHloOrdering::HloModuleSequence module_sequence,
         CreateMemoryMinimizingSequence(*module, BufferSizeBytesFunction()));
@@ -610,10 +660,22 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
     }
 
     IrEmitter ir_emitter(*module, *assignment, &llvm_module,
-                         /*hlo_to_profile_idx=*/nullptr);
+                         /*hlo_to_profile_idx=*/nullptr, target_machine.get());
+    ir_emitter.set_parallel_task_counts(
+        std::map<const HloInstruction*, int64>(task_counts.begin(),
+                                               task_counts.end()));
     HloComputation* computation = module->entry_computation();
     for (auto embedded_computation :
          computation->MakeEmbeddedComputationsList()) {
+      if (partitioned_computations.count(embedded_computation) > 0) {
+        TF_ASSIGN_OR_RETURN(llvm::Function * partitioned_function,
+                            ir_emitter.EmitPartitionedComputation(
+                                embedded_computation,
+                                embedded_computation->name()));
+        // The function is only called through the runtime, from this module.
+        partitioned_function->setLinkage(llvm::GlobalValue::InternalLinkage);
+        continue;
+      }
       TF_RETURN_IF_ERROR(
           ir_emitter
               .EmitComputation(embedded_computation,
@@ -67,6 +67,14 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const string& entry_point_name() const { return entry_point_name_; }
   // The relocation model used for compilation.
   RelocationModel relocation_model() const { return relocation_model_; }
+  // The number of threads the loops of the compiled code may be split across.
+  // The loops run in the intra-op thread pool of the ExecutableRunOptions the
+  // code is run with. Defaults to 1: the code is single-threaded, except for
+  // the Eigen runtime functions, e.g. matrix multiplications.
+  int64 max_parallelism() const { return max_parallelism_; }
+  void set_max_parallelism(int64 max_parallelism) {
+    max_parallelism_ = max_parallelism;
+  }
 
  private:
   const string triple_;
@@ -74,6 +82,7 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const string features_;
   const string entry_point_name_;
   const RelocationModel relocation_model_;
+  int64 max_parallelism_ = 1;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
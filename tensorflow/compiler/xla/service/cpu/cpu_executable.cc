@@ -294,6 +294,11 @@ StatusOr<std::unique_ptr<ShapedBuffer>> CpuExecutable::ExecuteOnStream(
   }
 
   se::Stream* stream = run_options->stream();
+  // The computation runs on this thread rather than on the stream: wait for
+  // the transfers of its arguments that may have been enqueued on the stream.
+  if (!stream->BlockHostUntilDone()) {
+    return InternalError("failed to wait for the arguments to be transferred");
+  }
   DeviceMemoryAllocator* memory_allocator = run_options->allocator();
   std::vector<se::DeviceMemoryBase> buffers(assignment_->Allocations().size());
 
@@ -15,16 +15,43 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Returns true if the output of `producer`, a dot emitted as tiled loops, can
+// be fused into `consumer`: the loops then compute the elements of `consumer`
+// from the elements of the dot when storing them.
+bool CanBeOutputFused(const HloInstruction& producer,
+                      const HloInstruction& consumer, int64 operand_index) {
+  if (!PotentiallyImplementedAsTiledLlvmIrDot(producer) ||
+      producer.user_count() != 1 ||
+      !ShapeUtil::SameDimensions(producer.shape(), consumer.shape())) {
+    return false;
+  }
+  if (consumer.opcode() == HloOpcode::kFusion) {
+    // Loop fusions contain only elementwise operations on CPUs.
+    return consumer.fusion_kind() == HloInstruction::FusionKind::kLoop &&
+           consumer.IsElementwiseOnOperand(operand_index);
+  }
+  return consumer.IsElementwise() && consumer.opcode() != HloOpcode::kMap;
+}
+
+}  // namespace
+
 bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
                                       int64 operand_index) {
   HloInstruction* producer = consumer->mutable_operand(operand_index);
 
-  // Output fusion is not currently supported on CPUs.
+  // Output fusion is only supported for the dots emitted as tiled loops.
+  if (CanBeOutputFused(*producer, *consumer, operand_index)) {
+    return true;
+  }
   if (producer->opcode() == HloOpcode::kFusion) {
     return false;
   }
@@ -45,5 +72,13 @@ bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
          InstructionFusion::ShouldFuse(consumer, operand_index);
 }
 
+HloInstruction::FusionKind CpuInstructionFusion::ChooseKind(
+    const HloInstruction* producer, const HloInstruction* consumer) {
+  if (producer->opcode() == HloOpcode::kDot) {
+    return HloInstruction::FusionKind::kOutput;
+  }
+  return InstructionFusion::ChooseKind(producer, consumer);
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -29,6 +29,11 @@ InfeedManager* GetInfeedManager() {
   return manager;
 }
 
+InfeedManager* GetOutfeedManager() {
+  static InfeedManager* manager = new InfeedManager;
+  return manager;
+}
+
 }  // namespace runtime
 }  // namespace cpu
 }  // namespace xla
@@ -49,3 +54,20 @@ void __xla_cpu_runtime_ReleaseInfeedBufferAfterDequeue(xla::int32 buffer_length,
       xla::cpu::runtime::GetInfeedManager();
   infeed->ReleaseCurrentBuffer(buffer_length, buffer_ptr);
 }
+
+void* __xla_cpu_runtime_AcquireOutfeedBufferForPopulation(
+    xla::int32 buffer_length) {
+  xla::cpu::runtime::InfeedManager* outfeed =
+      xla::cpu::runtime::GetOutfeedManager();
+  // Wait until a client has enqueued a buffer to populate.
+  xla::cpu::runtime::InfeedBuffer* buffer = outfeed->BlockingDequeueBuffer();
+  CHECK_EQ(buffer->length(), buffer_length);
+  return buffer->data();
+}
+
+void __xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation(
+    xla::int32 buffer_length, void* buffer_ptr) {
+  xla::cpu::runtime::InfeedManager* outfeed =
+      xla::cpu::runtime::GetOutfeedManager();
+  outfeed->ReleaseCurrentBuffer(buffer_length, buffer_ptr);
+}
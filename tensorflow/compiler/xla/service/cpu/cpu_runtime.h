@@ -50,14 +50,30 @@ constexpr char kEigenSingleThreadedMatmulF64SymbolName[] =
     "__xla_cpu_runtime_EigenSingleThreadedMatMulF64";
 constexpr char kEigenSingleThreadedConvF32SymbolName[] =
     "__xla_cpu_runtime_EigenSingleThreadedConvF32";
+constexpr char kMKLMatmulF32SymbolName[] = "__xla_cpu_runtime_MKLMatMulF32";
+constexpr char kMKLMatmulF64SymbolName[] = "__xla_cpu_runtime_MKLMatMulF64";
+constexpr char kMKLSingleThreadedMatmulF32SymbolName[] =
+    "__xla_cpu_runtime_MKLSingleThreadedMatMulF32";
+constexpr char kMKLSingleThreadedMatmulF64SymbolName[] =
+    "__xla_cpu_runtime_MKLSingleThreadedMatMulF64";
+constexpr char kParallelForkJoinSymbolName[] =
+    "__xla_cpu_runtime_ParallelForkJoin";
 constexpr char kAcquireInfeedBufferForDequeueSymbolName[] =
     "__xla_cpu_runtime_AcquireInfeedBufferForDequeue";
 constexpr char kReleaseInfeedBufferAfterDequeueSymbolName[] =
     "__xla_cpu_runtime_ReleaseInfeedBufferAfterDequeue";
+constexpr char kAcquireOutfeedBufferForPopulationSymbolName[] =
+    "__xla_cpu_runtime_AcquireOutfeedBufferForPopulation";
+constexpr char kReleaseOutfeedBufferAfterPopulationSymbolName[] =
+    "__xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation";
 
 // Returns the infeed manager used by the CPU runtime.
 InfeedManager* GetInfeedManager();
 
+// Returns the manager of the outfeed queue used by the CPU runtime, to which
+// clients enqueue the buffers that receive the data outfed by computations.
+InfeedManager* GetOutfeedManager();
+
 }  // namespace runtime
 }  // namespace cpu
 }  // namespace xla
@@ -86,6 +102,19 @@ extern void* __xla_cpu_runtime_AcquireInfeedBufferForDequeue(
 // that can be returned out of order.
 extern void __xla_cpu_runtime_ReleaseInfeedBufferAfterDequeue(
     xla::int32 buffer_length, void* buffer_ptr);
+
+// Blocks until the next outfeed buffer is enqueued by a client, then returns
+// it for the compiled code to write the outfed data into. Fails
+// catastrophically if the buffer is not of the correct length in bytes.
+extern void* __xla_cpu_runtime_AcquireOutfeedBufferForPopulation(
+    xla::int32 buffer_length);
+
+// Relinquishes the outfeed buffer returned by
+// __xla_cpu_runtime_AcquireOutfeedBufferForPopulation once the compiled code
+// has written it, handing it back to the client. As for the infeed, there may
+// only be one outstanding outfeed buffer in use by the runtime.
+extern void __xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation(
+    xla::int32 buffer_length, void* buffer_ptr);
 }
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_RUNTIME_H_
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/client/local_client.h"
 #include "tensorflow/compiler/xla/ptr_util.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/common_runtime/eigen_thread_pool.h"
 #include "tensorflow/core/platform/env.h"
@@ -72,10 +73,17 @@ void CheckMatrixMultiply(const Array2D<float>& a, const Array2D<float>& b,
   }
 }
 
-std::unique_ptr<Array2D<float>> EigenMatrixMultiply(const Array2D<float>& a,
-                                                    const Array2D<float>& b,
-                                                    bool transpose_lhs,
-                                                    bool transpose_rhs) {
+// The signature of the F32 runtime matmul functions.
+using MatMulF32 = void (*)(const void* run_options_ptr, float* out, float* lhs,
+                           float* rhs, int64 m, int64 n, int64 k,
+                           int32 transpose_lhs, int32 transpose_rhs);
+
+// Multiplies 'a' by 'b' using the runtime function 'matmul'.
+std::unique_ptr<Array2D<float>> RuntimeMatrixMultiply(MatMulF32 matmul,
+                                                      const Array2D<float>& a,
+                                                      const Array2D<float>& b,
+                                                      bool transpose_lhs,
+                                                      bool transpose_rhs) {
   tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(), "XLAEigen",
                                       2);
   tensorflow::EigenThreadPoolWrapper tp(&pool);
@@ -88,7 +96,7 @@ std::unique_ptr<Array2D<float>> EigenMatrixMultiply(const Array2D<float>& a,
   int64 n = b.width();
   int64 k = a.width();
 
-  // The Eigen matmul runtime function expects the matrix to be in column major
+  // The matmul runtime functions expect the matrix to be in column major
   // order and array2d is in row-major order. Create transposes of a and b. The
   // 'data' buffer in the transposed array is the original array in column major
   // order.
@@ -98,9 +106,8 @@ std::unique_ptr<Array2D<float>> EigenMatrixMultiply(const Array2D<float>& a,
   // Since we're going to transpose c before returning it. Swap the order of the
   // dimension sizes to ensure the returned array is properly dimensioned.
   auto c_transpose = MakeUnique<Array2D<float>>(n, m);
-  __xla_cpu_runtime_EigenMatMulF32(&run_options, c_transpose->data(),
-                                   a_transpose->data(), b_transpose->data(), m,
-                                   n, k, transpose_lhs, transpose_rhs);
+  matmul(&run_options, c_transpose->data(), a_transpose->data(),
+         b_transpose->data(), m, n, k, transpose_lhs, transpose_rhs);
   return MaybeTransposeArray2D(*c_transpose, true);
 }
 
@@ -110,7 +117,8 @@ TEST_F(CpuRuntimeTest, SmallEigenMatmul) {
 
   for (bool transpose_lhs : {false, true}) {
     for (bool transpose_rhs : {false, true}) {
-      auto c = EigenMatrixMultiply(a, b, transpose_lhs, transpose_rhs);
+      auto c = RuntimeMatrixMultiply(__xla_cpu_runtime_EigenMatMulF32, a, b,
+                                     transpose_lhs, transpose_rhs);
 
       LOG(INFO) << "a = " << a.ToString();
       LOG(INFO) << "b = " << b.ToString();
@@ -127,12 +135,30 @@ TEST_F(CpuRuntimeTest, LargeEigenMatmul) {
 
   for (bool transpose_lhs : {false, true}) {
     for (bool transpose_rhs : {false, true}) {
-      auto c = EigenMatrixMultiply(*a, *b, transpose_lhs, transpose_rhs);
+      auto c = RuntimeMatrixMultiply(__xla_cpu_runtime_EigenMatMulF32, *a,
+                                     *b, transpose_lhs, transpose_rhs);
 
       CheckMatrixMultiply(*a, *b, *c);
     }
   }
 }
 
+TEST_F(CpuRuntimeTest, MKLMatmul) {
+  auto a = MakeLinspaceArray2D(0.0, 1.0, 31, 17);
+  auto b = MakeLinspaceArray2D(-2.0, 2.0, 17, 23);
+
+  for (MatMulF32 matmul : {__xla_cpu_runtime_MKLMatMulF32,
+                           __xla_cpu_runtime_MKLSingleThreadedMatMulF32}) {
+    for (bool transpose_lhs : {false, true}) {
+      for (bool transpose_rhs : {false, true}) {
+        auto c = RuntimeMatrixMultiply(matmul, *a, *b, transpose_lhs,
+                                       transpose_rhs);
+
+        CheckMatrixMultiply(*a, *b, *c);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xla
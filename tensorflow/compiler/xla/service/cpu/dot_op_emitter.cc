@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include "external/llvm/include/llvm/IR/BasicBlock.h"
+#include "external/llvm/include/llvm/IR/DerivedTypes.h"
 #include "external/llvm/include/llvm/IR/Instructions.h"
 #include "external/llvm/include/llvm/IR/Module.h"
 #include "external/llvm/include/llvm/IR/Value.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/legacy_flags/cpu_runtime_flags.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
@@ -30,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -38,13 +42,30 @@ using llvm_ir::SetToFirstInsertPoint;
 
 namespace cpu {
 
+namespace {
+
+// The rows and the vectors of columns of the tiles of the target accumulated
+// in vector registers by the tiled matrix multiply. The 8 accumulators, the 2
+// vectors of the RHS and the broadcast element of the LHS fit in the 16 vector
+// registers of SSE and AVX.
+constexpr int64 kTileRows = 4;
+constexpr int64 kTileVectors = 2;
+
+// The size of the panels of the RHS multiplied with all the rows of the LHS,
+// which should stay in the L2 cache.
+constexpr int64 kRhsPanelByteSize = 128 * 1024;
+
+}  // namespace
+
 DotOpEmitter::DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
                            bool transpose_rhs,
                            const llvm_ir::IrArray& target_array,
                            const llvm_ir::IrArray& lhs_array,
                            const llvm_ir::IrArray& rhs_array,
                            llvm::Value* executable_run_options_value,
-                           llvm::IRBuilder<>* ir_builder)
+                           llvm::IRBuilder<>* ir_builder,
+                           int64 vector_register_byte_size,
+                           const Epilogue& epilogue)
     : dot_(dot),
       transpose_lhs_(transpose_lhs),
       transpose_rhs_(transpose_rhs),
@@ -52,18 +73,21 @@ DotOpEmitter::DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
       lhs_array_(lhs_array),
       rhs_array_(rhs_array),
       executable_run_options_value_(executable_run_options_value),
-      ir_builder_(ir_builder) {}
+      ir_builder_(ir_builder),
+      vector_register_byte_size_(vector_register_byte_size),
+      epilogue_(epilogue) {}
 
 /* static */ tensorflow::Status DotOpEmitter::EmitDotOperation(
     const HloInstruction& dot, bool transpose_lhs, bool transpose_rhs,
     const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
     const llvm_ir::IrArray& rhs_array,
-    llvm::Value* executable_run_options_value, llvm::IRBuilder<>* ir_builder) {
+    llvm::Value* executable_run_options_value, llvm::IRBuilder<>* ir_builder,
+    int64 vector_register_byte_size, const Epilogue& epilogue) {
   PrimitiveType type = target_array.GetShape().element_type();
   TF_RET_CHECK(F32 == type || F64 == type);
   DotOpEmitter dot_emitter(dot, transpose_lhs, transpose_rhs, target_array,
                            lhs_array, rhs_array, executable_run_options_value,
-                           ir_builder);
+                           ir_builder, vector_register_byte_size, epilogue);
   return dot_emitter.Emit();
 }
 
@@ -102,7 +126,11 @@ tensorflow::Status DotOpEmitter::Emit() {
     return EmitScalarDot();
   }
 
-  if (PotentiallyImplementedAsEigenDot(dot_)) {
+  if (CanEmitTiledGemm()) {
+    return EmitTiledGemm();
+  }
+
+  if (epilogue_ == nullptr && PotentiallyImplementedAsEigenDot(dot_)) {
     return EmitCallToRuntime();
   }
 
@@ -202,7 +230,7 @@ tensorflow::Status DotOpEmitter::Emit() {
     }
   }
 
-  target_array_.EmitWriteArrayElement(target_index, result, ir_builder_);
+  TF_RETURN_IF_ERROR(EmitWriteTargetElement(target_index, result));
 
   // Set the IR builder insert point to the exit basic block of the outer most
   // loop.
@@ -218,14 +246,214 @@ tensorflow::Status DotOpEmitter::EmitScalarDot() {
   llvm::Value* rhs_value =
       rhs_array_.EmitReadArrayElement(/*index=*/{}, ir_builder_);
   llvm::Value* result = ir_builder_->CreateFMul(lhs_value, rhs_value);
-  target_array_.EmitWriteArrayElement(/*index=*/{}, result, ir_builder_);
+  return EmitWriteTargetElement(/*index=*/{}, result);
+}
+
+tensorflow::Status DotOpEmitter::EmitWriteTargetElement(
+    const llvm_ir::IrArray::Index& index, llvm::Value* value) {
+  if (epilogue_ != nullptr) {
+    TF_ASSIGN_OR_RETURN(value, epilogue_(index, value));
+  }
+  target_array_.EmitWriteArrayElement(index, value, ir_builder_);
+  return tensorflow::Status::OK();
+}
+
+bool DotOpEmitter::CanEmitTiledGemm() const {
+  return PotentiallyImplementedAsTiledLlvmIrDot(dot_) && !transpose_lhs_ &&
+         !transpose_rhs_ &&
+         LayoutUtil::IsMonotonicWithDim0Major(
+             lhs_array_.GetShape().layout()) &&
+         LayoutUtil::IsMonotonicWithDim0Major(
+             rhs_array_.GetShape().layout()) &&
+         LayoutUtil::IsMonotonicWithDim0Major(
+             target_array_.GetShape().layout());
+}
+
+tensorflow::Status DotOpEmitter::EmitTiledGemm() {
+  // The target is computed as:
+  //
+  //   target[i, j] = sum(lhs[i, p] * rhs[p, j] for p in [0, k))
+  //
+  // for tiles of kTileRows rows i and of kTileVectors vectors of consecutive
+  // columns j, accumulated in vector registers: each step p of the reduction
+  // loads the vectors of the row p of the RHS, and multiplies them with the
+  // elements of the LHS broadcast to vectors. The columns not filling a tile
+  // are computed by tiles of one vector, and then one element.
+  const int64 m = lhs_array_.GetShape().dimensions(0);
+  const int64 k = lhs_array_.GetShape().dimensions(1);
+  const int64 n = rhs_array_.GetShape().dimensions(1);
+  const int64 element_byte_size = ShapeUtil::ByteSizeOfPrimitiveType(
+      target_array_.GetShape().element_type());
+  const int64 vector_width =
+      std::max<int64>(1, vector_register_byte_size_ / element_byte_size);
+  const int64 tile_cols = vector_width * kTileVectors;
+  const int64 block_cols = std::max(
+      tile_cols, kRhsPanelByteSize / (k * element_byte_size) / tile_cols *
+                     tile_cols);
+
+  const int64 tiled_rows = m / kTileRows * kTileRows;
+  const int64 tiled_cols = n / tile_cols * tile_cols;
+  const int64 vector_cols =
+      tiled_cols + (n - tiled_cols) / vector_width * vector_width;
+  for (int64 block = 0; block < tiled_cols; block += block_cols) {
+    const int64 block_end = std::min(block + block_cols, tiled_cols);
+    TF_RETURN_IF_ERROR(EmitGemmTiles(0, tiled_rows, kTileRows, block,
+                                     block_end, vector_width, kTileVectors));
+    TF_RETURN_IF_ERROR(EmitGemmTiles(tiled_rows, m, 1, block, block_end,
+                                     vector_width, kTileVectors));
+  }
+  TF_RETURN_IF_ERROR(EmitGemmTiles(0, tiled_rows, kTileRows, tiled_cols,
+                                   vector_cols, vector_width, 1));
+  TF_RETURN_IF_ERROR(EmitGemmTiles(tiled_rows, m, 1, tiled_cols, vector_cols,
+                                   vector_width, 1));
+  TF_RETURN_IF_ERROR(
+      EmitGemmTiles(0, tiled_rows, kTileRows, vector_cols, n, 1, 1));
+  return EmitGemmTiles(tiled_rows, m, 1, vector_cols, n, 1, 1);
+}
+
+tensorflow::Status DotOpEmitter::EmitGemmTiles(
+    int64 row_begin, int64 row_end, int64 tile_rows, int64 col_begin,
+    int64 col_end, int64 vector_width, int64 tile_vectors) {
+  if (row_begin == row_end || col_begin == col_end) {
+    return tensorflow::Status::OK();
+  }
+  const int64 k = lhs_array_.GetShape().dimensions(1);
+  const int64 n = rhs_array_.GetShape().dimensions(1);
+  const int64 tile_cols = vector_width * tile_vectors;
+  TF_RET_CHECK((row_end - row_begin) % tile_rows == 0 &&
+               (col_end - col_begin) % tile_cols == 0);
+
+  llvm::Type* element_type = target_array_.GetElementLlvmType();
+  llvm::Type* vector_type =
+      vector_width == 1 ? element_type
+                        : llvm::VectorType::get(element_type, vector_width);
+  const unsigned alignment = ShapeUtil::ByteSizeOfPrimitiveType(
+      target_array_.GetShape().element_type());
+  llvm::Value* lhs = ir_builder_->CreateBitCast(lhs_array_.GetBasePointer(),
+                                                element_type->getPointerTo());
+  llvm::Value* rhs = ir_builder_->CreateBitCast(rhs_array_.GetBasePointer(),
+                                                element_type->getPointerTo());
+  llvm::Value* target = ir_builder_->CreateBitCast(
+      target_array_.GetBasePointer(), element_type->getPointerTo());
+  // Returns the address of the element `row, col` of the row-major matrix
+  // `base` with `cols` columns, as a pointer to `type`.
+  auto address = [this](llvm::Value* base, llvm::Value* row, llvm::Value* col,
+                        int64 cols, llvm::Type* type) {
+    llvm::Value* offset = ir_builder_->CreateAdd(
+        ir_builder_->CreateMul(row, ir_builder_->getInt64(cols)), col);
+    return ir_builder_->CreateBitCast(
+        llvm_ir::EmitBufferIndexingGEP(base, offset, ir_builder_),
+        type->getPointerTo());
+  };
+
+  // The accumulators are promoted to registers by LLVM.
+  std::vector<llvm::Value*> accumulators;
+  for (int64 i = 0; i < tile_rows * tile_vectors; ++i) {
+    accumulators.push_back(llvm_ir::EmitAllocaAtFunctionEntry(
+        vector_type, "accumulator", ir_builder_, alignment));
+  }
+
+  llvm_ir::ForLoopNest loop_nest(ir_builder_);
+  std::unique_ptr<llvm_ir::ForLoop> row_loop =
+      loop_nest.AddLoop(0, (row_end - row_begin) / tile_rows, "row_tile");
+  std::unique_ptr<llvm_ir::ForLoop> col_loop =
+      loop_nest.AddLoop(0, (col_end - col_begin) / tile_cols, "col_tile");
+  std::unique_ptr<llvm_ir::ForLoop> reduction_loop =
+      loop_nest.AddLoop(0, k, "reduction");
+
+  // Preheader basic block of reduction loop:
+  // - Compute the first row and column of the tile.
+  // - Initialize the accumulators to zero.
+  ir_builder_->SetInsertPoint(
+      reduction_loop->GetPreheaderBasicBlock()->getTerminator());
+  llvm::Value* row = ir_builder_->CreateAdd(
+      ir_builder_->getInt64(row_begin),
+      ir_builder_->CreateMul(row_loop->GetIndVarValue(),
+                             ir_builder_->getInt64(tile_rows)));
+  llvm::Value* col = ir_builder_->CreateAdd(
+      ir_builder_->getInt64(col_begin),
+      ir_builder_->CreateMul(col_loop->GetIndVarValue(),
+                             ir_builder_->getInt64(tile_cols)));
+  std::vector<llvm::Value*> rows;
+  for (int64 i = 0; i < tile_rows; ++i) {
+    rows.push_back(ir_builder_->CreateAdd(row, ir_builder_->getInt64(i)));
+  }
+  std::vector<llvm::Value*> cols;
+  for (int64 j = 0; j < tile_vectors; ++j) {
+    cols.push_back(
+        ir_builder_->CreateAdd(col, ir_builder_->getInt64(j * vector_width)));
+  }
+  for (llvm::Value* accumulator : accumulators) {
+    ir_builder_->CreateStore(llvm::Constant::getNullValue(vector_type),
+                             accumulator);
+  }
+
+  // Body basic block of reduction loop:
+  // - Load the vectors of the row of the RHS.
+  // - Multiply them with the broadcast elements of the column of the LHS.
+  // - Add the products to the accumulators.
+  SetToFirstInsertPoint(reduction_loop->GetBodyBasicBlock(), ir_builder_);
+  llvm::Value* p = reduction_loop->GetIndVarValue();
+  std::vector<llvm::Value*> rhs_vectors;
+  for (int64 j = 0; j < tile_vectors; ++j) {
+    rhs_vectors.push_back(ir_builder_->CreateAlignedLoad(
+        address(rhs, p, cols[j], n, vector_type), alignment));
+  }
+  for (int64 i = 0; i < tile_rows; ++i) {
+    llvm::Value* lhs_element = ir_builder_->CreateAlignedLoad(
+        address(lhs, rows[i], p, k, element_type), alignment);
+    llvm::Value* lhs_vector =
+        vector_width == 1
+            ? lhs_element
+            : ir_builder_->CreateVectorSplat(vector_width, lhs_element);
+    for (int64 j = 0; j < tile_vectors; ++j) {
+      llvm::Value* accumulator = accumulators[i * tile_vectors + j];
+      llvm::Value* product =
+          ir_builder_->CreateFMul(lhs_vector, rhs_vectors[j]);
+      ir_builder_->CreateStore(
+          ir_builder_->CreateFAdd(ir_builder_->CreateLoad(accumulator),
+                                  product),
+          accumulator);
+    }
+  }
+
+  // Exit basic block of reduction loop:
+  // - Store the accumulators into the tile of the target, through the
+  //   epilogue one element at a time if there is one.
+  SetToFirstInsertPoint(reduction_loop->GetExitBasicBlock(), ir_builder_);
+  for (int64 i = 0; i < tile_rows; ++i) {
+    for (int64 j = 0; j < tile_vectors; ++j) {
+      llvm::Value* result =
+          ir_builder_->CreateLoad(accumulators[i * tile_vectors + j]);
+      if (epilogue_ == nullptr) {
+        ir_builder_->CreateAlignedStore(
+            result, address(target, rows[i], cols[j], n, vector_type),
+            alignment);
+        continue;
+      }
+      for (int64 lane = 0; lane < vector_width; ++lane) {
+        llvm::Value* element =
+            vector_width == 1
+                ? result
+                : ir_builder_->CreateExtractElement(result, lane);
+        llvm_ir::IrArray::Index index(
+            {rows[i],
+             ir_builder_->CreateAdd(cols[j], ir_builder_->getInt64(lane))});
+        TF_RETURN_IF_ERROR(EmitWriteTargetElement(index, element));
+      }
+    }
+  }
+
+  // Set the IR builder insert point to the exit basic block of the outer most
+  // loop.
+  ir_builder_->SetInsertPoint(loop_nest.GetOuterLoopExitBasicBlock());
   return tensorflow::Status::OK();
 }
 
 tensorflow::Status DotOpEmitter::EmitCallToRuntime() {
   DCHECK(ShapesAreLegalForRuntimeDot());
 
-  // The signature of the Eigen runtime matmul function is:
+  // The signature of the Eigen and MKL runtime matmul functions is:
   //
   //   (void)(void* run_options, float* out, float* lhs, float* rhs,
   //          int64 m, int64 n, int64 k, int32 transpose_lhs,
@@ -235,20 +463,33 @@ tensorflow::Status DotOpEmitter::EmitCallToRuntime() {
 
   legacy_flags::CpuRuntimeFlags* flags = legacy_flags::GetCpuRuntimeFlags();
   bool multi_threaded = flags->xla_cpu_multi_thread_eigen;
+  bool use_mkl = flags->xla_cpu_use_mkl;
   PrimitiveType type = target_array_.GetShape().element_type();
   llvm::Type* float_type;
   const char* fn_name;
   switch (type) {
     case F32:
-      fn_name = multi_threaded
-                    ? runtime::kEigenMatmulF32SymbolName
-                    : runtime::kEigenSingleThreadedMatmulF32SymbolName;
+      if (use_mkl) {
+        fn_name = multi_threaded
+                      ? runtime::kMKLMatmulF32SymbolName
+                      : runtime::kMKLSingleThreadedMatmulF32SymbolName;
+      } else {
+        fn_name = multi_threaded
+                      ? runtime::kEigenMatmulF32SymbolName
+                      : runtime::kEigenSingleThreadedMatmulF32SymbolName;
+      }
       float_type = ir_builder_->getFloatTy();
       break;
     case F64:
-      fn_name = multi_threaded
-                    ? runtime::kEigenMatmulF64SymbolName
-                    : runtime::kEigenSingleThreadedMatmulF64SymbolName;
+      if (use_mkl) {
+        fn_name = multi_threaded
+                      ? runtime::kMKLMatmulF64SymbolName
+                      : runtime::kMKLSingleThreadedMatmulF64SymbolName;
+      } else {
+        fn_name = multi_threaded
+                      ? runtime::kEigenMatmulF64SymbolName
+                      : runtime::kEigenSingleThreadedMatmulF64SymbolName;
+      }
       float_type = ir_builder_->getDoubleTy();
       break;
     default:
@@ -275,7 +516,7 @@ tensorflow::Status DotOpEmitter::EmitCallToRuntime() {
   matmul_func->setDoesNotThrow();
   matmul_func->setOnlyAccessesArgMemory();
 
-  // The Eigen runtime function expects column-major layout. If the matrices are
+  // The runtime functions expect column-major layout. If the matrices are
   // row major, then use the following identity to compute the product:
   //
   //   (A x B)^T = B^T x A^T
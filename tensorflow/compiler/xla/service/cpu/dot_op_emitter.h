@@ -16,10 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
 
+#include <functional>
+
 #include "external/llvm/include/llvm/IR/IRBuilder.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_array.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_loop.h"
+#include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -31,15 +34,26 @@ namespace cpu {
 // Helper class for emitting LLVM IR to perform the dot operation.
 class DotOpEmitter {
  public:
+  // Computes the element at `index` of the target from the value `dot_value`
+  // of the dot there, e.g. for the elementwise consumers fused with the dot.
+  using Epilogue = std::function<StatusOr<llvm::Value*>(
+      const llvm_ir::IrArray::Index& index, llvm::Value* dot_value)>;
+
   // Emit LLVM IR to perform the dot operation on lhs_array and rhs_array and
   // place the result in target_array. IR is emitted at current insert point of
   // the builder. Upon completion of the method, the insert point is set to the
   // end of all instructions emitted for this operation.
+  //
+  // The tiled loops emitted for the dots which don't call Eigen are vectorized
+  // for vector registers of vector_register_byte_size bytes. If epilogue is
+  // non-null, it computes the elements stored in target_array from the
+  // elements of the dot, which must then not be implemented with Eigen.
   static tensorflow::Status EmitDotOperation(
       const HloInstruction& dot, bool transpose_lhs, bool transpose_rhs,
       const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
       const llvm_ir::IrArray& rhs_array,
-      llvm::Value* executable_run_options_value, llvm::IRBuilder<>* ir_builder);
+      llvm::Value* executable_run_options_value, llvm::IRBuilder<>* ir_builder,
+      int64 vector_register_byte_size, const Epilogue& epilogue = nullptr);
 
  private:
   DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
@@ -47,7 +61,8 @@ class DotOpEmitter {
                const llvm_ir::IrArray& lhs_array,
                const llvm_ir::IrArray& rhs_array,
                llvm::Value* executable_run_options_value,
-               llvm::IRBuilder<>* ir_builder);
+               llvm::IRBuilder<>* ir_builder, int64 vector_register_byte_size,
+               const Epilogue& epilogue);
 
   // Emits the IR to perform the dot operation.
   tensorflow::Status Emit();
@@ -59,6 +74,30 @@ class DotOpEmitter {
   // Emits a call to the CPU runtime to perform the matrix multiply.
   tensorflow::Status EmitCallToRuntime();
 
+  // Returns true if the dot can be emitted by EmitTiledGemm(): the operands
+  // are row-major matrices which aren't transposed.
+  bool CanEmitTiledGemm() const;
+
+  // Emits the matrix multiply as loops over tiles of the target small enough
+  // to be accumulated in vector registers, in blocks of columns whose panel of
+  // the RHS stays in the cache while it is multiplied with all the rows of the
+  // LHS.
+  tensorflow::Status EmitTiledGemm();
+
+  // Emits the loops computing the elements of the target in the rows
+  // [row_begin, row_end) and the columns [col_begin, col_end), by tiles of
+  // tile_rows rows and tile_vectors vectors of vector_width columns, which
+  // must divide the ranges. Nothing is emitted for empty ranges.
+  tensorflow::Status EmitGemmTiles(int64 row_begin, int64 row_end,
+                                   int64 tile_rows, int64 col_begin,
+                                   int64 col_end, int64 vector_width,
+                                   int64 tile_vectors);
+
+  // Stores the element `value` of the dot at `index` into the target, through
+  // the epilogue if there is one.
+  tensorflow::Status EmitWriteTargetElement(
+      const llvm_ir::IrArray::Index& index, llvm::Value* value);
+
   // Emits a series of nested loops for iterating over an operand array in the
   // dot operation. Loops are constructed in major to minor dimension layout
   // order. No loop is emitted for the given reduction_dimension. The function
@@ -82,6 +121,8 @@ class DotOpEmitter {
   const llvm_ir::IrArray& rhs_array_;
   llvm::Value* executable_run_options_value_;
   llvm::IRBuilder<>* ir_builder_;
+  const int64 vector_register_byte_size_;
+  const Epilogue& epilogue_;
 };
 
 }  // namespace cpu
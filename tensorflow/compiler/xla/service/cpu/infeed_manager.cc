@@ -23,7 +23,13 @@ namespace runtime {
 
 InfeedBuffer::~InfeedBuffer() = default;
 
-InfeedManager::InfeedManager() : current_buffer_(nullptr) {}
+InfeedManager::InfeedManager() : capacity_(0), current_buffer_(nullptr) {}
+
+void InfeedManager::set_capacity(int64 capacity) {
+  tensorflow::mutex_lock l(mu_);
+  capacity_ = capacity;
+  not_full_cv_.notify_all();
+}
 
 void InfeedManager::Reset() {
   tensorflow::mutex_lock l(mu_);
@@ -32,10 +38,15 @@ void InfeedManager::Reset() {
     buffer->Done();
   }
   enqueued_buffer_.clear();
+  not_full_cv_.notify_all();
 }
 
 void InfeedManager::EnqueueBuffer(InfeedBuffer* buffer) {
   tensorflow::mutex_lock l(mu_);
+  while (capacity_ > 0 &&
+         static_cast<int64>(enqueued_buffer_.size()) >= capacity_) {
+    not_full_cv_.wait(l);
+  }
   bool was_empty = enqueued_buffer_.empty();
   enqueued_buffer_.push_back(buffer);
   if (was_empty) {
@@ -53,8 +64,13 @@ InfeedBuffer* InfeedManager::BlockingDequeueBuffer() {
     cv_.wait(l);
   }
   CHECK(!current_buffer_);
+  bool was_full = capacity_ > 0 &&
+                  static_cast<int64>(enqueued_buffer_.size()) >= capacity_;
   current_buffer_ = enqueued_buffer_.front();
   enqueued_buffer_.pop_front();
+  if (was_full) {
+    not_full_cv_.notify_one();
+  }
   return current_buffer_;
 }
 
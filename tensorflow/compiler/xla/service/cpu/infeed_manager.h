@@ -15,7 +15,9 @@ limitations under the License.
 
 // This header declares the abstract class for the infeed manager that
 // is used by the CPU runtime to transfer buffers into an executing
-// CPU computation, e.g., to feed data into a while loop.
+// CPU computation, e.g., to feed data into a while loop. The same class
+// transfers buffers out of the computation for the outfeed: the client
+// enqueues the buffers the runtime then populates.
 
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INFEED_MANAGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INFEED_MANAGER_H_
@@ -30,7 +32,9 @@ namespace cpu {
 namespace runtime {
 
 // Abstract class defining an infeed buffer that is passed to the
-// runtime by a client. The client manages the storage of the buffer.
+// runtime by a client. The client manages the storage of the buffer,
+// which the runtime reads in place for the infeed and writes in place
+// for the outfeed.
 class InfeedBuffer {
  public:
   virtual ~InfeedBuffer();
@@ -45,6 +49,10 @@ class InfeedManager {
  public:
   InfeedManager();
 
+  // Bounds the queue to 'capacity' buffers, see EnqueueBuffer. A capacity
+  // of 0, the default, leaves the queue unbounded.
+  void set_capacity(int64 capacity);
+
   // Calls the completion callback for any enqueued buffers that have
   // not been dequeued by the runtime, and empties the infeed
   // queue. Reset may not be called while a runtime computation is
@@ -56,6 +64,11 @@ class InfeedManager {
   // the buffer will no longer be accessed by the InfeedManager,
   // either as a result of a call to Reset or because the runtime has
   // dequeued and used the buffer.
+  //
+  // If the queue is bounded, blocks while it is full, so that the client
+  // prepares at most 'capacity' buffers ahead of the runtime. For example,
+  // a capacity of 2 double-buffers the infeed: the client fills the next
+  // buffer while the computation reads the current one.
   void EnqueueBuffer(InfeedBuffer* buffer);
 
   // Blocks until the infeed queue is non-empty, then returns the
@@ -74,9 +87,14 @@ class InfeedManager {
 
  private:
   tensorflow::mutex mu_;
+  // The maximum number of buffers in the queue, or 0 if it is unbounded.
+  int64 capacity_;
   // Condition variable that is signaled every time a buffer is
   // enqueued to an empty queue.
   tensorflow::condition_variable cv_;
+  // Condition variable that is signaled every time a buffer is
+  // dequeued from a full bounded queue.
+  tensorflow::condition_variable not_full_cv_;
   // InfeedBuffer* queue contents are not owned, but buffer->Done must
   // be called when the buffer is no longer needed by the runtime.
   std::deque<InfeedBuffer*> enqueued_buffer_;
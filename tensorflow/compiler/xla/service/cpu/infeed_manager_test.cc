@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -46,6 +47,21 @@ class TestInfeedBuffer : public cpu::runtime::InfeedBuffer {
   int32 length_;
 };
 
+class TestOutfeedBuffer : public TestInfeedBuffer {
+ public:
+  TestOutfeedBuffer(int32 length, void* destination)
+      : TestInfeedBuffer(length), destination_(destination) {}
+
+  void* data() override { return destination_; }
+  void Done() override {
+    TestInfeedBuffer::Done();
+    delete this;
+  }
+
+ private:
+  void* destination_;
+};
+
 void ProcessNextBuffer(int32 length) {
   void* buffer = __xla_cpu_runtime_AcquireInfeedBufferForDequeue(length);
   __xla_cpu_runtime_ReleaseInfeedBufferAfterDequeue(length, buffer);
@@ -98,5 +114,46 @@ TEST_F(InfeedManagerTest, MultiThreaded) {
   ProcessNextBuffer(length);
 }
 
+TEST_F(InfeedManagerTest, BoundedCapacityBlocksEnqueue) {
+  tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(), "test", 2);
+
+  cpu::runtime::InfeedManager* infeed = cpu::runtime::GetInfeedManager();
+  infeed->set_capacity(1);
+
+  const int32 length = 64;
+  infeed->EnqueueBuffer(new TestInfeedBuffer(length));
+  tensorflow::Notification second_enqueued;
+  pool.Schedule([infeed, &second_enqueued]() {
+    // Blocks until the first buffer is dequeued.
+    infeed->EnqueueBuffer(new TestInfeedBuffer(length));
+    second_enqueued.Notify();
+  });
+
+  tensorflow::Env::Default()->SleepForMicroseconds(100000);  // 100 ms
+  EXPECT_FALSE(second_enqueued.HasBeenNotified());
+  ProcessNextBuffer(length);
+  second_enqueued.WaitForNotification();
+  ProcessNextBuffer(length);
+
+  infeed->set_capacity(0);
+}
+
+TEST_F(InfeedManagerTest, OutfeedWritesClientBuffer) {
+  cpu::runtime::InfeedManager* outfeed = cpu::runtime::GetOutfeedManager();
+
+  int32 destination = 0;
+  TestOutfeedBuffer* buffer =
+      new TestOutfeedBuffer(sizeof(destination), &destination);
+  outfeed->EnqueueBuffer(buffer);
+
+  void* acquired =
+      __xla_cpu_runtime_AcquireOutfeedBufferForPopulation(sizeof(destination));
+  ASSERT_EQ(&destination, acquired);
+  *static_cast<int32*>(acquired) = 42;
+  __xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation(sizeof(destination),
+                                                        acquired);
+  EXPECT_EQ(42, destination);
+}
+
 }  // namespace
 }  // namespace xla
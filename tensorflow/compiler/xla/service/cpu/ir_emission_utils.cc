@@ -104,7 +104,7 @@ bool PotentiallyImplementedAsEigenDot(const HloInstruction& hlo) {
       // guarantees this invariant, so the check here is for programming
       // errors.
       CHECK_EQ(lhs_shape.dimensions(1), rhs_shape.dimensions(0));
-      return true;
+      return !PotentiallyImplementedAsTiledLlvmIrDot(hlo);
     }
   }
 
@@ -123,5 +123,38 @@ bool PotentiallyImplementedAsEigenDot(const HloInstruction& hlo) {
   return false;
 }
 
+bool PotentiallyImplementedAsTiledLlvmIrDot(const HloInstruction& hlo) {
+  if (hlo.opcode() != HloOpcode::kDot) {
+    return false;
+  }
+  const Shape& lhs_shape = hlo.operand(0)->shape();
+  const Shape& rhs_shape = hlo.operand(1)->shape();
+  const PrimitiveType type = hlo.shape().element_type();
+  if ((type != F32 && type != F64) || !IsRank2WithNoPadding(lhs_shape) ||
+      !IsRank2WithNoPadding(rhs_shape) || !IsRank2WithNoPadding(hlo.shape()) ||
+      ShapeUtil::HasZeroElements(lhs_shape) ||
+      ShapeUtil::HasZeroElements(rhs_shape)) {
+    return false;
+  }
+  legacy_flags::CpuRuntimeFlags* flags = legacy_flags::GetCpuRuntimeFlags();
+  const int64 m = lhs_shape.dimensions(0);
+  const int64 k = lhs_shape.dimensions(1);
+  const int64 n = rhs_shape.dimensions(1);
+  return m * n * k <= flags->xla_cpu_max_llvm_ir_gemm_size;
+}
+
+const HloInstruction* GetOutputFusedDot(const HloInstruction& fusion) {
+  if (fusion.opcode() != HloOpcode::kFusion ||
+      fusion.fusion_kind() != HloInstruction::FusionKind::kOutput) {
+    return nullptr;
+  }
+  for (const auto& fused_instruction : fusion.fused_instructions()) {
+    if (fused_instruction->opcode() == HloOpcode::kDot) {
+      return fused_instruction.get();
+    }
+  }
+  return nullptr;
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -26,6 +26,15 @@ bool PotentiallyImplementedAsEigenConvolution(
 
 bool PotentiallyImplementedAsEigenDot(const HloInstruction& dot);
 
+// Returns true if `dot` is a matrix multiplication small enough to be emitted
+// as tiled loops in LLVM IR rather than as a call to Eigen. Its output can then
+// be fused with its elementwise consumers.
+bool PotentiallyImplementedAsTiledLlvmIrDot(const HloInstruction& dot);
+
+// Returns the dot of `fusion` if `fusion` is the output fusion of a dot emitted
+// as tiled loops with its elementwise consumers, or null otherwise.
+const HloInstruction* GetOutputFusedDot(const HloInstruction& fusion);
+
 }  // namespace cpu
 }  // namespace xla
 
@@ -32,6 +32,7 @@ limitations under the License.
 #include "external/llvm/include/llvm/IR/Instructions.h"
 #include "external/llvm/include/llvm/IR/Intrinsics.h"
 #include "external/llvm/include/llvm/IR/LLVMContext.h"
+#include "external/llvm/include/llvm/IR/PassManager.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/legacy_flags/cpu_runtime_flags.h"
 #include "tensorflow/compiler/xla/map_util.h"
@@ -65,10 +66,12 @@ namespace cpu {
 IrEmitter::IrEmitter(
     const HloModule& hlo_module, const BufferAssignment& assignment,
     llvm::Module* llvm_module,
-    const std::unordered_map<const HloInstruction*, size_t>* hlo_to_profile_idx)
+    const std::unordered_map<const HloInstruction*, size_t>* hlo_to_profile_idx,
+    llvm::TargetMachine* target_machine)
     : assignment_(assignment),
       module_(llvm_module),
       arch_type_(llvm::Triple(llvm_module->getTargetTriple()).getArch()),
+      target_machine_(target_machine),
       ir_builder_(llvm_module->getContext()),
       hlo_to_profile_idx_(hlo_to_profile_idx),
       alias_analysis_(hlo_module, assignment, &llvm_module->getContext()),
@@ -101,6 +104,19 @@ StatusOr<llvm::Function*> IrEmitter::EmitComputation(
   return compute_function_;
 }
 
+StatusOr<llvm::Function*> IrEmitter::EmitPartitionedComputation(
+    HloComputation* computation, const string& function_name_prefix) {
+  emit_dynamic_loop_bounds_ = true;
+  StatusOr<llvm::Function*> function =
+      EmitComputation(computation, function_name_prefix,
+                      /*is_entry_computation=*/true,
+                      /*instruction_order=*/nullptr);
+  emit_dynamic_loop_bounds_ = false;
+  dynamic_loop_start_ = nullptr;
+  dynamic_loop_end_ = nullptr;
+  return function;
+}
+
 static llvm::Argument* GetArg(llvm::Function* f, int idx) {
   llvm::Function::arg_iterator arg_iter = f->arg_begin();
   std::advance(arg_iter, idx);
@@ -154,6 +170,11 @@ void IrEmitter::InitializeIrFunction(const string& function_name,
   //                     /---------------------------------------------\
   //   prof counters ->  | counter 0 | counter 1 | ..... | counter N-1 |
   //  (elided for aot)   \---------------------------------------------/
+  //
+  //                     /-------------------\
+  //   dynamic loop -->  |  start  |   end   |
+  //   bounds            \-------------------/
+  //  (only for partitioned computations, see EmitPartitionedComputation)
 
   // Even though the type of params and temps is void** in the host's view, in
   // LLVM IR this is represented by i8*, similarly to void*. It's up to the code
@@ -166,6 +187,9 @@ void IrEmitter::InitializeIrFunction(const string& function_name,
   if (hlo_to_profile_idx_) {
     compute_function_params.push_back(i64_ptr_type);
   }
+  if (emit_dynamic_loop_bounds_) {
+    compute_function_params.push_back(i64_ptr_type);
+  }
   llvm::FunctionType* compute_function_type = llvm::FunctionType::get(
       /*Result=*/llvm::Type::getVoidTy(module_->getContext()),
       /*Params=*/compute_function_params,
@@ -192,6 +216,9 @@ void IrEmitter::InitializeIrFunction(const string& function_name,
   if (hlo_to_profile_idx_) {
     (++arg_iter)->setName("prof_counters");
   }
+  if (emit_dynamic_loop_bounds_) {
+    (++arg_iter)->setName("dynamic_loop_bounds");
+  }
 
   // We know a-priori that the function arguments are guaranteed to point to
   // disjoint objects.
@@ -210,6 +237,13 @@ void IrEmitter::InitializeIrFunction(const string& function_name,
       /*Context=*/module_->getContext(),
       /*Name=*/"entry",
       /*Parent=*/compute_function_));
+
+  if (emit_dynamic_loop_bounds_) {
+    llvm::Argument* bounds = &*arg_iter;
+    dynamic_loop_start_ = ir_builder_.CreateLoad(bounds, "dynamic_loop_start");
+    dynamic_loop_end_ = ir_builder_.CreateLoad(
+        ir_builder_.CreateConstInBoundsGEP1_64(bounds, 1), "dynamic_loop_end");
+  }
 }
 
 IrEmitter::~IrEmitter() {}
@@ -407,8 +441,62 @@ Status IrEmitter::HandleInfeed(HloInstruction* infeed) {
 }
 
 Status IrEmitter::HandleOutfeed(HloInstruction* outfeed) {
-  // TODO(b/34359662): Implement outfeed on CPU.
-  return Unimplemented("Outfeed is not supported on CPU (b/34359662).");
+  VLOG(2) << "HandleOutfeed: " << outfeed->ToString();
+
+  const HloInstruction* operand = outfeed->operand(0);
+  const Shape& shape = operand->shape();
+  // TODO(b/31381668) handle tuples.
+  if (ShapeUtil::IsTuple(shape)) {
+    return Unimplemented("Outfeed with a tuple shape is not supported: %s",
+                         ShapeUtil::HumanString(shape).c_str());
+  }
+
+  // The signature of the acquire outfeed buffer function is:
+  //
+  //   (void*)(int32 length);
+  llvm::Type* i8_ptr_type = llvm::Type::getInt8PtrTy(module_->getContext());
+  llvm::Type* int32_type = ir_builder_.getInt32Ty();
+  llvm::FunctionType* acquire_type =
+      llvm::FunctionType::get(i8_ptr_type, {int32_type},
+                              /*isVarArg=*/false);
+
+  llvm::Function* acquire_func =
+      llvm::cast<llvm::Function>(module_->getOrInsertFunction(
+          runtime::kAcquireOutfeedBufferForPopulationSymbolName,
+          acquire_type));
+  acquire_func->setCallingConv(llvm::CallingConv::C);
+
+  // The signature of the release outfeed buffer function is:
+  //
+  //   (void)(int32 length, void* buffer);
+  llvm::FunctionType* release_type = llvm::FunctionType::get(
+      ir_builder_.getVoidTy(), {int32_type, i8_ptr_type},
+      /*isVarArg=*/false);
+
+  llvm::Function* release_func =
+      llvm::cast<llvm::Function>(module_->getOrInsertFunction(
+          runtime::kReleaseOutfeedBufferAfterPopulationSymbolName,
+          release_type));
+  release_func->setCallingConv(llvm::CallingConv::C);
+
+  int64 length = ByteSizeOf(shape);
+  if (length > std::numeric_limits<int32>::max()) {
+    return InvalidArgument("outfeed buffer length %lld is too large", length);
+  }
+  int32 length_32 = static_cast<int32>(length);
+
+  // The client's buffer is written directly: the runtime doesn't stage the
+  // outfed data.
+  llvm::Value* acquired_pointer =
+      ir_builder_.CreateCall(acquire_func, {ir_builder_.getInt32(length_32)});
+
+  ir_builder_.CreateMemCpy(acquired_pointer, GetEmittedValueFor(operand),
+                           length_32, 1);
+
+  ir_builder_.CreateCall(release_func,
+                         {ir_builder_.getInt32(length_32), acquired_pointer});
+
+  return Status::OK();
 }
 
 Status IrEmitter::HandleSort(HloInstruction* sort, HloInstruction* operand) {
@@ -759,7 +847,8 @@ Status IrEmitter::HandleDot(HloInstruction* dot, HloInstruction* lhs,
   // Dot operation is complicated so we delegate to a helper class.
   TF_RETURN_IF_ERROR(DotOpEmitter::EmitDotOperation(
       *dot, /*transpose_lhs=*/false, /*transpose_rhs=*/false, target_array,
-      lhs_array, rhs_array, GetExecutableRunOptionsArgument(), &ir_builder_));
+      lhs_array, rhs_array, GetExecutableRunOptionsArgument(), &ir_builder_,
+      GetVectorRegisterByteSize()));
 
   emitted_value_[dot] = target_address;
   return Status::OK();
@@ -1282,7 +1371,55 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
     TF_RETURN_IF_ERROR(DotOpEmitter::EmitDotOperation(
         *dot, dot->operand(0)->IsRank2Transpose(),
         dot->operand(1)->IsRank2Transpose(), target_array, lhs_array, rhs_array,
-        GetExecutableRunOptionsArgument(), &ir_builder_));
+        GetExecutableRunOptionsArgument(), &ir_builder_,
+        GetVectorRegisterByteSize()));
+
+    emitted_value_[fusion] = target_address;
+    return Status::OK();
+  } else if (fusion->fusion_kind() == HloInstruction::FusionKind::kOutput) {
+    // The dot is emitted as a tiled loop nest, and the elementwise ops fused
+    // into its consumers are applied to each element of the dot as the
+    // epilogue of the tiles, before it is written to the target.
+    const HloInstruction* dot = GetOutputFusedDot(*fusion);
+    TF_RET_CHECK(dot != nullptr);
+    std::vector<llvm_ir::IrArray> parameter_arrays;
+    for (HloInstruction* operand : fusion->operands()) {
+      parameter_arrays.push_back(GetIrArrayForOp(operand));
+    }
+    CpuElementalIrEmitter elemental_emitter(hlo_module_config_, &ir_builder_,
+                                            module_);
+    FusedIrEmitter fused_emitter(parameter_arrays, &elemental_emitter);
+    // The value of the dot at the index of the epilogue being emitted.
+    llvm::Value* dot_value = nullptr;
+    fused_emitter.SetGenerator(
+        dot, [&dot_value](const llvm_ir::IrArray::Index& index)
+                 -> StatusOr<llvm::Value*> { return dot_value; });
+    TF_RETURN_IF_ERROR(fusion->fused_expression_root()->Accept(&fused_emitter));
+    const llvm_ir::ElementGenerator root_generator =
+        fused_emitter.GetRootGenerator();
+
+    const HloInstruction* lhs = StripTranspose(*dot->operand(0));
+    const HloInstruction* rhs = StripTranspose(*dot->operand(1));
+    TF_RET_CHECK(lhs->opcode() == HloOpcode::kParameter &&
+                 rhs->opcode() == HloOpcode::kParameter);
+    llvm_ir::IrArray lhs_array(
+        GetIrArrayForOp(fusion->operand(lhs->parameter_number())));
+    llvm_ir::IrArray rhs_array(
+        GetIrArrayForOp(fusion->operand(rhs->parameter_number())));
+    TF_ASSIGN_OR_RETURN(llvm::Value * target_address,
+                        EmitTargetAddressForOp(fusion));
+    llvm_ir::IrArray target_array(target_address, fusion->shape());
+    AddAliasingInformationToIrArray(*fusion, &target_array);
+
+    TF_RETURN_IF_ERROR(DotOpEmitter::EmitDotOperation(
+        *dot, /*transpose_lhs=*/false, /*transpose_rhs=*/false, target_array,
+        lhs_array, rhs_array, GetExecutableRunOptionsArgument(), &ir_builder_,
+        GetVectorRegisterByteSize(),
+        [&dot_value, &root_generator](const llvm_ir::IrArray::Index& index,
+                                      llvm::Value* value) {
+          dot_value = value;
+          return root_generator(index);
+        }));
 
     emitted_value_[fusion] = target_address;
     return Status::OK();
@@ -1314,8 +1451,16 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
   TF_ASSIGN_OR_RETURN(llvm::Value * output_address,
                       EmitTargetAddressForOp(call));
 
-  EmitArrayFunctionCallInto(call_ir_function, parameter_addresses,
-                            output_address, computation->name());
+  auto task_count_it = parallel_task_counts_.find(call);
+  if (task_count_it != parallel_task_counts_.end()) {
+    TF_RETURN_IF_ERROR(EmitParallelForkJoin(*call, call_ir_function,
+                                            parameter_addresses,
+                                            output_address,
+                                            task_count_it->second));
+  } else {
+    EmitArrayFunctionCallInto(call_ir_function, parameter_addresses,
+                              output_address, computation->name());
+  }
 
   emitted_value_[call] = output_address;
   return Status::OK();
@@ -1608,6 +1753,14 @@ llvm::Argument* IrEmitter::GetProfileCountersArgument() {
   return hlo_to_profile_idx_ ? GetArg(compute_function_, 4) : nullptr;
 }
 
+int64 IrEmitter::GetVectorRegisterByteSize() {
+  llvm::FunctionAnalysisManager function_analysis_manager;
+  return target_machine_->getTargetIRAnalysis()
+             .run(*compute_function_, function_analysis_manager)
+             .getRegisterBitWidth(/*Vector=*/true) /
+         8;
+}
+
 llvm::Value* IrEmitter::GetTempBuffersArgument() {
   return GetArg(compute_function_, 3);
 }
@@ -1691,6 +1844,25 @@ void IrEmitter::EmitArrayFunctionCallInto(
     llvm::Function* function,
     tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
     llvm::Value* return_value_buffer, tensorflow::StringPiece name) {
+  llvm::Value* parameter_addresses_buffer =
+      EmitParameterAddressesBuffer(parameter_addresses, name);
+
+  const auto to_int8_ptr = [this](llvm::Value* ptr) {
+    return ir_builder_.CreatePointerCast(ptr, ir_builder_.getInt8PtrTy());
+  };
+  std::vector<llvm::Value*> arguments{
+      to_int8_ptr(return_value_buffer),
+      to_int8_ptr(GetExecutableRunOptionsArgument()),
+      parameter_addresses_buffer, GetTempBuffersArgument()};
+  if (auto* profile_counters = GetProfileCountersArgument()) {
+    arguments.push_back(profile_counters);
+  }
+  ir_builder_.CreateCall(function, arguments);
+}
+
+llvm::Value* IrEmitter::EmitParameterAddressesBuffer(
+    tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+    tensorflow::StringPiece name) {
   llvm::Value* parameter_addresses_buffer =
       llvm_ir::EmitAllocaAtFunctionEntryWithCount(
           ir_builder_.getInt8PtrTy(),
@@ -1706,18 +1878,45 @@ void IrEmitter::EmitArrayFunctionCallInto(
         parameter_addresses_buffer, {ir_builder_.getInt64(i)});
     ir_builder_.CreateStore(parameter_as_i8ptr, slot_in_param_adresses);
   }
+  return parameter_addresses_buffer;
+}
 
-  const auto to_int8_ptr = [this](llvm::Value* ptr) {
-    return ir_builder_.CreatePointerCast(ptr, ir_builder_.getInt8PtrTy());
-  };
-  std::vector<llvm::Value*> arguments{
-      to_int8_ptr(return_value_buffer),
-      to_int8_ptr(GetExecutableRunOptionsArgument()),
-      parameter_addresses_buffer, GetTempBuffersArgument()};
-  if (auto* profile_counters = GetProfileCountersArgument()) {
-    arguments.push_back(profile_counters);
-  }
-  ir_builder_.CreateCall(function, arguments);
+Status IrEmitter::EmitParallelForkJoin(
+    const HloInstruction& call, llvm::Function* function,
+    tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+    llvm::Value* return_value, int64 task_count) {
+  // The runtime function calls 'function' without profile counters.
+  TF_RET_CHECK(GetProfileCountersArgument() == nullptr);
+  const Shape& shape = call.shape();
+  const int64 outer_dimension_size =
+      shape.dimensions(LayoutUtil::Major(shape.layout(), 0));
+
+  llvm::Type* i8_ptr_type = ir_builder_.getInt8PtrTy();
+  llvm::Type* i8_ptr_ptr_type = i8_ptr_type->getPointerTo();
+  llvm::Type* int64_type = ir_builder_.getInt64Ty();
+  llvm::FunctionType* fork_join_type = llvm::FunctionType::get(
+      /*Result=*/ir_builder_.getVoidTy(),
+      /*Params=*/{i8_ptr_type, i8_ptr_type, i8_ptr_ptr_type, i8_ptr_ptr_type,
+                  int64_type, int64_type, i8_ptr_type},
+      /*isVarArg=*/false);
+  llvm::Function* fork_join_func =
+      llvm::cast<llvm::Function>(module_->getOrInsertFunction(
+          runtime::kParallelForkJoinSymbolName, fork_join_type));
+  fork_join_func->setCallingConv(llvm::CallingConv::C);
+  fork_join_func->setDoesNotThrow();
+
+  llvm::Value* parameter_addresses_buffer =
+      EmitParameterAddressesBuffer(parameter_addresses, call.name());
+  ir_builder_.CreateCall(
+      fork_join_func,
+      {ir_builder_.CreatePointerCast(return_value, i8_ptr_type),
+       ir_builder_.CreatePointerCast(GetExecutableRunOptionsArgument(),
+                                     i8_ptr_type),
+       parameter_addresses_buffer, GetTempBuffersArgument(),
+       ir_builder_.getInt64(outer_dimension_size),
+       ir_builder_.getInt64(task_count),
+       ir_builder_.CreatePointerCast(function, i8_ptr_type)});
+  return Status::OK();
 }
 
 llvm::Value* IrEmitter::EmitArrayFunctionCall(
@@ -1775,9 +1974,13 @@ Status IrEmitter::EmitTargetElementLoop(
   llvm_ir::IrArray target_array(target_address, target_shape);
   AddAliasingInformationToIrArray(*target_op, &target_array);
 
-  TF_RETURN_IF_ERROR(
-      llvm_ir::LoopEmitter(element_generator, target_array, &ir_builder_)
-          .EmitLoop());
+  llvm_ir::LoopEmitter loop_emitter(element_generator, target_array,
+                                    &ir_builder_);
+  if (emit_dynamic_loop_bounds_) {
+    loop_emitter.SetOuterDimensionBounds(dynamic_loop_start_,
+                                         dynamic_loop_end_);
+  }
+  TF_RETURN_IF_ERROR(loop_emitter.EmitLoop());
   emitted_value_[target_op] = target_address;
   return Status::OK();
 }
@@ -27,6 +27,7 @@ limitations under the License.
 #include "external/llvm/include/llvm/IR/IRBuilder.h"
 #include "external/llvm/include/llvm/IR/Module.h"
 #include "external/llvm/include/llvm/IR/Value.h"
+#include "external/llvm/include/llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
@@ -60,10 +61,13 @@ class IrEmitter : public DfsHloVisitorWithDefault {
   // llvm_module: the LLVM module to emit IR into.
   // hlo_to_profile_idx: the mapping from HLO to its index in the profiling
   //                     array.
+  // target_machine: the target machine the IR is compiled for, whose vector
+  //                 registers the emitted loops are vectorized for.
   IrEmitter(const HloModule& hlo_module, const BufferAssignment& assignment,
             llvm::Module* llvm_module,
             const std::unordered_map<const HloInstruction*, size_t>*
-                hlo_to_profile_idx);
+                hlo_to_profile_idx,
+            llvm::TargetMachine* target_machine);
   ~IrEmitter() override;
 
   // Emit and return the given HLO computation as an LLVM IR
@@ -85,6 +89,25 @@ class IrEmitter : public DfsHloVisitorWithDefault {
       bool is_entry_computation,
       std::vector<const HloInstruction*>* instruction_order);
 
+  // Like EmitComputation, but the emitted function takes an additional
+  // argument after the profile counters, if any: an array of two int64, the
+  // start and the end of a range of the most-major dimension of the root of
+  // 'computation'. The function only computes the elements of the root within
+  // this range, so that the range can be split across several calls of the
+  // function which run in parallel. 'computation' must be partitionable: see
+  // ParallelTaskAssignment::CanPartition.
+  StatusOr<llvm::Function*> EmitPartitionedComputation(
+      HloComputation* computation, const string& function_name_prefix);
+
+  // Makes each kCall instruction in 'task_counts' run its computation as the
+  // given number of tasks, in parallel on the intra-op thread pool, through
+  // the __xla_cpu_runtime_ParallelForkJoin runtime function. The computations
+  // must be emitted by EmitPartitionedComputation. Profiling isn't supported.
+  void set_parallel_task_counts(
+      std::map<const HloInstruction*, int64> task_counts) {
+    parallel_task_counts_ = std::move(task_counts);
+  }
+
  protected:
   //
   // The following methods implement the DfsHloVisitor interface.
@@ -192,6 +215,10 @@ class IrEmitter : public DfsHloVisitorWithDefault {
   // computation function being emitted by this emitter.
   llvm::Value* GetTempBuffersArgument();
 
+  // Returns the size in bytes of the vector registers of the target of the
+  // computation function being emitted by this emitter.
+  int64 GetVectorRegisterByteSize();
+
   // Emits code that computes the address of the given temporary buffer to the
   // function. target_shape is the shape of this temporary buffer.
   // The returned Value's type is a pointer to element_type.
@@ -237,6 +264,19 @@ class IrEmitter : public DfsHloVisitorWithDefault {
       tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
       llvm::Value* return_value, tensorflow::StringPiece name);
 
+  // Emits an array holding 'parameter_addresses', as passed to the functions
+  // of computations, and returns its address.
+  llvm::Value* EmitParameterAddressesBuffer(
+      tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+      tensorflow::StringPiece name);
+
+  // Emits a call of __xla_cpu_runtime_ParallelForkJoin running 'task_count'
+  // tasks of the partitioned 'function' of the computation called by 'call'.
+  Status EmitParallelForkJoin(
+      const HloInstruction& call, llvm::Function* function,
+      tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+      llvm::Value* return_value, int64 task_count);
+
   // Array function call emitter.  Returns a Value for the function's return
   // value buffer address. The return value buffer is alloca'ed by this
   // function.
@@ -295,6 +335,9 @@ class IrEmitter : public DfsHloVisitorWithDefault {
   // The target architecture.
   llvm::Triple::ArchType arch_type_;
 
+  // The target machine the IR is compiled for.
+  llvm::TargetMachine* target_machine_;
+
   // Used to produce unique names for generated functions.
   NameUniquer name_uniquer_;
 
@@ -314,6 +357,16 @@ class IrEmitter : public DfsHloVisitorWithDefault {
   // Maps HLOs to their index into the profile counter array.
   const std::unordered_map<const HloInstruction*, size_t>* hlo_to_profile_idx_;
 
+  // Whether the function being emitted takes the bounds of the most-major
+  // dimension of its root as an argument, and the values loaded from it.
+  bool emit_dynamic_loop_bounds_ = false;
+  llvm::Value* dynamic_loop_start_ = nullptr;
+  llvm::Value* dynamic_loop_end_ = nullptr;
+
+  // The number of tasks the kCall instructions whose computation is run in
+  // parallel are split into, see set_parallel_task_counts.
+  std::map<const HloInstruction*, int64> parallel_task_counts_;
+
   // Maps HLOs to Values emitted for them.
   std::unordered_map<const HloInstruction*, llvm::Value*> emitted_value_;
 
@@ -56,13 +56,14 @@ Status CpuLayoutAssignment::AddBackendConstraints(
           constraints->SetOperandLayout(filter_shape, convolution, 1));
       TF_RETURN_IF_ERROR(
           constraints->SetInstructionLayout(output_shape, convolution));
-    } else if (PotentiallyImplementedAsEigenDot(*instruction)) {
+    } else if (PotentiallyImplementedAsEigenDot(*instruction) ||
+               PotentiallyImplementedAsTiledLlvmIrDot(*instruction)) {
       const HloInstruction* dot = instruction.get();
       const HloInstruction* lhs_instruction = dot->operand(0);
       const HloInstruction* rhs_instruction = dot->operand(1);
 
-      // In order to implement `dot` with Eigen dot, the layouts of the lhs,
-      // rhs, and output need to be row-major.
+      // In order to implement `dot` with Eigen dot or the tiled LLVM IR dot,
+      // the layouts of the lhs, rhs, and output need to be row-major.
       //
       // These constraints are not hard constraints. Ideally, we should decide
       // which layouts to choose according to some cost model.
@@ -74,6 +75,20 @@ Status CpuLayoutAssignment::AddBackendConstraints(
       TF_RETURN_IF_ERROR(constraints->SetOperandLayout(lhs_shape, dot, 0));
       TF_RETURN_IF_ERROR(constraints->SetOperandLayout(rhs_shape, dot, 1));
       TF_RETURN_IF_ERROR(constraints->SetInstructionLayout(output_shape, dot));
+    } else if (GetOutputFusedDot(*instruction) != nullptr) {
+      // Likewise for the dot fused with its consumers, whose operands are the
+      // operands of the fusion and whose elements are written to its output.
+      const HloInstruction* fusion = instruction.get();
+      const HloInstruction* dot = GetOutputFusedDot(*fusion);
+      for (int64 operand_no = 0; operand_no < 2; ++operand_no) {
+        const int64 parameter_number =
+            dot->operand(operand_no)->parameter_number();
+        TF_RETURN_IF_ERROR(constraints->SetOperandLayout(
+            row_major_shape(fusion->operand(parameter_number)->shape()),
+            fusion, parameter_number));
+      }
+      TF_RETURN_IF_ERROR(constraints->SetInstructionLayout(
+          row_major_shape(fusion->shape()), fusion));
     } else {
       for (int64 operand_no = 0; operand_no < instruction->operand_count();
            ++operand_no) {
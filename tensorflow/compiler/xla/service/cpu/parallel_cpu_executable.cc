@@ -17,14 +17,17 @@ limitations under the License.
 
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <iterator>
 #include <list>
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "external/llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
@@ -58,6 +61,7 @@ ParallelCpuExecutable::ParallelCpuExecutable(
     std::unique_ptr<BufferAssignment> assignment,
     std::unique_ptr<HloModule> hlo_module,
     std::unique_ptr<std::map<HloInstruction*, string>> function_names,
+    std::map<HloInstruction*, int64> task_counts,
     std::unordered_map<const HloInstruction*, size_t> hlo_to_profile_idx,
     std::unordered_map<const HloInstruction*, std::unique_ptr<unsigned char[]>>
         aligned_constants)
@@ -65,6 +69,7 @@ ParallelCpuExecutable::ParallelCpuExecutable(
       jit_(std::move(jit)),
       assignment_(std::move(assignment)),
       functions_names_(std::move(function_names)),
+      task_counts_(std::move(task_counts)),
       hlo_to_profile_idx_(std::move(hlo_to_profile_idx)),
       aligned_constants_(std::move(aligned_constants)) {}
 
@@ -72,6 +77,26 @@ ParallelCpuExecutable::ParallelCpuExecutable(
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      uint64*);
 
+// Type of the function of a partitioned instruction, which additionally takes
+// the bounds of the range of the most-major dimension it computes.
+using PartitionedComputeFunctionType = void (*)(void*, const void*,
+                                                const void**, void**, uint64*,
+                                                const int64*);
+
+namespace {
+
+// The tasks of a partitioned instruction, shared by the workers running them.
+struct TaskQueue {
+  explicit TaskQueue(int64 worker_count) : pending_workers(worker_count) {}
+
+  // The next task to run.
+  std::atomic<int64> next_task{0};
+  // The workers which haven't run out of tasks yet.
+  std::atomic<int64> pending_workers;
+};
+
+}  // namespace
+
 // Given a pointer to an output buffer (following the CPU JIT calling
 // conventions), mark addresses that are "live". The initial pointer itself is
 // trivially live. If the shape of the buffer is a tuple, this analysis looks
@@ -248,8 +273,51 @@ Status ParallelCpuExecutable::ExecuteComputeFunctions(
                        return FindOrDie(results, operand);
                      });
       auto function = FindOrDie(functions, instruction);
-      // The thread pool entry takes ownership of |operand_buffers|.
       const auto* exec_run_options = &run_options->run_options();
+      auto task_count_it = task_counts_.find(instruction);
+      if (task_count_it != task_counts_.end()) {
+        // Schedules one worker per thread at most: each runs the next task
+        // left until there are none, so that the tasks are spread dynamically
+        // across the threads which are free. The last worker to finish owns
+        // |operand_buffers|.
+        const int64 task_count = task_count_it->second;
+        const int64 outer_dimension_size = instruction->shape().dimensions(
+            LayoutUtil::Major(instruction->shape().layout(), 0));
+        const int64 worker_count =
+            std::min<int64>(task_count, thread_pool->NumThreads());
+        auto tasks = std::make_shared<TaskQueue>(worker_count);
+        auto partitioned_function =
+            reinterpret_cast<PartitionedComputeFunctionType>(function);
+        for (int64 i = 0; i < worker_count; ++i) {
+          thread_pool->Schedule([instruction, &completion_queue,
+                                 &completion_queue_lock, &completion_queue_cv,
+                                 result_buffer, exec_run_options,
+                                 operand_buffers, temps_array,
+                                 profile_counters_array, partitioned_function,
+                                 tasks, task_count, outer_dimension_size] {
+            for (int64 task = tasks->next_task++; task < task_count;
+                 task = tasks->next_task++) {
+              const int64 bounds[2] = {
+                  task * outer_dimension_size / task_count,
+                  (task + 1) * outer_dimension_size / task_count};
+              partitioned_function(result_buffer, exec_run_options,
+                                   operand_buffers, temps_array,
+                                   profile_counters_array, bounds);
+            }
+            if (--tasks->pending_workers > 0) {
+              return;
+            }
+            delete[] operand_buffers;
+            tensorflow::mutex_lock l(completion_queue_lock);
+            completion_queue.push_back(instruction);
+            completion_queue_cv.notify_all();
+          });
+        }
+        ++instructions_in_flight;
+        pending_it = pending.erase(pending_it);
+        continue;
+      }
+      // The thread pool entry takes ownership of |operand_buffers|.
       thread_pool->Schedule([instruction, &completion_queue,
                              &completion_queue_lock, &completion_queue_cv,
                              result_buffer, exec_run_options, operand_buffers,
@@ -387,6 +455,11 @@ StatusOr<std::unique_ptr<ShapedBuffer>> ParallelCpuExecutable::ExecuteOnStream(
   }
 
   se::Stream* stream = run_options->stream();
+  // The computation runs on this thread rather than on the stream: wait for
+  // the transfers of its arguments that may have been enqueued on the stream.
+  if (!stream->BlockHostUntilDone()) {
+    return InternalError("failed to wait for the arguments to be transferred");
+  }
   DeviceMemoryAllocator* memory_allocator = run_options->allocator();
   std::vector<se::DeviceMemoryBase> buffers(assignment_->Allocations().size());
 
@@ -52,6 +52,7 @@ class ParallelCpuExecutable : public Executable {
       std::unique_ptr<BufferAssignment> assignment,
       std::unique_ptr<HloModule> hlo_module,
       std::unique_ptr<std::map<HloInstruction*, string>> instruction_functions,
+      std::map<HloInstruction*, int64> task_counts,
       std::unordered_map<const HloInstruction*, size_t> hlo_to_profile_idx,
       std::unordered_map<const HloInstruction*,
                          std::unique_ptr<unsigned char[]>>
@@ -135,6 +136,12 @@ class ParallelCpuExecutable : public Executable {
   // Map containing the JITted function names for each HLO instruction.
   std::unique_ptr<std::map<HloInstruction*, string>> functions_names_;
 
+  // Maps the instructions whose function is partitioned to the number of tasks
+  // their function is split into. The function of these instructions computes
+  // a range of the most-major dimension of their shape: see
+  // IrEmitter::EmitPartitionedComputation.
+  const std::map<HloInstruction*, int64> task_counts_;
+
   // Maps HLOs to their index into the profile counter array.
   const std::unordered_map<const HloInstruction*, size_t> hlo_to_profile_idx_;
 
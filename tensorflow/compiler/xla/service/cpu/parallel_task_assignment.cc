@@ -0,0 +1,164 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
+
+#include <algorithm>
+
+#include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/map_util.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+
+constexpr int64 ParallelTaskAssignment::kMinTaskCostBytes;
+constexpr int64 ParallelTaskAssignment::kTasksPerThread;
+
+namespace {
+
+// Returns whether the IrEmitter emits 'instruction' as a loop over the elements
+// of its shape.
+bool IsEmittedAsElementLoop(const HloInstruction& instruction) {
+  switch (instruction.opcode()) {
+    case HloOpcode::kBroadcast:
+    case HloOpcode::kConcatenate:
+    case HloOpcode::kGather:
+    case HloOpcode::kReshape:
+    case HloOpcode::kReverse:
+    case HloOpcode::kTranspose:
+      return true;
+    case HloOpcode::kFusion:
+      return instruction.fusion_kind() == HloInstruction::FusionKind::kLoop;
+    case HloOpcode::kRng:
+      // The random numbers generated depend on the order the elements are
+      // computed in.
+      return false;
+    default:
+      return instruction.IsElementwise();
+  }
+}
+
+}  // namespace
+
+ParallelTaskAssignment::ParallelTaskAssignment(
+    const HloCostAnalysis::ShapeSizeFunction& shape_size,
+    int64 max_parallelism)
+    : shape_size_(shape_size), max_parallelism_(max_parallelism) {}
+
+StatusOr<int64> ParallelTaskAssignment::GetTargetTaskCount(
+    const HloComputation& computation) const {
+  if (max_parallelism_ <= 1 || !CanPartition(computation)) {
+    return 1;
+  }
+  HloCostAnalysis cost_analysis(shape_size_);
+  TF_RETURN_IF_ERROR(computation.Accept(&cost_analysis));
+  const int64 cost = cost_analysis.flop_count() +
+                     cost_analysis.transcendental_count() +
+                     cost_analysis.bytes_accessed();
+  const int64 task_count =
+      GetTaskCountForCost(cost, computation.root_instruction()->shape());
+  VLOG(2) << "Computation " << computation.name() << " with cost " << cost
+          << " split into " << task_count << " tasks";
+  return task_count;
+}
+
+StatusOr<std::map<HloInstruction*, int64>>
+ParallelTaskAssignment::OutlinePartitionedInstructions(
+    HloModule* module) const {
+  std::map<HloInstruction*, int64> task_counts;
+  if (max_parallelism_ <= 1) {
+    return task_counts;
+  }
+  HloComputation* entry = module->entry_computation();
+  HloCostAnalysis cost_analysis(shape_size_);
+  TF_RETURN_IF_ERROR(entry->Accept(&cost_analysis));
+  for (HloInstruction* instruction : entry->MakeInstructionPostOrder()) {
+    const Shape& shape = instruction->shape();
+    if (instruction->opcode() == HloOpcode::kParameter ||
+        instruction->opcode() == HloOpcode::kConstant ||
+        !IsEmittedAsElementLoop(*instruction) || ShapeUtil::IsTuple(shape) ||
+        ShapeUtil::Rank(shape) == 0) {
+      continue;
+    }
+    const int64 cost = cost_analysis.flop_count(*instruction) +
+                       cost_analysis.transcendental_count(*instruction) +
+                       cost_analysis.bytes_accessed(*instruction);
+    const int64 task_count = GetTaskCountForCost(cost, shape);
+    if (task_count <= 1) {
+      continue;
+    }
+    VLOG(2) << "Instruction " << instruction->name() << " with cost " << cost
+            << " split into " << task_count << " tasks";
+    HloInstruction* call = module->OutlineExpressionFromComputation(
+        {instruction}, tensorflow::strings::StrCat("parallel_",
+                                                   instruction->name()),
+        entry);
+    InsertOrDie(&task_counts, call, task_count);
+  }
+  return task_counts;
+}
+
+int64 ParallelTaskAssignment::GetTaskCountForCost(int64 cost,
+                                                  const Shape& shape) const {
+  const int64 outer_dimension_size =
+      shape.dimensions(LayoutUtil::Major(shape.layout(), 0));
+  const int64 task_count = std::min(
+      {cost / kMinTaskCostBytes, max_parallelism_ * kTasksPerThread,
+       outer_dimension_size});
+  return std::max<int64>(task_count, 1);
+}
+
+/* static */ bool ParallelTaskAssignment::CanPartition(
+    const HloComputation& computation) {
+  const HloInstruction* root = computation.root_instruction();
+  const Shape& root_shape = root->shape();
+  if (ShapeUtil::IsTuple(root_shape) || ShapeUtil::Rank(root_shape) == 0) {
+    return false;
+  }
+  for (const auto& instruction : computation.instructions()) {
+    if (instruction->opcode() == HloOpcode::kParameter ||
+        instruction->opcode() == HloOpcode::kConstant) {
+      // Parameters and constants are available in full to every task.
+      continue;
+    }
+    if (!IsEmittedAsElementLoop(*instruction) ||
+        !ShapeUtil::SameDimensions(instruction->shape(), root_shape) ||
+        !LayoutUtil::Equal(instruction->shape().layout(),
+                           root_shape.layout())) {
+      return false;
+    }
+    for (int64 i = 0; i < instruction->operand_count(); ++i) {
+      const HloOpcode operand_opcode = instruction->operand(i)->opcode();
+      // A task only computes part of the other instructions, so it mustn't
+      // read elements of them at a different index.
+      if (operand_opcode != HloOpcode::kParameter &&
+          operand_opcode != HloOpcode::kConstant &&
+          !instruction->IsElementwiseOnOperand(i)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,87 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_TASK_ASSIGNMENT_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_TASK_ASSIGNMENT_H_
+
+#include <map>
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace cpu {
+
+// Chooses how many tasks the computations called by the entry computation of
+// the parallel CPU backend are split into.
+//
+// Each task of a computation computes the elements of its root within a range
+// of the most-major dimension. The ParallelCpuExecutable runs the tasks on
+// fewer workers than tasks, each picking the next task left once it's done
+// with the previous one, so that workers which are done early take over the
+// tasks slower ones didn't get to.
+class ParallelTaskAssignment {
+ public:
+  // 'shape_size' returns the size in bytes of a shape, for the cost analysis.
+  // 'max_parallelism' is the number of threads the tasks run on.
+  ParallelTaskAssignment(const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                         int64 max_parallelism);
+
+  // Returns the number of tasks 'computation' is split into, from its cost as
+  // estimated by HloCostAnalysis: each task computes at least
+  // kMinTaskCostBytes, and there are at most kTasksPerThread tasks per thread.
+  // Returns 1 if 'computation' can't be partitioned.
+  StatusOr<int64> GetTargetTaskCount(const HloComputation& computation) const;
+
+  // Outlines each instruction of the entry computation of 'module' which is
+  // worth splitting into several tasks into a computation of its own, called
+  // by a kCall instruction, so that its tasks can be emitted as calls of the
+  // same function. This lets the sequential CPU backend, which emits the
+  // entry computation as a single function, split loops across threads.
+  // Returns the number of tasks of each kCall instruction added.
+  StatusOr<std::map<HloInstruction*, int64>> OutlinePartitionedInstructions(
+      HloModule* module) const;
+
+  // Returns whether the elements of the root of 'computation' within a range
+  // of its most-major dimension can be computed independently of the other
+  // elements: this is the case if each instruction is emitted as a loop over
+  // the elements of the root's shape, reading the same element of the
+  // instructions of 'computation' it uses.
+  static bool CanPartition(const HloComputation& computation);
+
+  // The minimum cost of a task: the size of a typical L2 cache.
+  static constexpr int64 kMinTaskCostBytes = 256 << 10;
+
+  // The maximum number of tasks per thread. Having more tasks than threads
+  // balances the load between threads when tasks take uneven time.
+  static constexpr int64 kTasksPerThread = 4;
+
+ private:
+  // Returns the number of tasks computing the elements of 'shape' at a total
+  // cost of 'cost' is split into.
+  int64 GetTaskCountForCost(int64 cost, const Shape& shape) const;
+
+  const HloCostAnalysis::ShapeSizeFunction shape_size_;
+  const int64 max_parallelism_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_TASK_ASSIGNMENT_H_
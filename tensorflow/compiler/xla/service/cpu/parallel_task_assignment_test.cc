@@ -0,0 +1,147 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
+
+#include <map>
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class ParallelTaskAssignmentTest : public HloTestBase {
+ protected:
+  ParallelTaskAssignmentTest()
+      : task_assignment_(
+            [](const Shape& shape) {
+              return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+            },
+            /*max_parallelism=*/8) {}
+
+  int64 GetTargetTaskCount(const HloComputation& computation) {
+    return task_assignment_.GetTargetTaskCount(computation).ValueOrDie();
+  }
+
+  ParallelTaskAssignment task_assignment_;
+};
+
+TEST_F(ParallelTaskAssignmentTest, SplitsLargeElementwiseComputations) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {1024, 1024});
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kExp, param));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(shape, HloOpcode::kAdd, exp, param));
+  auto computation = builder.Build();
+
+  EXPECT_TRUE(ParallelTaskAssignment::CanPartition(*computation));
+  EXPECT_EQ(8 * ParallelTaskAssignment::kTasksPerThread,
+            GetTargetTaskCount(*computation));
+}
+
+TEST_F(ParallelTaskAssignmentTest, DoesNotSplitSmallComputations) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {16, 16});
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "param"));
+  builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kNegate, param));
+  auto computation = builder.Build();
+
+  EXPECT_TRUE(ParallelTaskAssignment::CanPartition(*computation));
+  EXPECT_EQ(1, GetTargetTaskCount(*computation));
+}
+
+TEST_F(ParallelTaskAssignmentTest, SplitsAtMostTheOuterDimension) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {3, 1 << 20});
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "param"));
+  builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kExp, param));
+  auto computation = builder.Build();
+
+  EXPECT_EQ(3, GetTargetTaskCount(*computation));
+}
+
+TEST_F(ParallelTaskAssignmentTest, DoesNotSplitTransposesOfIntermediates) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {1024, 1024});
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kExp, param));
+  // A task would read elements of 'exp' computed by other tasks.
+  builder.AddInstruction(HloInstruction::CreateTranspose(shape, exp, {1, 0}));
+  auto computation = builder.Build();
+
+  EXPECT_FALSE(ParallelTaskAssignment::CanPartition(*computation));
+  EXPECT_EQ(1, GetTargetTaskCount(*computation));
+}
+
+TEST_F(ParallelTaskAssignmentTest, DoesNotSplitDots) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {1024, 1024});
+  auto builder = HloComputation::Builder(TestName());
+  auto lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "lhs"));
+  auto rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, shape, "rhs"));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(shape, HloOpcode::kDot, lhs, rhs));
+  auto computation = builder.Build();
+
+  EXPECT_FALSE(ParallelTaskAssignment::CanPartition(*computation));
+}
+
+TEST_F(ParallelTaskAssignmentTest, OutlinesSplitInstructions) {
+  const Shape shape = ShapeUtil::MakeShape(F32, {1024, 1024});
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kExp, param));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(shape, HloOpcode::kDot, exp, param));
+  HloModule module(TestName());
+  HloComputation* computation = module.AddEntryComputation(builder.Build());
+
+  std::map<HloInstruction*, int64> task_counts =
+      task_assignment_.OutlinePartitionedInstructions(&module).ValueOrDie();
+
+  // Only the exponential is split, the dot is left as is.
+  ASSERT_EQ(1, task_counts.size());
+  HloInstruction* call = task_counts.begin()->first;
+  EXPECT_EQ(8 * ParallelTaskAssignment::kTasksPerThread,
+            task_counts.begin()->second);
+  EXPECT_EQ(HloOpcode::kCall, call->opcode());
+  EXPECT_EQ(HloOpcode::kExp, call->to_apply()->root_instruction()->opcode());
+  const HloInstruction* root = computation->root_instruction();
+  EXPECT_EQ(HloOpcode::kDot, root->opcode());
+  EXPECT_EQ(call, root->operand(0));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,73 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <atomic>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/core/platform/types.h"
+
+using tensorflow::int64;
+
+namespace {
+
+// Type of the function of a partitioned computation, which additionally takes
+// the bounds of the range of the most-major dimension it computes.
+using PartitionedComputeFunctionType = void (*)(void*, const void*,
+                                                const void**, void**,
+                                                const int64*);
+
+}  // namespace
+
+void __xla_cpu_runtime_ParallelForkJoin(void* result_ptr,
+                                        const void* run_options_ptr,
+                                        const void** params, void** temps,
+                                        int64 outer_dimension_size,
+                                        int64 task_count, void* function_ptr) {
+  const auto* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options == nullptr ? nullptr : run_options->intra_op_thread_pool();
+  auto function =
+      reinterpret_cast<PartitionedComputeFunctionType>(function_ptr);
+
+  std::atomic<int64> next_task(0);
+  const auto run_tasks = [&]() {
+    for (int64 task = next_task++; task < task_count; task = next_task++) {
+      const int64 bounds[2] = {task * outer_dimension_size / task_count,
+                               (task + 1) * outer_dimension_size / task_count};
+      function(result_ptr, run_options_ptr, params, temps, bounds);
+    }
+  };
+
+  const int64 worker_count =
+      thread_pool == nullptr
+          ? 1
+          : std::min<int64>(task_count, thread_pool->numThreads());
+  Eigen::Barrier barrier(worker_count - 1);
+  for (int64 i = 1; i < worker_count; ++i) {
+    thread_pool->enqueueNoNotification([&run_tasks, &barrier] {
+      run_tasks();
+      barrier.Notify();
+    });
+  }
+  run_tasks();
+  barrier.Wait();
+}
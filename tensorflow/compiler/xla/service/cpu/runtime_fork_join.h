@@ -0,0 +1,41 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
+
+#include "tensorflow/core/platform/types.h"
+
+extern "C" {
+
+// Runs the 'task_count' tasks of a partitioned computation and waits for them
+// to be done. 'function_ptr' points to the function of the computation, which
+// computes the elements of its result whose index in the most-major dimension
+// of size 'outer_dimension_size' is within the [start, end) bounds it's passed
+// after 'temps'. The tasks split that dimension into ranges of equal size.
+//
+// The tasks run on the intra-op thread pool of the xla::ExecutableRunOptions,
+// with one worker per thread at most, each running the next task left until
+// there are none. The calling thread is one of the workers. The tasks run
+// sequentially in the calling thread if there is no thread pool.
+extern void __xla_cpu_runtime_ParallelForkJoin(
+    void* result_ptr,
+    const void* /* xla::ExecutableRunOptions* */ run_options_ptr,
+    const void** params, void** temps, tensorflow::int64 outer_dimension_size,
+    tensorflow::int64 task_count, void* function_ptr);
+
+}  // extern "C"
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
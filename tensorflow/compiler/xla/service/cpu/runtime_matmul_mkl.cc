@@ -0,0 +1,133 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
+
+#if defined(INTEL_MKL)
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "third_party/mkl/include/mkl_cblas.h"
+#include "third_party/mkl/include/mkl_service.h"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#else
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
+#endif  // defined(INTEL_MKL)
+
+using tensorflow::int32;
+using tensorflow::int64;
+
+#if defined(INTEL_MKL)
+
+namespace {
+
+// BLAS gemm computes out = alpha * op(lhs) * op(rhs) + beta * out, with
+// column-major matrices whose leading dimension is the number of rows they are
+// stored with.
+void MatMul(float* out, float* lhs, float* rhs, int64 m, int64 n, int64 k,
+            int32 transpose_lhs, int32 transpose_rhs) {
+  cblas_sgemm(CblasColMajor, transpose_lhs ? CblasTrans : CblasNoTrans,
+              transpose_rhs ? CblasTrans : CblasNoTrans, m, n, k, 1.0f, lhs,
+              transpose_lhs ? k : m, rhs, transpose_rhs ? n : k, 0.0f, out, m);
+}
+
+void MatMul(double* out, double* lhs, double* rhs, int64 m, int64 n, int64 k,
+            int32 transpose_lhs, int32 transpose_rhs) {
+  cblas_dgemm(CblasColMajor, transpose_lhs ? CblasTrans : CblasNoTrans,
+              transpose_rhs ? CblasTrans : CblasNoTrans, m, n, k, 1.0, lhs,
+              transpose_lhs ? k : m, rhs, transpose_rhs ? n : k, 0.0, out, m);
+}
+
+// Runs the gemm on 'num_threads' MKL threads, restoring the calling thread's
+// previous MKL setting afterwards.
+template <typename T>
+void MatMulWithThreads(int num_threads, T* out, T* lhs, T* rhs, int64 m,
+                       int64 n, int64 k, int32 transpose_lhs,
+                       int32 transpose_rhs) {
+  const int previous_num_threads = mkl_set_num_threads_local(num_threads);
+  MatMul(out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
+  mkl_set_num_threads_local(previous_num_threads);
+}
+
+int IntraOpThreads(const void* run_options_ptr) {
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  return run_options->intra_op_thread_pool()->numThreads();
+}
+
+}  // namespace
+
+void __xla_cpu_runtime_MKLMatMulF32(const void* run_options_ptr, float* out,
+                                    float* lhs, float* rhs, int64 m, int64 n,
+                                    int64 k, int32 transpose_lhs,
+                                    int32 transpose_rhs) {
+  MatMulWithThreads(IntraOpThreads(run_options_ptr), out, lhs, rhs, m, n, k,
+                    transpose_lhs, transpose_rhs);
+}
+
+void __xla_cpu_runtime_MKLMatMulF64(const void* run_options_ptr, double* out,
+                                    double* lhs, double* rhs, int64 m, int64 n,
+                                    int64 k, int32 transpose_lhs,
+                                    int32 transpose_rhs) {
+  MatMulWithThreads(IntraOpThreads(run_options_ptr), out, lhs, rhs, m, n, k,
+                    transpose_lhs, transpose_rhs);
+}
+
+void __xla_cpu_runtime_MKLSingleThreadedMatMulF32(
+    const void* run_options_ptr, float* out, float* lhs, float* rhs, int64 m,
+    int64 n, int64 k, int32 transpose_lhs, int32 transpose_rhs) {
+  MatMulWithThreads(1, out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
+}
+
+void __xla_cpu_runtime_MKLSingleThreadedMatMulF64(
+    const void* run_options_ptr, double* out, double* lhs, double* rhs,
+    int64 m, int64 n, int64 k, int32 transpose_lhs, int32 transpose_rhs) {
+  MatMulWithThreads(1, out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
+}
+
+#else
+
+void __xla_cpu_runtime_MKLMatMulF32(const void* run_options_ptr, float* out,
+                                    float* lhs, float* rhs, int64 m, int64 n,
+                                    int64 k, int32 transpose_lhs,
+                                    int32 transpose_rhs) {
+  __xla_cpu_runtime_EigenMatMulF32(run_options_ptr, out, lhs, rhs, m, n, k,
+                                   transpose_lhs, transpose_rhs);
+}
+
+void __xla_cpu_runtime_MKLMatMulF64(const void* run_options_ptr, double* out,
+                                    double* lhs, double* rhs, int64 m, int64 n,
+                                    int64 k, int32 transpose_lhs,
+                                    int32 transpose_rhs) {
+  __xla_cpu_runtime_EigenMatMulF64(run_options_ptr, out, lhs, rhs, m, n, k,
+                                   transpose_lhs, transpose_rhs);
+}
+
+void __xla_cpu_runtime_MKLSingleThreadedMatMulF32(
+    const void* run_options_ptr, float* out, float* lhs, float* rhs, int64 m,
+    int64 n, int64 k, int32 transpose_lhs, int32 transpose_rhs) {
+  __xla_cpu_runtime_EigenSingleThreadedMatMulF32(
+      run_options_ptr, out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
+}
+
+void __xla_cpu_runtime_MKLSingleThreadedMatMulF64(
+    const void* run_options_ptr, double* out, double* lhs, double* rhs,
+    int64 m, int64 n, int64 k, int32 transpose_lhs, int32 transpose_rhs) {
+  __xla_cpu_runtime_EigenSingleThreadedMatMulF64(
+      run_options_ptr, out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
+}
+
+#endif  // defined(INTEL_MKL)
@@ -21,6 +21,7 @@ limitations under the License.
 #include <list>
 #include <utility>
 
+#include "external/llvm/include/llvm/IR/LLVMContext.h"
 #include "external/llvm/include/llvm/IR/Mangler.h"
 #include "external/llvm/include/llvm/Support/CodeGen.h"
 #include "external/llvm/include/llvm/Support/Host.h"
@@ -30,10 +31,16 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime_avx.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime_sse4_1.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/split_module.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -64,12 +71,27 @@ struct SimpleResolver : public llvm::JITSymbolResolver {
                runtime::kEigenSingleThreadedMatmulF32SymbolName) {
       func_addr = reinterpret_cast<void *>(
           __xla_cpu_runtime_EigenSingleThreadedMatMulF32);
+    } else if (canonical_name == runtime::kMKLMatmulF32SymbolName) {
+      func_addr = reinterpret_cast<void *>(__xla_cpu_runtime_MKLMatMulF32);
+    } else if (canonical_name == runtime::kMKLMatmulF64SymbolName) {
+      func_addr = reinterpret_cast<void *>(__xla_cpu_runtime_MKLMatMulF64);
+    } else if (canonical_name ==
+               runtime::kMKLSingleThreadedMatmulF32SymbolName) {
+      func_addr = reinterpret_cast<void *>(
+          __xla_cpu_runtime_MKLSingleThreadedMatMulF32);
+    } else if (canonical_name ==
+               runtime::kMKLSingleThreadedMatmulF64SymbolName) {
+      func_addr = reinterpret_cast<void *>(
+          __xla_cpu_runtime_MKLSingleThreadedMatMulF64);
     } else if (canonical_name == runtime::kEigenConvF32SymbolName) {
       func_addr = reinterpret_cast<void *>(__xla_cpu_runtime_EigenConvF32);
     } else if (canonical_name ==
                runtime::kEigenSingleThreadedConvF32SymbolName) {
       func_addr = reinterpret_cast<void *>(
           __xla_cpu_runtime_EigenSingleThreadedConvF32);
+    } else if (canonical_name == runtime::kParallelForkJoinSymbolName) {
+      func_addr =
+          reinterpret_cast<void *>(__xla_cpu_runtime_ParallelForkJoin);
     } else if (canonical_name ==
                runtime::kAcquireInfeedBufferForDequeueSymbolName) {
       func_addr = reinterpret_cast<void *>(
@@ -78,6 +100,14 @@ struct SimpleResolver : public llvm::JITSymbolResolver {
                runtime::kReleaseInfeedBufferAfterDequeueSymbolName) {
       func_addr = reinterpret_cast<void *>(
           __xla_cpu_runtime_ReleaseInfeedBufferAfterDequeue);
+    } else if (canonical_name ==
+               runtime::kAcquireOutfeedBufferForPopulationSymbolName) {
+      func_addr = reinterpret_cast<void *>(
+          __xla_cpu_runtime_AcquireOutfeedBufferForPopulation);
+    } else if (canonical_name ==
+               runtime::kReleaseOutfeedBufferAfterPopulationSymbolName) {
+      func_addr = reinterpret_cast<void *>(
+          __xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation);
     } else if (canonical_name == runtime::kExpV4F32) {
       func_addr = reinterpret_cast<void *>(runtime::ExpV4F32);
     } else if (canonical_name == runtime::kExpV8F32) {
@@ -138,18 +168,28 @@ CompilerFunctor::VectorIntrinsics GetAvailableIntrinsics() {
   return intrinsics;
 }
 
+std::unique_ptr<llvm::TargetMachine> CreateHostTargetMachine(
+    const llvm::TargetOptions &target_options,
+    llvm::CodeGenOpt::Level opt_level) {
+  return std::unique_ptr<llvm::TargetMachine>(
+      CHECK_NOTNULL(llvm::EngineBuilder()
+                        .setTargetOptions(target_options)
+                        .setOptLevel(opt_level)
+                        .selectTarget(
+                            /*TargetTriple=*/llvm::Triple(), /*MArch=*/"",
+                            /*MCPU=*/GetHostCpuName(),
+                            /*MAttrs=*/DetectMachineAttributes())));
+}
+
 }  // namespace
 
 SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions &target_options,
-                           llvm::CodeGenOpt::Level opt_level)
-    : target_machine_(
-          CHECK_NOTNULL(llvm::EngineBuilder()
-                            .setTargetOptions(target_options)
-                            .setOptLevel(opt_level)
-                            .selectTarget(
-                                /*TargetTriple=*/llvm::Triple(), /*MArch=*/"",
-                                /*MCPU=*/GetHostCpuName(),
-                                /*MAttrs=*/DetectMachineAttributes()))),
+                           llvm::CodeGenOpt::Level opt_level,
+                           int compile_threads)
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      compile_threads_(compile_threads),
+      target_machine_(CreateHostTargetMachine(target_options, opt_level)),
       disassembler_(*target_machine_),
       data_layout_(target_machine_->createDataLayout()),
       compile_layer_(object_layer_,
@@ -161,17 +201,64 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions &target_options,
 
 SimpleOrcJIT::ModuleHandleT SimpleOrcJIT::AddModule(
     std::unique_ptr<llvm::Module> module) {
+  ModuleHandleT handle;
+  if (compile_threads_ > 1 && AddModuleInParallel(*module, &handle)) {
+    module_handles_.push_back(handle);
+    return handle;
+  }
   // The Orc API adds a whole iterable "set" of modules, so we wrap the module
   // in a vector.
   std::vector<std::unique_ptr<llvm::Module>> module_set;
   module_set.push_back(std::move(module));
-  auto handle = compile_layer_.addModuleSet(
+  handle = compile_layer_.addModuleSet(
       std::move(module_set), MakeUnique<llvm::SectionMemoryManager>(),
       MakeUnique<SimpleResolver>());
   module_handles_.push_back(handle);
   return handle;
 }
 
+bool SimpleOrcJIT::AddModuleInParallel(const llvm::Module &module,
+                                       ModuleHandleT *handle) {
+  std::vector<string> partitions =
+      llvm_ir::SplitModuleToBitcode(module, compile_threads_);
+  if (partitions.empty()) {
+    return false;
+  }
+  VLOG(1) << "Compiling " << module.getModuleIdentifier() << " on "
+          << partitions.size() << " threads";
+
+  // The objects are linked together by the object layer, which resolves the
+  // references between the partitions.
+  using ObjectFileT = llvm::object::OwningBinary<llvm::object::ObjectFile>;
+  std::vector<std::unique_ptr<ObjectFileT>> objects(partitions.size());
+  {
+    tensorflow::thread::ThreadPool thread_pool(
+        tensorflow::Env::Default(), "xla_cpu_llvm_compile", partitions.size());
+    tensorflow::BlockingCounter counter(partitions.size());
+    for (size_t i = 0; i < partitions.size(); ++i) {
+      thread_pool.Schedule([this, &partitions, &objects, &counter, i]() {
+        // LLVM contexts and target machines can't be shared between threads.
+        llvm::LLVMContext context;
+        std::unique_ptr<llvm::Module> partition =
+            llvm_ir::ParseModuleFromBitcode(partitions[i], &context)
+                .ConsumeValueOrDie();
+        std::unique_ptr<llvm::TargetMachine> target_machine =
+            CreateHostTargetMachine(target_options_, opt_level_);
+        Disassembler disassembler(*target_machine);
+        CompilerFunctor compiler(target_machine.get(), &disassembler,
+                                 opt_level_, GetAvailableIntrinsics());
+        objects[i] = MakeUnique<ObjectFileT>(compiler(*partition));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  *handle = object_layer_.addObjectSet(
+      std::move(objects), MakeUnique<llvm::SectionMemoryManager>(),
+      MakeUnique<SimpleResolver>());
+  return true;
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::ModuleHandleT handle) {
   module_handles_.erase(
       std::remove(module_handles_.begin(), module_handles_.end(), handle));
@@ -38,7 +38,8 @@ namespace cpu {
 //
 // Supports JIT-ing multiple modules but without cross-module linking.
 // Implements eager compilation - the module is lowered to binary as soon as
-// it's added to the JIT.
+// it's added to the JIT. The externally visible functions of a module may be
+// split across several threads to be compiled in parallel.
 class SimpleOrcJIT {
  public:
   using ObjLayerT = llvm::orc::RTDyldObjectLinkingLayer<>;
@@ -51,8 +52,10 @@ class SimpleOrcJIT {
   // can be reassociated, etc.).
   // The |opt_level| parameter controls the optimization level of the code
   // generator.
+  // The |compile_threads| parameter is the maximum number of threads each
+  // module is compiled on.
   SimpleOrcJIT(const llvm::TargetOptions& target_options,
-               llvm::CodeGenOpt::Level opt_level);
+               llvm::CodeGenOpt::Level opt_level, int compile_threads = 1);
 
   // Data layout this JIT was created with.
   const llvm::DataLayout& data_layout() const { return data_layout_; }
@@ -62,6 +65,9 @@ class SimpleOrcJIT {
     return target_machine_->getTargetTriple();
   }
 
+  // Target machine (host) this JIT was created with.
+  llvm::TargetMachine* target_machine() const { return target_machine_.get(); }
+
   // Add a module to the JIT. Returns an opaque handle that can be used to later
   // remove this module.
   ModuleHandleT AddModule(std::unique_ptr<llvm::Module> module);
@@ -74,7 +80,15 @@ class SimpleOrcJIT {
   llvm::JITSymbol FindSymbol(const std::string& name);
 
  private:
+  // Compiles 'module' on up to compile_threads_ threads, each compiling some
+  // of its externally visible functions, and adds the object files to the
+  // object layer. Returns false if 'module' can't be split.
+  bool AddModuleInParallel(const llvm::Module& module, ModuleHandleT* handle);
+
   std::vector<ModuleHandleT> module_handles_;
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const int compile_threads_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const Disassembler disassembler_;
   const llvm::DataLayout data_layout_;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/compiler/xla/legacy_flags/cpu_runtime_flags.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/infeed_manager.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
@@ -58,10 +60,50 @@ class CpuInfeedBuffer : public cpu::runtime::InfeedBuffer {
   se::DeviceMemoryBase device_memory_;
 };
 
+// An infeed buffer which owns a donated literal, so that the runtime reads the
+// literal's storage in place instead of a copy of it.
+class CpuDonatedInfeedBuffer : public cpu::runtime::InfeedBuffer {
+ public:
+  CpuDonatedInfeedBuffer(int32 length, std::unique_ptr<Literal> literal)
+      : length_(length), literal_(std::move(literal)) {}
+
+  int32 length() override { return length_; }
+  void* data() override {
+    return LiteralUtil::MutableInternalData(literal_.get());
+  }
+  void Done() override { delete this; }
+
+ private:
+  int32 length_;
+  std::unique_ptr<Literal> literal_;
+};
+
+// An outfeed buffer pointing to the storage of the literal the computation
+// writes the outfed data into. Done() notifies the waiting client.
+class CpuOutfeedBuffer : public cpu::runtime::InfeedBuffer {
+ public:
+  CpuOutfeedBuffer(int32 length, void* destination)
+      : length_(length), destination_(destination) {}
+
+  int32 length() override { return length_; }
+  void* data() override { return destination_; }
+  void Done() override { done_.Notify(); }
+
+  void WaitUntilDone() { done_.WaitForNotification(); }
+
+ private:
+  int32 length_;
+  void* destination_;
+  tensorflow::Notification done_;
+};
+
 }  // namespace
 
 CpuTransferManager::CpuTransferManager()
-    : GenericTransferManager(se::host::kHostPlatformId) {}
+    : GenericTransferManager(se::host::kHostPlatformId) {
+  cpu::runtime::GetInfeedManager()->set_capacity(
+      legacy_flags::GetCpuRuntimeFlags()->xla_cpu_infeed_capacity);
+}
 
 Status CpuTransferManager::TransferLiteralToInfeed(se::StreamExecutor* executor,
                                                    const Literal& literal) {
@@ -94,6 +136,60 @@ Status CpuTransferManager::TransferLiteralToInfeed(se::StreamExecutor* executor,
   return Status::OK();
 }
 
+Status CpuTransferManager::DonateLiteralToInfeed(
+    se::StreamExecutor* executor, std::unique_ptr<Literal> literal) {
+  const Shape& shape = literal->shape();
+  VLOG(2) << "donating literal shape to infeed: "
+          << ShapeUtil::HumanString(shape);
+
+  // TODO(b/31381668) handle tuples.
+  if (ShapeUtil::IsTuple(shape)) {
+    return Unimplemented("Infeed with a tuple shape is not supported: %s",
+                         ShapeUtil::HumanString(shape).c_str());
+  }
+
+  int64 size = GetByteSizeRequirement(shape);
+  if (size > std::numeric_limits<int32>::max()) {
+    return Unimplemented("Infeed shape is too large: %s needs %lld bytes",
+                         ShapeUtil::HumanString(shape).c_str(), size);
+  }
+
+  // The buffer takes ownership of the literal: the host memory it points to is
+  // what the compiled code reads, no copy needed.
+  cpu::runtime::GetInfeedManager()->EnqueueBuffer(
+      new CpuDonatedInfeedBuffer(static_cast<int32>(size), std::move(literal)));
+
+  return Status::OK();
+}
+
+Status CpuTransferManager::TransferLiteralFromOutfeed(
+    se::StreamExecutor* executor, const Shape& literal_shape,
+    Literal* literal) {
+  VLOG(2) << "transferring literal shape from outfeed: "
+          << ShapeUtil::HumanString(literal_shape);
+
+  if (ShapeUtil::IsTuple(literal_shape)) {
+    return Unimplemented("Outfeed with a tuple shape is not supported: %s",
+                         ShapeUtil::HumanString(literal_shape).c_str());
+  }
+
+  int64 size = GetByteSizeRequirement(literal_shape);
+  if (size > std::numeric_limits<int32>::max()) {
+    return Unimplemented("Outfeed shape is too large: %s needs %lld bytes",
+                         ShapeUtil::HumanString(literal_shape).c_str(), size);
+  }
+
+  // The computation writes the outfed data directly into the literal.
+  *literal->mutable_shape() = literal_shape;
+  LiteralUtil::Reserve(ShapeUtil::ElementsIn(literal_shape), literal);
+  CpuOutfeedBuffer buffer(static_cast<int32>(size),
+                          LiteralUtil::MutableInternalData(literal));
+  cpu::runtime::GetOutfeedManager()->EnqueueBuffer(&buffer);
+  buffer.WaitUntilDone();
+
+  return Status::OK();
+}
+
 }  // namespace xla
 
 static std::unique_ptr<xla::TransferManager> CreateCpuTransferManager() {
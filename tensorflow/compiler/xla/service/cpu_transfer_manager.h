@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_TRANSFER_MANAGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_TRANSFER_MANAGER_H_
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/compiler/xla/service/generic_transfer_manager.h"
@@ -29,7 +30,7 @@ limitations under the License.
 namespace xla {
 
 // An implementation of the XLA GenericTransferManager that
-// handles CPU-specific infeed.
+// handles CPU-specific infeed and outfeed.
 class CpuTransferManager : public GenericTransferManager {
  public:
   CpuTransferManager();
@@ -37,6 +38,11 @@ class CpuTransferManager : public GenericTransferManager {
 
   Status TransferLiteralToInfeed(perftools::gputools::StreamExecutor* executor,
                                  const Literal& literal) override;
+  Status DonateLiteralToInfeed(perftools::gputools::StreamExecutor* executor,
+                               std::unique_ptr<Literal> literal) override;
+  Status TransferLiteralFromOutfeed(
+      perftools::gputools::StreamExecutor* executor, const Shape& literal_shape,
+      Literal* literal) override;
 
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(CpuTransferManager);
@@ -200,6 +200,8 @@ class DfsHloVisitor {
   virtual Status HandleDynamicSlice(HloInstruction* dynamic_slice,
                                     HloInstruction* operand,
                                     HloInstruction* start_indices) = 0;
+  virtual Status HandleGather(HloInstruction* gather, HloInstruction* operand,
+                              HloInstruction* indices) = 0;
   virtual Status HandleDynamicUpdateSlice(HloInstruction* dynamic_update_slice,
                                           HloInstruction* operand,
                                           HloInstruction* update,
@@ -140,6 +140,10 @@ class DfsHloVisitorWithDefault : public DfsHloVisitor {
                             HloInstruction* /*start_indices*/) override {
     return DefaultAction(dynamic_slice);
   }
+  Status HandleGather(HloInstruction* gather, HloInstruction* /*operand*/,
+                      HloInstruction* /*indices*/) override {
+    return DefaultAction(gather);
+  }
   Status HandleDynamicUpdateSlice(HloInstruction* dynamic_update_slice,
                                   HloInstruction* /*operand*/,
                                   HloInstruction* /*update*/,
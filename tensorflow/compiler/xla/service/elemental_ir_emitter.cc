@@ -842,6 +842,47 @@ llvm_ir::ElementGenerator ElementalIrEmitter::MakeElementGenerator(
         }
         return operand_to_generator.at(input_hlo)(input_index);
       };
+    case HloOpcode::kGather:
+      return [this, hlo, &operand_to_generator](
+                 const IrArray::Index& index) -> StatusOr<llvm::Value*> {
+        // The leading dimensions of 'index' select an element of the indices,
+        // which selects the slice of the operand along dimension 0; the
+        // trailing dimensions index within that slice.
+        const HloInstruction* input_hlo = hlo->operand(0);
+        const HloInstruction* indices_hlo = hlo->operand(1);
+        const int64 indices_rank = ShapeUtil::Rank(indices_hlo->shape());
+        const int64 rank = ShapeUtil::Rank(input_hlo->shape());
+        IrArray::Index indices_index(indices_rank);
+        for (int64 i = 0; i < indices_rank; ++i) {
+          indices_index[i] = index[i];
+        }
+        TF_ASSIGN_OR_RETURN(
+            llvm::Value * gather_index_value,
+            operand_to_generator.at(indices_hlo)(indices_index));
+        llvm::Type* index_type = index.size() == 0
+                                     ? ir_builder_->getInt64Ty()
+                                     : index[0]->getType();
+        llvm::Value* gather_index = ir_builder_->CreateSExtOrTrunc(
+            gather_index_value, index_type);
+        // Security note: this clamps the gathered index to
+        // [0, dim_size - 1], which keeps the reads in-bounds.
+        llvm::Value* zero = llvm::ConstantInt::get(index_type, 0);
+        llvm::Value* max_index = llvm::ConstantInt::get(
+            index_type, input_hlo->shape().dimensions(0) - 1);
+        gather_index = ir_builder_->CreateSelect(
+            ir_builder_->CreateICmpSLT(gather_index, zero), zero,
+            gather_index);
+        gather_index = ir_builder_->CreateSelect(
+            ir_builder_->CreateICmpSGT(gather_index, max_index), max_index,
+            gather_index);
+
+        IrArray::Index input_index(rank);
+        input_index[0] = gather_index;
+        for (int64 i = 1; i < rank; ++i) {
+          input_index[i] = index[indices_rank + i - 1];
+        }
+        return operand_to_generator.at(input_hlo)(input_index);
+      };
     case HloOpcode::kDynamicUpdateSlice:
       return [this, hlo, &operand_to_generator](
                  const IrArray::Index& index) -> StatusOr<llvm::Value*> {
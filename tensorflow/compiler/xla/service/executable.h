@@ -189,12 +189,17 @@ StatusOr<ReturnT> Executable::ExecuteOnStreamWrapper(
 
   VLOG(1) << "enqueueing executable on stream...";
   // If the profiling flag isn't enabled, we pass nullptr as the profile to
-  // indicate profiling is not requested.
+  // indicate profiling is not requested, unless the caller asked for it.
   HloExecutionProfile hlo_execution_profile;
   legacy_flags::ServiceFlags* flags = legacy_flags::GetServiceFlags();
   HloExecutionProfile* profile_ptr =
       flags->xla_hlo_profile && hlo_profiling_enabled() ? &hlo_execution_profile
                                                         : nullptr;
+  HloExecutionProfile* requested_profile =
+      run_options->run_options().hlo_execution_profile();
+  if (requested_profile != nullptr && hlo_profiling_enabled()) {
+    profile_ptr = requested_profile;
+  }
 
   auto return_value = ExecuteOnStream(run_options, arguments, profile_ptr);
 
@@ -223,7 +228,7 @@ StatusOr<ReturnT> Executable::ExecuteOnStreamWrapper(
     }
   }
 
-  if (profile_ptr != nullptr) {
+  if (profile_ptr != nullptr && flags->xla_hlo_profile) {
     std::unordered_set<const xla::HloComputation*> profiled_computations =
         profile_ptr->profiled_computations();
     // To ensure we have print the profiles in a stable order, iterate over the
@@ -157,6 +157,26 @@ Status GenericTransferManager::TransferLiteralToDevice(
       /*source=*/LiteralUtil::InternalData(literal), destination);
 }
 
+Status GenericTransferManager::TransferLiteralToDeviceAsync(
+    se::Stream* stream, const Literal& literal,
+    se::DeviceMemoryBase* destination) {
+  const Shape& shape = literal.shape();
+  VLOG(2) << "enqueueing transfer of literal shape to device: "
+          << ShapeUtil::HumanString(shape)
+          << "; device location: " << destination->opaque();
+
+  // Tuples need their element buffers allocated and their pointers
+  // transferred, which is done synchronously.
+  if (ShapeUtil::IsTuple(shape)) {
+    return TransferManager::TransferLiteralToDeviceAsync(stream, literal,
+                                                         destination);
+  }
+
+  return TransferBufferToDeviceAsync(
+      stream, /*size=*/GetByteSizeRequirement(shape),
+      /*source=*/LiteralUtil::InternalData(literal), destination);
+}
+
 Status GenericTransferManager::TransferLiteralToInfeed(
     se::StreamExecutor* executor, const Literal& literal) {
   return Unimplemented("Infeed is not supported on GPU (b/30467474)");
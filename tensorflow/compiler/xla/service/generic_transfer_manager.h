@@ -52,6 +52,10 @@ class GenericTransferManager : public TransferManager {
       perftools::gputools::StreamExecutor* executor, const Literal& literal,
       perftools::gputools::DeviceMemoryBase* destination) override;
 
+  Status TransferLiteralToDeviceAsync(
+      perftools::gputools::Stream* stream, const Literal& literal,
+      perftools::gputools::DeviceMemoryBase* destination) override;
+
   Status TransferLiteralToInfeed(perftools::gputools::StreamExecutor* executor,
                                  const Literal& literal) override;
 
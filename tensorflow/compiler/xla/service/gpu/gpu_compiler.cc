@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stdlib.h>
 #include <functional>
+#include <unordered_map>
 #include <utility>
 
 #include "external/llvm/include/llvm/IR/DiagnosticInfo.h"
@@ -41,10 +42,12 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
 #include "tensorflow/compiler/xla/service/gpu/layout_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/llvm_gpu_backend/gpu_backend_lib.h"
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/pad_insertion.h"
 #include "tensorflow/compiler/xla/service/gpu/partition_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk_schedule.h"
+#include "tensorflow/compiler/xla/service/gpu/while_loop_unroller.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
@@ -54,16 +57,21 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/split_module.h"
 #include "tensorflow/compiler/xla/service/reshape_mover.h"
 #include "tensorflow/compiler/xla/service/transpose_folding.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/cuda_libdevice_path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -127,6 +135,8 @@ tensorflow::Status OptimizeHloModule(HloModule* hlo_module,
   {
     HloPassPipeline pipeline("optimization", dump_hlo);
     pipeline.AddInvariantChecker<HloVerifier>();
+    // Runs first so that the unrolled iterations are simplified together.
+    pipeline.AddPass<WhileLoopUnroller>();
     {
       auto& pass = pipeline.AddPass<HloPassFix<HloPassPipeline>>(
           "simplification", dump_hlo);
@@ -153,7 +163,16 @@ tensorflow::Status OptimizeHloModule(HloModule* hlo_module,
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
     fusion.AddPass<FusionMerger>();
-    return fusion.Run(hlo_module).status();
+    TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
+  }
+  {
+    // Runs once the fusion passes above reach their fixed point, since they
+    // don't fuse into multi-output fusions.
+    HloPassPipeline pipeline("multi-output fusion", dump_hlo);
+    pipeline.AddInvariantChecker<HloVerifier>();
+    pipeline.AddPass<MultiOutputFusion>();
+    pipeline.AddPass<HloDCE>();
+    return pipeline.Run(hlo_module).status();
   }
 }
 
@@ -227,6 +246,81 @@ void DumpPtxasInfo(const string& ptx) {
   }
 }
 
+// A PTX module and the names of the kernels it defines.
+struct PtxModule {
+  string ptx;
+  std::vector<string> kernel_names;
+};
+
+std::vector<string> KernelNames(const llvm::Module& llvm_module) {
+  std::vector<string> kernel_names;
+  for (const llvm::Function& function : llvm_module) {
+    if (!function.isDeclaration() && !function.hasLocalLinkage()) {
+      kernel_names.push_back(llvm_ir::AsString(function.getName()));
+    }
+  }
+  return kernel_names;
+}
+
+// Compiles the kernels of 'llvm_module' to PTX. They are split across up to
+// --xla_gpu_llvm_compile_threads modules, compiled in parallel.
+StatusOr<std::vector<PtxModule>> CompileToPtxModules(
+    llvm::Module* llvm_module, std::pair<int, int> compute_capability,
+    const HloModuleConfig& hlo_module_config, const string& libdevice_dir) {
+  legacy_flags::GpuCompilerFlags* flags = legacy_flags::GetGpuCompilerFlags();
+  const int compile_threads = flags->xla_gpu_llvm_compile_threads > 0
+                                  ? flags->xla_gpu_llvm_compile_threads
+                                  : tensorflow::port::NumSchedulableCPUs();
+  std::vector<string> partitions;
+  if (compile_threads > 1) {
+    partitions = llvm_ir::SplitModuleToBitcode(*llvm_module, compile_threads);
+  }
+  if (partitions.empty()) {
+    std::vector<PtxModule> ptx_modules(1);
+    ptx_modules[0].kernel_names = KernelNames(*llvm_module);
+    TF_ASSIGN_OR_RETURN(ptx_modules[0].ptx,
+                        CompileToPtx(llvm_module, compute_capability,
+                                     hlo_module_config, libdevice_dir));
+    VLOG(2) << "LLVM module after optimizations:";
+    XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(*llvm_module));
+    return std::move(ptx_modules);
+  }
+
+  VLOG(1) << "Compiling the kernels of " << llvm_module->getModuleIdentifier()
+          << " on " << partitions.size() << " threads";
+  std::vector<PtxModule> ptx_modules(partitions.size());
+  std::vector<Status> statuses(partitions.size());
+  {
+    tensorflow::thread::ThreadPool thread_pool(tensorflow::Env::Default(),
+                                               "xla_gpu_llvm_compile",
+                                               partitions.size());
+    tensorflow::BlockingCounter counter(partitions.size());
+    for (size_t i = 0; i < partitions.size(); ++i) {
+      thread_pool.Schedule([&, i]() {
+        // An LLVMContext can't be shared between threads.
+        llvm::LLVMContext llvm_context;
+        statuses[i] = [&]() -> Status {
+          TF_ASSIGN_OR_RETURN(
+              std::unique_ptr<llvm::Module> partition,
+              llvm_ir::ParseModuleFromBitcode(partitions[i], &llvm_context));
+          ptx_modules[i].kernel_names = KernelNames(*partition);
+          TF_ASSIGN_OR_RETURN(
+              ptx_modules[i].ptx,
+              CompileToPtx(partition.get(), compute_capability,
+                           hlo_module_config, libdevice_dir));
+          return Status::OK();
+        }();
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return std::move(ptx_modules);
+}
+
 }  // namespace
 
 GpuCompiler::GpuCompiler()
@@ -258,13 +352,31 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::Compile(
   llvm_module.setTargetTriple(kTargetTriple);
   llvm_module.setDataLayout(kDataLayout);
 
+  // If a memory limit is set, rematerialize the instructions whose values are
+  // cheaper to recompute than to keep live, and launch the thunks in the order
+  // rematerialization computed.
+  legacy_flags::GpuCompilerFlags* flags = legacy_flags::GetGpuCompilerFlags();
+  SequentialHloOrdering::HloModuleSequence remat_sequence;
+  if (flags->xla_gpu_memory_limit_bytes > 0) {
+    TF_RETURN_IF_ERROR(
+        HloRematerialization::RematerializeAndSchedule(
+            ShapeSizeBytesFunction(), flags->xla_gpu_memory_limit_bytes,
+            module.get(), &remat_sequence,
+            flags->xla_gpu_max_recompute_flops_per_byte)
+            .status());
+  }
+
   // Determine the HLO schedule, which is an ordering of HLO instructions.  This
   // is used by buffer assignment to enable buffer reuse, and the same ordering
   // must also be used to determine the thunk launch schedule.
   std::unique_ptr<StreamAssignment> stream_assignment = AssignStreams(*module);
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<HloSchedule> hlo_schedule,
-      HloSchedule::Build(*module, *stream_assignment, pointer_size_));
+      HloSchedule::Build(
+          *module, *stream_assignment, pointer_size_,
+          remat_sequence.empty()
+              ? nullptr
+              : &remat_sequence.at(module->entry_computation())));
 
   // Run buffer analysis on the HLO graph. This analysis figures out which
   // temporary buffers are required to run the computation.
@@ -273,7 +385,6 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::Compile(
       BufferAssigner::Run(module.get(), hlo_schedule->ConsumeHloOrdering(),
                           BufferSizeBytesFunction(), kMemoryAlignment));
 
-  legacy_flags::GpuCompilerFlags* flags = legacy_flags::GetGpuCompilerFlags();
   if (!flags->xla_gpu_dump_debug_json_to.empty()) {
     HloProto proto = MakeHloProto(*module, *buffer_assignment);
     TF_RETURN_IF_ERROR(protobuf_util::DumpJsonToDirectory(
@@ -298,13 +409,6 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::Compile(
     XLA_VLOG_LINES(2, ir_module_string_before_opt);
   }
 
-  // Reserve space for the PTX to be generated for this module.
-  string* ptx;
-  {
-    tensorflow::mutex_lock lock(mutex_);
-    generated_ptxes_.emplace_back(MakeUnique<string>());
-    ptx = generated_ptxes_.back().get();
-  }
   int cc_major, cc_minor;
   if (!stream_exec->GetDeviceDescription().cuda_compute_capability(&cc_major,
                                                                    &cc_minor)) {
@@ -313,15 +417,27 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::Compile(
     cc_major = 2;
     cc_minor = 0;
   }
-  TF_ASSIGN_OR_RETURN(*ptx, CompileToPtx(&llvm_module, {cc_major, cc_minor},
-                                         module->config(), libdevice_dir_));
-
-  VLOG(2) << "LLVM module after optimizations:";
-  XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(llvm_module));
-  VLOG(2) << "PTX:";
-  XLA_VLOG_LINES(2, *ptx);
-  if (VLOG_IS_ON(2)) {
-    DumpPtxasInfo(*ptx);
+  TF_ASSIGN_OR_RETURN(std::vector<PtxModule> ptx_modules,
+                      CompileToPtxModules(&llvm_module, {cc_major, cc_minor},
+                                          module->config(), libdevice_dir_));
+
+  std::unordered_map<string, tensorflow::StringPiece> kernel_ptx;
+  for (PtxModule& ptx_module : ptx_modules) {
+    VLOG(2) << "PTX:";
+    XLA_VLOG_LINES(2, ptx_module.ptx);
+    if (VLOG_IS_ON(2)) {
+      DumpPtxasInfo(ptx_module.ptx);
+    }
+    string* ptx;
+    {
+      tensorflow::mutex_lock lock(mutex_);
+      generated_ptxes_.emplace_back(MakeUnique<string>(
+          std::move(ptx_module.ptx)));
+      ptx = generated_ptxes_.back().get();
+    }
+    for (const string& kernel_name : ptx_module.kernel_names) {
+      kernel_ptx.emplace(kernel_name, *ptx);
+    }
   }
 
   auto thunk_schedule = MakeUnique<ThunkSchedule>(
@@ -331,8 +447,9 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::Compile(
   XLA_VLOG_LINES(2, thunk_schedule->ToString());
 
   auto* gpu_executable =
-      new GpuExecutable(*ptx, std::move(thunk_schedule), std::move(module),
-                        std::move(buffer_assignment), ShapeSizeBytesFunction());
+      new GpuExecutable(std::move(kernel_ptx), std::move(thunk_schedule),
+                        std::move(module), std::move(buffer_assignment),
+                        ShapeSizeBytesFunction());
   if (flags->xla_gpu_embed_ir) {
     DCHECK_NE("", ir_module_string_before_opt);
     gpu_executable->set_ir_module_string(ir_module_string_before_opt);
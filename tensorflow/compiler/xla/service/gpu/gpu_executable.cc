@@ -108,15 +108,20 @@ class HloExecutionProfiler {
 // Implementation note: HLO profiling is always enabled for GPU executables,
 // since we can use timers around thunks.
 GpuExecutable::GpuExecutable(
-    tensorflow::StringPiece ptx, std::unique_ptr<ThunkSchedule> thunk_schedule,
+    std::unordered_map<string, tensorflow::StringPiece> kernel_ptx,
+    std::unique_ptr<ThunkSchedule> thunk_schedule,
     std::unique_ptr<HloModule> hlo_module,
     std::unique_ptr<BufferAssignment> assignment,
     HloCostAnalysis::ShapeSizeFunction shape_size_function)
     : Executable(std::move(hlo_module), std::move(shape_size_function)),
-      ptx_(ptx),
+      kernel_ptx_(std::move(kernel_ptx)),
       thunk_schedule_(std::move(thunk_schedule)),
       assignment_(std::move(assignment)) {}
 
+tensorflow::StringPiece GpuExecutable::ptx(const string& kernel_name) const {
+  return FindOrDie(kernel_ptx_, kernel_name);
+}
+
 Status GpuExecutable::ExecuteThunks(
     const ServiceExecutableRunOptions* run_options,
     const BufferAllocations& buffer_allocations, bool block_host_until_done,
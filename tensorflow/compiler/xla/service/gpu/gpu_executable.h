@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/device_memory_allocator.h"
@@ -47,7 +48,9 @@ namespace gpu {
 // This is an immutable data type after initialization, and thus thread safe.
 class GpuExecutable : public Executable {
  public:
-  GpuExecutable(tensorflow::StringPiece ptx,
+  // 'kernel_ptx' maps the name of each kernel to the compiled PTX module
+  // defining it: the kernels may be compiled to several PTX modules.
+  GpuExecutable(std::unordered_map<string, tensorflow::StringPiece> kernel_ptx,
                 std::unique_ptr<ThunkSchedule> thunk_schedule,
                 std::unique_ptr<HloModule> hlo_module,
                 std::unique_ptr<BufferAssignment> assignment,
@@ -61,8 +64,8 @@ class GpuExecutable : public Executable {
     ir_module_string_ = ir_module_string;
   }
 
-  // Returns the compiled PTX for the computation.
-  tensorflow::StringPiece ptx() const { return ptx_; }
+  // Returns the compiled PTX module defining the kernel named 'kernel_name'.
+  tensorflow::StringPiece ptx(const string& kernel_name) const;
 
   StatusOr<perftools::gputools::DeviceMemoryBase> ExecuteOnStream(
       const ServiceExecutableRunOptions* run_options,
@@ -103,8 +106,9 @@ class GpuExecutable : public Executable {
   // This string should be modified only before ExecuteOnStream.
   string ir_module_string_;
 
-  // The reference to the compiled PTX for the computation.
-  const tensorflow::StringPiece ptx_;
+  // The references to the compiled PTX modules defining the kernels of the
+  // computation, by kernel name.
+  const std::unordered_map<string, tensorflow::StringPiece> kernel_ptx_;
 
   // The thunks to be invoked by this GpuExecutable. They are generated by the
   // IrEmitter.
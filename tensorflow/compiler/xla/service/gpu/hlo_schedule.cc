@@ -187,12 +187,17 @@ HloSchedule::HloSchedule() {}
 /* static */
 StatusOr<std::unique_ptr<HloSchedule>> HloSchedule::Build(
     const HloModule& module, const StreamAssignment& stream_assignment,
-    int64 pointer_size) {
+    int64 pointer_size,
+    const std::vector<const HloInstruction*>* entry_sequence) {
   std::unique_ptr<HloSchedule> schedule(new HloSchedule);
 
   // Initialize thunk_launch_order_, the total order of thunk launches.
   const HloComputation* entry_computation = module.entry_computation();
-  if (stream_assignment.StreamCount() == 1) {
+  if (entry_sequence != nullptr) {
+    TF_RET_CHECK(entry_sequence->size() ==
+                 entry_computation->instruction_count());
+    schedule->thunk_launch_order_ = *entry_sequence;
+  } else if (stream_assignment.StreamCount() == 1) {
     // All kernels are launched on a single stream, so there's no loss of
     // concurrency by optimizing for minimal memory usage.
     TF_ASSIGN_OR_RETURN(
@@ -37,10 +37,12 @@ namespace gpu {
 class HloSchedule {
  public:
   // Constructs an HloSchedule for the given module, based on the given stream
-  // assignment.
+  // assignment. If 'entry_sequence' is non-null, it is used as the total order
+  // of thunk launches, e.g. the order rematerialization reduced memory use for.
   static StatusOr<std::unique_ptr<HloSchedule>> Build(
       const HloModule& module, const StreamAssignment& stream_assignment,
-      int64 pointer_size);
+      int64 pointer_size,
+      const std::vector<const HloInstruction*>* entry_sequence = nullptr);
 
   // Returns the total order of thunk launches, represented in terms of HLO
   // instructions.
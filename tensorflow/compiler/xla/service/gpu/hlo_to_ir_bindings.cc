@@ -34,8 +34,10 @@ void HloToIrBindings::EmitBasePointersForHlos(
   // I/O HLOs are bound to the arguments of the current IR function. I.e.,
   //
   // void IrFunction(io_0, io_1, ..., io_{m-1}, temp_buffer_base) {
+  //
+  // Kernels of while loops also take a trailing loop guard argument.
   llvm::Function* function = ir_builder_->GetInsertBlock()->getParent();
-  CHECK_EQ(io_hlos.size() + 1, function->arg_size());
+  CHECK_LE(io_hlos.size() + 1, function->arg_size());
 
   // An HLO can have duplicated operands. This data structure remembers which
   // operand HLOs are already bound to avoid rebinding the same HLO.
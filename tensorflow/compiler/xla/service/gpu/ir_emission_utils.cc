@@ -150,6 +150,27 @@ bool IsReductionToVector(const HloInstruction& reduce) {
                                               input->shape()));
 }
 
+int64 RowReductionTileSize(int64 depth, int64 height, int64 width,
+                           int64 min_threads) {
+  // Matches Eigen's RowReduceKernel, and is the largest tile that's used
+  // regardless of the number of threads.
+  constexpr int64 kMinWideRowTileSize = 8;
+  int64 tile_size = 1;
+  while (tile_size < kMaxRowReductionTileSize &&
+         tile_size * kWarpSize < width) {
+    if (tile_size >= kMinWideRowTileSize) {
+      const int64 threads_with_larger_tile =
+          depth * height *
+          RoundUpToNearest(CeilOfRatio(width, 2 * tile_size), kWarpSize);
+      if (threads_with_larger_tile < min_threads) {
+        break;
+      }
+    }
+    tile_size *= 2;
+  }
+  return tile_size;
+}
+
 // This emits a device-side call to
 // "i32 vprintf(i8* fmt, arguments_type* arguments)" in the driver; see
 // http://docs.nvidia.com/cuda/ptx-writers-guide-to-interoperability/index.html#system-calls
@@ -39,6 +39,16 @@ bool ImplementedAsLibraryCall(const HloInstruction& hlo);
 
 bool IsReductionToVector(const HloInstruction& reduce);
 
+// Returns the number of elements each thread reduces when reducing the rows of
+// a [depth, height, width] array over its depth and width, where a warp reduces
+// `kWarpSize` such tiles of a row. The tile is the smallest power of two
+// covering narrow rows in one pass of a warp, and grows up to
+// kMaxRowReductionTileSize for wide rows as long as at least `min_threads`
+// threads still run, which saves atomic operations on the output.
+constexpr int64 kMaxRowReductionTileSize = 64;
+int64 RowReductionTileSize(int64 depth, int64 height, int64 width,
+                           int64 min_threads);
+
 // Emits call to "vprintf" with given format and arguments.
 llvm::Value* EmitPrintf(tensorflow::StringPiece fmt,
                         tensorflow::gtl::ArraySlice<llvm::Value*> arguments,
@@ -0,0 +1,46 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+TEST(IrEmissionUtilsTest, NarrowRowsUseTheSmallestCoveringTile) {
+  EXPECT_EQ(1, RowReductionTileSize(1, 1000, 32, 0));
+  EXPECT_EQ(2, RowReductionTileSize(1, 1000, 33, 0));
+  EXPECT_EQ(4, RowReductionTileSize(1, 1000, 100, 0));
+  // Without enough threads, the tile doesn't grow beyond 8 elements.
+  EXPECT_EQ(8, RowReductionTileSize(1, 1, 256, 1 << 20));
+  EXPECT_EQ(8, RowReductionTileSize(1, 1, 2048, 1 << 20));
+}
+
+TEST(IrEmissionUtilsTest, WideRowsGrowTheTileWhileThreadsRemain) {
+  // 4096 rows of 1024 elements: a single warp per row still runs 128K
+  // threads.
+  EXPECT_EQ(32, RowReductionTileSize(1, 4096, 1024, 100000));
+  // Halving the rows halves the threads, so the tile stops growing earlier.
+  EXPECT_EQ(16, RowReductionTileSize(1, 2048, 1024, 100000));
+  // The tile size is bounded.
+  EXPECT_EQ(kMaxRowReductionTileSize,
+            RowReductionTileSize(1, 4096, 1 << 20, 0));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -369,6 +369,11 @@ class IrEmitterUnnested : public IrEmitter {
   // Whether this computation will produce a hybrid result, that is the
   // computation produces a ShapedBuffer.
   bool has_hybrid_result_;
+
+  // Whether the kernels take the loop guard of a WhileThunk as their last
+  // argument, and return without doing anything when it is zero. Set for the
+  // condition and body of while loops, see WhileThunk.
+  bool emit_loop_guard_ = false;
 };
 
 // Emits LLVM IR for a nested computation to the resultant function.
@@ -172,7 +172,7 @@ llvm::Function* IrEmitterUnnested::BuildKernelPrototype(
   int num_escaped_hlos = escaped_hlos.size();
   llvm::FunctionType* kernel_type = llvm::FunctionType::get(
       llvm::Type::getVoidTy(context),  // The type of function result.
-      std::vector<llvm::Type*>(num_escaped_hlos + 1,
+      std::vector<llvm::Type*>(num_escaped_hlos + (emit_loop_guard_ ? 2 : 1),
                                ir_builder_.getInt8PtrTy()),
       false);  // Not a variadic argument function.
   llvm::Function* kernel =
@@ -188,11 +188,11 @@ llvm::Function* IrEmitterUnnested::BuildKernelPrototype(
     kernel->addDereferenceableAttr(arg_no + 1, escaped_hlo_size);
   }
 
-  // The last argument is a pointer to the temporary buffer memory block.
-  // We know that it doesn't alias any of the escaped arguments (the inputs +
-  // the result).  We also know how many bytes can be dereferenced in it.
-  const llvm::Argument& temp_buffer = *std::prev(kernel->arg_end());
-  int64 temp_buffer_arg_no = temp_buffer.getArgNo();
+  // The argument after the escaped HLOs is a pointer to the temporary buffer
+  // memory block. We know that it doesn't alias any of the escaped arguments
+  // (the inputs + the result).  We also know how many bytes can be
+  // dereferenced in it.
+  int64 temp_buffer_arg_no = num_escaped_hlos;
   if (const BufferAllocation* allocation =
           ir_emitter_context_->buffer_assignment().GetTempAllocation()) {
     kernel->addDereferenceableAttr(temp_buffer_arg_no + 1, allocation->size());
@@ -213,6 +213,27 @@ llvm::Function* IrEmitterUnnested::BuildKernelPrototype(
       llvm::BasicBlock::Create(context,
                                "entry",  // The name of the basic block.
                                kernel);  // The parent/owner of "entry_bb".
+  if (emit_loop_guard_) {
+    // The last argument points to the loop guard of the enclosing WhileThunk,
+    // which is zero once the loop has exited. The kernel then returns right
+    // away, so that iterations launched past the end of the loop are no-ops.
+    llvm::Argument* loop_guard = &*std::prev(kernel->arg_end());
+    loop_guard->setName("loop_guard");
+    kernel->addAttribute(loop_guard->getArgNo() + 1, llvm::Attribute::NoAlias);
+    kernel->addDereferenceableAttr(loop_guard->getArgNo() + 1, 1);
+    llvm::BasicBlock* body_bb =
+        llvm::BasicBlock::Create(context, "loop_guard.body", kernel);
+    llvm::BasicBlock* exit_bb =
+        llvm::BasicBlock::Create(context, "loop_guard.exit", kernel);
+    ir_builder_.SetInsertPoint(entry_bb);
+    llvm::Value* in_loop = ir_builder_.CreateICmpNE(
+        ir_builder_.CreateLoad(loop_guard, "loop_guard.value"),
+        ir_builder_.getInt8(0));
+    ir_builder_.CreateCondBr(in_loop, body_bb, exit_bb);
+    llvm::ReturnInst::Create(context, exit_bb);
+    entry_bb = body_bb;
+  }
+
   // Emit a "return void" at entry_bb's end, and sets the insert point before
   // that return instruction.
   ir_builder_.SetInsertPoint(llvm::ReturnInst::Create(context, entry_bb));
@@ -449,6 +470,65 @@ Status IrEmitterUnnested::HandleFusion(HloInstruction* fusion) {
                                launch_dimensions, &ir_builder_)
         .EmitLoop();
   }
+  if (fusion->IsMultiOutputFusion()) {
+    // Multi-output loop fusion. The addresses of the buffers of the outputs are
+    // first copied to the output tuple, which the kernel reads them from and
+    // then computes all the outputs in one loop over their dimensions.
+    CHECK(HloInstruction::FusionKind::kLoop == fusion->fusion_kind());
+    const BufferAssignment& buffer_assignment =
+        ir_emitter_context_->buffer_assignment();
+    std::vector<BufferAllocation::Slice> output_buffers;
+    for (int64 i = 0; i < root->operand_count(); ++i) {
+      TF_ASSIGN_OR_RETURN(BufferAllocation::Slice output_buffer,
+                          buffer_assignment.GetUniqueSlice(fusion, {i}));
+      output_buffers.push_back(output_buffer);
+    }
+    std::vector<std::unique_ptr<Thunk>> thunks;
+    thunks.emplace_back(MakeUnique<TupleThunk>(
+        output_buffers, GetAllocationSlice(*fusion), fusion));
+    thunks.emplace_back(BuildKernelThunk(fusion));
+    KernelThunk* kernel_thunk = static_cast<KernelThunk*>(thunks.back().get());
+    thunk_sequence_->emplace_back(
+        MakeUnique<SequentialThunk>(std::move(thunks), fusion));
+
+    std::vector<llvm_ir::IrArray> parameter_arrays;
+    for (HloInstruction* operand : fusion->operands()) {
+      parameter_arrays.push_back(GetIrArray(*operand));
+    }
+    GpuElementalIrEmitter elemental_emitter(hlo_module_config_,
+                                            ir_emitter_context_->llvm_module(),
+                                            &ir_builder_, GetNestedComputer());
+    FusedIrEmitter fused_emitter(parameter_arrays, &elemental_emitter);
+    TF_RETURN_IF_ERROR(root->Accept(&fused_emitter));
+
+    std::vector<llvm_ir::ElementGenerator> output_generators;
+    std::vector<llvm_ir::IrArray> output_arrays;
+    for (int64 i = 0; i < root->operand_count(); ++i) {
+      const Shape& output_shape = fusion->shape().tuple_shapes(i);
+      output_generators.push_back(fused_emitter.GetGenerator(root->operand(i)));
+      output_arrays.emplace_back(
+          llvm_ir::EmitGetTupleElement(output_shape, i, /*alignment=*/1,
+                                       GetBasePointer(*fusion), &ir_builder_),
+          output_shape);
+    }
+    auto loop_body_emitter =
+        [&](const llvm_ir::IrArray::Index& index) -> Status {
+      for (int64 i = 0; i < output_arrays.size(); ++i) {
+        TF_ASSIGN_OR_RETURN(llvm::Value * value, output_generators[i](index));
+        output_arrays[i].EmitWriteArrayElement(index, value, &ir_builder_);
+      }
+      return Status::OK();
+    };
+
+    const Shape& loop_shape = fusion->shape().tuple_shapes(0);
+    LaunchDimensions launch_dimensions = CalculateLaunchDimensions(
+        loop_shape, ir_emitter_context_->device_description());
+    UpdateLaunchDimensions(launch_dimensions, kernel_thunk,
+                           ir_emitter_context_->llvm_module());
+    return ParallelLoopEmitter(loop_body_emitter, loop_shape,
+                               launch_dimensions, &ir_builder_)
+        .EmitLoop();
+  }
   if (ImplementedAsGemm(*fusion)) {
     thunk_sequence_->emplace_back(BuildGemmThunk(fusion));
     return Status::OK();
@@ -931,8 +1011,8 @@ Status IrEmitterUnnested::EmitRowReduction(
   //   int y = linear_index / width_in_tiles % height;
   //   int z = linear_index / (height * width_in_tiles);
   //   float partial_result = 0;
-  //   for (element_id_in_tile : range(kTileSize)) {
-  //     int x = x_in_tiles * kTileSize + element_id_in_tile;
+  //   for (element_id_in_tile : range(tile_size)) {
+  //     int x = x_in_tiles * tile_size + element_id_in_tile;
   //     if (x < width)
   //       partial_result = reducer(partial_result, input[z][y][z]);
   //   }
@@ -966,6 +1046,13 @@ Status IrEmitterUnnested::EmitRowReduction(
   // element_id_in_tile, which makes the code more friendly to optimizations
   // such as LICM.
   //
+  // 4. Select the tile size by shape (see RowReductionTileSize): narrow rows
+  // get small tiles, so that no iteration of the loop on element_id_in_tile is
+  // out of bounds for every thread of the warp, and wide rows get large tiles
+  // while enough threads remain, so that fewer warps accumulate into each
+  // output element. When a single warp covers a row and depth is 1, lane 0
+  // holds the complete result and stores it without an atomic operation.
+  //
   // for (linear_index = threadIdx.x + blockIdx.x * blockDim.x;
   //      linear_index < depth * height * width_in_tiles;
   //      linear_index += blockDim.x * gridDim.x) {
@@ -975,17 +1062,17 @@ Status IrEmitterUnnested::EmitRowReduction(
   //   int warp_id = x_in_tiles / warpSize;
   //   int lane_id = x_in_tiles % warpSize;
   //   float partial_result = 0;
-  //   int x = warp_id * kTileSize * warpSize + lane_id;
-  //   if (width % (kTileSize * warpSize) == 0 ||
-  //       x + (kTileSize - 1) * warpSize < width) {
+  //   int x = warp_id * tile_size * warpSize + lane_id;
+  //   if (width % (tile_size * warpSize) == 0 ||
+  //       x + (tile_size - 1) * warpSize < width) {
   //     // The entire tile is in bounds.
-  //     for (int element_id_in_tile = 0; element_id_in_tile < kTileSize;
+  //     for (int element_id_in_tile = 0; element_id_in_tile < tile_size;
   //        ++element_id_in_tile, x += warpSize) {
   //       partial_result = Reducer(partial_result, input[z][y][x]);
   //     }
   //   } else {
   //     // The tile is partially in bounds.
-  //     for (int element_id_in_tile = 0; element_id_in_tile < kTileSize;
+  //     for (int element_id_in_tile = 0; element_id_in_tile < tile_size;
   //          ++element_id_in_tile, x += warpSize) {
   //       if (x < width)
   //         partial_result = Reducer(partial_result, input[z][y][x]);
@@ -998,13 +1085,17 @@ Status IrEmitterUnnested::EmitRowReduction(
   //   if (lane_id == 0)
   //     AtomicReducer(&output[y], partial_result);
   // }
-  //
-  // Choose 8 as the tile size, which matches Eigen's RowReduceKernel.
-  constexpr int64 kTileSize = 8;
+  const int64 tile_size = RowReductionTileSize(
+      depth, height, width,
+      ir_emitter_context_->device_description().core_count() *
+          ir_emitter_context_->device_description().threads_per_core_limit());
   // Round the width in tiles up to the nearest multiple of kWarpSize, so that
   // the use of shfl_down is valid.
   const int64 width_in_tiles =
-      RoundUpToNearest(CeilOfRatio(width, kTileSize), kWarpSize);
+      RoundUpToNearest(CeilOfRatio(width, tile_size), kWarpSize);
+  // Whether lane 0 of each warp computes the complete reduction of a row.
+  const bool warp_reduces_whole_row =
+      depth == 1 && width_in_tiles == kWarpSize;
 
   auto loop_body_emitter =
       [=](const llvm_ir::IrArray::Index& tile_index) -> Status {
@@ -1030,27 +1121,27 @@ Status IrEmitterUnnested::EmitRowReduction(
         x_tile, ir_builder_.getInt64(kWarpSize), "lane_id");
 
     // The x-location of the last element in this tile.
-    //   last_x = lane_id + warpSize * (kTileSize - 1 + warp_id * kTileSize);
+    //   last_x = lane_id + warpSize * (tile_size - 1 + warp_id * tile_size);
     llvm::Value* last_x = ir_builder_.CreateNSWAdd(
         lane_id,
         ir_builder_.CreateNSWMul(
             ir_builder_.getInt64(kWarpSize),
             ir_builder_.CreateNSWAdd(
-                ir_builder_.getInt64(kTileSize - 1),
+                ir_builder_.getInt64(tile_size - 1),
                 ir_builder_.CreateNSWMul(warp_id,
-                                         ir_builder_.getInt64(kTileSize)))));
+                                         ir_builder_.getInt64(tile_size)))));
 
     auto emit_tile_element_loop = [=](bool tile_in_bounds) -> Status {
       std::unique_ptr<llvm_ir::ForLoop> tile_element_loop =
           llvm_ir::ForLoop::EmitForLoop("element_id_in_tile",
                                         ir_builder_.getInt64(0),
-                                        ir_builder_.getInt64(kTileSize),
+                                        ir_builder_.getInt64(tile_size),
                                         ir_builder_.getInt64(1), &ir_builder_);
 
       // Emit the body of the partial reduction loop.
       llvm_ir::SetToFirstInsertPoint(tile_element_loop->GetBodyBasicBlock(),
                                      &ir_builder_);
-      // x = lane_id + warpSize * (element_id_in_tile + warp_id * kTileSize);
+      // x = lane_id + warpSize * (element_id_in_tile + warp_id * tile_size);
       llvm::Value* x = ir_builder_.CreateNSWAdd(
           lane_id,
           ir_builder_.CreateNSWMul(
@@ -1058,7 +1149,7 @@ Status IrEmitterUnnested::EmitRowReduction(
               ir_builder_.CreateNSWAdd(
                   tile_element_loop->GetIndVarValue(),
                   ir_builder_.CreateNSWMul(warp_id,
-                                           ir_builder_.getInt64(kTileSize)))));
+                                           ir_builder_.getInt64(tile_size)))));
 
       // Unless we know the tile is entirely in bounds, we have to emit a
       // x-in-bounds check before reading from the input.
@@ -1108,7 +1199,7 @@ Status IrEmitterUnnested::EmitRowReduction(
     };
 
     llvm::Value* tile_in_bounds = ir_builder_.CreateOr(
-        ir_builder_.getInt1(width % (kTileSize * kWarpSize) == 0),
+        ir_builder_.getInt1(width % (tile_size * kWarpSize) == 0),
         ir_builder_.CreateICmpULT(last_x, ir_builder_.getInt64(width)));
     llvm_ir::LlvmIfData if_tile_in_bounds_data =
         llvm_ir::EmitIfThenElse(tile_in_bounds, "tile_in_bounds", &ir_builder_);
@@ -1153,6 +1244,14 @@ Status IrEmitterUnnested::EmitRowReduction(
     llvm::Value* output_address = GetIrArray(*output).EmitArrayElementAddress(
         llvm_ir::IrArray::Index(y, output->shape(), &ir_builder_), &ir_builder_,
         "output_element_address");
+    if (warp_reduces_whole_row) {
+      // The partial result started from the init value, and no other warp
+      // writes this output element.
+      ir_builder_.CreateStore(
+          ir_builder_.CreateLoad(partial_reduction_result_address),
+          output_address);
+      return Status::OK();
+    }
     return EmitAtomicOperationForNestedComputation(
         *reducer, output_address, partial_reduction_result_address);
   };
@@ -1843,6 +1942,7 @@ std::unique_ptr<Thunk> IrEmitterUnnested::BuildWhileThunk(
   IrEmitterUnnested ir_emitter_condition(hlo_module_config_, condition,
                                          /*has_hybrid_result=*/false,
                                          ir_emitter_context_);
+  ir_emitter_condition.emit_loop_guard_ = true;
   TF_CHECK_OK(condition->root_instruction()->Accept(&ir_emitter_condition));
 
   // Generate thunk sequence for while 'body'.
@@ -1850,6 +1950,7 @@ std::unique_ptr<Thunk> IrEmitterUnnested::BuildWhileThunk(
   IrEmitterUnnested ir_emitter_body(hlo_module_config_, body,
                                     false /* has_hybrid_result */,
                                     ir_emitter_context_);
+  ir_emitter_body.emit_loop_guard_ = true;
   TF_CHECK_OK(body->root_instruction()->Accept(&ir_emitter_body));
 
   return MakeUnique<WhileThunk>(
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/ptr_util.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
+#include "tensorflow/compiler/xla/service/gpu/while_thunk.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -42,8 +43,9 @@ tensorflow::Status KernelThunk::Initialize(const GpuExecutable& executable) {
     return tensorflow::Status::OK();
   }
 
-  loader_spec_.reset(new se::MultiKernelLoaderSpec(io_buffers_.size() + 1));
-  tensorflow::StringPiece ptx = executable.ptx();
+  loader_spec_.reset(new se::MultiKernelLoaderSpec(
+      io_buffers_.size() + (guarding_loop_ != nullptr ? 2 : 1)));
+  tensorflow::StringPiece ptx = executable.ptx(kernel_name_);
   // Convert tensorflow::StringPiece to se::port::StringPiece because
   // StreamExecutor uses the latter.
   loader_spec_->AddCudaPtxInMemory(
@@ -84,6 +86,10 @@ tensorflow::Status KernelThunk::ExecuteOnStream(
   }
   kernel_args->add_device_memory_argument(
       buffer_allocations.GetTempBufferBase());
+  if (guarding_loop_ != nullptr) {
+    kernel_args->add_device_memory_argument(
+        guarding_loop_->loop_guard(stream));
+  }
   if (!stream->parent()->Launch(
           stream, se::ThreadDim(launch_dimensions.threads_per_block()),
           se::BlockDim(launch_dimensions.block_count()), *kernel,
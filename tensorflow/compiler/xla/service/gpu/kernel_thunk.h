@@ -35,6 +35,7 @@ namespace xla {
 namespace gpu {
 
 class GpuExecutable;
+class WhileThunk;
 
 // This class stores everything that StreamExecutor needs for launching a
 // kernel. It implements the ExecuteOnStream interface for GpuExecutable to
@@ -55,6 +56,11 @@ class KernelThunk : public Thunk {
   const string& kernel_name() const { return kernel_name_; }
   void SetLaunchDimensions(const LaunchDimensions& launch_dims);
 
+  // Passes the loop guard of 'loop' to the kernel as its last argument. Must
+  // be called for the kernels emitted for the condition and body of 'loop',
+  // before Initialize.
+  void SetLoopGuard(const WhileThunk* loop) { guarding_loop_ = loop; }
+
   tensorflow::Status Initialize(const GpuExecutable& executable) override;
 
   // Executes the kernel for the thunk on "stream", which must be non-null.
@@ -69,6 +75,9 @@ class KernelThunk : public Thunk {
   // Entry kernel name for the computation.
   const string kernel_name_;
 
+  // The while loop whose loop guard the kernel takes, or nullptr.
+  const WhileThunk* guarding_loop_ = nullptr;
+
   // The thread and block dimension used to launch the kernel.
   // Will be set by IrEmitterUnnested.
   LaunchDimensions launch_dimensions_;
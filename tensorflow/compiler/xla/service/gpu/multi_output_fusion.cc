@@ -0,0 +1,242 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/call_graph.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+int64 ShapeSizeBytes(const Shape& shape) {
+  return ShapeUtil::IsOpaque(shape)
+             ? 0
+             : ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/sizeof(void*));
+}
+
+// Returns true if 'instruction' is a single-output loop fusion which can be
+// merged into a multi-output fusion.
+bool IsMergeableLoopFusion(const HloInstruction& instruction) {
+  return instruction.opcode() == HloOpcode::kFusion &&
+         instruction.fusion_kind() == HloInstruction::FusionKind::kLoop &&
+         !instruction.IsMultiOutputFusion() &&
+         ShapeUtil::IsArray(instruction.shape()) &&
+         // Emitted in place by IrEmitterUnnested.
+         instruction.fused_expression_root()->opcode() !=
+             HloOpcode::kDynamicUpdateSlice &&
+         instruction.control_predecessors().empty() &&
+         instruction.control_successors().empty() &&
+         instruction.parent()->root_instruction() != &instruction;
+}
+
+// Returns the bytes of the operands read by both 'a' and 'b'.
+int64 SharedOperandBytes(const HloInstruction& a, const HloInstruction& b) {
+  std::vector<const HloInstruction*> shared;
+  for (const HloInstruction* operand : a.operands()) {
+    if (b.IsUserOf(operand) &&
+        std::find(shared.begin(), shared.end(), operand) == shared.end()) {
+      shared.push_back(operand);
+    }
+  }
+  int64 bytes = 0;
+  for (const HloInstruction* operand : shared) {
+    bytes += ShapeSizeBytes(operand->shape());
+  }
+  return bytes;
+}
+
+// A pair of loop fusions to merge. If 'second' uses 'first', 'first' is the
+// producer and 'second' the consumer.
+struct Candidate {
+  HloInstruction* first;
+  HloInstruction* second;
+  // The bytes no longer accessed once the fusions are merged.
+  int64 saved_bytes;
+};
+
+// Merges the pairs of loop fusions of a computation into multi-output fusions.
+class MultiOutputFusionMerger {
+ public:
+  explicit MultiOutputFusionMerger(HloComputation* computation)
+      : computation_(computation) {}
+
+  StatusOr<bool> Run();
+
+ private:
+  // Returns the most profitable pair of fusions to merge, if any.
+  StatusOr<bool> FindBestCandidate(Candidate* best);
+
+  // Returns true if merging 'candidate' is legal and profitable.
+  bool ShouldMerge(const Candidate& candidate,
+                   const HloComputation::ReachabilityMap& reachability,
+                   const HloCostAnalysis& cost_analysis) const;
+
+  // Replaces the fusions of 'candidate' by a multi-output fusion.
+  Status Merge(const Candidate& candidate);
+
+  HloComputation* computation_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MultiOutputFusionMerger);
+};
+
+StatusOr<bool> MultiOutputFusionMerger::Run() {
+  bool changed = false;
+  Candidate candidate;
+  while (true) {
+    TF_ASSIGN_OR_RETURN(bool found, FindBestCandidate(&candidate));
+    if (!found) {
+      break;
+    }
+    VLOG(2) << "Merging " << candidate.first->name() << " and "
+            << candidate.second->name() << " saving " << candidate.saved_bytes
+            << " bytes";
+    TF_RETURN_IF_ERROR(Merge(candidate));
+    changed = true;
+  }
+  return changed;
+}
+
+StatusOr<bool> MultiOutputFusionMerger::FindBestCandidate(Candidate* best) {
+  // Each merge changes the dependencies between the remaining fusions, so the
+  // analyses are redone after each of them.
+  std::unique_ptr<HloComputation::ReachabilityMap> reachability =
+      computation_->ComputeTransitiveOperands();
+  HloCostAnalysis cost_analysis(ShapeSizeBytes);
+  TF_RETURN_IF_ERROR(computation_->Accept(&cost_analysis));
+
+  bool found = false;
+  auto consider = [&](const Candidate& candidate) {
+    if ((!found || candidate.saved_bytes > best->saved_bytes) &&
+        ShouldMerge(candidate, *reachability, cost_analysis)) {
+      *best = candidate;
+      found = true;
+    }
+  };
+  for (const auto& instruction : computation_->instructions()) {
+    HloInstruction* first = instruction.get();
+    // Siblings reading the output of 'first'.
+    const std::vector<HloInstruction*>& users = first->users();
+    for (auto a = users.begin(); a != users.end(); ++a) {
+      if (!IsMergeableLoopFusion(**a)) {
+        continue;
+      }
+      for (auto b = std::next(a); b != users.end(); ++b) {
+        if (IsMergeableLoopFusion(**b)) {
+          consider({*a, *b, SharedOperandBytes(**a, **b)});
+        }
+      }
+    }
+    // Consumers of 'first' with other users.
+    if (!IsMergeableLoopFusion(*first) || first->user_count() < 2) {
+      continue;
+    }
+    for (HloInstruction* second : users) {
+      if (IsMergeableLoopFusion(*second)) {
+        consider({first, second, ShapeSizeBytes(first->shape()) +
+                                     SharedOperandBytes(*first, *second)});
+      }
+    }
+  }
+  return found;
+}
+
+bool MultiOutputFusionMerger::ShouldMerge(
+    const Candidate& candidate,
+    const HloComputation::ReachabilityMap& reachability,
+    const HloCostAnalysis& cost_analysis) const {
+  const HloInstruction* first = candidate.first;
+  const HloInstruction* second = candidate.second;
+  // The outputs are computed by the same loop.
+  if (!ShapeUtil::SameDimensions(first->shape(), second->shape())) {
+    return false;
+  }
+  if (second->IsUserOf(first)) {
+    // The other operands of the consumer can't depend on the producer, since
+    // they would then depend on the merged fusion.
+    for (const HloInstruction* operand : second->operands()) {
+      if (operand != first && reachability.IsReachable(operand, first)) {
+        return false;
+      }
+    }
+  } else if (reachability.IsConnected(first, second)) {
+    return false;
+  }
+  const int64 bytes_accessed = cost_analysis.bytes_accessed(*first) +
+                               cost_analysis.bytes_accessed(*second);
+  return candidate.saved_bytes > 0 &&
+         candidate.saved_bytes >=
+             MultiOutputFusion::GetThresholdSavedBytesFraction() *
+                 bytes_accessed;
+}
+
+Status MultiOutputFusionMerger::Merge(const Candidate& candidate) {
+  HloInstruction* first = candidate.first;
+  HloInstruction* second = candidate.second;
+  HloInstruction* tuple = computation_->AddInstruction(
+      HloInstruction::CreateTuple({first, second}));
+  HloInstruction* fusion =
+      computation_->AddInstruction(HloInstruction::CreateFusion(
+          tuple->shape(), HloInstruction::FusionKind::kLoop, tuple));
+  TF_RETURN_IF_ERROR(computation_->RemoveInstruction(tuple));
+  // The consumer is merged first, so that its use of the producer becomes a
+  // use of the producer merged next.
+  fusion->MergeFusionInstruction(second);
+  fusion->MergeFusionInstruction(first);
+
+  // The users of the fusions read their outputs from the tuple, and the
+  // consumer is replaced first since it uses the producer.
+  for (int64 index : {1, 0}) {
+    HloInstruction* merged = index == 0 ? first : second;
+    HloInstruction* output =
+        computation_->AddInstruction(HloInstruction::CreateGetTupleElement(
+            merged->shape(), fusion, index));
+    TF_RETURN_IF_ERROR(computation_->ReplaceInstruction(merged, output));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<bool> MultiOutputFusion::Run(HloModule* module) {
+  bool changed = false;
+  std::unique_ptr<CallGraph> call_graph = CallGraph::Build(module);
+  for (auto& computation : module->computations()) {
+    // The computations applied to each element, e.g. by maps and reductions,
+    // are emitted as nested functions, which can't emit multi-output fusions.
+    if (call_graph->GetNode(computation.get()).context() !=
+        CallContext::kSequential) {
+      continue;
+    }
+    MultiOutputFusionMerger merger(computation.get());
+    TF_ASSIGN_OR_RETURN(bool merged, merger.Run());
+    changed |= merged;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,58 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that merges pairs of loop fusions into multi-output loop fusions,
+// whose fused expression root is a tuple of their outputs, and whose users read
+// these outputs through GetTupleElement instructions. The outputs are computed
+// by a single kernel looping over their common dimensions.
+//
+// Two kinds of pairs are merged:
+//
+// 1) Siblings: fusions reading common operands, neither of which depends on
+//    the other. The merged fusion reads the common operands once.
+// 2) Producer and consumer: a fusion used by other instructions than the
+//    consumer fusion, which the instruction fusion pass therefore didn't fuse
+//    into it. The merged fusion still outputs the producer for its other users,
+//    but the consumer no longer reads it back from memory.
+//
+// The pairs are merged greedily by decreasing number of bytes they stop
+// accessing, as long as it is a significant fraction of the bytes they access
+// according to HloCostAnalysis.
+class MultiOutputFusion : public HloPassInterface {
+ public:
+  tensorflow::StringPiece name() const override {
+    return "multi-output fusion";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // The minimum fraction of the bytes accessed by the two fusions that merging
+  // them must save.
+  static double GetThresholdSavedBytesFraction() { return 0.1; }
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
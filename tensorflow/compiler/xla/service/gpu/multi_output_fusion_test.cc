@@ -0,0 +1,131 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class MultiOutputFusionTest : public HloTestBase {
+ protected:
+  MultiOutputFusionTest() : module_(TestName()) {}
+
+  // Returns a loop fusion of the unary 'opcode' applied to 'operand'.
+  HloInstruction* AddUnaryFusion(HloComputation* computation, HloOpcode opcode,
+                                 HloInstruction* operand) {
+    HloInstruction* unary = computation->AddInstruction(
+        HloInstruction::CreateUnary(data_shape_, opcode, operand));
+    return computation->CreateFusionInstruction(
+        {unary}, HloInstruction::FusionKind::kLoop);
+  }
+
+  HloModule module_;
+  const Shape data_shape_ = ShapeUtil::MakeShape(F32, {1024});
+};
+
+TEST_F(MultiOutputFusionTest, MergesSiblingsReadingTheSameOperand) {
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, data_shape_, "param"));
+  HloComputation* computation = module_.AddEntryComputation(builder.Build());
+  HloInstruction* exp = AddUnaryFusion(computation, HloOpcode::kExp, param);
+  HloInstruction* neg = AddUnaryFusion(computation, HloOpcode::kNegate, param);
+  computation->set_root_instruction(
+      computation->AddInstruction(HloInstruction::CreateTuple({exp, neg})));
+
+  EXPECT_TRUE(MultiOutputFusion().Run(&module_).ValueOrDie());
+
+  const HloInstruction* root = computation->root_instruction();
+  ASSERT_EQ(HloOpcode::kTuple, root->opcode());
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(HloOpcode::kGetTupleElement, root->operand(0)->opcode());
+  EXPECT_EQ(HloOpcode::kGetTupleElement, root->operand(1)->opcode());
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  // The parameter is read once.
+  EXPECT_EQ(1, fusion->operand_count());
+  EXPECT_EQ(param, fusion->operand(0));
+}
+
+TEST_F(MultiOutputFusionTest, KeepsTheProducerAsAnOutputOfTheConsumer) {
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, data_shape_, "param"));
+  HloComputation* computation = module_.AddEntryComputation(builder.Build());
+  HloInstruction* exp = AddUnaryFusion(computation, HloOpcode::kExp, param);
+  HloInstruction* neg = AddUnaryFusion(computation, HloOpcode::kNegate, exp);
+  // The reduction keeps 'exp' from being fused into all its users.
+  HloComputation::Builder add_builder("add");
+  auto x = add_builder.AddInstruction(HloInstruction::CreateParameter(
+      0, ShapeUtil::MakeShape(F32, {}), "x"));
+  auto y = add_builder.AddInstruction(HloInstruction::CreateParameter(
+      1, ShapeUtil::MakeShape(F32, {}), "y"));
+  add_builder.AddInstruction(HloInstruction::CreateBinary(
+      ShapeUtil::MakeShape(F32, {}), HloOpcode::kAdd, x, y));
+  HloComputation* add = module_.AddEmbeddedComputation(add_builder.Build());
+  auto zero = computation->AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(0.0f)));
+  auto sum = computation->AddInstruction(HloInstruction::CreateReduce(
+      ShapeUtil::MakeShape(F32, {}), exp, zero, {0}, add));
+  computation->set_root_instruction(
+      computation->AddInstruction(HloInstruction::CreateTuple({neg, sum})));
+
+  EXPECT_TRUE(MultiOutputFusion().Run(&module_).ValueOrDie());
+
+  const HloInstruction* root = computation->root_instruction();
+  const HloInstruction* neg_output = root->operand(0);
+  const HloInstruction* exp_output = root->operand(1)->operand(0);
+  ASSERT_EQ(HloOpcode::kGetTupleElement, neg_output->opcode());
+  ASSERT_EQ(HloOpcode::kGetTupleElement, exp_output->opcode());
+  EXPECT_EQ(neg_output->operand(0), exp_output->operand(0));
+  EXPECT_EQ(1, neg_output->tuple_index());
+  EXPECT_EQ(0, exp_output->tuple_index());
+  const HloInstruction* fusion = neg_output->operand(0);
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_EQ(param, fusion->operand(0));
+  EXPECT_EQ(1, fusion->operand_count());
+}
+
+TEST_F(MultiOutputFusionTest, DoesNotMergeDependentSiblings) {
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, data_shape_, "param"));
+  HloComputation* computation = module_.AddEntryComputation(builder.Build());
+  HloInstruction* exp = AddUnaryFusion(computation, HloOpcode::kExp, param);
+  // 'copy' depends on 'exp' through an unfused instruction, so merging 'exp'
+  // into 'add' would create a cycle.
+  auto copy = computation->AddInstruction(
+      HloInstruction::CreateUnary(data_shape_, HloOpcode::kCopy, exp));
+  auto binary = computation->AddInstruction(HloInstruction::CreateBinary(
+      data_shape_, HloOpcode::kAdd, param, copy));
+  HloInstruction* add = computation->CreateFusionInstruction(
+      {binary}, HloInstruction::FusionKind::kLoop);
+  computation->set_root_instruction(
+      computation->AddInstruction(HloInstruction::CreateTuple({exp, add})));
+
+  EXPECT_FALSE(MultiOutputFusion().Run(&module_).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,129 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/while_loop_unroller.h"
+
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/compiler/xla/map_util.h"
+#include "tensorflow/compiler/xla/service/gpu/while_transformer.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Returns whether 'computation', or a computation it calls, has instructions
+// whose order isn't given by their data dependencies.
+bool HasSideEffects(const HloComputation& computation) {
+  for (const auto& instruction : computation.instructions()) {
+    switch (instruction->opcode()) {
+      case HloOpcode::kCustomCall:
+      case HloOpcode::kInfeed:
+      case HloOpcode::kOutfeed:
+      case HloOpcode::kRecv:
+      case HloOpcode::kSend:
+        return true;
+      default:
+        break;
+    }
+    if (!instruction->control_predecessors().empty()) {
+      return true;
+    }
+    for (const HloComputation* called : instruction->called_computations()) {
+      if (HasSideEffects(*called)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Adds a copy of the instructions of 'body' to 'computation', taking
+// 'loop_state' as parameter, and returns the copy of the root of 'body'.
+HloInstruction* AddBodyCopy(const HloComputation& body,
+                            HloInstruction* loop_state,
+                            HloComputation* computation) {
+  std::unordered_map<const HloInstruction*, HloInstruction*> copies;
+  for (HloInstruction* instruction : body.MakeInstructionPostOrder()) {
+    if (instruction->opcode() == HloOpcode::kParameter) {
+      InsertOrDie(&copies, instruction, loop_state);
+      continue;
+    }
+    std::vector<HloInstruction*> operands;
+    for (HloInstruction* operand : instruction->operands()) {
+      operands.push_back(FindOrDie(copies, operand));
+    }
+    InsertOrDie(&copies, instruction,
+                computation->AddInstruction(instruction->CloneWithNewOperands(
+                    instruction->shape(), operands)));
+  }
+  return FindOrDie(copies, body.root_instruction());
+}
+
+}  // namespace
+
+StatusOr<bool> WhileLoopUnroller::Run(HloModule* module) {
+  bool changed = false;
+  for (const auto& computation : module->computations()) {
+    std::vector<HloInstruction*> while_instructions;
+    for (const auto& instruction : computation->instructions()) {
+      if (instruction->opcode() == HloOpcode::kWhile) {
+        while_instructions.push_back(instruction.get());
+      }
+    }
+
+    for (HloInstruction* xla_while : while_instructions) {
+      auto loop = CanTransformWhileToFor(xla_while);
+      if (!loop.ok()) {
+        VLOG(2) << "Not unrolling " << xla_while->name() << ": "
+                << loop.status();
+        continue;
+      }
+      int64 loop_start, loop_limit, loop_increment;
+      std::tie(loop_start, loop_limit, loop_increment) = loop.ValueOrDie();
+      const int64 trip_count =
+          (loop_limit - loop_start + loop_increment - 1) / loop_increment;
+      const HloComputation& body = *xla_while->while_body();
+      if (trip_count * body.instruction_count() >
+              max_unrolled_instruction_count_ ||
+          HasSideEffects(body) ||
+          HasSideEffects(*xla_while->while_condition())) {
+        continue;
+      }
+
+      VLOG(2) << "Unrolling the " << trip_count << " iterations of "
+              << xla_while->name();
+      HloInstruction* loop_state = xla_while->mutable_operand(0);
+      for (int64 i = 0; i < trip_count; ++i) {
+        loop_state = AddBodyCopy(body, loop_state, computation.get());
+      }
+      TF_RETURN_IF_ERROR(
+          computation->ReplaceInstruction(xla_while, loop_state));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
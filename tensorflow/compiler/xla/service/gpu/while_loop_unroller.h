@@ -0,0 +1,52 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_LOOP_UNROLLER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_LOOP_UNROLLER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that fully unrolls the while loops with a known trip count (see
+// CanTransformWhileToFor) whose unrolled body has at most
+// 'max_unrolled_instruction_count' instructions.
+//
+// The while instruction is replaced by one copy of the body computation per
+// iteration, each taking the result of the previous one. This removes the loop
+// overhead, and lets the fusion passes fuse across iterations. The body must
+// not have side effects, whose order the copies wouldn't preserve.
+class WhileLoopUnroller : public HloPassInterface {
+ public:
+  explicit WhileLoopUnroller(int64 max_unrolled_instruction_count = 1024)
+      : max_unrolled_instruction_count_(max_unrolled_instruction_count) {}
+  ~WhileLoopUnroller() override {}
+  tensorflow::StringPiece name() const override {
+    return "while-loop-unroller";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 max_unrolled_instruction_count_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_LOOP_UNROLLER_H_
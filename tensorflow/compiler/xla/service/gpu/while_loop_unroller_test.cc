@@ -0,0 +1,138 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/while_loop_unroller.h"
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class WhileLoopUnrollerTest : public HloTestBase {
+ protected:
+  WhileLoopUnrollerTest()
+      : module_(TestName()),
+        induction_variable_shape_(ShapeUtil::MakeShape(S32, {})),
+        data_shape_(ShapeUtil::MakeShape(F32, {8})),
+        loop_state_shape_(ShapeUtil::MakeTupleShape(
+            {induction_variable_shape_, data_shape_})) {}
+
+  // Builds an entry computation running a loop while its induction variable,
+  // at tuple index 0 of the loop state, is less than 'limit', and returns the
+  // while instruction. The induction variable starts from 0 if 'constant_start'
+  // is true, from a parameter otherwise.
+  HloInstruction* BuildWhileInstruction(int64 limit, bool constant_start) {
+    auto condition_builder = HloComputation::Builder(TestName() + ".Condition");
+    auto condition_state =
+        condition_builder.AddInstruction(HloInstruction::CreateParameter(
+            0, loop_state_shape_, "loop_state"));
+    auto condition_induction_variable =
+        condition_builder.AddInstruction(HloInstruction::CreateGetTupleElement(
+            induction_variable_shape_, condition_state, 0));
+    auto limit_const = condition_builder.AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::CreateR0<int32>(limit)));
+    condition_builder.AddInstruction(HloInstruction::CreateBinary(
+        ShapeUtil::MakeShape(PRED, {}), HloOpcode::kLt,
+        condition_induction_variable, limit_const));
+    HloComputation* condition =
+        module_.AddEmbeddedComputation(condition_builder.Build());
+
+    auto body_builder = HloComputation::Builder(TestName() + ".Body");
+    auto body_state = body_builder.AddInstruction(
+        HloInstruction::CreateParameter(0, loop_state_shape_, "loop_state"));
+    auto induction_variable =
+        body_builder.AddInstruction(HloInstruction::CreateGetTupleElement(
+            induction_variable_shape_, body_state, 0));
+    auto one = body_builder.AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::CreateR0<int32>(1)));
+    auto next_induction_variable =
+        body_builder.AddInstruction(HloInstruction::CreateBinary(
+            induction_variable_shape_, HloOpcode::kAdd, one,
+            induction_variable));
+    auto data = body_builder.AddInstruction(
+        HloInstruction::CreateGetTupleElement(data_shape_, body_state, 1));
+    auto next_data = body_builder.AddInstruction(
+        HloInstruction::CreateUnary(data_shape_, HloOpcode::kExp, data));
+    body_builder.AddInstruction(
+        HloInstruction::CreateTuple({next_induction_variable, next_data}));
+    HloComputation* body = module_.AddEmbeddedComputation(body_builder.Build());
+
+    auto builder = HloComputation::Builder(TestName());
+    auto data_init = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, data_shape_, "data"));
+    auto induction_variable_init =
+        constant_start
+            ? builder.AddInstruction(HloInstruction::CreateConstant(
+                  LiteralUtil::CreateR0<int32>(0)))
+            : builder.AddInstruction(HloInstruction::CreateParameter(
+                  1, induction_variable_shape_, "induction_variable"));
+    auto loop_state_init = builder.AddInstruction(
+        HloInstruction::CreateTuple({induction_variable_init, data_init}));
+    auto xla_while = builder.AddInstruction(HloInstruction::CreateWhile(
+        loop_state_shape_, condition, body, loop_state_init));
+    module_.AddEntryComputation(builder.Build());
+    return xla_while;
+  }
+
+  HloModule module_;
+  const Shape induction_variable_shape_;
+  const Shape data_shape_;
+  const Shape loop_state_shape_;
+};
+
+TEST_F(WhileLoopUnrollerTest, UnrollsLoopsWithKnownTripCount) {
+  BuildWhileInstruction(/*limit=*/3, /*constant_start=*/true);
+
+  EXPECT_TRUE(WhileLoopUnroller().Run(&module_).ValueOrDie());
+
+  int64 exp_count = 0;
+  for (const auto& instruction :
+       module_.entry_computation()->instructions()) {
+    EXPECT_NE(HloOpcode::kWhile, instruction->opcode());
+    if (instruction->opcode() == HloOpcode::kExp) {
+      ++exp_count;
+    }
+  }
+  EXPECT_EQ(3, exp_count);
+  EXPECT_EQ(HloOpcode::kTuple,
+            module_.entry_computation()->root_instruction()->opcode());
+}
+
+TEST_F(WhileLoopUnrollerTest, DoesNotUnrollLongLoops) {
+  HloInstruction* xla_while =
+      BuildWhileInstruction(/*limit=*/1000, /*constant_start=*/true);
+
+  EXPECT_FALSE(WhileLoopUnroller().Run(&module_).ValueOrDie());
+  EXPECT_EQ(xla_while, module_.entry_computation()->root_instruction());
+}
+
+TEST_F(WhileLoopUnrollerTest, DoesNotUnrollLoopsWithUnknownTripCount) {
+  HloInstruction* xla_while =
+      BuildWhileInstruction(/*limit=*/3, /*constant_start=*/false);
+
+  EXPECT_FALSE(WhileLoopUnroller().Run(&module_).ValueOrDie());
+  EXPECT_EQ(xla_while, module_.entry_computation()->root_instruction());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -15,13 +15,53 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/while_thunk.h"
 
+#include <algorithm>
+
 #include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/gpu/kernel_thunk.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/errors.h"
 
+namespace se = ::perftools::gputools;
+
 namespace xla {
 namespace gpu {
 
+namespace {
+
+// The number of iterations of the first speculative batch, which doubles for
+// every batch up to kMaxIterationsPerBatch.
+constexpr int64 kMinIterationsPerBatch = 2;
+constexpr int64 kMaxIterationsPerBatch = 64;
+
+// Passes the loop guard of 'loop' to the kernels of 'thunks', and returns
+// whether all of them can run past the end of the loop without side effects.
+// Nested while loops guard their own kernels.
+bool GuardThunks(const std::vector<std::unique_ptr<Thunk>>& thunks,
+                 const WhileThunk* loop) {
+  bool guarded = true;
+  for (const std::unique_ptr<Thunk>& thunk : thunks) {
+    switch (thunk->kind()) {
+      case Thunk::Kind::kKernel:
+        static_cast<KernelThunk*>(thunk.get())->SetLoopGuard(loop);
+        break;
+      case Thunk::Kind::kSequential:
+        guarded &= GuardThunks(
+            static_cast<SequentialThunk*>(thunk.get())->thunks(), loop);
+        break;
+      case Thunk::Kind::kTuple:
+        // Tuples rewrite the same buffer pointers on every iteration.
+        break;
+      default:
+        guarded = false;
+        break;
+    }
+  }
+  return guarded;
+}
+
+}  // namespace
+
 WhileThunk::WhileThunk(
     const BufferAllocation::Slice& condition_result_buffer_index,
     std::unique_ptr<ThunkSequence> condition_thunk_sequence,
@@ -32,7 +72,13 @@ WhileThunk::WhileThunk(
       condition_thunk_sequence_(MakeUnique<SequentialThunk>(
           std::move(*condition_thunk_sequence), hlo)),
       body_thunk_sequence_(
-          MakeUnique<SequentialThunk>(std::move(*body_thunk_sequence), hlo)) {}
+          MakeUnique<SequentialThunk>(std::move(*body_thunk_sequence), hlo)) {
+  // Both calls guard their kernels, so they must not short-circuit.
+  const bool condition_guarded =
+      GuardThunks(condition_thunk_sequence_->thunks(), this);
+  const bool body_guarded = GuardThunks(body_thunk_sequence_->thunks(), this);
+  speculative_ = condition_guarded && body_guarded;
+}
 
 tensorflow::Status WhileThunk::Initialize(const GpuExecutable& executable) {
   TF_RETURN_IF_ERROR(condition_thunk_sequence_->Initialize(executable));
@@ -40,11 +86,82 @@ tensorflow::Status WhileThunk::Initialize(const GpuExecutable& executable) {
   return tensorflow::Status::OK();
 }
 
+se::DeviceMemoryBase WhileThunk::loop_guard(se::Stream* stream) const {
+  tensorflow::mutex_lock lock(mutex_);
+  auto it = loop_guards_.find(stream);
+  CHECK(it != loop_guards_.end())
+      << "No execution of " << hlo_instruction()->name()
+      << " in flight on stream " << stream;
+  return it->second;
+}
+
 tensorflow::Status WhileThunk::ExecuteOnStream(
-    const BufferAllocations& buffer_allocations,
-    perftools::gputools::Stream* stream) {
+    const BufferAllocations& buffer_allocations, se::Stream* stream) {
+  // The guard takes four bytes so that it can be set with a 32-bit memset,
+  // only its first byte is read.
+  const int device_ordinal = buffer_allocations.device_ordinal();
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase guard,
+      buffer_allocations.memory_allocator()->Allocate(device_ordinal, 4));
+  {
+    tensorflow::mutex_lock lock(mutex_);
+    loop_guards_[stream] = guard;
+  }
+  stream->ThenMemset32(&guard, 0x01010101, 4);
+
+  tensorflow::Status status =
+      speculative_ ? ExecuteSpeculatively(buffer_allocations, stream, &guard)
+                   : ExecuteSynchronously(buffer_allocations, stream);
+
+  {
+    tensorflow::mutex_lock lock(mutex_);
+    loop_guards_.erase(stream);
+  }
+  // Both paths wait for the stream when they succeed, but the kernels of an
+  // iteration which failed midway may still read the guard.
+  if (!status.ok()) {
+    stream->BlockHostUntilDone();
+  }
+  TF_RETURN_IF_ERROR(buffer_allocations.memory_allocator()->Deallocate(
+      device_ordinal, &guard));
+  return status;
+}
+
+tensorflow::Status WhileThunk::ExecuteSpeculatively(
+    const BufferAllocations& buffer_allocations, se::Stream* stream,
+    se::DeviceMemoryBase* loop_guard) {
+  se::DeviceMemoryBase condition_result_data =
+      buffer_allocations.GetDeviceAddress(condition_result_buffer_index_);
+
+  int64 batch_size = kMinIterationsPerBatch;
+  while (true) {
+    for (int64 i = 0; i < batch_size; ++i) {
+      // Once the condition is false, its kernels and the body's are no-ops,
+      // so the guard stays zero.
+      TF_RETURN_IF_ERROR(condition_thunk_sequence_->ExecuteOnStream(
+          buffer_allocations, stream));
+      stream->ThenMemcpyD2D(loop_guard, condition_result_data, sizeof(bool));
+      TF_RETURN_IF_ERROR(
+          body_thunk_sequence_->ExecuteOnStream(buffer_allocations, stream));
+    }
+
+    bool in_loop;
+    stream->ThenMemcpy(&in_loop, *loop_guard, sizeof(bool));
+    if (!stream->BlockHostUntilDone()) {
+      return InternalError(
+          "Failed to complete all kernels launched on stream %p", stream);
+    }
+    if (!in_loop) {
+      break;
+    }
+    batch_size = std::min(2 * batch_size, kMaxIterationsPerBatch);
+  }
+  return tensorflow::Status::OK();
+}
 
-  perftools::gputools::DeviceMemoryBase condition_result_data =
+tensorflow::Status WhileThunk::ExecuteSynchronously(
+    const BufferAllocations& buffer_allocations, se::Stream* stream) {
+  se::DeviceMemoryBase condition_result_data =
       buffer_allocations.GetDeviceAddress(condition_result_buffer_index_);
 
   while (true) {
@@ -53,6 +170,7 @@ tensorflow::Status WhileThunk::ExecuteOnStream(
         condition_thunk_sequence_->ExecuteOnStream(buffer_allocations, stream));
 
     // Copy the result of condition computation and break the loop if 'false'.
+    // The loop guard stays set, since the body only runs while it would be.
     bool condition_result;
     stream->ThenMemcpy(&condition_result, condition_result_data, sizeof(bool));
     if (!stream->BlockHostUntilDone()) {
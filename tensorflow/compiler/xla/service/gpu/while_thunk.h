@@ -16,13 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_THUNK_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_THUNK_H_
 
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
 #include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace xla {
 namespace gpu {
@@ -33,8 +36,14 @@ namespace gpu {
 // buffers for the following set of while-related instructions share the same
 // allocation:
 //   init, condition.parameter, body.parameter, body.root, while.result
-// WhileThunk synchronizes the stream to test the result of the 'condition'
-// computation.
+//
+// The kernels of 'condition' and 'body' take a one-byte loop guard, which
+// WhileThunk sets to the result of 'condition' after each evaluation. Once the
+// guard is zero the kernels return right away, so that when both sequences
+// only consist of kernels and tuples, WhileThunk launches batches of
+// iterations speculatively and synchronizes the stream once per batch to test
+// the guard. Otherwise, it synchronizes the stream to test the result of
+// every 'condition' computation.
 class WhileThunk : public Thunk {
  public:
   // Constructs a WhileThunk to compute while instruction 'hlo'.
@@ -50,10 +59,37 @@ class WhileThunk : public Thunk {
       const BufferAllocations& buffer_allocations,
       perftools::gputools::Stream* stream) override;
 
+  // Returns the loop guard of the execution of this loop on 'stream'.
+  perftools::gputools::DeviceMemoryBase loop_guard(
+      perftools::gputools::Stream* stream) const;
+
  private:
+  // Runs iterations in batches of increasing size, which make no progress
+  // past the end of the loop, until the loop guard is found to be zero.
+  tensorflow::Status ExecuteSpeculatively(
+      const BufferAllocations& buffer_allocations,
+      perftools::gputools::Stream* stream,
+      perftools::gputools::DeviceMemoryBase* loop_guard);
+
+  // Runs iterations one at a time, testing the result of 'condition' on the
+  // host before each body.
+  tensorflow::Status ExecuteSynchronously(
+      const BufferAllocations& buffer_allocations,
+      perftools::gputools::Stream* stream);
+
   const BufferAllocation::Slice condition_result_buffer_index_;
   std::unique_ptr<SequentialThunk> condition_thunk_sequence_;
   std::unique_ptr<SequentialThunk> body_thunk_sequence_;
+
+  // Whether all thunks of the loop make no progress once the loop guard is
+  // zero, so that iterations can be launched ahead of the loop condition.
+  bool speculative_ = true;
+
+  // The loop guards of the executions in flight, keyed by stream.
+  mutable tensorflow::mutex mutex_;
+  std::unordered_map<perftools::gputools::Stream*,
+                     perftools::gputools::DeviceMemoryBase>
+      loop_guards_ GUARDED_BY(mutex_);
 };
 
 }  // namespace gpu
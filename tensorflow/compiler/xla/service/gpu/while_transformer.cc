@@ -243,6 +243,7 @@ class WhileConditionComputationMatcher : public MatcherBase {
   explicit WhileConditionComputationMatcher(const HloComputation* computation)
       : computation_(computation) {
     expr_trees_.emplace_back(BuildCondExprTree());
+    expr_trees_.emplace_back(BuildUnfusedCondExprTree());
   }
 
   int64 loop_limit() const { return loop_limit_; }
@@ -276,6 +277,21 @@ class WhileConditionComputationMatcher : public MatcherBase {
     return root;
   }
 
+  // Builds expression tree for the condition computation before fusion:
+  //
+  //     Parameter
+  //         |
+  //        GTE   Const
+  //          \   /
+  //         LessThan
+  //
+  ExprTree BuildUnfusedCondExprTree() {
+    return ExprTree(HloOpcode::kLt,
+                    ExprTree(HloOpcode::kGetTupleElement, "gte",
+                             ExprTree(HloOpcode::kParameter, "param0")),
+                    ExprTree(HloOpcode::kConstant, "loop_limit"));
+  }
+
   Status MatchExprTree(const ExprTree& expr_tree) override {
     VLOG(2) << "MATCHING while condition";
     ExprTree::TaggedInstructionMap tagged_instructions;
@@ -302,6 +318,11 @@ class WhileConditionComputationMatcher : public MatcherBase {
                              param0->name().c_str());
     }
 
+    if (tagged_instructions.count("gte.fusion_param.param0") == 0) {
+      // The unfused expression tree was matched.
+      return tensorflow::Status::OK();
+    }
+
     // Get tagged 'gte.fusion_param.param0', find its associated fusion operand,
     // and compare it to 'computation_' parameter0.
     TF_ASSIGN_OR_RETURN(
@@ -338,6 +359,7 @@ class WhileInitOperandMatcher : public MatcherBase {
                           const int64 tuple_index)
       : while_hlo_(while_hlo), tuple_index_(tuple_index) {
     expr_trees_.emplace_back(BuildInitExprTree());
+    expr_trees_.emplace_back(BuildUnfusedInitExprTree());
   }
 
   int64 loop_start() const { return loop_start_; }
@@ -361,6 +383,20 @@ class WhileInitOperandMatcher : public MatcherBase {
                           ExprTree(HloOpcode::kConstant, "loop_start"))));
   }
 
+  // Builds expression tree for the while init operand before copy insertion:
+  //
+  //             Const
+  //               |
+  //             Tuple0
+  //               |
+  //             While
+  //
+  ExprTree BuildUnfusedInitExprTree() {
+    return ExprTree(HloOpcode::kWhile, "while",
+                    ExprTree(HloOpcode::kTuple, tuple_index_,
+                             ExprTree(HloOpcode::kConstant, "loop_start")));
+  }
+
   Status MatchExprTree(const ExprTree& expr_tree) override {
     VLOG(2) << "MATCHING while init";
     ExprTree::TaggedInstructionMap tagged_instructions;
@@ -404,6 +440,8 @@ class WhileBodyComputationMatcher : public MatcherBase {
       : computation_(computation), tuple_index_(tuple_index) {
     expr_trees_.emplace_back(BuildBodyExprTree(0, 1));
     expr_trees_.emplace_back(BuildBodyExprTree(1, 0));
+    expr_trees_.emplace_back(BuildUnfusedBodyExprTree(0, 1));
+    expr_trees_.emplace_back(BuildUnfusedBodyExprTree(1, 0));
   }
 
   int64 loop_increment() const { return loop_increment_; }
@@ -442,6 +480,27 @@ class WhileBodyComputationMatcher : public MatcherBase {
     return tuple0;
   }
 
+  // Builds expression tree for the while body computation before fusion and
+  // copy insertion:
+  //
+  //                  Param
+  //                    |
+  //           Const  GTE1
+  //              \   /
+  //               Add
+  //                |
+  //              Tuple0
+  //
+  ExprTree BuildUnfusedBodyExprTree(const int64 const_index,
+                                    const int64 gte_index) {
+    ExprTree gte1(HloOpcode::kGetTupleElement, "gte",
+                  ExprTree(HloOpcode::kParameter, "param0"));
+    ExprTree add(HloOpcode::kAdd, const_index,
+                 ExprTree(HloOpcode::kConstant, "loop_increment"), gte_index,
+                 gte1);
+    return ExprTree(HloOpcode::kTuple, tuple_index_, add);
+  }
+
   Status MatchExprTree(const ExprTree& expr_tree) override {
     VLOG(2) << "MATCHING while body";
     ExprTree::TaggedInstructionMap tagged_instructions;
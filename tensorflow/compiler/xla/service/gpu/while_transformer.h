@@ -34,6 +34,9 @@ namespace gpu {
 // The values in the returned tuple are values extracted from the 'while_hlo'
 // operand (and its sub-computations) during analysis.
 // Returns an error status on failure.
+//
+// The loop is matched either after fusion and copy insertion, when emitting IR,
+// or before fusion, e.g. to unroll it (see WhileLoopUnroller).
 StatusOr<std::tuple<int64, int64, int64>> CanTransformWhileToFor(
     const HloInstruction* while_hlo);
 
@@ -162,6 +162,20 @@ TEST_F(WhileTransformerTest, InductionVariableAtTupleElement1) {
               Eq(std::tuple<int64, int64, int64>(0, 10, 1)));
 }
 
+TEST_F(WhileTransformerTest, UnfusedLoop) {
+  // Build computation with induction variable at tuple element 1.
+  auto condition =
+      module_.AddEmbeddedComputation(BuildConditionComputation(1, 10));
+  auto body = module_.AddEmbeddedComputation(BuildBodyComputation(1, 0, 2));
+  auto while_hlo = BuildWhileInstruction(condition, body, 1, 0);
+  // Run WhileTransformer before fusion and copy insertion.
+  auto result = gpu::CanTransformWhileToFor(while_hlo);
+  ASSERT_TRUE(result.ok());
+  // Check results.
+  EXPECT_THAT(result.ConsumeValueOrDie(),
+              Eq(std::tuple<int64, int64, int64>(0, 10, 2)));
+}
+
 TEST_F(WhileTransformerTest, InvalidLoopLimit) {
   // Build computation with invalid loop limit.
   auto condition =
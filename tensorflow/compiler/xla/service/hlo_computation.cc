@@ -596,6 +596,9 @@ HloComputation::ComputeTransitiveOperands() const {
     for (const HloInstruction* operand : hlo->operands()) {
       result->SetReachableAndTransitiveClosure(hlo, operand);
     }
+    for (const HloInstruction* predecessor : hlo->control_predecessors()) {
+      result->SetReachableAndTransitiveClosure(hlo, predecessor);
+    }
   }
   return result;
 }
@@ -154,6 +154,7 @@ class HloComputation {
   std::list<HloInstruction*> MakeInstructionPostOrder() const;
 
   // Computes and returns the mapping from HLO to its transitive operands.
+  // Control predecessors count as operands, since they too must execute first.
   class ReachabilityMap;
   std::unique_ptr<ReachabilityMap> ComputeTransitiveOperands() const;
 
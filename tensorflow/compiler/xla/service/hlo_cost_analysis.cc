@@ -142,6 +142,12 @@ Status HloCostAnalysis::HandleDynamicSlice(HloInstruction* dynamic_slice,
   return Status::OK();
 }
 
+Status HloCostAnalysis::HandleGather(HloInstruction* gather,
+                                     HloInstruction* operand,
+                                     HloInstruction* indices) {
+  return Status::OK();
+}
+
 Status HloCostAnalysis::HandleDynamicUpdateSlice(
     HloInstruction* dynamic_update, HloInstruction* operand,
     HloInstruction* update, HloInstruction* start_indices) {
@@ -96,6 +96,8 @@ class HloCostAnalysis : public DfsHloVisitor {
                                   HloInstruction* operand,
                                   HloInstruction* update,
                                   HloInstruction* start_indices) override;
+  Status HandleGather(HloInstruction* gather, HloInstruction* operand,
+                      HloInstruction* indices) override;
   Status HandleTuple(
       HloInstruction* tuple,
       tensorflow::gtl::ArraySlice<HloInstruction*> operands) override;
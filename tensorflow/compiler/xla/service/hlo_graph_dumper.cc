@@ -264,6 +264,7 @@ string InstructionSequenceGraph(
       case HloOpcode::kCopy:
       case HloOpcode::kDynamicSlice:
       case HloOpcode::kDynamicUpdateSlice:
+      case HloOpcode::kGather:
       case HloOpcode::kPad:
       case HloOpcode::kReshape:
       case HloOpcode::kReverse:
@@ -312,6 +312,14 @@ HloInstruction::CreateCrossReplicaSum(const Shape& shape,
   return instruction;
 }
 
+/* static */ std::unique_ptr<HloInstruction> HloInstruction::CreateGather(
+    const Shape& shape, HloInstruction* operand, HloInstruction* indices) {
+  auto instruction = WrapUnique(new HloInstruction(HloOpcode::kGather, shape));
+  instruction->AppendOperand(operand);
+  instruction->AppendOperand(indices);
+  return instruction;
+}
+
 /* static */ std::unique_ptr<HloInstruction>
 HloInstruction::CreateDynamicUpdateSlice(const Shape& shape,
                                          HloInstruction* operand,
@@ -825,6 +833,9 @@ std::unique_ptr<HloInstruction> HloInstruction::CloneWithNewOperands(
       CHECK_EQ(new_operands.size(), 3);
       return CreateDynamicUpdateSlice(shape, new_operands[0], new_operands[1],
                                       new_operands[2]);
+    case HloOpcode::kGather:
+      CHECK_EQ(new_operands.size(), 2);
+      return CreateGather(shape, new_operands[0], new_operands[1]);
     case HloOpcode::kTranspose:
       CHECK_EQ(new_operands.size(), 1);
       return CreateTranspose(shape, new_operands[0], dimensions_);
@@ -1198,6 +1209,7 @@ bool HloInstruction::Identical(
       return ShapeUtil::Compatible(shape(), other.shape()) &&
              dynamic_slice_sizes_ == other.dynamic_slice_sizes_;
     case HloOpcode::kDynamicUpdateSlice:
+    case HloOpcode::kGather:
       return ShapeUtil::Compatible(shape(), other.shape());
     case HloOpcode::kCall:
     case HloOpcode::kMap:
@@ -1834,6 +1846,8 @@ Status HloInstruction::Visit(DfsHloVisitor* visitor) {
     case HloOpcode::kDynamicUpdateSlice:
       return visitor->HandleDynamicUpdateSlice(this, operands_[0], operands_[1],
                                                operands_[2]);
+    case HloOpcode::kGather:
+      return visitor->HandleGather(this, operands_[0], operands_[1]);
     case HloOpcode::kSort:
       return visitor->HandleSort(this, operands_[0]);
     case HloOpcode::kInfeed:
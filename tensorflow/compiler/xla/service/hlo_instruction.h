@@ -177,6 +177,11 @@ class HloInstruction {
       HloInstruction* start_indices,
       tensorflow::gtl::ArraySlice<int64> slice_sizes);
 
+  // Creates a gather instruction, which gathers the slices of 'operand' along
+  // dimension 0 at the positions given by the elements of 'indices'.
+  static std::unique_ptr<HloInstruction> CreateGather(
+      const Shape& shape, HloInstruction* operand, HloInstruction* indices);
+
   // Creates a dynamic update slice instruction, which updates a slice
   // of 'operand' with 'update' and 'start_indices'.
   static std::unique_ptr<HloInstruction> CreateDynamicUpdateSlice(
@@ -598,6 +603,11 @@ class HloInstruction {
     return fusion_kind_;
   }
 
+  void set_fusion_kind(FusionKind kind) {
+    CHECK_EQ(HloOpcode::kFusion, opcode_);
+    fusion_kind_ = kind;
+  }
+
   // Merges the fused instructions from 'instruction_to_merge' into the
   // fused instruction set of 'this', updating operands as necessary.
   //
@@ -71,6 +71,7 @@ HLO_MATCHER(Eq);
 HLO_MATCHER(Exp);
 HLO_MATCHER(Floor);
 HLO_MATCHER(Fusion);
+HLO_MATCHER(Gather);
 HLO_MATCHER(Ge);
 HLO_MATCHER(GetTupleElement);
 HLO_MATCHER(Gt);
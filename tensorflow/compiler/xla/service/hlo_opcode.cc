@@ -64,6 +64,8 @@ string HloOpcodeString(HloOpcode opcode) {
       return "ceil";
     case HloOpcode::kFusion:
       return "fusion";
+    case HloOpcode::kGather:
+      return "gather";
     case HloOpcode::kGe:
       return "greater-than-or-equal-to";
     case HloOpcode::kGetTupleElement:
@@ -50,6 +50,7 @@ enum class HloOpcode {
   kExp,
   kFloor,
   kFusion,
+  kGather,
   kGe,
   kGetTupleElement,
   kGt,
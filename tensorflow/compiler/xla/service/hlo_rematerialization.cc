@@ -848,16 +848,39 @@ int64 RematerializationCost(const HloInstruction* instruction,
          memory_reduced;
 }
 
+// Returns whether rematerializing 'instruction' recomputes more than
+// 'max_recompute_flops_per_byte' flops (including transcendentals) per byte of
+// memory saved. Moves of an instruction none of whose users are placed yet
+// recompute nothing. A negative limit means any recompute is acceptable.
+bool ExceedsRecomputeLimit(const HloInstruction* instruction,
+                           const MemoryUsageTracker& memory_tracker,
+                           const HloCostAnalysis& cost_analysis,
+                           int64 memory_reduced,
+                           int64 max_recompute_flops_per_byte) {
+  if (max_recompute_flops_per_byte < 0 ||
+      !std::any_of(instruction->users().begin(), instruction->users().end(),
+                   [&memory_tracker](const HloInstruction* inst) {
+                     return memory_tracker.IsPlaced(inst);
+                   })) {
+    return false;
+  }
+  const int64 recompute_flops =
+      cost_analysis.flop_count(*instruction) +
+      cost_analysis.transcendental_count(*instruction);
+  return recompute_flops > max_recompute_flops_per_byte * memory_reduced;
+}
+
 // Selects and returns the best candidate instruction for rematerialization.
 // The instruction with lowest rematerialization cost is selected among those
 // candidate which reduce memory use at the program point of the current
-// instruction as indicated by memory_tracker. nullptr is returned if no
-// candidate can be found.
+// instruction as indicated by memory_tracker, and which don't exceed the
+// recompute limit. nullptr is returned if no candidate can be found.
 HloInstruction* PickRematerializationCandidate(
     const MemoryUsageTracker& memory_tracker,
     const InstructionList& instruction_list,
     const HloCostAnalysis& cost_analysis,
-    const tensorflow::gtl::FlatSet<const HloInstruction*>& blacklist) {
+    const tensorflow::gtl::FlatSet<const HloInstruction*>& blacklist,
+    int64 max_recompute_flops_per_byte) {
   HloInstruction* best = nullptr;
   int64 best_cost = 0;
 
@@ -895,6 +918,13 @@ HloInstruction* PickRematerializationCandidate(
       continue;
     }
 
+    if (ExceedsRecomputeLimit(candidate, memory_tracker, cost_analysis,
+                              memory_reduced, max_recompute_flops_per_byte)) {
+      VLOG(5) << "candidate " << candidate->name()
+              << " not viable: recomputing it is too expensive";
+      continue;
+    }
+
     const int cost = RematerializationCost(candidate, memory_tracker,
                                            cost_analysis, memory_reduced);
 
@@ -1011,7 +1041,8 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
               << ", limit is " << HumanReadableNumBytes(memory_limit_bytes);
 
       HloInstruction* best = PickRematerializationCandidate(
-          memory_tracker, instruction_list, cost_analysis_, blacklist);
+          memory_tracker, instruction_list, cost_analysis_, blacklist,
+          max_recompute_flops_per_byte_);
 
       if (best == nullptr) {
         VLOG(3) << "Unable to find rematerialization candidate at program "
@@ -1286,8 +1317,9 @@ StatusOr<bool> HloRematerialization::Run(
 /* static */ StatusOr<bool> HloRematerialization::RematerializeAndSchedule(
     const HloRematerialization::ShapeSizeFunction& size_function,
     int64 memory_limit_bytes, HloModule* hlo_module,
-    SequentialHloOrdering::HloModuleSequence* sequence) {
-  HloRematerialization remat(size_function);
+    SequentialHloOrdering::HloModuleSequence* sequence,
+    int64 max_recompute_flops_per_byte) {
+  HloRematerialization remat(size_function, max_recompute_flops_per_byte);
   return remat.Run(hlo_module, sequence, memory_limit_bytes);
 }
 
@@ -47,6 +47,11 @@ class HloRematerialization {
   //     rematerialization. This is the order in which HLO instructions should
   //     be emitted to minimize memory use.
   //
+  //   max_recompute_flops_per_byte: Instructions whose recompute costs more
+  //     flops per byte of memory saved are never rematerialized, e.g. so that
+  //     only cheap elementwise operations are recomputed instead of
+  //     convolutions and dots. A negative value means no limit.
+  //
   // Returns whether any instructions were rematerialized. If memory use is
   // already below the given limit then no instructions are rematerialized and
   // false is returned.
@@ -56,12 +61,15 @@ class HloRematerialization {
   // code generation.
   static StatusOr<bool> RematerializeAndSchedule(
       const ShapeSizeFunction& size_function, int64 memory_limit_bytes,
-      HloModule* hlo_module,
-      SequentialHloOrdering::HloModuleSequence* sequence);
+      HloModule* hlo_module, SequentialHloOrdering::HloModuleSequence* sequence,
+      int64 max_recompute_flops_per_byte = -1);
 
  protected:
-  HloRematerialization(const ShapeSizeFunction& size_function)
-      : size_function_(size_function), cost_analysis_(size_function_) {}
+  HloRematerialization(const ShapeSizeFunction& size_function,
+                       int64 max_recompute_flops_per_byte)
+      : size_function_(size_function),
+        max_recompute_flops_per_byte_(max_recompute_flops_per_byte),
+        cost_analysis_(size_function_) {}
   ~HloRematerialization() {}
 
   // Runs rematerialization on the given module. Returns whether the module was
@@ -97,6 +105,10 @@ class HloRematerialization {
   // Function which computes the size of the top-level buffer of a shape.
   const ShapeSizeFunction size_function_;
 
+  // The maximum flops per byte of memory saved rematerialization may
+  // recompute; negative if unlimited.
+  const int64 max_recompute_flops_per_byte_;
+
   // Call graph of the hlo_module.
   std::unique_ptr<CallGraph> call_graph_;
 
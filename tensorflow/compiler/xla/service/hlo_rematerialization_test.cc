@@ -115,6 +115,45 @@ class HloRematerializationTest : public HloTestBase {
     return builder.Build();
   }
 
+  // Creates and returns a computation like the one produced by
+  // MakeRematerializableComputation, but where the instruction to
+  // rematerialize is a dot, which recomputes 16 flops per byte saved:
+  //
+  //   F32[32,32] %param = {...}
+  //   F32[32,32] %dot = dot(%param, %param)
+  //   F32[32,32] %negate = negate(%dot)
+  //   F32[64,32] %concat_1 = concat({%negate, %negate})
+  //   F32[1,32] %slice_1 = slice(%concat_1, {0:1, 0:32})
+  //   F32[33,32] %concat_2 = concat({%dot, %slice_1})
+  //   F32[1,32] %slice_2 = slice(%concat_2, {0:1, 0:32});
+  //
+  // Peak memory use is about 20KB before rematerialization and about 16KB
+  // after rematerializing %dot for its use in %concat_2.
+  std::unique_ptr<HloComputation> MakeRematerializableDotComputation() {
+    const Shape mat_shape = ShapeUtil::MakeShape(xla::F32, {32, 32});
+    const Shape row_shape = ShapeUtil::MakeShape(xla::F32, {1, 32});
+    auto builder = HloComputation::Builder(TestName());
+    auto param = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, mat_shape, "param"));
+    auto dot = builder.AddInstruction(
+        HloInstruction::CreateBinary(mat_shape, HloOpcode::kDot, param, param));
+    auto negate = builder.AddInstruction(
+        HloInstruction::CreateUnary(mat_shape, HloOpcode::kNegate, dot));
+    auto concat_1 = builder.AddInstruction(HloInstruction::CreateConcatenate(
+        ShapeUtil::MakeShape(xla::F32, {64, 32}), {negate, negate},
+        /*dimension=*/0));
+    auto slice_1 = builder.AddInstruction(HloInstruction::CreateSlice(
+        row_shape, concat_1, /*start_indices=*/{0, 0},
+        /*limit_indices=*/{1, 32}));
+    auto concat_2 = builder.AddInstruction(HloInstruction::CreateConcatenate(
+        ShapeUtil::MakeShape(xla::F32, {33, 32}), {dot, slice_1},
+        /*dimension=*/0));
+    builder.AddInstruction(HloInstruction::CreateSlice(
+        row_shape, concat_2, /*start_indices=*/{0, 0},
+        /*limit_indices=*/{1, 32}));
+    return builder.Build();
+  }
+
   // Create and return a trivial computation appropriate for use as a while
   // condition.
   std::unique_ptr<HloComputation> MakeConditionComputation() {
@@ -196,6 +235,28 @@ TEST_F(HloRematerializationTest, SingleComputationNoRematerialization) {
   EXPECT_EQ(computation->instruction_count(), 7);
 }
 
+// Test that an expensive instruction is only rematerialized when recomputing it
+// is within the flops per byte limit.
+TEST_F(HloRematerializationTest, RecomputeFlopsLimit) {
+  for (int64 max_recompute_flops_per_byte : {-1, 16, 15}) {
+    HloModule module(TestName());
+    HloComputation* computation =
+        module.AddEntryComputation(MakeRematerializableDotComputation());
+    EXPECT_EQ(computation->instruction_count(), 7);
+
+    SequentialHloOrdering::HloModuleSequence sequence;
+    TF_ASSIGN_OR_ASSERT_OK(
+        bool changed,
+        HloRematerialization::RematerializeAndSchedule(
+            ByteSizeOf, /*memory_limit_bytes=*/18 * 1024, &module, &sequence,
+            max_recompute_flops_per_byte));
+    // The dot recomputes 16 flops per byte saved.
+    const bool expect_changed = max_recompute_flops_per_byte != 15;
+    EXPECT_EQ(expect_changed, changed);
+    EXPECT_EQ(computation->instruction_count(), expect_changed ? 8 : 7);
+  }
+}
+
 // Test rematerialization of a computation which calls another computation via a
 // while. Both the entry computation and while body computation can have memory
 // usage reduced via rematerialization however the memory limit is set such that
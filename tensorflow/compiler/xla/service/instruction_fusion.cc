@@ -19,6 +19,7 @@ limitations under the License.
 #include <list>
 #include <memory>
 #include <numeric>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/compiler/xla/map_util.h"
@@ -47,6 +48,7 @@ namespace xla {
     case HloOpcode::kDynamicUpdateSlice:
     case HloOpcode::kEq:
     case HloOpcode::kFloor:
+    case HloOpcode::kGather:
     case HloOpcode::kGe:
     case HloOpcode::kGetTupleElement:
     case HloOpcode::kGt:
@@ -115,8 +117,55 @@ bool FusionWouldDuplicate(const HloInstruction& producer,
 }
 }  // namespace
 
+/*static*/ std::vector<const HloInstruction*>
+InstructionFusion::SlowestFusions(const HloModule& module,
+                                  const HloExecutionProfile& profile,
+                                  int64 max_fusions) {
+  std::vector<std::pair<uint64, const HloInstruction*>> fusions;
+  for (const auto& computation : module.computations()) {
+    for (const auto& instruction : computation->instructions()) {
+      if (instruction->opcode() != HloOpcode::kFusion) {
+        continue;
+      }
+      const uint64 cycles = profile.GetProfileResult(*instruction);
+      if (cycles > 0) {
+        fusions.emplace_back(cycles, instruction.get());
+      }
+    }
+  }
+  std::stable_sort(fusions.begin(), fusions.end(),
+                   [](const std::pair<uint64, const HloInstruction*>& a,
+                      const std::pair<uint64, const HloInstruction*>& b) {
+                     return a.first > b.first;
+                   });
+  std::vector<const HloInstruction*> slowest;
+  for (const auto& cycles_and_fusion : fusions) {
+    if (static_cast<int64>(slowest.size()) >= max_fusions) {
+      break;
+    }
+    slowest.push_back(cycles_and_fusion.second);
+  }
+  return slowest;
+}
+
+/*static*/ std::vector<string> InstructionFusion::FusedInstructionNames(
+    const HloInstruction& fusion) {
+  std::vector<string> names;
+  for (const auto& fused : fusion.fused_instructions()) {
+    if (fused->opcode() != HloOpcode::kParameter &&
+        fused.get() != fusion.fused_expression_root()) {
+      names.push_back(fused->name());
+    }
+  }
+  return names;
+}
+
 StatusOr<bool> InstructionFusion::Run(HloModule* module) {
   bool changed = false;
+  const auto& unfused =
+      module->config().debug_options().xla_unfused_instructions();
+  const std::unordered_set<string> unfused_instructions(unfused.begin(),
+                                                        unfused.end());
   for (auto& computation : module->computations()) {
     computation_ = computation.get();
 
@@ -263,6 +312,10 @@ StatusOr<bool> InstructionFusion::Run(HloModule* module) {
       for (int64 i : sorted_operand_numbers) {
         HloInstruction* operand = instruction->mutable_operand(i);
 
+        if (unfused_instructions.count(operand->name()) > 0) {
+          continue;
+        }
+
         if (FusionWouldDuplicate(*operand, *instruction) &&
             (all_consumers_fusable.count(operand) == 0)) {
           continue;
@@ -303,12 +356,15 @@ HloInstruction* InstructionFusion::Fuse(HloInstruction* producer,
 
   VLOG(2) << "Fusing " << producer << " into " << consumer;
 
+  HloInstruction::FusionKind kind = ChooseKind(producer, consumer);
   if (consumer->opcode() == HloOpcode::kFusion) {
     fusion_instruction = consumer;
+    if (kind != fusion_instruction->fusion_kind()) {
+      fusion_instruction->set_fusion_kind(kind);
+    }
   } else {
-    fusion_instruction =
-        computation_->AddInstruction(HloInstruction::CreateFusion(
-            consumer->shape(), ChooseKind(producer, consumer), consumer));
+    fusion_instruction = computation_->AddInstruction(
+        HloInstruction::CreateFusion(consumer->shape(), kind, consumer));
     TF_CHECK_OK(computation_->ReplaceInstruction(consumer, fusion_instruction));
   }
   fusion_instruction->FuseInstruction(producer);
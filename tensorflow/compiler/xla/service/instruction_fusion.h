@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_INSTRUCTION_FUSION_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_INSTRUCTION_FUSION_H_
 
+#include <vector>
+
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_execution_profile.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
@@ -28,7 +31,8 @@ namespace xla {
 // "vertically", meaning producing instructions are fused into their consumers
 // with the intent that the loops which compute their values will be fused in
 // code generation. Derived classes define ShouldFuse method to select which
-// instructions to fuse.
+// instructions to fuse. The instructions named by the xla_unfused_instructions
+// debug option of the module aren't fused into their users.
 class InstructionFusion : public HloPassInterface {
  public:
   explicit InstructionFusion(
@@ -47,6 +51,19 @@ class InstructionFusion : public HloPassInterface {
   // array. Expensive operations will not be duplicated.
   static bool IsExpensive(const HloInstruction& instruction);
 
+  // Returns the fusion instructions of 'module' which took the most cycles in
+  // 'profile', at most 'max_fusions' of them, slowest first. The fusions which
+  // weren't profiled are ignored.
+  static std::vector<const HloInstruction*> SlowestFusions(
+      const HloModule& module, const HloExecutionProfile& profile,
+      int64 max_fusions);
+
+  // Returns the names of the instructions fused into 'fusion' other than its
+  // root, which xla_unfused_instructions lists to compile its module again
+  // without this fusion.
+  static std::vector<string> FusedInstructionNames(
+      const HloInstruction& fusion);
+
  protected:
   // Returns whether the given producer instruction should be fused into the
   // given consumer instruction. producer is necessarily an operand of consumer.
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
 
+#include "tensorflow/compiler/xla/service/hlo_execution_profile.h"
 #include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 
 namespace op = xla::testing::opcode_matchers;
@@ -219,4 +221,65 @@ TEST_F(InstructionFusionTest, AllowEffectiveUnaryDuplication) {
           .ValueOrDie());
 }
 
+TEST_F(InstructionFusionTest, UnfusedInstructionsNotFused) {
+  HloComputation::Builder builder(TestName());
+  HloInstruction* const0 = builder.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0(5)));
+  HloInstruction* negate1 = builder.AddInstruction(HloInstruction::CreateUnary(
+      ShapeUtil::MakeShape(S32, {}), HloOpcode::kNegate, const0));
+  HloInstruction* broadcast2 =
+      builder.AddInstruction(HloInstruction::CreateBroadcast(
+          ShapeUtil::MakeShape(S32, {1}), negate1, {0}));
+
+  DebugOptions debug_options;
+  debug_options.add_xla_unfused_instructions(negate1->name());
+  HloModuleConfig config;
+  config.set_debug_options(debug_options);
+  auto module = MakeUnique<HloModule>(TestName(), VersionedComputationHandle(),
+                                      config);
+  auto computation = module->AddEntryComputation(builder.Build());
+  EXPECT_FALSE(
+      InstructionFusion(InstructionFusion::IsExpensive, /*may_duplicate=*/true)
+          .Run(module.get())
+          .ValueOrDie());
+  EXPECT_EQ(broadcast2, computation->root_instruction());
+}
+
+TEST_F(InstructionFusionTest, SlowestFusions) {
+  auto shape = ShapeUtil::MakeShape(F32, {16});
+  HloComputation::Builder builder(TestName());
+  auto param0 =
+      builder.AddInstruction(HloInstruction::CreateParameter(0, shape, "0"));
+  HloInstruction* negate = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kNegate, param0));
+  HloInstruction* exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kExp, negate));
+  HloInstruction* abs = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kAbs, param0));
+  builder.AddInstruction(HloInstruction::CreateTuple({exp, abs}));
+
+  auto module = MakeUnique<HloModule>(TestName());
+  auto computation = module->AddEntryComputation(builder.Build());
+  const string negate_name = negate->name();
+  HloInstruction* fast = computation->CreateFusionInstruction(
+      {abs}, HloInstruction::FusionKind::kLoop);
+  HloInstruction* slow = computation->CreateFusionInstruction(
+      {exp, negate}, HloInstruction::FusionKind::kLoop);
+
+  HloExecutionProfile profile;
+  profile.AddProfileResult(fast, 10);
+  profile.AddProfileResult(slow, 100);
+  std::vector<const HloInstruction*> slowest =
+      InstructionFusion::SlowestFusions(*module, profile, /*max_fusions=*/1);
+  ASSERT_EQ(1, slowest.size());
+  EXPECT_EQ(slow, slowest[0]);
+  EXPECT_EQ(2, InstructionFusion::SlowestFusions(*module, profile,
+                                                 /*max_fusions=*/3)
+                   .size());
+
+  // Only the root of the slow fusion may stay fused.
+  EXPECT_EQ(std::vector<string>({negate_name}),
+            InstructionFusion::FusedInstructionNames(*slow));
+}
+
 }  // namespace xla
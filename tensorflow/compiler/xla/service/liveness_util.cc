@@ -111,13 +111,14 @@ std::vector<std::pair<HloInstruction*, int64>> GetAllUsesOfInstructionAtIndex(
 }
 
 // Returns true if there is exactly one use of 'operand' at 'operand_index'
-// in 'fusion.fused_instructions', where the singleton use is the fused
-// root at operand index 'use_operand_index'. Returns false otherwise.
+// in 'fusion.fused_instructions', where the singleton use is 'fused_user'
+// at operand index 'use_operand_index'. Returns false otherwise.
 //
 // REQUIRES: 'fusion' opcode is a kFusion instruction.
 bool HasUniqueFusedUseOfOperandAt(
     HloInstruction* operand, const ShapeIndex& operand_index,
-    HloInstruction* fusion, const int64 use_operand_index,
+    HloInstruction* fusion, const HloInstruction* fused_user,
+    const int64 use_operand_index,
     const TuplePointsToAnalysis& points_to_analysis) {
   CHECK_EQ(HloOpcode::kFusion, fusion->opcode());
   // Check that 'operand' is unique in the operand list of 'fusion'.
@@ -139,9 +140,9 @@ bool HasUniqueFusedUseOfOperandAt(
   auto fused_param_uses = GetAllUsesOfInstructionAtIndex(
       fused_param, operand_index, points_to_analysis);
   // Return true iff there is exactly one use of 'operand' at 'index', and
-  // this singleton use is the fused root (at index in 'use_operand_indices').
+  // this singleton use is 'fused_user' (at index in 'use_operand_indices').
   return fused_param_uses.size() == 1 &&
-         fused_param_uses[0].first == fusion->fused_expression_root() &&
+         fused_param_uses[0].first == fused_user &&
          fused_param_uses[0].second == use_operand_index;
 }
 
@@ -153,6 +154,9 @@ bool HasUniqueFusedUseOfOperandAt(
 // *) Is a loop fusion instruction where the only use of 'operand' at 'index'
 //    in the set 'user.fused_instructions' is a DynamicUpdateSlice fused root
 //    at operand 0. Or...
+// *) Is a multi-output loop fusion instruction where the only use of
+//    'operand' at 'index' in the set 'user.fused_instructions' is the
+//    DynamicUpdateSlice computing output 'user_index', at operand 0. Or...
 // *) Is a kDot -> kAdd (or fused kTransposeDot -> kAdd) output fusion
 //    instruction where the only use of 'operand' at 'index' in the set
 //    'user.fused_instructions' is a kAdd fused root at operand 0 or 1. Or...
@@ -179,8 +183,24 @@ bool CanShareOperandBufferWithUser(
       // Returns true iff there is exactly one use of 'operand' at shape index
       // 'operand_index', and this singleton use is the fused root at operand
       // index 0.
-      return HasUniqueFusedUseOfOperandAt(operand, operand_index, user, 0,
+      return HasUniqueFusedUseOfOperandAt(operand, operand_index, user,
+                                          user->fused_expression_root(), 0,
                                           points_to_analysis);
+    } else if (user->fusion_kind() == HloInstruction::FusionKind::kLoop &&
+               user->IsMultiOutputFusion()) {
+      // Multi-output loop fusion.
+      //
+      // Returns true iff output 'user_index' is computed by a
+      // kDynamicUpdateSlice, and the only use of 'operand' at shape index
+      // 'operand_index' is this kDynamicUpdateSlice at operand index 0.
+      if (user_index.size() != 1) {
+        return false;
+      }
+      const HloInstruction* output =
+          user->fused_expression_root()->operand(user_index[0]);
+      return output->opcode() == HloOpcode::kDynamicUpdateSlice &&
+             HasUniqueFusedUseOfOperandAt(operand, operand_index, user, output,
+                                          0, points_to_analysis);
     } else if (user->fusion_kind() == HloInstruction::FusionKind::kOutput &&
                user->fused_expression_root()->opcode() == HloOpcode::kAdd) {
       // Output fusion with kAdd fused root.
@@ -206,9 +226,9 @@ bool CanShareOperandBufferWithUser(
       // Returns true iff there is exactly one use of 'operand' at shape index
       // 'operand_index', and this singleton use is the fused root (at operand
       // index 'other_add_operand_index').
-      return HasUniqueFusedUseOfOperandAt(operand, operand_index, user,
-                                          other_add_operand_index,
-                                          points_to_analysis);
+      return HasUniqueFusedUseOfOperandAt(
+          operand, operand_index, user, add, other_add_operand_index,
+          points_to_analysis);
     }
   }
   if (user->opcode() == HloOpcode::kDynamicUpdateSlice ||
@@ -202,6 +202,47 @@ TEST_F(CanShareOperandBufferWithUserTest, FusedDynamicUpdateSlice) {
                                             *points_to_analysis_));
 }
 
+TEST_F(CanShareOperandBufferWithUserTest, MultiOutputFusedDynamicUpdateSlice) {
+  auto builder = HloComputation::Builder(TestName());
+
+  Shape data_shape = ShapeUtil::MakeShape(F32, {8});
+  auto tuple = builder.AddInstruction(HloInstruction::CreateParameter(
+      0, ShapeUtil::MakeTupleShape({data_shape, data_shape}), "tuple"));
+  auto gte0 = builder.AddInstruction(
+      HloInstruction::CreateGetTupleElement(data_shape, tuple, 0));
+  auto gte1 = builder.AddInstruction(
+      HloInstruction::CreateGetTupleElement(data_shape, tuple, 1));
+
+  // Create a DynamicUpdateSlice instruction of tuple element 1, and a Negate
+  // instruction of tuple element 0.
+  auto starts = builder.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR1<int32>({2})));
+  auto update = builder.AddInstruction(HloInstruction::CreateConstant(
+      LiteralUtil::CreateR1<float>({2.f, 2.f, 2.f})));
+  auto dynamic_update_slice =
+      builder.AddInstruction(HloInstruction::CreateDynamicUpdateSlice(
+          data_shape, gte1, update, starts));
+  auto negate = builder.AddInstruction(
+      HloInstruction::CreateUnary(data_shape, HloOpcode::kNegate, gte0));
+  auto outputs = builder.AddInstruction(
+      HloInstruction::CreateTuple({negate, dynamic_update_slice}));
+
+  BuildModule(builder.Build());
+  auto fusion = computation_->CreateFusionInstruction(
+      {outputs, negate, dynamic_update_slice, starts, update, gte0, gte1},
+      HloInstruction::FusionKind::kLoop);
+  RunAnalysis();
+
+  // Output 1 of the fusion instruction can share with tuple element 1.
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_FALSE(CanShareOperandBufferWithUser(tuple, {0}, fusion, {0},
+                                             *points_to_analysis_));
+  EXPECT_FALSE(CanShareOperandBufferWithUser(tuple, {0}, fusion, {1},
+                                             *points_to_analysis_));
+  EXPECT_TRUE(CanShareOperandBufferWithUser(tuple, {1}, fusion, {1},
+                                            *points_to_analysis_));
+}
+
 TEST_F(CanShareOperandBufferWithUserTest, DynamicUpdateSliceCanShare) {
   auto builder = HloComputation::Builder(TestName());
 
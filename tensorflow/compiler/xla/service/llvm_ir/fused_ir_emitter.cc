@@ -33,6 +33,10 @@ namespace xla {
 using llvm_ir::IrArray;
 
 Status FusedIrEmitter::DefaultAction(HloInstruction* hlo) {
+  if (generators_.count(hlo) > 0) {
+    // The generator was given by SetGenerator().
+    return Status::OK();
+  }
   generators_[hlo] =
       [=](const IrArray::Index& index) -> StatusOr<llvm::Value*> {
     if (generated_value_cache_[hlo].count(index.multidim()) > 0) {
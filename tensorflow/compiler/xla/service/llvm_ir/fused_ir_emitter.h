@@ -62,6 +62,13 @@ class FusedIrEmitter : public DfsHloVisitorWithDefault {
   // Returns the generator function for the given instruction.
   Generator GetGenerator(const HloInstruction* instruction) const;
 
+  // Makes the fused emitter generate the elements of the given instruction,
+  // e.g. one emitted by the caller outside of the elemental emitter, with
+  // `generator`. Must be called before visiting the fused computation.
+  void SetGenerator(const HloInstruction* instruction, Generator generator) {
+    generators_[instruction] = std::move(generator);
+  }
+
   // Returns the ir value for instruction 'hlo'.
   llvm::Value* GetIrValueForGTE(const HloInstruction* hlo) const {
     auto it = gte_values_.find(hlo);
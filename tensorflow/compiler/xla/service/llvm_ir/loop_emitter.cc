@@ -67,10 +67,17 @@ IrArray::Index LoopEmitter::EmitIndexAndSetExitBasicBlock() {
   IrArray::Index array_index(shape_.dimensions_size());
   for (int i = shape_.layout().minor_to_major_size() - 1; i >= 0; --i) {
     int64 dimension = shape_.layout().minor_to_major(i);
-    std::unique_ptr<ForLoop> loop = loop_nest.AddLoop(
-        /*start_index=*/0,
-        /*end_index=*/shape_.dimensions(dimension),
-        /*suffix=*/tensorflow::strings::Printf("dim.%lld", dimension));
+    const string suffix = tensorflow::strings::Printf("dim.%lld", dimension);
+    std::unique_ptr<ForLoop> loop;
+    if (i == shape_.layout().minor_to_major_size() - 1 &&
+        outer_dimension_start_ != nullptr) {
+      loop = loop_nest.AddLoop(suffix, outer_dimension_start_,
+                               outer_dimension_end_);
+    } else {
+      loop = loop_nest.AddLoop(
+          /*start_index=*/0,
+          /*end_index=*/shape_.dimensions(dimension), suffix);
+    }
     array_index[dimension] = loop->GetIndVarValue();
   }
 
@@ -59,6 +59,15 @@ class LoopEmitter {
   // Emits a complete loop nest for every element in the given shape.
   tensorflow::Status EmitLoop();
 
+  // Restricts the emitted loop nest to the elements whose index in the
+  // most-major dimension of the shape is in [start, end). 'start' and 'end' are
+  // int64 values computed at run time, so that several calls of the same
+  // function can compute disjoint parts of the shape.
+  void SetOuterDimensionBounds(llvm::Value* start, llvm::Value* end) {
+    outer_dimension_start_ = start;
+    outer_dimension_end_ = end;
+  }
+
  protected:
   // An IR emitter that generates the loop body.
   BodyEmitter body_emitter_;
@@ -70,6 +79,11 @@ class LoopEmitter {
   // scalar, no loops are emitted and exit_bb_ is nullptr in that case.
   llvm::BasicBlock* exit_bb_;
 
+  // The bounds of the loop over the most-major dimension, or nullptr to iterate
+  // through the whole dimension.
+  llvm::Value* outer_dimension_start_ = nullptr;
+  llvm::Value* outer_dimension_end_ = nullptr;
+
   llvm::IRBuilder<>* ir_builder_;
 };
 
@@ -0,0 +1,190 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/llvm_ir/split_module.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include "external/llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "external/llvm/include/llvm/Bitcode/BitcodeWriter.h"
+#include "external/llvm/include/llvm/IR/Constants.h"
+#include "external/llvm/include/llvm/IR/Function.h"
+#include "external/llvm/include/llvm/IR/GlobalVariable.h"
+#include "external/llvm/include/llvm/Support/MemoryBuffer.h"
+#include "external/llvm/include/llvm/Support/raw_ostream.h"
+#include "external/llvm/include/llvm/Transforms/Utils/Cloning.h"
+#include "external/llvm/include/llvm/Transforms/Utils/ValueMapper.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace llvm_ir {
+
+namespace {
+
+using GlobalValueSet = std::unordered_set<const llvm::GlobalValue*>;
+
+// Adds the global values 'user' refers to, directly or through constant
+// expressions, which aren't in 'globals' yet to 'globals' and 'worklist'.
+void AddReferencedGlobals(const llvm::User& user, GlobalValueSet* globals,
+                          std::unordered_set<const llvm::Constant*>* constants,
+                          std::vector<const llvm::GlobalValue*>* worklist) {
+  for (const llvm::Value* operand : user.operands()) {
+    if (const auto* global = llvm::dyn_cast<llvm::GlobalValue>(operand)) {
+      if (globals->insert(global).second) {
+        worklist->push_back(global);
+      }
+    } else if (const auto* constant = llvm::dyn_cast<llvm::Constant>(operand)) {
+      if (constants->insert(constant).second) {
+        AddReferencedGlobals(*constant, globals, constants, worklist);
+      }
+    }
+  }
+}
+
+// Returns the global values 'roots' refer to, transitively, including the roots
+// themselves.
+GlobalValueSet ReferencedGlobals(
+    const std::vector<const llvm::Function*>& roots) {
+  GlobalValueSet globals(roots.begin(), roots.end());
+  std::unordered_set<const llvm::Constant*> constants;
+  std::vector<const llvm::GlobalValue*> worklist(roots.begin(), roots.end());
+  while (!worklist.empty()) {
+    const llvm::GlobalValue* global = worklist.back();
+    worklist.pop_back();
+    if (const auto* function = llvm::dyn_cast<llvm::Function>(global)) {
+      for (const llvm::BasicBlock& block : *function) {
+        for (const llvm::Instruction& instruction : block) {
+          AddReferencedGlobals(instruction, &globals, &constants, &worklist);
+        }
+      }
+    } else {
+      AddReferencedGlobals(*global, &globals, &constants, &worklist);
+    }
+  }
+  return globals;
+}
+
+int64 InstructionCount(const llvm::Function& function) {
+  int64 count = 0;
+  for (const llvm::BasicBlock& block : function) {
+    count += block.size();
+  }
+  return count;
+}
+
+}  // namespace
+
+std::vector<string> SplitModuleToBitcode(const llvm::Module& module,
+                                         int max_partitions) {
+  std::vector<const llvm::Function*> externally_visible;
+  for (const llvm::Function& function : module) {
+    if (!function.isDeclaration() && !function.hasLocalLinkage()) {
+      externally_visible.push_back(&function);
+    }
+  }
+  const int64 num_partitions =
+      std::min<int64>(max_partitions, externally_visible.size());
+  if (num_partitions < 2) {
+    return {};
+  }
+
+  // Assigns the largest functions first, each to the smallest partition.
+  std::vector<std::pair<int64, const llvm::Function*>> functions_by_size;
+  for (const llvm::Function* function : externally_visible) {
+    functions_by_size.emplace_back(InstructionCount(*function), function);
+  }
+  std::stable_sort(functions_by_size.begin(), functions_by_size.end(),
+                   [](const std::pair<int64, const llvm::Function*>& a,
+                      const std::pair<int64, const llvm::Function*>& b) {
+                     return a.first > b.first;
+                   });
+  std::vector<std::vector<const llvm::Function*>> roots(num_partitions);
+  std::vector<int64> partition_sizes(num_partitions, 0);
+  for (const auto& size_and_function : functions_by_size) {
+    const int64 smallest =
+        std::min_element(partition_sizes.begin(), partition_sizes.end()) -
+        partition_sizes.begin();
+    roots[smallest].push_back(size_and_function.second);
+    partition_sizes[smallest] += size_and_function.first;
+  }
+
+  std::vector<string> partitions;
+  for (int64 i = 0; i < num_partitions; ++i) {
+    GlobalValueSet defined = ReferencedGlobals(roots[i]);
+    const GlobalValueSet partition_roots(roots[i].begin(), roots[i].end());
+    for (const llvm::GlobalVariable& global : module.globals()) {
+      // Global arrays such as llvm.used can't be declarations.
+      if (global.hasAppendingLinkage()) {
+        defined.insert(&global);
+      }
+    }
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> partition =
+        llvm::CloneModule(&module, value_map,
+                          [&defined](const llvm::GlobalValue* global) {
+                            return defined.count(global) > 0;
+                          });
+    partition->setModuleIdentifier(tensorflow::strings::StrCat(
+        AsString(module.getModuleIdentifier()), "_", i));
+
+    std::vector<llvm::GlobalValue*> unused_declarations;
+    for (const llvm::GlobalValue& global : module.global_values()) {
+      auto* cloned = llvm::cast<llvm::GlobalValue>(value_map[&global]);
+      if (defined.count(&global) == 0) {
+        if (cloned->use_empty()) {
+          unused_declarations.push_back(cloned);
+        }
+      } else if (!global.hasLocalLinkage() && !global.hasAppendingLinkage() &&
+                 partition_roots.count(&global) == 0) {
+        // Keeps the copies in different partitions from clashing.
+        cloned->setLinkage(llvm::GlobalValue::InternalLinkage);
+      }
+    }
+    for (llvm::GlobalValue* declaration : unused_declarations) {
+      declaration->eraseFromParent();
+    }
+
+    std::string bitcode;
+    {
+      llvm::raw_string_ostream stream(bitcode);
+      llvm::WriteBitcodeToFile(partition.get(), stream);
+    }
+    VLOG(2) << "Partition " << i << " of " << module.getModuleIdentifier()
+            << ": " << roots[i].size() << " functions, "
+            << partition_sizes[i] << " instructions";
+    partitions.push_back(std::move(bitcode));
+  }
+  return partitions;
+}
+
+StatusOr<std::unique_ptr<llvm::Module>> ParseModuleFromBitcode(
+    const string& bitcode, llvm::LLVMContext* context) {
+  llvm::Expected<std::unique_ptr<llvm::Module>> module =
+      llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(AsStringRef(bitcode), "bitcode"), *context);
+  if (!module) {
+    return InternalError("Failed to parse bitcode: %s",
+                         llvm::toString(module.takeError()).c_str());
+  }
+  return std::move(module.get());
+}
+
+}  // namespace llvm_ir
+}  // namespace xla
@@ -0,0 +1,53 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_LLVM_IR_SPLIT_MODULE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_LLVM_IR_SPLIT_MODULE_H_
+
+#include <memory>
+#include <vector>
+
+#include "external/llvm/include/llvm/IR/LLVMContext.h"
+#include "external/llvm/include/llvm/IR/Module.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace llvm_ir {
+
+// Splits 'module' into at most 'max_partitions' modules which can be compiled
+// independently of each other, e.g. on different threads.
+//
+// The externally visible functions of 'module' are distributed across the
+// partitions, balancing their number of instructions. Each partition also
+// defines the functions and global variables its externally visible functions
+// refer to, transitively, with internal linkage: those shared by several
+// partitions are duplicated.
+//
+// The partitions are returned as bitcode, so that each can be parsed into its
+// own LLVMContext with ParseModuleFromBitcode: an LLVMContext can't be used by
+// several threads at once. Returns an empty vector if 'module' has fewer than
+// two externally visible functions, in which case it can't be split.
+std::vector<string> SplitModuleToBitcode(const llvm::Module& module,
+                                         int max_partitions);
+
+// Parses the module serialized to 'bitcode' into 'context'.
+StatusOr<std::unique_ptr<llvm::Module>> ParseModuleFromBitcode(
+    const string& bitcode, llvm::LLVMContext* context);
+
+}  // namespace llvm_ir
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_LLVM_IR_SPLIT_MODULE_H_
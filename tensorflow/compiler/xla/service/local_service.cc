@@ -118,7 +118,8 @@ StatusOr<GlobalDataHandle> LocalService::AllocateBufferOnDevice(
 StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
     const ComputationHandle& computation,
     const tensorflow::gtl::ArraySlice<const Shape*> argument_layouts,
-    const Shape* result_layout, int device_ordinal, bool has_hybrid_result) {
+    const Shape* result_layout, int device_ordinal, bool has_hybrid_result,
+    bool hlo_profiling, const DebugOptions& debug_options) {
   TF_ASSIGN_OR_RETURN(UserComputation * user_computation,
                       computation_tracker_.Resolve(computation));
   VersionedComputationHandle versioned_handle =
@@ -154,9 +155,10 @@ StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
   module_config->set_has_hybrid_result(has_hybrid_result);
   module_config->set_replica_count(execute_backend_->Replicas().size());
   legacy_flags::ServiceFlags* flags = legacy_flags::GetServiceFlags();
-  if (flags->xla_hlo_profile) {
+  if (flags->xla_hlo_profile || hlo_profiling) {
     module_config->enable_hlo_profiling(true);
   }
+  module_config->set_debug_options(debug_options);
   auto* computation_layout = module_config->mutable_entry_computation_layout();
   for (int i = 0; i < argument_layouts.size(); ++i) {
     const Shape& shape = *argument_layouts[i];
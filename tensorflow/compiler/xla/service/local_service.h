@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/service.h"
 #include "tensorflow/compiler/xla/service/shaped_buffer.h"
 #include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -53,11 +54,14 @@ class LocalService : public Service {
 
   // Builds an Executable with the given argument layouts and options. If
   // result_layout is non-null, then the executable is compiled to produce a
-  // result of the given layout.
+  // result of the given layout. If hlo_profiling is true, the executable
+  // collects per-HLO profiles even if the xla_hlo_profile flag isn't set.
   StatusOr<std::unique_ptr<Executable>> CompileExecutable(
       const ComputationHandle& computation,
       const tensorflow::gtl::ArraySlice<const Shape*> argument_layouts,
-      const Shape* result_layout, int device_ordinal, bool has_hybrid_result);
+      const Shape* result_layout, int device_ordinal, bool has_hybrid_result,
+      bool hlo_profiling = false,
+      const DebugOptions& debug_options = DebugOptions());
 
  private:
   explicit LocalService(std::unique_ptr<Backend> backend,
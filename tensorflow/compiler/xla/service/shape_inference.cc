@@ -1119,6 +1119,30 @@ ShapeInference::InferDegenerateDimensionBroadcastShape(
   return ShapeUtil::MakeShape(operand_shape.element_type(), slice_sizes);
 }
 
+/* static */ StatusOr<Shape> ShapeInference::InferGatherShape(
+    const Shape& operand_shape, const Shape& indices_shape) {
+  TF_RETURN_IF_ERROR(
+      ExpectNotTupleOrOpaque(operand_shape, "operand of gather"));
+  TF_RETURN_IF_ERROR(
+      ExpectNotTupleOrOpaque(indices_shape, "indices of gather"));
+
+  if (ShapeUtil::Rank(operand_shape) < 1) {
+    return InvalidArgument("gather operand must be at least rank 1: %s",
+                           ShapeUtil::HumanString(operand_shape).c_str());
+  }
+
+  if (!ShapeUtil::ElementIsIntegral(indices_shape)) {
+    return InvalidArgument("gather indices must be of integral type: %s",
+                           ShapeUtil::HumanString(indices_shape).c_str());
+  }
+
+  std::vector<int64> dimensions(indices_shape.dimensions().begin(),
+                                indices_shape.dimensions().end());
+  dimensions.insert(dimensions.end(), operand_shape.dimensions().begin() + 1,
+                    operand_shape.dimensions().end());
+  return ShapeUtil::MakeShape(operand_shape.element_type(), dimensions);
+}
+
 /* static */ StatusOr<Shape> ShapeInference::InferDynamicUpdateSliceShape(
     const Shape& operand_shape, const Shape& update_shape,
     const Shape& start_indices_shape) {
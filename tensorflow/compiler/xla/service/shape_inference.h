@@ -117,6 +117,14 @@ class ShapeInference {
       const Shape& operand_shape, const Shape& start_indices_shape,
       tensorflow::gtl::ArraySlice<int64> slice_sizes);
 
+  // Infers the shape produced by gathering the slices of 'operand_shape' along
+  // dimension 0 at the given indices: the dimensions of the indices followed
+  // by the remaining dimensions of the operand.
+  //
+  // e.g. gather f32[100x16] at s32[8x4] -> f32[8x4x16]
+  static StatusOr<Shape> InferGatherShape(const Shape& operand_shape,
+                                          const Shape& indices_shape);
+
   // Infers the shape produced by a dynamic update slice operation based
   // on the shape of operand and update.
   static StatusOr<Shape> InferDynamicUpdateSliceShape(
@@ -1203,6 +1203,27 @@ TEST_F(ShapeInferenceTest, Call) {
               HasSubstr("parameter must match argument"));
 }
 
+TEST_F(ShapeInferenceTest, Gather) {
+  Shape indices_shape = ShapeUtil::MakeShape(S32, {2, 3});
+  auto inferred_status =
+      ShapeInference::InferGatherShape(matrix_32_48_, indices_shape);
+  ASSERT_IS_OK(inferred_status.status());
+  EXPECT_TRUE(ShapeUtil::Equal(ShapeUtil::MakeShape(F32, {2, 3, 48}),
+                               inferred_status.ValueOrDie()));
+
+  auto inferred_status_error0 =
+      ShapeInference::InferGatherShape(f32_, indices_shape);
+  ASSERT_FALSE(inferred_status_error0.ok());
+  EXPECT_THAT(inferred_status_error0.status().error_message(),
+              HasSubstr("at least rank 1"));
+
+  auto inferred_status_error1 =
+      ShapeInference::InferGatherShape(matrix_32_48_, vector_32_);
+  ASSERT_FALSE(inferred_status_error1.ok());
+  EXPECT_THAT(inferred_status_error1.status().error_message(),
+              HasSubstr("integral type"));
+}
+
 TEST_F(ShapeInferenceTest, Transpose) {
   Shape a_shape = ShapeUtil::MakeShape(F32, {2, 3, 4, 5});
   auto inferred_shape_and_status =
@@ -35,6 +35,11 @@ TransferManager::platform_transfer_manager_mutex() {
   return m;
 }
 
+Status TransferManager::DonateLiteralToInfeed(
+    se::StreamExecutor* executor, std::unique_ptr<Literal> literal) {
+  return TransferLiteralToInfeed(executor, *literal);
+}
+
 /* static */ std::map<perftools::gputools::Platform::Id,
                       TransferManager::State>*
 TransferManager::GetPlatformTransferManagers() {
@@ -113,6 +118,41 @@ Status TransferManager::TransferBufferToDevice(
   return Status::OK();
 }
 
+Status TransferManager::TransferBufferToDeviceAsync(
+    se::Stream* stream, int64 size, const void* source,
+    se::DeviceMemoryBase* destination) {
+  if (destination->size() < size) {
+    return FailedPrecondition(
+        "Destination allocation on device not large enough for data tranfer: "
+        "%lld < %lld",
+        destination->size(), size);
+  }
+  if (!stream->ThenMemcpy(destination, source, size).ok()) {
+    return InternalError("failed to enqueue transfer of buffer to device");
+  }
+  return Status::OK();
+}
+
+Status TransferManager::TransferLiteralToDeviceAsync(
+    se::Stream* stream, const Literal& literal,
+    se::DeviceMemoryBase* region) {
+  if (!stream->BlockHostUntilDone()) {
+    return InternalError("failed to wait for stream before transfer");
+  }
+  return TransferLiteralToDevice(stream->parent(), literal, region);
+}
+
+Status TransferManager::TransferLiteralsToDeviceAsync(
+    se::Stream* stream, tensorflow::gtl::ArraySlice<const Literal*> literals,
+    tensorflow::gtl::ArraySlice<se::DeviceMemoryBase*> regions) {
+  TF_RET_CHECK(literals.size() == regions.size());
+  for (size_t i = 0; i < literals.size(); ++i) {
+    TF_RETURN_IF_ERROR(
+        TransferLiteralToDeviceAsync(stream, *literals[i], regions[i]));
+  }
+  return Status::OK();
+}
+
 StatusOr<std::set<se::DeviceMemoryBase>>
 TransferManager::GatherBufferPointersFromTuple(
     se::StreamExecutor* executor, const se::DeviceMemoryBase& source,
@@ -59,12 +59,40 @@ class TransferManager {
       perftools::gputools::StreamExecutor* executor, const Literal& literal,
       perftools::gputools::DeviceMemoryBase* region) = 0;
 
+  // Enqueues the transfer of the given literal into the provided region on
+  // 'stream' and returns without waiting for it to complete. The literal must
+  // stay alive and unmodified until the stream has completed the transfer. The
+  // default implementation waits for the stream and transfers synchronously.
+  virtual Status TransferLiteralToDeviceAsync(
+      perftools::gputools::Stream* stream, const Literal& literal,
+      perftools::gputools::DeviceMemoryBase* region);
+
+  // Enqueues the transfers of literals[i] into regions[i] on 'stream', see
+  // TransferLiteralToDeviceAsync. Streams are used rather than events to
+  // order transfers with the computations using them, as not all platforms
+  // support events: a computation enqueued on 'stream', or on a stream
+  // waiting for it with ThenWaitFor, sees the transferred data. This lets
+  // the arguments of the next computation be transferred while the current
+  // one runs on another stream.
+  Status TransferLiteralsToDeviceAsync(
+      perftools::gputools::Stream* stream,
+      tensorflow::gtl::ArraySlice<const Literal*> literals,
+      tensorflow::gtl::ArraySlice<perftools::gputools::DeviceMemoryBase*>
+          regions);
+
   // Transfers the given literal into the Infeed interface of the device,
   // using the given executor.
   virtual Status TransferLiteralToInfeed(
       perftools::gputools::StreamExecutor* executor,
       const Literal& literal) = 0;
 
+  // Transfers the given literal into the Infeed interface of the device, which
+  // may take ownership of its storage rather than copying it. The default
+  // implementation calls TransferLiteralToInfeed.
+  virtual Status DonateLiteralToInfeed(
+      perftools::gputools::StreamExecutor* executor,
+      std::unique_ptr<Literal> literal);
+
   // Transfers the given literal from the Outfeed interface of the device,
   // using the given executor.
   virtual Status TransferLiteralFromOutfeed(
@@ -117,6 +145,13 @@ class TransferManager {
       perftools::gputools::StreamExecutor* executor, int64 size,
       const void* source, perftools::gputools::DeviceMemoryBase* destination);
 
+  // Enqueues the transfer of a memory block of the given size from 'source'
+  // buffer to the given destination of the device on 'stream'. 'source' must
+  // stay alive until the stream has completed the transfer.
+  virtual Status TransferBufferToDeviceAsync(
+      perftools::gputools::Stream* stream, int64 size, const void* source,
+      perftools::gputools::DeviceMemoryBase* destination);
+
   typedef std::unique_ptr<TransferManager> (*TransferManagerCreationFunction)();
 
   /////
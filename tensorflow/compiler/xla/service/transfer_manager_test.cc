@@ -76,6 +76,26 @@ TEST_F(CpuTransferManagerTest, TransferR1F32ToDevice) {
   CHECK_EQ(-20.125f, *reinterpret_cast<float*>(&storage[3 * sizeof(float)]));
 }
 
+TEST_F(CpuTransferManagerTest, TransferLiteralsToDeviceAsync) {
+  std::vector<uint8> storage_a(sizeof(uint32), '\x00');
+  std::vector<uint8> storage_b(2 * sizeof(float), '\x00');
+  se::DeviceMemoryBase memptr_a(storage_a.data(), storage_a.size());
+  se::DeviceMemoryBase memptr_b(storage_b.data(), storage_b.size());
+  std::unique_ptr<Literal> literal_a = LiteralUtil::CreateR0<uint32>(42);
+  std::unique_ptr<Literal> literal_b =
+      LiteralUtil::CreateR1<float>({1.25f, -17.0f});
+
+  se::Stream stream(stream_exec_);
+  stream.Init();
+  TF_CHECK_OK(transfer_manager_.TransferLiteralsToDeviceAsync(
+      &stream, {literal_a.get(), literal_b.get()}, {&memptr_a, &memptr_b}));
+  CHECK(stream.BlockHostUntilDone());
+
+  CHECK_EQ(42, *reinterpret_cast<uint32*>(&storage_a[0]));
+  CHECK_EQ(1.25f, *reinterpret_cast<float*>(&storage_b[0]));
+  CHECK_EQ(-17.0f, *reinterpret_cast<float*>(&storage_b[sizeof(float)]));
+}
+
 TEST_F(CpuTransferManagerTest, TransferR1U8ToDevice) {
   std::vector<uint8> storage(16, '\x00');
   se::DeviceMemoryBase memptr(storage.data(), storage.size());
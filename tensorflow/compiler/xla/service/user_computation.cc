@@ -786,6 +786,34 @@ UserComputation::AddDynamicUpdateSliceInstruction(
   return handle;
 }
 
+StatusOr<ComputationDataHandle> UserComputation::AddGatherInstruction(
+    const GatherRequest& gather_request) {
+  tensorflow::mutex_lock lock(mutex_);
+
+  TF_ASSIGN_OR_RETURN(const OperationRequest* operand,
+                      LookUpRequest(gather_request.operand()));
+
+  TF_ASSIGN_OR_RETURN(const OperationRequest* indices,
+                      LookUpRequest(gather_request.indices()));
+
+  TF_ASSIGN_OR_RETURN(Shape new_shape,
+                      ShapeInference::InferGatherShape(
+                          operand->output_shape(), indices->output_shape()));
+
+  ComputationDataHandle handle = CreateComputationDataHandle();
+
+  OperationRequest& request =
+      (*session_computation_.mutable_requests())[handle.handle()];
+  *request.mutable_output_handle() = handle;
+  *request.mutable_output_shape() = new_shape;
+  *request.mutable_request()->mutable_gather_request() = gather_request;
+
+  VLOG(1) << "AddGatherInstruction (" << GetVersionedHandleInternal()
+          << "), data handle " << handle.handle() << ": "
+          << gather_request.ShortDebugString();
+  return handle;
+}
+
 StatusOr<ComputationDataHandle> UserComputation::AddConcatenateInstruction(
     const ConcatenateRequest& concatenate_request) {
   tensorflow::mutex_lock lock(mutex_);
@@ -1352,6 +1380,15 @@ void ConstantVisitor(const SessionComputation& session_computation,
       break;
     }
 
+    case OpRequest::kGatherRequest: {
+      const GatherRequest& gather_request = request.request().gather_request();
+      ConstantVisitor(session_computation, gather_request.operand(), visited,
+                      is_constant);
+      ConstantVisitor(session_computation, gather_request.indices(), visited,
+                      is_constant);
+      break;
+    }
+
     case OpRequest::kConcatenateRequest: {
       const ConcatenateRequest& concatenate_request =
           request.request().concatenate_request();
@@ -1945,6 +1982,13 @@ static void ForEachOperand(
       break;
     }
 
+    case OpRequest::kGatherRequest: {
+      const GatherRequest& gather_request = request.request().gather_request();
+      apply(gather_request.operand());
+      apply(gather_request.indices());
+      break;
+    }
+
     case OpRequest::kConcatenateRequest: {
       const ConcatenateRequest& concatenate_request =
           request.request().concatenate_request();
@@ -2328,6 +2372,15 @@ void ComputationLowerer::Visit(
       break;
     }
 
+    case OpRequest::kGatherRequest: {
+      const GatherRequest& gather_request = request.request().gather_request();
+      HloInstruction* operand = lookup_instruction(gather_request.operand());
+      HloInstruction* indices = lookup_instruction(gather_request.indices());
+      hlo_instruction = add_instruction(HloInstruction::CreateGather(
+          request.output_shape(), operand, indices));
+      break;
+    }
+
     case OpRequest::kConcatenateRequest: {
       const ConcatenateRequest& concatenate_request =
           request.request().concatenate_request();
@@ -160,6 +160,10 @@ class UserComputation {
   StatusOr<ComputationDataHandle> AddDynamicUpdateSliceInstruction(
       const DynamicUpdateSliceRequest& dynamic_update_slice_request);
 
+  // Enqueues a gather instruction onto this user computation.
+  StatusOr<ComputationDataHandle> AddGatherInstruction(
+      const GatherRequest& gather_request);
+
   // Enqueues a concatenate instruction onto this user computation.
   StatusOr<ComputationDataHandle> AddConcatenateInstruction(
       const ConcatenateRequest& slice_request);
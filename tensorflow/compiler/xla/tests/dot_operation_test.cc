@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -211,6 +212,50 @@ void DotOperationTest::TestMatrixDot(int M, int K, int N, bool lhs_row_major,
                              ErrorSpec(0.3, 3e-3));
 }
 
+// Tests a dot whose sizes aren't multiples of the tiles of the CPU backend,
+// followed by elementwise ops which can be fused into it.
+XLA_TEST_F(DotOperationTest, MatrixDotWithBiasAndReluF32) {
+  const int M = 9, K = 5, N = 37;
+  std::unique_ptr<Array2D<float>> lhs_data =
+      MakeLinspaceArray2D(-1.0, 1.0, M, K);
+  std::unique_ptr<Array2D<float>> rhs_data =
+      MakeLinspaceArray2D(-1.0, 1.0, K, N);
+  std::vector<float> bias_data(N);
+  for (int j = 0; j < N; ++j) {
+    bias_data[j] = 0.1f * (j % 7) - 0.3f;
+  }
+  auto lhs_handle =
+      client_->TransferToServer(*LiteralUtil::CreateR2FromArray2D(*lhs_data))
+          .ConsumeValueOrDie();
+  auto rhs_handle =
+      client_->TransferToServer(*LiteralUtil::CreateR2FromArray2D(*rhs_data))
+          .ConsumeValueOrDie();
+  auto bias_handle =
+      client_->TransferToServer(*LiteralUtil::CreateR1<float>(bias_data))
+          .ConsumeValueOrDie();
+
+  ComputationBuilder builder(client_, TestName());
+  auto dot = builder.Dot(
+      builder.Parameter(0, ShapeUtil::MakeShape(F32, {M, K}), "lhs"),
+      builder.Parameter(1, ShapeUtil::MakeShape(F32, {K, N}), "rhs"));
+  auto biased = builder.Add(
+      dot, builder.Parameter(2, ShapeUtil::MakeShape(F32, {N}), "bias"),
+      /*broadcast_dimensions=*/{1});
+  builder.Max(biased, builder.ConstantR0<float>(0.0f));
+
+  std::unique_ptr<Array2D<float>> expected =
+      ReferenceUtil::MatmulArray2D(*lhs_data, *rhs_data);
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      (*expected)(i, j) = std::max(0.0f, (*expected)(i, j) + bias_data[j]);
+    }
+  }
+
+  ComputeAndCompareR2<float>(
+      &builder, *expected,
+      {lhs_handle.get(), rhs_handle.get(), bias_handle.get()}, error_spec_);
+}
+
 XLA_TEST_F(DotOperationTest, MatrixDotF32_12_117_7_MinorToMajorTF) {
   TestMatrixDot(12, 117, 7, true, false);
 }
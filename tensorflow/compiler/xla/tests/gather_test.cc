@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests that gather operations can be performed.
+
+#include <vector>
+
+#include "tensorflow/compiler/xla/array2d.h"
+#include "tensorflow/compiler/xla/client/computation_builder.h"
+#include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/legacy_flags/cpu_compiler_flags.h"
+#include "tensorflow/compiler/xla/tests/client_library_test_base.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/compiler/xla/tests/test_macros.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace xla {
+namespace {
+
+class GatherTest : public ClientLibraryTestBase {};
+
+XLA_TEST_F(GatherTest, GatherR1) {
+  ComputationBuilder builder(client_, TestName());
+  auto operand = builder.ConstantR1<float>({0.0, 1.0, 2.0, 3.0, 4.0});
+  auto indices = builder.ConstantR1<int32>({4, 0, 2, 2});
+  builder.Gather(operand, indices);
+
+  ComputeAndCompareR1<float>(&builder, {4.0, 0.0, 2.0, 2.0}, {});
+}
+
+XLA_TEST_F(GatherTest, GatherRowsOfR2) {
+  ComputationBuilder builder(client_, TestName());
+  auto operand =
+      builder.ConstantR2<float>({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+  auto indices = builder.ConstantR1<int64>({2, 0});
+  builder.Gather(operand, indices);
+
+  ComputeAndCompareR2<float>(&builder,
+                             Array2D<float>({{5.0, 6.0}, {1.0, 2.0}}), {});
+}
+
+XLA_TEST_F(GatherTest, GatherWithR2Indices) {
+  ComputationBuilder builder(client_, TestName());
+  auto operand = builder.ConstantR1<int32>({10, 11, 12});
+  auto indices = builder.ConstantR2<int32>({{0, 1}, {2, 1}});
+  builder.Gather(operand, indices);
+
+  ComputeAndCompareR2<int32>(&builder, Array2D<int32>({{10, 11}, {12, 11}}),
+                             {});
+}
+
+XLA_TEST_F(GatherTest, OutOfBoundsIndicesAreClamped) {
+  ComputationBuilder builder(client_, TestName());
+  auto operand = builder.ConstantR1<float>({0.0, 1.0, 2.0});
+  auto indices = builder.ConstantR1<int32>({-1, 3, 100});
+  builder.Gather(operand, indices);
+
+  ComputeAndCompareR1<float>(&builder, {0.0, 2.0, 2.0}, {});
+}
+
+XLA_TEST_F(GatherTest, GatherFusedWithConsumer) {
+  ComputationBuilder builder(client_, TestName());
+  auto operand = builder.ConstantR1<float>({0.0, 1.0, 2.0, 3.0});
+  auto indices = builder.ConstantR1<int32>({3, 1});
+  builder.Add(builder.Gather(operand, indices),
+              builder.ConstantR1<float>({10.0, 20.0}));
+
+  ComputeAndCompareR1<float>(&builder, {13.0, 21.0}, {});
+}
+
+}  // namespace
+}  // namespace xla
+
+int main(int argc, char** argv) {
+  std::vector<tensorflow::Flag> flag_list;
+  xla::legacy_flags::AppendCpuCompilerFlags(&flag_list);
+  xla::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result) {
+    LOG(ERROR) << "\n" << usage;
+    return 2;
+  }
+  testing::InitGoogleTest(&argc, argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return 2;
+  }
+  return RUN_ALL_TESTS();
+}
@@ -19,6 +19,7 @@ from __future__ import division
 from __future__ import print_function
 
 # Add projects here, they will show up under tf.contrib.
+from tensorflow.contrib import all_reduce
 from tensorflow.contrib import bayesflow
 from tensorflow.contrib import cloud
 from tensorflow.contrib import compiler
@@ -57,6 +58,7 @@ from tensorflow.contrib import seq2seq
 from tensorflow.contrib import signal
 from tensorflow.contrib import slim
 from tensorflow.contrib import solvers
+from tensorflow.contrib import sparse_matrix
 from tensorflow.contrib import sparsemax
 from tensorflow.contrib import staging
 from tensorflow.contrib import stat_summarizer
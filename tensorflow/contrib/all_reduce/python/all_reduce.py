@@ -0,0 +1,284 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""All-reduce algorithms built from ops placed on the participating devices.
+
+Each algorithm only moves tensors between the devices of its inputs, so
+when they are on different workers the graph partitioner connects them
+with `Send`/`Recv` pairs that transfer the data over the worker channels,
+instead of routing every tensor through a parameter server.
+"""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import collections
+
+from tensorflow.python.framework import device as pydev
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+
+
+def _check_tensors(tensors):
+  """Validates the inputs of an all-reduce."""
+  if not tensors:
+    raise ValueError("Must pass >0 tensors to all-reduce operations")
+  dtype = tensors[0].dtype
+  shape = tensors[0].get_shape()
+  for t in tensors:
+    if not t.device:
+      raise ValueError("Device assignment required for all-reduce inputs: %s"
+                       % t.name)
+    if t.dtype != dtype:
+      raise ValueError("All-reduce inputs must have the same dtype, got %s "
+                       "and %s" % (dtype, t.dtype))
+    if not shape.is_compatible_with(t.get_shape()):
+      raise ValueError("All-reduce inputs must have the same shape, got %s "
+                       "and %s" % (shape, t.get_shape()))
+
+
+def _split_tensor(t, num_pieces):
+  """Splits `t` into `num_pieces` flat pieces of equal size.
+
+  The flattened tensor is padded with zeros to a multiple of `num_pieces`
+  elements.
+
+  Args:
+    t: The tensor to split.
+    num_pieces: The number of pieces.
+
+  Returns:
+    The list of pieces, and the number of elements of `t`.
+  """
+  with ops.device(t.device):
+    flat = array_ops.reshape(t, [-1])
+    size = array_ops.size(flat)
+    padding = math_ops.mod(num_pieces - math_ops.mod(size, num_pieces),
+                           num_pieces)
+    flat = array_ops.pad(flat, [[0, padding]])
+    return array_ops.split(flat, num_pieces), size
+
+
+def _join_pieces(pieces, size, like):
+  """Inverts `_split_tensor`, giving the result the shape of `like`."""
+  with ops.device(like.device):
+    flat = array_ops.concat(pieces, 0)
+    flat = array_ops.slice(flat, [0], [size])
+    return array_ops.reshape(flat, array_ops.shape(like))
+
+
+def ring_all_reduce(tensors, num_chunks=1, reduction=math_ops.add):
+  """Returns the all-reduction of `tensors`, computed around a ring.
+
+  The devices of `tensors` form a ring in the order given. Each tensor is
+  split into `len(tensors)` segments. In a first pass, every segment
+  travels once around the ring and is reduced with the corresponding
+  segment on each device it visits; in a second pass, the fully reduced
+  segments are passed around the ring once more. Each device sends and
+  receives about `2 * (n - 1) / n` times the size of a tensor, independently
+  of the number of devices `n`, which makes this bandwidth-optimal for
+  large tensors.
+
+  Each segment is further split into `num_chunks` chunks that are reduced
+  independently, so that transfers of later chunks overlap with the
+  reduction of earlier ones.
+
+  Args:
+    tensors: The tensors to reduce, each assigned to a different device,
+      with the same dtype and shape.
+    num_chunks: The number of chunks of each segment.
+    reduction: A binary function that reduces two tensors elementwise,
+      e.g. `tf.add` or `tf.maximum`.
+
+  Returns:
+    A list of tensors with the reduced value, where tensor `i` is on the
+    device of `tensors[i]`.
+
+  Raises:
+    ValueError: If the tensors are not valid all-reduce inputs, or
+      `num_chunks` is not positive.
+  """
+  _check_tensors(tensors)
+  if num_chunks < 1:
+    raise ValueError("num_chunks must be positive, got %d" % num_chunks)
+  n = len(tensors)
+  devices = [t.device for t in tensors]
+  if n == 1:
+    with ops.device(devices[0]):
+      return [array_ops.identity(tensors[0])]
+
+  # pieces[r][j * num_chunks + c] is chunk c of segment j on device r.
+  pieces = []
+  sizes = []
+  for t in tensors:
+    p, size = _split_tensor(t, n * num_chunks)
+    pieces.append(p)
+    sizes.append(size)
+
+  outputs = [[None] * (n * num_chunks) for _ in range(n)]
+  for j in range(n):
+    for c in range(num_chunks):
+      k = j * num_chunks + c
+      # Reduce the chunk on its way from device j to device j - 1.
+      value = pieces[j][k]
+      for step in range(1, n):
+        r = (j + step) % n
+        with ops.device(devices[r]):
+          value = reduction(value, pieces[r][k])
+      # Pass the reduced chunk on from device j - 1 to device j - 2.
+      owner = (j + n - 1) % n
+      outputs[owner][k] = value
+      for step in range(1, n):
+        r = (owner + step) % n
+        with ops.device(devices[r]):
+          value = array_ops.identity(value)
+        outputs[r][k] = value
+
+  return [_join_pieces(outputs[r], sizes[r], tensors[r]) for r in range(n)]
+
+
+def tree_all_reduce(tensors, reduction=math_ops.add):
+  """Returns the all-reduction of `tensors`, computed along a binary tree.
+
+  The tensors are reduced pairwise towards the device of `tensors[0]`, and
+  the result is sent back down the same tree. This takes `2 * log2(n)`
+  sequential transfers of whole tensors, so it has lower latency than
+  `ring_all_reduce` for small tensors, but more traffic on the devices near
+  the root.
+
+  Args:
+    tensors: The tensors to reduce, each assigned to a different device,
+      with the same dtype and shape.
+    reduction: A binary function that reduces two tensors elementwise,
+      e.g. `tf.add` or `tf.maximum`.
+
+  Returns:
+    A list of tensors with the reduced value, where tensor `i` is on the
+    device of `tensors[i]`.
+
+  Raises:
+    ValueError: If the tensors are not valid all-reduce inputs.
+  """
+  _check_tensors(tensors)
+  n = len(tensors)
+  devices = [t.device for t in tensors]
+  values = list(tensors)
+  stride = 1
+  while stride < n:
+    for i in range(0, n - stride, 2 * stride):
+      with ops.device(devices[i]):
+        values[i] = reduction(values[i], values[i + stride])
+    stride *= 2
+
+  outputs = [None] * n
+  with ops.device(devices[0]):
+    outputs[0] = array_ops.identity(values[0])
+  while stride > 1:
+    stride //= 2
+    for i in range(0, n - stride, 2 * stride):
+      with ops.device(devices[i + stride]):
+        outputs[i + stride] = array_ops.identity(outputs[i])
+  return outputs
+
+
+def _group_by_worker(tensors):
+  """Returns the indices of `tensors`, grouped by the task of their device.
+
+  The groups are ordered by their first tensor.
+  """
+  groups = collections.OrderedDict()
+  for i, t in enumerate(tensors):
+    spec = pydev.DeviceSpec.from_string(t.device)
+    groups.setdefault((spec.job, spec.replica, spec.task), []).append(i)
+  return list(groups.values())
+
+
+def _is_gpu(t):
+  device_type = pydev.DeviceSpec.from_string(t.device).device_type
+  return device_type is not None and device_type.upper() == "GPU"
+
+
+def hierarchical_all_sum(tensors, num_chunks=1, use_nccl=True):
+  """Returns the all-reduce sum of `tensors` across several workers.
+
+  The tensors on the devices of each worker (task) are first summed within
+  the worker, then the per-worker sums are all-reduced with
+  `ring_all_reduce` between one device of each worker, and the result is
+  broadcast to the other devices of the worker. Only one tensor per worker
+  crosses the network in each direction.
+
+  Within a worker whose tensors are all on GPUs, the sum and the broadcast
+  use NCCL collectives if `use_nccl` is true.
+
+  Args:
+    tensors: The tensors to sum, each assigned to a different device, with
+      the same dtype and shape.
+    num_chunks: The number of chunks of each ring segment, as for
+      `ring_all_reduce`.
+    use_nccl: Whether to use NCCL within workers whose tensors are on GPUs.
+
+  Returns:
+    A list of tensors with the sum, where tensor `i` is on the device of
+    `tensors[i]`.
+
+  Raises:
+    ValueError: If the tensors are not valid all-reduce inputs.
+  """
+  _check_tensors(tensors)
+  groups = _group_by_worker(tensors)
+
+  worker_sums = []
+  worker_deps = []
+  for group in groups:
+    group_tensors = [tensors[i] for i in group]
+    if len(group_tensors) == 1:
+      worker_sums.append(group_tensors[0])
+      worker_deps.append([])
+    elif use_nccl and all(_is_gpu(t) for t in group_tensors):
+      # pylint: disable=g-import-not-at-top
+      from tensorflow.contrib.nccl.python.ops import nccl_ops
+      # pylint: enable=g-import-not-at-top
+      sums = nccl_ops.all_sum(group_tensors)
+      worker_sums.append(sums[0])
+      # All of the NCCL ops of a collective must run.
+      worker_deps.append(sums[1:])
+    else:
+      with ops.device(group_tensors[0].device):
+        worker_sums.append(math_ops.add_n(group_tensors))
+      worker_deps.append([])
+
+  reduced = ring_all_reduce(worker_sums, num_chunks=num_chunks)
+
+  outputs = [None] * len(tensors)
+  for group, value, deps in zip(groups, reduced, worker_deps):
+    outputs[group[0]] = value
+    rest = group[1:]
+    if not rest:
+      continue
+    if use_nccl and all(_is_gpu(tensors[i]) for i in group):
+      # pylint: disable=g-import-not-at-top
+      from tensorflow.contrib.nccl.python.ops import nccl_ops
+      # pylint: enable=g-import-not-at-top
+      send, recvs = nccl_ops.broadcast(value,
+                                       [tensors[i].device for i in rest])
+      for i, recv, dep in zip(rest, recvs, deps):
+        with ops.device(tensors[i].device):
+          with ops.control_dependencies([send, dep]):
+            outputs[i] = array_ops.identity(recv)
+    else:
+      for i in rest:
+        with ops.device(tensors[i].device):
+          outputs[i] = array_ops.identity(value)
+  return outputs
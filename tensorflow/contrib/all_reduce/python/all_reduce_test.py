@@ -0,0 +1,112 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for tensorflow.contrib.all_reduce.python.all_reduce."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.all_reduce.python import all_reduce
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import device as pydev
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+_NUM_DEVICES = 4
+
+
+class AllReduceTest(test.TestCase):
+
+  def _session(self):
+    config = config_pb2.ConfigProto(device_count={"CPU": _NUM_DEVICES})
+    return self.test_session(config=config)
+
+  def _inputs(self, n, shape):
+    values = [np.random.uniform(size=shape).astype(np.float32)
+              for _ in range(n)]
+    tensors = []
+    for i, value in enumerate(values):
+      with ops.device("/cpu:%d" % i):
+        tensors.append(constant_op.constant(value))
+    return values, tensors
+
+  def _check(self, build, n, shape, expected_fn=sum):
+    with self._session() as sess:
+      values, tensors = self._inputs(n, shape)
+      outputs = build(tensors)
+      self.assertEqual(n, len(outputs))
+      for i, t in enumerate(outputs):
+        self.assertEqual(i, pydev.DeviceSpec.from_string(t.device).device_index)
+      results = sess.run(outputs)
+    expected = expected_fn(values)
+    for result in results:
+      self.assertAllClose(expected, result)
+
+  def testRingAllReduce(self):
+    for n in range(1, _NUM_DEVICES + 1):
+      for num_chunks in range(1, 4):
+        for shape in [[], [7], [4, 6]]:
+          self._check(
+              lambda t: all_reduce.ring_all_reduce(t, num_chunks=num_chunks),
+              n, shape)
+
+  def testRingAllReduceMaximum(self):
+    self._check(
+        lambda t: all_reduce.ring_all_reduce(t, reduction=math_ops.maximum),
+        3, [5, 3], lambda v: np.maximum.reduce(v))
+
+  def testTreeAllReduce(self):
+    for n in range(1, _NUM_DEVICES + 1):
+      self._check(all_reduce.tree_all_reduce, n, [3, 5])
+
+  def testHierarchicalAllSum(self):
+    # All of the devices of a local session belong to a single worker, so
+    # the cross-worker ring is covered by testRingAllReduce.
+    self._check(
+        lambda t: all_reduce.hierarchical_all_sum(t, use_nccl=False),
+        _NUM_DEVICES, [10])
+
+  def testGroupByWorker(self):
+    with ops.Graph().as_default():
+      tensors = []
+      for device in ["/job:worker/task:0/cpu:0", "/job:worker/task:1/cpu:0",
+                     "/job:worker/task:0/cpu:1", "/job:worker/task:1/gpu:0"]:
+        with ops.device(device):
+          tensors.append(constant_op.constant(1.0))
+      # pylint: disable=protected-access
+      self.assertEqual([[0, 2], [1, 3]], all_reduce._group_by_worker(tensors))
+      # pylint: enable=protected-access
+
+  def testInvalidInputs(self):
+    with ops.Graph().as_default():
+      with self.assertRaisesRegexp(ValueError, "Must pass >0 tensors"):
+        all_reduce.ring_all_reduce([])
+      with self.assertRaisesRegexp(ValueError, "Device assignment required"):
+        all_reduce.ring_all_reduce([constant_op.constant(1.0)])
+      with ops.device("/cpu:0"):
+        a = constant_op.constant([1.0, 2.0])
+        b = constant_op.constant([1.0, 2.0, 3.0])
+      with self.assertRaisesRegexp(ValueError, "same shape"):
+        all_reduce.tree_all_reduce([a, b])
+      with self.assertRaisesRegexp(ValueError, "num_chunks must be positive"):
+        all_reduce.ring_all_reduce([a], num_chunks=0)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,189 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BATCHING_ADAPTIVE_BATCH_POLICY_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BATCHING_ADAPTIVE_BATCH_POLICY_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Picks the batch size cutoff and batch timeout of a batch scheduling queue
+// from the recently observed batch processing times, to form batches as large
+// as possible while keeping task latencies below a target.
+//
+// A task waits at most the batch timeout for its batch to close, and is done
+// once the batch is processed, so its latency is bounded by the timeout plus
+// the processing time of the batch (ignoring the time the batch waits for a
+// free batch thread). The policy fits the processing time of a batch as a
+// linear function of its size, with more weight given to recent batches, and
+// adds a margin of three times the mean absolute error of the fit, which
+// approximates the 99th percentile of the processing time. It then chooses:
+//  - the largest batch size, up to 'max_batch_size', whose estimated
+//    processing time plus margin fits in 'target_latency_micros', since larger
+//    batches amortize more of the processing cost;
+//  - the batch timeout that spends the rest of the target waiting for tasks,
+//    up to 'max_batch_timeout_micros'.
+//
+// Until the first batch is recorded, or if 'target_latency_micros' is 0, the
+// policy returns the maximum batch size and timeout. The processing time
+// estimate is maintained either way.
+//
+// Not thread-safe.
+class AdaptiveBatchPolicy {
+ public:
+  struct Options {
+    // Upper bounds of the batch size cutoff and batch timeout.
+    int max_batch_size = 1000;
+    int64 max_batch_timeout_micros = 0;
+
+    // The latency target. 0 disables the adaptation.
+    int64 target_latency_micros = 0;
+
+    // The weight of a batch in the fit is multiplied by 'decay' every time a
+    // newer batch is recorded. Must be in (0, 1].
+    double decay = 0.95;
+  };
+
+  explicit AdaptiveBatchPolicy(const Options& options);
+
+  // Records that a batch of 'batch_size' tasks took 'processing_micros' to
+  // process, and updates the batch size cutoff and timeout.
+  void RecordBatch(int batch_size, int64 processing_micros);
+
+  // Returns the estimated time to process a batch of 'batch_size' tasks, not
+  // including the margin. Returns 0 before the first batch is recorded.
+  double EstimatedProcessingMicros(int batch_size) const;
+
+  // The batch size above which a batch is closed, in [1, max_batch_size].
+  int batch_size_cutoff() const { return batch_size_cutoff_; }
+
+  // The time a batch stays open for more tasks, in
+  // [0, max_batch_timeout_micros].
+  int64 batch_timeout_micros() const { return batch_timeout_micros_; }
+
+ private:
+  // The estimation margin: three times the mean absolute error of the fit.
+  double MarginMicros() const;
+
+  const Options options_;
+
+  // Decayed sums over the recorded batches, of the weights, sizes (x),
+  // processing times (y), and their products; used to fit y = a + b * x by
+  // weighted least squares.
+  double sum_weights_ = 0;
+  double sum_x_ = 0;
+  double sum_y_ = 0;
+  double sum_xx_ = 0;
+  double sum_xy_ = 0;
+
+  // The decayed sum of the absolute errors of the estimates made just before
+  // recording each batch.
+  double sum_abs_error_ = 0;
+
+  int batch_size_cutoff_;
+  int64 batch_timeout_micros_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AdaptiveBatchPolicy);
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+inline AdaptiveBatchPolicy::AdaptiveBatchPolicy(const Options& options)
+    : options_(options),
+      batch_size_cutoff_(options.max_batch_size),
+      batch_timeout_micros_(options.max_batch_timeout_micros) {
+  DCHECK_GT(options.decay, 0);
+  DCHECK_LE(options.decay, 1);
+}
+
+inline void AdaptiveBatchPolicy::RecordBatch(int batch_size,
+                                             int64 processing_micros) {
+  if (batch_size <= 0) {
+    return;
+  }
+  const double x = batch_size;
+  const double y = processing_micros;
+  const double abs_error =
+      sum_weights_ > 0 ? std::abs(y - EstimatedProcessingMicros(batch_size))
+                       : 0;
+  const double decay = options_.decay;
+  sum_weights_ = decay * sum_weights_ + 1;
+  sum_x_ = decay * sum_x_ + x;
+  sum_y_ = decay * sum_y_ + y;
+  sum_xx_ = decay * sum_xx_ + x * x;
+  sum_xy_ = decay * sum_xy_ + x * y;
+  sum_abs_error_ = decay * sum_abs_error_ + abs_error;
+  if (options_.target_latency_micros <= 0) {
+    return;
+  }
+
+  // Binary search for the largest batch size whose estimated processing time
+  // plus margin fits in the target; the estimate is nondecreasing in the batch
+  // size. The cutoff is at least 1 even if no batch size fits.
+  const double budget_micros = options_.target_latency_micros - MarginMicros();
+  int cutoff = 1;
+  int too_large = options_.max_batch_size + 1;
+  while (too_large - cutoff > 1) {
+    const int middle = cutoff + (too_large - cutoff) / 2;
+    if (EstimatedProcessingMicros(middle) <= budget_micros) {
+      cutoff = middle;
+    } else {
+      too_large = middle;
+    }
+  }
+  batch_size_cutoff_ = cutoff;
+  const double remaining_micros =
+      budget_micros - EstimatedProcessingMicros(cutoff);
+  batch_timeout_micros_ = std::min<int64>(
+      options_.max_batch_timeout_micros,
+      std::max<int64>(0, static_cast<int64>(remaining_micros)));
+}
+
+inline double AdaptiveBatchPolicy::EstimatedProcessingMicros(
+    int batch_size) const {
+  if (sum_weights_ <= 0) {
+    return 0;
+  }
+  const double variance_x = sum_weights_ * sum_xx_ - sum_x_ * sum_x_;
+  // If the recorded batches have (nearly) the same size, the slope can't be
+  // fitted, so assume the processing time is proportional to the batch size,
+  // which doesn't underestimate larger batches.
+  const double kMinRelativeVariance = 1e-6;
+  if (variance_x <= kMinRelativeVariance * sum_x_ * sum_x_) {
+    return sum_x_ > 0 ? batch_size * sum_y_ / sum_x_ : 0;
+  }
+  // A negative slope would favor ever larger batches; clamp it to 0.
+  const double slope = std::max(
+      0.0, (sum_weights_ * sum_xy_ - sum_x_ * sum_y_) / variance_x);
+  const double intercept = (sum_y_ - slope * sum_x_) / sum_weights_;
+  return std::max(0.0, intercept + slope * batch_size);
+}
+
+inline double AdaptiveBatchPolicy::MarginMicros() const {
+  return sum_weights_ > 0 ? 3 * sum_abs_error_ / sum_weights_ : 0;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BATCHING_ADAPTIVE_BATCH_POLICY_H_
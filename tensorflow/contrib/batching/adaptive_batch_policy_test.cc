@@ -0,0 +1,114 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/batching/adaptive_batch_policy.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+AdaptiveBatchPolicy::Options MakeOptions(int64 target_latency_micros) {
+  AdaptiveBatchPolicy::Options options;
+  options.max_batch_size = 1000;
+  options.max_batch_timeout_micros = 5000;
+  options.target_latency_micros = target_latency_micros;
+  return options;
+}
+
+// Records batches of various sizes, whose processing times are
+// 'fixed_micros' + 'per_task_micros' * size.
+void RecordLinearCostBatches(int64 fixed_micros, int64 per_task_micros,
+                             AdaptiveBatchPolicy* policy) {
+  for (int i = 0; i < 500; ++i) {
+    const int batch_size = 10 + 10 * (i % 10);
+    policy->RecordBatch(batch_size,
+                        fixed_micros + per_task_micros * batch_size);
+  }
+}
+
+TEST(AdaptiveBatchPolicyTest, MaximaBeforeFirstBatch) {
+  AdaptiveBatchPolicy policy(MakeOptions(10 * 1000));
+  EXPECT_EQ(1000, policy.batch_size_cutoff());
+  EXPECT_EQ(5000, policy.batch_timeout_micros());
+  EXPECT_EQ(0, policy.EstimatedProcessingMicros(100));
+}
+
+TEST(AdaptiveBatchPolicyTest, DisabledWithoutTarget) {
+  AdaptiveBatchPolicy policy(MakeOptions(0));
+  RecordLinearCostBatches(1000, 100, &policy);
+  EXPECT_EQ(1000, policy.batch_size_cutoff());
+  EXPECT_EQ(5000, policy.batch_timeout_micros());
+}
+
+TEST(AdaptiveBatchPolicyTest, FitsLinearCost) {
+  AdaptiveBatchPolicy policy(MakeOptions(10 * 1000));
+  RecordLinearCostBatches(1000, 100, &policy);
+  EXPECT_NEAR(1000 + 100 * 50, policy.EstimatedProcessingMicros(50), 1);
+  EXPECT_NEAR(1000 + 100 * 200, policy.EstimatedProcessingMicros(200), 1);
+}
+
+TEST(AdaptiveBatchPolicyTest, CutoffFitsTargetAndTimeoutTakesTheRest) {
+  // A batch of 90 tasks takes 10000us, leaving 50us for the timeout; a batch
+  // of 91 tasks would exceed the target.
+  AdaptiveBatchPolicy policy(MakeOptions(10050));
+  RecordLinearCostBatches(1000, 100, &policy);
+  EXPECT_EQ(90, policy.batch_size_cutoff());
+  EXPECT_NEAR(50, policy.batch_timeout_micros(), 1);
+}
+
+TEST(AdaptiveBatchPolicyTest, TimeoutIsBounded) {
+  // Tasks are cheap enough that the largest batches leave more than the
+  // maximum timeout.
+  AdaptiveBatchPolicy policy(MakeOptions(100 * 1000));
+  RecordLinearCostBatches(1000, 10, &policy);
+  EXPECT_EQ(1000, policy.batch_size_cutoff());
+  EXPECT_EQ(5000, policy.batch_timeout_micros());
+}
+
+TEST(AdaptiveBatchPolicyTest, CutoffIsAtLeastOne) {
+  AdaptiveBatchPolicy policy(MakeOptions(500));
+  RecordLinearCostBatches(1000, 100, &policy);
+  EXPECT_EQ(1, policy.batch_size_cutoff());
+  EXPECT_EQ(0, policy.batch_timeout_micros());
+}
+
+TEST(AdaptiveBatchPolicyTest, MarginCoversNoisyCosts) {
+  AdaptiveBatchPolicy noiseless(MakeOptions(10 * 1000));
+  AdaptiveBatchPolicy noisy(MakeOptions(10 * 1000));
+  for (int i = 0; i < 500; ++i) {
+    const int batch_size = 10 + 10 * (i % 10);
+    const int64 cost = 1000 + 100 * batch_size;
+    noiseless.RecordBatch(batch_size, cost);
+    noisy.RecordBatch(batch_size, cost + (i % 2 == 0 ? 500 : -500));
+  }
+  EXPECT_LT(noisy.batch_size_cutoff(), noiseless.batch_size_cutoff());
+}
+
+TEST(AdaptiveBatchPolicyTest, ConstantBatchSize) {
+  // All batches have the same size, so the cost is assumed proportional to it.
+  AdaptiveBatchPolicy policy(MakeOptions(10 * 1000));
+  for (int i = 0; i < 100; ++i) {
+    policy.RecordBatch(100, 2000);
+  }
+  EXPECT_NEAR(4000, policy.EstimatedProcessingMicros(200), 1);
+  EXPECT_NEAR(500, policy.batch_size_cutoff(), 1);
+  EXPECT_LT(policy.batch_timeout_micros(), 100);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/contrib/batching/shared_batch_scheduler.h"
 
@@ -176,6 +177,20 @@ class BasicBatchScheduler : public BatchScheduler<TaskType> {
     // parameter.
     int max_enqueued_batches = 10;
 
+    // If positive, the scheduler adapts the batch size cutoff and the timeout
+    // to the processing times of recent batches, forming the largest batches
+    // whose tasks are estimated to complete within this many microseconds of
+    // their batch starting to fill, 99% of the time. 'max_batch_size' and
+    // 'batch_timeout_micros' then bound the cutoff and the timeout.
+    int64 target_latency_micros = 0;
+
+    // If non-empty, the batch sizes the process-batch callback pads batches up
+    // to, in increasing order and ending with 'max_batch_size'. A batch that
+    // times out at a size that isn't allowed is cut at its longest allowed-size
+    // prefix of tasks, and the remaining tasks are carried over to the next
+    // batch, once.
+    std::vector<int> allowed_batch_sizes;
+
     // The following options are typically only overridden by test code.
 
     // The environment to use.
@@ -227,6 +242,10 @@ Status BasicBatchScheduler<TaskType>::Create(
       options.batch_timeout_micros;
   shared_scheduler_queue_options.max_enqueued_batches =
       options.max_enqueued_batches;
+  shared_scheduler_queue_options.target_latency_micros =
+      options.target_latency_micros;
+  shared_scheduler_queue_options.allowed_batch_sizes =
+      options.allowed_batch_sizes;
   std::unique_ptr<BatchScheduler<TaskType>> shared_scheduler_queue;
   TF_RETURN_IF_ERROR(shared_scheduler->AddQueue(shared_scheduler_queue_options,
                                                 process_batch_callback,
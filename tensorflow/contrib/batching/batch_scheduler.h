@@ -62,6 +62,12 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the time, in Env::NowMicros() terms, by which the task should be
+  // done processing, or 0 if it has no deadline. Schedulers that support
+  // deadlines reject tasks past their deadline, and schedule the batches of
+  // tasks close to their deadline early.
+  virtual uint64 deadline_micros() const { return 0; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
@@ -206,6 +212,7 @@ std::unique_ptr<TaskType> Batch<TaskType>::RemoveTask() {
       return nullptr;
     }
     std::unique_ptr<TaskType> task = std::move(tasks_.back());
+    size_ -= task->size();
     tasks_.pop_back();
     return task;
   }
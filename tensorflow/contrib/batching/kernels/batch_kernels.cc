@@ -220,6 +220,8 @@ class BatchResource : public ResourceBase {
     new_resource->batcher_queue_options_.max_batch_size = max_batch_size;
     new_resource->batcher_queue_options_.batch_timeout_micros =
         batch_timeout_micros;
+    new_resource->batcher_queue_options_.allowed_batch_sizes.assign(
+        allowed_batch_sizes.begin(), allowed_batch_sizes.end());
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
 
@@ -232,10 +234,15 @@ class BatchResource : public ResourceBase {
   // Ingests data from one invocation of the batch op. The data is enqueued to
   // be combined with others into a batch, asynchronously.
   Status RegisterInput(int64 guid, OpKernelContext* context,
-                       const string& batcher_queue_name,
+                       const string& batcher_queue_name, int32 queue_priority,
+                       int32 queue_weight, int64 task_deadline_micros,
                        AsyncOpKernel::DoneCallback done_callback) {
     std::unique_ptr<BatchTask> batch_components(new BatchTask);
     batch_components->guid = guid;
+    if (task_deadline_micros > 0) {
+      batch_components->deadline =
+          Env::Default()->NowMicros() + task_deadline_micros;
+    }
     OpInputList tensors;
     TF_RETURN_IF_ERROR(context->input_list("in_tensors", &tensors));
     for (int i = 0; i < tensors.size(); ++i) {
@@ -256,8 +263,8 @@ class BatchResource : public ResourceBase {
     batch_components->done_callback = std::move(done_callback);
 
     BatcherQueue* batcher_queue;
-    TF_RETURN_IF_ERROR(
-        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+    TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+        batcher_queue_name, queue_priority, queue_weight, &batcher_queue));
     return batcher_queue->Schedule(&batch_components);
   }
 
@@ -273,7 +280,12 @@ class BatchResource : public ResourceBase {
     OpKernelContext* context;
     AsyncOpKernel::DoneCallback done_callback;
 
+    // The time by which the batch should be processed, or 0 if none.
+    uint64 deadline = 0;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
+
+    uint64 deadline_micros() const override { return deadline; }
   };
 
   using Batcher = serving::SharedBatchScheduler<BatchTask>;
@@ -345,6 +357,13 @@ class BatchResource : public ResourceBase {
             task.done_callback);
       }
 
+      // A batch of one task that needs no padding is the task's input itself,
+      // which is forwarded without copying.
+      if (batch->num_tasks() == 1 && padding_amount == 0) {
+        last_task_context->set_output(i, batch->task(0).inputs.at(i));
+        continue;
+      }
+
       // Concatenate the tasks ith input tensors into a big output tensor.
       std::vector<Tensor> to_concatenate;
       to_concatenate.reserve(batch->num_tasks());
@@ -353,7 +372,8 @@ class BatchResource : public ResourceBase {
       }
 
       // Add padding as needed. Use the first row of the first task's tensor as
-      // the data for padding.
+      // the data for padding. Split() returns that row as a slice sharing the
+      // task's buffer when the tensor is aligned, and only copies it otherwise.
       if (padding_amount > 0) {
         const Tensor& padding_source = batch->task(0).inputs.at(i);
         Tensor padding;
@@ -367,8 +387,8 @@ class BatchResource : public ResourceBase {
           switch (type) {
 #define CASE(type)                                                   \
   case DataTypeToEnum<type>::value:                                  \
-    slice_status = SplitCPU<type>(last_task_context, padding_source, \
-                                  slice_sizes, &slices);             \
+    slice_status = Split<type>(last_task_context, padding_source,    \
+                               slice_sizes, &slices);                \
     break;
             TF_CALL_ALL_TYPES(CASE);
 #undef CASE
@@ -462,8 +482,9 @@ class BatchResource : public ResourceBase {
   }
 
   // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
-  // creates it.
+  // creates it, with priority 'queue_priority' and weight 'queue_weight'.
   Status LookupOrCreateBatcherQueue(const string& queue_name,
+                                    int32 queue_priority, int32 queue_weight,
                                     BatcherQueue** queue) {
     mutex_lock l(batcher_queues_mu_);
 
@@ -477,8 +498,11 @@ class BatchResource : public ResourceBase {
     auto process_batch_callback = [this](std::unique_ptr<Batch> batch) {
       ProcessBatch(std::move(batch));
     };
-    TF_RETURN_IF_ERROR(batcher_->AddQueue(batcher_queue_options_,
-                                          process_batch_callback, &new_queue));
+    Batcher::QueueOptions queue_options = batcher_queue_options_;
+    queue_options.priority = queue_priority;
+    queue_options.weight = queue_weight;
+    TF_RETURN_IF_ERROR(batcher_->AddQueue(queue_options, process_batch_callback,
+                                          &new_queue));
     *queue = new_queue.get();
     batcher_queues_[queue_name] = std::move(new_queue);
     return Status::OK();
@@ -515,6 +539,13 @@ class BatchKernel : public AsyncOpKernel {
                    c->GetAttr("batch_timeout_micros", &batch_timeout_micros_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+    OP_REQUIRES_OK(c, c->GetAttr("queue_priority", &queue_priority_));
+    OP_REQUIRES_OK(c, c->GetAttr("queue_weight", &queue_weight_));
+    OP_REQUIRES(c, queue_weight_ > 0,
+                errors::InvalidArgument("queue_weight must be positive; was ",
+                                        queue_weight_));
+    OP_REQUIRES_OK(c,
+                   c->GetAttr("task_deadline_micros", &task_deadline_micros_));
   }
 
   void ComputeAsync(OpKernelContext* c, DoneCallback done) final {
@@ -533,7 +564,8 @@ class BatchKernel : public AsyncOpKernel {
                              container_, shared_name_, &br, creator),
                          done);
     const Status status =
-        br->RegisterInput(random::New64(), c, batcher_queue_, done);
+        br->RegisterInput(random::New64(), c, batcher_queue_, queue_priority_,
+                          queue_weight_, task_deadline_micros_, done);
     br->Unref();
     if (!status.ok()) {
       OP_REQUIRES_OK_ASYNC(c, status, done);
@@ -571,6 +603,9 @@ class BatchKernel : public AsyncOpKernel {
   int32 max_batch_size_;
   int32 batch_timeout_micros_;
   std::vector<int32> allowed_batch_sizes_;
+  int32 queue_priority_;
+  int32 queue_weight_;
+  int64 task_deadline_micros_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("Batch").Device(DEVICE_CPU), BatchKernel);
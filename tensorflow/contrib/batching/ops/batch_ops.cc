@@ -32,6 +32,9 @@ REGISTER_OP("Batch")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
     .Attr("batching_queue: string = ''")
+    .Attr("queue_priority: int = 0")
+    .Attr("queue_weight: int = 1")
+    .Attr("task_deadline_micros: int = 0")
     .Attr("T: list(type)")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       std::vector<shape_inference::ShapeHandle> in_shapes;
@@ -87,6 +90,16 @@ id: always contains a scalar with a unique ID for this invocation of Batch.
 shared_name: Concurrently running instances of batch in the same device with the
  same container and shared_name will batch their elements together. If left
  empty, the op name will be used as the shared name.
+batching_queue: Instances with the same container and shared_name but different
+ batching_queue values are batched separately, sharing the batch threads.
+queue_priority: The priority of this op's batching_queue, set by the first
+ invocation using the queue. Batches from queues of higher priority are
+ processed first.
+queue_weight: The number of consecutive batches this op's batching_queue gets
+ when its turn comes among queues of equal priority. Must be positive.
+task_deadline_micros: If positive, the number of microseconds after an
+ invocation by which its batch should be processed. The batch is then formed
+ early if needed to meet the deadline.
 T: the types of tensors to be batched.
 )doc");
 
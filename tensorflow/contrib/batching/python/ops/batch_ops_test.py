@@ -78,6 +78,21 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(len(empty_b), 0)
       self.assertEqual(len(empty_m), 0)
 
+  def testSingleTaskBatch(self):
+    """Tests that a batch of a single task passes its input through."""
+    with self.test_session() as sess:
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[2, 3])
+      batched, index, _ = batch_ops.batch(
+          [inp], num_batch_threads=1, max_batch_size=10,
+          batch_timeout_micros=1000,  # 1ms
+          grad_timeout_micros=0, batching_queue="")
+      batch_t, index_t = sess.run(
+          [batched, index], feed_dict={inp: [[1, 2, 3], [4, 5, 6]]})
+
+      self.assertAllEqual(batch_t[0], [[1, 2, 3], [4, 5, 6]])
+      self.assertEqual(len(index_t), 1)
+      self.assertAllEqual(index_t[0][1:], [0, 2])
+
   def testBatchWithPadding(self):
     """Test that batching with padding up to an allowed batch size works."""
     with self.test_session() as sess:
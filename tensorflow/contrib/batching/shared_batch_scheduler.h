@@ -17,6 +17,7 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_CONTRIB_BATCHING_SHARED_BATCH_SCHEDULER_H_
 
 #include <stddef.h>
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/contrib/batching/adaptive_batch_policy.h"
 #include "tensorflow/contrib/batching/batch_scheduler.h"
 #include "tensorflow/contrib/batching/util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -74,6 +76,20 @@ namespace serving {
 // BasicBatchScheduler instance, in the sense that it has maximum batch size and
 // timeout parameters, which govern when a batch is eligible to be processed.
 //
+// Queues can be given a priority and a weight. Batch threads always take a
+// batch from a queue of the highest priority among those with a schedulable
+// batch, so lower-priority queues only get the threads the higher-priority
+// ones leave idle. Among queues of equal priority, the one whose next batch
+// holds the task with the earliest deadline (see BatchTask::deadline_micros())
+// goes first, and the rest are served round-robin, each getting up to its
+// weight in consecutive batches: e.g. with queues A and B having weights 1 and
+// 2 respectively, the servicing pattern is ABBABB...
+//
+// Tasks with a deadline are rejected if it has passed when they are submitted.
+// A batch holding tasks with a deadline becomes schedulable as soon as its
+// estimated processing time (see AdaptiveBatchPolicy) would make it miss the
+// earliest one, even before reaching its size or timeout.
+//
 // Each queue is independently configured with a maximum size (in terms of the
 // maximum number of batches worth of enqueued tasks). For online serving, it is
 // recommended that the queue sizes be configured such that the sum of the sizes
@@ -90,11 +106,6 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
-// and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
-//
-//
 // PERFORMANCE TUNING: See README.md.
 //
 template <typename TaskType>
@@ -134,7 +145,8 @@ class SharedBatchScheduler
     // The scheduler may form batches of any size between 1 and this number
     // (inclusive). If there is a need to quantize the batch sizes, i.e. only
     // submit batches whose size is in a small set of allowed sizes, that can be
-    // done by adding padding in the process-batch callback.
+    // done by adding padding in the process-batch callback, and by setting
+    // 'allowed_batch_sizes' below to reduce the padding needed.
     int max_batch_size = 1000;
 
     // If a task has been enqueued for this amount of time (in microseconds),
@@ -157,6 +169,36 @@ class SharedBatchScheduler
     // See the class documentation above for guidelines on how to tune this
     // parameter.
     int max_enqueued_batches = 10;
+
+    // If positive, the queue adapts the batch size cutoff and the timeout to
+    // the processing times of its recent batches, forming the largest batches
+    // whose tasks are estimated to complete within this many microseconds of
+    // their batch starting to fill, 99% of the time. 'max_batch_size' and
+    // 'batch_timeout_micros' then bound the cutoff and the timeout. See
+    // AdaptiveBatchPolicy for the details.
+    //
+    // This suits traffic whose rate varies too much for a single choice of
+    // batch size and timeout to be both efficient and fast.
+    int64 target_latency_micros = 0;
+
+    // If non-empty, the batch sizes the process-batch callback pads batches up
+    // to. The entries must increase monotonically, and the final entry must
+    // equal 'max_batch_size'.
+    //
+    // When the timeout expires on a batch whose size isn't allowed, the queue
+    // schedules its longest prefix of tasks whose total size is allowed, and
+    // carries the remaining tasks over to the next batch instead of having
+    // them padded. Tasks are carried over at most once, so a carried-over
+    // task may wait for up to twice 'batch_timeout_micros'.
+    std::vector<int> allowed_batch_sizes;
+
+    // Batches are taken from the queues of higher priority first. See the
+    // class documentation above.
+    int priority = 0;
+
+    // The maximum number of consecutive batches the queue gets when its turn
+    // comes around among queues of equal priority. Must be positive.
+    int weight = 1;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -167,9 +209,10 @@ class SharedBatchScheduler
   explicit SharedBatchScheduler(const Options& options);
 
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
-  // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
-  // queue declines to provide a batch to process, moves onto the next queue. If
-  // no queues provide a batch to process, just sleeps briefly and exits.
+  // queue of highest priority with a schedulable batch, preferring the batch
+  // with the earliest deadline and then the queue closest to
+  // 'next_queue_to_schedule_', and processes it. If no queues provide a batch
+  // to process, just sleeps briefly and exits.
   void ThreadLogic();
 
   const Options options_;
@@ -190,6 +233,10 @@ class SharedBatchScheduler
   // available batch thread should grab work.
   typename QueueList::iterator next_queue_to_schedule_ GUARDED_BY(mu_);
 
+  // The number of consecutive batches taken from 'next_queue_to_schedule_',
+  // which moves on to the next queue when this reaches the queue's weight.
+  int num_batches_from_next_queue_ GUARDED_BY(mu_) = 0;
+
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
@@ -205,6 +252,17 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// Returns the earlier of two task deadlines, where 0 stands for no deadline.
+inline uint64 EarlierDeadline(uint64 a_micros, uint64 b_micros) {
+  if (a_micros == 0) {
+    return b_micros;
+  }
+  if (b_micros == 0) {
+    return a_micros;
+  }
+  return std::min(a_micros, b_micros);
+}
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -248,6 +306,11 @@ class Queue {
   // BatchScheduler::SchedulingCapacity().
   size_t SchedulingCapacity() const;
 
+  // Returns whether ScheduleBatch() would return a batch at this time. If so,
+  // sets '*deadline_micros' to the earliest deadline of a task in that batch,
+  // or 0 if none of its tasks has a deadline.
+  bool HasSchedulableBatch(uint64* deadline_micros) const;
+
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
@@ -269,6 +332,9 @@ class Queue {
     return closed_;
   }
 
+  int priority() const { return options_.priority; }
+  int weight() const { return options_.weight; }
+
  private:
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -277,10 +343,21 @@ class Queue {
   // fresh open batch behind it.
   void StartNewBatch() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Like StartNewBatch(), but if the size of the open batch isn't one of
+  // 'options_.allowed_batch_sizes', first moves the tasks following its
+  // longest prefix of allowed size to the new batch, unless they have already
+  // been carried over once.
+  void StartNewBatchAtAllowedSize() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Determines whether the open batch residing at the back of 'batches_' is
   // currently schedulable.
   bool IsOpenBatchSchedulable() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the options for the policy that adapts the batch size cutoff and
+  // timeout.
+  static AdaptiveBatchPolicy::Options PolicyOptions(
+      const typename SharedBatchScheduler<TaskType>::QueueOptions& options);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -308,6 +385,14 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ GUARDED_BY(mu_);
 
+  // Whether the open batch holds tasks carried over by
+  // StartNewBatchAtAllowedSize(), which mustn't be carried over again.
+  bool open_batch_has_carried_over_tasks_ GUARDED_BY(mu_) = false;
+
+  // The earliest deadline of the tasks in the open batch, or 0 if none of them
+  // has a deadline.
+  uint64 open_batch_deadline_micros_ GUARDED_BY(mu_) = 0;
+
   // Whether this queue contains a batch that is eligible to be scheduled. Used
   // to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ GUARDED_BY(mu_) = false;
@@ -316,6 +401,10 @@ class Queue {
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ GUARDED_BY(mu_) = 0;
 
+  // Picks the batch size cutoff and timeout, which are the configured maximum
+  // batch size and timeout unless 'options_.target_latency_micros' is set.
+  AdaptiveBatchPolicy policy_ GUARDED_BY(mu_);
+
   // Used by CloseAndWaitUntilEmpty() to wait until the queue is empty, for the
   // case in which the queue is not empty when CloseAndWaitUntilEmpty() starts.
   // When ProcessBatch() dequeues the last batch and makes the queue empty, if
@@ -402,6 +491,27 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
+  if (options.weight <= 0) {
+    return errors::InvalidArgument("weight must be positive; was ",
+                                   options.weight);
+  }
+  for (int i = 0; i < options.allowed_batch_sizes.size(); ++i) {
+    const int size = options.allowed_batch_sizes[i];
+    if (i > 0 && size <= options.allowed_batch_sizes[i - 1]) {
+      return errors::InvalidArgument(
+          "allowed_batch_sizes entries must be monotonically increasing");
+    }
+    if (i == options.allowed_batch_sizes.size() - 1 &&
+        size != options.max_batch_size) {
+      return errors::InvalidArgument(
+          "final entry in allowed_batch_sizes must equal max_batch_size");
+    }
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -449,36 +559,73 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   {
     mutex_lock l(mu_);
 
+    // Find the queue to take a batch from, trying the queues in round-robin
+    // order starting with '*next_queue_to_schedule_', so that the first one
+    // wins among equally preferred queues.
+    auto best_queue = queues_.end();
+    uint64 best_deadline_micros = 0;
+    auto queue_it = next_queue_to_schedule_;
     const int num_queues = queues_.size();
-    for (int num_queues_tried = 0;
-         batch_to_process == nullptr && num_queues_tried < num_queues;
+    for (int num_queues_tried = 0; num_queues_tried < num_queues;
          ++num_queues_tried) {
-      DCHECK(next_queue_to_schedule_ != queues_.end());
-
-      // If a closed queue responds to ScheduleBatch() with nullptr, the queue
-      // will never yield any further batches so we can drop it. To avoid a
-      // race, we take a snapshot of the queue's closedness state *before*
-      // calling ScheduleBatch().
-      const bool queue_closed = (*next_queue_to_schedule_)->closed();
-
-      // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
-      if (batch_to_process != nullptr) {
-        queue_for_batch = next_queue_to_schedule_->get();
+      DCHECK(queue_it != queues_.end());
+
+      // If a closed queue has no schedulable batch, the queue will never yield
+      // any further batches so we can drop it. To avoid a race, we take a
+      // snapshot of the queue's closedness state *before* asking it for a
+      // batch.
+      const bool queue_closed = (*queue_it)->closed();
+
+      uint64 deadline_micros;
+      const bool schedulable =
+          (*queue_it)->HasSchedulableBatch(&deadline_micros);
+      if (!schedulable && queue_closed && (*queue_it)->IsEmpty()) {
+        // We've encountered a closed queue with no work to do. Drop it.
+        const bool dropping_next_queue = queue_it == next_queue_to_schedule_;
+        queue_it = queues_.erase(queue_it);
+        if (queue_it == queues_.end()) {
+          queue_it = queues_.begin();
+        }
+        if (dropping_next_queue) {
+          next_queue_to_schedule_ = queue_it;
+          num_batches_from_next_queue_ = 0;
+        }
+        continue;
+      }
+      if (schedulable &&
+          (best_queue == queues_.end() ||
+           (*queue_it)->priority() > (*best_queue)->priority() ||
+           ((*queue_it)->priority() == (*best_queue)->priority() &&
+            internal::EarlierDeadline(deadline_micros, best_deadline_micros) !=
+                best_deadline_micros))) {
+        best_queue = queue_it;
+        best_deadline_micros = deadline_micros;
       }
+      if (++queue_it == queues_.end()) {
+        // We've hit the end. Wrap to the first queue.
+        queue_it = queues_.begin();
+      }
+    }
 
-      // Advance 'next_queue_to_schedule_'.
-      if (queue_closed && (*next_queue_to_schedule_)->IsEmpty() &&
-          batch_to_process == nullptr) {
-        // We've encountered a closed queue with no work to do. Drop it.
-        DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
-        next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
+    if (best_queue != queues_.end()) {
+      batch_to_process = (*best_queue)->ScheduleBatch();
+    }
+    if (batch_to_process != nullptr) {
+      queue_for_batch = best_queue->get();
+
+      // Give the queue up to its weight in consecutive batches, then move on to
+      // the next queue.
+      if (best_queue == next_queue_to_schedule_) {
+        ++num_batches_from_next_queue_;
       } else {
-        ++next_queue_to_schedule_;
+        next_queue_to_schedule_ = best_queue;
+        num_batches_from_next_queue_ = 1;
       }
-      if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
-        // We've hit the end. Wrap to the first queue.
-        next_queue_to_schedule_ = queues_.begin();
+      if (num_batches_from_next_queue_ >= queue_for_batch->weight()) {
+        if (++next_queue_to_schedule_ == queues_.end()) {
+          next_queue_to_schedule_ = queues_.begin();
+        }
+        num_batches_from_next_queue_ = 0;
       }
     }
 
@@ -504,7 +651,8 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      policy_(PolicyOptions(options)) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -525,6 +673,11 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
                                    " is larger than maximum batch size ",
                                    options_.max_batch_size);
   }
+  const uint64 deadline_micros = (*task)->deadline_micros();
+  if (deadline_micros != 0 && env_->NowMicros() >= deadline_micros) {
+    return errors::DeadlineExceeded(
+        "The deadline of the task passed before it was scheduled");
+  }
 
   bool notify_of_schedulable_batch = false;
   {
@@ -532,7 +685,10 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
+    // A task larger than the adapted cutoff still goes into a batch of its own.
+    if (!batches_.back()->empty() &&
+        batches_.back()->size() + (*task)->size() >
+            policy_.batch_size_cutoff()) {
       if (batches_.size() >= options_.max_enqueued_batches) {
         return errors::Unavailable(
             "The batch scheduling queue to which this task was submitted is "
@@ -544,6 +700,8 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       open_batch_start_time_micros_ = env_->NowMicros();
     }
     batches_.back()->AddTask(std::move(*task));
+    open_batch_deadline_micros_ =
+        EarlierDeadline(open_batch_deadline_micros_, deadline_micros);
 
     if (!schedulable_batch_) {
       if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
@@ -575,12 +733,32 @@ size_t Queue<TaskType>::SchedulingCapacity() const {
   mutex_lock l(mu_);
   const int num_new_batches_schedulable =
       options_.max_enqueued_batches - batches_.size();
+  const int batch_size_cutoff = policy_.batch_size_cutoff();
   const int open_batch_capacity =
-      options_.max_batch_size - batches_.back()->size();
-  return (num_new_batches_schedulable * options_.max_batch_size) +
+      std::max<int>(0, batch_size_cutoff - batches_.back()->size());
+  return (num_new_batches_schedulable * batch_size_cutoff) +
          open_batch_capacity;
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::HasSchedulableBatch(uint64* deadline_micros) const {
+  mutex_lock l(mu_);
+  if (batches_.size() >= 2) {
+    const Batch<TaskType>& batch = *batches_.front();
+    *deadline_micros = 0;
+    for (int i = 0; i < batch.num_tasks(); ++i) {
+      *deadline_micros =
+          EarlierDeadline(*deadline_micros, batch.task(i).deadline_micros());
+    }
+    return true;
+  }
+  if (IsOpenBatchSchedulable()) {
+    *deadline_micros = open_batch_deadline_micros_;
+    return true;
+  }
+  return false;
+}
+
 template <typename TaskType>
 std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
   // The batch to schedule, which we may populate below. (If left as nullptr,
@@ -592,7 +770,7 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 
     // Consider closing the open batch at this time, to schedule it.
     if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
+      StartNewBatchAtAllowedSize();
     }
 
     if (batches_.size() >= 2) {
@@ -610,10 +788,14 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
+  const int batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
+  const uint64 processing_micros = env_->NowMicros() - start_time_micros;
 
   {
     mutex_lock l(mu_);
+    policy_.RecordBatch(batch_size, processing_micros);
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -653,6 +835,51 @@ template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
   batches_.back()->Close();
   batches_.emplace_back(new Batch<TaskType>);
+  open_batch_has_carried_over_tasks_ = false;
+  open_batch_deadline_micros_ = 0;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::StartNewBatchAtAllowedSize() {
+  const std::vector<int>& allowed_batch_sizes = options_.allowed_batch_sizes;
+  Batch<TaskType>* open_batch = batches_.back().get();
+  const auto is_allowed = [&allowed_batch_sizes](int size) {
+    return std::binary_search(allowed_batch_sizes.begin(),
+                              allowed_batch_sizes.end(), size);
+  };
+  if (closed_ || open_batch_has_carried_over_tasks_ ||
+      allowed_batch_sizes.empty() || is_allowed(open_batch->size())) {
+    StartNewBatch();
+    return;
+  }
+
+  // Finds the number of tasks in the longest prefix of allowed size.
+  int prefix_num_tasks = 0;
+  int prefix_size = 0;
+  for (int i = 0; i < open_batch->num_tasks() - 1; ++i) {
+    prefix_size += open_batch->task(i).size();
+    if (is_allowed(prefix_size)) {
+      prefix_num_tasks = i + 1;
+    }
+  }
+  if (prefix_num_tasks == 0) {
+    StartNewBatch();
+    return;
+  }
+
+  std::vector<std::unique_ptr<TaskType>> carried_over_tasks;
+  while (open_batch->num_tasks() > prefix_num_tasks) {
+    carried_over_tasks.push_back(open_batch->RemoveTask());
+  }
+  StartNewBatch();
+  for (auto it = carried_over_tasks.rbegin(); it != carried_over_tasks.rend();
+       ++it) {
+    open_batch_deadline_micros_ =
+        EarlierDeadline(open_batch_deadline_micros_, (*it)->deadline_micros());
+    batches_.back()->AddTask(std::move(*it));
+  }
+  open_batch_start_time_micros_ = env_->NowMicros();
+  open_batch_has_carried_over_tasks_ = true;
 }
 
 template <typename TaskType>
@@ -661,9 +888,28 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  if (closed_ || open_batch->size() >= policy_.batch_size_cutoff()) {
+    return true;
+  }
+  const uint64 now_micros = env_->NowMicros();
+  if (now_micros >=
+      open_batch_start_time_micros_ + policy_.batch_timeout_micros()) {
+    return true;
+  }
+  // Expedite the batch if waiting any longer would make it miss a deadline.
+  return open_batch_deadline_micros_ != 0 &&
+         now_micros + policy_.EstimatedProcessingMicros(open_batch->size()) >=
+             open_batch_deadline_micros_;
+}
+
+template <typename TaskType>
+AdaptiveBatchPolicy::Options Queue<TaskType>::PolicyOptions(
+    const typename SharedBatchScheduler<TaskType>::QueueOptions& options) {
+  AdaptiveBatchPolicy::Options policy_options;
+  policy_options.max_batch_size = options.max_batch_size;
+  policy_options.max_batch_timeout_micros = options.batch_timeout_micros;
+  policy_options.target_latency_micros = options.target_latency_micros;
+  return policy_options;
 }
 
 template <typename TaskType>
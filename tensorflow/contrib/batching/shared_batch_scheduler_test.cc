@@ -28,22 +28,27 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, uint64 deadline_micros = 0)
+      : size_(size), deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  uint64 deadline_micros() const override { return deadline_micros_; }
+
  private:
   const size_t size_;
+  const uint64 deadline_micros_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    uint64 deadline_micros = 0) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, deadline_micros));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -255,6 +260,79 @@ TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, TimedOutBatchesAreCutAtAllowedSizes) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&first_batch_processed, &second_batch_processed](
+        std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      if (!first_batch_processed.HasBeenNotified()) {
+        // The first four tasks, of allowed total size 4.
+        EXPECT_EQ(4, batch->num_tasks());
+        EXPECT_EQ(4, batch->size());
+        first_batch_processed.Notify();
+      } else {
+        // The carried-over task, which isn't carried over again.
+        EXPECT_EQ(1, batch->num_tasks());
+        EXPECT_EQ(1, batch->size());
+        second_batch_processed.Notify();
+      }
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 8;
+    queue_options.batch_timeout_micros = 10;
+    queue_options.max_enqueued_batches = 2;
+    queue_options.allowed_batch_sizes = {2, 4, 8};
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    for (int i = 0; i < 5; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    env.AdvanceByMicroseconds(10);
+    first_batch_processed.WaitForNotification();
+    EXPECT_EQ(1, queue->NumEnqueuedTasks());
+
+    // The carried-over task starts a new timeout.
+    env.AdvanceByMicroseconds(9);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, RejectsInvalidAllowedBatchSizes) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  for (const std::vector<int>& allowed_batch_sizes :
+       std::vector<std::vector<int>>{{2, 8, 4}, {2, 4}}) {
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 8;
+    queue_options.allowed_batch_sizes = allowed_batch_sizes;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    EXPECT_EQ(error::INVALID_ARGUMENT,
+              scheduler->AddQueue(queue_options, callback, &queue).code());
+  }
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -337,6 +415,136 @@ TEST(SharedBatchSchedulerTest,
   stop_teardown.Notify();
 }
 
+// Runs a scheduler with one batch thread and the queues configured by
+// 'queue_options', and submits 'num_tasks[i]' tasks of size 1 to queue i while
+// the thread is busy with a first batch from queue 0. Returns the indices of
+// the queues of the batches processed after that first one, in order.
+std::vector<int> ScheduleWhileBusy(
+    const std::vector<SharedBatchScheduler<FakeTask>::QueueOptions>&
+        queue_options,
+    const std::vector<int>& num_tasks) {
+  Notification first_batch_started, first_batch_proceed;
+  mutex mu;
+  std::vector<int> order;
+  int num_batches = 0;
+  {
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_CHECK_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    std::vector<std::unique_ptr<BatchScheduler<FakeTask>>> queues;
+    for (int i = 0; i < queue_options.size(); ++i) {
+      auto callback = [i, &first_batch_started, &first_batch_proceed, &mu,
+                       &order, &num_batches](
+          std::unique_ptr<Batch<FakeTask>> batch) {
+        mutex_lock l(mu);
+        if (num_batches++ == 0) {
+          first_batch_started.Notify();
+          first_batch_proceed.WaitForNotification();
+        } else {
+          order.push_back(i);
+        }
+      };
+      std::unique_ptr<BatchScheduler<FakeTask>> queue;
+      TF_CHECK_OK(scheduler->AddQueue(queue_options[i], callback, &queue));
+      queues.push_back(std::move(queue));
+    }
+
+    TF_CHECK_OK(ScheduleTask(1, queues[0].get()));
+    first_batch_started.WaitForNotification();
+    for (int i = 0; i < num_tasks.size(); ++i) {
+      for (int j = 0; j < num_tasks[i]; ++j) {
+        TF_CHECK_OK(ScheduleTask(1, queues[i].get()));
+      }
+    }
+    first_batch_proceed.Notify();
+  }
+  return order;
+}
+
+SharedBatchScheduler<FakeTask>::QueueOptions OneTaskBatchQueueOptions(
+    int priority, int weight) {
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 1;
+  queue_options.batch_timeout_micros = 0;
+  queue_options.max_enqueued_batches = 10;
+  queue_options.priority = priority;
+  queue_options.weight = weight;
+  return queue_options;
+}
+
+TEST(SharedBatchSchedulerTest, HigherPriorityQueuesGoFirst) {
+  const std::vector<int> order = ScheduleWhileBusy(
+      {OneTaskBatchQueueOptions(0, 1), OneTaskBatchQueueOptions(1, 1)},
+      {2, 2});
+  EXPECT_EQ((std::vector<int>{1, 1, 0, 0}), order);
+}
+
+TEST(SharedBatchSchedulerTest, QueuesGetTheirWeightInBatches) {
+  const std::vector<int> order = ScheduleWhileBusy(
+      {OneTaskBatchQueueOptions(0, 1), OneTaskBatchQueueOptions(0, 2)},
+      {2, 4});
+  EXPECT_EQ((std::vector<int>{1, 1, 0, 1, 1, 0}), order);
+}
+
+TEST(SharedBatchSchedulerTest, RejectsInvalidWeight) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            scheduler
+                ->AddQueue(OneTaskBatchQueueOptions(0, 0), callback, &queue)
+                .code());
+}
+
+TEST(SharedBatchSchedulerTest, Deadlines) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification batch_processed;
+    auto callback =
+        [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+          EXPECT_EQ(2, batch->num_tasks());
+          batch_processed.Notify();
+        };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.batch_timeout_micros = 1000 * 1000;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // A task whose deadline has passed is rejected.
+    env.AdvanceByMicroseconds(100);
+    EXPECT_EQ(error::DEADLINE_EXCEEDED,
+              ScheduleTask(1, queue.get(), 100 /* deadline_micros */).code());
+
+    // A batch is expedited to meet the earliest deadline of its tasks, well
+    // before the timeout.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), 150 /* deadline_micros */));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), 120 /* deadline_micros */));
+    env.AdvanceByMicroseconds(19);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(SharedBatchSchedulerTest, Fairness) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
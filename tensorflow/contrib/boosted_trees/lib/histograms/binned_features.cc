@@ -0,0 +1,91 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+#include "tensorflow/contrib/boosted_trees/lib/histograms/binned_features.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "tensorflow/contrib/boosted_trees/lib/utils/macros.h"
+#include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace histograms {
+
+Status BinnedFeatures::Initialize(
+    const std::vector<gtl::ArraySlice<float>>& feature_columns,
+    const std::vector<std::vector<float>>& bucket_boundaries,
+    int64 desired_parallelism, thread::ThreadPool* thread_pool) {
+  // Validate the feature columns and their boundaries.
+  const int num_features = feature_columns.size();
+  TF_CHECK_AND_RETURN_IF_ERROR(
+      num_features > 0,
+      errors::InvalidArgument("Must have at least one feature column."));
+  TF_CHECK_AND_RETURN_IF_ERROR(
+      bucket_boundaries.size() == num_features,
+      errors::InvalidArgument("Must have bucket boundaries for each of the ",
+                              num_features, " feature columns, got ",
+                              bucket_boundaries.size()));
+  const int64 batch_size = feature_columns[0].size();
+  int max_num_buckets = 0;
+  for (int feature = 0; feature < num_features; ++feature) {
+    TF_CHECK_AND_RETURN_IF_ERROR(
+        feature_columns[feature].size() == batch_size,
+        errors::InvalidArgument("Feature columns must have the same size: ",
+                                batch_size, " vs. ",
+                                feature_columns[feature].size()));
+    const std::vector<float>& boundaries = bucket_boundaries[feature];
+    TF_CHECK_AND_RETURN_IF_ERROR(
+        boundaries.size() < kMaxNumBuckets,
+        errors::InvalidArgument("Feature ", feature, " has ",
+                                boundaries.size(),
+                                " bucket boundaries, at most ",
+                                kMaxNumBuckets - 1, " are supported."));
+    TF_CHECK_AND_RETURN_IF_ERROR(
+        std::adjacent_find(boundaries.begin(), boundaries.end(),
+                           std::greater_equal<float>()) == boundaries.end(),
+        errors::InvalidArgument("Bucket boundaries of feature ", feature,
+                                " must be sorted and unique."));
+    max_num_buckets =
+        std::max(max_num_buckets, static_cast<int>(boundaries.size()) + 1);
+  }
+  batch_size_ = batch_size;
+  max_num_buckets_ = max_num_buckets;
+  bucket_boundaries_ = bucket_boundaries;
+  buckets_.resize(num_features * batch_size);
+
+  // Bin the features in parallel, each feature is written by one thread.
+  auto do_work = [this, &feature_columns](int64 start, int64 end) {
+    for (int64 feature = start; feature < end; ++feature) {
+      const gtl::ArraySlice<float> values = feature_columns[feature];
+      const std::vector<float>& boundaries = bucket_boundaries_[feature];
+      uint8* buckets = buckets_.data() + feature * batch_size_;
+      for (int64 example = 0; example < batch_size_; ++example) {
+        buckets[example] =
+            std::lower_bound(boundaries.begin(), boundaries.end(),
+                             values[example]) -
+            boundaries.begin();
+      }
+    }
+  };
+  utils::ParallelFor(num_features, desired_parallelism, thread_pool, do_work);
+  return Status::OK();
+}
+
+}  // namespace histograms
+}  // namespace boosted_trees
+}  // namespace tensorflow
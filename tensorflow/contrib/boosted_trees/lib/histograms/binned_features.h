@@ -0,0 +1,97 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_HISTOGRAMS_BINNED_FEATURES_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_HISTOGRAMS_BINNED_FEATURES_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace histograms {
+
+// Dense float feature columns of a batch, with every value replaced by the
+// index of its bucket. The buckets of a feature are delimited by sorted
+// boundaries, typically the quantiles computed by
+// quantiles::WeightedQuantilesStream: a value v falls in the first bucket b
+// with v <= boundaries[b], or in the last bucket if it is larger than all the
+// boundaries, so a feature with n boundaries has n + 1 buckets. The split
+// "bucket <= b" is then exactly the split "feature <= boundaries[b]".
+//
+// Binning is done once per batch, after which the gradient histograms of all
+// the tree nodes read one byte per example and feature.
+class BinnedFeatures {
+ public:
+  // Bucket indices are stored in one byte.
+  static constexpr int kMaxNumBuckets = 256;
+
+  BinnedFeatures() {}
+
+  // Disallow copy and assign.
+  BinnedFeatures(const BinnedFeatures& other) = delete;
+  BinnedFeatures& operator=(const BinnedFeatures& other) = delete;
+
+  // Bins 'feature_columns', one slice of batch_size values per feature,
+  // with the sorted, unique 'bucket_boundaries' of the same feature. Each
+  // feature may have at most kMaxNumBuckets - 1 boundaries. Features are
+  // binned on up to 'desired_parallelism' threads of 'thread_pool'.
+  Status Initialize(const std::vector<gtl::ArraySlice<float>>& feature_columns,
+                    const std::vector<std::vector<float>>& bucket_boundaries,
+                    int64 desired_parallelism,
+                    thread::ThreadPool* thread_pool);
+
+  // Returns the number of examples in the batch.
+  int64 batch_size() const { return batch_size_; }
+
+  // Returns the number of feature columns.
+  int num_features() const { return bucket_boundaries_.size(); }
+
+  // Returns the number of buckets of the feature with the most buckets.
+  int max_num_buckets() const { return max_num_buckets_; }
+
+  // Returns the number of buckets of 'feature'.
+  int num_buckets(int feature) const {
+    return bucket_boundaries_[feature].size() + 1;
+  }
+
+  // Returns the threshold of the split "feature <= threshold" that sends the
+  // buckets up to 'bucket' left. 'bucket' must not be the last bucket.
+  float threshold(int feature, int bucket) const {
+    return bucket_boundaries_[feature][bucket];
+  }
+
+  // Returns the bucket indices of 'feature', one per example.
+  const uint8* buckets(int feature) const {
+    return buckets_.data() + feature * batch_size_;
+  }
+
+ private:
+  int64 batch_size_ = 0;
+  int max_num_buckets_ = 0;
+  std::vector<std::vector<float>> bucket_boundaries_;
+
+  // Bucket indices, feature-major so that a feature's buckets are contiguous.
+  std::vector<uint8> buckets_;
+};
+
+}  // namespace histograms
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_HISTOGRAMS_BINNED_FEATURES_H_
@@ -0,0 +1,124 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+#include "tensorflow/contrib/boosted_trees/lib/histograms/binned_features.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace histograms {
+namespace {
+
+using errors::InvalidArgument;
+
+class BinnedFeaturesTest : public ::testing::Test {};
+
+TEST_F(BinnedFeaturesTest, NoFeatures) {
+  BinnedFeatures features;
+  EXPECT_EQ(InvalidArgument("Must have at least one feature column."),
+            features.Initialize({}, {}, 0, nullptr));
+}
+
+TEST_F(BinnedFeaturesTest, MissingBoundaries) {
+  BinnedFeatures features;
+  const std::vector<float> values = {1.0f, 2.0f};
+  EXPECT_EQ(InvalidArgument("Must have bucket boundaries for each of the 1 "
+                            "feature columns, got 0"),
+            features.Initialize({values}, {}, 0, nullptr));
+}
+
+TEST_F(BinnedFeaturesTest, DifferentSizes) {
+  BinnedFeatures features;
+  const std::vector<float> values1 = {1.0f, 2.0f};
+  const std::vector<float> values2 = {1.0f};
+  EXPECT_EQ(InvalidArgument("Feature columns must have the same size: 2 vs. 1"),
+            features.Initialize({values1, values2}, {{1.0f}, {1.0f}}, 0,
+                                nullptr));
+}
+
+TEST_F(BinnedFeaturesTest, TooManyBoundaries) {
+  BinnedFeatures features;
+  const std::vector<float> values = {1.0f};
+  std::vector<float> boundaries(BinnedFeatures::kMaxNumBuckets);
+  for (int i = 0; i < boundaries.size(); ++i) {
+    boundaries[i] = i;
+  }
+  EXPECT_EQ(InvalidArgument("Feature 0 has 256 bucket boundaries, at most 255 "
+                            "are supported."),
+            features.Initialize({values}, {boundaries}, 0, nullptr));
+}
+
+TEST_F(BinnedFeaturesTest, UnsortedBoundaries) {
+  BinnedFeatures features;
+  const std::vector<float> values = {1.0f};
+  EXPECT_EQ(
+      InvalidArgument("Bucket boundaries of feature 0 must be sorted and "
+                      "unique."),
+      features.Initialize({values}, {{1.0f, 1.0f}}, 0, nullptr));
+}
+
+TEST_F(BinnedFeaturesTest, Buckets) {
+  BinnedFeatures features;
+  const std::vector<float> values1 = {-1.0f, 0.0f, 0.5f, 1.0f, 7.0f};
+  const std::vector<float> values2 = {3.0f, 2.0f, 1.0f, 0.0f, -1.0f};
+  TF_EXPECT_OK(features.Initialize({values1, values2},
+                                   {{0.0f, 1.0f}, {1.5f}}, 0, nullptr));
+  EXPECT_EQ(5, features.batch_size());
+  EXPECT_EQ(2, features.num_features());
+  EXPECT_EQ(3, features.max_num_buckets());
+  EXPECT_EQ(3, features.num_buckets(0));
+  EXPECT_EQ(2, features.num_buckets(1));
+  EXPECT_EQ(1.0f, features.threshold(0, 1));
+  EXPECT_EQ(1.5f, features.threshold(1, 0));
+  EXPECT_EQ(std::vector<uint8>({0, 0, 1, 1, 2}),
+            std::vector<uint8>(features.buckets(0), features.buckets(0) + 5));
+  EXPECT_EQ(std::vector<uint8>({1, 1, 0, 0, 0}),
+            std::vector<uint8>(features.buckets(1), features.buckets(1) + 5));
+}
+
+TEST_F(BinnedFeaturesTest, ParallelBuckets) {
+  thread::ThreadPool thread_pool(Env::Default(), "test_pool", 4);
+  const int kNumFeatures = 10;
+  const int kBatchSize = 100;
+  std::vector<std::vector<float>> columns(kNumFeatures);
+  std::vector<std::vector<float>> boundaries(kNumFeatures);
+  for (int feature = 0; feature < kNumFeatures; ++feature) {
+    for (int example = 0; example < kBatchSize; ++example) {
+      columns[feature].push_back((example + feature) % kBatchSize);
+    }
+    for (int boundary = 0; boundary < kBatchSize; boundary += 10) {
+      boundaries[feature].push_back(boundary);
+    }
+  }
+  BinnedFeatures features;
+  TF_EXPECT_OK(features.Initialize(
+      std::vector<gtl::ArraySlice<float>>(columns.begin(), columns.end()),
+      boundaries, 4, &thread_pool));
+  for (int feature = 0; feature < kNumFeatures; ++feature) {
+    for (int example = 0; example < kBatchSize; ++example) {
+      const int value = (example + feature) % kBatchSize;
+      // Values are integers, so value <= boundaries[b] with b = ceil(v / 10).
+      EXPECT_EQ((value + 9) / 10, features.buckets(feature)[example]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace histograms
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -0,0 +1,143 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+#include "tensorflow/contrib/boosted_trees/lib/histograms/gradient_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace histograms {
+
+GradientHistogram::GradientHistogram(const BinnedFeatures& features)
+    : num_features_(features.num_features()),
+      num_buckets_(features.max_num_buckets()),
+      stats_(num_features_ * num_buckets_) {}
+
+void GradientHistogram::Accumulate(const BinnedFeatures& features,
+                                   gtl::ArraySlice<float> gradients,
+                                   gtl::ArraySlice<float> hessians,
+                                   gtl::ArraySlice<int64> examples,
+                                   int64 desired_parallelism,
+                                   thread::ThreadPool* thread_pool) {
+  CHECK_EQ(num_features_, features.num_features());
+  CHECK_EQ(num_buckets_, features.max_num_buckets());
+  CHECK_EQ(gradients.size(), features.batch_size());
+  CHECK_EQ(hessians.size(), features.batch_size());
+  // Each thread owns the histograms of a block of features, so no
+  // synchronization is needed.
+  auto do_work = [this, &features, gradients, hessians, examples](
+      int64 start, int64 end) {
+    for (int64 feature = start; feature < end; ++feature) {
+      const uint8* buckets = features.buckets(feature);
+      GradientStats* stats = stats_.data() + feature * num_buckets_;
+      for (const int64 example : examples) {
+        GradientStats& bucket_stats = stats[buckets[example]];
+        bucket_stats.gradient += gradients[example];
+        bucket_stats.hessian += hessians[example];
+      }
+    }
+  };
+  utils::ParallelFor(num_features_, desired_parallelism, thread_pool, do_work);
+}
+
+void GradientHistogram::Subtract(const GradientHistogram& parent,
+                                 const GradientHistogram& sibling) {
+  CHECK_EQ(stats_.size(), parent.stats_.size());
+  CHECK_EQ(stats_.size(), sibling.stats_.size());
+  for (size_t i = 0; i < stats_.size(); ++i) {
+    stats_[i].gradient = parent.stats_[i].gradient - sibling.stats_[i].gradient;
+    stats_[i].hessian = parent.stats_[i].hessian - sibling.stats_[i].hessian;
+  }
+}
+
+GradientStats GradientHistogram::total() const {
+  // Every example is in exactly one bucket of each feature.
+  GradientStats total;
+  if (num_features_ > 0) {
+    for (int bucket = 0; bucket < num_buckets_; ++bucket) {
+      total += stats(0, bucket);
+    }
+  }
+  return total;
+}
+
+namespace {
+
+// Returns the loss reduction of a leaf holding 'stats' over an empty leaf,
+// with its weight set to the regularized Newton step.
+double LeafScore(const GradientStats& stats,
+                 const learner::TreeRegularizationConfig& regularization) {
+  const double denominator = stats.hessian + regularization.l2();
+  if (denominator <= 0) {
+    return 0;
+  }
+  // L1 shrinks the gradient towards zero.
+  const double gradient =
+      std::copysign(std::max(0.0, std::abs(stats.gradient) -
+                                      regularization.l1()),
+                    stats.gradient);
+  return gradient * gradient / denominator;
+}
+
+}  // namespace
+
+bool FindBestSplit(const GradientHistogram& histogram,
+                   const BinnedFeatures& features,
+                   const learner::TreeRegularizationConfig& regularization,
+                   const learner::TreeConstraintsConfig& constraints,
+                   HistogramSplit* best_split) {
+  const GradientStats total = histogram.total();
+  const double parent_score = LeafScore(total, regularization);
+  const double min_node_weight = constraints.min_node_weight();
+  bool found = false;
+  for (int feature = 0; feature < histogram.num_features(); ++feature) {
+    // Scan the boundaries in increasing order, moving one bucket at a time
+    // from the right child to the left child.
+    GradientStats left_stats;
+    const int num_boundaries = features.num_buckets(feature) - 1;
+    for (int bucket = 0; bucket < num_boundaries; ++bucket) {
+      left_stats += histogram.stats(feature, bucket);
+      GradientStats right_stats;
+      right_stats.gradient = total.gradient - left_stats.gradient;
+      right_stats.hessian = total.hessian - left_stats.hessian;
+      if (left_stats.hessian < min_node_weight ||
+          right_stats.hessian < min_node_weight) {
+        continue;
+      }
+      const double gain = LeafScore(left_stats, regularization) +
+                          LeafScore(right_stats, regularization) -
+                          parent_score - regularization.tree_complexity();
+      if (!found || gain > best_split->gain) {
+        found = true;
+        best_split->feature = feature;
+        best_split->bucket = bucket;
+        best_split->threshold = features.threshold(feature, bucket);
+        best_split->gain = gain;
+        best_split->left_stats = left_stats;
+        best_split->right_stats = right_stats;
+      }
+    }
+  }
+  return found;
+}
+
+}  // namespace histograms
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -0,0 +1,116 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_HISTOGRAMS_GRADIENT_HISTOGRAM_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_HISTOGRAMS_GRADIENT_HISTOGRAM_H_
+
+#include <vector>
+
+#include "tensorflow/contrib/boosted_trees/lib/histograms/binned_features.h"
+#include "tensorflow/contrib/boosted_trees/proto/learner.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace histograms {
+
+// Sums of the gradients and hessians of a set of examples. Sums are kept in
+// double precision, as a node may hold many millions of examples.
+struct GradientStats {
+  double gradient = 0;
+  double hessian = 0;
+
+  GradientStats& operator+=(const GradientStats& other) {
+    gradient += other.gradient;
+    hessian += other.hessian;
+    return *this;
+  }
+};
+
+// Per feature and bucket gradient stats of the examples of a tree node.
+//
+// The histogram of a node is accumulated from its examples in a single pass
+// over their bucket indices, in parallel over blocks of features. The
+// histogram of the second child of a split node needs no pass at all: it is
+// its parent's histogram minus its sibling's, so only the child with fewer
+// examples has to be accumulated.
+class GradientHistogram {
+ public:
+  // Creates an empty histogram for the features of 'features'.
+  explicit GradientHistogram(const BinnedFeatures& features);
+
+  // Adds the gradient and hessian of each example in 'examples' to the
+  // buckets of its features. 'gradients' and 'hessians' hold one value per
+  // example of the batch. Blocks of features are accumulated on up to
+  // 'desired_parallelism' threads of 'thread_pool'.
+  void Accumulate(const BinnedFeatures& features,
+                  gtl::ArraySlice<float> gradients,
+                  gtl::ArraySlice<float> hessians,
+                  gtl::ArraySlice<int64> examples, int64 desired_parallelism,
+                  thread::ThreadPool* thread_pool);
+
+  // Sets this histogram to 'parent' - 'sibling', the histogram of the
+  // examples of 'parent' that are not in 'sibling'.
+  void Subtract(const GradientHistogram& parent,
+                const GradientHistogram& sibling);
+
+  // Returns the stats of the examples in 'bucket' of 'feature'.
+  const GradientStats& stats(int feature, int bucket) const {
+    return stats_[feature * num_buckets_ + bucket];
+  }
+
+  // Returns the stats of all the examples of the histogram.
+  GradientStats total() const;
+
+  int num_features() const { return num_features_; }
+
+ private:
+  const int num_features_;
+
+  // Stride between the buckets of consecutive features.
+  const int num_buckets_;
+
+  std::vector<GradientStats> stats_;
+};
+
+// The best split "feature <= threshold" of a node.
+struct HistogramSplit {
+  int feature = -1;
+  // The last bucket sent left.
+  int bucket = -1;
+  float threshold = 0;
+  float gain = 0;
+  GradientStats left_stats;
+  GradientStats right_stats;
+};
+
+// Finds the split with the largest gain over all the features and bucket
+// boundaries of 'histogram', where 'features' are the binned features the
+// histogram was accumulated from. Gains follow the second order
+// approximation of the loss, regularized by 'regularization', and splits
+// leaving a child with less hessian than the constraints' min_node_weight are
+// skipped. Returns false if no split is valid.
+bool FindBestSplit(const GradientHistogram& histogram,
+                   const BinnedFeatures& features,
+                   const learner::TreeRegularizationConfig& regularization,
+                   const learner::TreeConstraintsConfig& constraints,
+                   HistogramSplit* best_split);
+
+}  // namespace histograms
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_HISTOGRAMS_GRADIENT_HISTOGRAM_H_
@@ -0,0 +1,168 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+
+#include "tensorflow/contrib/boosted_trees/lib/histograms/gradient_histogram.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace histograms {
+namespace {
+
+class GradientHistogramTest : public ::testing::Test {
+ protected:
+  // Feature 0 separates the gradients of examples {0, 1, 2} from those of
+  // examples {3, 4, 5}, feature 1 doesn't.
+  void SetUp() override {
+    feature0_ = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    feature1_ = {0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f};
+    TF_ASSERT_OK(features_.Initialize({feature0_, feature1_},
+                                      {{1.0f, 2.0f, 3.0f}, {0.5f}}, 0,
+                                      nullptr));
+    gradients_ = {-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    hessians_ = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+  }
+
+  std::vector<float> feature0_;
+  std::vector<float> feature1_;
+  BinnedFeatures features_;
+  std::vector<float> gradients_;
+  std::vector<float> hessians_;
+};
+
+TEST_F(GradientHistogramTest, Accumulate) {
+  GradientHistogram histogram(features_);
+  histogram.Accumulate(features_, gradients_, hessians_, {0, 2, 3, 4}, 0,
+                       nullptr);
+  // Feature 0 buckets: {0, 1}, {2}, {3}, {4, 5}.
+  EXPECT_EQ(-1.0, histogram.stats(0, 0).gradient);
+  EXPECT_EQ(1.0, histogram.stats(0, 0).hessian);
+  EXPECT_EQ(-1.0, histogram.stats(0, 1).gradient);
+  EXPECT_EQ(1.0, histogram.stats(0, 2).gradient);
+  EXPECT_EQ(1.0, histogram.stats(0, 3).gradient);
+  // Feature 1 buckets: {0, 2, 4}, {1, 3, 5}.
+  EXPECT_EQ(-1.0, histogram.stats(1, 0).gradient);
+  EXPECT_EQ(3.0, histogram.stats(1, 0).hessian);
+  EXPECT_EQ(1.0, histogram.stats(1, 1).gradient);
+  EXPECT_EQ(1.0, histogram.stats(1, 1).hessian);
+  EXPECT_EQ(0.0, histogram.total().gradient);
+  EXPECT_EQ(4.0, histogram.total().hessian);
+}
+
+TEST_F(GradientHistogramTest, ParallelAccumulate) {
+  thread::ThreadPool thread_pool(Env::Default(), "test_pool", 2);
+  GradientHistogram serial(features_);
+  serial.Accumulate(features_, gradients_, hessians_, {0, 1, 2, 3, 4, 5}, 0,
+                    nullptr);
+  GradientHistogram parallel(features_);
+  parallel.Accumulate(features_, gradients_, hessians_, {0, 1, 2, 3, 4, 5}, 2,
+                      &thread_pool);
+  for (int feature = 0; feature < 2; ++feature) {
+    for (int bucket = 0; bucket < features_.num_buckets(feature); ++bucket) {
+      EXPECT_EQ(serial.stats(feature, bucket).gradient,
+                parallel.stats(feature, bucket).gradient);
+      EXPECT_EQ(serial.stats(feature, bucket).hessian,
+                parallel.stats(feature, bucket).hessian);
+    }
+  }
+}
+
+TEST_F(GradientHistogramTest, SiblingBySubtraction) {
+  GradientHistogram parent(features_);
+  parent.Accumulate(features_, gradients_, hessians_, {0, 1, 2, 3, 4, 5}, 0,
+                    nullptr);
+  GradientHistogram left(features_);
+  left.Accumulate(features_, gradients_, hessians_, {0, 1, 4}, 0, nullptr);
+  GradientHistogram expected_right(features_);
+  expected_right.Accumulate(features_, gradients_, hessians_, {2, 3, 5}, 0,
+                            nullptr);
+  GradientHistogram right(features_);
+  right.Subtract(parent, left);
+  for (int feature = 0; feature < 2; ++feature) {
+    for (int bucket = 0; bucket < features_.num_buckets(feature); ++bucket) {
+      EXPECT_EQ(expected_right.stats(feature, bucket).gradient,
+                right.stats(feature, bucket).gradient);
+      EXPECT_EQ(expected_right.stats(feature, bucket).hessian,
+                right.stats(feature, bucket).hessian);
+    }
+  }
+}
+
+TEST_F(GradientHistogramTest, FindBestSplit) {
+  GradientHistogram histogram(features_);
+  histogram.Accumulate(features_, gradients_, hessians_, {0, 1, 2, 3, 4, 5}, 0,
+                       nullptr);
+  learner::TreeRegularizationConfig regularization;
+  regularization.set_l2(1.0f);
+  learner::TreeConstraintsConfig constraints;
+  HistogramSplit split;
+  ASSERT_TRUE(FindBestSplit(histogram, features_, regularization, constraints,
+                            &split));
+  // feature0 <= 2 separates the negative from the positive gradients.
+  EXPECT_EQ(0, split.feature);
+  EXPECT_EQ(1, split.bucket);
+  EXPECT_EQ(2.0f, split.threshold);
+  EXPECT_EQ(-3.0, split.left_stats.gradient);
+  EXPECT_EQ(3.0, split.left_stats.hessian);
+  EXPECT_EQ(3.0, split.right_stats.gradient);
+  EXPECT_EQ(3.0, split.right_stats.hessian);
+  // 9 / 4 + 9 / 4 - 0 / 7.
+  EXPECT_FLOAT_EQ(4.5f, split.gain);
+}
+
+TEST_F(GradientHistogramTest, FindBestSplitRegularized) {
+  GradientHistogram histogram(features_);
+  histogram.Accumulate(features_, gradients_, hessians_, {0, 1, 2, 3, 4, 5}, 0,
+                       nullptr);
+  learner::TreeRegularizationConfig regularization;
+  regularization.set_l1(1.0f);
+  regularization.set_l2(1.0f);
+  regularization.set_tree_complexity(0.5f);
+  learner::TreeConstraintsConfig constraints;
+  HistogramSplit split;
+  ASSERT_TRUE(FindBestSplit(histogram, features_, regularization, constraints,
+                            &split));
+  EXPECT_EQ(0, split.feature);
+  EXPECT_EQ(1, split.bucket);
+  // 2 * 2 / 4 + 2 * 2 / 4 - 0 / 7 - 0.5.
+  EXPECT_FLOAT_EQ(1.5f, split.gain);
+}
+
+TEST_F(GradientHistogramTest, FindBestSplitMinNodeWeight) {
+  GradientHistogram histogram(features_);
+  histogram.Accumulate(features_, gradients_, hessians_, {0, 1, 2, 3, 4, 5}, 0,
+                       nullptr);
+  learner::TreeRegularizationConfig regularization;
+  learner::TreeConstraintsConfig constraints;
+  HistogramSplit split;
+  // The feature 0 split at 2 and the feature 1 split leave 3 examples on
+  // each side, the former has the larger gain.
+  constraints.set_min_node_weight(3.0f);
+  ASSERT_TRUE(FindBestSplit(histogram, features_, regularization, constraints,
+                            &split));
+  EXPECT_EQ(0, split.feature);
+  EXPECT_EQ(1, split.bucket);
+  // No split leaves 4 examples on each side.
+  constraints.set_min_node_weight(4.0f);
+  EXPECT_FALSE(FindBestSplit(histogram, features_, regularization, constraints,
+                             &split));
+}
+
+}  // namespace
+}  // namespace histograms
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -94,6 +94,18 @@ void MultipleAdditiveTrees::Predict(
     tensorflow::thread::ThreadPool* worker_threads,
     tensorflow::TTypes<float>::Matrix output_predictions,
     tensorflow::TTypes<float>::Matrix no_dropout_predictions) {
+  Predict(config, only_finalized_trees, trees_to_drop, features, nullptr,
+          worker_threads, output_predictions, no_dropout_predictions);
+}
+
+void MultipleAdditiveTrees::Predict(
+    const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
+    const bool only_finalized_trees, const std::vector<int32>& trees_to_drop,
+    const boosted_trees::utils::BatchFeatures& features,
+    const boosted_trees::trees::FlatDecisionTreeEnsemble* flat_ensemble,
+    tensorflow::thread::ThreadPool* worker_threads,
+    tensorflow::TTypes<float>::Matrix output_predictions,
+    tensorflow::TTypes<float>::Matrix no_dropout_predictions) {
   // Zero out predictions as the model is additive.
   output_predictions.setZero();
   no_dropout_predictions.setZero();
@@ -109,6 +121,29 @@ void MultipleAdditiveTrees::Predict(
   CalculateTreesToKeep(config, trees_to_drop, config.trees_size(),
                        only_finalized_trees, &trees_to_keep);
 
+  if (flat_ensemble != nullptr) {
+    QCHECK_EQ(flat_ensemble->num_trees(), config.trees_size())
+        << "Flat ensemble doesn't match the tree ensemble.";
+    std::vector<const float*> dense_float_features;
+    for (const Tensor& column : features.dense_float_feature_columns()) {
+      dense_float_features.push_back(column.flat<float>().data());
+    }
+    auto update_flat_predictions = [flat_ensemble, &dense_float_features,
+                                    &trees_to_keep, &trees_to_drop,
+                                    &output_predictions,
+                                    &no_dropout_predictions](int64 start,
+                                                             int64 end) {
+      flat_ensemble->Predict(trees_to_keep, dense_float_features, start, end,
+                             &output_predictions, &no_dropout_predictions);
+      // Now do predictions for dropped trees
+      flat_ensemble->Predict(trees_to_drop, dense_float_features, start, end,
+                             &no_dropout_predictions, nullptr);
+    };
+    boosted_trees::utils::ParallelFor(batch_size, worker_threads->NumThreads(),
+                                      worker_threads, update_flat_predictions);
+    return;
+  }
+
   // Lambda for doing a block of work.
   auto update_predictions = [&config, &features, &trees_to_keep, &trees_to_drop,
                              &output_predictions,
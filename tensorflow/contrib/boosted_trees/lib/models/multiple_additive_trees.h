@@ -17,6 +17,7 @@
 
 #include <vector>
 
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_decision_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_types.h"
@@ -41,6 +42,19 @@ class MultipleAdditiveTrees {
       thread::ThreadPool* const thread_pool,
       TTypes<float>::Matrix output_predictions,
       TTypes<float>::Matrix no_dropout_predictions);
+
+  // Same as above, but when 'flat_ensemble' is not null, predicts with it
+  // instead of traversing the protos. 'flat_ensemble' must have been
+  // initialized from 'config'; building it once and reusing it across
+  // batches avoids the per-node proto accesses of the traversal.
+  static void Predict(
+      const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
+      const bool only_finalized_trees, const std::vector<int32>& trees_to_drop,
+      const boosted_trees::utils::BatchFeatures& features,
+      const boosted_trees::trees::FlatDecisionTreeEnsemble* flat_ensemble,
+      thread::ThreadPool* const thread_pool,
+      TTypes<float>::Matrix output_predictions,
+      TTypes<float>::Matrix no_dropout_predictions);
 };
 
 }  // namespace models
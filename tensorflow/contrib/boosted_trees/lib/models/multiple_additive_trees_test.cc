@@ -375,6 +375,41 @@ TEST_F(MultipleAdditiveTreesTest, DenseLeaves) {
   }
 }
 
+TEST_F(MultipleAdditiveTreesTest, FlatEnsembleMatchesProtos) {
+  const int32 kBatchSize = 200;
+  const int32 kNumDenseFeatures = 10;
+  random::PhiloxRandom philox(1);
+  random::SimplePhilox rng(&philox);
+  boosted_trees::utils::BatchFeatures batch_features(kBatchSize);
+  testutil::RandomlyInitializeBatchFeatures(&rng, kNumDenseFeatures, 0, 0.0,
+                                            0.0, &batch_features);
+  testutil::RandomTreeGen tree_gen(&rng, kNumDenseFeatures, 0);
+  const DecisionTreeEnsembleConfig tree_ensemble_config =
+      tree_gen.GenerateEnsemble(5, 30);
+  boosted_trees::trees::FlatDecisionTreeEnsemble flat_ensemble;
+  ASSERT_TRUE(flat_ensemble.Initialize(tree_ensemble_config));
+
+  Tensor output_tensor(DT_FLOAT, TensorShape({kBatchSize, 1}));
+  Tensor no_dropout_output_tensor(DT_FLOAT, TensorShape({kBatchSize, 1}));
+  Tensor flat_output_tensor(DT_FLOAT, TensorShape({kBatchSize, 1}));
+  Tensor flat_no_dropout_output_tensor(DT_FLOAT, TensorShape({kBatchSize, 1}));
+  tensorflow::thread::ThreadPool threads(tensorflow::Env::Default(), "test",
+                                         kNumThreadsMultiThreaded);
+  const std::vector<int32> trees_to_drop = {1, 7, 20};
+  MultipleAdditiveTrees::Predict(tree_ensemble_config, false, trees_to_drop,
+                                 batch_features, &threads,
+                                 output_tensor.matrix<float>(),
+                                 no_dropout_output_tensor.matrix<float>());
+  MultipleAdditiveTrees::Predict(tree_ensemble_config, false, trees_to_drop,
+                                 batch_features, &flat_ensemble, &threads,
+                                 flat_output_tensor.matrix<float>(),
+                                 flat_no_dropout_output_tensor.matrix<float>());
+  test::ExpectTensorEqual<float>(output_tensor, flat_output_tensor);
+  test::ExpectTensorEqual<float>(no_dropout_output_tensor,
+                                 flat_no_dropout_output_tensor);
+
+}
+
 }  // namespace
 }  // namespace models
 }  // namespace boosted_trees
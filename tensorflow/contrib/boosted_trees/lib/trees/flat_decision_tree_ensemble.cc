@@ -0,0 +1,178 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_decision_tree_ensemble.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+namespace {
+// Number of examples that go through a tree together.
+constexpr int64 kBlockSize = 64;
+}  // namespace
+
+bool FlatDecisionTreeEnsemble::Initialize(
+    const DecisionTreeEnsembleConfig& config) {
+  Clear();
+  if (config.tree_weights_size() < config.trees_size()) {
+    return false;
+  }
+  for (int tree_idx = 0; tree_idx < config.trees_size(); ++tree_idx) {
+    if (!AddTree(config.trees(tree_idx), config.tree_weights(tree_idx))) {
+      Clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+void FlatDecisionTreeEnsemble::Clear() {
+  nodes_.clear();
+  trees_.clear();
+  leaf_value_offsets_.assign(1, 0);
+  leaf_classes_.clear();
+  leaf_values_.clear();
+}
+
+bool FlatDecisionTreeEnsemble::AddTree(const DecisionTreeConfig& tree,
+                                       float weight) {
+  const int32 num_nodes = tree.nodes_size();
+  if (num_nodes == 0) {
+    return false;
+  }
+  const int32 offset = nodes_.size();
+  for (int32 node_id = 0; node_id < num_nodes; ++node_id) {
+    const TreeNode& tree_node = tree.nodes(node_id);
+    Node node;
+    switch (tree_node.node_case()) {
+      case TreeNode::kLeaf: {
+        node.feature_column = 0;
+        node.threshold = 0;
+        node.children[0] = node.children[1] = offset + node_id;
+        const Leaf& leaf = tree_node.leaf();
+        if (leaf.has_sparse_vector()) {
+          const auto& sparse_vector = leaf.sparse_vector();
+          if (sparse_vector.index_size() != sparse_vector.value_size()) {
+            return false;
+          }
+          for (int i = 0; i < sparse_vector.index_size(); ++i) {
+            leaf_classes_.push_back(sparse_vector.index(i));
+            leaf_values_.push_back(sparse_vector.value(i));
+          }
+        } else if (leaf.has_vector()) {
+          const auto& vector = leaf.vector();
+          for (int i = 0; i < vector.value_size(); ++i) {
+            leaf_classes_.push_back(i);
+            leaf_values_.push_back(vector.value(i));
+          }
+        } else {
+          return false;
+        }
+        break;
+      }
+      case TreeNode::kDenseFloatBinarySplit: {
+        const auto& split = tree_node.dense_float_binary_split();
+        // A split can't be its own child, that is how leaves are told apart.
+        if (split.feature_column() < 0 || split.left_id() < 0 ||
+            split.left_id() >= num_nodes || split.left_id() == node_id ||
+            split.right_id() < 0 || split.right_id() >= num_nodes ||
+            split.right_id() == node_id) {
+          return false;
+        }
+        node.feature_column = split.feature_column();
+        node.threshold = split.threshold();
+        node.children[0] = offset + split.left_id();
+        node.children[1] = offset + split.right_id();
+        break;
+      }
+      default:
+        return false;
+    }
+    nodes_.push_back(node);
+    leaf_value_offsets_.push_back(leaf_classes_.size());
+  }
+
+  // Find the depth of the deepest leaf reachable from the root. A tree has at
+  // most num_nodes nodes to visit, more means the splits form a cycle.
+  int32 depth = 0;
+  int32 num_visited = 0;
+  std::vector<std::pair<int32, int32>> to_visit = {{offset, 0}};
+  while (!to_visit.empty()) {
+    if (++num_visited > num_nodes) {
+      return false;
+    }
+    const int32 node_id = to_visit.back().first;
+    const int32 node_depth = to_visit.back().second;
+    to_visit.pop_back();
+    const Node& node = nodes_[node_id];
+    if (node.children[0] == node_id) {
+      depth = std::max(depth, node_depth);
+    } else {
+      to_visit.emplace_back(node.children[0], node_depth + 1);
+      to_visit.emplace_back(node.children[1], node_depth + 1);
+    }
+  }
+  trees_.push_back({offset, depth, weight});
+  return true;
+}
+
+void FlatDecisionTreeEnsemble::Predict(
+    const std::vector<int32>& trees,
+    gtl::ArraySlice<const float*> dense_float_features, int64 example_start,
+    int64 example_end, TTypes<float>::Matrix* output_predictions,
+    TTypes<float>::Matrix* additional_output_predictions) const {
+  int32 node_ids[kBlockSize];
+  for (int64 block_start = example_start; block_start < example_end;
+       block_start += kBlockSize) {
+    const int64 block_size = std::min(kBlockSize, example_end - block_start);
+    for (const int32 tree_idx : trees) {
+      DCHECK_LT(tree_idx, trees_.size());
+      const Tree& tree = trees_[tree_idx];
+      std::fill(node_ids, node_ids + block_size, tree.root);
+      // Move every example of the block one level down at a time; examples
+      // that already reached a leaf stay there.
+      for (int32 level = 0; level < tree.depth; ++level) {
+        for (int64 i = 0; i < block_size; ++i) {
+          const Node& node = nodes_[node_ids[i]];
+          DCHECK_LT(node.feature_column, dense_float_features.size());
+          const float value =
+              dense_float_features[node.feature_column][block_start + i];
+          node_ids[i] = node.children[!(value <= node.threshold)];
+        }
+      }
+      for (int64 i = 0; i < block_size; ++i) {
+        const int64 example_idx = block_start + i;
+        for (int32 j = leaf_value_offsets_[node_ids[i]];
+             j < leaf_value_offsets_[node_ids[i] + 1]; ++j) {
+          const float value = tree.weight * leaf_values_[j];
+          (*output_predictions)(example_idx, leaf_classes_[j]) += value;
+          if (additional_output_predictions != nullptr) {
+            (*additional_output_predictions)(example_idx, leaf_classes_[j]) +=
+                value;
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
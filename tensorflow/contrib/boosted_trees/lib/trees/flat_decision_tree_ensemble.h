@@ -0,0 +1,103 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_DECISION_TREE_ENSEMBLE_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_DECISION_TREE_ENSEMBLE_H_
+
+#include <vector>
+
+#include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+// A tree ensemble compiled into contiguous arrays for fast batch prediction.
+//
+// Only ensembles made of dense float splits and leaves can be flattened,
+// which covers models trained on dense features. The nodes of all trees are
+// stored in one array, and leaves point to themselves so every example can
+// take exactly depth-of-tree branch-free steps. Examples are predicted in
+// blocks: all the examples of a block go through a tree before the next tree
+// is started, so the nodes of a tree are reused from cache across the block.
+//
+// Predictions are bit-identical to traversing the protos with
+// DecisionTree::Traverse, since the trees are added in the same order.
+class FlatDecisionTreeEnsemble {
+ public:
+  FlatDecisionTreeEnsemble() : leaf_value_offsets_(1, 0) {}
+
+  // Flattens all the trees of 'config'. Returns false, leaving the ensemble
+  // empty, if a tree is empty or malformed, has no weight, or has a node that
+  // is neither a leaf nor a dense float split.
+  bool Initialize(const DecisionTreeEnsembleConfig& config);
+
+  // Returns the number of trees, which is 0 until Initialize succeeds.
+  int num_trees() const { return trees_.size(); }
+
+  // Adds the weighted leaf values of 'trees' to the rows of
+  // 'output_predictions', and of 'additional_output_predictions' if not null,
+  // for the examples in [example_start, example_end). 'dense_float_features'
+  // points to the values of each dense float feature column, one value per
+  // example of the batch.
+  void Predict(const std::vector<int32>& trees,
+               gtl::ArraySlice<const float*> dense_float_features,
+               int64 example_start, int64 example_end,
+               TTypes<float>::Matrix* output_predictions,
+               TTypes<float>::Matrix* additional_output_predictions) const;
+
+ private:
+  struct Node {
+    // Examples whose feature value is <= threshold go to children[0], others
+    // (including NaNs) go to children[1]. Leaves are their own children.
+    int32 feature_column;
+    float threshold;
+    int32 children[2];
+  };
+
+  struct Tree {
+    int32 root;
+    // The number of steps that takes every example to a leaf.
+    int32 depth;
+    float weight;
+  };
+
+  // Removes all the trees.
+  void Clear();
+
+  // Flattens 'tree' at the end of the node arrays, returns false if it can't.
+  bool AddTree(const DecisionTreeConfig& tree, float weight);
+
+  std::vector<Node> nodes_;
+  std::vector<Tree> trees_;
+
+  // The leaf values of node i are at [leaf_value_offsets_[i],
+  // leaf_value_offsets_[i + 1]) in leaf_classes_ and leaf_values_; split
+  // nodes have none.
+  std::vector<int32> leaf_value_offsets_;
+  std::vector<int32> leaf_classes_;
+  std::vector<float> leaf_values_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FlatDecisionTreeEnsemble);
+};
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_DECISION_TREE_ENSEMBLE_H_
@@ -0,0 +1,165 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_decision_tree_ensemble.h"
+
+#include "tensorflow/contrib/boosted_trees/lib/testutil/random_tree_gen.h"
+#include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+namespace {
+
+class FlatDecisionTreeEnsembleTest : public ::testing::Test {
+ protected:
+  // Predicts the examples with 'ensemble' and returns the predictions,
+  // num_examples x num_classes in row-major order.
+  std::vector<float> Predict(const FlatDecisionTreeEnsemble& ensemble,
+                             const std::vector<int32>& trees,
+                             const std::vector<std::vector<float>>& columns,
+                             int64 num_examples, int num_classes) {
+    std::vector<const float*> dense_float_features;
+    for (const auto& column : columns) {
+      dense_float_features.push_back(column.data());
+    }
+    std::vector<float> predictions(num_examples * num_classes);
+    TTypes<float>::Matrix predictions_matrix(predictions.data(), num_examples,
+                                             num_classes);
+    ensemble.Predict(trees, dense_float_features, 0, num_examples,
+                     &predictions_matrix, nullptr);
+    return predictions;
+  }
+};
+
+TEST_F(FlatDecisionTreeEnsembleTest, Stump) {
+  DecisionTreeEnsembleConfig config;
+  auto* tree1 = config.add_trees();
+  auto* bias_leaf = tree1->add_nodes()->mutable_leaf()->mutable_vector();
+  bias_leaf->add_value(-0.4f);
+  bias_leaf->add_value(-0.7f);
+  auto* tree2 = config.add_trees();
+  auto* dense_split = tree2->add_nodes()->mutable_dense_float_binary_split();
+  dense_split->set_feature_column(1);
+  dense_split->set_threshold(5.0f);
+  dense_split->set_left_id(1);
+  dense_split->set_right_id(2);
+  auto* leaf1 = tree2->add_nodes()->mutable_leaf()->mutable_sparse_vector();
+  leaf1->add_index(0);
+  leaf1->add_value(0.9f);
+  auto* leaf2 = tree2->add_nodes()->mutable_leaf()->mutable_sparse_vector();
+  leaf2->add_index(1);
+  leaf2->add_value(0.2f);
+  config.add_tree_weights(1.0);
+  config.add_tree_weights(2.0);
+
+  FlatDecisionTreeEnsemble ensemble;
+  ASSERT_TRUE(ensemble.Initialize(config));
+  EXPECT_EQ(2, ensemble.num_trees());
+  const std::vector<std::vector<float>> columns = {{0.0f, 0.0f, 0.0f},
+                                                   {7.0f, -2.0f, 5.0f}};
+  EXPECT_EQ(std::vector<float>({-0.4f, -0.7f + 2 * 0.2f,
+                                -0.4f + 2 * 0.9f, -0.7f,
+                                -0.4f + 2 * 0.9f, -0.7f}),
+            Predict(ensemble, {0, 1}, columns, 3, 2));
+  EXPECT_EQ(std::vector<float>({0.0f, 2 * 0.2f, 2 * 0.9f, 0.0f, 2 * 0.9f,
+                                0.0f}),
+            Predict(ensemble, {1}, columns, 3, 2));
+}
+
+TEST_F(FlatDecisionTreeEnsembleTest, Unsupported) {
+  FlatDecisionTreeEnsemble ensemble;
+  // Empty tree.
+  DecisionTreeEnsembleConfig config;
+  config.add_trees();
+  config.add_tree_weights(1.0);
+  EXPECT_FALSE(ensemble.Initialize(config));
+  // Missing tree weight.
+  config.mutable_trees(0)->add_nodes()->mutable_leaf()->mutable_vector();
+  config.clear_tree_weights();
+  EXPECT_FALSE(ensemble.Initialize(config));
+  config.add_tree_weights(1.0);
+  EXPECT_TRUE(ensemble.Initialize(config));
+  // Categorical split.
+  auto* tree = config.add_trees();
+  auto* split = tree->add_nodes()->mutable_categorical_id_binary_split();
+  split->set_left_id(1);
+  split->set_right_id(2);
+  tree->add_nodes()->mutable_leaf()->mutable_vector();
+  tree->add_nodes()->mutable_leaf()->mutable_vector();
+  config.add_tree_weights(1.0);
+  EXPECT_FALSE(ensemble.Initialize(config));
+  EXPECT_EQ(0, ensemble.num_trees());
+  // Cycle.
+  auto* dense_split =
+      tree->mutable_nodes(0)->mutable_dense_float_binary_split();
+  dense_split->set_left_id(0);
+  dense_split->set_right_id(1);
+  EXPECT_FALSE(ensemble.Initialize(config));
+  dense_split->set_left_id(2);
+  auto* child_split =
+      tree->mutable_nodes(2)->mutable_dense_float_binary_split();
+  child_split->set_left_id(1);
+  child_split->set_right_id(0);
+  EXPECT_FALSE(ensemble.Initialize(config));
+  tree->mutable_nodes(2)->mutable_leaf()->mutable_vector();
+  EXPECT_TRUE(ensemble.Initialize(config));
+  EXPECT_EQ(2, ensemble.num_trees());
+}
+
+TEST_F(FlatDecisionTreeEnsembleTest, MatchesTraverse) {
+  const int kNumDenseFeatures = 10;
+  const int kNumExamples = 100;
+  random::PhiloxRandom philox(13);
+  random::SimplePhilox rng(&philox);
+  testutil::RandomTreeGen tree_gen(&rng, kNumDenseFeatures, 0);
+  const DecisionTreeEnsembleConfig config = tree_gen.GenerateEnsemble(6, 20);
+  std::vector<std::vector<float>> columns(kNumDenseFeatures);
+  std::vector<utils::Example> examples(kNumExamples);
+  for (int i = 0; i < kNumExamples; ++i) {
+    for (int feature = 0; feature < kNumDenseFeatures; ++feature) {
+      const float value = rng.RandFloat();
+      columns[feature].push_back(value);
+      examples[i].dense_float_features.push_back(value);
+    }
+  }
+
+  // Traverse the protos, adding the trees in the same order.
+  std::vector<float> expected(kNumExamples);
+  for (int i = 0; i < kNumExamples; ++i) {
+    for (int tree_idx = 0; tree_idx < config.trees_size(); ++tree_idx) {
+      const DecisionTreeConfig& tree = config.trees(tree_idx);
+      const int leaf_idx = DecisionTree::Traverse(tree, 0, examples[i]);
+      ASSERT_GE(leaf_idx, 0);
+      const auto& leaf = tree.nodes(leaf_idx).leaf().sparse_vector();
+      expected[i] += config.tree_weights(tree_idx) * leaf.value(0);
+    }
+  }
+
+  FlatDecisionTreeEnsemble ensemble;
+  ASSERT_TRUE(ensemble.Initialize(config));
+  std::vector<int32> trees(config.trees_size());
+  for (int tree_idx = 0; tree_idx < trees.size(); ++tree_idx) {
+    trees[tree_idx] = tree_idx;
+  }
+  EXPECT_EQ(expected, Predict(ensemble, trees, columns, kNumExamples, 1));
+}
+
+}  // namespace
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
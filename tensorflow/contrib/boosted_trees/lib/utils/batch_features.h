@@ -58,6 +58,11 @@ class BatchFeatures {
   // Returns the fixed batch size.
   int64 batch_size() const { return batch_size_; }
 
+  // Returns the dense float feature columns, batch_size x 1 matrices.
+  const std::vector<Tensor>& dense_float_feature_columns() const {
+    return dense_float_feature_columns_;
+  }
+
  private:
   // Total number of examples in the batch.
   const int64 batch_size_;
@@ -246,6 +246,8 @@ add_python_module("tensorflow/tensorboard/plugins/scalars")
 add_python_module("tensorflow/tensorboard/plugins/text")
 add_python_module("tensorflow/tensorboard/scripts")
 add_python_module("tensorflow/contrib")
+add_python_module("tensorflow/contrib/all_reduce")
+add_python_module("tensorflow/contrib/all_reduce/python")
 add_python_module("tensorflow/contrib/android")
 add_python_module("tensorflow/contrib/android/java")
 add_python_module("tensorflow/contrib/android/java/org")
@@ -487,6 +489,11 @@ add_python_module("tensorflow/contrib/slim/python/slim/nets")
 add_python_module("tensorflow/contrib/solvers")
 add_python_module("tensorflow/contrib/solvers/python")
 add_python_module("tensorflow/contrib/solvers/python/ops")
+add_python_module("tensorflow/contrib/sparse_matrix")
+add_python_module("tensorflow/contrib/sparse_matrix/ops")
+add_python_module("tensorflow/contrib/sparse_matrix/python")
+add_python_module("tensorflow/contrib/sparse_matrix/python/kernel_tests")
+add_python_module("tensorflow/contrib/sparse_matrix/python/ops")
 add_python_module("tensorflow/contrib/sparsemax")
 add_python_module("tensorflow/contrib/sparsemax/python")
 add_python_module("tensorflow/contrib/sparsemax/python/ops")
@@ -657,6 +664,8 @@ GENERATE_PYTHON_OP_LIB("contrib_rnn_lstm_ops"
   DESTINATION ${CMAKE_CURRENT_BINARY_DIR}/tf_python/tensorflow/contrib/rnn/ops/gen_lstm_ops.py)
 GENERATE_PYTHON_OP_LIB("contrib_seq2seq_beam_search_ops"
   DESTINATION ${CMAKE_CURRENT_BINARY_DIR}/tf_python/tensorflow/contrib/seq2seq/ops/gen_beam_search_ops.py)
+GENERATE_PYTHON_OP_LIB("contrib_sparse_matrix_csr_sparse_matrix_ops"
+  DESTINATION ${CMAKE_CURRENT_BINARY_DIR}/tf_python/tensorflow/contrib/sparse_matrix/ops/gen_csr_sparse_matrix_ops.py)
 GENERATE_PYTHON_OP_LIB("contrib_tensor_forest_ops"
   DESTINATION ${CMAKE_CURRENT_BINARY_DIR}/tf_python/tensorflow/contrib/tensor_forest/python/ops/gen_tensor_forest_ops.py)
 GENERATE_PYTHON_OP_LIB("contrib_tensor_forest_hybrid_ops"
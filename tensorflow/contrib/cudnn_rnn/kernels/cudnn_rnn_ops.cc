@@ -19,8 +19,10 @@ limitations under the License.
 #include <cmath>
 #include <functional>
 #include <limits>
+#include <map>
 #include <string>
 #include <unordered_set>
+#include <utility>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/device_base.h"
@@ -99,6 +101,7 @@ enum class TFRNNInputMode {
 };
 
 namespace {
+using perftools::gputools::dnn::RnnAlgorithm;
 using perftools::gputools::dnn::RnnMode;
 using perftools::gputools::dnn::RnnInputMode;
 using perftools::gputools::dnn::RnnDirectionMode;
@@ -151,6 +154,31 @@ Status ParseRNNDirectionMode(const string& str,
   return errors::InvalidArgument("Invalid RNN direction mode: ", str);
 }
 
+// Parses the "rnn_algorithm" attribute. 'auto' picks the fastest algorithm
+// for each input shape, and is only honored at inference: the reserve space
+// of a training step must come from the algorithm the backward pass uses, so
+// training falls back to the standard algorithm.
+Status ParseRNNAlgorithm(const string& str, RnnAlgorithm* rnn_algorithm,
+                         bool* autotune) {
+  *rnn_algorithm = RnnAlgorithm::kRnnStandard;
+  *autotune = false;
+  if (str == "standard") {
+    return Status::OK();
+  } else if (str == "persist_static") {
+    *rnn_algorithm = RnnAlgorithm::kRnnPersistStatic;
+    return Status::OK();
+  } else if (str == "persist_dynamic") {
+    *rnn_algorithm = RnnAlgorithm::kRnnPersistDynamic;
+    return Status::OK();
+  } else if (str == "auto") {
+    *autotune = true;
+    return Status::OK();
+  }
+  return errors::InvalidArgument("Invalid RNN algorithm: ", str);
+}
+
+constexpr int kNumRnnAlgorithms = 3;
+
 Status ToRNNInputMode(TFRNNInputMode tf_input_mode, int num_units,
                       int input_size, RnnInputMode* input_mode) {
   switch (tf_input_mode) {
@@ -368,6 +396,51 @@ struct CudnnModelShapes {
   }
 };
 
+// The sequence and state descriptors of the last shapes a kernel ran with.
+// Besides the layout of the model, they only depend on the sequence length
+// and the batch size, which rarely change between calls.
+struct CudnnRnnTensorDescriptors {
+  int seq_length = -1;
+  int batch_size = -1;
+  std::unique_ptr<perftools::gputools::dnn::RnnSequenceTensorDescriptor>
+      input_desc;
+  std::unique_ptr<perftools::gputools::dnn::RnnStateTensorDescriptor>
+      hidden_state_desc;
+  std::unique_ptr<perftools::gputools::dnn::RnnSequenceTensorDescriptor>
+      output_desc;
+
+  // Recreates the descriptors when the shapes differ from the last call.
+  Status Update(perftools::gputools::StreamExecutor* executor,
+                const CudnnModelShapes& model_shapes,
+                perftools::gputools::dnn::DataType data_type) {
+    if (input_desc != nullptr && seq_length == model_shapes.seq_length &&
+        batch_size == model_shapes.batch_size) {
+      return Status::OK();
+    }
+    const auto& input_shape = model_shapes.input_shape;
+    const auto& hidden_state_shape = model_shapes.hidden_state_shape;
+    const auto& output_shape = model_shapes.output_shape;
+    auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
+        input_shape.dim_size(0), input_shape.dim_size(1),
+        input_shape.dim_size(2), data_type);
+    TF_RETURN_IF_ERROR(FromExecutorStatus(input_desc_s));
+    auto hidden_state_desc_s = executor->createRnnStateTensorDescriptor(
+        hidden_state_shape.dim_size(0), hidden_state_shape.dim_size(1),
+        hidden_state_shape.dim_size(2), data_type);
+    TF_RETURN_IF_ERROR(FromExecutorStatus(hidden_state_desc_s));
+    auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
+        output_shape.dim_size(0), output_shape.dim_size(1),
+        output_shape.dim_size(2), data_type);
+    TF_RETURN_IF_ERROR(FromExecutorStatus(output_desc_s));
+    input_desc = input_desc_s.ConsumeValueOrDie();
+    hidden_state_desc = hidden_state_desc_s.ConsumeValueOrDie();
+    output_desc = output_desc_s.ConsumeValueOrDie();
+    seq_length = model_shapes.seq_length;
+    batch_size = model_shapes.batch_size;
+    return Status::OK();
+  }
+};
+
 // Extract and checks the forward input tensors, parameters, and shapes from the
 // OpKernelContext.
 Status ExtractForwardInput(OpKernelContext* context,
@@ -422,6 +495,7 @@ Status ExtractForwardInput(OpKernelContext* context,
   return Status::OK();
 }
 
+using perftools::gputools::dnn::ProfileResult;
 using perftools::gputools::dnn::RnnDescriptor;
 
 template <typename T>
@@ -523,7 +597,8 @@ class CudnnRNNKernelCommon : public OpKernel {
     // random number generator, therefore set state_allocator to nullptr.
     auto rnn_desc_s = stream->parent()->createRnnDescriptor(
         num_layers, num_units, input_size, input_mode, rnn_direction_mode(),
-        rnn_mode(), ToDataType<T>::value, dropout(), seed(),
+        rnn_mode(), ToDataType<T>::value, RnnAlgorithm::kRnnStandard,
+        false /* use_tensor_op_math */, dropout(), seed(),
         nullptr /* state_allocator */);
     if (!rnn_desc_s.ok()) {
       return FromExecutorStatus(rnn_desc_s);
@@ -565,15 +640,20 @@ class CudnnRNNParamsSizeOp<GPUDevice, T, Index> : public CudnnRNNKernelCommon {
   }
 };
 
-REGISTER_KERNEL_BUILDER(Name("CudnnRNNParamsSize")
-                            .Device(DEVICE_GPU)
-                            .HostMemory("num_layers")
-                            .HostMemory("num_units")
-                            .HostMemory("input_size")
-                            .HostMemory("params_size")
-                            .TypeConstraint<float>("T")
-                            .TypeConstraint<int32>("S"),
-                        CudnnRNNParamsSizeOp<GPUDevice, float, int32>);
+#define REGISTER_GPU(T)                                    \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNParamsSize")       \
+                              .Device(DEVICE_GPU)          \
+                              .HostMemory("num_layers")    \
+                              .HostMemory("num_units")     \
+                              .HostMemory("input_size")    \
+                              .HostMemory("params_size")   \
+                              .TypeConstraint<T>("T")      \
+                              .TypeConstraint<int32>("S"), \
+                          CudnnRNNParamsSizeOp<GPUDevice, T, int32>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+#undef REGISTER_GPU
 
 // Convert weight and bias params from a platform-specific layout to the
 // canonical form.
@@ -683,13 +763,18 @@ class CudnnRNNParamsToCanonical<GPUDevice, T> : public CudnnRNNKernelCommon {
   int num_params_;
 };
 
-REGISTER_KERNEL_BUILDER(Name("CudnnRNNParamsToCanonical")
-                            .Device(DEVICE_GPU)
-                            .HostMemory("num_layers")
-                            .HostMemory("num_units")
-                            .HostMemory("input_size")
-                            .TypeConstraint<float>("T"),
-                        CudnnRNNParamsToCanonical<GPUDevice, float>);
+#define REGISTER_GPU(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNParamsToCanonical") \
+                              .Device(DEVICE_GPU)           \
+                              .HostMemory("num_layers")     \
+                              .HostMemory("num_units")      \
+                              .HostMemory("input_size")     \
+                              .TypeConstraint<T>("T"),      \
+                          CudnnRNNParamsToCanonical<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+#undef REGISTER_GPU
 
 // Convert weight and bias params from the canonical form to a
 // platform-specific layout.
@@ -725,21 +810,104 @@ class CudnnRNNCanonicalToParams<GPUDevice, T> : public CudnnRNNKernelCommon {
   }
 };
 
-REGISTER_KERNEL_BUILDER(Name("CudnnRNNCanonicalToParams")
-                            .Device(DEVICE_GPU)
-                            .HostMemory("num_layers")
-                            .HostMemory("num_units")
-                            .HostMemory("input_size")
-                            .TypeConstraint<float>("T"),
-                        CudnnRNNCanonicalToParams<GPUDevice, float>);
+#define REGISTER_GPU(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNCanonicalToParams") \
+                              .Device(DEVICE_GPU)           \
+                              .HostMemory("num_layers")     \
+                              .HostMemory("num_units")      \
+                              .HostMemory("input_size")     \
+                              .TypeConstraint<T>("T"),      \
+                          CudnnRNNCanonicalToParams<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+#undef REGISTER_GPU
+
+// A common base class for the kernels that run the model. It reads the
+// algorithm attributes, and keeps the descriptors of the model and the
+// tensors across calls instead of recreating them for every step.
+class CudnnRNNModelKernelCommon : public CudnnRNNKernelCommon {
+ protected:
+  explicit CudnnRNNModelKernelCommon(OpKernelConstruction* context)
+      : CudnnRNNKernelCommon(context) {
+    string str;
+    OP_REQUIRES_OK(context, context->GetAttr("rnn_algorithm", &str));
+    OP_REQUIRES_OK(context,
+                   ParseRNNAlgorithm(str, &rnn_algorithm_, &autotune_));
+    OP_REQUIRES_OK(context, context->GetAttr("use_tensor_op_math",
+                                             &use_tensor_op_math_));
+  }
+
+  RnnAlgorithm rnn_algorithm() const { return rnn_algorithm_; }
+  bool autotune() const { return autotune_; }
+
+  // Checks 'model_shapes' against the ones of the first call, and brings the
+  // tensor descriptors up to date.
+  template <typename T>
+  Status PrepareTensorDescriptors(OpKernelContext* context,
+                                  const CudnnModelShapes& model_shapes)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (model_shapes_ == nullptr) {
+      model_shapes_.reset(new CudnnModelShapes(model_shapes));
+    } else if (!model_shapes_->IsCompatibleWith(model_shapes)) {
+      return errors::InvalidArgument(
+          "Incompatible rnn model shapes inferred: expecting ",
+          model_shapes_->RnnDescDebugString(), ", getting ",
+          model_shapes.RnnDescDebugString(), ".");
+    }
+    auto* executor = context->op_device_context()->stream()->parent();
+    return tensor_descs_.Update(executor, model_shapes, ToDataType<T>::value);
+  }
+
+  // Returns the model descriptor of 'algorithm', created on first use. Every
+  // algorithm keeps its own descriptor and dropout state.
+  template <typename T>
+  Status GetRnnDescriptor(OpKernelContext* context, RnnAlgorithm algorithm,
+                          const RnnDescriptor** rnn_desc)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int index = static_cast<int>(algorithm);
+    if (rnn_descs_[index] == nullptr || ResetRndGenState()) {
+      RnnInputMode input_mode;
+      TF_RETURN_IF_ERROR(ToRNNInputMode(rnn_input_mode(),
+                                        model_shapes_->num_units,
+                                        model_shapes_->input_size,
+                                        &input_mode));
+      rnn_descs_[index].reset();
+      dropout_state_allocators_[index].reset(
+          new CudnnRNNPersistentSpaceAllocator(context));
+      auto* executor = context->op_device_context()->stream()->parent();
+      auto rnn_desc_s = executor->createRnnDescriptor(
+          model_shapes_->num_layers, model_shapes_->num_units,
+          model_shapes_->input_size, input_mode, rnn_direction_mode(),
+          rnn_mode(), ToDataType<T>::value, algorithm, use_tensor_op_math_,
+          dropout(), seed(), dropout_state_allocators_[index].get());
+      TF_RETURN_IF_ERROR(FromExecutorStatus(rnn_desc_s));
+      rnn_descs_[index] = rnn_desc_s.ConsumeValueOrDie();
+    }
+    *rnn_desc = rnn_descs_[index].get();
+    return Status::OK();
+  }
+
+  mutex mu_;
+  CudnnRnnTensorDescriptors tensor_descs_ GUARDED_BY(mu_);
+
+ private:
+  RnnAlgorithm rnn_algorithm_;
+  bool autotune_;
+  bool use_tensor_op_math_;
+  std::unique_ptr<CudnnModelShapes> model_shapes_ GUARDED_BY(mu_);
+  std::unique_ptr<RnnDescriptor> rnn_descs_[kNumRnnAlgorithms] GUARDED_BY(mu_);
+  std::unique_ptr<CudnnRNNPersistentSpaceAllocator>
+      dropout_state_allocators_[kNumRnnAlgorithms] GUARDED_BY(mu_);
+};
 
 // Run the forward operation of the RNN model.
 template <typename T>
-class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
+class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNModelKernelCommon {
  public:
   typedef GPUDevice Device;
   explicit CudnnRNNForwardOp(OpKernelConstruction* context)
-      : CudnnRNNKernelCommon(context) {
+      : CudnnRNNModelKernelCommon(context) {
     OP_REQUIRES_OK(context, context->GetAttr("is_training", &is_training_));
   }
 
@@ -752,7 +920,6 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     OP_REQUIRES_OK(context,
                    ExtractForwardInput(context, model_types(), &input, &input_h,
                                        &input_c, &params, &model_shapes));
-    const auto& input_shape = model_shapes.input_shape;
     const auto& hidden_state_shape = model_shapes.hidden_state_shape;
     const auto& output_shape = model_shapes.output_shape;
 
@@ -772,55 +939,6 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     }
 
     auto* stream = context->op_device_context()->stream();
-    auto* executor = stream->parent();
-    RnnInputMode input_mode;
-    OP_REQUIRES_OK(context,
-                   ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
-                                  model_shapes.input_size, &input_mode));
-    // TODO(zhengxq): cache the descriptor so we don't have to create them all
-    // the time.
-    auto data_type = ToDataType<T>::value;
-    {
-      mutex_lock l(mu_);
-      if (model_shapes_ == nullptr) {
-        model_shapes_.reset(new CudnnModelShapes(model_shapes));
-      } else {
-        OP_REQUIRES(context, model_shapes_->IsCompatibleWith(model_shapes),
-                    errors::InvalidArgument(
-                        "Incompatible rnn model shapes inferred: expecting ",
-                        model_shapes_->RnnDescDebugString(), ", getting ",
-                        model_shapes.RnnDescDebugString(), "."));
-      }
-      if (rnn_desc_ == nullptr || ResetRndGenState()) {
-        dropout_state_allocator_.reset(
-            new CudnnRNNPersistentSpaceAllocator(context));
-        auto rnn_desc_s = executor->createRnnDescriptor(
-            model_shapes_->num_layers, model_shapes_->num_units,
-            model_shapes_->input_size, input_mode, rnn_direction_mode(),
-            rnn_mode(), data_type, dropout(), seed(),
-            dropout_state_allocator_.get());
-        OP_REQUIRES_OK(context, FromExecutorStatus(rnn_desc_s));
-        rnn_desc_ = std::move(rnn_desc_s.ConsumeValueOrDie());
-      }
-    }
-
-    auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
-        input_shape.dim_size(0), input_shape.dim_size(1),
-        input_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(input_desc_s));
-    auto input_desc = input_desc_s.ConsumeValueOrDie();
-
-    auto hidden_state_desc_s = executor->createRnnStateTensorDescriptor(
-        hidden_state_shape.dim_size(0), hidden_state_shape.dim_size(1),
-        hidden_state_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(hidden_state_desc_s));
-    auto hidden_state_desc = hidden_state_desc_s.ConsumeValueOrDie();
-
-    auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
-        output_shape.dim_size(0), output_shape.dim_size(1),
-        output_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(output_desc_s));
-    auto output_desc = output_desc_s.ConsumeValueOrDie();
 
     auto input_data = AsDeviceMemory<T>(input);
     auto input_h_data = AsDeviceMemory<T>(input_h);
@@ -845,47 +963,104 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
       OP_REQUIRES_OK(context,
                      context->allocate_output(3, {}, &dummy_reserve_space));
     }
-    // Creates a memory callback for the workspace. The memory lives to the end
-    // of this kernel calls.
-    CudnnRNNWorkspaceAllocator workspace_allocator(context);
-    bool launch_status = false;
-    {
-      mutex_lock l(mu_);
-      launch_status =
-          stream
-              ->ThenRnnForward(
-                  *rnn_desc_, *input_desc, input_data, *hidden_state_desc,
-                  input_h_data, *hidden_state_desc, input_c_data, params_data,
-                  *output_desc, &output_data, *hidden_state_desc,
-                  &output_h_data, *hidden_state_desc, &output_c_data,
-                  is_training_, &reserve_space_allocator, &workspace_allocator)
-              .ok();
+
+    mutex_lock l(mu_);
+    OP_REQUIRES_OK(context, PrepareTensorDescriptors<T>(context, model_shapes));
+    const auto& input_desc = *tensor_descs_.input_desc;
+    const auto& hidden_state_desc = *tensor_descs_.hidden_state_desc;
+    const auto& output_desc = *tensor_descs_.output_desc;
+    // Enqueues the forward pass with 'rnn_desc'. When profiling, failures
+    // are reported through 'profile_result' instead of the stream.
+    auto launch = [&](const RnnDescriptor& rnn_desc,
+                      ProfileResult* profile_result) {
+      // Creates a memory callback for the workspace. The memory lives to the
+      // end of this kernel calls.
+      CudnnRNNWorkspaceAllocator workspace_allocator(context);
+      return stream
+          ->ThenRnnForward(rnn_desc, input_desc, input_data, hidden_state_desc,
+                           input_h_data, hidden_state_desc, input_c_data,
+                           params_data, output_desc, &output_data,
+                           hidden_state_desc, &output_h_data,
+                           hidden_state_desc, &output_c_data, is_training_,
+                           &reserve_space_allocator, &workspace_allocator,
+                           profile_result)
+          .ok();
+    };
+
+    RnnAlgorithm algorithm = rnn_algorithm();
+    if (autotune() && !is_training_) {
+      const auto key =
+          std::make_pair(model_shapes.seq_length, model_shapes.batch_size);
+      auto it = autotuned_algorithms_.find(key);
+      if (it == autotuned_algorithms_.end()) {
+        // Times every algorithm on the inputs of this call. The persistent
+        // ones are not supported by all GPUs and model sizes, failing to
+        // create or run them just excludes them.
+        ProfileResult best_result;
+        for (RnnAlgorithm candidate :
+             {RnnAlgorithm::kRnnStandard, RnnAlgorithm::kRnnPersistStatic,
+              RnnAlgorithm::kRnnPersistDynamic}) {
+          const RnnDescriptor* rnn_desc = nullptr;
+          Status status = GetRnnDescriptor<T>(context, candidate, &rnn_desc);
+          if (!status.ok()) {
+            VLOG(1) << "Skipping RNN algorithm " << static_cast<int>(candidate)
+                    << ": " << status;
+            continue;
+          }
+          ProfileResult profile_result;
+          launch(*rnn_desc, &profile_result);
+          if (profile_result.is_valid() &&
+              profile_result.elapsed_time_in_ms() <
+                  best_result.elapsed_time_in_ms()) {
+            best_result = profile_result;
+          }
+        }
+        OP_REQUIRES(context, best_result.is_valid(),
+                    errors::NotFound("No RNN algorithm worked for shapes ",
+                                     model_shapes.input_shape.DebugString()));
+        it = autotuned_algorithms_
+                 .emplace(key, static_cast<RnnAlgorithm>(
+                                   best_result.algorithm()))
+                 .first;
+        VLOG(1) << "Autotuned RNN algorithm for "
+                << model_shapes.input_shape.DebugString() << ": "
+                << static_cast<int>(it->second);
+      }
+      algorithm = it->second;
     }
+
+    const RnnDescriptor* rnn_desc = nullptr;
+    OP_REQUIRES_OK(context, GetRnnDescriptor<T>(context, algorithm, &rnn_desc));
+    bool launch_status = launch(*rnn_desc, nullptr /* profile_result */);
     OP_REQUIRES(context, launch_status,
                 errors::Internal("Failed to call ThenRnnForward"));
   }
 
  private:
-  mutex mu_;
   bool is_training_;
-  std::unique_ptr<CudnnModelShapes> model_shapes_ GUARDED_BY(mu_);
-  std::unique_ptr<RnnDescriptor> rnn_desc_ GUARDED_BY(mu_);
-  std::unique_ptr<CudnnRNNPersistentSpaceAllocator> dropout_state_allocator_
+  // The fastest algorithm for each [seq_length, batch_size] seen at
+  // inference, when the algorithm is autotuned.
+  std::map<std::pair<int, int>, RnnAlgorithm> autotuned_algorithms_
       GUARDED_BY(mu_);
 };
 
-REGISTER_KERNEL_BUILDER(
-    Name("CudnnRNN").Device(DEVICE_GPU).TypeConstraint<float>("T"),
-    CudnnRNNForwardOp<GPUDevice, float>);
+#define REGISTER_GPU(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("CudnnRNN").Device(DEVICE_GPU).TypeConstraint<T>("T"),       \
+      CudnnRNNForwardOp<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+#undef REGISTER_GPU
 
 // Run the backward operation of the RNN model.
 template <typename T>
-class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
+class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNModelKernelCommon {
  public:
   typedef GPUDevice Device;
 
   explicit CudnnRNNBackwardOp(OpKernelConstruction* context)
-      : CudnnRNNKernelCommon(context) {}
+      : CudnnRNNModelKernelCommon(context) {}
 
   void Compute(OpKernelContext* context) override {
     const Tensor* input = nullptr;
@@ -897,11 +1072,9 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
                    ExtractForwardInput(context, model_types(), &input, &input_h,
                                        &input_c, &params, &model_shapes));
 
-    const auto& input_shape = model_shapes.input_shape;
     const auto& hidden_state_shape = model_shapes.hidden_state_shape;
     const auto& output_shape = model_shapes.output_shape;
 
-    auto data_type = ToDataType<T>::value;
     const Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->input("output", &output));
     OP_REQUIRES(context, output_shape == output->shape(),
@@ -980,55 +1153,6 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
                                                      &params_backprop));
 
     auto* stream = context->op_device_context()->stream();
-    auto* executor = stream->parent();
-    RnnInputMode input_mode;
-    OP_REQUIRES_OK(context,
-                   ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
-                                  model_shapes.input_size, &input_mode));
-    // TODO(zhengxq): cache the descriptor so we don't have to create them all
-    // the time.
-    {
-      mutex_lock l(mu_);
-      if (model_shapes_ == nullptr) {
-        model_shapes_.reset(new CudnnModelShapes(model_shapes));
-      } else {
-        OP_REQUIRES(context, model_shapes_->IsCompatibleWith(model_shapes),
-                    errors::InvalidArgument(
-                        "Incompatible rnn model shapes inferred: expecting ",
-                        model_shapes_->RnnDescDebugString(), ", getting ",
-                        model_shapes.RnnDescDebugString(), "."));
-      }
-
-      if (rnn_desc_ == nullptr || ResetRndGenState()) {
-        dropout_state_allocator_.reset(
-            new CudnnRNNPersistentSpaceAllocator(context));
-        auto rnn_desc_s = executor->createRnnDescriptor(
-            model_shapes.num_layers, model_shapes.num_units,
-            model_shapes.input_size, input_mode, rnn_direction_mode(),
-            rnn_mode(), data_type, dropout(), seed(),
-            dropout_state_allocator_.get());
-        OP_REQUIRES_OK(context, FromExecutorStatus(rnn_desc_s));
-        rnn_desc_ = std::move(rnn_desc_s.ConsumeValueOrDie());
-      }
-    }
-
-    auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
-        input_shape.dim_size(0), input_shape.dim_size(1),
-        input_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(input_desc_s));
-    auto input_desc = input_desc_s.ConsumeValueOrDie();
-
-    auto hidden_state_desc_s = executor->createRnnStateTensorDescriptor(
-        hidden_state_shape.dim_size(0), hidden_state_shape.dim_size(1),
-        hidden_state_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(hidden_state_desc_s));
-    auto hidden_state_desc = hidden_state_desc_s.ConsumeValueOrDie();
-
-    auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
-        output_shape.dim_size(0), output_shape.dim_size(1),
-        output_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(output_desc_s));
-    auto output_desc = output_desc_s.ConsumeValueOrDie();
 
     auto input_data = AsDeviceMemory<T>(input);
     auto input_h_data = AsDeviceMemory<T>(input_h);
@@ -1057,40 +1181,45 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     }
     auto params_backprop_data = AsDeviceMemory<T>(params_backprop);
     auto reserve_space_uint8 = CastDeviceMemory<uint8, T>(reserve_space);
+
+    mutex_lock l(mu_);
+    OP_REQUIRES_OK(context, PrepareTensorDescriptors<T>(context, model_shapes));
+    const auto& input_desc = *tensor_descs_.input_desc;
+    const auto& hidden_state_desc = *tensor_descs_.hidden_state_desc;
+    const auto& output_desc = *tensor_descs_.output_desc;
+    // The reserve space comes from a forward pass with the same algorithm,
+    // since the algorithm is only autotuned at inference.
+    const RnnDescriptor* rnn_desc = nullptr;
+    OP_REQUIRES_OK(context,
+                   GetRnnDescriptor<T>(context, rnn_algorithm(), &rnn_desc));
     // Creates a memory callback for the workspace. The memory lives to the end
     // of this kernel calls.
     CudnnRNNWorkspaceAllocator workspace_allocator(context);
-    bool launch_status = false;
-    {
-      mutex_lock l(mu_);
-      launch_status =
-          stream
-              ->ThenRnnBackward(
-                  *rnn_desc_, *input_desc, input_data, *hidden_state_desc,
-                  input_h_data, *hidden_state_desc, input_c_data, params_data,
-                  *output_desc, output_data, *hidden_state_desc, output_h_data,
-                  *hidden_state_desc, output_c_data, output_backprop_data,
-                  output_h_backprop_data, output_c_backprop_data,
-                  &input_backprop_data, &input_h_backprop_data,
-                  &input_c_backprop_data, &params_backprop_data,
-                  &reserve_space_uint8, &workspace_allocator)
-              .ok();
-    }
+    bool launch_status =
+        stream
+            ->ThenRnnBackward(
+                *rnn_desc, input_desc, input_data, hidden_state_desc,
+                input_h_data, hidden_state_desc, input_c_data, params_data,
+                output_desc, output_data, hidden_state_desc, output_h_data,
+                hidden_state_desc, output_c_data, output_backprop_data,
+                output_h_backprop_data, output_c_backprop_data,
+                &input_backprop_data, &input_h_backprop_data,
+                &input_c_backprop_data, &params_backprop_data,
+                &reserve_space_uint8, &workspace_allocator)
+            .ok();
     OP_REQUIRES(context, launch_status,
                 errors::Internal("Failed to call ThenRnnBackward"));
   }
-
- private:
-  mutex mu_;
-  std::unique_ptr<CudnnModelShapes> model_shapes_ GUARDED_BY(mu_);
-  std::unique_ptr<RnnDescriptor> rnn_desc_ GUARDED_BY(mu_);
-  std::unique_ptr<CudnnRNNPersistentSpaceAllocator> dropout_state_allocator_
-      GUARDED_BY(mu_);
 };
 
-REGISTER_KERNEL_BUILDER(
-    Name("CudnnRNNBackprop").Device(DEVICE_GPU).TypeConstraint<float>("T"),
-    CudnnRNNBackwardOp<GPUDevice, float>);
+#define REGISTER_GPU(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("CudnnRNNBackprop").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      CudnnRNNBackwardOp<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+#undef REGISTER_GPU
 
 // TODO(zhengxq): Add the conversion of Cudnn RNN Params from and to
 // its canonical form.
@@ -56,6 +56,21 @@ constexpr auto kRNNInputModeAttrs =
 constexpr auto kRNNDirectionAttrs =
     "direction: {'unidirectional', 'bidirectional'} = 'unidirectional'";
 
+constexpr auto kRNNAlgorithmAttrs =
+    "rnn_algorithm: {'standard', 'persist_static', 'persist_dynamic', 'auto'} "
+    "= 'standard'";
+
+constexpr auto kCudnnRNNAlgorithmAttrsDoc = R"doc(
+rnn_algorithm: The cuDNN algorithm used to run the RNN. 'persist_static' and
+    'persist_dynamic' keep the recurrent weights on chip and are usually faster
+    for small batches; they require cuDNN 6. 'auto' times every algorithm on
+    the first inference call for each input shape and keeps the fastest one;
+    in training it behaves like 'standard'. The backprop must use the same
+    algorithm as the forward operation that produced reserve_space.
+use_tensor_op_math: If true, allows cuDNN 7 to use Tensor Core math for half
+    precision. Ignored by older cuDNN versions.
+)doc";
+
 constexpr auto kCudnnRNNParamsCanonical = R"doc(
 weights: the canonical form of weights that can be used for saving
     and restoration. They are more likely to be compatible across different
@@ -75,7 +90,7 @@ REGISTER_OP("CudnnRNNParamsSize")
     .Input("num_layers: int32")
     .Input("num_units: int32")
     .Input("input_size: int32")
-    .Attr("T: {float}")
+    .Attr("T: {half, float}")
     .Attr("S: {int32, int64}")
     .Attr(kRNNModeAttrs)
     .Attr(kRNNInputModeAttrs)
@@ -130,13 +145,15 @@ REGISTER_OP("CudnnRNN")
     .Output("output_h: T")
     .Output("output_c: T")
     .Output("reserve_space: T")
-    .Attr("T: {float}")
+    .Attr("T: {half, float}")
     .Attr(kRNNModeAttrs)
     .Attr(kRNNInputModeAttrs)
     .Attr(kRNNDirectionAttrs)
     .Attr("dropout: float = 0.0")
     .Attr("seed: int = 0")
     .Attr("seed2: int = 0")
+    .Attr(kRNNAlgorithmAttrs)
+    .Attr("use_tensor_op_math: bool = false")
     .Attr("is_training: bool = true")
     .SetShapeFn([](InferenceContext* c) {
       auto input_shape = c->input(0);
@@ -165,8 +182,8 @@ REGISTER_OP("CudnnRNN")
 Computes the RNN from the input and initial states, with respect to the params
 buffer.
 )doc",
-                         kCudnnRNNCommonAttrs, CudnnRNNForwardTensors(),
-                         R"doc(
+                         kCudnnRNNCommonAttrs, kCudnnRNNAlgorithmAttrsDoc,
+                         CudnnRNNForwardTensors(), R"doc(
 is_training: Indicates whether this operation is used for inferenece or
     training.
 reserve_space: an opaque tensor that can be used in backprop calculation. It
@@ -190,13 +207,15 @@ REGISTER_OP("CudnnRNNBackprop")
     .Output("input_h_backprop: T")
     .Output("input_c_backprop: T")
     .Output("params_backprop: T")
-    .Attr("T: {float}")
+    .Attr("T: {half, float}")
     .Attr(kRNNModeAttrs)
     .Attr(kRNNInputModeAttrs)
     .Attr(kRNNDirectionAttrs)
     .Attr("dropout: float = 0.0")
     .Attr("seed: int = 0")
     .Attr("seed2: int = 0")
+    .Attr(kRNNAlgorithmAttrs)
+    .Attr("use_tensor_op_math: bool = false")
     .SetShapeFn([](InferenceContext* c) {
       auto input_shape = c->input(0);
       auto input_h_shape = c->input(1);
@@ -211,8 +230,8 @@ REGISTER_OP("CudnnRNNBackprop")
     .Doc(strings::StrCat(R"doc(
 Compute the backprop of both data and weights in a RNN.
 )doc",
-                         kCudnnRNNCommonAttrs, CudnnRNNForwardTensors(),
-                         R"doc(
+                         kCudnnRNNCommonAttrs, kCudnnRNNAlgorithmAttrsDoc,
+                         CudnnRNNForwardTensors(), R"doc(
 output_backprop: A 3-D tensor with the same shape as output in the forward pass.
 output_h_backprop: A 3-D tensor with the same shape as output_h in the forward
     pass.
@@ -236,7 +255,7 @@ REGISTER_OP("CudnnRNNParamsToCanonical")
     .Input("params: T")
     .Output("weights: num_params * T")
     .Output("biases: num_params * T")
-    .Attr("T: {float}")
+    .Attr("T: {half, float}")
     .Attr("num_params: int")
     .Attr(kRNNModeAttrs)
     .Attr(kRNNInputModeAttrs)
@@ -279,7 +298,7 @@ REGISTER_OP("CudnnRNNCanonicalToParams")
     .Input("weights: num_params * T")
     .Input("biases: num_params * T")
     .Output("params: T")
-    .Attr("T: {float}")
+    .Attr("T: {half, float}")
     .Attr("num_params: int")
     .Attr(kRNNModeAttrs)
     .Attr(kRNNInputModeAttrs)
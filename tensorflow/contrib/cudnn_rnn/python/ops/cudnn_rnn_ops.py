@@ -163,7 +163,10 @@ class _CudnnRNN(object):
                input_mode="linear_input",
                direction="unidirectional",
                dropout=0.,
-               seed=0):
+               seed=0,
+               dtype=dtypes.float32,
+               rnn_algorithm="standard",
+               use_tensor_op_math=False):
     """Creates a CudnnRNN model from model spec.
 
     Args:
@@ -186,6 +189,14 @@ class _CudnnRNN(object):
       dropout: whether to enable dropout. With it is 0, dropout is disabled.
       seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
           for behavior.
+      dtype: the dtype of the model, either tf.float32 or tf.float16.
+      rnn_algorithm: the cuDNN algorithm to run. Could be 'standard',
+          'persist_static', 'persist_dynamic' or 'auto'. The persistent
+          algorithms need cuDNN 6 and are usually faster for small batches.
+          'auto' picks the fastest algorithm for each input shape during
+          inference and uses 'standard' in training.
+      use_tensor_op_math: whether to allow cuDNN 7 Tensor Core math for
+          float16 models.
     """
     self._num_layers = num_layers
     self._num_units = num_units
@@ -194,6 +205,9 @@ class _CudnnRNN(object):
     self._input_mode = input_mode
     self._direction = direction
     self._dropout = dropout
+    self._dtype = dtype
+    self._rnn_algorithm = rnn_algorithm
+    self._use_tensor_op_math = use_tensor_op_math
     # get graph and op seed.
     self._seed, self._seed2 = random_seed.get_seed(seed)
     if self._seed is None and self._seed2 is None:
@@ -209,7 +223,7 @@ class _CudnnRNN(object):
         num_layers=self._num_layers,
         num_units=self._num_units,
         input_size=self._input_size,
-        T=dtypes.float32,
+        T=self._dtype,
         S=dtypes.int32,
         dropout=self._dropout,
         seed=self._seed,
@@ -235,7 +249,7 @@ class _CudnnRNN(object):
     """
     if self._rnn_mode != "lstm":
       # For model that doesn't take input_c, replace with a dummy tensor.
-      input_c = array_ops.constant([], dtype=dtypes.float32)
+      input_c = array_ops.constant([], dtype=input_h.dtype)
     output, output_h, output_c, _ = gen_cudnn_rnn_ops.cudnn_rnn(
         input=input_data,
         input_h=input_h,
@@ -247,6 +261,8 @@ class _CudnnRNN(object):
         dropout=self._dropout,
         seed=self._seed,
         seed2=self._seed2,
+        rnn_algorithm=self._rnn_algorithm,
+        use_tensor_op_math=self._use_tensor_op_math,
         is_training=is_training)
     return (output, output_h, output_c)
 
@@ -311,7 +327,10 @@ class CudnnLSTM(_CudnnRNN):
                input_mode="auto_select",
                direction="unidirectional",
                dropout=0.,
-               seed=0):
+               seed=0,
+               dtype=dtypes.float32,
+               rnn_algorithm="standard",
+               use_tensor_op_math=False):
     """Creates a Cudnn LSTM model from model spec.
 
     Args:
@@ -329,6 +348,14 @@ class CudnnLSTM(_CudnnRNN):
           'unidirectional' or 'bidirectional'
       dropout: whether to enable dropout. With it is 0, dropout is disabled.
       seed: the seed used for initializing dropout.
+      dtype: the dtype of the model, either tf.float32 or tf.float16.
+      rnn_algorithm: the cuDNN algorithm to run. Could be 'standard',
+          'persist_static', 'persist_dynamic' or 'auto'. The persistent
+          algorithms need cuDNN 6 and are usually faster for small batches.
+          'auto' picks the fastest algorithm for each input shape during
+          inference and uses 'standard' in training.
+      use_tensor_op_math: whether to allow cuDNN 7 Tensor Core math for
+          float16 models.
     """
     super(CudnnLSTM, self).__init__(
         "lstm",
@@ -338,7 +365,10 @@ class CudnnLSTM(_CudnnRNN):
         input_mode=input_mode,
         direction=direction,
         dropout=dropout,
-        seed=seed)
+        seed=seed,
+        dtype=dtype,
+        rnn_algorithm=rnn_algorithm,
+        use_tensor_op_math=use_tensor_op_math)
 
   def __call__(self, input_data, input_h, input_c, params, is_training=True):
     """Runs the forward step for the Cudnn LSTM model.
@@ -371,7 +401,10 @@ class _CudnnRNNNoInputC(_CudnnRNN):
                input_mode="auto_select",
                direction="unidirectional",
                dropout=0.,
-               seed=0):
+               seed=0,
+               dtype=dtypes.float32,
+               rnn_algorithm="standard",
+               use_tensor_op_math=False):
     """Creates a Cudnn RNN model from model without hidden-state C.
 
     Args:
@@ -389,6 +422,14 @@ class _CudnnRNNNoInputC(_CudnnRNN):
           'unidirectional' or 'bidirectional'
       dropout: whether to enable dropout. With it is 0, dropout is disabled.
       seed: the seed used for initializing dropout.
+      dtype: the dtype of the model, either tf.float32 or tf.float16.
+      rnn_algorithm: the cuDNN algorithm to run. Could be 'standard',
+          'persist_static', 'persist_dynamic' or 'auto'. The persistent
+          algorithms need cuDNN 6 and are usually faster for small batches.
+          'auto' picks the fastest algorithm for each input shape during
+          inference and uses 'standard' in training.
+      use_tensor_op_math: whether to allow cuDNN 7 Tensor Core math for
+          float16 models.
     """
     super(_CudnnRNNNoInputC, self).__init__(
         self._rnn_mode,
@@ -398,7 +439,10 @@ class _CudnnRNNNoInputC(_CudnnRNN):
         input_mode=input_mode,
         direction=direction,
         dropout=dropout,
-        seed=seed)
+        seed=seed,
+        dtype=dtype,
+        rnn_algorithm=rnn_algorithm,
+        use_tensor_op_math=use_tensor_op_math)
 
   def __call__(self, input_data, input_h, params, is_training=True):
     """Runs the forward step for the Cudnn LSTM model.
@@ -467,7 +511,9 @@ def _cudnn_rnn_backward(op, *grad):
       seed2=op.get_attr("seed2"),
       rnn_mode=op.get_attr("rnn_mode"),
       input_mode=op.get_attr("input_mode"),
-      direction=op.get_attr("direction"))
+      direction=op.get_attr("direction"),
+      rnn_algorithm=op.get_attr("rnn_algorithm"),
+      use_tensor_op_math=op.get_attr("use_tensor_op_math"))
 
 
 ops.RegisterShape("CudnnRNNParamsSize")(common_shapes.call_cpp_shape_fn)
@@ -22,6 +22,8 @@
 
 @@read_batch_features
 @@rejection_resample
+
+@@AUTOTUNE
 """
 
 from __future__ import absolute_import
@@ -29,6 +31,7 @@ from __future__ import division
 from __future__ import print_function
 
 # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops.dataset_ops import AUTOTUNE
 from tensorflow.contrib.data.python.ops.dataset_ops import Dataset
 from tensorflow.contrib.data.python.ops.dataset_ops import FixedLengthRecordDataset
 from tensorflow.contrib.data.python.ops.dataset_ops import Iterator
@@ -0,0 +1,110 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import random_ops
+from tensorflow.python.platform import test
+
+
+class CacheDatasetTest(test.TestCase):
+
+  def testMemoryCacheDataset(self):
+    # Each element is random, so the second epoch only matches the first if
+    # it is served from the cache.
+    dataset = (dataset_ops.Dataset.range(10)
+               .map(lambda x: (x, random_ops.random_uniform([3])))
+               .cache().repeat(3))
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      first_epoch = [sess.run(get_next) for _ in range(10)]
+      for _ in range(2):
+        for i in range(10):
+          index, value = sess.run(get_next)
+          self.assertEqual(i, index)
+          self.assertAllEqual(first_epoch[i][1], value)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testMemoryCacheIsNotFilledByPartialEpoch(self):
+    dataset = (dataset_ops.Dataset.range(5)
+               .map(lambda x: random_ops.random_uniform([]))
+               .cache())
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      sess.run(get_next)
+      # Reinitializing abandons the partial epoch, so the next one fills the
+      # cache from scratch and all of its elements are produced.
+      sess.run(init_op)
+      for _ in range(5):
+        sess.run(get_next)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testFileCacheDataset(self):
+    filename = os.path.join(self.get_temp_dir(), "cache")
+    components = (np.array([1, 2, 3, 4], dtype=np.int64),
+                  np.array([[1., 2.], [3., 4.], [5., 6.], [7., 8.]]))
+    input_placeholders = tuple(
+        array_ops.placeholder(dtypes.as_dtype(c.dtype), shape=c.shape)
+        for c in components)
+    dataset = (dataset_ops.Dataset.from_tensor_slices(input_placeholders)
+               .cache(filename))
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      # The first epoch writes the cache.
+      sess.run(init_op, feed_dict=dict(zip(input_placeholders, components)))
+      for i in range(4):
+        result = sess.run(get_next)
+        self.assertAllEqual(components[0][i], result[0])
+        self.assertAllEqual(components[1][i], result[1])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+      # Later iterators read from the cache, not from their input.
+      sess.run(init_op, feed_dict={
+          input_placeholders[0]: np.zeros([4], dtype=np.int64),
+          input_placeholders[1]: np.zeros([4, 2])})
+      for i in range(4):
+        result = sess.run(get_next)
+        self.assertAllEqual(components[0][i], result[0])
+        self.assertAllEqual(components[1][i], result[1])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+
+if __name__ == "__main__":
+  test.main()
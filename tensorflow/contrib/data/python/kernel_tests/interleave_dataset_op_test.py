@@ -0,0 +1,173 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import itertools
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.platform import test
+
+
+class InterleaveDatasetTest(test.TestCase):
+
+  def _interleave(self, lists, cycle_length, block_length):
+    """Python implementation of interleave used for testing."""
+    num_open = 0
+
+    # `all_iterators` acts as a queue of iterators over each element of
+    # `lists`.
+    all_iterators = iter([iter(l) for l in lists])
+
+    # `open_iterators` are the iterators whose elements are currently being
+    # interleaved.
+    open_iterators = []
+    for _ in range(cycle_length):
+      try:
+        open_iterators.append(next(all_iterators))
+        num_open += 1
+      except StopIteration:
+        open_iterators.append(None)
+
+    while num_open:
+      for i in range(cycle_length):
+        if open_iterators[i] is None:
+          try:
+            open_iterators[i] = next(all_iterators)
+            num_open += 1
+          except StopIteration:
+            continue
+        for _ in range(block_length):
+          try:
+            yield next(open_iterators[i])
+          except StopIteration:
+            open_iterators[i] = None
+            num_open -= 1
+            break
+
+  def testPythonImplementation(self):
+    input_lists = [[4, 4, 4, 4], [5, 5, 5, 5, 5], [6, 6, 6, 6, 6, 6],
+                   [4, 4, 4, 4], [5, 5, 5, 5, 5], [6, 6, 6, 6, 6, 6]]
+
+    # Cycle length 1 acts like `Dataset.flat_map()`.
+    expected_elements = itertools.chain(*input_lists)
+    for expected, produced in zip(
+        expected_elements, self._interleave(input_lists, 1, 1)):
+      self.assertEqual(expected, produced)
+
+    # Cycle length > 1.
+    expected_elements = [4, 5, 4, 5, 4, 5, 4,
+                         5, 5, 6, 6,  # NOTE(mrry): When we cycle back
+                                      # to a list and are already at
+                                      # the end of that list, we move
+                                      # on to the next element.
+                         4, 6, 4, 6, 4, 6, 4, 6, 5, 6, 5, 6, 5, 6, 5, 6, 5]
+    for expected, produced in zip(
+        expected_elements, self._interleave(input_lists, 2, 1)):
+      self.assertEqual(expected, produced)
+
+  def _buildDataset(self, input_values, cycle_length, block_length,
+                    parallel=False, sloppy=False):
+    dataset = (dataset_ops.Dataset.from_tensor_slices(input_values)
+               .repeat(2))
+    map_func = lambda x: dataset_ops.Dataset.from_tensors(x).repeat(x)
+    if parallel:
+      return dataset.parallel_interleave(map_func, cycle_length, block_length,
+                                         sloppy)
+    return dataset.interleave(map_func, cycle_length, block_length)
+
+  def _testInterleaveDataset(self, parallel):
+    input_values = array_ops.placeholder(dtypes.int64, shape=[None])
+    cycle_length = array_ops.placeholder(dtypes.int64, shape=[])
+    block_length = array_ops.placeholder(dtypes.int64, shape=[])
+
+    iterator = self._buildDataset(
+        input_values, cycle_length, block_length,
+        parallel=parallel).make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      # Cover empty input elements, cycle lengths longer than the input,
+      # and blocks that span a whole input element.
+      for input_list in [[4, 5, 6], [4, 0, 6], [0, 0, 0]]:
+        for cycle_length_val in [1, 2, 3, 7]:
+          for block_length_val in [1, 2, 10]:
+            sess.run(init_op, feed_dict={input_values: input_list,
+                                         cycle_length: cycle_length_val,
+                                         block_length: block_length_val})
+            lists = [[x] * x for x in input_list + input_list]
+            for expected in self._interleave(lists, cycle_length_val,
+                                             block_length_val):
+              self.assertEqual(expected, sess.run(get_next))
+            with self.assertRaises(errors.OutOfRangeError):
+              sess.run(get_next)
+
+  def testInterleaveDataset(self):
+    self._testInterleaveDataset(parallel=False)
+
+  def testParallelInterleaveDataset(self):
+    self._testInterleaveDataset(parallel=True)
+
+  def testSloppyParallelInterleaveDataset(self):
+    input_values = np.array([4, 5, 6], dtype=np.int64)
+    iterator = self._buildDataset(
+        input_values, 3, 2, parallel=True,
+        sloppy=True).make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      # The order is not deterministic, but every element is produced.
+      produced = []
+      for _ in range(2 * (4 + 5 + 6)):
+        produced.append(sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+      expected = [x for x in [4, 5, 6] * 2 for _ in range(x)]
+      self.assertAllEqual(sorted(expected), sorted(produced))
+
+  def testParallelInterleaveForwardsErrors(self):
+    components = np.array([1., 2., np.nan, 4.], dtype=np.float32)
+    iterator = (
+        dataset_ops.Dataset.from_tensor_slices(components)
+        .map(lambda x: array_ops.check_numerics(x, "message"))
+        .parallel_interleave(lambda x: dataset_ops.Dataset.from_tensors(x),
+                             cycle_length=2)
+        .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      self.assertEqual(1., sess.run(get_next))
+      self.assertEqual(2., sess.run(get_next))
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+      self.assertEqual(4., sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+
+if __name__ == "__main__":
+  test.main()
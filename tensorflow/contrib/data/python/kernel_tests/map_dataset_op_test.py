@@ -199,6 +199,48 @@ class MapDatasetTest(test.TestCase):
   def testImplicitDisposeParallelMapDataset(self):
     self._testDisposeParallelMapDataset(False)
 
+  def testAutoTunedParallelMapDataset(self):
+    output_buffer_size = array_ops.placeholder(dtypes.int64, shape=[])
+    iterator = (dataset_ops.Dataset.range(1000)
+                .map(lambda x: x * x, num_threads=dataset_ops.AUTOTUNE,
+                     output_buffer_size=output_buffer_size)
+                .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      # A non-positive buffer size lets the iterator choose the maximum size.
+      for output_buffer_size_val in [-1, 1, 3]:
+        sess.run(init_op,
+                 feed_dict={output_buffer_size: output_buffer_size_val})
+        for i in range(1000):
+          self.assertEqual(i * i, sess.run(get_next))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testAutoTunedParallelMapDatasetDefaultBufferSize(self):
+    iterator = (dataset_ops.Dataset.range(100)
+                .map(lambda x: x + 1, num_threads=dataset_ops.AUTOTUNE)
+                .make_one_shot_iterator())
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for i in range(100):
+        self.assertEqual(i + 1, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testParallelMapInvalidNumThreads(self):
+    num_threads = array_ops.placeholder(dtypes.int32, shape=[])
+    iterator = (dataset_ops.Dataset.range(10)
+                .map(lambda x: x, num_threads=num_threads)
+                .make_initializable_iterator())
+    init_op = iterator.initializer
+
+    with self.test_session() as sess:
+      with self.assertRaisesOpError("num_threads must be greater than zero"):
+        sess.run(init_op, feed_dict={num_threads: -2})
+
   def testParallelMapError(self):
     components = np.array([1., 2., 3., np.nan, 5.]).astype(np.float32)
 
@@ -219,6 +261,57 @@ class MapDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(get_next)
 
+  def testMapAndBatchDataset(self):
+    """Test a dataset that maps a TF function and batches the results."""
+    # The pipeline is TensorSliceDataset -> RepeatDataset(count) ->
+    # MapAndBatchDataset(square_3, batch_size).
+    components = (np.arange(7),
+                  np.array([[1, 2, 3]]) * np.arange(7)[:, np.newaxis],
+                  np.array(37.0) * np.arange(7))
+    count = array_ops.placeholder(dtypes.int64, shape=[])
+    batch_size = array_ops.placeholder(dtypes.int64, shape=[])
+    num_threads = array_ops.placeholder(dtypes.int32, shape=[])
+
+    def _map_fn(x, y, z):
+      return math_ops.square(x), math_ops.square(y), math_ops.square(z)
+
+    iterator = (dataset_ops.Dataset.from_tensor_slices(components)
+                .repeat(count)
+                .map_and_batch(_map_fn, batch_size, num_threads)
+                .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    self.assertEqual([[None] + list(c.shape[1:]) for c in components],
+                     [t.shape.as_list() for t in get_next])
+
+    with self.test_session() as sess:
+      for batch_size_val, num_threads_val in [(4, 1), (4, 4), (7, 2), (8, 16)]:
+        sess.run(init_op, feed_dict={count: 4, batch_size: batch_size_val,
+                                     num_threads: num_threads_val})
+        # The last batch may be partial.
+        for start in range(0, 28, batch_size_val):
+          result = sess.run(get_next)
+          indices = [i % 7 for i in range(start, min(start + batch_size_val,
+                                                     28))]
+          for component, result_component in zip(components, result):
+            self.assertAllEqual(component[indices]**2, result_component)
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testMapAndBatchShapeMismatch(self):
+    iterator = (dataset_ops.Dataset.range(4)
+                .map_and_batch(lambda x: array_ops.fill([x], x), 4)
+                .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "Cannot batch tensors with different"):
+        sess.run(get_next)
+
   def testCaptureHashTable(self):
     # NOTE(mrry): We must use the V2 variants of `HashTable`
     # etc. because these produce a `tf.resource`-typed output that is
@@ -0,0 +1,167 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import time
+
+from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.core.example import example_pb2
+from tensorflow.core.example import feature_pb2
+from tensorflow.python.client import session
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import parsing_ops
+from tensorflow.python.platform import test
+from tensorflow.python.util import compat
+
+
+def _make_example(i):
+  return example_pb2.Example(features=feature_pb2.Features(
+      feature={
+          "age":
+              feature_pb2.Feature(int64_list=feature_pb2.Int64List(
+                  value=[i])),
+          "height":
+              feature_pb2.Feature(float_list=feature_pb2.FloatList(
+                  value=[float(i), float(i) / 2])),
+          "kws":
+              feature_pb2.Feature(bytes_list=feature_pb2.BytesList(
+                  value=[compat.as_bytes("kw%d" % j)
+                         for j in range(i % 3)])),
+      })).SerializeToString()
+
+
+class ParseExampleDatasetTest(test.TestCase):
+
+  def testParseExampleDataset(self):
+    serialized = [_make_example(i) for i in range(10)]
+    features = {
+        "age": parsing_ops.FixedLenFeature([], dtypes.int64),
+        "height": parsing_ops.FixedLenFeature([2], dtypes.float32),
+        "kws": parsing_ops.VarLenFeature(dtypes.string),
+        "missing": parsing_ops.FixedLenFeature([], dtypes.int64,
+                                               default_value=-1),
+    }
+    batch_size = array_ops.placeholder(dtypes.int64, shape=[])
+    num_threads = array_ops.placeholder(dtypes.int32, shape=[])
+    dataset = (dataset_ops.Dataset.from_tensor_slices(serialized)
+               .batch(batch_size)
+               .parse_example(features, num_threads))
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    # The sparse "kws" triplet comes first, followed by the dense features in
+    # sorted key order.
+    self.assertEqual((dtypes.int64, dtypes.string, dtypes.int64, dtypes.int64,
+                      dtypes.float32, dtypes.int64), dataset.output_types)
+    self.assertEqual([[None, 2], [None], [2], [None], [None, 2], [None]],
+                     [s.as_list() for s in dataset.output_shapes])
+
+    serialized_t = array_ops.placeholder(dtypes.string, shape=[None])
+    expected = parsing_ops.parse_example(serialized_t, features)
+
+    with self.test_session() as sess:
+      for batch_size_val, num_threads_val in [(4, 1), (4, 3), (10, 8)]:
+        sess.run(init_op, feed_dict={batch_size: batch_size_val,
+                                     num_threads: num_threads_val})
+        for start in range(0, len(serialized), batch_size_val):
+          result = sess.run(get_next)
+          expected_val = sess.run(expected, feed_dict={
+              serialized_t: serialized[start:start + batch_size_val]})
+          self.assertAllEqual(expected_val["kws"].indices, result[0])
+          self.assertAllEqual(expected_val["kws"].values, result[1])
+          self.assertAllEqual(expected_val["kws"].dense_shape, result[2])
+          self.assertAllEqual(expected_val["age"], result[3])
+          self.assertAllEqual(expected_val["height"], result[4])
+          self.assertAllEqual(expected_val["missing"], result[5])
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testParseExampleDatasetMissingRequiredFeature(self):
+    serialized = [_make_example(i) for i in range(4)]
+    features = {"weight": parsing_ops.FixedLenFeature([], dtypes.float32)}
+    iterator = (dataset_ops.Dataset.from_tensor_slices(serialized)
+                .batch(2)
+                .parse_example(features)
+                .make_one_shot_iterator())
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      with self.assertRaisesOpError("Feature: weight"):
+        sess.run(get_next)
+
+  def testParseExampleDatasetRequiresVectorInput(self):
+    serialized = [_make_example(i) for i in range(4)]
+    features = {"age": parsing_ops.FixedLenFeature([], dtypes.int64)}
+    with self.assertRaises(TypeError):
+      dataset_ops.Dataset.from_tensor_slices(serialized).parse_example(
+          features)
+
+
+class ParseExampleDatasetBenchmark(test.Benchmark):
+
+  def _benchmark(self, name, make_dataset, num_features, batch_size):
+    features = {}
+    feature_protos = {}
+    for i in range(num_features):
+      key = "f%03d" % i
+      features[key] = parsing_ops.FixedLenFeature([], dtypes.float32)
+      feature_protos[key] = feature_pb2.Feature(
+          float_list=feature_pb2.FloatList(value=[float(i)]))
+    serialized = example_pb2.Example(features=feature_pb2.Features(
+        feature=feature_protos)).SerializeToString()
+
+    with ops.Graph().as_default():
+      dataset = make_dataset(
+          dataset_ops.Dataset.from_tensors(serialized).repeat(None), features,
+          batch_size)
+      get_next = dataset.make_one_shot_iterator().get_next()
+      get_next_op = get_next[0].op
+
+      with session.Session() as sess:
+        for _ in range(5):
+          sess.run(get_next_op)
+        iters = 50
+        start = time.time()
+        for _ in range(iters):
+          sess.run(get_next_op)
+        end = time.time()
+        self.report_benchmark(
+            iters=iters, wall_time=(end - start) / iters,
+            name="%s_features_%d_batch_%d" % (name, num_features, batch_size))
+
+  def benchmarkMapThenBatch(self):
+    def make_dataset(dataset, features, batch_size):
+      # pylint: disable=protected-access
+      return (dataset
+              .map(lambda x: dataset_ops._parse_example([x], features))
+              .batch(batch_size))
+      # pylint: enable=protected-access
+    self._benchmark("map_then_batch", make_dataset, 500, 128)
+
+  def benchmarkBatchThenParseExample(self):
+    def make_dataset(dataset, features, batch_size):
+      return dataset.batch(batch_size).parse_example(features, num_threads=8)
+    self._benchmark("parse_example_dataset", make_dataset, 500, 128)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,101 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.platform import test
+
+
+class PrefetchDatasetTest(test.TestCase):
+
+  def testPrefetchDataset(self):
+    components = (np.arange(7),
+                  np.array([[1, 2, 3]]) * np.arange(7)[:, np.newaxis],
+                  np.array(37.0) * np.arange(7))
+    count = array_ops.placeholder(dtypes.int64, shape=[])
+    buffer_size = array_ops.placeholder(dtypes.int64, shape=[])
+
+    dataset = (dataset_ops.Dataset.from_tensor_slices(components)
+               .repeat(count).prefetch(buffer_size))
+    self.assertEqual([c.shape[1:] for c in components],
+                     [t.shape for t in dataset.output_shapes])
+
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for buffer_size_val in [1, 2, 7, 100]:
+        sess.run(init_op, feed_dict={count: 3, buffer_size: buffer_size_val})
+        # The elements are produced in input order.
+        for _ in range(3):
+          for i in range(7):
+            result = sess.run(get_next)
+            for component, result_component in zip(components, result):
+              self.assertAllEqual(component[i], result_component)
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "buffer_size must be greater than zero"):
+        sess.run(init_op, feed_dict={count: 1, buffer_size: 0})
+
+  def testPrefetchForwardsErrors(self):
+    components = np.array([1., 2., 3., np.nan, 5.]).astype(np.float32)
+
+    dataset = (dataset_ops.Dataset.from_tensor_slices(components)
+               .map(lambda x: array_ops.check_numerics(x, "message"))
+               .prefetch(2))
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      for i in range(3):
+        self.assertEqual(components[i], sess.run(get_next))
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+      # The prefetch thread keeps reading after an error.
+      self.assertEqual(components[4], sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testDisposePrefetchDataset(self):
+    # Destroying the iterator while the prefetch thread is blocked on a
+    # full buffer must not hang.
+    dataset = dataset_ops.Dataset.range(1000).prefetch(10)
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+    dispose_op = iterator.dispose_op()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      for i in range(3):
+        self.assertEqual(i, sess.run(get_next))
+      sess.run(dispose_op)
+
+
+if __name__ == "__main__":
+  test.main()
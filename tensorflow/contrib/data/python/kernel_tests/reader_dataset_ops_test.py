@@ -114,6 +114,32 @@ class TextLineDatasetTest(test.TestCase):
         self.assertAllEqual([self._lineText(1, i) for i in range(5)],
                             sess.run(get_next))
 
+  def testTextLineDatasetMmap(self):
+    test_filenames = self._createFiles(2, 5, crlf=True)
+    # Add files that exercise the edge cases of line splitting.
+    for i, contents in enumerate([b"", b"a\n\nb\r\n\n", b"c\r", b"\r"]):
+      fn = os.path.join(self.get_temp_dir(), "text_line_edge.%d.txt" % i)
+      with open(fn, "wb") as f:
+        f.write(contents)
+      test_filenames.append(fn)
+
+    def read_all(use_mmap):
+      get_next = (dataset_ops.TextLineDataset(test_filenames, use_mmap=use_mmap)
+                  .make_one_shot_iterator().get_next())
+      lines = []
+      with self.test_session() as sess:
+        while True:
+          try:
+            lines.append(sess.run(get_next))
+          except errors.OutOfRangeError:
+            return lines
+
+    lines = read_all(use_mmap=True)
+    self.assertEqual(read_all(use_mmap=False), lines)
+    self.assertEqual(
+        [self._lineText(j, i) for j in range(2) for i in range(5)] +
+        [b"a", b"", b"b", b"", b"c"], lines)
+
 
 class FixedLengthRecordReaderTest(test.TestCase):
 
@@ -202,6 +228,20 @@ class FixedLengthRecordReaderTest(test.TestCase):
                                for i in range(self._num_records)],
                               sess.run(get_next))
 
+  def testFixedLengthRecordDatasetMmap(self):
+    test_filenames = self._createFiles()
+    get_next = (dataset_ops.FixedLengthRecordDataset(
+        test_filenames, self._record_bytes, self._header_bytes,
+        self._footer_bytes, use_mmap=True)
+                .make_one_shot_iterator().get_next())
+
+    with self.test_session() as sess:
+      for j in range(self._num_files):
+        for i in range(self._num_records):
+          self.assertEqual(self._record(j, i), sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
 
 class TFRecordDatasetTest(test.TestCase):
 
@@ -41,6 +41,11 @@ from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.platform import gfile
 
 
+# A value of `num_threads` for `Dataset.map()` that tunes the parallelism at
+# runtime.
+AUTOTUNE = -1
+
+
 class Iterator(object):
   """Represents the state of iterating through a `Dataset`."""
 
@@ -229,11 +234,14 @@ class Iterator(object):
     return gen_dataset_ops.make_iterator(dataset.make_dataset_resource(),
                                          self._iterator_resource)
 
-  def get_next(self, name=None):
+  def get_next(self, name=None, collect_stats=False):
     """Returns a nested structure of `tf.Tensor`s containing the next element.
 
     Args:
       name: (Optional.) A name for the created operation.
+      collect_stats: (Optional.) If `True`, the iterator and its inputs export
+        their statistics under `/tensorflow/data/iterator/` while getting the
+        element.
 
     Returns:
       A nested structure of `tf.Tensor` objects.
@@ -244,6 +252,7 @@ class Iterator(object):
             self._iterator_resource,
             output_types=nest.flatten(self._output_types),
             output_shapes=nest.flatten(self._output_shapes),
+            collect_stats=collect_stats,
             name=name))
 
   def dispose_op(self, name=None):
@@ -657,6 +666,40 @@ class Dataset(object):
     """
     return ShuffleDataset(self, buffer_size, seed)
 
+  def prefetch(self, buffer_size):
+    """Creates a `Dataset` that prefetches elements from this dataset.
+
+    An iterator over the returned dataset produces elements of this dataset
+    on a background thread, so that input processing overlaps with the
+    computation that consumes its output.
+
+    Args:
+      buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the
+        maximum number of elements that will be buffered when prefetching.
+
+    Returns:
+      A `Dataset`.
+    """
+    return PrefetchDataset(self, buffer_size)
+
+  def cache(self, filename=""):
+    """Caches the elements in this dataset.
+
+    The first time the returned dataset is iterated to the end, its elements
+    are cached, and later iterations (e.g. later epochs of a
+    `Dataset.repeat()`) read them from the cache instead of recomputing them.
+
+    Args:
+      filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
+        file on the filesystem to use for caching the elements. If a complete
+        cache already exists at `filename`, it is used. If a filename is not
+        provided, the elements are cached in memory.
+
+    Returns:
+      A `Dataset`.
+    """
+    return CacheDataset(self, filename)
+
   def take(self, count):
     """Creates a `Dataset` with at most `count` elements from this dataset.
 
@@ -803,16 +846,68 @@ class Dataset(object):
       num_threads: (Optional.) A `tf.int32` scalar `tf.Tensor`, representing
         the number of threads to use for processing elements in parallel. If
         not specified, elements will be processed sequentially without
-        buffering.
+        buffering. If `tf.contrib.data.AUTOTUNE`, the number of elements
+        processed in parallel (up to the number of CPUs) and the size of the
+        buffer will be adjusted at runtime, depending on how long the
+        consumer of the dataset waits for elements.
       output_buffer_size: (Optional.) A `tf.int64` scalar `tf.Tensor`,
         representing the maximum number of processed elements that will be
-        buffered when processing in parallel.
+        buffered when processing in parallel. If `num_threads` is
+        `tf.contrib.data.AUTOTUNE` and this is not specified, the buffer may
+        grow to twice the number of CPUs.
 
     Returns:
       A `Dataset`.
     """
     return MapDataset(self, map_func, num_threads, output_buffer_size)
 
+  def map_and_batch(self, map_func, batch_size, num_threads=1):
+    """Maps `map_func` across this dataset, and batches the results.
+
+    This is equivalent to
+    `dataset.map(map_func, num_threads).batch(batch_size)`, but the result of
+    each call of `map_func` is copied into its slice of the batch as soon as the
+    call finishes, rather than buffered and copied when the whole batch is
+    ready. Every element in a batch must have the same shape.
+
+    Args:
+      map_func: A function mapping a nested structure of tensors (having shapes
+        and types defined by `self.output_shapes` and `self.output_types`) to
+        another nested structure of tensors.
+      batch_size: A `tf.int64` scalar `tf.Tensor`, representing the number of
+        consecutive elements of the mapped dataset to combine in a single batch.
+      num_threads: (Optional.) A `tf.int32` scalar `tf.Tensor`, representing the
+        number of threads to use for processing elements in parallel.
+
+    Returns:
+      A `Dataset`.
+    """
+    return MapAndBatchDataset(self, map_func, batch_size, num_threads)
+
+  def parse_example(self, features, num_threads=1):
+    """Parses each batch of serialized `Example` protos in this dataset.
+
+    Each element of this dataset must be a `tf.string` vector of serialized
+    `Example` protos, such as the output of `Dataset.batch()` applied to a
+    dataset of records. This is equivalent to
+    `dataset.map(lambda x: tf.parse_example(x, features))`, but all of the
+    examples in a batch are parsed by a single multithreaded kernel.
+
+    Each element of the returned dataset is a tuple, containing the `indices`,
+    `values` and `dense_shape` of each `VarLenFeature` in sorted key order,
+    followed by the value of each `FixedLenFeature` in sorted key order.
+
+    Args:
+      features: A `dict` mapping feature keys to `FixedLenFeature` or
+        `VarLenFeature` values. See `tf.parse_example`.
+      num_threads: (Optional.) A `tf.int32` scalar `tf.Tensor`, representing the
+        number of threads to use for parsing each batch.
+
+    Returns:
+      A `Dataset`.
+    """
+    return ParseExampleDataset(self, features, num_threads)
+
   def flat_map(self, map_func):
     """Maps `map_func` across this dataset and flattens the result.
 
@@ -826,6 +921,77 @@ class Dataset(object):
     """
     return FlatMapDataset(self, map_func)
 
+  def interleave(self, map_func, cycle_length, block_length=1):
+    """Maps `map_func` across this dataset, and interleaves the results.
+
+    For example, you can use `Dataset.interleave()` to process many input files
+    concurrently:
+
+    ```python
+    # Preprocess 4 files concurrently, and interleave blocks of 16 records from
+    # each file.
+    filenames = ["/var/data/file1.txt", "/var/data/file2.txt", ...]
+    dataset = (Dataset.from_tensor_slices(filenames)
+               .interleave(
+                   lambda x: TextLineDataset(x).map(parse_fn, num_threads=1),
+                   cycle_length=4, block_length=16))
+    ```
+
+    The `cycle_length` and `block_length` arguments control the order in which
+    elements are produced. `cycle_length` controls the number of input elements
+    that are processed concurrently. If you set `cycle_length` to 1, this
+    transformation will handle one input element at a time, and will produce
+    identical results to `tf.contrib.data.Dataset.flat_map`. In general,
+    this transformation will apply `map_func` to `cycle_length` input elements,
+    open iterators on the returned `Dataset` objects, and cycle through them
+    producing `block_length` consecutive elements from each iterator, and
+    consuming the next input element each time it reaches the end of an
+    iterator.
+
+    Args:
+      map_func: A function mapping a nested structure of tensors (having shapes
+        and types defined by `self.output_shapes` and `self.output_types`) to a
+        `Dataset`.
+      cycle_length: The number of elements from this dataset that will be
+        processed concurrently.
+      block_length: The number of consecutive elements to produce from each
+        input element before cycling to another input element.
+
+    Returns:
+      A `Dataset`.
+    """
+    return InterleaveDataset(self, map_func, cycle_length, block_length)
+
+  def parallel_interleave(self, map_func, cycle_length, block_length=1,
+                          sloppy=False):
+    """Like `Dataset.interleave()`, but reads the input elements in parallel.
+
+    Each of the `cycle_length` datasets returned by `map_func` is read on its
+    own background thread, and the next input elements are opened while the
+    current ones are being consumed. This is useful when reading each element
+    is latency-bound, e.g. when reading many sharded files from a remote file
+    system.
+
+    Args:
+      map_func: A function mapping a nested structure of tensors (having shapes
+        and types defined by `self.output_shapes` and `self.output_types`) to a
+        `Dataset`.
+      cycle_length: The number of elements from this dataset that will be
+        processed concurrently, and the number of threads used to do so.
+      block_length: The number of consecutive elements to produce from each
+        input element before cycling to another input element.
+      sloppy: If false (the default), the elements are produced in the same
+        deterministic order as `Dataset.interleave()`. If true, an input
+        element that has no output ready is skipped in favor of the next one
+        in the cycle that does, which improves throughput when the input
+        elements are read at uneven speeds.
+
+    Returns:
+      A `Dataset`.
+    """
+    return ParallelInterleaveDataset(self, map_func, cycle_length,
+                                     block_length, sloppy)
+
   def unbatch(self):
     """Splits elements of this dataset into sequences of consecutive elements.
 
@@ -1091,6 +1257,58 @@ class ShuffleDataset(Dataset):
     return self._input_dataset.output_types
 
 
+class CacheDataset(Dataset):
+  """A `Dataset` that caches elements of its input."""
+
+  def __init__(self, input_dataset, filename):
+    """See `Dataset.cache()` for details."""
+    super(CacheDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._filename = ops.convert_to_tensor(
+        filename, dtype=dtypes.string, name="filename")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.cache_dataset(
+        self._input_dataset.make_dataset_resource(),
+        filename=self._filename,
+        output_shapes=nest.flatten(self.output_shapes),
+        output_types=nest.flatten(self.output_types))
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+
+class PrefetchDataset(Dataset):
+  """A `Dataset` that asynchronously prefetches its input."""
+
+  def __init__(self, input_dataset, buffer_size):
+    """See `Dataset.prefetch()` for details."""
+    super(PrefetchDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.prefetch_dataset(
+        self._input_dataset.make_dataset_resource(),
+        buffer_size=self._buffer_size,
+        output_shapes=nest.flatten(self.output_shapes),
+        output_types=nest.flatten(self.output_types))
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+
 class TakeDataset(Dataset):
   """A `Dataset` containing the first `count` elements from its input."""
 
@@ -1477,6 +1695,105 @@ class MapDataset(Dataset):
     return self._output_types
 
 
+class MapAndBatchDataset(MapDataset):
+  """A `Dataset` that maps a function over its input and batches the results."""
+
+  def __init__(self, input_dataset, map_func, batch_size, num_threads):
+    """See `Dataset.map_and_batch()` for details."""
+    super(MapAndBatchDataset, self).__init__(input_dataset, map_func)
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._num_threads = ops.convert_to_tensor(
+        num_threads, dtype=dtypes.int32, name="num_threads")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.map_and_batch_dataset(
+        self._input_dataset.make_dataset_resource(),
+        self._map_func.captured_inputs,
+        f=self._map_func,
+        batch_size=self._batch_size,
+        num_threads=self._num_threads,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+  @property
+  def output_shapes(self):
+    return nest.pack_sequence_as(self._output_shapes, [
+        tensor_shape.vector(None).concatenate(s)
+        for s in nest.flatten(self._output_shapes)
+    ])
+
+
+class ParseExampleDataset(Dataset):
+  """A `Dataset` that parses batches of serialized `Example` protos."""
+
+  def __init__(self, input_dataset, features, num_threads):
+    """See `Dataset.parse_example()` for details."""
+    super(ParseExampleDataset, self).__init__()
+    self._input_dataset = input_dataset
+    if not features:
+      raise ValueError("Missing: features was %s." % features)
+    if (input_dataset.output_types != dtypes.string or
+        not input_dataset.output_shapes.is_compatible_with(
+            tensor_shape.vector(None))):
+      raise TypeError("Input dataset must produce vectors of serialized "
+                      "`Example` protos, but its elements have types %s and "
+                      "shapes %s." % (input_dataset.output_types,
+                                      input_dataset.output_shapes))
+    self._num_threads = ops.convert_to_tensor(
+        num_threads, dtype=dtypes.int32, name="num_threads")
+    # pylint: disable=protected-access
+    (self._sparse_keys, self._sparse_types, self._dense_keys, self._dense_types,
+     dense_defaults, dense_shapes) = parsing_ops._features_to_raw_params(
+         features, [parsing_ops.VarLenFeature, parsing_ops.FixedLenFeature])
+    # pylint: enable=protected-access
+    self._dense_shapes = [tensor_shape.as_shape(s) for s in dense_shapes]
+
+    self._dense_defaults = []
+    for key, dtype, shape in zip(self._dense_keys, self._dense_types,
+                                 self._dense_shapes):
+      default_value = dense_defaults.get(key)
+      if default_value is None:
+        default_value = constant_op.constant([], dtype=dtype)
+      elif not isinstance(default_value, ops.Tensor):
+        default_value = array_ops.reshape(
+            ops.convert_to_tensor(default_value, dtype=dtype), shape)
+      self._dense_defaults.append(default_value)
+
+    output_types = []
+    output_shapes = []
+    for dtype in self._sparse_types:
+      output_types.extend([dtypes.int64, dtype, dtypes.int64])
+      output_shapes.extend([tensor_shape.matrix(None, 2),
+                            tensor_shape.vector(None),
+                            tensor_shape.vector(2)])
+    for dtype, shape in zip(self._dense_types, self._dense_shapes):
+      output_types.append(dtype)
+      output_shapes.append(tensor_shape.vector(None).concatenate(shape))
+    self._output_types = tuple(output_types)
+    self._output_shapes = tuple(output_shapes)
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.parse_example_dataset(
+        self._input_dataset.make_dataset_resource(),
+        self._num_threads,
+        sparse_keys=self._sparse_keys,
+        dense_keys=self._dense_keys,
+        dense_defaults=self._dense_defaults,
+        sparse_types=self._sparse_types,
+        dense_shapes=[s.as_proto() for s in self._dense_shapes],
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+
 class FlatMapDataset(Dataset):
   """A `Dataset` that maps a function over its input and flattens the result."""
 
@@ -1529,6 +1846,52 @@ class FlatMapDataset(Dataset):
     return self._output_types
 
 
+class InterleaveDataset(FlatMapDataset):
+  """A `Dataset` that maps a function over its input and interleaves the result.
+  """
+
+  def __init__(self, input_dataset, map_func, cycle_length, block_length):
+    """See `Dataset.interleave()` for details."""
+    super(InterleaveDataset, self).__init__(input_dataset, map_func)
+    self._cycle_length = ops.convert_to_tensor(
+        cycle_length, dtype=dtypes.int64, name="cycle_length")
+    self._block_length = ops.convert_to_tensor(
+        block_length, dtype=dtypes.int64, name="block_length")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.interleave_dataset(
+        self._input_dataset.make_dataset_resource(),
+        self._map_func.captured_inputs,
+        self._cycle_length,
+        self._block_length,
+        f=self._map_func,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+
+class ParallelInterleaveDataset(InterleaveDataset):
+  """A `Dataset` that reads and interleaves its mapped inputs in parallel."""
+
+  def __init__(self, input_dataset, map_func, cycle_length, block_length,
+               sloppy):
+    """See `Dataset.parallel_interleave()` for details."""
+    super(ParallelInterleaveDataset, self).__init__(
+        input_dataset, map_func, cycle_length, block_length)
+    self._sloppy = ops.convert_to_tensor(
+        sloppy, dtype=dtypes.bool, name="sloppy")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.parallel_interleave_dataset(
+        self._input_dataset.make_dataset_resource(),
+        self._map_func.captured_inputs,
+        self._cycle_length,
+        self._block_length,
+        self._sloppy,
+        f=self._map_func,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+
 class FilterDataset(Dataset):
   """A `Dataset` that filters its input according to a predicate function."""
 
@@ -1581,18 +1944,25 @@ class FilterDataset(Dataset):
 class TextLineDataset(Dataset):
   """A `Dataset` comprising lines from one or more text files."""
 
-  def __init__(self, filenames):
+  def __init__(self, filenames, use_mmap=False):
     """Creates a `TextLineDataset`.
 
     Args:
       filenames: A `tf.string` tensor containing one or more filenames.
+      use_mmap: (Optional.) If `True`, read each file through a read-only
+        memory mapping when its file system supports one. This avoids
+        refilling a read buffer, which dominates the cost of reading short
+        lines from local files. A file must not be truncated while it is
+        being read.
     """
     super(TextLineDataset, self).__init__()
     self._filenames = ops.convert_to_tensor(
         filenames, dtype=dtypes.string, name="filenames")
+    self._use_mmap = use_mmap
 
   def make_dataset_resource(self):
-    return gen_dataset_ops.text_line_dataset(self._filenames)
+    return gen_dataset_ops.text_line_dataset(
+        self._filenames, use_mmap=self._use_mmap)
 
   @property
   def output_shapes(self):
@@ -1642,7 +2012,8 @@ class FixedLengthRecordDataset(Dataset):
                filenames,
                record_bytes,
                header_bytes=None,
-               footer_bytes=None):
+               footer_bytes=None,
+               use_mmap=False):
     """Creates a `FixedLengthRecordDataset`.
 
     Args:
@@ -1653,6 +2024,11 @@ class FixedLengthRecordDataset(Dataset):
         bytes to skip at the start of a file.
       footer_bytes: (Optional.) A `tf.int64` scalar representing the number of
         bytes to ignore at the end of a file.
+      use_mmap: (Optional.) If `True`, read each file through a read-only
+        memory mapping when its file system supports one. This avoids
+        refilling a read buffer, which dominates the cost of reading small
+        records from local files. A file must not be truncated while it is
+        being read.
     """
     super(FixedLengthRecordDataset, self).__init__()
     self._filenames = ops.convert_to_tensor(
@@ -1671,11 +2047,12 @@ class FixedLengthRecordDataset(Dataset):
     else:
       self._footer_bytes = constant_op.constant(
           0, dtype=dtypes.int64, name="footer_bytes")
+    self._use_mmap = use_mmap
 
   def make_dataset_resource(self):
     return gen_dataset_ops.fixed_length_record_dataset(
         self._filenames, self._header_bytes, self._record_bytes,
-        self._footer_bytes)
+        self._footer_bytes, use_mmap=self._use_mmap)
 
   @property
   def output_shapes(self):
@@ -1843,22 +2220,25 @@ def read_batch_features(file_pattern,
   if randomize_input:
     dataset = dataset.shuffle(capacity)
   dataset = dataset.batch(batch_size)
-  dataset = dataset.map(lambda x: _parse_example(x, features))
+  dataset = dataset.parse_example(features)
   iterator = dataset.make_one_shot_iterator()
   outputs = iterator.get_next()
+  # `Dataset.parse_example()` produces the sparse features before the dense
+  # features, each in sorted key order.
   index = 0
   result = {}
-  for key in sorted(features.keys()):
-    feature = features[key]
-    if isinstance(feature, parsing_ops.FixedLenFeature):
-      result[key] = outputs[index]
-      index += 1
-    else:
+  keys = sorted(features.keys())
+  for key in keys:
+    if isinstance(features[key], parsing_ops.VarLenFeature):
       result[key] = sparse_tensor_lib.SparseTensor(
           indices=outputs[index],
           values=outputs[index + 1],
           dense_shape=outputs[index + 2])
       index += 3
+  for key in keys:
+    if isinstance(features[key], parsing_ops.FixedLenFeature):
+      result[key] = outputs[index]
+      index += 1
   return result
 
 
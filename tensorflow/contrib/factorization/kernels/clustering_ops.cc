@@ -413,23 +413,25 @@ class NearestNeighborsOp : public OpKernel {
         nearest_center_indices(i, 0) = index;
       }
     } else {
-      // Select k nearest centers for each point.
+      // Select k nearest centers for each point. The selector and the
+      // extracted centers are reused across points, and once the selector
+      // holds k centers, farther centers are rejected with one comparison.
       using Center = std::pair<float, int64>;
       const int64 num_centers = centers.rows();
       gtl::TopN<Center, std::less<Center>> selector(k);
-      std::unique_ptr<std::vector<Center>> nearest_centers;
+      selector.reserve(num_centers);
+      std::vector<Center> nearest_centers;
       for (int i = 0; i < num_points; ++i) {
-        selector.reserve(num_centers);
         for (int j = 0; j < num_centers; ++j) {
           const float partial_distance =
               centers_half_squared_norm(j) - inner_product(i, j);
           selector.push(Center(partial_distance, j));
         }
-        nearest_centers.reset(selector.Extract());
+        selector.ExtractNondestructive(&nearest_centers);
         selector.Reset();
         const float point_half_squared_norm = points_half_squared_norm(i);
         for (int j = 0; j < k; ++j) {
-          const Center& center = (*nearest_centers)[j];
+          const Center& center = nearest_centers[j];
           nearest_center_distances(i, j) =
               2.0 * (point_half_squared_norm + center.first);
           nearest_center_indices(i, j) = center.second;
@@ -510,8 +512,11 @@ class NearestNeighborsOp : public OpKernel {
           }
           nearest_center_indices.row(i) = merged_indices;
           nearest_center_distances.row(i) = merged_distances;
-          out_k = std::min(k, out_k + block_k);
         }
+        // Every point now has this many valid nearest centers. This must not
+        // change while merging the points of one block, or the later points
+        // would read unset entries when k exceeds the block size.
+        out_k = std::min(k, out_k + block_k);
       }
     }
   }
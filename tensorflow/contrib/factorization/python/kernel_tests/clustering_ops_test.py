@@ -142,6 +142,31 @@ class NearestCentersLargeTest(test.TestCase):
           distances.eval(),
           self._expected_nearest_neighbor_squared_distances[:, 0:5])
 
+  def testNearestMoreThanCentersBlockSize(self):
+    # The centers are processed in blocks of at most 1024, so the results of
+    # the blocks are merged for k = 1500.
+    k = 1500
+    # The points are tiled, so only the distances of the first tile are needed.
+    points_per_tile = 10
+    squared_distances = np.tile(
+        np.sum(np.square(self._points[:points_per_tile, np.newaxis, :] -
+                         self._centers[np.newaxis, :, :]), axis=2),
+        (int(self._points.shape[0] / points_per_tile), 1))
+    with self.test_session():
+      [indices, distances] = clustering_ops.nearest_neighbors(self._points,
+                                                              self._centers, k)
+      indices, distances = indices.eval(), distances.eval()
+      self.assertAllClose(
+          distances, np.sort(squared_distances, axis=1)[:, :k],
+          rtol=1e-3, atol=1e-3)
+      # Each point gets k distinct centers, at the reported distances.
+      for row in indices:
+        self.assertEqual(k, len(np.unique(row)))
+      self.assertAllClose(
+          squared_distances[np.arange(indices.shape[0])[:, np.newaxis],
+                            indices],
+          distances, rtol=1e-3, atol=1e-3)
+
 
 if __name__ == "__main__":
   np.random.seed(0)
@@ -310,7 +310,8 @@ class MutableHashTable(LookupInterface):
                default_value,
                shared_name=None,
                name="MutableHashTable",
-               checkpoint=True):
+               checkpoint=True,
+               num_shards=1):
     """Creates an empty `MutableHashTable` object.
 
     Creates a table, the type of its keys and values are specified by key_dtype
@@ -326,6 +327,10 @@ class MutableHashTable(LookupInterface):
       checkpoint: if True, the contents of the table are saved to and restored
         from checkpoints. If `shared_name` is empty for a checkpointed table, it
         is shared using the table node name.
+      num_shards: The number of shards the table is split into, each with its
+        own lock. Lookups and inserts from concurrent steps only contend when
+        they touch the same shard, but a lookup may then see part of a
+        concurrent insert.
 
     Returns:
       A `MutableHashTable` object.
@@ -348,6 +353,7 @@ class MutableHashTable(LookupInterface):
           use_node_name_sharing=use_node_name_sharing,
           key_dtype=key_dtype,
           value_dtype=value_dtype,
+          num_shards=num_shards,
           name=name)
     else:
       self._table_ref = gen_lookup_ops._mutable_hash_table_of_tensors_v2(
@@ -356,6 +362,7 @@ class MutableHashTable(LookupInterface):
           key_dtype=key_dtype,
           value_dtype=value_dtype,
           value_shape=self._default_value.get_shape(),
+          num_shards=num_shards,
           name=name)
     # pylint: enable=protected-access
     super(MutableHashTable, self).__init__(key_dtype, value_dtype,
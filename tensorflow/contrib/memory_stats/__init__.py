@@ -14,11 +14,19 @@
 # ==============================================================================
 """Ops for memory statistics.
 
+@@BytesFree
 @@BytesLimit
+@@FreeBytesByBin
+@@LargestFreeBlock
+@@ManagedBytesInUse
 @@MaxBytesInUse
 """
 
+from tensorflow.contrib.memory_stats.python.ops.memory_stats_ops import BytesFree
 from tensorflow.contrib.memory_stats.python.ops.memory_stats_ops import BytesLimit
+from tensorflow.contrib.memory_stats.python.ops.memory_stats_ops import FreeBytesByBin
+from tensorflow.contrib.memory_stats.python.ops.memory_stats_ops import LargestFreeBlock
+from tensorflow.contrib.memory_stats.python.ops.memory_stats_ops import ManagedBytesInUse
 from tensorflow.contrib.memory_stats.python.ops.memory_stats_ops import MaxBytesInUse
 
 from tensorflow.python.util.all_util import remove_undocumented
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 
 namespace tensorflow {
@@ -76,4 +78,88 @@ REGISTER_KERNEL_BUILDER(
     Name("MaxBytesInUse").Device(DEVICE_GPU).HostMemory("out"),
     MaxBytesInUseOp);
 
+// Op that measures the free memory in bytes, within the memory reserved
+// by the allocator.
+class BytesFreeOp : public MemoryStatsOp {
+ public:
+  explicit BytesFreeOp(OpKernelConstruction* context)
+      : MemoryStatsOp(context) {}
+
+ private:
+  int64 ExtractAllocatorStats(
+      const AllocatorStats& allocator_stats) const override {
+    return allocator_stats.bytes_free;
+  }
+};
+
+// Op that measures the largest block that can be allocated without
+// reserving more memory. Compared to BytesFree, it measures the
+// fragmentation of the free memory.
+class LargestFreeBlockOp : public MemoryStatsOp {
+ public:
+  explicit LargestFreeBlockOp(OpKernelConstruction* context)
+      : MemoryStatsOp(context) {}
+
+ private:
+  int64 ExtractAllocatorStats(
+      const AllocatorStats& allocator_stats) const override {
+    return allocator_stats.largest_free_block_bytes;
+  }
+};
+
+// As MaxBytesInUse, the CPU allocators do not track free memory.
+REGISTER_KERNEL_BUILDER(Name("BytesFree").Device(DEVICE_GPU).HostMemory("out"),
+                        BytesFreeOp);
+REGISTER_KERNEL_BUILDER(
+    Name("LargestFreeBlock").Device(DEVICE_GPU).HostMemory("out"),
+    LargestFreeBlockOp);
+
+// Op that measures the memory in bytes that the allocator spilled to
+// memory the system may page out of the device, e.g. unified memory.
+class ManagedBytesInUseOp : public MemoryStatsOp {
+ public:
+  explicit ManagedBytesInUseOp(OpKernelConstruction* context)
+      : MemoryStatsOp(context) {}
+
+ private:
+  int64 ExtractAllocatorStats(
+      const AllocatorStats& allocator_stats) const override {
+    return allocator_stats.managed_bytes_in_use;
+  }
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ManagedBytesInUse").Device(DEVICE_GPU).HostMemory("out"),
+    ManagedBytesInUseOp);
+
+// Op that returns the histogram of the free memory by block size:
+// element i is the number of free bytes in blocks of [256 << i,
+// 256 << (i + 1)) bytes.
+class FreeBytesByBinOp : public OpKernel {
+ public:
+  explicit FreeBytesByBinOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    Allocator* allocator =
+        context->device()->GetAllocator(AllocatorAttributes());
+    AllocatorStats allocator_stats;
+    allocator->GetStats(&allocator_stats);
+    const std::vector<int64>& bins = allocator_stats.free_bytes_by_bin;
+
+    Tensor* output_tensor = nullptr;
+    const int64 num_bins = bins.size();
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({num_bins}), &output_tensor));
+    auto out = output_tensor->vec<int64>();
+    for (size_t i = 0; i < bins.size(); ++i) {
+      out(i) = bins[i];
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("FreeBytesByBin").Device(DEVICE_GPU).HostMemory("out"),
+    FreeBytesByBinOp);
+
 }  // namespace tensorflow
@@ -18,5 +18,9 @@ namespace tensorflow {
 
 REGISTER_OP("BytesLimit").Output("out: int64").SetIsStateful();
 REGISTER_OP("MaxBytesInUse").Output("out: int64").SetIsStateful();
+REGISTER_OP("BytesFree").Output("out: int64").SetIsStateful();
+REGISTER_OP("LargestFreeBlock").Output("out: int64").SetIsStateful();
+REGISTER_OP("FreeBytesByBin").Output("out: int64").SetIsStateful();
+REGISTER_OP("ManagedBytesInUse").Output("out: int64").SetIsStateful();
 
 }  // namespace tensorflow
@@ -68,6 +68,22 @@ class MemoryStatsOpsTest(test_util.TensorFlowTestCase):
       self.assertGreaterEqual(max_bytes_in_use, matrix_size_in_bytes * 3)
       self.assertLess(max_bytes_in_use, matrix_size_in_bytes * 4)
 
+  def testFragmentation(self):
+    # The free memory is only tracked on GPU. See kernels/memory_stats_ops.cc.
+    if not test.is_gpu_available():
+      return
+
+    with self.test_session(use_gpu=True) as sess:
+      a = random_ops.random_uniform([256, 256])
+      sess.run(math_ops.matmul(a, a))
+      bytes_free, largest_free_block, free_bytes_by_bin = sess.run([
+          memory_stats_ops.BytesFree(), memory_stats_ops.LargestFreeBlock(),
+          memory_stats_ops.FreeBytesByBin()
+      ])
+      self.assertLess(0, largest_free_block)
+      self.assertLessEqual(largest_free_block, bytes_free)
+      self.assertEqual(bytes_free, sum(free_bytes_by_bin))
+
 
 if __name__ == '__main__':
   test.main()
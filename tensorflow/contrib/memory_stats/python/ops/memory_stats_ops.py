@@ -34,3 +34,36 @@ def BytesLimit():
 def MaxBytesInUse():
   """Generates an op that computes the peak memory of a device."""
   return gen_memory_stats_ops.max_bytes_in_use()
+
+
+def BytesFree():
+  """Generates an op that computes the free memory reserved by a device."""
+  return gen_memory_stats_ops.bytes_free()
+
+
+def LargestFreeBlock():
+  """Generates an op that computes the largest free block of a device.
+
+  An allocation larger than this block needs the device to reserve more
+  memory, even if `BytesFree()` is larger.
+  """
+  return gen_memory_stats_ops.largest_free_block()
+
+
+def ManagedBytesInUse():
+  """Generates an op that computes the memory a device spilled to the host.
+
+  This is the memory in use in CUDA unified memory, which is only used if
+  `GPUOptions.allow_unified_memory_fallback` is set.
+  """
+  return gen_memory_stats_ops.managed_bytes_in_use()
+
+
+def FreeBytesByBin():
+  """Generates an op that computes the free memory of a device by size.
+
+  Element `i` of the result is the number of free bytes in blocks of
+  `[256 << i, 256 << (i + 1))` bytes, the last element also counting the
+  larger blocks.
+  """
+  return gen_memory_stats_ops.free_bytes_by_bin()
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -42,13 +43,35 @@ MPIRendezvousMgr::MPIRendezvousMgr(const WorkerEnv* env)
     use_optimal_transfer_ = true;
   }
 
+  int64 num_threads = 1;
+  Status s = ReadInt64FromEnvVar("MPI_PROGRESS_THREADS", 1, &num_threads);
+  if (!s.ok() || num_threads < 1) {
+    LOG(ERROR) << "Invalid MPI_PROGRESS_THREADS, using 1 thread: " << s;
+    num_threads = 1;
+  }
+
   // extract worker-name
   auto parsed = env->local_devices[0]->parsed_name();
   const std::string task_id = strings::StrCat(parsed.job, ":", parsed.replica);
 
-  mpiutils_ = new MPIUtils(task_id);
-  background_thread_ =
-      std::thread(&MPIRendezvousMgr::MPIBackgroundThread, this);
+  mpiutils_ = new MPIUtils(task_id, num_threads > 1);
+  if (num_threads > 1 && !mpiutils_->IsThreadMultiple()) {
+    LOG(WARNING) << "The MPI library does not support MPI_THREAD_MULTIPLE, "
+                    "using a single progress thread";
+    num_threads = 1;
+  }
+  if (use_optimal_transfer_ && mpiutils_->IsCUDAAware()) {
+    LOG(INFO) << "MPI CUDA Aware path enabled, GPU tensors are not staged "
+                 "through host memory";
+  }
+  MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &num_processes_));
+  for (int i = 0; i < num_threads; ++i) {
+    progress_queues_.emplace_back(new ProgressQueues);
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    background_threads_.emplace_back(&MPIRendezvousMgr::MPIBackgroundThread,
+                                     this, i);
+  }
 }
 
 BaseRemoteRendezvous* MPIRendezvousMgr::Create(int64 step_id,
@@ -79,24 +102,9 @@ void MPIRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  // Set properties of the request object and create the request function
+  // Set properties of the request object
   rendezvous_call->Init(parsed, step_id_);
 
-  std::function<void()> request_call = [parsed, dst, rendezvous_call]() {
-    // Use MPI_Alloc_mem here to force allocation inside MPI thread
-    // this is not optimal, but prevents memory corruption and segmentation
-    // faults during inter-server transfers...
-    MPI_CHECK(MPI_Alloc_mem(rendezvous_call->request_buffer_size_,
-                            MPI_INFO_NULL, &rendezvous_call->request_buffer_));
-    rendezvous_call->req_.SerializeToArray(
-        rendezvous_call->request_buffer_,
-        rendezvous_call->request_buffer_size_);
-    MPI_CHECK(MPI_Isend(rendezvous_call->request_buffer_,
-                        rendezvous_call->request_buffer_size_, MPI_CHAR, dst,
-                        TAG_REQTENSOR, MPI_COMM_WORLD,
-                        &rendezvous_call->mpi_request_));
-  };
-
   // Create the function which is called when the Tensor is send by remote
   const int64 temp1 = step_id_;
   rendezvous_call->recv_call_ =
@@ -118,14 +126,44 @@ void MPIRemoteRendezvous::RecvFromRemoteAsync(
       dst_device->MakeTensorFromProto(mpi_response.response().tensor(),
                                       recv_args.alloc_attrs, &val);
     } else {
+      // Without a CUDA Aware MPI library, data for GPU memory is received
+      // into pinned host memory and then copied to the GPU.
+      const bool stage_on_host = dst_device->tensorflow_gpu_device_info() &&
+                                 !recv_args.alloc_attrs.on_host() &&
+                                 !mpiutils_->IsCUDAAware();
+      AllocatorAttributes alloc_attrs = recv_args.alloc_attrs;
+      if (stage_on_host) {
+        alloc_attrs.set_on_host(true);
+        alloc_attrs.set_gpu_compatible(true);
+      }
       TensorResponse tr;
-      tr.InitAlloc(dst_device, recv_args.alloc_attrs);
+      tr.InitAlloc(dst_device, alloc_attrs);
       tr.InitPartial(mpi_response.response());
       const size_t nBytes = tr.tensor().TotalBytes();
       void* data = const_cast<void*>(DMAHelper::base(&tr.tensor()));
       MPI_Status status;
       MPI_CHECK(MPI_Recv(data, static_cast<int>(nBytes), MPI_BYTE, dst,
                          TAG_SENDTENSOR2, MPI_COMM_WORLD, &status));
+      if (stage_on_host) {
+        Tensor* host_tensor = new Tensor(std::move(tr.tensor()));
+        Tensor* gpu_tensor =
+            new Tensor(dst_device->GetAllocator(recv_args.alloc_attrs),
+                       host_tensor->dtype(), host_tensor->shape());
+        const DeviceContext* dst_dev_context =
+            recv_args.device_context
+                ? recv_args.device_context
+                : dst_device->tensorflow_gpu_device_info()->default_context;
+        const bool is_dead = mpi_response.response().is_dead();
+        GPUUtil::CopyCPUTensorToGPU(
+            host_tensor, dst_dev_context, dst_device, gpu_tensor,
+            [host_tensor, gpu_tensor, recv_args, done,
+             is_dead](const Status& s) {
+              done(s, Args(), recv_args, *gpu_tensor, is_dead);
+              delete host_tensor;
+              delete gpu_tensor;
+            });
+        return;
+      }
       val = std::move(tr.tensor());
     }
 
@@ -134,8 +172,8 @@ void MPIRemoteRendezvous::RecvFromRemoteAsync(
 
   MPIRendezvousMgr* mgr =
       reinterpret_cast<MPIRendezvousMgr*>(this->rendezvous_mgr_);
-  mgr->QueueRequest(parsed.FullKey().ToString(), step_id_,
-                    std::move(request_call), rendezvous_call);
+  mgr->QueueRequest(parsed.FullKey().ToString(), step_id_, dst,
+                    rendezvous_call);
 }
 
 MPIRemoteRendezvous::~MPIRemoteRendezvous() {
@@ -180,10 +218,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
       const int tensor_size = static_cast<int>(val.TotalBytes());
       void* temp = const_cast<void*>(DMAHelper::base(&val));
 
-      // If the MPI library is not GPU aware there should be a data transfer
-      // here to get the data on the host.
-      // if(src_dev->tensorflow_gpu_device_info()) //memcpy to send_buffer2_
-
+      // GPU tensors only take this path with a CUDA Aware MPI library.
       // TODO(jbedorf)  this should be a loop over max size
       MPI_CHECK(MPI_Isend(temp, tensor_size, MPI_CHAR, mpi_dst, TAG_SENDTENSOR2,
                           MPI_COMM_WORLD, &mpi_send_call->msg2_));
@@ -193,7 +228,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
   };
 
   // Wrapper around the read callback to place the callback on our queue
-  Rendezvous::DoneCallback done_cb = [this, parsed, step_id, send_cb](
+  Rendezvous::DoneCallback done_cb = [this, parsed, step_id, send_cb, mpi_dst](
       const Status& status, const Rendezvous::Args& send_args,
       const Rendezvous::Args& recv_args, const Tensor& val, bool is_dead) {
     if (!status.ok()) {
@@ -216,12 +251,24 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
 
     // Control if shape and data should be send together or if we can optimize
     // it in two different transfers, thereby reducing memory copies
+    const bool on_gpu = src_dev->tensorflow_gpu_device_info() &&
+                        (!send_args.alloc_attrs.on_host());
     bool doOptimalTransfer = true;
     if (!DataTypeCanUseMemcpy(val.dtype())) doOptimalTransfer = false;
     if (val.TotalBytes() < 1024) doOptimalTransfer = false;
+    // Without a CUDA Aware MPI library, GPU tensors are staged through host
+    // memory in the TensorProto.
+    if (on_gpu && !mpiutils_->IsCUDAAware()) doOptimalTransfer = false;
 
     doOptimalTransfer = doOptimalTransfer && use_optimal_transfer_;
 
+    if (doOptimalTransfer && on_gpu) {
+      // MPI reads the tensor from GPU memory, once the kernels that produce
+      // it have run.
+      s = GPUUtil::Sync(src_dev);
+      CHECK(s.ok()) << "GPU sync failed: " << s.error_message();
+    }
+
     if (doOptimalTransfer) {
       // First send the Tensor description and in a follow up transfer the data
       mpi_send_call->mRes_.mutable_response()->mutable_tensor()->set_dtype(
@@ -232,8 +279,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
       mpi_send_call->mRes_.set_singlesend(false);
     } else {
       // Send the Tensor description and data in a single transfer
-      if (src_dev->tensorflow_gpu_device_info() &&
-          (!send_args.alloc_attrs.on_host())) {
+      if (on_gpu) {
         Notification n;
         GPUUtil::SetProtoFromGPU(
             val, src_dev, send_args.device_context,
@@ -254,7 +300,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
 
     SendQueueEntry req(parsed.FullKey().ToString().c_str(), std::move(res));
 
-    this->QueueSendRequest(req);
+    this->QueueSendRequest(mpi_dst, req);
 
     // Wait for the notification that indicates the tensor has been
     // successfully transmitted to the remote process. Only needed if we
@@ -267,43 +313,74 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
   });
 }
 
-void MPIRendezvousMgr::MPIBackgroundThread() {
+void MPIRendezvousMgr::MPIBackgroundThread(const int index) {
   std::list<std::unique_ptr<MPISendTensorCall>> active_sends;
+  std::list<std::unique_ptr<MPIRequestTensorBatch>> active_requests;
+  ProgressQueues* queues = progress_queues_[index].get();
+
+  // The processes whose tensors this thread receives
+  std::vector<int> sources;
+  const int num_threads = progress_queues_.size();
+  if (num_threads == 1) {
+    sources.push_back(MPI_ANY_SOURCE);
+  } else {
+    for (int rank = index; rank < num_processes_; rank += num_threads) {
+      sources.push_back(rank);
+    }
+  }
 
   while (1) {
     MPI_Status status;
 
-    // Check for incoming Tensor requests
-    RecvTensorRequest request;
-    if (ProbeForData(TAG_REQTENSOR, &status, &request)) {
-      this->AddRequest(request, status.MPI_SOURCE);
+    // Check for incoming Tensor requests, which any thread can handle
+    MPIRecvTensorRequests requests;
+    if (ProbeForData(TAG_REQTENSOR, MPI_ANY_SOURCE, &status, &requests)) {
+      for (const RecvTensorRequest& request : requests.request()) {
+        this->AddRequest(request, status.MPI_SOURCE);
+      }
     }
 
     // Check for incoming Tensor reply
-    MPIRecvTensorResponse mRes;
-    if (ProbeForData(TAG_SENDTENSOR, &status, &mRes)) {
-      const int64 step_id = mRes.step_id();
-      std::string key = mRes.key();
-
-      std::shared_ptr<MPIRequestTensorCall> call;
-      GetRecvCall(step_id, key, &call);
-      call->recv_call_(mRes);
-      RemoveRecvCall(step_id, key);
+    for (const int source : sources) {
+      MPIRecvTensorResponse mRes;
+      if (ProbeForData(TAG_SENDTENSOR, source, &status, &mRes)) {
+        const int64 step_id = mRes.step_id();
+        std::string key = mRes.key();
+
+        std::shared_ptr<MPIRequestTensorCall> call;
+        GetRecvCall(step_id, key, &call);
+        call->recv_call_(mRes);
+        RemoveRecvCall(step_id, key);
+      }
     }
 
     // Remove sends that have been completed
     active_sends.remove_if([](std::unique_ptr<MPISendTensorCall>& i) {
       return i->IsFinished();
     });
+    active_requests.remove_if([](std::unique_ptr<MPIRequestTensorBatch>& i) {
+      return i->IsFinished();
+    });
 
-    // send a Tensor request
-    RequestQueueEntry req;
-    if (GetRequest(&req)) req.second();
+    std::map<int, MPIRecvTensorRequests> pending_requests;
+    std::queue<SendQueueEntry> pending_sends;
+    {
+      mutex_lock l(queues->mu);
+      pending_requests.swap(queues->requests);
+      pending_sends.swap(queues->sends);
+    }
+
+    // Send the Tensor requests, one message per process
+    for (const auto& dst_and_requests : pending_requests) {
+      std::unique_ptr<MPIRequestTensorBatch> p(new MPIRequestTensorBatch);
+      p->Send(dst_and_requests.second, dst_and_requests.first);
+      active_requests.push_back(std::move(p));
+    }
 
-    // Send a Tensor response
-    SendQueueEntry send;
-    if (GetResponse(&send)) {
-      std::unique_ptr<MPISendTensorCall> p(send.second());
+    // Send the Tensor responses
+    while (!pending_sends.empty()) {
+      std::unique_ptr<MPISendTensorCall> p(pending_sends.front().second());
+      pending_sends.pop();
       active_sends.push_back(std::move(p));
     }
 
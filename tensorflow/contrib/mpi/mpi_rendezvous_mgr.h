@@ -89,25 +89,49 @@ class MPIRequestTensorCall {
  public:
   Rendezvous::DoneCallback done_;
   RecvTensorRequest req_;
-  MPI_Request mpi_request_;
-  char* request_buffer_;
-  size_t request_buffer_size_;
   std::function<void(MPIRecvTensorResponse)> recv_call_;
 
-  MPIRequestTensorCall() : request_buffer_(nullptr) {}
-  ~MPIRequestTensorCall() {
+  void Init(const Rendezvous::ParsedKey& parsed, const int64 step_id) {
+    req_.set_step_id(step_id);
+    req_.set_rendezvous_key(parsed.FullKey().data(), parsed.FullKey().size());
+  }
+};
+
+// The tensor requests for one remote process that were queued since its
+// progress thread last sent any, coalesced into a single message.
+class MPIRequestTensorBatch {
+ public:
+  MPIRequestTensorBatch() : request_buffer_(nullptr), done_(0) {}
+
+  ~MPIRequestTensorBatch() {
     MPI_CHECK(MPI_Wait(&mpi_request_, MPI_STATUS_IGNORE));
-    // delete[] request_buffer_;
     MPI_CHECK(MPI_Free_mem(request_buffer_));
   }
 
-  void Init(const Rendezvous::ParsedKey& parsed, const int64 step_id) {
-    req_.set_step_id(step_id);
-    req_.set_rendezvous_key(parsed.FullKey().data(), parsed.FullKey().size());
-    request_buffer_size_ = req_.ByteSize();
-    //   request_buffer_ = new char[request_buffer_size_];
-    //  req_.SerializeToArray(request_buffer_, request_buffer_size_);
+  MPIRequestTensorBatch(MPIRequestTensorBatch&&) = delete;
+
+  void Send(const MPIRecvTensorRequests& requests, const int dst) {
+    const int request_buffer_size = requests.ByteSize();
+    // Use MPI_Alloc_mem here to force allocation inside MPI thread
+    // this is not optimal, but prevents memory corruption and segmentation
+    // faults during inter-server transfers...
+    MPI_CHECK(MPI_Alloc_mem(request_buffer_size, MPI_INFO_NULL,
+                            &request_buffer_));
+    requests.SerializeToArray(request_buffer_, request_buffer_size);
+    MPI_CHECK(MPI_Isend(request_buffer_, request_buffer_size, MPI_CHAR, dst,
+                        TAG_REQTENSOR, MPI_COMM_WORLD, &mpi_request_));
+  }
+
+  bool IsFinished() {
+    MPI_Status status;
+    if (!done_) MPI_CHECK(MPI_Test(&mpi_request_, &done_, &status));
+    return done_;
   }
+
+ private:
+  char* request_buffer_;
+  MPI_Request mpi_request_;
+  int done_;  // Int instead of bool for simpler IsFinished logic
 };
 
 class MPIRemoteRendezvous : public BaseRemoteRendezvous {
@@ -138,17 +162,20 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
   ~MPIRendezvousMgr() {
     delete mpiutils_;
     fprintf(stderr, "Delete MPIRendezvousMgr \n");
-    // TODO(jbedorf) stop background_thread_
+    // TODO(jbedorf) stop background_threads_
     MPI_CHECK(MPI_Finalize());
   }
 
-  void QueueRequest(std::string key, int64 step_id,
-                    std::function<void()> request_call,
+  void QueueRequest(std::string key, int64 step_id, const int dst,
                     MPIRequestTensorCall* rCall) {
-    mutex_lock l(mrq_);
-    request_queue_.push(RequestQueueEntry(key, std::move(request_call)));
-    recv_tensor_map_[step_id][key] =
-        std::shared_ptr<MPIRequestTensorCall>(rCall);
+    {
+      mutex_lock l(mrq_);
+      recv_tensor_map_[step_id][key] =
+          std::shared_ptr<MPIRequestTensorCall>(rCall);
+    }
+    ProgressQueues* queues = QueuesFor(dst);
+    mutex_lock l(queues->mu);
+    *queues->requests[dst].add_request() = rCall->req_;
   }
 
   void RemoveStepID(const int64 step_id) {
@@ -167,30 +194,44 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
       const Status&, const Rendezvous::Args&, const Rendezvous::Args&,
       const Tensor&, const bool, MPISendTensorCall*)> MPIRecvTensorCallBack;
 
-  typedef std::pair<std::string, std::function<void()>> RequestQueueEntry;
   typedef std::pair<std::string, std::function<MPISendTensorCall*()>>
       SendQueueEntry;
 
+  // The work of one progress thread. A thread serves the remote processes
+  // whose rank modulo the number of threads is its index, so that the
+  // description and the data of a tensor sent in two transfers are never
+  // interleaved with those of another tensor from a different thread.
+  struct ProgressQueues {
+    mutex mu;
+    // The tensor requests that have not been sent yet, by destination.
+    std::map<int, MPIRecvTensorRequests> requests GUARDED_BY(mu);
+    std::queue<SendQueueEntry> sends GUARDED_BY(mu);
+  };
+
   const WorkerEnv* worker_env_2;
-  std::thread background_thread_;
+  std::vector<std::thread> background_threads_;
   MPIUtils* mpiutils_;
   bool use_optimal_transfer_;
+  int num_processes_;
+  std::vector<std::unique_ptr<ProgressQueues>> progress_queues_;
 
-  mutex msq_;
   mutex mrq_;
 
-  std::queue<SendQueueEntry> send_queue_ GUARDED_BY(msq_);
-  std::queue<RequestQueueEntry> request_queue_ GUARDED_BY(mrq_);
   std::map<int64, std::unordered_map<std::string,
                                      std::shared_ptr<MPIRequestTensorCall>>>
       recv_tensor_map_ GUARDED_BY(mrq_);
 
   void AddRequest(RecvTensorRequest, const int);
-  void MPIBackgroundThread();
+  void MPIBackgroundThread(const int index);
+
+  ProgressQueues* QueuesFor(const int rank) {
+    return progress_queues_[rank % progress_queues_.size()].get();
+  }
 
-  void QueueSendRequest(SendQueueEntry req) {
-    mutex_lock l(msq_);
-    send_queue_.push(req);
+  void QueueSendRequest(const int dst, SendQueueEntry req) {
+    ProgressQueues* queues = QueuesFor(dst);
+    mutex_lock l(queues->mu);
+    queues->sends.push(req);
   }
 
   void GetRecvCall(const int64 step_id, const std::string& key,
@@ -214,33 +255,13 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
     recv_tensor_map_[step_id].erase(key);
   }
 
-  bool GetRequest(RequestQueueEntry* req) {
-    mutex_lock l(mrq_);
-    if (!request_queue_.empty()) {
-      *req = request_queue_.front();
-      request_queue_.pop();
-      return true;
-    }
-    return false;
-  }
-
-  bool GetResponse(SendQueueEntry* send) {
-    mutex_lock l(msq_);
-    if (!send_queue_.empty()) {
-      *send = send_queue_.front();
-      send_queue_.pop();
-      return true;
-    }
-    return false;
-  }
-
   template <typename T>
-  int ProbeForData(const int tag, MPI_Status* status, T* obj) {
+  int ProbeForData(const int tag, const int source, MPI_Status* status,
+                   T* obj) {
     int flag = 0, msg_size = 0;
     MPI_Message msg;
     // Receive the message, probe as size is variable
-    MPI_CHECK(
-        MPI_Improbe(MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, &flag, &msg, status));
+    MPI_CHECK(MPI_Improbe(source, tag, MPI_COMM_WORLD, &flag, &msg, status));
     if (flag) {
       MPI_CHECK(MPI_Get_count(status, MPI_CHAR, &msg_size));
       MPI_Status stat2;
@@ -20,8 +20,13 @@ namespace tensorflow {
 
 #define max_worker_name_length 128
 
-MPIUtils::MPIUtils(const std::string& worker_name) {
-  InitMPI();
+MPIUtils::MPIUtils(const std::string& worker_name, bool thread_multiple) {
+  InitMPI(thread_multiple);
+  // The MPI standard has no way to query whether the library accepts
+  // pointers to GPU memory (CUDA Aware), so it is declared by the user.
+  const char* cuda_aware_env = getenv("MPI_CUDA_AWARE");
+  cuda_aware_ = cuda_aware_env && cuda_aware_env[0] == '1';
+
   // Connect the MPI process IDs to the worker names that are used by TF.
   // Gather the names of all the active processes (name can't be longer than
   // 128 bytes)
@@ -48,15 +53,19 @@ MPIUtils::MPIUtils(const std::string& worker_name) {
   }
 }
 
-void MPIUtils::InitMPI() {
+void MPIUtils::InitMPI(bool thread_multiple) {
   // Initialize the MPI environment if that hasn't been done
   int flag = 0;
+  int provided = MPI_THREAD_SINGLE;
   MPI_CHECK(MPI_Initialized(&flag));
   if (!flag) {
     int proc_id = 0, number_of_procs = 1, len = -1;
     char my_host_name[max_worker_name_length];
-    // MPI_CHECK(MPI_Init_thread(0, 0, MPI_THREAD_MULTIPLE, &flag));
-    MPI_CHECK(MPI_Init(0, 0));
+    if (thread_multiple) {
+      MPI_CHECK(MPI_Init_thread(0, 0, MPI_THREAD_MULTIPLE, &provided));
+    } else {
+      MPI_CHECK(MPI_Init(0, 0));
+    }
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &proc_id));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &number_of_procs));
     MPI_CHECK(MPI_Get_processor_name(my_host_name, &len));
@@ -64,7 +73,10 @@ void MPIUtils::InitMPI() {
             "MPI Environment initialised. Process id: %d Total processes: %d "
             "|| Hostname: %s \n",
             proc_id, number_of_procs, my_host_name);
+  } else {
+    MPI_CHECK(MPI_Query_thread(&provided));
   }
+  thread_multiple_ = provided == MPI_THREAD_MULTIPLE;
 }
 
 }  // namespace tensorflow
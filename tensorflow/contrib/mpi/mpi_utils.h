@@ -39,7 +39,9 @@ limitations under the License.
 namespace tensorflow {
 class MPIUtils {
  public:
-  explicit MPIUtils(const std::string& worker_name);
+  // Initializes MPI, with support for calls from several threads at once
+  // if "thread_multiple" is true.
+  MPIUtils(const std::string& worker_name, bool thread_multiple);
 
   const int GetSourceID(const std::string& task_id) const {
     auto it = name_to_id_.find(task_id);
@@ -49,10 +51,19 @@ class MPIUtils {
     return it->second;
   }
 
+  // Whether MPI may be called from several threads at once.
+  bool IsThreadMultiple() const { return thread_multiple_; }
+
+  // Whether the MPI library can send from and receive into GPU memory, as
+  // declared by MPI_CUDA_AWARE=1.
+  bool IsCUDAAware() const { return cuda_aware_; }
+
  private:
-  void InitMPI();
+  void InitMPI(bool thread_multiple);
 
   std::map<std::string, int> name_to_id_;
+  bool thread_multiple_ = false;
+  bool cuda_aware_ = false;
 };
 }  // namespace tensorflow
 
@@ -19,6 +19,8 @@
 @@all_prod
 @@all_sum
 @@broadcast
+@@bucketed_all_sum
+@@sum_tower_gradients
 
 """
 
@@ -31,6 +33,8 @@ from tensorflow.contrib.nccl.python.ops.nccl_ops import all_min
 from tensorflow.contrib.nccl.python.ops.nccl_ops import all_prod
 from tensorflow.contrib.nccl.python.ops.nccl_ops import all_sum
 from tensorflow.contrib.nccl.python.ops.nccl_ops import broadcast
+from tensorflow.contrib.nccl.python.ops.nccl_ops import bucketed_all_sum
+from tensorflow.contrib.nccl.python.ops.nccl_ops import sum_tower_gradients
 
 from tensorflow.python.util.all_util import remove_undocumented
 remove_undocumented(__name__)
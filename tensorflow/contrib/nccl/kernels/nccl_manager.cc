@@ -433,27 +433,29 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
       }
     }
 
-    // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, rank, nccl_result]() {
-      if (nccl_result == ncclSuccess) {
-        collective->participants[rank]->done_callback(Status::OK());
-      } else {
-        // Propagate the error, but note that if other members of the collective
-        // did launch their kernels, then they are hanging.
-        collective->participants[rank]->done_callback(errors::Unknown(
-            "Error invoking AllReduce: ", ncclGetErrorString(nccl_result)));
-      }
+    // Make the tensor stream wait for the nccl kernel on the device, instead
+    // of waiting for the kernel on the host: the next kernel launched on the
+    // tensor stream sees the output, and the input is not reused before the
+    // nccl kernel has read it, as the allocator orders reuse on the tensor
+    // stream. So the participant is done as soon as the kernel is queued.
+    if (nccl_result == ncclSuccess) {
+      p->tensor_stream->ThenWaitFor(comm_stream);
+      p->done_callback(Status::OK());
+    } else {
+      // Propagate the error, but note that if other members of the collective
+      // did launch their kernels, then they are hanging.
+      p->done_callback(errors::Unknown("Error invoking AllReduce: ",
+                                       ncclGetErrorString(nccl_result)));
+    }
 
-      // TODO(cwhipkey): use RefCounted after figuring out how to use in a
-      // custom op library.
-      // See tensorflow/core/lib/core/refcount.h for details on this locking.
-      if (collective->remaining_participants.load(std::memory_order_acquire) ==
-              1 ||
-          collective->remaining_participants.fetch_sub(1) == 1) {
-        delete collective;
-      }
-    };
-    p->event_mgr->ThenExecute(comm_stream, done_callback);
+    // TODO(cwhipkey): use RefCounted after figuring out how to use in a
+    // custom op library.
+    // See tensorflow/core/lib/core/refcount.h for details on this locking.
+    if (collective->remaining_participants.load(std::memory_order_acquire) ==
+            1 ||
+        collective->remaining_participants.fetch_sub(1) == 1) {
+      delete collective;
+    }
   }
 }
 
@@ -46,14 +46,15 @@ class NcclManager {
   // participant is managed by <executor>, and its events are polled by
   // <event_mgr>.
   //
-  // This is an asynchronous call. When <done_callback> is called, <out_t> has
-  // been set to the all-reduce result (note: the stream may not yet have been
-  // synced).
+  // This is an asynchronous call. <done_callback> is called once the nccl
+  // kernel has been queued on the communication stream, without waiting for
+  // it to finish.
   //
   // <tensor_stream> is the stream that should be waited on to ensure <in_t>'s
   // data is available on the GPU for the communication stream to access. It
-  // is also the stream that will use the produced data; <done_callback> is
-  // not called until the next kernel launched on <stream> would see the data.
+  // is also the stream that will use the produced data; before
+  // <done_callback> is called, <tensor_stream> is made to wait for the nccl
+  // kernel, so the next kernel launched on it would see the data.
   void AddToAllReduce(int num_devices, const string& key,
                       ncclRedOp_t reduction_op,
                       perftools::gputools::StreamExecutor* executor,
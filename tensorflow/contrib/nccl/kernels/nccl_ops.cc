@@ -31,11 +31,13 @@ namespace tensorflow {
 // 2. For input tensors to the communicator, the compute stream is passed to the
 //    NcclManager which will do a needed
 //    communicator_stream.ThenWaitFor(input_tensor_stream).
-// 3. The done_callback of the async kernel is not called by the
-//    NcclManager until after the communicator kernel is complete. This
-//    is enough to a) keep the input tensor data valid for the lifetime of the
-//    collective; and b) ensure the data in the output tensor is available
-//    when the async op kernel's done callback is called.
+// 3. Once the communicator kernel is queued, the NcclManager does a
+//    input_tensor_stream.ThenWaitFor(communicator_stream) and calls the
+//    done_callback of the async kernel, without waiting for the kernel on the
+//    host. This is enough to a) keep the input tensor data valid for the
+//    lifetime of the collective, since its memory is only reused by work
+//    ordered after the compute stream; and b) ensure the data in the output
+//    tensor is available to every kernel that consumes it.
 class NcclAsyncOpBase : public AsyncOpKernel {
  public:
   explicit NcclAsyncOpBase(OpKernelConstruction* c) : AsyncOpKernel(c) {
@@ -30,6 +30,8 @@ from tensorflow.python.platform import resource_loader
 _nccl_ops_so = loader.load_op_library(
     resource_loader.get_path_to_datafile('_nccl_ops.so'))
 
+_DEFAULT_BUCKET_BYTES = 4 * 1024 * 1024
+
 
 def all_sum(tensors):
   """Returns a list of tensors with the all-reduce sum across `tensors`.
@@ -137,6 +139,131 @@ def broadcast(src_tensor, dst_devices):
   return send, recvs
 
 
+def bucketed_all_sum(per_device_tensors, bucket_bytes=_DEFAULT_BUCKET_BYTES):
+  """Sums lists of tensors across devices, fusing small tensors into buckets.
+
+  Every all-reduce is a collective with a fixed launch and synchronization
+  cost, which dominates for small tensors such as biases. This packs runs of
+  tensors of the same dtype into flat buckets of at most `bucket_bytes`, sums
+  each bucket with a single `all_sum` and unpacks the results. Tensors that
+  are larger than `bucket_bytes`, or whose shape is not fully defined, are
+  summed on their own.
+
+  As with `all_sum`, if only some of the returned tensors are evaluated then
+  the computation will hang.
+
+  Args:
+    per_device_tensors: A list with one list of tensors per device. The i-th
+      tensors of all the lists are summed together, so they must have the same
+      dtype and shape. Each tensor must be assigned to a GPU device.
+    bucket_bytes: The maximum size in bytes of a bucket of fused tensors.
+
+  Returns:
+    A list with one list of tensors per device, where tensor i of list d is
+    the sum of the i-th tensors and has the same device as
+    `per_device_tensors[d][i]`.
+  """
+  if not per_device_tensors:
+    raise ValueError('Must pass >0 tensor lists to bucketed_all_sum')
+  num_tensors = len(per_device_tensors[0])
+  if any(len(tensors) != num_tensors for tensors in per_device_tensors):
+    raise ValueError('All tensor lists must have the same length')
+
+  res = [[None] * num_tensors for _ in per_device_tensors]
+
+  def sum_bucket(bucket):
+    if len(bucket) == 1:
+      i = bucket[0]
+      for d, t in enumerate(all_sum([ts[i] for ts in per_device_tensors])):
+        res[d][i] = t
+      return
+    shapes = [per_device_tensors[0][i].get_shape() for i in bucket]
+    sizes = [shape.num_elements() for shape in shapes]
+    flat_tensors = []
+    for tensors in per_device_tensors:
+      with ops.device(tensors[bucket[0]].device):
+        flat_tensors.append(
+            array_ops.concat(
+                [array_ops.reshape(tensors[i], [-1]) for i in bucket], 0))
+    for d, summed in enumerate(all_sum(flat_tensors)):
+      with ops.device(summed.device):
+        parts = array_ops.split(summed, sizes)
+        for i, shape, part in zip(bucket, shapes, parts):
+          res[d][i] = array_ops.reshape(part, shape)
+
+  bucket = []
+  bucket_dtype = None
+  bucket_size = 0
+  for i, t in enumerate(per_device_tensors[0]):
+    shape = t.get_shape()
+    size = None
+    if shape.is_fully_defined():
+      size = shape.num_elements() * t.dtype.size
+    if size is None or size >= bucket_bytes:
+      sum_bucket([i])
+      continue
+    if bucket and (t.dtype != bucket_dtype or
+                   bucket_size + size > bucket_bytes):
+      sum_bucket(bucket)
+      bucket = []
+      bucket_size = 0
+    bucket.append(i)
+    bucket_dtype = t.dtype
+    bucket_size += size
+  if bucket:
+    sum_bucket(bucket)
+  return res
+
+
+def sum_tower_gradients(tower_grads_and_vars,
+                        bucket_bytes=_DEFAULT_BUCKET_BYTES):
+  """Sums gradients across towers, for synchronous data parallel training.
+
+  This replaces copying the gradients of all towers to one device and adding
+  them with `add_n`: the sums are computed with `bucketed_all_sum`, directly
+  between the GPUs, and every tower gets them on its own device.
+
+  Args:
+    tower_grads_and_vars: A list with one list of `(gradient, variable)` pairs
+      per tower, as returned by `Optimizer.compute_gradients`, with the pairs
+      in the same order in every tower. A gradient that is `None` in one tower
+      must be `None` in all of them. `IndexedSlices` gradients are converted
+      to dense tensors.
+    bucket_bytes: The maximum size in bytes of a bucket of fused gradients.
+
+  Returns:
+    A list with one list of `(gradient, variable)` pairs per tower, where each
+    gradient is the sum over the towers.
+  """
+  if not tower_grads_and_vars:
+    raise ValueError('Must pass >0 towers to sum_tower_gradients')
+  first_tower = tower_grads_and_vars[0]
+  indices = [i for i, (g, _) in enumerate(first_tower) if g is not None]
+  per_tower_grads = []
+  for grads_and_vars in tower_grads_and_vars:
+    if len(grads_and_vars) != len(first_tower):
+      raise ValueError('All towers must have the same number of gradients')
+    if [i for i, (g, _) in enumerate(grads_and_vars) if g is not None
+       ] != indices:
+      raise ValueError('A gradient that is None in one tower must be None in '
+                       'all towers')
+    grads = []
+    for i in indices:
+      g = grads_and_vars[i][0]
+      with ops.device(g.device):
+        grads.append(ops.convert_to_tensor(g))
+    per_tower_grads.append(grads)
+
+  summed = bucketed_all_sum(per_tower_grads, bucket_bytes=bucket_bytes)
+  res = []
+  for grads_and_vars, grads in zip(tower_grads_and_vars, summed):
+    summed_grads_and_vars = list(grads_and_vars)
+    for i, g in zip(indices, grads):
+      summed_grads_and_vars[i] = (g, grads_and_vars[i][1])
+    res.append(summed_grads_and_vars)
+  return res
+
+
 def _apply_all_reduce(reduction_op, tensors):
   if not tensors:
     raise ValueError('Must pass >0 tensors to all reduce operations')
@@ -147,5 +147,72 @@ class CombinedTest(test.TestCase):
             self.assertAllClose(r, np_ans)
 
 
+class BucketedAllSumTest(test.TestCase):
+
+  def testBucketedAllSum(self):
+    if not test.is_gpu_available():
+      return  # Test requires access to a GPU
+
+    # With 64 byte buckets, the float32 tensors are fused in twos, the int64
+    # one breaks the bucket, and the large one is summed on its own.
+    shapes_and_dtypes = [((3, 4), np.float32), ((2,), np.float32),
+                         ((5,), np.int64), ((4, 2), np.float32),
+                         ((7,), np.float32), ((100,), np.float32)]
+    with self.test_session(use_gpu=True) as sess:
+      for devices in [['/gpu:0', '/gpu:0', '/gpu:0'], ['/gpu:0', '/gpu:0']]:
+        np_ans = [np.zeros(s, dtype=t) for s, t in shapes_and_dtypes]
+        per_device_tensors = []
+        for d in devices:
+          tensors = []
+          with ops.device(d):
+            for i, (shape, dtype) in enumerate(shapes_and_dtypes):
+              t = ((np.random.random_sample(shape) - .5) * 1024).astype(dtype)
+              np_ans[i] += t
+              tensors.append(array_ops.identity(t))
+          per_device_tensors.append(tensors)
+        summed = nccl.bucketed_all_sum(per_device_tensors, bucket_bytes=64)
+
+        for tensors in summed:
+          for (shape, _), t in zip(shapes_and_dtypes, tensors):
+            self.assertEqual(shape, t.get_shape())
+        for tensors in sess.run(summed):
+          for ans, t in zip(np_ans, tensors):
+            self.assertAllClose(ans, t)
+
+  def testSumTowerGradients(self):
+    if not test.is_gpu_available():
+      return  # Test requires access to a GPU
+
+    with self.test_session(use_gpu=True) as sess:
+      devices = ['/gpu:0', '/gpu:0']
+      np_ans = [np.zeros((3,), np.float32), np.zeros((2, 2), np.float32)]
+      tower_grads_and_vars = []
+      for d in devices:
+        with ops.device(d):
+          g0 = np.random.random_sample((3,)).astype(np.float32)
+          g2 = np.random.random_sample((2, 2)).astype(np.float32)
+          np_ans[0] += g0
+          np_ans[1] += g2
+          tower_grads_and_vars.append([(array_ops.identity(g0), 'v0'),
+                                       (None, 'v1'),
+                                       (array_ops.identity(g2), 'v2')])
+      summed = nccl.sum_tower_gradients(tower_grads_and_vars)
+
+      for grads_and_vars in summed:
+        self.assertEqual(['v0', 'v1', 'v2'], [v for _, v in grads_and_vars])
+        self.assertIsNone(grads_and_vars[1][0])
+      results = sess.run([[gv[0][0], gv[2][0]] for gv in summed])
+      for result in results:
+        self.assertAllClose(np_ans[0], result[0])
+        self.assertAllClose(np_ans[1], result[1])
+
+  def testErrors(self):
+    t = array_ops.identity(np.random.random_sample((3, 4)))
+    with self.assertRaisesRegexp(ValueError, 'same length'):
+      nccl.bucketed_all_sum([[t], [t, t]])
+    with self.assertRaisesRegexp(ValueError, 'must be None in all towers'):
+      nccl.sum_tower_gradients([[(t, 'v')], [(None, 'v')]])
+
+
 if __name__ == '__main__':
   test.main()
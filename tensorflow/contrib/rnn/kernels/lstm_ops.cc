@@ -21,7 +21,9 @@ limitations under the License.
 
 #include "tensorflow/contrib/rnn/kernels/lstm_ops.h"
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -618,6 +620,204 @@ class SliceHelper {
   const Device& device_;
 };
 
+// Computes the forward pass of BlockLSTM on CPU.
+//
+// The projection of the inputs x[t] * w_x + b does not depend on the previous
+// time steps, so it is computed for many time steps at once, in a large matmul
+// that reads w_x once. Each time step then only multiplies h[t - 1] by w_h,
+// split among the threads in blocks of cells and of the batch: a block
+// multiplies rows of h[t - 1] few enough to stay in L2 by the columns of w_h of
+// the four gates of its cells, and applies the gate nonlinearities to the
+// result while it is still in cache. The blocks are the same at every time
+// step, so each block reads the same columns of w_h.
+template <typename T>
+class CpuBlockLSTMFprop {
+ public:
+  CpuBlockLSTMFprop(int64 batch_size, int64 input_size, int64 cell_size,
+                    T forget_bias, T cell_clip, bool use_peephole)
+      : batch_size_(batch_size),
+        input_size_(input_size),
+        cell_size_(cell_size),
+        forget_bias_(forget_bias),
+        cell_clip_(cell_clip),
+        use_peephole_(use_peephole) {}
+
+  // Computes the first seq_len_max time steps of the outputs.
+  Status Compute(OpKernelContext* ctx, int64 seq_len_max, const Tensor& x,
+                 const Tensor& cs_prev, const Tensor& h_prev, const Tensor& w,
+                 const Tensor& wci, const Tensor& wcf, const Tensor& wco,
+                 const Tensor& b, Tensor* i, Tensor* cs, Tensor* f, Tensor* o,
+                 Tensor* ci, Tensor* co, Tensor* h) const {
+    if (seq_len_max == 0) return Status::OK();
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int64 num_gates = cell_size_ * 4;
+    const int64 step_size = batch_size_ * cell_size_;
+
+    // The time steps of each input projection, as many as fit in a few MB.
+    const int64 steps_per_projection = std::max<int64>(
+        1, std::min<int64>(seq_len_max, (8 << 20) / (sizeof(T) * batch_size_ *
+                                                     num_gates)));
+    Tensor xw_tensor;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<T>::v(),
+        TensorShape({steps_per_projection * batch_size_, num_gates}),
+        &xw_tensor));
+
+    const T* x_data = x.flat<T>().data();
+    typename TTypes<T>::ConstMatrix w_x(w.flat<T>().data(), input_size_,
+                                        num_gates);
+    const T* w_h = w.flat<T>().data() + input_size_ * num_gates;
+    Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_pairs;
+    contract_pairs[0] = Eigen::IndexPair<Eigen::DenseIndex>(1, 0);
+    Eigen::array<Eigen::DenseIndex, 2> b_shape({1, num_gates});
+
+    for (int64 t0 = 0; t0 < seq_len_max; t0 += steps_per_projection) {
+      const int64 num_steps = std::min(steps_per_projection, seq_len_max - t0);
+      typename TTypes<T>::UnalignedConstMatrix x_steps(
+          x_data + t0 * batch_size_ * input_size_, num_steps * batch_size_,
+          input_size_);
+      typename TTypes<T>::Matrix xw(xw_tensor.flat<T>().data(),
+                                    num_steps * batch_size_, num_gates);
+      Eigen::array<Eigen::DenseIndex, 2> broadcast_shape(
+          {num_steps * batch_size_, 1});
+      xw.device(device) =
+          x_steps.contract(w_x, contract_pairs) +
+          b.vec<T>().reshape(b_shape).broadcast(broadcast_shape);
+
+      for (int64 t = t0; t < t0 + num_steps; ++t) {
+        const T* cs_prev_t =
+            t == 0 ? cs_prev.flat<T>().data()
+                   : cs->flat<T>().data() + (t - 1) * step_size;
+        const T* h_prev_t = t == 0 ? h_prev.flat<T>().data()
+                                   : h->flat<T>().data() + (t - 1) * step_size;
+        Step(device, xw.data() + (t - t0) * batch_size_ * num_gates, cs_prev_t,
+             h_prev_t, w_h, wci.flat<T>().data(), wcf.flat<T>().data(),
+             wco.flat<T>().data(), i->flat<T>().data() + t * step_size,
+             cs->flat<T>().data() + t * step_size,
+             f->flat<T>().data() + t * step_size,
+             o->flat<T>().data() + t * step_size,
+             ci->flat<T>().data() + t * step_size,
+             co->flat<T>().data() + t * step_size,
+             h->flat<T>().data() + t * step_size);
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      Matrix;
+  typedef Eigen::Map<const Matrix, Eigen::Unaligned, Eigen::OuterStride<>>
+      ConstMatrixMap;
+  typedef Eigen::Map<Eigen::Array<T, 1, Eigen::Dynamic>> Row;
+  typedef Eigen::Map<const Eigen::Array<T, 1, Eigen::Dynamic>> ConstRow;
+
+  // The number of cells of a block.
+  static constexpr int64 kCellBlockSize = 16;
+
+  template <typename Derived>
+  static Eigen::Array<T, 1, Eigen::Dynamic> Sigmoid(
+      const Eigen::ArrayBase<Derived>& x) {
+    return (T(1) + (-x).exp()).inverse();
+  }
+
+  // Computes one time step, where xw is the projection of the inputs.
+  void Step(const CPUDevice& device, const T* xw, const T* cs_prev,
+            const T* h_prev, const T* w_h, const T* wci, const T* wcf,
+            const T* wco, T* i, T* cs, T* f, T* o, T* ci, T* co, T* h) const {
+    const int64 num_gates = cell_size_ * 4;
+    const int64 num_cell_blocks =
+        (cell_size_ + kCellBlockSize - 1) / kCellBlockSize;
+    // The rows of h_prev of a block fit in 64KB.
+    const int64 batch_block_size = std::max<int64>(
+        1, std::min<int64>(batch_size_, (64 << 10) / (sizeof(T) * cell_size_)));
+    const int64 num_batch_blocks =
+        (batch_size_ + batch_block_size - 1) / batch_block_size;
+
+    auto compute_blocks = [&](int64 first, int64 last) {
+      Matrix gates;
+      for (int64 block = first; block < last; ++block) {
+        const int64 c0 = (block % num_cell_blocks) * kCellBlockSize;
+        const int64 num_cells = std::min(kCellBlockSize, cell_size_ - c0);
+        const int64 b0 = (block / num_cell_blocks) * batch_block_size;
+        const int64 num_rows = std::min(batch_block_size, batch_size_ - b0);
+
+        // The gates of the block, [i, ci, f, o] for its cells.
+        gates.resize(num_rows, 4 * num_cells);
+        ConstMatrixMap h_rows(h_prev + b0 * cell_size_, num_rows, cell_size_,
+                              Eigen::OuterStride<>(cell_size_));
+        for (int g = 0; g < 4; ++g) {
+          const int64 column = g * cell_size_ + c0;
+          ConstMatrixMap w_columns(w_h + column, cell_size_, num_cells,
+                                   Eigen::OuterStride<>(num_gates));
+          ConstMatrixMap xw_columns(xw + b0 * num_gates + column, num_rows,
+                                    num_cells, Eigen::OuterStride<>(num_gates));
+          auto gate = gates.middleCols(g * num_cells, num_cells);
+          gate.noalias() = h_rows * w_columns;
+          gate += xw_columns;
+        }
+
+        ConstRow wci_row(wci + c0, num_cells);
+        ConstRow wcf_row(wcf + c0, num_cells);
+        ConstRow wco_row(wco + c0, num_cells);
+        for (int64 r = 0; r < num_rows; ++r) {
+          const int64 offset = (b0 + r) * cell_size_ + c0;
+          auto gates_row = gates.row(r).array();
+          ConstRow cs_prev_row(cs_prev + offset, num_cells);
+          Row i_row(i + offset, num_cells);
+          Row cs_row(cs + offset, num_cells);
+          Row f_row(f + offset, num_cells);
+          Row o_row(o + offset, num_cells);
+          Row ci_row(ci + offset, num_cells);
+          Row co_row(co + offset, num_cells);
+          Row h_row(h + offset, num_cells);
+
+          if (use_peephole_) {
+            i_row = Sigmoid(gates_row.segment(0, num_cells) +
+                            cs_prev_row * wci_row);
+            f_row = Sigmoid(gates_row.segment(2 * num_cells, num_cells) +
+                            forget_bias_ + cs_prev_row * wcf_row);
+          } else {
+            i_row = Sigmoid(gates_row.segment(0, num_cells));
+            f_row = Sigmoid(gates_row.segment(2 * num_cells, num_cells) +
+                            forget_bias_);
+          }
+          ci_row = gates_row.segment(num_cells, num_cells).tanh();
+          cs_row = i_row * ci_row + f_row * cs_prev_row;
+          if (cell_clip_ > 0.0f) {
+            cs_row = cs_row.max(-cell_clip_).min(cell_clip_);
+          }
+          co_row = cs_row.tanh();
+          if (use_peephole_) {
+            o_row = Sigmoid(gates_row.segment(3 * num_cells, num_cells) +
+                            cs_row * wco_row);
+          } else {
+            o_row = Sigmoid(gates_row.segment(3 * num_cells, num_cells));
+          }
+          h_row = o_row * co_row;
+        }
+      }
+    };
+
+    // Per block: the matmul, and about 100 cycles per cell for the rest.
+    const int64 block_size = batch_block_size * kCellBlockSize;
+    const Eigen::TensorOpCost cost(
+        sizeof(T) * (batch_block_size * cell_size_ + cell_size_ * 4 *
+                     kCellBlockSize + 5 * block_size),
+        sizeof(T) * 7 * block_size,
+        block_size * (8 * cell_size_ + 100));
+    device.parallelFor(num_batch_blocks * num_cell_blocks, cost,
+                       compute_blocks);
+  }
+
+  const int64 batch_size_;
+  const int64 input_size_;
+  const int64 cell_size_;
+  const T forget_bias_;
+  const T cell_clip_;
+  const bool use_peephole_;
+};
+
 }  // namespace
 
 template <typename Device, typename T, bool USE_CUBLAS>
@@ -745,49 +945,60 @@ class BlockLSTMOp : public OpKernel {
     Tensor* h_out;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("h", batch_cell_shape, &h_out));
 
-    Tensor xh_tensor;
-    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
-                            DataTypeToEnum<T>::v(),
-                            TensorShape({batch_size, input_size + cell_size}),
-                            &xh_tensor));
-
-    Tensor icfo_tensor;
-    OP_REQUIRES_OK(ctx,
-                   ctx->allocate_temp(DataTypeToEnum<T>::v(),
-                                      TensorShape({batch_size, cell_size * 4}),
-                                      &icfo_tensor));
-
     const Device& device = ctx->eigen_device<Device>();
 
     const int64 seq_len_max = seq_len_max_tensor->scalar<int64>()();
-    SliceHelper<Device, T> slicer(ctx);
-    for (int64 t = 0; t < seq_len_max; ++t) {
-      const Tensor x_tensor = slicer.InputSlice(*x, t, "x");
-      const Tensor& cs_prev_tensor2 =
-          t == 0 ? *cs_prev_tensor
-                 : slicer.OutputSlice(cs_out, t - 1, "cs_prev");
-      const Tensor& h_prev_tensor2 =
-          t == 0 ? *h_prev_tensor : slicer.OutputSlice(h_out, t - 1, "h_prev");
-
-      Tensor i_tensor = slicer.OutputSlice(i_out, t, "i_out");
-      Tensor cs_tensor = slicer.OutputSlice(cs_out, t, "cs_out");
-      Tensor f_tensor = slicer.OutputSlice(f_out, t, "f_out");
-      Tensor o_tensor = slicer.OutputSlice(o_out, t, "o_out");
-      Tensor ci_tensor = slicer.OutputSlice(ci_out, t, "ci_out");
-      Tensor co_tensor = slicer.OutputSlice(co_out, t, "co_out");
-      Tensor h_tensor = slicer.OutputSlice(h_out, t, "h_out");
-
-      functor::LSTMBlockCellFprop<Device, T, USE_CUBLAS>(batch_size, input_size,
-                                                         cell_size)(
-          ctx, device, forget_bias_, cell_clip_, use_peephole_,
-          x_tensor.matrix<T>(), cs_prev_tensor2.matrix<T>(),
-          h_prev_tensor2.matrix<T>(), w_tensor->matrix<T>(),
-          wci_tensor->vec<T>(), wcf_tensor->vec<T>(), wco_tensor->vec<T>(),
-          b_tensor->vec<T>(), xh_tensor.matrix<T>(), i_tensor.matrix<T>(),
-          cs_tensor.matrix<T>(), f_tensor.matrix<T>(), o_tensor.matrix<T>(),
-          ci_tensor.matrix<T>(), co_tensor.matrix<T>(), icfo_tensor.matrix<T>(),
-          h_tensor.matrix<T>());
-      slicer.FinishTimeStep();
+    if (std::is_same<Device, CPUDevice>::value) {
+      OP_REQUIRES_OK(
+          ctx, CpuBlockLSTMFprop<T>(batch_size, input_size, cell_size,
+                                    forget_bias_, cell_clip_, use_peephole_)
+                   .Compute(ctx, seq_len_max, *x, *cs_prev_tensor,
+                            *h_prev_tensor, *w_tensor, *wci_tensor,
+                            *wcf_tensor, *wco_tensor, *b_tensor, i_out, cs_out,
+                            f_out, o_out, ci_out, co_out, h_out));
+    } else {
+      Tensor xh_tensor;
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                              DataTypeToEnum<T>::v(),
+                              TensorShape({batch_size, input_size + cell_size}),
+                              &xh_tensor));
+
+      Tensor icfo_tensor;
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                              DataTypeToEnum<T>::v(),
+                              TensorShape({batch_size, cell_size * 4}),
+                              &icfo_tensor));
+
+      SliceHelper<Device, T> slicer(ctx);
+      for (int64 t = 0; t < seq_len_max; ++t) {
+        const Tensor x_tensor = slicer.InputSlice(*x, t, "x");
+        const Tensor& cs_prev_tensor2 =
+            t == 0 ? *cs_prev_tensor
+                   : slicer.OutputSlice(cs_out, t - 1, "cs_prev");
+        const Tensor& h_prev_tensor2 =
+            t == 0 ? *h_prev_tensor
+                   : slicer.OutputSlice(h_out, t - 1, "h_prev");
+
+        Tensor i_tensor = slicer.OutputSlice(i_out, t, "i_out");
+        Tensor cs_tensor = slicer.OutputSlice(cs_out, t, "cs_out");
+        Tensor f_tensor = slicer.OutputSlice(f_out, t, "f_out");
+        Tensor o_tensor = slicer.OutputSlice(o_out, t, "o_out");
+        Tensor ci_tensor = slicer.OutputSlice(ci_out, t, "ci_out");
+        Tensor co_tensor = slicer.OutputSlice(co_out, t, "co_out");
+        Tensor h_tensor = slicer.OutputSlice(h_out, t, "h_out");
+
+        functor::LSTMBlockCellFprop<Device, T, USE_CUBLAS>(
+            batch_size, input_size, cell_size)(
+            ctx, device, forget_bias_, cell_clip_, use_peephole_,
+            x_tensor.matrix<T>(), cs_prev_tensor2.matrix<T>(),
+            h_prev_tensor2.matrix<T>(), w_tensor->matrix<T>(),
+            wci_tensor->vec<T>(), wcf_tensor->vec<T>(), wco_tensor->vec<T>(),
+            b_tensor->vec<T>(), xh_tensor.matrix<T>(), i_tensor.matrix<T>(),
+            cs_tensor.matrix<T>(), f_tensor.matrix<T>(), o_tensor.matrix<T>(),
+            ci_tensor.matrix<T>(), co_tensor.matrix<T>(),
+            icfo_tensor.matrix<T>(), h_tensor.matrix<T>());
+        slicer.FinishTimeStep();
+      }
     }
 
     if (seq_len_max < timelen) {
@@ -384,6 +384,53 @@ class LSTMBlockCellTest(test.TestCase):
       for basic, fused in zip(basic_wgrads, fused_wgrads):
         self.assertAllClose(basic, fused, rtol=1e-2, atol=1e-2)
 
+  def testBlockLSTMMatchesLSTMBlockCell(self):
+    # Enough cells and batch to be split in blocks, some of them partial.
+    batch_size = 70
+    input_size = 3
+    cell_size = 37
+    sequence_length = 8
+    seq_len_max = 6
+    np.random.seed(1)
+    inputs = [
+        np.random.randn(batch_size, input_size).astype(np.float32)
+        for _ in range(sequence_length)
+    ]
+    cs_prev = np.random.randn(batch_size, cell_size).astype(np.float32)
+    h_prev = np.random.randn(batch_size, cell_size).astype(np.float32)
+    w = np.random.randn(input_size + cell_size,
+                        cell_size * 4).astype(np.float32) * 0.1
+    b = np.random.randn(cell_size * 4).astype(np.float32)
+    wci, wcf, wco = [
+        np.random.randn(cell_size).astype(np.float32) for _ in range(3)
+    ]
+    for use_peephole in [False, True]:
+      with self.test_session(use_gpu=False) as sess:
+        block = block_lstm(
+            ops.convert_to_tensor(seq_len_max, dtype=dtypes.int64),
+            inputs, w, b, cs_prev=cs_prev, h_prev=h_prev, wci=wci, wcf=wcf,
+            wco=wco, forget_bias=1.0, cell_clip=1.0,
+            use_peephole=use_peephole)
+        cells = []
+        cs, h = cs_prev, h_prev
+        for x in inputs[:seq_len_max]:
+          cell = lstm_ops._lstm_block_cell(  # pylint: disable=protected-access
+              x, cs, h, w, b, wci=wci, wcf=wcf, wco=wco, forget_bias=1.0,
+              cell_clip=1.0, use_peephole=use_peephole)
+          cells.append(cell)
+          cs, h = cell[1], cell[6]
+        block_outputs, cell_outputs = sess.run([block, cells])
+        for t in range(seq_len_max):
+          for output in range(7):
+            self.assertAllClose(cell_outputs[t][output],
+                                block_outputs[output][t])
+        # The states after seq_len_max are zero.
+        for t in range(seq_len_max, sequence_length):
+          self.assertAllEqual(np.zeros([batch_size, cell_size]),
+                              block_outputs[1][t])
+          self.assertAllEqual(np.zeros([batch_size, cell_size]),
+                              block_outputs[6][t])
+
   def testLSTMFusedSequenceLengths(self):
     """Verify proper support for sequence lengths in LSTMBlockFusedCell."""
     with self.test_session(use_gpu=True) as sess:
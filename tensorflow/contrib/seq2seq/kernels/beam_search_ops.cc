@@ -21,6 +21,8 @@ limitations under the License.
 
 #include "tensorflow/contrib/seq2seq/kernels/beam_search_ops.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <vector>
 
@@ -93,6 +95,176 @@ class GatherTreeOp : public OpKernel {
 REGISTER_KERNEL(int32);
 #undef REGISTER_KERNEL
 
+// Computes one step of beam search for each batch entry: the total log
+// probabilities and length penalized scores of all the beam_width *
+// vocab_size continuations, and the beam_width best of them. The
+// continuations are scored and selected in one pass, without materializing
+// the scores, lengths or masks of all of them.
+class BeamSearchStepOp : public OpKernel {
+ public:
+  explicit BeamSearchStepOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& step_log_probs = ctx->input(0);
+    const Tensor& log_probs = ctx->input(1);
+    const Tensor& lengths = ctx->input(2);
+    const Tensor& finished = ctx->input(3);
+    const Tensor& time = ctx->input(4);
+    const Tensor& end_token = ctx->input(5);
+    const Tensor& length_penalty_weight = ctx->input(6);
+    OP_REQUIRES(ctx, step_log_probs.dims() == 3,
+                errors::InvalidArgument(
+                    "step_log_probs must be a 3-tensor, saw shape: ",
+                    step_log_probs.shape().DebugString()));
+    const int64 batch_size = step_log_probs.dim_size(0);
+    const int64 beam_width = step_log_probs.dim_size(1);
+    const int64 vocab_size = step_log_probs.dim_size(2);
+    const TensorShape beam_shape({batch_size, beam_width});
+    OP_REQUIRES(ctx, log_probs.shape() == beam_shape,
+                errors::InvalidArgument(
+                    "log_probs.shape must be ", beam_shape.DebugString(),
+                    ", saw: ", log_probs.shape().DebugString()));
+    OP_REQUIRES(ctx, lengths.shape() == beam_shape,
+                errors::InvalidArgument(
+                    "lengths.shape must be ", beam_shape.DebugString(),
+                    ", saw: ", lengths.shape().DebugString()));
+    OP_REQUIRES(ctx, finished.shape() == beam_shape,
+                errors::InvalidArgument(
+                    "finished.shape must be ", beam_shape.DebugString(),
+                    ", saw: ", finished.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(time.shape()),
+                errors::InvalidArgument("time must be a scalar, saw shape: ",
+                                        time.shape().DebugString()));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(end_token.shape()),
+        errors::InvalidArgument("end_token must be a scalar, saw shape: ",
+                                end_token.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(length_penalty_weight.shape()),
+                errors::InvalidArgument(
+                    "length_penalty_weight must be a scalar, saw shape: ",
+                    length_penalty_weight.shape().DebugString()));
+    // At the first step all the beams are equal, so only the continuations
+    // of the first beam are considered.
+    const int64 num_beams = time.scalar<int32>()() > 0 ? beam_width : 1;
+    OP_REQUIRES(ctx, num_beams * vocab_size >= beam_width,
+                errors::InvalidArgument(
+                    "Only ", num_beams * vocab_size,
+                    " continuations for a beam width of ", beam_width));
+
+    Tensor* scores = nullptr;
+    Tensor* predicted_ids = nullptr;
+    Tensor* parent_ids = nullptr;
+    Tensor* next_log_probs = nullptr;
+    Tensor* next_lengths = nullptr;
+    Tensor* next_finished = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, beam_shape, &scores));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, beam_shape, &predicted_ids));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, beam_shape, &parent_ids));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(3, beam_shape, &next_log_probs));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(4, beam_shape, &next_lengths));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(5, beam_shape, &next_finished));
+
+    auto step_log_probs_t = step_log_probs.tensor<float, 3>();
+    auto log_probs_t = log_probs.matrix<float>();
+    auto lengths_t = lengths.matrix<int32>();
+    auto finished_t = finished.matrix<bool>();
+    const int32 eos = end_token.scalar<int32>()();
+    const float penalty_weight = length_penalty_weight.scalar<float>()();
+    auto scores_t = scores->matrix<float>();
+    auto predicted_ids_t = predicted_ids->matrix<int32>();
+    auto parent_ids_t = parent_ids->matrix<int32>();
+    auto next_log_probs_t = next_log_probs->matrix<float>();
+    auto next_lengths_t = next_lengths->matrix<int32>();
+    auto next_finished_t = next_finished->matrix<bool>();
+    // The penalty of a continuation of length l, (5 + l)^w / 6^w; see
+    // https://arxiv.org/abs/1609.08144.
+    auto length_penalty = [penalty_weight](int32 length) {
+      return std::pow(5.f + static_cast<float>(length), penalty_weight) /
+             std::pow(6.f, penalty_weight);
+    };
+    // Finished beams only continue with the end token.
+    const float kMaskedLogProb = Eigen::NumTraits<float>::lowest();
+
+    auto DoWork = [&](int64 start_batch, int64 limit_batch) {
+      std::vector<Candidate> best;
+      best.reserve(beam_width + 1);
+      for (int64 batch = start_batch; batch < limit_batch; ++batch) {
+        best.clear();
+        for (int64 beam = 0; beam < num_beams; ++beam) {
+          const bool beam_finished = finished_t(batch, beam);
+          const float beam_log_prob = log_probs_t(batch, beam);
+          const int32 beam_length = lengths_t(batch, beam);
+          // Continuations with the end token or of a finished beam keep the
+          // beam's length, the others are one longer.
+          const float penalty = length_penalty(beam_length);
+          const float longer_penalty = length_penalty(beam_length + 1);
+          for (int64 word = 0; word < vocab_size; ++word) {
+            const bool is_eos = word == eos;
+            float step_log_prob = step_log_probs_t(batch, beam, word);
+            if (beam_finished) {
+              step_log_prob = is_eos ? 0.f : kMaskedLogProb;
+            }
+            const float total = beam_log_prob + step_log_prob;
+            const float score =
+                penalty_weight == 0
+                    ? total
+                    : total / (beam_finished || is_eos ? penalty
+                                                       : longer_penalty);
+            const Candidate candidate = {score, beam * vocab_size + word,
+                                         total};
+            if (best.size() < beam_width) {
+              best.push_back(candidate);
+              std::push_heap(best.begin(), best.end(), IsBetter);
+            } else if (IsBetter(candidate, best.front())) {
+              std::pop_heap(best.begin(), best.end(), IsBetter);
+              best.back() = candidate;
+              std::push_heap(best.begin(), best.end(), IsBetter);
+            }
+          }
+        }
+        std::sort_heap(best.begin(), best.end(), IsBetter);
+        for (int64 i = 0; i < beam_width; ++i) {
+          const Candidate& candidate = best[i];
+          const int32 word = candidate.index % vocab_size;
+          const int32 parent = candidate.index / vocab_size;
+          const bool now_finished = finished_t(batch, parent) || word == eos;
+          scores_t(batch, i) = candidate.score;
+          predicted_ids_t(batch, i) = word;
+          parent_ids_t(batch, i) = parent;
+          next_log_probs_t(batch, i) = candidate.total_log_prob;
+          next_finished_t(batch, i) = now_finished;
+          next_lengths_t(batch, i) =
+              lengths_t(batch, parent) + (!now_finished && word != eos);
+        }
+      }
+    };
+    // Each continuation costs a few arithmetic and compare operations, and
+    // rarely a heap update.
+    const int64 batch_cost = num_beams * vocab_size * 20;
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          batch_cost, DoWork);
+  }
+
+ private:
+  struct Candidate {
+    float score;
+    // beam * vocab_size + word.
+    int64 index;
+    float total_log_prob;
+  };
+
+  // Orders candidates like a sorted top_k of the scores: by decreasing score,
+  // ties going to the lower index. The heap of the best candidates is a
+  // min-heap under this ordering, with the worst candidate at its front.
+  static bool IsBetter(const Candidate& a, const Candidate& b) {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("BeamSearchStep").Device(DEVICE_CPU),
+                        BeamSearchStepOp);
+
 namespace functor {
 
 // CPU specialization
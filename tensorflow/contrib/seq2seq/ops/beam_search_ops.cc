@@ -65,4 +65,70 @@ sequence_length: `[batch_size, beam_width]`.
 beams: `[max_time, batch_size, beam_width]`.
 )doc");
 
+REGISTER_OP("BeamSearchStep")
+    .Input("step_log_probs: float")
+    .Input("log_probs: float")
+    .Input("lengths: int32")
+    .Input("finished: bool")
+    .Input("time: int32")
+    .Input("end_token: int32")
+    .Input("length_penalty_weight: float")
+    .Output("scores: float")
+    .Output("predicted_ids: int32")
+    .Output("parent_ids: int32")
+    .Output("next_log_probs: float")
+    .Output("next_lengths: int32")
+    .Output("next_finished: bool")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle step_log_probs, beams, unused;
+
+      // step_log_probs is shaped [batch_size, beam_width, vocab_size], and
+      // the other inputs and all the outputs [batch_size, beam_width].
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &step_log_probs));
+      TF_RETURN_IF_ERROR(c->Subshape(step_log_probs, 0, 2, &beams));
+      for (int i = 1; i < 4; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, &unused));
+        TF_RETURN_IF_ERROR(c->Merge(beams, c->input(i), &beams));
+      }
+      for (int i = 4; i < 7; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      for (int i = 0; i < 6; ++i) {
+        c->set_output(i, beams);
+      }
+      return tensorflow::Status::OK();
+    })
+    .Doc(R"doc(
+Selects the best continuations of the beams for one step of beam search.
+
+For each batch entry, scores every continuation of every beam with a word of
+the vocabulary, and returns the `beam_width` best of them by decreasing score,
+ties going to the lower `beam * vocab_size + word`. A continuation has total
+log probability `log_probs[batch, beam] + step_log_probs[batch, beam, word]`,
+where finished beams can only continue with `end_token`, at no cost. Its length
+is the beam's length, plus one unless the beam is finished or `word` is
+`end_token`. Its score is its total log probability divided by the length
+penalty `((5 + length) / 6) ** length_penalty_weight`.
+
+This computes the same results as the corresponding chain of ops, without
+materializing the `[batch_size, beam_width * vocab_size]` scores.
+
+step_log_probs: `[batch_size, beam_width, vocab_size]`, the log softmax of the
+  logits of the step.
+log_probs: `[batch_size, beam_width]`, the total log probabilities of the
+  beams.
+lengths: `[batch_size, beam_width]`, the lengths of the beams.
+finished: `[batch_size, beam_width]`, whether the beams are finished.
+time: The step, starting at 0. All the beams are equal at step 0, so only the
+  continuations of the first beam are considered.
+end_token: The end token.
+length_penalty_weight: The length penalty weight, 0 disables the penalty.
+scores: `[batch_size, beam_width]`, the scores of the selected continuations.
+predicted_ids: `[batch_size, beam_width]`, their words.
+parent_ids: `[batch_size, beam_width]`, the beams they continue.
+next_log_probs: `[batch_size, beam_width]`, their total log probabilities.
+next_lengths: `[batch_size, beam_width]`, their lengths.
+next_finished: `[batch_size, beam_width]`, whether they are finished.
+)doc");
+
 }  // end namespace tensorflow
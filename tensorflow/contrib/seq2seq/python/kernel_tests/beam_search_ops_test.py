@@ -147,5 +147,60 @@ class GatherTreeTest(test.TestCase):
       self.assertAllEqual(expected_beams, beams.eval())
 
 
+class BeamSearchStepTest(test.TestCase):
+
+  def testFirstStepUsesOnlyFirstBeam(self):
+    # (batch_size = 1, beam_width = 2, vocab_size = 3)
+    step_log_probs = np.log(
+        [[[0.5, 0.3, 0.2], [0.1, 0.1, 0.8]]]).astype(np.float32)
+    outputs = beam_search_ops.beam_search_step(
+        step_log_probs=step_log_probs,
+        log_probs=np.zeros([1, 2], dtype=np.float32),
+        lengths=np.zeros([1, 2], dtype=np.int32),
+        finished=np.zeros([1, 2], dtype=np.bool),
+        time=0, end_token=2, length_penalty_weight=0.0)
+    with self.test_session():
+      (scores, predicted_ids, parent_ids, next_log_probs, next_lengths,
+       next_finished) = [t.eval() for t in outputs]
+    self.assertAllClose(np.log([[0.5, 0.3]]), scores)
+    self.assertAllEqual([[0, 1]], predicted_ids)
+    self.assertAllEqual([[0, 0]], parent_ids)
+    self.assertAllClose(np.log([[0.5, 0.3]]), next_log_probs)
+    self.assertAllEqual([[1, 1]], next_lengths)
+    self.assertAllEqual([[False, False]], next_finished)
+
+  def testFinishedBeamOnlyContinuesWithEndToken(self):
+    # (batch_size = 1, beam_width = 2, vocab_size = 3); beam 0 is finished.
+    step_log_probs = np.array(
+        [[[-3., -0.5, -1.], [-0.1, -5., -5.]]], dtype=np.float32)
+    outputs = beam_search_ops.beam_search_step(
+        step_log_probs=step_log_probs,
+        log_probs=np.array([[-1., -2.]], dtype=np.float32),
+        lengths=np.array([[3, 3]], dtype=np.int32),
+        finished=np.array([[True, False]]),
+        time=1, end_token=0, length_penalty_weight=0.0)
+    with self.test_session():
+      (scores, predicted_ids, parent_ids, next_log_probs, next_lengths,
+       next_finished) = [t.eval() for t in outputs]
+    self.assertAllClose([[-1., -2.1]], scores)
+    self.assertAllEqual([[0, 0]], predicted_ids)
+    self.assertAllEqual([[0, 1]], parent_ids)
+    self.assertAllClose([[-1., -2.1]], next_log_probs)
+    self.assertAllEqual([[3, 3]], next_lengths)
+    self.assertAllEqual([[True, True]], next_finished)
+
+  def testTooFewCandidates(self):
+    # At time 0 only the vocab_size continuations of beam 0 are candidates.
+    outputs = beam_search_ops.beam_search_step(
+        step_log_probs=np.zeros([1, 3, 2], dtype=np.float32),
+        log_probs=np.zeros([1, 3], dtype=np.float32),
+        lengths=np.zeros([1, 3], dtype=np.int32),
+        finished=np.zeros([1, 3], dtype=np.bool),
+        time=0, end_token=0, length_penalty_weight=0.0)
+    with self.test_session():
+      with self.assertRaisesOpError("Only 2 continuations"):
+        outputs[0].eval()
+
+
 if __name__ == "__main__":
   test.main()
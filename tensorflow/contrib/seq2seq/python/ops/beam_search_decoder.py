@@ -475,6 +475,75 @@ def _beam_search_step(time, logits, next_cell_state, beam_state, batch_size,
   """
   static_batch_size = tensor_util.constant_value(batch_size)
 
+  # The fused op only has a float32 CPU kernel; logits placed on a GPU keep
+  # the unfused ops there rather than being copied to the host at every step.
+  if (logits.dtype == dtypes.float32 and
+      "gpu" not in logits.device.lower()):
+    # Score and select the continuations in one op, without materializing
+    # the [batch_size, beam_width * vocab_size] scores.
+    (next_beam_scores, next_word_ids, next_beam_ids, next_beam_probs,
+     next_prediction_len, next_finished) = beam_search_ops.beam_search_step(
+         step_log_probs=nn_ops.log_softmax(logits),
+         log_probs=beam_state.log_probs,
+         lengths=beam_state.lengths,
+         finished=beam_state.finished,
+         time=time,
+         end_token=end_token,
+         length_penalty_weight=length_penalty_weight)
+  else:
+    (next_beam_scores, next_word_ids, next_beam_ids, next_beam_probs,
+     next_prediction_len, next_finished) = _select_beams(
+         time=time,
+         logits=logits,
+         beam_state=beam_state,
+         batch_size=batch_size,
+         beam_width=beam_width,
+         end_token=end_token,
+         length_penalty_weight=length_penalty_weight)
+  for t in (next_beam_scores, next_word_ids, next_beam_ids, next_beam_probs,
+            next_prediction_len, next_finished):
+    t.set_shape([static_batch_size, beam_width])
+
+  # Pick out the cell_states according to the next_beam_ids. We use a
+  # different gather_shape here because the cell_state tensors, i.e.
+  # the tensors that would be gathered from, all have dimension
+  # greater than two and we need to preserve those dimensions.
+  # pylint: disable=g-long-lambda
+  next_cell_state = nest.map_structure(
+      lambda gather_from: _maybe_tensor_gather_helper(
+          gather_indices=next_beam_ids,
+          gather_from=gather_from,
+          batch_size=batch_size,
+          range_size=beam_width,
+          gather_shape=[batch_size * beam_width, -1]),
+      next_cell_state)
+  # pylint: enable=g-long-lambda
+
+  next_state = BeamSearchDecoderState(
+      cell_state=next_cell_state,
+      log_probs=next_beam_probs,
+      lengths=next_prediction_len,
+      finished=next_finished)
+
+  output = BeamSearchDecoderOutput(
+      scores=next_beam_scores,
+      predicted_ids=next_word_ids,
+      parent_ids=next_beam_ids)
+
+  return output, next_state
+
+
+def _select_beams(time, logits, beam_state, batch_size, beam_width, end_token,
+                  length_penalty_weight):
+  """Selects the best continuations of the beams, see `_beam_search_step`.
+
+  This is the unfused equivalent of `beam_search_ops.beam_search_step`, used
+  for logits that are not float32 or are placed on a GPU.
+
+  Returns:
+    A tuple `(scores, word_ids, beam_ids, log_probs, lengths, finished)` of
+    the selected continuations, each shaped `[batch_size, beam_width]`.
+  """
   # Calculate the current lengths of the predictions
   prediction_lengths = beam_state.lengths
   previously_finished = beam_state.finished
@@ -520,8 +589,6 @@ def _beam_search_step(time, logits, next_cell_state, beam_state, batch_size,
       ops.convert_to_tensor(beam_width, dtype=dtypes.int32, name="beam_width"),
       num_available_beam)
   next_beam_scores, word_indices = nn_ops.top_k(scores_flat, k=next_beam_size)
-  next_beam_scores.set_shape([static_batch_size, beam_width])
-  word_indices.set_shape([static_batch_size, beam_width])
 
   # Pick out the probs, beam_ids, and states according to the chosen predictions
   next_beam_probs = _tensor_gather_helper(
@@ -558,33 +625,8 @@ def _beam_search_step(time, logits, next_cell_state, beam_state, batch_size,
       gather_shape=[-1])
   next_prediction_len += lengths_to_add
 
-  # Pick out the cell_states according to the next_beam_ids. We use a
-  # different gather_shape here because the cell_state tensors, i.e.
-  # the tensors that would be gathered from, all have dimension
-  # greater than two and we need to preserve those dimensions.
-  # pylint: disable=g-long-lambda
-  next_cell_state = nest.map_structure(
-      lambda gather_from: _maybe_tensor_gather_helper(
-          gather_indices=next_beam_ids,
-          gather_from=gather_from,
-          batch_size=batch_size,
-          range_size=beam_width,
-          gather_shape=[batch_size * beam_width, -1]),
-      next_cell_state)
-  # pylint: enable=g-long-lambda
-
-  next_state = BeamSearchDecoderState(
-      cell_state=next_cell_state,
-      log_probs=next_beam_probs,
-      lengths=next_prediction_len,
-      finished=next_finished)
-
-  output = BeamSearchDecoderOutput(
-      scores=next_beam_scores,
-      predicted_ids=next_word_ids,
-      parent_ids=next_beam_ids)
-
-  return output, next_state
+  return (next_beam_scores, next_word_ids, next_beam_ids, next_beam_probs,
+          next_prediction_len, next_finished)
 
 
 def _get_scores(log_probs, sequence_lengths, length_penalty_weight):
@@ -0,0 +1,528 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_rendezvous_mgr.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
+#endif  // GOOGLE_CUDA
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// How long the polling threads wait before checking for shutdown.
+const int64 kWaitMicros = 100000;
+
+// How long a tensor waits for space in the segment before it is sent
+// through RPC.
+const int64 kReplyTimeoutMicros = 1000000;
+
+// How long a worker that is not on this host is assumed to stay away.
+// Workers may start in any order, so the segment of a missing worker is
+// looked for again after this time.
+const uint64 kMissingPeerRetryMicros = 10000000;
+
+const int64 kDefaultSegmentBytes = 256 << 20;
+
+// Replaces the characters that may not appear in a segment name.
+string SanitizeName(const string& name) {
+  string result = name;
+  for (char& c : result) {
+    if (!isalnum(c)) c = '_';
+  }
+  return result;
+}
+
+}  // namespace
+
+class ShmRemoteRendezvous : public BaseRemoteRendezvous {
+ public:
+  // Takes ownership of a reference on "rpc_rendezvous".
+  ShmRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                      ShmRendezvousMgr* mgr, RemoteRendezvous* rpc_rendezvous)
+      : BaseRemoteRendezvous(env, step_id, false),
+        mgr_(mgr),
+        rpc_rendezvous_(rpc_rendezvous) {}
+
+  Status Initialize(WorkerSession* session) override {
+    TF_RETURN_IF_ERROR(BaseRemoteRendezvous::Initialize(session));
+    return rpc_rendezvous_->Initialize(session);
+  }
+
+  void StartAbort(const Status& status) override {
+    BaseRemoteRendezvous::StartAbort(status);
+    rpc_rendezvous_->StartAbort(status);
+    mgr_->AbortStep(step_id_, status);
+  }
+
+  // Receives "parsed" from its producer through RPC.
+  void RecvFromRpc(const Rendezvous::ParsedKey& parsed,
+                   const Rendezvous::Args& recv_args, DoneCallback done) {
+    rpc_rendezvous_->RecvAsync(parsed, recv_args, std::move(done));
+  }
+
+ protected:
+  void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                           const Rendezvous::Args& recv_args,
+                           DoneCallback done) override {
+    CHECK(is_initialized());
+    Device* dst_device;
+    Status s = session()->device_mgr->LookupDevice(parsed.dst_device,
+                                                   &dst_device);
+    if (!s.ok()) {
+      done(s, Args(), recv_args, Tensor(), false);
+      return;
+    }
+    if (!mgr_->RecvFromPeer(this, step_id_, parsed, dst_device, recv_args,
+                            done)) {
+      RecvFromRpc(parsed, recv_args, std::move(done));
+    }
+  }
+
+ private:
+  ~ShmRemoteRendezvous() override { rpc_rendezvous_->Unref(); }
+
+  ShmRendezvousMgr* const mgr_;  // Not owned.
+  RemoteRendezvous* const rpc_rendezvous_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRemoteRendezvous);
+};
+
+ShmRendezvousMgr::ShmRendezvousMgr(const WorkerEnv* env,
+                                   const ServerDef& server_def)
+    : BaseRendezvousMgr(env),
+      env_(env),
+      server_def_(server_def),
+      rpc_mgr_(new RpcRendezvousMgr(
+          env, server_def.default_session_config().rpc_options())) {
+  int64 segment_bytes;
+  Status s = ReadInt64FromEnvVar("TF_SHM_TRANSPORT_BYTES", kDefaultSegmentBytes,
+                                 &segment_bytes);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+    segment_bytes = kDefaultSegmentBytes;
+  }
+  const string name = SegmentName(server_def, server_def.job_name(),
+                                  server_def.task_index());
+  s = ShmSegment::Create(name, segment_bytes, &segment_);
+  if (!s.ok()) {
+    // The other tasks on this host will not find the segment, and will
+    // receive the tensors of this task through RPC.
+    LOG(WARNING) << "Failed to create shared memory segment " << name
+                 << ", tensors will be sent through RPC only: " << s;
+    return;
+  }
+  LOG(INFO) << "Serving tensors to the tasks on this host through shared "
+               "memory segment "
+            << name << " of " << segment_bytes << " bytes";
+  server_.reset(env_->env->StartThread(ThreadOptions(), "shm_rendezvous",
+                                       [this]() { ServeRequests(); }));
+}
+
+ShmRendezvousMgr::~ShmRendezvousMgr() {
+  {
+    mutex_lock l(mu_);
+    shutdown_ = true;
+  }
+  if (segment_ != nullptr) {
+    segment_->NotifyOwner();
+  }
+  server_.reset();
+
+  std::vector<PendingRecv> cancelled;
+  {
+    mutex_lock l(mu_);
+    for (auto& entry : peers_) {
+      for (auto& pending : entry.second->pending) {
+        if (pending.second.done != nullptr) {
+          cancelled.push_back(std::move(pending.second));
+        }
+      }
+      entry.second->pending.clear();
+    }
+  }
+  for (PendingRecv& recv : cancelled) {
+    recv.done(errors::Cancelled("Shutting down the rendezvous manager"),
+              Rendezvous::Args(), recv.recv_args, Tensor(), false);
+    recv.rendezvous->Unref();
+  }
+  // The waiting threads exit when they see shutdown_, and the peers are
+  // destroyed after them.
+  std::unordered_map<string, std::unique_ptr<Peer>> peers;
+  {
+    mutex_lock l(mu_);
+    std::swap(peers, peers_);
+  }
+  for (auto& entry : peers) {
+    entry.second->waiter.reset();
+  }
+}
+
+/* static */
+string ShmRendezvousMgr::SegmentName(const ServerDef& server_def,
+                                     const string& job_name, int task_id) {
+  // Tasks of different clusters on the same host must not share a
+  // segment, so the cluster is part of the name.
+  std::vector<string> tasks;
+  for (const auto& job : server_def.cluster().job()) {
+    for (const auto& task : job.tasks()) {
+      tasks.push_back(
+          strings::StrCat(job.name(), "|", task.first, "|", task.second));
+    }
+  }
+  std::sort(tasks.begin(), tasks.end());
+  const uint64 cluster = Fingerprint64(str_util::Join(tasks, ","));
+  return strings::StrCat("/tf_shm_", strings::Hex(cluster), "_",
+                         SanitizeName(job_name), "_", task_id);
+}
+
+BaseRemoteRendezvous* ShmRendezvousMgr::Create(int64 step_id,
+                                               const WorkerEnv* worker_env) {
+  return new ShmRemoteRendezvous(worker_env, step_id, this,
+                                 rpc_mgr_->Find(step_id));
+}
+
+void ShmRendezvousMgr::Cleanup(int64 step_id) {
+  BaseRendezvousMgr::Cleanup(step_id);
+  rpc_mgr_->Cleanup(step_id);
+}
+
+void ShmRendezvousMgr::CleanupAll() {
+  BaseRendezvousMgr::CleanupAll();
+  rpc_mgr_->CleanupAll();
+}
+
+bool ShmRendezvousMgr::RecvFromPeer(ShmRemoteRendezvous* rendezvous,
+                                    int64 step_id,
+                                    const Rendezvous::ParsedKey& parsed,
+                                    Device* dst_device,
+                                    const Rendezvous::Args& recv_args,
+                                    const Rendezvous::DoneCallback& done) {
+  string src_worker;
+  string src_rel_device;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    return false;
+  }
+  mutex_lock l(mu_);
+  if (shutdown_) return false;
+  Peer* peer = FindPeer(src_worker);
+  if (peer == nullptr) return false;
+  int slot;
+  if (!peer->segment->PostRequest(step_id, parsed.FullKey(), &slot)) {
+    return false;
+  }
+  rendezvous->Ref();
+  peer->pending[slot] = {rendezvous, step_id, parsed, dst_device, recv_args,
+                         done};
+  return true;
+}
+
+void ShmRendezvousMgr::AbortStep(int64 step_id, const Status& status) {
+  std::vector<PendingRecv> aborted;
+  {
+    mutex_lock l(mu_);
+    for (auto& entry : peers_) {
+      for (auto& pending : entry.second->pending) {
+        PendingRecv& recv = pending.second;
+        if (recv.step_id == step_id && recv.done != nullptr) {
+          aborted.push_back(recv);
+          // The entry stays until the peer answers, so that the slot is
+          // released then.
+          recv.done = nullptr;
+          recv.rendezvous = nullptr;
+        }
+      }
+    }
+  }
+  for (PendingRecv& recv : aborted) {
+    recv.done(status, Rendezvous::Args(), recv.recv_args, Tensor(), false);
+    recv.rendezvous->Unref();
+  }
+}
+
+ShmRendezvousMgr::Peer* ShmRendezvousMgr::FindPeer(const string& src_worker) {
+  auto it = peers_.find(src_worker);
+  if (it != peers_.end()) {
+    return it->second->closed ? nullptr : it->second.get();
+  }
+  const uint64 now = env_->env->NowMicros();
+  auto missing = missing_peers_.find(src_worker);
+  if (missing != missing_peers_.end() &&
+      now < missing->second + kMissingPeerRetryMicros) {
+    return nullptr;
+  }
+  DeviceNameUtils::ParsedName name;
+  if (!DeviceNameUtils::ParseFullName(src_worker, &name) || !name.has_job ||
+      !name.has_task) {
+    missing_peers_[src_worker] = now;
+    return nullptr;
+  }
+  std::unique_ptr<ShmSegment> segment;
+  Status s = ShmSegment::Open(SegmentName(server_def_, name.job, name.task),
+                              &segment);
+  if (!s.ok()) {
+    VLOG(1) << "Receiving tensors from " << src_worker << " through RPC: "
+            << s;
+    missing_peers_[src_worker] = now;
+    return nullptr;
+  }
+  missing_peers_.erase(src_worker);
+  LOG(INFO) << "Receiving tensors from " << src_worker
+            << " through shared memory segment " << segment->name();
+
+  Peer* peer = new Peer;
+  peer->segment = std::move(segment);
+  peers_[src_worker].reset(peer);
+  peer->waiter.reset(env_->env->StartThread(
+      ThreadOptions(), "shm_rendezvous_peer",
+      [this, src_worker, peer]() { WaitForReplies(src_worker, peer); }));
+  return peer;
+}
+
+void ShmRendezvousMgr::WaitForReplies(const string& peer_name, Peer* peer) {
+  std::vector<ShmSegment::Reply> replies;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (shutdown_) return;
+    }
+    replies.clear();
+    peer->segment->WaitForReplies(kWaitMicros, &replies);
+    for (const ShmSegment::Reply& reply : replies) {
+      HandleReply(peer, reply);
+    }
+    if (replies.empty() && !peer->segment->IsOwnerAlive()) break;
+  }
+
+  // The peer has exited, so its pending requests will not be answered.
+  std::vector<PendingRecv> failed;
+  {
+    mutex_lock l(mu_);
+    peer->closed = true;
+    for (auto& pending : peer->pending) {
+      if (pending.second.done != nullptr) {
+        failed.push_back(std::move(pending.second));
+      }
+    }
+    peer->pending.clear();
+  }
+  const Status s = errors::Unavailable("Task ", peer_name, " has exited");
+  LOG(WARNING) << s;
+  for (PendingRecv& recv : failed) {
+    recv.done(s, Rendezvous::Args(), recv.recv_args, Tensor(), false);
+    recv.rendezvous->Unref();
+  }
+}
+
+void ShmRendezvousMgr::HandleReply(Peer* peer,
+                                   const ShmSegment::Reply& reply) {
+  PendingRecv recv;
+  {
+    mutex_lock l(mu_);
+    auto it = peer->pending.find(reply.slot);
+    if (it != peer->pending.end()) {
+      recv = std::move(it->second);
+      peer->pending.erase(it);
+    }
+  }
+  if (recv.done == nullptr) {
+    // The step was aborted.
+    peer->segment->ReleaseReply(reply);
+    return;
+  }
+  switch (reply.state) {
+    case ShmSegment::kFailed:
+      peer->segment->ReleaseReply(reply);
+      recv.done(reply.status, Rendezvous::Args(), recv.recv_args, Tensor(),
+                false);
+      recv.rendezvous->Unref();
+      break;
+    case ShmSegment::kFallback:
+      // The producer kept the tensor for a RecvTensor RPC.
+      peer->segment->ReleaseReply(reply);
+      recv.rendezvous->RecvFromRpc(recv.parsed, recv.recv_args,
+                                   std::move(recv.done));
+      recv.rendezvous->Unref();
+      break;
+    case ShmSegment::kReady:
+      // Copies the tensor out of the segment on another thread, so that
+      // the replies of this peer are not serialized.
+      env_->compute_pool->Schedule([peer, recv, reply]() {
+        Tensor val;
+        Status s = ReadTensor(recv, reply, &val);
+        peer->segment->ReleaseReply(reply);
+        recv.done(s, Rendezvous::Args(), recv.recv_args, val,
+                  s.ok() && reply.is_dead);
+        recv.rendezvous->Unref();
+      });
+      break;
+  }
+}
+
+/* static */
+Status ShmRendezvousMgr::ReadTensor(const PendingRecv& recv,
+                                    const ShmSegment::Reply& reply,
+                                    Tensor* val) {
+  if (reply.is_dead) {
+    return Status::OK();
+  }
+  const bool on_host = recv.recv_args.alloc_attrs.on_host() ||
+                       recv.dst_device->tensorflow_gpu_device_info() == nullptr;
+  if (on_host && !reply.is_proto) {
+    Tensor copy(recv.dst_device->GetAllocator(recv.recv_args.alloc_attrs),
+                reply.dtype, reply.shape);
+    if (copy.TotalBytes() != reply.data.size()) {
+      return errors::Internal("Received ", reply.data.size(), " bytes for ",
+                              recv.parsed.FullKey(), " instead of ",
+                              copy.TotalBytes());
+    }
+    memcpy(const_cast<char*>(copy.tensor_data().data()), reply.data.data(),
+           reply.data.size());
+    *val = copy;
+    return Status::OK();
+  }
+  TensorProto proto;
+  if (reply.is_proto) {
+    if (!proto.ParseFromArray(reply.data.data(), reply.data.size())) {
+      return errors::Internal("Failed to parse the tensor received for ",
+                              recv.parsed.FullKey());
+    }
+  } else {
+    proto.set_dtype(reply.dtype);
+    reply.shape.AsProto(proto.mutable_tensor_shape());
+    proto.set_tensor_content(reply.data.data(), reply.data.size());
+  }
+  return recv.dst_device->MakeTensorFromProto(proto, recv.recv_args.alloc_attrs,
+                                              val);
+}
+
+void ShmRendezvousMgr::ServeRequests() {
+  std::vector<ShmSegment::Request> requests;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (shutdown_) return;
+    }
+    requests.clear();
+    segment_->WaitForRequests(kWaitMicros, &requests);
+    for (const ShmSegment::Request& request : requests) {
+      ServeRequest(request);
+    }
+  }
+}
+
+void ShmRendezvousMgr::ServeRequest(const ShmSegment::Request& request) {
+  const int slot = request.slot;
+  const int64 step_id = request.step_id;
+  Rendezvous::ParsedKey parsed;
+  Status s = Rendezvous::ParseKey(request.key, &parsed);
+  Device* src_device = nullptr;
+  if (s.ok()) {
+    s = env_->device_mgr->LookupDevice(parsed.src_device, &src_device);
+  }
+  if (!s.ok()) {
+    segment_->SendError(slot, s);
+    return;
+  }
+
+  // The reference is held until the tensor is sent, so that it can be put
+  // back into the rendezvous if it does not fit in the segment.
+  ShmRemoteRendezvous* rendezvous =
+      static_cast<ShmRemoteRendezvous*>(Find(step_id));
+  rendezvous->RecvLocalAsync(
+      parsed, [this, slot, parsed, src_device, rendezvous](
+                  const Status& status, const Rendezvous::Args& send_args,
+                  const Rendezvous::Args& recv_args, const Tensor& val,
+                  const bool is_dead) {
+        if (!status.ok()) {
+          segment_->SendError(slot, status);
+          rendezvous->Unref();
+          return;
+        }
+        if (send_args.device_context) send_args.device_context->Ref();
+        auto send = [this, slot, parsed, rendezvous, send_args, val,
+                     is_dead](const Tensor& host_val) {
+          env_->compute_pool->Schedule([this, slot, parsed, rendezvous,
+                                        send_args, val, host_val, is_dead]() {
+            if (!segment_->SendReply(slot, host_val, is_dead,
+                                     kReplyTimeoutMicros)) {
+              // The requester will ask for the tensor through RPC.
+              Status s = rendezvous->Send(parsed, send_args, val, is_dead);
+              if (!s.ok()) {
+                LOG(WARNING) << "Failed to send " << parsed.FullKey()
+                             << " through RPC: " << s;
+              }
+            }
+            if (send_args.device_context) send_args.device_context->Unref();
+            rendezvous->Unref();
+          });
+        };
+        if (is_dead || val.TotalBytes() == 0 ||
+            send_args.alloc_attrs.on_host() ||
+            src_device->tensorflow_gpu_device_info() == nullptr) {
+          send(val);
+          return;
+        }
+#if GOOGLE_CUDA
+        // "val" is on a GPU, so it is copied into pinned host memory first.
+        AllocatorAttributes alloc_attrs;
+        alloc_attrs.set_gpu_compatible(true);
+        alloc_attrs.set_on_host(true);
+        Tensor* copy = new Tensor(src_device->GetAllocator(alloc_attrs),
+                                  val.dtype(), val.shape());
+        GPUUtil::CopyGPUTensorToCPU(
+            src_device, send_args.device_context, &val, copy,
+            [this, slot, send_args, rendezvous, copy,
+             send](const Status& s) {
+              if (s.ok()) {
+                send(*copy);
+              } else {
+                segment_->SendError(slot, s);
+                send_args.device_context->Unref();
+                rendezvous->Unref();
+              }
+              delete copy;
+            });
+#else
+        segment_->SendError(slot, errors::Internal("No GPU device in process"));
+        if (send_args.device_context) send_args.device_context->Unref();
+        rendezvous->Unref();
+#endif  // GOOGLE_CUDA
+      });
+}
+
+}  // namespace tensorflow
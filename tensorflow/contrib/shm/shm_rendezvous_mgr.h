@@ -0,0 +1,133 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_SHM_SHM_RENDEZVOUS_MGR_H_
+#define TENSORFLOW_CONTRIB_SHM_SHM_RENDEZVOUS_MGR_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/contrib/shm/shm_segment.h"
+#include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+
+namespace tensorflow {
+
+class Device;
+class ShmRemoteRendezvous;
+
+// A RendezvousMgr that receives tensors from the tasks on the same host
+// through their shared-memory segments (see ShmSegment), and from the
+// other tasks through an RpcRendezvousMgr.
+//
+// Each task serves the tensors it produces through a segment of its own.
+// A task finds out that a peer is on the same host when it opens the
+// segment of the peer, so no configuration is needed. A tensor is also
+// received through RPC if the segment of its producer is full, or too
+// small for the tensor.
+class ShmRendezvousMgr : public BaseRendezvousMgr {
+ public:
+  // "server_def" describes the cluster and the task of this process.
+  ShmRendezvousMgr(const WorkerEnv* env, const ServerDef& server_def);
+  ~ShmRendezvousMgr() override;
+
+  void Cleanup(int64 step_id) override;
+  void CleanupAll() override;
+
+  // Returns the name of the segment of task "task_id" of "job_name", in
+  // the cluster of "server_def".
+  static string SegmentName(const ServerDef& server_def,
+                            const string& job_name, int task_id);
+
+ protected:
+  BaseRemoteRendezvous* Create(int64 step_id,
+                               const WorkerEnv* worker_env) override;
+
+ private:
+  friend class ShmRemoteRendezvous;
+
+  // A request to a peer, which has not been answered.
+  struct PendingRecv {
+    ShmRemoteRendezvous* rendezvous;  // Owns a reference.
+    int64 step_id;
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  // The segment of a task on this host, and its pending requests.
+  struct Peer {
+    std::unique_ptr<ShmSegment> segment;
+    std::unique_ptr<Thread> waiter;
+    // Keyed by slot.
+    std::unordered_map<int, PendingRecv> pending;
+    bool closed = false;
+  };
+
+  // Requests "parsed" from the segment of its producer, and returns true,
+  // or returns false if the producer must be asked through RPC.
+  bool RecvFromPeer(ShmRemoteRendezvous* rendezvous, int64 step_id,
+                    const Rendezvous::ParsedKey& parsed, Device* dst_device,
+                    const Rendezvous::Args& recv_args,
+                    const Rendezvous::DoneCallback& done);
+
+  // Fails the pending requests of "step_id" with "status".
+  void AbortStep(int64 step_id, const Status& status);
+
+  // Returns the peer that serves "src_worker", opening its segment if
+  // necessary, or nullptr if it is not on this host.
+  Peer* FindPeer(const string& src_worker) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Receives the replies of the peer "peer_name".
+  void WaitForReplies(const string& peer_name, Peer* peer);
+  void HandleReply(Peer* peer, const ShmSegment::Reply& reply);
+  // Copies the tensor of "reply" to the device of "recv".
+  static Status ReadTensor(const PendingRecv& recv,
+                           const ShmSegment::Reply& reply, Tensor* val);
+
+  // Answers the requests posted in the segment of this task.
+  void ServeRequests();
+  void ServeRequest(const ShmSegment::Request& request);
+
+  const WorkerEnv* const env_;  // Not owned.
+  const ServerDef server_def_;
+
+  // Receives the tensors from the tasks on other hosts.
+  std::unique_ptr<BaseRendezvousMgr> rpc_mgr_;
+
+  // The segment served by this task, or nullptr if it could not be
+  // created.
+  std::unique_ptr<ShmSegment> segment_;
+  std::unique_ptr<Thread> server_;
+
+  mutex mu_;
+  bool shutdown_ GUARDED_BY(mu_) = false;
+  // Keyed by worker name.
+  std::unordered_map<string, std::unique_ptr<Peer>> peers_ GUARDED_BY(mu_);
+  // The time when each worker that is not on this host was looked for.
+  std::unordered_map<string, uint64> missing_peers_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRendezvousMgr);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_SHM_SHM_RENDEZVOUS_MGR_H_
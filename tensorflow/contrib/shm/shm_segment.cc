@@ -0,0 +1,509 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_segment.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+const uint64 kMagic = 0x54465f53484d5f31ull;  // "TF_SHM_1"
+const int kMaxDims = 16;
+const int kMaxErrorLength = 512;
+const int kMaxHostLength = 64;
+// The alignment of the tensors in the ring buffer.
+const uint64 kAlignment = 64;
+
+uint64 RoundUp(uint64 n) { return (n + kAlignment - 1) / kAlignment * kAlignment; }
+
+enum SlotState : uint32 {
+  kSlotFree = 0,
+  // Posted by a requester, and not yet seen by the owner.
+  kSlotPosted,
+  // Seen by the owner, which is waiting for the tensor.
+  kSlotClaimed,
+  // Answered by the owner.
+  kSlotReady,
+  kSlotFailed,
+  kSlotFallback,
+};
+
+// Precedes each allocation in the ring buffer. Its size keeps the
+// tensors aligned.
+struct ChunkHeader {
+  uint64 size;  // Including this header.
+  uint64 released;
+  char padding[kAlignment - 2 * sizeof(uint64)];
+};
+static_assert(sizeof(ChunkHeader) == kAlignment, "Misaligned ChunkHeader");
+
+bool GetHostName(char* host) {
+  memset(host, 0, kMaxHostLength);
+  return gethostname(host, kMaxHostLength - 1) == 0;
+}
+
+bool IsProcessAlive(pid_t pid) { return kill(pid, 0) == 0 || errno == EPERM; }
+
+}  // namespace
+
+struct ShmSlot {
+  uint32 state;
+  // Set when WaitForReplies() has returned the reply.
+  uint32 delivered;
+  pid_t requester;
+  int64 step_id;
+  uint32 key_length;
+  char key[ShmSegment::kMaxKeyLength];
+
+  // The reply.
+  uint32 is_dead;
+  uint32 is_proto;
+  int32 dtype;
+  int32 num_dims;
+  int64 dims[kMaxDims];
+  uint64 data_offset;
+  uint64 data_size;
+  int32 error_code;
+  char error[kMaxErrorLength];
+};
+
+struct ShmHeader {
+  uint64 magic;
+  pid_t owner;
+  char owner_host[kMaxHostLength];
+  // The ring buffer has "data_capacity" bytes starting at "data_start".
+  uint64 data_start;
+  uint64 data_capacity;
+
+  pthread_mutex_t mu;
+  // Signalled when a request is posted.
+  pthread_cond_t request_cv;
+  // Signalled when a request is answered, or space is freed.
+  pthread_cond_t reply_cv;
+
+  // The ring buffer holds the chunks between the offsets "tail" and
+  // "head", modulo "data_capacity". Both only grow.
+  uint64 head;
+  uint64 tail;
+  int32 next_slot;
+  ShmSlot slots[ShmSegment::kNumSlots];
+};
+
+ShmSegment::ShmSegment(const string& name, bool is_owner, ShmHeader* header,
+                       size_t mapped_size)
+    : name_(name),
+      is_owner_(is_owner),
+      header_(header),
+      mapped_size_(mapped_size) {}
+
+ShmSegment::~ShmSegment() {
+  munmap(header_, mapped_size_);
+  if (is_owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+/* static */
+Status ShmSegment::Create(const string& name, uint64 data_capacity,
+                          std::unique_ptr<ShmSegment>* segment) {
+  data_capacity = RoundUp(data_capacity);
+  const uint64 data_start = RoundUp(sizeof(ShmHeader));
+  const size_t size = data_start + data_capacity;
+
+  // Removes the segment of an earlier task with this name.
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::Internal("Failed to create shared memory segment ", name,
+                            ": ", strerror(errno));
+  }
+  if (ftruncate(fd, size) != 0) {
+    const int error = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return errors::ResourceExhausted("Failed to allocate ", size,
+                                     " bytes of shared memory for ", name,
+                                     ": ", strerror(error));
+  }
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::Internal("Failed to map shared memory segment ", name, ": ",
+                            strerror(errno));
+  }
+
+  // The segment is zero-filled by ftruncate().
+  ShmHeader* header = static_cast<ShmHeader*>(addr);
+  header->owner = getpid();
+  GetHostName(header->owner_host);
+  header->data_start = data_start;
+  header->data_capacity = data_capacity;
+
+  pthread_mutexattr_t mu_attr;
+  pthread_mutexattr_init(&mu_attr);
+  pthread_mutexattr_setpshared(&mu_attr, PTHREAD_PROCESS_SHARED);
+  // Lets the other processes recover the mutex if a process dies while
+  // holding it.
+  pthread_mutexattr_setrobust(&mu_attr, PTHREAD_MUTEX_ROBUST);
+  pthread_mutex_init(&header->mu, &mu_attr);
+  pthread_mutexattr_destroy(&mu_attr);
+
+  pthread_condattr_t cv_attr;
+  pthread_condattr_init(&cv_attr);
+  pthread_condattr_setpshared(&cv_attr, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&cv_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&header->request_cv, &cv_attr);
+  pthread_cond_init(&header->reply_cv, &cv_attr);
+  pthread_condattr_destroy(&cv_attr);
+
+  // Publishes the initialized header to the processes that open it.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+
+  segment->reset(new ShmSegment(name, true /* is_owner */, header, size));
+  return Status::OK();
+}
+
+/* static */
+Status ShmSegment::Open(const string& name,
+                        std::unique_ptr<ShmSegment>* segment) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::NotFound("No shared memory segment ", name, ": ",
+                            strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(ShmHeader)) {
+    close(fd);
+    return errors::NotFound("Shared memory segment ", name,
+                            " is not initialized");
+  }
+  const size_t size = st.st_size;
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return errors::Internal("Failed to map shared memory segment ", name, ": ",
+                            strerror(errno));
+  }
+  ShmHeader* header = static_cast<ShmHeader*>(addr);
+  std::unique_ptr<ShmSegment> s(
+      new ShmSegment(name, false /* is_owner */, header, size));
+
+  const bool initialized = header->magic == kMagic;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!initialized ||
+      header->data_start + header->data_capacity > static_cast<uint64>(size)) {
+    return errors::NotFound("Shared memory segment ", name,
+                            " is not initialized");
+  }
+  // A segment may be visible in another network namespace or left over
+  // from an earlier task, so check that its owner is running on this host.
+  char host[kMaxHostLength];
+  if (!GetHostName(host) || strcmp(host, header->owner_host) != 0) {
+    return errors::NotFound("Shared memory segment ", name,
+                            " belongs to host ", header->owner_host);
+  }
+  if (!s->IsOwnerAlive()) {
+    return errors::NotFound("The owner of shared memory segment ", name,
+                            " has exited");
+  }
+  *segment = std::move(s);
+  return Status::OK();
+}
+
+bool ShmSegment::IsOwnerAlive() const { return IsProcessAlive(header_->owner); }
+
+void ShmSegment::Lock() {
+  if (pthread_mutex_lock(&header_->mu) == EOWNERDEAD) {
+    // The previous holder died. Its updates of the slots are either
+    // complete or not visible to the other processes yet.
+    pthread_mutex_consistent(&header_->mu);
+  }
+}
+
+void ShmSegment::Unlock() { pthread_mutex_unlock(&header_->mu); }
+
+void ShmSegment::WaitLocked(pthread_cond_t* cv, int64 timeout_micros) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  const int64 nanos = deadline.tv_nsec + timeout_micros * 1000;
+  deadline.tv_sec += nanos / 1000000000;
+  deadline.tv_nsec = nanos % 1000000000;
+  if (pthread_cond_timedwait(cv, &header_->mu, &deadline) == EOWNERDEAD) {
+    pthread_mutex_consistent(&header_->mu);
+  }
+}
+
+uint64 ShmSegment::AllocateLocked(uint64 size) {
+  const uint64 capacity = header_->data_capacity;
+  const uint64 needed = RoundUp(sizeof(ChunkHeader) + size);
+  const uint64 pos = header_->head % capacity;
+  // A chunk does not wrap around the end of the ring buffer, so the rest
+  // of the buffer may have to be skipped.
+  const uint64 skipped = capacity - pos < needed ? capacity - pos : 0;
+  if (header_->head - header_->tail + skipped + needed > capacity) {
+    return 0;
+  }
+  char* data = base() + header_->data_start;
+  if (skipped > 0) {
+    ChunkHeader* padding = reinterpret_cast<ChunkHeader*>(data + pos);
+    padding->size = skipped;
+    padding->released = 1;
+    header_->head += skipped;
+  }
+  const uint64 chunk_pos = header_->head % capacity;
+  ChunkHeader* chunk = reinterpret_cast<ChunkHeader*>(data + chunk_pos);
+  chunk->size = needed;
+  chunk->released = 0;
+  header_->head += needed;
+  return header_->data_start + chunk_pos + sizeof(ChunkHeader);
+}
+
+void ShmSegment::FreeLocked(uint64 data_offset) {
+  ChunkHeader* chunk =
+      reinterpret_cast<ChunkHeader*>(base() + data_offset - sizeof(ChunkHeader));
+  chunk->released = 1;
+  // Chunks may be released in any order, but the space of a chunk is only
+  // reused when all of the chunks allocated before it are released.
+  char* data = base() + header_->data_start;
+  while (header_->tail != header_->head) {
+    ChunkHeader* oldest = reinterpret_cast<ChunkHeader*>(
+        data + header_->tail % header_->data_capacity);
+    if (!oldest->released) break;
+    header_->tail += oldest->size;
+  }
+}
+
+bool ShmSegment::PostRequest(int64 step_id, StringPiece key, int* slot) {
+  if (key.size() > static_cast<size_t>(kMaxKeyLength)) {
+    return false;
+  }
+  Lock();
+  bool found = false;
+  for (int i = 0; i < kNumSlots; ++i) {
+    const int index = (header_->next_slot + i) % kNumSlots;
+    ShmSlot* s = &header_->slots[index];
+    if (s->state == kSlotFree) {
+      s->requester = getpid();
+      s->delivered = 0;
+      s->step_id = step_id;
+      s->key_length = key.size();
+      memcpy(s->key, key.data(), key.size());
+      s->state = kSlotPosted;
+      header_->next_slot = (index + 1) % kNumSlots;
+      *slot = index;
+      found = true;
+      break;
+    }
+  }
+  if (found) {
+    pthread_cond_broadcast(&header_->request_cv);
+  }
+  Unlock();
+  return found;
+}
+
+void ShmSegment::ReadReplyLocked(int slot, Reply* reply) {
+  ShmSlot* s = &header_->slots[slot];
+  s->delivered = 1;
+  reply->slot = slot;
+  reply->is_dead = false;
+  reply->is_proto = false;
+  reply->dtype = DT_INVALID;
+  reply->shape = TensorShape();
+  reply->data = StringPiece();
+  switch (s->state) {
+    case kSlotReady:
+      reply->state = kReady;
+      reply->is_dead = s->is_dead;
+      reply->is_proto = s->is_proto;
+      reply->dtype = static_cast<DataType>(s->dtype);
+      for (int i = 0; i < s->num_dims; ++i) {
+        reply->shape.AddDim(s->dims[i]);
+      }
+      reply->data = StringPiece(base() + s->data_offset, s->data_size);
+      break;
+    case kSlotFailed:
+      reply->state = kFailed;
+      reply->status = Status(static_cast<error::Code>(s->error_code),
+                             StringPiece(s->error));
+      break;
+    default:
+      reply->state = kFallback;
+      break;
+  }
+}
+
+void ShmSegment::WaitForReplies(int64 timeout_micros,
+                                std::vector<Reply>* replies) {
+  const pid_t pid = getpid();
+  const size_t num_replies = replies->size();
+  Lock();
+  for (int pass = 0; pass < 2 && replies->size() == num_replies; ++pass) {
+    if (pass == 1) {
+      WaitLocked(&header_->reply_cv, timeout_micros);
+    }
+    for (int i = 0; i < kNumSlots; ++i) {
+      const ShmSlot& s = header_->slots[i];
+      if (s.requester == pid && !s.delivered &&
+          (s.state == kSlotReady || s.state == kSlotFailed ||
+           s.state == kSlotFallback)) {
+        replies->emplace_back();
+        ReadReplyLocked(i, &replies->back());
+      }
+    }
+  }
+  Unlock();
+}
+
+void ShmSegment::ReleaseReply(const Reply& reply) {
+  Lock();
+  ShmSlot* s = &header_->slots[reply.slot];
+  if (s->state == kSlotReady && s->data_size > 0) {
+    FreeLocked(s->data_offset);
+  }
+  s->state = kSlotFree;
+  s->requester = 0;
+  // Wakes up an owner waiting for space.
+  pthread_cond_broadcast(&header_->reply_cv);
+  Unlock();
+}
+
+void ShmSegment::WaitForRequests(int64 timeout_micros,
+                                 std::vector<Request>* requests) {
+  const size_t num_requests = requests->size();
+  Lock();
+  for (int pass = 0; pass < 2 && requests->size() == num_requests; ++pass) {
+    if (pass == 1) {
+      WaitLocked(&header_->request_cv, timeout_micros);
+    }
+    for (int i = 0; i < kNumSlots; ++i) {
+      ShmSlot* s = &header_->slots[i];
+      if (s->state == kSlotPosted) {
+        s->state = kSlotClaimed;
+        requests->push_back({i, s->step_id, string(s->key, s->key_length)});
+      } else if ((s->state == kSlotReady || s->state == kSlotFailed ||
+                  s->state == kSlotFallback) &&
+                 !IsProcessAlive(s->requester)) {
+        // Nobody will release the reply of a requester that has exited.
+        if (s->state == kSlotReady && s->data_size > 0) {
+          FreeLocked(s->data_offset);
+        }
+        s->state = kSlotFree;
+        s->requester = 0;
+      }
+    }
+  }
+  Unlock();
+}
+
+bool ShmSegment::SendReply(int slot, const Tensor& val, bool is_dead,
+                           int64 timeout_micros) {
+  // Tensors with a memcpy-able type are copied as they are, and the
+  // others as a serialized TensorProto.
+  const bool is_proto = !is_dead && (!DataTypeCanUseMemcpy(val.dtype()) ||
+                                     val.dims() > kMaxDims);
+  TensorProto proto;
+  uint64 size = 0;
+  if (is_proto) {
+    val.AsProtoTensorContent(&proto);
+    size = proto.ByteSize();
+  } else if (!is_dead) {
+    size = val.TotalBytes();
+  }
+
+  ShmSlot* s = &header_->slots[slot];
+  uint64 offset = 0;
+  if (size > 0) {
+    const int64 step_micros = 10000;
+    Lock();
+    for (int64 waited = 0; (offset = AllocateLocked(size)) == 0;
+         waited += step_micros) {
+      if (RoundUp(sizeof(ChunkHeader) + size) > header_->data_capacity ||
+          waited >= timeout_micros) {
+        s->state = kSlotFallback;
+        pthread_cond_broadcast(&header_->reply_cv);
+        Unlock();
+        return false;
+      }
+      WaitLocked(&header_->reply_cv, step_micros);
+    }
+    Unlock();
+    // The requester does not read the chunk before the slot is ready, so
+    // it is filled without holding the lock.
+    if (is_proto) {
+      proto.SerializeWithCachedSizesToArray(
+          reinterpret_cast<uint8*>(base() + offset));
+    } else {
+      memcpy(base() + offset, val.tensor_data().data(), size);
+    }
+  }
+
+  Lock();
+  s->is_dead = is_dead;
+  s->is_proto = is_proto;
+  s->dtype = val.dtype();
+  s->num_dims = is_proto || is_dead ? 0 : val.dims();
+  for (int i = 0; i < s->num_dims; ++i) {
+    s->dims[i] = val.dim_size(i);
+  }
+  s->data_offset = offset;
+  s->data_size = size;
+  s->state = kSlotReady;
+  pthread_cond_broadcast(&header_->reply_cv);
+  Unlock();
+  return true;
+}
+
+void ShmSegment::SendError(int slot, const Status& status) {
+  Lock();
+  ShmSlot* s = &header_->slots[slot];
+  s->error_code = status.code();
+  const string& message = status.error_message();
+  const size_t length =
+      std::min(message.size(), static_cast<size_t>(kMaxErrorLength - 1));
+  memcpy(s->error, message.data(), length);
+  s->error[length] = '\0';
+  s->state = kSlotFailed;
+  pthread_cond_broadcast(&header_->reply_cv);
+  Unlock();
+}
+
+void ShmSegment::NotifyOwner() {
+  Lock();
+  pthread_cond_broadcast(&header_->request_cv);
+  Unlock();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,174 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_SHM_SHM_SEGMENT_H_
+#define TENSORFLOW_CONTRIB_SHM_SHM_SEGMENT_H_
+
+#include <pthread.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+struct ShmHeader;
+
+// A ShmSegment is a named POSIX shared-memory region through which the
+// tasks on one host exchange tensors.
+//
+// Each task creates one segment, in which it is the sender: the other
+// tasks on the host open the segment and post requests for tensors in
+// its request slots, and the owner answers each request by copying the
+// tensor into a ring buffer in the segment. The requester reads the
+// tensor directly from the ring buffer, and then releases its slot and
+// the ring space of the tensor.
+//
+// The segment is synchronized with a process-shared mutex in the
+// segment, so all methods are thread-safe, and may be called from any
+// process that has the segment open.
+class ShmSegment {
+ public:
+  // The maximum length of a rendezvous key in a request.
+  static const int kMaxKeyLength = 1024;
+
+  // The number of requests that can be pending at the same time.
+  static const int kNumSlots = 1024;
+
+  // Creates a new segment called "name", with a ring buffer of
+  // "data_capacity" bytes, replacing any existing segment of that name.
+  // The segment is removed when the returned object is destroyed.
+  static Status Create(const string& name, uint64 data_capacity,
+                       std::unique_ptr<ShmSegment>* segment);
+
+  // Opens the existing segment "name" created by a task on this host.
+  // Returns NotFound if there is no such segment, or if the process that
+  // created it has exited.
+  static Status Open(const string& name, std::unique_ptr<ShmSegment>* segment);
+
+  ~ShmSegment();
+
+  const string& name() const { return name_; }
+
+  // Returns true if the process that created the segment is running.
+  bool IsOwnerAlive() const;
+
+  // The state of a reply, as seen by the requester.
+  enum ReplyState {
+    // The owner copied the tensor into the segment.
+    kReady,
+    // The owner could not produce the tensor.
+    kFailed,
+    // The owner did not copy the tensor into the segment, because it did
+    // not fit, and the requester must receive it from the owner by other
+    // means.
+    kFallback,
+  };
+
+  // A reply to a request, which is valid until ReleaseReply().
+  struct Reply {
+    int slot;
+    ReplyState state;
+    // If state == kFailed, the error.
+    Status status;
+    // If state == kReady, the tensor.
+    bool is_dead;
+    DataType dtype;
+    TensorShape shape;
+    // If true, "data" is a serialized TensorProto of the tensor. Otherwise,
+    // "data" is the content of a tensor of type "dtype" and shape "shape".
+    bool is_proto;
+    StringPiece data;
+  };
+
+  // Methods for requesters.
+
+  // Posts a request for the tensor "key" of step "step_id" on behalf of
+  // the calling process, and stores the slot of the request in "*slot".
+  // Returns false if the key is too long or all slots are taken, in which
+  // case the caller must request the tensor by other means.
+  bool PostRequest(int64 step_id, StringPiece key, int* slot);
+
+  // Waits up to "timeout_micros" for replies to requests of the calling
+  // process, and appends them to "*replies". Each reply is returned once.
+  //
+  // REQUIRES: Only one thread per process calls this method.
+  void WaitForReplies(int64 timeout_micros, std::vector<Reply>* replies);
+
+  // Frees the slot of "reply", and the space of its tensor.
+  void ReleaseReply(const Reply& reply);
+
+  // Methods for the owner.
+
+  // A request posted by PostRequest().
+  struct Request {
+    int slot;
+    int64 step_id;
+    string key;
+  };
+
+  // Waits up to "timeout_micros" for new requests, and appends them to
+  // "*requests". Also frees the replies to requesters that have exited.
+  void WaitForRequests(int64 timeout_micros, std::vector<Request>* requests);
+
+  // Copies "val", which must be in host memory, into the ring buffer as
+  // the reply to the request in "slot". If the space for "val" is not
+  // available within "timeout_micros", or "val" is larger than the ring
+  // buffer, answers the request with kFallback and returns false.
+  bool SendReply(int slot, const Tensor& val, bool is_dead,
+                 int64 timeout_micros);
+
+  // Answers the request in "slot" with the error "status".
+  void SendError(int slot, const Status& status);
+
+  // Wakes up the callers of WaitForRequests(), e.g. to shut down.
+  void NotifyOwner();
+
+ private:
+  ShmSegment(const string& name, bool is_owner, ShmHeader* header,
+             size_t mapped_size);
+
+  // Allocates "size" bytes in the ring buffer, and returns the offset of
+  // the data in the segment, or 0 if there is not enough space.
+  uint64 AllocateLocked(uint64 size);
+  void FreeLocked(uint64 data_offset);
+
+  void Lock();
+  void Unlock();
+  // Waits on "cv" for at most "timeout_micros".
+  void WaitLocked(pthread_cond_t* cv, int64 timeout_micros);
+
+  // Fills "*reply" from "slot", and marks it as delivered.
+  void ReadReplyLocked(int slot, Reply* reply);
+
+  char* base() const { return reinterpret_cast<char*>(header_); }
+
+  const string name_;
+  const bool is_owner_;
+  ShmHeader* const header_;
+  const size_t mapped_size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmSegment);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_SHM_SHM_SEGMENT_H_
@@ -0,0 +1,185 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_segment.h"
+
+#include <unistd.h>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string TestSegmentName(const string& test) {
+  return strings::StrCat("/tf_shm_test_", getpid(), "_", test);
+}
+
+// Posts a request in "requester", and returns the request as seen by
+// "owner".
+ShmSegment::Request PostRequest(ShmSegment* requester, ShmSegment* owner,
+                                const string& key) {
+  int slot;
+  CHECK(requester->PostRequest(7, key, &slot));
+  std::vector<ShmSegment::Request> requests;
+  owner->WaitForRequests(0, &requests);
+  CHECK_EQ(1, requests.size());
+  CHECK_EQ(slot, requests[0].slot);
+  return requests[0];
+}
+
+ShmSegment::Reply WaitForReply(ShmSegment* requester) {
+  std::vector<ShmSegment::Reply> replies;
+  requester->WaitForReplies(0, &replies);
+  CHECK_EQ(1, replies.size());
+  return replies[0];
+}
+
+TEST(ShmSegmentTest, OpenMissing) {
+  std::unique_ptr<ShmSegment> segment;
+  Status s = ShmSegment::Open(TestSegmentName("missing"), &segment);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+}
+
+TEST(ShmSegmentTest, SendTensor) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("send"), 1 << 20, &owner));
+  std::unique_ptr<ShmSegment> requester;
+  TF_ASSERT_OK(ShmSegment::Open(owner->name(), &requester));
+  EXPECT_TRUE(requester->IsOwnerAlive());
+
+  ShmSegment::Request request = PostRequest(requester.get(), owner.get(), "a");
+  EXPECT_EQ(7, request.step_id);
+  EXPECT_EQ("a", request.key);
+
+  Tensor val = test::AsTensor<float>({1.0f, 2.0f, 3.0f, 4.0f},
+                                     TensorShape({2, 2}));
+  EXPECT_TRUE(owner->SendReply(request.slot, val, false, 0));
+  ShmSegment::Reply reply = WaitForReply(requester.get());
+  EXPECT_EQ(ShmSegment::kReady, reply.state);
+  EXPECT_FALSE(reply.is_dead);
+  EXPECT_FALSE(reply.is_proto);
+  EXPECT_EQ(DT_FLOAT, reply.dtype);
+  EXPECT_EQ(val.shape(), reply.shape);
+  EXPECT_EQ(val.tensor_data(), reply.data);
+  requester->ReleaseReply(reply);
+
+  // A reply is returned once.
+  std::vector<ShmSegment::Reply> replies;
+  requester->WaitForReplies(0, &replies);
+  EXPECT_TRUE(replies.empty());
+}
+
+TEST(ShmSegmentTest, SendStringTensor) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("string"), 1 << 20, &owner));
+  std::unique_ptr<ShmSegment> requester;
+  TF_ASSERT_OK(ShmSegment::Open(owner->name(), &requester));
+
+  ShmSegment::Request request = PostRequest(requester.get(), owner.get(), "b");
+  Tensor val = test::AsTensor<string>({"hello", "world"});
+  EXPECT_TRUE(owner->SendReply(request.slot, val, false, 0));
+  ShmSegment::Reply reply = WaitForReply(requester.get());
+  EXPECT_EQ(ShmSegment::kReady, reply.state);
+  EXPECT_TRUE(reply.is_proto);
+  TensorProto proto;
+  ASSERT_TRUE(proto.ParseFromArray(reply.data.data(), reply.data.size()));
+  Tensor received;
+  ASSERT_TRUE(received.FromProto(proto));
+  test::ExpectTensorEqual<string>(val, received);
+  requester->ReleaseReply(reply);
+}
+
+TEST(ShmSegmentTest, SendError) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("error"), 1 << 20, &owner));
+  std::unique_ptr<ShmSegment> requester;
+  TF_ASSERT_OK(ShmSegment::Open(owner->name(), &requester));
+
+  ShmSegment::Request request = PostRequest(requester.get(), owner.get(), "c");
+  owner->SendError(request.slot, errors::Aborted("Step aborted"));
+  ShmSegment::Reply reply = WaitForReply(requester.get());
+  EXPECT_EQ(ShmSegment::kFailed, reply.state);
+  EXPECT_TRUE(errors::IsAborted(reply.status));
+  EXPECT_EQ("Step aborted", reply.status.error_message());
+  requester->ReleaseReply(reply);
+}
+
+TEST(ShmSegmentTest, FallbackWhenTooLarge) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("large"), 4096, &owner));
+  std::unique_ptr<ShmSegment> requester;
+  TF_ASSERT_OK(ShmSegment::Open(owner->name(), &requester));
+
+  ShmSegment::Request request = PostRequest(requester.get(), owner.get(), "d");
+  Tensor val(DT_FLOAT, TensorShape({4096}));
+  EXPECT_FALSE(owner->SendReply(request.slot, val, false, 0));
+  ShmSegment::Reply reply = WaitForReply(requester.get());
+  EXPECT_EQ(ShmSegment::kFallback, reply.state);
+  requester->ReleaseReply(reply);
+}
+
+TEST(ShmSegmentTest, ReusesReleasedSpace) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("reuse"), 4096, &owner));
+  std::unique_ptr<ShmSegment> requester;
+  TF_ASSERT_OK(ShmSegment::Open(owner->name(), &requester));
+
+  // Each tensor takes more than a third of the ring buffer, so the
+  // segment only has space for the next one once the last is released,
+  // and the tensors wrap around the end of the buffer.
+  Tensor val(DT_INT32, TensorShape({400}));
+  for (int i = 0; i < 10; ++i) {
+    val.flat<int32>().setConstant(i);
+    ShmSegment::Request request =
+        PostRequest(requester.get(), owner.get(), strings::StrCat("key", i));
+    ASSERT_TRUE(owner->SendReply(request.slot, val, false, 0));
+    ShmSegment::Reply reply = WaitForReply(requester.get());
+    ASSERT_EQ(ShmSegment::kReady, reply.state);
+    EXPECT_EQ(val.tensor_data(), reply.data);
+    requester->ReleaseReply(reply);
+  }
+}
+
+TEST(ShmSegmentTest, DeadTensor) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("dead"), 4096, &owner));
+  std::unique_ptr<ShmSegment> requester;
+  TF_ASSERT_OK(ShmSegment::Open(owner->name(), &requester));
+
+  ShmSegment::Request request = PostRequest(requester.get(), owner.get(), "e");
+  EXPECT_TRUE(owner->SendReply(request.slot, Tensor(), true, 0));
+  ShmSegment::Reply reply = WaitForReply(requester.get());
+  EXPECT_EQ(ShmSegment::kReady, reply.state);
+  EXPECT_TRUE(reply.is_dead);
+  EXPECT_TRUE(reply.data.empty());
+  requester->ReleaseReply(reply);
+}
+
+TEST(ShmSegmentTest, KeyTooLong) {
+  std::unique_ptr<ShmSegment> owner;
+  TF_ASSERT_OK(ShmSegment::Create(TestSegmentName("key"), 4096, &owner));
+  int slot;
+  EXPECT_FALSE(owner->PostRequest(
+      1, string(ShmSegment::kMaxKeyLength + 1, 'k'), &slot));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,39 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Sparse matrices in compressed sparse row (CSR) form.
+
+A `SparseTensor` lists its nonzeros as unordered coordinates, so the ops that
+consume it sort or scatter on every call. A `CSRSparseMatrix` keeps the
+nonzeros of a 2-D matrix grouped by row, sorted once at conversion.
+
+@@CSRSparseMatrix
+@@sparse_tensor_to_csr
+@@csr_to_sparse_tensor
+@@csr_matmul
+@@csr_add
+@@csr_transpose
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+# pylint: disable=unused-import,wildcard-import
+from tensorflow.contrib.sparse_matrix.python.ops.csr_sparse_matrix_ops import *
+# pylint: enable=unused-import,wildcard-import
+
+from tensorflow.python.util.all_util import remove_undocumented
+
+remove_undocumented(__name__)
@@ -0,0 +1,528 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Kernels for matrices in compressed sparse row (CSR) form. A CSR matrix is
+// passed as four tensors: int64 row_ptrs of length rows + 1, int64
+// col_indices and values of length nnz, and the int64 dense_shape
+// [rows, cols]. The nonzeros of row i are at [row_ptrs[i], row_ptrs[i + 1]),
+// with strictly increasing column indices.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Checks that 'dense_shape' is the shape of a matrix and returns its number
+// of rows and columns.
+Status GetMatrixShape(const Tensor& dense_shape, int64* rows, int64* cols) {
+  if (!TensorShapeUtils::IsVector(dense_shape.shape()) ||
+      dense_shape.NumElements() != 2) {
+    return errors::InvalidArgument(
+        "dense_shape must be a vector of length 2, got shape: ",
+        dense_shape.shape().DebugString());
+  }
+  const auto shape = dense_shape.vec<int64>();
+  if (shape(0) < 0 || shape(1) < 0) {
+    return errors::InvalidArgument("dense_shape must be nonnegative, got: [",
+                                   shape(0), ", ", shape(1), "]");
+  }
+  *rows = shape(0);
+  *cols = shape(1);
+  return Status::OK();
+}
+
+// Checks that inputs [first, first + 4) of 'ctx' are the row_ptrs,
+// col_indices, values and dense_shape of a valid CSR matrix and returns its
+// number of rows and columns.
+Status ValidateCSRInput(OpKernelContext* ctx, int first, int64* rows,
+                        int64* cols) {
+  const Tensor& row_ptrs_t = ctx->input(first);
+  const Tensor& col_indices_t = ctx->input(first + 1);
+  const Tensor& values_t = ctx->input(first + 2);
+  TF_RETURN_IF_ERROR(GetMatrixShape(ctx->input(first + 3), rows, cols));
+  if (!TensorShapeUtils::IsVector(row_ptrs_t.shape()) ||
+      row_ptrs_t.NumElements() != *rows + 1) {
+    return errors::InvalidArgument(
+        "row_ptrs must be a vector of length dense_shape[0] + 1 = ",
+        *rows + 1, ", got shape: ", row_ptrs_t.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(col_indices_t.shape()) ||
+      !TensorShapeUtils::IsVector(values_t.shape()) ||
+      col_indices_t.NumElements() != values_t.NumElements()) {
+    return errors::InvalidArgument(
+        "col_indices and values must be vectors of the same length, got "
+        "shapes: ",
+        col_indices_t.shape().DebugString(), " and ",
+        values_t.shape().DebugString());
+  }
+  const auto row_ptrs = row_ptrs_t.vec<int64>();
+  const auto col_indices = col_indices_t.vec<int64>();
+  const int64 nnz = col_indices_t.NumElements();
+  if (row_ptrs(0) != 0 || row_ptrs(*rows) != nnz) {
+    return errors::InvalidArgument(
+        "row_ptrs must start at 0 and end at the number of nonzeros ", nnz,
+        ", got: ", row_ptrs(0), " and ", row_ptrs(*rows));
+  }
+  for (int64 i = 0; i < *rows; ++i) {
+    if (row_ptrs(i + 1) < row_ptrs(i)) {
+      return errors::InvalidArgument("row_ptrs must be nondecreasing, got ",
+                                     row_ptrs(i), " followed by ",
+                                     row_ptrs(i + 1), " at row ", i);
+    }
+  }
+  for (int64 i = 0; i < *rows; ++i) {
+    for (int64 j = row_ptrs(i); j < row_ptrs(i + 1); ++j) {
+      const int64 col = col_indices(j);
+      if (!FastBoundsCheck(col, *cols)) {
+        return errors::InvalidArgument("col_indices[", j, "] = ", col,
+                                       " is out of bounds: need 0 <= index < ",
+                                       *cols);
+      }
+      if (j > row_ptrs(i) && col <= col_indices(j - 1)) {
+        return errors::InvalidArgument(
+            "col_indices must be strictly increasing within each row, got ",
+            col_indices(j - 1), " followed by ", col, " in row ", i);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+// Returns a cost per row for Shard, for work proportional to the number of
+// products 'per_nonzero' of every nonzero in an average row.
+int64 CostPerRow(int64 nnz, int64 rows, int64 per_nonzero) {
+  return std::max<int64>(1, (nnz / std::max<int64>(rows, 1) + 1) *
+                                per_nonzero);
+}
+
+}  // namespace
+
+template <typename T>
+class SparseTensorToCSROp : public OpKernel {
+ public:
+  explicit SparseTensorToCSROp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& indices_t = ctx->input(0);
+    const Tensor& values_t = ctx->input(1);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsMatrix(indices_t.shape()) &&
+                    indices_t.dim_size(1) == 2,
+                errors::InvalidArgument(
+                    "indices must be a matrix with 2 columns, got shape: ",
+                    indices_t.shape().DebugString()));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsVector(values_t.shape()) &&
+                    values_t.NumElements() == indices_t.dim_size(0),
+                errors::InvalidArgument(
+                    "values must be a vector with a value per index, got "
+                    "shape: ",
+                    values_t.shape().DebugString()));
+    int64 rows, cols;
+    OP_REQUIRES_OK(ctx, GetMatrixShape(ctx->input(2), &rows, &cols));
+    const int64 nnz = indices_t.dim_size(0);
+    const auto indices = indices_t.matrix<int64>();
+    const auto values = values_t.vec<T>();
+
+    Tensor* row_ptrs_t = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(0, TensorShape({rows + 1}), &row_ptrs_t));
+    Tensor* col_indices_t = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(1, TensorShape({nnz}), &col_indices_t));
+    Tensor* csr_values_t = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(2, TensorShape({nnz}), &csr_values_t));
+    auto row_ptrs = row_ptrs_t->vec<int64>();
+    auto col_indices = col_indices_t->vec<int64>();
+    auto csr_values = csr_values_t->vec<T>();
+
+    // Count the nonzeros of every row and place them row by row, in the
+    // order of the input, with a counting sort.
+    row_ptrs.setZero();
+    for (int64 i = 0; i < nnz; ++i) {
+      const int64 row = indices(i, 0);
+      const int64 col = indices(i, 1);
+      OP_REQUIRES(ctx, FastBoundsCheck(row, rows) && FastBoundsCheck(col, cols),
+                  errors::InvalidArgument(
+                      "indices[", i, "] = [", row, ", ", col,
+                      "] is out of bounds: need 0 <= index < [", rows, ", ",
+                      cols, "]"));
+      ++row_ptrs(row + 1);
+    }
+    for (int64 i = 0; i < rows; ++i) {
+      row_ptrs(i + 1) += row_ptrs(i);
+    }
+    std::vector<int64> order(nnz);
+    {
+      std::vector<int64> next(row_ptrs.data(), row_ptrs.data() + rows);
+      for (int64 i = 0; i < nnz; ++i) {
+        order[next[indices(i, 0)]++] = i;
+      }
+    }
+
+    // Sort the nonzeros of every row by column, in parallel over the rows.
+    auto sort_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        const int64 row_begin = row_ptrs(row);
+        const int64 row_end = row_ptrs(row + 1);
+        std::sort(order.begin() + row_begin, order.begin() + row_end,
+                  [&indices](int64 a, int64 b) {
+                    return indices(a, 1) < indices(b, 1);
+                  });
+        for (int64 j = row_begin; j < row_end; ++j) {
+          col_indices(j) = indices(order[j], 1);
+          csr_values(j) = values(order[j]);
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, rows,
+          CostPerRow(nnz, rows, 50), sort_rows);
+
+    for (int64 row = 0; row < rows; ++row) {
+      for (int64 j = row_ptrs(row) + 1; j < row_ptrs(row + 1); ++j) {
+        OP_REQUIRES(ctx, col_indices(j) != col_indices(j - 1),
+                    errors::InvalidArgument(
+                        "indices[", order[j], "] = [", row, ", ",
+                        col_indices(j), "] is repeated"));
+      }
+    }
+  }
+};
+
+#define REGISTER_KERNELS(type)                                             \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("SparseTensorToCSR").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      SparseTensorToCSROp<type>)
+
+TF_CALL_NUMBER_TYPES(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+template <typename T>
+class CSRToSparseTensorOp : public OpKernel {
+ public:
+  explicit CSRToSparseTensorOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    int64 rows, cols;
+    OP_REQUIRES_OK(ctx, ValidateCSRInput(ctx, 0, &rows, &cols));
+    const auto row_ptrs = ctx->input(0).vec<int64>();
+    const auto col_indices = ctx->input(1).vec<int64>();
+    const int64 nnz = col_indices.size();
+
+    Tensor* indices_t = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(0, TensorShape({nnz, 2}), &indices_t));
+    auto indices = indices_t->matrix<int64>();
+    for (int64 row = 0; row < rows; ++row) {
+      for (int64 j = row_ptrs(row); j < row_ptrs(row + 1); ++j) {
+        indices(j, 0) = row;
+        indices(j, 1) = col_indices(j);
+      }
+    }
+  }
+};
+
+#define REGISTER_KERNELS(type)                                             \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("CSRToSparseTensor").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      CSRToSparseTensorOp<type>)
+
+TF_CALL_NUMBER_TYPES(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+template <typename T>
+class CSRMatMulOp : public OpKernel {
+ public:
+  // Vectorize the products above this number of columns of b.
+  static const int64 kNumVectorize = 32;
+
+  explicit CSRMatMulOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    int64 rows, cols;
+    OP_REQUIRES_OK(ctx, ValidateCSRInput(ctx, 0, &rows, &cols));
+    const Tensor& b_t = ctx->input(4);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b_t.shape()),
+                errors::InvalidArgument("b must be a matrix, got shape: ",
+                                        b_t.shape().DebugString()));
+    OP_REQUIRES(ctx, b_t.dim_size(0) == cols,
+                errors::InvalidArgument(
+                    "Cannot multiply A and b because inner dimension does not "
+                    "match: ",
+                    cols, " vs. ", b_t.dim_size(0)));
+    const int64 n = b_t.dim_size(1);
+    const auto row_ptrs = ctx->input(0).vec<int64>();
+    const auto col_indices = ctx->input(1).vec<int64>();
+    const auto values = ctx->input(2).vec<T>();
+    const auto b = b_t.matrix<T>();
+
+    Tensor* product_t = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(0, TensorShape({rows, n}), &product_t));
+    if (product_t->NumElements() == 0) return;
+    auto product = product_t->matrix<T>();
+
+    auto compute_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        if (n < kNumVectorize) {
+          // Short rows: accumulate each output element in a register.
+          for (int64 k = 0; k < n; ++k) {
+            T sum(0);
+            for (int64 j = row_ptrs(row); j < row_ptrs(row + 1); ++j) {
+              sum += values(j) * b(col_indices(j), k);
+            }
+            product(row, k) = sum;
+          }
+        } else {
+          // Long rows: a vectorized AXPY per nonzero.
+          typename TTypes<T>::UnalignedVec product_row(&product(row, 0), n);
+          product_row.setZero();
+          for (int64 j = row_ptrs(row); j < row_ptrs(row + 1); ++j) {
+            typename TTypes<T>::UnalignedConstVec b_row(
+                &b(col_indices(j), 0), n);
+            product_row += b_row * values(j);
+          }
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, rows,
+          CostPerRow(values.size(), rows, 2 * n), compute_rows);
+  }
+};
+
+#define REGISTER_KERNELS(type)                                     \
+  REGISTER_KERNEL_BUILDER(                                         \
+      Name("CSRMatMul").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      CSRMatMulOp<type>)
+
+TF_CALL_float(REGISTER_KERNELS);
+TF_CALL_double(REGISTER_KERNELS);
+TF_CALL_int32(REGISTER_KERNELS);
+TF_CALL_complex64(REGISTER_KERNELS);
+TF_CALL_complex128(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+template <typename T>
+class CSRAddOp : public OpKernel {
+ public:
+  explicit CSRAddOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    int64 rows, cols;
+    OP_REQUIRES_OK(ctx, ValidateCSRInput(ctx, 0, &rows, &cols));
+    int64 b_rows, b_cols;
+    OP_REQUIRES_OK(ctx, ValidateCSRInput(ctx, 4, &b_rows, &b_cols));
+    OP_REQUIRES(ctx, rows == b_rows && cols == b_cols,
+                errors::InvalidArgument(
+                    "A and B must have the same shape, got: [", rows, ", ",
+                    cols, "] and [", b_rows, ", ", b_cols, "]"));
+    const Tensor& alpha_t = ctx->input(8);
+    const Tensor& beta_t = ctx->input(9);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(alpha_t.shape()) &&
+                    TensorShapeUtils::IsScalar(beta_t.shape()),
+                errors::InvalidArgument(
+                    "alpha and beta must be scalars, got shapes: ",
+                    alpha_t.shape().DebugString(), " and ",
+                    beta_t.shape().DebugString()));
+    const T alpha = alpha_t.scalar<T>()();
+    const T beta = beta_t.scalar<T>()();
+    const auto a_row_ptrs = ctx->input(0).vec<int64>();
+    const auto a_col_indices = ctx->input(1).vec<int64>();
+    const auto a_values = ctx->input(2).vec<T>();
+    const auto b_row_ptrs = ctx->input(4).vec<int64>();
+    const auto b_col_indices = ctx->input(5).vec<int64>();
+    const auto b_values = ctx->input(6).vec<T>();
+
+    Tensor* c_row_ptrs_t = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({rows + 1}),
+                                             &c_row_ptrs_t));
+    auto c_row_ptrs = c_row_ptrs_t->vec<int64>();
+
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_row =
+        CostPerRow(a_values.size() + b_values.size(), rows, 4);
+
+    // Count the union of the columns of every row, in parallel.
+    c_row_ptrs(0) = 0;
+    auto count_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        int64 ja = a_row_ptrs(row);
+        int64 jb = b_row_ptrs(row);
+        const int64 a_end = a_row_ptrs(row + 1);
+        const int64 b_end = b_row_ptrs(row + 1);
+        int64 count = 0;
+        while (ja < a_end && jb < b_end) {
+          const int64 a_col = a_col_indices(ja);
+          const int64 b_col = b_col_indices(jb);
+          if (a_col <= b_col) ++ja;
+          if (b_col <= a_col) ++jb;
+          ++count;
+        }
+        c_row_ptrs(row + 1) = count + (a_end - ja) + (b_end - jb);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, rows,
+          cost_per_row, count_rows);
+    for (int64 row = 0; row < rows; ++row) {
+      c_row_ptrs(row + 1) += c_row_ptrs(row);
+    }
+
+    const int64 c_nnz = c_row_ptrs(rows);
+    Tensor* c_col_indices_t = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({c_nnz}),
+                                             &c_col_indices_t));
+    Tensor* c_values_t = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(2, TensorShape({c_nnz}), &c_values_t));
+    auto c_col_indices = c_col_indices_t->vec<int64>();
+    auto c_values = c_values_t->vec<T>();
+
+    // Merge the rows, in parallel.
+    auto merge_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        int64 ja = a_row_ptrs(row);
+        int64 jb = b_row_ptrs(row);
+        const int64 a_end = a_row_ptrs(row + 1);
+        const int64 b_end = b_row_ptrs(row + 1);
+        int64 jc = c_row_ptrs(row);
+        while (ja < a_end && jb < b_end) {
+          const int64 a_col = a_col_indices(ja);
+          const int64 b_col = b_col_indices(jb);
+          if (a_col < b_col) {
+            c_col_indices(jc) = a_col;
+            c_values(jc) = alpha * a_values(ja++);
+          } else if (b_col < a_col) {
+            c_col_indices(jc) = b_col;
+            c_values(jc) = beta * b_values(jb++);
+          } else {
+            c_col_indices(jc) = a_col;
+            c_values(jc) = alpha * a_values(ja++) + beta * b_values(jb++);
+          }
+          ++jc;
+        }
+        for (; ja < a_end; ++ja, ++jc) {
+          c_col_indices(jc) = a_col_indices(ja);
+          c_values(jc) = alpha * a_values(ja);
+        }
+        for (; jb < b_end; ++jb, ++jc) {
+          c_col_indices(jc) = b_col_indices(jb);
+          c_values(jc) = beta * b_values(jb);
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, rows,
+          cost_per_row, merge_rows);
+  }
+};
+
+#define REGISTER_KERNELS(type)                                  \
+  REGISTER_KERNEL_BUILDER(                                      \
+      Name("CSRAdd").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      CSRAddOp<type>)
+
+TF_CALL_float(REGISTER_KERNELS);
+TF_CALL_double(REGISTER_KERNELS);
+TF_CALL_int32(REGISTER_KERNELS);
+TF_CALL_int64(REGISTER_KERNELS);
+TF_CALL_complex64(REGISTER_KERNELS);
+TF_CALL_complex128(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+template <typename T>
+class CSRTransposeOp : public OpKernel {
+ public:
+  explicit CSRTransposeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("conjugate", &conjugate_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    int64 rows, cols;
+    OP_REQUIRES_OK(ctx, ValidateCSRInput(ctx, 0, &rows, &cols));
+    const auto row_ptrs = ctx->input(0).vec<int64>();
+    const auto col_indices = ctx->input(1).vec<int64>();
+    const auto values = ctx->input(2).vec<T>();
+    const int64 nnz = values.size();
+
+    Tensor* t_row_ptrs_t = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({cols + 1}),
+                                             &t_row_ptrs_t));
+    Tensor* t_col_indices_t = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({nnz}),
+                                             &t_col_indices_t));
+    Tensor* t_values_t = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(2, TensorShape({nnz}), &t_values_t));
+    auto t_row_ptrs = t_row_ptrs_t->vec<int64>();
+    auto t_col_indices = t_col_indices_t->vec<int64>();
+    auto t_values = t_values_t->vec<T>();
+
+    // Counting sort over the columns. The rows are visited in increasing
+    // order, so the columns of every row of the transpose come out sorted.
+    t_row_ptrs.setZero();
+    for (int64 j = 0; j < nnz; ++j) {
+      ++t_row_ptrs(col_indices(j) + 1);
+    }
+    for (int64 col = 0; col < cols; ++col) {
+      t_row_ptrs(col + 1) += t_row_ptrs(col);
+    }
+    std::vector<int64> next(t_row_ptrs.data(), t_row_ptrs.data() + cols);
+    for (int64 row = 0; row < rows; ++row) {
+      for (int64 j = row_ptrs(row); j < row_ptrs(row + 1); ++j) {
+        const int64 t_j = next[col_indices(j)]++;
+        t_col_indices(t_j) = row;
+        t_values(t_j) = values(j);
+      }
+    }
+    if (conjugate_) {
+      t_values.device(ctx->eigen_device<CPUDevice>()) = t_values.conjugate();
+    }
+  }
+
+ private:
+  bool conjugate_;
+};
+
+#define REGISTER_KERNELS(type)                                        \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("CSRTranspose").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      CSRTransposeOp<type>)
+
+TF_CALL_NUMBER_TYPES(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
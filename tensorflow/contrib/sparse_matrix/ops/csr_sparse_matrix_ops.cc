@@ -0,0 +1,249 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/shape_inference.h"
+
+namespace tensorflow {
+
+using shape_inference::DimensionHandle;
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+namespace {
+
+// Checks the ranks of the four components of a CSR matrix starting at input
+// 'first' and merges the sizes of col_indices and values into '*nnz'.
+Status ValidateCSRComponents(InferenceContext* c, int first,
+                             DimensionHandle* nnz) {
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(first), 1, &unused));
+  ShapeHandle col_indices;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(first + 1), 1, &col_indices));
+  ShapeHandle values;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(first + 2), 1, &values));
+  ShapeHandle dense_shape;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(first + 3), 1, &dense_shape));
+  DimensionHandle unused_dim;
+  TF_RETURN_IF_ERROR(c->WithValue(c->Dim(dense_shape, 0), 2, &unused_dim));
+  return c->Merge(c->Dim(col_indices, 0), c->Dim(values, 0), nnz);
+}
+
+}  // namespace
+
+REGISTER_OP("SparseTensorToCSR")
+    .Input("indices: int64")
+    .Input("values: T")
+    .Input("dense_shape: int64")
+    .Output("row_ptrs: int64")
+    .Output("col_indices: int64")
+    .Output("csr_values: T")
+    .Attr("T: numbertype")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle indices;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &indices));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &values));
+      ShapeHandle dense_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &dense_shape));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(indices, 1), 2, &unused));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(dense_shape, 0), 2, &unused));
+      DimensionHandle nnz;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(indices, 0), c->Dim(values, 0), &nnz));
+      c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(1, c->Vector(nnz));
+      c->set_output(2, c->Vector(nnz));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Converts a 2-D `SparseTensor` to compressed sparse row (CSR) form.
+
+The indices of the `SparseTensor` need not be in any particular order. The
+output lists the nonzeros row by row, with strictly increasing column indices
+within each row: the nonzeros of row `i` are
+`col_indices[row_ptrs[i]:row_ptrs[i + 1]]` and
+`csr_values[row_ptrs[i]:row_ptrs[i + 1]]`. Repeated indices are an error.
+
+The CSR form is what the other `CSR*` ops consume, so a matrix that is used
+many times only pays for the sort once.
+
+indices: 2-D.  The `indices` of the `SparseTensor`, with shape `[nnz, 2]`.
+values: 1-D.  The `values` of the `SparseTensor`, with shape `[nnz]`.
+dense_shape: 1-D.  The `dense_shape` of the `SparseTensor`, with shape `[2]`.
+row_ptrs: 1-D.  The offsets of the rows in `col_indices` and `csr_values`,
+  with shape `[dense_shape[0] + 1]`.
+col_indices: 1-D.  The column of every nonzero, with shape `[nnz]`.
+csr_values: 1-D.  The value of every nonzero, with shape `[nnz]`.
+)doc");
+
+REGISTER_OP("CSRToSparseTensor")
+    .Input("row_ptrs: int64")
+    .Input("col_indices: int64")
+    .Input("values: T")
+    .Input("dense_shape: int64")
+    .Output("indices: int64")
+    .Attr("T: numbertype")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle nnz;
+      TF_RETURN_IF_ERROR(ValidateCSRComponents(c, 0, &nnz));
+      c->set_output(0, c->Matrix(nnz, 2));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Converts a CSR matrix to the `indices` of a 2-D `SparseTensor`.
+
+The `values` and `dense_shape` of the `SparseTensor` are those of the CSR
+matrix. The indices are in row-major order, so the result does not need a
+`SparseReorder`.
+
+row_ptrs: 1-D.  The row offsets of the CSR matrix.
+col_indices: 1-D.  The column indices of the CSR matrix.
+values: 1-D.  The values of the CSR matrix.
+dense_shape: 1-D.  The shape of the CSR matrix, `[rows, cols]`.
+indices: 2-D.  The indices of the nonzeros, with shape `[nnz, 2]`.
+)doc");
+
+REGISTER_OP("CSRMatMul")
+    .Input("a_row_ptrs: int64")
+    .Input("a_col_indices: int64")
+    .Input("a_values: T")
+    .Input("a_dense_shape: int64")
+    .Input("b: T")
+    .Output("product: T")
+    .Attr("T: {float, double, int32, complex64, complex128}")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle nnz;
+      TF_RETURN_IF_ERROR(ValidateCSRComponents(c, 0, &nnz));
+      ShapeHandle b;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 2, &b));
+      ShapeHandle a_shape;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(3, &a_shape));
+      TF_RETURN_IF_ERROR(c->WithRank(a_shape, 2, &a_shape));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(a_shape, 1), c->Dim(b, 0), &unused));
+      c->set_output(0, c->Matrix(c->Dim(a_shape, 0), c->Dim(b, 1)));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Multiply CSR matrix A by dense matrix B.
+
+The output rows are computed in parallel, each as a sum of rows of `b` scaled
+by the nonzeros of the matching row of A. A matrix-vector product is the case
+of `b` with a single column.
+
+a_row_ptrs: 1-D.  The row offsets of A.
+a_col_indices: 1-D.  The column indices of A.
+a_values: 1-D.  The values of A.
+a_dense_shape: 1-D.  The shape of A, `[m, k]`.
+b: 2-D.  A dense matrix with shape `[k, n]`.
+product: 2-D.  The dense matrix `A * b`, with shape `[m, n]`.
+)doc");
+
+REGISTER_OP("CSRAdd")
+    .Input("a_row_ptrs: int64")
+    .Input("a_col_indices: int64")
+    .Input("a_values: T")
+    .Input("a_dense_shape: int64")
+    .Input("b_row_ptrs: int64")
+    .Input("b_col_indices: int64")
+    .Input("b_values: T")
+    .Input("b_dense_shape: int64")
+    .Input("alpha: T")
+    .Input("beta: T")
+    .Output("c_row_ptrs: int64")
+    .Output("c_col_indices: int64")
+    .Output("c_values: T")
+    .Attr("T: {float, double, int32, int64, complex64, complex128}")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle a_nnz;
+      TF_RETURN_IF_ERROR(ValidateCSRComponents(c, 0, &a_nnz));
+      DimensionHandle b_nnz;
+      TF_RETURN_IF_ERROR(ValidateCSRComponents(c, 4, &b_nnz));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(8), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(9), 0, &unused));
+      ShapeHandle row_ptrs;
+      TF_RETURN_IF_ERROR(c->Merge(c->input(0), c->input(4), &row_ptrs));
+      c->set_output(0, row_ptrs);
+      c->set_output(1, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(2, c->Vector(InferenceContext::kUnknownDim));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes `alpha * A + beta * B` for CSR matrices A and B of the same shape.
+
+The nonzeros of the result are the union of those of A and B. Each row is
+merged in a single pass over the sorted column indices, and the rows are
+merged in parallel. Entries that cancel out are kept as explicit zeros.
+
+a_row_ptrs: 1-D.  The row offsets of A.
+a_col_indices: 1-D.  The column indices of A.
+a_values: 1-D.  The values of A.
+a_dense_shape: 1-D.  The shape of A.
+b_row_ptrs: 1-D.  The row offsets of B.
+b_col_indices: 1-D.  The column indices of B.
+b_values: 1-D.  The values of B.
+b_dense_shape: 1-D.  The shape of B, which must be that of A.
+alpha: 0-D.  The scale of A.
+beta: 0-D.  The scale of B.
+c_row_ptrs: 1-D.  The row offsets of the sum.
+c_col_indices: 1-D.  The column indices of the sum.
+c_values: 1-D.  The values of the sum.
+)doc");
+
+REGISTER_OP("CSRTranspose")
+    .Input("row_ptrs: int64")
+    .Input("col_indices: int64")
+    .Input("values: T")
+    .Input("dense_shape: int64")
+    .Output("transposed_row_ptrs: int64")
+    .Output("transposed_col_indices: int64")
+    .Output("transposed_values: T")
+    .Attr("T: numbertype")
+    .Attr("conjugate: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle nnz;
+      TF_RETURN_IF_ERROR(ValidateCSRComponents(c, 0, &nnz));
+      ShapeHandle shape;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(3, &shape));
+      TF_RETURN_IF_ERROR(c->WithRank(shape, 2, &shape));
+      DimensionHandle num_row_ptrs;
+      TF_RETURN_IF_ERROR(c->Add(c->Dim(shape, 1), 1, &num_row_ptrs));
+      c->set_output(0, c->Vector(num_row_ptrs));
+      c->set_output(1, c->Vector(nnz));
+      c->set_output(2, c->Vector(nnz));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Transposes a CSR matrix.
+
+The CSR form of the transpose is the compressed sparse column (CSC) form of
+the input, so this also converts between the two. It takes a single counting
+sort over the columns, in `O(nnz + cols)`.
+
+row_ptrs: 1-D.  The row offsets of the matrix.
+col_indices: 1-D.  The column indices of the matrix.
+values: 1-D.  The values of the matrix.
+dense_shape: 1-D.  The shape of the matrix, `[rows, cols]`.
+conjugate: If true, the values of the transpose are conjugated, which gives
+  the adjoint of a complex matrix.
+transposed_row_ptrs: 1-D.  The row offsets of the transpose, with shape
+  `[cols + 1]`.
+transposed_col_indices: 1-D.  The column indices of the transpose.
+transposed_values: 1-D.  The values of the transpose.
+)doc");
+
+}  // namespace tensorflow
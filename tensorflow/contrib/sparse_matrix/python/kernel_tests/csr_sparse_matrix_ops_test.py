@@ -0,0 +1,136 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for contrib.sparse_matrix.python.ops.csr_sparse_matrix_ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.sparse_matrix.python.ops import csr_sparse_matrix_ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.platform import test
+
+
+def _random_sparse(shape, density, dtype=np.float32, seed=0):
+  """Returns a dense matrix and a shuffled `SparseTensor` of its nonzeros."""
+  rng = np.random.RandomState(seed)
+  dense = rng.randn(*shape).astype(dtype)
+  dense[rng.rand(*shape) > density] = 0
+  indices = np.transpose(np.nonzero(dense)).astype(np.int64)
+  indices = indices[rng.permutation(len(indices))]
+  values = dense[indices[:, 0], indices[:, 1]]
+  sp = sparse_tensor.SparseTensor(indices, values,
+                                  np.array(shape, dtype=np.int64))
+  return dense, sp
+
+
+def _to_dense(csr_values):
+  """Expands evaluated CSR components to a dense matrix."""
+  row_ptrs, col_indices, values, dense_shape = csr_values
+  dense = np.zeros(dense_shape, dtype=values.dtype)
+  for row in range(dense_shape[0]):
+    for j in range(row_ptrs[row], row_ptrs[row + 1]):
+      dense[row, col_indices[j]] = values[j]
+  return dense
+
+
+class CSRSparseMatrixOpsTest(test.TestCase):
+
+  def testRoundTrip(self):
+    dense, sp = _random_sparse([20, 30], 0.2)
+    with self.test_session():
+      csr = csr_sparse_matrix_ops.sparse_tensor_to_csr(sp)
+      csr_values = [t.eval() for t in csr]
+      self.assertAllEqual(dense, _to_dense(csr_values))
+      row_ptrs, col_indices = csr_values[0], csr_values[1]
+      for row in range(20):
+        cols = col_indices[row_ptrs[row]:row_ptrs[row + 1]]
+        self.assertTrue(np.all(np.diff(cols) > 0))
+
+      back = csr_sparse_matrix_ops.csr_to_sparse_tensor(csr)
+      indices = back.indices.eval()
+      self.assertAllEqual(np.transpose(np.nonzero(dense)), indices)
+      self.assertAllEqual(dense[np.nonzero(dense)], back.values.eval())
+
+  def testRepeatedIndex(self):
+    sp = sparse_tensor.SparseTensor([[0, 1], [1, 0], [0, 1]], [1., 2., 3.],
+                                    [2, 2])
+    with self.test_session():
+      csr = csr_sparse_matrix_ops.sparse_tensor_to_csr(sp)
+      with self.assertRaisesOpError(r"indices\[2\] = \[0, 1\] is repeated"):
+        csr.values.eval()
+
+  def testInvalidCSR(self):
+    csr = csr_sparse_matrix_ops.CSRSparseMatrix(
+        np.array([0, 2, 1], dtype=np.int64), np.array([0, 1], dtype=np.int64),
+        np.array([1., 2.], dtype=np.float32),
+        np.array([2, 2], dtype=np.int64))
+    with self.test_session():
+      with self.assertRaisesOpError("row_ptrs must be nondecreasing"):
+        csr_sparse_matrix_ops.csr_transpose(csr).values.eval()
+
+  def testMatMul(self):
+    dense, sp = _random_sparse([50, 40], 0.1)
+    rng = np.random.RandomState(1)
+    with self.test_session():
+      csr = csr_sparse_matrix_ops.sparse_tensor_to_csr(sp)
+      # Both the narrow and the vectorized paths.
+      for n in [1, 5, 64]:
+        b = rng.randn(40, n).astype(np.float32)
+        self.assertAllClose(
+            np.dot(dense, b),
+            csr_sparse_matrix_ops.csr_matmul(csr, b).eval(), rtol=1e-5)
+      x = rng.randn(40).astype(np.float32)
+      self.assertAllClose(
+          np.dot(dense, x),
+          csr_sparse_matrix_ops.csr_matmul(csr, x).eval(), rtol=1e-5)
+
+  def testAdd(self):
+    a_dense, a_sp = _random_sparse([30, 20], 0.2, seed=2)
+    b_dense, b_sp = _random_sparse([30, 20], 0.2, seed=3)
+    with self.test_session():
+      a = csr_sparse_matrix_ops.sparse_tensor_to_csr(a_sp)
+      b = csr_sparse_matrix_ops.sparse_tensor_to_csr(b_sp)
+      c = csr_sparse_matrix_ops.csr_add(a, b, alpha=2., beta=-0.5)
+      c_values = [t.eval() for t in c]
+      self.assertAllClose(2. * a_dense - 0.5 * b_dense, _to_dense(c_values))
+      self.assertEqual(
+          np.count_nonzero((a_dense != 0) | (b_dense != 0)), len(c_values[1]))
+
+  def testTranspose(self):
+    dense, sp = _random_sparse([15, 25], 0.2)
+    with self.test_session():
+      csr = csr_sparse_matrix_ops.sparse_tensor_to_csr(sp)
+      transposed = csr_sparse_matrix_ops.csr_transpose(csr)
+      self.assertAllEqual(dense.T,
+                          _to_dense([t.eval() for t in transposed]))
+
+  def testAdjoint(self):
+    dense, _ = _random_sparse([10, 12], 0.3, dtype=np.complex64)
+    dense += 1j * dense
+    indices = np.transpose(np.nonzero(dense)).astype(np.int64)
+    sp = sparse_tensor.SparseTensor(indices,
+                                    dense[indices[:, 0], indices[:, 1]],
+                                    np.array([10, 12], dtype=np.int64))
+    with self.test_session():
+      csr = csr_sparse_matrix_ops.sparse_tensor_to_csr(sp)
+      adjoint = csr_sparse_matrix_ops.csr_transpose(csr, conjugate=True)
+      self.assertAllEqual(np.conj(dense.T),
+                          _to_dense([t.eval() for t in adjoint]))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,157 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Ops for sparse matrices in compressed sparse row (CSR) form."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import collections
+
+from tensorflow.contrib.sparse_matrix.ops import gen_csr_sparse_matrix_ops
+from tensorflow.contrib.util import loader
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import array_ops
+from tensorflow.python.platform import resource_loader
+
+_csr_sparse_matrix_ops_so = loader.load_op_library(
+    resource_loader.get_path_to_datafile("_csr_sparse_matrix_ops.so"))
+
+
+class CSRSparseMatrix(
+    collections.namedtuple("CSRSparseMatrix",
+                           ["row_ptrs", "col_indices", "values",
+                            "dense_shape"])):
+  """A 2-D sparse matrix in compressed sparse row (CSR) form.
+
+  The nonzeros of row `i` are at positions `row_ptrs[i]` to
+  `row_ptrs[i + 1] - 1` of `col_indices` and `values`, with strictly
+  increasing column indices. All the components are 1-D `Tensor`s, and
+  `row_ptrs`, `col_indices` and `dense_shape` are `int64`.
+
+  The compressed sparse column (CSC) form of a matrix is the CSR form of its
+  transpose; see `csr_transpose`.
+  """
+  __slots__ = ()
+
+
+def sparse_tensor_to_csr(sp_input, name=None):
+  """Converts a 2-D `SparseTensor` to a `CSRSparseMatrix`.
+
+  The indices of `sp_input` need not be ordered. The sort happens once here,
+  so a matrix that is multiplied or added many times should be converted once
+  and reused.
+
+  Args:
+    sp_input: A 2-D `SparseTensor`, with no repeated indices.
+    name: A name for the operation (optional).
+
+  Returns:
+    A `CSRSparseMatrix` with the nonzeros of `sp_input`.
+  """
+  with ops.name_scope(name, "SparseTensorToCSR", [sp_input]) as name:
+    sp_input = sparse_tensor.convert_to_tensor_or_sparse_tensor(sp_input)
+    row_ptrs, col_indices, values = (
+        gen_csr_sparse_matrix_ops.sparse_tensor_to_csr(
+            sp_input.indices, sp_input.values, sp_input.dense_shape,
+            name=name))
+    return CSRSparseMatrix(row_ptrs, col_indices, values,
+                           sp_input.dense_shape)
+
+
+def csr_to_sparse_tensor(csr, name=None):
+  """Converts a `CSRSparseMatrix` to a `SparseTensor`.
+
+  Args:
+    csr: A `CSRSparseMatrix`.
+    name: A name for the operation (optional).
+
+  Returns:
+    A `SparseTensor` with the nonzeros of `csr`, in row-major order.
+  """
+  with ops.name_scope(name, "CSRToSparseTensor", list(csr)) as name:
+    indices = gen_csr_sparse_matrix_ops.csr_to_sparse_tensor(
+        csr.row_ptrs, csr.col_indices, csr.values, csr.dense_shape, name=name)
+    return sparse_tensor.SparseTensor(indices, csr.values, csr.dense_shape)
+
+
+def csr_matmul(a, b, name=None):
+  """Multiplies a `CSRSparseMatrix` by a dense matrix or vector.
+
+  Args:
+    a: A `CSRSparseMatrix` with shape `[m, k]`.
+    b: A dense `Tensor` with shape `[k, n]`, or a vector with shape `[k]`.
+    name: A name for the operation (optional).
+
+  Returns:
+    The dense product `a * b`, with shape `[m, n]`, or `[m]` if `b` is a
+    vector.
+  """
+  with ops.name_scope(name, "CSRMatMul", list(a) + [b]) as name:
+    b = ops.convert_to_tensor(b, name="b")
+    is_vector = b.get_shape().ndims == 1
+    if is_vector:
+      b = array_ops.expand_dims(b, 1)
+    product = gen_csr_sparse_matrix_ops.csr_mat_mul(
+        a.row_ptrs, a.col_indices, a.values, a.dense_shape, b, name=name)
+    if is_vector:
+      product = array_ops.squeeze(product, [1])
+    return product
+
+
+def csr_add(a, b, alpha=1, beta=1, name=None):
+  """Computes `alpha * a + beta * b` for two `CSRSparseMatrix`es.
+
+  The nonzeros of the result are the union of those of `a` and `b`; entries
+  that cancel out are kept as explicit zeros.
+
+  Args:
+    a: A `CSRSparseMatrix`.
+    b: A `CSRSparseMatrix` with the shape and dtype of `a`.
+    alpha: A scalar, the scale of `a`.
+    beta: A scalar, the scale of `b`.
+    name: A name for the operation (optional).
+
+  Returns:
+    A `CSRSparseMatrix` with the sum.
+  """
+  with ops.name_scope(name, "CSRAdd", list(a) + list(b)) as name:
+    alpha = ops.convert_to_tensor(alpha, dtype=a.values.dtype, name="alpha")
+    beta = ops.convert_to_tensor(beta, dtype=a.values.dtype, name="beta")
+    row_ptrs, col_indices, values = gen_csr_sparse_matrix_ops.csr_add(
+        a.row_ptrs, a.col_indices, a.values, a.dense_shape,
+        b.row_ptrs, b.col_indices, b.values, b.dense_shape,
+        alpha, beta, name=name)
+    return CSRSparseMatrix(row_ptrs, col_indices, values, a.dense_shape)
+
+
+def csr_transpose(csr, conjugate=False, name=None):
+  """Transposes a `CSRSparseMatrix`.
+
+  Args:
+    csr: A `CSRSparseMatrix` with shape `[m, n]`.
+    conjugate: If true, also conjugates the values, for the adjoint of a
+      complex matrix.
+    name: A name for the operation (optional).
+
+  Returns:
+    A `CSRSparseMatrix` with shape `[n, m]`.
+  """
+  with ops.name_scope(name, "CSRTranspose", list(csr)) as name:
+    row_ptrs, col_indices, values = gen_csr_sparse_matrix_ops.csr_transpose(
+        csr.row_ptrs, csr.col_indices, csr.values, csr.dense_shape,
+        conjugate=conjugate, name=name)
+    dense_shape = array_ops.reverse_v2(csr.dense_shape, [0])
+    return CSRSparseMatrix(row_ptrs, col_indices, values, dense_shape)
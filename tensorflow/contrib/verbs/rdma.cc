@@ -16,11 +16,17 @@ limitations under the License.
 #ifdef TENSORFLOW_USE_VERBS
 
 #include "tensorflow/contrib/verbs/rdma.h"
+#include <algorithm>
 #include <cstdlib>
+#include <set>
 #include "tensorflow/contrib/verbs/verbs_util.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
+#include "tensorflow/core/common_runtime/visitable_allocator.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/process_state.h"
+#endif  // GOOGLE_CUDA
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 #include "tensorflow/core/framework/rendezvous.h"
@@ -83,16 +89,74 @@ ibv_pd* alloc_protection_domain(ibv_context* context) {
   return pd;
 }
 
-RdmaAdapter::RdmaAdapter(const WorkerEnv* worker_env)
+RdmaAdapter::RdmaAdapter(const WorkerEnv* worker_env, bool gpu_direct)
     : context_(open_default_device()),
       pd_(alloc_protection_domain(context_)),
-      worker_env_(worker_env) {
+      worker_env_(worker_env),
+      gpu_direct_(gpu_direct) {
   event_channel_ = ibv_create_comp_channel(context_);
   CHECK(event_channel_) << "Failed to create completion channel";
   cq_ = ibv_create_cq(context_, MAX_CONCURRENT_WRITES * 2, NULL, event_channel_,
                       0);
   CHECK(cq_) << "Failed to create completion queue";
   CHECK(!ibv_req_notify_cq(cq_, 0)) << "Failed to request CQ notification";
+  // Register the regions of the allocators of the local CPU devices, so
+  // that their tensors are RDMA-written in place instead of being copied
+  // into the tensor buffers. The allocators visit the regions that they
+  // already have, and those that they allocate later.
+  std::set<Allocator*> cpu_allocators;
+  for (Device* d : worker_env_->device_mgr->ListDevices()) {
+    if (d->device_type() != DEVICE_CPU) continue;
+    Allocator* allocator = d->GetAllocator(AllocatorAttributes());
+    if (!cpu_allocators.insert(allocator).second) continue;
+    VisitableAllocator* visitable =
+        dynamic_cast<VisitableAllocator*>(allocator);
+    if (visitable == nullptr) {
+      VLOG(1) << "Tensors of " << d->name() << " are copied into the RDMA "
+              << "buffers: its allocator " << allocator->Name()
+              << " cannot be registered with " << name() << ". Set "
+              << "use_pooled_cpu_allocator to send them in place.";
+      continue;
+    }
+    visitable->AddAllocVisitor([this](void* addr, size_t length) {
+      if (!RegisterMemoryRegion(addr, length)) {
+        LOG(WARNING) << "Failed to register " << length << " bytes of host "
+                     << "memory with " << name();
+      }
+    });
+    visitable->AddFreeVisitor(
+        [this](void* addr, size_t length) { DeregisterMemoryRegion(addr); });
+  }
+  if (gpu_direct_) {
+#if GOOGLE_CUDA
+    // Register the regions of the GPU allocators on the buses of the local
+    // GPUs, including those that they allocate later. This requires
+    // peer memory support for the adapter (e.g. the nv_peer_mem module).
+    // The adapter lives as long as the server, so the visitors never
+    // outlive it.
+    std::set<int> bus_ids;
+    for (Device* d : worker_env_->device_mgr->ListDevices()) {
+      if (d->tensorflow_gpu_device_info()) {
+        bus_ids.insert(d->attributes().locality().bus_id());
+      }
+    }
+    for (int bus_id : bus_ids) {
+      ProcessState::singleton()->AddGPUAllocVisitor(
+          bus_id, [this](void* addr, size_t length) {
+            if (!RegisterMemoryRegion(addr, length)) {
+              LOG(WARNING) << "Failed to register " << length << " bytes of "
+                           << "GPU memory with " << name() << "; GPUDirect "
+                           << "RDMA requires peer memory support for the "
+                           << "adapter.";
+            }
+          });
+    }
+#else
+    LOG(WARNING) << "RPCOptions.verbs_gpu_direct has no effect without GPU "
+                 << "support.";
+    gpu_direct_ = false;
+#endif  // GOOGLE_CUDA
+  }
   polling_thread_.reset(Env::Default()->StartThread(
       ThreadOptions(), "RdmaAdapterCQThread", [this] { Process_CQ(); }));
   VLOG(2) << "Start RdmaAdapter: " << name();
@@ -100,6 +164,12 @@ RdmaAdapter::RdmaAdapter(const WorkerEnv* worker_env)
 
 RdmaAdapter::~RdmaAdapter() {
   polling_thread_.reset();
+  {
+    mutex_lock lock{mr_mu_};
+    for (ibv_mr* mr : mrs_) {
+      CHECK(!ibv_dereg_mr(mr)) << "ibv_dereg_mr failed";
+    }
+  }
   CHECK(!ibv_destroy_cq(cq_)) << "Failed to destroy CQ";
   CHECK(!ibv_destroy_comp_channel(event_channel_))
       << "Failed to destroy channel";
@@ -109,6 +179,51 @@ RdmaAdapter::~RdmaAdapter() {
 
 string RdmaAdapter::name() const { return string(context_->device->name); }
 
+bool RdmaAdapter::RegisterMemoryRegion(void* addr, size_t length) {
+  ibv_mr* mr = ibv_reg_mr(pd_, addr, length,
+                          IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+  if (mr == nullptr) {
+    return false;
+  }
+  VLOG(2) << "Registered memory region of " << length << " bytes with "
+          << name();
+  mutex_lock lock{mr_mu_};
+  auto iter = std::upper_bound(
+      mrs_.begin(), mrs_.end(), addr,
+      [](const void* a, const ibv_mr* b) { return a < b->addr; });
+  mrs_.insert(iter, mr);
+  return true;
+}
+
+void RdmaAdapter::DeregisterMemoryRegion(void* addr) {
+  mutex_lock lock{mr_mu_};
+  auto iter = std::lower_bound(
+      mrs_.begin(), mrs_.end(), addr,
+      [](const ibv_mr* a, const void* b) { return a->addr < b; });
+  if (iter == mrs_.end() || (*iter)->addr != addr) {
+    // The region failed to register.
+    return;
+  }
+  CHECK(!ibv_dereg_mr(*iter)) << "ibv_dereg_mr failed";
+  mrs_.erase(iter);
+}
+
+ibv_mr* RdmaAdapter::FindMemoryRegion(const void* addr, size_t length) const {
+  mutex_lock lock{mr_mu_};
+  auto iter = std::upper_bound(
+      mrs_.begin(), mrs_.end(), addr,
+      [](const void* a, const ibv_mr* b) { return a < b->addr; });
+  if (iter == mrs_.begin()) {
+    return nullptr;
+  }
+  ibv_mr* mr = *(iter - 1);
+  const char* begin = static_cast<const char*>(mr->addr);
+  if (static_cast<const char*>(addr) + length > begin + mr->length) {
+    return nullptr;
+  }
+  return mr;
+}
+
 // Function to process incoming messages
 // There are two types of messages:
 // 1. IBV_WC_RECV_RDMA_WITH_IMM (receive)
@@ -179,6 +294,9 @@ void RdmaAdapter::Process_CQ() {
           rmr.rkey = rm.rkey_;
           tb->SetRemoteMR(rmr, true);
           tb->CreateCPUBuffer(rm.buffer_size_);
+          if (rm.device_buffer_size_ > 0) {
+            tb->CreateDeviceBuffer(rm.device_buffer_size_);
+          }
           // create RDMA_MESSAGE_BUFFER_RESPONSE message
           RdmaMessage br;
           br.type_ = RDMA_MESSAGE_BUFFER_RESPONSE;
@@ -187,6 +305,12 @@ void RdmaAdapter::Process_CQ() {
           br.buffer_size_ = rm.buffer_size_;
           br.remote_addr_ = reinterpret_cast<uint64_t>(tb->buffer_);
           br.rkey_ = tb->self_->rkey;
+          if (rm.device_buffer_size_ > 0) {
+            br.device_buffer_size_ = rm.device_buffer_size_;
+            br.device_remote_addr_ = reinterpret_cast<uint64_t>(
+                DMAHelper::base(&tb->device_tensor_));
+            br.device_rkey_ = tb->device_mr_->rkey;
+          }
           string message = RdmaMessage::CreateMessage(br);
           RdmaBuffer* mb = rc->tx_message_buffer_;
           mb->EnqueueItem(message);
@@ -205,6 +329,12 @@ void RdmaAdapter::Process_CQ() {
           rmr.remote_addr = rm.remote_addr_;
           rmr.rkey = rm.rkey_;
           tb->SetRemoteMR(rmr, true);
+          if (rm.device_buffer_size_ > 0) {
+            RemoteMR device_rmr;
+            device_rmr.remote_addr = rm.device_remote_addr_;
+            device_rmr.rkey = rm.device_rkey_;
+            tb->SetRemoteDeviceMR(device_rmr);
+          }
           tb->SetBufferStatus(local, idle);
           tb->SetBufferStatus(remote, idle);
           worker_env_->compute_pool->Schedule([tb]() { tb->SendNextItem(); });
@@ -218,6 +348,7 @@ void RdmaAdapter::Process_CQ() {
         }
       } else if (wc_[i].opcode == IBV_WC_RDMA_WRITE) {
         RdmaBuffer* rb = reinterpret_cast<RdmaBuffer*>(wc_[i].wr_id);
+        rb->WriteDone();
         rb->SetBufferStatus(local, idle);
         RdmaMessage rm;
         RdmaMessage::ParseMessage(rm, rb->buffer_);
@@ -241,7 +372,9 @@ RdmaChannel::RdmaChannel(const RdmaAdapter* adapter, const string local_name,
     attr.recv_cq = adapter_->cq_;
     attr.cap.max_send_wr = RdmaAdapter::MAX_CONCURRENT_WRITES;
     attr.cap.max_recv_wr = RdmaAdapter::MAX_CONCURRENT_WRITES;
-    attr.cap.max_send_sge = 1;
+    // The message and the data of a tensor in registered memory are
+    // gathered into one write.
+    attr.cap.max_send_sge = 2;
     attr.cap.max_recv_sge = 1;
     attr.qp_type = IBV_QPT_RC;
 
@@ -535,9 +668,11 @@ void RdmaBuffer::FreeBuffer() {
   if ((buffer_ != nullptr) && buffer_on_host_) {
     free(buffer_);
   }
-  // TODO
-  // release buffer if it is on device.
-  // We don't support RDMABuffer on device at this moment.
+  // The device buffer is returned to its allocator, and its memory
+  // region stays registered with the adapter.
+  device_size_ = 0;
+  device_tensor_ = Tensor();
+  device_mr_ = nullptr;
 }
 
 // Allocate CPU memory for the Rdma buffer
@@ -568,6 +703,36 @@ void RdmaBuffer::CreateCPUBuffer(size_t size, bool lock) {
   }
 }
 
+// Allocate GPU memory for the data of the tensor named by the buffer,
+// on the device that receives it. The memory comes from the device's
+// allocator, whose regions are registered with the adapter.
+// Args:
+//   size: to-be-allocated memory size
+// Returns:
+//   None
+void RdmaBuffer::CreateDeviceBuffer(size_t size) {
+  CHECK(size > 0);
+  Rendezvous::ParsedKey parsed;
+  Status s = Rendezvous::ParseKey(name_, &parsed);
+  CHECK(s.ok()) << "Failed to parse key " << name_ << ": " << s;
+  Device* dst_dev = nullptr;
+  s = channel_->adapter_->worker_env_->device_mgr->LookupDevice(
+      parsed.dst_device, &dst_dev);
+  CHECK(s.ok()) << "dst device not found";
+  Tensor device_tensor(dst_dev->GetAllocator(AllocatorAttributes()), DT_UINT8,
+                       TensorShape({static_cast<int64>(size)}));
+  ibv_mr* mr = channel_->adapter_->FindMemoryRegion(
+      DMAHelper::base(&device_tensor), size);
+  CHECK(mr) << "GPU memory of " << dst_dev->name() << " is not registered "
+            << "with " << channel_->adapter_->name() << "; GPUDirect RDMA "
+            << "requires RPCOptions.verbs_gpu_direct on all workers and peer "
+            << "memory support for the adapter.";
+  mutex_lock lock{mu_};
+  device_size_ = size;
+  device_tensor_ = device_tensor;
+  device_mr_ = mr;
+}
+
 // Set address of remote memory region
 // Args:
 //   rmr: address of remote memory region
@@ -586,6 +751,17 @@ void RdmaBuffer::SetRemoteMR(RemoteMR rmr, bool override) {
   }
 }
 
+// Set address of remote device memory region, for GPUDirect RDMA
+// Args:
+//   rmr: address of remote device memory region
+// Returns:
+//   None
+void RdmaBuffer::SetRemoteDeviceMR(RemoteMR rmr) {
+  mutex_lock lock{mu_};
+  remote_device_.remote_addr = rmr.remote_addr;
+  remote_device_.rkey = rmr.rkey;
+}
+
 // Put a task in the buffer's job queue
 void RdmaBuffer::EnqueueItem(string item) {
   mutex_lock lock{mu_};
@@ -623,6 +799,78 @@ RdmaMessageBuffer::RdmaMessageBuffer(RdmaChannel* channel, string name)
 RdmaTensorBuffer::RdmaTensorBuffer(RdmaChannel* channel, string name)
     : RdmaBuffer(channel, name) {}
 
+void RdmaTensorBuffer::WriteDone() {
+  mutex_lock lock{mu_};
+  in_flight_tensor_ = Tensor();
+}
+
+// Rdma-Write the data of a GPU tensor into the remote device buffer, then
+// the message in the buffer. Work requests on a queue pair are executed in
+// order, so the data has arrived when the receiver sees the message.
+void RdmaTensorBuffer::WriteWithDeviceData(uint32_t imm_data,
+                                           size_t buffer_size,
+                                           const Tensor& in, ibv_mr* mr) {
+  struct ibv_sge data_list;
+  data_list.addr = reinterpret_cast<uint64_t>(DMAHelper::base(&in));
+  data_list.length = in.TotalBytes();
+  data_list.lkey = mr->lkey;
+
+  struct ibv_sge message_list;
+  message_list.addr = (uint64_t)buffer_;
+  message_list.length = buffer_size;
+  message_list.lkey = self_->lkey;
+
+  struct ibv_send_wr wr[2];
+  memset(wr, 0, sizeof(wr));
+  // The data write is unsignaled; it completes with the message write.
+  wr[0].wr_id = (uint64_t)this;
+  wr[0].sg_list = &data_list;
+  wr[0].num_sge = 1;
+  wr[0].opcode = IBV_WR_RDMA_WRITE;
+  wr[0].wr.rdma.remote_addr = (uint64_t)remote_device_.remote_addr;
+  wr[0].wr.rdma.rkey = remote_device_.rkey;
+  wr[0].next = &wr[1];
+
+  wr[1].wr_id = (uint64_t)this;
+  wr[1].sg_list = &message_list;
+  wr[1].num_sge = 1;
+  wr[1].opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  wr[1].send_flags = IBV_SEND_SIGNALED;
+  wr[1].imm_data = imm_data;
+  wr[1].wr.rdma.remote_addr = (uint64_t)remote_.remote_addr;
+  wr[1].wr.rdma.rkey = remote_.rkey;
+
+  struct ibv_send_wr* bad_wr;
+  CHECK(!ibv_post_send(channel_->qp_, wr, &bad_wr)) << "Failed to post send";
+}
+
+// Rdma-Write the message in the buffer followed by the data of a tensor in
+// registered host memory, which the adapter gathers from both regions.
+void RdmaTensorBuffer::WriteWithHostData(uint32_t imm_data, const Tensor& in,
+                                         ibv_mr* mr) {
+  struct ibv_sge list[2];
+  list[0].addr = (uint64_t)buffer_;
+  list[0].length = RdmaMessage::kMessageTotalBytes;
+  list[0].lkey = self_->lkey;
+  list[1].addr = reinterpret_cast<uint64_t>(DMAHelper::base(&in));
+  list[1].length = in.TotalBytes();
+  list[1].lkey = mr->lkey;
+
+  struct ibv_send_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = (uint64_t)this;
+  wr.sg_list = list;
+  wr.num_sge = 2;
+  wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  wr.send_flags = IBV_SEND_SIGNALED;
+  wr.imm_data = imm_data;
+  wr.wr.rdma.remote_addr = (uint64_t)remote_.remote_addr;
+  wr.wr.rdma.rkey = remote_.rkey;
+
+  struct ibv_send_wr* bad_wr;
+  CHECK(!ibv_post_send(channel_->qp_, &wr, &bad_wr)) << "Failed to post send";
+}
+
 // Send the next ack from the buffer's job queue.
 void RdmaAckBuffer::SendNextItem() {
   uint32_t imm_data = LookupBufferIndex("rx_ack_buffer");
@@ -683,7 +931,6 @@ void RdmaTensorBuffer::SendNextItem() {
                          << " error message: " << status.error_message();
       size_t buffer_size = RdmaMessage::kMessageTotalBytes;
       size_t tensor_bytes = 0;
-      TensorProto proto;
       // Figures out which device the tensor is hosted on.
       Device* src_dev = nullptr;
       Status s = channel_->adapter_->worker_env_->device_mgr->LookupDevice(
@@ -703,23 +950,70 @@ void RdmaTensorBuffer::SendNextItem() {
       CHECK(s.ok()) << "dst device not found";
       AllocatorAttributes dst_alloc_attr;
       dst_alloc_attr.set_on_host(true);
-      // string tensor needs to be serialized
-      if (src_dev->tensorflow_gpu_device_info() &&
-          (!send_args.alloc_attrs.on_host())) {
-        CHECK(send_args.device_context)
-            << "send dev name: " << src_dev->name()
-            << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
-        // "val" is on a GPU. Uses GPUUtil to fill the proto.
-        s = VerbsUtil::SetProtoFromGPUSync(
-            in, src_dev, send_args.device_context, &proto, is_dead);
-        CHECK(s.ok()) << "set proto from gpu sync";
+      const bool on_gpu = src_dev->tensorflow_gpu_device_info() &&
+                          (!send_args.alloc_attrs.on_host());
+      // With GPUDirect RDMA, a GPU tensor for a GPU on the remote side is
+      // written straight from its memory into a device buffer there,
+      // provided that its memory is registered with the adapter. Whether
+      // a buffer does so is decided when it is created.
+      ibv_mr* device_mr = nullptr;
+      if (on_gpu && !is_dead && channel_->adapter_->gpu_direct() &&
+          parsed.dst.type == DEVICE_GPU && DataTypeCanUseMemcpy(in.dtype()) &&
+          in.TotalBytes() > 0) {
+        device_mr = channel_->adapter_->FindMemoryRegion(
+            DMAHelper::base(&in), in.TotalBytes());
+      }
+      // A numeric CPU tensor for a CPU on the remote side is sent as its
+      // bytes rather than as a TensorProto. They are gathered from its
+      // memory by the write if the allocator of its device registered that
+      // with the adapter, and copied into "buffer_" otherwise.
+      const bool raw_data = !on_gpu && !is_dead &&
+                            parsed.dst.type == DEVICE_CPU &&
+                            DataTypeCanUseMemcpy(in.dtype());
+      ibv_mr* host_mr = nullptr;
+      if (raw_data && in.TotalBytes() > 0) {
+        host_mr = channel_->adapter_->FindMemoryRegion(DMAHelper::base(&in),
+                                                       in.TotalBytes());
+      }
+      bool use_device_buffer;
+      {
+        mutex_lock lock{mu_};
+        use_device_buffer = (local_status_ == none) ? (device_mr != nullptr)
+                                                    : (device_size_ > 0);
+      }
+      if (use_device_buffer && !is_dead) {
+        CHECK(device_mr) << "GPU tensor " << key << " is not in memory "
+                         << "registered with " << channel_->adapter_->name();
+      }
+      TensorProto proto;
+      if (use_device_buffer) {
+        // Only the message goes through "buffer_".
+        tensor_bytes = in.TotalBytes();
+        if (!is_dead) {
+          s = VerbsUtil::SyncGPUStream(src_dev, send_args.device_context);
+          CHECK(s.ok()) << "sync gpu stream: " << s;
+        }
+      } else if (raw_data) {
+        tensor_bytes = in.TotalBytes();
+        buffer_size += tensor_bytes;
       } else {
-        // tensor is in CPU memory.
-        in.AsProtoTensorContent(&proto);
+        // string tensor needs to be serialized
+        if (on_gpu) {
+          CHECK(send_args.device_context)
+              << "send dev name: " << src_dev->name()
+              << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
+          // "val" is on a GPU. Uses GPUUtil to fill the proto.
+          s = VerbsUtil::SetProtoFromGPUSync(
+              in, src_dev, send_args.device_context, &proto, is_dead);
+          CHECK(s.ok()) << "set proto from gpu sync";
+        } else {
+          // tensor is in CPU memory.
+          in.AsProtoTensorContent(&proto);
+        }
+        tensor_bytes = proto.ByteSize();
+        // maybe some margin for string tensor?
+        buffer_size += tensor_bytes;
       }
-      tensor_bytes = proto.ByteSize();
-      // maybe some margin for string tensor?
-      buffer_size += tensor_bytes;
       // prepare message
       RdmaMessage rm;
       rm.name_size_ = key.size();
@@ -729,11 +1023,60 @@ void RdmaTensorBuffer::SendNextItem() {
       rm.step_id_ = step_id;
       rm.is_dead_ = is_dead;
       rm.tensor_bytes_ = tensor_bytes;
+      rm.raw_data_ = raw_data;
       rm.buffer_size_ = buffer_size;
       mu_.lock();
-      if (local_status_ == none ||
-          (buffer_size > size_ && local_status_ == idle &&
-           remote_status_ == idle)) {
+      if ((local_status_ != none) &&
+          ((device_size_ > 0) != use_device_buffer)) {
+        // Another send created the buffer in the meantime; retry with it.
+        mu_.unlock();
+        EnqueueItem(key_with_step_id);
+      } else if (use_device_buffer) {
+        if (local_status_ == none) {
+          CreateCPUBuffer(buffer_size, false);
+          device_size_ = tensor_bytes;
+          mu_.unlock();
+          // put back the key since it is not sent;
+          EnqueueItem(key_with_step_id);
+          // ask the remote to create the same buffer, and a device buffer
+          // for the data
+          rm.type_ = RDMA_MESSAGE_BUFFER_REQUEST;
+          rm.remote_addr_ = reinterpret_cast<uint64_t>(buffer_);
+          rm.rkey_ = self_->rkey;
+          rm.device_buffer_size_ = tensor_bytes;
+          string message = RdmaMessage::CreateMessage(rm);
+          channel_->tx_message_buffer_->EnqueueItem(message);
+          channel_->tx_message_buffer_->SendNextItem();
+        } else if ((local_status_ == idle) && (remote_status_ == idle)) {
+          CHECK(is_dead || tensor_bytes == device_size_)
+              << "tensor and device buffer size do not agree!"
+              << " device buffer size = " << device_size_
+              << " requested tensor size = " << tensor_bytes
+              << in.DebugString();
+          local_status_ = busy;
+          remote_status_ = busy;
+          if (!is_dead) {
+            // Keep the tensor until the write has completed.
+            in_flight_tensor_ = in;
+          }
+          mu_.unlock();
+          uint32_t imm_data = LookupBufferIndex(key);
+          rm.type_ = RDMA_MESSAGE_TENSOR_WRITE;
+          string message = RdmaMessage::CreateMessage(rm);
+          memcpy(buffer_, message.data(), message.size());
+          if (!is_dead) {
+            WriteWithDeviceData(imm_data, buffer_size, in, device_mr);
+          } else {
+            Write(imm_data, buffer_size);
+          }
+        } else {
+          mu_.unlock();
+          // put back the key since it is not sent;
+          EnqueueItem(key_with_step_id);
+        }
+      } else if (local_status_ == none ||
+                 (buffer_size > size_ && local_status_ == idle &&
+                  remote_status_ == idle)) {
         if ((local_status_ != none) && (buffer_size > size_)) {
           CHECK(rm.data_type_ == DT_STRING)
               << "Only string tensor allows to change size";
@@ -753,6 +1096,10 @@ void RdmaTensorBuffer::SendNextItem() {
         // both buffers are ready, send the tensor
         local_status_ = busy;
         remote_status_ = busy;
+        if (host_mr != nullptr) {
+          // Keep the tensor until the write has completed.
+          in_flight_tensor_ = in;
+        }
         // local/remote_status_ won't be set back to idle
         // unitl Write() is successful
         mu_.unlock();
@@ -765,13 +1112,21 @@ void RdmaTensorBuffer::SendNextItem() {
         rm.type_ = RDMA_MESSAGE_TENSOR_WRITE;
         string message = RdmaMessage::CreateMessage(rm);
         memcpy(buffer_, message.data(), message.size());
+        if (host_mr != nullptr) {
+          WriteWithHostData(imm_data, in, host_mr);
+          return;
+        }
         if (!is_dead) {
           // copy the tensor buffer content
           void* output =
               static_cast<void*>(static_cast<char*>(buffer_) +
                                  RdmaMessage::kTensorBufferStartIndex);
           CHECK(tensor_bytes + RdmaMessage::kTensorBufferStartIndex <= size_);
-          proto.SerializeToArray(output, tensor_bytes);
+          if (!raw_data) {
+            proto.SerializeToArray(output, tensor_bytes);
+          } else if (tensor_bytes > 0) {
+            memcpy(output, DMAHelper::base(&in), tensor_bytes);
+          }
         } else {
           buffer_size = RdmaMessage::kMessageTotalBytes;
         }
@@ -796,18 +1151,22 @@ string RdmaMessage::CreateMessage(const RdmaMessage& rm) {
   // Rdma Message format
   // type|name_size|name|step_id|buffer_size|remote_addr|rkey|is_dead|...
   //   1B|    2B   | 512|  8B   |    8B     |       8B  | 4B |    1B |...
-  // ...|data_type|tensor_shape|tensor_bytes|tensor_buffer
-  // ...|   XB    |    XB      |    8B      |...
+  // ...|data_type|tensor_shape|tensor_bytes|device_buffer_size|...
+  // ...|   XB    |    XB      |    8B      |        8B        |...
+  // ...|device_remote_addr|device_rkey|raw_data|tensor_buffer
+  // ...|        8B        |    4B     |   1B   |...
   //
   // ACK:             type|13|"rx_ack_buffer"
   // TENSOR_REQUEST:  type|name_size|tensor_name|step_id
   // TENSOR_WRITE:    type|name_size|tensor_name|step_id|...|is_dead
-  //                 |data_type|tensor_shape|tensor_bytes
+  //                 |data_type|tensor_shape|tensor_bytes|...|raw_data
   // BUFFER_IDLE:     type|name_size|buffer_name
   // BUFFER_REQUEST:
-  // type|name_size|buffer_name|...|buffer_size|remote_addr|rkey|
+  // type|name_size|buffer_name|...|buffer_size|remote_addr|rkey|...
+  //     |device_buffer_size|device_remote_addr|device_rkey
   // BUFFER_RESPONSE:
-  // type|name_size|buffer_name|...|buffer_size|remote_addr|rkey|
+  // type|name_size|buffer_name|...|buffer_size|remote_addr|rkey|...
+  //     |device_buffer_size|device_remote_addr|device_rkey
   char message[kMessageTotalBytes];
   // type
   message[kTypeStartIndex] = static_cast<char>(rm.type_) & 0xff;
@@ -823,13 +1182,19 @@ string RdmaMessage::CreateMessage(const RdmaMessage& rm) {
     memcpy(&message[kRemoteAddrStartIndex], &rm.remote_addr_,
            sizeof(rm.remote_addr_));
     memcpy(&message[kRkeyStartIndex], &rm.rkey_, sizeof(rm.rkey_));
+    memcpy(&message[kDeviceBufferSizeStartIndex], &rm.device_buffer_size_,
+           sizeof(rm.device_buffer_size_));
+    memcpy(&message[kDeviceRemoteAddrStartIndex], &rm.device_remote_addr_,
+           sizeof(rm.device_remote_addr_));
+    memcpy(&message[kDeviceRkeyStartIndex], &rm.device_rkey_,
+           sizeof(rm.device_rkey_));
   }
   // step_id
   if ((rm.type_ == RDMA_MESSAGE_TENSOR_WRITE) ||
       (rm.type_ == RDMA_MESSAGE_TENSOR_REQUEST)) {
     memcpy(&message[kStepIdStartIndex], &rm.step_id_, sizeof(rm.step_id_));
   }
-  // is_dead, data_type, tensor_shape, tensor_bytes
+  // is_dead, data_type, tensor_shape, tensor_bytes, raw_data
   if (rm.type_ == RDMA_MESSAGE_TENSOR_WRITE) {
     memcpy(&message[kIsDeadStartIndex], &rm.is_dead_, sizeof(rm.is_dead_));
 
@@ -839,6 +1204,7 @@ string RdmaMessage::CreateMessage(const RdmaMessage& rm) {
            sizeof(rm.tensor_shape_));
     memcpy(&message[kTensorBytesStartIndex], &rm.tensor_bytes_,
            sizeof(rm.tensor_bytes_));
+    memcpy(&message[kRawDataStartIndex], &rm.raw_data_, sizeof(rm.raw_data_));
   }
   return string(message, kMessageTotalBytes);
 }
@@ -865,13 +1231,19 @@ void RdmaMessage::ParseMessage(RdmaMessage& rm, void* buffer) {
     memcpy(&rm.remote_addr_, &message[kRemoteAddrStartIndex],
            sizeof(rm.remote_addr_));
     memcpy(&rm.rkey_, &message[kRkeyStartIndex], sizeof(rm.rkey_));
+    memcpy(&rm.device_buffer_size_, &message[kDeviceBufferSizeStartIndex],
+           sizeof(rm.device_buffer_size_));
+    memcpy(&rm.device_remote_addr_, &message[kDeviceRemoteAddrStartIndex],
+           sizeof(rm.device_remote_addr_));
+    memcpy(&rm.device_rkey_, &message[kDeviceRkeyStartIndex],
+           sizeof(rm.device_rkey_));
   }
   // step_id
   if ((rm.type_ == RDMA_MESSAGE_TENSOR_WRITE) ||
       (rm.type_ == RDMA_MESSAGE_TENSOR_REQUEST)) {
     memcpy(&rm.step_id_, &message[kStepIdStartIndex], sizeof(rm.step_id_));
   }
-  // data_type, tensor_bytes, tensor_shape, is_dead
+  // data_type, tensor_bytes, tensor_shape, is_dead, raw_data
   if (rm.type_ == RDMA_MESSAGE_TENSOR_WRITE) {
     memcpy(&rm.is_dead_, &message[kIsDeadStartIndex], sizeof(rm.is_dead_));
     memcpy(&rm.data_type_, &message[kDataTypeStartIndex],
@@ -880,6 +1252,7 @@ void RdmaMessage::ParseMessage(RdmaMessage& rm, void* buffer) {
            sizeof(rm.tensor_shape_));
     memcpy(&rm.tensor_bytes_, &message[kTensorBytesStartIndex],
            sizeof(rm.tensor_bytes_));
+    memcpy(&rm.raw_data_, &message[kRawDataStartIndex], sizeof(rm.raw_data_));
   }
 }
 
@@ -28,6 +28,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/env.h"
@@ -73,13 +74,27 @@ class RdmaAdapter {
   friend class RdmaRemoteRendezvous;
 
  public:
-  RdmaAdapter(const WorkerEnv* worker_env);
+  RdmaAdapter(const WorkerEnv* worker_env, bool gpu_direct);
   ~RdmaAdapter();
   // Adapter name, e.g. mlx5_0.
   string name() const;
   void Process_CQ();
+  // Whether tensors are RDMA-written directly between GPU memory on
+  // both sides (GPUDirect RDMA), controlled by RPCOptions.verbs_gpu_direct.
+  bool gpu_direct() const { return gpu_direct_; }
+  // Returns the registered memory region that contains
+  // [addr, addr + length), or nullptr if there is none.
+  ibv_mr* FindMemoryRegion(const void* addr, size_t length) const;
 
  protected:
+  // Registers a region of memory with the adapter. Called for each region
+  // allocated by the allocators of the CPU devices that can be visited,
+  // and by the GPU allocators when gpu_direct() is true. Returns false if
+  // the region could not be registered.
+  bool RegisterMemoryRegion(void* addr, size_t length);
+  // Deregisters the region at "addr" when its allocator frees it.
+  void DeregisterMemoryRegion(void* addr);
+
   static const int MAX_CONCURRENT_WRITES = 1000;
   ibv_context* context_;
   // ibverbs protection domain
@@ -94,6 +109,10 @@ class RdmaAdapter {
   const WorkerEnv* worker_env_;
   // thread for cq.
   std::unique_ptr<Thread> polling_thread_;
+  bool gpu_direct_;
+  mutable mutex mr_mu_;
+  // Registered memory regions, sorted by address.
+  std::vector<ibv_mr*> mrs_ GUARDED_BY(mr_mu_);
 };
 
 // Class that represents a connection to a remote Rdma peer.
@@ -182,8 +201,15 @@ class RdmaBuffer {
   void FreeBuffer();
   void EnqueueItem(string Item);
   virtual void SendNextItem(){};
+  // Called when an RDMA write from this buffer has completed, before the
+  // buffer is marked idle.
+  virtual void WriteDone() {}
   void CreateCPUBuffer(size_t size, bool lock = true);
+  // Allocates "size" bytes of memory on the GPU that the tensor named by
+  // this buffer is received on, for GPUDirect RDMA writes into it.
+  void CreateDeviceBuffer(size_t size);
   void SetRemoteMR(RemoteMR rmi, bool override);
+  void SetRemoteDeviceMR(RemoteMR rmr);
   uint32_t LookupBufferIndex(const string& buffer_name) {
     return const_cast<RdmaChannel*>(channel_)->LookupBufferIndex(buffer_name);
   }
@@ -201,6 +227,14 @@ class RdmaBuffer {
   std::queue<string> queue_ GUARDED_BY(mu_);
   BufferStatus local_status_ GUARDED_BY(mu_) = none;
   BufferStatus remote_status_ GUARDED_BY(mu_) = none;
+  // With GPUDirect RDMA, the data of a tensor buffer is written from the
+  // sender's GPU tensor into "device_tensor_" on the receiver's GPU,
+  // and "buffer_" only holds the message. "device_size_" is non-zero
+  // for such buffers on both sides.
+  size_t device_size_ = 0;
+  Tensor device_tensor_;
+  ibv_mr* device_mr_ = nullptr;  // Not owned.
+  RemoteMR remote_device_;
 };
 
 class RdmaAckBuffer : public RdmaBuffer {
@@ -225,6 +259,21 @@ class RdmaTensorBuffer : public RdmaBuffer {
   explicit RdmaTensorBuffer(RdmaChannel* channel, string name);
   virtual ~RdmaTensorBuffer() override {}
   void SendNextItem() override;
+  void WriteDone() override;
+
+ private:
+  // RDMA-writes the data of "in" from the GPU memory region "mr" into the
+  // remote device buffer, followed by the first "buffer_size" bytes of
+  // the message in "buffer_".
+  void WriteWithDeviceData(uint32_t imm_data, size_t buffer_size,
+                           const Tensor& in, ibv_mr* mr);
+  // RDMA-writes the message in "buffer_" followed by the data of "in",
+  // gathered from the registered memory region "mr", into the remote
+  // buffer, so that the data is not copied into "buffer_" first.
+  void WriteWithHostData(uint32_t imm_data, const Tensor& in, ibv_mr* mr);
+
+  // The tensor that an in-flight write reads from in place.
+  Tensor in_flight_tensor_ GUARDED_BY(mu_);
 };
 
 struct RdmaMessage {
@@ -239,11 +288,21 @@ struct RdmaMessage {
   DataType data_type_;
   TensorShape tensor_shape_;
   size_t tensor_bytes_;
+  // Whether the tensor buffer holds the bytes of the tensor rather than a
+  // serialized TensorProto.
+  bool raw_data_ = false;
+  // Size and remote memory region of the device buffer, for GPUDirect
+  // RDMA. A zero "device_buffer_size_" means there is none.
+  uint64_t device_buffer_size_ = 0;
+  uint64_t device_remote_addr_ = 0;
+  uint32_t device_rkey_ = 0;
 
   // type|name_size|name|step_id|buffer_size|remote_addr|rkey|is_dead|...
   //   1B|    2B   | 512|  8B   |    8B     |       8B  | 4B |    1B |...
-  // ...|data_type|tensor_shape|tensor_bytes|tensor_buffer
-  // ...|   XB    |    XB      |    8B      |...
+  // ...|data_type|tensor_shape|tensor_bytes|device_buffer_size|...
+  // ...|   XB    |    XB      |    8B      |        8B        |...
+  // ...|device_remote_addr|device_rkey|raw_data|tensor_buffer
+  // ...|        8B        |    4B     |   1B   |...
   //
   static const size_t kNameCapacity = 512;
   static const size_t kTypeStartIndex = 0;
@@ -264,8 +323,16 @@ struct RdmaMessage {
       kDataTypeStartIndex + sizeof(data_type_);
   static const size_t kTensorBytesStartIndex =
       kTensorShapeStartIndex + sizeof(TensorShape);
-  static const size_t kTensorBufferStartIndex =
+  static const size_t kDeviceBufferSizeStartIndex =
       kTensorBytesStartIndex + sizeof(tensor_bytes_);
+  static const size_t kDeviceRemoteAddrStartIndex =
+      kDeviceBufferSizeStartIndex + sizeof(device_buffer_size_);
+  static const size_t kDeviceRkeyStartIndex =
+      kDeviceRemoteAddrStartIndex + sizeof(device_remote_addr_);
+  static const size_t kRawDataStartIndex =
+      kDeviceRkeyStartIndex + sizeof(device_rkey_);
+  static const size_t kTensorBufferStartIndex =
+      kRawDataStartIndex + sizeof(raw_data_);
   static const size_t kMessageTotalBytes = kTensorBufferStartIndex;
   static const size_t kRdmaMessageBufferSize = kMessageTotalBytes;
   static const size_t kRdmaAckBufferSize = kMessageTotalBytes;
@@ -26,9 +26,9 @@ limitations under the License.
 namespace tensorflow {
 
 RdmaMgr::RdmaMgr(const WorkerEnv* const worker_env,
-                 GrpcChannelCache* const channel_cache)
+                 GrpcChannelCache* const channel_cache, bool gpu_direct)
     : worker_env_(worker_env), channel_cache_(channel_cache) {
-  rdma_adapter_ = new RdmaAdapter(worker_env_);
+  rdma_adapter_ = new RdmaAdapter(worker_env_, gpu_direct);
   // hardcoded to default session (legacy_session_)
   // TODO: use WorkerSessionForSession
   // need to pass in session handle
@@ -29,8 +29,9 @@ namespace tensorflow {
 
 class RdmaMgr {
  public:
-  explicit RdmaMgr(const WorkerEnv* const worker_env,
-                   GrpcChannelCache* const channel_cache);
+  // "gpu_direct" enables GPUDirect RDMA, see RdmaAdapter::gpu_direct().
+  RdmaMgr(const WorkerEnv* const worker_env,
+          GrpcChannelCache* const channel_cache, bool gpu_direct);
   ~RdmaMgr();
   RdmaChannel* FindChannel(const string& key);
   void SetupChannels();
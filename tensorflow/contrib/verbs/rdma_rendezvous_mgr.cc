@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -39,6 +40,12 @@ class RdmaRemoteRendezvous : public BaseRemoteRendezvous {
 
  private:
   ~RdmaRemoteRendezvous() override {}
+  // Copies the tensor described by "rm" out of the device buffer of "rb"
+  // into a tensor on "dst_dev", then calls "release_buffer" and "done".
+  void RecvFromDeviceBuffer(const RdmaMessage& rm, RdmaBuffer* rb,
+                            Device* dst_dev, const Rendezvous::Args& recv_args,
+                            std::function<void()> release_buffer,
+                            DoneCallback done);
   RdmaMgr* rdma_mgr_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RdmaRemoteRendezvous);
@@ -95,6 +102,24 @@ void RdmaRemoteRendezvous::RecvFromRemoteAsync(
     CHECK(rb->size_ >= RdmaMessage::kMessageTotalBytes);
     RdmaMessage::ParseMessage(rm, rb->buffer_);
     CHECK(rm.type_ == RDMA_MESSAGE_TENSOR_WRITE);
+    // Tells the sender that the buffer can be written again.
+    auto release_buffer = [rc, key]() {
+      RdmaMessage br;
+      br.type_ = RDMA_MESSAGE_BUFFER_IDLE;
+      br.name_size_ = key.size();
+      br.name_ = key;
+      string message = RdmaMessage::CreateMessage(br);
+      RdmaBuffer* tb = rc->tx_message_buffer_;
+      tb->EnqueueItem(message);
+      tb->SendNextItem();
+    };
+    rc->RemoveRecvCallback(key_with_step_id);
+    if (!rm.is_dead_ && rb->device_size_ > 0) {
+      // GPUDirect RDMA wrote the data into the device buffer; copy it into
+      // the tensor before releasing the buffer.
+      RecvFromDeviceBuffer(rm, rb, dst_dev, recv_args, release_buffer, done);
+      return;
+    }
     Tensor val;
     if (!rm.is_dead_) {
       void* input = static_cast<char*>(rb->buffer_) +
@@ -102,21 +127,25 @@ void RdmaRemoteRendezvous::RecvFromRemoteAsync(
       TensorProto proto;
       CHECK(rm.tensor_bytes_ + RdmaMessage::kTensorBufferStartIndex <=
             rb->size_);
-      CHECK(ParseProtoUnlimited(&proto, input, rm.tensor_bytes_))
-          << "fail to parse proto from array";
-      s = dst_dev->MakeTensorFromProto(proto, recv_args.alloc_attrs, &val);
+      if (rm.raw_data_) {
+        // The buffer is written again once released, so the data is copied
+        // out of it.
+        val = Tensor(dst_dev->GetAllocator(recv_args.alloc_attrs),
+                     rm.data_type_, rm.tensor_shape_);
+        CHECK(val.TotalBytes() == rm.tensor_bytes_)
+            << "tensor and message size do not agree!"
+            << " tensor_bytes = " << rm.tensor_bytes_ << val.DebugString();
+        if (rm.tensor_bytes_ > 0) {
+          memcpy(DMAHelper::base(&val), input, rm.tensor_bytes_);
+        }
+      } else {
+        CHECK(ParseProtoUnlimited(&proto, input, rm.tensor_bytes_))
+            << "fail to parse proto from array";
+        s = dst_dev->MakeTensorFromProto(proto, recv_args.alloc_attrs, &val);
+      }
     }
 
-    rc->RemoveRecvCallback(key_with_step_id);
-    // create message
-    RdmaMessage br;
-    br.type_ = RDMA_MESSAGE_BUFFER_IDLE;
-    br.name_size_ = key.size();
-    br.name_ = key;
-    string message = RdmaMessage::CreateMessage(br);
-    RdmaBuffer* tb = rc->tx_message_buffer_;
-    tb->EnqueueItem(message);
-    tb->SendNextItem();
+    release_buffer();
     done(s, Args(), recv_args, val, rm.is_dead_);
   });
   // append key to message queue
@@ -131,6 +160,51 @@ void RdmaRemoteRendezvous::RecvFromRemoteAsync(
   rb->SendNextItem();
 }
 
+void RdmaRemoteRendezvous::RecvFromDeviceBuffer(
+    const RdmaMessage& rm, RdmaBuffer* rb, Device* dst_dev,
+    const Rendezvous::Args& recv_args, std::function<void()> release_buffer,
+    DoneCallback done) {
+#if GOOGLE_CUDA
+  Tensor src;
+  src.UnsafeCopyFromInternal(rb->device_tensor_, rm.data_type_,
+                             rm.tensor_shape_);
+  Tensor* val = new Tensor(dst_dev->GetAllocator(recv_args.alloc_attrs),
+                           rm.data_type_, rm.tensor_shape_);
+  const DeviceContext* dst_dev_context =
+      recv_args.device_context
+          ? recv_args.device_context
+          : dst_dev->tensorflow_gpu_device_info()->default_context;
+  if (recv_args.alloc_attrs.on_host()) {
+    GPUUtil::CopyGPUTensorToCPU(
+        dst_dev, dst_dev_context, &src, val,
+        [val, recv_args, release_buffer, done](const Status& s) {
+          release_buffer();
+          done(s, Args(), recv_args, *val, false);
+          delete val;
+        });
+  } else {
+    // CopyGPUTensorToSameGPU() only enqueues the copy on the stream, so
+    // the kernels that consume "val" there run after it. The buffer is
+    // released once the copy has run.
+    GPUUtil::CopyGPUTensorToSameGPU(
+        dst_dev, dst_dev_context, &src, val,
+        [val, recv_args, done](const Status& s) {
+          done(s, Args(), recv_args, *val, false);
+          delete val;
+        });
+    VerbsUtil::GPUStreamDoneAsync(dst_dev, dst_dev_context,
+                                  [release_buffer](const Status& s) {
+                                    CHECK(s.ok()) << "copy from device buffer: "
+                                                  << s;
+                                    release_buffer();
+                                  });
+  }
+#else
+  done(errors::Internal("No GPU device in process"), Args(), recv_args,
+       Tensor(), false);
+#endif  // GOOGLE_CUDA
+}
+
 RdmaRendezvousMgr::RdmaRendezvousMgr(const WorkerEnv* env)
     : BaseRendezvousMgr(env) {}
 
@@ -81,7 +81,10 @@ Status VerbsServer::Init(ServiceInitFunction service_func,
     mutex_lock l(mu_);
     CHECK_EQ(verbs_state_, DISCONNECTED);
     CHECK(ChannelCacheFactory(server_def(), &channel_cache_).ok());
-    rdma_mgr_ = new RdmaMgr(worker_env(), channel_cache_);
+    const RPCOptions& rpc_options =
+        server_def().default_session_config().rpc_options();
+    rdma_mgr_ = new RdmaMgr(worker_env(), channel_cache_,
+                            rpc_options.verbs_gpu_direct());
     // set rdma_mgr for verbs_service and rdma_rendezvous_mgr
     verbs_service_->SetRdmaMgr(rdma_mgr_);
     dynamic_cast<RdmaRendezvousMgr*>(worker_env()->rendezvous_mgr)
@@ -16,6 +16,11 @@ limitations under the License.
 #include "tensorflow/contrib/verbs/verbs_util.h"
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#endif  // GOOGLE_CUDA
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 namespace tensorflow {
@@ -35,6 +40,43 @@ Status VerbsUtil::SetProtoFromGPUSync(const Tensor& tensor, Device* dev,
   return status;
 }
 
+// static
+Status VerbsUtil::SyncGPUStream(Device* dev,
+                                const DeviceContext* device_context) {
+  Notification n;
+  Status status;
+  GPUStreamDoneAsync(dev, device_context, [&n, &status](const Status& s) {
+    status = s;
+    n.Notify();
+  });
+  n.WaitForNotification();
+  return status;
+}
+
+// static
+void VerbsUtil::GPUStreamDoneAsync(Device* dev,
+                                   const DeviceContext* device_context,
+                                   StatusCallback done) {
+#if GOOGLE_CUDA
+  const DeviceBase::GpuDeviceInfo* dev_info = dev->tensorflow_gpu_device_info();
+  if (dev_info == nullptr || device_context == nullptr) {
+    done(errors::Internal("No GPU stream for device ", dev->name()));
+    return;
+  }
+  perftools::gputools::Stream* stream =
+      static_cast<const GPUDeviceContext*>(device_context)->stream();
+  dev_info->event_mgr->ThenExecute(stream, [stream, done]() {
+    if (!stream->ok()) {
+      done(errors::Internal("GPU stream in error state"));
+      return;
+    }
+    done(Status::OK());
+  });
+#else
+  done(errors::Internal("No GPU device in process"));
+#endif  // GOOGLE_CUDA
+}
+
 // static
 string VerbsUtil::AppendStepidToKey(const string& key, int64 step_id) {
   return strings::StrCat(key, ";", step_id);
@@ -32,6 +32,14 @@ class VerbsUtil {
   static Status SetProtoFromGPUSync(const Tensor& tensor, Device* dev,
                                     const DeviceContext* device_context,
                                     TensorProto* proto, bool is_dead);
+  // Blocks until the work queued on the stream of "device_context" has
+  // completed.
+  static Status SyncGPUStream(Device* dev, const DeviceContext* device_context);
+  // Calls "done" once the work queued on the stream of "device_context"
+  // has completed.
+  static void GPUStreamDoneAsync(Device* dev,
+                                 const DeviceContext* device_context,
+                                 StatusCallback done);
   static string AppendStepidToKey(const string& key, int64 step_id);
   static void GetKeyAndStepId(const string& key_with_step_id, string& key,
                               int64& step_id);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -249,10 +250,18 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (thread_cache_ != nullptr && rounded_bytes <= kMaxCachedChunkBytes) {
+    void* ptr = AllocateFromThreadCache(rounded_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
-  mutex_lock l(lock_);
+  mutex_lock l(lock_, std::try_to_lock);
+  WaitForLock(&l);
   void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
   if (ptr != nullptr) {
     return ptr;
@@ -266,6 +275,21 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Chunks parked in the thread cache are invisible to the bins, so give
+  // them back and search again before declaring failure.  The shard locks
+  // are always taken before lock_, hence the unlock.
+  if (thread_cache_ != nullptr) {
+    l.unlock();
+    const bool released = ReleaseThreadCache();
+    l.lock();
+    if (released) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+      if (ptr != nullptr) {
+        return ptr;
+      }
+    }
+  }
+
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -369,7 +393,11 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 }
 
 void BFCAllocator::DeallocateRaw(void* ptr) {
-  DeallocateRawInternal(ptr);
+  if (thread_cache_ != nullptr && ptr != nullptr) {
+    DeallocateToThreadCache(ptr);
+  } else {
+    DeallocateRawInternal(ptr);
+  }
   retry_helper_.NotifyDealloc();
 }
 
@@ -378,7 +406,8 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     LOG(ERROR) << "tried to deallocate nullptr";
     return;
   }
-  mutex_lock l(lock_);
+  mutex_lock l(lock_, std::try_to_lock);
+  WaitForLock(&l);
 
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
@@ -516,6 +545,11 @@ void BFCAllocator::AddAllocVisitor(Visitor visitor) {
   }
 }
 
+void BFCAllocator::AddFreeVisitor(Visitor visitor) {
+  mutex_lock l(lock_);
+  free_visitors_.push_back(visitor);
+}
+
 bool BFCAllocator::TracksAllocationSizes() { return true; }
 
 size_t BFCAllocator::RequestedSize(void* ptr) {
@@ -703,8 +737,158 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
 }
 
 void BFCAllocator::GetStats(AllocatorStats* stats) {
+  int64 num_cache_hits = 0;
+  int64 num_cache_misses = 0;
+  for (int i = 0; i < num_thread_cache_shards_; ++i) {
+    ThreadCacheShard* shard = &thread_cache_[i];
+    mutex_lock l(shard->mu);
+    num_cache_hits += shard->num_hits;
+    num_cache_misses += shard->num_misses;
+  }
   mutex_lock l(lock_);
   *stats = stats_;
+  // Cache hits never reach FindChunkPtr, so count them here.
+  stats->num_allocs += num_cache_hits;
+  stats->num_cache_hits = num_cache_hits;
+  stats->num_cache_misses = num_cache_misses;
+
+  // Bins hold only free chunks, sorted by size.
+  stats->bytes_reserved = total_region_allocated_bytes_;
+  stats->free_bytes_by_bin.assign(kNumBins, 0);
+  for (BinNum bin_num = 0; bin_num < kNumBins; bin_num++) {
+    const Bin::FreeChunkSet& free_chunks = BinFromIndex(bin_num)->free_chunks;
+    for (ChunkHandle h : free_chunks) {
+      stats->free_bytes_by_bin[bin_num] += ChunkFromHandle(h)->size;
+    }
+    stats->bytes_free += stats->free_bytes_by_bin[bin_num];
+    if (!free_chunks.empty()) {
+      stats->largest_free_block_bytes =
+          ChunkFromHandle(*free_chunks.rbegin())->size;
+    }
+  }
+}
+
+size_t BFCAllocator::ReleaseFreeRegions() {
+  // Chunks parked in the thread cache are in use, and would keep their
+  // regions from being released.
+  ReleaseThreadCache();
+  mutex_lock l(lock_);
+  // A region holds no allocation if its first chunk is free and spans it.
+  std::vector<std::pair<void*, size_t>> free_regions;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    Chunk* c = ChunkFromHandle(h);
+    if (c->in_use() || c->size != region.memory_size()) continue;
+    RemoveFreeChunkFromBin(h);
+    DeleteChunk(h);
+    free_regions.emplace_back(region.ptr(), region.memory_size());
+  }
+  size_t released_bytes = 0;
+  for (const auto& region : free_regions) {
+    region_manager_.RemoveAllocationRegion(region.first);
+    for (const auto& visitor : free_visitors_) {
+      visitor(region.first, region.second);
+    }
+    suballocator_->Free(region.first, region.second);
+    total_region_allocated_bytes_ -= region.second;
+    released_bytes += region.second;
+  }
+  if (released_bytes > 0) {
+    VLOG(1) << "Released " << free_regions.size() << " regions ("
+            << strings::HumanReadableNumBytes(released_bytes) << ") of "
+            << name_;
+  }
+  return released_bytes;
+}
+
+void BFCAllocator::EnableThreadCache(int num_shards) {
+  CHECK_GT(num_shards, 0);
+  CHECK(thread_cache_ == nullptr)
+      << "Thread cache of allocator " << name_ << " is already enabled";
+  num_thread_cache_shards_ = num_shards;
+  thread_cache_.reset(new ThreadCacheShard[num_shards]);
+}
+
+void BFCAllocator::WaitForLock(mutex_lock* l) {
+  if (l->owns_lock()) {
+    return;
+  }
+  const uint64 start_micros = Env::Default()->NowMicros();
+  l->lock();
+  ++stats_.num_lock_waits;
+  stats_.lock_wait_micros += Env::Default()->NowMicros() - start_micros;
+}
+
+BFCAllocator::ThreadCacheShard* BFCAllocator::ThreadCacheShardForCaller() {
+  const size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &thread_cache_[h % num_thread_cache_shards_];
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t rounded_bytes) {
+  ThreadCacheShard* shard = ThreadCacheShardForCaller();
+  mutex_lock l(shard->mu);
+  std::vector<void*>* free_list =
+      &shard->free_lists[CacheClassForSize(rounded_bytes)];
+  if (free_list->empty()) {
+    ++shard->num_misses;
+    return nullptr;
+  }
+  void* ptr = free_list->back();
+  free_list->pop_back();
+  shard->cached_bytes -= rounded_bytes;
+  ++shard->num_hits;
+  return ptr;
+}
+
+void BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  ThreadCacheShard* shard = ThreadCacheShardForCaller();
+  mutex_lock l(shard->mu);
+  shard->pending_frees.push_back(ptr);
+  if (shard->pending_frees.size() < kThreadCacheFreeBatch) {
+    return;
+  }
+
+  // Only lock_ knows the chunk sizes, so sort the whole batch at once:
+  // small chunks go to the shard's free lists while it has room, the rest
+  // go back to the bins.
+  mutex_lock bl(lock_, std::try_to_lock);
+  WaitForLock(&bl);
+  for (void* p : shard->pending_frees) {
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(p);
+    CHECK(h != kInvalidChunkHandle);
+    const size_t size = ChunkFromHandle(h)->size;
+    if (size <= kMaxCachedChunkBytes &&
+        shard->cached_bytes + size <= kMaxShardCachedBytes) {
+      shard->free_lists[CacheClassForSize(size)].push_back(p);
+      shard->cached_bytes += size;
+    } else {
+      FreeAndMaybeCoalesce(h);
+    }
+  }
+  shard->pending_frees.clear();
+}
+
+bool BFCAllocator::ReleaseThreadCache() {
+  bool released = false;
+  for (int i = 0; i < num_thread_cache_shards_; ++i) {
+    ThreadCacheShard* shard = &thread_cache_[i];
+    mutex_lock l(shard->mu);
+    mutex_lock bl(lock_);
+    for (void* p : shard->pending_frees) {
+      FreeAndMaybeCoalesce(region_manager_.get_handle(p));
+      released = true;
+    }
+    shard->pending_frees.clear();
+    for (std::vector<void*>& free_list : shard->free_lists) {
+      for (void* p : free_list) {
+        FreeAndMaybeCoalesce(region_manager_.get_handle(p));
+        released = true;
+      }
+      free_list.clear();
+    }
+    shard->cached_bytes = 0;
+  }
+  return released;
 }
 
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -56,8 +57,8 @@ class BFCAllocator : public VisitableAllocator {
 
   void AddAllocVisitor(Visitor visitor) override;
 
-  // Does nothing, because memory is never freed.
-  void AddFreeVisitor(Visitor visitor) override {}
+  // Visitors are called on each region released by ReleaseFreeRegions().
+  void AddFreeVisitor(Visitor visitor) override;
 
   bool TracksAllocationSizes() override;
 
@@ -69,6 +70,18 @@ class BFCAllocator : public VisitableAllocator {
 
   void GetStats(AllocatorStats* stats) override;
 
+  // Enables a front-end cache of recently freed small chunks, split into
+  // 'num_shards' shards that are selected by the calling thread. Must be
+  // called before the first allocation.
+  void EnableThreadCache(int num_shards);
+
+  // Returns the regions that hold no allocation to the sub-allocator,
+  // and returns the number of bytes released. Later allocations extend
+  // the allocator with new regions, which are at least as large as the
+  // ones released, so a working set that had been spread over several
+  // regions is laid out again in fewer of them.
+  size_t ReleaseFreeRegions();
+
  private:
   struct Bin;
 
@@ -174,6 +187,39 @@ class BFCAllocator : public VisitableAllocator {
   static const size_t kMinAllocationBits = 8;
   static const size_t kMinAllocationSize = 1 << kMinAllocationBits;
 
+  // When the thread cache is enabled, chunks of at most
+  // kMaxCachedChunkBytes are not returned to the bins on free. They stay
+  // marked in use and are parked in the free list of the calling thread's
+  // shard that matches their exact size, so that a later allocation of the
+  // same rounded size from that shard is served without taking lock_.
+  // Frees are buffered per shard and handed to lock_ in batches of
+  // kThreadCacheFreeBatch.  Everything cached is returned to the bins
+  // before an allocation is allowed to fail.
+  //
+  // Cached chunks still count towards bytes_in_use, and a pointer served
+  // from the cache reports the RequestedSize() and AllocationId() of the
+  // allocation that originally produced its chunk.
+  static const size_t kMaxCachedChunkBytes = 64 << 10;
+  static const size_t kNumCacheClasses =
+      kMaxCachedChunkBytes >> kMinAllocationBits;
+  static const size_t kMaxShardCachedBytes = 8 << 20;
+  static const size_t kThreadCacheFreeBatch = 32;
+
+  struct ThreadCacheShard {
+    mutex mu;
+    // free_lists[c] holds cached chunks of size (c + 1) * kMinAllocationSize.
+    std::vector<void*> free_lists[kNumCacheClasses] GUARDED_BY(mu);
+    size_t cached_bytes GUARDED_BY(mu) = 0;
+    // Freed pointers not yet sorted into free_lists or returned to the bins.
+    std::vector<void*> pending_frees GUARDED_BY(mu);
+    int64 num_hits GUARDED_BY(mu) = 0;
+    int64 num_misses GUARDED_BY(mu) = 0;
+  };
+
+  static size_t CacheClassForSize(size_t rounded_bytes) {
+    return (rounded_bytes >> kMinAllocationBits) - 1;
+  }
+
   // AllocationRegion maps pointers to ChunkHandles for a single
   // contiguous memory region.
   //
@@ -260,6 +306,14 @@ class BFCAllocator : public VisitableAllocator {
       regions_.insert(entry, AllocationRegion(ptr, memory_size));
     }
 
+    void RemoveAllocationRegion(void* ptr) {
+      auto entry =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      CHECK(entry != regions_.end() && entry->ptr() == ptr)
+          << "Could not find Region for " << ptr;
+      regions_.erase(entry);
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -342,6 +396,24 @@ class BFCAllocator : public VisitableAllocator {
   ChunkHandle AllocateChunk() EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void DeallocateChunk(ChunkHandle h) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Blocks until 'l', constructed with std::try_to_lock on lock_, holds the
+  // lock, recording the wait in the lock-wait stats if it had to block.
+  void WaitForLock(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the thread cache shard used by the calling thread.
+  ThreadCacheShard* ThreadCacheShardForCaller();
+
+  // Returns a cached chunk of exactly 'rounded_bytes', or nullptr.
+  void* AllocateFromThreadCache(size_t rounded_bytes);
+
+  // Buffers 'ptr' in the caller's shard, flushing the buffer once it holds
+  // kThreadCacheFreeBatch pointers.
+  void DeallocateToThreadCache(void* ptr);
+
+  // Returns every chunk held by the thread cache to the bins.  Returns true
+  // if any chunk was returned.
+  bool ReleaseThreadCache();
+
   Chunk* ChunkFromHandle(ChunkHandle h) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   AllocatorRetry retry_helper_;
@@ -403,6 +475,8 @@ class BFCAllocator : public VisitableAllocator {
 
   // Called once on each region, ASAP.
   std::vector<Visitor> region_visitors_;
+  // Called on each region before it is released.
+  std::vector<Visitor> free_visitors_;
 
   // Counter containing the next unique identifier to assign to a
   // newly-created chunk.
@@ -411,6 +485,10 @@ class BFCAllocator : public VisitableAllocator {
   // Stats.
   AllocatorStats stats_ GUARDED_BY(lock_);
 
+  // Optional front-end cache; see ThreadCacheShard.
+  int num_thread_cache_shards_ = 0;
+  std::unique_ptr<ThreadCacheShard[]> thread_cache_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
 
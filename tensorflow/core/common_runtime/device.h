@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -104,6 +105,24 @@ class Device : public DeviceBase {
   // at completion.
   virtual Status Sync() = 0;
 
+  // Returns the memory that the device holds for reuse, but that no
+  // tensor occupies, to the system. Called between steps if requested
+  // in the session options; the default does nothing.
+  virtual void ReleaseUnusedMemory() {}
+
+  // The time that the executions of an op have taken on the device.
+  struct OpTime {
+    int64 total_usecs = 0;
+    int64 count = 0;
+  };
+  typedef std::unordered_map<string, OpTime> OpTimes;
+
+  // Moves the op times that the device has measured since the last call
+  // to "*op_times", keyed by node name. Only devices that sample the time
+  // of their ops (see GPUOptions.device_timing_sample_steps) measure any;
+  // the default measures none.
+  virtual void TakeSampledOpTimes(OpTimes* op_times) {}
+
   // Optionally modify the device's GraphDef before execution.
   //
   // This method should be considered experimental and is supplied to enable
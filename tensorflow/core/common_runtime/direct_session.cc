@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -71,6 +72,13 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Not labelled by session: a cell per DirectSession would never be released,
+// and processes that create sessions repeatedly would keep growing it.
+auto* direct_session_step_latency_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/direct_session/step_latency_usecs",
+     "The time each DirectSession step spends running its executors."},
+    monitoring::ExponentialBuckets(1, 2, 32));
+
 int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options) {
   const int32 t = options.config.inter_op_parallelism_threads();
   if (t != 0) return t;
@@ -127,6 +135,13 @@ class DirectSessionFactory : public SessionFactory {
   }
 
   Session* NewSession(const SessionOptions& options) override {
+    if (options.config.scheduling_options().use_shared_scheduler() &&
+        (options.config.use_per_session_threads() ||
+         options.config.session_inter_op_thread_pool_size() > 0)) {
+      LOG(ERROR) << "scheduling_options.use_shared_scheduler cannot be "
+                    "combined with per-session inter-op thread pools";
+      return nullptr;
+    }
     // Must do this before the CPU allocator is created.
     if (options.config.graph_options().build_cost_model() > 0) {
       EnableCPUAllocatorFullStats(true);
@@ -217,7 +232,11 @@ void DirectSession::SchedClosure(thread::ThreadPool* pool,
   // safe given the reasoning above.
   c();
 #else
-  pool->Schedule(std::move(c));
+  if (scheduler_client_ != nullptr) {
+    scheduler_client_->Schedule(std::move(c));
+  } else {
+    pool->Schedule(std::move(c));
+  }
 #endif  // __ANDROID__
 }
 
@@ -242,6 +261,14 @@ DirectSession::DirectSession(const SessionOptions& options,
   } else {
     thread_pools_.push_back(GlobalThreadPool(options));
     owns_thread_pools_ = false;
+    const SessionSchedulingOptions& scheduling_options =
+        options_.config.scheduling_options();
+    if (scheduling_options.use_shared_scheduler()) {
+      scheduler_client_ =
+          SessionScheduler::Global(thread_pools_[0])
+              ->NewClient(scheduling_options.weight(),
+                          scheduling_options.max_concurrency());
+    }
   }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
@@ -290,6 +317,7 @@ DirectSession::~DirectSession() {
     d->op_segment()->RemoveHold(session_handle_);
   }
   delete cancellation_manager_;
+  scheduler_client_.reset();
   if (owns_thread_pools_) {
     for (auto* p : thread_pools_) delete p;
   }
@@ -429,8 +457,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   ExecutorsAndKeys* executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
 
-  Executor::Args args;
-  args.step_id = step_id_counter_.fetch_add(1);
+  const int64 step_id = step_id_counter_.fetch_add(1);
 
   TF_RETURN_IF_ERROR(
       GetOrCreateExecutors(pool, input_tensor_names, output_names, target_nodes,
@@ -440,7 +467,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   std::unique_ptr<DebuggerStateInterface> debugger_state;
   if (!run_options.debug_options().debug_tensor_watch_opts().empty()) {
     TF_RETURN_IF_ERROR(CreateDebuggerState(
-        run_options.debug_options(), args.step_id, executor_step_count,
+        run_options.debug_options(), step_id, executor_step_count,
         input_tensor_names, output_names, target_nodes, &debugger_state));
   }
 
@@ -467,11 +494,48 @@ Status DirectSession::Run(const RunOptions& run_options,
     return s;
   }
 
+  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
+                                 executors_and_keys, executor_step_count, pool,
+                                 run_state_args.handle, output_names,
+                                 run_metadata));
+
+  // Receive outputs.
+  if (outputs) {
+    std::vector<Tensor> sorted_outputs;
+    Status s = call_frame.ConsumeRetvals(&sorted_outputs);
+    if (errors::IsInternal(s)) {
+      return errors::InvalidArgument(s.error_message());
+    } else if (!s.ok()) {
+      return s;
+    }
+    outputs->clear();
+    outputs->reserve(sorted_outputs.size());
+    for (const string& output_name : output_names) {
+      outputs->emplace_back(
+          std::move(sorted_outputs[executors_and_keys
+                                       ->output_name_to_index[output_name]]));
+    }
+  }
+
+  return Status::OK();
+}
+
+Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
+                                  FunctionCallFrame* call_frame,
+                                  ExecutorsAndKeys* executors_and_keys,
+                                  int64 executor_step_count,
+                                  thread::ThreadPool* pool,
+                                  const string& handle,
+                                  const std::vector<string>& output_names,
+                                  RunMetadata* run_metadata) {
+  Executor::Args args;
+  args.step_id = step_id;
+
   // Create a run state and start execution.
   RunState run_state(args.step_id, &devices_);
   run_state.rendez = new IntraProcessRendezvous(device_mgr_.get());
   CancellationManager step_cancellation_manager;
-  args.call_frame = &call_frame;
+  args.call_frame = call_frame;
 
   // Start parallel Executors.
   const size_t num_executors = executors_and_keys->items.size();
@@ -493,7 +557,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
   if (LogMemory::IsEnabled()) {
-    LogMemory::RecordStep(args.step_id, run_state_args.handle);
+    LogMemory::RecordStep(args.step_id, handle);
   }
   args.sync_on_finish = sync_on_finish_;
 
@@ -544,6 +608,7 @@ Status DirectSession::Run(const RunOptions& run_options,
     return errors::Cancelled("Run call was cancelled");
   }
 
+  const uint64 start_time_usecs = options_.env->NowMicros();
   for (const auto& item : executors_and_keys->items) {
     item.executor->RunAsync(args, barrier->Get());
   }
@@ -552,6 +617,15 @@ Status DirectSession::Run(const RunOptions& run_options,
                       run_options.timeout_in_ms() > 0
                           ? run_options.timeout_in_ms()
                           : operation_timeout_in_ms_);
+  static monitoring::SamplerCell* step_latency_cell =
+      direct_session_step_latency_usecs->GetCell();
+  step_latency_cell->Add(options_.env->NowMicros() - start_time_usecs);
+
+  if (options_.config.gpu_options().release_free_regions_after_step()) {
+    for (const auto& item : executors_and_keys->items) {
+      item.flib->device()->ReleaseUnusedMemory();
+    }
+  }
 
   if (!cancellation_manager_->DeregisterCallback(cancellation_token)) {
     // The step has been cancelled: make sure we don't attempt to receive the
@@ -573,30 +647,28 @@ Status DirectSession::Run(const RunOptions& run_options,
     TF_RETURN_IF_ERROR(run_state.status);
   }
 
-  // Receive outputs.
-  if (outputs) {
-    std::vector<Tensor> sorted_outputs;
-    Status s = call_frame.ConsumeRetvals(&sorted_outputs);
-    if (errors::IsInternal(s)) {
-      return errors::InvalidArgument(s.error_message());
-    } else if (!s.ok()) {
-      return s;
-    }
-    outputs->clear();
-    outputs->reserve(sorted_outputs.size());
-    for (const string& output_name : output_names) {
-      outputs->emplace_back(
-          std::move(sorted_outputs[executors_and_keys
-                                       ->output_name_to_index[output_name]]));
-    }
-  }
-
   // Save the output tensors of this run we choose to keep.
   TF_RETURN_IF_ERROR(
       run_state.tensor_store.SaveTensors(output_names, &session_state_));
 
   // Build and return the cost model as instructed.
   mutex_lock l(executor_lock_);
+  if (options_.config.gpu_options().device_timing_sample_steps() > 0) {
+    // Fold the op times that the devices have sampled into the cost model.
+    // They complete asynchronously, so they may belong to an earlier step.
+    for (const auto& item : executors_and_keys->items) {
+      Device::OpTimes op_times;
+      item.flib->device()->TakeSampledOpTimes(&op_times);
+      if (op_times.empty()) continue;
+      CostModel* cm = cost_model_manager_.FindOrCreateCostModel(item.graph);
+      for (const Node* n : item.graph->op_nodes()) {
+        auto it = op_times.find(n->name());
+        if (it == op_times.end()) continue;
+        cm->RecordTime(n, Microseconds(it->second.total_usecs));
+        cm->RecordCount(n, it->second.count);
+      }
+    }
+  }
   if (update_cost_model) {
     // Build the cost model
     std::unordered_map<string, const Graph*> device_to_graph;
@@ -630,6 +702,161 @@ Status DirectSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+Status DirectSession::MakeCallable(const RunOptions& run_options,
+                                   const std::vector<string>& feed_names,
+                                   const std::vector<string>& fetch_names,
+                                   const std::vector<string>& target_names,
+                                   CallableHandle* out_handle) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  {
+    mutex_lock l(graph_def_lock_);
+    if (!graph_created_) {
+      return errors::InvalidArgument(
+          "Session was not created with a graph before MakeCallable()!");
+    }
+  }
+  if (run_options.inter_op_thread_pool() < 0 ||
+      run_options.inter_op_thread_pool() >= thread_pools_.size()) {
+    return errors::InvalidArgument("Invalid inter_op_thread_pool: ",
+                                   run_options.inter_op_thread_pool());
+  }
+
+  std::unique_ptr<Callable> callable(new Callable);
+  callable->run_options = run_options;
+  callable->pool = thread_pools_[run_options.inter_op_thread_pool()];
+  callable->feed_names = feed_names;
+  callable->fetch_names = fetch_names;
+  callable->target_names = target_names;
+  RunStateArgs run_state_args(run_options.debug_options());
+  TF_RETURN_IF_ERROR(GetOrCreateExecutors(
+      callable->pool, feed_names, fetch_names, target_names,
+      &callable->executors_and_keys, &run_state_args));
+  callable->handle = run_state_args.handle;
+
+  // Resolve every name to its call frame slot now, so that RunCallable()
+  // does no string processing.
+  ExecutorsAndKeys* executors_and_keys = callable->executors_and_keys;
+  callable->feed_arg_index.reserve(feed_names.size());
+  for (const string& name : feed_names) {
+    auto it = executors_and_keys->input_name_to_index.find(name);
+    if (it == executors_and_keys->input_name_to_index.end()) {
+      return errors::InvalidArgument("Unknown feed: ", name);
+    }
+    callable->feed_arg_index.push_back(it->second);
+  }
+  callable->fetch_retval_index.reserve(fetch_names.size());
+  for (const string& name : fetch_names) {
+    auto it = executors_and_keys->output_name_to_index.find(name);
+    if (it == executors_and_keys->output_name_to_index.end()) {
+      return errors::InvalidArgument("Unknown fetch: ", name);
+    }
+    callable->fetch_retval_index.push_back(it->second);
+  }
+
+  mutex_lock l(callables_lock_);
+  const CallableHandle h = next_callable_handle_++;
+  callables_[h] = std::move(callable);
+  *out_handle = h;
+  return Status::OK();
+}
+
+std::shared_ptr<const DirectSession::Callable> DirectSession::LookupCallable(
+    CallableHandle handle) {
+  mutex_lock l(callables_lock_);
+  auto it = callables_.find(handle);
+  if (it == callables_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+Status DirectSession::RunCallable(CallableHandle handle,
+                                  const std::vector<Tensor>& feed_tensors,
+                                  std::vector<Tensor>* fetch_tensors,
+                                  RunMetadata* run_metadata) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  direct_session_runs->GetCell()->IncrementBy(1);
+  // Holds the callable until the step is done, in case it is released by
+  // another thread.
+  std::shared_ptr<const Callable> callable = LookupCallable(handle);
+  if (callable == nullptr) {
+    return errors::InvalidArgument("No such callable handle: ", handle);
+  }
+  if (feed_tensors.size() != callable->feed_arg_index.size()) {
+    return errors::InvalidArgument(
+        "Expected ", callable->feed_arg_index.size(),
+        " feed tensors but got ", feed_tensors.size());
+  }
+  RunMetadata unused_run_metadata;
+  if (run_metadata == nullptr) {
+    run_metadata = &unused_run_metadata;
+  }
+
+  ExecutorsAndKeys* executors_and_keys = callable->executors_and_keys;
+  const int64 step_id = step_id_counter_.fetch_add(1);
+  const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
+
+  std::unique_ptr<DebuggerStateInterface> debugger_state;
+  const DebugOptions& debug_options = callable->run_options.debug_options();
+  if (!debug_options.debug_tensor_watch_opts().empty()) {
+    TF_RETURN_IF_ERROR(CreateDebuggerState(
+        debug_options, step_id, executor_step_count, callable->feed_names,
+        callable->fetch_names, callable->target_names, &debugger_state));
+  }
+
+  FunctionCallFrame call_frame(executors_and_keys->input_types,
+                               executors_and_keys->output_types);
+  gtl::InlinedVector<Tensor, 4> feed_args(feed_tensors.size());
+  for (size_t i = 0; i < feed_tensors.size(); ++i) {
+    Tensor* arg = &feed_args[callable->feed_arg_index[i]];
+    if (feed_tensors[i].dtype() == DT_RESOURCE) {
+      TF_RETURN_IF_ERROR(ResourceHandleToInputTensor(feed_tensors[i], arg));
+    } else {
+      *arg = feed_tensors[i];
+    }
+  }
+  Status s = call_frame.SetArgs(feed_args);
+  if (errors::IsInternal(s)) {
+    return errors::InvalidArgument(s.error_message());
+  } else if (!s.ok()) {
+    return s;
+  }
+
+  TF_RETURN_IF_ERROR(RunInternal(
+      step_id, callable->run_options, &call_frame, executors_and_keys,
+      executor_step_count, callable->pool, callable->handle,
+      callable->fetch_names, run_metadata));
+
+  if (fetch_tensors) {
+    std::vector<Tensor> sorted_outputs;
+    Status s = call_frame.ConsumeRetvals(&sorted_outputs);
+    if (errors::IsInternal(s)) {
+      return errors::InvalidArgument(s.error_message());
+    } else if (!s.ok()) {
+      return s;
+    }
+    fetch_tensors->clear();
+    fetch_tensors->reserve(callable->fetch_retval_index.size());
+    for (size_t index : callable->fetch_retval_index) {
+      fetch_tensors->push_back(sorted_outputs[index]);
+    }
+  }
+  return Status::OK();
+}
+
+Status DirectSession::ReleaseCallable(CallableHandle handle) {
+  // The callable is deleted after the lock is released, if no step holds it.
+  std::shared_ptr<const Callable> callable;
+  mutex_lock l(callables_lock_);
+  auto it = callables_.find(handle);
+  if (it == callables_.end()) {
+    return errors::InvalidArgument("No such callable handle: ", handle);
+  }
+  callable = std::move(it->second);
+  callables_.erase(it);
+  return Status::OK();
+}
+
 Status DirectSession::PRunSetup(const std::vector<string>& input_names,
                                 const std::vector<string>& output_names,
                                 const std::vector<string>& target_nodes,
@@ -1129,6 +1356,13 @@ Status DirectSession::GetOrCreateExecutors(
       }
     };
     params.node_outputs_cb = node_outputs_callback_;
+    const ExecutorOptions& executor_opts = options_.config.executor_options();
+    if (executor_opts.use_work_stealing()) {
+      params.num_ready_queues = executor_opts.num_ready_queues() > 0
+                                    ? executor_opts.num_ready_queues()
+                                    : pool->NumThreads();
+    }
+    params.plan_step_memory = executor_opts.plan_step_memory();
 
     optimizer.Optimize(lib, options_.env, device, &iter->second);
 
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/session_scheduler.h"
 #include "tensorflow/core/common_runtime/simple_graph_execution_state.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -91,6 +92,18 @@ class DirectSession : public Session {
                             const std::vector<string>& output_names,
                             std::vector<Tensor>* outputs) override;
 
+  // NOTE: Experimental and subject to change.
+  ::tensorflow::Status MakeCallable(const RunOptions& run_options,
+                                    const std::vector<string>& feed_names,
+                                    const std::vector<string>& fetch_names,
+                                    const std::vector<string>& target_names,
+                                    CallableHandle* out_handle) override;
+  ::tensorflow::Status RunCallable(CallableHandle handle,
+                                   const std::vector<Tensor>& feed_tensors,
+                                   std::vector<Tensor>* fetch_tensors,
+                                   RunMetadata* run_metadata) override;
+  ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
+
   // Reset clears 'containers' from the device_mgr of the DirectSession.
   // If 'containers' is empty, then Reset clears the default container.
   ::tensorflow::Status Reset(const std::vector<string>& containers);
@@ -170,6 +183,22 @@ class DirectSession : public Session {
     ~RunState();
   };
 
+  // A feed/fetch/target signature resolved by MakeCallable().
+  // 'feed_arg_index[i]' is the call frame argument fed by the i-th feed and
+  // 'fetch_retval_index[i]' the call frame return value of the i-th fetch.
+  struct Callable {
+    RunOptions run_options;
+    thread::ThreadPool* pool = nullptr;  // Not owned.
+    ExecutorsAndKeys* executors_and_keys = nullptr;  // Owned by executors_.
+    std::vector<size_t> feed_arg_index;
+    std::vector<size_t> fetch_retval_index;
+    std::vector<string> feed_names;
+    std::vector<string> fetch_names;
+    std::vector<string> target_names;
+    // The handle used to log memory, if memory logging is enabled.
+    string handle;
+  };
+
   struct RunStateArgs {
     RunStateArgs(const DebugOptions& options) : debug_options(options) {}
 
@@ -202,6 +231,23 @@ class DirectSession : public Session {
       RunStateArgs* run_state_args, DataTypeVector* input_types,
       DataTypeVector* output_types);
 
+  // Runs one step of 'executors_and_keys', feeding and fetching through
+  // 'call_frame'. 'handle' identifies the step for memory logging, and
+  // 'output_names' are the fetches whose tensors may be kept in the
+  // session state.
+  ::tensorflow::Status RunInternal(int64 step_id, const RunOptions& run_options,
+                                   FunctionCallFrame* call_frame,
+                                   ExecutorsAndKeys* executors_and_keys,
+                                   int64 executor_step_count,
+                                   thread::ThreadPool* pool,
+                                   const string& handle,
+                                   const std::vector<string>& output_names,
+                                   RunMetadata* run_metadata);
+
+  // Returns the callable for 'handle', or nullptr. The callable stays
+  // valid while the caller holds it, even if it is released meanwhile.
+  std::shared_ptr<const Callable> LookupCallable(CallableHandle handle);
+
   ::tensorflow::Status ExtendLocked(const GraphDef& graph)
       EXCLUSIVE_LOCKS_REQUIRED(graph_def_lock_);
 
@@ -269,6 +315,8 @@ class DirectSession : public Session {
   // The thread-pools to use for running ops.
   std::vector<thread::ThreadPool*> thread_pools_;
   bool owns_thread_pools_ = false;
+  // If set, closures are scheduled through it instead of on thread_pools_.
+  std::unique_ptr<SessionScheduler::Client> scheduler_client_;
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
@@ -284,6 +332,13 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       GUARDED_BY(executor_lock_);
 
+  // Callables made by MakeCallable(), indexed by handle. Handles are not
+  // reused, so a released handle cannot refer to a later callable.
+  mutex callables_lock_;
+  std::unordered_map<CallableHandle, std::shared_ptr<const Callable>>
+      callables_ GUARDED_BY(callables_lock_);
+  CallableHandle next_callable_handle_ GUARDED_BY(callables_lock_) = 0;
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       GUARDED_BY(executor_lock_);
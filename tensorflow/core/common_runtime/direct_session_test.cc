@@ -36,6 +36,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
@@ -107,6 +111,46 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+// Returns the total number of samples, or the sum of the values, of all
+// the points of the metric "name".
+double SumMetricPoints(const string& name) {
+  std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  auto it = metrics->point_set_map.find(name);
+  if (it == metrics->point_set_map.end()) return 0;
+  double sum = 0;
+  for (const auto& point : it->second->points) {
+    sum += point->value_type == monitoring::ValueType::kHistogram
+               ? point->histogram_value.num()
+               : point->int64_value;
+  }
+  return sum;
+}
+
+TEST_F(DirectSessionMinusAXTest, TestStepMetrics) {
+  Initialize({3, 2, -1, 0});
+  std::unique_ptr<Session> session(CreateSession());
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<Tensor> outputs;
+  // Build the executors outside of the measured step.
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+
+  const double steps_before =
+      SumMetricPoints("/tensorflow/core/direct_session/step_latency_usecs");
+  const double executor_steps_before =
+      SumMetricPoints("/tensorflow/core/executor/max_outstanding_ops");
+  const double ops_before = SumMetricPoints("/tensorflow/core/executor/ops");
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+  EXPECT_EQ(steps_before + 1, SumMetricPoints(
+                                  "/tensorflow/core/direct_session/"
+                                  "step_latency_usecs"));
+  EXPECT_LT(executor_steps_before,
+            SumMetricPoints("/tensorflow/core/executor/max_outstanding_ops"));
+  // At least the two constants, the matmul and the negation ran.
+  EXPECT_LE(ops_before + 4, SumMetricPoints("/tensorflow/core/executor/ops"));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestFeed) {
   Initialize({1, 2, 3, 4});
   std::unique_ptr<Session> session(CreateSession());
@@ -205,6 +249,113 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestSharedScheduler) {
+  Initialize({1, 2, 3, 4});
+
+  // Two sessions of different weights, one of them limited to one closure
+  // at a time, share the global inter-op threads.
+  std::vector<std::unique_ptr<Session>> sessions;
+  for (int i = 0; i < 2; ++i) {
+    SessionOptions options;
+    SessionSchedulingOptions* scheduling_options =
+        options.config.mutable_scheduling_options();
+    scheduling_options->set_use_shared_scheduler(true);
+    scheduling_options->set_weight(i + 1);
+    scheduling_options->set_max_concurrency(i == 0 ? 1 : 0);
+    (*options.config.mutable_device_count())["CPU"] = 2;
+    sessions.emplace_back(NewSession(options));
+    ASSERT_TRUE(sessions.back() != nullptr);
+    TF_ASSERT_OK(sessions.back()->Create(def_));
+  }
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+  std::vector<string> output_names = {y_ + ":0"};
+  for (int i = 0; i < 4; ++i) {
+    Session* session = sessions[i % 2].get();
+    tp->Schedule([session, output_names]() {
+      for (int j = 0; j < 100; ++j) {
+        std::vector<Tensor> outputs;
+        TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+        ASSERT_EQ(1, outputs.size());
+        EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+      }
+    });
+  }
+  delete tp;
+}
+
+TEST(DirectSessionTest, SharedSchedulerConflictsWithPerSessionThreads) {
+  SessionOptions options;
+  options.config.mutable_scheduling_options()->set_use_shared_scheduler(true);
+  options.config.set_use_per_session_threads(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  EXPECT_TRUE(session == nullptr);
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithCallable) {
+  Initialize({1, 2, 3, 4});
+  std::unique_ptr<Session> session(CreateSession());
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(RunOptions(), {x_ + ":0"},
+                                     {y_neg_ + ":0", y_ + ":0"}, {},
+                                     &handle));
+
+  for (int i = 0; i < 3; ++i) {
+    Tensor t(DT_FLOAT, TensorShape({2, 1}));
+    test::FillValues<float>(&t, {1, i});
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {t}, &outputs, nullptr));
+    ASSERT_EQ(2, outputs.size());
+    // y = [1 2; 3 4] * [1; i]
+    EXPECT_FLOAT_EQ(-(1.0 + 2.0 * i), outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(3.0 + 4.0 * i, outputs[1].matrix<float>()(1, 0));
+  }
+
+  // The wrong number of feeds is rejected.
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->RunCallable(handle, {}, &outputs, nullptr)));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->RunCallable(handle, {}, &outputs, nullptr)));
+  EXPECT_TRUE(errors::IsInvalidArgument(session->ReleaseCallable(handle)));
+}
+
+TEST_F(DirectSessionMinusAXTest, TestPlanStepMemory) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  options.config.mutable_executor_options()->set_plan_step_memory(true);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Run concurrently so that later steps overlap the planned ones.
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+  std::vector<string> output_names = {y_ + ":0", y_neg_ + ":0"};
+  auto fn = [&session, output_names]() {
+    for (int i = 0; i < 100; ++i) {
+      std::vector<std::pair<string, Tensor>> inputs;
+      std::vector<Tensor> outputs;
+      Status s = session->Run(inputs, output_names, {}, &outputs);
+      TF_ASSERT_OK(s);
+      ASSERT_EQ(2, outputs.size());
+      EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+      EXPECT_FLOAT_EQ(-3.0, outputs[1].matrix<float>()(0, 0));
+    }
+  };
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule(fn);
+  }
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   std::unique_ptr<Session> session(CreateSession());
@@ -293,6 +444,41 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST(DirectSessionTest, MultipleComputeStreams) {
+  // Independent branches, which run on different streams of the GPU if
+  // there is one, joined by ops that wait for several streams.
+  Graph g(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&g, a_tensor);
+  std::vector<Node*> branches;
+  for (int i = 0; i < 4; ++i) {
+    branches.push_back(test::graph::Matmul(&g, a, a, false, false));
+  }
+  Node* sum = test::graph::Add(&g, test::graph::Add(&g, branches[0], branches[1]),
+                              test::graph::Add(&g, branches[2], branches[3]));
+  GraphDef def;
+  test::graph::ToGraphDef(&g, &def);
+  for (NodeDef& node : *def.mutable_node()) {
+    node.set_device("/gpu:0");
+  }
+
+  SessionOptions options;
+  options.config.set_allow_soft_placement(true);
+  options.config.mutable_gpu_options()->set_num_compute_streams(4);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {sum->name() + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({28, 40, 60, 88}, TensorShape({2, 2})),
+        outputs[0]);
+  }
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -1220,5 +1406,52 @@ void BM_FeedFetch(int iters, int num_feeds) {
 
 BENCHMARK(BM_FeedFetch)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 
+// Runs one chain of large matmuls per NUMA node, each chain placed on its
+// own CPU device when "use_numa_devices" is true and on /cpu:0 otherwise.
+// On a single-node host both variants run the same graph.
+void BM_NUMAMatMul(int iters, int use_numa_devices) {
+  testing::StopTiming();
+  const int kDim = 1024;
+  const int kChainLength = 4;
+  const int num_chains = port::NUMANumNodes();
+  Graph g(OpRegistry::Global());
+  std::unordered_map<string, string> devices;
+  std::vector<string> targets;
+  for (int c = 0; c < num_chains; ++c) {
+    const string device = strings::StrCat("/cpu:", use_numa_devices ? c : 0);
+    Tensor m(DT_FLOAT, TensorShape({kDim, kDim}));
+    m.flat<float>().setRandom();
+    Node* a = test::graph::Constant(&g, m);
+    Node* x = test::graph::Constant(&g, m);
+    devices[a->name()] = device;
+    devices[x->name()] = device;
+    for (int i = 0; i < kChainLength; ++i) {
+      x = test::graph::Matmul(&g, a, x, false, false);
+      devices[x->name()] = device;
+    }
+    targets.push_back(x->name());
+  }
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  for (NodeDef& node : *gd.mutable_node()) {
+    node.set_device(devices[node.name()]);
+  }
+  SessionOptions opts;
+  opts.config.set_use_numa_devices(use_numa_devices != 0);
+  std::unique_ptr<Session> sess(NewSession(opts));
+  TF_CHECK_OK(sess->Create(gd));
+  // Ignore the first run, which includes graph partitioning.
+  TF_CHECK_OK(sess->Run({}, {}, targets, nullptr));
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_chains *
+                          kChainLength * 2 * kDim * kDim * kDim);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(sess->Run({}, {}, targets, nullptr));
+  }
+  testing::StopTiming();
+}
+
+BENCHMARK(BM_NUMAMatMul)->Arg(0)->Arg(1);
+
 }  // namespace
 }  // namespace tensorflow
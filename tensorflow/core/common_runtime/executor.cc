@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -50,10 +52,13 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -66,6 +71,31 @@ namespace {
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+// Always-on executor metrics. Each step accumulates them in a few atomics
+// and reports them once, when it finishes.
+auto* executor_ops = monitoring::Counter<1>::New(
+    "/tensorflow/core/executor/ops",
+    "The number of nodes run by local executors, by whether the thread that "
+    "made them ready ran them inline or dispatched them to a new closure.",
+    "dispatch");
+
+auto* executor_dispatch_delay_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/executor/dispatch_delay_usecs",
+     "The mean delay, per step, between dispatching a ready node to the "
+     "runner and starting to run it."},
+    monitoring::ExponentialBuckets(1, 2, 24));
+
+auto* executor_max_outstanding_ops = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/executor/max_outstanding_ops",
+     "The largest number of nodes that were ready or running at once, per "
+     "step."},
+    monitoring::ExponentialBuckets(1, 2, 20));
+
+auto* executor_step_output_bytes = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/executor/step_output_bytes",
+     "The total size of the tensors produced by the nodes of each step."},
+    monitoring::ExponentialBuckets(1024, 4, 16));
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -195,6 +225,50 @@ void SetReferencedTensors(NodeExecStats* nt,
 class ExecutorImpl;
 class GraphView;
 
+// Returns the size of the per-step arena of "impl": the exact space that the
+// state an ExecutorState allocates when a step starts takes in a StepArena.
+size_t StepArenaSize(const ExecutorImpl* impl);
+
+// A single buffer, sized by StepArenaSize(), out of which an ExecutorState
+// carves its step-start state. Unlike core::Arena, which allocates requests
+// larger than a quarter of its block separately, it never allocates more
+// than its initial buffer. Not thread-safe.
+class StepArena {
+ public:
+  // The alignment of the buffer, and the granularity of the allocations.
+  static constexpr size_t kAlignment = 16;
+
+  // Returns the space that an allocation of "size" bytes takes.
+  static size_t AllocatedSize(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  explicit StepArena(size_t size)
+      : base_(static_cast<char*>(port::AlignedMalloc(size, kAlignment))),
+        size_(size) {
+    CHECK(size == 0 || base_ != nullptr);
+  }
+  ~StepArena() { port::AlignedFree(base_); }
+
+  // Returns "size" bytes aligned to "alignment", which must not exceed
+  // kAlignment.
+  char* AllocAligned(size_t size, size_t alignment) {
+    DCHECK_LE(alignment, kAlignment);
+    CHECK_LE(used_ + AllocatedSize(size), size_)
+        << "The step state outgrew StepArenaSize()";
+    char* ptr = base_ + used_;
+    used_ += AllocatedSize(size);
+    return ptr;
+  }
+
+ private:
+  char* const base_;
+  const size_t size_;
+  size_t used_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArena);
+};
+
 struct EdgeInfo {
   int dst_id;
   int output_slot : 31;
@@ -236,6 +310,11 @@ struct NodeItem {
 
   PendingCounts::Handle pending_id;
 
+  // The scheduling priority of this node, from its optional "_priority"
+  // attr (see grappler::SchedulingPriorities), or 0. Ready nodes with higher
+  // priorities are run first.
+  int64 priority = 0;
+
   const EdgeInfo* output_edge_list() const { return output_edge_base(); }
 
   // ith output edge.
@@ -347,6 +426,9 @@ class ExecutorImpl : public Executor {
     for (auto fiter : frame_info_) {
       delete fiter.second;
     }
+    if (memory_planner_ != nullptr) {
+      memory_planner_->Unref();
+    }
     delete graph_;
   }
 
@@ -361,6 +443,7 @@ class ExecutorImpl : public Executor {
 
  private:
   friend class ExecutorState;
+  friend size_t StepArenaSize(const ExecutorImpl* impl);
 
   struct ControlFlowInfo {
     gtl::FlatSet<string, HashStr> unique_frame_names;
@@ -417,9 +500,47 @@ class ExecutorImpl : public Executor {
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // True iff some node of the graph has a scheduling priority, in which case
+  // each batch of ready nodes is sorted by decreasing priority.
+  bool has_priorities_ = false;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
+  // True iff the graph has no loops, i.e. no Enter, Exit or NextIteration
+  // nodes, so that all its nodes run in a single iteration of the root
+  // frame. Such graphs are run with a static schedule: each step keeps a
+  // single dense array of input tensors and a lock-free array of pending
+  // counts indexed by node id, and never creates any FrameState or
+  // IterationState.
+  bool use_static_schedule_ = false;
+
+  // The initial pending count of each node, indexed by node id. Only
+  // populated if use_static_schedule_.
+  std::vector<int32> static_pending_counts_;
+
+  // Under the static schedule, the low bits of the pending count of a
+  // Merge node hold its count as in PendingCounts: twice the number of
+  // pending control inputs, plus one until a live data input arrives. The
+  // first live data input sets kStaticMergeClaimBit before writing its
+  // tensor, and the number of dead data inputs is kept above that.
+  static constexpr int32 kStaticMergePendingMask = (1 << 15) - 1;
+  static constexpr int32 kStaticMergeClaimBit = 1 << 15;
+  static constexpr int kStaticMergeDeadShift = 16;
+
+  // The number of input tensors of all the nodes in the graph. Only
+  // populated if use_static_schedule_.
+  int static_total_inputs_ = 0;
+
+  // Size of the arena that holds the step-scoped state of each
+  // ExecutorState. See StepArenaSize().
+  size_t step_arena_size_ = 0;
+
+  // Serves the default allocations of the nodes from a slab planned after
+  // the first step. Only created if params_.plan_step_memory. Owns a
+  // reference.
+  StepMemoryPlanner* memory_planner_ = nullptr;
+
   // Mapping from frame name to static information about the frame.
   // TODO(yuanbyu): We could cache it along with the graph so to avoid
   // the overhead of constructing it for each executor instance.
@@ -654,6 +775,11 @@ Status ExecutorImpl::Initialize() {
     item->is_sink = IsSink(n);
     item->is_enter_exit_or_next_iter =
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
+    const AttrValue* priority = n->attrs().Find("_priority");
+    if (priority != nullptr) {
+      item->priority = priority->i();
+      has_priorities_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -677,6 +803,40 @@ Status ExecutorImpl::Initialize() {
   // all nodes.
   InitializePending(graph_, cf_info);
 
+  // Precompute the static schedule if the graph has no loops, and its
+  // merges fit the packed pending counts.
+  use_static_schedule_ = true;
+  for (const Node* n : graph_->nodes()) {
+    if (IsEnter(n) || IsExit(n) || IsNextIteration(n)) {
+      use_static_schedule_ = false;
+      break;
+    }
+    if (IsMerge(n)) {
+      size_t max_pending, max_dead;
+      GetMaxPendingCounts(n, &max_pending, &max_dead);
+      const size_t kMax = kStaticMergePendingMask;
+      if (max_pending > kMax || max_dead > kMax) {
+        use_static_schedule_ = false;
+        break;
+      }
+    }
+  }
+  if (use_static_schedule_) {
+    static_pending_counts_.resize(graph_->num_node_ids(), 0);
+    for (const Node* n : graph_->nodes()) {
+      size_t max_pending, max_dead;
+      GetMaxPendingCounts(n, &max_pending, &max_dead);
+      static_pending_counts_[n->id()] = max_pending;
+    }
+    static_total_inputs_ = EnsureFrameInfo("")->total_inputs;
+  }
+  step_arena_size_ = StepArenaSize(this);
+  if (params_.plan_step_memory) {
+    memory_planner_ = new StepMemoryPlanner(
+        params_.device->GetAllocator(AllocatorAttributes()),
+        graph_->num_node_ids());
+  }
+
   return gview_.SetAllocAttrs(graph_, params_.device);
 }
 
@@ -787,6 +947,8 @@ class ExecutorState {
   void RunAsync(Executor::DoneCallback done);
 
  private:
+  friend size_t StepArenaSize(const ExecutorImpl* impl);
+
   // Either a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
   // TODO(yuanbyu): A better way to do "has_value"?
   struct Entry {
@@ -883,6 +1045,18 @@ class ExecutorState {
           counts_(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
+    // Same as above, but keeps the input tensors and the pending counts in
+    // "arena", which must outlive this IterationState.
+    IterationState(const PendingCounts* pending_counts,
+                   int total_input_tensors, StepArena* arena)
+        : input_tensors(NewEntryArray(arena, total_input_tensors)),
+          outstanding_ops(0),
+          outstanding_frame_count(0),
+          counts_(*pending_counts,
+                  arena->AllocAligned(pending_counts->num_bytes(),
+                                      PendingCounts::kStorageAlignment)),
+          num_arena_input_tensors_(total_input_tensors) {}
+
     // The state of an iteration.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
@@ -925,12 +1099,36 @@ class ExecutorState {
                                     dead_result);
     }
 
-    ~IterationState() { delete[] input_tensors; }
+    ~IterationState() {
+      if (num_arena_input_tensors_ < 0) {
+        delete[] input_tensors;
+      } else {
+        DestroyEntryArray(input_tensors, num_arena_input_tensors_);
+      }
+    }
 
    private:
     PendingCounts counts_;
+    // The size of input_tensors if it lives in an arena, or -1 if it was
+    // allocated with new[].
+    const int num_arena_input_tensors_ = -1;
   };
 
+  // Constructs and destroys an array of "n" Entry objects in "arena".
+  static Entry* NewEntryArray(StepArena* arena, int n) {
+    Entry* entries = reinterpret_cast<Entry*>(
+        arena->AllocAligned(n * sizeof(Entry), alignof(Entry)));
+    for (int i = 0; i < n; ++i) {
+      new (&entries[i]) Entry();
+    }
+    return entries;
+  }
+  static void DestroyEntryArray(Entry* entries, int n) {
+    for (int i = 0; i < n; ++i) {
+      entries[i].~Entry();
+    }
+  }
+
   struct FrameState {
     explicit FrameState(const ExecutorImpl* impl, int parallel_iters)
         : executor(impl),
@@ -1163,6 +1361,21 @@ class ExecutorState {
     int front_index_;
   };
 
+  // A ready node waiting in one of the work-stealing ready queues, along
+  // with the time it became ready (used only for step stats).
+  struct QueuedNode {
+    TaggedNode tagged_node;
+    int64 scheduled_usec;
+  };
+
+  // The ready queue owned by one work-stealing worker. The owner pushes
+  // and pops at the back so that it keeps running the successors of the
+  // nodes it just finished; idle siblings steal from the front.
+  struct WorkerQueue {
+    mutex mu;
+    std::deque<QueuedNode> nodes GUARDED_BY(mu);
+  };
+
   struct AsyncState;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
@@ -1187,6 +1400,11 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
 
+  // Holds the state allocated when the step starts (the tensors and pending
+  // counts of the root frame, and the slice reader cache), so that it takes
+  // a single allocation and is released in one go when the step is deleted.
+  StepArena arena_;
+
   // Owned.
 
   // A flag that is set on error after the frame state has been
@@ -1194,13 +1412,44 @@ class ExecutorState {
   bool dumped_on_error_ = false;
 
   // The root frame in which the execution of this step is started.
-  FrameState* root_frame_;
+  // nullptr if impl_->use_static_schedule_.
+  FrameState* root_frame_ = nullptr;
+
+  // The state of a statically scheduled step; see
+  // ExecutorImpl::use_static_schedule_. The tensors are laid out as in the
+  // root frame's IterationState. Each pending count holds the number of
+  // inputs a node is still waiting for, and kStaticDeadBit is set once a
+  // dead input has arrived.
+  static constexpr int32 kStaticDeadBit = 1 << 30;
+  Entry* static_input_tensors_ = nullptr;
+  std::atomic<int32>* static_pending_ = nullptr;
 
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // Step metrics, reported by ReportStepMetrics().
+  std::atomic<int64> max_outstanding_ops_{0};
+  std::atomic<int64> num_dispatched_ops_{0};
+  std::atomic<int64> num_inline_ops_{0};
+  std::atomic<int64> dispatch_delay_usecs_{0};
+  std::atomic<int64> output_bytes_{0};
+
+  // Work-stealing state, used iff num_ready_queues_ > 0.
+  const int num_ready_queues_;
+  std::unique_ptr<WorkerQueue[]> worker_queues_;
+  // The number of workers currently running WorkerLoop().
+  std::atomic<int> num_active_workers_;
+  // The number of nodes in all the worker queues.
+  std::atomic<int> num_queued_nodes_;
+  // Used to assign queues to new workers and to spread pushes from threads
+  // that are not workers (e.g. async kernel callbacks).
+  std::atomic<uint32> next_worker_queue_;
+  // One reference for the completion of the step plus one per active
+  // worker. Whoever drops the last reference runs Finish().
+  std::atomic<int> num_step_refs_;
+
   mutex mu_;
   Status status_ GUARDED_BY(mu_);
 
@@ -1231,8 +1480,10 @@ class ExecutorState {
   void CleanupFramesIterations(FrameState* frame, int64 iter,
                                TaggedNodeSeq* ready);
 
-  // Process a ready node in current thread.
-  void Process(TaggedNode node, int64 scheduled_usec);
+  // Process a ready node in current thread. "queue_id" is the worker queue
+  // owned by the current thread, or -1 if the current thread is not a
+  // work-stealing worker.
+  void Process(TaggedNode node, int64 scheduled_usec, int queue_id);
 
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -1251,15 +1502,41 @@ class ExecutorState {
   void PropagateOutputs(const TaggedNode& tagged_node, const NodeItem* item,
                         EntryVector* outputs, TaggedNodeSeq* ready);
 
+  // The static-schedule counterpart of FrameState::ActivateNodes(). Needs
+  // no locks: every input slot has a single writer, and the pending counts
+  // are atomic. Merge nodes let only the first live data input write its
+  // slot, see ExecutorImpl::kStaticMergeClaimBit.
+  void ActivateNodesStatic(const NodeItem* item, const bool is_dead,
+                           EntryVector* outputs, TaggedNodeSeq* ready);
+
   // "node" just finishes. Takes ownership of "stats". Returns true if
   // execution has completed.
   bool NodeDone(const Status& s, const Node* node, const TaggedNodeSeq& ready,
-                NodeExecStats* stats, TaggedNodeReadyQueue* inline_ready);
+                NodeExecStats* stats, TaggedNodeReadyQueue* inline_ready,
+                int queue_id);
 
   // Schedule all the expensive nodes in 'ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // nodes in 'ready' into 'inline_ready', by decreasing priority if the graph
+  // has scheduling priorities.
   void ScheduleReady(const TaggedNodeSeq& ready,
-                     TaggedNodeReadyQueue* inline_ready);
+                     TaggedNodeReadyQueue* inline_ready, int queue_id);
+
+  // Hands a ready node to another thread: either a new runner_ closure, or
+  // (with work stealing) the worker queue "queue_id", starting a new worker
+  // if there is spare parallelism.
+  void Dispatch(const TaggedNode& tagged_node, int64 scheduled_usec,
+                int queue_id);
+
+  // Work-stealing helpers.
+  //
+  // Starts a new worker if fewer than num_ready_queues_ are active.
+  void MaybeStartWorker();
+  // Pops a ready node from queue "queue_id", or steals one from a sibling.
+  // Returns false if all the queues are empty.
+  bool PopReady(int queue_id, QueuedNode* queued);
+  // The body of a worker closure. Runs ready nodes until all the queues are
+  // empty.
+  void WorkerLoop(int queue_id);
 
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
@@ -1276,7 +1553,21 @@ class ExecutorState {
   void DumpState();
   const Tensor* GetTensorValueForDump(const Entry& input);
 
-  // Clean up when this executor is done.
+  // Raises max_outstanding_ops_ to "outstanding" if it is larger.
+  void UpdateMaxOutstandingOps(int64 outstanding) {
+    int64 prev = max_outstanding_ops_.load(std::memory_order_relaxed);
+    while (outstanding > prev &&
+           !max_outstanding_ops_.compare_exchange_weak(
+               prev, outstanding, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Adds the metrics of this step to the process-wide executor metrics.
+  void ReportStepMetrics();
+
+  // Clean up when this executor is done. With work stealing, this also
+  // releases a reference in num_step_refs_ and only cleans up once the
+  // last worker has exited.
   void Finish();
 
   // A standalone routine for this expression so that we can express
@@ -1286,6 +1577,7 @@ class ExecutorState {
   // be changed out from under us because the iteration is still alive).
   Entry* GetInputTensors(FrameState* input_frame,
                          int64 input_iter) const NO_THREAD_SAFETY_ANALYSIS {
+    if (input_frame == nullptr) return static_input_tensors_;
     return input_frame->GetIteration(input_iter)->input_tensors;
   }
 };
@@ -1299,13 +1591,42 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
       stats_collector_(args.stats_collector),
-      slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
+      slice_reader_cache_(nullptr),
       call_frame_(args.call_frame),
       impl_(impl),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
-      num_outstanding_ops_(0) {
+      arena_(impl->step_arena_size_),
+      num_outstanding_ops_(0),
+      num_ready_queues_(impl->params_.num_ready_queues),
+      num_active_workers_(0),
+      num_queued_nodes_(0),
+      next_worker_queue_(0),
+      num_step_refs_(1) {
+  if (num_ready_queues_ > 0) {
+    worker_queues_.reset(new WorkerQueue[num_ready_queues_]);
+  }
+  slice_reader_cache_ = new (arena_.AllocAligned(
+      sizeof(checkpoint::TensorSliceReaderCacheWrapper),
+      alignof(checkpoint::TensorSliceReaderCacheWrapper)))
+      checkpoint::TensorSliceReaderCacheWrapper;
+  if (impl_->use_static_schedule_) {
+    // No frames and iterations: all the step state lives in two dense
+    // arrays indexed as in the root frame.
+    static_input_tensors_ =
+        NewEntryArray(&arena_, impl_->static_total_inputs_);
+    const int num_nodes = impl_->static_pending_counts_.size();
+    static_pending_ = reinterpret_cast<std::atomic<int32>*>(
+        arena_.AllocAligned(num_nodes * sizeof(std::atomic<int32>),
+                            alignof(std::atomic<int32>)));
+    for (int i = 0; i < num_nodes; ++i) {
+      new (&static_pending_[i])
+          std::atomic<int32>(impl_->static_pending_counts_[i]);
+    }
+    return;
+  }
+
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
@@ -1315,8 +1636,9 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
 
   // Initialize iteration 0.
   root_frame_->iterations.resize(root_frame_->max_parallel_iterations);
-  root_frame_->iterations[0] = new IterationState(
-      root_frame_->pending_counts, root_frame_->total_input_tensors);
+  root_frame_->iterations[0] =
+      new IterationState(root_frame_->pending_counts,
+                         root_frame_->total_input_tensors, &arena_);
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
 }
@@ -1328,7 +1650,32 @@ ExecutorState::~ExecutorState() {
   for (auto it : device_context_map_) {
     it->Unref();
   }
-  delete slice_reader_cache_;
+  slice_reader_cache_->~TensorSliceReaderCacheWrapper();
+  if (static_input_tensors_ != nullptr) {
+    DestroyEntryArray(static_input_tensors_, impl_->static_total_inputs_);
+  }
+  // The remaining step state is released with arena_.
+}
+
+size_t StepArenaSize(const ExecutorImpl* impl) {
+  // Mirrors the allocations of the ExecutorState constructor.
+  size_t bytes = StepArena::AllocatedSize(
+      sizeof(checkpoint::TensorSliceReaderCacheWrapper));
+  if (impl->use_static_schedule_) {
+    bytes += StepArena::AllocatedSize(impl->static_total_inputs_ *
+                                      sizeof(ExecutorState::Entry)) +
+             StepArena::AllocatedSize(impl->static_pending_counts_.size() *
+                                      sizeof(std::atomic<int32>));
+  } else {
+    auto it = impl->frame_info_.find("");
+    if (it != impl->frame_info_.end()) {
+      const ExecutorImpl::FrameInfo* finfo = it->second;
+      bytes += StepArena::AllocatedSize(finfo->total_inputs *
+                                        sizeof(ExecutorState::Entry)) +
+               StepArena::AllocatedSize(finfo->pending_counts->num_bytes());
+    }
+  }
+  return bytes;
 }
 
 Status ExecutorImpl::BuildControlFlowInfo(const Graph* g,
@@ -1434,10 +1781,13 @@ void ExecutorState::RunAsync(Executor::DoneCallback done) {
     done(Status::OK());
   } else {
     num_outstanding_ops_ = ready.size();
-    root_frame_->iterations[0]->outstanding_ops = ready.size();
+    max_outstanding_ops_ = ready.size();
+    if (root_frame_ != nullptr) {
+      root_frame_->iterations[0]->outstanding_ops = ready.size();
+    }
     done_cb_ = std::move(done);
     // Schedule to run all the ready ops in thread pool.
-    ScheduleReady(ready, nullptr);
+    ScheduleReady(ready, nullptr, -1);
   }
 }
 
@@ -1486,7 +1836,8 @@ struct ExecutorState::AsyncState {
   }
 };
 
-void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
+void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec,
+                            int queue_id) {
   const GraphView& gview = impl_->gview_;
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
@@ -1516,12 +1867,25 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   params.input_alloc_attrs = &input_alloc_attrs;
   params.runner = &runner_;
 
+  // Every call runs one dispatched node, followed by the nodes it makes
+  // ready inline.
+  num_dispatched_ops_.fetch_add(1, std::memory_order_relaxed);
+  if (scheduled_usec > 0) {
+    dispatch_delay_usecs_.fetch_add(nodestats::NowInUsec() - scheduled_usec,
+                                    std::memory_order_relaxed);
+  }
+
   Status s;
   NodeExecStats* stats = nullptr;
   EntryVector outputs;
   bool completed = false;
+  bool is_dispatched_node = true;
   inline_ready.push_back(tagged_node);
   while (!inline_ready.empty()) {
+    if (!is_dispatched_node) {
+      num_inline_ops_.fetch_add(1, std::memory_order_relaxed);
+    }
+    is_dispatched_node = false;
     tagged_node = inline_ready.front();
     inline_ready.pop_front();
     const Node* node = tagged_node.node;
@@ -1532,7 +1896,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
 
     // TODO(misard) Replace with a finer-grain enabling flag once we
     // add better optional debugging support.
-    if (vlog_ && VLOG_IS_ON(1)) {
+    if (vlog_ && VLOG_IS_ON(1) && input_frame != nullptr) {
       mutex_lock l(input_frame->mu);
       input_frame->GetIteration(input_iter)->mark_started(item.pending_id);
     }
@@ -1583,16 +1947,21 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         }
         MaybeMarkCompleted(input_frame, input_iter, id);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+        completed =
+            NodeDone(s, item.node, ready, stats, &inline_ready, queue_id);
         continue;
       }
 
       // Set up compute params.
       OpKernel* op_kernel = item.kernel;
       params.op_kernel = op_kernel;
-      params.frame_iter = FrameAndIter(input_frame->frame_id, input_iter);
+      params.frame_iter = FrameAndIter(
+          input_frame != nullptr ? input_frame->frame_id : 0, input_iter);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
+      if (impl_->memory_planner_ != nullptr) {
+        params.default_allocator = impl_->memory_planner_->node_allocator(id);
+      }
 
       if (item.kernel_is_async) {
         // Asynchronous computes.
@@ -1639,7 +2008,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
                                                  accessed);
           }
           bool completed =
-              NodeDone(s, state->item->node, ready, stats, nullptr);
+              NodeDone(s, state->item->node, ready, stats, nullptr, -1);
           delete state;
           if (completed) Finish();
         };
@@ -1683,7 +2052,8 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         scheduled_usec = nodestats::NowInUsec();
       }
       // Postprocess.
-      completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+      completed =
+          NodeDone(s, item.node, ready, stats, &inline_ready, queue_id);
     }
   }  // while !inline_ready.empty()
 
@@ -1794,6 +2164,7 @@ Status ExecutorState::ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
   if (node->id() < device_context_map_.size()) {
     device_context = device_context_map_[node->id()];
   }
+  int64 output_bytes = 0;
 
   // Experimental: debugger (tfdb) access to intermediate node completion.
   if (item.num_outputs == 0 && impl_->params_.node_outputs_cb != nullptr) {
@@ -1861,6 +2232,7 @@ Status ExecutorState::ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
           out->has_value = true;
           out->val_field_is_set = true;
           out->val.Init(std::move(*val.tensor));
+          output_bytes += out->val->TotalBytes();
           if (log_memory_) {
             LogMemory::RecordTensorOutput(ctx->op_kernel().name(),
                                           ctx->step_id(), i, *out->val);
@@ -1886,6 +2258,9 @@ Status ExecutorState::ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
       delete val.tensor;
     }
   }
+  if (output_bytes > 0) {
+    output_bytes_.fetch_add(output_bytes, std::memory_order_relaxed);
+  }
   return s;
 }
 
@@ -1900,6 +2275,11 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
   // Propagates outputs along out edges, and puts newly ready nodes
   // into the ready queue.
   ready->clear();
+  if (input_frame == nullptr) {
+    DCHECK(impl_->use_static_schedule_);
+    ActivateNodesStatic(item, is_dead, outputs, ready);
+    return;
+  }
   bool is_frame_done = false;
   FrameState* output_frame = input_frame;
   int64 output_iter = input_iter;
@@ -1996,7 +2376,8 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
 
 bool ExecutorState::NodeDone(const Status& s, const Node* node,
                              const TaggedNodeSeq& ready, NodeExecStats* stats,
-                             TaggedNodeReadyQueue* inline_ready) {
+                             TaggedNodeReadyQueue* inline_ready,
+                             int queue_id) {
   if (stats) {
     nodestats::SetAllEnd(stats);
     if (!SetTimelineLabel(node, stats)) {
@@ -2031,32 +2412,52 @@ bool ExecutorState::NodeDone(const Status& s, const Node* node,
   if (ready_size == 0 || !s.ok()) {
     completed = (num_outstanding_ops_.fetch_sub(1) == 1);
   } else if (ready_size > 1) {
-    num_outstanding_ops_.fetch_add(ready_size - 1, std::memory_order_relaxed);
+    UpdateMaxOutstandingOps(num_outstanding_ops_.fetch_add(
+                                ready_size - 1, std::memory_order_relaxed) +
+                            ready_size - 1);
   }
 
   // Schedule the ready nodes in 'ready'.
   if (s.ok()) {
-    ScheduleReady(ready, inline_ready);
+    ScheduleReady(ready, inline_ready, queue_id);
   }
   return completed;
 }
 
-void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
-                                  TaggedNodeReadyQueue* inline_ready) {
-  if (ready.empty()) return;
+void ExecutorState::ScheduleReady(const TaggedNodeSeq& unsorted_ready,
+                                  TaggedNodeReadyQueue* inline_ready,
+                                  int queue_id) {
+  if (unsorted_ready.empty()) return;
+  const GraphView& gview = impl_->gview_;
 
+  // Start the nodes on the longest critical paths first: they are dispatched
+  // first, queued first in inline_ready, and the one kept to run on this
+  // thread is the first expensive node rather than the last.
+  const bool by_priority = impl_->has_priorities_ && unsorted_ready.size() > 1;
+  TaggedNodeSeq sorted_ready;
+  if (by_priority) {
+    sorted_ready = unsorted_ready;
+    std::stable_sort(sorted_ready.begin(), sorted_ready.end(),
+                     [&gview](const TaggedNode& a, const TaggedNode& b) {
+                       return gview.node(a.node->id())->priority >
+                              gview.node(b.node->id())->priority;
+                     });
+  }
+  const TaggedNodeSeq& ready = by_priority ? sorted_ready : unsorted_ready;
+
+  // The dispatch time is always needed for the dispatch delay metric, but
+  // inline nodes only need it when collecting stats.
   int64 scheduled_usec = 0;
-  if (stats_collector_) {
+  if (stats_collector_ || inline_ready == nullptr) {
     scheduled_usec = nodestats::NowInUsec();
   }
   if (inline_ready == nullptr) {
     // Schedule to run all the ready ops in thread pool.
     for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_usec); });
+      Dispatch(tagged_node, scheduled_usec, queue_id);
     }
     return;
   }
-  const GraphView& gview = impl_->gview_;
   const TaggedNode* curr_expensive_node = nullptr;
   for (auto& tagged_node : ready) {
     const NodeItem& item = *gview.node(tagged_node.node->id());
@@ -2067,8 +2468,12 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
       if (curr_expensive_node) {
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_usec));
+        if (scheduled_usec == 0) scheduled_usec = nodestats::NowInUsec();
+        if (by_priority) {
+          Dispatch(tagged_node, scheduled_usec, queue_id);
+          continue;
+        }
+        Dispatch(*curr_expensive_node, scheduled_usec, queue_id);
       }
       curr_expensive_node = &tagged_node;
     }
@@ -2080,17 +2485,108 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     } else {
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
-      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_usec));
+      if (scheduled_usec == 0) scheduled_usec = nodestats::NowInUsec();
+      Dispatch(*curr_expensive_node, scheduled_usec, queue_id);
+    }
+  }
+}
+
+void ExecutorState::Dispatch(const TaggedNode& tagged_node,
+                             int64 scheduled_usec, int queue_id) {
+  if (num_ready_queues_ == 0) {
+    runner_([=]() { Process(tagged_node, scheduled_usec, -1); });
+    return;
+  }
+  const bool is_worker = (queue_id >= 0);
+  if (!is_worker) {
+    // A worker may run the node, and finish the step, as soon as it is
+    // pushed, so hold a reference until MaybeStartWorker() returns.
+    num_step_refs_.fetch_add(1);
+    // Spread the nodes over all the queues so that the initial workers do
+    // not immediately have to steal.
+    queue_id = next_worker_queue_.fetch_add(1) % num_ready_queues_;
+  }
+  {
+    WorkerQueue* q = &worker_queues_[queue_id];
+    mutex_lock l(q->mu);
+    q->nodes.push_back(QueuedNode{tagged_node, scheduled_usec});
+  }
+  // NOTE: The increment must happen after the push and before the check
+  // of num_active_workers_ in MaybeStartWorker(); see WorkerLoop().
+  num_queued_nodes_.fetch_add(1);
+  MaybeStartWorker();
+  if (!is_worker) Finish();
+}
+
+void ExecutorState::MaybeStartWorker() {
+  int active = num_active_workers_.load();
+  while (active < num_ready_queues_) {
+    if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+      num_step_refs_.fetch_add(1);
+      const int queue_id = next_worker_queue_.fetch_add(1) % num_ready_queues_;
+      runner_([this, queue_id]() { WorkerLoop(queue_id); });
+      return;
     }
   }
 }
 
+bool ExecutorState::PopReady(int queue_id, QueuedNode* queued) {
+  if (num_queued_nodes_.load() == 0) return false;
+  // Take the most recently pushed node from our own queue.
+  {
+    WorkerQueue* q = &worker_queues_[queue_id];
+    mutex_lock l(q->mu);
+    if (!q->nodes.empty()) {
+      *queued = q->nodes.back();
+      q->nodes.pop_back();
+      num_queued_nodes_.fetch_sub(1);
+      return true;
+    }
+  }
+  // Steal the oldest node from a sibling.
+  for (int i = 1; i < num_ready_queues_; ++i) {
+    WorkerQueue* q = &worker_queues_[(queue_id + i) % num_ready_queues_];
+    mutex_lock l(q->mu);
+    if (!q->nodes.empty()) {
+      *queued = q->nodes.front();
+      q->nodes.pop_front();
+      num_queued_nodes_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ExecutorState::WorkerLoop(int queue_id) {
+  QueuedNode queued{TaggedNode(nullptr, nullptr, -1, false), 0};
+  while (true) {
+    while (PopReady(queue_id, &queued)) {
+      Process(queued.tagged_node, queued.scheduled_usec, queue_id);
+    }
+    // Retire this worker. A node pushed concurrently either saw this worker
+    // as still active (and then shows up in num_queued_nodes_ below) or saw
+    // the decremented count and started a new worker itself.
+    num_active_workers_.fetch_sub(1);
+    if (num_queued_nodes_.load() == 0) break;
+    int active = num_active_workers_.load();
+    bool reactivated = false;
+    while (active < num_ready_queues_) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        reactivated = true;
+        break;
+      }
+    }
+    if (!reactivated) break;
+  }
+  // Drop this worker's reference. The step may be deleted after this.
+  Finish();
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               int64 node_id) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
   // add better optional debugging support.
-  if (vlog_ && VLOG_IS_ON(1)) {
+  if (vlog_ && VLOG_IS_ON(1) && frame != nullptr) {
     const NodeItem* item = impl_->gview_.node(node_id);
     mutex_lock l(frame->mu);
     frame->GetIteration(iter)->mark_completed(item->pending_id);
@@ -2217,7 +2713,33 @@ void ExecutorState::DumpState() {
   }
 }
 
+void ExecutorState::ReportStepMetrics() {
+  static monitoring::CounterCell* dispatched_cell =
+      executor_ops->GetCell("dispatched");
+  static monitoring::CounterCell* inline_cell = executor_ops->GetCell("inline");
+  const int64 num_dispatched = num_dispatched_ops_.load();
+  dispatched_cell->IncrementBy(num_dispatched);
+  inline_cell->IncrementBy(num_inline_ops_.load());
+  static monitoring::SamplerCell* dispatch_delay_cell =
+      executor_dispatch_delay_usecs->GetCell();
+  static monitoring::SamplerCell* max_outstanding_cell =
+      executor_max_outstanding_ops->GetCell();
+  static monitoring::SamplerCell* output_bytes_cell =
+      executor_step_output_bytes->GetCell();
+  if (num_dispatched > 0) {
+    dispatch_delay_cell->Add(
+        static_cast<double>(dispatch_delay_usecs_.load()) / num_dispatched);
+  }
+  max_outstanding_cell->Add(max_outstanding_ops_.load());
+  output_bytes_cell->Add(output_bytes_.load());
+}
+
 void ExecutorState::Finish() {
+  if (num_ready_queues_ > 0 && num_step_refs_.fetch_sub(1) != 1) {
+    // Some worker is still running; the last one to exit finishes.
+    return;
+  }
+  ReportStepMetrics();
   mu_.lock();
   auto status = status_;
   auto done_cb = std::move(done_cb_);
@@ -2230,7 +2752,12 @@ void ExecutorState::Finish() {
     // the user until the step (and its side-effects) has actually completed.
     status = impl_->params_.device->Sync();
   }
+  StepMemoryPlanner* memory_planner = impl_->memory_planner_;
   delete this;
+  // Learn from the step only once all of its state has been released.
+  if (memory_planner != nullptr && status.ok()) {
+    memory_planner->StepDone();
+  }
   CHECK(done_cb != nullptr);
   runner([=]() { done_cb(status); });
 }
@@ -2462,6 +2989,88 @@ void ExecutorState::FrameState::ActivateNodes(const NodeItem* item,
   }
 }
 
+void ExecutorState::ActivateNodesStatic(const NodeItem* item,
+                                        const bool is_dead,
+                                        EntryVector* outputs,
+                                        TaggedNodeSeq* ready) {
+  const GraphView& gview = impl_->gview_;
+  const size_t num_output_edges = item->num_output_edges;
+  const EdgeInfo* edges = item->output_edge_list();
+  for (size_t out_index = 0; out_index < num_output_edges; out_index++) {
+    const EdgeInfo& e = edges[out_index];
+    const int dst_id = e.dst_id;
+    const NodeItem* dst_item = gview.node(dst_id);
+    const int src_slot = e.output_slot;
+
+    if (dst_item->is_sink) continue;
+
+    const bool is_control_edge = (src_slot == Graph::kControlSlot);
+    std::atomic<int32>* pending = &static_pending_[dst_id];
+    if (dst_item->is_merge) {
+      // Mirrors the merge case of FrameState::ActivateNodes().
+      bool dst_ready = false;
+      bool dst_dead = false;
+      if (is_control_edge) {
+        const int32 state = pending->fetch_sub(2) - 2;
+        const int32 count = state & ExecutorImpl::kStaticMergePendingMask;
+        dst_dead = (state >> ExecutorImpl::kStaticMergeDeadShift) ==
+                   dst_item->num_inputs;
+        dst_ready = (count == 0) || ((count == 1) && dst_dead);
+      } else if ((*outputs)[src_slot].has_value) {
+        // Claim the input before writing it, and clear the live bit only
+        // after, so that the merge cannot start before its value is in
+        // place. Later live inputs are dropped.
+        if ((pending->fetch_or(ExecutorImpl::kStaticMergeClaimBit) &
+             ExecutorImpl::kStaticMergeClaimBit) == 0) {
+          const int dst_loc = dst_item->input_start + e.input_slot;
+          if (e.is_last) {
+            static_input_tensors_[dst_loc] = std::move((*outputs)[src_slot]);
+          } else {
+            static_input_tensors_[dst_loc] = (*outputs)[src_slot];
+          }
+          dst_ready = (pending->fetch_sub(1) &
+                       ExecutorImpl::kStaticMergePendingMask) == 1;
+        }
+      } else {
+        const int32 state =
+            pending->fetch_add(1 << ExecutorImpl::kStaticMergeDeadShift) +
+            (1 << ExecutorImpl::kStaticMergeDeadShift);
+        dst_dead = (state >> ExecutorImpl::kStaticMergeDeadShift) ==
+                   dst_item->num_inputs;
+        dst_ready =
+            ((state & ExecutorImpl::kStaticMergePendingMask) == 1) && dst_dead;
+      }
+      if (dst_ready) {
+        ready->push_back(TaggedNode(dst_item->node, nullptr, 0, dst_dead));
+      }
+      continue;
+    }
+
+    if (!is_control_edge) {
+      // The input must be in place before the pending count is decremented,
+      // since whoever brings the count to zero runs dst right away.
+      const int dst_loc = dst_item->input_start + e.input_slot;
+      if (e.is_last) {
+        static_input_tensors_[dst_loc] = std::move((*outputs)[src_slot]);
+      } else {
+        static_input_tensors_[dst_loc] = (*outputs)[src_slot];
+      }
+    }
+
+    const bool increment_dead =
+        (is_dead || (!is_control_edge && !(*outputs)[src_slot].has_value));
+    if (increment_dead) {
+      pending->fetch_or(kStaticDeadBit);
+    }
+    const int32 count = pending->fetch_sub(1) - 1;
+    if ((count & ~kStaticDeadBit) == 0) {
+      const bool dst_dead =
+          (count & kStaticDeadBit) != 0 && !dst_item->is_control_trigger;
+      ready->push_back(TaggedNode(dst_item->node, nullptr, 0, dst_dead));
+    }
+  }
+}
+
 void ExecutorState::FrameState::ActivateNexts(const GraphView* gview,
                                               int64 iter,
                                               TaggedNodeSeq* ready) {
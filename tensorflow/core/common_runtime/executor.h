@@ -141,6 +141,19 @@ struct LocalExecutorParams {
   std::function<void(OpKernel*)> delete_kernel;
 
   Executor::Args::NodeOutputsCallback node_outputs_cb;
+
+  // If positive, each step keeps this many per-worker ready queues and
+  // dispatches at most this many concurrent worker closures to the
+  // runner. Workers execute newly ready nodes from their own queue and
+  // steal from sibling queues when idle, instead of scheduling every
+  // expensive node as a separate closure. If zero, every expensive ready
+  // node is handed to the runner individually.
+  int num_ready_queues = 0;
+
+  // If true, the allocations with default attributes made during the
+  // first successful step are recorded, and later steps are served from a
+  // single slab laid out from that record. See StepMemoryPlanner.
+  bool plan_step_memory = false;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       const Graph* graph, Executor** executor);
@@ -0,0 +1,199 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks of the per-node overhead of the runtime. Every benchmark
+// runs nodes that do next to no work and reports the number of nodes it ran
+// as items, so 1000 / (M items/s) is the overhead per node in nanoseconds.
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+namespace f = test::function;
+
+// A chain of "depth" NoOps, each waiting for the previous one.
+Graph* NoOpChain(int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* last = test::graph::NoOp(g, {});
+  for (int i = 1; i < depth; ++i) {
+    last = test::graph::NoOp(g, {last});
+  }
+  return g;
+}
+
+void BM_NoOpChain(int iters, int depth) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * depth);
+  test::Benchmark("cpu", NoOpChain(depth)).Run(iters);
+}
+BENCHMARK(BM_NoOpChain)->Arg(16)->Arg(256)->Arg(4096);
+
+// One NoOp fanning out to "width" NoOps, which all fan in to a last NoOp.
+Graph* FanOutFanIn(int width) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* source = test::graph::NoOp(g, {});
+  std::vector<Node*> middle;
+  for (int i = 0; i < width; ++i) {
+    middle.push_back(test::graph::NoOp(g, {source}));
+  }
+  test::graph::NoOp(g, middle);
+  return g;
+}
+
+void BM_FanOutFanIn(int iters, int width) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * (width + 2));
+  test::Benchmark("cpu", FanOutFanIn(width)).Run(iters);
+}
+BENCHMARK(BM_FanOutFanIn)->Arg(16)->Arg(256)->Arg(4096);
+
+// The nodes run by every iteration of the loop built by WhileLoop: Merge,
+// the limit, Less, LoopCond, Switch, Identity, the increment, Add and
+// NextIteration.
+const int kNodesPerLoopIteration = 9;
+
+// A while loop that counts from 0 to "num_iterations" in type T.
+template <typename T>
+Graph* WhileLoop(int num_iterations) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* enter = test::graph::Enter(
+      g, test::graph::Constant(g, test::AsScalar<T>(0)), "loop");
+  Node* merge = test::graph::Merge(g, enter, {"next_iteration"});
+  Node* limit = test::graph::Constant(
+      g, test::AsScalar<T>(static_cast<T>(num_iterations)));
+  g->AddControlEdge(merge, limit);
+  Node* cond = test::graph::LoopCond(g, test::graph::Less(g, merge, limit));
+  Node* switch_node = test::graph::Switch(g, merge, cond);
+  Node* body = test::graph::Identity(g, switch_node, 1);
+  Node* one = test::graph::Constant(g, test::AsScalar<T>(1));
+  g->AddControlEdge(body, one);
+  Node* next = test::graph::Next(g, "next_iteration",
+                                 test::graph::Add(g, body, one));
+  g->AddEdge(next, 0, merge, 1);
+  test::graph::Exit(g, switch_node);
+  return g;
+}
+
+void BM_WhileLoop(int iters, int num_iterations) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_iterations *
+                          kNodesPerLoopIteration);
+  test::Benchmark("cpu", WhileLoop<float>(num_iterations)).Run(iters);
+}
+BENCHMARK(BM_WhileLoop)->Arg(16)->Arg(256)->Arg(4096);
+
+// Runs "def" on a session with two CPU devices and without graph
+// optimizations, so that its nodes run as they are, fetching "fetch". Nodes
+// placed on a GPU run on the CPU if there is none. Reports "num_nodes" items
+// per step.
+void RunSessionBenchmark(int iters, const GraphDef& def, const string& fetch,
+                         int64 num_nodes) {
+  testing::StopTiming();
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  options.config.set_allow_soft_placement(true);
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_CHECK_OK(session->Create(def));
+  std::vector<Tensor> outputs;
+  // The first run creates the executors.
+  TF_CHECK_OK(session->Run({}, {fetch}, {}, &outputs));
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_nodes);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(session->Run({}, {fetch}, {}, &outputs));
+  }
+  testing::StopTiming();
+}
+
+// A chain of "length" Identity nodes, alternately placed on /cpu:0 and
+// /cpu:1 if "cross_device", so that every hop goes through a Send and a Recv.
+// Each hop counts as one item.
+void BM_SendRecvChain(int iters, int cross_device) {
+  const int kLength = 256;
+  std::vector<NodeDef> nodes;
+  nodes.push_back(f::NDef("n0", "Const", {},
+                          {{"value", test::AsScalar<float>(1)},
+                           {"dtype", DT_FLOAT}},
+                          "/cpu:0"));
+  for (int i = 1; i <= kLength; ++i) {
+    const string device = cross_device && i % 2 == 1 ? "/cpu:1" : "/cpu:0";
+    nodes.push_back(f::NDef(strings::StrCat("n", i), "Identity",
+                            {strings::StrCat("n", i - 1)}, {{"T", DT_FLOAT}},
+                            device));
+  }
+  RunSessionBenchmark(iters, f::GDef(nodes), strings::StrCat("n", kLength),
+                      kLength);
+}
+BENCHMARK(BM_SendRecvChain)->Arg(0)->Arg(1);
+
+// A chain of "length" calls to a function of three nodes. Each call counts as
+// one item.
+void BM_FunctionCallChain(int iters, int length) {
+  std::vector<NodeDef> nodes;
+  nodes.push_back(f::NDef(
+      "n0", "Const", {},
+      {{"value", test::AsScalar<float>(1)}, {"dtype", DT_FLOAT}}));
+  for (int i = 1; i <= length; ++i) {
+    nodes.push_back(f::NDef(strings::StrCat("n", i), "XTimesTwo",
+                            {strings::StrCat("n", i - 1)}, {{"T", DT_FLOAT}}));
+  }
+  RunSessionBenchmark(iters, f::GDef(nodes, {f::XTimesTwo()}),
+                      strings::StrCat("n", length), length);
+}
+BENCHMARK(BM_FunctionCallChain)->Arg(16)->Arg(256);
+
+// The loop of WhileLoop<T> placed on /gpu:0. Each iteration counts as one
+// item, so 1000 / (M items/s) is the overhead of an iteration in nanoseconds.
+// With int32, the counter and the predicate are in host memory; with float,
+// the counter stays on the device and is copied to the host every iteration
+// for the comparison.
+template <typename T>
+void WhileLoopOnGpu(int iters, int num_iterations) {
+  std::unique_ptr<Graph> g(WhileLoop<T>(num_iterations));
+  GraphDef def;
+  g->ToGraphDef(&def);
+  string fetch;
+  for (NodeDef& node : *def.mutable_node()) {
+    node.set_device("/gpu:0");
+    if (node.op() == "Exit") fetch = node.name();
+  }
+  RunSessionBenchmark(iters, def, fetch, num_iterations);
+}
+
+void BM_WhileLoopOnGpuInt32(int iters, int num_iterations) {
+  WhileLoopOnGpu<int32>(iters, num_iterations);
+}
+BENCHMARK(BM_WhileLoopOnGpuInt32)->Arg(256)->Arg(4096);
+
+void BM_WhileLoopOnGpuFloat(int iters, int num_iterations) {
+  WhileLoopOnGpu<float>(iters, num_iterations);
+}
+BENCHMARK(BM_WhileLoopOnGpuFloat)->Arg(256)->Arg(4096);
+
+}  // namespace
+}  // namespace tensorflow
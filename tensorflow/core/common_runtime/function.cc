@@ -200,8 +200,13 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
   // object, and an executor is created for the graph.
   struct Item : public core::RefCounted {
     const Graph* graph = nullptr;  // Owned by exec.
+    const FunctionBody* func_graph = nullptr;  // Owned by the runtime.
     Executor* exec = nullptr;
 
+    // Whether the graph has _Send or _Recv nodes. Calls to functions without
+    // them don't need a rendezvous.
+    bool has_send_recv = false;
+
     ~Item() override { delete this->exec; }
   };
   std::vector<Item*> items_;
@@ -478,12 +483,21 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Handle handle, Item** item) {
     DeleteNonCachedKernel(kernel);
   };
   Graph* graph = g.get();
+  bool has_send_recv = false;
+  for (const Node* n : graph->nodes()) {
+    if (n->IsSend() || n->IsRecv()) {
+      has_send_recv = true;
+      break;
+    }
+  }
   Executor* exec;
   TF_RETURN_IF_ERROR(NewLocalExecutor(params, g.release(), &exec));
 
   *item = new Item;
   (*item)->graph = graph;
+  (*item)->func_graph = fbody;
   (*item)->exec = exec;
+  (*item)->has_send_recv = has_send_recv;
   return Status::OK();
 }
 
@@ -522,18 +536,19 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   if (opts.cancellation_manager && opts.cancellation_manager->IsCancelled()) {
     return done(errors::Cancelled(""));
   }
-  const FunctionBody* fbody = GetFunctionBody(handle);
-  FunctionCallFrame* frame =
-      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
-  Status s = frame->SetArgs(args);
+  // The item carries the function body, so that a call takes mu_ only once.
+  Item* item = nullptr;
+  Status s = GetOrCreateItem(handle, &item);
   if (!s.ok()) {
-    delete frame;
     return done(s);
   }
-  Item* item = nullptr;
-  s = GetOrCreateItem(handle, &item);
+  const FunctionBody* fbody = item->func_graph;
+  FunctionCallFrame* frame =
+      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
+  s = frame->SetArgs(args);
   if (!s.ok()) {
     delete frame;
+    item->Unref();
     return done(s);
   }
   DCHECK(opts.runner != nullptr);
@@ -545,9 +560,12 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   exec_args.call_frame = frame;
   exec_args.cancellation_manager = opts.cancellation_manager;
   exec_args.runner = *opts.runner;
-  // TODO(zhifengc): we can avoid creating rendez here if we know
-  // there is no send/recv nodes in the graph.
-  auto* rendez = new IntraProcessRendezvous(device_mgr_);
+  // Without _Send or _Recv nodes nothing uses the rendezvous, and most
+  // functions (e.g. dataset map functions) are called per element.
+  IntraProcessRendezvous* rendez = nullptr;
+  if (item->has_send_recv) {
+    rendez = new IntraProcessRendezvous(device_mgr_);
+  }
   exec_args.rendezvous = rendez;
   item->exec->RunAsync(
       // Executor args
@@ -555,10 +573,12 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
       // Done callback.
       [item, frame, rets, rendez, done](const Status& status) {
         item->Unref();
-        rendez->Unref();
+        if (rendez != nullptr) rendez->Unref();
         Status s = status;
         if (s.ok()) {
-          s = frame->GetRetvals(rets);
+          // The frame is deleted below, so its tensors can be moved out,
+          // which lets consumers forward their buffers.
+          s = frame->ConsumeRetvals(rets);
         }
         delete frame;
         done(s);
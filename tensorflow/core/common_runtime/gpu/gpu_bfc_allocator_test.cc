@@ -265,6 +265,125 @@ TEST(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   b.DeallocateRaw(bmem);
 }
 
+TEST(GPUBFCAllocatorTest, ThreadCache) {
+  GPUBFCAllocator a(0, 1 << 30);
+  a.EnableThreadCache(1);
+
+  // Fill the free batch so the freed chunks land in the cache.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; i++) {
+    ptrs.push_back(a.AllocateRaw(1, 1024));
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+
+  // Same-sized allocations are served from the cache and reuse the chunks.
+  std::vector<void*> reused;
+  for (int i = 0; i < 64; i++) {
+    reused.push_back(a.AllocateRaw(1, 1000));
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  LOG(INFO) << "Alloc stats: \n" << stats.DebugString();
+  EXPECT_EQ(64, stats.num_cache_hits);
+  EXPECT_EQ(128, stats.num_allocs);
+  std::sort(ptrs.begin(), ptrs.end());
+  for (void* p : reused) {
+    EXPECT_TRUE(std::binary_search(ptrs.begin(), ptrs.end(), p));
+    EXPECT_EQ(1024, a.AllocatedSize(p));
+  }
+  for (void* p : reused) {
+    a.DeallocateRaw(p);
+  }
+
+  // A different size misses the cache.
+  void* p = a.AllocateRaw(1, 4096);
+  a.GetStats(&stats);
+  EXPECT_EQ(65, stats.num_cache_misses);
+  a.DeallocateRaw(p);
+}
+
+TEST(GPUBFCAllocatorTest, ThreadCacheReleasedUnderPressure) {
+  GPUBFCAllocator a(0, 1 << 20);
+  a.EnableThreadCache(1);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 512; i++) {
+    ptrs.push_back(a.AllocateRaw(1, 1024));
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+
+  // Only fits once the cached chunks are coalesced back into the bins.
+  void* p = a.AllocateRaw(1, 768 << 10);
+  EXPECT_NE(nullptr, p);
+  a.DeallocateRaw(p);
+}
+
+TEST(GPUBFCAllocatorTest, FragmentationStats) {
+  GPUBFCAllocator a(0, 1 << 30);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; i++) {
+    ptrs.push_back(a.AllocateRaw(1, 1 << 20));
+  }
+  // Leaves 1MiB holes between the live allocations.
+  for (int i = 0; i < 8; i += 2) {
+    a.DeallocateRaw(ptrs[i]);
+  }
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(4 << 20, stats.bytes_in_use);
+  EXPECT_EQ(stats.bytes_reserved - stats.bytes_in_use, stats.bytes_free);
+  // The largest free block is what remains after the last allocation.
+  EXPECT_EQ(stats.bytes_reserved - (8 << 20), stats.largest_free_block_bytes);
+  int64 free_bytes = 0;
+  for (int64 bin_bytes : stats.free_bytes_by_bin) {
+    free_bytes += bin_bytes;
+  }
+  EXPECT_EQ(stats.bytes_free, free_bytes);
+  // The holes are in the bin of 1MiB blocks.
+  EXPECT_EQ(4 << 20, stats.free_bytes_by_bin[12]);
+
+  for (int i = 1; i < 8; i += 2) {
+    a.DeallocateRaw(ptrs[i]);
+  }
+}
+
+TEST(GPUBFCAllocatorTest, ReleaseFreeRegions) {
+  GPUOptions options;
+  options.set_allow_growth(true);
+  GPUBFCAllocator a(0, 1 << 30, options);
+
+  // The first allocation extends the allocator by 1MiB, and the second by
+  // a separate region of 8MiB.
+  void* small = a.AllocateRaw(1, 512 << 10);
+  void* large = a.AllocateRaw(1, 8 << 20);
+  a.DeallocateRaw(large);
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(9 << 20, stats.bytes_reserved);
+
+  // Only the region without an allocation is released.
+  EXPECT_EQ(8 << 20, a.ReleaseFreeRegions());
+  a.GetStats(&stats);
+  EXPECT_EQ(1 << 20, stats.bytes_reserved);
+  EXPECT_EQ(0, a.ReleaseFreeRegions());
+
+  a.DeallocateRaw(small);
+  EXPECT_EQ(1 << 20, a.ReleaseFreeRegions());
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_reserved);
+  EXPECT_EQ(0, stats.bytes_free);
+
+  // The allocator extends itself again as needed.
+  void* p = a.AllocateRaw(1, 4 << 20);
+  EXPECT_NE(nullptr, p);
+  a.DeallocateRaw(p);
+}
+
 static void BM_Allocation(int iters) {
   GPUBFCAllocator a(0, 1uLL << 33);
   // Exercise a few different allocation sizes
@@ -281,8 +400,12 @@ static void BM_Allocation(int iters) {
 }
 BENCHMARK(BM_Allocation);
 
-static void BM_AllocationThreaded(int iters, int num_threads) {
+static void RunAllocationThreaded(int iters, int num_threads,
+                                  int thread_cache_shards) {
   GPUBFCAllocator a(0, 1uLL << 33);
+  if (thread_cache_shards > 0) {
+    a.EnableThreadCache(thread_cache_shards);
+  }
   thread::ThreadPool pool(Env::Default(), "test", num_threads);
   std::atomic_int_fast32_t count(iters);
   mutex done_lock;
@@ -313,8 +436,17 @@ static void BM_AllocationThreaded(int iters, int num_threads) {
     done.wait(l);
   }
 }
+
+static void BM_AllocationThreaded(int iters, int num_threads) {
+  RunAllocationThreaded(iters, num_threads, 0);
+}
 BENCHMARK(BM_AllocationThreaded)->Arg(1)->Arg(4)->Arg(16);
 
+static void BM_AllocationThreadedCache(int iters, int num_threads) {
+  RunAllocationThreaded(iters, num_threads, num_threads);
+}
+BENCHMARK(BM_AllocationThreadedCache)->Arg(1)->Arg(4)->Arg(16);
+
 // A more complex benchmark that defers deallocation of an object for
 // "delay" allocations.
 static void BM_AllocationDelayed(int iters, int delay) {
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_topology.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu/process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
@@ -261,6 +262,13 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   executor_ = executor_status.ValueOrDie();
   em_.reset(new EventMgr(executor_, options.config.gpu_options()));
+  staging_pool_.reset(GPUStagingPool::Create(executor_, em_.get(),
+                                             options.config.gpu_options()));
+  const int32 sample_steps =
+      options.config.gpu_options().device_timing_sample_steps();
+  if (sample_steps > 0) {
+    timing_sampler_.reset(new GPUTimingSampler(em_.get(), sample_steps));
+  }
 
   if (max_streams_ < 1) {
     return errors::InvalidArgument("Invalid value for max_streams.");
@@ -295,10 +303,23 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         i, streams_.back()->compute, streams_.back()->host_to_device,
         streams_.back()->device_to_host, streams_.back()->device_to_device));
   }
+  const int64 scratch_arena_bytes =
+      options.config.gpu_options().scratch_arena_bytes_per_stream();
+  if (scratch_arena_bytes > 0) {
+    std::vector<gpu::Stream*> compute_streams;
+    for (const StreamGroup* group : streams_) {
+      compute_streams.push_back(group->compute);
+    }
+    scratch_arena_.reset(new GPUScratchArena(gpu_allocator_, compute_streams,
+                                             scratch_arena_bytes));
+  }
+
   gpu_device_info_ = new GpuDeviceInfo;
   gpu_device_info_->stream = streams_[0]->compute;
   gpu_device_info_->default_context = device_contexts_[0];
   gpu_device_info_->event_mgr = em_.get();
+  gpu_device_info_->staging_pool = staging_pool_.get();
+  gpu_device_info_->scratch_arena = scratch_arena_.get();
   gpu_device_info_->gpu_id = gpu_id_;
   set_tensorflow_gpu_device_info(gpu_device_info_);
 
@@ -386,49 +407,27 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
   gpu::Stream* stream = gpu_device_context->stream();
   const auto stream_id = gpu_device_context->stream_id();
 
-  const bool vlog_1 = VLOG_IS_ON(1);
-  const bool vlog_2 = vlog_1 && VLOG_IS_ON(2);
-
-  if (vlog_1) {
+  if (VLOG_IS_ON(1)) {
     VLOG(1) << "GpuDevice::Compute " << op_kernel->name() << " op "
             << op_kernel->def().op() << " on GPU" << gpu_id_ << " stream["
             << stream_id << "]";
   }
 
-  const auto num_streams = streams_.size();
-  if (num_streams > 1) {
-    // If this op's device context is different from the other contexts,
-    // we must wait on the stream.
-    for (int i = 0; i < context->num_inputs(); ++i) {
-      const GPUDeviceContext* idc =
-          static_cast<GPUDeviceContext*>(context->input_device_context(i));
-      OP_REQUIRES(context, idc != nullptr,
-                  errors::Internal("Input device context ", i,
-                                   " was not set properly."));
-      if (vlog_2) {
-        const void* base;
-        size_t len;
-        if (context->has_input(i)) {
-          if (IsRefType(context->input_dtype(i))) {
-            Tensor tensor = context->mutable_input(i, false);
-            base = DMAHelper::base(&tensor);
-            len = tensor.TotalBytes();
-          } else {
-            const Tensor& tensor = context->input(i);
-            base = DMAHelper::base(&tensor);
-            len = tensor.TotalBytes();
-          }
-          LOG(INFO) << "Input " << i << " " << base << "  " << len;
-          LOG(INFO) << "  stream[" << stream_id << "].ThenWaitFor(stream["
-                    << idc->stream_id() << "])"
-                    << ((idc->stream() == stream) ? " not needed" : "");
-        }
-      }
-      if (idc->stream() != stream) stream->ThenWaitFor(idc->stream());
-    }
+  if (streams_.size() > 1) {
+    WaitForInputStreams(context, gpu_device_context);
+    if (!context->status().ok()) return;
   }
   gpu::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  gpu::Timer* timer = nullptr;
+  if (timing_sampler_ != nullptr &&
+      timing_sampler_->ShouldSample(context->step_id())) {
+    timer = timing_sampler_->Start(stream);
+  }
   op_kernel->Compute(context);
+  if (timer != nullptr) {
+    timing_sampler_->Stop(stream, timer, op_kernel->name(),
+                          op_kernel->type_string());
+  }
   if (context->status().ok()) {
     if (sync_every_op_) {
       // Note: GPUUtil::Sync() only syncs the default stream.
@@ -440,6 +439,50 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
   }
 }
 
+void BaseGPUDevice::WaitForInputStreams(OpKernelContext* context,
+                                        GPUDeviceContext* gpu_device_context) {
+  gpu::Stream* stream = gpu_device_context->stream();
+  const auto stream_id = gpu_device_context->stream_id();
+  const bool vlog_2 = VLOG_IS_ON(2);
+  // Waits at most once for each of the other streams, since a wait covers
+  // all of the work enqueued on that stream so far.
+  gtl::InlinedVector<gpu::Stream*, 4> waited;
+  // If this op's device context is different from the other contexts,
+  // we must wait on the stream.
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    const GPUDeviceContext* idc =
+        static_cast<GPUDeviceContext*>(context->input_device_context(i));
+    OP_REQUIRES(context, idc != nullptr,
+                errors::Internal("Input device context ", i,
+                                 " was not set properly."));
+    if (vlog_2) {
+      const void* base;
+      size_t len;
+      if (context->has_input(i)) {
+        if (IsRefType(context->input_dtype(i))) {
+          Tensor tensor = context->mutable_input(i, false);
+          base = DMAHelper::base(&tensor);
+          len = tensor.TotalBytes();
+        } else {
+          const Tensor& tensor = context->input(i);
+          base = DMAHelper::base(&tensor);
+          len = tensor.TotalBytes();
+        }
+        LOG(INFO) << "Input " << i << " " << base << "  " << len;
+        LOG(INFO) << "  stream[" << stream_id << "].ThenWaitFor(stream["
+                  << idc->stream_id() << "])"
+                  << ((idc->stream() == stream) ? " not needed" : "");
+      }
+    }
+    if (idc->stream() != stream &&
+        std::find(waited.begin(), waited.end(), idc->stream()) ==
+            waited.end()) {
+      stream->ThenWaitFor(idc->stream());
+      waited.push_back(idc->stream());
+    }
+  }
+}
+
 void BaseGPUDevice::ConsumeListOfAccessedTensors(
     DeviceContext* device_context, const TensorReferenceVector& tensor_refs) {
   GPUDeviceContext* gpu_device_context = device_contexts_[0];
@@ -454,6 +497,16 @@ void BaseGPUDevice::ConsumeListOfAccessedTensors(
 // all streams not just the current one.
 Status BaseGPUDevice::Sync() { return GPUUtil::SyncAll(this); }
 
+void BaseGPUDevice::ReleaseUnusedMemory() {
+  ProcessState::singleton()->ReleaseFreeGPUMemory(gpu_id_);
+}
+
+void BaseGPUDevice::TakeSampledOpTimes(OpTimes* op_times) {
+  if (timing_sampler_ != nullptr) {
+    timing_sampler_->TakeOpTimes(op_times);
+  }
+}
+
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
                                  OpKernelContext* context,
                                  AsyncOpKernel::DoneCallback done) {
@@ -468,6 +521,16 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
           << op_kernel->def().op() << " on GPU" << gpu_id_ << " stream["
           << stream_id << "]";
 
+  if (streams_.size() > 1) {
+    // Asynchronous kernels enqueue their work on the stream of their
+    // context too, so they wait for their inputs in the same way.
+    WaitForInputStreams(context, gpu_device_context);
+    if (!context->status().ok()) {
+      done();
+      return;
+    }
+  }
+
   // When TraceMe profiling is off (which is the default), the
   // following TraceMe constructor is simply a conditional test of
   // false value. Measurements show that its overhead is negligible.
@@ -578,15 +641,16 @@ Status BaseGPUDeviceFactory::CreateDevices(const SessionOptions& options,
   }
   std::vector<int> valid_gpu_ids;
   TF_RETURN_IF_ERROR(GetValidDeviceIds(
-      options.config.gpu_options().visible_device_list(), &valid_gpu_ids));
+      options.config.gpu_options().visible_device_list(),
+      options.config.gpu_options().topology_probe_bytes(), &valid_gpu_ids));
   if (static_cast<size_t>(n) > valid_gpu_ids.size()) {
     n = valid_gpu_ids.size();
   }
   for (int i = 0; i < n; i++) {
     BaseGPUDevice* gpu_device;
-    TF_RETURN_IF_ERROR(CreateGPUDevice(options,
-                                       strings::StrCat(name_prefix, "/gpu:", i),
-                                       valid_gpu_ids[i], &gpu_device));
+    TF_RETURN_IF_ERROR(CreateGPUDevice(
+        options, strings::StrCat(name_prefix, "/gpu:", i), valid_gpu_ids[i],
+        valid_gpu_ids, &gpu_device));
     TF_RETURN_IF_ERROR(gpu_device->Init(options));
     devices->push_back(gpu_device);
   }
@@ -618,9 +682,9 @@ static string GetShortDeviceDescription(int device_id,
                          ", pci bus id: ", desc.pci_bus_id());
 }
 
-Status BaseGPUDeviceFactory::CreateGPUDevice(const SessionOptions& options,
-                                             const string& name, int gpu_id,
-                                             BaseGPUDevice** out_device) {
+Status BaseGPUDeviceFactory::CreateGPUDevice(
+    const SessionOptions& options, const string& name, int gpu_id,
+    const std::vector<int>& valid_gpu_ids, BaseGPUDevice** out_device) {
   CHECK_GE(gpu_id, 0);
 
   // Look up the device, to see its attributes.
@@ -666,6 +730,15 @@ Status BaseGPUDeviceFactory::CreateGPUDevice(const SessionOptions& options,
   // NUMA locales are indexed from 0, buses are indexed from 1.
   DeviceLocality dev_locality;
   dev_locality.set_bus_id(numa_node + 1);
+  for (int i = 0; i < valid_gpu_ids.size(); ++i) {
+    if (valid_gpu_ids[i] == gpu_id) continue;
+    const GPUTopology::Link link =
+        GPUTopology::Global()->GetLink(gpu_id, valid_gpu_ids[i]);
+    InterconnectLink* dev_link = dev_locality.mutable_links()->add_link();
+    dev_link->set_device_id(i);
+    dev_link->set_type(link.peer_access ? "peer" : "host");
+    dev_link->set_bandwidth(link.bandwidth);
+  }
   VLOG(1) << "GPUDevice id " << gpu_id << " on bus " << dev_locality.bus_id()
           << " numa: " << numa_node << " pci: " << desc.pci_bus_id();
 
@@ -675,7 +748,7 @@ Status BaseGPUDeviceFactory::CreateGPUDevice(const SessionOptions& options,
       GetShortDeviceDescription(gpu_id, desc),
       process_state->GetGPUAllocator(options.config.gpu_options(), gpu_id,
                                      allocated_memory),
-      process_state->GetCPUAllocator(numa_node));
+      process_state->GetCPUAllocator(options.config.gpu_options(), numa_node));
 
   return Status::OK();
 }
@@ -848,7 +921,8 @@ Status EnablePeerAccess(gpu::Platform* platform,
 }  // namespace
 
 Status BaseGPUDeviceFactory::GetValidDeviceIds(
-    const string& visible_device_list, std::vector<int>* ids) {
+    const string& visible_device_list, int64 topology_probe_bytes,
+    std::vector<int>* ids) {
   TF_RETURN_IF_ERROR(ValidateGPUMachineManager());
 
   gpu::Platform* gpu_manager = GPUMachineManager();
@@ -948,6 +1022,8 @@ Status BaseGPUDeviceFactory::GetValidDeviceIds(
   if (new_gpu_found) {
     // Enable peer access
     TF_RETURN_IF_ERROR(EnablePeerAccess(gpu_manager, visible_gpu_order));
+    TF_RETURN_IF_ERROR(GPUTopology::Global()->Discover(
+        gpu_manager, visible_gpu_order, topology_probe_bytes));
 
     // Print out a matrix showing which devices can DMA to one
     // another.
@@ -28,6 +28,9 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_scratch_arena.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_timing_sampler.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -71,6 +74,11 @@ class BaseGPUDevice : public LocalDevice {
 
   Status Sync() override;
 
+  // Releases the regions of the GPU allocator that hold no tensor.
+  void ReleaseUnusedMemory() override;
+
+  void TakeSampledOpTimes(OpTimes* op_times) override;
+
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -115,12 +123,23 @@ class BaseGPUDevice : public LocalDevice {
   int gpu_id_ = -1;
   const bool sync_every_op_ = false;
   const int32 max_streams_;
+  // Declared before em_, whose pending callbacks release staging buffers.
+  std::unique_ptr<GPUStagingPool> staging_pool_;
+  // Also declared before em_, whose pending callbacks record the times.
+  std::unique_ptr<GPUTimingSampler> timing_sampler_;
   std::unique_ptr<EventMgr> em_;
+  std::unique_ptr<GPUScratchArena> scratch_arena_;
 
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
   void ComputeHelper(OpKernel* op_kernel, OpKernelContext* context);
+
+  // Makes the stream of "gpu_device_context" wait for the streams on which
+  // the inputs of "context" were produced. Sets the status of "context" on
+  // error.
+  void WaitForInputStreams(OpKernelContext* context,
+                           GPUDeviceContext* gpu_device_context);
 };
 
 class BaseGPUDeviceFactory : public DeviceFactory {
@@ -129,8 +148,11 @@ class BaseGPUDeviceFactory : public DeviceFactory {
                        std::vector<Device*>* devices) override;
 
  private:
+  // "valid_gpu_ids" are the GPUs of all the devices of the task, in the
+  // order of their device ids.
   Status CreateGPUDevice(const SessionOptions& options, const string& name,
-                         int gpu_id, BaseGPUDevice** out_device);
+                         int gpu_id, const std::vector<int>& valid_gpu_ids,
+                         BaseGPUDevice** out_device);
 
   virtual BaseGPUDevice* CreateGPUDevice(const SessionOptions& options,
                                          const string& name, Bytes memory_limit,
@@ -143,9 +165,11 @@ class BaseGPUDeviceFactory : public DeviceFactory {
   // Returns into 'ids' the list of valid GPU ids, in the order that
   // they should map to logical gpu ids "/gpu:0", "/gpu:1", etc, based
   // upon 'visible_device_list', a comma-separated list of 'visible
-  // gpu ids'.
+  // gpu ids'. The first call that finds new GPUs also discovers their
+  // topology, measuring it with copies of "topology_probe_bytes" if
+  // positive.
   Status GetValidDeviceIds(const string& visible_device_list,
-                           std::vector<int>* ids);
+                           int64 topology_probe_bytes, std::vector<int>* ids);
 
   // visible_gpu_initialized_[gpu_id] is true if visible GPU gpu_id
   // has been initialized by the process.
@@ -23,6 +23,16 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+int32 NumComputeStreams(const SessionOptions& options) {
+  const int32 num_streams =
+      options.config.gpu_options().num_compute_streams();
+  return num_streams == 0 ? 1 : num_streams;
+}
+
+}  // namespace
+
 class GPUDevice : public BaseGPUDevice {
  public:
   GPUDevice(const SessionOptions& options, const string& name,
@@ -31,7 +41,7 @@ class GPUDevice : public BaseGPUDevice {
             Allocator* cpu_allocator)
       : BaseGPUDevice(options, name, memory_limit, locality, gpu_id,
                       physical_device_desc, gpu_allocator, cpu_allocator,
-                      false /* sync every op */, 1 /* max_streams */) {
+                      false /* sync every op */, NumComputeStreams(options)) {
     if (options.config.has_gpu_options()) {
       force_gpu_compatible_ =
           options.config.gpu_options().force_gpu_compatible();
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
@@ -34,17 +36,29 @@ EventMgr::EventMgr(gpu::StreamExecutor* se, const GPUOptions& gpu_options)
           gpu_options.polling_inactive_delay_msecs()
               ? gpu_options.polling_inactive_delay_msecs()
               : 1),
+      spin_polling_(gpu_options.event_polling() == GPUOptions::SPIN),
+      use_host_callbacks_(gpu_options.event_polling() ==
+                          GPUOptions::HOST_CALLBACK),
       accumulated_stream_(nullptr),
       accumulated_tensors_(new TensorReferenceVector),
       accumulated_tensor_bytes_(0),
       // threadpool_ has 1 thread for the polling loop, and one to execute
       // event callback functions. Maybe we should have more?
       threadpool_(Env::Default(), "GPU_Event_Manager", 2) {
-  StartPollingLoop();
+  if (!use_host_callbacks_) {
+    StartPollingLoop();
+  }
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    // The callbacks refer to this object.
+    mutex_lock l(mu_);
+    while (num_pending_callbacks_ > 0) {
+      callbacks_done_.wait(l);
+    }
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -127,14 +141,21 @@ void EventMgr::FlushAccumulatedTensors() {
 // contention, which argue for longer delay.  The current strategy is
 // to poll frequently when the queue is non-empty, and infrequently
 // otherwise.
+//
+// With spin_polling_, the loop does not sleep between polls as long as
+// they retire events, and after kSpinPolls polls that retire nothing it
+// sleeps for exponentially longer, up to polling_active_delay_usecs_.
 void EventMgr::PollLoop() {
+  const int kSpinPolls = 100;
   bool queue_empty = false;
+  int idle_polls = 0;
+  int32 delay_usecs = spin_polling_ ? 0 : polling_active_delay_usecs_;
   while (!stop_polling_->HasBeenNotified()) {
     if (queue_empty) {
       mutex_lock l(mu_);
       WaitForMilliseconds(&l, &events_pending_, polling_inactive_delay_msecs_);
-    } else {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+    } else if (delay_usecs > 0) {
+      Env::Default()->SleepForMicroseconds(delay_usecs);
     }
     ToFreeVector to_free;
     {
@@ -142,6 +163,15 @@ void EventMgr::PollLoop() {
       PollEvents(true, &to_free);
       queue_empty = used_events_.empty();
     }
+    if (spin_polling_) {
+      if (!to_free.empty() || queue_empty) {
+        idle_polls = 0;
+        delay_usecs = 0;
+      } else if (++idle_polls > kSpinPolls) {
+        delay_usecs =
+            std::min(std::max(1, 2 * delay_usecs), polling_active_delay_usecs_);
+      }
+    }
     FreeMemory(to_free);
   }
   polling_stopped_->Notify();
@@ -150,6 +180,20 @@ void EventMgr::PollLoop() {
 void EventMgr::QueueInUse(gpu::Stream* stream, InUse iu) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
+  if (use_host_callbacks_) {
+    // The callback runs on a driver thread, which must not call into the
+    // driver, and blocks the stream until it returns, so it only hands "iu"
+    // over to the threadpool.
+    ++num_pending_callbacks_;
+    stream->ThenDoHostCallback([this, iu]() {
+      threadpool_.Schedule([this, iu]() { RetireAfterCallback(iu); });
+    });
+    if (!stream->ok()) {
+      // We don't expect to see this, as with events in an error state.
+      LOG(FATAL) << "Failed to enqueue a host callback";
+    }
+    return;
+  }
   // Events are created on demand, and repeatedly reused.  There is no
   // limit placed here on the number of allocated Events.
   if (free_events_.empty()) {
@@ -166,6 +210,16 @@ void EventMgr::QueueInUse(gpu::Stream* stream, InUse iu) {
   if (was_empty) events_pending_.notify_all();
 }
 
+void EventMgr::RetireAfterCallback(const InUse& iu) {
+  ReleaseMemory(iu);
+  // This already runs in the threadpool.
+  if (iu.func != nullptr) iu.func();
+  mutex_lock l(mu_);
+  if (--num_pending_callbacks_ == 0) {
+    callbacks_done_.notify_all();
+  }
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
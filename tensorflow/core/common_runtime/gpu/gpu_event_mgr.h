@@ -95,8 +95,14 @@ class EventMgr {
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
   const int32 polling_inactive_delay_msecs_;
+  // See GPUOptions::EventPolling.
+  const bool spin_polling_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
+  // The number of host callbacks that have not run yet.
+  int64 num_pending_callbacks_ GUARDED_BY(mu_) = 0;
+  condition_variable callbacks_done_;
 
   void FlushAccumulatedTensors() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -109,27 +115,35 @@ class EventMgr {
 
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
 
-  void FreeMemory(const ToFreeVector& to_free) {
-    for (const auto& iu : to_free) {
-      if (iu.mem != nullptr) {
-        for (auto& t : *(iu.mem)) {
-          t.Unref();
-        }
-        delete iu.mem;
+  // Releases the tensors and the buffer of "iu".
+  static void ReleaseMemory(const InUse& iu) {
+    if (iu.mem != nullptr) {
+      for (auto& t : *(iu.mem)) {
+        t.Unref();
       }
-      if (iu.bufrec.buf) {
-        if (LogMemory::IsEnabled()) {
-          LogMemory::RecordRawDeallocation(iu.bufrec.operation,
-                                           iu.bufrec.step_id, iu.bufrec.buf,
-                                           iu.bufrec.alloc, false);
-        }
-        iu.bufrec.alloc->DeallocateRaw(iu.bufrec.buf);
+      delete iu.mem;
+    }
+    if (iu.bufrec.buf) {
+      if (LogMemory::IsEnabled()) {
+        LogMemory::RecordRawDeallocation(iu.bufrec.operation,
+                                         iu.bufrec.step_id, iu.bufrec.buf,
+                                         iu.bufrec.alloc, false);
       }
+      iu.bufrec.alloc->DeallocateRaw(iu.bufrec.buf);
+    }
+  }
+
+  void FreeMemory(const ToFreeVector& to_free) {
+    for (const auto& iu : to_free) {
+      ReleaseMemory(iu);
       // The function must be called in another thread.
       if (iu.func != nullptr) threadpool_.Schedule(iu.func);
     }
   }
 
+  // Retires "iu" when its host callback has run.
+  void RetireAfterCallback(const InUse& iu);
+
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
   // records.
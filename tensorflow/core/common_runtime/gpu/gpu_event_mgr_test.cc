@@ -246,6 +246,53 @@ TEST(EventMgr, NonEmptyShutdown) {
   }
 }
 
+// Waits up to 10 seconds for all of the test tensors to be freed.
+static bool WaitForTensorsFreed() {
+  for (int i = 0; i < 10000 && live_tensor_bytes > 0; ++i) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  return live_tensor_bytes == 0;
+}
+
+// Checks that the tensors and the functions queued on "em" are retired
+// without calling PollEvents() directly.
+static void TestRetiresWithoutPolling(EventMgr* em) {
+  EXPECT_EQ(0, live_tensor_bytes);
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  CHECK(stream.get());
+  stream->Init();
+  for (int i = 0; i < 5; ++i) {
+    TensorReferenceVector v;
+    AddTensorReference(&v, 100 * 1048576);
+    em->ThenDeleteTensors(stream.get(), v);
+    Notification n;
+    em->ThenExecute(stream.get(), [&n]() { n.Notify(); });
+    n.WaitForNotification();
+    EXPECT_TRUE(WaitForTensorsFreed());
+  }
+}
+
+TEST(EventMgr, SpinPolling) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.set_event_polling(GPUOptions::SPIN);
+  EventMgr em(stream_exec, gpu_options);
+  TestRetiresWithoutPolling(&em);
+}
+
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.set_event_polling(GPUOptions::HOST_CALLBACK);
+  EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  TestRetiresWithoutPolling(&em);
+  // No events are used.
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -0,0 +1,156 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+GPUManagedFallbackAllocator::GPUManagedFallbackAllocator(
+    VisitableAllocator* allocator, int device_id)
+    : base_allocator_(allocator), num_managed_allocs_(0) {
+  stream_exec_ = GPUMachineManager()->ExecutorForDevice(device_id).ValueOrDie();
+}
+
+GPUManagedFallbackAllocator::~GPUManagedFallbackAllocator() {
+  {
+    mutex_lock l(mu_);
+    for (const auto& it : managed_sizes_) {
+      stream_exec_->UnifiedMemoryDeallocate(it.first);
+    }
+  }
+  delete base_allocator_;
+}
+
+void* GPUManagedFallbackAllocator::AllocateRaw(size_t alignment,
+                                               size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* GPUManagedFallbackAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (allocation_attr.no_retry_on_failure) {
+    return base_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  // Spill at once rather than wait for the device memory to be freed.
+  AllocationAttributes no_retry = allocation_attr;
+  no_retry.no_retry_on_failure = true;
+  void* ptr = base_allocator_->AllocateRaw(alignment, num_bytes, no_retry);
+  if (ptr != nullptr || num_bytes == 0) {
+    return ptr;
+  }
+
+  ptr = stream_exec_->UnifiedMemoryAllocate(num_bytes);
+  if (ptr == nullptr) {
+    // Unified memory is exhausted too: fail as the GPU allocator would.
+    return base_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  mutex_lock l(mu_);
+  if (!logged_fallback_) {
+    LOG(WARNING) << "GPU memory exhausted: serving the allocation of "
+                 << strings::HumanReadableNumBytes(num_bytes)
+                 << ", and the later ones that do not fit on the device, "
+                 << "from unified memory, which may be paged to the host";
+    logged_fallback_ = true;
+  }
+  managed_sizes_[ptr] = num_bytes;
+  managed_bytes_in_use_ += num_bytes;
+  max_managed_bytes_in_use_ =
+      std::max(max_managed_bytes_in_use_, managed_bytes_in_use_);
+  ++num_managed_allocs_total_;
+  num_managed_allocs_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+bool GPUManagedFallbackAllocator::IsManaged(void* ptr, size_t* num_bytes) {
+  if (num_managed_allocs_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  mutex_lock l(mu_);
+  auto it = managed_sizes_.find(ptr);
+  if (it == managed_sizes_.end()) {
+    return false;
+  }
+  *num_bytes = it->second;
+  return true;
+}
+
+void GPUManagedFallbackAllocator::DeallocateRaw(void* ptr) {
+  bool managed = false;
+  if (num_managed_allocs_.load(std::memory_order_relaxed) > 0) {
+    mutex_lock l(mu_);
+    auto it = managed_sizes_.find(ptr);
+    if (it != managed_sizes_.end()) {
+      managed_bytes_in_use_ -= it->second;
+      managed_sizes_.erase(it);
+      num_managed_allocs_.fetch_sub(1, std::memory_order_relaxed);
+      managed = true;
+    }
+  }
+  if (managed) {
+    // Outside of mu_, since freeing waits for the device.
+    stream_exec_->UnifiedMemoryDeallocate(ptr);
+  } else {
+    base_allocator_->DeallocateRaw(ptr);
+  }
+}
+
+void GPUManagedFallbackAllocator::AddAllocVisitor(Visitor visitor) {
+  return base_allocator_->AddAllocVisitor(visitor);
+}
+
+void GPUManagedFallbackAllocator::AddFreeVisitor(Visitor visitor) {
+  return base_allocator_->AddFreeVisitor(visitor);
+}
+
+bool GPUManagedFallbackAllocator::TracksAllocationSizes() {
+  return base_allocator_->TracksAllocationSizes();
+}
+
+size_t GPUManagedFallbackAllocator::RequestedSize(void* ptr) {
+  size_t num_bytes;
+  if (IsManaged(ptr, &num_bytes)) return num_bytes;
+  return base_allocator_->RequestedSize(ptr);
+}
+
+size_t GPUManagedFallbackAllocator::AllocatedSize(void* ptr) {
+  size_t num_bytes;
+  if (IsManaged(ptr, &num_bytes)) return num_bytes;
+  return base_allocator_->AllocatedSize(ptr);
+}
+
+int64 GPUManagedFallbackAllocator::AllocationId(void* ptr) {
+  size_t num_bytes;
+  if (IsManaged(ptr, &num_bytes)) return 0;
+  return base_allocator_->AllocationId(ptr);
+}
+
+void GPUManagedFallbackAllocator::GetStats(AllocatorStats* stats) {
+  base_allocator_->GetStats(stats);
+  mutex_lock l(mu_);
+  stats->managed_bytes_in_use = managed_bytes_in_use_;
+  stats->max_managed_bytes_in_use = max_managed_bytes_in_use_;
+  stats->num_managed_allocs = num_managed_allocs_total_;
+  stats->bytes_in_use += managed_bytes_in_use_;
+  stats->num_allocs += num_managed_allocs_total_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
+#define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/visitable_allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that wraps a GPU allocator, and serves the allocations
+// that the GPU allocator cannot satisfy from CUDA unified memory.
+//
+// Unified memory is not limited by the memory of the device: the driver
+// migrates its pages between the host and the device on access, so a
+// model slightly larger than the device still runs, at the cost of the
+// page faults. The allocations are advised to live on the device, so the
+// driver keeps the pages that are used on the device.
+//
+// Allocations that are allowed to fail (no_retry_on_failure) are never
+// served from unified memory.
+class GPUManagedFallbackAllocator : public VisitableAllocator {
+ public:
+  // Takes ownership of "allocator".
+  GPUManagedFallbackAllocator(VisitableAllocator* allocator, int device_id);
+  ~GPUManagedFallbackAllocator() override;
+
+  string Name() override { return base_allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  void AddAllocVisitor(Visitor visitor) override;
+  void AddFreeVisitor(Visitor visitor) override;
+  bool TracksAllocationSizes() override;
+  size_t RequestedSize(void* ptr) override;
+  size_t AllocatedSize(void* ptr) override;
+  int64 AllocationId(void* ptr) override;
+  void GetStats(AllocatorStats* stats) override;
+
+ private:
+  // Returns true, and sets "*num_bytes", if "ptr" is in unified memory.
+  bool IsManaged(void* ptr, size_t* num_bytes);
+
+  VisitableAllocator* base_allocator_;  // owned
+
+  perftools::gputools::StreamExecutor* stream_exec_;  // not owned
+
+  // The number of live allocations in unified memory, read without
+  // the lock so that frees pay nothing while there are none.
+  std::atomic<int64> num_managed_allocs_;
+
+  mutex mu_;
+  std::unordered_map<void*, size_t> managed_sizes_ GUARDED_BY(mu_);
+  int64 managed_bytes_in_use_ GUARDED_BY(mu_) = 0;
+  int64 max_managed_bytes_in_use_ GUARDED_BY(mu_) = 0;
+  int64 num_managed_allocs_total_ GUARDED_BY(mu_) = 0;
+  bool logged_fallback_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUManagedFallbackAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
@@ -0,0 +1,92 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+namespace {
+
+TEST(GPUManagedFallbackAllocatorTest, FitsOnDevice) {
+  GPUManagedFallbackAllocator a(new GPUBFCAllocator(0, 1 << 20), 0);
+  void* p = a.AllocateRaw(1, 1024);
+  EXPECT_NE(nullptr, p);
+  EXPECT_EQ(1024, a.RequestedSize(p));
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.managed_bytes_in_use);
+  EXPECT_EQ(0, stats.num_managed_allocs);
+  a.DeallocateRaw(p);
+}
+
+TEST(GPUManagedFallbackAllocatorTest, SpillsToUnifiedMemory) {
+  GPUManagedFallbackAllocator a(new GPUBFCAllocator(0, 1 << 20), 0);
+  void* on_device = a.AllocateRaw(1, 512 << 10);
+  EXPECT_NE(nullptr, on_device);
+  // Larger than the device pool.
+  void* spilled = a.AllocateRaw(1, 4 << 20);
+  ASSERT_NE(nullptr, spilled);
+  EXPECT_EQ(4 << 20, a.RequestedSize(spilled));
+  EXPECT_EQ(4 << 20, a.AllocatedSize(spilled));
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(4 << 20, stats.managed_bytes_in_use);
+  EXPECT_EQ(1, stats.num_managed_allocs);
+  EXPECT_EQ((512 << 10) + (4 << 20), stats.bytes_in_use);
+
+  // The spilled memory is usable by the device.
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  gpu::DeviceMemoryBase mem(spilled, 4 << 20);
+  std::vector<char> host(4 << 20, 7);
+  ASSERT_TRUE(stream_exec->SynchronousMemcpy(&mem, host.data(), host.size()));
+  std::vector<char> back(host.size(), 0);
+  ASSERT_TRUE(stream_exec->SynchronousMemcpy(back.data(), mem, back.size()));
+  EXPECT_EQ(host, back);
+
+  a.DeallocateRaw(spilled);
+  a.DeallocateRaw(on_device);
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.managed_bytes_in_use);
+  EXPECT_EQ(4 << 20, stats.max_managed_bytes_in_use);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(GPUManagedFallbackAllocatorTest, OptionalAllocationsDoNotSpill) {
+  GPUManagedFallbackAllocator a(new GPUBFCAllocator(0, 1 << 20), 0);
+  AllocationAttributes attr;
+  attr.no_retry_on_failure = true;
+  EXPECT_EQ(nullptr, a.AllocateRaw(1, 4 << 20, attr));
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.num_managed_allocs);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
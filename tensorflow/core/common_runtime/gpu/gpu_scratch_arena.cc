@@ -0,0 +1,87 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_scratch_arena.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+
+GPUScratchArena::GPUScratchArena(Allocator* allocator,
+                                 const std::vector<gpu::Stream*>& streams,
+                                 int64 bytes_per_stream)
+    : allocator_(allocator), bytes_per_stream_(bytes_per_stream) {
+  CHECK_GT(bytes_per_stream_, 0);
+  for (gpu::Stream* stream : streams) {
+    void* base = allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                         bytes_per_stream_);
+    if (base == nullptr) {
+      LOG(WARNING) << "GPUScratchArena: Failed to reserve "
+                   << bytes_per_stream_ << " bytes for a stream, its kernels "
+                   << "will allocate their scratch space from "
+                   << allocator_->Name();
+      continue;
+    }
+    StreamRegion* region = new StreamRegion;
+    region->stream = stream;
+    region->base = static_cast<char*>(base);
+    region->size = bytes_per_stream_;
+    regions_.emplace_back(region);
+  }
+}
+
+GPUScratchArena::~GPUScratchArena() {
+  for (const auto& region : regions_) {
+    CHECK(!region->in_use.load()) << "Destroying an arena in use";
+    allocator_->DeallocateRaw(region->base);
+  }
+}
+
+ScratchArena::Region* GPUScratchArena::TryAcquire(gpu::Stream* stream) {
+  for (const auto& region : regions_) {
+    if (region->stream != stream) continue;
+    if (region->in_use.exchange(true, std::memory_order_acquire)) {
+      return nullptr;
+    }
+    region->offset = 0;
+    return region.get();
+  }
+  return nullptr;
+}
+
+bool GPUScratchArena::Allocate(Region* stream_region, int64 num_bytes,
+                               void** ptr) {
+  StreamRegion* region = static_cast<StreamRegion*>(stream_region);
+  DCHECK(region->in_use.load());
+  // Keeps every allocation aligned like those of the allocators.
+  const int64 alignment = Allocator::kAllocatorAlignment;
+  const int64 aligned_bytes = (num_bytes + alignment - 1) & ~(alignment - 1);
+  if (num_bytes < 0 || aligned_bytes > region->size - region->offset) {
+    return false;
+  }
+  *ptr = region->base + region->offset;
+  region->offset += aligned_bytes;
+  return true;
+}
+
+void GPUScratchArena::Release(Region* stream_region) {
+  StreamRegion* region = static_cast<StreamRegion*>(stream_region);
+  DCHECK(region->in_use.load());
+  region->in_use.store(false, std::memory_order_release);
+}
+
+}  // namespace tensorflow
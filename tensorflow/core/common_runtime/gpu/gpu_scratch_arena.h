@@ -0,0 +1,76 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_SCRATCH_ARENA_H_
+#define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_SCRATCH_ARENA_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A GPUScratchArena reserves one region of device memory per compute
+// stream, out of which the kernels enqueued on that stream carve their
+// temporary workspace (e.g. the cuDNN convolution workspace).
+//
+// An op acquires the region of its stream, allocates from it by bumping
+// an offset, and releases it once it has enqueued the kernels that use
+// the workspace. The next op to acquire the region enqueues its kernels
+// after those on the same stream, so the region can be reused right away
+// without waiting for the stream. Acquiring is a single atomic exchange,
+// and never blocks: when the region is held by another op, or is too
+// small, the caller falls back to its allocator.
+class GPUScratchArena : public ScratchArena {
+ public:
+  // Reserves "bytes_per_stream" bytes from "allocator" for each of
+  // "streams". Neither is owned, and both must outlive the arena. The
+  // streams for which the memory can not be reserved get no region.
+  GPUScratchArena(Allocator* allocator,
+                  const std::vector<perftools::gputools::Stream*>& streams,
+                  int64 bytes_per_stream);
+  ~GPUScratchArena() override;
+
+  int64 bytes_per_stream() const override { return bytes_per_stream_; }
+  Region* TryAcquire(perftools::gputools::Stream* stream) override;
+  bool Allocate(Region* region, int64 num_bytes, void** ptr) override;
+  void Release(Region* region) override;
+
+ private:
+  struct StreamRegion : public Region {
+    perftools::gputools::Stream* stream = nullptr;
+    char* base = nullptr;
+    int64 size = 0;
+    int64 offset = 0;
+    std::atomic<bool> in_use{false};
+  };
+
+  Allocator* const allocator_;  // not owned
+  const int64 bytes_per_stream_;
+  // Only written by the constructor.
+  std::vector<std::unique_ptr<StreamRegion>> regions_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUScratchArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_GPU_GPU_SCRATCH_ARENA_H_
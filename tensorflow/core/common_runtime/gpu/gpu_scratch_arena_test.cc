@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_scratch_arena.h"
+
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+namespace {
+
+class GPUScratchArenaTest : public ::testing::Test {
+ protected:
+  GPUScratchArenaTest()
+      : stream_exec_(GPUMachineManager()->ExecutorForDevice(0).ValueOrDie()),
+        stream0_(stream_exec_),
+        stream1_(stream_exec_) {
+    stream0_.Init();
+    stream1_.Init();
+  }
+
+  // The arena never touches its memory, so it can come from the CPU.
+  Allocator* allocator() { return cpu_allocator(); }
+
+  gpu::StreamExecutor* stream_exec_;
+  gpu::Stream stream0_;
+  gpu::Stream stream1_;
+};
+
+TEST_F(GPUScratchArenaTest, OneRegionPerStream) {
+  GPUScratchArena arena(allocator(), {&stream0_, &stream1_}, 1024);
+  ScratchArena::Region* region0 = arena.TryAcquire(&stream0_);
+  ASSERT_NE(nullptr, region0);
+  ScratchArena::Region* region1 = arena.TryAcquire(&stream1_);
+  ASSERT_NE(nullptr, region1);
+  EXPECT_NE(region0, region1);
+
+  void* ptr0 = nullptr;
+  void* ptr1 = nullptr;
+  EXPECT_TRUE(arena.Allocate(region0, 1024, &ptr0));
+  EXPECT_TRUE(arena.Allocate(region1, 1024, &ptr1));
+  EXPECT_NE(ptr0, ptr1);
+  arena.Release(region0);
+  arena.Release(region1);
+}
+
+TEST_F(GPUScratchArenaTest, RegionIsExclusive) {
+  GPUScratchArena arena(allocator(), {&stream0_}, 1024);
+  ScratchArena::Region* region = arena.TryAcquire(&stream0_);
+  ASSERT_NE(nullptr, region);
+  EXPECT_EQ(nullptr, arena.TryAcquire(&stream0_));
+  arena.Release(region);
+  EXPECT_EQ(region, arena.TryAcquire(&stream0_));
+  arena.Release(region);
+  // No region for streams the arena was not created for.
+  EXPECT_EQ(nullptr, arena.TryAcquire(&stream1_));
+}
+
+TEST_F(GPUScratchArenaTest, BumpAllocation) {
+  GPUScratchArena arena(allocator(), {&stream0_}, 1024);
+  ScratchArena::Region* region = arena.TryAcquire(&stream0_);
+  ASSERT_NE(nullptr, region);
+  void* first = nullptr;
+  void* second = nullptr;
+  void* third = nullptr;
+  EXPECT_TRUE(arena.Allocate(region, 100, &first));
+  EXPECT_TRUE(arena.Allocate(region, 500, &second));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(second) %
+                   Allocator::kAllocatorAlignment);
+  EXPECT_GE(static_cast<char*>(second), static_cast<char*>(first) + 100);
+  EXPECT_FALSE(arena.Allocate(region, 1024, &third));
+  arena.Release(region);
+
+  // The whole region is available again once it is reacquired.
+  region = arena.TryAcquire(&stream0_);
+  ASSERT_NE(nullptr, region);
+  EXPECT_TRUE(arena.Allocate(region, 1024, &third));
+  EXPECT_EQ(first, third);
+  arena.Release(region);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -0,0 +1,188 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+
+namespace {
+
+// Copies smaller than this are left to the driver, which stages them at
+// least as fast as the pool would.
+const int64 kMinStagingBytes = 64 << 10;
+
+const int64 kDefaultChunkBytes = 4 << 20;
+const int kDefaultNumChunks = 4;
+
+}  // namespace
+
+GPUStagingPool::GPUStagingPool(gpu::StreamExecutor* stream_exec, EventMgr* em,
+                               int64 chunk_bytes, int num_chunks)
+    : em_(em),
+      chunk_bytes_(chunk_bytes),
+      num_chunks_(num_chunks),
+      allocator_(new PoolAllocator(num_chunks, false /*auto_resize*/,
+                                   new CUDAHostAllocator(stream_exec),
+                                   new NoopRounder, "gpu_staging")) {
+  CHECK_GT(chunk_bytes_, 0);
+  CHECK_GT(num_chunks_, 0);
+}
+
+GPUStagingPool::~GPUStagingPool() {
+  mutex_lock l(mu_);
+  CHECK_EQ(0, num_in_use_) << "Staging buffers still in use";
+}
+
+bool GPUStagingPool::ShouldStage(int64 num_bytes) const {
+  return num_bytes >= kMinStagingBytes;
+}
+
+void* GPUStagingPool::TryAcquireBuffer() {
+  {
+    mutex_lock l(mu_);
+    ++num_copied_chunks_;
+    if (num_in_use_ == num_chunks_) {
+      return nullptr;
+    }
+    ++num_in_use_;
+    ++num_staged_chunks_;
+  }
+  void* buffer = allocator_->Get(chunk_bytes_);
+  if (buffer == nullptr) {
+    // Out of pinned memory: copy the chunk without staging.
+    mutex_lock l(mu_);
+    --num_in_use_;
+    --num_staged_chunks_;
+  }
+  return buffer;
+}
+
+void GPUStagingPool::ReleaseBuffer(void* buffer) {
+  allocator_->Put(buffer, chunk_bytes_);
+  mutex_lock l(mu_);
+  --num_in_use_;
+}
+
+void GPUStagingPool::CopyToDevice(gpu::Stream* stream, const void* src,
+                                  gpu::DeviceMemoryBase dst, int64 num_bytes,
+                                  std::function<void()> done) {
+  const char* src_base = static_cast<const char*>(src);
+  char* dst_base = static_cast<char*>(dst.opaque());
+  for (int64 offset = 0; offset < num_bytes; offset += chunk_bytes_) {
+    const int64 n = std::min(chunk_bytes_, num_bytes - offset);
+    gpu::DeviceMemoryBase chunk_dst(dst_base + offset, n);
+    void* buffer = TryAcquireBuffer();
+    if (buffer == nullptr) {
+      stream->ThenMemcpy(&chunk_dst, src_base + offset, n);
+      continue;
+    }
+    // The DMA of the previous chunk proceeds while this one is copied.
+    memcpy(buffer, src_base + offset, n);
+    stream->ThenMemcpy(&chunk_dst, buffer, n);
+    em_->ThenExecute(stream, [this, buffer]() { ReleaseBuffer(buffer); });
+  }
+  em_->ThenExecute(stream, std::move(done));
+}
+
+void GPUStagingPool::CopyFromDevice(gpu::Stream* stream,
+                                    const gpu::DeviceMemoryBase& src,
+                                    void* dst, int64 num_bytes,
+                                    std::function<void()> done) {
+  // The staged chunks are copied out of their buffers by callbacks, which
+  // may run in any order, so "done" is called by the last one to finish.
+  struct State {
+    std::atomic<int64> pending{1};
+    std::function<void()> done;
+  };
+  State* state = new State;
+  state->done = std::move(done);
+  auto finish = [state]() {
+    if (state->pending.fetch_sub(1) == 1) {
+      state->done();
+      delete state;
+    }
+  };
+
+  const char* src_base = static_cast<const char*>(src.opaque());
+  char* dst_base = static_cast<char*>(dst);
+  for (int64 offset = 0; offset < num_bytes; offset += chunk_bytes_) {
+    const int64 n = std::min(chunk_bytes_, num_bytes - offset);
+    gpu::DeviceMemoryBase chunk_src(const_cast<char*>(src_base + offset), n);
+    void* buffer = TryAcquireBuffer();
+    if (buffer == nullptr) {
+      stream->ThenMemcpy(dst_base + offset, chunk_src, n);
+      continue;
+    }
+    stream->ThenMemcpy(buffer, chunk_src, n);
+    state->pending.fetch_add(1);
+    char* chunk_dst = dst_base + offset;
+    // The DMA of the next chunk proceeds while this one is copied out.
+    em_->ThenExecute(stream, [this, buffer, chunk_dst, n, finish]() {
+      memcpy(chunk_dst, buffer, n);
+      ReleaseBuffer(buffer);
+      finish();
+    });
+  }
+  em_->ThenExecute(stream, finish);
+}
+
+int GPUStagingPool::NumBuffersInUse() {
+  mutex_lock l(mu_);
+  return num_in_use_;
+}
+
+int64 GPUStagingPool::NumChunks() {
+  mutex_lock l(mu_);
+  return num_copied_chunks_;
+}
+
+int64 GPUStagingPool::NumStagedChunks() {
+  mutex_lock l(mu_);
+  return num_staged_chunks_;
+}
+
+/* static */
+GPUStagingPool* GPUStagingPool::Create(gpu::StreamExecutor* stream_exec,
+                                       EventMgr* em,
+                                       const GPUOptions& options) {
+  int num_chunks = options.staging_num_chunks();
+  if (num_chunks < 0) {
+    return nullptr;
+  }
+  if (num_chunks == 0) {
+    num_chunks = kDefaultNumChunks;
+  }
+  int64 chunk_bytes = options.staging_chunk_bytes();
+  if (chunk_bytes < 0) {
+    LOG(ERROR) << "GPUStagingPool: Invalid staging_chunk_bytes "
+               << chunk_bytes << ", using " << kDefaultChunkBytes;
+  }
+  if (chunk_bytes <= 0) {
+    chunk_bytes = kDefaultChunkBytes;
+  }
+  return new GPUStagingPool(stream_exec, em, chunk_bytes, num_chunks);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,109 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_STAGING_POOL_H_
+#define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_STAGING_POOL_H_
+
+#include <functional>
+#include <memory>
+
+#include "tensorflow/core/common_runtime/gpu/pool_allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class EventMgr;
+class GPUOptions;
+
+// A GPUStagingPool owns a small ring of pinned host buffers, through
+// which tensors in pageable host memory are copied to and from a GPU.
+//
+// A copy from pageable memory is otherwise staged by the driver, which
+// blocks the calling thread and serializes the copies of a device. The
+// pool instead splits a copy into chunks, and copies each chunk between
+// the pageable memory and a staging buffer on the CPU while the DMA of
+// the previous chunk is in flight.
+//
+// The pool never blocks waiting for a free buffer: the chunks for which
+// no buffer is available are copied directly from or to pageable memory.
+class GPUStagingPool {
+ public:
+  // Creates a pool of "num_chunks" buffers of "chunk_bytes" bytes each,
+  // allocated on "stream_exec". The buffers are returned to the pool
+  // through "em". Neither is owned, and both must outlive the pool.
+  GPUStagingPool(perftools::gputools::StreamExecutor* stream_exec,
+                 EventMgr* em, int64 chunk_bytes, int num_chunks);
+  ~GPUStagingPool();
+
+  // Returns true if a copy of "num_bytes" from or to pageable memory
+  // should go through the pool.
+  bool ShouldStage(int64 num_bytes) const;
+
+  // Enqueues on "stream" the copy of the "num_bytes" at "src" in host
+  // memory to "dst". "src" must stay valid until "done" is called, and
+  // "done" is called once all the copies have completed on "stream".
+  void CopyToDevice(perftools::gputools::Stream* stream, const void* src,
+                    perftools::gputools::DeviceMemoryBase dst,
+                    int64 num_bytes, std::function<void()> done);
+
+  // Enqueues on "stream" the copy of the "num_bytes" at "src" in device
+  // memory to "dst" in host memory, and calls "done" once all of "dst"
+  // has been filled in.
+  void CopyFromDevice(perftools::gputools::Stream* stream,
+                      const perftools::gputools::DeviceMemoryBase& src,
+                      void* dst, int64 num_bytes, std::function<void()> done);
+
+  int64 chunk_bytes() const { return chunk_bytes_; }
+  int num_chunks() const { return num_chunks_; }
+
+  // Returns the number of buffers in use by enqueued copies.
+  int NumBuffersInUse();
+
+  // Returns the number of chunks and of staged chunks copied so far.
+  int64 NumChunks();
+  int64 NumStagedChunks();
+
+  // Creates the pool of a device from the staging_chunk_bytes and
+  // staging_num_chunks of "options". Returns nullptr if staging is
+  // disabled by a negative staging_num_chunks.
+  static GPUStagingPool* Create(
+      perftools::gputools::StreamExecutor* stream_exec, EventMgr* em,
+      const GPUOptions& options);
+
+ private:
+  // Returns a free staging buffer, or nullptr if all are in use.
+  void* TryAcquireBuffer();
+  void ReleaseBuffer(void* buffer);
+
+  EventMgr* const em_;  // not owned
+  const int64 chunk_bytes_;
+  const int num_chunks_;
+  std::unique_ptr<PoolAllocator> allocator_;
+
+  mutex mu_;
+  int num_in_use_ GUARDED_BY(mu_) = 0;
+  int64 num_copied_chunks_ GUARDED_BY(mu_) = 0;
+  int64 num_staged_chunks_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUStagingPool);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_GPU_GPU_STAGING_POOL_H_
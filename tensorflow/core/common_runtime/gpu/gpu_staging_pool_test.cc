@@ -0,0 +1,111 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+namespace {
+
+// Copies "num_bytes" to the GPU and back through a pool of "num_chunks"
+// buffers of "chunk_bytes", and checks that the data survives the trip.
+void TestRoundTrip(int64 chunk_bytes, int num_chunks, int64 num_bytes,
+                   int64* num_staged_chunks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  EventMgr em(stream_exec, GPUOptions());
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  gpu::DeviceMemory<char> gpu_mem = stream_exec->AllocateArray<char>(num_bytes);
+  ASSERT_FALSE(gpu_mem.is_null());
+  {
+    GPUStagingPool pool(stream_exec, &em, chunk_bytes, num_chunks);
+    std::vector<char> src(num_bytes);
+    for (int64 i = 0; i < num_bytes; ++i) {
+      src[i] = static_cast<char>(i % 251);
+    }
+    std::vector<char> dst(num_bytes, 0);
+
+    Notification to_device;
+    pool.CopyToDevice(stream.get(), src.data(), gpu_mem, num_bytes,
+                      [&to_device]() { to_device.Notify(); });
+    to_device.WaitForNotification();
+    Notification from_device;
+    pool.CopyFromDevice(stream.get(), gpu_mem, dst.data(), num_bytes,
+                        [&from_device]() { from_device.Notify(); });
+    from_device.WaitForNotification();
+    EXPECT_TRUE(stream->ok());
+    EXPECT_EQ(src, dst);
+
+    const int64 chunks_per_copy = (num_bytes + chunk_bytes - 1) / chunk_bytes;
+    EXPECT_EQ(2 * chunks_per_copy, pool.NumChunks());
+    *num_staged_chunks = pool.NumStagedChunks();
+    // The buffers of the last chunks are released by callbacks that may
+    // still be running.
+    stream->BlockHostUntilDone();
+    while (pool.NumBuffersInUse() > 0) {
+      Env::Default()->SleepForMicroseconds(100);
+    }
+  }
+  stream_exec->Deallocate(&gpu_mem);
+}
+
+TEST(GPUStagingPoolTest, CopiesInChunks) {
+  int64 num_staged_chunks = 0;
+  // Not a multiple of the chunk size, to cover a partial last chunk.
+  TestRoundTrip(1 << 16, 4, (1 << 20) + 1000, &num_staged_chunks);
+  EXPECT_GT(num_staged_chunks, 0);
+}
+
+TEST(GPUStagingPoolTest, SmallerThanOneChunk) {
+  int64 num_staged_chunks = 0;
+  TestRoundTrip(1 << 20, 2, 1000, &num_staged_chunks);
+  EXPECT_EQ(2, num_staged_chunks);
+}
+
+TEST(GPUStagingPoolTest, FallsBackWhenBuffersAreInUse) {
+  // With a single buffer most chunks find it in use, and are copied
+  // without staging.
+  int64 num_staged_chunks = 0;
+  TestRoundTrip(1 << 12, 1, 1 << 20, &num_staged_chunks);
+  EXPECT_GT(num_staged_chunks, 0);
+}
+
+TEST(GPUStagingPoolTest, ShouldStage) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  EventMgr em(stream_exec, GPUOptions());
+  GPUStagingPool pool(stream_exec, &em, 1 << 20, 2);
+  EXPECT_FALSE(pool.ShouldStage(0));
+  EXPECT_FALSE(pool.ShouldStage(1 << 10));
+  EXPECT_TRUE(pool.ShouldStage(1 << 20));
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -0,0 +1,73 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_timing_sampler.h"
+
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+
+namespace {
+
+auto* gpu_op_device_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/gpu_op_device_usecs",
+     "The time that the sampled ops take on the GPU, in microseconds.", "op"},
+    // Power of 2 with bucket count 20 (> 1 second)
+    monitoring::ExponentialBuckets(1, 2, 20));
+
+}  // namespace
+
+GPUTimingSampler::GPUTimingSampler(EventMgr* em, int64 sample_steps)
+    : em_(em), sample_steps_(sample_steps) {
+  CHECK_GT(sample_steps_, 0);
+}
+
+gpu::Timer* GPUTimingSampler::Start(gpu::Stream* stream) {
+  gpu::Timer* timer = new gpu::Timer(stream->parent());
+  stream->InitTimer(timer).ThenStartTimer(timer);
+  return timer;
+}
+
+void GPUTimingSampler::Stop(gpu::Stream* stream, gpu::Timer* timer,
+                            const string& node_name, const string& op_type) {
+  stream->ThenStopTimer(timer);
+  em_->ThenExecute(stream, [this, stream, timer, node_name, op_type]() {
+    if (stream->ok()) {
+      Record(node_name, op_type, timer->Microseconds());
+    }
+    delete timer;
+  });
+}
+
+void GPUTimingSampler::Record(const string& node_name, const string& op_type,
+                              int64 usecs) {
+  gpu_op_device_usecs->GetCell(op_type)->Add(usecs);
+  mutex_lock l(mu_);
+  Device::OpTime& op_time = op_times_[node_name];
+  op_time.total_usecs += usecs;
+  ++op_time.count;
+}
+
+void GPUTimingSampler::TakeOpTimes(Device::OpTimes* op_times) {
+  mutex_lock l(mu_);
+  op_times->swap(op_times_);
+  op_times_.clear();
+}
+
+}  // namespace tensorflow
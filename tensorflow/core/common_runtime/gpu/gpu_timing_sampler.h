@@ -0,0 +1,81 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_TIMING_SAMPLER_H_
+#define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_TIMING_SAMPLER_H_
+
+#include <string>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class EventMgr;
+
+// Measures the time that the ops of one step out of "sample_steps" take on
+// the GPU, by recording a pair of CUDA events around the work that each op
+// enqueues on its stream.
+//
+// The GPUTracer traces every kernel through CUPTI, which slows the steps
+// down too much to stay on in production. The sampler only times the
+// sampled steps, at the cost of two events per op.
+//
+// The times are exported per op type by the
+// /tensorflow/core/gpu_op_device_usecs sampler, and kept per node until
+// they are taken by TakeOpTimes.
+class GPUTimingSampler {
+ public:
+  // "em" is not owned, and must outlive the sampler.
+  GPUTimingSampler(EventMgr* em, int64 sample_steps);
+
+  // Returns true if the ops of step "step_id" are timed.
+  bool ShouldSample(int64 step_id) const {
+    return step_id % sample_steps_ == 0;
+  }
+
+  // Starts timing the work enqueued on "stream". The returned timer must be
+  // passed to Stop once the op has enqueued its work.
+  perftools::gputools::Timer* Start(perftools::gputools::Stream* stream);
+
+  // Stops "timer", and records its time for the op "node_name" of type
+  // "op_type" once "stream" completes the work of the op. Takes ownership
+  // of "timer".
+  void Stop(perftools::gputools::Stream* stream,
+            perftools::gputools::Timer* timer, const string& node_name,
+            const string& op_type);
+
+  // Moves the times recorded since the last call to "*op_times".
+  void TakeOpTimes(Device::OpTimes* op_times);
+
+ private:
+  void Record(const string& node_name, const string& op_type, int64 usecs);
+
+  EventMgr* const em_;  // not owned
+  const int64 sample_steps_;
+
+  mutex mu_;
+  Device::OpTimes op_times_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUTimingSampler);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_GPU_GPU_TIMING_SAMPLER_H_
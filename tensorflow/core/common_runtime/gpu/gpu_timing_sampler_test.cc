@@ -0,0 +1,82 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_timing_sampler.h"
+
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+namespace {
+
+TEST(GPUTimingSamplerTest, ShouldSample) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  EventMgr em(stream_exec, GPUOptions());
+  GPUTimingSampler sampler(&em, 10);
+  EXPECT_TRUE(sampler.ShouldSample(0));
+  EXPECT_FALSE(sampler.ShouldSample(1));
+  EXPECT_FALSE(sampler.ShouldSample(9));
+  EXPECT_TRUE(sampler.ShouldSample(20));
+}
+
+TEST(GPUTimingSamplerTest, RecordsOpTimes) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  EventMgr em(stream_exec, GPUOptions());
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  stream->Init();
+  const int64 num_bytes = 64 << 20;
+  gpu::DeviceMemory<char> mem = stream_exec->AllocateArray<char>(num_bytes);
+  ASSERT_FALSE(mem.is_null());
+
+  GPUTimingSampler sampler(&em, 1);
+  for (int i = 0; i < 2; ++i) {
+    gpu::Timer* timer = sampler.Start(stream.get());
+    stream->ThenMemZero(&mem, num_bytes);
+    sampler.Stop(stream.get(), timer, "zero", "MemZero");
+  }
+  stream->BlockHostUntilDone();
+
+  // The times are recorded by callbacks, which may still be pending.
+  Device::OpTimes op_times;
+  Device::OpTime total;
+  while (total.count < 2) {
+    sampler.TakeOpTimes(&op_times);
+    EXPECT_LE(op_times.size(), 1);
+    if (!op_times.empty()) {
+      total.total_usecs += op_times["zero"].total_usecs;
+      total.count += op_times["zero"].count;
+    }
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  EXPECT_EQ(2, total.count);
+  EXPECT_GT(total.total_usecs, 0);
+
+  sampler.TakeOpTimes(&op_times);
+  EXPECT_TRUE(op_times.empty());
+  stream_exec->Deallocate(&mem);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -0,0 +1,244 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_topology.h"
+
+#include <algorithm>
+#include <set>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+
+namespace {
+
+const int kNumProbes = 3;
+
+// A relayed copy makes two copies and an allocation on the relay: only
+// relay when the measurements predict a clear speedup.
+const double kMinRelaySpeedup = 1.25;
+
+// Returns the bandwidth, in bytes per second, of copies of "num_bytes" from
+// "src" to "dst" issued on a stream of "from", or 0 if the copies failed.
+int64 MeasureBandwidth(gpu::StreamExecutor* from,
+                       const gpu::DeviceMemoryBase& src,
+                       gpu::DeviceMemoryBase* dst, int64 num_bytes) {
+  gpu::Stream stream(from);
+  stream.Init();
+  // The first copy pays for the setup of the peer mappings.
+  stream.ThenMemcpy(dst, src, num_bytes);
+  if (!stream.BlockHostUntilDone()) {
+    return 0;
+  }
+  const uint64 start = Env::Default()->NowMicros();
+  for (int i = 0; i < kNumProbes; ++i) {
+    stream.ThenMemcpy(dst, src, num_bytes);
+  }
+  if (!stream.BlockHostUntilDone()) {
+    return 0;
+  }
+  const uint64 elapsed_us =
+      std::max<uint64>(Env::Default()->NowMicros() - start, 1);
+  return num_bytes * kNumProbes * 1000000 / elapsed_us;
+}
+
+}  // namespace
+
+/* static */
+GPUTopology* GPUTopology::Global() {
+  static GPUTopology* topology = new GPUTopology;
+  return topology;
+}
+
+Status GPUTopology::Discover(gpu::Platform* platform,
+                             const std::vector<int>& gpu_ids,
+                             int64 probe_bytes) {
+  std::vector<gpu::StreamExecutor*> executors;
+  for (int gpu_id : gpu_ids) {
+    auto exec_status = platform->ExecutorForDevice(gpu_id);
+    if (!exec_status.ok()) {
+      return exec_status.status();
+    }
+    executors.push_back(exec_status.ValueOrDie());
+  }
+  for (int i = 0; i < gpu_ids.size(); ++i) {
+    for (int j = 0; j < gpu_ids.size(); ++j) {
+      if (i == j) continue;
+      Link link;
+      link.peer_access = executors[i]->CanEnablePeerAccessTo(executors[j]);
+      SetLink(gpu_ids[i], gpu_ids[j], link);
+    }
+  }
+
+  if (probe_bytes <= 0 || gpu_ids.size() < 2) {
+    return Status::OK();
+  }
+
+  std::vector<gpu::DeviceMemory<uint8>> buffers;
+  for (gpu::StreamExecutor* se : executors) {
+    buffers.push_back(se->AllocateArray<uint8>(probe_bytes));
+  }
+  for (int i = 0; i < gpu_ids.size(); ++i) {
+    for (int j = 0; j < gpu_ids.size(); ++j) {
+      if (i == j || buffers[i].is_null() || buffers[j].is_null()) continue;
+      Link link = GetLink(gpu_ids[i], gpu_ids[j]);
+      link.bandwidth =
+          MeasureBandwidth(executors[i], buffers[i], &buffers[j], probe_bytes);
+      SetLink(gpu_ids[i], gpu_ids[j], link);
+    }
+  }
+  LOG(INFO) << "GPU copy bandwidth:\n" << DebugString();
+
+  // Keep the buffers of the GPUs that turn out to be worth relaying through.
+  std::set<int> relays;
+  {
+    mutex_lock l(mu_);
+    for (int i = 0; i < gpu_ids.size(); ++i) {
+      if (!buffers[i].is_null()) {
+        relays_[gpu_ids[i]].buffer = buffers[i];
+      }
+    }
+    for (int from : gpu_ids) {
+      for (int to : gpu_ids) {
+        if (from == to) continue;
+        const int relay = GetRelayLocked(from, to);
+        if (relay >= 0) {
+          relays.insert(relay);
+          VLOG(1) << "Copies from GPU " << from << " to GPU " << to
+                  << " are relayed through GPU " << relay;
+        }
+      }
+    }
+    for (int i = 0; i < gpu_ids.size(); ++i) {
+      if (relays.count(gpu_ids[i]) == 0) {
+        relays_.erase(gpu_ids[i]);
+      }
+    }
+  }
+  for (int i = 0; i < executors.size(); ++i) {
+    if (!buffers[i].is_null() && relays.count(gpu_ids[i]) == 0) {
+      executors[i]->Deallocate(&buffers[i]);
+    }
+  }
+  return Status::OK();
+}
+
+void GPUTopology::SetLink(int from, int to, const Link& link) {
+  mutex_lock l(mu_);
+  links_[{from, to}] = link;
+}
+
+GPUTopology::Link GPUTopology::GetLink(int from, int to) const {
+  mutex_lock l(mu_);
+  return GetLinkLocked(from, to);
+}
+
+GPUTopology::Link GPUTopology::GetLinkLocked(int from, int to) const {
+  auto it = links_.find({from, to});
+  if (it == links_.end()) {
+    return Link();
+  }
+  return it->second;
+}
+
+void GPUTopology::AddRelay(int gpu_id, const gpu::DeviceMemoryBase& buffer) {
+  mutex_lock l(mu_);
+  relays_[gpu_id].buffer = buffer;
+}
+
+int GPUTopology::GetRelay(int from, int to) const {
+  mutex_lock l(mu_);
+  return GetRelayLocked(from, to);
+}
+
+int GPUTopology::GetRelayLocked(int from, int to) const {
+  const Link direct = GetLinkLocked(from, to);
+  if (direct.bandwidth <= 0) {
+    return -1;
+  }
+  // Compare the time per byte of each route.
+  double best_time = 1.0 / (direct.bandwidth * kMinRelaySpeedup);
+  int best_relay = -1;
+  for (const auto& it : relays_) {
+    const int relay = it.first;
+    if (relay == from || relay == to) continue;
+    const Link first = GetLinkLocked(from, relay);
+    const Link second = GetLinkLocked(relay, to);
+    if (!first.peer_access || !second.peer_access || first.bandwidth <= 0 ||
+        second.bandwidth <= 0) {
+      continue;
+    }
+    const double time = 1.0 / first.bandwidth + 1.0 / second.bandwidth;
+    if (time < best_time) {
+      best_time = time;
+      best_relay = relay;
+    }
+  }
+  return best_relay;
+}
+
+bool GPUTopology::AcquireRelayBuffer(int relay, gpu::DeviceMemoryBase* buffer) {
+  mutex_lock l(mu_);
+  auto it = relays_.find(relay);
+  if (it == relays_.end() || it->second.in_use) {
+    return false;
+  }
+  it->second.in_use = true;
+  *buffer = it->second.buffer;
+  return true;
+}
+
+void GPUTopology::ReleaseRelayBuffer(int relay) {
+  mutex_lock l(mu_);
+  relays_[relay].in_use = false;
+}
+
+string GPUTopology::DebugString() const {
+  mutex_lock l(mu_);
+  std::set<int> gpu_ids;
+  for (const auto& it : links_) {
+    gpu_ids.insert(it.first.first);
+    gpu_ids.insert(it.first.second);
+  }
+  string result = "     ";
+  for (int to : gpu_ids) {
+    strings::StrAppend(&result, strings::Printf("%10d", to));
+  }
+  for (int from : gpu_ids) {
+    strings::StrAppend(&result, "\n", strings::Printf("%3d: ", from));
+    for (int to : gpu_ids) {
+      if (from == to) {
+        strings::StrAppend(&result, strings::Printf("%10s", "-"));
+        continue;
+      }
+      const Link link = GetLinkLocked(from, to);
+      string cell = link.bandwidth > 0
+                        ? strings::HumanReadableNumBytes(link.bandwidth)
+                        : "?";
+      if (!link.peer_access) cell += "*";
+      strings::StrAppend(&result, strings::Printf("%10s", cell.c_str()));
+    }
+  }
+  strings::StrAppend(&result, "\n(bytes/s, * without peer access)");
+  return result;
+}
+
+}  // namespace tensorflow
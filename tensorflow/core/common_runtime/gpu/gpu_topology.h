@@ -0,0 +1,109 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_TOPOLOGY_H_
+#define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_TOPOLOGY_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The interconnect between the GPUs of the machine: which GPUs can access
+// the memory of which other GPUs, and how fast they copy to each other.
+//
+// Device-to-device copies use it to pick their route: on machines where
+// some pairs of GPUs are connected by a fast link (e.g. NVLink) and others
+// only through PCIe switches or the host, copying through a GPU linked to
+// both ends can be faster than copying directly.
+//
+// GPUs are identified by their StreamExecutor ordinal.
+class GPUTopology {
+ public:
+  struct Link {
+    // Whether the source GPU can access the memory of the destination.
+    bool peer_access = false;
+    // Measured bandwidth of the copies, in bytes per second, or 0 if it
+    // was not measured.
+    int64 bandwidth = 0;
+  };
+
+  GPUTopology() {}
+
+  // The topology of the GPUs used by the process.
+  static GPUTopology* Global();
+
+  // Records whether each of "gpu_ids" can access the memory of the others.
+  // If "probe_bytes" is positive, also measures the bandwidth of each
+  // ordered pair by timing copies of "probe_bytes" on a stream of the
+  // source, which takes n * (n - 1) probes for n GPUs. The pairs for which
+  // a probe buffer can not be allocated are left unmeasured. The GPUs
+  // through which some copies are predicted to be faster then keep their
+  // probe buffer to stage the relayed copies. Peer access must already be
+  // enabled.
+  Status Discover(perftools::gputools::Platform* platform,
+                  const std::vector<int>& gpu_ids, int64 probe_bytes);
+
+  void SetLink(int from, int to, const Link& link);
+
+  // Returns the link from "from" to "to", or a default Link if unknown.
+  Link GetLink(int from, int to) const;
+
+  // Allows the copies between other GPUs to be staged through "gpu_id", in
+  // "buffer", which must outlive the topology.
+  void AddRelay(int gpu_id,
+                const perftools::gputools::DeviceMemoryBase& buffer);
+
+  // Returns the GPU to stage the copies from "from" to "to" through, or -1
+  // if no relay is predicted to be at least 25% faster than the direct
+  // copy. Only the measured links with peer access are considered, so
+  // this is always -1 when "from" to "to" was not measured.
+  int GetRelay(int from, int to) const;
+
+  // Sets "*buffer" to the staging buffer of "relay" and returns true, or
+  // returns false if another copy is using it.
+  bool AcquireRelayBuffer(int relay,
+                          perftools::gputools::DeviceMemoryBase* buffer);
+  void ReleaseRelayBuffer(int relay);
+
+  string DebugString() const;
+
+ private:
+  struct Relay {
+    perftools::gputools::DeviceMemoryBase buffer;
+    bool in_use = false;
+  };
+
+  Link GetLinkLocked(int from, int to) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  int GetRelayLocked(int from, int to) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  std::map<std::pair<int, int>, Link> links_ GUARDED_BY(mu_);
+  std::map<int, Relay> relays_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUTopology);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_GPU_GPU_TOPOLOGY_H_
@@ -0,0 +1,117 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_topology.h"
+
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace gpu = ::perftools::gputools;
+
+namespace tensorflow {
+namespace {
+
+const int64 kNVLink = 20LL << 30;
+const int64 kPCIe = 10LL << 30;
+const int64 kHost = 4LL << 30;
+
+void SetLinks(GPUTopology* topology, int a, int b, bool peer_access,
+              int64 bandwidth) {
+  GPUTopology::Link link;
+  link.peer_access = peer_access;
+  link.bandwidth = bandwidth;
+  topology->SetLink(a, b, link);
+  topology->SetLink(b, a, link);
+}
+
+// GPUs 0 and 1, and 1 and 2, are linked by NVLink, but 0 and 2 only
+// through the host.
+void BuildTopology(GPUTopology* topology) {
+  SetLinks(topology, 0, 1, true, kNVLink);
+  SetLinks(topology, 1, 2, true, kNVLink);
+  SetLinks(topology, 0, 2, false, kHost);
+  // Never copied to.
+  static char buffer[16];
+  for (int gpu_id = 0; gpu_id < 3; ++gpu_id) {
+    topology->AddRelay(gpu_id, gpu::DeviceMemoryBase(buffer, sizeof(buffer)));
+  }
+}
+
+TEST(GPUTopologyTest, RelaysThroughFasterLinks) {
+  GPUTopology topology;
+  BuildTopology(&topology);
+  EXPECT_EQ(1, topology.GetRelay(0, 2));
+  EXPECT_EQ(1, topology.GetRelay(2, 0));
+  EXPECT_EQ(-1, topology.GetRelay(0, 1));
+  EXPECT_EQ(-1, topology.GetRelay(1, 2));
+}
+
+TEST(GPUTopologyTest, DirectWhenRelayIsNotClearlyFaster) {
+  GPUTopology topology;
+  BuildTopology(&topology);
+  // Two NVLink hops take as long as one 10GB/s hop.
+  SetLinks(&topology, 0, 2, true, kPCIe);
+  EXPECT_EQ(-1, topology.GetRelay(0, 2));
+}
+
+TEST(GPUTopologyTest, UnmeasuredLinksAreNotRelayed) {
+  GPUTopology topology;
+  BuildTopology(&topology);
+  SetLinks(&topology, 0, 2, false, 0);
+  EXPECT_EQ(-1, topology.GetRelay(0, 2));
+  SetLinks(&topology, 0, 2, false, kHost);
+  SetLinks(&topology, 0, 1, true, 0);
+  EXPECT_EQ(-1, topology.GetRelay(0, 2));
+}
+
+TEST(GPUTopologyTest, RelayBufferIsExclusive) {
+  GPUTopology topology;
+  BuildTopology(&topology);
+  gpu::DeviceMemoryBase buffer;
+  EXPECT_TRUE(topology.AcquireRelayBuffer(1, &buffer));
+  EXPECT_EQ(16, buffer.size());
+  gpu::DeviceMemoryBase other;
+  EXPECT_FALSE(topology.AcquireRelayBuffer(1, &other));
+  topology.ReleaseRelayBuffer(1);
+  EXPECT_TRUE(topology.AcquireRelayBuffer(1, &other));
+  topology.ReleaseRelayBuffer(1);
+  EXPECT_FALSE(topology.AcquireRelayBuffer(3, &other));
+}
+
+TEST(GPUTopologyTest, Discover) {
+  gpu::Platform* platform = GPUMachineManager();
+  std::vector<int> gpu_ids;
+  for (int i = 0; i < platform->VisibleDeviceCount(); ++i) {
+    gpu_ids.push_back(i);
+  }
+  GPUTopology topology;
+  TF_ASSERT_OK(topology.Discover(platform, gpu_ids, 1 << 20));
+  for (int from : gpu_ids) {
+    for (int to : gpu_ids) {
+      if (from == to) continue;
+      // Every pair of GPUs can copy to each other, through the host if need
+      // be.
+      EXPECT_GT(topology.GetLink(from, to).bandwidth, 0);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
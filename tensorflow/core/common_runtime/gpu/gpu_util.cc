@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_topology.h"
 #include "tensorflow/core/common_runtime/gpu/process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
@@ -29,8 +34,10 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
@@ -61,6 +68,69 @@ namespace tensorflow {
 
 namespace gpu = ::perftools::gputools;
 
+namespace {
+
+// The bandwidth of the copies between host and GPU memory is the ratio of
+// these two counters, per direction ("host_to_device", "device_to_host")
+// and per path: "pinned" for host tensors already in pinned memory,
+// "staged" for copies through the staging pool of the device, and
+// "pageable" for the others.
+auto* gpu_copy_bytes = monitoring::Counter<2>::New(
+    "/tensorflow/core/gpu_copy_bytes",
+    "The number of bytes copied between host and GPU memory.", "direction",
+    "path");
+
+auto* gpu_copy_usecs = monitoring::Counter<2>::New(
+    "/tensorflow/core/gpu_copy_usecs",
+    "The time from the issue to the completion of the copies between host "
+    "and GPU memory, in microseconds.",
+    "direction", "path");
+
+// Returns true if the buffer of "host_tensor" was allocated by the CUDA
+// host allocator, and is thus pinned.
+bool IsPinned(const Tensor& host_tensor) {
+  const TensorBuffer* buf = DMAHelper::buffer(&host_tensor);
+  if (buf == nullptr) return false;
+  AllocationDescription desc;
+  buf->FillAllocationDescription(&desc);
+  return desc.allocator_name() ==
+         ProcessState::singleton()->GetCUDAHostAllocator(0)->Name();
+}
+
+// Returns the path label of a copy of "host_tensor", and sets
+// "*staging_pool" to the pool to copy it through, or nullptr.
+const char* CopyPath(const DeviceBase::GpuDeviceInfo* dev_info,
+                     const Tensor& host_tensor,
+                     GPUStagingPool** staging_pool) {
+  *staging_pool = nullptr;
+  if (IsPinned(host_tensor)) return "pinned";
+  GPUStagingPool* pool = dev_info->staging_pool;
+  if (pool != nullptr && pool->ShouldStage(host_tensor.TotalBytes())) {
+    *staging_pool = pool;
+    return "staged";
+  }
+  return "pageable";
+}
+
+// Device-to-device copies smaller than this are never relayed: their cost
+// is dominated by latency, which a relay doubles.
+const int64 kMinRelayBytes = 1 << 20;
+
+// Returns the GPU to stage a copy of "num_bytes" from "src_gpu_id" to
+// "dst_gpu_id" through, and sets "*buffer" to its staging buffer, or returns
+// -1 to copy directly.
+int AcquireRelay(int src_gpu_id, int dst_gpu_id, int64 num_bytes,
+                 DeviceMemoryBase* buffer) {
+  if (num_bytes < kMinRelayBytes) return -1;
+  GPUTopology* topology = GPUTopology::Global();
+  const int relay = topology->GetRelay(src_gpu_id, dst_gpu_id);
+  // Copy directly rather than wait for the copy that uses the buffer.
+  if (relay < 0 || !topology->AcquireRelayBuffer(relay, buffer)) return -1;
+  return relay;
+}
+
+}  // namespace
+
 Status PrepareCopy(Device* device, const DeviceContext* ctx, const Tensor& src,
                    const Tensor* dst,
                    const DeviceBase::GpuDeviceInfo** dev_info,
@@ -213,6 +283,7 @@ void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
   send_device_to_device_stream->ThenWaitFor(send_stream);
 
   const int64 total_bytes = input->TotalBytes();
+  int relay = -1;
   if (total_bytes > 0) {
     void* src_ptr = GetBase(input);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
@@ -231,17 +302,43 @@ void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
     // to make sure the memory is free.
     send_device_to_device_stream->ThenWaitFor(recv_stream);
 
-    VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr;
-    send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
-                                             total_bytes);
+    // Stage the copy through another GPU when the topology says it is
+    // faster, e.g. between GPUs that are not linked directly by NVLink but
+    // are both linked to the relay.
+    DeviceMemoryBase relay_buffer;
+    relay = AcquireRelay(dev_info->gpu_id,
+                         dst->tensorflow_gpu_device_info()->gpu_id,
+                         total_bytes, &relay_buffer);
+
+    VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr << " relay "
+            << relay;
+    if (relay >= 0) {
+      char* src_base = static_cast<char*>(src_ptr);
+      char* dst_base = static_cast<char*>(dst_ptr);
+      for (int64 offset = 0; offset < total_bytes;
+           offset += relay_buffer.size()) {
+        const int64 n =
+            std::min<int64>(relay_buffer.size(), total_bytes - offset);
+        DeviceMemoryBase chunk_src(src_base + offset, n);
+        DeviceMemoryBase chunk_dst(dst_base + offset, n);
+        send_device_to_device_stream->ThenMemcpy(&relay_buffer, chunk_src, n);
+        send_device_to_device_stream->ThenMemcpy(&chunk_dst, relay_buffer, n);
+      }
+    } else {
+      send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
+                                               total_bytes);
+    }
   }
 
   // Use of input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*input);
   dev_info->event_mgr->ThenExecute(
       send_device_to_device_stream,
-      [done, send_device_to_device_stream, input_ref]() {
+      [done, send_device_to_device_stream, input_ref, relay]() {
         input_ref.Unref();
+        if (relay >= 0) {
+          GPUTopology::Global()->ReleaseRelayBuffer(relay);
+        }
         if (!send_device_to_device_stream->ok()) {
           LOG(FATAL) << "GPU->GPU Memcpy failed";
         }
@@ -280,23 +377,35 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64 total_bytes = gpu_tensor->TotalBytes();
+  GPUStagingPool* staging_pool = nullptr;
+  const char* path = CopyPath(dev_info, *cpu_tensor, &staging_pool);
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  // Use of the input may outlive stack scope, so keep a ref.
+  TensorReference input_ref(*gpu_tensor);
+  auto copy_done = [send_device_to_host_stream, done, input_ref, total_bytes,
+                    path, start_usecs]() {
+    if (!send_device_to_host_stream->ok()) {
+      LOG(FATAL) << "GPU->CPU Memcpy failed";
+    }
+    input_ref.Unref();
+    gpu_copy_bytes->GetCell("device_to_host", path)->IncrementBy(total_bytes);
+    gpu_copy_usecs->GetCell("device_to_host", path)
+        ->IncrementBy(Env::Default()->NowMicros() - start_usecs);
+    done(Status::OK());
+  };
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     void* dst_ptr = GetBase(cpu_tensor);
+    if (staging_pool != nullptr) {
+      staging_pool->CopyFromDevice(send_device_to_host_stream, gpu_src_ptr,
+                                   dst_ptr, total_bytes, std::move(copy_done));
+      return;
+    }
     send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
   }
-  // Use of the input may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*gpu_tensor);
-  dev_info->event_mgr->ThenExecute(
-      send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
-        if (!send_device_to_host_stream->ok()) {
-          LOG(FATAL) << "GPU->CPU Memcpy failed";
-        }
-        input_ref.Unref();
-        done(Status::OK());
-      });
+  dev_info->event_mgr->ThenExecute(send_device_to_host_stream,
+                                   std::move(copy_done));
 }
 
 /*  static */
@@ -325,24 +434,37 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   recv_host_to_device_stream->ThenWaitFor(recv_stream);
 
   const int64 total_bytes = cpu_tensor->TotalBytes();
+  GPUStagingPool* staging_pool = nullptr;
+  const char* path = CopyPath(dev_info, *cpu_tensor, &staging_pool);
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  // Use of cpu_tensor may outlive stack scope, so keep a ref.
+  TensorReference input_ref(*cpu_tensor);
+  auto copy_done = [recv_host_to_device_stream, done, input_ref, total_bytes,
+                    path, start_usecs]() {
+    input_ref.Unref();
+    if (!recv_host_to_device_stream->ok()) {
+      LOG(FATAL) << "CPU->GPU Memcpy failed";
+    }
+    gpu_copy_bytes->GetCell("host_to_device", path)->IncrementBy(total_bytes);
+    gpu_copy_usecs->GetCell("host_to_device", path)
+        ->IncrementBy(Env::Default()->NowMicros() - start_usecs);
+    done(Status::OK());
+  };
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
+    if (staging_pool != nullptr) {
+      staging_pool->CopyToDevice(recv_host_to_device_stream, src_ptr,
+                                 gpu_dst_ptr, total_bytes,
+                                 std::move(copy_done));
+      return;
+    }
     recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
   }
-  // Use of cpu_tensor may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*cpu_tensor);
-  dev_info->event_mgr->ThenExecute(
-      recv_host_to_device_stream,
-      [recv_host_to_device_stream, done, input_ref]() {
-        input_ref.Unref();
-        if (!recv_host_to_device_stream->ok()) {
-          LOG(FATAL) << "CPU->GPU Memcpy failed";
-        }
-        done(Status::OK());
-      });
+  dev_info->event_mgr->ThenExecute(recv_host_to_device_stream,
+                                   std::move(copy_done));
 }
 
 Status GPUUtil::Sync(Device* gpu_device) {
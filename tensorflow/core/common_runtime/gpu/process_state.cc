@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_debug_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/pool_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
@@ -98,6 +99,7 @@ Allocator* ProcessState::GetGPUAllocator(const GPUOptions& options, int gpu_id,
 
   if (gpu_id >= static_cast<int64>(gpu_allocators_.size())) {
     gpu_allocators_.resize(gpu_id + 1);
+    gpu_bfc_allocators_.resize(gpu_id + 1);
     if (FLAGS_brain_gpu_record_mem_types) gpu_al_.resize(gpu_id + 1);
   }
 
@@ -110,7 +112,13 @@ Allocator* ProcessState::GetGPUAllocator(const GPUOptions& options, int gpu_id,
       return nullptr;
     }
 
-    gpu_allocator = new GPUBFCAllocator(gpu_id, total_bytes, options);
+    GPUBFCAllocator* bfc_allocator =
+        new GPUBFCAllocator(gpu_id, total_bytes, options);
+    gpu_bfc_allocators_[gpu_id] = bfc_allocator;
+    gpu_allocator = bfc_allocator;
+    if (options.allow_unified_memory_fallback()) {
+      gpu_allocator = new GPUManagedFallbackAllocator(gpu_allocator, gpu_id);
+    }
 
     // If true, checks for memory overwrites by writing
     // distinctive patterns on both ends of allocated memory.
@@ -151,7 +159,17 @@ Allocator* ProcessState::GetGPUAllocator(const GPUOptions& options, int gpu_id,
 #endif  // GOOGLE_CUDA
 }
 
-Allocator* ProcessState::GetCPUAllocator(int numa_node) {
+size_t ProcessState::ReleaseFreeGPUMemory(int gpu_id) {
+  mutex_lock lock(mu_);
+  if (gpu_id >= static_cast<int64>(gpu_bfc_allocators_.size()) ||
+      gpu_bfc_allocators_[gpu_id] == nullptr) {
+    return 0;
+  }
+  return gpu_bfc_allocators_[gpu_id]->ReleaseFreeRegions();
+}
+
+Allocator* ProcessState::GetCPUAllocator(const GPUOptions& options,
+                                         int numa_node) {
   // Although we're temporarily ignoring numa_node, check for legality.
   CHECK_GE(numa_node, 0);
   // TODO(tucker): actually maintain separate CPUAllocators for
@@ -178,9 +196,17 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
         LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
-      allocator = new BFCAllocator(new BasicCPUAllocator(), cpu_mem_limit,
-                                   true /*allow_growth*/,
-                                   "bfc_cpu_allocator_for_gpu" /*name*/);
+      BFCAllocator* bfc_allocator = new BFCAllocator(
+          new BasicCPUAllocator(), cpu_mem_limit, true /*allow_growth*/,
+          "bfc_cpu_allocator_for_gpu" /*name*/);
+      const int thread_cache_shards =
+          options.host_allocator_thread_cache_shards();
+      if (thread_cache_shards > 0) {
+        bfc_allocator->EnableThreadCache(thread_cache_shards);
+        VLOG(2) << "Using " << thread_cache_shards
+                << " thread cache shards for ProcessState CPU allocator";
+      }
+      allocator = bfc_allocator;
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
     } else {
@@ -29,6 +29,7 @@ limitations under the License.
 namespace tensorflow {
 
 class Allocator;
+class BFCAllocator;
 class VisitableAllocator;
 class PoolAllocator;
 
@@ -70,9 +71,11 @@ class ProcessState {
   // If we know nothing, it's called CPU 0 with no other attributes.
   MemDesc PtrType(const void* ptr);
 
-  // Returns the one CPUAllocator used for the given numa_node.
+  // Returns the one CPUAllocator used for the given numa_node. The first
+  // call creates the allocator, so only the "options" of that call are
+  // used.
   // TEMPORARY: ignores numa_node.
-  Allocator* GetCPUAllocator(int numa_node);
+  Allocator* GetCPUAllocator(const GPUOptions& options, int numa_node);
 
   // Returns the one GPU allocator used for the indexed GPU.
   // Note that this is a system GPU index, not (necessarily) a brain
@@ -94,6 +97,10 @@ class ProcessState {
 
   virtual Allocator* GetCUDAHostAllocator(int numa_node);
 
+  // Returns the regions of the GPU allocator of "gpu_id" that hold no
+  // allocation to the device, and returns the number of bytes released.
+  size_t ReleaseFreeGPUMemory(int gpu_id);
+
   // Registers a function to be called once on every new Region
   // allocated by every GPURegionAllocator proximate to the specified
   // bus.  The AllocVisitor is provided with a memory pointer and the
@@ -119,6 +126,9 @@ class ProcessState {
 
   std::vector<Allocator*> cpu_allocators_ GUARDED_BY(mu_);
   std::vector<VisitableAllocator*> gpu_allocators_ GUARDED_BY(mu_);
+  // The BFCAllocators at the bottom of gpu_allocators_, which may be
+  // wrapped for debugging.
+  std::vector<BFCAllocator*> gpu_bfc_allocators_ GUARDED_BY(mu_);
   std::vector<std::vector<AllocVisitor>> gpu_visitors_ GUARDED_BY(mu_);
   std::vector<Allocator*> cuda_host_allocators_ GUARDED_BY(mu_);
 
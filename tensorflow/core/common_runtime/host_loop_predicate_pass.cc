@@ -0,0 +1,163 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <deque>
+#include <unordered_set>
+
+#include "tensorflow/core/common_runtime/memory_types.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+// The label of the GPU kernels that run on the host, with their arguments in
+// host memory.
+const char* const kHostLabel = "host";
+
+bool IsOnGpu(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name(), &parsed) &&
+         parsed.has_type && parsed.type == DEVICE_GPU;
+}
+
+// Returns true if output "index" of "n" can be read on the host of
+// "device" without a copy from a device: "n" is not on a GPU, or is on
+// "device" and produces the output in host memory.
+bool OutputOnHost(const Graph* g, const Node* n, int index,
+                  const string& device) {
+  if (!IsOnGpu(n)) return true;
+  if (n->assigned_device_name() != device) return false;
+  MemoryType memory_type;
+  if (!MemoryTypeForOutput(DEVICE_GPU, g, n, index, &memory_type).ok()) {
+    return false;
+  }
+  return memory_type == HOST_MEMORY;
+}
+
+// The predicate of a while loop on the GPU is read on the host by LoopCond,
+// but the nodes that compute it (a comparison of the loop counter, a
+// LogicalAnd of two conditions, ...) run on the device unless they are int32,
+// so every iteration copies the predicate off the device. For the scalar
+// ops that register a GPU kernel with the "host" label, this pass labels
+// the nodes whose outputs only feed the predicate, so that they run on the
+// host and the predicate stays in host memory. A node is only labeled if
+// that doesn't add copies between device and host: one that takes two
+// values computed on the device keeps its output there, and pays one copy
+// instead of two.
+//
+// The nodes stay on their device, so the partitioning of the loop does not
+// change; EnsureMemoryTypes() adds the copies of their inputs that are still
+// in device memory.
+class HostLoopPredicatePass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr || options.graph->get() == nullptr) {
+      return Status::OK();
+    }
+    Graph* g = options.graph->get();
+
+    // The nodes whose consumers all read their outputs in host memory.
+    std::unordered_set<const Node*> on_host;
+    std::deque<Node*> queue;
+    for (Node* n : g->op_nodes()) {
+      if (IsLoopCond(n) && IsOnGpu(n)) {
+        on_host.insert(n);
+        AddProducers(n, &queue);
+      }
+    }
+    while (!queue.empty()) {
+      Node* n = queue.front();
+      queue.pop_front();
+      if (on_host.count(n) == 0 && ShouldRunOnHost(g, n, on_host)) {
+        n->AddAttr("_kernel", kHostLabel);
+        on_host.insert(n);
+        AddProducers(n, &queue);
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  static void AddProducers(const Node* n, std::deque<Node*>* queue) {
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge()) queue->push_back(e->src());
+    }
+  }
+
+  static bool ShouldRunOnHost(const Graph* g, const Node* n,
+                              const std::unordered_set<const Node*>& on_host) {
+    if (!IsOnGpu(n) || n->attrs().Find("_kernel") != nullptr) return false;
+    const string& device = n->assigned_device_name();
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      if (on_host.count(e->dst()) == 0 ||
+          e->dst()->assigned_device_name() != device) {
+        return false;
+      }
+    }
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      // Already in host memory, so there's nothing to save.
+      if (OutputOnHost(g, n, i, device)) return false;
+    }
+    NodeDef host_def = n->def();
+    (*host_def.mutable_attr())["_kernel"].set_s(kHostLabel);
+    if (!FindKernelDef(DEVICE_GPU, host_def, nullptr, nullptr).ok()) {
+      return false;
+    }
+
+    // Today the value is copied to the host after "n", and each of its
+    // inputs in host memory is copied to the device before it. Running "n"
+    // on the host instead copies each of its inputs in device memory.
+    int copies_on_device = n->num_outputs();
+    int copies_on_host = 0;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      if (OutputOnHost(g, e->src(), e->src_output(), device)) {
+        ++copies_on_device;
+      } else if (!WillRunOnHost(e->src(), n, on_host)) {
+        ++copies_on_host;
+      }
+    }
+    return copies_on_host <= copies_on_device;
+  }
+
+  // Returns true if "producer" is an input-less node (such as a Const) on
+  // the device of "consumer" that only feeds "consumer" and nodes in
+  // "on_host", and so will be labeled as well once "consumer" is.
+  static bool WillRunOnHost(const Node* producer, const Node* consumer,
+                            const std::unordered_set<const Node*>& on_host) {
+    if (producer->num_inputs() > 0 ||
+        producer->assigned_device_name() != consumer->assigned_device_name()) {
+      return false;
+    }
+    for (const Edge* e : producer->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      if (e->dst() != consumer && on_host.count(e->dst()) == 0) return false;
+    }
+    NodeDef host_def = producer->def();
+    (*host_def.mutable_attr())["_kernel"].set_s(kHostLabel);
+    return FindKernelDef(DEVICE_GPU, host_def, nullptr, nullptr).ok();
+  }
+};
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, 0,
+                      HostLoopPredicatePass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,151 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+REGISTER_OP("HostLoopPredicateTestValue").Output("output: float");
+REGISTER_OP("HostLoopPredicateTestConst").Output("output: float");
+REGISTER_OP("HostLoopPredicateTestLess")
+    .Input("x: float")
+    .Input("y: float")
+    .Output("z: bool");
+REGISTER_OP("HostLoopPredicateTestConsumer").Input("x: bool");
+
+class DummyKernel : public OpKernel {
+ public:
+  explicit DummyKernel(OpKernelConstruction* context) : OpKernel(context) {}
+  void Compute(OpKernelContext* context) override {}
+};
+
+REGISTER_KERNEL_BUILDER(Name("HostLoopPredicateTestValue").Device(DEVICE_GPU),
+                        DummyKernel);
+REGISTER_KERNEL_BUILDER(Name("HostLoopPredicateTestConst").Device(DEVICE_GPU),
+                        DummyKernel);
+REGISTER_KERNEL_BUILDER(Name("HostLoopPredicateTestConst")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("output")
+                            .Label("host"),
+                        DummyKernel);
+REGISTER_KERNEL_BUILDER(Name("HostLoopPredicateTestLess").Device(DEVICE_GPU),
+                        DummyKernel);
+REGISTER_KERNEL_BUILDER(Name("HostLoopPredicateTestLess")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("x")
+                            .HostMemory("y")
+                            .HostMemory("z")
+                            .Label("host"),
+                        DummyKernel);
+REGISTER_KERNEL_BUILDER(
+    Name("HostLoopPredicateTestConsumer").Device(DEVICE_GPU), DummyKernel);
+
+const char* const kGpu = "/job:localhost/replica:0/task:0/device:GPU:0";
+const char* const kCpu = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class HostLoopPredicatePassTest : public ::testing::Test {
+ protected:
+  HostLoopPredicatePassTest() : graph_(new Graph(OpRegistry::Global())) {}
+
+  Node* AddNode(const string& name, const string& op,
+                const std::vector<Node*>& inputs, const string& device) {
+    NodeBuilder builder(name, op);
+    for (Node* input : inputs) {
+      builder.Input(input);
+    }
+    Node* n;
+    TF_CHECK_OK(builder.Finalize(graph_.get(), &n));
+    n->set_assigned_device_name(device);
+    return n;
+  }
+
+  void RunPass() {
+    GraphOptimizationPassOptions options;
+    options.graph = &graph_;
+    TF_ASSERT_OK(OptimizationPassRegistry::Global()->RunGrouping(
+        OptimizationPassRegistry::POST_PLACEMENT, options));
+  }
+
+  static bool OnHost(const Node* n) {
+    string label;
+    return GetNodeAttr(n->attrs(), "_kernel", &label).ok() && label == "host";
+  }
+
+  std::unique_ptr<Graph> graph_;
+};
+
+TEST_F(HostLoopPredicatePassTest, ComparisonWithConstant) {
+  Node* value = AddNode("value", "HostLoopPredicateTestValue", {}, kGpu);
+  Node* limit = AddNode("limit", "HostLoopPredicateTestConst", {}, kGpu);
+  Node* less = AddNode("less", "HostLoopPredicateTestLess", {value, limit},
+                       kGpu);
+  AddNode("cond", "LoopCond", {less}, kGpu);
+  RunPass();
+
+  // The value is copied to the host instead of the predicate, and the limit
+  // is never on the device.
+  EXPECT_TRUE(OnHost(less));
+  EXPECT_TRUE(OnHost(limit));
+  EXPECT_FALSE(OnHost(value));
+}
+
+TEST_F(HostLoopPredicatePassTest, TwoDeviceInputs) {
+  Node* x = AddNode("x", "HostLoopPredicateTestValue", {}, kGpu);
+  Node* y = AddNode("y", "HostLoopPredicateTestValue", {}, kGpu);
+  Node* less = AddNode("less", "HostLoopPredicateTestLess", {x, y}, kGpu);
+  AddNode("cond", "LoopCond", {less}, kGpu);
+  RunPass();
+
+  // Two copies of the inputs would replace one of the predicate.
+  EXPECT_FALSE(OnHost(less));
+}
+
+TEST_F(HostLoopPredicatePassTest, PredicateUsedOnDevice) {
+  Node* value = AddNode("value", "HostLoopPredicateTestValue", {}, kGpu);
+  Node* limit = AddNode("limit", "HostLoopPredicateTestConst", {}, kGpu);
+  Node* less = AddNode("less", "HostLoopPredicateTestLess", {value, limit},
+                       kGpu);
+  AddNode("cond", "LoopCond", {less}, kGpu);
+  AddNode("consumer", "HostLoopPredicateTestConsumer", {less}, kGpu);
+  RunPass();
+
+  EXPECT_FALSE(OnHost(less));
+  EXPECT_FALSE(OnHost(limit));
+}
+
+TEST_F(HostLoopPredicatePassTest, LoopOnCpu) {
+  Node* value = AddNode("value", "HostLoopPredicateTestValue", {}, kCpu);
+  Node* limit = AddNode("limit", "HostLoopPredicateTestConst", {}, kCpu);
+  Node* less = AddNode("less", "HostLoopPredicateTestLess", {value, limit},
+                       kCpu);
+  AddNode("cond", "LoopCond", {less}, kCpu);
+  RunPass();
+
+  EXPECT_FALSE(OnHost(less));
+  EXPECT_FALSE(OnHost(limit));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -55,8 +55,10 @@ Benchmark::Benchmark(const string& device, Graph* g,
       DeviceFactory::NewDevice(t, *options, "/job:localhost/replica:0/task:0");
   CHECK(device_) << "Could not create a " << device << " device";
 
-  pool_ = new thread::ThreadPool(options->env, "blocking",
-                                 port::NumSchedulableCPUs());
+  const int num_threads = options->config.inter_op_parallelism_threads() > 0
+                              ? options->config.inter_op_parallelism_threads()
+                              : port::NumSchedulableCPUs();
+  pool_ = new thread::ThreadPool(options->env, "blocking", num_threads);
 
   auto runner = [this](std::function<void()> closure) {
     pool_->Schedule(closure);
@@ -81,6 +83,13 @@ Benchmark::Benchmark(const string& device, Graph* g,
   params.delete_kernel = [](OpKernel* kernel) {
     DeleteNonCachedKernel(kernel);
   };
+  const ExecutorOptions& executor_opts = options->config.executor_options();
+  if (executor_opts.use_work_stealing()) {
+    params.num_ready_queues = executor_opts.num_ready_queues() > 0
+                                  ? executor_opts.num_ready_queues()
+                                  : pool_->NumThreads();
+  }
+  params.plan_step_memory = executor_opts.plan_step_memory();
 
   if (init) {
     Executor* init_exec;
@@ -16,32 +16,80 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/common_runtime/local_device.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/eigen_thread_pool.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_feature_guard.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Starts every thread with its affinity restricted to one NUMA node.
+class NUMAPinnedEnv : public EnvWrapper {
+ public:
+  NUMAPinnedEnv(Env* env, int numa_node)
+      : EnvWrapper(env), numa_node_(numa_node) {}
+
+  Thread* StartThread(const ThreadOptions& thread_options, const string& name,
+                      std::function<void()> fn) override {
+    const int numa_node = numa_node_;
+    return EnvWrapper::StartThread(thread_options, name, [numa_node, fn]() {
+      if (!port::NUMASetThreadNodeAffinity(numa_node)) {
+        LOG(WARNING) << "Could not pin thread to NUMA node " << numa_node;
+      }
+      fn();
+    });
+  }
+
+ private:
+  const int numa_node_;
+};
+
+}  // namespace
+
 /* static */
 bool LocalDevice::use_global_threadpool_ = true;
 
 struct LocalDevice::EigenThreadPoolInfo {
-  explicit EigenThreadPoolInfo(const SessionOptions& options) {
+  // If "numa_node" is not kNoNUMANode, the threads are pinned to that
+  // node.
+  EigenThreadPoolInfo(const SessionOptions& options, int numa_node) {
     int32 intra_op_parallelism_threads =
         options.config.intra_op_parallelism_threads();
-    if (intra_op_parallelism_threads == 0) {
-      intra_op_parallelism_threads = port::NumSchedulableCPUs();
+    Env* env = options.env;
+    string name = "Eigen";
+    if (numa_node == kNoNUMANode) {
+      if (intra_op_parallelism_threads == 0) {
+        intra_op_parallelism_threads = port::NumSchedulableCPUs();
+      }
+    } else {
+      if (intra_op_parallelism_threads == 0) {
+        intra_op_parallelism_threads = port::NUMANumSchedulableCPUs(numa_node);
+      } else {
+        intra_op_parallelism_threads = std::max(
+            1, intra_op_parallelism_threads / port::NUMANumNodes());
+      }
+      pinned_env_.reset(new NUMAPinnedEnv(env, numa_node));
+      env = pinned_env_.get();
+      name = strings::StrCat("Eigen_numa", numa_node);
     }
     VLOG(1) << "Local device intra op parallelism threads: "
             << intra_op_parallelism_threads;
     eigen_worker_threads_.num_threads = intra_op_parallelism_threads;
-    eigen_worker_threads_.workers = new thread::ThreadPool(
-        options.env, "Eigen", intra_op_parallelism_threads);
+    eigen_worker_threads_.workers =
+        new thread::ThreadPool(env, name, intra_op_parallelism_threads);
     eigen_threadpool_wrapper_.reset(
         new EigenThreadPoolWrapper(eigen_worker_threads_.workers));
     eigen_device_.reset(new Eigen::ThreadPoolDevice(
@@ -54,6 +102,10 @@ struct LocalDevice::EigenThreadPoolInfo {
     delete eigen_worker_threads_.workers;
   }
 
+  static const int kNoNUMANode = -1;
+
+  // Outlives the threads started through it.
+  std::unique_ptr<Env> pinned_env_;
   DeviceBase::CpuWorkerThreads eigen_worker_threads_;
   std::unique_ptr<Eigen::ThreadPoolInterface> eigen_threadpool_wrapper_;
   std::unique_ptr<Eigen::ThreadPoolDevice> eigen_device_;
@@ -66,16 +118,35 @@ LocalDevice::LocalDevice(const SessionOptions& options,
   // best flags for performance.
   port::WarnAboutUnusedCPUFeatures();
   LocalDevice::EigenThreadPoolInfo* tp_info;
-  if (use_global_threadpool_) {
+  const int numa_node = attributes.locality().numa_node() - 1;
+  if (numa_node != EigenThreadPoolInfo::kNoNUMANode &&
+      use_global_threadpool_) {
+    // All devices bound to the same NUMA node share one threadpool pinned
+    // to that node.
+    static mutex* mu = new mutex;
+    static std::vector<LocalDevice::EigenThreadPoolInfo*>* numa_tp_infos =
+        new std::vector<LocalDevice::EigenThreadPoolInfo*>;
+    mutex_lock l(*mu);
+    if (numa_tp_infos->size() <= static_cast<size_t>(numa_node)) {
+      numa_tp_infos->resize(numa_node + 1, nullptr);
+    }
+    if ((*numa_tp_infos)[numa_node] == nullptr) {
+      (*numa_tp_infos)[numa_node] =
+          new LocalDevice::EigenThreadPoolInfo(options, numa_node);
+    }
+    tp_info = (*numa_tp_infos)[numa_node];
+  } else if (use_global_threadpool_) {
     // All ThreadPoolDevices in the process will use this single fixed
     // sized threadpool for numerical computations.
     static LocalDevice::EigenThreadPoolInfo* global_tp_info =
-        new LocalDevice::EigenThreadPoolInfo(options);
+        new LocalDevice::EigenThreadPoolInfo(options,
+                                             EigenThreadPoolInfo::kNoNUMANode);
     tp_info = global_tp_info;
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
     // computations.
-    owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(options));
+    owned_tp_info_.reset(
+        new LocalDevice::EigenThreadPoolInfo(options, numa_node));
     tp_info = owned_tp_info_.get();
   }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
@@ -89,7 +89,23 @@ class PendingCounts {
     memcpy(bytes_, other.bytes_, other.num_bytes_);
   }
 
-  ~PendingCounts() { delete[] bytes_; }
+  // Create a new PendingCounts object with the same layout and counts
+  // as "other", whose state is kept in "storage". "storage" must hold
+  // other.num_bytes() bytes, be aligned to kStorageAlignment, and outlive
+  // the new object.
+  PendingCounts(const PendingCounts& other, char* storage)
+      : num_bytes_(other.num_bytes_), bytes_(storage), owns_bytes_(false) {
+    CHECK_EQ(uintptr_t(bytes_) % alignof(LargeCounts), 0);
+    memcpy(bytes_, other.bytes_, other.num_bytes_);
+  }
+
+  ~PendingCounts() {
+    if (owns_bytes_) delete[] bytes_;
+  }
+
+  // The number of bytes of state, and the alignment it requires.
+  int num_bytes() const { return num_bytes_; }
+  static constexpr size_t kStorageAlignment = 8;
 
   void set_initial_count(Handle h, size_t pending_count) {
     if (h.is_large_) {
@@ -301,6 +317,7 @@ class PendingCounts {
 
   const int num_bytes_;  // Just for bounds checking in debug mode
   char* bytes_;          // Array of num_bytes_ bytes
+  bool owns_bytes_ = true;
 
   void operator=(const PendingCounts&) = delete;
 };
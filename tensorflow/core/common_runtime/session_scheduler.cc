@@ -0,0 +1,167 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/session_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+struct SessionScheduler::ClientState {
+  ClientState(int32 weight, int32 max_concurrency)
+      : step(1.0 / std::max(weight, 1)),
+        max_concurrency(std::max(max_concurrency, 0)) {}
+
+  // How far the client's virtual time advances per closure.
+  const double step;
+  // 0 means unlimited.
+  const int max_concurrency;
+
+  std::deque<std::function<void()>> queue;
+  int num_running = 0;
+  // The virtual start time of the client's next closure.
+  double virtual_time = 0;
+  // Set once the Client handle is gone; the state is dropped from the
+  // scheduler when its queue drains.
+  bool removed = false;
+};
+
+SessionScheduler::SessionScheduler(thread::ThreadPool* workers,
+                                   int max_running)
+    : workers_(workers),
+      max_running_(max_running > 0 ? max_running : workers->NumThreads()) {}
+
+SessionScheduler::~SessionScheduler() {
+  mutex_lock l(mu_);
+  for (const std::shared_ptr<ClientState>& client : clients_) {
+    CHECK(client->removed) << "SessionScheduler destroyed with live clients";
+  }
+  while (num_running_ > 0 || !clients_.empty()) {
+    idle_.wait(l);
+  }
+}
+
+/* static */
+SessionScheduler* SessionScheduler::Global(thread::ThreadPool* workers) {
+  static SessionScheduler* scheduler = new SessionScheduler(workers, 0);
+  return scheduler;
+}
+
+SessionScheduler::Client::Client(SessionScheduler* scheduler,
+                                 std::shared_ptr<ClientState> state)
+    : scheduler_(scheduler), state_(std::move(state)) {}
+
+SessionScheduler::Client::~Client() { scheduler_->RemoveClient(state_); }
+
+void SessionScheduler::Client::Schedule(std::function<void()> fn) {
+  scheduler_->Schedule(state_, std::move(fn));
+}
+
+std::unique_ptr<SessionScheduler::Client> SessionScheduler::NewClient(
+    int32 weight, int32 max_concurrency) {
+  std::shared_ptr<ClientState> state =
+      std::make_shared<ClientState>(weight, max_concurrency);
+  {
+    mutex_lock l(mu_);
+    clients_.push_back(state);
+  }
+  return std::unique_ptr<Client>(new Client(this, std::move(state)));
+}
+
+void SessionScheduler::RemoveClient(
+    const std::shared_ptr<ClientState>& client) {
+  mutex_lock l(mu_);
+  client->removed = true;
+  if (client->queue.empty()) {
+    clients_.erase(std::find(clients_.begin(), clients_.end(), client));
+  }
+}
+
+void SessionScheduler::Schedule(const std::shared_ptr<ClientState>& client,
+                                std::function<void()> fn) {
+  std::vector<Task> tasks;
+  {
+    mutex_lock l(mu_);
+    if (client->queue.empty() && client->num_running == 0) {
+      // A client that has been idle starts level with the others, rather
+      // than with the credit of the time it wasn't asking for anything.
+      client->virtual_time = std::max(client->virtual_time, virtual_time_);
+    }
+    client->queue.push_back(std::move(fn));
+    DispatchLocked(&tasks);
+  }
+  for (Task& task : tasks) {
+    workers_->Schedule([this, task]() { Run(task); });
+  }
+}
+
+void SessionScheduler::DispatchLocked(std::vector<Task>* tasks) {
+  while (num_running_ < max_running_) {
+    size_t next = clients_.size();
+    for (size_t i = 0; i < clients_.size(); ++i) {
+      const ClientState& client = *clients_[i];
+      if (client.queue.empty() ||
+          (client.max_concurrency > 0 &&
+           client.num_running >= client.max_concurrency)) {
+        continue;
+      }
+      if (next == clients_.size() ||
+          client.virtual_time < clients_[next]->virtual_time) {
+        next = i;
+      }
+    }
+    if (next == clients_.size()) return;
+
+    ClientState* client = clients_[next].get();
+    tasks->push_back({clients_[next], std::move(client->queue.front())});
+    client->queue.pop_front();
+    ++client->num_running;
+    ++num_running_;
+    virtual_time_ = client->virtual_time;
+    client->virtual_time += client->step;
+    if (client->removed && client->queue.empty()) {
+      clients_.erase(clients_.begin() + next);
+    }
+  }
+}
+
+void SessionScheduler::Run(Task task) {
+  while (true) {
+    task.fn();
+    task.fn = nullptr;
+
+    std::vector<Task> tasks;
+    {
+      mutex_lock l(mu_);
+      --task.client->num_running;
+      --num_running_;
+      DispatchLocked(&tasks);
+      if (num_running_ == 0) idle_.notify_all();
+    }
+    if (tasks.empty()) return;
+    // Usually only the slot of this closure was freed, so its successor
+    // runs on this thread without a round trip through the pool.
+    for (size_t i = 1; i < tasks.size(); ++i) {
+      const Task& next = tasks[i];
+      workers_->Schedule([this, next]() { Run(next); });
+    }
+    task = std::move(tasks[0]);
+  }
+}
+
+}  // namespace tensorflow
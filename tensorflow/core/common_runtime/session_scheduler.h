@@ -0,0 +1,129 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_SESSION_SCHEDULER_H_
+#define TENSORFLOW_COMMON_RUNTIME_SESSION_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// SessionScheduler shares one pool of inter-op threads between the
+// sessions of a process, so that a server hosting many models runs a
+// bounded number of kernels at once instead of one thread pool's worth
+// per session.
+//
+// Each session registers as a client with a weight and an optional limit
+// on the number of its closures that may run at the same time. At most
+// "max_running" closures run on the workers at once; the rest wait in
+// per-client queues. Whenever a worker frees up, it takes the next closure
+// of the eligible client that has had the least service relative to its
+// weight (start-time fair queueing), so under contention a client of
+// weight 2 gets twice the kernel launches of a client of weight 1, and an
+// idle client does not build up credit while it isn't running anything.
+//
+// A kernel that blocks (e.g. a dequeue from an empty queue) holds its slot
+// until it returns, so a client whose kernels wait on each other needs a
+// max_concurrency of 0 (unlimited) or large enough for them not to
+// deadlock.
+//
+// This class is thread-safe.
+class SessionScheduler {
+ private:
+  struct ClientState;
+
+ public:
+  // "workers" is not owned and must outlive the scheduler. If
+  // "max_running" is 0, it is the number of threads of "workers".
+  SessionScheduler(thread::ThreadPool* workers, int max_running);
+
+  // Waits for the closures that are still queued or running.
+  // REQUIRES: All the clients have been destroyed.
+  ~SessionScheduler();
+
+  // Returns the process-wide scheduler, which runs on "workers". Only the
+  // "workers" of the first call are used.
+  static SessionScheduler* Global(thread::ThreadPool* workers);
+
+  // The handle through which one session schedules its closures.
+  class Client {
+   public:
+    // Closures that are still queued run before the client goes away.
+    ~Client();
+
+    // Runs "fn" on one of the workers, once the client's turn comes.
+    void Schedule(std::function<void()> fn);
+
+   private:
+    friend class SessionScheduler;
+    Client(SessionScheduler* scheduler, std::shared_ptr<ClientState> state);
+
+    SessionScheduler* const scheduler_;
+    const std::shared_ptr<ClientState> state_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(Client);
+  };
+
+  // Registers a new client. A "weight" of 0 or less is taken as 1. If
+  // "max_concurrency" is 0 or less, the client may use all the slots.
+  std::unique_ptr<Client> NewClient(int32 weight, int32 max_concurrency);
+
+  // Returns the number of closures that may run at once.
+  int max_running() const { return max_running_; }
+
+ private:
+  struct Task {
+    std::shared_ptr<ClientState> client;
+    std::function<void()> fn;
+  };
+
+  void Schedule(const std::shared_ptr<ClientState>& client,
+                std::function<void()> fn);
+  void RemoveClient(const std::shared_ptr<ClientState>& client);
+
+  // Moves the next closures allowed to run from the client queues to
+  // "tasks".
+  void DispatchLocked(std::vector<Task>* tasks) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Runs "task" and then, instead of handing the freed slot back to the
+  // pool, any closure that was dispatched into it.
+  void Run(Task task);
+
+  thread::ThreadPool* const workers_;
+  const int max_running_;
+
+  mutex mu_;
+  std::vector<std::shared_ptr<ClientState>> clients_ GUARDED_BY(mu_);
+  int num_running_ GUARDED_BY(mu_) = 0;
+  // Notified when the last running closure finishes.
+  condition_variable idle_;
+  // The virtual start time of the last closure to be dispatched.
+  double virtual_time_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SessionScheduler);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_SESSION_SCHEDULER_H_
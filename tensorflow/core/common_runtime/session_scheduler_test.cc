@@ -0,0 +1,179 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/session_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SessionSchedulerTest, RunsEverything) {
+  thread::ThreadPool workers(Env::Default(), "test", 4);
+  SessionScheduler scheduler(&workers, 0);
+  EXPECT_EQ(4, scheduler.max_running());
+
+  const int kClients = 5;
+  const int kClosures = 200;
+  std::atomic<int> count(0);
+  BlockingCounter done(kClients * kClosures);
+  std::vector<std::unique_ptr<SessionScheduler::Client>> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.push_back(scheduler.NewClient(i + 1, 0));
+  }
+  for (int j = 0; j < kClosures; ++j) {
+    for (auto& client : clients) {
+      client->Schedule([&count, &done]() {
+        ++count;
+        done.DecrementCount();
+      });
+    }
+  }
+  done.Wait();
+  EXPECT_EQ(kClients * kClosures, count);
+}
+
+TEST(SessionSchedulerTest, NestedSchedule) {
+  thread::ThreadPool workers(Env::Default(), "test", 2);
+  SessionScheduler scheduler(&workers, 1);
+  std::unique_ptr<SessionScheduler::Client> client =
+      scheduler.NewClient(1, 0);
+
+  // Closures that schedule more closures, as an executor does.
+  const int kDepth = 100;
+  Notification done;
+  std::function<void(int)> step = [&](int depth) {
+    if (depth == kDepth) {
+      done.Notify();
+      return;
+    }
+    client->Schedule([&step, depth]() { step(depth + 1); });
+  };
+  step(0);
+  done.WaitForNotification();
+}
+
+TEST(SessionSchedulerTest, MaxConcurrency) {
+  thread::ThreadPool workers(Env::Default(), "test", 8);
+  SessionScheduler scheduler(&workers, 0);
+  std::unique_ptr<SessionScheduler::Client> client =
+      scheduler.NewClient(1, 2);
+
+  mutex mu;
+  int running = 0;
+  int max_seen = 0;
+  const int kClosures = 50;
+  BlockingCounter done(kClosures);
+  for (int i = 0; i < kClosures; ++i) {
+    client->Schedule([&]() {
+      {
+        mutex_lock l(mu);
+        ++running;
+        max_seen = std::max(max_seen, running);
+      }
+      Env::Default()->SleepForMicroseconds(1000);
+      {
+        mutex_lock l(mu);
+        --running;
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  EXPECT_LE(max_seen, 2);
+  EXPECT_GE(max_seen, 1);
+}
+
+TEST(SessionSchedulerTest, Weights) {
+  thread::ThreadPool workers(Env::Default(), "test", 1);
+  SessionScheduler scheduler(&workers, 1);
+  std::unique_ptr<SessionScheduler::Client> heavy = scheduler.NewClient(3, 0);
+  std::unique_ptr<SessionScheduler::Client> light = scheduler.NewClient(1, 0);
+
+  // Hold the only slot while both clients queue up their closures.
+  Notification start;
+  BlockingCounter blocked(1);
+  light->Schedule([&]() {
+    blocked.DecrementCount();
+    start.WaitForNotification();
+  });
+  blocked.Wait();
+
+  mutex mu;
+  std::vector<int> order;
+  const int kClosures = 40;
+  BlockingCounter done(2 * kClosures);
+  for (int i = 0; i < kClosures; ++i) {
+    heavy->Schedule([&]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(0);
+      }
+      done.DecrementCount();
+    });
+    light->Schedule([&]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(1);
+      }
+      done.DecrementCount();
+    });
+  }
+  start.Notify();
+  done.Wait();
+
+  // While both have work queued, the heavy client gets three turns for every
+  // one of the light client.
+  ASSERT_EQ(2 * kClosures, order.size());
+  const int heavy_turns = std::count(order.begin(), order.begin() + 40, 0);
+  EXPECT_GE(heavy_turns, 28);
+  EXPECT_LE(heavy_turns, 32);
+}
+
+TEST(SessionSchedulerTest, ClientDestroyedWithQueuedWork) {
+  thread::ThreadPool workers(Env::Default(), "test", 1);
+  SessionScheduler scheduler(&workers, 1);
+  std::unique_ptr<SessionScheduler::Client> client =
+      scheduler.NewClient(1, 0);
+
+  Notification start;
+  std::atomic<int> count(0);
+  BlockingCounter done(11);
+  client->Schedule([&]() {
+    start.WaitForNotification();
+    done.DecrementCount();
+  });
+  for (int i = 0; i < 10; ++i) {
+    client->Schedule([&]() {
+      ++count;
+      done.DecrementCount();
+    });
+  }
+  client.reset();
+  start.Notify();
+  done.Wait();
+  EXPECT_EQ(10, count);
+}
+
+}  // namespace
+}  // namespace tensorflow
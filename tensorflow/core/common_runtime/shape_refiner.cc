@@ -212,6 +212,35 @@ Status ShapeRefiner::EvaluateConstantTensorForEdge(const Node* node,
   *evaluated = false;
   const Edge* input_edge;
   TF_RETURN_IF_ERROR(node->input_edge(dst_idx, &input_edge));
+  const Node* src = input_edge->src();
+  const string output_tensor_name =
+      strings::StrCat(src->name(), ":", input_edge->src_output());
+
+  // Shape functions commonly request the same constant tensor more than once
+  // (e.g. every Reshape fed by one shape constant), so return the memoized
+  // value before building and running a subgraph. Only successful
+  // evaluations are memoized: setting shapes later may make a tensor that
+  // could not be evaluated constant.
+  auto it = const_tensor_map_.find(output_tensor_name);
+  if (it != const_tensor_map_.end()) {
+    *result = it->second;
+    *evaluated = true;
+    return Status::OK();
+  }
+
+  // The value of a Const is in its attributes; running it through the
+  // GraphRunner would only copy it.
+  if (src->IsConstant()) {
+    const TensorProto* proto = nullptr;
+    TF_RETURN_IF_ERROR(GetNodeAttr(src->def(), "value", &proto));
+    if (result->FromProto(*proto)) {
+      *evaluated = true;
+      if (result->TotalBytes() <= kMaxTensorSize) {
+        const_tensor_map_[output_tensor_name] = *result;
+      }
+    }
+    return Status::OK();
+  }
 
   bool is_constant_graph = false;
   Graph subgraph(ops_registry_);
@@ -230,8 +259,6 @@ Status ShapeRefiner::EvaluateConstantTensorForEdge(const Node* node,
   if (!is_constant_graph) {
     return Status::OK();
   }
-  const string output_tensor_name =
-      strings::StrCat(input_edge->src()->name(), ":", input_edge->src_output());
   std::vector<Tensor> outputs;
   // NOTE; we should pass in a function library runtime if we want
   // to support constant-expression evaluation on functions.
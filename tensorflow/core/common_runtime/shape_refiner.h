@@ -144,6 +144,9 @@ class ShapeRefiner {
   // cache to avoid consuming too much memory, if that eventually
   // becomes a concern.
   //
+  // Consulted before evaluating any edge, and for the inputs of the
+  // subgraphs that still need to be evaluated.
+  //
   // Only tensors less than 1KiB are currently stored in the cache.
   static constexpr int64 kMaxTensorSize = 1024;
   std::unordered_map<string, Tensor> const_tensor_map_;
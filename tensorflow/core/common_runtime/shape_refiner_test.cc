@@ -761,6 +761,48 @@ TEST(ShapeRefinerTest, ConstantValueAsShape_Shape) {
   }
 }
 
+TEST(ShapeRefinerTest, ConstantValueAsShape_SharedByConsumers) {
+  Scope root = Scope::NewRootScope();
+  // A Const small enough to be memoized, one too large to be, and a computed
+  // shape, each requested by two consumers.
+  auto small = ops::Const(root, {2, 3});
+  Tensor large_value(DT_INT32, TensorShape({300}));
+  large_value.flat<int32>().setConstant(1);
+  auto large = ops::Const(root, large_value);
+  auto sum = ops::Add(root, small, small);
+
+  std::vector<Node*> results;
+  for (const Output& shape : {small, small, large, large, sum, sum}) {
+    Node* result;
+    TF_ASSERT_OK(NodeBuilder(root.graph()->NewName("test"),
+                             "TensorAsShapeInt32")
+                     .Input(shape.node())
+                     .Finalize(root.graph(), &result));
+    results.push_back(result);
+  }
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+  TF_ASSERT_OK(m.AddNode(small.node()));
+  TF_ASSERT_OK(m.AddNode(large.node()));
+  TF_ASSERT_OK(m.AddNode(sum.node()));
+  for (Node* result : results) {
+    TF_ASSERT_OK(m.AddNode(result));
+  }
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    shape_inference::InferenceContext* ctx = m.GetContext(results[i]);
+    const int kind = i / 2;
+    if (kind == 0) {
+      EXPECT_EQ("[2,3]", ctx->DebugString(ctx->output(0)));
+    } else if (kind == 1) {
+      EXPECT_EQ(300, ctx->Rank(ctx->output(0)));
+      EXPECT_EQ(1, ctx->Value(ctx->Dim(ctx->output(0), 299)));
+    } else {
+      EXPECT_EQ("[4,6]", ctx->DebugString(ctx->output(0)));
+    }
+  }
+}
+
 TEST(ShapeRefinerTest, ConstantValueAsShape_PackInt32) {
   Scope root = Scope::NewRootScope();
   Node* scalar_non_const;
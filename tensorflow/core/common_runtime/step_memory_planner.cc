@@ -0,0 +1,262 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundedBytes(size_t bytes) {
+  const size_t align = Allocator::kAllocatorAlignment;
+  return (bytes + align - 1) / align * align;
+}
+
+}  // namespace
+
+// The allocator handed to the kernels of one node.
+class StepMemoryPlanner::NodeAllocator : public Allocator {
+ public:
+  NodeAllocator(StepMemoryPlanner* planner, int id)
+      : planner_(planner), id_(id) {}
+
+  string Name() override { return planner_->device_allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return planner_->Allocate(id_, alignment, num_bytes,
+                              AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    return planner_->Allocate(id_, alignment, num_bytes, allocation_attr);
+  }
+
+  void DeallocateRaw(void* ptr) override { planner_->Deallocate(ptr); }
+
+ private:
+  StepMemoryPlanner* const planner_;  // Not owned.
+  const int id_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(NodeAllocator);
+};
+
+StepMemoryPlanner::StepMemoryPlanner(Allocator* device_allocator,
+                                     int num_nodes)
+    : device_allocator_(device_allocator) {
+  node_allocators_.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    node_allocators_.emplace_back(new NodeAllocator(this, i));
+  }
+}
+
+Allocator* StepMemoryPlanner::node_allocator(int id) const {
+  return node_allocators_[id].get();
+}
+
+StepMemoryPlanner::~StepMemoryPlanner() {
+  // Every allocation from the slab holds a reference, so none is live.
+  if (slab_ != nullptr) {
+    device_allocator_->DeallocateRaw(slab_);
+  }
+}
+
+void* StepMemoryPlanner::Allocate(int id, size_t alignment, size_t num_bytes,
+                                  const AllocationAttributes& allocation_attr) {
+  const size_t bytes = RoundedBytes(num_bytes);
+  if (num_bytes > 0 && alignment <= Allocator::kAllocatorAlignment) {
+    mutex_lock l(mu_);
+    if (state_ == kPlanned) {
+      for (int b : node_buffers_[id]) {
+        if (CanUse(b, bytes)) {
+          in_use_[b] = true;
+          void* ptr = slab_ + buffers_[b].offset;
+          planned_live_[ptr] = b;
+          ++stats_.num_planned_allocs;
+          Ref();
+          return ptr;
+        }
+      }
+    }
+  }
+
+  void* ptr =
+      device_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  {
+    mutex_lock l(mu_);
+    if (state_ == kRecording) {
+      Buffer r;
+      r.node_id = id;
+      r.bytes = bytes;
+      r.start = clock_++;
+      r.end = -1;
+      recorded_live_[ptr] = recorded_.size();
+      recorded_.push_back(r);
+    } else {
+      ++stats_.num_fallback_allocs;
+    }
+  }
+  Ref();
+  return ptr;
+}
+
+void StepMemoryPlanner::Deallocate(void* ptr) {
+  bool planned = false;
+  {
+    mutex_lock l(mu_);
+    auto it = planned_live_.find(ptr);
+    if (it != planned_live_.end()) {
+      in_use_[it->second] = false;
+      planned_live_.erase(it);
+      planned = true;
+    } else if (state_ == kRecording) {
+      auto rit = recorded_live_.find(ptr);
+      if (rit != recorded_live_.end()) {
+        recorded_[rit->second].end = clock_++;
+        recorded_live_.erase(rit);
+      }
+    }
+  }
+  if (!planned) {
+    device_allocator_->DeallocateRaw(ptr);
+  }
+  // May delete this.
+  Unref();
+}
+
+bool StepMemoryPlanner::CanUse(int b, size_t bytes) const {
+  if (in_use_[b] || buffers_[b].bytes < bytes) {
+    return false;
+  }
+  for (int o : overlaps_[b]) {
+    if (in_use_[o]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StepMemoryPlanner::StepDone() {
+  mutex_lock l(mu_);
+  if (state_ == kRecording) {
+    BuildPlan();
+  }
+}
+
+void StepMemoryPlanner::BuildPlan() {
+  // Only buffers that were freed during the recorded step take part.
+  for (const Buffer& r : recorded_) {
+    if (r.end >= 0 && r.bytes > 0) {
+      buffers_.push_back(r);
+    }
+  }
+  recorded_.clear();
+  recorded_live_.clear();
+
+  // Place the buffers in decreasing size order, each at the lowest offset
+  // that does not collide with an already placed buffer whose lifetime
+  // overlaps its own.
+  const int num_buffers = buffers_.size();
+  std::vector<int> order(num_buffers);
+  for (int i = 0; i < num_buffers; ++i) {
+    order[i] = i;
+  }
+  const std::vector<Buffer>& buffers = buffers_;
+  std::sort(order.begin(), order.end(), [&buffers](int a, int b) {
+    if (buffers[a].bytes != buffers[b].bytes) {
+      return buffers[a].bytes > buffers[b].bytes;
+    }
+    return buffers[a].start < buffers[b].start;
+  });
+  size_t slab_bytes = 0;
+  std::vector<int> placed;
+  std::vector<std::pair<size_t, size_t>> busy;
+  for (int b : order) {
+    Buffer* buf = &buffers_[b];
+    busy.clear();
+    for (int p : placed) {
+      const Buffer& other = buffers_[p];
+      if (other.start < buf->end && buf->start < other.end) {
+        busy.emplace_back(other.offset, other.offset + other.bytes);
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    size_t offset = 0;
+    for (const auto& range : busy) {
+      if (range.first >= offset + buf->bytes) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    buf->offset = offset;
+    slab_bytes = std::max(slab_bytes, offset + buf->bytes);
+    placed.push_back(b);
+  }
+
+  if (slab_bytes == 0) {
+    VLOG(1) << "No step-local allocations to plan";
+    state_ = kDisabled;
+    return;
+  }
+  slab_ = static_cast<char*>(device_allocator_->AllocateRaw(
+      Allocator::kAllocatorAlignment, slab_bytes));
+  if (slab_ == nullptr) {
+    LOG(WARNING) << "Could not allocate a planned step memory slab of "
+                 << strings::HumanReadableNumBytes(slab_bytes)
+                 << "; falling back to per-tensor allocation.";
+    buffers_.clear();
+    state_ = kDisabled;
+    return;
+  }
+
+  node_buffers_.resize(node_allocators_.size());
+  overlaps_.resize(num_buffers);
+  in_use_.assign(num_buffers, false);
+  size_t recorded_bytes = 0;
+  for (int i = 0; i < num_buffers; ++i) {
+    const Buffer& a = buffers_[i];
+    recorded_bytes += a.bytes;
+    node_buffers_[a.node_id].push_back(i);
+    for (int j = i + 1; j < num_buffers; ++j) {
+      const Buffer& b = buffers_[j];
+      if (a.offset < b.offset + b.bytes && b.offset < a.offset + a.bytes) {
+        overlaps_[i].push_back(j);
+        overlaps_[j].push_back(i);
+      }
+    }
+  }
+  stats_.num_planned_buffers = num_buffers;
+  stats_.slab_bytes = slab_bytes;
+  state_ = kPlanned;
+  VLOG(1) << "Planned " << num_buffers << " step-local buffers totalling "
+          << strings::HumanReadableNumBytes(recorded_bytes) << " into a slab of "
+          << strings::HumanReadableNumBytes(slab_bytes);
+}
+
+StepMemoryPlanner::Stats StepMemoryPlanner::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+}  // end namespace tensorflow
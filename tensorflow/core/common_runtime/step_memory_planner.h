@@ -0,0 +1,130 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
+#define TENSORFLOW_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// StepMemoryPlanner learns the allocation pattern of the steps of one
+// executor and serves later steps out of a single preallocated slab.
+//
+// During the first step, nodes allocate from the device allocator while
+// the planner records the size of each allocation and when it was
+// allocated and freed relative to all the others. When the step ends,
+// the allocations that were freed within the step are packed into one
+// slab, greedily in decreasing size order, so that buffers whose recorded
+// lifetimes overlap never share memory. Allocations that outlived the
+// step (fetched outputs, persistent state) keep using the device
+// allocator.
+//
+// Later steps may run nodes in a different order than the recorded one,
+// so the plan is only a hint: a node gets one of its planned buffers only
+// if no buffer overlapping it in the slab is currently in use, and falls
+// back to the device allocator otherwise.
+//
+// This class is thread-safe.
+class StepMemoryPlanner : public core::RefCounted {
+ public:
+  // "device_allocator" is not owned and must outlive the planner.
+  StepMemoryPlanner(Allocator* device_allocator, int num_nodes);
+
+  // Returns the allocator through which node "id" makes its allocations
+  // with default attributes. Every live allocation holds a reference on
+  // the planner, so the returned allocator outlives all of them.
+  Allocator* node_allocator(int id) const;
+
+  // Called when a step ends. The first call builds the plan.
+  void StepDone();
+
+  struct Stats {
+    // Allocations served from, and not from, the slab since the plan was
+    // built.
+    int64 num_planned_allocs = 0;
+    int64 num_fallback_allocs = 0;
+    // The number of buffers in the plan and the size of the slab.
+    int64 num_planned_buffers = 0;
+    int64 slab_bytes = 0;
+  };
+  Stats GetStats();
+
+ private:
+  class NodeAllocator;
+
+  ~StepMemoryPlanner() override;
+
+  void* Allocate(int id, size_t alignment, size_t num_bytes,
+                 const AllocationAttributes& allocation_attr);
+  void Deallocate(void* ptr);
+
+  // Packs the recorded allocations into the slab.
+  void BuildPlan() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns true iff buffer "b" can hold "bytes" and no buffer sharing its
+  // memory is in use.
+  bool CanUse(int b, size_t bytes) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  enum State { kRecording, kPlanned, kDisabled };
+
+  struct Buffer {
+    int node_id = -1;
+    size_t bytes = 0;
+    // Logical times at which the buffer was allocated and freed.
+    int64 start = 0;
+    int64 end = 0;
+    size_t offset = 0;
+  };
+
+  Allocator* const device_allocator_;
+  std::vector<std::unique_ptr<NodeAllocator>> node_allocators_;
+
+  mutex mu_;
+  State state_ GUARDED_BY(mu_) = kRecording;
+
+  // Recording state. "clock_" orders all allocation and free events.
+  int64 clock_ GUARDED_BY(mu_) = 0;
+  std::vector<Buffer> recorded_ GUARDED_BY(mu_);
+  std::unordered_map<void*, int> recorded_live_ GUARDED_BY(mu_);
+
+  // The plan.
+  char* slab_ GUARDED_BY(mu_) = nullptr;
+  std::vector<Buffer> buffers_ GUARDED_BY(mu_);
+  // node_buffers_[id] are the indices of the buffers planned for node id.
+  std::vector<std::vector<int>> node_buffers_ GUARDED_BY(mu_);
+  // overlaps_[b] are the indices of the other buffers sharing memory with b.
+  std::vector<std::vector<int>> overlaps_ GUARDED_BY(mu_);
+  std::vector<bool> in_use_ GUARDED_BY(mu_);
+  // Maps a live pointer into the slab to its buffer.
+  std::unordered_map<void*, int> planned_live_ GUARDED_BY(mu_);
+
+  Stats stats_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepMemoryPlanner);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
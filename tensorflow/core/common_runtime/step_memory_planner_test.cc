@@ -0,0 +1,107 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const size_t kAlign = Allocator::kAllocatorAlignment;
+
+TEST(StepMemoryPlannerTest, SharesBuffersWithDisjointLifetimes) {
+  StepMemoryPlanner* planner = new StepMemoryPlanner(cpu_allocator(), 3);
+  Allocator* n0 = planner->node_allocator(0);
+  Allocator* n1 = planner->node_allocator(1);
+  Allocator* n2 = planner->node_allocator(2);
+
+  // Recorded step: a and c are never live at the same time, b overlaps
+  // both.
+  void* a = n0->AllocateRaw(kAlign, 1024);
+  void* b = n1->AllocateRaw(kAlign, 1024);
+  n0->DeallocateRaw(a);
+  void* c = n2->AllocateRaw(kAlign, 1000);
+  n1->DeallocateRaw(b);
+  n2->DeallocateRaw(c);
+  planner->StepDone();
+
+  StepMemoryPlanner::Stats stats = planner->GetStats();
+  EXPECT_EQ(3, stats.num_planned_buffers);
+  EXPECT_EQ(2048, stats.slab_bytes);
+
+  // The same step again is served entirely from the slab.
+  a = n0->AllocateRaw(kAlign, 1024);
+  b = n1->AllocateRaw(kAlign, 1024);
+  EXPECT_NE(a, b);
+  n0->DeallocateRaw(a);
+  c = n2->AllocateRaw(kAlign, 1000);
+  EXPECT_EQ(a, c);
+  n1->DeallocateRaw(b);
+  n2->DeallocateRaw(c);
+  stats = planner->GetStats();
+  EXPECT_EQ(3, stats.num_planned_allocs);
+  EXPECT_EQ(0, stats.num_fallback_allocs);
+
+  // A different order that would make a and c collide falls back.
+  a = n0->AllocateRaw(kAlign, 1024);
+  c = n2->AllocateRaw(kAlign, 1000);
+  EXPECT_NE(a, c);
+  // So does a request larger than the planned buffer.
+  b = n1->AllocateRaw(kAlign, 4096);
+  stats = planner->GetStats();
+  EXPECT_EQ(4, stats.num_planned_allocs);
+  EXPECT_EQ(2, stats.num_fallback_allocs);
+  n0->DeallocateRaw(a);
+  n1->DeallocateRaw(b);
+  n2->DeallocateRaw(c);
+
+  planner->Unref();
+}
+
+TEST(StepMemoryPlannerTest, AllocationsOutlivingTheStepAreNotPlanned) {
+  StepMemoryPlanner* planner = new StepMemoryPlanner(cpu_allocator(), 2);
+  Allocator* n0 = planner->node_allocator(0);
+  Allocator* n1 = planner->node_allocator(1);
+
+  void* temp = n0->AllocateRaw(kAlign, 256);
+  void* fetched = n1->AllocateRaw(kAlign, 512);
+  n0->DeallocateRaw(temp);
+  planner->StepDone();
+  n1->DeallocateRaw(fetched);
+
+  StepMemoryPlanner::Stats stats = planner->GetStats();
+  EXPECT_EQ(1, stats.num_planned_buffers);
+  EXPECT_EQ(256, stats.slab_bytes);
+  planner->Unref();
+}
+
+TEST(StepMemoryPlannerTest, LiveAllocationsKeepThePlannerAlive) {
+  StepMemoryPlanner* planner = new StepMemoryPlanner(cpu_allocator(), 1);
+  Allocator* n0 = planner->node_allocator(0);
+  n0->DeallocateRaw(n0->AllocateRaw(kAlign, 64));
+  planner->StepDone();
+
+  void* planned = n0->AllocateRaw(kAlign, 64);
+  void* fallback = n0->AllocateRaw(kAlign, 64);
+  planner->Unref();
+  // Both deallocations must still reach the planner and the slab.
+  n0->DeallocateRaw(fallback);
+  n0->DeallocateRaw(planned);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2015 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_stats_aggregator.h"
+
+#include <algorithm>
+
+namespace tensorflow {
+
+void StepStatsAggregator::Add(const StepStats& step_stats) {
+  mutex_lock l(mu_);
+  ++num_steps_;
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      NodeTotals& totals =
+          nodes_[std::make_pair(dev_stats.device(), node_stats.node_name())];
+      ++totals.count;
+      totals.op_start_rel_micros += node_stats.op_start_rel_micros();
+      totals.op_micros +=
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      totals.all_end_rel_micros += node_stats.all_end_rel_micros();
+      for (const AllocatorMemoryUsed& used : node_stats.memory()) {
+        MemoryTotals& memory = totals.memory[used.allocator_name()];
+        memory.total_bytes += used.total_bytes();
+        memory.peak_bytes += used.peak_bytes();
+      }
+    }
+  }
+}
+
+int64 StepStatsAggregator::GetProfile(StepStats* profile) const {
+  mutex_lock l(mu_);
+  GetProfileLocked(profile);
+  return num_steps_;
+}
+
+void StepStatsAggregator::Clear() {
+  mutex_lock l(mu_);
+  nodes_.clear();
+  num_steps_ = 0;
+}
+
+int64 StepStatsAggregator::TakeProfile(StepStats* profile) {
+  mutex_lock l(mu_);
+  GetProfileLocked(profile);
+  const int64 num_steps = num_steps_;
+  nodes_.clear();
+  num_steps_ = 0;
+  return num_steps;
+}
+
+void StepStatsAggregator::GetProfileLocked(StepStats* profile) const {
+  profile->Clear();
+  DeviceStepStats* dev_stats = nullptr;
+  for (const auto& entry : nodes_) {
+    const string& device = entry.first.first;
+    const NodeTotals& totals = entry.second;
+    if (dev_stats == nullptr || dev_stats->device() != device) {
+      dev_stats = profile->add_dev_stats();
+      dev_stats->set_device(device);
+    }
+    NodeExecStats* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name(entry.first.second);
+    const int64 op_start_rel_micros = totals.op_start_rel_micros / totals.count;
+    node_stats->set_op_start_rel_micros(op_start_rel_micros);
+    node_stats->set_op_end_rel_micros(op_start_rel_micros +
+                                      totals.op_micros / totals.count);
+    node_stats->set_all_end_rel_micros(
+        std::max<int64>(node_stats->op_end_rel_micros(),
+                        totals.all_end_rel_micros / totals.count));
+    for (const auto& allocator_and_memory : totals.memory) {
+      AllocatorMemoryUsed* used = node_stats->add_memory();
+      used->set_allocator_name(allocator_and_memory.first);
+      used->set_total_bytes(allocator_and_memory.second.total_bytes /
+                            totals.count);
+      used->set_peak_bytes(allocator_and_memory.second.peak_bytes /
+                           totals.count);
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2015 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_AGGREGATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_AGGREGATOR_H_
+
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// StepStatsAggregator folds the StepStats of many traced steps into a single
+// profile: for every node on every device, the average time it started at and
+// ran for and the average memory it allocated, over the steps that ran it.
+// Tracing only a sample of the steps and aggregating them keeps an up-to-date
+// profile at a fraction of the cost of tracing every step.
+//
+// The profile is itself a StepStats, with one NodeExecStats per node, so it
+// can be put in a RunMetadata and analyzed with tfprof like a single traced
+// step.
+//
+// Thread-safe.
+class StepStatsAggregator {
+ public:
+  StepStatsAggregator() {}
+
+  // Adds the nodes of a traced step to the profile.
+  void Add(const StepStats& step_stats);
+
+  // Writes the profile of the steps added since the last Clear() to
+  // *profile, and returns the number of those steps.
+  int64 GetProfile(StepStats* profile) const;
+
+  // Discards the steps added so far.
+  void Clear();
+
+  // GetProfile() followed by Clear(), without losing the steps added in
+  // between.
+  int64 TakeProfile(StepStats* profile);
+
+ private:
+  struct MemoryTotals {
+    int64 total_bytes = 0;
+    int64 peak_bytes = 0;
+  };
+
+  struct NodeTotals {
+    int64 count = 0;
+    int64 op_start_rel_micros = 0;
+    int64 op_micros = 0;
+    int64 all_end_rel_micros = 0;
+    std::map<string, MemoryTotals> memory;
+  };
+
+  // Keyed by device and node name. Ordered, so that the profile lists the
+  // devices and nodes in the same order every time.
+  typedef std::map<std::pair<string, string>, NodeTotals> NodeMap;
+
+  void GetProfileLocked(StepStats* profile) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  NodeMap nodes_ GUARDED_BY(mu_);
+  int64 num_steps_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepStatsAggregator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_AGGREGATOR_H_
@@ -0,0 +1,112 @@
+/* Copyright 2015 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_stats_aggregator.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void AddNode(const string& name, int64 op_start, int64 op_end, int64 all_end,
+             int64 bytes, DeviceStepStats* dev_stats) {
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_op_start_rel_micros(op_start);
+  node_stats->set_op_end_rel_micros(op_end);
+  node_stats->set_all_end_rel_micros(all_end);
+  AllocatorMemoryUsed* used = node_stats->add_memory();
+  used->set_allocator_name("cpu");
+  used->set_total_bytes(bytes);
+  used->set_peak_bytes(bytes);
+}
+
+TEST(StepStatsAggregatorTest, Empty) {
+  StepStatsAggregator aggregator;
+  StepStats profile;
+  EXPECT_EQ(0, aggregator.GetProfile(&profile));
+  EXPECT_EQ(0, profile.dev_stats_size());
+}
+
+TEST(StepStatsAggregatorTest, AveragesOverSteps) {
+  StepStatsAggregator aggregator;
+  StepStats step1;
+  DeviceStepStats* cpu1 = step1.add_dev_stats();
+  cpu1->set_device("/cpu:0");
+  AddNode("a", 1, 11, 12, 100, cpu1);
+  AddNode("b", 2, 4, 6, 0, cpu1);
+  DeviceStepStats* gpu1 = step1.add_dev_stats();
+  gpu1->set_device("/gpu:0");
+  AddNode("c", 0, 50, 50, 1000, gpu1);
+  aggregator.Add(step1);
+
+  // "b" only runs in the first step.
+  StepStats step2;
+  DeviceStepStats* cpu2 = step2.add_dev_stats();
+  cpu2->set_device("/cpu:0");
+  AddNode("a", 3, 33, 34, 300, cpu2);
+  aggregator.Add(step2);
+
+  StepStats profile;
+  EXPECT_EQ(2, aggregator.GetProfile(&profile));
+  ASSERT_EQ(2, profile.dev_stats_size());
+
+  const DeviceStepStats& cpu = profile.dev_stats(0);
+  EXPECT_EQ("/cpu:0", cpu.device());
+  ASSERT_EQ(2, cpu.node_stats_size());
+  const NodeExecStats& a = cpu.node_stats(0);
+  EXPECT_EQ("a", a.node_name());
+  EXPECT_EQ(2, a.op_start_rel_micros());
+  EXPECT_EQ(2 + 20, a.op_end_rel_micros());
+  EXPECT_EQ(23, a.all_end_rel_micros());
+  ASSERT_EQ(1, a.memory_size());
+  EXPECT_EQ("cpu", a.memory(0).allocator_name());
+  EXPECT_EQ(200, a.memory(0).total_bytes());
+  EXPECT_EQ(200, a.memory(0).peak_bytes());
+  const NodeExecStats& b = cpu.node_stats(1);
+  EXPECT_EQ("b", b.node_name());
+  EXPECT_EQ(4, b.op_end_rel_micros());
+
+  const DeviceStepStats& gpu = profile.dev_stats(1);
+  EXPECT_EQ("/gpu:0", gpu.device());
+  ASSERT_EQ(1, gpu.node_stats_size());
+  EXPECT_EQ(50, gpu.node_stats(0).op_end_rel_micros());
+  EXPECT_EQ(1000, gpu.node_stats(0).memory(0).total_bytes());
+}
+
+TEST(StepStatsAggregatorTest, ClearAndTake) {
+  StepStatsAggregator aggregator;
+  StepStats step;
+  DeviceStepStats* cpu = step.add_dev_stats();
+  cpu->set_device("/cpu:0");
+  AddNode("a", 0, 10, 10, 0, cpu);
+  aggregator.Add(step);
+  aggregator.Clear();
+
+  StepStats profile;
+  EXPECT_EQ(0, aggregator.GetProfile(&profile));
+  EXPECT_EQ(0, profile.dev_stats_size());
+
+  aggregator.Add(step);
+  EXPECT_EQ(1, aggregator.GetProfile(&profile));
+  EXPECT_EQ(1, profile.dev_stats_size());
+
+  EXPECT_EQ(1, aggregator.TakeProfile(&profile));
+  EXPECT_EQ(1, profile.dev_stats_size());
+  EXPECT_EQ(0, aggregator.GetProfile(&profile));
+}
+
+}  // namespace
+}  // namespace tensorflow
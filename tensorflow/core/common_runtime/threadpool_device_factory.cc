@@ -17,28 +17,132 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
 #include <vector>
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Mirrors the default limit of the BFC-based CPU allocator in ProcessState;
+// the regions of the pooled allocators below are only reserved as they are
+// used.
+const int64 kPooledCPUMemoryLimit = 1LL << 36;
+
+// Allocates regions whose pages are placed on one NUMA node.
+class NUMASubAllocator : public SubAllocator {
+ public:
+  explicit NUMASubAllocator(int numa_node) : numa_node_(numa_node) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes) override {
+    return port::NUMAMalloc(numa_node_, num_bytes, alignment);
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    port::NUMAFree(ptr, num_bytes);
+  }
+
+ private:
+  const int numa_node_;
+};
+
+// Returns the process-wide allocator of the CPU devices bound to
+// "numa_node".
+Allocator* NUMACPUAllocator(int numa_node) {
+  static mutex* mu = new mutex;
+  static std::vector<Allocator*>* allocators = new std::vector<Allocator*>;
+  mutex_lock l(*mu);
+  if (allocators->empty()) {
+    for (int i = 0; i < port::NUMANumNodes(); ++i) {
+      allocators->push_back(new BFCAllocator(
+          new NUMASubAllocator(i), kPooledCPUMemoryLimit,
+          true /*allow_growth*/, strings::StrCat("cpu_numa", i)));
+    }
+  }
+  return (*allocators)[numa_node];
+}
+
+// Allocates regions backed by huge pages, placed on one NUMA node, or on
+// any node if numa_node is negative.
+class HugePageSubAllocator : public SubAllocator {
+ public:
+  explicit HugePageSubAllocator(int numa_node) : numa_node_(numa_node) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes) override {
+    return port::HugePageMalloc(numa_node_, num_bytes, alignment);
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    port::HugePageFree(ptr, num_bytes);
+  }
+
+ private:
+  const int numa_node_;
+};
+
+// Returns the process-wide allocator of the CPU devices bound to
+// "numa_node", or of the unbound ones if "numa_node" is negative, when
+// use_pooled_cpu_allocator is set. Tensors are carved out of huge-page
+// regions that are kept for the life of the process, in the size-binned
+// free lists of a BFCAllocator, instead of coming from the system
+// allocator one by one.
+Allocator* PooledCPUAllocator(int numa_node) {
+  static mutex* mu = new mutex;
+  static std::vector<Allocator*>* allocators = new std::vector<Allocator*>;
+  mutex_lock l(*mu);
+  if (allocators->empty()) {
+    // The allocator of the unbound devices comes first.
+    for (int i = -1; i < port::NUMANumNodes(); ++i) {
+      allocators->push_back(new BFCAllocator(
+          new HugePageSubAllocator(i), kPooledCPUMemoryLimit,
+          true /*allow_growth*/,
+          i < 0 ? "cpu_pool" : strings::StrCat("cpu_pool_numa", i)));
+    }
+  }
+  return (*allocators)[numa_node + 1];
+}
+
+}  // namespace
+
 // TODO(zhifengc/tucker): Figure out the bytes of available RAM.
 class ThreadPoolDeviceFactory : public DeviceFactory {
  public:
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<Device*>* devices) override {
-    // TODO(zhifengc/tucker): Figure out the number of available CPUs
-    // and/or NUMA configuration.
+    // TODO(zhifengc/tucker): Figure out the number of available CPUs.
     int n = 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
     }
+    const int num_numa_nodes = port::NUMANumNodes();
+    if (options.config.use_numa_devices() && num_numa_nodes > 1 && n > 0) {
+      // One device per NUMA node, each computing on threads pinned to the
+      // node and allocating from its memory.
+      for (int i = 0; i < num_numa_nodes; i++) {
+        string name = strings::StrCat(name_prefix, "/cpu:", i);
+        DeviceLocality locality;
+        locality.set_numa_node(i + 1);
+        Allocator* allocator = options.config.use_pooled_cpu_allocator()
+                                   ? PooledCPUAllocator(i)
+                                   : NUMACPUAllocator(i);
+        devices->push_back(new ThreadPoolDevice(
+            options, name, Bytes(256 << 20), locality, allocator));
+      }
+      return Status::OK();
+    }
+    Allocator* allocator = options.config.use_pooled_cpu_allocator()
+                               ? PooledCPUAllocator(-1)
+                               : cpu_allocator();
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/cpu:", i);
       devices->push_back(new ThreadPoolDevice(
-          options, name, Bytes(256 << 20), DeviceLocality(), cpu_allocator()));
+          options, name, Bytes(256 << 20), DeviceLocality(), allocator));
     }
 
     return Status::OK();
@@ -97,7 +97,33 @@ Status BaseRendezvousMgr::RecvLocal(int64 step_id,
   return ret;
 }
 
+Status BaseRendezvousMgr::DeliverPushedTensor(
+    int64 step_id, const Rendezvous::ParsedKey& parsed, const Tensor& val,
+    bool is_dead) {
+  BaseRemoteRendezvous* rendez = nullptr;
+  {
+    mutex_lock l(mu_);
+    Table::iterator iter = table_.find(step_id);
+    if (iter != table_.end()) {
+      rendez = iter->second;
+    } else if (cleaned_step_set_.count(step_id) > 0) {
+      VLOG(1) << "Dropping " << parsed.FullKey() << ", which was pushed after "
+              << "step " << step_id << " was cleaned up";
+      return Status::OK();
+    } else {
+      // The step has not started on this worker yet.
+      rendez = Create(step_id, worker_env_);
+      table_.insert({step_id, rendez});
+    }
+    rendez->Ref();
+  }
+  core::ScopedUnref unref(rendez);
+  return rendez->DeliverPushedTensor(parsed, val, is_dead);
+}
+
 void BaseRendezvousMgr::Cleanup(int64 step_id) {
+  // The number of cleaned up steps for which late pushes are dropped.
+  static const size_t kMaxCleanedSteps = 1024;
   Rendezvous* rendez = nullptr;
   {
     mutex_lock l(mu_);
@@ -106,6 +132,13 @@ void BaseRendezvousMgr::Cleanup(int64 step_id) {
       rendez = iter->second;
       table_.erase(iter);
     }
+    if (cleaned_step_set_.insert(step_id).second) {
+      cleaned_steps_.push_back(step_id);
+      if (cleaned_steps_.size() > kMaxCleanedSteps) {
+        cleaned_step_set_.erase(cleaned_steps_.front());
+        cleaned_steps_.pop_front();
+      }
+    }
   }
   if (!rendez) return;
   rendez->StartAbort(errors::Aborted("Cleanup ", step_id));
@@ -196,10 +229,87 @@ Status BaseRemoteRendezvous::Send(const Rendezvous::ParsedKey& parsed,
           session_->worker_name);
     }
   }
+  if (!IsSameWorker(parsed.src, parsed.dst) && UsePush(parsed)) {
+    PushToRemote(parsed, args, val, is_dead);
+    return Status::OK();
+  }
   // Buffers "val" and "device_context" in local_.
   return local_->Send(parsed, args, val, is_dead);
 }
 
+void BaseRemoteRendezvous::PushToRemote(const Rendezvous::ParsedKey& parsed,
+                                        const Rendezvous::Args& args,
+                                        const Tensor& val, bool is_dead) {
+  Ref();
+  StatusCallback push_done = [this, parsed](const Status& s) {
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to push " << parsed.FullKey() << ": " << s;
+      StartAbort(s);
+    }
+    Unref();
+  };
+
+  const bool src_host =
+      (args.alloc_attrs.on_host() || parsed.src.type == "CPU");
+  if (is_dead || src_host) {
+    PushToRemoteAsync(parsed, val, is_dead, std::move(push_done));
+    return;
+  }
+
+  // "val" is in device memory, so copy it to the host before pushing it.
+  if (!DMAHelper::CanUseDMA(&val)) {
+    push_done(errors::InvalidArgument("Non-DMA-safe ",
+                                      DataTypeString(val.dtype()),
+                                      " tensor may not be copied from a GPU."));
+    return;
+  }
+  Device* src_device;
+  Status s = env_->device_mgr->LookupDevice(parsed.src_device, &src_device);
+  if (!s.ok()) {
+    push_done(s);
+    return;
+  }
+  AllocatorAttributes host_attr;
+  host_attr.set_on_host(true);
+  host_attr.set_gpu_compatible(true);
+  Tensor* host_val =
+      new Tensor(src_device->GetAllocator(host_attr), val.dtype(), val.shape());
+  // Keep a reference to "val" until the copy is done.
+  Tensor* device_val = new Tensor(val);
+  args.device_context->CopyDeviceTensorToCPU(
+      device_val, parsed.edge_name, src_device, host_val,
+      [this, parsed, host_val, device_val, push_done](const Status& s) {
+        delete device_val;
+        if (s.ok()) {
+          PushToRemoteAsync(parsed, *host_val, false, push_done);
+        } else {
+          push_done(s);
+        }
+        delete host_val;
+      });
+}
+
+Status BaseRemoteRendezvous::DeliverPushedTensor(
+    const Rendezvous::ParsedKey& parsed, const Tensor& val, bool is_dead) {
+  VLOG(1) << "BaseRemoteRendezvous DeliverPushedTensor " << this << " "
+          << parsed.FullKey();
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) return status_;
+    // The push may arrive before the step starts on this worker, in
+    // which case the consumer has not initialized the rendezvous yet.
+    if (is_initialized_locked() &&
+        !IsLocalDevice(session_->worker_name, parsed.dst_device)) {
+      return errors::InvalidArgument(
+          "Invalid rendezvous key (dst): ", parsed.FullKey(), " @ ",
+          session_->worker_name);
+    }
+  }
+  Rendezvous::Args args;
+  args.alloc_attrs.set_on_host(true);
+  return local_->Send(parsed, args, val, is_dead);
+}
+
 Status BaseRemoteRendezvous::ValidateDevices(const ParsedKey& parsed,
                                              bool is_src) {
   // Cache session pointer to avoid repeatedly taking & releasing the lock
@@ -276,6 +386,35 @@ void BaseRemoteRendezvous::SameWorkerRecvDone(
                      done);
 }
 
+void BaseRemoteRendezvous::PushedRecvDone(const Rendezvous::ParsedKey& parsed,
+                                          const Rendezvous::Args& recv_args,
+                                          const Tensor& in, Tensor* out,
+                                          StatusCallback done) {
+  const bool dst_host =
+      (recv_args.alloc_attrs.on_host() || parsed.dst.type == "CPU");
+  if (dst_host) {
+    *out = in;
+    done(Status::OK());
+    return;
+  }
+
+  if (!DMAHelper::CanUseDMA(&in)) {
+    done(errors::InvalidArgument("Non-DMA-safe ", DataTypeString(in.dtype()),
+                                 " tensor may not be copied to a GPU."));
+    return;
+  }
+  Device* dst_device;
+  Status s = env_->device_mgr->LookupDevice(parsed.dst_device, &dst_device);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  Tensor copy(dst_device->GetAllocator(recv_args.alloc_attrs), in.dtype(),
+              in.shape());
+  *out = copy;
+  recv_args.device_context->CopyCPUTensorToDevice(&in, dst_device, out, done);
+}
+
 bool BaseRemoteRendezvous::IsSameWorker(DeviceNameUtils::ParsedName src,
                                         DeviceNameUtils::ParsedName dst) {
   return DeviceNameUtils::IsSameAddressSpace(src, dst);
@@ -315,6 +454,27 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
           }
         });
     return;
+  } else if (UsePush(parsed)) {
+    // The remote producer pushes the tensor into local_.
+    local_->RecvAsync(
+        parsed, recv_args,
+        [this, parsed, done](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& in, bool is_dead) {
+          Tensor* out = new Tensor;
+          StatusCallback final_callback = [done, send_args, recv_args, out,
+                                           is_dead](const Status& s) {
+            done(s, send_args, recv_args, *out, is_dead);
+            delete out;
+          };
+
+          if (status.ok() && !is_dead) {
+            PushedRecvDone(parsed, recv_args, in, out,
+                           std::move(final_callback));
+          } else {
+            final_callback(status);
+          }
+        });
   } else {
     RecvFromRemoteAsync(parsed, recv_args, std::move(done));
   }
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 
+#include <deque>
 #include <string>
 #include <unordered_set>
 
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
@@ -82,6 +84,14 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                    Tensor* val, bool* is_dead) override;
 
+  // Finds the local rendezvous instance for the "step_id", creating it
+  // if the step has not started on this worker yet, and buffers the
+  // pushed tensor in it. A tensor pushed to a step that was recently
+  // cleaned up is dropped.
+  Status DeliverPushedTensor(int64 step_id,
+                             const Rendezvous::ParsedKey& parsed,
+                             const Tensor& val, bool is_dead) override;
+
   // Removes rendezvous for "step_id".
   //
   // TODO(zhifengc): Have a background thread in worker that
@@ -105,6 +115,12 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   mutex mu_;
   Table table_ GUARDED_BY(mu_);
 
+  // The last steps that were cleaned up, oldest first. A tensor pushed to
+  // one of them has no consumer left, and must not create a rendezvous
+  // that nothing would clean up.
+  std::deque<int64> cleaned_steps_ GUARDED_BY(mu_);
+  gtl::FlatSet<int64> cleaned_step_set_ GUARDED_BY(mu_);
+
   BaseRemoteRendezvous* FindOrCreate(int64 step_id);
 
   TF_DISALLOW_COPY_AND_ASSIGN(BaseRendezvousMgr);
@@ -125,14 +141,16 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   Status Initialize(WorkerSession* session) override;
 
   // Forwards to local_, where the Tensor "val" will be buffered and
-  // any waiting callback stored.
+  // any waiting callback stored. If "key" is pushed to its consumer
+  // (see UsePush()), sends "val" to the remote consumer instead.
   Status Send(const ParsedKey& key, const Rendezvous::Args& args,
               const Tensor& val, const bool is_dead) override;
 
   // This method is called only by the RecvOp.  It tests to see
   // whether the value will be produced by a local or remote device
-  // and handles accordingly.  In the local case it forwards to
-  // local_, in the remote case it initiates an RPC request.
+  // and handles accordingly.  In the local case, or if the remote
+  // producer pushes the value, it forwards to local_, otherwise it
+  // initiates an RPC request.
   void RecvAsync(const ParsedKey& key, const Rendezvous::Args& args,
                  DoneCallback done) override;
 
@@ -150,11 +168,33 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // REQUIRES: "parsed" is one that will be Saved into the local rendezvous.
   void RecvLocalAsync(const ParsedKey& parsed, DoneCallback done);
 
+  // This method is called only by the local Worker, forwarded through
+  // the same method on RendezvousMgr, when a remote producer has
+  // pushed the tensor for "parsed". Buffers "val" in local_ for the
+  // local consumer.
+  Status DeliverPushedTensor(const ParsedKey& parsed, const Tensor& val,
+                             bool is_dead);
+
  protected:
   virtual void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                                    const Rendezvous::Args& args,
                                    DoneCallback done) = 0;
 
+  // Returns true if the producer of "parsed", which is on a different
+  // worker from its consumer, sends the tensor to the consumer as soon
+  // as it is produced, rather than waiting for a RecvTensor request.
+  // Both the producing and the consuming worker must return the same
+  // value for the same key.
+  virtual bool UsePush(const Rendezvous::ParsedKey& parsed) { return false; }
+
+  // Sends "val", which is in host memory, to the remote worker that
+  // consumes "parsed". Called only if UsePush(parsed) is true.
+  virtual void PushToRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                                 const Tensor& val, bool is_dead,
+                                 StatusCallback done) {
+    done(errors::Unimplemented("PushToRemoteAsync()"));
+  }
+
   // Returns true if "src" and "dst" are located in the same worker,
   // and hence may use a local rendezvous.
   virtual bool IsSameWorker(DeviceNameUtils::ParsedName src,
@@ -217,6 +257,19 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Must be called only if fully initialized.
   void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
 
+  // Copies "val" to host memory if necessary, and pushes it to the
+  // remote consumer of "parsed". Aborts the rendezvous if the push
+  // fails.
+  void PushToRemote(const ParsedKey& parsed, const Rendezvous::Args& args,
+                    const Tensor& val, bool is_dead);
+
+  // Callback handling the case when a pushed tensor has been received
+  // from local_. Tensor "in" is in host memory, and will be copied to
+  // the destination device of "parsed" if necessary.
+  void PushedRecvDone(const Rendezvous::ParsedKey& parsed,
+                      const Rendezvous::Args& recv_args, const Tensor& in,
+                      Tensor* out, StatusCallback done);
+
   TF_DISALLOW_COPY_AND_ASSIGN(BaseRemoteRendezvous);
 };
 
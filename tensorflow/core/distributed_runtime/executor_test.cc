@@ -60,6 +60,7 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_;
+    params.num_ready_queues = num_ready_queues_;
     params.create_kernel = [this, version](const NodeDef& ndef,
                                            OpKernel** kernel) {
       return CreateNonCachedKernel(device_, nullptr, ndef, version, kernel);
@@ -82,6 +83,7 @@ class ExecutorTest : public ::testing::Test {
   }
 
   thread::ThreadPool* thread_pool_ = nullptr;
+  int num_ready_queues_ = 0;
   Device* device_ = nullptr;
   Executor* exec_ = nullptr;
   StepStatsCollector step_stats_collector_;
@@ -162,6 +164,28 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, DeadInputWithoutControlFlow) {
+  // The graph has no control flow, so it runs with a static schedule, but a
+  // dead tensor can still arrive from another partition through a Recv.
+  Graph* g = new Graph(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g, "b", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g, in0, in1);
+  test::graph::Send(g, tmp, "c", BOB, 1, ALICE);
+  Create(g);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             true));  // in0 is dead.
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -242,6 +266,26 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(4096, g);
+  num_ready_queues_ = 4;
+  Create(g);
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+    rendez->Unref();
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -316,6 +360,62 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+// Switch followed by Merge, without loops, so run with a static schedule.
+// The merge also waits for a control input.
+static Graph* SwitchMergeGraph(bool pred) {
+  Graph* g = new Graph(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g, VB(pred));
+  auto sw = test::graph::Switch(g, in0, in1);
+  auto if_false = test::graph::Identity(g, sw, 0);
+  auto if_true = test::graph::Identity(g, sw, 1);
+  auto merge = test::graph::Merge(g, if_false, if_true);
+  g->AddControlEdge(test::graph::Constant(g, V(0.0)), merge);
+  test::graph::Send(g, merge, "c", BOB, 1, ALICE);
+  return g;
+}
+
+TEST_F(ExecutorTest, SwitchMergeFalseBranch) {
+  Create(SwitchMergeGraph(false));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));  // out = 1.0
+  EXPECT_FALSE(is_dead);
+}
+
+TEST_F(ExecutorTest, SwitchMergeTrueBranch) {
+  Create(SwitchMergeGraph(true));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));  // out = 1.0
+  EXPECT_FALSE(is_dead);
+}
+
+TEST_F(ExecutorTest, SwitchMergeAllInputsDead) {
+  Create(SwitchMergeGraph(true));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             true));  // in0 is dead.
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   Graph* g = new Graph(OpRegistry::Global());
@@ -409,4 +509,84 @@ TEST_F(ExecutorTest, RecvInvalidRefDtype) {
   rendez->Unref();
 }
 
+// Builds a graph of "width" independent Add nodes fed by one constant, and
+// a graph with a chain of "depth" Add nodes. Both measure the per-node
+// overhead of dispatching small ops.
+static Graph* WideGraph(int width) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* in = test::graph::Constant(g, V(1.0));
+  for (int i = 0; i < width; ++i) {
+    test::graph::Add(g, in, in);
+  }
+  return g;
+}
+
+static Graph* DeepGraph(int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* v = test::graph::Constant(g, V(1.0));
+  for (int i = 0; i < depth; ++i) {
+    v = test::graph::Add(g, v, v);
+  }
+  return g;
+}
+
+static SessionOptions ExecutorBenchmarkOptions(bool work_stealing) {
+  SessionOptions options;
+  options.config.mutable_executor_options()->set_use_work_stealing(
+      work_stealing);
+  return options;
+}
+
+static void BM_WideGraph(int iters, int width) {
+  const SessionOptions options = ExecutorBenchmarkOptions(false);
+  testing::ItemsProcessed(static_cast<int64>(iters) * width);
+  test::Benchmark("cpu", WideGraph(width), &options).Run(iters);
+}
+BENCHMARK(BM_WideGraph)->Arg(1024)->Arg(4096);
+
+static void BM_WideGraphWorkStealing(int iters, int width) {
+  const SessionOptions options = ExecutorBenchmarkOptions(true);
+  testing::ItemsProcessed(static_cast<int64>(iters) * width);
+  test::Benchmark("cpu", WideGraph(width), &options).Run(iters);
+}
+BENCHMARK(BM_WideGraphWorkStealing)->Arg(1024)->Arg(4096);
+
+// Builds a graph of "width" independent Add nodes fed through the taken
+// output of a Switch, so that all of them become ready at once.
+static Graph* WideCondGraph(int width) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* in = test::graph::Switch(g, test::graph::Constant(g, V(1.0)),
+                                 test::graph::Constant(g, VB(true)));
+  Node* taken = test::graph::Identity(g, in, 1);
+  for (int i = 0; i < width; ++i) {
+    test::graph::Add(g, taken, taken);
+  }
+  return g;
+}
+
+// Measures how activating the successors of many concurrently finishing
+// nodes scales with the number of inter-op threads.
+static void BM_WideCondGraph(int iters, int num_threads) {
+  const int kWidth = 4096;
+  SessionOptions options = ExecutorBenchmarkOptions(false);
+  options.config.set_inter_op_parallelism_threads(num_threads);
+  testing::ItemsProcessed(static_cast<int64>(iters) * kWidth);
+  test::Benchmark("cpu", WideCondGraph(kWidth), &options).Run(iters);
+}
+BENCHMARK(BM_WideCondGraph)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
+static void BM_DeepGraph(int iters, int depth) {
+  const SessionOptions options = ExecutorBenchmarkOptions(false);
+  testing::ItemsProcessed(static_cast<int64>(iters) * depth);
+  test::Benchmark("cpu", DeepGraph(depth), &options).Run(iters);
+}
+BENCHMARK(BM_DeepGraph)->Arg(1024)->Arg(4096);
+
+static void BM_DeepGraphWorkStealing(int iters, int depth) {
+  const SessionOptions options = ExecutorBenchmarkOptions(true);
+  testing::ItemsProcessed(static_cast<int64>(iters) * depth);
+  test::Benchmark("cpu", DeepGraph(depth), &options).Run(iters);
+}
+BENCHMARK(BM_DeepGraphWorkStealing)->Arg(1024)->Arg(4096);
+
 }  // namespace tensorflow
@@ -46,8 +46,12 @@ limitations under the License.
 
 namespace tensorflow {
 
-GraphMgr::GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr)
-    : worker_env_(worker_env), device_mgr_(device_mgr), table_(5) {
+GraphMgr::GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr,
+                   int64 cache_capacity)
+    : worker_env_(worker_env),
+      device_mgr_(device_mgr),
+      table_(5),
+      cache_capacity_(cache_capacity) {
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   Status status =
@@ -59,6 +63,7 @@ GraphMgr::GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr)
 
 GraphMgr::~GraphMgr() {
   for (auto p : table_) p.second->Unref();
+  for (auto p : cache_) p.second.item->Unref();
 }
 
 GraphMgr::Item::~Item() {
@@ -264,7 +269,8 @@ Status GraphMgr::InitItem(const string& session, const GraphDef& gdef,
 
 Status GraphMgr::Register(const string& session, const GraphDef& gdef,
                           const GraphOptions& graph_options,
-                          const DebugOptions& debug_options, string* handle) {
+                          const DebugOptions& debug_options,
+                          const string& graph_key, string* handle) {
   Item* item = new Item;
   Status s = InitItem(session, gdef, graph_options, debug_options, item);
   if (!s.ok()) {
@@ -272,16 +278,61 @@ Status GraphMgr::Register(const string& session, const GraphDef& gdef,
     return s;
   }
 
-  // Inserts one item into table_.
+  Item* evicted = nullptr;
+  // Inserts one item into table_, and possibly into cache_.
   {
     mutex_lock l(mu_);
     *handle = strings::Printf("%016llx", ++next_id_);
     item->handle = *handle;
     CHECK(table_.insert({*handle, item}).second);
+    if (!graph_key.empty() && cache_capacity_ > 0 &&
+        cache_.count(graph_key) == 0) {
+      if (cache_.size() >= static_cast<size_t>(cache_capacity_)) {
+        auto lru = cache_.begin();
+        for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+          if (it->second.last_use < lru->second.last_use) lru = it;
+        }
+        evicted = lru->second.item;
+        cache_.erase(lru);
+      }
+      item->Ref();
+      cache_[graph_key] = {item, ++cache_clock_};
+    }
+  }
+  if (evicted != nullptr) {
+    evicted->Unref();
   }
   return Status::OK();
 }
 
+Status GraphMgr::RegisterCached(const string& graph_key, string* handle) {
+  mutex_lock l(mu_);
+  auto iter = cache_.find(graph_key);
+  if (iter == cache_.end()) {
+    return errors::NotFound("No cached graph for key ", graph_key);
+  }
+  iter->second.last_use = ++cache_clock_;
+  Item* item = iter->second.item;
+  item->Ref();
+  *handle = strings::Printf("%016llx", ++next_id_);
+  CHECK(table_.insert({*handle, item}).second);
+  return Status::OK();
+}
+
+void GraphMgr::ClearCache() {
+  std::vector<Item*> items;
+  {
+    mutex_lock l(mu_);
+    for (const auto& entry : cache_) {
+      items.push_back(entry.second.item);
+    }
+    cache_.clear();
+  }
+  for (auto item : items) {
+    item->Unref();
+  }
+}
+
 Status GraphMgr::Deregister(const string& handle) {
   Item* item = nullptr;
   // Removes one item from table_.
@@ -64,13 +64,32 @@ struct WorkerSession;
 //   EXPECT_EQ(out["c"], Tensor({4, 6}));
 class GraphMgr {
  public:
-  explicit GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr);
+  // "cache_capacity" is the number of graphs kept cached for reuse by
+  // RegisterCached().
+  GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr,
+           int64 cache_capacity);
   ~GraphMgr();
 
   // Registers a graph. Fills in "handle"
+  //
+  // If "graph_key" is non-empty, the graph is also cached under
+  // "graph_key", so that a later RegisterCached("graph_key") can reuse it
+  // without rebuilding it. The caller must ensure that equal keys are only
+  // used for identical "gdef", "graph_options" and "debug_options".
   Status Register(const string& session, const GraphDef& gdef,
                   const GraphOptions& graph_options,
-                  const DebugOptions& debug_options, string* handle);
+                  const DebugOptions& debug_options, const string& graph_key,
+                  string* handle);
+
+  // Registers the graph that was cached under "graph_key" by an earlier
+  // call to Register(). Fills in "handle", which must be deregistered like
+  // the handle of any other graph. Returns NotFound if no graph is cached
+  // under "graph_key".
+  Status RegisterCached(const string& graph_key, string* handle);
+
+  // Drops all of the cached graphs. Graphs that are still registered stay
+  // registered.
+  void ClearCache();
 
   // Executes one step of a registered graph "handle".
   //
@@ -150,6 +169,20 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Graphs that can be reused by RegisterCached(), keyed by the
+  // "graph_key" with which they were registered. Each entry holds a
+  // reference on its item. When the cache is full, the least recently
+  // used entry is evicted.
+  struct CacheEntry {
+    Item* item;
+    uint64 last_use;
+  };
+  std::unordered_map<string, CacheEntry> cache_ GUARDED_BY(mu_);
+  uint64 cache_clock_ GUARDED_BY(mu_) = 0;
+
+  // The maximum number of entries in cache_.
+  const int64 cache_capacity_;
+
   void StartParallelExecutors(const string& handle, int64 step_id, Item* item,
                               Rendezvous* rendezvous,
                               StepStatsCollector* collector,
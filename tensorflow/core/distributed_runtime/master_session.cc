@@ -45,9 +45,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -370,6 +372,28 @@ Status MasterSession::ReffedClientGraph::DoBuildPartitions(
   return Partition(popts, &client_graph_->graph, out_partitions);
 }
 
+namespace {
+
+// Returns a fingerprint of "req" for use as RegisterGraphRequest.graph_key.
+// The request is serialized deterministically, so that equal requests
+// have equal keys.
+string RegisterGraphKey(const RegisterGraphRequest& req) {
+  string serialized;
+  {
+    req.ByteSize();
+    protobuf::io::StringOutputStream stream(&serialized);
+    protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    req.SerializeWithCachedSizes(&output);
+  }
+  const Fprint128 fp = Fingerprint128(serialized);
+  return strings::Printf("%016llx%016llx",
+                         static_cast<unsigned long long>(fp.high64),
+                         static_cast<unsigned long long>(fp.low64));
+}
+
+}  // namespace
+
 Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     const PartitionOptions& popts, const FunctionDefLibrary& func_def_lib,
     std::unordered_map<string, GraphDef> graph_partitions) {
@@ -399,28 +423,86 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
   };
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
-  BlockingCounter done(num);
+  // Graphs with debug watches are not cached by the workers.
+  const bool reuse_graphs =
+      session_opts_.config.rpc_options().reuse_registered_graphs() &&
+      debug_opts_.debug_tensor_watch_opts().empty();
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
     Call* c = &calls[i];
-    c->req.set_session_handle(session_handle_);
     c->req.mutable_graph_def()->Swap(&graph_partitions[part.name]);
     // For simplicity, we ship the library completely to every worker.
     *c->req.mutable_graph_def()->mutable_library() = func_def_lib;
     *c->req.mutable_graph_options() = session_opts_.config.graph_options();
     *c->req.mutable_debug_options() = debug_opts_;
+    if (reuse_graphs) {
+      // The key is computed before the session handle is set, so that
+      // other sessions registering the same partition get the same key.
+      c->req.set_graph_key(RegisterGraphKey(c->req));
+    }
+    c->req.set_session_handle(session_handle_);
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
-    auto cb = [c, &done](const Status& s) {
-      c->status = s;
-      done.DecrementCount();
-    };
-    part.worker->RegisterGraphAsync(&c->req, &c->resp, cb);
   }
-  done.Wait();
-  for (int i = 0; i < num; ++i) {
-    Call* c = &calls[i];
-    s.Update(c->status);
-    partitions_[i].graph_handle = c->resp.graph_handle();
+
+  // Sends the requests of "calls[i]" for each i in "indices" in parallel,
+  // and waits for all of the responses.
+  auto send_requests = [this, &calls](const std::vector<int>& indices) {
+    BlockingCounter done(indices.size());
+    for (int i : indices) {
+      Call* c = &calls[i];
+      auto cb = [c, &done](const Status& s) {
+        c->status = s;
+        done.DecrementCount();
+      };
+      partitions_[i].worker->RegisterGraphAsync(&c->req, &c->resp, cb);
+    }
+    done.Wait();
+  };
+
+  std::vector<int> to_register;
+  if (reuse_graphs) {
+    // First ask each worker for a graph that it has already built for an
+    // identical request, without sending the GraphDef.
+    std::vector<int> all(num);
+    gtl::InlinedVector<RegisterGraphRequest, 4> full_reqs(num);
+    for (int i = 0; i < num; ++i) {
+      Call* c = &calls[i];
+      all[i] = i;
+      full_reqs[i].Swap(&c->req);
+      c->req.set_session_handle(session_handle_);
+      c->req.set_graph_key(full_reqs[i].graph_key());
+      c->req.set_lookup_cached_graph(true);
+    }
+    send_requests(all);
+    for (int i = 0; i < num; ++i) {
+      Call* c = &calls[i];
+      if (c->status.ok()) {
+        VLOG(2) << "Reusing cached graph " << c->req.graph_key() << " on "
+                << partitions_[i].name;
+        partitions_[i].graph_handle = c->resp.graph_handle();
+      } else if (errors::IsNotFound(c->status)) {
+        c->req.Swap(&full_reqs[i]);
+        c->resp.Clear();
+        to_register.push_back(i);
+      } else {
+        s.Update(c->status);
+      }
+    }
+  } else {
+    for (int i = 0; i < num; ++i) {
+      to_register.push_back(i);
+    }
+  }
+
+  // On failure, the graphs that were found by the lookup are deregistered
+  // with the rest of "partitions_" when this client graph is destroyed.
+  if (s.ok()) {
+    send_requests(to_register);
+    for (int i : to_register) {
+      Call* c = &calls[i];
+      s.Update(c->status);
+      partitions_[i].graph_handle = c->resp.graph_handle();
+    }
   }
   return s;
 }
@@ -932,6 +1014,12 @@ void BuildBuildGraphOptions(const PartialRunSetupRequest& req,
   std::sort(opts->fetch_endpoints.begin(), opts->fetch_endpoints.end());
 }
 
+// Returns a new random step id. Keeps the highest 8 bits 0x01: we reserve
+// some bits of the step_id for future use.
+static uint64 NewStepId() {
+  return (random::New64() & ((1uLL << 56) - 1)) | (1uLL << 56);
+}
+
 uint64 HashBuildGraphOptions(const BuildGraphOptions& opts) {
   uint64 h = 0x2b992ddfa23249d6ull;
   for (const string& name : opts.feed_endpoints) {
@@ -1236,9 +1324,7 @@ Status MasterSession::PartialRunSetup(const PartialRunSetupRequest* req,
   BuildGraphOptions opts;
   BuildBuildGraphOptions(*req, &opts);
   TF_RETURN_IF_ERROR(StartStep(opts, &count, &rcg, true));
-  // Keeps the highest 8 bits 0x01: we reserve some bits of the
-  // step_id for future use.
-  uint64 step_id = (random::New64() & ((1uLL << 56) - 1)) | (1uLL << 56);
+  const uint64 step_id = NewStepId();
   TRACEPRINTF("stepid %llu", step_id);
 
   rcg->Ref();
@@ -1270,8 +1356,10 @@ Status MasterSession::Run(CallOptions* opts, const RunStepRequestWrapper& req,
   Status status;
   if (!req.partial_run_handle().empty()) {
     status = DoPartialRun(opts, req, resp);
+  } else if (CanPipelineStep(req)) {
+    status = DoPipelinedRun(req);
   } else {
-    status = DoRunWithLocalExecution(opts, req, resp);
+    status = DoRunWithLocalExecution(opts, req, resp, NewStepId());
   }
   return status;
 }
@@ -1476,7 +1564,7 @@ Status MasterSession::CreateDebuggerState(
 
 Status MasterSession::DoRunWithLocalExecution(
     CallOptions* opts, const RunStepRequestWrapper& req,
-    MutableRunStepResponseWrapper* resp) {
+    MutableRunStepResponseWrapper* resp, uint64 step_id) {
   VLOG(2) << "DoRunWithLocalExecution req: " << req.DebugString();
   PerStepState pss;
   pss.start_micros = Env::Default()->NowMicros();
@@ -1501,9 +1589,6 @@ Status MasterSession::DoRunWithLocalExecution(
   }
   TF_RETURN_IF_ERROR(BuildAndRegisterPartitions(rcg));
 
-  // Keeps the highest 8 bits 0x01: we reserve some bits of the
-  // step_id for future use.
-  const uint64 step_id = (random::New64() & ((1uLL << 56) - 1)) | (1uLL << 56);
   TRACEPRINTF("stepid %llu", step_id);
 
   pss.collect_timeline = req.options().trace_level() == RunOptions::FULL_TRACE;
@@ -1558,11 +1643,81 @@ Status MasterSession::DoRunWithLocalExecution(
   return s;
 }
 
+bool MasterSession::CanPipelineStep(const RunStepRequestWrapper& req) const {
+  return session_opts_.config.rpc_options().max_pipelined_steps() > 0 &&
+         req.num_fetches() == 0 &&
+         req.options().trace_level() == RunOptions::NO_TRACE &&
+         req.options().debug_options().debug_tensor_watch_opts().empty() &&
+         !req.options().output_partition_graphs();
+}
+
+Status MasterSession::DoPipelinedRun(const RunStepRequestWrapper& req) {
+  const int32 max_pipelined_steps =
+      session_opts_.config.rpc_options().max_pipelined_steps();
+  bool closed;
+  Status pipelined_status;
+  {
+    mutex_lock l(mu_);
+    while (num_pipelined_steps_ >= max_pipelined_steps && !closed_ &&
+           pipelined_status_.ok()) {
+      pipelined_step_done_.wait(l);
+    }
+    closed = closed_;
+    // Reports the failure of an earlier pipelined step.
+    std::swap(pipelined_status, pipelined_status_);
+    if (!closed && pipelined_status.ok()) {
+      ++num_pipelined_steps_;
+    }
+  }
+  if (closed) {
+    MarkRunCompletion();
+    return errors::FailedPrecondition("Session is closed.");
+  }
+  if (!pipelined_status.ok()) {
+    MarkRunCompletion();
+    return pipelined_status;
+  }
+
+  // The step outlives the call, so it runs on a copy of the request.
+  struct PipelinedStep {
+    explicit PipelinedStep(const RunStepRequest& request)
+        : proto(request), req(&proto) {}
+    const RunStepRequest proto;
+    ProtoRunStepRequest req;
+    InMemoryRunStepResponse resp;
+    CallOptions opts;
+  };
+  PipelinedStep* step = new PipelinedStep(req.ToProto());
+  const uint64 step_id = NewStepId();
+  // DoRunWithLocalExecution() calls MarkRunCompletion(), after which
+  // the session may be closed and deleted, so the closure holds a ref.
+  Ref();
+  SchedClosure([this, step, step_id]() {
+    Status s =
+        DoRunWithLocalExecution(&step->opts, step->req, &step->resp, step_id);
+    delete step;
+    if (!s.ok()) {
+      s = Status(s.code(), strings::StrCat("Pipelined step ", step_id,
+                                           " failed: ", s.error_message()));
+      LOG(WARNING) << s;
+    }
+    {
+      mutex_lock l(mu_);
+      pipelined_status_.Update(s);
+      --num_pipelined_steps_;
+    }
+    pipelined_step_done_.notify_all();
+    Unref();
+  });
+  return Status::OK();
+}
+
 Status MasterSession::Close() {
   {
     mutex_lock l(mu_);
     closed_ = true;  // All subsequent calls to Run() or Extend() will fail.
   }
+  pipelined_step_done_.notify_all();
   cancellation_manager_.StartCancel();
   std::vector<ReffedClientGraph*> to_unref;
   {
@@ -180,6 +180,13 @@ class MasterSession : public core::RefCounted {
   bool closed_ GUARDED_BY(mu_) = false;
   bool garbage_collected_ GUARDED_BY(mu_) = false;
 
+  // Steps started by DoPipelinedRun() that have not finished yet.
+  condition_variable pipelined_step_done_;
+  int32 num_pipelined_steps_ GUARDED_BY(mu_) = 0;
+  // The first error of a pipelined step, which the next pipelined Run()
+  // returns.
+  Status pipelined_status_ GUARDED_BY(mu_);
+
   std::unordered_map<uint64, int64> subgraph_execution_counts_ GUARDED_BY(mu_);
 
   // We need to ensure that certain nodes added (e.g., send and recv
@@ -205,9 +212,17 @@ class MasterSession : public core::RefCounted {
                       RCGMap* rcg_map) EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status DoRunWithLocalExecution(CallOptions* opts,
                                  const RunStepRequestWrapper& req,
-                                 MutableRunStepResponseWrapper* resp);
+                                 MutableRunStepResponseWrapper* resp,
+                                 uint64 step_id);
   Status DoPartialRun(CallOptions* opts, const RunStepRequestWrapper& req,
                       MutableRunStepResponseWrapper* resp);
+  // Returns true if "req" may run in the background, as described for
+  // RPCOptions.max_pipelined_steps.
+  bool CanPipelineStep(const RunStepRequestWrapper& req) const;
+  // Starts "req" in the background, once fewer than max_pipelined_steps
+  // steps are in flight. Instead returns the error of an earlier pipelined
+  // step that failed, if any.
+  Status DoPipelinedRun(const RunStepRequestWrapper& req);
   void MarkRunCompletion();
   void UpdateLastAccessTime();
 
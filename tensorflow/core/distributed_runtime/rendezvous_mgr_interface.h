@@ -85,6 +85,15 @@ class RendezvousMgrInterface {
   virtual Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                            Tensor* val, bool* is_dead) = 0;
 
+  // Buffers "val", which a remote producer pushed to this worker, in
+  // the local rendezvous instance for the "step_id" until the local
+  // consumer of "parsed" receives it. "val" must be in host memory.
+  //
+  // This method is used by the rpc handler of PushTensor.
+  virtual Status DeliverPushedTensor(int64 step_id,
+                                     const Rendezvous::ParsedKey& parsed,
+                                     const Tensor& val, bool is_dead) = 0;
+
   // Removes rendezvous for "step_id".
   //
   // TODO(zhifengc): Have a background thread in worker that
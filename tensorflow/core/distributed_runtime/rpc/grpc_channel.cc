@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <map>
 #include <unordered_map>
@@ -53,10 +55,9 @@ Status ValidateHostPortPair(const string& host_port) {
   }
   return Status::OK();
 }
-}  // namespace
 
-Status NewHostPortGrpcChannel(const string& target,
-                              SharedGrpcChannelPtr* channel_pointer) {
+Status NewHostPortGrpcChannelImpl(const string& target, bool distinct,
+                                  SharedGrpcChannelPtr* channel_pointer) {
   // Minimally ensure that the target is valid
   TF_RETURN_IF_ERROR(ValidateHostPortPair(target));
 
@@ -66,10 +67,28 @@ Status NewHostPortGrpcChannel(const string& target,
   // NOTE(mrry): Some versions of gRPC use a 20-second minimum backoff
   // on connection failure, which makes our tests time out.
   args.SetInt("grpc.testing.fixed_reconnect_backoff_ms", 1000);
+  if (distinct) {
+    // gRPC shares one connection between the channels to a target that
+    // have the same arguments. Give each channel a distinct argument, so
+    // that it uses a separate connection.
+    static std::atomic<int> next_channel_id(0);
+    args.SetInt("tensorflow.grpc_channel_id", next_channel_id++);
+  }
   *channel_pointer = ::grpc::CreateCustomChannel(
       target, ::grpc::InsecureChannelCredentials(), args);
   return Status::OK();
 }
+}  // namespace
+
+Status NewHostPortGrpcChannel(const string& target,
+                              SharedGrpcChannelPtr* channel_pointer) {
+  return NewHostPortGrpcChannelImpl(target, false, channel_pointer);
+}
+
+Status NewDistinctHostPortGrpcChannel(const string& target,
+                                      SharedGrpcChannelPtr* channel_pointer) {
+  return NewHostPortGrpcChannelImpl(target, true, channel_pointer);
+}
 
 ChannelCreationFunction ConvertToChannelCreationFunction(
     const std::function<Status(string, SharedGrpcChannelPtr*)>&
@@ -109,6 +128,10 @@ Status GrpcChannelSpec::AddHostPortsJob(
 namespace {
 
 // GrpcChannelCache that caches results to FindWorkerChannel() calls.
+//
+// If more than one channel is created for a target, FindWorkerChannel()
+// returns them in turn, so that the calls to the target are striped
+// across the channels.
 class CachingGrpcChannelCache : public GrpcChannelCache {
  public:
   CachingGrpcChannelCache() {}
@@ -116,40 +139,61 @@ class CachingGrpcChannelCache : public GrpcChannelCache {
   ~CachingGrpcChannelCache() override {}
 
   SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
-    SharedGrpcChannelPtr ch = nullptr;
     {
-      mutex_lock l(mu_);  // could use reader lock
-      ch = gtl::FindPtrOrNull(channels_, target);
-      if (ch) {
-        return ch;
+      mutex_lock l(mu_);
+      ChannelSet* set = gtl::FindOrNull(channels_, target);
+      if (set) {
+        return set->Next();
       }
     }
-    ch = FindChannelOnce(target);
-    if (ch) {
-      mutex_lock l(mu_);
-      channels_.insert({target, ch});
+    std::vector<SharedGrpcChannelPtr> channels;
+    FindChannelsOnce(target, &channels);
+    if (channels.empty()) {
+      return nullptr;
     }
-    return ch;
+    mutex_lock l(mu_);
+    // Another thread may have created channels for "target" concurrently,
+    // in which case its channels are used.
+    ChannelSet* set = &channels_[target];
+    if (set->channels.empty()) {
+      set->channels = std::move(channels);
+    }
+    return set->Next();
   }
 
  protected:
-  // Find the ClientChannel for "target".  Only called when no channel was
-  // found in the channels_ cache for "target".  A non nullptr result will be
-  // cached in channels_.
-  virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
+  // Find the ClientChannels for "target".  Only called when no channel was
+  // found in the channels_ cache for "target".  The channels appended to
+  // "*channels" will be cached in channels_.
+  virtual void FindChannelsOnce(
+      const string& target, std::vector<SharedGrpcChannelPtr>* channels) = 0;
 
  private:
+  struct ChannelSet {
+    std::vector<SharedGrpcChannelPtr> channels;
+    size_t next = 0;
+
+    SharedGrpcChannelPtr Next() {
+      SharedGrpcChannelPtr ch = channels[next];
+      next = (next + 1) % channels.size();
+      return ch;
+    }
+  };
+
   // TODO(zhifengc): Eviction when the map becomes too big.
   mutex mu_;
-  std::unordered_map<string, SharedGrpcChannelPtr> channels_ GUARDED_BY(mu_);
+  std::unordered_map<string, ChannelSet> channels_ GUARDED_BY(mu_);
 };
 
 // A ChannelCache that is the union of multiple ChannelCaches.
 // Takes ownership of the caches passed to the constructor.
-class MultiGrpcChannelCache : public CachingGrpcChannelCache {
+//
+// The channels are cached by the underlying caches, so calls to
+// FindWorkerChannel() are forwarded to the cache that handles the target.
+class MultiGrpcChannelCache : public GrpcChannelCache {
  public:
   explicit MultiGrpcChannelCache(const std::vector<GrpcChannelCache*>& caches)
-      : CachingGrpcChannelCache(), caches_(caches) {}
+      : caches_(caches) {}
 
   ~MultiGrpcChannelCache() override {
     for (GrpcChannelCache* cache : caches_) {
@@ -181,8 +225,15 @@ class MultiGrpcChannelCache : public CachingGrpcChannelCache {
     return cache->TranslateTask(target);
   }
 
- protected:
-  SharedGrpcChannelPtr FindChannelOnce(const string& target) override {
+  SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
+    GrpcChannelCache* target_cache = nullptr;
+    {
+      mutex_lock l(mu_);  // could use reader lock
+      target_cache = gtl::FindPtrOrNull(target_caches_, target);
+    }
+    if (target_cache) {
+      return target_cache->FindWorkerChannel(target);
+    }
     for (GrpcChannelCache* cache : caches_) {
       SharedGrpcChannelPtr ch(cache->FindWorkerChannel(target));
       if (ch) {
@@ -208,10 +259,12 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
  public:
   SparseGrpcChannelCache(const string& job_id,
                          const std::map<int, string>& host_ports,
-                         ChannelCreationFunction channel_func)
+                         ChannelCreationFunction channel_func,
+                         int num_channels_per_target)
       : job_id_(job_id),
         host_ports_(host_ports),
-        channel_func_(std::move(channel_func)) {
+        channel_func_(std::move(channel_func)),
+        num_channels_per_target_(std::max(num_channels_per_target, 1)) {
     LOG(INFO) << "Initialize GrpcChannelCache for job " << ToString();
   }
   ~SparseGrpcChannelCache() override {}
@@ -248,12 +301,19 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
   }
 
  protected:
-  SharedGrpcChannelPtr FindChannelOnce(const string& target) override {
+  void FindChannelsOnce(const string& target,
+                        std::vector<SharedGrpcChannelPtr>* channels) override {
     const string host_port = TranslateTask(target);
     if (host_port.empty()) {
-      return nullptr;
+      return;
+    }
+    for (int i = 0; i < num_channels_per_target_; ++i) {
+      SharedGrpcChannelPtr ch = channel_func_(host_port);
+      if (!ch) {
+        break;
+      }
+      channels->push_back(std::move(ch));
     }
-    return channel_func_(host_port);
   }
 
  private:
@@ -271,6 +331,7 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
   const string job_id_;
   const std::map<int, string> host_ports_;
   const ChannelCreationFunction channel_func_;
+  const int num_channels_per_target_;
   TF_DISALLOW_COPY_AND_ASSIGN(SparseGrpcChannelCache);
 };
 
@@ -286,8 +347,9 @@ GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
   std::vector<GrpcChannelCache*> caches;
   caches.reserve(num_jobs);
   for (auto& job : spec.host_ports_jobs()) {
-    caches.push_back(
-        new SparseGrpcChannelCache(job.job_id, job.host_ports, channel_func));
+    caches.push_back(new SparseGrpcChannelCache(
+        job.job_id, job.host_ports, channel_func,
+        spec.num_channels_per_target()));
   }
   return caches.size() == 1 ? caches[0] : new MultiGrpcChannelCache(caches);
 }
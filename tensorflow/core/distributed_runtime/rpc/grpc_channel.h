@@ -52,8 +52,16 @@ class GrpcChannelSpec {
     return host_ports_jobs_;
   }
 
+  // The number of channels that a GrpcChannelCache opens to each target.
+  // Values smaller than 1 are treated as 1.
+  void set_num_channels_per_target(int num_channels) {
+    num_channels_per_target_ = num_channels;
+  }
+  int num_channels_per_target() const { return num_channels_per_target_; }
+
  private:
   std::vector<HostPortsJob> host_ports_jobs_;
+  int num_channels_per_target_ = 1;
   std::set<string> job_ids_;
 };
 
@@ -71,6 +79,10 @@ class GrpcChannelCache {
   // worker named by 'target'. 'target' is of the following
   // format: /job:<job identifier>/task:<task id>
   // E.g., /job:mnist/task:2
+  //
+  // If the GrpcChannelSpec asks for N > 1 channels per target, the cache
+  // opens N channels to every target, and successive calls return them in
+  // turn.
   virtual SharedGrpcChannelPtr FindWorkerChannel(const string& target) = 0;
 
   // Translates a string in the form `/job:X/task:Z` into a host_port.
@@ -79,6 +91,9 @@ class GrpcChannelCache {
 
 typedef std::function<SharedGrpcChannelPtr(string)> ChannelCreationFunction;
 
+// If `channel_spec` asks for more than one channel per target,
+// `channel_func` should return channels with separate connections (see
+// NewDistinctHostPortGrpcChannel), or gRPC folds them onto one.
 GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& channel_spec,
                                       ChannelCreationFunction channel_func);
 
@@ -91,6 +106,11 @@ ChannelCreationFunction ConvertToChannelCreationFunction(
 Status NewHostPortGrpcChannel(const string& target,
                               SharedGrpcChannelPtr* channel_pointer);
 
+// Like NewHostPortGrpcChannel, but the channel gets its own connection even
+// if other channels to `target` are open.
+Status NewDistinctHostPortGrpcChannel(const string& target,
+                                      SharedGrpcChannelPtr* channel_pointer);
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CHANNEL_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <stdlib.h>
+
 #include <string>
 #include <vector>
 
@@ -144,6 +146,29 @@ TEST(GrpcChannelTest, SparseHostPorts) {
             workers);
 }
 
+TEST(GrpcChannelTest, MultipleChannelsPerTarget) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {{0, "a:1"}, {1, "b:2"}}));
+  TF_EXPECT_OK(spec.AddHostPortsJob("ps", {"c:3"}));
+  spec.set_num_channels_per_target(3);
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewDistinctHostPortGrpcChannel);
+  std::unique_ptr<GrpcChannelCache> cc(NewGrpcChannelCache(spec, channel_func));
+
+  for (const string& target :
+       {"/job:mnist/replica:0/task:1", "/job:ps/replica:0/task:0"}) {
+    // The channels to a target are returned in turn.
+    auto ch_1 = cc->FindWorkerChannel(target);
+    auto ch_2 = cc->FindWorkerChannel(target);
+    auto ch_3 = cc->FindWorkerChannel(target);
+    auto ch_4 = cc->FindWorkerChannel(target);
+    EXPECT_NE(ch_1.get(), ch_2.get());
+    EXPECT_NE(ch_1.get(), ch_3.get());
+    EXPECT_NE(ch_2.get(), ch_3.get());
+    EXPECT_EQ(ch_1.get(), ch_4.get());
+  }
+}
+
 TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
   SharedGrpcChannelPtr mock_ptr;
 
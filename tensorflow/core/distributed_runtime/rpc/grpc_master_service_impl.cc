@@ -91,6 +91,13 @@ MasterService::Stub::Stub(
                                    request, response);
 }
 
+::grpc::Status MasterService::Stub::RunStep(::grpc::ClientContext* context,
+                                            const ::grpc::ByteBuffer& request,
+                                            RunStepResponse* response) {
+  return ::grpc::BlockingUnaryCall(channel_.get(), rpcmethod_RunStep_, context,
+                                   request, response);
+}
+
 ::grpc::Status MasterService::Stub::CloseSession(
     ::grpc::ClientContext* context, const CloseSessionRequest& request,
     CloseSessionResponse* response) {
@@ -24,6 +24,7 @@ limitations under the License.
 #include "grpc++/impl/codegen/status.h"
 #include "grpc++/impl/codegen/stub_options.h"
 #include "grpc++/impl/codegen/sync_stream.h"
+#include "grpc++/support/byte_buffer.h"
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_serialization_traits.h"
 #include "tensorflow/core/protobuf/master.pb.h"
@@ -95,6 +96,11 @@ class MasterService GRPC_FINAL {
     ::grpc::Status RunStep(::grpc::ClientContext* context,
                            const RunStepRequest& request,
                            RunStepResponse* response) GRPC_OVERRIDE;
+    // Like RunStep() above, but "request" is already encoded as a
+    // RunStepRequest (see grpc::EncodeRunStepRequestToByteBuffer()).
+    ::grpc::Status RunStep(::grpc::ClientContext* context,
+                           const ::grpc::ByteBuffer& request,
+                           RunStepResponse* response);
     ::grpc::Status CloseSession(::grpc::ClientContext* context,
                                 const CloseSessionRequest& request,
                                 CloseSessionResponse* response) GRPC_OVERRIDE;
@@ -16,12 +16,16 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_master.h"
 
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/master_interface.h"
+#include "tensorflow/core/distributed_runtime/message_wrappers.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_master_service_impl.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/master.pb.h"
 
@@ -63,13 +67,48 @@ class GrpcRemoteMaster : public MasterInterface {
     return FromGrpcStatus(stub_->PartialRunSetup(&ctx, *request, response));
   }
 
+  // The feeds of "request" are encoded straight from their tensors, so
+  // the data of a large feed is handed to gRPC without being copied into
+  // a TensorProto first. Requests from CreateRunStepRequest() hold their
+  // feeds as tensors, which makes this the fast path.
   Status RunStep(CallOptions* call_options, RunStepRequestWrapper* request,
                  MutableRunStepResponseWrapper* response) override {
+    RunStepRequest header;
+    header.set_session_handle(request->session_handle());
+    header.set_partial_run_handle(request->partial_run_handle());
+    for (size_t i = 0; i < request->num_fetches(); ++i) {
+      header.add_fetch(request->fetch_name(i));
+    }
+    for (size_t i = 0; i < request->num_targets(); ++i) {
+      header.add_target(request->target_name(i));
+    }
+    *header.mutable_options() = request->options();
+    std::vector<std::pair<string, Tensor>> feeds(request->num_feeds());
+    for (size_t i = 0; i < feeds.size(); ++i) {
+      feeds[i].first = request->feed_name(i);
+      TF_RETURN_IF_ERROR(request->FeedValue(i, &feeds[i].second));
+    }
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeRunStepRequestToByteBuffer(header, feeds, &buf);
+
     ::grpc::ClientContext ctx;
     ctx.set_fail_fast(false);
     SetDeadline(&ctx, call_options->GetTimeout());
-    return FromGrpcStatus(stub_->RunStep(&ctx, request->ToProto(),
-                                         get_proto_from_wrapper(response)));
+    return FromGrpcStatus(
+        stub_->RunStep(&ctx, buf, get_proto_from_wrapper(response)));
+  }
+
+  // A request that is already a proto is sent as it is.
+  Status RunStep(CallOptions* call_options, const RunStepRequest* request,
+                 RunStepResponse* response) override {
+    ::grpc::ClientContext ctx;
+    ctx.set_fail_fast(false);
+    SetDeadline(&ctx, call_options->GetTimeout());
+    return FromGrpcStatus(stub_->RunStep(&ctx, *request, response));
+  }
+
+  MutableRunStepRequestWrapper* CreateRunStepRequest() override {
+    return new InMemoryRunStepRequest;
   }
 
   Status CloseSession(CallOptions* call_options,
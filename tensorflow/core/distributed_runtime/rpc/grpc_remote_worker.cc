@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
@@ -49,6 +50,8 @@ class GrpcRemoteWorker : public WorkerInterface {
         cleanupgraph_(Method(GrpcWorkerMethod::kCleanupGraph)),
         cleanupall_(Method(GrpcWorkerMethod::kCleanupAll)),
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
+        pushtensor_(Method(GrpcWorkerMethod::kPushTensor)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
         logger_(logger) {}
@@ -176,6 +179,70 @@ class GrpcRemoteWorker : public WorkerInterface {
                  *cb_to_use, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: " << request->DebugString();
+    if (!logger_->LoggingActive()) {
+      IssueRequest(request, response, recvtensorbatch_, std::move(done),
+                   call_opts);
+      return;
+    }
+    // Log each tensor in the batch as if it had been received with its
+    // own RecvTensor call.
+    int64 start_usec = Env::Default()->NowMicros();
+    StatusCallback wrapper_done = [this, request, response, done,
+                                   start_usec](Status s) {
+      int64 end_usec = Env::Default()->NowMicros();
+      const int num_responses = std::min(response->response_size(),
+                                         request->rendezvous_key_size());
+      for (int i = 0; i < num_responses; ++i) {
+        const RecvTensorResponse& r = response->response(i);
+        int64 send_start_usec = start_usec;
+        if (r.send_start_micros()) {
+          // See RecvTensorAsync() for why the reported time is clamped.
+          send_start_usec =
+              std::max(start_usec, static_cast<int64>(r.send_start_micros()));
+          send_start_usec = std::min(send_start_usec, end_usec - 1);
+        }
+        const string& key = request->rendezvous_key(i);
+        std::vector<string> key_parts = str_util::Split(key, ';');
+        if (key_parts.size() != 5) {
+          LOG(WARNING) << "Bad key: " << key;
+        } else {
+          // The encoded size of the tensor approximates its size in
+          // memory, and avoids decoding it twice.
+          logger_->RecordRecvTensor(request->step_id(), send_start_usec,
+                                    end_usec,
+                                    key_parts[3],  // tensor name
+                                    key_parts[0],  // src_device
+                                    key_parts[2],  // dst_device
+                                    r.tensor().ByteSize());
+        }
+      }
+      done(s);
+    };
+    IssueRequest(request, response, recvtensorbatch_, std::move(wrapper_done),
+                 call_opts);
+  }
+
+  void PushTensorAsync(const PushTensorRequest* request,
+                       PushTensorResponse* response,
+                       StatusCallback done) override {
+    IssueRequest(request, response, pushtensor_, std::move(done));
+  }
+
+  // The data of a large "val" is handed to gRPC without being copied into
+  // a TensorProto first.
+  void PushTensorAsync(const PushTensorRequest* request, const Tensor& val,
+                       PushTensorResponse* response,
+                       StatusCallback done) override {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodePushTensorRequestToByteBuffer(*request, val, &buf);
+    IssueRequest(&buf, response, pushtensor_, std::move(done));
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -262,6 +329,8 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::RpcMethod cleanupgraph_;
   const ::grpc::RpcMethod cleanupall_;
   const ::grpc::RpcMethod recvtensor_;
+  const ::grpc::RpcMethod recvtensorbatch_;
+  const ::grpc::RpcMethod pushtensor_;
   const ::grpc::RpcMethod logging_;
   const ::grpc::RpcMethod tracing_;
 
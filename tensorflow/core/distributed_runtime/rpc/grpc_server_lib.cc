@@ -50,6 +50,9 @@ namespace tensorflow {
 
 namespace {
 
+// The default number of registered graphs that a worker keeps cached.
+const int kDefaultRegisteredGraphCacheSize = 16;
+
 // Define an option subclass in order to disable SO_REUSEPORT for the
 // server socket.
 class NoReusePortOption : public ::grpc::ServerBuilderOption {
@@ -62,11 +65,6 @@ class NoReusePortOption : public ::grpc::ServerBuilderOption {
                          plugins) override {}
 };
 
-// static utility function
-RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
-  return new RpcRendezvousMgr(env);
-}
-
 }  // namespace
 
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
@@ -123,9 +121,10 @@ Status GrpcServer::Init(
                                                &master_env_.local_devices));
   worker_env_.local_devices = master_env_.local_devices;
   worker_env_.device_mgr = new DeviceMgr(worker_env_.local_devices);
-  worker_env_.rendezvous_mgr = rendezvous_mgr_func == nullptr
-                                   ? new RpcRendezvousMgr(&worker_env_)
-                                   : rendezvous_mgr_func(&worker_env_);
+  worker_env_.rendezvous_mgr =
+      rendezvous_mgr_func == nullptr
+          ? new RpcRendezvousMgr(&worker_env_, config.rpc_options())
+          : rendezvous_mgr_func(&worker_env_);
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -185,7 +184,8 @@ Status GrpcServer::Init(
       master_impl_.get(), config.operation_timeout_in_ms(), &builder);
   worker_impl_ = NewGrpcWorker(&worker_env_);
   worker_service_ =
-      NewGrpcWorkerService(worker_impl_.get(), &builder).release();
+      NewGrpcWorkerService(worker_impl_.get(), config.rpc_options(), &builder)
+          .release();
   // extra service:
   if (service_func != nullptr) {
     service_func(&worker_env_, &builder);
@@ -209,7 +209,10 @@ Status GrpcServer::Init(
       [this](const ServerDef& server_def, WorkerCacheInterface** worker_cache) {
         WorkerCacheFactoryOptions options(server_def);
         return WorkerCacheFactory(options, worker_cache);
-      });
+      },
+      config.rpc_options().registered_graph_cache_size() > 0
+          ? config.rpc_options().registered_graph_cache_size()
+          : kDefaultRegisteredGraphCacheSize);
   worker_env_.compute_pool = ComputePool(sess_opts);
 
   // Finish setting up master environment.
@@ -261,6 +264,9 @@ Status GrpcServer::ParseChannelSpec(const WorkerCacheFactoryOptions& options,
     }
     TF_RETURN_IF_ERROR(channel_spec->AddHostPortsJob(job.name(), host_ports));
   }
+  channel_spec->set_num_channels_per_target(
+      server_def_.default_session_config().rpc_options()
+          .grpc_channels_per_target());
   return Status::OK();
 }
 
@@ -372,6 +378,10 @@ std::shared_ptr<::grpc::ServerCredentials> GrpcServer::GetServerCredentials(
 ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
   // We can do this because SparseGrpcChannelCache is robust to nullptr being
   // returned by the channel creation function
+  if (server_def_.default_session_config().rpc_options()
+          .grpc_channels_per_target() > 1) {
+    return ConvertToChannelCreationFunction(NewDistinctHostPortGrpcChannel);
+  }
   return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
 }
 
@@ -385,7 +395,7 @@ Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   std::unique_ptr<GrpcServer> ret(
       new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   ServiceInitFunction service_func = nullptr;
-  TF_RETURN_IF_ERROR(ret->Init(service_func, NewRpcRendezvousMgr));
+  TF_RETURN_IF_ERROR(ret->Init(service_func, nullptr));
   *out_server = std::move(ret);
   return Status::OK();
 }
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
@@ -488,6 +489,53 @@ TEST(GrpcSessionTest, SendRecv_Node_Naming) {
   TF_CHECK_OK(session->Close());
 }
 
+TEST(GrpcSessionTest, BatchedRecvOfDependentTensors) {
+  SessionOptions cluster_options = Devices(1, 0);
+  cluster_options.config.mutable_rpc_options()
+      ->set_recv_tensor_batch_window_usecs(10000);
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(cluster_options, 2, &cluster));
+  std::unique_ptr<Session> session(
+      NewRemote(Options(cluster->targets()[0], 1)));
+  ASSERT_TRUE(session != nullptr);
+
+  ASSERT_EQ(2, cluster->devices().size());
+  const DeviceAttributes& dev0 = cluster->devices()[0];
+  const DeviceAttributes& dev1 = cluster->devices()[1];
+  ASSERT_NE(dev0.name(), dev1.name());
+
+  // 'dev1' receives 'a' and 'c' from 'dev0' in the same batch, but 'c'
+  // can only be produced after 'dev1' has received 'a' and sent 'b'
+  // back.
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({1, 1}));
+  a_tensor.flat<float>()(0) = 100;
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* b = test::graph::Identity(&graph, a);
+  Node* c = test::graph::Identity(&graph, b);
+  Node* d = test::graph::Add(&graph, b, c);
+
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  SetDevice(&def, a->name(), dev0.name());
+  SetDevice(&def, b->name(), dev1.name());
+  SetDevice(&def, c->name(), dev0.name());
+  SetDevice(&def, d->name(), dev1.name());
+  TF_CHECK_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_timeout_in_ms(60000);
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(
+        session->Run(run_options, {}, {d->name()}, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    IsSingleFloatValue(outputs[0], 200);
+  }
+
+  TF_CHECK_OK(session->Close());
+}
+
 TEST(GrpcSessionTest, Error) {
   std::unique_ptr<test::TestCluster> cluster;
   TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
@@ -605,6 +653,83 @@ TEST(SessionTest, SharedVar) {
   }
 }
 
+TEST(SessionTest, PipelinedSteps) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 1, &cluster));
+  const string master = cluster->targets()[0];
+
+  GraphDef gdef;
+  string init_name;
+  string inc_name;
+  string get_name;
+  {
+    Graph g(OpRegistry::Global());
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    Node* var = test::graph::Var(&g, DT_FLOAT, one.shape());
+    Node* init = test::graph::Assign(&g, var, test::graph::Constant(&g, one));
+    init_name = init->name();
+    Node* update = test::graph::Assign(
+        &g, var, test::graph::Add(&g, var, test::graph::Constant(&g, one)));
+    inc_name = update->name();
+    get_name = var->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  SessionOptions options = Options(master, 1);
+  options.config.mutable_rpc_options()->set_max_pipelined_steps(1);
+  std::unique_ptr<Session> session(NewRemote(options));
+  TF_CHECK_OK(session->Create(gdef));
+  // With one pipelined step, each step starts when the previous one has
+  // finished, so the steps are applied in order.
+  TF_CHECK_OK(session->Run({}, {}, {init_name}, nullptr));
+  for (int i = 0; i < 9; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, {inc_name}, nullptr));
+  }
+  // Fetches are not pipelined, but may not see the last pipelined step.
+  std::vector<Tensor> ret;
+  TF_CHECK_OK(session->Run({}, {get_name}, {}, &ret));
+  ASSERT_EQ(ret.size(), 1);
+  EXPECT_GE(ret[0].scalar<float>()(), 9.0);
+  EXPECT_LE(ret[0].scalar<float>()(), 10.0);
+  TF_CHECK_OK(session->Close());
+}
+
+TEST(SessionTest, PipelinedStepError) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 1, &cluster));
+  const string master = cluster->targets()[0];
+
+  GraphDef gdef;
+  string error_name;
+  string const_name;
+  {
+    Graph g(OpRegistry::Global());
+    auto a = test::graph::Constant(&g, Tensor());
+    auto a_err = test::graph::Error(&g, a, "fantasia!");
+    error_name = a_err->name();
+    const_name = a->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  SessionOptions options = Options(master, 1);
+  options.config.mutable_rpc_options()->set_max_pipelined_steps(1);
+  std::unique_ptr<Session> session(NewRemote(options));
+  TF_CHECK_OK(session->Create(gdef));
+  // The first step is started in the background. A step that fetches a
+  // tensor is not pipelined, and does not report the error.
+  TF_EXPECT_OK(session->Run({}, {}, {error_name}, nullptr));
+  std::vector<Tensor> outputs;
+  TF_EXPECT_OK(session->Run({}, {const_name}, {}, &outputs));
+  // The next pipelined step starts after the first step has finished, so
+  // it reports the error.
+  Status status = session->Run({}, {}, {error_name}, nullptr);
+  EXPECT_FALSE(status.ok());
+  EXPECT_NE(status.ToString().find("fantasia!"), string::npos);
+  EXPECT_NE(status.ToString().find("Pipelined step "), string::npos);
+  TF_CHECK_OK(session->Close());
+}
+
 void CreateInvalidGraph(const string& graph_def_ascii,
                         const string& error_substring) {
   GraphDef graph;
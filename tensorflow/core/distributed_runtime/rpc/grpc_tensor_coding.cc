@@ -17,22 +17,65 @@ limitations under the License.
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 namespace grpc {
 
+// Tensor data larger than this is shared with the ByteBuffer rather than
+// copied into it.
+static const int kLargeTensorBytes = 1024;
+
 static void do_nothing(void* raw) {}
 static void unref_tensorbuffer(void* raw) {
   TensorBuffer* buf = static_cast<TensorBuffer*>(raw);
   buf->Unref();
 }
 
+// Points "*data" at the backing store of "val", and "*unref" at a special
+// zero-length slice that is really a TensorBuffer reference that we will
+// unref when we are done. "*data" must come before "*unref" in the
+// ByteBuffer they are added to.
+//
+// TODO(jeff): Note that this approach relies on the fact that
+// slices are destroyed in the order in which they are added to
+// the ByteBuffer.  In principle, these could be broken by future
+// hypothetical grpc_slice-related changes (e.g. the
+// implementation could decide to destroy 0-length slices
+// eagerly).  In practice, this does not happen with the current
+// implementation, and the gpr_slice interface at the moment does
+// not allow us to do the Tensor-unreferencing in the right way
+// (since the Tensor pointer is different than the backing store
+// array pointer).
+//
+// TODO(jeff,sanjay): switch to using new
+// gsr_slice_new_with_user_data interface that allows for
+// different pointers for the data and the argument to the
+// destroy function once that has been added integrated into grpc
+// (see https://github.com/grpc/grpc/pull/7488)
+static void ShareTensorData(const Tensor& val, ::grpc::Slice* data,
+                            ::grpc::Slice* unref) {
+  StringPiece tdata = val.tensor_data();
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  buf->Ref();
+  gpr_slice s1 = gpr_slice_new(
+      const_cast<void*>(static_cast<const void*>(tdata.data())), tdata.size(),
+      do_nothing);
+  *data = ::grpc::Slice(s1, ::grpc::Slice::STEAL_REF);
+
+  gpr_slice s2 =
+      gpr_slice_new(const_cast<TensorBuffer*>(buf), 0, unref_tensorbuffer);
+  *unref = ::grpc::Slice(s2, ::grpc::Slice::STEAL_REF);
+}
+
 void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
                                           ::grpc::ByteBuffer* result) {
   size_t len = proto.ByteSize();
@@ -138,18 +181,57 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Encodes "header" (a RecvTensorResponse without its tensor() field)
+// followed by the DT_STRING tensor "val" into a single gpr_slice. The
+// elements of "val" are written directly as TensorProto::string_val
+// fields, rather than being copied into a TensorProto first.
+static void EncodeStringTensorToByteBuffer(const RecvTensorResponse& header,
+                                           const Tensor& val,
+                                           ::grpc::ByteBuffer* result) {
+  gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+  io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+  EncodeSkeleton(val, &e_skeleton);
+
+  const auto strings = val.flat<string>();
+  size_t tensor_proto_bytesize = e_skeleton.size();
+  for (int64 i = 0; i < strings.size(); ++i) {
+    tensor_proto_bytesize += VarLengthEncodingSize(
+        TensorProto::kStringValFieldNumber, strings(i).size());
+  }
+  string encoded_header;
+  header.AppendToString(&encoded_header);
+  const size_t expected_size =
+      encoded_header.size() +
+      VarLengthEncodingSize(RecvTensorResponse::kTensorFieldNumber,
+                            tensor_proto_bytesize);
+
+  gpr_slice s = gpr_slice_malloc(expected_size);
+  io::ProtoEncodeHelper e(reinterpret_cast<char*>(GPR_SLICE_START_PTR(s)),
+                          expected_size);
+  e.WriteRawBytes(encoded_header);
+  e.WriteVarlengthBeginning(RecvTensorResponse::kTensorFieldNumber,
+                            tensor_proto_bytesize);
+  e.WriteRawBytes(StringPiece(e_skeleton.data(), e_skeleton.size()));
+  for (int64 i = 0; i < strings.size(); ++i) {
+    e.WriteString(TensorProto::kStringValFieldNumber, strings(i));
+  }
+  CHECK_EQ(e.size(), expected_size);
+
+  ::grpc::Slice slice(s, ::grpc::Slice::STEAL_REF);
+  *result = ::grpc::ByteBuffer(&slice, 1);
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result) {
-  const int kLargeTensorBytes = 1024;
   RecvTensorResponse response;
   if (is_dead) {
     response.set_is_dead(is_dead);
   }
   response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+  if (val.dtype() == DT_STRING) {
+    EncodeStringTensorToByteBuffer(response, val, result);
+  } else if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
-    // TODO(jeff,sanjay): If this becomes an issue, we could
-    // go directly from val -> ByteBuffer, with some effort.
     val.AsProtoTensorContent(response.mutable_tensor());
 
     // Encode full protocol buffer to a ByteBuffer
@@ -218,39 +300,8 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
     }
 
     if (tensor_data_is_large) {
-      // Encode the actual tensor data by pointing to the backing store,
-      // and add a special zero-length slice that is really a TensorBuffer
-      // reference that we will unref when we are done.
-      //
-      // TODO(jeff): Note that this approach relies on the fact that
-      // slices are destroyed in the order in which they are added to
-      // the ByteBuffer.  In principle, these could be broken by future
-      // hypothetical grpc_slice-related changes (e.g. the
-      // implementation could decide to destroy 0-length slices
-      // eagerly).  In practice, this does not happen with the current
-      // implementation, and the gpr_slice interface at the moment does
-      // not allow us to do the Tensor-unreferencing in the right way
-      // (since the Tensor pointer is different than the backing store
-      // array pointer).
-      //
-      // TODO(jeff,sanjay): switch to using new
-      // gsr_slice_new_with_user_data interface that allows for
-      // different pointers for the data and the argument to the
-      // destroy function once that has been added integrated into grpc
-      // (see https://github.com/grpc/grpc/pull/7488)
-
       // (E) Encode tensor data, but by sharing backing store
-
-      const TensorBuffer* buf = DMAHelper::buffer(&val);
-      buf->Ref();
-      gpr_slice s1 = gpr_slice_new(
-          const_cast<void*>(static_cast<const void*>(tdata.data())),
-          tdata.size(), do_nothing);
-      slices[1] = ::grpc::Slice(s1, ::grpc::Slice::STEAL_REF);
-
-      gpr_slice s2 =
-          gpr_slice_new(const_cast<TensorBuffer*>(buf), 0, unref_tensorbuffer);
-      slices[2] = ::grpc::Slice(s2, ::grpc::Slice::STEAL_REF);
+      ShareTensorData(val, &slices[1], &slices[2]);
       num_slices += 2;
     }
     size_t total_bytes = 0;
@@ -263,5 +314,202 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              const TensorCodec* codec,
+                              ::grpc::ByteBuffer* result) {
+  if (codec == nullptr || is_dead || !codec->CanEncode(val.dtype())) {
+    EncodeTensorToByteBuffer(is_dead, val, result);
+    return;
+  }
+  RecvTensorResponse response;
+  TensorProto* proto = response.mutable_tensor();
+  Status s = codec->Encode(val, proto->mutable_tensor_content());
+  if (!s.ok() || proto->tensor_content().size() >= val.TotalBytes()) {
+    if (!s.ok()) {
+      LOG(WARNING) << "Sending tensor without encoding it with "
+                   << codec->name() << ": " << s;
+    }
+    EncodeTensorToByteBuffer(is_dead, val, result);
+    return;
+  }
+  proto->set_dtype(val.dtype());
+  val.shape().AsProto(proto->mutable_tensor_shape());
+  response.set_tensor_codec(codec->name());
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+}
+
+// Appends the encoding of "val" as a TensorProto to "*slices". As in
+// EncodeTensorToByteBuffer(), the data of a large tensor is shared rather
+// than copied.
+static void AppendTensorProtoSlices(const Tensor& val,
+                                    std::vector<::grpc::Slice>* slices) {
+  if (!DataTypeCanUseMemcpy(val.dtype())) {
+    TensorProto proto;
+    val.AsProtoTensorContent(&proto);
+    const size_t len = proto.ByteSize();
+    gpr_slice s = gpr_slice_malloc(len);
+    proto.SerializeWithCachedSizesToArray(
+        reinterpret_cast<uint8*>(GPR_SLICE_START_PTR(s)));
+    slices->emplace_back(s, ::grpc::Slice::STEAL_REF);
+    return;
+  }
+
+  static const int kVarintMax64 = 10;  // Max length of varint64 encoding
+  StringPiece tdata = val.tensor_data();
+  const bool tensor_data_is_large = (tdata.size() > kLargeTensorBytes);
+
+  // The skeleton, followed by the tag and length of the tensor content.
+  gtl::InlinedVector<char, 128> space(SkeletonEncodingSizeUpperBound(val) +
+                                      1 + kVarintMax64);
+  io::ProtoEncodeHelper e(space.data(), space.size());
+  EncodeSkeleton(val, &e);
+  e.WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
+                            tdata.size());
+
+  const size_t slice_len = e.size() + (tensor_data_is_large ? 0 : tdata.size());
+  gpr_slice s0 = gpr_slice_malloc(slice_len);
+  memcpy(GPR_SLICE_START_PTR(s0), e.data(), e.size());
+  if (!tensor_data_is_large) {
+    memcpy(GPR_SLICE_START_PTR(s0) + e.size(), tdata.data(), tdata.size());
+  }
+  slices->emplace_back(s0, ::grpc::Slice::STEAL_REF);
+
+  if (tensor_data_is_large) {
+    slices->resize(slices->size() + 2);
+    ShareTensorData(val, &(*slices)[slices->size() - 2], &slices->back());
+  }
+}
+
+void EncodeRunStepRequestToByteBuffer(
+    const RunStepRequest& header,
+    const std::vector<std::pair<string, Tensor>>& feeds,
+    ::grpc::ByteBuffer* result) {
+  std::vector<::grpc::Slice> slices;
+  string encoded_header;
+  header.AppendToString(&encoded_header);
+  slices.emplace_back(
+      gpr_slice_from_copied_buffer(encoded_header.data(),
+                                   encoded_header.size()),
+      ::grpc::Slice::STEAL_REF);
+
+  // Each feed is a length-delimited RunStepRequest::feed field holding a
+  // NamedTensorProto: a small slice with the tags, lengths and name,
+  // followed by the slices of the TensorProto.
+  std::vector<::grpc::Slice> tensor_slices;
+  for (const auto& feed : feeds) {
+    const string& name = feed.first;
+    tensor_slices.clear();
+    AppendTensorProtoSlices(feed.second, &tensor_slices);
+    size_t tensor_bytes = 0;
+    for (const ::grpc::Slice& slice : tensor_slices) {
+      tensor_bytes += slice.size();
+    }
+    const size_t named_tensor_bytes =
+        VarLengthEncodingSize(NamedTensorProto::kNameFieldNumber,
+                              name.size()) +
+        VarLengthEncodingSize(NamedTensorProto::kTensorFieldNumber,
+                              tensor_bytes);
+    // Everything in the feed field but the tensor slices.
+    const size_t prefix_bytes =
+        VarLengthEncodingSize(RunStepRequest::kFeedFieldNumber,
+                              named_tensor_bytes) -
+        tensor_bytes;
+
+    gpr_slice prefix = gpr_slice_malloc(prefix_bytes);
+    io::ProtoEncodeHelper e(
+        reinterpret_cast<char*>(GPR_SLICE_START_PTR(prefix)), prefix_bytes);
+    e.WriteVarlengthBeginning(RunStepRequest::kFeedFieldNumber,
+                              named_tensor_bytes);
+    e.WriteString(NamedTensorProto::kNameFieldNumber, name);
+    e.WriteVarlengthBeginning(NamedTensorProto::kTensorFieldNumber,
+                              tensor_bytes);
+    CHECK_EQ(e.size(), prefix_bytes);
+    slices.emplace_back(prefix, ::grpc::Slice::STEAL_REF);
+    for (const ::grpc::Slice& slice : tensor_slices) {
+      slices.push_back(slice);
+    }
+  }
+  *result = ::grpc::ByteBuffer(slices.data(), slices.size());
+}
+
+void EncodeRecvTensorBatchResponseToByteBuffer(
+    const RecvTensorBatchResponse& header,
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result) {
+  std::vector<::grpc::Slice> slices;
+  string encoded_header;
+  header.AppendToString(&encoded_header);
+  slices.emplace_back(
+      gpr_slice_from_copied_buffer(encoded_header.data(),
+                                   encoded_header.size()),
+      ::grpc::Slice::STEAL_REF);
+
+  // Each response is encoded as a length-delimited
+  // RecvTensorBatchResponse::response field: a small slice holding the
+  // tag and length, followed by the slices of the response itself.
+  std::vector<::grpc::Slice> response_slices;
+  for (const ::grpc::ByteBuffer& response : responses) {
+    const size_t response_bytes = response.Length();
+    const size_t header_bytes =
+        VarLengthEncodingSize(RecvTensorBatchResponse::kResponseFieldNumber,
+                              response_bytes) -
+        response_bytes;
+    gpr_slice header = gpr_slice_malloc(header_bytes);
+    io::ProtoEncodeHelper e(
+        reinterpret_cast<char*>(GPR_SLICE_START_PTR(header)), header_bytes);
+    e.WriteVarlengthBeginning(RecvTensorBatchResponse::kResponseFieldNumber,
+                              response_bytes);
+    CHECK_EQ(e.size(), header_bytes);
+    slices.emplace_back(header, ::grpc::Slice::STEAL_REF);
+
+    response_slices.clear();
+    (void)response.Dump(&response_slices);
+    for (const ::grpc::Slice& slice : response_slices) {
+      slices.push_back(slice);
+    }
+  }
+  *result = ::grpc::ByteBuffer(slices.data(), slices.size());
+}
+
+void EncodePushTensorRequestToByteBuffer(const PushTensorRequest& header,
+                                         const Tensor& val,
+                                         ::grpc::ByteBuffer* result) {
+  std::vector<::grpc::Slice> slices;
+  string encoded_header;
+  header.AppendToString(&encoded_header);
+  slices.emplace_back(
+      gpr_slice_from_copied_buffer(encoded_header.data(),
+                                   encoded_header.size()),
+      ::grpc::Slice::STEAL_REF);
+
+  if (!header.is_dead()) {
+    // The tensor is a length-delimited PushTensorRequest::tensor field: a
+    // small slice with the tag and length, followed by the slices of the
+    // TensorProto.
+    std::vector<::grpc::Slice> tensor_slices;
+    AppendTensorProtoSlices(val, &tensor_slices);
+    size_t tensor_bytes = 0;
+    for (const ::grpc::Slice& slice : tensor_slices) {
+      tensor_bytes += slice.size();
+    }
+    const size_t prefix_bytes =
+        VarLengthEncodingSize(PushTensorRequest::kTensorFieldNumber,
+                              tensor_bytes) -
+        tensor_bytes;
+    gpr_slice prefix = gpr_slice_malloc(prefix_bytes);
+    io::ProtoEncodeHelper e(
+        reinterpret_cast<char*>(GPR_SLICE_START_PTR(prefix)), prefix_bytes);
+    e.WriteVarlengthBeginning(PushTensorRequest::kTensorFieldNumber,
+                              tensor_bytes);
+    CHECK_EQ(e.size(), prefix_bytes);
+    slices.emplace_back(prefix, ::grpc::Slice::STEAL_REF);
+    for (const ::grpc::Slice& slice : tensor_slices) {
+      slices.push_back(slice);
+    }
+  }
+  *result = ::grpc::ByteBuffer(slices.data(), slices.size());
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
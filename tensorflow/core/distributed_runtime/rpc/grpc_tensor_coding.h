@@ -16,13 +16,22 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
 
 namespace tensorflow {
+class PushTensorRequest;
 class Tensor;
+class TensorCodec;
+class RecvTensorBatchResponse;
 class RecvTensorResponse;
+class RunStepRequest;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -51,6 +60,56 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Like EncodeTensorToByteBuffer() above, but if "codec" is non-null and
+// can encode "val", encodes the content of "val" with "codec", and sets
+// "RecvTensorResponse::tensor_codec" to its name. Falls back to the
+// encoding above if the codec fails or does not make the content
+// smaller.
+//
+// Discards original contents of *result.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              const TensorCodec* codec,
+                              ::grpc::ByteBuffer* result);
+
+// Encode "header" followed by a sequence of byte buffers, each of which
+// is parseable as a RecvTensorResponse protocol buffer, into a byte
+// buffer in a format that is parseable as a RecvTensorBatchResponse
+// protocol buffer holding the fields of "header" and those responses in
+// the same order. "header" should not have any responses of its own.
+// The slices of "responses" are shared with "*result" rather than
+// copied.
+//
+// Discards original contents of *result.
+void EncodeRecvTensorBatchResponseToByteBuffer(
+    const RecvTensorBatchResponse& header,
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result);
+
+// Encode "header" followed by "feeds" into a byte buffer in a format
+// that is parseable as a RunStepRequest protocol buffer holding the
+// fields of "header" and, in order, a RunStepRequest::feed for each
+// element of "feeds". "header" should not have any feeds of its own.
+// As in EncodeTensorToByteBuffer(), the data of the large feeds is
+// shared with "*result" rather than copied.
+//
+// Discards original contents of *result.
+void EncodeRunStepRequestToByteBuffer(
+    const RunStepRequest& header,
+    const std::vector<std::pair<string, Tensor>>& feeds,
+    ::grpc::ByteBuffer* result);
+
+// Encode "header" followed by "val" into a byte buffer in a format that
+// is parseable as a PushTensorRequest protocol buffer holding the fields
+// of "header" and "val" as PushTensorRequest::tensor. "header" should
+// not have a tensor of its own, and "val" is ignored if
+// "header.is_dead()". As in EncodeTensorToByteBuffer(), the data of a
+// large tensor is shared with "*result" rather than copied.
+//
+// Discards original contents of *result.
+void EncodePushTensorRequestToByteBuffer(const PushTensorRequest& header,
+                                         const Tensor& val,
+                                         ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
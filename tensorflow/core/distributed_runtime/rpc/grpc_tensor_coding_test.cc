@@ -17,15 +17,117 @@ limitations under the License.
 
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
+
+// Reads the slices of an encoded ::grpc::ByteBuffer in place, the way
+// the gRPC byte buffer reader does on the receiving side.
+class SliceSource : public TensorResponse::Source {
+ public:
+  explicit SliceSource(const ::grpc::ByteBuffer& buf) {
+    (void)buf.Dump(&slices_);
+  }
+  ~SliceSource() override { DeleteStream(); }
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    DeleteStream();
+    stream_ = new (&space_) Stream(&slices_);
+    return stream_;
+  }
+
+ private:
+  class Stream : public protobuf::io::ZeroCopyInputStream {
+   public:
+    explicit Stream(const std::vector<::grpc::Slice>* slices)
+        : slices_(slices) {}
+
+    bool Next(const void** data, int* size) override {
+      while (index_ < slices_->size()) {
+        const ::grpc::Slice& slice = (*slices_)[index_];
+        if (offset_ < slice.size()) {
+          *data = slice.begin() + offset_;
+          *size = slice.size() - offset_;
+          byte_count_ += *size;
+          offset_ = 0;
+          ++index_;
+          return true;
+        }
+        offset_ = 0;
+        ++index_;
+      }
+      return false;
+    }
+
+    void BackUp(int count) override {
+      --index_;
+      offset_ = (*slices_)[index_].size() - count;
+      byte_count_ -= count;
+    }
+
+    bool Skip(int count) override {
+      const void* data;
+      int size;
+      while (count > 0) {
+        if (!Next(&data, &size)) return false;
+        if (size > count) {
+          BackUp(size - count);
+          size = count;
+        }
+        count -= size;
+      }
+      return true;
+    }
+
+    protobuf_int64 ByteCount() const override { return byte_count_; }
+
+   private:
+    const std::vector<::grpc::Slice>* const slices_;
+    size_t index_ = 0;
+    size_t offset_ = 0;
+    protobuf_int64 byte_count_ = 0;
+  };
+
+  void DeleteStream() {
+    if (stream_) {
+      stream_->~Stream();
+    }
+  }
+
+  std::vector<::grpc::Slice> slices_;
+  Stream* stream_ = nullptr;  // Points into space_ if non-nullptr
+  char space_[sizeof(Stream)];
+};
+
 class GrpcTensorCodingTest : public ::testing::Test {
  public:
   void Validate(const Tensor& t, bool is_dead) {
@@ -100,4 +202,258 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, RecvTensorBatch) {
+  // Include a tensor large enough to share its backing store with the
+  // encoded buffer.
+  std::vector<Tensor> tensors;
+  tensors.push_back(test::AsTensor<float>({1.0, 2.0, 3.0}));
+  tensors.push_back(test::AsTensor<int32>({}, TensorShape({0})));
+  Tensor large(DT_INT64, TensorShape({1000}));
+  large.flat<int64>().setConstant(7);
+  tensors.push_back(large);
+  tensors.push_back(test::AsTensor<string>({"a", "bc"}));
+
+  std::vector<::grpc::ByteBuffer> responses(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    grpc::EncodeTensorToByteBuffer(i == 1 /* is_dead */, tensors[i],
+                                   &responses[i]);
+  }
+  RecvTensorBatchResponse header;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    header.add_key_index(tensors.size() - i);
+  }
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRecvTensorBatchResponseToByteBuffer(header, responses, &buf);
+
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  RecvTensorBatchResponse batch;
+  ASSERT_TRUE(batch.ParseFromString(tmp));
+  ASSERT_EQ(tensors.size(), static_cast<size_t>(batch.response_size()));
+  ASSERT_EQ(tensors.size(), static_cast<size_t>(batch.key_index_size()));
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_EQ(tensors.size() - i, batch.key_index(i));
+    EXPECT_EQ(i == 1, batch.response(i).is_dead());
+    Tensor result_tensor;
+    EXPECT_TRUE(result_tensor.FromProto(batch.response(i).tensor()));
+    EXPECT_EQ(tensors[i].dtype(), result_tensor.dtype());
+    EXPECT_EQ(tensors[i].shape().DebugString(),
+              result_tensor.shape().DebugString());
+    EXPECT_EQ(tensors[i].DebugString(), result_tensor.DebugString());
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, RunStepRequest) {
+  RunStepRequest header;
+  header.set_session_handle("session");
+  header.add_fetch("y:0");
+  header.add_target("train");
+  header.mutable_options()->set_timeout_in_ms(10);
+
+  // Include a tensor large enough to share its backing store with the
+  // encoded buffer, and one that takes the proto path.
+  std::vector<std::pair<string, Tensor>> feeds;
+  feeds.emplace_back("a:0", test::AsTensor<float>({1.0, 2.0, 3.0}));
+  Tensor large(DT_FLOAT, TensorShape({100, 1000}));
+  large.flat<float>().setConstant(3.5);
+  feeds.emplace_back("b:0", large);
+  feeds.emplace_back("", test::AsTensor<int32>({}, TensorShape({0})));
+  feeds.emplace_back("c:0", test::AsTensor<string>({"a", "", "bcd"}));
+
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRunStepRequestToByteBuffer(header, feeds, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  RunStepRequest request;
+  ASSERT_TRUE(request.ParseFromString(tmp));
+  EXPECT_EQ("session", request.session_handle());
+  ASSERT_EQ(1, request.fetch_size());
+  EXPECT_EQ("y:0", request.fetch(0));
+  ASSERT_EQ(1, request.target_size());
+  EXPECT_EQ("train", request.target(0));
+  EXPECT_EQ(10, request.options().timeout_in_ms());
+  ASSERT_EQ(feeds.size(), static_cast<size_t>(request.feed_size()));
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    EXPECT_EQ(feeds[i].first, request.feed(i).name());
+    Tensor result_tensor;
+    EXPECT_TRUE(result_tensor.FromProto(request.feed(i).tensor()));
+    EXPECT_EQ(feeds[i].second.dtype(), result_tensor.dtype());
+    EXPECT_EQ(feeds[i].second.shape().DebugString(),
+              result_tensor.shape().DebugString());
+    EXPECT_EQ(feeds[i].second.DebugString(), result_tensor.DebugString());
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, PushTensorRequest) {
+  Tensor large(DT_FLOAT, TensorShape({100, 1000}));
+  large.flat<float>().setConstant(3.5);
+  for (const Tensor& val :
+       {test::AsTensor<float>({1.0, 2.0, 3.0}), large,
+        test::AsTensor<string>({"a", "", "bcd"})}) {
+    for (bool is_dead : {false, true}) {
+      PushTensorRequest header;
+      header.set_step_id(17);
+      header.set_rendezvous_key("key");
+      header.set_is_dead(is_dead);
+
+      ::grpc::ByteBuffer buf;
+      grpc::EncodePushTensorRequestToByteBuffer(header, val, &buf);
+      std::vector<::grpc::Slice> slices;
+      (void)buf.Dump(&slices);
+      string tmp;
+      for (const auto& s : slices) {
+        tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+      }
+
+      PushTensorRequest request;
+      ASSERT_TRUE(request.ParseFromString(tmp));
+      EXPECT_EQ(17, request.step_id());
+      EXPECT_EQ("key", request.rendezvous_key());
+      EXPECT_EQ(is_dead, request.is_dead());
+      EXPECT_EQ(!is_dead, request.has_tensor());
+      if (!is_dead) {
+        Tensor result_tensor;
+        EXPECT_TRUE(result_tensor.FromProto(request.tensor()));
+        EXPECT_EQ(val.DebugString(), result_tensor.DebugString());
+      }
+    }
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, ParseTensorResponseFromSlices) {
+  // The large tensor's data is encoded in its own slice, which the
+  // receiver parses straight into the allocated tensor.
+  std::vector<Tensor> tensors;
+  tensors.push_back(test::AsTensor<float>({1.0, 2.0, 3.0}));
+  Tensor large(DT_FLOAT, TensorShape({100, 1000}));
+  large.flat<float>().setConstant(3.5);
+  tensors.push_back(large);
+  tensors.push_back(test::AsTensor<string>({"a", "", "bcd"}, {3, 1}));
+
+  DummyDevice cpu_device(Env::Default());
+  for (const Tensor& t : tensors) {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToByteBuffer(false, t, &buf);
+    SliceSource source(buf);
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_FALSE(response.metadata().is_dead());
+    EXPECT_EQ(t.dtype(), response.tensor().dtype());
+    EXPECT_EQ(t.shape().DebugString(), response.tensor().shape().DebugString());
+    EXPECT_EQ(t.DebugString(), response.tensor().DebugString());
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, ParseEncodedTensorResponse) {
+  // Values that fp16 and bfloat16 represent exactly.
+  Tensor floats(DT_FLOAT, TensorShape({10, 100}));
+  auto flat = floats.flat<float>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    flat(i) = (i % 7) * 0.5f - 1.0f;
+  }
+  Tensor zeros(DT_INT64, TensorShape({1000}));
+  zeros.flat<int64>().setZero();
+
+  DummyDevice cpu_device(Env::Default());
+  for (const string& codec_name : {"fp16", "bfloat16", "snappy"}) {
+    const TensorCodec* codec = LookupTensorCodec(codec_name);
+    ASSERT_NE(nullptr, codec);
+    for (const Tensor& t : {floats, zeros}) {
+      ::grpc::ByteBuffer buf;
+      grpc::EncodeTensorToByteBuffer(false, t, codec, &buf);
+      SliceSource source(buf);
+      TensorResponse response;
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      if (codec->CanEncode(t.dtype())) {
+        EXPECT_EQ(codec_name, response.metadata().tensor_codec());
+        EXPECT_LT(buf.Length(), t.TotalBytes());
+      } else {
+        EXPECT_EQ("", response.metadata().tensor_codec());
+      }
+      EXPECT_EQ(t.dtype(), response.tensor().dtype());
+      EXPECT_EQ(t.shape().DebugString(),
+                response.tensor().shape().DebugString());
+      EXPECT_EQ(t.tensor_data(), response.tensor().tensor_data());
+    }
+  }
+}
+
+static Tensor MakeBenchmarkTensor(int bytes) {
+  Tensor t(DT_FLOAT, TensorShape({bytes / static_cast<int>(sizeof(float))}));
+  t.flat<float>().setConstant(1.0);
+  return t;
+}
+
+// Encoding that shares the tensor's buffer with the ByteBuffer.
+static void BM_EncodeTensorToByteBuffer(int iters, int bytes) {
+  testing::StopTiming();
+  Tensor t = MakeBenchmarkTensor(bytes);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToByteBuffer(false, t, &buf);
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes);
+}
+BENCHMARK(BM_EncodeTensorToByteBuffer)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->Arg(1 << 28);
+
+// Encoding through a RecvTensorResponse proto, for comparison.
+static void BM_EncodeTensorViaProto(int iters, int bytes) {
+  testing::StopTiming();
+  Tensor t = MakeBenchmarkTensor(bytes);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    RecvTensorResponse response;
+    t.AsProtoTensorContent(response.mutable_tensor());
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeRecvTensorResponseToByteBuffer(response, &buf);
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes);
+}
+BENCHMARK(BM_EncodeTensorViaProto)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->Arg(1 << 28);
+
+// Parsing of an encoded ByteBuffer into an allocated tensor.
+static void BM_ParseTensorResponse(int iters, int bytes) {
+  testing::StopTiming();
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, MakeBenchmarkTensor(bytes), &buf);
+  DummyDevice cpu_device(Env::Default());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    SliceSource source(buf);
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_CHECK_OK(response.ParseFrom(&source));
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes);
+}
+BENCHMARK(BM_ParseTensorResponse)
+    ->Arg(1 << 10)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->Arg(1 << 28);
+
 }  // namespace tensorflow
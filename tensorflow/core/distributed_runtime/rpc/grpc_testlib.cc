@@ -56,7 +56,9 @@ Status TestCluster::MakeTestCluster(const SessionOptions& options, int n,
          /* see grpc_testlib_server.cc for flags */
          tf_jobs, "--tf_job=localhost", strings::StrCat("--tf_task=", i),
          strings::StrCat("--num_cpus=", num_cpus),
-         strings::StrCat("--num_gpus=", num_gpus)});
+         strings::StrCat("--num_gpus=", num_gpus),
+         strings::StrCat("--rpc_options=",
+                         options.config.rpc_options().ShortDebugString())});
     ret->subprocesses_.emplace_back(testing::CreateSubProcess(argv));
     bool success = ret->subprocesses_[i]->Start();
     if (!success) {
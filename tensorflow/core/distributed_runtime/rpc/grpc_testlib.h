@@ -42,10 +42,10 @@ namespace test {
 class TestCluster {
  public:
   // Creates a new test cluster based on the given `options` (which
-  // configure the number of devices of each type) and a count of
-  // processes `n`. On success, the test cluster is stored in
-  // *out_cluster, and this function returns OK. Otherwise an error is
-  // returned.
+  // configure the number of devices of each type, and the RPC options
+  // of the servers) and a count of processes `n`. On success, the test
+  // cluster is stored in *out_cluster, and this function returns OK.
+  // Otherwise an error is returned.
   static Status MakeTestCluster(const SessionOptions& options, int n,
                                 std::unique_ptr<TestCluster>* out_cluster);
   ~TestCluster();
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/protobuf/cluster.pb.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/command_line_flags.h"
@@ -37,7 +38,7 @@ namespace {
 
 Status FillServerDef(const string& job_spec, const string& job_name,
                      int num_cpus, int num_gpus, int task_index,
-                     ServerDef* options) {
+                     const string& rpc_options, ServerDef* options) {
   options->set_protocol("grpc");
   options->set_job_name(job_name);
   options->set_task_index(task_index);
@@ -69,6 +70,10 @@ Status FillServerDef(const string& job_spec, const string& job_name,
   ConfigProto* config = options->mutable_default_session_config();
   (*config->mutable_device_count())["CPU"] = num_cpus;
   (*config->mutable_device_count())["GPU"] = num_gpus;
+  if (!protobuf::TextFormat::ParseFromString(rpc_options,
+                                             config->mutable_rpc_options())) {
+    return errors::InvalidArgument("Invalid RPC options: ", rpc_options);
+  }
   return Status::OK();
 }
 
@@ -82,12 +87,15 @@ int main(int argc, char* argv[]) {
   int num_cpus = 1;
   int num_gpus = 0;
   int task_index = 0;
+  tensorflow::string rpc_options;
   std::vector<tensorflow::Flag> flag_list = {
       tensorflow::Flag("tf_jobs", &job_spec, "job specification"),
       tensorflow::Flag("tf_job", &job_name, "job name"),
       tensorflow::Flag("tf_task", &task_index, "task index"),
       tensorflow::Flag("num_cpus", &num_cpus, "number of CPUs"),
       tensorflow::Flag("num_gpus", &num_gpus, "number of GPUs"),
+      tensorflow::Flag("rpc_options", &rpc_options,
+                       "RPCOptions of the server, in text format"),
   };
   tensorflow::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
   const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
@@ -97,8 +105,9 @@ int main(int argc, char* argv[]) {
   }
 
   tensorflow::ServerDef def;
-  tensorflow::Status s = tensorflow::FillServerDef(job_spec, job_name, num_cpus,
-                                                   num_gpus, task_index, &def);
+  tensorflow::Status s =
+      tensorflow::FillServerDef(job_spec, job_name, num_cpus, num_gpus,
+                                task_index, rpc_options, &def);
   if (!s.ok()) {
     LOG(ERROR) << "Could not parse job spec: " << s.error_message() << "\n"
                << usage;
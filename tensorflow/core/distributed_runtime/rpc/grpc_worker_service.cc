@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
+#include <vector>
 
 #include "grpc++/alarm.h"
 #include "grpc++/server_builder.h"
@@ -36,14 +38,17 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -52,13 +57,25 @@ namespace {
 
 class GrpcWorkerService : public AsyncServiceInterface {
  public:
-  GrpcWorkerService(GrpcWorker* worker, ::grpc::ServerBuilder* builder)
+  GrpcWorkerService(GrpcWorker* worker, const RPCOptions& rpc_options,
+                    ::grpc::ServerBuilder* builder)
       : worker_(worker), is_shutdown_(false) {
     builder->RegisterService(&worker_service_);
-    cq_ = builder->AddCompletionQueue();
+    const int64 num_cqs =
+        std::max<int64>(rpc_options.grpc_worker_completion_queues(), 1);
+    // Every completion queue needs at least one polling thread.
+    num_polling_threads_ =
+        std::max<int64>(rpc_options.grpc_worker_polling_threads(), num_cqs);
+    for (int64 i = 0; i < num_cqs; ++i) {
+      cqs_.push_back(builder->AddCompletionQueue());
+    }
   }
 
-  ~GrpcWorkerService() override { delete shutdown_alarm_; }
+  ~GrpcWorkerService() override {
+    for (::grpc::Alarm* alarm : shutdown_alarms_) {
+      delete alarm;
+    }
+  }
 
   void Shutdown() override {
     bool did_shutdown = false;
@@ -74,14 +91,16 @@ class GrpcWorkerService : public AsyncServiceInterface {
       // NOTE(mrry): This enqueues a special event (with a null tag)
       // that causes the completion queue to be shut down on the
       // polling thread.
-      shutdown_alarm_ =
-          new ::grpc::Alarm(cq_.get(), gpr_now(GPR_CLOCK_MONOTONIC), nullptr);
+      for (const auto& cq : cqs_) {
+        shutdown_alarms_.push_back(new ::grpc::Alarm(
+            cq.get(), gpr_now(GPR_CLOCK_MONOTONIC), nullptr));
+      }
     }
   }
 
 // This macro creates a new request for the given RPC method name
 // (e.g., `ENQUEUE_REQUEST(GetStatus, false);`), and enqueues it on
-// `this->cq_`.
+// the next of `this->cqs_`.
 //
 // This macro is invoked one or more times for each RPC method to
 // ensure that there are sufficient completion queue entries to
@@ -97,17 +116,16 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Call<GrpcWorkerService, grpc::WorkerService::AsyncService,       \
            method##Request, method##Response>::                        \
           EnqueueRequestForMethod(                                     \
-              &worker_service_, cq_.get(),                             \
+              &worker_service_, NextCompletionQueue(),                 \
               static_cast<int>(GrpcWorkerMethod::k##method),           \
               &GrpcWorkerService::method##Handler, (supports_cancel)); \
     }                                                                  \
   } while (0)
 
-  // This method blocks forever handling requests from the completion queue.
+  // This method blocks forever handling requests from the completion queues.
   void HandleRPCsLoop() override {
     // TODO(mrry): This may require performance engineering. We can
-    // add more threads to service the completion queue, and add more
-    // of various request types if they are short and frequent.
+    // add more of various request types if they are short and frequent.
     // Currently we allow unbounded numbers of pending calls for each
     // method, by re-enqueuing a request before the previous one
     // completes, and we may decide to bound some of the request
@@ -120,23 +138,68 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
     // TODO(mrry): Determine a better policy for enqueuing the appropriate
     // number of each request type.
-    for (int i = 0; i < 1000; ++i) {
+    const int num_cqs = cqs_.size();
+    for (int i = 0; i < 1000 * num_cqs; ++i) {
       EnqueueRecvTensorRequestRaw();
     }
-    for (int i = 0; i < 100; ++i) {
+    for (int i = 0; i < 100 * num_cqs; ++i) {
+      EnqueueRecvTensorBatchRequestRaw();
+    }
+    for (int i = 0; i < 100 * num_cqs; ++i) {
+      ENQUEUE_REQUEST(PushTensor, false);
+    }
+    for (int i = 0; i < 100 * num_cqs; ++i) {
       ENQUEUE_REQUEST(RunGraph, true);
     }
-    for (int i = 0; i < 100; ++i) {
+    for (int i = 0; i < 100 * num_cqs; ++i) {
       ENQUEUE_REQUEST(CleanupGraph, false);
     }
 
     ENQUEUE_REQUEST(Logging, false);
     ENQUEUE_REQUEST(Tracing, false);
 
+    // The calling thread polls the first completion queue, and the
+    // other polling threads are assigned to the queues in turn.
+    std::vector<std::unique_ptr<Thread>> polling_threads;
+    for (int64 i = 1; i < num_polling_threads_; ++i) {
+      ::grpc::ServerCompletionQueue* cq = cqs_[i % num_cqs].get();
+      polling_threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "TF_worker_service_poller",
+          [this, cq]() { PollCompletionQueue(cq); }));
+    }
+    PollCompletionQueue(cqs_[0].get());
+    // Blocks until the other polling threads exit.
+    polling_threads.clear();
+  }
+
+ private:
+  GrpcWorker* worker_ = nullptr;  // Not owned.
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>> cqs_;
+  int64 num_polling_threads_;
+
+  grpc::WorkerService::AsyncService worker_service_;
+
+  mutex shutdown_mu_;
+  bool is_shutdown_ GUARDED_BY(shutdown_mu_);
+  std::vector<::grpc::Alarm*> shutdown_alarms_;
+  // The index in `cqs_` of the queue on which the next request is enqueued.
+  size_t next_cq_ GUARDED_BY(shutdown_mu_) = 0;
+
+  // Returns the completion queue for the next enqueued request. Requests
+  // are spread over the queues in turn.
+  ::grpc::ServerCompletionQueue* NextCompletionQueue()
+      EXCLUSIVE_LOCKS_REQUIRED(shutdown_mu_) {
+    ::grpc::ServerCompletionQueue* cq = cqs_[next_cq_].get();
+    next_cq_ = (next_cq_ + 1) % cqs_.size();
+    return cq;
+  }
+
+  // Handles the events of "cq" until it is shut down.
+  void PollCompletionQueue(::grpc::ServerCompletionQueue* cq) {
     void* tag;
     bool ok;
 
-    while (cq_->Next(&tag, &ok)) {
+    while (cq->Next(&tag, &ok)) {
       UntypedCall<GrpcWorkerService>::Tag* callback_tag =
           static_cast<UntypedCall<GrpcWorkerService>::Tag*>(tag);
       if (callback_tag) {
@@ -144,21 +207,11 @@ class GrpcWorkerService : public AsyncServiceInterface {
       } else {
         // NOTE(mrry): A null `callback_tag` indicates that this is
         // the shutdown alarm.
-        cq_->Shutdown();
+        cq->Shutdown();
       }
     }
   }
 
- private:
-  GrpcWorker* worker_ = nullptr;  // Not owned.
-  std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
-
-  grpc::WorkerService::AsyncService worker_service_;
-
-  mutex shutdown_mu_;
-  bool is_shutdown_ GUARDED_BY(shutdown_mu_);
-  ::grpc::Alarm* shutdown_alarm_ = nullptr;
-
   void Schedule(std::function<void()> f) {
     worker_->env()->compute_pool->Schedule(std::move(f));
   }
@@ -255,6 +308,32 @@ class GrpcWorkerService : public AsyncServiceInterface {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandlerRaw(
+      WorkerCall<RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(call_opts, &call->request, &call->response,
+                                    [call, call_opts](const Status& s) {
+                                      call->ClearCancelCallback();
+                                      delete call_opts;
+                                      call->SendResponse(ToGrpcStatus(s));
+                                    });
+    });
+    EnqueueRecvTensorBatchRequestRaw();
+  }
+
+  void PushTensorHandler(
+      WorkerCall<PushTensorRequest, PushTensorResponse>* call) {
+    Schedule([this, call]() {
+      worker_->PushTensorAsync(&call->request, &call->response,
+                               [call](const Status& s) {
+                                 call->SendResponse(ToGrpcStatus(s));
+                               });
+    });
+    ENQUEUE_REQUEST(PushTensor, false);
+  }
+
   void CleanupGraphHandler(
       WorkerCall<CleanupGraphRequest, CleanupGraphResponse>* call) {
     Schedule([this, call]() {
@@ -287,13 +366,26 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Call<GrpcWorkerService, grpc::WorkerService::AsyncService,
            RecvTensorRequest, ::grpc::ByteBuffer>::
           EnqueueRequestForMethod(
-              &worker_service_, cq_.get(),
+              &worker_service_, NextCompletionQueue(),
               static_cast<int>(GrpcWorkerMethod::kRecvTensor),
               &GrpcWorkerService::RecvTensorHandlerRaw,
               true /* supports cancel*/);
     }
   }
 
+  void EnqueueRecvTensorBatchRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerService, grpc::WorkerService::AsyncService,
+           RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              &worker_service_, NextCompletionQueue(),
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+              &GrpcWorkerService::RecvTensorBatchHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerService);
 };
 
@@ -322,19 +414,264 @@ void GrpcWorker::RecvTensorAsync(CallOptions* opts,
     return;
   }
 
+  const TensorCodec* codec = nullptr;
+  if (!request->tensor_codec().empty()) {
+    codec = LookupTensorCodec(request->tensor_codec());
+    if (codec == nullptr) {
+      LOG(WARNING) << "Unknown tensor codec " << request->tensor_codec()
+                   << " requested for " << key;
+    }
+  }
+
   // Request the tensor associated with the rendezvous key. Any time
   // while waiting for the tensor to be produced, up until the start
   // of execution of the callback lambda body below, an RPC
   // cancellation should abort the rendezvous.
   opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  RecvLocalToByteBuffer(step_id, parsed, src_dev, codec,
+                        request->tensor_codec_min_bytes(),
+                        [opts]() { opts->ClearCancelCallback(); }, response,
+                        std::move(done));
+}
+
+// The state of a RecvTensorBatch call. Guarded by the batch_mu_ of the
+// worker, except for the const members.
+struct GrpcWorker::BatchCall {
+  BatchCall(CallOptions* opts, ::grpc::ByteBuffer* response,
+            StatusCallback done)
+      : opts(opts), response(response), done(std::move(done)) {}
+
+  CallOptions* const opts;
+  ::grpc::ByteBuffer* const response;
+  const StatusCallback done;
+
+  // True until the receives of all of the keys have been started, so
+  // that the tensors that are already available are returned together.
+  bool starting = true;
+  Status status;
+  RecvTensorBatchResponse header;  // Holds the key indices.
+  std::vector<::grpc::ByteBuffer> responses;
+  // The receives whose tensors have not been produced yet.
+  std::vector<BatchRecv*> waiting;
+};
+
+// The receive of one key of a RecvTensorBatch call. It outlives the
+// call if the tensor is produced after the call has returned, until the
+// key is requested again. Guarded by the batch_mu_ of the worker, except
+// for the const members and "response", which is only accessed by the
+// receive until it is done.
+struct GrpcWorker::BatchRecv {
+  BatchRecv(int64 step_id, const string& key) : step_id(step_id), key(key) {}
+
+  const int64 step_id;
+  const string key;
+  ::grpc::ByteBuffer response;
+
+  bool done = false;
+  Status status;
+  // The call waiting for the tensor, if any, and the index of the key in
+  // its request.
+  BatchCall* waiter = nullptr;
+  int key_index = -1;
+  // True if the step was cleaned up before the receive was done, in
+  // which case it is no longer in batch_recvs_.
+  bool orphaned = false;
+};
+
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      ::grpc::ByteBuffer* response,
+                                      StatusCallback done) {
+  const int64 step_id = request->step_id();
+  const int num_keys = request->rendezvous_key_size();
+  TRACEPRINTF("RecvTensorBatch: %lld %d keys", step_id, num_keys);
+  std::vector<Rendezvous::ParsedKey> parsed(num_keys);
+  std::vector<Device*> src_devs(num_keys, nullptr);
+  Status s;
+  for (int i = 0; s.ok() && i < num_keys; ++i) {
+    s = Rendezvous::ParseKey(request->rendezvous_key(i), &parsed[i]);
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_devs[i]);
+    }
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  if (num_keys == 0) {
+    grpc::EncodeRecvTensorBatchResponseToByteBuffer(RecvTensorBatchResponse(),
+                                                    {}, response);
+    done(Status::OK());
+    return;
+  }
+
+  // As in RecvTensorAsync(), an RPC cancellation aborts the step until
+  // the call returns.
+  opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  BatchCall* call = new BatchCall(opts, response, std::move(done));
+  // The receives of the keys that were not requested before, and the
+  // indices of these keys.
+  std::vector<BatchRecv*> new_recvs;
+  std::vector<int> new_recv_keys;
+  {
+    mutex_lock l(batch_mu_);
+    auto& step_recvs = batch_recvs_[step_id];
+    for (int i = 0; i < num_keys; ++i) {
+      const string& key = request->rendezvous_key(i);
+      BatchRecv*& recv = step_recvs[key];
+      if (recv == nullptr) {
+        recv = new BatchRecv(step_id, key);
+        new_recvs.push_back(recv);
+        new_recv_keys.push_back(i);
+      } else if (recv->waiter != nullptr) {
+        call->status.Update(errors::InvalidArgument(
+            "Rendezvous key ", key,
+            " is requested by two RecvTensorBatch calls at once."));
+        continue;
+      }
+      if (recv->done) {
+        TakeBatchRecvLocked(recv, i, call);
+        step_recvs.erase(key);
+      } else {
+        recv->waiter = call;
+        recv->key_index = i;
+        call->waiting.push_back(recv);
+      }
+    }
+    if (step_recvs.empty()) {
+      batch_recvs_.erase(step_id);
+    }
+  }
+  for (size_t i = 0; i < new_recvs.size(); ++i) {
+    BatchRecv* recv = new_recvs[i];
+    const int key_index = new_recv_keys[i];
+    RecvLocalToByteBuffer(
+        step_id, parsed[key_index], src_devs[key_index], nullptr /* codec */,
+        0, []() {}, &recv->response,
+        [this, recv](const Status& s) { BatchRecvDone(recv, s); });
+  }
+  bool reply;
+  {
+    mutex_lock l(batch_mu_);
+    call->starting = false;
+    reply = ReadyToReplyLocked(call);
+  }
+  if (reply) {
+    ReplyBatch(call);
+  }
+}
+
+void GrpcWorker::BatchRecvDone(BatchRecv* recv, const Status& s) {
+  BatchCall* call = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    recv->done = true;
+    recv->status = s;
+    if (recv->waiter == nullptr) {
+      // Keep the tensor until it is requested again.
+      if (recv->orphaned) {
+        delete recv;
+      }
+      return;
+    }
+    call = recv->waiter;
+    call->waiting.erase(
+        std::find(call->waiting.begin(), call->waiting.end(), recv));
+    if (!recv->orphaned) {
+      auto it = batch_recvs_.find(recv->step_id);
+      it->second.erase(recv->key);
+      if (it->second.empty()) {
+        batch_recvs_.erase(it);
+      }
+    }
+    TakeBatchRecvLocked(recv, recv->key_index, call);
+    if (!ReadyToReplyLocked(call)) {
+      return;
+    }
+  }
+  ReplyBatch(call);
+}
+
+void GrpcWorker::TakeBatchRecvLocked(BatchRecv* recv, int key_index,
+                                     BatchCall* call) {
+  call->status.Update(recv->status);
+  if (recv->status.ok()) {
+    call->header.add_key_index(key_index);
+    call->responses.push_back(recv->response);
+  }
+  delete recv;
+}
+
+bool GrpcWorker::ReadyToReplyLocked(BatchCall* call) {
+  if (call->starting ||
+      (call->status.ok() && call->responses.empty() &&
+       !call->waiting.empty())) {
+    return false;
+  }
+  for (BatchRecv* recv : call->waiting) {
+    recv->waiter = nullptr;
+    recv->key_index = -1;
+  }
+  call->waiting.clear();
+  return true;
+}
+
+void GrpcWorker::ReplyBatch(BatchCall* call) {
+  call->opts->ClearCancelCallback();
+  if (call->status.ok()) {
+    grpc::EncodeRecvTensorBatchResponseToByteBuffer(
+        call->header, call->responses, call->response);
+  }
+  call->done(call->status);
+  delete call;
+}
+
+void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
+                                   CleanupGraphResponse* response,
+                                   StatusCallback done) {
+  {
+    mutex_lock l(batch_mu_);
+    auto it = batch_recvs_.find(request->step_id());
+    if (it != batch_recvs_.end()) {
+      for (auto& key_and_recv : it->second) {
+        BatchRecv* recv = key_and_recv.second;
+        if (recv->done) {
+          delete recv;
+        } else {
+          // Cleaning up the rendezvous below aborts the receive.
+          recv->orphaned = true;
+        }
+      }
+      batch_recvs_.erase(it);
+    }
+  }
+  Worker::CleanupGraphAsync(request, response, std::move(done));
+}
+
+// Receives the tensor for "parsed" from the local rendezvous and encodes
+// it into "*response" as a RecvTensorResponse. If "codec" is non-null,
+// tensors of at least "codec_min_bytes" bytes are encoded with it. Calls
+// "recv_done" when the tensor has been produced and before it is encoded.
+void GrpcWorker::RecvLocalToByteBuffer(int64 step_id,
+                                       const Rendezvous::ParsedKey& parsed,
+                                       Device* src_dev,
+                                       const TensorCodec* codec,
+                                       int64 codec_min_bytes,
+                                       std::function<void()> recv_done,
+                                       ::grpc::ByteBuffer* response,
+                                       StatusCallback done) {
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, response, done, src_dev](const Status& status,
-                                      const Rendezvous::Args& send_args,
-                                      const Rendezvous::Args& recv_args,
-                                      const Tensor& val, const bool is_dead) {
-        opts->ClearCancelCallback();
+      [recv_done, response, done, src_dev, codec, codec_min_bytes](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& val,
+          const bool is_dead) {
+        recv_done();
         if (status.ok()) {
+          const TensorCodec* val_codec =
+              static_cast<int64>(val.TotalBytes()) >= codec_min_bytes
+                  ? codec
+                  : nullptr;
           // DMA can only be used for Tensors that do not fall into
           // the following three odd edge cases: 1) a zero-size
           // buffer, 2) a dead tensor which has an uninit value, and
@@ -347,37 +684,43 @@ void GrpcWorker::RecvTensorAsync(CallOptions* opts,
             if (src_dev->tensorflow_gpu_device_info() && (!on_host)) {
 #if GOOGLE_CUDA
               const DeviceContext* send_dev_context = send_args.device_context;
-              RecvTensorResponse* tmp = new RecvTensorResponse;
-              tmp->set_is_dead(is_dead);
               CHECK(send_dev_context)
                   << "send dev name: " << src_dev->name()
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
-              // "val" is on a GPU. Uses GPUUtil to fill the response proto.
-              StatusCallback response_ready = [response, done,
-                                               tmp](const Status& s) {
+              if (is_dead || val.TotalBytes() == 0) {
+                // There is no data to copy out of GPU memory.
+                grpc::EncodeTensorToByteBuffer(
+                    is_dead, is_dead ? Tensor(val.dtype()) : val, response);
+                done(Status::OK());
+                return;
+              }
+              // "val" is on a GPU. Copy it into pinned host memory, and
+              // encode the copy, which lets EncodeTensorToByteBuffer()
+              // share its buffer with the response instead of serializing
+              // it through a TensorProto.
+              AllocatorAttributes alloc_attrs;
+              alloc_attrs.set_gpu_compatible(true);
+              alloc_attrs.set_on_host(true);
+              Tensor* copy = new Tensor(src_dev->GetAllocator(alloc_attrs),
+                                        val.dtype(), val.shape());
+              StatusCallback copy_ready = [response, done, copy,
+                                           val_codec](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                tmp->set_send_start_micros(Env::Default()->NowMicros());
-
-                grpc::EncodeRecvTensorResponseToByteBuffer(*tmp, response);
+                if (s.ok()) {
+                  grpc::EncodeTensorToByteBuffer(false, *copy, val_codec,
+                                                 response);
+                }
                 done(s);
-                delete tmp;
+                delete copy;
               };
-
-              // TODO (jeff,sanjay,mrry): Avoid copy on GPU path by
-              // modifying GPUUtil::SetProtoFromGPU to accept a
-              // ::grpc::ByteBuffer to serialize to, rather than
-              // encoding into a protocol buffer and then
-              // serializing that (i.e. figure out how to use
-              // EncodeTensorToByteBuffer on this path rather than
-              // EncodeRecvTensorResponseToByteBuffer)
-              GPUUtil::SetProtoFromGPU(val, src_dev, send_dev_context,
-                                       tmp->mutable_tensor(), is_dead,
-                                       response_ready);
+              GPUUtil::CopyGPUTensorToCPU(src_dev, send_dev_context, &val,
+                                          copy, copy_ready);
 #else
               done(errors::Internal("No GPU device in process"));
 #endif  // GOOGLE_CUDA
             } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+              grpc::EncodeTensorToByteBuffer(is_dead, val, val_codec,
+                                             response);
               done(Status::OK());
             }
           }
@@ -395,9 +738,10 @@ std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* env) {
 }
 
 std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
-    GrpcWorker* worker, ::grpc::ServerBuilder* builder) {
+    GrpcWorker* worker, const RPCOptions& rpc_options,
+    ::grpc::ServerBuilder* builder) {
   return std::unique_ptr<AsyncServiceInterface>(
-      new GrpcWorkerService(worker, builder));
+      new GrpcWorkerService(worker, rpc_options, builder));
 }
 
 }  // namespace tensorflow
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
+#include <unordered_map>
+
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace grpc {
 class ByteBuffer;
@@ -26,6 +30,8 @@ class ServerBuilder;
 namespace tensorflow {
 
 class AsyncServiceInterface;
+class RPCOptions;
+class TensorCodec;
 struct WorkerEnv;
 struct WorkerSession;
 
@@ -37,14 +43,61 @@ class GrpcWorker : public Worker {
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        ::grpc::ByteBuffer* response, StatusCallback done);
 
+  // Receives the requested tensors, and encodes them into a single
+  // RecvTensorBatchResponse without copying the tensor data of each
+  // RecvTensorResponse. Returns as soon as at least one of the tensors
+  // is available; the receives of the others stay pending until they
+  // are requested again, or the step is cleaned up.
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            ::grpc::ByteBuffer* response, StatusCallback done);
+
+  // Also drops the pending batched receives of the step.
+  void CleanupGraphAsync(const CleanupGraphRequest* request,
+                         CleanupGraphResponse* response,
+                         StatusCallback done) override;
+
   WorkerEnv* env();
+
+ private:
+  struct BatchCall;
+  struct BatchRecv;
+
+  // Called when the tensor of "recv" has been received and encoded.
+  void BatchRecvDone(BatchRecv* recv, const Status& s);
+
+  // Moves the result of "recv", which must be done, into "call" as the
+  // response for the key at "key_index".
+  void TakeBatchRecvLocked(BatchRecv* recv, int key_index, BatchCall* call)
+      EXCLUSIVE_LOCKS_REQUIRED(batch_mu_);
+
+  // Returns true if "call" should return now, in which case its pending
+  // receives are detached from it.
+  bool ReadyToReplyLocked(BatchCall* call) EXCLUSIVE_LOCKS_REQUIRED(batch_mu_);
+
+  void ReplyBatch(BatchCall* call);
+
+  void RecvLocalToByteBuffer(int64 step_id,
+                             const Rendezvous::ParsedKey& parsed,
+                             Device* src_dev, const TensorCodec* codec,
+                             int64 codec_min_bytes,
+                             std::function<void()> recv_done,
+                             ::grpc::ByteBuffer* response, StatusCallback done);
+
+  mutex batch_mu_;
+  // The receives of RecvTensorBatch calls whose tensors have not been
+  // returned yet, by step id and rendezvous key.
+  std::unordered_map<int64, std::unordered_map<string, BatchRecv*>>
+      batch_recvs_ GUARDED_BY(batch_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env);
 
-// Returns an implementation of WorkerService rpc service.
+// Returns an implementation of WorkerService rpc service, with the
+// completion queues and polling threads that `rpc_options` asks for.
 std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
-    GrpcWorker* worker, ::grpc::ServerBuilder* builder);
+    GrpcWorker* worker, const RPCOptions& rpc_options,
+    ::grpc::ServerBuilder* builder);
 
 }  // namespace tensorflow
 
@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
@@ -28,27 +33,135 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
+// Which tensors the remote workers are asked to encode with a tensor codec
+// before sending them, from the recv_tensor_codec* fields of RPCOptions.
+struct RecvTensorCodecOptions {
+  string codec;
+  int64 min_bytes = 0;
+  std::vector<string> peers;
+
+  // Returns true if the tensors from "src_worker" should be encoded.
+  bool Matches(const string& src_worker) const {
+    if (codec.empty()) return false;
+    if (peers.empty()) return true;
+    for (const string& peer : peers) {
+      if (src_worker == peer ||
+          StringPiece(src_worker).starts_with(strings::StrCat(peer, "/"))) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
 namespace {
 
+class RpcRecvTensorBatchCall;
+
+// The maximum number of receives in a single RecvTensorBatch call. A
+// batch that reaches this size is sent without waiting for its window
+// to close.
+const int kMaxRecvTensorBatchSize = 256;
+
+// The default limit on the PushTensor calls outstanding in a step.
+const int kDefaultMaxInflightPushes = 16;
+
+// The default size of the smallest tensor encoded with a tensor codec.
+const int64 kDefaultRecvTensorCodecMinBytes = 64 << 10;
+
+std::shared_ptr<const RecvTensorCodecOptions> MakeRecvTensorCodecOptions(
+    const RPCOptions& options) {
+  std::shared_ptr<RecvTensorCodecOptions> o =
+      std::make_shared<RecvTensorCodecOptions>();
+  o->codec = options.recv_tensor_codec();
+  if (!o->codec.empty() && LookupTensorCodec(o->codec) == nullptr) {
+    LOG(ERROR) << "Unknown tensor codec in RPCOptions.recv_tensor_codec: "
+               << o->codec;
+    o->codec.clear();
+  }
+  o->min_bytes = options.recv_tensor_codec_min_bytes() > 0
+                     ? options.recv_tensor_codec_min_bytes()
+                     : kDefaultRecvTensorCodecMinBytes;
+  o->peers.assign(options.recv_tensor_codec_peers().begin(),
+                  options.recv_tensor_codec_peers().end());
+  return o;
+}
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id, false) {}
+  RpcRemoteRendezvous(
+      const WorkerEnv* env, int64 step_id, bool push_tensors,
+      int max_inflight_pushes, int64 batch_window_micros,
+      std::shared_ptr<const RecvTensorCodecOptions> codec_options)
+      : BaseRemoteRendezvous(env, step_id, false),
+        push_tensors_(push_tensors),
+        max_inflight_pushes_(max_inflight_pushes),
+        batch_window_micros_(batch_window_micros),
+        codec_options_(std::move(codec_options)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                            const Rendezvous::Args& args,
                            DoneCallback done) override;
 
+  bool UsePush(const Rendezvous::ParsedKey& parsed) override {
+    return push_tensors_;
+  }
+
+  void PushToRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                         const Tensor& val, bool is_dead,
+                         StatusCallback done) override;
+
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Adds a receive to the pending batch for "src_worker", creating the
+  // batch if necessary. Takes ownership of "rwi".
+  void AddToBatch(const string& src_worker, WorkerInterface* rwi,
+                  const Rendezvous::ParsedKey& parsed, Device* dst_device,
+                  const Rendezvous::Args& recv_args, DoneCallback done);
+
+  // Sends the pending batch for "src_worker", if its id is "batch_id".
+  void FlushBatch(const string& src_worker, int64 batch_id);
+
+  void StartBatch(RpcRecvTensorBatchCall* batch);
+
+  // Sends "val" to the worker of "parsed.dst_device".
+  void StartPush(const Rendezvous::ParsedKey& parsed, const Tensor& val,
+                 bool is_dead, StatusCallback done);
+
+  // Starts the oldest queued push, if any, in place of a push that
+  // finished.
+  void PushDone();
+
+  const bool push_tensors_;
+  // The maximum number of PushTensor calls outstanding at a time. Later
+  // pushes are queued in "pending_pushes_".
+  const int max_inflight_pushes_;
+  // The time for which receives from the same remote worker are held
+  // back, so that they can be sent in a single RecvTensorBatch call. If
+  // zero, every receive is sent in its own RecvTensor call.
+  const int64 batch_window_micros_;
+  const std::shared_ptr<const RecvTensorCodecOptions> codec_options_;
+
+  mutex batch_mu_;
+  int64 next_batch_id_ GUARDED_BY(batch_mu_) = 0;
+  // The batch that has not been sent yet, for each remote worker.
+  std::unordered_map<string, RpcRecvTensorBatchCall*> pending_batches_
+      GUARDED_BY(batch_mu_);
+
+  mutex push_mu_;
+  int num_inflight_pushes_ GUARDED_BY(push_mu_) = 0;
+  std::deque<std::function<void()>> pending_pushes_ GUARDED_BY(push_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -197,6 +310,138 @@ class RpcRecvTensorFreeList {
   std::vector<RpcRecvTensorCall*> objects_ GUARDED_BY(mu_);
 };
 
+// Used to retrieve several tensors from the same remote process in a
+// single RecvTensorBatch call.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorBatchCall(int64 batch_id, const string& src_worker,
+                         WorkerInterface* wi, int64 step_id)
+      : batch_id_(batch_id), src_worker_(src_worker), wi_(wi) {
+    req_.set_step_id(step_id);
+  }
+
+  ~RpcRecvTensorBatchCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorBatchCall destructor.";
+  }
+
+  void Add(StringPiece key, Device* dst_device,
+           const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+    req_.add_rendezvous_key(key.data(), key.size());
+    entries_.push_back({dst_device, recv_args, std::move(done)});
+  }
+
+  int size() const { return entries_.size(); }
+
+  void Start(std::function<void()> recv_done) override {
+    using namespace std::placeholders;
+    StatusCallback cb = std::bind(
+        [this](std::function<void()> recv_done,
+               // Begin unbound arguments.
+               const Status& s) {
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          }
+          recv_done();
+        },
+        std::move(recv_done), _1);
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_, std::move(cb));
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  // Calls the done callback of each receive whose tensor the batch
+  // returned, or of every receive if the batch failed. The server returns
+  // some of the tensors as soon as they are available, because the others
+  // may depend on them. Returns true if some receives are still pending,
+  // in which case the batch is ready to be started again to request their
+  // tensors.
+  bool RunCallbacks() {
+    Status s = status();
+    std::vector<bool> returned(size(), false);
+    if (s.ok() && (resp_.response_size() == 0 ||
+                   resp_.key_index_size() != resp_.response_size())) {
+      s = errors::Internal("RecvTensorBatch returned ", resp_.response_size(),
+                           " tensors for ", resp_.key_index_size(),
+                           " keys.");
+    }
+    for (int i = 0; s.ok() && i < resp_.key_index_size(); ++i) {
+      const int key_index = resp_.key_index(i);
+      if (key_index < 0 || key_index >= size() || returned[key_index]) {
+        s = errors::Internal("RecvTensorBatch returned an invalid key index ",
+                             key_index, " for ", size(), " keys.");
+      } else {
+        returned[key_index] = true;
+      }
+    }
+    if (!s.ok()) {
+      for (Entry& entry : entries_) {
+        entry.done(s, Rendezvous::Args(), entry.recv_args, Tensor{}, false);
+      }
+      entries_.clear();
+      return false;
+    }
+    for (int i = 0; i < resp_.response_size(); ++i) {
+      Entry& entry = entries_[resp_.key_index(i)];
+      TensorResponse tensor_response;
+      tensor_response.InitAlloc(entry.dst_device, entry.recv_args.alloc_attrs);
+      const bool is_dead = resp_.response(i).is_dead();
+      Status tensor_status =
+          tensor_response.InitFrom(resp_.mutable_response(i));
+      entry.done(tensor_status, Rendezvous::Args(), entry.recv_args,
+                 tensor_response.tensor(), is_dead);
+    }
+
+    // Keep the receives that are still pending.
+    protobuf::RepeatedPtrField<string> keys;
+    keys.Swap(req_.mutable_rendezvous_key());
+    std::vector<Entry> pending;
+    for (int i = 0; i < size(); ++i) {
+      if (!returned[i]) {
+        req_.add_rendezvous_key(keys.Get(i));
+        pending.push_back(std::move(entries_[i]));
+      }
+    }
+    entries_.swap(pending);
+    resp_.Clear();
+    return !entries_.empty();
+  }
+
+ private:
+  friend class RpcRemoteRendezvous;
+
+  struct Entry {
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  const int64 batch_id_;
+  const string src_worker_;
+  WorkerInterface* wi_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+  std::vector<Entry> entries_;
+
+  mutable mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorBatchCall);
+};
+
 static RpcRecvTensorFreeList* get_call_freelist() {
   static RpcRecvTensorFreeList* call_freelist = new RpcRecvTensorFreeList();
   return call_freelist;
@@ -236,8 +481,20 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
+  if (batch_window_micros_ > 0) {
+    const string src_worker = call->src_worker_;
+    get_call_freelist()->Release(call, sess->worker_cache.get());
+    AddToBatch(src_worker, rwi, parsed, dst_device, recv_args,
+               std::move(done));
+    return;
+  }
+
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
              recv_args, std::move(done));
+  if (codec_options_->Matches(call->src_worker_)) {
+    call->req_.set_tensor_codec(codec_options_->codec);
+    call->req_.set_tensor_codec_min_bytes(codec_options_->min_bytes);
+  }
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call);
@@ -258,14 +515,169 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::AddToBatch(const string& src_worker,
+                                     WorkerInterface* rwi,
+                                     const Rendezvous::ParsedKey& parsed,
+                                     Device* dst_device,
+                                     const Rendezvous::Args& recv_args,
+                                     DoneCallback done) {
+  RpcRecvTensorBatchCall* full_batch = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    RpcRecvTensorBatchCall*& batch = pending_batches_[src_worker];
+    if (batch == nullptr) {
+      const int64 batch_id = next_batch_id_++;
+      batch = new RpcRecvTensorBatchCall(batch_id, src_worker, rwi, step_id_);
+      // The closure is identified by the id of the batch, rather than a
+      // pointer to it, because the batch may already have been sent
+      // (and deleted) when the window closes.
+      Ref();
+      env_->env->SchedClosureAfter(batch_window_micros_,
+                                   [this, src_worker, batch_id]() {
+                                     FlushBatch(src_worker, batch_id);
+                                     Unref();
+                                   });
+    } else {
+      // The pending batch already holds an interface to "src_worker".
+      session()->worker_cache->ReleaseWorker(src_worker, rwi);
+    }
+    batch->Add(parsed.FullKey(), dst_device, recv_args, std::move(done));
+    if (batch->size() >= kMaxRecvTensorBatchSize) {
+      full_batch = batch;
+      pending_batches_.erase(src_worker);
+    }
+  }
+  if (full_batch != nullptr) {
+    StartBatch(full_batch);
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     int64 batch_id) {
+  RpcRecvTensorBatchCall* batch = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    if (it == pending_batches_.end() || it->second->batch_id_ != batch_id) {
+      // The batch was sent when it became full.
+      return;
+    }
+    batch = it->second;
+    pending_batches_.erase(it);
+  }
+  StartBatch(batch);
+}
+
+void RpcRemoteRendezvous::StartBatch(RpcRecvTensorBatchCall* batch) {
+  VLOG(2) << "Sending " << batch->size() << " receives for step " << step_id_
+          << " to " << batch->src_worker_ << " in one batch.";
+  // Record "batch" in active_ so that it can be aborted cleanly.
+  RegisterCall(batch);
+  Ref();
+  batch->Start([this, batch]() {
+    // Removes "batch" from active_. Prevent StartAbort().
+    DeregisterCall(batch);
+    if (batch->RunCallbacks()) {
+      // Request the tensors that were not available yet.
+      StartBatch(batch);
+    } else {
+      session()->worker_cache->ReleaseWorker(batch->src_worker_, batch->wi_);
+      batch->wi_ = nullptr;
+      delete batch;
+    }
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::PushToRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Tensor& val, bool is_dead,
+    StatusCallback done) {
+  {
+    mutex_lock l(push_mu_);
+    if (num_inflight_pushes_ >= max_inflight_pushes_) {
+      pending_pushes_.push_back([this, parsed, val, is_dead, done]() {
+        StartPush(parsed, val, is_dead, done);
+      });
+      return;
+    }
+    ++num_inflight_pushes_;
+  }
+  StartPush(parsed, val, is_dead, std::move(done));
+}
+
+void RpcRemoteRendezvous::PushDone() {
+  std::function<void()> next;
+  {
+    mutex_lock l(push_mu_);
+    if (pending_pushes_.empty()) {
+      --num_inflight_pushes_;
+      return;
+    }
+    next = std::move(pending_pushes_.front());
+    pending_pushes_.pop_front();
+  }
+  next();
+}
+
+void RpcRemoteRendezvous::StartPush(const Rendezvous::ParsedKey& parsed,
+                                    const Tensor& val, bool is_dead,
+                                    StatusCallback done) {
+  string dst_worker;
+  string dst_rel_device;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.dst_device, &dst_worker,
+                                        &dst_rel_device)) {
+    PushDone();
+    done(errors::Internal(parsed.dst_device,
+                          " is invalid remote destination device."));
+    return;
+  }
+  WorkerSession* sess = session();
+  WorkerInterface* rwi = sess->worker_cache->CreateWorker(dst_worker);
+  if (rwi == nullptr) {
+    PushDone();
+    done(errors::Internal("No worker known as ", dst_worker));
+    return;
+  }
+
+  PushTensorRequest* req = new PushTensorRequest;
+  PushTensorResponse* resp = new PushTensorResponse;
+  req->set_step_id(step_id_);
+  const StringPiece key = parsed.FullKey();
+  req->set_rendezvous_key(key.data(), key.size());
+  req->set_is_dead(is_dead);
+  rwi->PushTensorAsync(
+      req, val, resp,
+      [this, sess, dst_worker, rwi, req, resp, done](const Status& s) {
+        sess->worker_cache->ReleaseWorker(dst_worker, rwi);
+        delete req;
+        delete resp;
+        PushDone();
+        done(s);
+      });
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : RpcRendezvousMgr(env, RPCOptions()) {}
+
+RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env,
+                                   const RPCOptions& options)
+    : BaseRendezvousMgr(env),
+      push_tensors_(options.push_tensors()),
+      max_inflight_pushes_(options.max_inflight_push_tensors() > 0
+                               ? options.max_inflight_push_tensors()
+                               : kDefaultMaxInflightPushes),
+      recv_tensor_batch_window_micros_(
+          std::max<int64>(0, options.recv_tensor_batch_window_usecs())),
+      codec_options_(MakeRecvTensorCodecOptions(options)) {}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64 step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id, push_tensors_,
+                                 max_inflight_pushes_,
+                                 recv_tensor_batch_window_micros_,
+                                 codec_options_);
 }
 
 }  // end namespace tensorflow
@@ -16,12 +16,18 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <memory>
+
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
+struct RecvTensorCodecOptions;
+
 class DeviceMgr;
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
@@ -42,14 +48,32 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If RPCOptions.push_tensors is true, tensors sent to a remote worker
+// are pushed to it with a PushTensor call as soon as they are produced,
+// rather than buffered until it issues a RecvTensor call. The option
+// must have the same value on all of the workers in the cluster.
+//
+// The receives of tensors from remote workers are batched as configured
+// by RPCOptions.recv_tensor_batch_window_usecs, and the tensors received
+// with RecvTensor are encoded as configured by RPCOptions.recv_tensor_codec.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
+  // "options" are typically the rpc_options of the
+  // ServerDef.default_session_config of the server.
+  RpcRendezvousMgr(const WorkerEnv* env, const RPCOptions& options);
 
  protected:
   BaseRemoteRendezvous* Create(int64 step_id, const WorkerEnv* worker_env);
 
  private:
+  const bool push_tensors_;
+  const int max_inflight_pushes_;
+  const int64 recv_tensor_batch_window_micros_;
+  // Shared with the rendezvous of the steps.
+  const std::shared_ptr<const RecvTensorCodecOptions> codec_options_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
@@ -154,6 +154,68 @@ TEST_F(RpcRendezvousMgrTest, CleanupAll) {
   }
 }
 
+TEST_F(RpcRendezvousMgrTest, PushedRecv) {
+  RPCOptions options;
+  options.set_push_tensors(true);
+  RpcRendezvousMgr push_rmgr(&env, options);
+
+  // The producer is on another worker, which pushes the tensor before
+  // the step starts on this worker. The consumer then receives it
+  // without issuing a RecvTensor call, which would fail because
+  // DummyWorkerCache knows no workers.
+  const int64 step_id = 123;
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:mnist/replica:1/task:3/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:0", "foo", FrameAndIter(0, 0)));
+  TF_ASSERT_OK(
+      push_rmgr.DeliverPushedTensor(step_id, key, V("peach"), false));
+  {
+    RemoteRendezvous* rendez = push_rmgr.Find(step_id);
+    core::ScopedUnref unref(rendez);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Tensor val(DT_STRING);
+    bool val_dead = false;
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez->Recv(key, args, &val, &val_dead));
+    EXPECT_FALSE(val_dead);
+    EXPECT_EQ(V(val), "peach");
+  }
+  push_rmgr.Cleanup(step_id);
+
+  // A push for a key whose consumer is not on this worker is rejected.
+  const Rendezvous::ParsedKey bad_key = MakeKey(Rendezvous::CreateKey(
+      "/job:mnist/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:3/cpu:0", "foo", FrameAndIter(0, 0)));
+  {
+    RemoteRendezvous* rendez = push_rmgr.Find(step_id);
+    core::ScopedUnref unref(rendez);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        push_rmgr.DeliverPushedTensor(step_id, bad_key, V("peach"), false)));
+  }
+  push_rmgr.Cleanup(step_id);
+
+  // A push that arrives after the step was cleaned up is dropped, rather
+  // than buffered in a new rendezvous for the step.
+  TF_ASSERT_OK(
+      push_rmgr.DeliverPushedTensor(step_id, key, V("peach"), false));
+  {
+    RemoteRendezvous* rendez = push_rmgr.Find(step_id);
+    core::ScopedUnref unref(rendez);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Notification n;
+    rendez->RecvAsync(key, Rendezvous::Args(),
+                      [&n](const Status& s, const Rendezvous::Args& send_args,
+                           const Rendezvous::Args& recv_args, const Tensor& v,
+                           const bool dead) {
+                        EXPECT_TRUE(errors::IsAborted(s));
+                        n.Notify();
+                      });
+    push_rmgr.Cleanup(step_id);
+    n.WaitForNotification();
+  }
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
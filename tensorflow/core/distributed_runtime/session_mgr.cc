@@ -27,12 +27,14 @@ namespace tensorflow {
 SessionMgr::SessionMgr(
     WorkerEnv* worker_env, const string& default_worker_name,
     std::unique_ptr<WorkerCacheInterface> default_worker_cache,
-    WorkerCacheFactory worker_cache_factory)
+    WorkerCacheFactory worker_cache_factory, int64 graph_cache_capacity)
     : worker_env_(worker_env),
+      graph_cache_capacity_(graph_cache_capacity),
       legacy_session_(default_worker_name, std::move(default_worker_cache),
                       std::unique_ptr<DeviceMgr>(worker_env->device_mgr),
-                      std::unique_ptr<GraphMgr>(
-                          new GraphMgr(worker_env, worker_env->device_mgr))),
+                      std::unique_ptr<GraphMgr>(new GraphMgr(
+                          worker_env, worker_env->device_mgr,
+                          graph_cache_capacity))),
       worker_cache_factory_(std::move(worker_cache_factory)) {}
 
 string SessionMgr::WorkerNameFromServerDef(const ServerDef& server_def) {
@@ -60,7 +62,7 @@ Status SessionMgr::CreateSession(const string& session,
   std::unique_ptr<DeviceMgr> device_mgr(new DeviceMgr(renamed_devices));
 
   std::unique_ptr<GraphMgr> graph_mgr(
-      new GraphMgr(worker_env_, device_mgr.get()));
+      new GraphMgr(worker_env_, device_mgr.get(), graph_cache_capacity_));
 
   std::unique_ptr<WorkerSession> worker_session(new WorkerSession(
       worker_name, std::unique_ptr<WorkerCacheInterface>(worker_cache),
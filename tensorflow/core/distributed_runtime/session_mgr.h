@@ -38,10 +38,12 @@ class SessionMgr {
   typedef std::function<Status(const ServerDef&, WorkerCacheInterface**)>
       WorkerCacheFactory;
 
+  // The graph managers of the sessions cache up to "graph_cache_capacity"
+  // registered graphs each.
   explicit SessionMgr(
       WorkerEnv* worker_env, const string& default_worker_name,
       std::unique_ptr<WorkerCacheInterface> default_worker_cache,
-      WorkerCacheFactory worker_cache_factory);
+      WorkerCacheFactory worker_cache_factory, int64 graph_cache_capacity);
   ~SessionMgr() {}
 
   // Allocates state for a new session.
@@ -57,6 +59,7 @@ class SessionMgr {
 
  private:
   const WorkerEnv* const worker_env_;  // Not owned.
+  const int64 graph_cache_capacity_;
 
   // A note about destruction:
   // We must delete graph_mgr before device_mgr, due to shared
@@ -0,0 +1,228 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* codec_input_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_codec/input_bytes",
+    "The total size of the tensors encoded with a tensor codec.", "codec");
+
+auto* codec_output_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_codec/output_bytes",
+    "The total size of the encodings produced by a tensor codec. The "
+    "compression ratio of the codec is input_bytes / output_bytes.",
+    "codec");
+
+auto* codec_encode_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_codec/encode_usecs",
+    "The time spent encoding tensors with a tensor codec.", "codec");
+
+auto* codec_decode_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_codec/decode_usecs",
+    "The time spent decoding tensors with a tensor codec.", "codec");
+
+// Rounds DT_FLOAT tensors to IEEE half precision.
+class Fp16Codec : public TensorCodec {
+ public:
+  Fp16Codec() : name_("fp16") {}
+
+  const string& name() const override { return name_; }
+
+  bool CanEncode(DataType dtype) const override { return dtype == DT_FLOAT; }
+
+ protected:
+  Status EncodeInternal(const Tensor& val, string* out) const override {
+    const auto in = val.flat<float>();
+    out->resize(in.size() * sizeof(Eigen::half));
+    Eigen::half* dst = reinterpret_cast<Eigen::half*>(&(*out)[0]);
+    for (int64 i = 0; i < in.size(); ++i) {
+      dst[i] = Eigen::half(in(i));
+    }
+    return Status::OK();
+  }
+
+  Status DecodeInternal(StringPiece in, Tensor* val) const override {
+    auto out = val->flat<float>();
+    if (in.size() != out.size() * sizeof(Eigen::half)) {
+      return errors::InvalidArgument("Expected ", out.size(),
+                                     " fp16 values, but got ", in.size(),
+                                     " bytes");
+    }
+    const Eigen::half* src = reinterpret_cast<const Eigen::half*>(in.data());
+    for (int64 i = 0; i < out.size(); ++i) {
+      out(i) = static_cast<float>(src[i]);
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string name_;
+};
+
+// Truncates DT_FLOAT tensors to bfloat16. This keeps the range of float,
+// but only 8 bits of precision.
+class BFloat16Codec : public TensorCodec {
+ public:
+  BFloat16Codec() : name_("bfloat16") {}
+
+  const string& name() const override { return name_; }
+
+  bool CanEncode(DataType dtype) const override { return dtype == DT_FLOAT; }
+
+ protected:
+  Status EncodeInternal(const Tensor& val, string* out) const override {
+    const auto in = val.flat<float>();
+    out->resize(in.size() * sizeof(bfloat16));
+    FloatToBFloat16(in.data(), reinterpret_cast<bfloat16*>(&(*out)[0]),
+                    in.size());
+    return Status::OK();
+  }
+
+  Status DecodeInternal(StringPiece in, Tensor* val) const override {
+    auto out = val->flat<float>();
+    if (in.size() != out.size() * sizeof(bfloat16)) {
+      return errors::InvalidArgument("Expected ", out.size(),
+                                     " bfloat16 values, but got ", in.size(),
+                                     " bytes");
+    }
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(in.data()), out.data(),
+                    out.size());
+    return Status::OK();
+  }
+
+ private:
+  const string name_;
+};
+
+// Compresses the bytes of a tensor with snappy.
+class SnappyCodec : public TensorCodec {
+ public:
+  SnappyCodec() : name_("snappy") {}
+
+  const string& name() const override { return name_; }
+
+  bool CanEncode(DataType dtype) const override {
+    return DataTypeCanUseMemcpy(dtype);
+  }
+
+ protected:
+  Status EncodeInternal(const Tensor& val, string* out) const override {
+    const StringPiece data = val.tensor_data();
+    if (!port::Snappy_Compress(data.data(), data.size(), out)) {
+      return errors::Unimplemented(
+          "Snappy compression is not supported on this platform");
+    }
+    return Status::OK();
+  }
+
+  Status DecodeInternal(StringPiece in, Tensor* val) const override {
+    StringPiece data = val->tensor_data();
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(in.data(), in.size(),
+                                            &uncompressed_size)) {
+      return errors::InvalidArgument("Corrupt snappy-encoded tensor");
+    }
+    if (uncompressed_size != data.size()) {
+      return errors::InvalidArgument("Expected ", data.size(),
+                                     " uncompressed bytes, but got ",
+                                     uncompressed_size);
+    }
+    if (!port::Snappy_Uncompress(in.data(), in.size(),
+                                 const_cast<char*>(data.data()))) {
+      return errors::InvalidArgument("Corrupt snappy-encoded tensor");
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string name_;
+};
+
+struct CodecRegistry {
+  mutex mu;
+  std::unordered_map<string, std::unique_ptr<TensorCodec>> codecs
+      GUARDED_BY(mu);
+};
+
+CodecRegistry* GlobalCodecRegistry() {
+  static CodecRegistry* registry = [] {
+    CodecRegistry* r = new CodecRegistry;
+    mutex_lock l(r->mu);
+    const std::vector<TensorCodec*> builtin_codecs = {
+        new Fp16Codec, new BFloat16Codec, new SnappyCodec};
+    for (TensorCodec* codec : builtin_codecs) {
+      r->codecs[codec->name()].reset(codec);
+    }
+    return r;
+  }();
+  return registry;
+}
+
+}  // namespace
+
+Status TensorCodec::Encode(const Tensor& val, string* out) const {
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(EncodeInternal(val, out));
+  const uint64 usecs = Env::Default()->NowMicros() - start_usecs;
+  codec_input_bytes->GetCell(name())->IncrementBy(val.TotalBytes());
+  codec_output_bytes->GetCell(name())->IncrementBy(out->size());
+  codec_encode_usecs->GetCell(name())->IncrementBy(usecs);
+  VLOG(3) << "Encoded " << val.TotalBytes() << " bytes into " << out->size()
+          << " bytes with " << name() << " in " << usecs << " usecs";
+  return Status::OK();
+}
+
+Status TensorCodec::Decode(StringPiece in, Tensor* val) const {
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(DecodeInternal(in, val));
+  codec_decode_usecs->GetCell(name())->IncrementBy(
+      Env::Default()->NowMicros() - start_usecs);
+  return Status::OK();
+}
+
+void RegisterTensorCodec(TensorCodec* codec) {
+  CodecRegistry* registry = GlobalCodecRegistry();
+  mutex_lock l(registry->mu);
+  std::unique_ptr<TensorCodec>& entry = registry->codecs[codec->name()];
+  CHECK(entry == nullptr) << "Tensor codec registered twice: "
+                          << codec->name();
+  entry.reset(codec);
+}
+
+const TensorCodec* LookupTensorCodec(const string& name) {
+  CodecRegistry* registry = GlobalCodecRegistry();
+  mutex_lock l(registry->mu);
+  auto it = registry->codecs.find(name);
+  return it == registry->codecs.end() ? nullptr : it->second.get();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODEC_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODEC_H_
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A TensorCodec encodes the content of a tensor into a (usually smaller)
+// byte string for transfer between workers, and decodes it again on the
+// receiving side. The dtype and shape of the tensor are transferred
+// separately, so a codec only has to encode the content.
+//
+// A codec may be lossy: for example, the "fp16" codec rounds each float
+// to half precision.
+//
+// Implementations must be thread-safe.
+class TensorCodec {
+ public:
+  virtual ~TensorCodec() {}
+
+  // The name under which this codec is registered. Workers agree on a
+  // codec by its name.
+  virtual const string& name() const = 0;
+
+  // Returns true if this codec can encode tensors of type "dtype".
+  virtual bool CanEncode(DataType dtype) const = 0;
+
+  // Encodes the content of "val" into "*out".
+  //
+  // REQUIRES: CanEncode(val.dtype()).
+  Status Encode(const Tensor& val, string* out) const;
+
+  // Decodes "in", as produced by Encode(), into "*val", which must have
+  // been allocated with the dtype and shape of the encoded tensor.
+  Status Decode(StringPiece in, Tensor* val) const;
+
+ protected:
+  // Implementations of Encode() and Decode(), which record the sizes of
+  // the encoded tensors and the time spent in the codec.
+  virtual Status EncodeInternal(const Tensor& val, string* out) const = 0;
+  virtual Status DecodeInternal(StringPiece in, Tensor* val) const = 0;
+};
+
+// Registers "codec" under codec->name(). Takes ownership of "codec".
+void RegisterTensorCodec(TensorCodec* codec);
+
+// Returns the codec registered as "name", or nullptr if there is none.
+// The returned codec is valid for the lifetime of the process.
+//
+// The following codecs are always registered:
+//
+// * "fp16": Rounds DT_FLOAT tensors to IEEE half precision.
+// * "bfloat16": Truncates DT_FLOAT tensors to bfloat16.
+// * "snappy": Compresses the bytes of any memcpy-able tensor with snappy.
+//   Lossless, and most effective for tensors with many zeros.
+const TensorCodec* LookupTensorCodec(const string& name);
+
+namespace tensor_codec_registration {
+
+class TensorCodecRegistration {
+ public:
+  explicit TensorCodecRegistration(TensorCodec* codec) {
+    RegisterTensorCodec(codec);
+  }
+};
+
+}  // namespace tensor_codec_registration
+
+// Registers a TensorCodec subclass with a default constructor.
+#define REGISTER_TENSOR_CODEC(codec_class) \
+  REGISTER_TENSOR_CODEC_UNIQ_HELPER(__COUNTER__, codec_class)
+#define REGISTER_TENSOR_CODEC_UNIQ_HELPER(ctr, codec_class) \
+  REGISTER_TENSOR_CODEC_UNIQ(ctr, codec_class)
+#define REGISTER_TENSOR_CODEC_UNIQ(ctr, codec_class)             \
+  static ::tensorflow::tensor_codec_registration::               \
+      TensorCodecRegistration tensor_codec_registration_##ctr( \
+          new codec_class)
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODEC_H_
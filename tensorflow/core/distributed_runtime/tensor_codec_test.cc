@@ -0,0 +1,175 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Encodes "val" with "codec" and decodes the result into a new tensor.
+Tensor RoundTrip(const TensorCodec* codec, const Tensor& val,
+                 size_t* encoded_size) {
+  string encoded;
+  TF_CHECK_OK(codec->Encode(val, &encoded));
+  *encoded_size = encoded.size();
+  Tensor decoded(val.dtype(), val.shape());
+  TF_CHECK_OK(codec->Decode(encoded, &decoded));
+  return decoded;
+}
+
+TEST(TensorCodecTest, Fp16) {
+  const TensorCodec* codec = LookupTensorCodec("fp16");
+  ASSERT_NE(nullptr, codec);
+  EXPECT_TRUE(codec->CanEncode(DT_FLOAT));
+  EXPECT_FALSE(codec->CanEncode(DT_DOUBLE));
+  EXPECT_FALSE(codec->CanEncode(DT_INT32));
+
+  Tensor val = test::AsTensor<float>({0.0f, 1.0f, -2.5f, 1e-3f, 60000.0f},
+                                     TensorShape({5, 1}));
+  size_t encoded_size;
+  Tensor decoded = RoundTrip(codec, val, &encoded_size);
+  EXPECT_EQ(5 * 2, encoded_size);
+  test::ExpectClose(val, decoded, 0 /* atol */, 1e-3 /* rtol */);
+}
+
+TEST(TensorCodecTest, BFloat16) {
+  const TensorCodec* codec = LookupTensorCodec("bfloat16");
+  ASSERT_NE(nullptr, codec);
+  EXPECT_TRUE(codec->CanEncode(DT_FLOAT));
+  EXPECT_FALSE(codec->CanEncode(DT_INT64));
+
+  // bfloat16 keeps the range of float.
+  Tensor val = test::AsTensor<float>({0.0f, 1.0f, -2.5f, 1e30f, -1e-30f});
+  size_t encoded_size;
+  Tensor decoded = RoundTrip(codec, val, &encoded_size);
+  EXPECT_EQ(5 * 2, encoded_size);
+  test::ExpectClose(val, decoded, 0 /* atol */, 1e-2 /* rtol */);
+}
+
+TEST(TensorCodecTest, Snappy) {
+  const TensorCodec* codec = LookupTensorCodec("snappy");
+  ASSERT_NE(nullptr, codec);
+  EXPECT_TRUE(codec->CanEncode(DT_FLOAT));
+  EXPECT_TRUE(codec->CanEncode(DT_INT64));
+  EXPECT_FALSE(codec->CanEncode(DT_STRING));
+
+  Tensor val(DT_INT32, TensorShape({100, 100}));
+  auto flat = val.flat<int32>();
+  flat.setZero();
+  for (int64 i = 0; i < flat.size(); i += 97) {
+    flat(i) = i;
+  }
+  size_t encoded_size;
+  Tensor decoded = RoundTrip(codec, val, &encoded_size);
+  EXPECT_LT(encoded_size, val.TotalBytes() / 4);
+  test::ExpectTensorEqual<int32>(val, decoded);
+}
+
+TEST(TensorCodecTest, DecodeRejectsWrongSize) {
+  Tensor val = test::AsTensor<float>({1.0f, 2.0f, 3.0f});
+  for (const string& name : {"fp16", "bfloat16", "snappy"}) {
+    const TensorCodec* codec = LookupTensorCodec(name);
+    ASSERT_NE(nullptr, codec);
+    string encoded;
+    TF_ASSERT_OK(codec->Encode(val, &encoded));
+    Tensor wrong_shape(DT_FLOAT, TensorShape({4}));
+    Status s = codec->Decode(encoded, &wrong_shape);
+    EXPECT_TRUE(errors::IsInvalidArgument(s)) << name << ": " << s;
+  }
+}
+
+// A codec that sends tensors as they are.
+class IdentityCodec : public TensorCodec {
+ public:
+  IdentityCodec() : name_("test_identity") {}
+
+  const string& name() const override { return name_; }
+
+  bool CanEncode(DataType dtype) const override {
+    return DataTypeCanUseMemcpy(dtype);
+  }
+
+ protected:
+  Status EncodeInternal(const Tensor& val, string* out) const override {
+    *out = val.tensor_data().ToString();
+    return Status::OK();
+  }
+
+  Status DecodeInternal(StringPiece in, Tensor* val) const override {
+    StringPiece data = val->tensor_data();
+    if (in.size() != data.size()) {
+      return errors::InvalidArgument("Wrong size");
+    }
+    memcpy(const_cast<char*>(data.data()), in.data(), in.size());
+    return Status::OK();
+  }
+
+ private:
+  const string name_;
+};
+
+REGISTER_TENSOR_CODEC(IdentityCodec);
+
+TEST(TensorCodecTest, Registration) {
+  EXPECT_EQ(nullptr, LookupTensorCodec("no_such_codec"));
+  const TensorCodec* codec = LookupTensorCodec("test_identity");
+  ASSERT_NE(nullptr, codec);
+  EXPECT_EQ("test_identity", codec->name());
+
+  Tensor val = test::AsTensor<int64>({1, 2, 3});
+  size_t encoded_size;
+  Tensor decoded = RoundTrip(codec, val, &encoded_size);
+  EXPECT_EQ(val.TotalBytes(), encoded_size);
+  test::ExpectTensorEqual<int64>(val, decoded);
+}
+
+static void BM_Encode(int iters, const char* name, int bytes) {
+  testing::StopTiming();
+  const TensorCodec* codec = LookupTensorCodec(name);
+  Tensor val(DT_FLOAT, TensorShape({bytes / static_cast<int>(sizeof(float))}));
+  auto flat = val.flat<float>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    flat(i) = (i % 10 == 0) ? i : 0.0f;
+  }
+  string encoded;
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(codec->Encode(val, &encoded));
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes);
+}
+
+static void BM_EncodeFp16(int iters, int bytes) {
+  BM_Encode(iters, "fp16", bytes);
+}
+static void BM_EncodeBFloat16(int iters, int bytes) {
+  BM_Encode(iters, "bfloat16", bytes);
+}
+static void BM_EncodeSnappy(int iters, int bytes) {
+  BM_Encode(iters, "snappy", bytes);
+}
+BENCHMARK(BM_EncodeFp16)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24);
+BENCHMARK(BM_EncodeBFloat16)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24);
+BENCHMARK(BM_EncodeSnappy)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24);
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "google/protobuf/any.pb.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 
 namespace tensorflow {
 
@@ -50,6 +51,9 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
+  if (!meta_.tensor_codec().empty()) {
+    return InitFromEncoded();
+  }
   if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
@@ -84,6 +88,9 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (!meta_.tensor_codec().empty()) {
+      return InitFromEncoded();
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -100,8 +107,42 @@ Status TensorResponse::ParseFrom(Source* source) {
   already_used_ = true;
   if (ParseFast(source)) return Status::OK();
   meta_.Clear();
-  if (ParseSlow(source)) return Status::OK();
-  return errors::InvalidArgument("Cannot parse tensor from response");
+  return ParseSlow(source);
+}
+
+Status TensorResponse::InitFromEncoded() {
+  const TensorCodec* codec = LookupTensorCodec(meta_.tensor_codec());
+  if (codec == nullptr) {
+    return errors::Unimplemented("Unknown tensor codec: ",
+                                 meta_.tensor_codec());
+  }
+  const TensorProto& proto = meta_.tensor();
+  if (!codec->CanEncode(proto.dtype()) ||
+      !TensorShape::IsValid(proto.tensor_shape())) {
+    return errors::InvalidArgument("Cannot parse tensor encoded with ",
+                                   meta_.tensor_codec(), " from response");
+  }
+  // Tensors for other devices are decoded in host memory, and then copied
+  // to the device.
+  Tensor decoded(on_host_ ? allocator_ : cpu_allocator(), proto.dtype(),
+                 TensorShape(proto.tensor_shape()));
+  Status s = codec->Decode(proto.tensor_content(), &decoded);
+  if (s.ok()) {
+    if (on_host_) {
+      tensor_ = std::move(decoded);
+    } else {
+      TensorProto decoded_proto;
+      decoded.AsProtoTensorContent(&decoded_proto);
+      s = device_->MakeTensorFromProto(decoded_proto, alloc_attrs_, &tensor_);
+    }
+  }
+  // Reduce memory usage for big tensors.
+  {
+    TensorProto empty;
+    meta_.mutable_tensor()->Swap(&empty);
+  }
+  meta_.clear_tensor();
+  return s;
 }
 
 // Define some helper routines for decoding protocol buffer wire format data
@@ -257,6 +298,10 @@ bool TensorResponse::ParseFast(Source* source) {
           return false;
         break;
       }
+      case RecvTensorResponse::kTensorCodecFieldNumber: {
+        // Encoded tensors are decoded on the slow path.
+        return false;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -267,14 +312,17 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
-bool TensorResponse::ParseSlow(Source* source) {
+Status TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
-    return false;
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  if (!meta_.tensor_codec().empty()) {
+    return InitFromEncoded();
   }
 
   Tensor parsed(meta_.tensor().dtype());
   if (!parsed.FromProto(allocator_, meta_.tensor())) {
-    return false;
+    return errors::InvalidArgument("Cannot parse tensor from response");
   }
   tensor_ = std::move(parsed);
 
@@ -285,7 +333,7 @@ bool TensorResponse::ParseSlow(Source* source) {
   }
   meta_.clear_tensor();
 
-  return true;
+  return Status::OK();
 }
 
 }  // namespace tensorflow
@@ -91,7 +91,11 @@ class TensorResponse {
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
-  bool ParseSlow(Source* source);
+  Status ParseSlow(Source* source);
+
+  // Decodes meta_.tensor(), whose content is encoded with the tensor
+  // codec meta_.tensor_codec(), into tensor_.
+  Status InitFromEncoded();
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
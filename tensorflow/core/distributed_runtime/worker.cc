@@ -53,9 +53,16 @@ void Worker::RegisterGraphAsync(const RegisterGraphRequest* request,
                                 StatusCallback done) {
   WorkerSession* session =
       env_->session_mgr->WorkerSessionForSession(request->session_handle());
-  Status s = session->graph_mgr->Register(
-      request->session_handle(), request->graph_def(), request->graph_options(),
-      request->debug_options(), response->mutable_graph_handle());
+  Status s;
+  if (request->lookup_cached_graph()) {
+    s = session->graph_mgr->RegisterCached(request->graph_key(),
+                                           response->mutable_graph_handle());
+  } else {
+    s = session->graph_mgr->Register(
+        request->session_handle(), request->graph_def(),
+        request->graph_options(), request->debug_options(),
+        request->graph_key(), response->mutable_graph_handle());
+  }
   done(s);
 }
 
@@ -178,6 +185,9 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
             const Tensor& val = p.second;
             response->AddRecv(key, val);
           }
+          if (collector != nullptr) {
+            profile_.Add(*response->mutable_step_stats());
+          }
         }
         delete collector;
         delete out;
@@ -279,12 +289,27 @@ void Worker::CleanupAllAsync(const CleanupAllRequest* request,
   std::vector<string> containers;
   for (const auto& c : request->container()) containers.push_back(c);
   env_->device_mgr->ClearContainers(containers);
+  // Cached graphs may hold kernels that refer to the cleared resources.
+  env_->session_mgr->LegacySession()->graph_mgr->ClearCache();
   done(Status::OK());
 }
 
 void Worker::LoggingAsync(const LoggingRequest* request,
                           LoggingResponse* response, StatusCallback done) {
-  done(errors::Unimplemented("Logging"));
+  if (request->rpc_logging() || request->fetch_step_id_size() > 0) {
+    done(errors::Unimplemented("Logging"));
+    return;
+  }
+  if (request->fetch_profile() && request->clear()) {
+    response->set_profile_steps(
+        profile_.TakeProfile(response->mutable_profile()));
+  } else if (request->fetch_profile()) {
+    response->set_profile_steps(
+        profile_.GetProfile(response->mutable_profile()));
+  } else if (request->clear()) {
+    profile_.Clear();
+  }
+  done(Status::OK());
 }
 
 void Worker::TracingAsync(const TracingRequest* request,
@@ -322,4 +347,27 @@ void Worker::RecvTensorAsync(CallOptions* opts,
   done(errors::Unimplemented("Worker::RecvTensorAsync()"));
 }
 
+void Worker::PushTensorAsync(const PushTensorRequest* request,
+                             PushTensorResponse* response,
+                             StatusCallback done) {
+  const int64 step_id = request->step_id();
+  const string& key = request->rendezvous_key();
+  TRACEPRINTF("PushTensor: %lld %s", step_id, key.c_str());
+  Rendezvous::ParsedKey parsed;
+  Status s = Rendezvous::ParseKey(key, &parsed);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  Tensor val;
+  if (!request->is_dead() &&
+      !val.FromProto(cpu_allocator(), request->tensor())) {
+    done(errors::InvalidArgument("Cannot parse tensor from request for ",
+                                 key));
+    return;
+  }
+  done(env_->rendezvous_mgr->DeliverPushedTensor(step_id, parsed, val,
+                                                 request->is_dead()));
+}
+
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "tensorflow/core/common_runtime/step_stats_aggregator.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/partial_run_mgr.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
@@ -79,6 +80,10 @@ class Worker : public WorkerInterface {
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override;
 
+  void PushTensorAsync(const PushTensorRequest* request,
+                       PushTensorResponse* response,
+                       StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -99,6 +104,10 @@ class Worker : public WorkerInterface {
   mutex mu_;
   CancellationManager* cancellation_manager_ GUARDED_BY(mu_);
 
+  // The stats of the steps run with tracing or cost collection on, which the
+  // master turns on for a sample of the steps. Served by LoggingAsync().
+  StepStatsAggregator profile_;
+
   Status PrepareRunGraph(RunGraphRequestWrapper* req,
                          GraphMgr::NamedTensors* in,
                          GraphMgr::NamedTensors* out);
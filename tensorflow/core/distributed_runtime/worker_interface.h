@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -102,6 +103,42 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives several tensors produced on this worker in a single
+  // round trip. Implementations that do not support batching return
+  // an `Unimplemented` error.
+  virtual void RecvTensorBatchAsync(CallOptions* opts,
+                                    const RecvTensorBatchRequest* request,
+                                    RecvTensorBatchResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("RecvTensorBatchAsync()"));
+  }
+
+  // Delivers a tensor produced on the calling worker to the rendezvous
+  // of a consumer on this worker, without waiting for a RecvTensor
+  // request.
+  virtual void PushTensorAsync(const PushTensorRequest* request,
+                               PushTensorResponse* response,
+                               StatusCallback done) {
+    done(errors::Unimplemented("PushTensorAsync()"));
+  }
+
+  // Like PushTensorAsync() above, but pushes "val" as the tensor of
+  // "request", which should not have a tensor of its own. Transports may
+  // send "val" without copying it into a TensorProto first.
+  virtual void PushTensorAsync(const PushTensorRequest* request,
+                               const Tensor& val, PushTensorResponse* response,
+                               StatusCallback done) {
+    PushTensorRequest* full_request = new PushTensorRequest(*request);
+    if (!request->is_dead()) {
+      val.AsProtoTensorContent(full_request->mutable_tensor());
+    }
+    PushTensorAsync(full_request, response,
+                    [full_request, done](const Status& s) {
+                      done(s);
+                      delete full_request;
+                    });
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -31,6 +31,17 @@ void AllocatorStats::Clear() {
   this->max_bytes_in_use = 0;
   this->max_alloc_size = 0;
   this->bytes_limit = 0;
+  this->num_cache_hits = 0;
+  this->num_cache_misses = 0;
+  this->num_lock_waits = 0;
+  this->lock_wait_micros = 0;
+  this->bytes_reserved = 0;
+  this->bytes_free = 0;
+  this->largest_free_block_bytes = 0;
+  this->free_bytes_by_bin.clear();
+  this->managed_bytes_in_use = 0;
+  this->max_managed_bytes_in_use = 0;
+  this->num_managed_allocs = 0;
 }
 
 string AllocatorStats::DebugString() const {
@@ -39,9 +50,23 @@ string AllocatorStats::DebugString() const {
       "InUse:        %20lld\n"
       "MaxInUse:     %20lld\n"
       "NumAllocs:    %20lld\n"
-      "MaxAllocSize: %20lld\n",
+      "MaxAllocSize: %20lld\n"
+      "CacheHits:    %20lld\n"
+      "CacheMisses:  %20lld\n"
+      "LockWaits:    %20lld\n"
+      "LockWaitUs:   %20lld\n"
+      "Reserved:     %20lld\n"
+      "Free:         %20lld\n"
+      "LargestFree:  %20lld\n"
+      "ManagedInUse: %20lld\n"
+      "MaxManaged:   %20lld\n"
+      "NumManaged:   %20lld\n",
       this->bytes_limit, this->bytes_in_use, this->max_bytes_in_use,
-      this->num_allocs, this->max_alloc_size);
+      this->num_allocs, this->max_alloc_size, this->num_cache_hits,
+      this->num_cache_misses, this->num_lock_waits, this->lock_wait_micros,
+      this->bytes_reserved, this->bytes_free, this->largest_free_block_bytes,
+      this->managed_bytes_in_use, this->max_managed_bytes_in_use,
+      this->num_managed_allocs);
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <limits>
+#include <vector>
 
 #include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/resource_handle.pb.h"
@@ -56,6 +57,34 @@ struct AllocatorStats {
   // unknown.
   int64 bytes_limit;
 
+  // Allocations served by, and missed in, an allocator's front-end cache.
+  int64 num_cache_hits;
+  int64 num_cache_misses;
+
+  // Number of times a caller blocked on the allocator's internal lock, and
+  // the total time spent blocked.
+  int64 num_lock_waits;
+  int64 lock_wait_micros;
+
+  // Fragmentation of the memory the allocator holds, if it pools memory:
+  // the bytes obtained from the system, the free bytes within them, and
+  // the largest free block. An allocation larger than the largest free
+  // block needs more memory even if bytes_free is larger.
+  int64 bytes_reserved;
+  int64 bytes_free;
+  int64 largest_free_block_bytes;
+  // free_bytes_by_bin[i] is the number of free bytes in blocks of
+  // [256 << i, 256 << (i + 1)) bytes, the last bin also counting the
+  // larger blocks. Empty if unknown.
+  std::vector<int64> free_bytes_by_bin;
+
+  // Allocations served from memory that the system may page out of the
+  // device, e.g. CUDA unified memory, which are also counted in
+  // bytes_in_use and num_allocs.
+  int64 managed_bytes_in_use;
+  int64 max_managed_bytes_in_use;
+  int64 num_managed_allocs;
+
   AllocatorStats() { Clear(); }
 
   void Clear();
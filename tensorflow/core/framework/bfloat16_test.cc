@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#include <string.h>
+#include <limits>
+
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -42,6 +45,28 @@ TEST(Bfloat16Test, Conversion) {
   }
 }
 
+TEST(Bfloat16Test, ConversionKeepsUpperHalf) {
+  // Long enough for the vectorized loops, with a tail they don't handle.
+  const int kSize = 37;
+  float a[kSize];
+  for (int i = 0; i < kSize; ++i) {
+    a[i] = (i % 2 ? -1.0f : 1.0f) * (i * 3.14159f + 0.001f);
+  }
+  a[kSize - 1] = std::numeric_limits<float>::infinity();
+  bfloat16 b[kSize];
+  float c[kSize];
+  FloatToBFloat16(a, b, kSize);
+  BFloat16ToFloat(b, c, kSize);
+  for (int i = 0; i < kSize; ++i) {
+    uint32 a_bits;
+    uint32 c_bits;
+    memcpy(&a_bits, &a[i], sizeof(a_bits));
+    memcpy(&c_bits, &c[i], sizeof(c_bits));
+    EXPECT_EQ(a_bits >> 16, b[i].value);
+    EXPECT_EQ(a_bits & 0xffff0000u, c_bits);
+  }
+}
+
 static void BM_FloatToBFloat16(int iters) {
   testing::StopTiming();
   static const int N = 32 << 20;
@@ -46,6 +46,7 @@ namespace tensorflow {
 class Device;
 class Env;
 class EventMgr;
+class GPUStagingPool;
 class OpKernelContext;
 class ResourceMgr;
 
@@ -53,6 +54,36 @@ namespace thread {
 class ThreadPool;
 }
 
+// Device memory reserved for each stream of a device, out of which the kernels
+// enqueued on a stream can carve their temporary workspace without going
+// through the device allocator. Implemented by GPUScratchArena.
+class ScratchArena {
+ public:
+  // The memory of a stream, held by one op at a time.
+  class Region {
+   public:
+    virtual ~Region() {}
+  };
+
+  virtual ~ScratchArena() {}
+
+  // The size of the region of each stream.
+  virtual int64 bytes_per_stream() const = 0;
+
+  // Returns the region of "stream" for the exclusive use of the caller until
+  // it is passed to Release, or nullptr if "stream" has no region or its
+  // region is in use.
+  virtual Region* TryAcquire(perftools::gputools::Stream* stream) = 0;
+
+  // Sets "*ptr" to "num_bytes" of "region" that are not handed out since it
+  // was acquired, and returns true, or returns false if fewer are left.
+  virtual bool Allocate(Region* region, int64 num_bytes, void** ptr) = 0;
+
+  // Returns "region" to the arena. The memory handed out of it may be reused
+  // by the kernels enqueued on the stream from now on.
+  virtual void Release(Region* region) = 0;
+};
+
 // A wrapper for an Eigen Gpu Device that includes per-op state. The
 // class is defined even for non-GPU devices since the
 // OpKernelContext::Params structure wants to fill it in.
@@ -126,12 +157,17 @@ class DeviceBase {
   // supply a DeviceContext for an op in FillContextMap (e.g. when only
   // using a single stream.)
   // "event_mgr" is used to delay deallocation of temporary GPU buffers.
+  // "staging_pool", if set, stages the copies from and to pageable host
+  // memory.
+  // "scratch_arena", if set, holds the scratch space of the streams.
   // TODO(pbar) Work out how to move this out of DeviceBase.
   struct GpuDeviceInfo {
     // Make sure all the defaults are NULL, so we can spot missing assignments.
     perftools::gputools::Stream* stream = nullptr;
     DeviceContext* default_context = nullptr;
     EventMgr* event_mgr = nullptr;
+    GPUStagingPool* staging_pool = nullptr;
+    ScratchArena* scratch_arena = nullptr;
     int gpu_id = -1;
   };
 
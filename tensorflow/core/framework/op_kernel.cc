@@ -246,7 +246,9 @@ OpKernelContext::~OpKernelContext() {
 
 Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   Allocator* allocator =
-      params_->device->GetStepAllocator(attr, resource_manager());
+      (params_->default_allocator != nullptr && attr.value == 0)
+          ? params_->default_allocator
+          : params_->device->GetStepAllocator(attr, resource_manager());
   if (track_allocations()) {
     mutex_lock lock(mu_);
     for (const auto& wrapped : wrapped_allocators_) {
@@ -390,6 +392,37 @@ bool OpKernelContext::forward_input_to_output_with_shape(
   }
 }
 
+bool OpKernelContext::forward_input_to_output_bitcast(int input_index,
+                                                      int output_index,
+                                                      Tensor** output) {
+  const TensorValue& input = (*params_->inputs)[input_index];
+  if (input.tensor == nullptr || input.is_ref()) {
+    return false;
+  }
+  const DataType output_dtype = expected_output_dtype(output_index);
+  const int input_size = DataTypeSize(input_dtype(input_index));
+  if (input_size == 0 || input_size != DataTypeSize(output_dtype)) {
+    return false;
+  }
+  const auto output_attr = params_->output_attr_array == nullptr
+                               ? AllocatorAttributes()
+                               : output_alloc_attr(output_index);
+  // forward_input() checks everything else, as if the types matched.
+  std::unique_ptr<Tensor> forwarded = forward_input(
+      input_index, input_dtype(input_index), input.tensor->shape(),
+      output_memory_type(output_index), output_attr);
+  if (forwarded == nullptr) {
+    return false;
+  }
+  Tensor* new_tensor = new Tensor();
+  new_tensor->UnsafeCopyFromInternal(*forwarded, output_dtype,
+                                     forwarded->shape());
+  // Transfer ownership to the output slot in OpKernelContext.
+  outputs_[output_index] = TensorValue(new_tensor);
+  *output = outputs_[output_index].tensor;
+  return true;
+}
+
 Status OpKernelContext::forward_input_to_output_with_shape(
     StringPiece input_name, StringPiece output_name,
     const TensorShape& output_shape, Tensor** output) {
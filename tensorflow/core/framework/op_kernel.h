@@ -517,6 +517,11 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, serves the allocations with default attributes in place
+    // of the device's allocator. Executors that plan step memory set this
+    // to an allocator specific to the node being run.
+    Allocator* default_allocator = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -695,6 +700,14 @@ class OpKernelContext {
                                             const TensorShape& output_shape,
                                             Tensor** output) TF_MUST_USE_RESULT;
 
+  // Like forward_input_to_output_with_shape, keeping the shape of
+  // input[input_index], but the type of output[output_index] only has to have
+  // the same size as that of the input, rather than match it. The forwarded
+  // buffer is reinterpreted, not converted, so this is only useful to kernels
+  // that overwrite every element in place, e.g. a Cast from int32 to float.
+  bool forward_input_to_output_bitcast(int input_index, int output_index,
+                                       Tensor** output) TF_MUST_USE_RESULT;
+
   // Returns a pointer to a Tensor aliasing the underlying buffer backing
   // input[input_index] iff
   //   * input[input_index] is not a ref,
@@ -1216,6 +1229,11 @@ class Name : public KernelDefBuilder {
 #define REGISTER_KERNEL_BUILDER_UNIQ_HELPER(ctr, kernel_builder, ...) \
   REGISTER_KERNEL_BUILDER_UNIQ(ctr, kernel_builder, __VA_ARGS__)
 
+// The factory is chosen by a template on the constexpr selective registration
+// flag, so that a kernel class that is not registered is never instantiated:
+// neither its constructor, vtable and Compute(), nor the functors they use are
+// emitted, whatever the optimization level, and the linker has nothing of it
+// to keep.
 #define REGISTER_KERNEL_BUILDER_UNIQ(ctr, kernel_builder, ...)        \
   constexpr bool should_register_##ctr##__flag =                      \
       SHOULD_REGISTER_OP_KERNEL(#__VA_ARGS__);                        \
@@ -1225,10 +1243,8 @@ class Name : public KernelDefBuilder {
               ? ::tensorflow::register_kernel::kernel_builder.Build() \
               : nullptr,                                              \
           #__VA_ARGS__,                                               \
-          [](::tensorflow::OpKernelConstruction* context)             \
-              -> ::tensorflow::OpKernel* {                            \
-            return new __VA_ARGS__(context);                          \
-          });
+          ::tensorflow::kernel_factory::SelectedFactory<              \
+              should_register_##ctr##__flag, __VA_ARGS__>::Get());
 
 // The `REGISTER_SYSTEM_KERNEL_BUILDER()` macro acts as
 // `REGISTER_KERNEL_BUILDER()` except that the kernel is registered
@@ -1282,6 +1298,22 @@ class OpKernelRegistrar {
                     Factory factory);
 };
 
+// SelectedFactory<true, K>::Get() returns a factory creating a K;
+// SelectedFactory<false, K>::Get() returns nullptr without referencing K's
+// constructor. Used by REGISTER_KERNEL_BUILDER.
+template <bool should_register, class K>
+struct SelectedFactory {
+  static OpKernel* Create(OpKernelConstruction* context) {
+    return new K(context);
+  }
+  static constexpr OpKernelRegistrar::Factory Get() { return &Create; }
+};
+
+template <class K>
+struct SelectedFactory<false, K> {
+  static constexpr OpKernelRegistrar::Factory Get() { return nullptr; }
+};
+
 }  // namespace kernel_factory
 
 // -----------------------------------------------------------------------------
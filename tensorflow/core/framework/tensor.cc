@@ -23,6 +23,10 @@ limitations under the License.
 //   default constructors and destructors when T is not a simple type
 //   (e.g., string.), and skips them otherwise.
 //
+// * InlineBuffer: holds small arrays of simple types allocated by
+//   cpu_allocator() in the same heap block as the reference count, to
+//   avoid a second allocation for scalars and other tiny tensors.
+//
 // * Helper<T>: provides various routines given type T.  The routines
 //   includes running the constructor and destructor of T[], encoding
 //   an decoding T[] into/from a Cord, etc.
@@ -41,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -101,6 +106,58 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Ref-counted buffer that stores up to kMaxBytes bytes in itself rather than
+// in memory from the allocator. Only used for cpu_allocator() when it doesn't
+// track allocations, since its memory then has no other properties than
+// alignment, which the buffer matches.
+class InlineBuffer : public BufferBase {
+ public:
+  static constexpr size_t kMaxBytes = 64;
+
+  InlineBuffer(Allocator* a, size_t num_bytes)
+      : BufferBase(a), size_(num_bytes) {
+    DCHECK_LE(num_bytes, kMaxBytes);
+  }
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return size_; }
+  // data_ doesn't come from the allocator, so it can't be asked about it.
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(alloc_->Name());
+  }
+
+  // Plain new doesn't guarantee the alignment of data_.
+  static void* operator new(size_t size) {
+    return port::AlignedMalloc(size, Allocator::kAllocatorAlignment);
+  }
+  static void operator delete(void* p) { port::AlignedFree(p); }
+
+ private:
+  const size_t size_;
+  alignas(Allocator::kAllocatorAlignment) char data_[kMaxBytes];
+
+  ~InlineBuffer() override {}
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
+constexpr size_t InlineBuffer::kMaxBytes;
+
+// Returns a new buffer for T[n], allocated by 'a' unless it fits in an
+// InlineBuffer. The contents are uninitialized for simple types.
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64 n,
+                        const AllocationAttributes& allocation_attr =
+                            AllocationAttributes()) {
+  if (is_simple_type<T>::value && n > 0 &&
+      sizeof(T) * n <= InlineBuffer::kMaxBytes && a == cpu_allocator() &&
+      !a->TracksAllocationSizes() && !LogMemory::IsEnabled()) {
+    return new InlineBuffer(a, sizeof(T) * n);
+  }
+  return new Buffer<T>(a, n, allocation_attr);
+}
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -128,7 +185,7 @@ struct Helper {
       LogUnexpectedSize(in.size(), sizeof(T) * n);
       return nullptr;
     }
-    Buffer<T>* buf = new Buffer<T>(a, n);
+    TensorBuffer* buf = NewBuffer<T>(a, n);
     char* data = buf->template base<char>();
     if (data == nullptr) {
       buf->Unref();
@@ -391,7 +448,7 @@ Buffer<T>::~Buffer() {
 template <typename T>
 TensorBuffer* FromProtoField(Allocator* a, const TensorProto& in, int64 n) {
   CHECK_GT(n, 0);
-  Buffer<T>* buf = new Buffer<T>(a, n);
+  TensorBuffer* buf = NewBuffer<T>(a, n);
   T* data = buf->template base<T>();
   if (data == nullptr) {
     buf->Unref();
@@ -422,7 +479,7 @@ template <>
 TensorBuffer* FromProtoField<Eigen::half>(Allocator* a, const TensorProto& in,
                                           int64 n) {
   CHECK_GT(n, 0);
-  Buffer<Eigen::half>* buf = new Buffer<Eigen::half>(a, n);
+  TensorBuffer* buf = NewBuffer<Eigen::half>(a, n);
   uint16* data = buf->template base<uint16>();
   if (data == nullptr) {
     buf->Unref();
@@ -582,7 +639,7 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements()));
   }
   if (buf_ != nullptr && buf_->data() != nullptr && LogMemory::IsEnabled()) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -596,7 +653,7 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (!allocation_attr.allocation_will_be_logged && buf_ != nullptr &&
       buf_->data() != nullptr && LogMemory::IsEnabled()) {
@@ -668,6 +725,36 @@ Tensor Tensor::Slice(int64 start, int64 limit) const {
   return ret;
 }
 
+bool Tensor::FromAdjacentSlices(gtl::ArraySlice<const Tensor*> slices,
+                                const TensorShape& shape, Tensor* out) {
+  if (slices.empty() || slices[0]->buf_ == nullptr) return false;
+  const Tensor& first = *slices[0];
+  const DataType dt = first.dtype();
+  if (!DataTypeCanUseMemcpy(dt)) return false;
+  TensorBuffer* root = first.buf_->root_buffer();
+  const char* next = first.buf_->base<const char>();
+  int64 num_elements = 0;
+  for (const Tensor* slice : slices) {
+    if (slice->dtype() != dt || slice->buf_ == nullptr ||
+        slice->buf_->root_buffer() != root ||
+        slice->buf_->base<const char>() != next) {
+      return false;
+    }
+    next += slice->NumElements() * DataTypeSize(dt);
+    num_elements += slice->NumElements();
+  }
+  if (num_elements != shape.num_elements() || !first.IsAligned()) {
+    return false;
+  }
+  Tensor ret;
+  ret.shape_ = shape;
+  ret.set_dtype(dt);
+  ret.buf_ = nullptr;
+  CASES(dt, ret.buf_ = new SubBuffer<T>(first.buf_, 0, num_elements));
+  *out = ret;
+  return true;
+}
+
 bool Tensor::FromProto(const TensorProto& proto) {
   return FromProto(cpu_allocator(), proto);
 }
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -194,6 +195,17 @@ class Tensor {
   /// REQUIRES: `0 <= dim0_start <= dim0_limit <= dim_size(0)`
   Tensor Slice(int64 dim0_start, int64 dim0_limit) const;
 
+  /// \brief The inverse of `Slice()`: sets `*out` to a tensor of `shape` made
+  /// of the elements of `slices`, in order, without copying them.
+  ///
+  /// This is possible when the slices are adjacent in one underlying buffer,
+  /// e.g. when they were returned by `Slice()` on consecutive ranges of a
+  /// tensor. Returns false and leaves `*out` unchanged otherwise, or if the
+  /// slices are of different or non-memcpy-able types, if the result would not
+  /// be aligned or if the slices do not have `shape.num_elements()` elements.
+  static bool FromAdjacentSlices(gtl::ArraySlice<const Tensor*> slices,
+                                 const TensorShape& shape, Tensor* out);
+
   /// \brief Parse `other` and construct the tensor.
 
   /// Returns `true` iff the parsing succeeds. If the parsing fails,
@@ -873,6 +873,38 @@ TEST(Tensor, FailureToAllocate) {
   }
 }
 
+// Small tensors from cpu_allocator() keep their data in the buffer object;
+// they must behave like any other tensor.
+TEST(Tensor, SmallTensors) {
+  for (int64 n : {0, 1, 3, 16, 17}) {
+    TensorShape shape({n});
+    Tensor t(cpu_allocator(), DT_FLOAT, shape);
+    EXPECT_TRUE(t.IsAligned()) << n;
+    EXPECT_EQ(n * sizeof(float), t.TotalBytes()) << n;
+    EXPECT_EQ(n * sizeof(float), t.AllocatedBytes()) << n;
+    auto flat = t.flat<float>();
+    for (int64 i = 0; i < n; ++i) {
+      flat(i) = i;
+    }
+
+    if (n > 0) {
+      Tensor copy = t;
+      EXPECT_TRUE(copy.SharesBufferWith(t)) << n;
+    }
+
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    Tensor parsed;
+    ASSERT_TRUE(parsed.FromProto(cpu_allocator(), proto)) << n;
+    EXPECT_TRUE(parsed.IsAligned()) << n;
+    test::ExpectTensorEqual<float>(t, parsed);
+  }
+  Tensor d(DT_DOUBLE, TensorShape({}));
+  d.scalar<double>()() = 2.5;
+  EXPECT_TRUE(d.IsAligned());
+  EXPECT_EQ(2.5, d.scalar<double>()());
+}
+
 // On the alignment.
 //
 // As of 2015/8, tensorflow::Tensor allocates its buffer with 32-byte
@@ -955,6 +987,52 @@ TEST(Tensor, Slice_Basic) {
   }
 }
 
+TEST(Tensor, FromAdjacentSlices) {
+  Tensor x(DT_FLOAT, TensorShape({10, 4, 2}));
+  for (int i = 0; i < 10; ++i) {
+    x.Slice(i, i + 1).flat<float>().setConstant(i * 1.f);
+  }
+  {  // Consecutive slices make up a view of x.
+    Tensor a = x.Slice(2, 4);
+    Tensor b = x.Slice(4, 5);
+    Tensor c = x.Slice(5, 8);
+    Tensor y;
+    EXPECT_TRUE(Tensor::FromAdjacentSlices({&a, &b, &c},
+                                           TensorShape({6, 4, 2}), &y));
+    EXPECT_TRUE(y.SharesBufferWith(x));
+    EXPECT_EQ(a.flat<float>().data(), y.flat<float>().data());
+    test::ExpectTensorEqual<float>(x.Slice(2, 8), y);
+
+    // The view can have any shape with the same number of elements.
+    EXPECT_TRUE(
+        Tensor::FromAdjacentSlices({&a, &b, &c}, TensorShape({48}), &y));
+    EXPECT_EQ(48, y.NumElements());
+  }
+  {  // Slices out of order, not adjacent or of other buffers are copied.
+    Tensor a = x.Slice(2, 4);
+    Tensor b = x.Slice(4, 6);
+    Tensor c = x.Slice(8, 10);
+    Tensor other(DT_FLOAT, TensorShape({2, 4, 2}));
+    Tensor y;
+    EXPECT_FALSE(
+        Tensor::FromAdjacentSlices({&b, &a}, TensorShape({4, 4, 2}), &y));
+    EXPECT_FALSE(
+        Tensor::FromAdjacentSlices({&a, &c}, TensorShape({4, 4, 2}), &y));
+    EXPECT_FALSE(
+        Tensor::FromAdjacentSlices({&a, &other}, TensorShape({4, 4, 2}), &y));
+    EXPECT_FALSE(
+        Tensor::FromAdjacentSlices({&a, &b}, TensorShape({5, 4, 2}), &y));
+    EXPECT_FALSE(Tensor::FromAdjacentSlices({}, TensorShape({0}), &y));
+  }
+  {  // Strings are not memcpy-able.
+    Tensor s(DT_STRING, TensorShape({4}));
+    Tensor a = s.Slice(0, 2);
+    Tensor b = s.Slice(2, 4);
+    Tensor y;
+    EXPECT_FALSE(Tensor::FromAdjacentSlices({&a, &b}, TensorShape({4}), &y));
+  }
+}
+
 namespace {
 template <typename T>
 Tensor MkTensor(DataType dt, const TensorShape& shape,
@@ -1040,6 +1118,14 @@ static void BM_Assign(int iters) {
 }
 BENCHMARK(BM_Assign);
 
+static void BM_CreateAndDestroyScalar(int iters) {
+  TensorShape shape({});
+  while (--iters) {
+    Tensor t(DT_INT32, shape);
+  }
+}
+BENCHMARK(BM_CreateAndDestroyScalar);
+
 // Ensure tensor_data() works on empty tensors
 TEST(Tensor, EmptyTensorData) {
   Tensor empty;
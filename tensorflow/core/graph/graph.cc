@@ -235,6 +235,15 @@ Node::Properties::Properties(const OpDef* op_def, const NodeDef& node_def,
       input_types_(inputs.begin(), inputs.end()),
       output_types_(outputs.begin(), outputs.end()) {}
 
+Node::Properties::Properties(const OpDef* op_def, NodeDef&& node_def,
+                             const DataTypeSlice inputs,
+                             const DataTypeSlice outputs)
+    : op_def_(op_def),
+      input_types_(inputs.begin(), inputs.end()),
+      output_types_(outputs.begin(), outputs.end()) {
+  node_def_.Swap(&node_def);
+}
+
 Node::Properties::~Properties() {}
 
 // Graph
@@ -286,21 +295,36 @@ Graph::~Graph() {
   // destroy them.
 }
 
+Status Graph::LookUpNodeTypes(const NodeDef& node_def, const OpDef** op_def,
+                              DataTypeVector* inputs, DataTypeVector* outputs) {
+  TF_RETURN_IF_ERROR(ops_.LookUpOpDef(node_def.op(), op_def));
+  Status s = InOutTypesForNode(node_def, **op_def, inputs, outputs);
+  if (!s.ok()) return AttachDef(s, node_def);
+  return Status::OK();
+}
+
 Node* Graph::AddNode(const NodeDef& node_def, Status* status) {
   const OpDef* op_def;
-  status->Update(ops_.LookUpOpDef(node_def.op(), &op_def));
+  DataTypeVector inputs;
+  DataTypeVector outputs;
+  status->Update(LookUpNodeTypes(node_def, &op_def, &inputs, &outputs));
   if (!status->ok()) return nullptr;
 
+  Node* node = AllocateNode(
+      new Node::Properties(op_def, node_def, inputs, outputs), nullptr);
+  return node;
+}
+
+Node* Graph::AddNode(NodeDef&& node_def, Status* status) {
+  const OpDef* op_def;
   DataTypeVector inputs;
   DataTypeVector outputs;
-  status->Update(InOutTypesForNode(node_def, *op_def, &inputs, &outputs));
-  if (!status->ok()) {
-    *status = AttachDef(*status, node_def);
-    return nullptr;
-  }
+  status->Update(LookUpNodeTypes(node_def, &op_def, &inputs, &outputs));
+  if (!status->ok()) return nullptr;
 
   Node* node = AllocateNode(
-      new Node::Properties(op_def, node_def, inputs, outputs), nullptr);
+      new Node::Properties(op_def, std::move(node_def), inputs, outputs),
+      nullptr);
   return node;
 }
 
@@ -189,6 +189,9 @@ class Node {
    public:
     Properties(const OpDef* op_def, const NodeDef& node_def,
                const DataTypeSlice inputs, const DataTypeSlice outputs);
+    // Takes the contents of 'node_def' instead of copying them.
+    Properties(const OpDef* op_def, NodeDef&& node_def,
+               const DataTypeSlice inputs, const DataTypeSlice outputs);
 
     const OpDef* op_def_;  // not owned
     NodeDef node_def_;
@@ -393,6 +396,10 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(const NodeDef& node_def, Status* status);
 
+  // Same as above, but takes the contents of 'node_def' instead of copying
+  // them, which avoids a copy of large attrs (e.g. constant tensors).
+  Node* AddNode(NodeDef&& node_def, Status* status);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
@@ -520,6 +527,10 @@ class Graph {
   // will be associated with that node rather than the new one being
   // created.
   Node* AllocateNode(Node::Properties* props, const Node* cost_node);
+
+  // Looks up the op of 'node_def' and infers its input and output types.
+  Status LookUpNodeTypes(const NodeDef& node_def, const OpDef** op_def,
+                         DataTypeVector* inputs, DataTypeVector* outputs);
   void ReleaseNode(Node* node);
 
   // Registry of all known ops, including functions.
@@ -151,7 +151,8 @@ class GraphConstructor {
   void Undo();
 
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(const NodeDef& node_def, Node** node);
+  // Takes the contents of 'node_def'.
+  Status MakeNode(NodeDef&& node_def, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -211,10 +212,11 @@ class GraphConstructor {
   // Used in the conversion from node_defs_ to g_ to represent the ith input
   // of a node.
   struct InputInfo {
-    explicit InputInfo(const string& node_name, Node* n, int i)
+    explicit InputInfo(StringPiece node_name, Node* n, int i)
         : name(node_name), node(n), index(i) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string name;
+    // The name of the input node if it is in node_defs_, pointing into the
+    // key of its gdef_nodes_ entry, which outlives the conversion.
+    StringPiece name;
     Node* node;
     int index;
   };
@@ -222,10 +224,10 @@ class GraphConstructor {
   // Used in the conversion from node_defs_ to g_ to represent an edge from
   // the node named 'name' to node 'n'.
   struct EdgeInfo {
-    explicit EdgeInfo(const string& name, int i1, Node* n, int i2)
+    explicit EdgeInfo(StringPiece name, int i1, Node* n, int i2)
         : src_name(name), src_index(i1), dst_node(n), dst_index(i2) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string src_name;
+    // Points into a key of gdef_nodes_, like InputInfo::name.
+    StringPiece src_name;
     int src_index;
     Node* dst_node;
     int dst_index;
@@ -326,6 +328,7 @@ Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 
 Status GraphConstructor::BuildNodeIndex() {
   // Validate the node names and add them to gdef_nodes_.
+  gdef_nodes_.reserve(node_defs_.size());
   for (int n = 0; n < node_defs_.size(); ++n) {
     const NodeDef& node_def = *node_defs_[n];
     if (!IsValidNodeName(node_def.name(), opts_.allow_internal_ops)) {
@@ -421,13 +424,13 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(const NodeDef& node_def, Node** node) {
+Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   // Add the node to the graph.
   Status status;
-  *node = g_->AddNode(node_def, &status);
+  *node = g_->AddNode(std::move(node_def), &status);
   if (!status.ok()) return status;
   if (opts_.expect_device_spec) {
-    (*node)->set_assigned_device_name(node_def.device());
+    (*node)->set_assigned_device_name((*node)->def().device());
   }
   return Status::OK();
 }
@@ -656,10 +659,11 @@ Status GraphConstructor::Convert() {
     input_already_exists.resize(original_node_def.input_size(), false);
 
     if (opts_.importing) {
-      // TODO(ashankar): The line below means an additional copy of the NodeDef,
-      // which can be expensive if the NodeDef contains large tensors in it.
-      // Might make sense to change the API for ImportGraphDef to take a mutable
-      // GraphDef* and avoid the copying.
+      // TODO(ashankar): The line below copies the NodeDef, which can be
+      // expensive if the NodeDef contains large tensors in it. The copy is
+      // moved into the Node, so it is the only one, but it might make sense to
+      // change the API for ImportGraphDef to take a mutable GraphDef* and avoid
+      // the copying.
       imported_node_def = original_node_def;
       if (!opts_.input_map.empty()) {
         RemapNodeDefInputs(&imported_node_def, &input_already_exists);
@@ -674,8 +678,10 @@ Status GraphConstructor::Convert() {
     }
 
     TF_RETURN_IF_ERROR(ValidateColocationConstraints(*node_def));
+    inputs.reserve(node_def->input_size());
     for (int i = 0; i < node_def->input_size(); ++i) {
       TensorId id(ParseTensorName(node_def->input(i)));
+      StringPiece src_name;
       Node* src_node;
       int src_index;
 
@@ -683,6 +689,7 @@ Status GraphConstructor::Convert() {
         // Locate input in newly-imported nodes
         auto iter = gdef_nodes_.find(id.first);
         DCHECK(iter != gdef_nodes_.end()) << id.first;
+        src_name = iter->first;
         src_node = iter->second.node;
         src_index = id.second;
         if (src_node == nullptr) has_data_back_edge = true;
@@ -701,7 +708,7 @@ Status GraphConstructor::Convert() {
             src_node->num_outputs(), " outputs");
       }
 
-      inputs.push_back(InputInfo(id.first.ToString(), src_node, src_index));
+      inputs.push_back(InputInfo(src_name, src_node, src_index));
     }
 
     if (has_data_back_edge && !IsMerge(*node_def)) {
@@ -714,8 +721,12 @@ Status GraphConstructor::Convert() {
     if (opts_.importing) {
       AddPrefixToNodeDef(input_already_exists, &imported_node_def);
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&imported_node_def));
+      // imported_node_def is a copy already; move it into the node.
+      TF_RETURN_IF_ERROR(MakeNode(std::move(imported_node_def), &node));
+    } else {
+      TF_RETURN_IF_ERROR(MakeNode(NodeDef(original_node_def), &node));
     }
-    TF_RETURN_IF_ERROR(MakeNode(*node_def, &node));
+    node_def = &node->def();
     // Use original_node_def so name StringPiece remains valid
     gdef_nodes_[original_node_def.name()].node = node;
 
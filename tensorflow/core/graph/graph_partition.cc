@@ -819,7 +819,14 @@ Status Partition(const PartitionOptions& opts, Graph* g,
   status = BuildMemoryDeviceInfo(*g, &g_info);
   if (!status.ok()) return status;
 
-  string dstp;
+  // Resolve the partition of every node once, rather than calling
+  // node_to_loc and looking up the partition again for every edge.
+  // Pointers to the values of an unordered_map stay valid as it grows.
+  std::vector<GraphDef*> node_partitions(g->num_node_ids(), nullptr);
+  for (const Node* n : g->op_nodes()) {
+    node_partitions[n->id()] = &(*partitions)[opts.node_to_loc(n)];
+  }
+
   std::vector<const Edge*> inputs;
   DupRecvTable dup_recv(3);
   // For a node dst, 'ref_recvs' remembers the recvs introduced by a ref
@@ -832,8 +839,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
   int32 num_data = 0;
   int32 num_control = 0;
   for (const Node* dst : g->op_nodes()) {
-    dstp = opts.node_to_loc(dst);
-    GraphDef* dst_graph = &(*partitions)[dstp];
+    GraphDef* dst_graph = node_partitions[dst->id()];
     NodeDef* dst_def = dst_graph->add_node();
     *dst_def = dst->def();
     dst_def->set_device(dst->assigned_device_name());
@@ -883,7 +889,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
       const Node* src = edge->src();
       if (!src->IsOp()) continue;  // Skip Sink/Source nodes.
 
-      GraphDef* src_graph = &(*partitions)[opts.node_to_loc(src)];
+      GraphDef* src_graph = node_partitions[src->id()];
       if (src_graph == dst_graph && !NeedSameDeviceSendRecv(edge, g_info)) {
         // Same partition and compatible memory types:
         AddInput(dst_def, src->name(), edge->src_output());
@@ -1027,9 +1033,10 @@ Status Partition(const PartitionOptions& opts, Graph* g,
   }
 
   // Set versions and function library
+  const FunctionDefLibrary library = g->flib_def().ToProto();
   for (auto& it : *partitions) {
     it.second.mutable_versions()->CopyFrom(g->versions());
-    *it.second.mutable_library() = g->flib_def().ToProto();
+    *it.second.mutable_library() = library;
   }
 
   // Set the start times for recvs at the very end.
@@ -313,6 +313,30 @@ TEST_F(GraphTest, Type) {
   VerifyGraphStats();
 }
 
+TEST_F(GraphTest, AddNodeTakesNodeDef) {
+  NodeDef node_def;
+  TF_ASSERT_OK(NodeDefBuilder("A", "TwoInputsOneOutput")
+                   .Input("x", 0, DT_FLOAT)
+                   .Input("y", 0, DT_FLOAT)
+                   .Attr("_a", "attr")
+                   .Finalize(&node_def));
+  const NodeDef expected = node_def;
+
+  Status s;
+  Node* node = graph_.AddNode(std::move(node_def), &s);
+  TF_ASSERT_OK(s);
+  EXPECT_EQ(expected.DebugString(), node->def().DebugString());
+  EXPECT_EQ(2, node->num_inputs());
+  EXPECT_EQ(DT_FLOAT, node->output_type(0));
+
+  // Errors are reported as for the copying overload.
+  NodeDef bad_def;
+  bad_def.set_name("B");
+  bad_def.set_op("DoesNotExist");
+  EXPECT_EQ(nullptr, graph_.AddNode(std::move(bad_def), &s));
+  EXPECT_FALSE(s.ok());
+}
+
 TEST_F(GraphTest, AddAttr) {
   Node* n1 = AddNodeWithName("A");
 
@@ -479,5 +503,30 @@ static void BM_InEdgeIteration(int iters, int num_nodes) {
 }
 BENCHMARK(BM_InEdgeIteration)->Range(10, 100000);
 
+static void BM_ConvertGraphDefToGraph(int iters, int num_nodes) {
+  testing::StopTiming();
+  string s;
+  for (int in = 0; in < 10; in++) {
+    s += strings::Printf("node { name: 'in%04d' op: 'Input' }", in);
+  }
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int op = 0; op < num_nodes; op++) {
+    s += strings::Printf(
+        "node { name: 'op%04d' op: 'In2Out1' input: ['in%04d', 'in%04d' ] }",
+        op, rnd.Uniform(10), rnd.Uniform(10));
+  }
+  GraphDef graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(s, &graph_def));
+  GraphConstructorOptions opts;
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_nodes);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Graph graph(OpRegistry::Global());
+    TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &graph));
+  }
+}
+BENCHMARK(BM_ConvertGraphDefToGraph)->Range(10, 100000);
+
 }  // namespace
 }  // namespace tensorflow
@@ -262,6 +262,7 @@ class MklLayoutRewritePass : public GraphOptimizationPass {
  public:
   MklLayoutRewritePass() {
     // NOTE: names are alphabetically sorted.
+    csinfo_.addn = "AddN";
     csinfo_.avg_pool = "AvgPool";
     csinfo_.avg_pool_grad = "AvgPoolGrad";
     csinfo_.bias_add = "BiasAdd";
@@ -289,6 +290,9 @@ class MklLayoutRewritePass : public GraphOptimizationPass {
     csinfo_.split                 = "Split";
 
     // NOTE: names are alphabetically sorted.
+    rinfo_.push_back({csinfo_.addn,
+                      GetMklOpName(csinfo_.addn),
+                      CopyAttrsAddN, AlwaysRewrite, nullptr});
     rinfo_.push_back({csinfo_.avg_pool,
                       GetMklOpName(csinfo_.avg_pool),
                       CopyAttrsPooling, AlwaysRewrite, nullptr});
@@ -439,6 +443,7 @@ class MklLayoutRewritePass : public GraphOptimizationPass {
   /// Structure to store all constant strings
   /// NOTE: names are alphabetically sorted.
   struct {
+    string addn;
     string avg_pool;
     string avg_pool_grad;
     string bias_add;
@@ -767,6 +772,7 @@ class MklLayoutRewritePass : public GraphOptimizationPass {
   // We need operator-specific function to copy attributes because the framework
   // does not provide any generic function for it.
   // NOTE: names are alphabetically sorted.
+  static void CopyAttrsAddN(const Node* orig_node, NodeBuilder* nb);
   static void CopyAttrsBiasAddGrad(const Node* orig_node, NodeBuilder* nb);
   static void CopyAttrsConcat(const Node* orig_node, NodeBuilder* nb);
   static void CopyAttrsConcatV2(const Node* orig_node, NodeBuilder* nb);
@@ -817,12 +823,8 @@ static void FillInputs(const Node* n,
     }
   }
   std::sort(control_edges->begin(), control_edges->end());
-  if (n->op_def().is_commutative()) {
-    // For commutative inputs, we sort the input by the input Node*
-    // to get a canonical ordering (so that add(a,b) and add(b, a) will
-    // hash to the same value if is_commutative is true for 'add').
-    std::sort(in->begin(), in->end());
-  }
+  // Unlike in CSE, the inputs of commutative ops (such as AddN) are not
+  // sorted: the rewritten node keeps the order of the original inputs.
 }
 
 void MklLayoutRewritePass::GetNodesProducingTFTensorList(
@@ -1240,6 +1242,20 @@ void MklLayoutRewritePass::AddWorkSpaceEdgeIfNeeded(
 // Op-specific functions to copy attributes from old node to new node
 //////////////////////////////////////////////////////////////////////////
 
+void MklLayoutRewritePass::CopyAttrsAddN(const Node* orig_node,
+                                         NodeBuilder* nb) {
+  DataType T;
+  int N;
+
+  // Get all attributes from old node.
+  TF_CHECK_OK(GetNodeAttr(orig_node->def(), "T", &T));
+  TF_CHECK_OK(GetNodeAttr(orig_node->def(), "N", &N));
+
+  // Add attributes to new node.
+  nb->Attr("T", T);
+  nb->Attr("N", N);
+}
+
 void MklLayoutRewritePass::CopyAttrsConv2D(const Node* orig_node,
                                            NodeBuilder* nb) {
   DataType T;
@@ -638,6 +638,24 @@ TEST_F(MklLayoutPassTest, NodeRewrite_Concat_Basic) {
             "B:1->D:2;C->E;D->E:1;DMT/_0->D:3;DMT/_1->D:4;DMT/_2->D:5");
 }
 
+// AddN with no Mkl layer feeding it
+TEST_F(MklLayoutPassTest, NodeRewrite_AddN_Basic) {
+  InitGraph(
+      "node { name: 'A' op: 'Input'}"
+      "node { name: 'B' op: 'Input'}"
+      "node { name: 'C' op: 'AddN'"
+      " attr { key: 'T'                value { type: DT_FLOAT } }"
+      " attr { key: 'N'                value { i: 2 } }"
+      " input: ['A', 'B']}"
+      "node { name: 'D' op: 'Mul' attr { key: 'T' value { type: DT_FLOAT } }"
+      " input: ['A', 'C'] }");
+  EXPECT_EQ(DoMklLayoutOptimizationPass(),
+            "A(Input);B(Input);C(_MklAddN);D(Mul);DMT/_0(Const);"
+            "DMT/_1(Const)|A->C;A->D;A:control->DMT/_0:control;"
+            "A:control->DMT/_1:control;B->C:1;C->D:1;DMT/_0->C:2;"
+            "DMT/_1->C:3");
+}
+
 // Concat with 2 Mkl layers feeding it
 TEST_F(MklLayoutPassTest, NodeRewrite_Concat_Input_Mkl) {
   InitGraph(
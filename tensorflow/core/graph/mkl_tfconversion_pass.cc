@@ -19,6 +19,7 @@ limitations under the License.
 #include <queue>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -59,6 +60,10 @@ namespace tensorflow {
 //  do the conversion for A1 and A2 only. We do not need to do any conversion
 //  for A3.
 //
+//  If an output of A is input to several such nodes B1, B2, ..., we insert
+//  a single C for that output and feed all of them from it, instead of
+//  converting the same tensor once per consumer.
+//
 // This pass relies on ops registering themselves about their Mkl compliance.
 // An Mkl-compliant op can accept inputs in the Mkl format, and produce outputs
 // in the Mkl format. Non-compliant ops accept inputs and outputs in the
@@ -87,15 +92,17 @@ class MklToTfConversionPass : public GraphOptimizationPass {
     return mkl_op_registry::IsMklOp(op_name, T);
   }
 
-  // Insert layout conversion node on the edge pointed by 'e' from graph 'g'.
+  // Insert a single layout conversion node in graph 'g' for the edges in
+  // 'edges', which all start at the same output of the same node.
   //
-  // Edge will be deleted once a call to this function is successful.
-  // Any attempt to use the edge after this call
+  // Edges will be deleted once a call to this function is successful.
+  // Any attempt to use the edges after this call
   // will lead to undefined behaviors.
   //
   // @return Success:OK() if insertion is successful, otherwise returns
   //         appropriate error status code.
-  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*);
+  Status InsertConversionNodeOnEdges(std::unique_ptr<Graph>* g,
+                                     const std::vector<Edge*>& edges);
 };
 
 // We register MklToTf insertion for phase 2 in post-partition grouping
@@ -106,38 +113,44 @@ const OptimizationPassRegistry::Grouping kMklTfConvPassGroup =
     OptimizationPassRegistry::POST_PARTITIONING;
 REGISTER_OPTIMIZATION(kMklTfConvPassGroup, 2, MklToTfConversionPass);
 
-Status MklToTfConversionPass::InsertConversionNodeOnEdge(
-    std::unique_ptr<Graph>* g, Edge* e) {
-  CHECK_NOTNULL(e);
+Status MklToTfConversionPass::InsertConversionNodeOnEdges(
+    std::unique_ptr<Graph>* g, const std::vector<Edge*>& edges) {
+  CHECK(!edges.empty());
 
-  Node* src = e->src();
-  Node* dst = e->dst();
+  Node* src = edges[0]->src();
+  const int src_output = edges[0]->src_output();
 
   CHECK_NOTNULL(src);
-  CHECK_NOTNULL(dst);
 
   Node* conversion_node = nullptr;
   DataType src_datatype = DT_INVALID;
-  DataType dst_datatype = DT_INVALID;
   string data_format;
 
   TF_CHECK_OK(GetNodeAttr(src->def(), "T", &src_datatype));
-  bool dst_dtype_found = GetNodeAttr(dst->def(), "T", &dst_datatype) ==
-                          Status::OK();
-  // We compare source and destination datatypes only when both are found.
-  if (dst_dtype_found && (src_datatype != dst_datatype)) {
-    string err_msg = "T attribute of " + src->name() + " and " +
-                      dst->name() + " do not match. Will not insert" +
-                     " MklToTf node in such case.";
-    return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
+  for (const Edge* e : edges) {
+    Node* dst = e->dst();
+    CHECK_NOTNULL(dst);
+    CHECK_EQ(e->src(), src);
+    CHECK_EQ(e->src_output(), src_output);
+
+    DataType dst_datatype = DT_INVALID;
+    bool dst_dtype_found = GetNodeAttr(dst->def(), "T", &dst_datatype) ==
+                            Status::OK();
+    // We compare source and destination datatypes only when both are found.
+    if (dst_dtype_found && (src_datatype != dst_datatype)) {
+      string err_msg = "T attribute of " + src->name() + " and " +
+                        dst->name() + " do not match. Will not insert" +
+                       " MklToTf node in such case.";
+      return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
+    }
   }
 
   // Build the conversion node and specify src as input.
   TF_CHECK_OK(
       NodeBuilder((*g)->NewName("Mkl2Tf"), "_MklToTf")
-          .Input(src, e->src_output())
+          .Input(src, src_output)
           .Input(src, DataIndexToMetaDataIndex(
-                          e->src_output(),
+                          src_output,
                           src->num_outputs()))  // Get an Mkl tensor slot
                                                 // from the Tf tensor slot.
           .Device(src->def().device())  // We want to get conversion node
@@ -157,17 +170,20 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
   // Set the Mkl op label for this op.
   conversion_node->AddAttr("_kernel", mkl_op_registry::kMklOpLabel);
 
-  // Now that we have added edge from src->conversion_node, let's add edge from
-  // output of conversion_node to the dest node. Since conversion_node
+  // Now that we have added edge from src->conversion_node, let's add edges
+  // from output of conversion_node to the dest nodes. Since conversion_node
   // has only 1 output, the src_output of conversion_node is 0.
-  CHECK_NOTNULL((*g)->AddEdge(conversion_node, 0, dst, e->dst_input()));
+  for (Edge* e : edges) {
+    Node* dst = e->dst();
+    CHECK_NOTNULL((*g)->AddEdge(conversion_node, 0, dst, e->dst_input()));
 
-  VLOG(1) << "MklToTfConversionPass: Inserting Conversion node on: "
-          << src->type_string() << " and " << dst->type_string()
-          << " successful.";
+    VLOG(1) << "MklToTfConversionPass: Inserting Conversion node on: "
+            << src->type_string() << " and " << dst->type_string()
+            << " successful.";
 
-  // Remove src->dst edge now.
-  (*g)->RemoveEdge(e);
+    // Remove src->dst edge now.
+    (*g)->RemoveEdge(e);
+  }
   return Status::OK();
 }
 
@@ -182,8 +198,12 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
   // followed by a non-Mkl op node, we will just iterate over edge
   // set of the graph.
   // edge set whose source and destination are candidates for
-  // inserting conversion node
-  std::vector<Edge*> candidate_edges;
+  // inserting conversion node, grouped by the output they start from so
+  // that every output gets a single conversion node. The groups are kept
+  // in the order they are found, which keeps the node names deterministic.
+  std::vector<std::vector<Edge*>> candidate_edges;
+  std::unordered_map<const Node*, std::unordered_map<int, size_t>>
+      candidate_index;
 
   for (const Edge* e : (*g)->edges()) {
     Node* src = e->src();
@@ -220,19 +240,25 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
     if (src_is_mkl_op && !dst_is_mkl_op) {
       VLOG(1) << "MklToTfConversionPass: Scheduled nodes " << src->name()
               << " and " << dst->name() << " for inserting conversion nodes";
-      candidate_edges.push_back(const_cast<Edge*>(e));
+      auto& output_index = candidate_index[src];
+      auto it = output_index.find(e->src_output());
+      if (it == output_index.end()) {
+        output_index[e->src_output()] = candidate_edges.size();
+        candidate_edges.push_back({const_cast<Edge*>(e)});
+      } else {
+        candidate_edges[it->second].push_back(const_cast<Edge*>(e));
+      }
     }
   }
 
   // Process all candidate edges and insert conversion nodes on them.
-  for (Edge* e : candidate_edges) {
+  for (const std::vector<Edge*>& edges : candidate_edges) {
     // Even if we insert conversion node on a single edge, we
     // need to return true.
-    string src_name = e->src()->name();
-    string dst_name = e->dst()->name();
-    if (InsertConversionNodeOnEdge(g, e) == Status::OK()) {
+    string src_name = edges[0]->src()->name();
+    if (InsertConversionNodeOnEdges(g, edges) == Status::OK()) {
       VLOG(1) << "MklToTfConversionPass: Inserted conversion "
-              << "node on edge between " << src_name << " and " << dst_name;
+              << "node for " << edges.size() << " edges from " << src_name;
       result = true;
     }
   }
@@ -44,6 +44,9 @@ AnalyticalCostEstimator::AnalyticalCostEstimator(
 
 Status AnalyticalCostEstimator::Initialize(const GrapplerItem& item) {
   item_ = item;
+  if (item.op_cost_calibration != nullptr) {
+    node_estimator_->SetCalibration(*item.op_cost_calibration);
+  }
   return Status::OK();
 }
 
@@ -45,7 +45,8 @@ class AnalyticalCostEstimator : public CostEstimator {
                           bool use_static_shapes);
   ~AnalyticalCostEstimator() override {}
 
-  // Initializes the estimator for the specified grappler item.
+  // Initializes the estimator for the specified grappler item, and calibrates
+  // the node estimator with the op cost calibration of the item, if any.
   // This implementation always returns OK.
   Status Initialize(const GrapplerItem& item) override;
 
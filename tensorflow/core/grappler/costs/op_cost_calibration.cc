@@ -0,0 +1,204 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// The features of the cost model: a constant, and the analytical compute and
+// memory times of the op.
+constexpr int kNumFeatures = 3;
+
+// A measurement of an op: its features and its measured execution time, in
+// nanoseconds.
+struct Sample {
+  double features[kNumFeatures];
+  double measured_time;
+};
+
+// Fits measured_time ~ sum(coefs[i] * features[i]) over the features whose
+// bit is set in mask, by least squares weighted by the inverse of the squared
+// measured times, i.e. on the relative errors. Returns false if the system is
+// singular or if one of the coefficients is negative. Otherwise sets coefs,
+// with the coefficients of the other features set to 0, and the sum of the
+// squared relative errors.
+bool FitFeatures(const std::vector<Sample>& samples, int mask,
+                 double coefs[kNumFeatures], double* error) {
+  std::vector<int> used;
+  for (int i = 0; i < kNumFeatures; ++i) {
+    if (mask & (1 << i)) used.push_back(i);
+  }
+  const int n = used.size();
+
+  // The normal equations, as an augmented n x (n + 1) matrix.
+  std::vector<std::vector<double>> a(n, std::vector<double>(n + 1, 0.0));
+  for (const Sample& sample : samples) {
+    const double weight = 1.0 / (sample.measured_time * sample.measured_time);
+    for (int i = 0; i < n; ++i) {
+      const double fi = sample.features[used[i]];
+      for (int j = 0; j < n; ++j) {
+        a[i][j] += weight * fi * sample.features[used[j]];
+      }
+      a[i][n] += weight * fi * sample.measured_time;
+    }
+  }
+
+  // Gaussian elimination with partial pivoting.
+  for (int col = 0; col < n; ++col) {
+    int pivot = col;
+    for (int row = col + 1; row < n; ++row) {
+      if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) pivot = row;
+    }
+    // The weighted features are relative to the measured times, so the
+    // entries of a well-conditioned system are not tiny.
+    if (std::fabs(a[pivot][col]) < 1e-12) return false;
+    std::swap(a[col], a[pivot]);
+    for (int row = 0; row < n; ++row) {
+      if (row == col) continue;
+      const double factor = a[row][col] / a[col][col];
+      for (int k = col; k <= n; ++k) {
+        a[row][k] -= factor * a[col][k];
+      }
+    }
+  }
+
+  for (int i = 0; i < kNumFeatures; ++i) coefs[i] = 0.0;
+  for (int i = 0; i < n; ++i) {
+    const double coef = a[i][n] / a[i][i];
+    if (coef < 0) return false;
+    coefs[used[i]] = coef;
+  }
+
+  *error = 0;
+  for (const Sample& sample : samples) {
+    double predicted = 0;
+    for (int i = 0; i < kNumFeatures; ++i) {
+      predicted += coefs[i] * sample.features[i];
+    }
+    const double relative_error =
+        (predicted - sample.measured_time) / sample.measured_time;
+    *error += relative_error * relative_error;
+  }
+  return true;
+}
+
+}  // namespace
+
+Status MeasureOpPerformance(Cluster* cluster, const GrapplerItem& item,
+                            int measurement_steps,
+                            OpPerformanceList* measurements) {
+  MeasuringCostEstimator estimator(cluster, measurement_steps, 0);
+  TF_RETURN_IF_ERROR(estimator.Initialize(item));
+  CostGraphDef cost_graph;
+  Costs costs;
+  TF_RETURN_IF_ERROR(estimator.PredictCosts(item.graph, &cost_graph, &costs));
+  OpPerformanceList performance =
+      CostGraphToOpPerformanceData(cost_graph, item.graph);
+  for (auto& op_performance : *performance.mutable_op_performance()) {
+    measurements->add_op_performance()->Swap(&op_performance);
+  }
+  return Status::OK();
+}
+
+Status FitOpCostCalibration(const OpPerformanceList& measurements,
+                            OpCostCalibration* calibration) {
+  // The calibration is fitted against the uncalibrated estimates.
+  OpLevelCostEstimator estimator;
+  estimator.SetCalibration(OpCostCalibration());
+
+  std::map<std::pair<string, string>, std::vector<Sample>> samples;
+  for (const OpPerformance& op_performance : measurements.op_performance()) {
+    if (op_performance.compute_cost() <= 0) {
+      // Not measured, e.g. the node didn't run.
+      continue;
+    }
+    const OpInfo& op_info = op_performance.op();
+    const Costs costs = estimator.PredictCosts(op_info);
+    Sample sample;
+    sample.features[0] = 1.0;
+    sample.features[1] = costs.compute_time.count();
+    sample.features[2] = costs.memory_time.count();
+    sample.measured_time = op_performance.compute_cost();
+    samples[std::make_pair(op_info.op(), op_info.device().type())].push_back(
+        sample);
+  }
+  if (samples.empty()) {
+    return errors::InvalidArgument(
+        "No measured op performance to calibrate the op costs from");
+  }
+
+  calibration->Clear();
+  for (const auto& op_samples : samples) {
+    // Keep the best fit over the subsets of features with non-negative
+    // coefficients. The constant alone always fits.
+    double best_coefs[kNumFeatures] = {0.0, 0.0, 0.0};
+    double best_error = -1;
+    for (int mask = 1; mask < (1 << kNumFeatures); ++mask) {
+      double coefs[kNumFeatures];
+      double error;
+      if (FitFeatures(op_samples.second, mask, coefs, &error) &&
+          (best_error < 0 || error < best_error)) {
+        best_error = error;
+        std::copy(coefs, coefs + kNumFeatures, best_coefs);
+      }
+    }
+    if (best_error < 0) continue;
+
+    OpCostCalibration::Entry* entry = calibration->add_entries();
+    entry->set_op(op_samples.first.first);
+    entry->set_device_type(op_samples.first.second);
+    entry->set_fixed_time(best_coefs[0]);
+    entry->set_compute_scale(best_coefs[1]);
+    entry->set_memory_scale(best_coefs[2]);
+    entry->set_num_samples(op_samples.second.size());
+    VLOG(1) << "Calibrated " << entry->op() << " on " << entry->device_type()
+            << " from " << entry->num_samples()
+            << " samples: fixed time " << entry->fixed_time()
+            << ", compute scale " << entry->compute_scale()
+            << ", memory scale " << entry->memory_scale()
+            << ", mean squared relative error "
+            << best_error / entry->num_samples();
+  }
+  return Status::OK();
+}
+
+Status CalibrateOpCosts(Cluster* cluster,
+                        const std::vector<GrapplerItem>& items,
+                        int measurement_steps, OpCostCalibration* calibration) {
+  OpPerformanceList measurements;
+  for (const GrapplerItem& item : items) {
+    TF_RETURN_IF_ERROR(
+        MeasureOpPerformance(cluster, item, measurement_steps, &measurements));
+  }
+  return FitOpCostCalibration(measurements, calibration);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+#define TENSORFLOW_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+
+#include <vector>
+
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class Cluster;
+struct GrapplerItem;
+
+// Runs the item on the cluster with a MeasuringCostEstimator, and appends the
+// measured performance of each of the nodes that ran to measurements.
+Status MeasureOpPerformance(Cluster* cluster, const GrapplerItem& item,
+                            int measurement_steps,
+                            OpPerformanceList* measurements);
+
+// Fits the calibration of the OpLevelCostEstimator from measured op
+// performance data. For each op and device type, the fixed time and the
+// scales of the analytical compute and memory times (see OpCostCalibration)
+// are fitted by non-negative least squares on the relative errors, so that
+// the small and the large instances of an op weigh the same.
+Status FitOpCostCalibration(const OpPerformanceList& measurements,
+                            OpCostCalibration* calibration);
+
+// Measures the items on the cluster and fits a calibration from all of their
+// nodes. The items should be representative of the graphs to optimize, and
+// run on each of the device types to calibrate. The calibration can then be
+// saved with WriteBinaryProto and loaded by the OpLevelCostEstimator (see
+// OpLevelCostEstimator::SetCalibration).
+Status CalibrateOpCosts(Cluster* cluster,
+                        const std::vector<GrapplerItem>& items,
+                        int measurement_steps, OpCostCalibration* calibration);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
@@ -0,0 +1,142 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void DescribeMatrix(int rows, int columns, OpInfo* op_features) {
+  auto input = op_features->add_inputs();
+  auto shape = input->mutable_shape();
+  shape->add_dim()->set_size(rows);
+  shape->add_dim()->set_size(columns);
+  input->set_dtype(DT_FLOAT);
+}
+
+OpInfo DescribeOp(const string& op, int m, int n, int k) {
+  OpInfo op_features;
+  op_features.set_op(op);
+  auto device = op_features.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(1);
+  device->set_frequency(2000);  // Mhz
+  DescribeMatrix(m, k, &op_features);
+  DescribeMatrix(k, n, &op_features);
+  return op_features;
+}
+
+class OpCostCalibrationTest : public ::testing::Test {
+ protected:
+  void SetUp() override { estimator_.SetCalibration(OpCostCalibration()); }
+
+  // Adds a measurement of op_features that took measured_time nanoseconds.
+  void AddMeasurement(const OpInfo& op_features, double measured_time) {
+    OpPerformance* perf = measurements_.add_op_performance();
+    *perf->mutable_op() = op_features;
+    perf->set_compute_cost(measured_time);
+  }
+
+  // The uncalibrated estimator.
+  OpLevelCostEstimator estimator_;
+  OpPerformanceList measurements_;
+};
+
+TEST_F(OpCostCalibrationTest, FitsComputeAndMemoryScales) {
+  // MatMuls that take 2x longer to compute and 3x longer to load than the
+  // analytical estimates, plus a fixed 500ns.
+  for (int m : {16, 64, 256}) {
+    for (int k : {8, 128}) {
+      const OpInfo op_features = DescribeOp("MatMul", m, 32, k);
+      const Costs costs = estimator_.PredictCosts(op_features);
+      AddMeasurement(op_features, 500 + 2 * costs.compute_time.count() +
+                                      3 * costs.memory_time.count());
+    }
+  }
+
+  OpCostCalibration calibration;
+  TF_ASSERT_OK(FitOpCostCalibration(measurements_, &calibration));
+  ASSERT_EQ(1, calibration.entries_size());
+  const OpCostCalibration::Entry& entry = calibration.entries(0);
+  EXPECT_EQ("MatMul", entry.op());
+  EXPECT_EQ("CPU", entry.device_type());
+  EXPECT_EQ(6, entry.num_samples());
+  EXPECT_NEAR(500, entry.fixed_time(), 5);
+  EXPECT_NEAR(2, entry.compute_scale(), 0.01);
+  EXPECT_NEAR(3, entry.memory_scale(), 0.01);
+
+  // The calibrated estimator predicts the measured times.
+  OpLevelCostEstimator calibrated;
+  calibrated.SetCalibration(calibration);
+  const OpInfo op_features = DescribeOp("MatMul", 128, 32, 64);
+  const Costs costs = estimator_.PredictCosts(op_features);
+  const double expected = 500 + 2 * costs.compute_time.count() +
+                          3 * costs.memory_time.count();
+  EXPECT_NEAR(expected,
+              calibrated.PredictCosts(op_features).execution_time.count(),
+              0.01 * expected);
+}
+
+TEST_F(OpCostCalibrationTest, FitsNonNegativeCoefficients) {
+  // An op without an analytical model only has a memory time, and takes the
+  // same time regardless of its size.
+  for (int m : {16, 64, 256, 1024}) {
+    AddMeasurement(DescribeOp("Relu", m, m, 1), 1000);
+  }
+
+  OpCostCalibration calibration;
+  TF_ASSERT_OK(FitOpCostCalibration(measurements_, &calibration));
+  ASSERT_EQ(1, calibration.entries_size());
+  const OpCostCalibration::Entry& entry = calibration.entries(0);
+  EXPECT_EQ("Relu", entry.op());
+  EXPECT_NEAR(1000, entry.fixed_time(), 1);
+  EXPECT_EQ(0, entry.compute_scale());
+  EXPECT_NEAR(0, entry.memory_scale(), 1e-6);
+}
+
+TEST_F(OpCostCalibrationTest, CalibratesOnlyMatchingDeviceTypes) {
+  for (int m : {16, 64, 256}) {
+    AddMeasurement(DescribeOp("Relu", m, m, 1), 1000);
+  }
+  OpCostCalibration calibration;
+  TF_ASSERT_OK(FitOpCostCalibration(measurements_, &calibration));
+
+  OpLevelCostEstimator calibrated;
+  calibrated.SetCalibration(calibration);
+  OpInfo op_features = DescribeOp("Relu", 32, 32, 1);
+  EXPECT_NEAR(1000, calibrated.PredictCosts(op_features).execution_time.count(),
+              1);
+  // Not calibrated for GPUs.
+  op_features.mutable_device()->set_type("GPU");
+  (*op_features.mutable_device()->mutable_environment())["architecture"] = "6";
+  EXPECT_EQ(estimator_.PredictCosts(op_features).execution_time,
+            calibrated.PredictCosts(op_features).execution_time);
+}
+
+TEST_F(OpCostCalibrationTest, NoMeasurements) {
+  OpCostCalibration calibration;
+  EXPECT_FALSE(FitOpCostCalibration(measurements_, &calibration).ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -34,6 +36,13 @@ constexpr char kBatchMatMul[] = "BatchMatMul";
 constexpr char kVariable[] = "Variable";
 constexpr char kVariableV2[] = "VariableV2";
 
+Status ReadOpCostCalibration(const string& filename,
+                             OpCostCalibration* calibration) {
+  return StringPiece(filename).ends_with(".pbtxt")
+             ? ReadTextProto(Env::Default(), filename, calibration)
+             : ReadBinaryProto(Env::Default(), filename, calibration);
+}
+
 OpLevelCostEstimator::OpLevelCostEstimator() {
   // Syntactic sugar to build and return a lambda that takes an OpInfo and
   // returns a cost.
@@ -60,22 +69,47 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
       {kBatchMatMul, wrap(&OpLevelCostEstimator::PredictBatchMatMul)}};
 }
 
+void OpLevelCostEstimator::SetCalibration(
+    const OpCostCalibration& calibration) {
+  calibration_.clear();
+  for (const auto& entry : calibration.entries()) {
+    calibration_[std::make_pair(entry.op(), entry.device_type())] = entry;
+  }
+}
+
 Costs OpLevelCostEstimator::PredictCosts(const OpInfo& op_features) const {
   auto it = device_cost_impl_.find(op_features.op());
   if (it == device_cost_impl_.end()) {
     VLOG(1) << "Missing implementation for op: " << op_features.op();
     Costs costs;
     costs = DummyExecutionTime(op_features);
+    Calibrate(op_features, &costs);
     return costs;
   }
 
   std::function<Costs(const OpInfo&)> estimator = it->second;
   Costs costs = estimator(op_features);
+  Calibrate(op_features, &costs);
   VLOG(1) << "Operation " << op_features.op() << " takes "
           << costs.execution_time.count() << " ns.";
   return costs;
 }
 
+void OpLevelCostEstimator::Calibrate(const OpInfo& op_features,
+                                     Costs* costs) const {
+  if (calibration_.empty()) return;
+  auto it = calibration_.find(
+      std::make_pair(op_features.op(), op_features.device().type()));
+  if (it == calibration_.end()) return;
+  const OpCostCalibration::Entry& entry = it->second;
+  costs->compute_time =
+      Costs::NanoSeconds(entry.compute_scale() * costs->compute_time.count());
+  costs->memory_time =
+      Costs::NanoSeconds(entry.memory_scale() * costs->memory_time.count());
+  costs->execution_time = Costs::NanoSeconds(entry.fixed_time()) +
+                          costs->compute_time + costs->memory_time;
+}
+
 std::pair<double, double> OpLevelCostEstimator::GetDeviceInfo(
     const DeviceProperties& device) const {
   double gflops = -1;
@@ -116,6 +150,16 @@ std::pair<double, double> OpLevelCostEstimator::GetDeviceInfo(
     } else {
       bandwidth = 100;
     }
+  } else if (device.type() == "Channel") {
+    // The transfers between devices, e.g. the _Send nodes of the
+    // VirtualScheduler, are bound by the bandwidth of the link, by default a
+    // PCIe 3.0 x16 link.
+    gflops = 1;
+    if (device.bandwidth() > 0) {
+      bandwidth = device.bandwidth() / 1e6;
+    } else {
+      bandwidth = 12;
+    }
   }
 
   return std::make_pair(gflops, bandwidth);
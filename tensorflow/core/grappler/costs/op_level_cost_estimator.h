@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <string>
+#include <utility>
 
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
@@ -34,6 +35,12 @@ class OpLevelCostEstimator {
 
   virtual Costs PredictCosts(const OpInfo& op_features) const;
 
+  // Replaces the calibration of the estimator: the analytical estimates of
+  // the ops with an entry for the type of their device are corrected by it.
+  // By default, an estimator has no calibration. The estimators of the
+  // optimizers take theirs from GrapplerItem::op_cost_calibration.
+  void SetCalibration(const OpCostCalibration& calibration);
+
  protected:
   // Returns an estimate of device performance (in billions of operations
   // executed per second) and memory bandwidth (in GigaBytes/second) for the
@@ -41,6 +48,9 @@ class OpLevelCostEstimator {
   virtual std::pair<double, double> GetDeviceInfo(
       const DeviceProperties& device) const;
 
+  // Corrects the costs of the op with its calibration entry, if any.
+  void Calibrate(const OpInfo& op_features, Costs* costs) const;
+
   // For operations for which we haven't yet built estimates, returns a dummy
   // value based on input size.
   Costs DummyExecutionTime(const OpInfo& op_features) const;
@@ -141,8 +151,16 @@ class OpLevelCostEstimator {
 
  private:
   friend class OpLevelCostEstimatorTest;
+
+  // The calibration entries, by op and device type.
+  std::map<std::pair<string, string>, OpCostCalibration::Entry> calibration_;
 };
 
+// Reads a binary or, if `filename` ends with ".pbtxt", a text
+// OpCostCalibration proto.
+Status ReadOpCostCalibration(const string& filename,
+                             OpCostCalibration* calibration);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 #endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_LEVEL_COST_ESTIMATOR_H_
@@ -16,6 +16,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/device_properties.pb.h"
 
@@ -178,5 +181,67 @@ TEST_F(OpLevelCostEstimatorTest, BatchMatMul) {
   EXPECT_NE(matmul_inaccurate, batch_matmul_inaccurate);
 }
 
+TEST_F(OpLevelCostEstimatorTest, Calibration) {
+  const OpInfo matmul = DescribeMatMul(2, 4, 7, 7);
+  const Costs uncalibrated = PredictCosts(matmul);
+
+  OpCostCalibration calibration;
+  auto entry = calibration.add_entries();
+  entry->set_op("MatMul");
+  entry->set_device_type("CPU");
+  entry->set_fixed_time(1000);
+  entry->set_compute_scale(2);
+  entry->set_memory_scale(3);
+  estimator_.SetCalibration(calibration);
+
+  const Costs calibrated = PredictCosts(matmul);
+  EXPECT_EQ(2 * uncalibrated.compute_time.count(),
+            calibrated.compute_time.count());
+  EXPECT_EQ(3 * uncalibrated.memory_time.count(),
+            calibrated.memory_time.count());
+  EXPECT_EQ(1000 + calibrated.compute_time.count() +
+                calibrated.memory_time.count(),
+            calibrated.execution_time.count());
+
+  // Other ops keep their analytical estimates.
+  const OpInfo conv = DescribeConvolution(16, 19, 19, 48, 48, 5, 5, 256);
+  estimator_.SetCalibration(OpCostCalibration());
+  const Costs conv_costs = PredictCosts(conv);
+  estimator_.SetCalibration(calibration);
+  EXPECT_EQ(conv_costs.execution_time, PredictCosts(conv).execution_time);
+}
+
+TEST_F(OpLevelCostEstimatorTest, ReadCalibration) {
+  const OpInfo matmul = DescribeMatMul(2, 4, 7, 7);
+  const Costs uncalibrated = PredictCosts(matmul);
+
+  OpCostCalibration calibration;
+  auto entry = calibration.add_entries();
+  entry->set_op("MatMul");
+  entry->set_device_type("CPU");
+  entry->set_compute_scale(2);
+  entry->set_memory_scale(2);
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "op_cost_calibration.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), filename, calibration));
+
+  OpCostCalibration read_calibration;
+  TF_ASSERT_OK(ReadOpCostCalibration(filename, &read_calibration));
+  OpLevelCostEstimator calibrated;
+  calibrated.SetCalibration(read_calibration);
+  EXPECT_EQ(2 * uncalibrated.compute_time.count(),
+            calibrated.PredictCosts(matmul).compute_time.count());
+
+  // The other estimators are not calibrated.
+  OpLevelCostEstimator uncalibrated_estimator;
+  EXPECT_EQ(uncalibrated.compute_time,
+            uncalibrated_estimator.PredictCosts(matmul).compute_time);
+
+  EXPECT_FALSE(
+      ReadOpCostCalibration(io::JoinPath(testing::TmpDir(), "missing.pbtxt"),
+                            &read_calibration)
+          .ok());
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
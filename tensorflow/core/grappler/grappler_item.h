@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/protobuf/queue_runner.pb.h"
 
 namespace tensorflow {
@@ -48,6 +49,11 @@ struct GrapplerItem {
   // Queue runner(s) required to run the queue(s) of this model.
   std::vector<QueueRunnerDef> queue_runners;
 
+  // The calibration of the op costs estimated for this item (see
+  // OpLevelCostEstimator::SetCalibration), or null to keep the analytical
+  // estimates. The copies of the item share it.
+  std::shared_ptr<const OpCostCalibration> op_cost_calibration;
+
   // Return the set of node evaluated during a regular train/inference step.
   std::vector<const NodeDef*> MainOpsFanin() const;
   // Return the set nodes used by TensorFlow to initialize the graph.
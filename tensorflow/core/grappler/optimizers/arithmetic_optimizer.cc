@@ -0,0 +1,612 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// The maximum number of passes of simplifications over the graph. A pass only
+// simplifies what the previous ones made simplifiable, so few are needed.
+const int kMaxSimplifyPasses = 10;
+
+bool HasControlInputs(const NodeDef& node) {
+  return NumDataInputs(node) < node.input_size();
+}
+
+bool IsControlFlow(const NodeDef& node) {
+  static const auto* control_flow_ops = new std::unordered_set<string>{
+      "ControlTrigger", "Enter", "Exit", "LoopCond", "Merge", "NextIteration",
+      "RefEnter", "RefExit", "RefMerge", "RefNextIteration", "RefSwitch",
+      "Switch"};
+  return control_flow_ops->count(node.op()) > 0;
+}
+
+DataType GetType(const NodeDef& node, const string& attr_name) {
+  auto attr = node.attr().find(attr_name);
+  return attr == node.attr().end() ? DT_INVALID : attr->second.type();
+}
+
+// Returns true iff the order of the data inputs of node does not matter.
+bool IsCommutative(const NodeDef& node) {
+  static const auto* commutative_ops = new std::unordered_set<string>{
+      "Add", "AddN", "Equal", "LogicalAnd", "LogicalOr", "Maximum", "Minimum",
+      "Mul", "NotEqual", "SquaredDifference"};
+  // The Add of strings concatenates them.
+  return commutative_ops->count(node.op()) > 0 &&
+         GetType(node, "T") != DT_STRING;
+}
+
+// Returns a signature that is the same for the nodes that compute the same
+// values: the nodes of the same op, device, attributes and inputs.
+string NodeSignature(const NodeDef& node) {
+  const int num_inputs = NumDataInputs(node);
+  std::vector<string> inputs;
+  for (int i = 0; i < num_inputs; ++i) {
+    const string& input = node.input(i);
+    inputs.push_back(NodePosition(input) == 0 ? NodeName(input) : input);
+  }
+  if (IsCommutative(node)) {
+    std::sort(inputs.begin(), inputs.end());
+  }
+  const std::set<string> control_inputs(node.input().begin() + num_inputs,
+                                        node.input().end());
+  string signature = strings::StrCat(node.op(), ";", node.device());
+  for (const string& input : inputs) {
+    strings::StrAppend(&signature, ";", input);
+  }
+  for (const string& input : control_inputs) {
+    strings::StrAppend(&signature, ";", input);
+  }
+  // The attributes in a deterministic order.
+  const std::map<string, AttrValue> attrs(node.attr().begin(),
+                                          node.attr().end());
+  for (const auto& attr : attrs) {
+    strings::StrAppend(&signature, ";", attr.first, "=",
+                       attr.second.SerializeAsString());
+  }
+  return signature;
+}
+
+// Returns the node of the tensor if it is the first output of a node of op op,
+// without control inputs, or nullptr otherwise.
+NodeDef* GetBypassableInput(const string& tensor, const string& op,
+                            const NodeMap& node_map) {
+  if (IsControlInput(tensor) || NodePosition(tensor) != 0) return nullptr;
+  NodeDef* node = node_map.GetNode(tensor);
+  if (node == nullptr || node->op() != op || HasControlInputs(*node)) {
+    return nullptr;
+  }
+  return node;
+}
+
+// Gets the value of the tensor if it is the output of a Const node.
+bool GetConstantValue(const string& tensor, const NodeMap& node_map,
+                      Tensor* value) {
+  if (IsControlInput(tensor) || NodePosition(tensor) != 0) return false;
+  const NodeDef* node = node_map.GetNode(tensor);
+  if (node == nullptr || !IsConstant(*node)) return false;
+  auto attr = node->attr().find("value");
+  return attr != node->attr().end() && value->FromProto(attr->second.tensor());
+}
+
+// Gets the permutation of a Transpose from the tensor of its second input.
+bool GetPermutation(const string& tensor, const NodeMap& node_map,
+                    std::vector<int64>* permutation) {
+  Tensor value;
+  if (!GetConstantValue(tensor, node_map, &value) || value.dims() != 1) {
+    return false;
+  }
+  permutation->clear();
+  for (int i = 0; i < value.NumElements(); ++i) {
+    if (value.dtype() == DT_INT32) {
+      permutation->push_back(value.vec<int32>()(i));
+    } else if (value.dtype() == DT_INT64) {
+      permutation->push_back(value.vec<int64>()(i));
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true iff the tensor is a scalar constant of the given value.
+bool IsScalarConstant(const string& tensor, const NodeMap& node_map,
+                      int value) {
+  Tensor constant;
+  if (!GetConstantValue(tensor, node_map, &constant) || constant.dims() != 0) {
+    return false;
+  }
+  switch (constant.dtype()) {
+    case DT_FLOAT:
+      return constant.scalar<float>()() == value;
+    case DT_DOUBLE:
+      return constant.scalar<double>()() == value;
+    case DT_INT32:
+      return constant.scalar<int32>()() == value;
+    case DT_INT64:
+      return constant.scalar<int64>()() == value;
+    default:
+      return false;
+  }
+}
+
+// Returns true iff casting from src to dst and back to src is the identity.
+bool IsLosslessCast(DataType src, DataType dst) {
+  switch (src) {
+    case DT_HALF:
+      return dst == DT_FLOAT || dst == DT_DOUBLE;
+    case DT_FLOAT:
+      return dst == DT_DOUBLE;
+    case DT_INT8:
+      return dst == DT_INT16 || dst == DT_INT32 || dst == DT_INT64;
+    case DT_INT16:
+      return dst == DT_INT32 || dst == DT_INT64;
+    case DT_INT32:
+      return dst == DT_INT64;
+    case DT_UINT8:
+      return dst == DT_UINT16 || dst == DT_INT16 || dst == DT_INT32 ||
+             dst == DT_INT64;
+    case DT_UINT16:
+      return dst == DT_INT32 || dst == DT_INT64;
+    default:
+      return false;
+  }
+}
+
+// Gets the statically inferred shape of the tensor, if it is fully defined.
+bool GetFullyDefinedShape(const string& tensor,
+                          const GraphProperties* properties,
+                          TensorShapeProto* shape) {
+  if (properties == nullptr || IsControlInput(tensor)) return false;
+  const string node = NodeName(tensor);
+  if (!properties->HasOutputProperties(node)) return false;
+  const std::vector<OpInfo::TensorProperties> outputs =
+      properties->GetOutputProperties(node);
+  const int position = NodePosition(tensor);
+  if (position >= outputs.size()) return false;
+  *shape = outputs[position].shape();
+  if (shape->unknown_rank()) return false;
+  for (const auto& dim : shape->dim()) {
+    if (dim.size() < 0) return false;
+  }
+  return true;
+}
+
+bool ShapesEqual(const TensorShapeProto& shape1,
+                 const TensorShapeProto& shape2) {
+  if (shape1.dim_size() != shape2.dim_size()) return false;
+  for (int i = 0; i < shape1.dim_size(); ++i) {
+    if (shape1.dim(i).size() != shape2.dim(i).size()) return false;
+  }
+  return true;
+}
+
+// Returns name, with a suffix if the graph already has a node of that name.
+string UniqueNodeName(const string& name, const NodeMap& node_map) {
+  string unique_name = name;
+  for (int i = 1; node_map.GetNode(unique_name) != nullptr; ++i) {
+    unique_name = strings::StrCat(name, "_", i);
+  }
+  return unique_name;
+}
+
+}  // namespace
+
+bool ArithmeticOptimizer::CanDedup(const NodeDef& node) const {
+  if (nodes_to_preserve_.count(node.name()) || IsPlaceholder(node) ||
+      IsControlFlow(node)) {
+    return false;
+  }
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+      op_def->is_stateful() || op_def->output_arg_size() == 0) {
+    return false;
+  }
+  for (const auto& output_arg : op_def->output_arg()) {
+    if (output_arg.is_ref()) return false;
+  }
+  return true;
+}
+
+void ArithmeticOptimizer::DedupComputations(GraphDef* graph) const {
+  // The inputs of the consumers of a duplicate change, which can make them
+  // duplicates in turn, so dedup until there are no more duplicates.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    NodeMap node_map(graph);
+    std::unordered_map<string, const NodeDef*> representatives;
+    std::unordered_set<string> duplicates;
+    for (const NodeDef& node : graph->node()) {
+      if (!CanDedup(node)) continue;
+      auto representative =
+          representatives.emplace(NodeSignature(node), &node);
+      if (representative.second) continue;
+      const string& representative_name = representative.first->second->name();
+      for (NodeDef* output : node_map.GetOutputs(node.name())) {
+        for (int i = 0; i < output->input_size(); ++i) {
+          int position;
+          if (ParseNodeName(output->input(i), &position) != node.name()) {
+            continue;
+          }
+          if (position < 0) {
+            output->set_input(i, strings::StrCat("^", representative_name));
+          } else if (position == 0) {
+            output->set_input(i, representative_name);
+          } else {
+            output->set_input(
+                i, strings::StrCat(representative_name, ":", position));
+          }
+        }
+      }
+      duplicates.insert(node.name());
+      changed = true;
+    }
+    RemoveNodes(duplicates, graph);
+    VLOG(2) << "Removed " << duplicates.size() << " duplicate nodes.";
+  }
+}
+
+string ArithmeticOptimizer::ControlDependencyOn(
+    const string& tensor, const NodeDef& node, NodeMap* node_map,
+    GraphDef* graph) const {
+  const NodeDef* producer = node_map->GetNode(tensor);
+  if (producer == nullptr || !IsSwitch(*producer)) {
+    return strings::StrCat("^", NodeName(tensor));
+  }
+  // Only the taken output of a Switch is produced, but a control dependency
+  // on the Switch itself would be triggered on both branches. As in
+  // ConstantFolding::AddControlDependency(), anchor it on an Identity of the
+  // output instead, reusing an existing one if there is one.
+  for (const NodeDef* output : node_map->GetOutputs(producer->name())) {
+    if (IsIdentity(*output) && output != &node && output->input_size() == 1 &&
+        IsSameInput(output->input(0), tensor)) {
+      return strings::StrCat("^", output->name());
+    }
+  }
+  int position = 0;
+  string anchor_name = ParseNodeName(tensor, &position);
+  strings::StrAppend(&anchor_name, "_", position);
+  NodeDef* anchor = graph->add_node();
+  anchor->set_name(UniqueNodeName(
+      AddPrefixToNodeName(anchor_name, "ArithmeticOptimizer/ControlDependency",
+                          "_"),
+      *node_map));
+  anchor->set_op("Identity");
+  anchor->set_device(producer->device());
+  (*anchor->mutable_attr())["T"].set_type(producer->attr().at("T").type());
+  anchor->add_input(tensor);
+  node_map->AddNode(anchor->name(), anchor);
+  node_map->AddOutput(producer->name(), anchor->name());
+  return strings::StrCat("^", anchor->name());
+}
+
+void ArithmeticOptimizer::ReplaceWith(
+    NodeDef* node, const string& tensor, DataType type, NodeMap* node_map,
+    GraphDef* graph, std::unordered_set<string>* bypassed_nodes) const {
+  if (!nodes_to_preserve_.count(node->name()) && !HasControlInputs(*node)) {
+    string control_input;
+    for (NodeDef* output : node_map->GetOutputs(node->name())) {
+      for (int i = 0; i < output->input_size(); ++i) {
+        int position;
+        if (ParseNodeName(output->input(i), &position) != node->name()) {
+          continue;
+        }
+        if (position >= 0) {
+          output->set_input(i, tensor);
+          continue;
+        }
+        if (control_input.empty()) {
+          control_input = ControlDependencyOn(tensor, *node, node_map, graph);
+        }
+        output->set_input(i, control_input);
+        node_map->AddOutput(NodeName(control_input), output->name());
+      }
+      node_map->AddOutput(NodeName(tensor), output->name());
+    }
+    bypassed_nodes->insert(node->name());
+    return;
+  }
+  // Keep the node, its control inputs and its internal attributes such as the
+  // colocation constraints.
+  NodeDef identity;
+  identity.set_name(node->name());
+  identity.set_op("Identity");
+  identity.set_device(node->device());
+  identity.add_input(tensor);
+  for (int i = NumDataInputs(*node); i < node->input_size(); ++i) {
+    identity.add_input(node->input(i));
+  }
+  for (const auto& attr : node->attr()) {
+    if (!attr.first.empty() && attr.first[0] == '_') {
+      (*identity.mutable_attr())[attr.first] = attr.second;
+    }
+  }
+  (*identity.mutable_attr())["T"].set_type(type);
+  node->Swap(&identity);
+  node_map->AddOutput(NodeName(tensor), node->name());
+}
+
+bool ArithmeticOptimizer::TrySimplify(
+    NodeDef* node, const GraphProperties* properties, NodeMap* node_map,
+    GraphDef* graph, std::unordered_set<string>* bypassed_nodes) const {
+  const int num_inputs = NumDataInputs(*node);
+  const DataType type = GetType(*node, "T");
+
+  // Transpose(x, identity) => x, and
+  // Transpose(Transpose(x, p1), p2) => x if p2 is the inverse of p1.
+  if (IsTranspose(*node) && num_inputs == 2) {
+    std::vector<int64> permutation;
+    if (!GetPermutation(node->input(1), *node_map, &permutation)) {
+      return false;
+    }
+    bool is_identity = true;
+    for (int i = 0; i < permutation.size(); ++i) {
+      is_identity &= permutation[i] == i;
+    }
+    if (is_identity) {
+      ReplaceWith(node, node->input(0), type, node_map, graph, bypassed_nodes);
+      return true;
+    }
+    const NodeDef* inner =
+        GetBypassableInput(node->input(0), "Transpose", *node_map);
+    std::vector<int64> inner_permutation;
+    if (inner == nullptr || inner->input_size() != 2 ||
+        !GetPermutation(inner->input(1), *node_map, &inner_permutation) ||
+        inner_permutation.size() != permutation.size()) {
+      return false;
+    }
+    for (int i = 0; i < permutation.size(); ++i) {
+      if (permutation[i] < 0 || permutation[i] >= permutation.size() ||
+          inner_permutation[permutation[i]] != i) {
+        return false;
+      }
+    }
+    bypassed_nodes->insert(inner->name());
+    ReplaceWith(node, inner->input(0), type, node_map, graph, bypassed_nodes);
+    return true;
+  }
+
+  // Reshape(Reshape(x, s1), s2) => Reshape(x, s2), and
+  // Reshape(x, s) => x if x already has the shape s.
+  if (node->op() == "Reshape" && num_inputs == 2) {
+    NodeDef* inner = GetBypassableInput(node->input(0), "Reshape", *node_map);
+    if (inner != nullptr && inner->input_size() == 2) {
+      bypassed_nodes->insert(inner->name());
+      node->set_input(0, inner->input(0));
+      node_map->AddOutput(NodeName(node->input(0)), node->name());
+      return true;
+    }
+    TensorShapeProto input_shape;
+    TensorShapeProto output_shape;
+    if (GetFullyDefinedShape(node->input(0), properties, &input_shape) &&
+        GetFullyDefinedShape(node->name(), properties, &output_shape) &&
+        ShapesEqual(input_shape, output_shape)) {
+      ReplaceWith(node, node->input(0), type, node_map, graph, bypassed_nodes);
+      return true;
+    }
+    return false;
+  }
+
+  // Cast(x) => x if it casts to the type of x, and
+  // Cast(Cast(x)) => x if the inner Cast is lossless.
+  if (node->op() == "Cast" && num_inputs == 1) {
+    const DataType src_type = GetType(*node, "SrcT");
+    const DataType dst_type = GetType(*node, "DstT");
+    if (src_type == dst_type) {
+      ReplaceWith(node, node->input(0), dst_type, node_map, graph,
+                  bypassed_nodes);
+      return true;
+    }
+    const NodeDef* inner =
+        GetBypassableInput(node->input(0), "Cast", *node_map);
+    if (inner != nullptr && GetType(*inner, "SrcT") == dst_type &&
+        GetType(*inner, "DstT") == src_type &&
+        IsLosslessCast(dst_type, src_type)) {
+      bypassed_nodes->insert(inner->name());
+      ReplaceWith(node, inner->input(0), dst_type, node_map, graph,
+                  bypassed_nodes);
+      return true;
+    }
+    return false;
+  }
+
+  // Identity(Identity(x)) => Identity(x) on the same device.
+  if (IsIdentity(*node) && num_inputs == 1) {
+    NodeDef* inner = GetBypassableInput(node->input(0), "Identity", *node_map);
+    if (inner != nullptr && inner->device() == node->device()) {
+      bypassed_nodes->insert(inner->name());
+      node->set_input(0, inner->input(0));
+      node_map->AddOutput(NodeName(node->input(0)), node->name());
+      return true;
+    }
+    return false;
+  }
+
+  // x * 1, 1 * x, x / 1, x + 0, 0 + x and x - 0 => x, for a scalar 1 or 0 that
+  // does not change the shape of x.
+  if (num_inputs == 2) {
+    const string& op = node->op();
+    const bool is_mul = op == "Mul";
+    const bool is_add = op == "Add" && type != DT_STRING;
+    const bool is_div = op == "Div" || op == "RealDiv";
+    const bool is_sub = op == "Sub";
+    if (is_mul || is_add || is_div || is_sub) {
+      const int neutral = is_mul || is_div ? 1 : 0;
+      if (IsScalarConstant(node->input(1), *node_map, neutral)) {
+        ReplaceWith(node, node->input(0), type, node_map, graph,
+                    bypassed_nodes);
+        return true;
+      }
+      if ((is_mul || is_add) &&
+          IsScalarConstant(node->input(0), *node_map, neutral)) {
+        ReplaceWith(node, node->input(1), type, node_map, graph,
+                    bypassed_nodes);
+        return true;
+      }
+      return false;
+    }
+  }
+
+  // AddN(Mul(x, a1), ..., Mul(x, an)) => Mul(x, AddN(a1, ..., an)) if the
+  // multiplications are only used by the AddN and the ai have the same shape.
+  if (node->op() == "AddN" && num_inputs >= 2 && properties != nullptr) {
+    std::vector<const NodeDef*> muls;
+    for (int i = 0; i < num_inputs; ++i) {
+      const NodeDef* mul = GetBypassableInput(node->input(i), "Mul", *node_map);
+      if (mul == nullptr || mul->input_size() != 2 ||
+          mul->device() != node->device() ||
+          nodes_to_preserve_.count(mul->name()) ||
+          node_map->GetOutputs(mul->name()).size() != 1) {
+        return false;
+      }
+      for (int j = 0; j < num_inputs; ++j) {
+        if (j != i && NodeName(node->input(j)) == mul->name()) return false;
+      }
+      muls.push_back(mul);
+    }
+    for (const string& common : muls[0]->input()) {
+      std::vector<string> factors;
+      for (const NodeDef* mul : muls) {
+        if (mul->input(0) == common) {
+          factors.push_back(mul->input(1));
+        } else if (mul->input(1) == common) {
+          factors.push_back(mul->input(0));
+        } else {
+          break;
+        }
+      }
+      if (factors.size() != muls.size()) continue;
+      TensorShapeProto shape;
+      if (!GetFullyDefinedShape(factors[0], properties, &shape)) continue;
+      bool same_shapes = true;
+      for (const string& factor : factors) {
+        TensorShapeProto factor_shape;
+        same_shapes &=
+            GetFullyDefinedShape(factor, properties, &factor_shape) &&
+            ShapesEqual(shape, factor_shape);
+      }
+      if (!same_shapes) continue;
+
+      NodeDef* sum = graph->add_node();
+      sum->set_name(UniqueNodeName(
+          AddPrefixToNodeName(node->name(),
+                              "ArithmeticOptimizer/HoistCommonFactor", "_"),
+          *node_map));
+      sum->set_op("AddN");
+      sum->set_device(node->device());
+      (*sum->mutable_attr())["N"].set_i(factors.size());
+      (*sum->mutable_attr())["T"].set_type(type);
+      for (const string& factor : factors) {
+        sum->add_input(factor);
+        node_map->AddOutput(NodeName(factor), sum->name());
+      }
+      node_map->AddNode(sum->name(), sum);
+
+      for (const NodeDef* mul : muls) {
+        bypassed_nodes->insert(mul->name());
+      }
+      // Turn the AddN into the Mul, keeping its name and control inputs.
+      const string common_input = common;
+      node->set_op("Mul");
+      node->mutable_attr()->erase("N");
+      node->set_input(0, common_input);
+      node->set_input(1, sum->name());
+      node->mutable_input()->DeleteSubrange(2, num_inputs - 2);
+      node_map->AddOutput(NodeName(common_input), node->name());
+      node_map->AddOutput(sum->name(), node->name());
+      return true;
+    }
+    return false;
+  }
+  return false;
+}
+
+Status ArithmeticOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                     GraphDef* output) {
+  *output = item.graph;
+  nodes_to_preserve_.clear();
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve_.insert(NodeName(feed.first));
+  }
+
+  DedupComputations(output);
+
+  // The shapes of the nodes are those of the input graph: the simplifications
+  // keep the names and values of the nodes they do not remove.
+  GraphProperties properties(item);
+  const bool has_properties = properties.InferStatically().ok();
+
+  bool changed = true;
+  for (int pass = 0; pass < kMaxSimplifyPasses && changed; ++pass) {
+    changed = false;
+    NodeMap node_map(output);
+    std::unordered_set<string> bypassed_nodes;
+    // The nodes added by the simplifications are simplified in the next pass.
+    const int num_nodes = output->node_size();
+    for (int i = 0; i < num_nodes; ++i) {
+      NodeDef* node = output->mutable_node(i);
+      if (bypassed_nodes.count(node->name())) continue;
+      changed |= TrySimplify(node, has_properties ? &properties : nullptr,
+                             &node_map, output, &bypassed_nodes);
+    }
+
+    // Remove the bypassed nodes that are no longer used.
+    NodeMap updated_node_map(output);
+    std::unordered_set<string> unused_nodes;
+    for (const string& node : bypassed_nodes) {
+      if (!nodes_to_preserve_.count(node) &&
+          updated_node_map.GetOutputs(node).empty()) {
+        unused_nodes.insert(node);
+      }
+    }
+    RemoveNodes(unused_nodes, output);
+  }
+  return Status::OK();
+}
+
+void ArithmeticOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                   const GraphDef& optimize_output,
+                                   double result) {
+  // Nothing to do for ArithmeticOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
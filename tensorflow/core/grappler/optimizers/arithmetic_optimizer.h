@@ -0,0 +1,85 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_ARITHMETIC_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_ARITHMETIC_OPTIMIZER_H_
+
+#include <unordered_set>
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class GraphProperties;
+class NodeMap;
+
+// Simplify the arithmetic of a graph, along the lines of the algebraic
+// simplifier of XLA:
+// - Common subexpression elimination of the stateless nodes.
+// - Cancellation of the inverse pairs: Transpose(Transpose(x)) with inverse
+//   permutations and lossless Cast round trips are replaced by x.
+// - Collapsing of the Reshape and Identity chains, and removal of the no-op
+//   Transpose, Reshape and Cast nodes.
+// - Removal of the multiplications and divisions by one and of the additions
+//   and subtractions of zero.
+// - Hoisting of a common factor out of an AddN of multiplications:
+//   AddN(Mul(x, a), Mul(x, b)) is replaced by Mul(x, AddN(a, b)).
+//
+// The materialization of the Shape, Size and Rank nodes of statically known
+// shapes is left to the constant folding.
+class ArithmeticOptimizer : public GraphOptimizer {
+ public:
+  ArithmeticOptimizer() {}
+  ~ArithmeticOptimizer() override {}
+
+  string name() const override { return "arithmetic_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  // Returns true iff node can be replaced by an equivalent node.
+  bool CanDedup(const NodeDef& node) const;
+  // Replaces the duplicate nodes of the graph with a single node.
+  void DedupComputations(GraphDef* graph) const;
+
+  // Tries to simplify node, and returns true iff the graph was changed. The
+  // nodes bypassed by the simplification are added to bypassed_nodes, to be
+  // removed if they are no longer used.
+  bool TrySimplify(NodeDef* node, const GraphProperties* properties,
+                   NodeMap* node_map, GraphDef* graph,
+                   std::unordered_set<string>* bypassed_nodes) const;
+  // Replaces the uses of the output of node with tensor, or node with an
+  // Identity of tensor if its name must be preserved or it has control
+  // inputs.
+  void ReplaceWith(NodeDef* node, const string& tensor, DataType type,
+                   NodeMap* node_map, GraphDef* graph,
+                   std::unordered_set<string>* bypassed_nodes) const;
+  // Returns a control input that is triggered when tensor is produced, to
+  // replace the control inputs on node. This adds an Identity of tensor to
+  // graph if tensor is an output of a Switch that has none.
+  string ControlDependencyOn(const string& tensor, const NodeDef& node,
+                             NodeMap* node_map, GraphDef* graph) const;
+
+  std::unordered_set<string> nodes_to_preserve_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_ARITHMETIC_OPTIMIZER_H_
@@ -0,0 +1,273 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ArithmeticOptimizerTest : public ::testing::Test {
+ protected:
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  std::vector<string> Inputs(const NodeDef& node) {
+    return std::vector<string>(node.input().begin(), node.input().end());
+  }
+
+  // Optimizes the graph of s, fetching fetch.
+  GraphDef Optimize(const Scope& s, const string& fetch) {
+    GrapplerItem item;
+    item.fetch.push_back(fetch);
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    ArithmeticOptimizer optimizer;
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+    return output;
+  }
+};
+
+TEST_F(ArithmeticOptimizerTest, DedupsCommutedComputations) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f}, {2});
+  Output y = ops::Const(s.WithOpName("y"), {3.0f, 4.0f}, {2});
+  Output x_copy = ops::Const(s.WithOpName("x_copy"), {1.0f, 2.0f}, {2});
+  Output add1 = ops::Add(s.WithOpName("add1"), x, y);
+  Output add2 = ops::Add(s.WithOpName("add2"), y, x_copy);
+  ops::Sub(s.WithOpName("output"), add1, add2);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(4, output.node_size());
+  EXPECT_EQ(nullptr, FindNode(output, "x_copy"));
+  EXPECT_EQ(nullptr, FindNode(output, "add2"));
+  const NodeDef* sub = FindNode(output, "output");
+  ASSERT_NE(nullptr, sub);
+  EXPECT_EQ(std::vector<string>({"add1", "add1"}), Inputs(*sub));
+}
+
+TEST_F(ArithmeticOptimizerTest, DoesNotDedupPlaceholders) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT);
+  ops::Add(s.WithOpName("output"), x, y);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(3, output.node_size());
+}
+
+TEST_F(ArithmeticOptimizerTest, RemovesInverseTransposes) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output perm1 = ops::Const(s.WithOpName("perm1"), {0, 2, 3, 1}, {4});
+  Output perm2 = ops::Const(s.WithOpName("perm2"), {0, 3, 1, 2}, {4});
+  Output transpose1 = ops::Transpose(s.WithOpName("transpose1"), x, perm1);
+  Output transpose2 =
+      ops::Transpose(s.WithOpName("transpose2"), transpose1, perm2);
+  ops::Identity(s.WithOpName("output"), transpose2);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(nullptr, FindNode(output, "transpose1"));
+  EXPECT_EQ(nullptr, FindNode(output, "transpose2"));
+  const NodeDef* identity = FindNode(output, "output");
+  ASSERT_NE(nullptr, identity);
+  EXPECT_EQ(std::vector<string>({"x"}), Inputs(*identity));
+}
+
+TEST_F(ArithmeticOptimizerTest, KeepsNonInverseTransposes) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output perm = ops::Const(s.WithOpName("perm"), {0, 2, 3, 1}, {4});
+  Output transpose1 = ops::Transpose(s.WithOpName("transpose1"), x, perm);
+  Output transpose2 =
+      ops::Transpose(s.WithOpName("transpose2"), transpose1, perm);
+  ops::Identity(s.WithOpName("output"), transpose2);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_NE(nullptr, FindNode(output, "transpose1"));
+  EXPECT_NE(nullptr, FindNode(output, "transpose2"));
+}
+
+TEST_F(ArithmeticOptimizerTest, CollapsesReshapes) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output shape1 = ops::Const(s.WithOpName("shape1"), {4, 6}, {2});
+  Output shape2 = ops::Const(s.WithOpName("shape2"), {2, 12}, {2});
+  Output reshape1 = ops::Reshape(s.WithOpName("reshape1"), x, shape1);
+  Output reshape2 = ops::Reshape(s.WithOpName("reshape2"), reshape1, shape2);
+  ops::Identity(s.WithOpName("output"), reshape2);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(nullptr, FindNode(output, "reshape1"));
+  const NodeDef* reshape = FindNode(output, "reshape2");
+  ASSERT_NE(nullptr, reshape);
+  EXPECT_EQ(std::vector<string>({"x", "shape2"}), Inputs(*reshape));
+}
+
+TEST_F(ArithmeticOptimizerTest, RemovesMultiplicationByOne) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output one = ops::Const(s.WithOpName("one"), 1.0f, {});
+  Output zero = ops::Const(s.WithOpName("zero"), 0.0f, {});
+  Output mul = ops::Mul(s.WithOpName("mul"), one, x);
+  Output add = ops::Add(s.WithOpName("add"), mul, zero);
+  ops::Identity(s.WithOpName("output"), add);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(nullptr, FindNode(output, "mul"));
+  EXPECT_EQ(nullptr, FindNode(output, "add"));
+  const NodeDef* identity = FindNode(output, "output");
+  ASSERT_NE(nullptr, identity);
+  EXPECT_EQ(std::vector<string>({"x"}), Inputs(*identity));
+}
+
+TEST_F(ArithmeticOptimizerTest, ReplacesFetchedMultiplicationByIdentity) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output one = ops::Const(s.WithOpName("one"), 1.0f, {});
+  ops::Mul(s.WithOpName("mul"), x, one);
+
+  GraphDef output = Optimize(s, "mul");
+
+  const NodeDef* mul = FindNode(output, "mul");
+  ASSERT_NE(nullptr, mul);
+  EXPECT_EQ("Identity", mul->op());
+  EXPECT_EQ(std::vector<string>({"x"}), Inputs(*mul));
+  EXPECT_EQ(DT_FLOAT, mul->attr().at("T").type());
+}
+
+TEST_F(ArithmeticOptimizerTest, AnchorsControlDependenciesOnSwitchOutputs) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output pred = ops::Placeholder(s.WithOpName("pred"), DT_BOOL);
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT);
+  ops::Switch sw(s.WithOpName("switch"), x, pred);
+  Output one = ops::Const(s.WithOpName("one"), 1.0f, {});
+  Output mul = ops::Mul(s.WithOpName("mul"), sw.output_true, one);
+  ops::Identity(s.WithOpName("output").WithControlDependencies(mul), y);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(nullptr, FindNode(output, "mul"));
+  // A control dependency on the Switch would be triggered on both branches.
+  const NodeDef* identity = FindNode(output, "output");
+  ASSERT_NE(nullptr, identity);
+  EXPECT_EQ(std::vector<string>(
+                {"y", "^ArithmeticOptimizer/ControlDependency_switch_1"}),
+            Inputs(*identity));
+  const NodeDef* anchor =
+      FindNode(output, "ArithmeticOptimizer/ControlDependency_switch_1");
+  ASSERT_NE(nullptr, anchor);
+  EXPECT_EQ("Identity", anchor->op());
+  EXPECT_EQ(std::vector<string>({"switch:1"}), Inputs(*anchor));
+}
+
+TEST_F(ArithmeticOptimizerTest, RemovesLosslessCastRoundTrips) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output to_double = ops::Cast(s.WithOpName("to_double"), x, DT_DOUBLE);
+  Output to_float = ops::Cast(s.WithOpName("to_float"), to_double, DT_FLOAT);
+  Output to_int = ops::Cast(s.WithOpName("to_int"), to_float, DT_INT32);
+  Output back = ops::Cast(s.WithOpName("back"), to_int, DT_FLOAT);
+  ops::Identity(s.WithOpName("output"), back);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(nullptr, FindNode(output, "to_double"));
+  EXPECT_EQ(nullptr, FindNode(output, "to_float"));
+  // The round trip through int32 is lossy.
+  const NodeDef* to_int_node = FindNode(output, "to_int");
+  ASSERT_NE(nullptr, to_int_node);
+  EXPECT_EQ(std::vector<string>({"x"}), Inputs(*to_int_node));
+  EXPECT_NE(nullptr, FindNode(output, "back"));
+}
+
+TEST_F(ArithmeticOptimizerTest, CollapsesIdentities) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output identity1 = ops::Identity(s.WithOpName("identity1"), x);
+  Output identity2 = ops::Identity(s.WithOpName("identity2"), identity1);
+  ops::Identity(s.WithOpName("output"), identity2);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(2, output.node_size());
+  const NodeDef* identity = FindNode(output, "output");
+  ASSERT_NE(nullptr, identity);
+  EXPECT_EQ(std::vector<string>({"x"}), Inputs(*identity));
+}
+
+TEST_F(ArithmeticOptimizerTest, HoistsCommonFactorOutOfAddN) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f}, {1, 2});
+  Output a = ops::Const(s.WithOpName("a"), {3.0f, 4.0f}, {1, 2});
+  Output b = ops::Const(s.WithOpName("b"), {5.0f, 6.0f}, {1, 2});
+  Output mul1 = ops::Mul(s.WithOpName("mul1"), x, a);
+  Output mul2 = ops::Mul(s.WithOpName("mul2"), b, x);
+  Output add = ops::AddN(s.WithOpName("add"), {mul1, mul2});
+  ops::Identity(s.WithOpName("output"), add);
+
+  GraphDef output = Optimize(s, "output");
+
+  EXPECT_EQ(nullptr, FindNode(output, "mul1"));
+  EXPECT_EQ(nullptr, FindNode(output, "mul2"));
+  const NodeDef* mul = FindNode(output, "add");
+  ASSERT_NE(nullptr, mul);
+  EXPECT_EQ("Mul", mul->op());
+  const string sum_name = "ArithmeticOptimizer/HoistCommonFactor_add";
+  EXPECT_EQ(std::vector<string>({"x", sum_name}), Inputs(*mul));
+  const NodeDef* sum = FindNode(output, sum_name);
+  ASSERT_NE(nullptr, sum);
+  EXPECT_EQ("AddN", sum->op());
+  EXPECT_EQ(std::vector<string>({"a", "b"}), Inputs(*sum));
+  EXPECT_EQ(2, sum->attr().at("N").i());
+}
+
+TEST_F(ArithmeticOptimizerTest, DoesNotHoistBroadcastFactors) {
+  Scope s = Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f}, {1, 2});
+  Output a = ops::Const(s.WithOpName("a"), 3.0f, {});
+  Output b = ops::Const(s.WithOpName("b"), {5.0f, 6.0f}, {1, 2});
+  Output mul1 = ops::Mul(s.WithOpName("mul1"), x, a);
+  Output mul2 = ops::Mul(s.WithOpName("mul2"), x, b);
+  Output add = ops::AddN(s.WithOpName("add"), {mul1, mul2});
+  ops::Identity(s.WithOpName("output"), add);
+
+  GraphDef output = Optimize(s, "output");
+
+  const NodeDef* add_node = FindNode(output, "add");
+  ASSERT_NE(nullptr, add_node);
+  EXPECT_EQ("AddN", add_node->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
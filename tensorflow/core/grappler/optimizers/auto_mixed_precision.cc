@@ -0,0 +1,265 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/devices.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// The ops that are much faster in float16, and always run in float16.
+const std::unordered_set<string>& Float16Ops() {
+  static const auto* ops = new std::unordered_set<string>{
+      "BatchMatMul", "Conv2D", "Conv2DBackpropFilter", "Conv2DBackpropInput",
+      "MatMul"};
+  return *ops;
+}
+
+// The ops that are numerically safe in float16, and run in float16 when one
+// of their inputs is computed in float16. All of them, like the ops above,
+// have float16 GPU kernels.
+const std::unordered_set<string>& Float16SafeOps() {
+  static const auto* ops = new std::unordered_set<string>{
+      "Add",         "AddN",      "AvgPool",     "AvgPoolGrad", "BiasAdd",
+      "BiasAddGrad", "ConcatV2",  "Elu",         "EluGrad",     "ExpandDims",
+      "Identity",    "MaxPool",   "MaxPoolGrad", "Maximum",     "Minimum",
+      "Mul",         "Neg",       "Relu",        "Relu6",       "Relu6Grad",
+      "ReluGrad",    "Reshape",   "Sigmoid",     "SigmoidGrad", "Slice",
+      "Square",      "Squeeze",   "Sub",         "Tanh",        "TanhGrad",
+      "Transpose"};
+  return *ops;
+}
+
+// Returns the positions of the inputs (or outputs) of node described by args
+// that have the type of the attribute T.
+std::vector<int> PortsOfTypeT(
+    const NodeDef& node,
+    const protobuf::RepeatedPtrField<OpDef::ArgDef>& args) {
+  std::vector<int> ports;
+  int port = 0;
+  for (const auto& arg : args) {
+    int num_ports = 1;
+    if (!arg.number_attr().empty()) {
+      auto number = node.attr().find(arg.number_attr());
+      num_ports = number == node.attr().end() ? 0 : number->second.i();
+    } else if (!arg.type_list_attr().empty()) {
+      auto types = node.attr().find(arg.type_list_attr());
+      num_ports =
+          types == node.attr().end() ? 0 : types->second.list().type_size();
+    }
+    for (int i = 0; i < num_ports; ++i, ++port) {
+      if (arg.type_attr() == "T") ports.push_back(port);
+    }
+  }
+  return ports;
+}
+
+bool Contains(const std::vector<int>& ports, int port) {
+  return std::find(ports.begin(), ports.end(), port) != ports.end();
+}
+
+}  // namespace
+
+bool AutoMixedPrecision::CanRunInFloat16(const NodeDef& node) const {
+  if (nodes_to_preserve_.count(node.name())) return false;
+  if (!Float16Ops().count(node.op()) && !Float16SafeOps().count(node.op())) {
+    return false;
+  }
+  auto type = node.attr().find("T");
+  if (type == node.attr().end() || type->second.type() != DT_FLOAT) {
+    return false;
+  }
+  // The nodes that aren't assigned to a device are placed on a GPU if there
+  // is one.
+  if (node.device().empty()) return true;
+  DeviceNameUtils::ParsedName device;
+  return DeviceNameUtils::ParseFullName(node.device(), &device) &&
+         (!device.has_type || device.type == DEVICE_GPU);
+}
+
+Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* output) {
+  *output = item.graph;
+  if (num_gpus_ == 0) {
+    num_gpus_ = GetNumAvailableGPUs();
+  }
+  if (num_gpus_ < 1) {
+    // float16 is only faster on the GPUs.
+    return Status::OK();
+  }
+  nodes_to_preserve_.clear();
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve_.insert(NodeName(feed.first));
+  }
+
+  const int num_nodes = output->node_size();
+  std::unordered_map<string, int> index;
+  for (int i = 0; i < num_nodes; ++i) {
+    index[output->node(i).name()] = i;
+  }
+  std::vector<std::vector<int>> outputs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    std::set<int> inputs;
+    for (const string& input : output->node(i).input()) {
+      auto input_index = index.find(NodeName(input));
+      if (input_index != index.end()) inputs.insert(input_index->second);
+    }
+    for (int input : inputs) {
+      outputs[input].push_back(i);
+    }
+  }
+
+  // The inputs and outputs of type T of the nodes that can run in float16.
+  std::vector<bool> candidates(num_nodes, false);
+  std::vector<std::vector<int>> input_ports(num_nodes);
+  std::vector<std::vector<int>> output_ports(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = output->node(i);
+    const OpDef* op_def = nullptr;
+    if (!CanRunInFloat16(node) ||
+        !OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+      continue;
+    }
+    candidates[i] = true;
+    input_ports[i] = PortsOfTypeT(node, op_def->input_arg());
+    output_ports[i] = PortsOfTypeT(node, op_def->output_arg());
+  }
+  std::vector<bool> float16(num_nodes, false);
+  // Returns true iff the input of node at port is an output of type T of a
+  // float16 node.
+  auto is_float16_input = [&](int node, int port) {
+    const string& input = output->node(node).input(port);
+    auto input_index = index.find(NodeName(input));
+    return input_index != index.end() && float16[input_index->second] &&
+           Contains(output_ports[input_index->second], NodePosition(input));
+  };
+
+  // Propagate float16 from the float16 ops through the safe ops.
+  std::deque<int> float16_nodes;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (candidates[i] && Float16Ops().count(output->node(i).op())) {
+      float16[i] = true;
+      float16_nodes.push_back(i);
+    }
+  }
+  while (!float16_nodes.empty()) {
+    const int node = float16_nodes.front();
+    float16_nodes.pop_front();
+    for (int consumer : outputs[node]) {
+      if (float16[consumer] || !candidates[consumer]) continue;
+      for (int port : input_ports[consumer]) {
+        if (port < output->node(consumer).input_size() &&
+            is_float16_input(consumer, port)) {
+          float16[consumer] = true;
+          float16_nodes.push_back(consumer);
+          break;
+        }
+      }
+    }
+  }
+
+  // Cast the tensors between the float32 and the float16 nodes, with one cast
+  // per tensor, type and device.
+  std::unordered_set<string> new_names;
+  std::unordered_map<string, string> casts;
+  int num_casts = 0;
+  auto cast = [&](const string& input, DataType type, const string& device) {
+    int port;
+    const string name = ParseNodeName(input, &port);
+    const string tensor = port == 0 ? name : strings::StrCat(name, ":", port);
+    const string key = strings::StrCat(tensor, "|", type, "|", device);
+    auto existing_cast = casts.find(key);
+    if (existing_cast != casts.end()) return existing_cast->second;
+
+    const string prefix = type == DT_HALF ? "AutoMixedPrecision/CastToFp16"
+                                          : "AutoMixedPrecision/CastToFp32";
+    const string cast_name = AddPrefixToNodeName(
+        port == 0 ? name : strings::StrCat(name, "_", port), prefix, "_");
+    string unique_name = cast_name;
+    for (int i = 1; index.count(unique_name) || new_names.count(unique_name);
+         ++i) {
+      unique_name = strings::StrCat(cast_name, "_", i);
+    }
+    new_names.insert(unique_name);
+
+    NodeDef* cast_node = output->add_node();
+    cast_node->set_name(unique_name);
+    cast_node->set_op("Cast");
+    cast_node->set_device(device);
+    cast_node->add_input(tensor);
+    (*cast_node->mutable_attr())["SrcT"].set_type(
+        type == DT_HALF ? DT_FLOAT : DT_HALF);
+    (*cast_node->mutable_attr())["DstT"].set_type(type);
+    casts[key] = unique_name;
+    ++num_casts;
+    return unique_name;
+  };
+
+  int num_float16_nodes = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = output->mutable_node(i);
+    if (float16[i]) {
+      ++num_float16_nodes;
+      (*node->mutable_attr())["T"].set_type(DT_HALF);
+      for (int port : input_ports[i]) {
+        if (port >= node->input_size() || IsControlInput(node->input(port)) ||
+            is_float16_input(i, port)) {
+          continue;
+        }
+        *node->mutable_input(port) =
+            cast(node->input(port), DT_HALF, node->device());
+      }
+    } else {
+      for (int port = 0; port < node->input_size(); ++port) {
+        const string& input = node->input(port);
+        if (IsControlInput(input) || !is_float16_input(i, port)) continue;
+        const NodeDef& producer = output->node(index[NodeName(input)]);
+        *node->mutable_input(port) = cast(input, DT_FLOAT, producer.device());
+      }
+    }
+  }
+
+  VLOG(1) << "Converted " << num_float16_nodes << " nodes to float16, with "
+          << num_casts << " casts.";
+  return Status::OK();
+}
+
+void AutoMixedPrecision::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimize_output,
+                                  double result) {
+  // Nothing to do for AutoMixedPrecision.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+
+#include <unordered_set>
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Run the float32 computations of the GPUs in float16 where that is safe:
+// - The matrix multiplications and convolutions, which are much faster in
+//   float16, always run in float16.
+// - The ops that are numerically safe in float16, e.g. the activations, the
+//   pooling and the elementwise additions, run in float16 when one of their
+//   inputs is computed in float16.
+// - The other ops, e.g. the reductions, the softmax and the losses, and the
+//   variables and their updates, stay in float32.
+// Casts are inserted at the boundaries, so that the variables keep their
+// float32 values and the gradients are cast back to float32 before being
+// applied.
+class AutoMixedPrecision : public GraphOptimizer {
+ public:
+  AutoMixedPrecision() {}
+  ~AutoMixedPrecision() override {}
+
+  string name() const override { return "auto_mixed_precision"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+  // Only the graphs of the machines with GPUs are rewritten. The number of
+  // GPUs is detected by default.
+  void set_num_gpus(int num_gpus) { num_gpus_ = num_gpus; };
+
+ private:
+  // Returns true iff node can run in float16.
+  bool CanRunInFloat16(const NodeDef& node) const;
+
+  int num_gpus_ = 0;
+  std::unordered_set<string> nodes_to_preserve_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
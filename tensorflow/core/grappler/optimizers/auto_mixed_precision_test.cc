@@ -0,0 +1,210 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class AutoMixedPrecisionTest : public ::testing::Test {
+ protected:
+  NodeDef* AddNode(const string& name, const string& op,
+                   const std::vector<string>& inputs, const string& device,
+                   GraphDef* graph) {
+    NodeDef* node = graph->add_node();
+    node->set_name(name);
+    node->set_op(op);
+    node->set_device(device);
+    for (const string& input : inputs) {
+      node->add_input(input);
+    }
+    (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+    return node;
+  }
+
+  NodeDef* AddPlaceholder(const string& name, GraphDef* graph) {
+    NodeDef* node = AddNode(name, "Placeholder", {}, "", graph);
+    node->mutable_attr()->erase("T");
+    (*node->mutable_attr())["dtype"].set_type(DT_FLOAT);
+    return node;
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  std::vector<string> Inputs(const NodeDef& node) {
+    return std::vector<string>(node.input().begin(), node.input().end());
+  }
+
+  DataType Type(const GraphDef& graph, const string& name) {
+    const NodeDef* node = FindNode(graph, name);
+    return node == nullptr ? DT_INVALID : node->attr().at("T").type();
+  }
+
+  // Checks that the node is a cast of input to type.
+  void ExpectCast(const GraphDef& graph, const string& name,
+                  const string& input, DataType type, const string& device) {
+    const NodeDef* cast = FindNode(graph, name);
+    ASSERT_NE(nullptr, cast);
+    EXPECT_EQ("Cast", cast->op());
+    EXPECT_EQ(std::vector<string>({input}), Inputs(*cast));
+    EXPECT_EQ(type == DT_HALF ? DT_FLOAT : DT_HALF,
+              cast->attr().at("SrcT").type());
+    EXPECT_EQ(type, cast->attr().at("DstT").type());
+    EXPECT_EQ(device, cast->device());
+  }
+};
+
+TEST_F(AutoMixedPrecisionTest, ConvertsConvolutionBlock) {
+  const string gpu = "/job:localhost/replica:0/task:0/gpu:0";
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddPlaceholder("x", graph);
+  AddPlaceholder("filter", graph);
+  AddPlaceholder("bias", graph);
+  NodeDef* conv = AddNode("conv", "Conv2D", {"x", "filter"}, gpu, graph);
+  (*conv->mutable_attr())["padding"].set_s("SAME");
+  AddNode("bias_add", "BiasAdd", {"conv", "bias"}, gpu, graph);
+  AddNode("relu", "Relu", {"bias_add"}, gpu, graph);
+  AddNode("softmax", "Softmax", {"relu"}, gpu, graph);
+  AddNode("output", "Identity", {"softmax"}, gpu, graph);
+  item.fetch.push_back("output");
+
+  AutoMixedPrecision optimizer;
+  optimizer.set_num_gpus(1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(DT_HALF, Type(output, "conv"));
+  EXPECT_EQ(DT_HALF, Type(output, "bias_add"));
+  EXPECT_EQ(DT_HALF, Type(output, "relu"));
+  EXPECT_EQ(DT_FLOAT, Type(output, "softmax"));
+  EXPECT_EQ(DT_FLOAT, Type(output, "output"));
+
+  ExpectCast(output, "AutoMixedPrecision/CastToFp16_x", "x", DT_HALF, gpu);
+  ExpectCast(output, "AutoMixedPrecision/CastToFp16_filter", "filter",
+             DT_HALF, gpu);
+  ExpectCast(output, "AutoMixedPrecision/CastToFp16_bias", "bias", DT_HALF,
+             gpu);
+  ExpectCast(output, "AutoMixedPrecision/CastToFp32_relu", "relu", DT_FLOAT,
+             gpu);
+  EXPECT_EQ(std::vector<string>({"AutoMixedPrecision/CastToFp16_x",
+                                 "AutoMixedPrecision/CastToFp16_filter"}),
+            Inputs(*FindNode(output, "conv")));
+  EXPECT_EQ(std::vector<string>({"conv", "AutoMixedPrecision/CastToFp16_bias"}),
+            Inputs(*FindNode(output, "bias_add")));
+  EXPECT_EQ(std::vector<string>({"AutoMixedPrecision/CastToFp32_relu"}),
+            Inputs(*FindNode(output, "softmax")));
+  EXPECT_EQ(item.graph.node_size() + 4, output.node_size());
+}
+
+TEST_F(AutoMixedPrecisionTest, SharesCasts) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddPlaceholder("x", graph);
+  AddPlaceholder("w1", graph);
+  AddPlaceholder("w2", graph);
+  AddNode("matmul1", "MatMul", {"x", "w1"}, "", graph);
+  AddNode("matmul2", "MatMul", {"x", "w2"}, "", graph);
+  AddNode("add", "Add", {"matmul1", "matmul2"}, "", graph);
+  AddNode("sum1", "Sum", {"add"}, "", graph);
+  AddNode("sum2", "Sum", {"add"}, "", graph);
+
+  AutoMixedPrecision optimizer;
+  optimizer.set_num_gpus(1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(DT_HALF, Type(output, "matmul1"));
+  EXPECT_EQ(DT_HALF, Type(output, "matmul2"));
+  EXPECT_EQ(DT_HALF, Type(output, "add"));
+  EXPECT_EQ(DT_FLOAT, Type(output, "sum1"));
+  EXPECT_EQ(DT_FLOAT, Type(output, "sum2"));
+  // x, w1, w2 and add are each cast once.
+  EXPECT_EQ(item.graph.node_size() + 4, output.node_size());
+  EXPECT_EQ("AutoMixedPrecision/CastToFp16_x",
+            FindNode(output, "matmul1")->input(0));
+  EXPECT_EQ("AutoMixedPrecision/CastToFp16_x",
+            FindNode(output, "matmul2")->input(0));
+  EXPECT_EQ("AutoMixedPrecision/CastToFp32_add",
+            FindNode(output, "sum1")->input(0));
+  EXPECT_EQ("AutoMixedPrecision/CastToFp32_add",
+            FindNode(output, "sum2")->input(0));
+}
+
+TEST_F(AutoMixedPrecisionTest, KeepsCpuAndFetchedNodes) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddPlaceholder("x", graph);
+  AddPlaceholder("w", graph);
+  AddNode("cpu_matmul", "MatMul", {"x", "w"}, "/cpu:0", graph);
+  AddNode("fetched_matmul", "MatMul", {"x", "w"}, "/gpu:0", graph);
+  AddNode("relu", "Relu", {"x"}, "/gpu:0", graph);
+  item.fetch = {"cpu_matmul", "fetched_matmul", "relu"};
+
+  AutoMixedPrecision optimizer;
+  optimizer.set_num_gpus(1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The relu only runs in float16 after a float16 node.
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    EXPECT_EQ(item.graph.node(i).DebugString(), output.node(i).DebugString());
+  }
+}
+
+TEST_F(AutoMixedPrecisionTest, CastsOnlyTensorsOfTypeT) {
+  const string gpu = "/gpu:0";
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddPlaceholder("x", graph);
+  AddPlaceholder("w", graph);
+  (*AddPlaceholder("shape", graph)->mutable_attr())["dtype"].set_type(
+      DT_INT32);
+  AddNode("matmul", "MatMul", {"x", "w"}, gpu, graph);
+  NodeDef* reshape =
+      AddNode("reshape", "Reshape", {"matmul", "shape", "^w"}, gpu, graph);
+  (*reshape->mutable_attr())["Tshape"].set_type(DT_INT32);
+  AddNode("output", "Sigmoid", {"reshape"}, gpu, graph);
+  AddNode("loss", "Sum", {"output"}, gpu, graph);
+
+  AutoMixedPrecision optimizer;
+  optimizer.set_num_gpus(1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(DT_HALF, Type(output, "reshape"));
+  EXPECT_EQ(DT_HALF, Type(output, "output"));
+  EXPECT_EQ(DT_INT32, FindNode(output, "reshape")->attr().at("Tshape").type());
+  EXPECT_EQ(std::vector<string>({"matmul", "shape", "^w"}),
+            Inputs(*FindNode(output, "reshape")));
+  EXPECT_EQ(std::vector<string>({"AutoMixedPrecision/CastToFp32_output"}),
+            Inputs(*FindNode(output, "loss")));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
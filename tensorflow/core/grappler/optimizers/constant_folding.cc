@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/bcast.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -105,6 +106,106 @@ string AsControlDependency(const NodeDef& node) {
   return strings::StrCat("^", node.name());
 }
 
+// Reads the value of a constant integer vector.
+bool GetConstantVector(const NodeDef& node, std::vector<int64>* values) {
+  if (!IsConstant(node)) {
+    return false;
+  }
+  auto value = node.attr().find("value");
+  if (value == node.attr().end()) {
+    return false;
+  }
+  Tensor tensor;
+  if (!tensor.FromProto(value->second.tensor()) || tensor.dims() != 1) {
+    return false;
+  }
+  values->clear();
+  for (int i = 0; i < tensor.NumElements(); ++i) {
+    if (tensor.dtype() == DT_INT32) {
+      values->push_back(tensor.flat<int32>()(i));
+    } else if (tensor.dtype() == DT_INT64) {
+      values->push_back(tensor.flat<int64>()(i));
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Computes the reduction indices returned by BroadcastGradientArgs for the
+// shapes x and y, some dimensions of which may be unknown: an unknown
+// dimension is either 1 or equal to the dimension it's broadcast with. Sets
+// known[i] to false when the reduction indices reduce_idx[i] depend on the
+// values of the unknown dimensions. Returns false if the shapes can't be
+// broadcast.
+bool BroadcastGradientArgsOfPartialShapes(const PartialTensorShape& x,
+                                          const PartialTensorShape& y,
+                                          std::vector<int64> reduce_idx[2],
+                                          bool known[2]) {
+  if (x.IsFullyDefined() && y.IsFullyDefined()) {
+    BCast::Vec x_dims(x.dims());
+    for (int i = 0; i < x.dims(); ++i) {
+      x_dims[i] = x.dim_size(i);
+    }
+    BCast::Vec y_dims(y.dims());
+    for (int i = 0; i < y.dims(); ++i) {
+      y_dims[i] = y.dim_size(i);
+    }
+    BCast bcast(x_dims, y_dims);
+    if (!bcast.IsValid()) {
+      return false;
+    }
+    reduce_idx[0].assign(bcast.grad_x_reduce_idx().begin(),
+                         bcast.grad_x_reduce_idx().end());
+    reduce_idx[1].assign(bcast.grad_y_reduce_idx().begin(),
+                         bcast.grad_y_reduce_idx().end());
+    known[0] = known[1] = true;
+    return true;
+  }
+
+  known[0] = known[1] = true;
+  // Identical shapes are never reduced, even along their dimensions of size 1.
+  bool may_be_identical = x.dims() == y.dims();
+  const int rank = std::max(x.dims(), y.dims());
+  for (int i = 0; i < rank; ++i) {
+    // Align the shapes on their inner-most dimension, and pad them with 1s.
+    const int x_padding = rank - x.dims();
+    const int y_padding = rank - y.dims();
+    const int64 dims[2] = {i < x_padding ? 1 : x.dim_size(i - x_padding),
+                           i < y_padding ? 1 : y.dim_size(i - y_padding)};
+    if (dims[0] >= 0 && dims[1] >= 0) {
+      if (dims[0] == dims[1]) {
+        if (dims[0] == 1) {
+          reduce_idx[0].push_back(i);
+          reduce_idx[1].push_back(i);
+        }
+      } else if (dims[0] == 1) {
+        may_be_identical = false;
+        reduce_idx[0].push_back(i);
+      } else if (dims[1] == 1) {
+        may_be_identical = false;
+        reduce_idx[1].push_back(i);
+      } else {
+        return false;
+      }
+    } else if (dims[0] >= 0 || dims[1] >= 0) {
+      // Whether the unknown dimension is 1 or not, the known one is reduced
+      // iff it's 1.
+      const int known_side = dims[0] >= 0 ? 0 : 1;
+      known[1 - known_side] = false;
+      if (dims[known_side] == 1) {
+        reduce_idx[known_side].push_back(i);
+      }
+    } else {
+      known[0] = known[1] = false;
+    }
+  }
+  if (may_be_identical) {
+    known[0] = known[1] = false;
+  }
+  return true;
+}
+
 }  // namespace
 
 ConstantFolding::ConstantFolding() {
@@ -241,9 +342,249 @@ Status ConstantFolding::MaterializeShapes(const GrapplerItem& item) {
       }
     }
   }
+
+  // Materialize the values derived from the shapes that are only partially
+  // known, e.g. because of an unknown batch size.
+  for (int i = 0; i < node_count; ++i) {
+    NodeDef* node = graph_.mutable_node(i);
+    if (node->op() == "StridedSlice") {
+      MaterializeShapeSlice(properties, node);
+    } else if (node->op() == "BroadcastGradientArgs") {
+      MaterializeBroadcastGradientArgs(properties, *node);
+    }
+  }
   return Status::OK();
 }
 
+bool ConstantFolding::GetShapeValue(const GraphProperties& properties,
+                                    const string& input,
+                                    PartialTensorShape* shape) const {
+  const NodeDef* node = node_map_->GetNode(input);
+  if (node == nullptr || IsControlInput(input) || NodePosition(input) != 0) {
+    return false;
+  }
+  if (node->op() == "Shape") {
+    std::vector<OpInfo::TensorProperties> shape_input =
+        properties.GetInputProperties(node->name());
+    if (shape_input.size() != 1 || shape_input[0].shape().unknown_rank()) {
+      return false;
+    }
+    *shape = PartialTensorShape(shape_input[0].shape());
+    return true;
+  }
+  std::vector<int64> dims;
+  if (!GetConstantVector(*node, &dims)) {
+    return false;
+  }
+  for (int64 dim : dims) {
+    if (dim < 0) {
+      return false;
+    }
+  }
+  *shape = PartialTensorShape(dims);
+  return true;
+}
+
+string ConstantFolding::ShapeControlDependency(const string& input) {
+  const NodeDef* node = node_map_->GetNode(input);
+  if (node->op() == "Shape") {
+    // Depend on the tensor whose shape was computed rather than on the shape
+    // node, which can then be pruned.
+    return AddControlDependency(node->input(0));
+  }
+  return AsControlDependency(*node);
+}
+
+void ConstantFolding::MaterializeShapeSlice(const GraphProperties& properties,
+                                            NodeDef* node) {
+  // Only handle the slices of a single element of the shape of a tensor of
+  // known rank, e.g. tf.shape(x)[1] or tf.shape(x)[1:].
+  if (node->input_size() < 4 || nodes_to_preserve_.count(node->name())) {
+    return;
+  }
+  const NodeDef* shape_node = node_map_->GetNode(node->input(0));
+  if (shape_node == nullptr || shape_node->op() != "Shape" ||
+      NodePosition(node->input(0)) != 0) {
+    return;
+  }
+  const auto& attr = node->attr();
+  if ((attr.count("ellipsis_mask") && attr.at("ellipsis_mask").i() != 0) ||
+      (attr.count("new_axis_mask") && attr.at("new_axis_mask").i() != 0)) {
+    return;
+  }
+  std::vector<int64> begin;
+  std::vector<int64> end;
+  std::vector<int64> strides;
+  for (int j = 1; j < 4; ++j) {
+    const NodeDef* input = node_map_->GetNode(node->input(j));
+    std::vector<int64>* values = j == 1 ? &begin : j == 2 ? &end : &strides;
+    if (input == nullptr || !GetConstantVector(*input, values) ||
+        values->size() != 1) {
+      return;
+    }
+  }
+  if (strides[0] == 0) {
+    return;
+  }
+  PartialTensorShape shape;
+  if (!GetShapeValue(properties, node->input(0), &shape)) {
+    return;
+  }
+
+  const int64 rank = shape.dims();
+  const bool shrink_axis = attr.count("shrink_axis_mask") &&
+                           (attr.at("shrink_axis_mask").i() & 1);
+  const bool begin_mask =
+      attr.count("begin_mask") && (attr.at("begin_mask").i() & 1);
+  const bool end_mask = attr.count("end_mask") && (attr.at("end_mask").i() & 1);
+  std::vector<int64> dims;
+  if (shrink_axis) {
+    const int64 index = begin[0] < 0 ? begin[0] + rank : begin[0];
+    if (index < 0 || index >= rank) {
+      return;
+    }
+    dims.push_back(shape.dim_size(index));
+  } else {
+    // Follow the python slicing semantics.
+    auto canonical = [rank](int64 index, int64 low, int64 high) {
+      index = index < 0 ? index + rank : index;
+      return std::min(std::max(index, low), high);
+    };
+    if (strides[0] > 0) {
+      const int64 start = begin_mask ? 0 : canonical(begin[0], 0, rank);
+      const int64 stop = end_mask ? rank : canonical(end[0], 0, rank);
+      for (int64 j = start; j < stop; j += strides[0]) {
+        dims.push_back(shape.dim_size(j));
+      }
+    } else {
+      const int64 start =
+          begin_mask ? rank - 1 : canonical(begin[0], -1, rank - 1);
+      const int64 stop = end_mask ? -1 : canonical(end[0], -1, rank - 1);
+      for (int64 j = start; j > stop; j += strides[0]) {
+        dims.push_back(shape.dim_size(j));
+      }
+    }
+  }
+
+  const DataType type = attr.at("T").type();
+  if (type != DT_INT32 && type != DT_INT64) {
+    return;
+  }
+  Tensor value(type, shrink_axis ? TensorShape({})
+                                 : TensorShape({static_cast<int64>(
+                                       dims.size())}));
+  for (int j = 0; j < dims.size(); ++j) {
+    if (dims[j] < 0 || (type == DT_INT32 && dims[j] >= INT_MAX)) {
+      return;
+    }
+    if (type == DT_INT32) {
+      value.flat<int32>()(j) = dims[j];
+    } else {
+      value.flat<int64>()(j) = dims[j];
+    }
+  }
+
+  // Replace the slice with the corresponding constant, which is only
+  // generated when the tensor whose shape is sliced is.
+  std::vector<string> control_inputs = {ShapeControlDependency(node->input(0))};
+  for (const string& input : node->input()) {
+    if (IsControlInput(input)) {
+      control_inputs.push_back(input);
+    }
+  }
+  node->set_op("Const");
+  node->clear_attr();
+  (*node->mutable_attr())["dtype"].set_type(type);
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  node->clear_input();
+  for (const string& input : control_inputs) {
+    *node->add_input() = input;
+  }
+}
+
+void ConstantFolding::MaterializeBroadcastGradientArgs(
+    const GraphProperties& properties, const NodeDef& node) {
+  if (node.input_size() < 2 || nodes_to_preserve_.count(node.name())) {
+    return;
+  }
+  std::vector<int64> reduce_idx[2];
+  bool known[2];
+  const NodeDef* x = node_map_->GetNode(node.input(0));
+  const NodeDef* y = node_map_->GetNode(node.input(1));
+  if (x != nullptr && y != nullptr && x->op() == "Shape" &&
+      y->op() == "Shape" && NodePosition(node.input(0)) == 0 &&
+      NodePosition(node.input(1)) == 0 &&
+      (x == y || IsSameInput(x->input(0), y->input(0)))) {
+    // The shapes of the same tensor are identical even if they're unknown.
+    known[0] = known[1] = true;
+  } else {
+    PartialTensorShape x_shape;
+    PartialTensorShape y_shape;
+    if (!GetShapeValue(properties, node.input(0), &x_shape) ||
+        !GetShapeValue(properties, node.input(1), &y_shape) ||
+        !BroadcastGradientArgsOfPartialShapes(x_shape, y_shape, reduce_idx,
+                                              known)) {
+      return;
+    }
+  }
+  if (!known[0] && !known[1]) {
+    return;
+  }
+
+  const DataType type = node.attr().at("T").type();
+  // The constants are generated iff the shapes would have been.
+  std::vector<string> control_inputs;
+  for (int j = 0; j < node.input_size(); ++j) {
+    const string control_input = j < 2 ? ShapeControlDependency(node.input(j))
+                                       : node.input(j);
+    if (std::find(control_inputs.begin(), control_inputs.end(),
+                  control_input) == control_inputs.end()) {
+      control_inputs.push_back(control_input);
+    }
+  }
+  string const_names[2];
+  for (int j = 0; j < 2; ++j) {
+    const_names[j] = AddPrefixToNodeName(
+        strings::StrCat(node.name(), "-bcastargs-", j), kConstantFoldingConst);
+    if (node_map_->GetNode(const_names[j]) != nullptr) {
+      return;
+    }
+  }
+  for (int j = 0; j < 2; ++j) {
+    if (!known[j]) {
+      continue;
+    }
+    Tensor value(type, TensorShape({static_cast<int64>(reduce_idx[j].size())}));
+    for (int k = 0; k < reduce_idx[j].size(); ++k) {
+      if (type == DT_INT32) {
+        value.flat<int32>()(k) = reduce_idx[j][k];
+      } else {
+        value.flat<int64>()(k) = reduce_idx[j][k];
+      }
+    }
+    NodeDef* const_node = graph_.add_node();
+    *const_node = CreateNodeDef(const_names[j], TensorValue(&value));
+    const_node->set_device(node.device());
+    for (const string& input : control_inputs) {
+      *const_node->add_input() = input;
+    }
+    node_map_->AddNode(const_names[j], const_node);
+  }
+
+  // Read the reduction indices from the constants.
+  for (NodeDef* output : node_map_->GetOutputs(node.name())) {
+    for (int j = 0; j < output->input_size(); ++j) {
+      int position;
+      const string input = ParseNodeName(output->input(j), &position);
+      if (input == node.name() && (position == 0 || position == 1) &&
+          known[position]) {
+        *output->mutable_input(j) = const_names[position];
+        node_map_->AddOutput(const_names[position], output->name());
+      }
+    }
+  }
+}
+
 bool ConstantFolding::IsFoldable(const NodeDef& node) const {
   // Skips nodes that must be preserved, and op_types that don't benefit from
   // folding
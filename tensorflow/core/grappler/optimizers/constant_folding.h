@@ -19,6 +19,8 @@ limitations under the License.
 #include <regex>
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
 
@@ -46,6 +48,20 @@ class ConstantFolding : public GraphOptimizer {
  private:
   string AddControlDependency(const string& input_name);
   Status MaterializeShapes(const GrapplerItem& item);
+  // Sets shape to the value of input, computed by a Shape node or a constant.
+  // Returns false if it isn't known statically.
+  bool GetShapeValue(const GraphProperties& properties, const string& input,
+                     PartialTensorShape* shape) const;
+  // Returns a control dependency that triggers when the shape input would
+  // have been generated.
+  string ShapeControlDependency(const string& input);
+  // Replaces the slices of partially known shapes that only read known
+  // dimensions with constants.
+  void MaterializeShapeSlice(const GraphProperties& properties, NodeDef* node);
+  // Feeds the outputs of a BroadcastGradientArgs node that are known from the
+  // partially known shapes of its inputs with constants.
+  void MaterializeBroadcastGradientArgs(const GraphProperties& properties,
+                                        const NodeDef& node);
 
   bool IsFoldable(const NodeDef& node) const;
 
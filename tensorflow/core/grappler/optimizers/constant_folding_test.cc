@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/cc/ops/array_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -245,6 +246,148 @@ TEST_F(ConstantFoldingTest, ShapeMaterialization) {
   EXPECT_EQ(3, found);
 }
 
+TEST_F(ConstantFoldingTest, PartialShapeMaterialization) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output x =
+      ops::Placeholder(scope.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape(PartialTensorShape({-1, 5, 7})));
+  Output shape = ops::Shape(scope.WithOpName("shape"), x);
+  Output dim = ops::StridedSlice(scope.WithOpName("dim"), shape, {1}, {2}, {1},
+                                 ops::StridedSlice::ShrinkAxisMask(1));
+  Output dims = ops::StridedSlice(scope.WithOpName("dims"), shape, {1}, {0},
+                                  {1}, ops::StridedSlice::EndMask(1));
+  Output batch = ops::StridedSlice(scope.WithOpName("batch"), shape, {0}, {1},
+                                   {1}, ops::StridedSlice::ShrinkAxisMask(1));
+  Output p1 = ops::Multiply(scope.WithOpName("p1"), dim, dims);
+  Output p2 = ops::Multiply(scope.WithOpName("p2"), p1, batch);
+
+  GrapplerItem item;
+  item.fetch.push_back("p2");
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding fold;
+  GraphDef output;
+  Status status = fold.Optimize(nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  int found = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "dim") {
+      ++found;
+      EXPECT_EQ("Const", node.op());
+      EXPECT_EQ(1, node.input_size());
+      EXPECT_EQ("^x", node.input(0));
+      Tensor value;
+      CHECK(value.FromProto(node.attr().at("value").tensor()));
+      EXPECT_EQ(0, value.dims());
+      EXPECT_EQ(5, value.flat<int>()(0));
+    } else if (node.name() == "dims") {
+      ++found;
+      EXPECT_EQ("Const", node.op());
+      EXPECT_EQ(1, node.input_size());
+      EXPECT_EQ("^x", node.input(0));
+      Tensor value;
+      CHECK(value.FromProto(node.attr().at("value").tensor()));
+      EXPECT_EQ(2, value.NumElements());
+      EXPECT_EQ(5, value.flat<int>()(0));
+      EXPECT_EQ(7, value.flat<int>()(1));
+    } else if (node.name() == "batch") {
+      // The batch size is unknown.
+      ++found;
+      EXPECT_EQ("StridedSlice", node.op());
+      EXPECT_EQ("shape", node.input(0));
+    }
+  }
+  EXPECT_EQ(3, found);
+}
+
+TEST_F(ConstantFoldingTest, BroadcastGradientArgsMaterialization) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output x =
+      ops::Placeholder(scope.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape(PartialTensorShape({-1, 10})));
+  Output b =
+      ops::Placeholder(scope.WithOpName("b"), DT_FLOAT,
+                       ops::Placeholder::Shape(PartialTensorShape({10})));
+  Output x_shape = ops::Shape(scope.WithOpName("x_shape"), x);
+  Output b_shape = ops::Shape(scope.WithOpName("b_shape"), b);
+  auto bcast = ops::internal::BroadcastGradientArgs(scope.WithOpName("bcast"),
+                                                    x_shape, b_shape);
+  Output r0 = ops::Identity(scope.WithOpName("r0"), bcast.r0);
+  Output r1 = ops::Identity(scope.WithOpName("r1"), bcast.r1);
+
+  GrapplerItem item;
+  item.fetch = {"r0", "r1"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding fold;
+  GraphDef output;
+  Status status = fold.Optimize(nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  const string r1_value =
+      AddPrefixToNodeName("bcast-bcastargs-1", kConstantFoldingConst);
+  int found = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "r0") {
+      // Whether x is reduced depends on its unknown batch size.
+      ++found;
+      EXPECT_EQ("bcast", node.input(0));
+    } else if (node.name() == "r1") {
+      ++found;
+      EXPECT_EQ(r1_value, node.input(0));
+    } else if (node.name() == r1_value) {
+      ++found;
+      EXPECT_EQ("Const", node.op());
+      EXPECT_EQ(2, node.input_size());
+      EXPECT_EQ("^x", node.input(0));
+      EXPECT_EQ("^b_shape", node.input(1));
+      Tensor value;
+      CHECK(value.FromProto(node.attr().at("value").tensor()));
+      EXPECT_EQ(1, value.NumElements());
+      EXPECT_EQ(0, value.flat<int>()(0));
+    }
+  }
+  EXPECT_EQ(3, found);
+}
+
+TEST_F(ConstantFoldingTest, BroadcastGradientArgsOfIdenticalShapes) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(scope.WithOpName("x"), DT_FLOAT);
+  Output shape1 = ops::Shape(scope.WithOpName("shape1"), x);
+  Output shape2 = ops::Shape(scope.WithOpName("shape2"), x);
+  auto bcast = ops::internal::BroadcastGradientArgs(scope.WithOpName("bcast"),
+                                                    shape1, shape2);
+  Output r0 = ops::Identity(scope.WithOpName("r0"), bcast.r0);
+  Output r1 = ops::Identity(scope.WithOpName("r1"), bcast.r1);
+
+  GrapplerItem item;
+  item.fetch = {"r0", "r1"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding fold;
+  GraphDef output;
+  Status status = fold.Optimize(nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  int found = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "r0" || node.name() == "r1") {
+      ++found;
+      const NodeDef* input = nullptr;
+      for (const auto& other : output.node()) {
+        if (other.name() == node.input(0)) input = &other;
+      }
+      ASSERT_NE(nullptr, input);
+      EXPECT_EQ("Const", input->op());
+      Tensor value;
+      CHECK(value.FromProto(input->attr().at("value").tensor()));
+      EXPECT_EQ(0, value.NumElements());
+    }
+  }
+  EXPECT_EQ(2, found);
+}
+
 TEST_F(ConstantFoldingTest, SwitchNodes) {
   tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
   ops::Variable v_in(scope.WithOpName("v_in"), {3}, DT_FLOAT);
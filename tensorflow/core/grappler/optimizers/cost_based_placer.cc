@@ -0,0 +1,306 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/cost_based_placer.h"
+
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/analytical_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// The number of times the nodes moved together to the other device are
+// extended with their neighbors before giving up on the move.
+const int kMaxMoveExtensions = 4;
+
+int Find(std::vector<int>* parents, int i) {
+  while ((*parents)[i] != i) {
+    (*parents)[i] = (*parents)[(*parents)[i]];
+    i = (*parents)[i];
+  }
+  return i;
+}
+
+// Returns true iff node outputs a reference or a resource, which must be used
+// on the device of node.
+bool OutputsReference(const NodeDef& node) {
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  for (const auto& arg : op_def->output_arg()) {
+    if (arg.is_ref() || arg.type() == DT_RESOURCE) return true;
+  }
+  return false;
+}
+
+// Returns 1 if device is a CPU, 0 if it is a GPU or is empty, since the TF
+// placer puts the nodes on the GPU by default, and -1 otherwise.
+int IsCpu(const string& device) {
+  if (device.empty()) return 0;
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed) &&
+      !DeviceNameUtils::ParseLocalName(device, &parsed)) {
+    return -1;
+  }
+  if (!parsed.has_type) return -1;
+  if (parsed.type == DEVICE_CPU) return 1;
+  return parsed.type == DEVICE_GPU ? 0 : -1;
+}
+
+Status PredictStepTime(Cluster* cluster, const GrapplerItem& item,
+                       const GraphDef& graph, Costs::Duration* step_time) {
+  AnalyticalCostEstimator estimator(cluster, true /* use_static_shapes */);
+  TF_RETURN_IF_ERROR(estimator.Initialize(item));
+  Costs costs;
+  TF_RETURN_IF_ERROR(estimator.PredictCosts(graph, nullptr, &costs));
+  *step_time = costs.execution_time;
+  return Status::OK();
+}
+
+}  // namespace
+
+Status CostBasedPlacer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output) {
+  *output = item.graph;
+  if (cluster == nullptr || item.fetch.empty()) {
+    return Status::OK();
+  }
+  // The devices of the nodes placed by default.
+  string cpu;
+  string gpu;
+  for (const auto& device : cluster->GetDevices()) {
+    string* name = device.second.type() == "CPU"
+                       ? &cpu
+                       : device.second.type() == "GPU" ? &gpu : nullptr;
+    if (name != nullptr && (name->empty() || device.first < *name)) {
+      *name = device.first;
+    }
+  }
+  if (cpu.empty() || gpu.empty()) {
+    return Status::OK();
+  }
+
+  const GraphDef& graph = item.graph;
+  const int num_nodes = graph.node_size();
+  std::unordered_map<string, int> index;
+  for (int i = 0; i < num_nodes; ++i) {
+    index[graph.node(i).name()] = i;
+  }
+  // The producers of the data inputs of each node.
+  std::vector<std::vector<int>> inputs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : graph.node(i).input()) {
+      auto input_index = index.find(NodeName(input));
+      if (!IsControlInput(input) && input_index != index.end()) {
+        inputs[i].push_back(input_index->second);
+      }
+    }
+  }
+
+  // Group the nodes that must be placed on the same device: the colocated
+  // nodes and the users of references and resources with their producers.
+  std::vector<int> parents(num_nodes);
+  std::iota(parents.begin(), parents.end(), 0);
+  auto merge = [&parents](int a, int b) {
+    parents[Find(&parents, a)] = Find(&parents, b);
+  };
+  std::vector<bool> outputs_reference(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    outputs_reference[i] = OutputsReference(graph.node(i));
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    for (int input : inputs[i]) {
+      if (outputs_reference[input]) merge(i, input);
+    }
+    auto colocation = graph.node(i).attr().find(kColocationAttrName);
+    if (colocation == graph.node(i).attr().end()) continue;
+    for (const string& group : colocation->second.list().s()) {
+      StringPiece name(group);
+      if (!name.Consume(kColocationGroupPrefix)) continue;
+      auto colocated = index.find(name.ToString());
+      if (colocated != index.end()) merge(i, colocated->second);
+    }
+  }
+
+  // The groups with an explicitly placed node, or without CPU and GPU kernels,
+  // are fixed. The groups with only CPU kernels are placed on the CPU.
+  std::vector<bool> fixed(num_nodes, false);
+  std::vector<bool> has_cpu_kernels(num_nodes, true);
+  std::vector<bool> has_gpu_kernels(num_nodes, true);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph.node(i);
+    const int group = Find(&parents, i);
+    if (!node.device().empty()) {
+      fixed[group] = true;
+      continue;
+    }
+    DeviceTypeVector device_types;
+    bool cpu_kernel = false;
+    bool gpu_kernel = false;
+    if (SupportedDeviceTypesForNode(
+            {DeviceType(DEVICE_GPU), DeviceType(DEVICE_CPU)}, node,
+            &device_types)
+            .ok()) {
+      for (const DeviceType& device_type : device_types) {
+        cpu_kernel |= device_type == DeviceType(DEVICE_CPU);
+        gpu_kernel |= device_type == DeviceType(DEVICE_GPU);
+      }
+    }
+    has_cpu_kernels[group] = has_cpu_kernels[group] && cpu_kernel;
+    has_gpu_kernels[group] = has_gpu_kernels[group] && gpu_kernel;
+  }
+  std::vector<bool> movable(num_nodes, false);
+  std::vector<bool> on_cpu(num_nodes, false);
+  for (int group = 0; group < num_nodes; ++group) {
+    if (Find(&parents, group) != group) continue;
+    fixed[group] =
+        fixed[group] || (!has_cpu_kernels[group] && !has_gpu_kernels[group]);
+    movable[group] =
+        !fixed[group] && has_cpu_kernels[group] && has_gpu_kernels[group];
+    on_cpu[group] = !fixed[group] && !has_gpu_kernels[group];
+  }
+
+  auto place = [&](GraphDef* placed) {
+    *placed = graph;
+    for (int i = 0; i < num_nodes; ++i) {
+      const int group = Find(&parents, i);
+      if (!fixed[group]) {
+        placed->mutable_node(i)->set_device(on_cpu[group] ? cpu : gpu);
+      }
+    }
+  };
+  auto step_time = [&](Costs::Duration* time) {
+    GraphDef placed;
+    place(&placed);
+    return PredictStepTime(cluster, item, placed, time);
+  };
+
+  Costs::Duration initial_time;
+  Status status = step_time(&initial_time);
+  if (!status.ok()) {
+    VLOG(1) << "Couldn't simulate the step: " << status;
+    return Status::OK();
+  }
+  Costs::Duration best_time = initial_time;
+  int num_evaluations = 1;
+  int num_moves = 0;
+  bool improved = true;
+  while (improved && num_evaluations < max_evaluations_) {
+    improved = false;
+    // The device of each node: 1 for the CPU, 0 for the GPU, -1 if unknown.
+    std::vector<int> is_cpu(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) {
+      const int group = Find(&parents, i);
+      is_cpu[i] = fixed[group] ? IsCpu(graph.node(i).device()) : on_cpu[group];
+    }
+    // The neighbors of each movable group, and the movable groups at the
+    // boundaries between the devices.
+    std::vector<std::unordered_set<int>> neighbors(num_nodes);
+    std::vector<int> candidates;
+    std::vector<bool> is_candidate(num_nodes, false);
+    for (int i = 0; i < num_nodes; ++i) {
+      for (int input : inputs[i]) {
+        const int groups[2] = {Find(&parents, i), Find(&parents, input)};
+        if (groups[0] == groups[1]) continue;
+        for (int j = 0; j < 2; ++j) {
+          if (!movable[groups[j]]) continue;
+          neighbors[groups[j]].insert(groups[1 - j]);
+          if (is_cpu[i] >= 0 && is_cpu[input] >= 0 &&
+              is_cpu[i] != is_cpu[input] && !is_candidate[groups[j]]) {
+            is_candidate[groups[j]] = true;
+            candidates.push_back(groups[j]);
+          }
+        }
+      }
+    }
+
+    for (int candidate : candidates) {
+      if (num_evaluations >= max_evaluations_) break;
+      // Move the candidate to the other device, along with the neighboring
+      // nodes on its device if that alone doesn't help, e.g. to move a chain
+      // of nodes between two nodes on the other device.
+      const bool was_on_cpu = on_cpu[candidate];
+      std::vector<int> moved = {candidate};
+      std::unordered_set<int> in_moved = {candidate};
+      on_cpu[candidate] = !was_on_cpu;
+      bool accepted = false;
+      for (int extension = 0; extension <= kMaxMoveExtensions &&
+                              num_evaluations < max_evaluations_;
+           ++extension) {
+        Costs::Duration time;
+        ++num_evaluations;
+        if (step_time(&time).ok() && time < best_time) {
+          best_time = time;
+          accepted = true;
+          break;
+        }
+        const int num_moved = moved.size();
+        for (int j = 0; j < num_moved; ++j) {
+          for (int neighbor : neighbors[moved[j]]) {
+            if (movable[neighbor] && on_cpu[neighbor] == was_on_cpu &&
+                in_moved.insert(neighbor).second) {
+              moved.push_back(neighbor);
+              on_cpu[neighbor] = !was_on_cpu;
+            }
+          }
+        }
+        if (static_cast<int>(moved.size()) == num_moved) break;
+      }
+      if (accepted) {
+        improved = true;
+        num_moves += moved.size();
+      } else {
+        for (int group : moved) {
+          on_cpu[group] = was_on_cpu;
+        }
+      }
+    }
+  }
+
+  if (best_time < initial_time) {
+    place(output);
+  }
+  VLOG(1) << "Moved " << num_moves << " groups of nodes, for a simulated step "
+          << "time of " << best_time.count() << " ns instead of "
+          << initial_time.count() << " ns, in " << num_evaluations
+          << " simulations.";
+  return Status::OK();
+}
+
+void CostBasedPlacer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                               const GraphDef& optimize_output, double result) {
+  // Nothing to do for CostBasedPlacer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
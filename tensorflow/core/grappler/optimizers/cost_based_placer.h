@@ -0,0 +1,57 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_COST_BASED_PLACER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_COST_BASED_PLACER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Place the nodes that aren't assigned to a device on the CPU or the GPU of
+// the cluster so as to minimize the step time simulated by the analytical cost
+// model, including the time of the transfers between the devices.
+//
+// The placement starts from the one of the TF placer, which puts the nodes on
+// the GPU whenever they have a GPU kernel, and greedily moves the nodes at the
+// boundaries between the devices, e.g. the small computations between CPU
+// nodes, to the other device as long as this shortens the simulated step. The
+// explicitly placed nodes, the colocation constraints and the nodes using a
+// reference or a resource produced by another node are respected. The graph is
+// left unchanged unless a faster placement is found.
+class CostBasedPlacer : public GraphOptimizer {
+ public:
+  // At most max_evaluations placements are simulated.
+  explicit CostBasedPlacer(int max_evaluations = 100)
+      : max_evaluations_(max_evaluations) {}
+  ~CostBasedPlacer() override {}
+
+  string name() const override { return "cost_based_placer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  int max_evaluations_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_COST_BASED_PLACER_H_
@@ -0,0 +1,151 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/cost_based_placer.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+REGISTER_OP("CostBasedPlacerTestOp")
+    .Input("x: float")
+    .Output("y: float")
+    .SetShapeFn(shape_inference::UnchangedShape);
+
+class DummyOp : public OpKernel {
+ public:
+  explicit DummyOp(OpKernelConstruction* context) : OpKernel(context) {}
+  void Compute(OpKernelContext* context) override {}
+};
+
+REGISTER_KERNEL_BUILDER(Name("CostBasedPlacerTestOp").Device(DEVICE_CPU),
+                        DummyOp);
+REGISTER_KERNEL_BUILDER(Name("CostBasedPlacerTestOp").Device(DEVICE_GPU),
+                        DummyOp);
+
+const char kCpu[] = "/job:localhost/replica:0/task:0/cpu:0";
+const char kGpu[] = "/job:localhost/replica:0/task:0/gpu:0";
+
+class CostBasedPlacerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_num_cores(4);
+    cpu_device.set_frequency(2600);
+    cpu_device.set_bandwidth(24 * 1024 * 1024);
+    devices_[kCpu] = cpu_device;
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_num_cores(12);
+    gpu_device.set_frequency(1100);
+    gpu_device.set_bandwidth(180 * 1024 * 1024);
+    (*gpu_device.mutable_environment())["architecture"] = "6";
+    devices_[kGpu] = gpu_device;
+  }
+
+  NodeDef* AddNode(const string& name, const string& op, const string& input,
+                   const string& device, GraphDef* graph) {
+    NodeDef* node = graph->add_node();
+    node->set_name(name);
+    node->set_op(op);
+    if (!input.empty()) {
+      node->add_input(input);
+    }
+    node->set_device(device);
+    return node;
+  }
+
+  // Builds x -> a -> b, where x and b are placed on the CPU and the output of
+  // x is large enough for its transfers to the GPU to dominate the step.
+  GrapplerItem CreateItem() {
+    GrapplerItem item;
+    NodeDef* x = AddNode("x", "Placeholder", "", kCpu, &item.graph);
+    (*x->mutable_attr())["dtype"].set_type(DT_FLOAT);
+    TensorShapeProto* shape = (*x->mutable_attr())["shape"].mutable_shape();
+    shape->add_dim()->set_size(1024);
+    shape->add_dim()->set_size(1024);
+    AddNode("a", "CostBasedPlacerTestOp", "x", "", &item.graph);
+    AddNode("b", "CostBasedPlacerTestOp", "a", kCpu, &item.graph);
+    item.fetch.push_back("b");
+    return item;
+  }
+
+  void ExpectUnchanged(const GrapplerItem& item, const GraphDef& output) {
+    ASSERT_EQ(item.graph.node_size(), output.node_size());
+    for (int i = 0; i < output.node_size(); ++i) {
+      EXPECT_EQ(item.graph.node(i).DebugString(), output.node(i).DebugString());
+    }
+  }
+
+  std::unordered_map<string, DeviceProperties> devices_;
+};
+
+TEST_F(CostBasedPlacerTest, MovesNodesBetweenCpuNodesToTheCpu) {
+  VirtualCluster cluster(devices_);
+  GrapplerItem item = CreateItem();
+
+  CostBasedPlacer placer;
+  GraphDef output;
+  TF_EXPECT_OK(placer.Optimize(&cluster, item, &output));
+
+  ASSERT_EQ(3, output.node_size());
+  EXPECT_EQ(kCpu, output.node(0).device());
+  EXPECT_EQ("a", output.node(1).name());
+  EXPECT_EQ(kCpu, output.node(1).device());
+  EXPECT_EQ(kCpu, output.node(2).device());
+}
+
+TEST_F(CostBasedPlacerTest, RespectsColocationConstraints) {
+  VirtualCluster cluster(devices_);
+  GrapplerItem item = CreateItem();
+  AddNode("c", "CostBasedPlacerTestOp", "x", kGpu, &item.graph);
+  (*item.graph.mutable_node(1)->mutable_attr())["_class"]
+      .mutable_list()
+      ->add_s("loc:@c");
+
+  CostBasedPlacer placer;
+  GraphDef output;
+  TF_EXPECT_OK(placer.Optimize(&cluster, item, &output));
+
+  ExpectUnchanged(item, output);
+}
+
+TEST_F(CostBasedPlacerTest, NeedsCpuAndGpu) {
+  GrapplerItem item = CreateItem();
+  CostBasedPlacer placer;
+  GraphDef output;
+  TF_EXPECT_OK(placer.Optimize(nullptr, item, &output));
+  ExpectUnchanged(item, output);
+
+  devices_.erase(kGpu);
+  VirtualCluster cluster(devices_);
+  TF_EXPECT_OK(placer.Optimize(&cluster, item, &output));
+  ExpectUnchanged(item, output);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,343 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+bool IsControlFlow(const NodeDef& node) {
+  static const auto* control_flow_ops = new std::unordered_set<string>{
+      "ControlTrigger", "Enter", "Exit", "LoopCond", "Merge", "NextIteration",
+      "RefEnter", "RefExit", "RefMerge", "RefNextIteration", "RefSwitch",
+      "Switch"};
+  return control_flow_ops->count(node.op()) > 0;
+}
+
+int NumEdges(const GraphDef& graph) {
+  int num_edges = 0;
+  for (const NodeDef& node : graph.node()) {
+    num_edges += node.input_size();
+  }
+  return num_edges;
+}
+
+// Removes the inputs of node for which remove returns true, keeping the order
+// of the other inputs.
+template <typename Predicate>
+void RemoveInputs(NodeDef* node, Predicate remove) {
+  int num_inputs = 0;
+  for (int i = 0; i < node->input_size(); ++i) {
+    if (!remove(node->input(i))) {
+      node->mutable_input()->SwapElements(i, num_inputs++);
+    }
+  }
+  node->mutable_input()->DeleteSubrange(num_inputs,
+                                        node->input_size() - num_inputs);
+}
+
+// Removes the duplicate control inputs of node, and those on nodes that are
+// also data inputs, except for the Switch nodes: a data input of a Switch
+// only depends on one of its branches.
+void RemoveRedundantControlInputs(NodeDef* node, const NodeMap& node_map) {
+  std::unordered_set<string> data_inputs;
+  for (const string& input : node->input()) {
+    if (!IsControlInput(input)) {
+      data_inputs.insert(NodeName(input));
+    }
+  }
+  std::unordered_set<string> control_inputs;
+  RemoveInputs(node, [&](const string& input) {
+    if (!IsControlInput(input)) return false;
+    const string name = NodeName(input);
+    if (!control_inputs.insert(name).second) return true;
+    const NodeDef* input_node = node_map.GetNode(name);
+    return data_inputs.count(name) > 0 && input_node != nullptr &&
+           input_node->op() != "Switch" && input_node->op() != "RefSwitch";
+  });
+}
+
+// Sorts the nodes of the graph in topological order, ignoring the back edges
+// of the loops, and gets the unique input nodes of each node. Returns false if
+// the graph has other cycles.
+bool TopologicalOrder(const GraphDef& graph, std::vector<int>* order,
+                      std::vector<std::vector<int>>* inputs) {
+  const int num_nodes = graph.node_size();
+  std::unordered_map<string, int> index;
+  for (int i = 0; i < num_nodes; ++i) {
+    index[graph.node(i).name()] = i;
+  }
+  inputs->assign(num_nodes, {});
+  std::vector<std::vector<int>> outputs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph.node(i);
+    const bool is_merge = node.op() == "Merge" || node.op() == "RefMerge";
+    std::set<int> unique_inputs;
+    for (const string& input : node.input()) {
+      auto input_index = index.find(NodeName(input));
+      if (input_index == index.end()) continue;
+      const string& input_op = graph.node(input_index->second).op();
+      if (is_merge &&
+          (input_op == "NextIteration" || input_op == "RefNextIteration")) {
+        continue;
+      }
+      unique_inputs.insert(input_index->second);
+    }
+    (*inputs)[i].assign(unique_inputs.begin(), unique_inputs.end());
+    for (int input : unique_inputs) {
+      outputs[input].push_back(i);
+    }
+  }
+
+  order->clear();
+  std::vector<int> num_ready_inputs(num_nodes, 0);
+  std::deque<int> ready_nodes;
+  for (int i = 0; i < num_nodes; ++i) {
+    if ((*inputs)[i].empty()) ready_nodes.push_back(i);
+  }
+  while (!ready_nodes.empty()) {
+    const int node = ready_nodes.front();
+    ready_nodes.pop_front();
+    order->push_back(node);
+    for (int output : outputs[node]) {
+      if (++num_ready_inputs[output] == (*inputs)[output].size()) {
+        ready_nodes.push_back(output);
+      }
+    }
+  }
+  return order->size() == num_nodes;
+}
+
+// Returns true if "node" always runs after "input" when it consumes it. This
+// does not hold for a Merge, which runs as soon as one of its inputs is
+// available, nor for the edges that enter, exit or loop back into a while
+// loop frame, which relate different iterations.
+bool ImpliesOrder(const NodeDef& input, const NodeDef& node) {
+  return !IsMerge(node) && !IsEnter(node) && !IsExit(node) &&
+         !IsNextIteration(node) && !IsEnter(input) && !IsExit(input) &&
+         !IsNextIteration(input);
+}
+
+// Removes the control inputs of the nodes that are implied by a longer path
+// from the same input node. Only the edges along which ImpliesOrder() holds
+// count as paths.
+void TransitiveReduction(GraphDef* graph) {
+  std::vector<int> order;
+  std::vector<std::vector<int>> inputs;
+  if (!TopologicalOrder(*graph, &order, &inputs)) {
+    VLOG(1) << "Skipping the transitive reduction of a graph with cycles.";
+    return;
+  }
+  const int num_nodes = graph->node_size();
+  std::unordered_map<string, int> index;
+  for (int i = 0; i < num_nodes; ++i) {
+    index[graph->node(i).name()] = i;
+  }
+  std::vector<int> position(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    position[order[i]] = i;
+  }
+  std::vector<std::vector<int>> control_outputs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : graph->node(i).input()) {
+      if (!IsControlInput(input)) continue;
+      auto input_index = index.find(NodeName(input));
+      if (input_index != index.end()) {
+        control_outputs[input_index->second].push_back(i);
+      }
+    }
+  }
+
+  // For each node with control outputs, the length of the longest path to
+  // the nodes that follow it in topological order up to its last control
+  // output. A control output with a longest path longer than one is implied by
+  // that path.
+  std::vector<int> longest(num_nodes, -1);
+  std::vector<std::unordered_set<string>> inputs_to_remove(num_nodes);
+  for (int start = 0; start < num_nodes; ++start) {
+    const int source = order[start];
+    if (control_outputs[source].empty()) continue;
+    int end = start;
+    for (int output : control_outputs[source]) {
+      end = std::max(end, position[output]);
+    }
+    longest[source] = 0;
+    for (int i = start + 1; i <= end; ++i) {
+      const int node = order[i];
+      longest[node] = -1;
+      for (int input : inputs[node]) {
+        if (position[input] >= start && longest[input] >= 0 &&
+            ImpliesOrder(graph->node(input), graph->node(node))) {
+          longest[node] = std::max(longest[node], longest[input] + 1);
+        }
+      }
+    }
+    for (int output : control_outputs[source]) {
+      if (longest[output] > 1) {
+        inputs_to_remove[output].insert(
+            strings::StrCat("^", graph->node(source).name()));
+      }
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    if (inputs_to_remove[i].empty()) continue;
+    RemoveInputs(graph->mutable_node(i), [&](const string& input) {
+      return inputs_to_remove[i].count(input) > 0;
+    });
+  }
+}
+
+}  // namespace
+
+bool DependencyOptimizer::IsBypassable(const NodeDef& node,
+                                       const NodeMap& node_map) const {
+  if (nodes_to_preserve_.count(node.name())) return false;
+  if (node.op() == "NoOp") {
+    for (const string& input : node.input()) {
+      if (!IsControlInput(input)) return false;
+    }
+    return true;
+  }
+  if (IsIdentity(node)) {
+    // The Identity nodes of the Switch outputs are the pivots of the
+    // conditionals, whose control outputs only run in one branch.
+    if (node.input_size() == 0 || IsControlInput(node.input(0))) return false;
+    const NodeDef* input = node_map.GetNode(node.input(0));
+    return input != nullptr && !IsControlFlow(*input);
+  }
+  return false;
+}
+
+void DependencyOptimizer::BypassControlNodes(GraphDef* graph) const {
+  NodeMap node_map(graph);
+  std::unordered_set<string> bypassed_nodes;
+  for (int i = 0; i < graph->node_size(); ++i) {
+    const NodeDef& node = graph->node(i);
+    if (!IsBypassable(node, node_map)) continue;
+
+    // The nodes that the consumers of node will depend on instead.
+    std::vector<const NodeDef*> inputs;
+    std::set<string> input_names;
+    bool has_unknown_inputs = false;
+    for (const string& input : node.input()) {
+      const string name = NodeName(input);
+      if (!input_names.insert(name).second) continue;
+      const NodeDef* input_node = node_map.GetNode(name);
+      has_unknown_inputs |= input_node == nullptr;
+      inputs.push_back(input_node);
+    }
+    if (has_unknown_inputs) continue;
+    std::vector<NodeDef*> outputs;
+    bool has_data_outputs = false;
+    for (NodeDef* output : node_map.GetOutputs(node.name())) {
+      if (bypassed_nodes.count(output->name())) continue;
+      for (const string& input : output->input()) {
+        has_data_outputs |=
+            !IsControlInput(input) && NodeName(input) == node.name();
+      }
+      outputs.push_back(output);
+    }
+    if (has_data_outputs) continue;
+
+    // Only bypass the node if that does not add edges, nor edges between
+    // devices, which are sent over the network after partitioning.
+    const int num_inputs = inputs.size();
+    const int num_outputs = outputs.size();
+    if (num_inputs * num_outputs > num_inputs + num_outputs) continue;
+    int num_cross_device_edges = 0;
+    int num_bypass_cross_device_edges = 0;
+    for (const NodeDef* input : inputs) {
+      num_cross_device_edges += input->device() != node.device();
+      for (const NodeDef* output : outputs) {
+        num_bypass_cross_device_edges += input->device() != output->device();
+      }
+    }
+    for (const NodeDef* output : outputs) {
+      num_cross_device_edges += output->device() != node.device();
+    }
+    if (num_bypass_cross_device_edges > num_cross_device_edges) continue;
+
+    const string control_input = strings::StrCat("^", node.name());
+    for (NodeDef* output : outputs) {
+      RemoveInputs(output, [&control_input](const string& input) {
+        return input == control_input;
+      });
+      std::set<string> output_inputs;
+      for (const string& input : output->input()) {
+        output_inputs.insert(NodeName(input));
+      }
+      for (const NodeDef* input : inputs) {
+        if (!output_inputs.count(input->name())) {
+          output->add_input(strings::StrCat("^", input->name()));
+          node_map.AddOutput(input->name(), output->name());
+        }
+      }
+    }
+    bypassed_nodes.insert(node.name());
+  }
+  RemoveNodes(bypassed_nodes, graph);
+  VLOG(2) << "Bypassed " << bypassed_nodes.size() << " nodes.";
+}
+
+Status DependencyOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                     GraphDef* output) {
+  *output = item.graph;
+  nodes_to_preserve_.clear();
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve_.insert(NodeName(feed.first));
+  }
+  const int num_edges = NumEdges(*output);
+
+  {
+    NodeMap node_map(output);
+    for (int i = 0; i < output->node_size(); ++i) {
+      RemoveRedundantControlInputs(output->mutable_node(i), node_map);
+    }
+  }
+  BypassControlNodes(output);
+  TransitiveReduction(output);
+
+  VLOG(1) << "Reduced the number of edges from " << num_edges << " to "
+          << NumEdges(*output) << ".";
+  return Status::OK();
+}
+
+void DependencyOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                   const GraphDef& optimize_output,
+                                   double result) {
+  // Nothing to do for DependencyOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_DEPENDENCY_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_DEPENDENCY_OPTIMIZER_H_
+
+#include <unordered_set>
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class NodeMap;
+
+// Reduce the number of control dependencies the executor has to process:
+// - Remove the duplicate control inputs, and those from nodes that are also
+//   data inputs.
+// - Bypass the NoOp nodes, and the Identity nodes whose outputs are only used
+//   as control dependencies, when that does not add edges or cross device
+//   edges.
+// - Remove the control inputs implied by other paths between their nodes, by
+//   a transitive reduction of the graph.
+class DependencyOptimizer : public GraphOptimizer {
+ public:
+  DependencyOptimizer() {}
+  ~DependencyOptimizer() override {}
+
+  string name() const override { return "dependency_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  // Returns true iff node can be removed by routing its inputs to its outputs
+  // as control dependencies.
+  bool IsBypassable(const NodeDef& node, const NodeMap& node_map) const;
+  // Bypasses and removes the bypassable nodes of the graph.
+  void BypassControlNodes(GraphDef* graph) const;
+
+  std::unordered_set<string> nodes_to_preserve_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_DEPENDENCY_OPTIMIZER_H_
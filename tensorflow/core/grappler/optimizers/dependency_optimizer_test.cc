@@ -0,0 +1,245 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+#include <algorithm>
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class DependencyOptimizerTest : public ::testing::Test {
+ protected:
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  // Returns the inputs of the node, with the control inputs sorted since
+  // their order is not significant.
+  std::vector<string> Inputs(const NodeDef& node) {
+    std::vector<string> inputs(node.input().begin(), node.input().end());
+    auto control = std::find_if(inputs.begin(), inputs.end(), IsControlInput);
+    std::sort(control, inputs.end());
+    return inputs;
+  }
+};
+
+TEST_F(DependencyOptimizerTest, BypassesNoOp) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  Output b = ops::Const(s.WithOpName("b"), 2.0f, {});
+  auto group = ops::NoOp(
+      s.WithOpName("group").WithControlDependencies({a.op(), b.op()}));
+  ops::Const(s.WithOpName("x").WithControlDependencies(group.operation), 3.0f,
+             {});
+
+  GrapplerItem item;
+  item.fetch.push_back("x");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() - 1, output.node_size());
+  EXPECT_EQ(nullptr, FindNode(output, "group"));
+  const NodeDef* x = FindNode(output, "x");
+  ASSERT_NE(nullptr, x);
+  EXPECT_EQ(std::vector<string>({"^a", "^b"}), Inputs(*x));
+}
+
+TEST_F(DependencyOptimizerTest, KeepsPreservedNoOp) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  auto group = ops::NoOp(s.WithOpName("group").WithControlDependencies(a));
+  ops::Const(s.WithOpName("x").WithControlDependencies(group.operation), 3.0f,
+             {});
+
+  GrapplerItem item;
+  item.fetch = {"x", "group"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  const NodeDef* x = FindNode(output, "x");
+  ASSERT_NE(nullptr, x);
+  EXPECT_EQ(std::vector<string>({"^group"}), Inputs(*x));
+}
+
+TEST_F(DependencyOptimizerTest, BypassesIdentityUsedAsControlInput) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  Output id = ops::Identity(s.WithOpName("id"), a);
+  ops::NoOp(s.WithOpName("train").WithControlDependencies(id));
+
+  GrapplerItem item;
+  item.fetch.push_back("train");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "id"));
+  const NodeDef* train = FindNode(output, "train");
+  ASSERT_NE(nullptr, train);
+  EXPECT_EQ(std::vector<string>({"^a"}), Inputs(*train));
+}
+
+TEST_F(DependencyOptimizerTest, RemovesControlInputsImpliedByDataInputs) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  Output b = ops::Const(s.WithOpName("b"), 2.0f, {});
+  Output c = ops::Const(s.WithOpName("c"), 3.0f, {});
+  ops::Add(s.WithOpName("x").WithControlDependencies({a.op(), c.op()}), a, b);
+
+  GrapplerItem item;
+  item.fetch.push_back("x");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* x = FindNode(output, "x");
+  ASSERT_NE(nullptr, x);
+  EXPECT_EQ(std::vector<string>({"a", "b", "^c"}), Inputs(*x));
+}
+
+TEST_F(DependencyOptimizerTest, RemovesTransitiveControlInputs) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  Output b = ops::Const(s.WithOpName("b").WithControlDependencies(a), 2.0f, {});
+  Output c = ops::Square(s.WithOpName("c"), b);
+  ops::Const(s.WithOpName("x").WithControlDependencies({a.op(), c.op()}), 3.0f,
+             {});
+
+  GrapplerItem item;
+  item.fetch.push_back("x");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // x runs after c, which runs after b and thus after a.
+  const NodeDef* x = FindNode(output, "x");
+  ASSERT_NE(nullptr, x);
+  EXPECT_EQ(std::vector<string>({"^c"}), Inputs(*x));
+  const NodeDef* b_node = FindNode(output, "b");
+  ASSERT_NE(nullptr, b_node);
+  EXPECT_EQ(std::vector<string>({"^a"}), Inputs(*b_node));
+}
+
+TEST_F(DependencyOptimizerTest, DoesNotBypassWhenEdgesIncrease) {
+  Scope s = Scope::NewRootScope();
+  std::vector<Operation> inputs;
+  for (const string& name : {"a", "b", "c"}) {
+    inputs.push_back(ops::Const(s.WithOpName(name), 1.0f, {}).op());
+  }
+  auto group =
+      ops::NoOp(s.WithOpName("group").WithControlDependencies(inputs));
+  for (const string& name : {"x", "y", "z"}) {
+    ops::Const(s.WithOpName(name).WithControlDependencies(group.operation),
+               2.0f, {});
+  }
+
+  GrapplerItem item;
+  item.fetch = {"x", "y", "z"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Bypassing the NoOp would replace its 6 edges with 9.
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  const NodeDef* group_node = FindNode(output, "group");
+  ASSERT_NE(nullptr, group_node);
+  EXPECT_EQ(std::vector<string>({"^a", "^b", "^c"}), Inputs(*group_node));
+  for (const string& name : {"x", "y", "z"}) {
+    const NodeDef* node = FindNode(output, name);
+    ASSERT_NE(nullptr, node);
+    EXPECT_EQ(std::vector<string>({"^group"}), Inputs(*node));
+  }
+}
+
+TEST_F(DependencyOptimizerTest, KeepsControlInputsOnSwitch) {
+  Scope s = Scope::NewRootScope();
+  Output data = ops::Const(s.WithOpName("data"), 1.0f, {});
+  Output pred = ops::Const(s.WithOpName("pred"), true, {});
+  auto sw = ops::Switch(s.WithOpName("switch"), data, pred);
+  // The control input on the Switch is not implied by the data input on one
+  // of its outputs, since the outputs of a Switch differ in liveness.
+  ops::Identity(s.WithOpName("x").WithControlDependencies(sw.output_false),
+                sw.output_true);
+
+  GrapplerItem item;
+  item.fetch.push_back("x");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* x = FindNode(output, "x");
+  ASSERT_NE(nullptr, x);
+  EXPECT_EQ(std::vector<string>({"switch:1", "^switch"}), Inputs(*x));
+}
+
+TEST_F(DependencyOptimizerTest, KeepsControlInputsAcrossMerge) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+  Output other = ops::Const(s.WithOpName("other"), 2.0f, {});
+  Output pred = ops::Const(s.WithOpName("pred"), false, {});
+  auto a_switch = ops::Switch(s.WithOpName("a_switch"), a, pred);
+  auto other_switch = ops::Switch(s.WithOpName("other_switch"), other, pred);
+  Output then_value = ops::Square(s.WithOpName("then"), a_switch.output_true);
+  Output else_value =
+      ops::Identity(s.WithOpName("else"), other_switch.output_false);
+  auto merge = ops::Merge(s.WithOpName("merge"), {then_value, else_value});
+  // The path from a through the merge does not order x after a, since the
+  // merge runs as soon as the else branch is available.
+  ops::Identity(s.WithOpName("x").WithControlDependencies(a.op()),
+                merge.output);
+
+  GrapplerItem item;
+  item.fetch.push_back("x");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DependencyOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* x = FindNode(output, "x");
+  ASSERT_NE(nullptr, x);
+  EXPECT_EQ(std::vector<string>({"merge", "^a"}), Inputs(*x));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,324 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/inference_optimizer.h"
+
+#include <cmath>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+bool HasFloatType(const NodeDef& node) {
+  auto attr = node.attr().find("T");
+  return attr != node.attr().end() && attr->second.type() == DT_FLOAT;
+}
+
+string DataFormat(const NodeDef& node) {
+  auto attr = node.attr().find("data_format");
+  return attr == node.attr().end() ? "NHWC" : attr->second.s();
+}
+
+// Returns true iff the first output of node is used once by consumer, and
+// no other output of node is used.
+bool IsOnlyConsumer(const NodeDef& node, const NodeDef& consumer,
+                    const NodeMap& node_map) {
+  const std::set<NodeDef*>& outputs = node_map.GetOutputs(node.name());
+  if (outputs.size() != 1 || *outputs.begin() != &consumer) return false;
+  int num_uses = 0;
+  for (const string& input : consumer.input()) {
+    if (NodeName(input) != node.name()) continue;
+    if (IsControlInput(input) || NodePosition(input) != 0) return false;
+    ++num_uses;
+  }
+  return num_uses == 1;
+}
+
+// Returns true iff only the first output of node is used by other nodes.
+bool OnlyFirstOutputUsed(const NodeDef& node, const NodeMap& node_map) {
+  for (const NodeDef* output : node_map.GetOutputs(node.name())) {
+    for (const string& input : output->input()) {
+      if (NodeName(input) == node.name() &&
+          (IsControlInput(input) || NodePosition(input) != 0)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Reads the value of node if it is a float constant.
+bool GetFloatConstant(const NodeDef* node, Tensor* value) {
+  if (node == nullptr || node->op() != "Const") return false;
+  auto attr = node->attr().find("value");
+  return attr != node->attr().end() &&
+         value->FromProto(attr->second.tensor()) && value->dtype() == DT_FLOAT;
+}
+
+// Copies the internal attributes of from, such as the colocation constraints,
+// to to.
+void CopyInternalAttributes(const NodeDef& from, NodeDef* to) {
+  for (const auto& attr : from.attr()) {
+    if (!attr.first.empty() && attr.first[0] == '_') {
+      (*to->mutable_attr())[attr.first] = attr.second;
+    }
+  }
+}
+
+// Replaces node with a node of the same name, so that its consumers are
+// unchanged, applying op to its first input.
+void ReplaceWithUnaryOp(const string& op, NodeDef* node) {
+  NodeDef replacement;
+  replacement.set_name(node->name());
+  replacement.set_op(op);
+  replacement.set_device(node->device());
+  replacement.add_input(node->input(0));
+  for (int i = NumDataInputs(*node); i < node->input_size(); ++i) {
+    replacement.add_input(node->input(i));
+  }
+  (*replacement.mutable_attr())["T"] = node->attr().at("T");
+  CopyInternalAttributes(*node, &replacement);
+  node->Swap(&replacement);
+}
+
+}  // namespace
+
+int InferenceOptimizer::RemoveTrainingNodes(GraphDef* graph) const {
+  int num_removed = 0;
+  for (int i = 0; i < graph->node_size(); ++i) {
+    NodeDef* node = graph->mutable_node(i);
+    if ((node->op() != "CheckNumerics" && node->op() != "PreventGradient") ||
+        nodes_to_preserve_.count(node->name()) || NumDataInputs(*node) != 1 ||
+        !node->attr().count("T")) {
+      continue;
+    }
+    ReplaceWithUnaryOp("Identity", node);
+    ++num_removed;
+  }
+  return num_removed;
+}
+
+int InferenceOptimizer::FoldBatchNorms(GraphDef* graph) const {
+  NodeMap node_map(graph);
+  std::unordered_set<string> names;
+  for (const NodeDef& node : graph->node()) {
+    names.insert(node.name());
+  }
+  auto add_constant = [&](const string& prefix, const string& name,
+                          const Tensor& value, const string& device) {
+    const string const_name = AddPrefixToNodeName(name, prefix, "_");
+    string unique_name = const_name;
+    for (int i = 1; names.count(unique_name); ++i) {
+      unique_name = strings::StrCat(const_name, "_", i);
+    }
+    names.insert(unique_name);
+    NodeDef* node = graph->add_node();
+    node->set_name(unique_name);
+    node->set_op("Const");
+    node->set_device(device);
+    (*node->mutable_attr())["dtype"].set_type(DT_FLOAT);
+    value.AsProtoTensorContent(
+        (*node->mutable_attr())["value"].mutable_tensor());
+    return node;
+  };
+
+  int num_folded = 0;
+  const int num_nodes = graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = graph->mutable_node(i);
+    const bool is_batch_norm = node->op() == "FusedBatchNorm";
+    if ((!is_batch_norm && node->op() != "Mul") || !HasFloatType(*node) ||
+        nodes_to_preserve_.count(node->name())) {
+      continue;
+    }
+
+    // The contraction, and the per channel scale applied to its output.
+    NodeDef* contraction = nullptr;
+    int contraction_input = 0;
+    Tensor scale;
+    // The constant inputs of the batch normalization.
+    Tensor params[4];
+    if (is_batch_norm) {
+      auto is_training = node->attr().find("is_training");
+      if (is_training == node->attr().end() || is_training->second.b() ||
+          NumDataInputs(*node) != 5 || DataFormat(*node) != "NHWC" ||
+          !OnlyFirstOutputUsed(*node, node_map)) {
+        continue;
+      }
+      bool constant = true;
+      for (int j = 0; j < 4 && constant; ++j) {
+        constant = GetFloatConstant(node_map.GetNode(node->input(j + 1)),
+                                    &params[j]) &&
+                   params[j].dims() == 1 &&
+                   params[j].NumElements() == params[0].NumElements();
+      }
+      if (!constant) continue;
+      contraction = node_map.GetNode(node->input(0));
+      scale = Tensor(DT_FLOAT, params[0].shape());
+    } else {
+      if (NumDataInputs(*node) != 2) continue;
+      for (int j = 0; j < 2 && contraction == nullptr; ++j) {
+        if (GetFloatConstant(node_map.GetNode(node->input(1 - j)), &scale) &&
+            scale.dims() <= 1) {
+          contraction = node_map.GetNode(node->input(j));
+          contraction_input = j;
+        }
+      }
+    }
+    if (contraction == nullptr || !HasFloatType(*contraction) ||
+        nodes_to_preserve_.count(contraction->name()) ||
+        NumDataInputs(*contraction) != 2 ||
+        !IsOnlyConsumer(*contraction, *node, node_map)) {
+      continue;
+    }
+    if (contraction->op() == "Conv2D") {
+      if (DataFormat(*contraction) != "NHWC") continue;
+    } else if (contraction->op() == "MatMul") {
+      auto transpose_b = contraction->attr().find("transpose_b");
+      if (transpose_b != contraction->attr().end() &&
+          transpose_b->second.b()) {
+        continue;
+      }
+    } else {
+      continue;
+    }
+    // The output channels are the last dimension of the weights, in the HWIO
+    // format for a convolution.
+    const NodeDef* weights_node = node_map.GetNode(contraction->input(1));
+    Tensor weights;
+    if (!GetFloatConstant(weights_node, &weights) ||
+        weights.dims() != (contraction->op() == "Conv2D" ? 4 : 2)) {
+      continue;
+    }
+    const int64 num_channels = weights.dim_size(weights.dims() - 1);
+    if (num_channels == 0 ||
+        (scale.NumElements() != 1 && scale.NumElements() != num_channels)) {
+      continue;
+    }
+
+    // The batch normalization computes
+    //   (x - mean) * scale / sqrt(variance + epsilon) + offset.
+    Tensor offset(DT_FLOAT, TensorShape({num_channels}));
+    if (is_batch_norm) {
+      auto epsilon = node->attr().find("epsilon");
+      const float epsilon_value =
+          epsilon != node->attr().end() ? epsilon->second.f() : 0.0001f;
+      auto gamma = params[0].flat<float>();
+      auto beta = params[1].flat<float>();
+      auto mean = params[2].flat<float>();
+      auto variance = params[3].flat<float>();
+      auto scale_values = scale.flat<float>();
+      auto offset_values = offset.flat<float>();
+      for (int64 c = 0; c < num_channels; ++c) {
+        scale_values(c) = gamma(c) / std::sqrt(variance(c) + epsilon_value);
+        offset_values(c) = beta(c) - mean(c) * scale_values(c);
+      }
+    }
+    Tensor folded_weights(DT_FLOAT, weights.shape());
+    auto weight_values = weights.flat<float>();
+    auto folded_values = folded_weights.flat<float>();
+    auto scale_values = scale.flat<float>();
+    for (int64 j = 0; j < weights.NumElements(); ++j) {
+      folded_values(j) =
+          weight_values(j) *
+          scale_values(scale.NumElements() == 1 ? 0 : j % num_channels);
+    }
+
+    NodeDef* folded_weights_node =
+        add_constant("InferenceOptimizer/FoldedWeights", contraction->name(),
+                     folded_weights, weights_node->device());
+    for (int j = NumDataInputs(*weights_node); j < weights_node->input_size();
+         ++j) {
+      folded_weights_node->add_input(weights_node->input(j));
+    }
+    contraction->set_input(1, folded_weights_node->name());
+
+    if (!is_batch_norm) {
+      // The output of the contraction is already scaled.
+      node->mutable_input()->SwapElements(0, contraction_input);
+      ReplaceWithUnaryOp("Identity", node);
+    } else {
+      NodeDef* offset_node = add_constant("InferenceOptimizer/FoldedOffset",
+                                          node->name(), offset, node->device());
+      // The control inputs of the constant inputs of the batch normalization.
+      std::set<string> control_inputs;
+      for (int j = 1; j < 5; ++j) {
+        const NodeDef* param = node_map.GetNode(node->input(j));
+        for (int k = NumDataInputs(*param); k < param->input_size(); ++k) {
+          if (control_inputs.insert(param->input(k)).second) {
+            offset_node->add_input(param->input(k));
+          }
+        }
+      }
+
+      NodeDef bias;
+      bias.set_name(node->name());
+      bias.set_op("BiasAdd");
+      bias.set_device(node->device());
+      bias.add_input(node->input(0));
+      bias.add_input(offset_node->name());
+      for (int j = NumDataInputs(*node); j < node->input_size(); ++j) {
+        bias.add_input(node->input(j));
+      }
+      (*bias.mutable_attr())["T"].set_type(DT_FLOAT);
+      (*bias.mutable_attr())["data_format"].set_s("NHWC");
+      CopyInternalAttributes(*node, &bias);
+      node->Swap(&bias);
+    }
+    ++num_folded;
+  }
+  return num_folded;
+}
+
+Status InferenceOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* output) {
+  *output = item.graph;
+  nodes_to_preserve_.clear();
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve_.insert(NodeName(feed.first));
+  }
+
+  const int num_removed = RemoveTrainingNodes(output);
+  const int num_folded = FoldBatchNorms(output);
+  VLOG(1) << "Removed " << num_removed << " training nodes and folded "
+          << num_folded << " batch normalizations into weights.";
+  return Status::OK();
+}
+
+void InferenceOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimize_output,
+                                  double result) {
+  // Nothing to do for InferenceOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,63 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_INFERENCE_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_INFERENCE_OPTIMIZER_H_
+
+#include <unordered_set>
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Optimize the graphs that are only used for inference, as the
+// strip_unused_nodes, remove_nodes and fold_batch_norms graph transforms do:
+// - The CheckNumerics and PreventGradient nodes, which are only needed for
+//   training, are replaced with Identity nodes, which the model pruner then
+//   removes along with the StopGradient nodes.
+// - The inference FusedBatchNorm nodes, and the multiplications by constants,
+//   applied to the output of a Conv2D or a MatMul with constant weights are
+//   folded into the weights, the batch normalizations becoming a BiasAdd.
+// The unused nodes are pruned when running the graph, and the constants are
+// folded by ConstantFolding.
+class InferenceOptimizer : public GraphOptimizer {
+ public:
+  InferenceOptimizer() {}
+  ~InferenceOptimizer() override {}
+
+  string name() const override { return "inference_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  // Replaces the nodes only needed for training with Identity nodes, and
+  // returns their number.
+  int RemoveTrainingNodes(GraphDef* graph) const;
+  // Folds the batch normalizations and multiplications by constants into the
+  // weights of the preceding Conv2D and MatMul nodes, and returns their
+  // number.
+  int FoldBatchNorms(GraphDef* graph) const;
+
+  std::unordered_set<string> nodes_to_preserve_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_INFERENCE_OPTIMIZER_H_
@@ -0,0 +1,203 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/inference_optimizer.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class InferenceOptimizerTest : public ::testing::Test {
+ protected:
+  NodeDef* AddNode(const string& name, const string& op,
+                   const std::vector<string>& inputs, GraphDef* graph) {
+    NodeDef* node = graph->add_node();
+    node->set_name(name);
+    node->set_op(op);
+    for (const string& input : inputs) {
+      node->add_input(input);
+    }
+    (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+    return node;
+  }
+
+  NodeDef* AddConst(const string& name, const Tensor& value,
+                    GraphDef* graph) {
+    NodeDef* node = AddNode(name, "Const", {}, graph);
+    node->mutable_attr()->erase("T");
+    (*node->mutable_attr())["dtype"].set_type(DT_FLOAT);
+    value.AsProtoTensorContent(
+        (*node->mutable_attr())["value"].mutable_tensor());
+    return node;
+  }
+
+  NodeDef* AddBatchNorm(const string& name, const string& input,
+                        GraphDef* graph) {
+    std::vector<string> inputs = {input};
+    for (const string& param : {"gamma", "beta", "mean", "variance"}) {
+      inputs.push_back(strings::StrCat(name, "/", param));
+    }
+    AddConst(inputs[1], test::AsTensor<float>({2, 6}), graph);
+    AddConst(inputs[2], test::AsTensor<float>({1, -1}), graph);
+    AddConst(inputs[3], test::AsTensor<float>({0.5, 1}), graph);
+    AddConst(inputs[4], test::AsTensor<float>({4, 9}), graph);
+    NodeDef* batch_norm = AddNode(name, "FusedBatchNorm", inputs, graph);
+    (*batch_norm->mutable_attr())["is_training"].set_b(false);
+    (*batch_norm->mutable_attr())["epsilon"].set_f(0);
+    return batch_norm;
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  std::vector<string> Inputs(const NodeDef& node) {
+    return std::vector<string>(node.input().begin(), node.input().end());
+  }
+
+  Tensor Value(const GraphDef& graph, const string& name) {
+    const NodeDef* node = FindNode(graph, name);
+    Tensor value;
+    if (node != nullptr) {
+      CHECK(value.FromProto(node->attr().at("value").tensor()));
+    }
+    return value;
+  }
+};
+
+TEST_F(InferenceOptimizerTest, FoldsBatchNormIntoConvolution) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddNode("x", "Placeholder", {}, graph);
+  AddConst("filter", test::AsTensor<float>({1, 2, 3, 4}, {1, 1, 2, 2}), graph);
+  AddNode("conv", "Conv2D", {"x", "filter"}, graph);
+  AddBatchNorm("batch_norm", "conv", graph);
+  AddNode("relu", "Relu", {"batch_norm"}, graph);
+  item.fetch.push_back("relu");
+
+  InferenceOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The scales are 2 / sqrt(4) = 1 and 6 / sqrt(9) = 2, and the offsets are
+  // 1 - 0.5 * 1 and -1 - 1 * 2.
+  const string folded_filter = "InferenceOptimizer/FoldedWeights_conv";
+  const string offset = "InferenceOptimizer/FoldedOffset_batch_norm";
+  EXPECT_EQ(std::vector<string>({"x", folded_filter}),
+            Inputs(*FindNode(output, "conv")));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1, 4, 3, 8}, {1, 1, 2, 2}),
+      Value(output, folded_filter));
+  const NodeDef* bias = FindNode(output, "batch_norm");
+  EXPECT_EQ("BiasAdd", bias->op());
+  EXPECT_EQ(std::vector<string>({"conv", offset}), Inputs(*bias));
+  EXPECT_EQ("NHWC", bias->attr().at("data_format").s());
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({0.5, -3}),
+                                 Value(output, offset));
+  EXPECT_EQ(item.graph.node_size() + 2, output.node_size());
+}
+
+TEST_F(InferenceOptimizerTest, FoldsMulIntoMatMul) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddNode("x", "Placeholder", {}, graph);
+  AddConst("weights", test::AsTensor<float>({1, 2, 3, 4}, {2, 2}), graph);
+  AddConst("scale", test::AsTensor<float>({10, 100}), graph);
+  AddNode("matmul", "MatMul", {"x", "weights"}, graph);
+  AddNode("mul", "Mul", {"scale", "matmul"}, graph);
+  AddNode("output", "Relu", {"mul"}, graph);
+
+  InferenceOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const string folded_weights = "InferenceOptimizer/FoldedWeights_matmul";
+  EXPECT_EQ(std::vector<string>({"x", folded_weights}),
+            Inputs(*FindNode(output, "matmul")));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({10, 200, 30, 400}, {2, 2}),
+      Value(output, folded_weights));
+  const NodeDef* mul = FindNode(output, "mul");
+  EXPECT_EQ("Identity", mul->op());
+  EXPECT_EQ(std::vector<string>({"matmul"}), Inputs(*mul));
+}
+
+TEST_F(InferenceOptimizerTest, KeepsBatchNormsThatCantBeFolded) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddNode("x", "Placeholder", {}, graph);
+  AddNode("filter", "VariableV2", {}, graph);
+  AddConst("weights", test::AsTensor<float>({1, 2, 3, 4}, {1, 1, 2, 2}),
+           graph);
+  // The weights are variables.
+  AddNode("conv1", "Conv2D", {"x", "filter"}, graph);
+  AddBatchNorm("batch_norm1", "conv1", graph);
+  // The output of the convolution is used elsewhere.
+  AddNode("conv2", "Conv2D", {"x", "weights"}, graph);
+  AddBatchNorm("batch_norm2", "conv2", graph);
+  AddNode("relu", "Relu", {"conv2"}, graph);
+  // The batch normalization is computed for training.
+  AddNode("conv3", "Conv2D", {"x", "weights"}, graph);
+  (*AddBatchNorm("batch_norm3", "conv3", graph)->mutable_attr())["is_training"]
+      .set_b(true);
+  item.fetch.push_back("relu");
+
+  InferenceOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    EXPECT_EQ(item.graph.node(i).DebugString(), output.node(i).DebugString());
+  }
+}
+
+TEST_F(InferenceOptimizerTest, RemovesTrainingNodes) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddNode("x", "Placeholder", {}, graph);
+  NodeDef* check = AddNode("check", "CheckNumerics", {"x", "^x"}, graph);
+  (*check->mutable_attr())["message"].set_s("NaN");
+  AddNode("prevent", "PreventGradient", {"check"}, graph);
+  AddNode("fetched", "CheckNumerics", {"prevent"}, graph);
+  item.fetch.push_back("fetched");
+
+  InferenceOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* identity = FindNode(output, "check");
+  EXPECT_EQ("Identity", identity->op());
+  EXPECT_EQ(std::vector<string>({"x", "^x"}), Inputs(*identity));
+  EXPECT_EQ(1, identity->attr().size());
+  EXPECT_EQ(DT_FLOAT, identity->attr().at("T").type());
+  EXPECT_EQ("Identity", FindNode(output, "prevent")->op());
+  EXPECT_EQ("CheckNumerics", FindNode(output, "fetched")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
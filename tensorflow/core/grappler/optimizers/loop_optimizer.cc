@@ -0,0 +1,492 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+bool IsControlFlow(const NodeDef& node) {
+  static const auto* control_flow_ops = new std::unordered_set<string>{
+      "ControlTrigger", "Enter", "Exit", "LoopCond", "Merge", "NextIteration",
+      "RefEnter", "RefExit", "RefMerge", "RefNextIteration", "RefSwitch",
+      "Switch"};
+  return control_flow_ops->count(node.op()) > 0;
+}
+
+// True iff node is an Enter node that forwards the same tensor to all the
+// iterations of its loop.
+bool IsConstantEnter(const NodeDef& node) {
+  if (node.op() != "Enter") return false;
+  auto is_constant = node.attr().find("is_constant");
+  return is_constant != node.attr().end() && is_constant->second.b();
+}
+
+// True iff node can't fail at run time, whatever the values of its inputs.
+bool IsErrorFree(const NodeDef& node) {
+  static const auto* error_free_ops = new std::unordered_set<string>{
+      "Abs", "Ceil", "Cos", "Exp", "Floor", "Identity", "Log", "Neg",
+      "OnesLike", "Rank", "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt",
+      "Shape", "Sigmoid", "Sign", "Sin", "Size", "Sqrt", "Square", "Tanh",
+      "ZerosLike"};
+  return error_free_ops->count(node.op()) > 0 || IsConstant(node);
+}
+
+// True iff node can only fail at run time when the shapes of its inputs, or
+// the values of its constant shape inputs, don't fit. The static shape
+// inference checks this when all the shapes are fully defined.
+bool FailsOnlyOnShapeMismatch(const NodeDef& node) {
+  static const auto* shape_checked_ops = new std::unordered_set<string>{
+      "Add", "AddN", "BiasAdd", "ExpandDims", "MatMul", "Maximum", "Minimum",
+      "Mul", "Reshape", "Sub", "Tile"};
+  return shape_checked_ops->count(node.op()) > 0;
+}
+
+bool IsFullyDefined(const TensorShapeProto& shape) {
+  if (shape.unknown_rank()) return false;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return false;
+  }
+  return true;
+}
+
+// True iff the static shape inference ran on node and inferred fully defined
+// shapes for all its inputs and outputs.
+bool HasFullyDefinedShapes(const GraphProperties& properties,
+                           const NodeDef& node) {
+  if (!properties.HasOutputProperties(node.name())) return false;
+  for (const auto& input : properties.GetInputProperties(node.name())) {
+    if (!IsFullyDefined(input.shape())) return false;
+  }
+  for (const auto& output : properties.GetOutputProperties(node.name())) {
+    if (!IsFullyDefined(output.shape())) return false;
+  }
+  return true;
+}
+
+// A while loop frame.
+struct Frame {
+  // The enclosing frame, or -1 for the root frame of the graph.
+  int parent;
+  string name;
+  // One of the Enter nodes of the frame.
+  int enter;
+};
+
+// Assigns the nodes of the graph to their frames, by propagating the frames
+// from the nodes without inputs, which are in the root frame 0: the outputs of
+// an Enter node are in a child frame of its own frame, and the outputs of an
+// Exit node in the parent frame of its own frame. The nodes that can't be
+// reached are assigned to frame -1.
+void AssignFrames(const GraphDef& graph,
+                  const std::unordered_map<string, int>& index,
+                  const std::vector<std::vector<int>>& outputs,
+                  std::vector<int>* node_frames, std::vector<Frame>* frames) {
+  const int num_nodes = graph.node_size();
+  frames->assign(1, {-1, "", -1});
+  node_frames->assign(num_nodes, -1);
+  std::deque<int> ready_nodes;
+  for (int i = 0; i < num_nodes; ++i) {
+    bool has_inputs = false;
+    for (const string& input : graph.node(i).input()) {
+      has_inputs |= index.count(NodeName(input)) > 0;
+    }
+    if (!has_inputs) {
+      (*node_frames)[i] = 0;
+      ready_nodes.push_back(i);
+    }
+  }
+
+  std::map<std::pair<int, string>, int> child_frames;
+  while (!ready_nodes.empty()) {
+    const int node = ready_nodes.front();
+    ready_nodes.pop_front();
+    const NodeDef& node_def = graph.node(node);
+    int output_frame = (*node_frames)[node];
+    if (IsEnter(node_def)) {
+      auto frame_name = node_def.attr().find("frame_name");
+      const auto key = std::make_pair(
+          output_frame,
+          frame_name == node_def.attr().end() ? "" : frame_name->second.s());
+      auto child_frame = child_frames.find(key);
+      if (child_frame == child_frames.end()) {
+        child_frame = child_frames.emplace(key, frames->size()).first;
+        frames->push_back({key.first, key.second, node});
+      }
+      output_frame = child_frame->second;
+    } else if (IsExit(node_def) && output_frame > 0) {
+      output_frame = (*frames)[output_frame].parent;
+    }
+    for (int output : outputs[node]) {
+      if ((*node_frames)[output] < 0) {
+        (*node_frames)[output] = output_frame;
+        ready_nodes.push_back(output);
+      }
+    }
+  }
+}
+
+// Collects in gates the control inputs that the hoisted node drops, and on
+// which the nodes of the loop that use its outputs must keep depending: the
+// control inputs of the hoisted constants that are neither hoisted nor
+// constant Enter nodes, and those of the hoisted inputs of node.
+const std::set<string>& CollectGates(
+    const GraphDef& graph, const std::unordered_map<string, int>& index,
+    const std::vector<bool>& hoisted, int node,
+    std::vector<std::set<string>>* gates, std::vector<bool>* done) {
+  std::set<string>& node_gates = (*gates)[node];
+  if ((*done)[node]) return node_gates;
+  (*done)[node] = true;
+  for (const string& input : graph.node(node).input()) {
+    const int producer = index.at(NodeName(input));
+    if (hoisted[producer]) {
+      const std::set<string>& producer_gates =
+          CollectGates(graph, index, hoisted, producer, gates, done);
+      node_gates.insert(producer_gates.begin(), producer_gates.end());
+    } else if (!IsConstantEnter(graph.node(producer))) {
+      node_gates.insert(graph.node(producer).name());
+    }
+  }
+  return node_gates;
+}
+
+}  // namespace
+
+bool LoopOptimizer::CanHoist(const NodeDef& node,
+                             DataTypeVector* output_types) const {
+  if (nodes_to_preserve_.count(node.name()) || IsControlFlow(node)) {
+    return false;
+  }
+  // A hoisted node runs even if its loop runs no iteration, or if it was in
+  // a branch of a conditional that isn't taken, so it must not fail where it
+  // wouldn't have run.
+  if (!IsErrorFree(node) && !shape_checked_nodes_.count(node.name())) {
+    return false;
+  }
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+      op_def->is_stateful() || op_def->output_arg_size() == 0) {
+    return false;
+  }
+  // The value of a reference can change between the iterations.
+  for (const auto& input_arg : op_def->input_arg()) {
+    if (input_arg.is_ref()) return false;
+  }
+  for (const auto& output_arg : op_def->output_arg()) {
+    if (output_arg.is_ref()) return false;
+  }
+  DataTypeVector input_types;
+  return InOutTypesForNode(node, *op_def, &input_types, output_types).ok();
+}
+
+int LoopOptimizer::HoistLoopInvariants(GraphDef* graph) const {
+  const int num_nodes = graph->node_size();
+  std::unordered_map<string, int> index;
+  for (int i = 0; i < num_nodes; ++i) {
+    index[graph->node(i).name()] = i;
+  }
+  std::vector<std::vector<int>> outputs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    std::set<int> inputs;
+    for (const string& input : graph->node(i).input()) {
+      auto input_index = index.find(NodeName(input));
+      if (input_index != index.end()) inputs.insert(input_index->second);
+    }
+    for (int input : inputs) {
+      outputs[input].push_back(i);
+    }
+  }
+  std::vector<int> node_frames;
+  std::vector<Frame> frames;
+  AssignFrames(*graph, index, outputs, &node_frames, &frames);
+  if (frames.size() == 1) return 0;
+
+  std::vector<DataTypeVector> output_types(num_nodes);
+  std::vector<bool> candidates(num_nodes, false);
+  for (int i = 0; i < num_nodes; ++i) {
+    candidates[i] =
+        node_frames[i] > 0 && CanHoist(graph->node(i), &output_types[i]);
+  }
+
+  // Find the loop invariant nodes, in topological order. The control inputs
+  // of the constants don't matter since they are kept as gates.
+  std::vector<bool> invariant(num_nodes, false);
+  std::vector<int> invariant_nodes;
+  std::deque<int> nodes_to_check;
+  std::vector<bool> to_check = candidates;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (candidates[i]) nodes_to_check.push_back(i);
+  }
+  while (!nodes_to_check.empty()) {
+    const int node = nodes_to_check.front();
+    nodes_to_check.pop_front();
+    to_check[node] = false;
+    const NodeDef& node_def = graph->node(node);
+    const bool is_constant = IsConstant(node_def);
+    bool is_invariant = true;
+    for (const string& input : node_def.input()) {
+      auto input_index = index.find(NodeName(input));
+      if (input_index == index.end()) {
+        is_invariant = false;
+        break;
+      }
+      if (is_constant && IsControlInput(input)) continue;
+      const int producer = input_index->second;
+      if (!IsConstantEnter(graph->node(producer)) &&
+          !(invariant[producer] &&
+            node_frames[producer] == node_frames[node])) {
+        is_invariant = false;
+        break;
+      }
+    }
+    if (!is_invariant) continue;
+    invariant[node] = true;
+    invariant_nodes.push_back(node);
+    for (int output : outputs[node]) {
+      if (candidates[output] && !invariant[output] && !to_check[output]) {
+        to_check[output] = true;
+        nodes_to_check.push_back(output);
+      }
+    }
+  }
+
+  // Hoist the invariant nodes other than the constants, which are cheap to
+  // run in the loop, and the constants that they use.
+  std::vector<bool> hoisted(num_nodes, false);
+  for (int node : invariant_nodes) {
+    hoisted[node] = !IsConstant(graph->node(node));
+  }
+  for (int node : invariant_nodes) {
+    if (!hoisted[node]) continue;
+    for (const string& input : graph->node(node).input()) {
+      const int producer = index[NodeName(input)];
+      if (invariant[producer] && IsConstant(graph->node(producer))) {
+        hoisted[producer] = true;
+      }
+    }
+  }
+  int num_hoisted = 0;
+  std::vector<std::set<string>> gates(num_nodes);
+  std::vector<bool> gates_done(num_nodes, false);
+  for (int node : invariant_nodes) {
+    if (!hoisted[node]) continue;
+    ++num_hoisted;
+    CollectGates(*graph, index, hoisted, node, &gates, &gates_done);
+  }
+  if (num_hoisted == 0) return 0;
+
+  // Feed the outputs of the hoisted nodes back into their loops, through a
+  // constant Enter node and, if the hoisted node dropped control inputs, an
+  // Identity node that depends on them.
+  std::unordered_set<string> new_names;
+  auto unique_name = [&index, &new_names](const string& name) {
+    string unique_name = name;
+    for (int i = 1; index.count(unique_name) || new_names.count(unique_name);
+         ++i) {
+      unique_name = strings::StrCat(name, "_", i);
+    }
+    new_names.insert(unique_name);
+    return unique_name;
+  };
+  std::map<std::pair<int, int>, string> feeds;
+  auto feed = [&](int node, int port) {
+    auto existing_feed = feeds.find(std::make_pair(node, port));
+    if (existing_feed != feeds.end()) return existing_feed->second;
+    const NodeDef& node_def = graph->node(node);
+    const Frame& frame = frames[node_frames[node]];
+    const DataType type = output_types[node][port];
+    const string name = port == 0 ? node_def.name()
+                                  : strings::StrCat(node_def.name(), "_", port);
+
+    NodeDef* enter = graph->add_node();
+    enter->set_name(
+        unique_name(AddPrefixToNodeName(name, "LoopOptimizer/Enter", "_")));
+    enter->set_op("Enter");
+    enter->set_device(node_def.device());
+    enter->add_input(port == 0 ? node_def.name()
+                               : strings::StrCat(node_def.name(), ":", port));
+    auto* attr = enter->mutable_attr();
+    (*attr)["T"].set_type(type);
+    (*attr)["frame_name"].set_s(frame.name);
+    (*attr)["is_constant"].set_b(true);
+    const auto& frame_enter_attr = graph->node(frame.enter).attr();
+    auto parallel_iterations = frame_enter_attr.find("parallel_iterations");
+    if (parallel_iterations != frame_enter_attr.end()) {
+      (*attr)["parallel_iterations"] = parallel_iterations->second;
+    }
+    string fed = enter->name();
+
+    if (!gates[node].empty()) {
+      NodeDef* gate = graph->add_node();
+      gate->set_name(
+          unique_name(AddPrefixToNodeName(name, "LoopOptimizer/Gate", "_")));
+      gate->set_op("Identity");
+      gate->set_device(node_def.device());
+      gate->add_input(enter->name());
+      for (const string& control_input : gates[node]) {
+        gate->add_input(strings::StrCat("^", control_input));
+      }
+      (*gate->mutable_attr())["T"].set_type(type);
+      fed = gate->name();
+    }
+    feeds[std::make_pair(node, port)] = fed;
+    return fed;
+  };
+  for (int node = 0; node < num_nodes; ++node) {
+    if (hoisted[node]) continue;
+    NodeDef* node_def = graph->mutable_node(node);
+    for (int i = 0; i < node_def->input_size(); ++i) {
+      int port;
+      const string input = ParseNodeName(node_def->input(i), &port);
+      auto input_index = index.find(input);
+      if (input_index == index.end() || !hoisted[input_index->second]) {
+        continue;
+      }
+      if (port < 0) {
+        *node_def->mutable_input(i) =
+            strings::StrCat("^", feed(input_index->second, 0));
+      } else {
+        *node_def->mutable_input(i) = feed(input_index->second, port);
+      }
+    }
+  }
+
+  // Move the hoisted nodes to the enclosing frames, by replacing their
+  // constant Enter inputs with the inputs of these Enter nodes (which were
+  // updated above if they were hoisted themselves) and dropping the gates.
+  for (int node = 0; node < num_nodes; ++node) {
+    if (!hoisted[node]) continue;
+    NodeDef* node_def = graph->mutable_node(node);
+    std::vector<string> inputs;
+    std::vector<string> control_inputs;
+    std::set<string> control_input_set;
+    auto add_control_input = [&](const string& name) {
+      if (control_input_set.insert(name).second) {
+        control_inputs.push_back(strings::StrCat("^", name));
+      }
+    };
+    for (const string& input : node_def->input()) {
+      const int producer = index[NodeName(input)];
+      const NodeDef& producer_def = graph->node(producer);
+      if (IsConstantEnter(producer_def)) {
+        if (IsControlInput(input)) {
+          add_control_input(NodeName(producer_def.input(0)));
+        } else {
+          inputs.push_back(producer_def.input(0));
+        }
+      } else if (hoisted[producer]) {
+        if (IsControlInput(input)) {
+          add_control_input(producer_def.name());
+        } else {
+          inputs.push_back(input);
+        }
+      }
+    }
+    // A node without inputs would run in the root frame: anchor it in the
+    // enclosing frame on the input of one of the Enter nodes of the loop.
+    const Frame& frame = frames[node_frames[node]];
+    if (inputs.empty() && control_inputs.empty() && frame.parent > 0) {
+      add_control_input(NodeName(graph->node(frame.enter).input(0)));
+    }
+    node_def->clear_input();
+    for (const string& input : inputs) {
+      node_def->add_input(input);
+    }
+    for (const string& input : control_inputs) {
+      node_def->add_input(input);
+    }
+  }
+
+  // Remove the constant Enter nodes that are no longer used.
+  std::unordered_set<string> used;
+  for (const NodeDef& node : graph->node()) {
+    for (const string& input : node.input()) {
+      used.insert(NodeName(input));
+    }
+  }
+  std::unordered_set<string> unused_enters;
+  for (int node = 0; node < num_nodes; ++node) {
+    const NodeDef& node_def = graph->node(node);
+    if (IsConstantEnter(node_def) && !used.count(node_def.name()) &&
+        !nodes_to_preserve_.count(node_def.name())) {
+      unused_enters.insert(node_def.name());
+    }
+  }
+  RemoveNodes(unused_enters, graph);
+
+  VLOG(2) << "Hoisted " << num_hoisted << " nodes out of " << frames.size() - 1
+          << " frames.";
+  return num_hoisted;
+}
+
+Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                               GraphDef* output) {
+  *output = item.graph;
+  nodes_to_preserve_.clear();
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve_.insert(NodeName(feed.first));
+  }
+  shape_checked_nodes_.clear();
+  GraphProperties properties(item);
+  if (properties.InferStatically().ok()) {
+    for (const NodeDef& node : item.graph.node()) {
+      if (FailsOnlyOnShapeMismatch(node) &&
+          HasFullyDefinedShapes(properties, node)) {
+        shape_checked_nodes_.insert(node.name());
+      }
+    }
+  }
+
+  // Each pass moves the invariant nodes out of one level of nested loops.
+  int num_hoisted = 0;
+  for (int hoisted = HoistLoopInvariants(output); hoisted > 0;
+       hoisted = HoistLoopInvariants(output)) {
+    num_hoisted += hoisted;
+  }
+  VLOG(1) << "Hoisted " << num_hoisted << " loop invariant nodes.";
+  return Status::OK();
+}
+
+void LoopOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                             const GraphDef& optimize_output, double result) {
+  // Nothing to do for LoopOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
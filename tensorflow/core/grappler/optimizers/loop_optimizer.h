@@ -0,0 +1,74 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_LOOP_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_LOOP_OPTIMIZER_H_
+
+#include <unordered_set>
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Hoist the loop invariant computations out of the while loops: the stateless
+// nodes of a frame whose inputs are all constant Enter nodes (the tensors that
+// a while loop captures from its enclosing frame) or other loop invariant
+// nodes are moved to the enclosing frame, and their outputs fed back into the
+// loop through new constant Enter nodes. They then run once per
+// execution of the loop instead of once per iteration.
+//
+// Since a hoisted node also runs when the loop runs no iteration, only the
+// nodes that can't fail are hoisted: the ops that never fail, and the ops that
+// only fail on mismatched shapes when the static shape inference has checked
+// all their shapes.
+//
+// The constants of a loop body only depend on the loop through control
+// dependencies, e.g. on the pivot of the body, which make them run in the
+// frame. They are hoisted with their consumers, and the values fed back into
+// the loop then go through an Identity with the same control dependencies, so
+// that the nodes of the loop still run after them and are still dead when
+// they are.
+class LoopOptimizer : public GraphOptimizer {
+ public:
+  LoopOptimizer() {}
+  ~LoopOptimizer() override {}
+
+  string name() const override { return "loop_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  // Returns true iff node can be hoisted if its inputs are loop invariant,
+  // and sets output_types to the types of its outputs.
+  bool CanHoist(const NodeDef& node, DataTypeVector* output_types) const;
+  // Moves the loop invariant nodes of each frame to its enclosing frame.
+  // Returns the number of nodes moved.
+  int HoistLoopInvariants(GraphDef* graph) const;
+
+  std::unordered_set<string> nodes_to_preserve_;
+  // The nodes that only fail on mismatched shapes and whose shapes were
+  // checked by the static shape inference.
+  std::unordered_set<string> shape_checked_nodes_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_LOOP_OPTIMIZER_H_
@@ -0,0 +1,314 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class LoopOptimizerTest : public ::testing::Test {
+ protected:
+  NodeDef* AddNode(const string& name, const string& op,
+                   const std::vector<string>& inputs, GraphDef* graph) {
+    NodeDef* node = graph->add_node();
+    node->set_name(name);
+    node->set_op(op);
+    for (const string& input : inputs) {
+      node->add_input(input);
+    }
+    (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+    return node;
+  }
+
+  // Adds a constant holding a 2x2 tensor of zeros.
+  NodeDef* AddConst(const string& name, DataType type,
+                    const std::vector<string>& inputs, GraphDef* graph) {
+    NodeDef* node = AddNode(name, "Const", inputs, graph);
+    node->mutable_attr()->erase("T");
+    (*node->mutable_attr())["dtype"].set_type(type);
+    TensorProto* value = (*node->mutable_attr())["value"].mutable_tensor();
+    value->set_dtype(type);
+    value->mutable_tensor_shape()->add_dim()->set_size(2);
+    value->mutable_tensor_shape()->add_dim()->set_size(2);
+    return node;
+  }
+
+  // Adds an int32 vector constant.
+  NodeDef* AddIntConst(const string& name, const std::vector<int>& values,
+                       const std::vector<string>& inputs, GraphDef* graph) {
+    NodeDef* node = AddConst(name, DT_INT32, inputs, graph);
+    TensorProto* value = node->mutable_attr()->at("value").mutable_tensor();
+    value->mutable_tensor_shape()->clear_dim();
+    value->mutable_tensor_shape()->add_dim()->set_size(values.size());
+    for (int v : values) {
+      value->add_int_val(v);
+    }
+    return node;
+  }
+
+  NodeDef* AddEnter(const string& name, const string& input,
+                    const string& frame, bool is_constant, GraphDef* graph) {
+    NodeDef* node = AddNode(name, "Enter", {input}, graph);
+    (*node->mutable_attr())["frame_name"].set_s(frame);
+    (*node->mutable_attr())["is_constant"].set_b(is_constant);
+    (*node->mutable_attr())["parallel_iterations"].set_i(10);
+    return node;
+  }
+
+  // Adds a while loop named frame over the float tensor init, whose body
+  // computes body_output. Returns the name of the pivot of the body.
+  string AddLoop(const string& frame, const string& init,
+                 const string& body_output, GraphDef* graph) {
+    AddEnter(frame + "/Enter", init, frame, false, graph);
+    NodeDef* merge = AddNode(frame + "/Merge", "Merge",
+                             {frame + "/Enter", frame + "/NextIteration"},
+                             graph);
+    (*merge->mutable_attr())["N"].set_i(2);
+    AddConst(frame + "/limit", DT_FLOAT, {"^" + frame + "/Merge"}, graph);
+    AddNode(frame + "/Less", "Less", {frame + "/Merge", frame + "/limit"},
+            graph);
+    AddNode(frame + "/LoopCond", "LoopCond", {frame + "/Less"}, graph)
+        ->clear_attr();
+    AddNode(frame + "/Switch", "Switch",
+            {frame + "/Merge", frame + "/LoopCond"}, graph);
+    AddNode(frame + "/Identity", "Identity", {frame + "/Switch:1"}, graph);
+    AddNode(frame + "/NextIteration", "NextIteration", {body_output}, graph);
+    AddNode(frame + "/Exit", "Exit", {frame + "/Switch"}, graph);
+    return frame + "/Identity";
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  std::vector<string> Inputs(const NodeDef& node) {
+    return std::vector<string>(node.input().begin(), node.input().end());
+  }
+};
+
+TEST_F(LoopOptimizerTest, HoistsInvariantNodes) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddConst("x", DT_FLOAT, {}, graph);
+  AddConst("w", DT_FLOAT, {}, graph);
+  const string pivot = AddLoop("while", "x", "while/MatMul", graph);
+  AddEnter("while/Enter_w", "w", "while", true, graph);
+  AddIntConst("while/shape", {2, 2}, {"^" + pivot}, graph);
+  NodeDef* reshape = AddNode("while/Reshape", "Reshape",
+                             {"while/Enter_w", "while/shape"}, graph);
+  (*reshape->mutable_attr())["Tshape"].set_type(DT_INT32);
+  AddNode("while/MatMul", "MatMul", {pivot, "while/Reshape"}, graph);
+  item.fetch.push_back("while/Exit");
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The reshape and the constant it uses run outside of the loop.
+  const NodeDef* hoisted = FindNode(output, "while/Reshape");
+  ASSERT_NE(nullptr, hoisted);
+  EXPECT_EQ(std::vector<string>({"w", "while/shape"}), Inputs(*hoisted));
+  const NodeDef* shape = FindNode(output, "while/shape");
+  ASSERT_NE(nullptr, shape);
+  EXPECT_EQ(0, shape->input_size());
+  EXPECT_EQ(nullptr, FindNode(output, "while/Enter_w"));
+
+  // It is fed back into the loop through a constant Enter node, gated on the
+  // pivot that the constant depended on.
+  const NodeDef* enter = FindNode(output, "LoopOptimizer/Enter_while/Reshape");
+  ASSERT_NE(nullptr, enter);
+  EXPECT_EQ("Enter", enter->op());
+  EXPECT_EQ(std::vector<string>({"while/Reshape"}), Inputs(*enter));
+  EXPECT_EQ("while", enter->attr().at("frame_name").s());
+  EXPECT_TRUE(enter->attr().at("is_constant").b());
+  EXPECT_EQ(10, enter->attr().at("parallel_iterations").i());
+  EXPECT_EQ(DT_FLOAT, enter->attr().at("T").type());
+  const NodeDef* gate = FindNode(output, "LoopOptimizer/Gate_while/Reshape");
+  ASSERT_NE(nullptr, gate);
+  EXPECT_EQ("Identity", gate->op());
+  EXPECT_EQ(std::vector<string>(
+                {"LoopOptimizer/Enter_while/Reshape", "^while/Identity"}),
+            Inputs(*gate));
+  const NodeDef* matmul = FindNode(output, "while/MatMul");
+  ASSERT_NE(nullptr, matmul);
+  EXPECT_EQ(std::vector<string>(
+                {"while/Identity", "LoopOptimizer/Gate_while/Reshape"}),
+            Inputs(*matmul));
+}
+
+TEST_F(LoopOptimizerTest, HoistsWithoutGateWhenNoControlInputs) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddConst("x", DT_FLOAT, {}, graph);
+  AddConst("w", DT_FLOAT, {}, graph);
+  AddConst("b", DT_FLOAT, {}, graph);
+  const string pivot = AddLoop("while", "x", "while/Add", graph);
+  AddEnter("while/Enter_w", "w", "while", true, graph);
+  AddEnter("while/Enter_b", "b", "while", true, graph);
+  AddNode("while/Mul", "Mul", {"while/Enter_w", "while/Enter_b"}, graph);
+  AddNode("while/Square", "Square", {"while/Mul"}, graph);
+  AddNode("while/Add", "Add", {pivot, "while/Square", "^while/Mul"}, graph);
+  item.fetch.push_back("while/Exit");
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* mul = FindNode(output, "while/Mul");
+  ASSERT_NE(nullptr, mul);
+  EXPECT_EQ(std::vector<string>({"w", "b"}), Inputs(*mul));
+  const NodeDef* square = FindNode(output, "while/Square");
+  ASSERT_NE(nullptr, square);
+  EXPECT_EQ(std::vector<string>({"while/Mul"}), Inputs(*square));
+  EXPECT_EQ(nullptr, FindNode(output, "LoopOptimizer/Gate_while/Square"));
+  const NodeDef* add = FindNode(output, "while/Add");
+  ASSERT_NE(nullptr, add);
+  EXPECT_EQ(std::vector<string>({"while/Identity",
+                                 "LoopOptimizer/Enter_while/Square",
+                                 "^LoopOptimizer/Enter_while/Mul"}),
+            Inputs(*add));
+}
+
+TEST_F(LoopOptimizerTest, KeepsLoopVariantNodes) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddConst("x", DT_FLOAT, {}, graph);
+  AddConst("w", DT_FLOAT, {}, graph);
+  AddIntConst("shape", {2, 2}, {}, graph);
+  const string pivot = AddLoop("while", "x", "while/Add", graph);
+  AddEnter("while/Enter_w", "w", "while", true, graph);
+  NodeDef* enter_shape =
+      AddEnter("while/Enter_shape", "shape", "while", true, graph);
+  (*enter_shape->mutable_attr())["T"].set_type(DT_INT32);
+  // Depends on the loop variable.
+  AddNode("while/Mul", "Mul", {pivot, "while/Enter_w"}, graph);
+  // Stateful.
+  NodeDef* random = AddNode("while/RandomUniform", "RandomUniform",
+                            {"while/Enter_shape"}, graph);
+  (*random->mutable_attr())["T"].set_type(DT_INT32);
+  (*random->mutable_attr())["dtype"].set_type(DT_FLOAT);
+  // Depends on a non constant Enter node.
+  AddEnter("while/Enter_v", "w", "while", false, graph);
+  AddNode("while/Neg", "Neg", {"while/Enter_v"}, graph);
+  // Fetched.
+  AddNode("while/Square", "Square", {"while/Enter_w"}, graph);
+  NodeDef* add = AddNode(
+      "while/Add", "AddN",
+      {"while/Mul", "while/RandomUniform", "while/Neg", "while/Square"}, graph);
+  (*add->mutable_attr())["N"].set_i(4);
+  item.fetch = {"while/Exit", "while/Square"};
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    EXPECT_EQ(item.graph.node(i).DebugString(), output.node(i).DebugString());
+  }
+}
+
+TEST_F(LoopOptimizerTest, KeepsNodesThatCanFail) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddConst("x", DT_FLOAT, {}, graph);
+  AddConst("w", DT_FLOAT, {}, graph);
+  NodeDef* shape = AddNode("shape", "Placeholder", {}, graph);
+  shape->clear_attr();
+  (*shape->mutable_attr())["dtype"].set_type(DT_INT32);
+  const string pivot = AddLoop("while", "x", "while/Add", graph);
+  AddEnter("while/Enter_w", "w", "while", true, graph);
+  NodeDef* enter_shape =
+      AddEnter("while/Enter_shape", "shape", "while", true, graph);
+  (*enter_shape->mutable_attr())["T"].set_type(DT_INT32);
+  // Fails on some values of its input.
+  NodeDef* check = AddNode("while/CheckNumerics", "CheckNumerics",
+                           {"while/Enter_w"}, graph);
+  (*check->mutable_attr())["message"].set_s("w");
+  // Its shape input isn't known statically.
+  NodeDef* reshape = AddNode("while/Reshape", "Reshape",
+                             {"while/Enter_w", "while/Enter_shape"}, graph);
+  (*reshape->mutable_attr())["Tshape"].set_type(DT_INT32);
+  NodeDef* add =
+      AddNode("while/Add", "AddN",
+              {pivot, "while/CheckNumerics", "while/Reshape"}, graph);
+  (*add->mutable_attr())["N"].set_i(3);
+  item.fetch.push_back("while/Exit");
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    EXPECT_EQ(item.graph.node(i).DebugString(), output.node(i).DebugString());
+  }
+}
+
+TEST_F(LoopOptimizerTest, HoistsOutOfNestedLoops) {
+  GrapplerItem item;
+  GraphDef* graph = &item.graph;
+  AddConst("x", DT_FLOAT, {}, graph);
+  AddConst("w", DT_FLOAT, {}, graph);
+  const string outer_pivot = AddLoop("outer", "x", "inner/Exit", graph);
+  const string inner_pivot =
+      AddLoop("inner", outer_pivot, "inner/MatMul", graph);
+  AddEnter("outer/Enter_w", "w", "outer", true, graph);
+  AddEnter("inner/Enter_w", "outer/Enter_w", "inner", true, graph);
+  AddNode("inner/Square", "Square", {"inner/Enter_w"}, graph);
+  AddNode("inner/MatMul", "MatMul", {inner_pivot, "inner/Square"}, graph);
+  item.fetch.push_back("outer/Exit");
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The square runs once, and is fed to the inner loop through both frames.
+  const NodeDef* square = FindNode(output, "inner/Square");
+  ASSERT_NE(nullptr, square);
+  EXPECT_EQ(std::vector<string>({"w"}), Inputs(*square));
+  EXPECT_EQ(nullptr, FindNode(output, "outer/Enter_w"));
+  EXPECT_EQ(nullptr, FindNode(output, "inner/Enter_w"));
+  const NodeDef* outer_enter =
+      FindNode(output, "LoopOptimizer/Enter_inner/Square_1");
+  ASSERT_NE(nullptr, outer_enter);
+  EXPECT_EQ("outer", outer_enter->attr().at("frame_name").s());
+  EXPECT_EQ(std::vector<string>({"inner/Square"}), Inputs(*outer_enter));
+  const NodeDef* inner_enter =
+      FindNode(output, "LoopOptimizer/Enter_inner/Square");
+  ASSERT_NE(nullptr, inner_enter);
+  EXPECT_EQ("inner", inner_enter->attr().at("frame_name").s());
+  EXPECT_EQ(std::vector<string>({"LoopOptimizer/Enter_inner/Square_1"}),
+            Inputs(*inner_enter));
+  const NodeDef* matmul = FindNode(output, "inner/MatMul");
+  ASSERT_NE(nullptr, matmul);
+  EXPECT_EQ(std::vector<string>(
+                {"inner/Identity", "LoopOptimizer/Enter_inner/Square"}),
+            Inputs(*matmul));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
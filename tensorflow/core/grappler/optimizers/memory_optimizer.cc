@@ -15,16 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_rewriter.h"
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -122,6 +125,11 @@ static int64 EstimateSize(const OpInfo::TensorProperties& t) {
   return num_elems * size;
 }
 
+// Let's assume we're going to swap over PCIe running at 16 GBps.
+static Costs::NanoSeconds EstimateSwapTime(int64 bytes_to_swap) {
+  return Costs::NanoSeconds(bytes_to_swap / 16);
+}
+
 struct SwapInfo {
   std::vector<int> inputs_to_swap;
   Costs::NanoSeconds time_to_swap = 0;
@@ -201,6 +209,193 @@ static const NodeDef* FindSwapTrigger(
   return nullptr;
 }
 
+// Returns true if the node may run on a GPU, ie unless it is explicitly placed
+// on another type of device.
+static bool MayRunOnGPU(const NodeDef& node) {
+  if (node.device().empty()) {
+    return true;
+  }
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(node.device(), &parsed) ||
+      !parsed.has_type) {
+    return true;
+  }
+  return parsed.type == "GPU" || parsed.type == "gpu";
+}
+
+struct SwapCandidate {
+  NodeDef* node;
+  int input_id;
+  int64 bytes;
+  // Time during which the tensor is held without being used.
+  Costs::NanoSeconds idle_time;
+};
+
+// Picks the tensors to swap out when the graph is not expected to fit in the
+// memory of the GPU. The candidates are the inputs of a node that are the
+// last use of their tensor, and that have been produced or used long before
+// the other inputs of the node are ready: the tensor can then be swapped out
+// after its previous use, and swapped back in while the other inputs are
+// being computed. The candidates that stay idle for the longest time are
+// swapped first, until enough memory is expected to be freed.
+static Status IdentifySwappingCandidates(
+    Cluster* cluster, const GrapplerItem& item, GraphProperties* properties,
+    const std::unordered_map<const NodeDef*, Costs::NanoSeconds>&
+        execution_times,
+    GraphDef* optimized_graph,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  if (cluster == nullptr) {
+    return Status::OK();
+  }
+  int64 device_memory = -1;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& props = device.second;
+    if (props.type() == "GPU" && props.memory_size() > 0 &&
+        (device_memory < 0 || props.memory_size() < device_memory)) {
+      device_memory = props.memory_size();
+    }
+  }
+  if (device_memory < 0) {
+    // Nothing to swap from.
+    return Status::OK();
+  }
+  GraphMemory memory(item);
+  TF_RETURN_IF_ERROR(memory.InferFromGraphProperties(properties));
+  const int64 peak_memory = memory.GetWorstCaseMemoryUsage();
+  if (peak_memory <= device_memory) {
+    return Status::OK();
+  }
+  const int64 bytes_to_free = peak_memory - device_memory;
+
+  std::unordered_map<string, Costs::NanoSeconds> times;
+  for (const auto& it : execution_times) {
+    times[it.first->name()] = it.second;
+  }
+
+  // Find the uses of every tensor.
+  std::unordered_map<string, std::vector<std::pair<NodeDef*, int>>> uses;
+  for (auto& node : *optimized_graph->mutable_node()) {
+    for (int i = 0; i < node.input_size(); ++i) {
+      if (IsControlInput(node.input(i))) {
+        continue;
+      }
+      int position;
+      const string input_node = ParseNodeName(node.input(i), &position);
+      uses[strings::StrCat(input_node, ":", position)].emplace_back(&node, i);
+    }
+  }
+
+  std::vector<SwapCandidate> candidates;
+  NodeMap node_map(optimized_graph);
+  for (const auto& tensor : uses) {
+    int position;
+    const string producer_name = ParseNodeName(tensor.first, &position);
+    const NodeDef* producer = node_map.GetNode(producer_name);
+    if (producer == nullptr || times.count(producer_name) == 0 ||
+        producer->op() == "Const" || !MayRunOnGPU(*producer)) {
+      continue;
+    }
+
+    // The last use of the tensor, and the time of the use before it.
+    NodeDef* last_use = nullptr;
+    int last_input_id = -1;
+    Costs::NanoSeconds last_use_time = 0;
+    Costs::NanoSeconds previous_use_time = times[producer_name];
+    for (const auto& use : tensor.second) {
+      auto it = times.find(use.first->name());
+      if (it == times.end()) {
+        last_use = nullptr;
+        break;
+      }
+      if (last_use == nullptr || it->second > last_use_time) {
+        if (last_use != nullptr) {
+          previous_use_time = std::max(previous_use_time, last_use_time);
+        }
+        last_use = use.first;
+        last_input_id = use.second;
+        last_use_time = it->second;
+      } else {
+        previous_use_time = std::max(previous_use_time, it->second);
+      }
+    }
+    if (last_use == nullptr || !MayRunOnGPU(*last_use) ||
+        last_use->op() == "Merge" || last_use->op() == "Switch" ||
+        last_use->op() == "NextIteration") {
+      continue;
+    }
+
+    // The swap in is triggered by the other inputs of the node, so it can
+    // only overlap with their computation.
+    bool has_other_inputs = false;
+    Costs::NanoSeconds other_inputs_ready_time = 0;
+    for (int i = 0; i < last_use->input_size(); ++i) {
+      const string input_node = NodeName(last_use->input(i));
+      if (input_node == producer_name) {
+        continue;
+      }
+      auto it = times.find(input_node);
+      if (it == times.end()) {
+        continue;
+      }
+      has_other_inputs = true;
+      other_inputs_ready_time = std::max(other_inputs_ready_time, it->second);
+    }
+    if (!has_other_inputs) {
+      continue;
+    }
+
+    const std::vector<OpInfo::TensorProperties> props =
+        properties->GetOutputProperties(producer_name);
+    if (position >= static_cast<int>(props.size()) ||
+        IsRefType(props[position].dtype())) {
+      continue;
+    }
+    const int64 bytes = EstimateSize(props[position]);
+    const Costs::NanoSeconds idle_time =
+        other_inputs_ready_time - previous_use_time;
+    // The tensor has to be swapped out and back in while it is idle.
+    if (idle_time <= 2 * EstimateSwapTime(bytes)) {
+      continue;
+    }
+    candidates.push_back({last_use, last_input_id, bytes, idle_time});
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const SwapCandidate& a, const SwapCandidate& b) {
+              if (a.idle_time != b.idle_time) {
+                return a.idle_time > b.idle_time;
+              }
+              return a.bytes > b.bytes;
+            });
+
+  int64 bytes_freed = 0;
+  for (const SwapCandidate& candidate : candidates) {
+    if (bytes_freed >= bytes_to_free) {
+      break;
+    }
+    std::vector<int> inputs;
+    auto it = nodes_to_swap->find(candidate.node);
+    if (it != nodes_to_swap->end()) {
+      inputs = it->second.inputs_to_swap;
+    }
+    if (std::find(inputs.begin(), inputs.end(), candidate.input_id) !=
+        inputs.end()) {
+      continue;
+    }
+    // Keep at least one input to trigger the swap in.
+    if (static_cast<int>(inputs.size()) + 1 >= candidate.node->input_size()) {
+      continue;
+    }
+    VLOG(1) << "Swapping input " << candidate.input_id << " of "
+            << candidate.node->name() << " (" << candidate.bytes
+            << " bytes, idle for " << candidate.idle_time.count() << "ns)";
+    (*nodes_to_swap)[candidate.node].inputs_to_swap.push_back(
+        candidate.input_id);
+    bytes_freed += candidate.bytes;
+  }
+  return Status::OK();
+}
+
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                  GraphDef* optimized_graph) {
   *optimized_graph = item.graph;
@@ -221,34 +416,40 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
     }
   }
-  if (nodes_to_swap.empty()) {
+  const bool use_heuristics =
+      optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS;
+  if (nodes_to_swap.empty() && !use_heuristics) {
     // Nothing to do.
     return Status::OK();
   }
 
-  {
-    // Estimate the size of the data to swap for each node.
-    GraphProperties properties(item);
-    TF_RETURN_IF_ERROR(properties.InferStatically());
-    for (auto& swap : nodes_to_swap) {
-      const NodeDef* node = swap.first;
-      std::vector<OpInfo::TensorProperties> props =
-          properties.GetInputProperties(node->name());
-      SwapInfo& swap_info = swap.second;
-      int64 bytes_to_swap = 0;
-      for (int64 input_id : swap_info.inputs_to_swap) {
-        const OpInfo::TensorProperties& t = props[input_id];
-        bytes_to_swap += EstimateSize(t);
-      }
-      // Let's assume we're going to swap over PCIe running at 16 GBps.
-      swap_info.time_to_swap = bytes_to_swap / 16;
-    }
-  }
-
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically());
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
   TF_RETURN_IF_ERROR(
       EstimateEarliestExecutionTimes(item, cluster, &execution_times));
 
+  if (use_heuristics) {
+    TF_RETURN_IF_ERROR(IdentifySwappingCandidates(cluster, item, &properties,
+                                                  execution_times,
+                                                  optimized_graph,
+                                                  &nodes_to_swap));
+  }
+
+  // Estimate the size of the data to swap for each node.
+  for (auto& swap : nodes_to_swap) {
+    const NodeDef* node = swap.first;
+    std::vector<OpInfo::TensorProperties> props =
+        properties.GetInputProperties(node->name());
+    SwapInfo& swap_info = swap.second;
+    int64 bytes_to_swap = 0;
+    for (int64 input_id : swap_info.inputs_to_swap) {
+      const OpInfo::TensorProperties& t = props[input_id];
+      bytes_to_swap += EstimateSize(t);
+    }
+    swap_info.time_to_swap = EstimateSwapTime(bytes_to_swap);
+  }
+
   std::unordered_map<string, const NodeDef*> name_map;
   for (const auto& node : item.graph.node()) {
     name_map[node.name()] = &node;
@@ -19,14 +19,23 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
 namespace grappler {
 
 // Swap tensors in and out of device memory.
+//
+// The tensors marked with the "_swap_to_host" attribute are always swapped.
+// With SWAPPING_HEURISTICS, the optimizer also picks the tensors to swap
+// itself when the graph does not fit in the memory of the GPU: it swaps out
+// the tensors that stay unused for the longest time between two of their
+// uses, and swaps them back in early enough to overlap the copy with the
+// computation that precedes their last use.
 class MemoryOptimizer : public GraphOptimizer {
  public:
-  MemoryOptimizer() {}
+  explicit MemoryOptimizer(RewriterConfig::MemOptType optimization_level)
+      : optimization_level_(optimization_level) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -36,6 +45,9 @@ class MemoryOptimizer : public GraphOptimizer {
 
   void Feedback(Cluster* cluster, const GrapplerItem& item,
                 const GraphDef& pruned_graph, double result) override;
+
+ private:
+  RewriterConfig::MemOptType optimization_level_;
 };
 
 // Helper function to recompute a sub-graph (recomputed_source_nodes) on a
@@ -127,6 +127,35 @@ class MemoryOptimizerTest : public ::testing::Test {
     devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
     return VirtualCluster(devices);
   }
+
+  static VirtualCluster CreateVirtualGPUCluster(int64 memory_size) {
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_frequency(1000);
+    gpu_device.set_num_cores(24);
+    // 1 GBps, ie 1 byte per nanosecond, to keep the estimates simple.
+    gpu_device.set_bandwidth(1000000);
+    gpu_device.set_memory_size(memory_size);
+    (*gpu_device.mutable_environment())["architecture"] = "6";
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/gpu:0"] = gpu_device;
+    return VirtualCluster(devices);
+  }
+
+  // A forward pass a -> b -> c -> d -> e, followed by f that uses b again.
+  static void BuildLongLiveRangeGraph(GrapplerItem* item) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+        "/job:localhost/replica:0/task:0/gpu:0");
+    // 256KB tensors.
+    Output a = ops::Placeholder(s.WithOpName("a"), DT_FLOAT,
+                                ops::Placeholder::Shape({256, 256}));
+    Output b = ops::AddN(s.WithOpName("b"), {a});
+    Output c = ops::AddN(s.WithOpName("c"), {b});
+    Output d = ops::AddN(s.WithOpName("d"), {c});
+    Output e = ops::AddN(s.WithOpName("e"), {d});
+    Output f = ops::AddN(s.WithOpName("f"), {b, e});
+    TF_CHECK_OK(s.ToGraphDef(&item->graph));
+  }
 };
 
 TEST_F(MemoryOptimizerTest, SimpleSwapping) {
@@ -150,7 +179,7 @@ TEST_F(MemoryOptimizerTest, SimpleSwapping) {
 
   VirtualCluster cluster(CreateVirtualCluster());
 
-  MemoryOptimizer optimizer;
+  MemoryOptimizer optimizer(RewriterConfig::MANUAL);
   GraphDef output;
   Status status = optimizer.Optimize(&cluster, item, &output);
   TF_EXPECT_OK(status);
@@ -174,6 +203,50 @@ TEST_F(MemoryOptimizerTest, SimpleSwapping) {
   EXPECT_EQ("^c", swap_in.input(1));
 }
 
+TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
+  GrapplerItem item;
+  BuildLongLiveRangeGraph(&item);
+  EXPECT_EQ(6, item.graph.node_size());
+
+  // The 6 tensors of 256KB don't fit in 1MB.
+  VirtualCluster cluster(CreateVirtualGPUCluster(1 << 20));
+
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  // Only b is unused for long enough to be swapped, between c and f.
+  EXPECT_EQ(8, output.node_size());
+  const NodeDef& new_f = output.node(5);
+  EXPECT_EQ("f", new_f.name());
+  EXPECT_EQ(2, new_f.input_size());
+  EXPECT_EQ("swap_in_f_0", new_f.input(0));
+  EXPECT_EQ("e", new_f.input(1));
+
+  const NodeDef& swap_out = output.node(6);
+  EXPECT_EQ("swap_out_f_0", swap_out.name());
+  EXPECT_EQ("b", swap_out.input(0));
+
+  // The swap in overlaps with the computation of e.
+  const NodeDef& swap_in = output.node(7);
+  EXPECT_EQ("swap_in_f_0", swap_in.name());
+  EXPECT_EQ(2, swap_in.input_size());
+  EXPECT_EQ("swap_out_f_0", swap_in.input(0));
+  EXPECT_EQ("^d", swap_in.input(1));
+}
+
+TEST_F(MemoryOptimizerTest, SwappingHeuristicsGraphFits) {
+  GrapplerItem item;
+  BuildLongLiveRangeGraph(&item);
+
+  VirtualCluster cluster(CreateVirtualGPUCluster(1LL << 30));
+
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+  EXPECT_EQ(6, output.node_size());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
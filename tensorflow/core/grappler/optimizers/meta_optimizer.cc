@@ -15,14 +15,25 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/cost_based_placer.h"
+#include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/inference_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimizer_fusion.h"
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/core/grappler/optimizers/scheduling_priorities.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -31,22 +42,49 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::NewOptimizer(
     const string& optimizer) {
   VLOG(1) << "Adding graph optimization pass: " << optimizer;
   std::unique_ptr<GraphOptimizer> graph_optimizer;
+  if (optimizer == "inference") {
+    graph_optimizer.reset(new InferenceOptimizer());
+  }
   if (optimizer == "pruning") {
     graph_optimizer.reset(new ModelPruner());
   }
   if (optimizer == "constfold") {
     graph_optimizer.reset(new ConstantFolding());
   }
+  if (optimizer == "arithmetic") {
+    graph_optimizer.reset(new ArithmeticOptimizer());
+  }
+  if (optimizer == "loop") {
+    graph_optimizer.reset(new LoopOptimizer());
+  }
+  if (optimizer == "dependency") {
+    graph_optimizer.reset(new DependencyOptimizer());
+  }
+  if (optimizer == "placement") {
+    graph_optimizer.reset(new CostBasedPlacer());
+  }
   if (optimizer == "layout") {
     graph_optimizer.reset(new LayoutOptimizer());
   }
   if (optimizer == "memory") {
-    graph_optimizer.reset(new MemoryOptimizer());
+    graph_optimizer.reset(new MemoryOptimizer(cfg_.memory_optimization()));
   }
   if (optimizer == "autoparallel") {
     graph_optimizer.reset(
         new AutoParallel(cfg_.auto_parallel().num_replicas()));
   }
+  if (optimizer == "optimizerfusion") {
+    graph_optimizer.reset(new OptimizerFusion());
+  }
+  if (optimizer == "mixedprecision") {
+    graph_optimizer.reset(new AutoMixedPrecision());
+  }
+  if (optimizer == "remap") {
+    graph_optimizer.reset(new Remapper());
+  }
+  if (optimizer == "priorities") {
+    graph_optimizer.reset(new SchedulingPriorities());
+  }
   return graph_optimizer;
 }
 
@@ -54,6 +92,10 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   std::vector<std::unique_ptr<GraphOptimizer>> optimizers;
   if (cfg_.optimizers().empty()) {
+    if (cfg_.inference_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new InferenceOptimizer()));
+    }
     if (!cfg_.disable_model_pruning()) {
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(new ModelPruner()));
     }
@@ -61,21 +103,57 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       optimizers.push_back(
           std::unique_ptr<GraphOptimizer>(new ConstantFolding()));
     }
+    if (cfg_.arithmetic_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new ArithmeticOptimizer()));
+    }
+    if (cfg_.loop_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new LoopOptimizer()));
+    }
+    if (cfg_.dependency_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new DependencyOptimizer()));
+    }
+    // The layout, precision and remapping depend on the placement.
+    if (cfg_.cost_based_placement()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new CostBasedPlacer()));
+    }
     if (cfg_.optimize_tensor_layout()) {
       optimizers.push_back(
           std::unique_ptr<GraphOptimizer>(new LayoutOptimizer()));
     }
-    if (cfg_.memory_optimization() > 0) {
+    if (cfg_.auto_mixed_precision()) {
       optimizers.push_back(
-          std::unique_ptr<GraphOptimizer>(new MemoryOptimizer()));
+          std::unique_ptr<GraphOptimizer>(new AutoMixedPrecision()));
+    }
+    if (cfg_.remapping()) {
+      optimizers.push_back(std::unique_ptr<GraphOptimizer>(new Remapper()));
+    }
+    if (cfg_.memory_optimization() > 0) {
+      optimizers.push_back(std::unique_ptr<GraphOptimizer>(
+          new MemoryOptimizer(cfg_.memory_optimization())));
     }
     if (cfg_.auto_parallel().enable()) {
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
           new AutoParallel(cfg_.auto_parallel().num_replicas())));
     }
+    if (cfg_.optimizer_fusion()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new OptimizerFusion()));
+    }
+    // The priorities are estimated on the final graph.
+    if (cfg_.scheduling_priorities()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new SchedulingPriorities()));
+    }
   } else {
-    std::set<string> available_optimizers = {"pruning", "constfold", "layout",
-                                             "memory", "autoparallel"};
+    std::set<string> available_optimizers = {
+        "pruning", "constfold", "arithmetic",   "dependency",
+        "layout",  "memory",    "autoparallel", "optimizerfusion",
+        "remap",   "priorities", "loop",         "mixedprecision",
+        "inference", "placement"};
     for (const auto& optimizer : cfg_.optimizers()) {
       if (available_optimizers.find(optimizer) != available_optimizers.end()) {
         optimizers.push_back(NewOptimizer(optimizer));
@@ -88,17 +166,28 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     return Status::OK();
   }
 
-  bool already_optimized = false;
-  for (const auto& optimizer : optimizers) {
-    if (!already_optimized) {
-      TF_RETURN_IF_ERROR(optimizer->Optimize(cluster, item, optimized_graph));
-      already_optimized = true;
+  // The cost models of the optimizers take their calibration from the item.
+  GrapplerItem optimized_item = item;
+  if (!cfg_.op_cost_calibration_file().empty()) {
+    std::unique_ptr<OpCostCalibration> calibration(new OpCostCalibration);
+    Status status = ReadOpCostCalibration(cfg_.op_cost_calibration_file(),
+                                          calibration.get());
+    if (status.ok()) {
+      VLOG(1) << "Read " << calibration->entries_size()
+              << " op cost calibration entries from "
+              << cfg_.op_cost_calibration_file();
+      optimized_item.op_cost_calibration = std::move(calibration);
     } else {
-      GrapplerItem optimized_item = item;
+      LOG(WARNING) << "Failed to read the op cost calibration from "
+                   << cfg_.op_cost_calibration_file() << ": " << status;
+    }
+  }
+  for (int i = 0; i < optimizers.size(); ++i) {
+    if (i > 0) {
       optimized_item.graph = *optimized_graph;
-      TF_RETURN_IF_ERROR(
-          optimizer->Optimize(cluster, optimized_item, optimized_graph));
     }
+    TF_RETURN_IF_ERROR(
+        optimizers[i]->Optimize(cluster, optimized_item, optimized_graph));
   }
   TopologicalSort(optimized_graph);
   // Copy the graph version.
@@ -114,7 +203,12 @@ void MetaOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
 
 bool MetaOptimizerEnabled(const RewriterConfig& cfg) {
   return cfg.optimize_tensor_layout() || cfg.constant_folding() ||
-         cfg.auto_parallel().enable() || !cfg.optimizers().empty();
+         cfg.arithmetic_optimization() || cfg.dependency_optimization() ||
+         cfg.auto_parallel().enable() || cfg.optimizer_fusion() ||
+         cfg.remapping() || cfg.scheduling_priorities() ||
+         cfg.loop_optimization() || cfg.auto_mixed_precision() ||
+         cfg.inference_optimization() || cfg.cost_based_placement() ||
+         !cfg.optimizers().empty();
 }
 
 Status RunMetaOptimizer(const GrapplerItem& item, const RewriterConfig& cfg,
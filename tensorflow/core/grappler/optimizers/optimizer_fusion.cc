@@ -0,0 +1,308 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimizer_fusion.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// An op that can be fused, and how its inputs map to those of the fused op.
+// The inputs of the fused op are those of the op, with a list of N inputs in
+// place of each variable input.
+struct FusableOp {
+  string fused_op;
+  int num_inputs;
+  // The variable and slots inputs, which come first and are refs.
+  int num_ref_inputs;
+  // The inputs that differ by variable: the refs and the gradient.
+  std::set<int> variable_inputs;
+};
+
+const std::unordered_map<string, FusableOp>& FusableOps() {
+  static const auto* fusable_ops = new std::unordered_map<string, FusableOp>{
+      {"ApplyMomentum", {"MultiApplyMomentum", 5, 2, {0, 1, 3}}},
+      {"ApplyAdam", {"MultiApplyAdam", 10, 3, {0, 1, 2, 9}}},
+  };
+  return *fusable_ops;
+}
+
+// Returns true iff an output of node is a data input of another node.
+bool HasDataOutputs(const NodeDef& node, const NodeMap& node_map) {
+  for (const NodeDef* output : node_map.GetOutputs(node.name())) {
+    for (const string& input : output->input()) {
+      if (!IsControlInput(input) && NodeName(input) == node.name()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns the nodes of graph that are in nodes or depend on one of them.
+std::unordered_set<const NodeDef*> NodesDependingOn(
+    const GraphDef& graph, const NodeMap& node_map,
+    const std::unordered_set<const NodeDef*>& nodes) {
+  std::unordered_set<const NodeDef*> depending(nodes);
+  // Visit the inputs of the nodes before the nodes. The nodes of a cycle are
+  // visited once, as if the back edge was not there.
+  enum State { kVisiting, kVisited };
+  std::unordered_map<const NodeDef*, State> states;
+  for (const NodeDef& root : graph.node()) {
+    if (states.count(&root)) continue;
+    std::vector<const NodeDef*> stack = {&root};
+    while (!stack.empty()) {
+      const NodeDef* node = stack.back();
+      auto state = states.find(node);
+      if (state == states.end()) {
+        states[node] = kVisiting;
+        for (const string& input : node->input()) {
+          const NodeDef* input_node = node_map.GetNode(input);
+          if (input_node != nullptr && !states.count(input_node)) {
+            stack.push_back(input_node);
+          }
+        }
+        continue;
+      }
+      stack.pop_back();
+      if (state->second == kVisited) continue;
+      state->second = kVisited;
+      for (const string& input : node->input()) {
+        if (depending.count(node_map.GetNode(input))) {
+          depending.insert(node);
+          break;
+        }
+      }
+    }
+  }
+  return depending;
+}
+
+// Returns the key of the nodes that node can be fused with, or the empty string
+// if it cannot be fused: the nodes of the same op, device and attributes that
+// share the inputs that are not by variable, and whose variables are on the
+// same device as those of node.
+string FusionKey(const NodeDef& node, const FusableOp& fusable_op,
+                 const NodeMap& node_map) {
+  string variables_device;
+  for (int i = 0; i < fusable_op.num_ref_inputs; ++i) {
+    const NodeDef* variable = node_map.GetNode(node.input(i));
+    if (variable == nullptr) return "";
+    if (i == 0) {
+      variables_device = variable->device();
+    } else if (variable->device() != variables_device) {
+      return "";
+    }
+  }
+  string key = strings::StrCat(node.op(), ";", node.device(), ";",
+                               variables_device);
+  for (int i = 0; i < fusable_op.num_inputs; ++i) {
+    if (!fusable_op.variable_inputs.count(i)) {
+      strings::StrAppend(&key, ";", node.input(i));
+    }
+  }
+  // The attributes in a deterministic order, without the internal ones such as
+  // the colocation constraints.
+  std::map<string, const AttrValue*> attrs;
+  for (const auto& attr : node.attr()) {
+    if (attr.first.empty() || attr.first[0] != '_') {
+      attrs[attr.first] = &attr.second;
+    }
+  }
+  for (const auto& attr : attrs) {
+    strings::StrAppend(&key, ";", attr.first, "=",
+                       attr.second->SerializeAsString());
+  }
+  return key;
+}
+
+// Returns name, with a suffix if the graph already has a node of that name.
+string UniqueNodeName(const string& name, const NodeMap& node_map) {
+  string unique_name = name;
+  for (int i = 1; node_map.GetNode(unique_name) != nullptr; ++i) {
+    unique_name = strings::StrCat(name, "_", i);
+  }
+  return unique_name;
+}
+
+}  // namespace
+
+Status OptimizerFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output) {
+  *output = item.graph;
+  NodeMap node_map(output);
+
+  std::unordered_set<string> nodes_to_preserve;
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve.insert(NodeName(node));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve.insert(NodeName(node));
+  }
+
+  const auto& fusable_ops = FusableOps();
+  std::unordered_set<const NodeDef*> candidates;
+  for (const NodeDef& node : output->node()) {
+    auto fusable_op = fusable_ops.find(node.op());
+    if (fusable_op != fusable_ops.end() &&
+        NumDataInputs(node) == fusable_op->second.num_inputs &&
+        !nodes_to_preserve.count(node.name()) &&
+        !HasDataOutputs(node, node_map)) {
+      candidates.insert(&node);
+    }
+  }
+  if (candidates.empty()) return Status::OK();
+
+  // The fused node depends on the inputs of all the nodes it replaces, so a
+  // node that depends on a candidate is not fused to avoid cycles.
+  const std::unordered_set<const NodeDef*> depending =
+      NodesDependingOn(*output, node_map, candidates);
+
+  // Group the nodes to fuse in the order of the graph.
+  std::vector<std::vector<NodeDef*>> groups;
+  std::unordered_map<string, int> group_of_key;
+  for (int i = 0; i < output->node_size(); ++i) {
+    NodeDef* node = output->mutable_node(i);
+    if (!candidates.count(node)) continue;
+    bool has_depending_input = false;
+    for (const string& input : node->input()) {
+      if (depending.count(node_map.GetNode(input))) {
+        has_depending_input = true;
+        break;
+      }
+    }
+    if (has_depending_input) continue;
+    const string key = FusionKey(*node, fusable_ops.at(node->op()), node_map);
+    if (key.empty()) continue;
+    auto group = group_of_key.emplace(key, groups.size());
+    if (group.second) groups.emplace_back();
+    groups[group.first->second].push_back(node);
+  }
+
+  std::unordered_set<string> fused_nodes;
+  int num_fused_groups = 0;
+  for (const std::vector<NodeDef*>& group : groups) {
+    if (group.size() < 2) continue;
+    const NodeDef& first = *group[0];
+    const FusableOp& fusable_op = fusable_ops.at(first.op());
+
+    NodeDef* fused = output->add_node();
+    fused->set_name(UniqueNodeName(
+        AddPrefixToNodeName(first.name(), "OptimizerFusion", "-"), node_map));
+    fused->set_op(fusable_op.fused_op);
+    fused->set_device(first.device());
+    for (const auto& attr : first.attr()) {
+      if (attr.first.empty() || attr.first[0] != '_') {
+        (*fused->mutable_attr())[attr.first] = attr.second;
+      }
+    }
+    (*fused->mutable_attr())["N"].set_i(group.size());
+
+    for (int i = 0; i < fusable_op.num_inputs; ++i) {
+      if (fusable_op.variable_inputs.count(i)) {
+        for (const NodeDef* node : group) {
+          fused->add_input(node->input(i));
+        }
+      } else {
+        fused->add_input(first.input(i));
+      }
+    }
+    // The control inputs and colocation constraints of all the nodes.
+    std::set<string> control_inputs;
+    std::set<string> colocations;
+    for (const NodeDef* node : group) {
+      for (int i = fusable_op.num_inputs; i < node->input_size(); ++i) {
+        if (control_inputs.insert(node->input(i)).second) {
+          fused->add_input(node->input(i));
+        }
+      }
+      auto colocation = node->attr().find("_class");
+      if (colocation != node->attr().end()) {
+        for (const string& location : colocation->second.list().s()) {
+          colocations.insert(location);
+        }
+      }
+    }
+    if (!colocations.empty()) {
+      auto* list = (*fused->mutable_attr())["_class"].mutable_list();
+      for (const string& location : colocations) {
+        list->add_s(location);
+      }
+    }
+    node_map.AddNode(fused->name(), fused);
+
+    // Make the control dependencies on the nodes dependencies on the fused
+    // node.
+    const string fused_control_input = strings::StrCat("^", fused->name());
+    for (const NodeDef* node : group) {
+      const string control_input = strings::StrCat("^", node->name());
+      for (NodeDef* output_node : node_map.GetOutputs(node->name())) {
+        bool has_fused_input = false;
+        for (int i = 0; i < output_node->input_size();) {
+          const string& input = output_node->input(i);
+          if (input == control_input || input == fused_control_input) {
+            if (has_fused_input) {
+              output_node->mutable_input()->SwapElements(
+                  i, output_node->input_size() - 1);
+              output_node->mutable_input()->RemoveLast();
+              continue;
+            }
+            output_node->set_input(i, fused_control_input);
+            has_fused_input = true;
+          }
+          ++i;
+        }
+        node_map.AddOutput(fused->name(), output_node->name());
+      }
+      fused_nodes.insert(node->name());
+    }
+    ++num_fused_groups;
+  }
+
+  // Remove the fused nodes.
+  int num_nodes = 0;
+  for (int i = 0; i < output->node_size(); ++i) {
+    if (!fused_nodes.count(output->node(i).name())) {
+      output->mutable_node()->SwapElements(i, num_nodes++);
+    }
+  }
+  output->mutable_node()->DeleteSubrange(num_nodes,
+                                         output->node_size() - num_nodes);
+
+  VLOG(1) << "Fused " << fused_nodes.size() << " optimizer nodes into "
+          << num_fused_groups << " nodes.";
+  return Status::OK();
+}
+
+void OptimizerFusion::Feedback(Cluster* cluster, const GrapplerItem& item,
+                               const GraphDef& optimize_output, double result) {
+  // Nothing to do for OptimizerFusion.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_OPTIMIZER_FUSION_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_OPTIMIZER_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuse the ApplyMomentum and ApplyAdam nodes that update different variables
+// with the same hyperparameters into MultiApplyMomentum and MultiApplyAdam
+// nodes, so that a training step runs one op per optimizer instead of one op
+// per variable.
+//
+// Only the nodes whose outputs are used as control dependencies are fused, and
+// only with nodes on the same device whose variables are on the same device.
+class OptimizerFusion : public GraphOptimizer {
+ public:
+  OptimizerFusion() {}
+  ~OptimizerFusion() override {}
+
+  string name() const override { return "optimizer_fusion"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_OPTIMIZER_FUSION_H_
@@ -0,0 +1,182 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimizer_fusion.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class OptimizerFusionTest : public ::testing::Test {
+ protected:
+  // Adds an ApplyMomentum node "apply<i>" of variable "var<i>" on device.
+  Output AddApplyMomentum(const Scope& s, int i, const Output& lr,
+                          const Output& momentum, const string& device = "") {
+    Scope scope = s.WithDevice(device);
+    Output var = ops::Variable(scope.WithOpName(strings::StrCat("var", i)),
+                               {10}, DT_FLOAT);
+    Output accum = ops::Variable(
+        scope.WithOpName(strings::StrCat("accum", i)), {10}, DT_FLOAT);
+    Output grad =
+        ops::Const(scope.WithOpName(strings::StrCat("grad", i)), 1.0f, {10});
+    return ops::ApplyMomentum(scope.WithOpName(strings::StrCat("apply", i)),
+                              var, accum, lr, grad, momentum);
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(OptimizerFusionTest, FusesMomentum) {
+  Scope s = Scope::NewRootScope();
+  Output lr = ops::Const(s.WithOpName("lr"), 0.1f, {});
+  Output momentum = ops::Const(s.WithOpName("momentum"), 0.9f, {});
+  std::vector<Operation> applies;
+  for (int i = 0; i < 3; ++i) {
+    applies.push_back(AddApplyMomentum(s, i, lr, momentum).op());
+  }
+  ops::NoOp(s.WithOpName("train").WithControlDependencies(applies));
+
+  GrapplerItem item;
+  item.fetch.push_back("train");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  OptimizerFusion fusion;
+  GraphDef output;
+  TF_EXPECT_OK(fusion.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() - 2, output.node_size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(nullptr, FindNode(output, strings::StrCat("apply", i)));
+  }
+  const NodeDef* fused = FindNode(output, "OptimizerFusion-apply0");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("MultiApplyMomentum", fused->op());
+  EXPECT_EQ(3, fused->attr().at("N").i());
+  EXPECT_EQ(DT_FLOAT, fused->attr().at("T").type());
+  const std::vector<string> expected_inputs = {
+      "var0", "var1",  "var2",  "accum0", "accum1", "accum2",
+      "lr",   "grad0", "grad1", "grad2",  "momentum"};
+  ASSERT_EQ(expected_inputs.size(), fused->input_size());
+  for (int i = 0; i < expected_inputs.size(); ++i) {
+    EXPECT_EQ(expected_inputs[i], fused->input(i));
+  }
+
+  const NodeDef* train = FindNode(output, "train");
+  ASSERT_NE(nullptr, train);
+  ASSERT_EQ(1, train->input_size());
+  EXPECT_EQ("^OptimizerFusion-apply0", train->input(0));
+}
+
+TEST_F(OptimizerFusionTest, GroupsByHyperparametersAndDevice) {
+  Scope s = Scope::NewRootScope();
+  Output lr = ops::Const(s.WithOpName("lr"), 0.1f, {});
+  Output other_lr = ops::Const(s.WithOpName("other_lr"), 0.2f, {});
+  Output momentum = ops::Const(s.WithOpName("momentum"), 0.9f, {});
+  std::vector<Operation> applies = {
+      AddApplyMomentum(s, 0, lr, momentum).op(),
+      AddApplyMomentum(s, 1, other_lr, momentum).op(),
+      AddApplyMomentum(s, 2, lr, momentum, "/job:ps/task:0").op(),
+      AddApplyMomentum(s, 3, lr, momentum).op(),
+      AddApplyMomentum(s, 4, lr, momentum, "/job:ps/task:1").op()};
+  ops::NoOp(s.WithOpName("train").WithControlDependencies(applies));
+
+  GrapplerItem item;
+  item.fetch.push_back("train");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  OptimizerFusion fusion;
+  GraphDef output;
+  TF_EXPECT_OK(fusion.Optimize(nullptr, item, &output));
+
+  // Only apply0 and apply3 can be fused.
+  const NodeDef* fused = FindNode(output, "OptimizerFusion-apply0");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(2, fused->attr().at("N").i());
+  EXPECT_EQ("var0", fused->input(0));
+  EXPECT_EQ("var3", fused->input(1));
+  EXPECT_EQ(nullptr, FindNode(output, "apply0"));
+  EXPECT_EQ(nullptr, FindNode(output, "apply3"));
+  for (int i : {1, 2, 4}) {
+    EXPECT_NE(nullptr, FindNode(output, strings::StrCat("apply", i)));
+  }
+
+  const NodeDef* train = FindNode(output, "train");
+  ASSERT_NE(nullptr, train);
+  std::set<string> train_inputs(train->input().begin(), train->input().end());
+  EXPECT_EQ(std::set<string>({"^OptimizerFusion-apply0", "^apply1", "^apply2",
+                              "^apply4"}),
+            train_inputs);
+}
+
+TEST_F(OptimizerFusionTest, KeepsNodesWithDataOutputs) {
+  Scope s = Scope::NewRootScope();
+  Output lr = ops::Const(s.WithOpName("lr"), 0.1f, {});
+  Output momentum = ops::Const(s.WithOpName("momentum"), 0.9f, {});
+  Output apply0 = AddApplyMomentum(s, 0, lr, momentum);
+  Output apply1 = AddApplyMomentum(s, 1, lr, momentum);
+  Output identity = ops::Identity(s.WithOpName("identity"), apply0);
+  ops::NoOp(s.WithOpName("train").WithControlDependencies(apply1));
+
+  GrapplerItem item;
+  item.fetch = {"train", "identity"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  OptimizerFusion fusion;
+  GraphDef output;
+  TF_EXPECT_OK(fusion.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("MultiApplyMomentum", node.op());
+  }
+}
+
+TEST_F(OptimizerFusionTest, KeepsDependentNodes) {
+  // apply1 runs after apply0, so fusing them would create a cycle.
+  Scope s = Scope::NewRootScope();
+  Output lr = ops::Const(s.WithOpName("lr"), 0.1f, {});
+  Output momentum = ops::Const(s.WithOpName("momentum"), 0.9f, {});
+  Output apply0 = AddApplyMomentum(s, 0, lr, momentum);
+  Output apply1 =
+      AddApplyMomentum(s.WithControlDependencies(apply0), 1, lr, momentum);
+  ops::NoOp(s.WithOpName("train").WithControlDependencies(apply1));
+
+  GrapplerItem item;
+  item.fetch.push_back("train");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  OptimizerFusion fusion;
+  GraphDef output;
+  TF_EXPECT_OK(fusion.Optimize(nullptr, item, &output));
+
+  EXPECT_NE(nullptr, FindNode(output, "apply0"));
+  EXPECT_NE(nullptr, FindNode(output, "apply1"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,247 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// A matched subgraph: the Conv2D or MatMul, the BiasAdd or FusedBatchNorm
+// applied to its output, and the optional activation applied to the output of
+// the latter.
+struct Pattern {
+  NodeDef* contraction = nullptr;
+  NodeDef* bias = nullptr;
+  NodeDef* activation = nullptr;
+};
+
+bool HasFloatType(const NodeDef& node) {
+  auto attr = node.attr().find("T");
+  return attr != node.attr().end() && attr->second.type() == DT_FLOAT;
+}
+
+string DataFormat(const NodeDef& node) {
+  auto attr = node.attr().find("data_format");
+  return attr == node.attr().end() ? "NHWC" : attr->second.s();
+}
+
+// Returns the only node that uses the output of node, if it is the only use of
+// any output of node and it is its first input, or nullptr otherwise.
+NodeDef* SingleConsumer(const NodeDef& node, const NodeMap& node_map) {
+  const std::set<NodeDef*>& outputs = node_map.GetOutputs(node.name());
+  if (outputs.size() != 1) return nullptr;
+  NodeDef* consumer = *outputs.begin();
+  for (int i = 0; i < consumer->input_size(); ++i) {
+    int position;
+    if (ParseNodeName(consumer->input(i), &position) == node.name() &&
+        (i != 0 || position != 0)) {
+      return nullptr;
+    }
+  }
+  return consumer;
+}
+
+// Returns true iff only the first output of node is used by other nodes or
+// fetched.
+bool OnlyFirstOutputUsed(const NodeDef& node, const NodeMap& node_map,
+                         const GrapplerItem& item) {
+  for (const NodeDef* output : node_map.GetOutputs(node.name())) {
+    for (const string& input : output->input()) {
+      if (NodeName(input) == node.name() &&
+          (IsControlInput(input) || NodePosition(input) != 0)) {
+        return false;
+      }
+    }
+  }
+  for (const string& fetch : item.fetch) {
+    if (NodeName(fetch) == node.name() && NodePosition(fetch) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsActivation(const NodeDef& node) {
+  return node.op() == "Relu" || node.op() == "Relu6" || node.op() == "Elu";
+}
+
+// Returns true iff candidate can be fused after the previous node of the
+// pattern.
+bool CanFuseAfter(const NodeDef& candidate, const NodeDef& previous) {
+  return HasFloatType(candidate) && candidate.device() == previous.device();
+}
+
+// Matches the pattern starting at contraction, a Conv2D or MatMul node.
+bool MatchPattern(NodeDef* contraction, const NodeMap& node_map,
+                  const std::unordered_set<string>& nodes_to_preserve,
+                  const GrapplerItem& item, Pattern* pattern) {
+  const bool is_conv = contraction->op() == "Conv2D";
+  if (!HasFloatType(*contraction) || NumDataInputs(*contraction) != 2 ||
+      nodes_to_preserve.count(contraction->name())) {
+    return false;
+  }
+  NodeDef* bias = SingleConsumer(*contraction, node_map);
+  if (bias == nullptr || !CanFuseAfter(*bias, *contraction)) return false;
+  if (bias->op() == "BiasAdd") {
+    // The bias of a matrix is added to its rows in both data formats.
+    if (is_conv && DataFormat(*bias) != DataFormat(*contraction)) {
+      return false;
+    }
+  } else if (bias->op() == "FusedBatchNorm" && is_conv) {
+    auto is_training = bias->attr().find("is_training");
+    if (is_training == bias->attr().end() || is_training->second.b() ||
+        NumDataInputs(*bias) != 5 ||
+        DataFormat(*bias) != DataFormat(*contraction) ||
+        !OnlyFirstOutputUsed(*bias, node_map, item)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  pattern->contraction = contraction;
+  pattern->bias = bias;
+  pattern->activation = nullptr;
+
+  if (nodes_to_preserve.count(bias->name())) return true;
+  NodeDef* activation = SingleConsumer(*bias, node_map);
+  if (activation != nullptr && IsActivation(*activation) &&
+      CanFuseAfter(*activation, *bias)) {
+    pattern->activation = activation;
+  }
+  return true;
+}
+
+// Replaces the last node of the pattern with the fused node, of the same name
+// so that its consumers are unchanged.
+void FusePattern(const Pattern& pattern) {
+  const NodeDef& contraction = *pattern.contraction;
+  const NodeDef& bias = *pattern.bias;
+  NodeDef* last =
+      pattern.activation != nullptr ? pattern.activation : pattern.bias;
+
+  NodeDef fused;
+  fused.set_name(last->name());
+  fused.set_op(contraction.op() == "Conv2D" ? "_FusedConv2D" : "_FusedMatMul");
+  fused.set_device(last->device());
+  fused.add_input(contraction.input(0));
+  fused.add_input(contraction.input(1));
+  const int num_args = NumDataInputs(bias) - 1;
+  for (int i = 1; i <= num_args; ++i) {
+    fused.add_input(bias.input(i));
+  }
+  // The control inputs of all the nodes of the pattern.
+  std::set<string> control_inputs;
+  for (const NodeDef* node :
+       {pattern.contraction, pattern.bias, pattern.activation}) {
+    if (node == nullptr) continue;
+    for (int i = NumDataInputs(*node); i < node->input_size(); ++i) {
+      if (control_inputs.insert(node->input(i)).second) {
+        fused.add_input(node->input(i));
+      }
+    }
+  }
+
+  // The attributes of the contraction, without the internal ones such as the
+  // colocation constraints, which are those of the last node.
+  auto* attr = fused.mutable_attr();
+  for (const auto& contraction_attr : contraction.attr()) {
+    if (contraction_attr.first.empty() || contraction_attr.first[0] != '_') {
+      (*attr)[contraction_attr.first] = contraction_attr.second;
+    }
+  }
+  for (const auto& last_attr : last->attr()) {
+    if (!last_attr.first.empty() && last_attr.first[0] == '_') {
+      (*attr)[last_attr.first] = last_attr.second;
+    }
+  }
+  (*attr)["num_args"].set_i(num_args);
+  auto* fused_ops = (*attr)["fused_ops"].mutable_list();
+  fused_ops->add_s(bias.op());
+  if (pattern.activation != nullptr) {
+    fused_ops->add_s(pattern.activation->op());
+  }
+  // The variance epsilon of the batch normalization, unused by a BiasAdd. Set
+  // either way, since the default attributes are only added on import.
+  auto epsilon = bias.attr().find("epsilon");
+  (*attr)["epsilon"].set_f(
+      epsilon != bias.attr().end() ? epsilon->second.f() : 0.0001f);
+  last->Swap(&fused);
+}
+
+}  // namespace
+
+Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
+                          GraphDef* output) {
+  *output = item.graph;
+  NodeMap node_map(output);
+
+  std::unordered_set<string> nodes_to_preserve;
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve.insert(NodeName(node));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve.insert(NodeName(node));
+  }
+
+  // The nodes of a pattern are only used within the pattern, so the patterns
+  // do not overlap and the node map stays valid for the nodes not yet fused.
+  std::unordered_set<string> fused_nodes;
+  int num_patterns = 0;
+  for (int i = 0; i < output->node_size(); ++i) {
+    NodeDef* node = output->mutable_node(i);
+    if (node->op() != "Conv2D" && node->op() != "MatMul") continue;
+    Pattern pattern;
+    if (!MatchPattern(node, node_map, nodes_to_preserve, item, &pattern)) {
+      continue;
+    }
+    fused_nodes.insert(pattern.contraction->name());
+    if (pattern.activation != nullptr) {
+      fused_nodes.insert(pattern.bias->name());
+    }
+    FusePattern(pattern);
+    ++num_patterns;
+  }
+
+  // Remove the nodes replaced by the fused nodes.
+  int num_nodes = 0;
+  for (int i = 0; i < output->node_size(); ++i) {
+    if (!fused_nodes.count(output->node(i).name())) {
+      output->mutable_node()->SwapElements(i, num_nodes++);
+    }
+  }
+  output->mutable_node()->DeleteSubrange(num_nodes,
+                                         output->node_size() - num_nodes);
+
+  VLOG(1) << "Remapped " << num_patterns << " subgraphs into fused nodes.";
+  return Status::OK();
+}
+
+void Remapper::Feedback(Cluster* cluster, const GrapplerItem& item,
+                        const GraphDef& optimize_output, double result) {
+  // Nothing to do for Remapper.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_REMAPPER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_REMAPPER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Replace the subgraphs of a Conv2D followed by a BiasAdd or an inference
+// FusedBatchNorm, and of a MatMul followed by a BiasAdd, optionally followed
+// by a Relu, Relu6 or Elu, with a single _FusedConv2D or _FusedMatMul node
+// that applies the following ops to the output of the convolution or of the
+// multiplication in place.
+//
+// Only float subgraphs on a single device are remapped, and only when the
+// intermediate outputs are not used elsewhere.
+class Remapper : public GraphOptimizer {
+ public:
+  Remapper() {}
+  ~Remapper() override {}
+
+  string name() const override { return "remapper"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_REMAPPER_H_
@@ -0,0 +1,202 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class RemapperTest : public ::testing::Test {
+ protected:
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  std::vector<string> Inputs(const NodeDef& node) {
+    return std::vector<string>(node.input().begin(), node.input().end());
+  }
+
+  std::vector<string> FusedOps(const NodeDef& node) {
+    const auto& list = node.attr().at("fused_ops").list().s();
+    return std::vector<string>(list.begin(), list.end());
+  }
+};
+
+TEST_F(RemapperTest, FusesConv2DBiasAddRelu) {
+  Scope s = Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {8, 32, 32, 3});
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {1, 1, 3, 16});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {16});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  ops::Identity(s.WithOpName("output"), relu);
+
+  GrapplerItem item;
+  item.fetch.push_back("output");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() - 2, output.node_size());
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  EXPECT_EQ(nullptr, FindNode(output, "bias_add"));
+  const NodeDef* fused = FindNode(output, "relu");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedConv2D", fused->op());
+  EXPECT_EQ(std::vector<string>({"input", "filter", "bias"}), Inputs(*fused));
+  EXPECT_EQ(std::vector<string>({"BiasAdd", "Relu"}), FusedOps(*fused));
+  EXPECT_EQ(1, fused->attr().at("num_args").i());
+  EXPECT_EQ("SAME", fused->attr().at("padding").s());
+  EXPECT_EQ(DT_FLOAT, fused->attr().at("T").type());
+}
+
+TEST_F(RemapperTest, FusesConv2DBatchNorm) {
+  Scope s = Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {8, 32, 32, 3});
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {1, 1, 3, 16});
+  Output scale = ops::Const(s.WithOpName("scale"), 1.0f, {16});
+  Output offset = ops::Const(s.WithOpName("offset"), 1.0f, {16});
+  Output mean = ops::Const(s.WithOpName("mean"), 1.0f, {16});
+  Output variance = ops::Const(s.WithOpName("variance"), 1.0f, {16});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "SAME");
+  auto batch_norm = ops::FusedBatchNorm(
+      s.WithOpName("batch_norm"), conv, scale, offset, mean, variance,
+      ops::FusedBatchNorm::IsTraining(false).Epsilon(0.01f));
+  ops::Identity(s.WithOpName("output"), batch_norm.y);
+
+  GrapplerItem item;
+  item.fetch.push_back("output");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  const NodeDef* fused = FindNode(output, "batch_norm");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedConv2D", fused->op());
+  EXPECT_EQ(std::vector<string>(
+                {"input", "filter", "scale", "offset", "mean", "variance"}),
+            Inputs(*fused));
+  EXPECT_EQ(std::vector<string>({"FusedBatchNorm"}), FusedOps(*fused));
+  EXPECT_EQ(4, fused->attr().at("num_args").i());
+  EXPECT_FLOAT_EQ(0.01f, fused->attr().at("epsilon").f());
+}
+
+TEST_F(RemapperTest, FusesMatMulBiasAddWithControlInputs) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {8, 32});
+  Output b = ops::Const(s.WithOpName("b"), 1.0f, {32, 16});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {16});
+  Output init = ops::Const(s.WithOpName("init"), 1.0f, {});
+  Output matmul = ops::MatMul(
+      s.WithOpName("matmul").WithControlDependencies(init.op()), a, b,
+      ops::MatMul::TransposeB(false));
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  Output elu = ops::Elu(s.WithOpName("elu"), bias_add);
+  ops::Identity(s.WithOpName("output"), elu);
+
+  GrapplerItem item;
+  item.fetch.push_back("output");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  const NodeDef* fused = FindNode(output, "elu");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedMatMul", fused->op());
+  EXPECT_EQ(std::vector<string>({"a", "b", "bias", "^init"}), Inputs(*fused));
+  EXPECT_EQ(std::vector<string>({"BiasAdd", "Elu"}), FusedOps(*fused));
+  EXPECT_FALSE(fused->attr().at("transpose_b").b());
+}
+
+TEST_F(RemapperTest, KeepsIntermediateOutputsUsedElsewhere) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {8, 32});
+  Output b = ops::Const(s.WithOpName("b"), 1.0f, {32, 16});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {16});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), a, b);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  ops::Identity(s.WithOpName("output"), relu);
+
+  GrapplerItem item;
+  // The BiasAdd is fetched, so only the MatMul and the BiasAdd are fused.
+  item.fetch = {"output", "bias_add"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "matmul"));
+  const NodeDef* fused = FindNode(output, "bias_add");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedMatMul", fused->op());
+  EXPECT_EQ(std::vector<string>({"BiasAdd"}), FusedOps(*fused));
+  const NodeDef* relu_node = FindNode(output, "relu");
+  ASSERT_NE(nullptr, relu_node);
+  EXPECT_EQ("Relu", relu_node->op());
+}
+
+TEST_F(RemapperTest, DoesNotFuseTrainingBatchNorm) {
+  Scope s = Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {8, 32, 32, 3});
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {1, 1, 3, 16});
+  Output scale = ops::Const(s.WithOpName("scale"), 1.0f, {16});
+  Output offset = ops::Const(s.WithOpName("offset"), 1.0f, {16});
+  Output empty = ops::Const(s.WithOpName("empty"), 1.0f, {0});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "SAME");
+  auto batch_norm =
+      ops::FusedBatchNorm(s.WithOpName("batch_norm"), conv, scale, offset,
+                          empty, empty, ops::FusedBatchNorm::IsTraining(true));
+  ops::Identity(s.WithOpName("output"), batch_norm.y);
+
+  GrapplerItem item;
+  item.fetch.push_back("output");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  const NodeDef* conv_node = FindNode(output, "conv");
+  ASSERT_NE(nullptr, conv_node);
+  EXPECT_EQ("Conv2D", conv_node->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/scheduling_priorities.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/static_schedule.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status SchedulingPriorities::Optimize(Cluster* cluster,
+                                      const GrapplerItem& item,
+                                      GraphDef* output) {
+  *output = item.graph;
+  if (cluster == nullptr) {
+    // Nothing to do.
+    return Status::OK();
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> path_lengths;
+  Status s = EstimateCriticalPathLengths(item, cluster, &path_lengths);
+  if (!s.ok()) {
+    // The priorities are only hints for the executor, so their absence must
+    // not disable the other optimizations.
+    VLOG(1) << "Not annotating the scheduling priorities: " << s;
+    return Status::OK();
+  }
+
+  // The output is a copy of the input graph, with the nodes in the same order.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    const int64 priority = path_lengths[&item.graph.node(i)].count();
+    (*output->mutable_node(i)->mutable_attr())["_priority"].set_i(priority);
+  }
+  return Status::OK();
+}
+
+void SchedulingPriorities::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                    const GraphDef& optimize_output,
+                                    double result) {
+  // Nothing to do for SchedulingPriorities.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_SCHEDULING_PRIORITIES_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_SCHEDULING_PRIORITIES_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Annotate each node of the graph with an int "_priority" attribute: the
+// estimated length, in nanoseconds, of the critical path that starts at the
+// node (see EstimateCriticalPathLengths). The executor runs the ready nodes
+// with the highest priorities first, so that the long chains of dependent
+// nodes start as early as possible.
+//
+// The graph is left unchanged if there is no cluster to estimate the costs
+// on, or if the graph has a cycle that is not a loop.
+class SchedulingPriorities : public GraphOptimizer {
+ public:
+  SchedulingPriorities() {}
+  ~SchedulingPriorities() override {}
+
+  string name() const override { return "scheduling_priorities"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_SCHEDULING_PRIORITIES_H_
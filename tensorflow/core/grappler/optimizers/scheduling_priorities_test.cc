@@ -0,0 +1,96 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/scheduling_priorities.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class SchedulingPrioritiesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    cluster_.reset(new VirtualCluster(devices));
+  }
+
+  // Builds a long chain of AddN nodes and a short branch from the same input.
+  void BuildGraph(GrapplerItem* item) {
+    Scope s = Scope::NewRootScope();
+    Output a = ops::Const(s.WithOpName("a"), 0.0f, {10, 10});
+    Output b = ops::AddN(s.WithOpName("b"), {a});
+    Output c = ops::AddN(s.WithOpName("c"), {b});
+    ops::Identity(s.WithOpName("short"), a);
+    ops::Identity(s.WithOpName("long"), c);
+    item->fetch = {"short", "long"};
+    TF_CHECK_OK(s.ToGraphDef(&item->graph));
+  }
+
+  int64 Priority(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return node.attr().at("_priority").i();
+    }
+    ADD_FAILURE() << "Node " << name << " not found";
+    return -1;
+  }
+
+  std::unique_ptr<VirtualCluster> cluster_;
+};
+
+TEST_F(SchedulingPrioritiesTest, PrioritizesCriticalPath) {
+  GrapplerItem item;
+  BuildGraph(&item);
+
+  SchedulingPriorities optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster_.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(1, node.attr().count("_priority")) << node.name();
+  }
+  EXPECT_GT(Priority(output, "a"), Priority(output, "b"));
+  EXPECT_GT(Priority(output, "b"), Priority(output, "c"));
+  EXPECT_GT(Priority(output, "c"), Priority(output, "long"));
+  EXPECT_GT(Priority(output, "b"), Priority(output, "short"));
+  EXPECT_LT(0, Priority(output, "short"));
+}
+
+TEST_F(SchedulingPrioritiesTest, NoClusterLeavesGraphUnchanged) {
+  GrapplerItem item;
+  BuildGraph(&item);
+
+  SchedulingPriorities optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.DebugString(), output.DebugString());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -88,6 +88,9 @@ Status EstimateEarliestExecutionTimes(
   GraphProperties properties(item);
   TF_RETURN_IF_ERROR(properties.InferStatically());
   OpLevelCostEstimator estimator;
+  if (item.op_cost_calibration != nullptr) {
+    estimator.SetCalibration(*item.op_cost_calibration);
+  }
   VirtualPlacer placer(cluster);
 
   while (!ready_nodes.empty()) {
@@ -119,5 +122,79 @@ Status EstimateEarliestExecutionTimes(
   return Status::OK();
 }
 
+Status EstimateCriticalPathLengths(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* path_lengths) {
+  std::unordered_map<string, const NodeDef*> name_map;
+  for (const NodeDef& node : item.graph.node()) {
+    name_map[node.name()] = &node;
+  }
+
+  std::unordered_map<const NodeDef*, std::vector<const NodeDef*>> fanins;
+  std::unordered_map<const NodeDef*, int> pending_outputs;
+  for (const NodeDef& node : item.graph.node()) {
+    for (const string& input : node.input()) {
+      string node_name = NodeName(input);
+      auto it = name_map.find(node_name);
+      if (it == name_map.end()) {
+        return errors::InvalidArgument(
+            strings::StrCat("Unknown input node ", input));
+      }
+      const NodeDef* fanin = it->second;
+      if (IsNextIteration(*fanin)) {
+        // Ignore the back edges of the loops.
+        continue;
+      }
+      fanins[&node].push_back(fanin);
+      pending_outputs[fanin]++;
+    }
+  }
+  name_map.clear();
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically());
+  OpLevelCostEstimator estimator;
+  if (item.op_cost_calibration != nullptr) {
+    estimator.SetCalibration(*item.op_cost_calibration);
+  }
+  VirtualPlacer placer(cluster);
+
+  // Visit the nodes in reverse topological order, starting from the nodes
+  // whose outputs are not used.
+  std::deque<const NodeDef*> ready_nodes;
+  for (const NodeDef& node : item.graph.node()) {
+    (*path_lengths)[&node] = 0;
+    if (pending_outputs[&node] == 0) {
+      ready_nodes.push_back(&node);
+    }
+  }
+  int num_visited = 0;
+  while (!ready_nodes.empty()) {
+    const NodeDef* node = ready_nodes.front();
+    ready_nodes.pop_front();
+    ++num_visited;
+
+    // The critical path of the node's outputs is already known.
+    Costs::NanoSeconds path_length =
+        PredictExecutionTime(properties, estimator, placer, *node) +
+        (*path_lengths)[node];
+    (*path_lengths)[node] = path_length;
+
+    for (const NodeDef* fanin : fanins[node]) {
+      (*path_lengths)[fanin] = std::max((*path_lengths)[fanin], path_length);
+      if (--pending_outputs[fanin] == 0) {
+        ready_nodes.push_back(fanin);
+      }
+    }
+  }
+  if (num_visited != item.graph.node_size()) {
+    return errors::InvalidArgument(
+        "The graph has a cycle that is not a loop, can't estimate the "
+        "critical paths");
+  }
+
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -35,6 +35,15 @@ Status EstimateEarliestExecutionTimes(
     const GrapplerItem& item, const Cluster* cluster,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* execution_times);
 
+// Compute the length of the critical path starting at each node of the graph,
+// i.e. the estimated time it takes to execute the node and the longest chain
+// of nodes that depend on it. Running the nodes with the longest critical paths
+// first shortens the execution of the whole graph. The back edges of the loops
+// (from the NextIteration to the Merge nodes) are ignored.
+Status EstimateCriticalPathLengths(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* path_lengths);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
@@ -121,6 +121,81 @@ TEST_F(StaticScheduleTest, BasicGraphWithCtrlDependencies) {
   }
 }
 
+TEST_F(StaticScheduleTest, CriticalPathLengths) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output a = ops::Const(s.WithOpName("a"), 0.0f, {10, 10});
+  Output b = ops::AddN(s.WithOpName("b"), {a});
+  Output c = ops::Identity(s.WithOpName("c"), b);
+  Output d = ops::AddN(s.WithOpName("d"), {c});
+  // A short branch, off the critical path.
+  Output e = ops::Identity(s.WithOpName("e"), a);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  VirtualCluster cluster(CreateVirtualCluster());
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> path_lengths;
+  Status status = EstimateCriticalPathLengths(item, &cluster, &path_lengths);
+  TF_EXPECT_OK(status);
+
+  EXPECT_EQ(item.graph.node_size(), path_lengths.size());
+
+  for (auto length : path_lengths) {
+    if (length.first->name() == "a") {
+      EXPECT_EQ(Costs::NanoSeconds(25000002), length.second);
+    } else if (length.first->name() == "b") {
+      EXPECT_EQ(Costs::NanoSeconds(25000001), length.second);
+    } else if (length.first->name() == "c") {
+      EXPECT_EQ(Costs::NanoSeconds(12500001), length.second);
+    } else if (length.first->name() == "d") {
+      EXPECT_EQ(Costs::NanoSeconds(12500000), length.second);
+    } else if (length.first->name() == "e") {
+      EXPECT_EQ(Costs::NanoSeconds(1), length.second);
+    }
+  }
+}
+
+TEST_F(StaticScheduleTest, CalibratedCriticalPathLengths) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output a = ops::Const(s.WithOpName("a"), 0.0f, {10, 10});
+  Output b = ops::AddN(s.WithOpName("b"), {a});
+  Output c = ops::Identity(s.WithOpName("c"), b);
+  Output d = ops::AddN(s.WithOpName("d"), {c});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  // Every AddN takes 1000 ns.
+  std::shared_ptr<OpCostCalibration> calibration(new OpCostCalibration);
+  auto entry = calibration->add_entries();
+  entry->set_op("AddN");
+  entry->set_device_type("CPU");
+  entry->set_fixed_time(1000);
+  item.op_cost_calibration = calibration;
+
+  VirtualCluster cluster(CreateVirtualCluster());
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> path_lengths;
+  Status status = EstimateCriticalPathLengths(item, &cluster, &path_lengths);
+  TF_EXPECT_OK(status);
+
+  EXPECT_EQ(item.graph.node_size(), path_lengths.size());
+
+  for (auto length : path_lengths) {
+    if (length.first->name() == "a") {
+      EXPECT_EQ(Costs::NanoSeconds(2002), length.second);
+    } else if (length.first->name() == "b") {
+      EXPECT_EQ(Costs::NanoSeconds(2001), length.second);
+    } else if (length.first->name() == "c") {
+      EXPECT_EQ(Costs::NanoSeconds(1001), length.second);
+    } else if (length.first->name() == "d") {
+      EXPECT_EQ(Costs::NanoSeconds(1000), length.second);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -111,6 +111,27 @@ string NodeName(const string& name) {
   return ParseNodeName(name, &position);
 }
 
+int NumDataInputs(const NodeDef& node) {
+  int num_inputs = 0;
+  while (num_inputs < node.input_size() &&
+         !IsControlInput(node.input(num_inputs))) {
+    ++num_inputs;
+  }
+  return num_inputs;
+}
+
+void RemoveNodes(const std::unordered_set<string>& nodes, GraphDef* graph) {
+  if (nodes.empty()) return;
+  int num_nodes = 0;
+  for (int i = 0; i < graph->node_size(); ++i) {
+    if (!nodes.count(graph->node(i).name())) {
+      graph->mutable_node()->SwapElements(i, num_nodes++);
+    }
+  }
+  graph->mutable_node()->DeleteSubrange(num_nodes,
+                                        graph->node_size() - num_nodes);
+}
+
 int NodePosition(const string& name) {
   int position;
   ParseNodeName(name, &position);
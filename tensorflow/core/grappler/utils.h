@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_GRAPPLER_UTILS_H_
 
 #include <functional>
+#include <unordered_set>
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -58,6 +59,14 @@ bool IsSameInput(const string& name1, const string& name2);
 // string otherwise.
 string NodeName(const string& name);
 
+// Returns the number of inputs of 'node' that are not control inputs, which
+// come first.
+int NumDataInputs(const NodeDef& node);
+
+// Removes from 'graph' the nodes whose names are in 'nodes'. The other nodes
+// keep their order.
+void RemoveNodes(const std::unordered_set<string>& nodes, GraphDef* graph);
+
 // Get the trailing position number ":{digits}" (if any) of a node name.
 int NodePosition(const string& name);
 
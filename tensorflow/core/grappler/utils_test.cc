@@ -58,6 +58,27 @@ TEST_F(UtilsTest, NodePosition) {
   EXPECT_EQ(0, NodePosition(""));
 }
 
+TEST_F(UtilsTest, NumDataInputs) {
+  NodeDef node;
+  EXPECT_EQ(0, NumDataInputs(node));
+  node.add_input("a");
+  node.add_input("b:1");
+  EXPECT_EQ(2, NumDataInputs(node));
+  node.add_input("^c");
+  EXPECT_EQ(2, NumDataInputs(node));
+}
+
+TEST_F(UtilsTest, RemoveNodes) {
+  GraphDef graph;
+  for (const char* name : {"a", "b", "c", "d"}) {
+    graph.add_node()->set_name(name);
+  }
+  RemoveNodes({"b", "d"}, &graph);
+  ASSERT_EQ(2, graph.node_size());
+  EXPECT_EQ("a", graph.node(0).name());
+  EXPECT_EQ("c", graph.node(1).name());
+}
+
 TEST_F(UtilsTest, AddNodeNamePrefix) {
   EXPECT_EQ("OPTIMIZED/abc", AddPrefixToNodeName("abc", "OPTIMIZED"));
   EXPECT_EQ("^OPTIMIZED/abc", AddPrefixToNodeName("^abc", "OPTIMIZED"));
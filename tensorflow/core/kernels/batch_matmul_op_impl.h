@@ -17,6 +17,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <type_traits>
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op.h"
@@ -191,6 +192,179 @@ struct SequentialMatMulKernel {
   }
 };
 
+// The largest dimension of the matrices multiplied by SmallMatMulKernel.
+const int64 kMaxSmallMatMulDim = 128;
+
+// Batch matmul kernel for many small matrices, which avoids the per-call
+// overhead of the Eigen products. The operands are multiplied in row-major
+// order by a micro-kernel that accumulates blocks of 4 rows by 2 packets of
+// the output in registers. Only float and double are vectorized this way, the
+// other types use SequentialMatMulKernel.
+template <typename Scalar,
+          bool Vectorized = std::is_same<Scalar, float>::value ||
+                            std::is_same<Scalar, double>::value>
+struct SmallMatMulKernel {
+  static constexpr bool kSupported = false;
+
+  static void Run(const Tensor& in_x, const Tensor& in_y, bool adj_x,
+                  bool adj_y, Tensor* out, int start, int limit) {}
+};
+
+template <typename Scalar>
+struct SmallMatMulKernel<Scalar, true> {
+  static constexpr bool kSupported = true;
+
+  using Packet = typename Eigen::internal::packet_traits<Scalar>::type;
+  static constexpr int kPacketSize =
+      Eigen::internal::packet_traits<Scalar>::size;
+  static constexpr int kBlockRows = 4;
+
+  using Matrix =
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using ConstMatrixMap = Eigen::Map<const Matrix>;
+  using MatrixMap = Eigen::Map<Matrix>;
+
+  // Computes 4 rows of c = a * b, where a is 4 x k, b is k x n and c is 4 x n,
+  // all row-major. The accumulators are spelled out so that they stay in
+  // registers without relying on the compiler to unroll the row loop.
+  static void MultiplyBlock(const Scalar* a, const Scalar* b, Scalar* c,
+                            int64 k, int64 n) {
+    using Eigen::internal::pmadd;
+    using Eigen::internal::ploadu;
+    using Eigen::internal::pset1;
+    using Eigen::internal::pstoreu;
+    const Scalar* a0 = a;
+    const Scalar* a1 = a + k;
+    const Scalar* a2 = a + 2 * k;
+    const Scalar* a3 = a + 3 * k;
+    int64 j = 0;
+    for (; j + 2 * kPacketSize <= n; j += 2 * kPacketSize) {
+      Packet c00 = pset1<Packet>(Scalar(0)), c01 = c00;
+      Packet c10 = c00, c11 = c00;
+      Packet c20 = c00, c21 = c00;
+      Packet c30 = c00, c31 = c00;
+      const Scalar* b_p = b + j;
+      for (int64 p = 0; p < k; ++p, b_p += n) {
+        const Packet b0 = ploadu<Packet>(b_p);
+        const Packet b1 = ploadu<Packet>(b_p + kPacketSize);
+        Packet a_p = pset1<Packet>(a0[p]);
+        c00 = pmadd(a_p, b0, c00);
+        c01 = pmadd(a_p, b1, c01);
+        a_p = pset1<Packet>(a1[p]);
+        c10 = pmadd(a_p, b0, c10);
+        c11 = pmadd(a_p, b1, c11);
+        a_p = pset1<Packet>(a2[p]);
+        c20 = pmadd(a_p, b0, c20);
+        c21 = pmadd(a_p, b1, c21);
+        a_p = pset1<Packet>(a3[p]);
+        c30 = pmadd(a_p, b0, c30);
+        c31 = pmadd(a_p, b1, c31);
+      }
+      pstoreu(c + j, c00);
+      pstoreu(c + j + kPacketSize, c01);
+      pstoreu(c + n + j, c10);
+      pstoreu(c + n + j + kPacketSize, c11);
+      pstoreu(c + 2 * n + j, c20);
+      pstoreu(c + 2 * n + j + kPacketSize, c21);
+      pstoreu(c + 3 * n + j, c30);
+      pstoreu(c + 3 * n + j + kPacketSize, c31);
+    }
+    if (j + kPacketSize <= n) {
+      Packet c0 = pset1<Packet>(Scalar(0)), c1 = c0, c2 = c0, c3 = c0;
+      const Scalar* b_p = b + j;
+      for (int64 p = 0; p < k; ++p, b_p += n) {
+        const Packet b0 = ploadu<Packet>(b_p);
+        c0 = pmadd(pset1<Packet>(a0[p]), b0, c0);
+        c1 = pmadd(pset1<Packet>(a1[p]), b0, c1);
+        c2 = pmadd(pset1<Packet>(a2[p]), b0, c2);
+        c3 = pmadd(pset1<Packet>(a3[p]), b0, c3);
+      }
+      pstoreu(c + j, c0);
+      pstoreu(c + n + j, c1);
+      pstoreu(c + 2 * n + j, c2);
+      pstoreu(c + 3 * n + j, c3);
+      j += kPacketSize;
+    }
+    for (; j < n; ++j) {
+      Scalar c0 = Scalar(0), c1 = Scalar(0), c2 = Scalar(0), c3 = Scalar(0);
+      const Scalar* b_p = b + j;
+      for (int64 p = 0; p < k; ++p, b_p += n) {
+        c0 += a0[p] * *b_p;
+        c1 += a1[p] * *b_p;
+        c2 += a2[p] * *b_p;
+        c3 += a3[p] * *b_p;
+      }
+      c[j] = c0;
+      c[n + j] = c1;
+      c[2 * n + j] = c2;
+      c[3 * n + j] = c3;
+    }
+  }
+
+  // Computes one row of c = a * b, for the rows left over by MultiplyBlock.
+  static void MultiplyRow(const Scalar* a, const Scalar* b, Scalar* c, int64 k,
+                          int64 n) {
+    using Eigen::internal::pmadd;
+    using Eigen::internal::ploadu;
+    using Eigen::internal::pset1;
+    using Eigen::internal::pstoreu;
+    int64 j = 0;
+    for (; j + 2 * kPacketSize <= n; j += 2 * kPacketSize) {
+      Packet c0 = pset1<Packet>(Scalar(0)), c1 = c0;
+      const Scalar* b_p = b + j;
+      for (int64 p = 0; p < k; ++p, b_p += n) {
+        const Packet a_p = pset1<Packet>(a[p]);
+        c0 = pmadd(a_p, ploadu<Packet>(b_p), c0);
+        c1 = pmadd(a_p, ploadu<Packet>(b_p + kPacketSize), c1);
+      }
+      pstoreu(c + j, c0);
+      pstoreu(c + j + kPacketSize, c1);
+    }
+    for (; j < n; ++j) {
+      Scalar c0 = Scalar(0);
+      const Scalar* b_p = b + j;
+      for (int64 p = 0; p < k; ++p, b_p += n) {
+        c0 += a[p] * *b_p;
+      }
+      c[j] = c0;
+    }
+  }
+
+  static void Run(const Tensor& in_x, const Tensor& in_y, bool adj_x,
+                  bool adj_y, Tensor* out, int start, int limit) {
+    const int64 m = out->dim_size(1);
+    const int64 k = in_x.dim_size(adj_x ? 1 : 2);
+    const int64 n = out->dim_size(2);
+    const Scalar* x_base = in_x.flat<Scalar>().data();
+    const Scalar* y_base = in_y.flat<Scalar>().data();
+    Scalar* z_base = out->flat<Scalar>().data();
+    // The adjoints of real matrices are their transposes, which are copied to
+    // row-major buffers so that the micro-kernel reads both operands in order.
+    std::vector<Scalar> x_buffer(adj_x ? m * k : 0);
+    std::vector<Scalar> y_buffer(adj_y ? k * n : 0);
+    for (int i = start; i < limit; ++i) {
+      const Scalar* x = x_base + i * m * k;
+      const Scalar* y = y_base + i * k * n;
+      Scalar* z = z_base + i * m * n;
+      if (adj_x) {
+        MatrixMap(x_buffer.data(), m, k) = ConstMatrixMap(x, k, m).transpose();
+        x = x_buffer.data();
+      }
+      if (adj_y) {
+        MatrixMap(y_buffer.data(), k, n) = ConstMatrixMap(y, n, k).transpose();
+        y = y_buffer.data();
+      }
+      int64 row = 0;
+      for (; row + kBlockRows <= m; row += kBlockRows) {
+        MultiplyBlock(x + row * k, y, z + row * n, k, n);
+      }
+      for (; row < m; ++row) {
+        MultiplyRow(x + row * k, y, z + row * n, k, n);
+      }
+    }
+  }
+};
+
 }  // namespace
 
 template <typename Device, typename Scalar>
@@ -210,6 +384,8 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
         in_x.dim_size(1) * in_x.dim_size(2) * out->dim_size(2);
     const int64 min_dim = std::min(std::min(in_x.dim_size(1), in_x.dim_size(2)),
                                    out->dim_size(2));
+    const int64 max_dim = std::max(std::max(in_x.dim_size(1), in_x.dim_size(2)),
+                                   out->dim_size(2));
     const int64 kMaxCostOuterParallelism = 128 * 256 * 256;  // heuristic.
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     if (min_dim > 1 &&
@@ -220,6 +396,16 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
       ParallelMatMulKernel::Run(context, in_x, in_y, adj_x, adj_y, out, 0,
                                 num_units);
       conjugate_result = adj_x;
+    } else if (SmallMatMulKernel<Scalar>::kSupported && min_dim > 1 &&
+               max_dim <= kMaxSmallMatMulDim) {
+      // Parallelize over outer dims, multiplying each of the small matrices
+      // with a register-blocked kernel rather than a parallel contraction.
+      Shard(worker_threads.num_threads, worker_threads.workers, num_units,
+            cost_per_unit,
+            [&in_x, &in_y, adj_x, adj_y, out](int start, int limit) {
+              SmallMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y, out,
+                                             start, limit);
+            });
     } else if (min_dim > 1 && worker_threads.num_threads > num_units) {
       // Parallelize over both outer and inner dims.
       // TODO(rmlarsen): The parallelized contraction in Eigen can deadlock
@@ -317,30 +503,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
     auto* stream = context->op_device_context()->stream();
     OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
 
-    typedef perftools::gputools::DeviceMemory<Scalar> DeviceMemoryType;
-    std::vector<DeviceMemoryType> a_device_memory;
-    std::vector<DeviceMemoryType> b_device_memory;
-    std::vector<DeviceMemoryType> c_device_memory;
-    std::vector<DeviceMemoryType*> a_ptrs;
-    std::vector<DeviceMemoryType*> b_ptrs;
-    std::vector<DeviceMemoryType*> c_ptrs;
-    a_device_memory.reserve(batch_size);
-    b_device_memory.reserve(batch_size);
-    c_device_memory.reserve(batch_size);
-    a_ptrs.reserve(batch_size);
-    b_ptrs.reserve(batch_size);
-    c_ptrs.reserve(batch_size);
-    auto* a_base_ptr = in_x.template flat<Scalar>().data();
-    auto* b_base_ptr = in_y.template flat<Scalar>().data();
-    auto* c_base_ptr = out->template flat<Scalar>().data();
-    for (int64 i = 0; i < batch_size; ++i) {
-      a_device_memory.push_back(AsDeviceMemory(a_base_ptr + i * m * k));
-      b_device_memory.push_back(AsDeviceMemory(b_base_ptr + i * k * n));
-      c_device_memory.push_back(AsDeviceMemory(c_base_ptr + i * m * n));
-      a_ptrs.push_back(&a_device_memory.back());
-      b_ptrs.push_back(&b_device_memory.back());
-      c_ptrs.push_back(&c_device_memory.back());
-    }
+    auto a_device_memory = AsDeviceMemory(in_x.template flat<Scalar>().data());
+    auto b_device_memory = AsDeviceMemory(in_y.template flat<Scalar>().data());
+    auto c_device_memory = AsDeviceMemory(out->template flat<Scalar>().data());
 
     // Cublas does
     // C = A x B
@@ -368,9 +533,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         bool blas_launch_status =
             stream
                 ->ThenBlasGemv(gemv_trans_a, adj_x ? m : k, adj_x ? k : m,
-                               static_cast<Scalar>(1.0), *(a_ptrs[0]),
-                               adj_x ? m : k, *(b_ptrs[0]), 1,
-                               static_cast<Scalar>(0.0), c_ptrs[0], 1)
+                               static_cast<Scalar>(1.0), a_device_memory,
+                               adj_x ? m : k, b_device_memory, 1,
+                               static_cast<Scalar>(0.0), &c_device_memory, 1)
                 .ok();
         if (!blas_launch_status) {
           context->SetStatus(errors::Internal(
@@ -382,9 +547,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         bool blas_launch_status =
             stream
                 ->ThenBlasGemm(blas_transpose_b, blas_transpose_a, n, m, k,
-                               static_cast<Scalar>(1.0), *(b_ptrs[0]),
-                               adj_y ? k : n, *(a_ptrs[0]), adj_x ? m : k,
-                               static_cast<Scalar>(0.0), c_ptrs[0], n)
+                               static_cast<Scalar>(1.0), b_device_memory,
+                               adj_y ? k : n, a_device_memory, adj_x ? m : k,
+                               static_cast<Scalar>(0.0), &c_device_memory, n)
                 .ok();
         if (!blas_launch_status) {
           context->SetStatus(errors::Internal(
@@ -394,18 +559,23 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         }
       }
     } else {
+      // The matrices of each operand are contiguous, so the strided batched
+      // GEMM multiplies them without the arrays of pointers to the matrices.
+      // The scratch allocator only holds those arrays for the versions of
+      // cuBLAS without a strided batched GEMM.
       CublasScratchAllocator scratch_allocator(context);
       bool blas_launch_status =
           stream
-              ->ThenBlasGemmBatchedWithScratch(
+              ->ThenBlasGemmStridedBatchedWithScratch(
                   blas_transpose_b, blas_transpose_a, n, m, k,
-                  static_cast<Scalar>(1.0), b_ptrs, adj_y ? k : n, a_ptrs,
-                  adj_x ? m : k, static_cast<Scalar>(0.0), c_ptrs, n,
+                  static_cast<Scalar>(1.0), b_device_memory, adj_y ? k : n,
+                  k * n, a_device_memory, adj_x ? m : k, m * k,
+                  static_cast<Scalar>(0.0), &c_device_memory, n, m * n,
                   batch_size, &scratch_allocator)
               .ok();
       if (!blas_launch_status) {
         context->SetStatus(errors::Internal(
-            "Blas xGEMMBatched launch failed : a.shape=",
+            "Blas xGEMMStridedBatched launch failed : a.shape=",
             in_x.shape().DebugString(),
             ", b.shape=", in_y.shape().DebugString(), ", m=", m, ", n=", n,
             ", k=", k, ", batch_size=", batch_size));
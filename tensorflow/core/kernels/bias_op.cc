@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/x86_cwise_kernels.h"
 #include "tensorflow/core/util/tensor_format.h"
 
 #if GOOGLE_CUDA
@@ -36,6 +37,29 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Adds the biases with the kernel of x86_cwise_kernels.h, which handles float,
+// when it is enabled. Returns false otherwise.
+template <typename T>
+bool X86BiasAdd(const CPUDevice& d, const Tensor& input, const Tensor& bias,
+                Tensor* output) {
+  return false;
+}
+
+template <>
+bool X86BiasAdd<float>(const CPUDevice& d, const Tensor& input,
+                       const Tensor& bias, Tensor* output) {
+  if (!x86::CwiseKernelsEnabled()) return false;
+  const int64 cols = bias.NumElements();
+  x86::BiasAddFloat(d, input.flat<float>().data(), bias.flat<float>().data(),
+                    output->flat<float>().data(), input.NumElements() / cols,
+                    cols);
+  return true;
+}
+
+}  // namespace
+
 template <typename Device, typename T>
 class BiasOp;
 
@@ -98,10 +122,14 @@ class BiasOp<CPUDevice, T> : public BinaryOp<T> {
     }
   }
 
-  // Add biases for an input matrix of rank Dims, by using the Bias.
+  // Add biases for an input matrix of rank Dims, by using the x86 kernel if
+  // it applies and the Bias functor otherwise.
   template <int Dims>
   void Compute(OpKernelContext* ctx, const Tensor& input, const Tensor& bias,
                Tensor* output) {
+    if (X86BiasAdd<T>(ctx->eigen_device<Device>(), input, bias, output)) {
+      return;
+    }
     functor::Bias<Device, T, Dims> functor;
     functor(ctx->eigen_device<Device>(), input.tensor<T, Dims>(), bias.vec<T>(),
             output->tensor<T, Dims>());
@@ -0,0 +1,306 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/dataset.h"
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class CacheDatasetOp : public OpKernel {
+ public:
+  explicit CacheDatasetOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &input));
+    core::ScopedUnref unref_input(input);
+
+    const Tensor* filename_t;
+    OP_REQUIRES_OK(ctx, ctx->input("filename", &filename_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename_t->shape()),
+                errors::InvalidArgument("filename must be a scalar"));
+    const string& filename = filename_t->scalar<string>()();
+
+    DatasetBase* dataset;
+    if (filename.empty()) {
+      dataset = new MemoryDataset(input);
+    } else {
+      dataset = new FileDataset(ctx->env(), input, filename);
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->flat<ResourceHandle>()(0) = handle;
+  }
+
+ private:
+  // Caches the elements of `input` in host memory.
+  //
+  // The first iterator over the dataset reads from `input` and records
+  // the elements it produces. If it reaches the end of `input`, the
+  // recorded elements become the cache, and every iterator created after
+  // that reads from the cache instead of `input`. Iterators created while
+  // the cache is being filled by another iterator read from `input`
+  // without recording.
+  class MemoryDataset : public DatasetBase {
+   public:
+    explicit MemoryDataset(const DatasetBase* input) : input_(input) {
+      input_->Ref();
+    }
+
+    ~MemoryDataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      mutex_lock l(mu_);
+      if (cache_complete_) {
+        return std::unique_ptr<IteratorBase>(new ReaderIterator(this));
+      } else if (!writer_active_) {
+        writer_active_ = true;
+        return std::unique_ptr<IteratorBase>(new WriterIterator(this));
+      } else {
+        return input_->MakeIterator();
+      }
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() override { return "CacheDatasetOp::MemoryDataset"; }
+
+   private:
+    class WriterIterator : public DatasetIterator<MemoryDataset> {
+     public:
+      explicit WriterIterator(const MemoryDataset* dataset)
+          : DatasetIterator<MemoryDataset>(dataset),
+            input_impl_(dataset->input_->MakeIterator()) {}
+
+      ~WriterIterator() override {
+        if (!committed_) {
+          // The input was not read to the end, so the recorded elements
+          // are discarded and a later iterator may fill the cache.
+          mutex_lock l(dataset()->mu_);
+          dataset()->writer_active_ = false;
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          if (!committed_) {
+            mutex_lock dataset_l(dataset()->mu_);
+            dataset()->cache_ = std::move(elements_);
+            dataset()->cache_complete_ = true;
+            dataset()->writer_active_ = false;
+            committed_ = true;
+          }
+          return Status::OK();
+        }
+        // Tensors share their buffers, so this does not copy the element.
+        elements_.push_back(*out_tensors);
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      std::vector<std::vector<Tensor>> elements_ GUARDED_BY(mu_);
+      bool committed_ GUARDED_BY(mu_) = false;
+    };
+
+    class ReaderIterator : public DatasetIterator<MemoryDataset> {
+     public:
+      explicit ReaderIterator(const MemoryDataset* dataset)
+          : DatasetIterator<MemoryDataset>(dataset) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        mutex_lock dataset_l(dataset()->mu_);
+        const std::vector<std::vector<Tensor>>& cache = dataset()->cache_;
+        if (index_ < cache.size()) {
+          *out_tensors = cache[index_];
+          ++index_;
+          *end_of_sequence = false;
+        } else {
+          *end_of_sequence = true;
+        }
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      size_t index_ GUARDED_BY(mu_) = 0;
+    };
+
+    const DatasetBase* const input_;
+    mutable mutex mu_;
+    mutable bool writer_active_ GUARDED_BY(mu_) = false;
+    mutable bool cache_complete_ GUARDED_BY(mu_) = false;
+    mutable std::vector<std::vector<Tensor>> cache_ GUARDED_BY(mu_);
+  };
+
+  // Caches the elements of `input` in a tensor bundle at `filename`.
+  //
+  // If the bundle does not exist when an iterator is created, the
+  // iterator reads from `input` and writes each element to the bundle,
+  // which is finished when the end of `input` is reached. Otherwise, the
+  // iterator reads the elements from the bundle. Because the bundle is
+  // only visible once it has been finished, an incomplete cache (e.g.
+  // from an iterator that was destroyed early) is never read.
+  class FileDataset : public DatasetBase {
+   public:
+    FileDataset(Env* env, const DatasetBase* input, string filename)
+        : env_(env), input_(input), filename_(std::move(filename)) {
+      input_->Ref();
+    }
+
+    ~FileDataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      if (env_->FileExists(MetaFilename(filename_)).ok()) {
+        return std::unique_ptr<IteratorBase>(new ReaderIterator(this));
+      } else {
+        return std::unique_ptr<IteratorBase>(new WriterIterator(this));
+      }
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() override { return "CacheDatasetOp::FileDataset"; }
+
+   private:
+    // The key under which component `component` of element `index` is
+    // stored in the bundle.
+    static string Key(int64 index, size_t component) {
+      return strings::StrCat(index, "_", component);
+    }
+
+    class WriterIterator : public DatasetIterator<FileDataset> {
+     public:
+      explicit WriterIterator(const FileDataset* dataset)
+          : DatasetIterator<FileDataset>(dataset),
+            input_impl_(dataset->input_->MakeIterator()),
+            writer_(dataset->env_, dataset->filename_) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer_.status());
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          if (!finished_) {
+            finished_ = true;
+            return writer_.Finish();
+          }
+          return Status::OK();
+        }
+        for (size_t i = 0; i < out_tensors->size(); ++i) {
+          TF_RETURN_IF_ERROR(writer_.Add(Key(index_, i), (*out_tensors)[i]));
+        }
+        ++index_;
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      BundleWriter writer_ GUARDED_BY(mu_);
+      int64 index_ GUARDED_BY(mu_) = 0;
+      bool finished_ GUARDED_BY(mu_) = false;
+    };
+
+    class ReaderIterator : public DatasetIterator<FileDataset> {
+     public:
+      explicit ReaderIterator(const FileDataset* dataset)
+          : DatasetIterator<FileDataset>(dataset),
+            reader_(dataset->env_, dataset->filename_) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader_.status());
+        const size_t num_components = dataset()->output_dtypes().size();
+        if (!reader_.Contains(Key(index_, 0))) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        out_tensors->clear();
+        out_tensors->reserve(num_components);
+        for (size_t i = 0; i < num_components; ++i) {
+          const string key = Key(index_, i);
+          DataType dtype;
+          TensorShape shape;
+          TF_RETURN_IF_ERROR(reader_.LookupDtypeAndShape(key, &dtype, &shape));
+          if (dtype != dataset()->output_dtypes()[i]) {
+            return errors::InvalidArgument(
+                "Cached component ", i, " in ", dataset()->filename_,
+                " has type ", DataTypeString(dtype), " but the dataset has ",
+                DataTypeString(dataset()->output_dtypes()[i]));
+          }
+          out_tensors->emplace_back(cpu_allocator(), dtype, shape);
+          TF_RETURN_IF_ERROR(reader_.Lookup(key, &out_tensors->back()));
+        }
+        ++index_;
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      BundleReader reader_ GUARDED_BY(mu_);
+      int64 index_ GUARDED_BY(mu_) = 0;
+    };
+
+    Env* const env_;
+    const DatasetBase* const input_;
+    const string filename_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("CacheDataset").Device(DEVICE_CPU),
+                        CacheDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
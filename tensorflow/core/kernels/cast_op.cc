@@ -64,8 +64,12 @@ class CastOpBase : public OpKernel {
     if (work_ == nullptr) {
       ctx->set_output(0, inp);
     } else {
+      // Casts between types of the same size, e.g. int32 and float, are done
+      // in place when nothing else uses the input.
       Tensor* out = nullptr;
-      OP_REQUIRES_OK(ctx, ctx->allocate_output(0, inp.shape(), &out));
+      if (!ctx->forward_input_to_output_bitcast(0, 0, &out)) {
+        OP_REQUIRES_OK(ctx, ctx->allocate_output(0, inp.shape(), &out));
+      }
       work_(ctx, inp, out);
     }
   }
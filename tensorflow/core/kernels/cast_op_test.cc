@@ -89,6 +89,17 @@ TEST_ALL_CASTS_FROM(double)
 #undef TEST_ALL_CASTS_FROM
 #undef TEST_CAST
 
+TEST_F(CastOpTest, ForwardsInputOfSameSize) {
+  MakeOp(DT_INT32, DT_FLOAT);
+  AddInputFromArray<int32>(TensorShape({4}), {1, -2, 3, -4});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {1.0f, -2.0f, 3.0f, -4.0f});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+  EXPECT_EQ(GetInput(0).tensor_data().data(),
+            GetOutput(0)->tensor_data().data());
+}
+
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
 static void BM_cpu_float_int64(int iters, int num) {
@@ -126,6 +126,22 @@ class ConcatBaseOp : public OpKernel {
     } else {
       output_shape.set_dim(axis, output_concat_dim);
     }
+    // The inputs need no copy if they are adjacent in memory and concatenated
+    // along their outermost dimension, e.g. when they are the outputs of a
+    // Split or Unpack along it, or if a single one of them is not empty: the
+    // output is then a view of their buffer.
+    std::vector<const Tensor*> non_empty_values;
+    for (int i = 0; i < N; ++i) {
+      if (values[i].NumElements() > 0) non_empty_values.push_back(&values[i]);
+    }
+    if (inputs_flat_dim0 == 1 || non_empty_values.size() == 1) {
+      Tensor aliased_output;
+      if (Tensor::FromAdjacentSlices(non_empty_values, output_shape,
+                                     &aliased_output)) {
+        c->set_output(0, aliased_output);
+        return;
+      }
+    }
     Tensor* output = nullptr;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() > 0) {
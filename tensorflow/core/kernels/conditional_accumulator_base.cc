@@ -21,7 +21,10 @@ ConditionalAccumulatorBase::ConditionalAccumulatorBase(
     const DataType& dtype, const PartialTensorShape& shape, const string& name)
     : dtype_(dtype), shape_(shape), name_(name) {
   counter_ = 0;
+  num_applying_ = 0;
   current_global_step_ = 0;
+  unlocked_global_step_ = 0;
+  num_dropped_ = 0;
 }
 
 Status ConditionalAccumulatorBase::MatchesNodeDef(const NodeDef& node_def) {
@@ -42,9 +45,18 @@ Status ConditionalAccumulatorBase::SetGlobalStep(int64 new_global_step) {
                  << " >= " << new_global_step << " = new_global_step.";
   }
   current_global_step_ = new_global_step;
+  unlocked_global_step_.store(new_global_step, std::memory_order_release);
   return Status::OK();
 }
 
+bool ConditionalAccumulatorBase::DropIfStale(int64 local_step) {
+  if (local_step >= unlocked_global_step_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  num_dropped_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
 /**
  * Logs an attempt to extract the average gradient, and tries to flush all
  * TakeGrad attempts.
@@ -75,7 +87,8 @@ void ConditionalAccumulatorBase::TryTakeGrad(int num_required,
         takegrad_attempts_.emplace_back(
             num_required, callback, ctx, cm, token,
             [this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-              if (counter_ >= attempt->elements_requested) {
+              if (counter_ >= attempt->elements_requested &&
+                  num_applying_ == 0) {
                 bool successful_take_grad = TakeGradLockedHelper(
                     attempt->context, attempt->done_callback);
                 if (successful_take_grad) {
@@ -188,6 +201,11 @@ bool ConditionalAccumulatorBase::TakeGradLockedHelper(OpKernelContext* ctx,
 
   // Implicitly increment global_step
   current_global_step_++;
+  unlocked_global_step_.store(current_global_step_, std::memory_order_release);
+  const int64 num_dropped = num_dropped_.exchange(0, std::memory_order_relaxed);
+  VLOG(1) << "Accumulator " << name_ << " finished step "
+          << current_global_step_ - 1 << " with " << counter_
+          << " gradients; dropped " << num_dropped << " stale gradients";
 
   // Average the accumulated gradient
   DivideAccumGradByCounter(ctx);
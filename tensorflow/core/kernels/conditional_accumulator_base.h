@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_CONDITIONAL_ACCUMULATOR_BASE_H_
 #define TENSORFLOW_KERNELS_CONDITIONAL_ACCUMULATOR_BASE_H_
 
+#include <atomic>
 #include <deque>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -127,7 +128,17 @@ class ConditionalAccumulatorBase : public ResourceBase {
   const string name_;
   mutex mu_;
   int counter_ GUARDED_BY(mu_);
+  // The number of gradients being added outside mu_, which are counted in
+  // counter_ once they are done. TakeGrad waits for them.
+  int num_applying_ GUARDED_BY(mu_);
   int64 current_global_step_ GUARDED_BY(mu_);
+  // A copy of current_global_step_ that can be read without mu_, so that
+  // stale gradients (from backup workers that lost the race, or from
+  // stragglers) are dropped without waiting for an accumulation of a fresh
+  // gradient in progress. Updated whenever current_global_step_ changes.
+  std::atomic<int64> unlocked_global_step_;
+  // The number of stale gradients dropped since the last TakeGrad.
+  std::atomic<int64> num_dropped_;
 
   std::deque<Attempt> takegrad_attempts_ GUARDED_BY(mu_);
 
@@ -150,6 +161,11 @@ class ConditionalAccumulatorBase : public ResourceBase {
   bool TryAttemptLocked(std::vector<CleanUp>* clean_up)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns true if a gradient computed at "local_step" is stale, and counts
+  // it as dropped. The check is done again under mu_ before a gradient that
+  // passes it is applied.
+  bool DropIfStale(int64 local_step);
+
   // Helper methods
   //  void DeepCopy(Tensor* dst);
   bool TakeGradLockedHelper(OpKernelContext* ctx, DoneCallback callback)
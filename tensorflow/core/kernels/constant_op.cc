@@ -121,6 +121,21 @@ REGISTER_KERNEL_BUILDER(Name("Const")
                             .HostMemory("output")
                             .TypeConstraint<int32>("dtype"),
                         HostConstantOp);
+
+// Constants of the scalar predicate of a loop on the GPU, which
+// HostLoopPredicatePass labels "host" so that they stay in host memory.
+#define REGISTER_HOST_LABEL_KERNEL(TYPE)                      \
+  REGISTER_KERNEL_BUILDER(Name("Const")                       \
+                              .Device(DEVICE_GPU)             \
+                              .HostMemory("output")           \
+                              .TypeConstraint<TYPE>("dtype")  \
+                              .Label("host"),                 \
+                          HostConstantOp);
+REGISTER_HOST_LABEL_KERNEL(float);
+REGISTER_HOST_LABEL_KERNEL(double);
+REGISTER_HOST_LABEL_KERNEL(int64);
+REGISTER_HOST_LABEL_KERNEL(bool);
+#undef REGISTER_HOST_LABEL_KERNEL
 #endif
 
 #ifdef TENSORFLOW_USE_SYCL
@@ -21,6 +21,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/conv_ops.h"
 #include <string.h>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -30,7 +32,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/conv_2d.h"
+#include "tensorflow/core/kernels/conv_ops_autotune.h"
 #include "tensorflow/core/kernels/deep_conv2d.h"
+#include "tensorflow/core/kernels/fused_bias_activation.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #ifdef TENSORFLOW_USE_LIBXSMM
 #include "tensorflow/core/kernels/xsmm_conv2d.h"
@@ -39,8 +43,11 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -157,7 +164,18 @@ class LaunchDeepConvOp<CPUDevice, float> {
                           in_depth, out_depth, out_rows, out_cols)) {
       return false;
     }
+    Launch(ctx, input, filter, batch, input_rows, input_cols, in_depth,
+           filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
+           out_depth, output);
+    return true;
+  }
 
+  // Launches DeepConv2D, which must support the convolution.
+  static void Launch(OpKernelContext* ctx, const Tensor& input,
+                     const Tensor& filter, int batch, int input_rows,
+                     int input_cols, int in_depth, int filter_rows,
+                     int filter_cols, int pad_rows, int pad_cols, int out_rows,
+                     int out_cols, int out_depth, Tensor* output) {
     Conv2DArgs args;
     args.batch = batch;
     args.in_rows = input_rows;
@@ -177,7 +195,6 @@ class LaunchDeepConvOp<CPUDevice, float> {
 
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
-    return true;
   }
 };
 
@@ -250,10 +267,242 @@ class LaunchXsmmConvOp<CPUDevice, float> {
 };
 #endif
 
+namespace {
+
+// The algorithms that compute Conv2D on CPU.
+enum class CpuConvAlgorithm { kEigen, kDeepConv, kXsmm };
+
+const char* CpuConvAlgorithmName(CpuConvAlgorithm algorithm) {
+  switch (algorithm) {
+    case CpuConvAlgorithm::kEigen:
+      return "eigen";
+    case CpuConvAlgorithm::kDeepConv:
+      return "deep_conv";
+    case CpuConvAlgorithm::kXsmm:
+      return "xsmm";
+  }
+  return "unknown";
+}
+
+bool CpuConvAlgorithmFromName(StringPiece name, CpuConvAlgorithm* algorithm) {
+  for (CpuConvAlgorithm candidate :
+       {CpuConvAlgorithm::kEigen, CpuConvAlgorithm::kDeepConv,
+        CpuConvAlgorithm::kXsmm}) {
+    if (name == CpuConvAlgorithmName(candidate)) {
+      *algorithm = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// The config of the AutoTuneMap of the CPU convolutions.
+class CpuConvConfig {
+ public:
+  CpuConvConfig() : algorithm_(CpuConvAlgorithm::kEigen) {}
+  explicit CpuConvConfig(CpuConvAlgorithm algorithm) : algorithm_(algorithm) {}
+
+  CpuConvAlgorithm algorithm() const { return algorithm_; }
+
+  bool operator==(const CpuConvConfig& other) const {
+    return algorithm_ == other.algorithm_;
+  }
+  bool operator!=(const CpuConvConfig& other) const {
+    return !(*this == other);
+  }
+  string ToString() const { return CpuConvAlgorithmName(algorithm_); }
+
+ private:
+  CpuConvAlgorithm algorithm_;
+};
+
+struct CpuConvAutoTuneGroup {
+  static string name() { return "CpuConv"; }
+};
+typedef AutoTuneSingleton<CpuConvAutoTuneGroup, ConvParameters, CpuConvConfig>
+    AutoTuneCpuConv;
+
+// Returns true if the CPU convolutions time their algorithms on first use to
+// pick the fastest. This is off by default since the algorithms do not round
+// the same way.
+bool CpuConvUseAutotune() {
+  bool value;
+  Status status = ReadBoolFromEnvVar("TF_CPU_CONV_USE_AUTOTUNE", false, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  return value;
+}
+
+// The autotuned algorithms saved in the file named by the environment
+// variable TF_CPU_CONV_AUTOTUNE_FILE, if it is set, so that other processes
+// don't need to time them again. Each line of the file is the parameters of a
+// convolution and its algorithm, separated by a tab.
+class CpuConvAutoTuneFile {
+ public:
+  static CpuConvAutoTuneFile* Get() {
+    static CpuConvAutoTuneFile* file = new CpuConvAutoTuneFile;
+    return file;
+  }
+
+  bool Find(const ConvParameters& params, CpuConvAlgorithm* algorithm) const {
+    mutex_lock l(mu_);
+    auto it = algorithms_.find(params.ToString());
+    if (it == algorithms_.end()) return false;
+    *algorithm = it->second;
+    return true;
+  }
+
+  void Insert(const ConvParameters& params, CpuConvAlgorithm algorithm) {
+    if (filename_.empty()) return;
+    const string key = params.ToString();
+    mutex_lock l(mu_);
+    if (!algorithms_.emplace(key, algorithm).second) return;
+    std::unique_ptr<WritableFile> file;
+    Status s = Env::Default()->NewAppendableFile(filename_, &file);
+    if (s.ok()) {
+      s = file->Append(
+          strings::StrCat(key, "\t", CpuConvAlgorithmName(algorithm), "\n"));
+    }
+    if (s.ok()) s = file->Close();
+    if (!s.ok()) {
+      LOG(WARNING) << "Could not save the CPU convolution algorithms to "
+                   << filename_ << ": " << s;
+    }
+  }
+
+ private:
+  CpuConvAutoTuneFile() {
+    Status s =
+        ReadStringFromEnvVar("TF_CPU_CONV_AUTOTUNE_FILE", "", &filename_);
+    if (s.ok() && !filename_.empty() &&
+        Env::Default()->FileExists(filename_).ok()) {
+      string contents;
+      s = ReadFileToString(Env::Default(), filename_, &contents);
+      for (StringPiece line : str_util::Split(contents, '\n')) {
+        std::vector<string> fields = str_util::Split(line, '\t');
+        CpuConvAlgorithm algorithm;
+        if (fields.size() == 2 &&
+            CpuConvAlgorithmFromName(fields[1], &algorithm)) {
+          algorithms_[fields[0]] = algorithm;
+        }
+      }
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Could not read the CPU convolution algorithms from "
+                   << filename_ << ": " << s;
+    }
+  }
+
+  string filename_;
+  mutable mutex mu_;
+  std::unordered_map<string, CpuConvAlgorithm> algorithms_ GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+// Launches the fastest algorithm of the convolution when autotuning is on.
+// The first times a convolution of given parameters runs, all the algorithms
+// that support it run and are timed, and the fastest one is kept.
+template <typename Device, typename T>
+class LaunchAutotunedConvOp {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, int batch, int input_rows,
+                  int input_cols, int in_depth, int filter_rows,
+                  int filter_cols, int pad_rows, int pad_cols, int out_rows,
+                  int out_cols, int out_depth, int stride_rows, int stride_cols,
+                  Padding padding, Tensor* output, TensorFormat data_format) {
+    return false;
+  }
+};
+
+template <>
+class LaunchAutotunedConvOp<CPUDevice, float> {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, int batch, int input_rows,
+                  int input_cols, int in_depth, int filter_rows,
+                  int filter_cols, int pad_rows, int pad_cols, int out_rows,
+                  int out_cols, int out_depth, int stride_rows, int stride_cols,
+                  Padding padding, Tensor* output, TensorFormat data_format) {
+    if (data_format != FORMAT_NHWC) return false;
+
+    // Runs an algorithm, or returns false if it does not support the
+    // convolution.
+    auto launch = [&](CpuConvAlgorithm algorithm) {
+      switch (algorithm) {
+        case CpuConvAlgorithm::kEigen:
+          LaunchGeneric<CPUDevice, float>::launch(
+              ctx, input, filter, stride_rows, stride_cols,
+              BrainPadding2EigenPadding(padding), output, data_format);
+          return true;
+        case CpuConvAlgorithm::kDeepConv:
+          if (!DeepConv2DSupports(stride_rows, stride_cols, filter_rows,
+                                  filter_cols)) {
+            return false;
+          }
+          LaunchDeepConvOp<CPUDevice, float>::Launch(
+              ctx, input, filter, batch, input_rows, input_cols, in_depth,
+              filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
+              out_depth, output);
+          return true;
+        case CpuConvAlgorithm::kXsmm:
+#ifdef TENSORFLOW_USE_LIBXSMM
+          return LaunchXsmmConvOp<CPUDevice, float>::Run(
+              ctx, input, filter, batch, input_rows, input_cols, in_depth,
+              filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
+              out_depth, stride_rows, stride_cols, output, data_format);
+#else
+          return false;
+#endif
+      }
+      return false;
+    };
+
+    ConvParameters params(batch, in_depth, {input_rows, input_cols}, out_depth,
+                          {filter_rows, filter_cols},
+                          {stride_rows, stride_cols}, {pad_rows, pad_cols},
+                          DT_FLOAT, 0);
+    CpuConvConfig config;
+    CpuConvAlgorithm algorithm;
+    if (AutoTuneCpuConv::GetInstance()->Find(params, &config)) {
+      return launch(config.algorithm());
+    }
+    if (CpuConvAutoTuneFile::Get()->Find(params, &algorithm)) {
+      AutoTuneCpuConv::GetInstance()->Insert(params, CpuConvConfig(algorithm));
+      return launch(algorithm);
+    }
+
+    // Time the algorithms. The output is the one of the last that runs.
+    CpuConvAlgorithm best_algorithm = CpuConvAlgorithm::kEigen;
+    uint64 best_time = kuint64max;
+    for (CpuConvAlgorithm candidate :
+         {CpuConvAlgorithm::kEigen, CpuConvAlgorithm::kDeepConv,
+          CpuConvAlgorithm::kXsmm}) {
+      const uint64 start = Env::Default()->NowMicros();
+      if (!launch(candidate)) continue;
+      if (!ctx->status().ok()) return true;
+      const uint64 time = Env::Default()->NowMicros() - start;
+      VLOG(2) << "Conv2D " << params.ToString() << " with "
+              << CpuConvAlgorithmName(candidate) << ": " << time << "us";
+      if (time < best_time) {
+        best_algorithm = candidate;
+        best_time = time;
+      }
+    }
+    AutoTuneCpuConv::GetInstance()->Insert(params,
+                                           CpuConvConfig(best_algorithm));
+    CpuConvAutoTuneFile::Get()->Insert(params, best_algorithm);
+    return true;
+  }
+};
+
+// Not a BinaryOp, since FusedConv2DOp has more inputs.
 template <typename Device, typename T>
-class Conv2DOp : public BinaryOp<T> {
+class Conv2DOp : public OpKernel {
  public:
-  explicit Conv2DOp(OpKernelConstruction* context) : BinaryOp<T>(context) {
+  explicit Conv2DOp(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
     string data_format;
     OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
@@ -262,6 +511,7 @@ class Conv2DOp : public BinaryOp<T> {
     OP_REQUIRES_OK(context, context->GetAttr("use_cudnn_on_gpu", &use_cudnn_));
     use_cudnn_ &= CanUseCudnn();
     cudnn_use_autotune_ = CudnnUseAutotune();
+    cpu_use_autotune_ = CpuConvUseAutotune();
     OP_REQUIRES(context, strides_.size() == 4,
                 errors::InvalidArgument("Sliding window strides field must "
                                         "specify 4 dimensions"));
@@ -371,6 +621,15 @@ class Conv2DOp : public BinaryOp<T> {
       return;
     }
 
+    if (cpu_use_autotune_ &&
+        LaunchAutotunedConvOp<Device, T>::Run(
+            context, input, filter, batch, input_rows, input_cols, in_depth,
+            filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
+            out_depth, stride_rows, stride_cols, padding_, output,
+            data_format_)) {
+      return;
+    }
+
 #ifdef TENSORFLOW_USE_LIBXSMM
     if (LaunchXsmmConvOp<Device, T>::Run(
             context, input, filter, batch, input_rows, input_cols, in_depth,
@@ -392,17 +651,55 @@ class Conv2DOp : public BinaryOp<T> {
                      BrainPadding2EigenPadding(padding_), output, data_format_);
   }
 
- private:
+ protected:
   std::vector<int32> strides_;
   bool use_cudnn_;
   Padding padding_;
   TensorFormat data_format_;
   LaunchConv2DOp<Device, T> launcher_;
   bool cudnn_use_autotune_;
+  bool cpu_use_autotune_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(Conv2DOp);
 };
 
+// A Conv2D followed by a BiasAdd or an inference FusedBatchNorm, and
+// optionally an activation, which are applied in place to the output of the
+// convolution in a single pass.
+template <typename Device, typename T>
+class FusedConv2DOp : public Conv2DOp<Device, T> {
+ public:
+  explicit FusedConv2DOp(OpKernelConstruction* context)
+      : Conv2DOp<Device, T>(context) {
+    OP_REQUIRES_OK(context, fused_ops_.Init(context));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    Conv2DOp<Device, T>::Compute(context);
+    if (!context->status().ok()) {
+      return;
+    }
+    Tensor* output = context->mutable_output(0);
+    const TensorFormat data_format = this->data_format_;
+    const int64 batch = GetTensorDim(*output, data_format, 'N');
+    const int64 channels = GetTensorDim(*output, data_format, 'C');
+    const int64 spatial = GetTensorDim(*output, data_format, 'H') *
+                          GetTensorDim(*output, data_format, 'W');
+    if (data_format == FORMAT_NHWC) {
+      fused_ops_.Apply<Device, T>(context, 2, batch * spatial, channels, 1,
+                                  output);
+    } else {
+      fused_ops_.Apply<Device, T>(context, 2, batch, channels, spatial,
+                                  output);
+    }
+  }
+
+ private:
+  FusedBiasActivationOps fused_ops_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConv2DOp);
+};
+
 #define REGISTER_CPU(T)                                         \
   REGISTER_KERNEL_BUILDER(                                      \
       Name("Conv2D").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
@@ -415,6 +712,10 @@ TF_CALL_half(REGISTER_CPU);
 TF_CALL_float(REGISTER_CPU);
 #endif  // USE_GEMM_FOR_CONV
 
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedConv2D").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    FusedConv2DOp<CPUDevice, float>);
+
 // To be used inside depthwise_conv_op.cc.
 template class LaunchConv2DOp<CPUDevice, float>;
 
@@ -780,6 +1081,9 @@ REGISTER_KERNEL_BUILDER(
 REGISTER_KERNEL_BUILDER(
     Name("Conv2D").Device(DEVICE_GPU).TypeConstraint<float>("T"),
     Conv2DOp<GPUDevice, float>);
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedConv2D").Device(DEVICE_GPU).TypeConstraint<float>("T"),
+    FusedConv2DOp<GPUDevice, float>);
 
 // To be used inside depthwise_conv_op.cc.
 template class LaunchConv2DOp<GPUDevice, float>;
@@ -21,9 +21,15 @@ limitations under the License.
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
@@ -72,6 +78,83 @@ TEST(ConvParameters, WinogradNonfusedAlgoSize) {
 
 #endif  // GOOGLE_CUDA
 
+class Conv2DAutotuneTest : public OpsTestBase {
+ protected:
+  // Runs a SAME 3x3 convolution, which all the algorithms support, and checks
+  // it against a direct computation.
+  void RunConv() {
+    const int batch = 2, rows = 7, cols = 9, in_depth = 3, out_depth = 5;
+    Tensor input(DT_FLOAT, TensorShape({batch, rows, cols, in_depth}));
+    Tensor filter(DT_FLOAT, TensorShape({3, 3, in_depth, out_depth}));
+    input.flat<float>().setRandom();
+    filter.flat<float>().setRandom();
+    TF_ASSERT_OK(NodeDefBuilder("conv", "Conv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("strides", {1, 1, 1, 1})
+                     .Attr("padding", "SAME")
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<float>(input.shape(),
+                             gtl::ArraySlice<float>(input.flat<float>().data(),
+                                                    input.NumElements()));
+    AddInputFromArray<float>(
+        filter.shape(), gtl::ArraySlice<float>(filter.flat<float>().data(),
+                                               filter.NumElements()));
+
+    Tensor expected(DT_FLOAT, TensorShape({batch, rows, cols, out_depth}));
+    auto in = input.tensor<float, 4>();
+    auto f = filter.tensor<float, 4>();
+    auto e = expected.tensor<float, 4>();
+    for (int b = 0; b < batch; ++b) {
+      for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+          for (int d = 0; d < out_depth; ++d) {
+            float sum = 0;
+            for (int fr = 0; fr < 3; ++fr) {
+              for (int fc = 0; fc < 3; ++fc) {
+                const int ir = r + fr - 1, ic = c + fc - 1;
+                if (ir < 0 || ir >= rows || ic < 0 || ic >= cols) continue;
+                for (int k = 0; k < in_depth; ++k) {
+                  sum += in(b, ir, ic, k) * f(fr, fc, k, d);
+                }
+              }
+            }
+            e(b, r, c, d) = sum;
+          }
+        }
+      }
+    }
+
+    // The first run times the algorithms, the second one uses the fastest.
+    for (int i = 0; i < 2; ++i) {
+      TF_ASSERT_OK(RunOpKernel());
+      test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+    }
+  }
+};
+
+TEST_F(Conv2DAutotuneTest, SavesFastestAlgorithm) {
+  const string filename = io::JoinPath(testing::TmpDir(), "cpu_conv_autotune");
+  Env::Default()->DeleteFile(filename).IgnoreError();
+  setenv("TF_CPU_CONV_USE_AUTOTUNE", "1", 1);
+  setenv("TF_CPU_CONV_AUTOTUNE_FILE", filename.c_str(), 1);
+  RunConv();
+  unsetenv("TF_CPU_CONV_USE_AUTOTUNE");
+  unsetenv("TF_CPU_CONV_AUTOTUNE_FILE");
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  std::vector<string> lines =
+      str_util::Split(contents, '\n', str_util::SkipEmpty());
+  ASSERT_EQ(1, lines.size());
+  std::vector<string> fields = str_util::Split(lines[0], '\t');
+  ASSERT_EQ(2, fields.size());
+  EXPECT_TRUE(fields[1] == "eigen" || fields[1] == "deep_conv" ||
+              fields[1] == "xsmm")
+      << fields[1];
+}
+
 class FusedResizePadConvOpTest : public OpsTestBase {
  protected:
   void HandwrittenConv() {
@@ -346,4 +429,148 @@ TEST_F(FusedResizePadConvOpTest, ResizeAndPadSymmetricComparativeLarge) {
                           "SYMMETRIC", 1, "SAME");
 }
 
+class FusedConv2DOpTest : public OpsTestBase {
+ protected:
+  // Runs Conv2D followed by the separate `fused_ops`, and _FusedConv2D with
+  // the same ops, and checks that their outputs match.
+  void CompareFusedAndSeparate(int image_width, int image_height, int depth,
+                               int filter_size, int filter_count,
+                               const std::vector<string>& fused_ops,
+                               const string& padding) {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor image_data(DT_FLOAT,
+                      TensorShape({2, image_height, image_width, depth}));
+    image_data.flat<float>().setRandom();
+    Output image =
+        Const(root.WithOpName("image"), Input::Initializer(image_data));
+
+    Tensor filter_data(DT_FLOAT, TensorShape({filter_size, filter_size, depth,
+                                              filter_count}));
+    filter_data.flat<float>().setRandom();
+    Output filter =
+        Const(root.WithOpName("filter"), Input::Initializer(filter_data));
+
+    std::vector<Output> args;
+    for (int i = 0; i < (fused_ops[0] == "BiasAdd" ? 1 : 4); ++i) {
+      Tensor arg_data(DT_FLOAT, TensorShape({filter_count}));
+      arg_data.flat<float>().setRandom();
+      // Keeps the variance of the batch normalization away from zero.
+      arg_data.flat<float>() = arg_data.flat<float>().abs() + 0.5f;
+      args.push_back(Const(root.WithOpName(strings::StrCat("arg", i)),
+                           Input::Initializer(arg_data)));
+    }
+
+    Output conv = Conv2D(root.WithOpName("conv"), image, filter, {1, 1, 1, 1},
+                         padding);
+    Output unfused;
+    if (fused_ops[0] == "BiasAdd") {
+      unfused = BiasAdd(root.WithOpName("bias_add"), conv, args[0]);
+    } else {
+      unfused = FusedBatchNorm(root.WithOpName("batch_norm"), conv, args[0],
+                               args[1], args[2], args[3],
+                               FusedBatchNorm::IsTraining(false))
+                    .y;
+    }
+    if (fused_ops.size() > 1 && fused_ops[1] == "Relu") {
+      unfused = Relu(root.WithOpName("relu"), unfused);
+    } else if (fused_ops.size() > 1 && fused_ops[1] == "Relu6") {
+      unfused = Relu6(root.WithOpName("relu6"), unfused);
+    } else if (fused_ops.size() > 1 && fused_ops[1] == "Elu") {
+      unfused = Elu(root.WithOpName("elu"), unfused);
+    }
+    Output unfused_output = Identity(root.WithOpName("unfused"), unfused);
+
+    tensorflow::GraphDef graph;
+    TF_ASSERT_OK(root.ToGraphDef(&graph));
+
+    std::vector<NodeDefBuilder::NodeOut> fused_args;
+    for (int i = 0; i < args.size(); ++i) {
+      fused_args.emplace_back(strings::StrCat("arg", i), 0, DT_FLOAT);
+    }
+    TF_ASSERT_OK(NodeDefBuilder("fused", "_FusedConv2D")
+                     .Input("image", 0, DT_FLOAT)
+                     .Input("filter", 0, DT_FLOAT)
+                     .Input(fused_args)
+                     .Attr("T", DT_FLOAT)
+                     .Attr("num_args", static_cast<int>(args.size()))
+                     .Attr("strides", {1, 1, 1, 1})
+                     .Attr("padding", padding)
+                     .Attr("fused_ops", fused_ops)
+                     .Attr("epsilon", 0.0001f)
+                     .Finalize(graph.add_node()));
+
+    std::unique_ptr<tensorflow::Session> session(
+        tensorflow::NewSession(tensorflow::SessionOptions()));
+    TF_ASSERT_OK(session->Create(graph));
+
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {"unfused", "fused"}, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+
+    test::ExpectTensorNear<float>(outputs[0], outputs[1], 1e-4);
+  }
+};
+
+TEST_F(FusedConv2DOpTest, HandwrittenBiasAddRelu) {
+  TF_EXPECT_OK(NodeDefBuilder("fused_conv_op", "_FusedConv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("num_args", 1)
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "VALID")
+                   .Attr("fused_ops", {"BiasAdd", "Relu"})
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+
+  // A 1x1 convolution of a 1x2x2x1 image with two filters, 1 and -1.
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 1, 2}), {1, -1});
+  AddInputFromArray<float>(TensorShape({2}), {-2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // relu(x - 2) for the first channel and relu(3 - x) for the second one.
+  Tensor expected(DT_FLOAT, TensorShape({1, 2, 2, 2}));
+  test::FillValues<float>(&expected, {0, 2, 0, 1, 1, 0, 2, 0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedConv2DOpTest, UnsupportedFusedOps) {
+  TF_EXPECT_OK(NodeDefBuilder("fused_conv_op", "_FusedConv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("num_args", 1)
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "VALID")
+                   .Attr("fused_ops", {"Relu", "BiasAdd"})
+                   .Finalize(node_def()));
+  EXPECT_EQ(error::UNIMPLEMENTED, InitOp().code());
+}
+
+TEST_F(FusedConv2DOpTest, BiasAddComparative) {
+  CompareFusedAndSeparate(5, 4, 3, 3, 4, {"BiasAdd"}, "SAME");
+}
+
+TEST_F(FusedConv2DOpTest, BiasAddReluComparative) {
+  CompareFusedAndSeparate(5, 4, 3, 3, 4, {"BiasAdd", "Relu"}, "SAME");
+}
+
+TEST_F(FusedConv2DOpTest, BiasAddEluComparative) {
+  CompareFusedAndSeparate(5, 4, 3, 2, 4, {"BiasAdd", "Elu"}, "VALID");
+}
+
+TEST_F(FusedConv2DOpTest, BatchNormComparative) {
+  CompareFusedAndSeparate(5, 4, 3, 3, 4, {"FusedBatchNorm"}, "SAME");
+}
+
+TEST_F(FusedConv2DOpTest, BatchNormRelu6Comparative) {
+  CompareFusedAndSeparate(5, 4, 3, 3, 4, {"FusedBatchNorm", "Relu6"},
+                          "VALID");
+}
+
 }  // namespace tensorflow
@@ -44,6 +44,8 @@ REGISTER_KERNEL_BUILDER(Name("Equal")
                             .HostMemory("z")
                             .TypeConstraint<int32>("T"),
                         BinaryOp<CPUDevice, functor::equal_to<int32>>);
+REGISTER_GPU_HOST_LABEL("Equal", functor::equal_to, float);
+REGISTER_GPU_HOST_LABEL("Equal", functor::equal_to, double);
 #endif
 
 #ifdef TENSORFLOW_USE_SYCL
@@ -32,6 +32,9 @@ REGISTER_KERNEL_BUILDER(Name("Greater")
                             .HostMemory("z")
                             .TypeConstraint<int32>("T"),
                         BinaryOp<CPUDevice, functor::greater<int32>>);
+REGISTER_GPU_HOST_LABEL("Greater", functor::greater, float);
+REGISTER_GPU_HOST_LABEL("Greater", functor::greater, double);
+REGISTER_GPU_HOST_LABEL("Greater", functor::greater, int64);
 #endif
 #ifdef TENSORFLOW_USE_SYCL
 REGISTER(BinaryOp, SYCL, "Greater", functor::greater, float);
@@ -32,6 +32,9 @@ REGISTER_KERNEL_BUILDER(Name("GreaterEqual")
                             .HostMemory("z")
                             .TypeConstraint<int32>("T"),
                         BinaryOp<CPUDevice, functor::greater_equal<int32>>);
+REGISTER_GPU_HOST_LABEL("GreaterEqual", functor::greater_equal, float);
+REGISTER_GPU_HOST_LABEL("GreaterEqual", functor::greater_equal, double);
+REGISTER_GPU_HOST_LABEL("GreaterEqual", functor::greater_equal, int64);
 #endif
 
 #ifdef TENSORFLOW_USE_SYCL
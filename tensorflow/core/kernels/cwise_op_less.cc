@@ -32,6 +32,9 @@ REGISTER_KERNEL_BUILDER(Name("Less")
                             .HostMemory("z")
                             .TypeConstraint<int32>("T"),
                         BinaryOp<CPUDevice, functor::less<int32>>);
+REGISTER_GPU_HOST_LABEL("Less", functor::less, float);
+REGISTER_GPU_HOST_LABEL("Less", functor::less, double);
+REGISTER_GPU_HOST_LABEL("Less", functor::less, int64);
 #endif
 #ifdef TENSORFLOW_USE_SYCL
 REGISTER3(BinaryOp, SYCL, "Less", functor::less, float, double, int64);
@@ -32,6 +32,9 @@ REGISTER_KERNEL_BUILDER(Name("LessEqual")
                             .HostMemory("z")
                             .TypeConstraint<int32>("T"),
                         BinaryOp<CPUDevice, functor::less_equal<int32>>);
+REGISTER_GPU_HOST_LABEL("LessEqual", functor::less_equal, float);
+REGISTER_GPU_HOST_LABEL("LessEqual", functor::less_equal, double);
+REGISTER_GPU_HOST_LABEL("LessEqual", functor::less_equal, int64);
 #endif
 
 #ifdef TENSORFLOW_USE_SYCL
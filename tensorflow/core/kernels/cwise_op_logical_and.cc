@@ -21,5 +21,12 @@ REGISTER_KERNEL_BUILDER(Name("LogicalAnd").Device(DEVICE_CPU),
 #if GOOGLE_CUDA
 REGISTER_KERNEL_BUILDER(Name("LogicalAnd").Device(DEVICE_GPU),
                         BinaryOp<GPUDevice, functor::logical_and>);
+REGISTER_KERNEL_BUILDER(Name("LogicalAnd")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("x")
+                            .HostMemory("y")
+                            .HostMemory("z")
+                            .Label("host"),
+                        BinaryOp<CPUDevice, functor::logical_and>);
 #endif
 }  // namespace tensorflow
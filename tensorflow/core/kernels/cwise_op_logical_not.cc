@@ -21,5 +21,11 @@ REGISTER_KERNEL_BUILDER(Name("LogicalNot").Device(DEVICE_CPU),
 #if GOOGLE_CUDA
 REGISTER_KERNEL_BUILDER(Name("LogicalNot").Device(DEVICE_GPU),
                         UnaryOp<GPUDevice, functor::logical_not>);
+REGISTER_KERNEL_BUILDER(Name("LogicalNot")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("x")
+                            .HostMemory("y")
+                            .Label("host"),
+                        UnaryOp<CPUDevice, functor::logical_not>);
 #endif
 }  // namespace tensorflow
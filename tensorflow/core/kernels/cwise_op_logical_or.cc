@@ -21,5 +21,12 @@ REGISTER_KERNEL_BUILDER(Name("LogicalOr").Device(DEVICE_CPU),
 #if GOOGLE_CUDA
 REGISTER_KERNEL_BUILDER(Name("LogicalOr").Device(DEVICE_GPU),
                         BinaryOp<GPUDevice, functor::logical_or>);
+REGISTER_KERNEL_BUILDER(Name("LogicalOr")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("x")
+                            .HostMemory("y")
+                            .HostMemory("z")
+                            .Label("host"),
+                        BinaryOp<CPUDevice, functor::logical_or>);
 #endif
 }  // namespace tensorflow
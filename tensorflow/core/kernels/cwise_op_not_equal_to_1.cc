@@ -21,5 +21,7 @@ REGISTER6(BinaryOp, CPU, "NotEqual", functor::not_equal_to, float, Eigen::half,
 #if GOOGLE_CUDA
 REGISTER4(BinaryOp, GPU, "NotEqual", functor::not_equal_to, float, Eigen::half,
           double, uint8);
+REGISTER_GPU_HOST_LABEL("NotEqual", functor::not_equal_to, float);
+REGISTER_GPU_HOST_LABEL("NotEqual", functor::not_equal_to, double);
 #endif
 }  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cwise_ops.h"
 #include "tensorflow/core/kernels/cwise_ops_gradients.h"
+#include "tensorflow/core/kernels/x86_cwise_kernels.h"
 
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -255,6 +256,81 @@ void Assign(const D& d, Out out, Rhs rhs) {
   out.device(d) = rhs;
 }
 
+// The functors with a kernel in x86_cwise_kernels.h, which is used instead
+// of Eigen when it is enabled. The calls return false when it is not, or
+// when the functor has no such kernel, for the caller to use Eigen.
+struct NoX86CwiseKernel {
+  template <typename Tout, typename Tin>
+  static bool Binary(const CPUDevice& d, Tout* out, const Tin* in0,
+                     const Tin* in1, int64 n) {
+    return false;
+  }
+  // out[i] = in[i] op scalar, or scalar op in[i], which is the same as for
+  // the functors with a kernel, which commute.
+  template <typename Tout, typename Tin>
+  static bool BinaryScalar(const CPUDevice& d, Tout* out, const Tin* in,
+                           Tin scalar, int64 n) {
+    return false;
+  }
+  template <typename Tout, typename Tin>
+  static bool Unary(const CPUDevice& d, Tout* out, const Tin* in, int64 n) {
+    return false;
+  }
+};
+
+template <typename Functor>
+struct X86CwiseKernel : NoX86CwiseKernel {};
+
+template <>
+struct X86CwiseKernel<add<float>> : NoX86CwiseKernel {
+  static bool Binary(const CPUDevice& d, float* out, const float* in0,
+                     const float* in1, int64 n) {
+    if (!x86::CwiseKernelsEnabled()) return false;
+    x86::AddFloat(d, in0, in1, out, n);
+    return true;
+  }
+  static bool BinaryScalar(const CPUDevice& d, float* out, const float* in,
+                           float scalar, int64 n) {
+    if (!x86::CwiseKernelsEnabled()) return false;
+    x86::AddScalarFloat(d, in, scalar, out, n);
+    return true;
+  }
+};
+
+template <>
+struct X86CwiseKernel<mul<float>> : NoX86CwiseKernel {
+  static bool Binary(const CPUDevice& d, float* out, const float* in0,
+                     const float* in1, int64 n) {
+    if (!x86::CwiseKernelsEnabled()) return false;
+    x86::MulFloat(d, in0, in1, out, n);
+    return true;
+  }
+  static bool BinaryScalar(const CPUDevice& d, float* out, const float* in,
+                           float scalar, int64 n) {
+    if (!x86::CwiseKernelsEnabled()) return false;
+    x86::MulScalarFloat(d, in, scalar, out, n);
+    return true;
+  }
+};
+
+template <>
+struct X86CwiseKernel<tanh<float>> : NoX86CwiseKernel {
+  static bool Unary(const CPUDevice& d, float* out, const float* in, int64 n) {
+    if (!x86::CwiseKernelsEnabled()) return false;
+    x86::TanhFloat(d, in, out, n);
+    return true;
+  }
+};
+
+template <>
+struct X86CwiseKernel<sigmoid<float>> : NoX86CwiseKernel {
+  static bool Unary(const CPUDevice& d, float* out, const float* in, int64 n) {
+    if (!x86::CwiseKernelsEnabled()) return false;
+    x86::SigmoidFloat(d, in, out, n);
+    return true;
+  }
+};
+
 // Partial specialization of BinaryFunctor<Device=CPUDevice, Functor, NDIMS>
 // for functors with with no error checking.
 template <typename Functor, int NDIMS>
@@ -262,6 +338,10 @@ struct BinaryFunctor<CPUDevice, Functor, NDIMS, false> {
   void operator()(const CPUDevice& d, typename Functor::tout_type out,
                   typename Functor::tin_type in0,
                   typename Functor::tin_type in1, bool* error) {
+    if (X86CwiseKernel<Functor>::Binary(d, out.data(), in0.data(), in1.data(),
+                                        out.size())) {
+      return;
+    }
     Assign(d, out, in0.binaryExpr(in1, typename Functor::func()));
   }
 
@@ -272,6 +352,10 @@ struct BinaryFunctor<CPUDevice, Functor, NDIMS, false> {
     typedef typename Functor::in_type Tin;
     typedef typename Functor::func Binary;
     typedef typename Eigen::internal::scalar_left<Tout, Tin, Binary> Unary;
+    if (X86CwiseKernel<Functor>::BinaryScalar(d, out.data(), in.data(),
+                                              scalar(), out.size())) {
+      return;
+    }
     Assign(d, out, in.unaryExpr(Unary(scalar.data())));
   }
 
@@ -282,6 +366,10 @@ struct BinaryFunctor<CPUDevice, Functor, NDIMS, false> {
     typedef typename Functor::in_type Tin;
     typedef typename Functor::func Binary;
     typedef typename Eigen::internal::scalar_right<Tout, Tin, Binary> Unary;
+    if (X86CwiseKernel<Functor>::BinaryScalar(d, out.data(), in.data(),
+                                              scalar(), out.size())) {
+      return;
+    }
     Assign(d, out, in.unaryExpr(Unary(scalar.data())));
   }
 
@@ -445,6 +533,9 @@ template <typename Functor>
 struct UnaryFunctor<CPUDevice, Functor> {
   void operator()(const CPUDevice& d, typename Functor::tout_type out,
                   typename Functor::tin_type in) {
+    if (X86CwiseKernel<Functor>::Unary(d, out.data(), in.data(), out.size())) {
+      return;
+    }
     Assign(d, out, in.unaryExpr(typename Functor::func()));
   }
 };
@@ -466,6 +557,20 @@ struct ApproximateEqual<CPUDevice, T> {
   REGISTER_KERNEL_BUILDER(Name(N).Device(DEVICE_##D).TypeConstraint<T>("T"), \
                           OP<D##Device, F<T>>);
 
+// Registers a GPU kernel of the binary op "N" for type "T" that runs on the
+// host, with all its arguments in host memory. It is only picked for nodes
+// labeled "host", which HostLoopPredicatePass does for the scalar predicate
+// of a loop on the GPU, so the predicate doesn't leave the host.
+#define REGISTER_GPU_HOST_LABEL(N, F, T)                       \
+  REGISTER_KERNEL_BUILDER(Name(N)                              \
+                              .Device(DEVICE_GPU)              \
+                              .HostMemory("x")                 \
+                              .HostMemory("y")                 \
+                              .HostMemory("z")                 \
+                              .TypeConstraint<T>("T")          \
+                              .Label("host"),                  \
+                          BinaryOp<CPUDevice, F<T>>);
+
 // Macros to register kernels for multiple types (T0, T1, etc.)  on
 // device type "D" (CPU or GPU) for operation "N" (e.g., sqrt) using
 // the functor "F" (e.g., functor::sqrt).
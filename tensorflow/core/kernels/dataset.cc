@@ -0,0 +1,93 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/dataset.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* iterator_elements = monitoring::Counter<1>::New(
+    "/tensorflow/data/iterator/elements",
+    "The number of elements produced by dataset iterators.", "dataset");
+
+auto* iterator_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/data/iterator/bytes",
+    "The total size of the tensors in the elements produced by dataset "
+    "iterators.",
+    "dataset");
+
+auto* iterator_self_time_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/data/iterator/self_time_usecs",
+    "The time spent in the GetNext() calls of dataset iterators, excluding "
+    "the time spent in the GetNext() calls of their inputs on the same "
+    "thread.",
+    "dataset");
+
+auto* iterator_buffer_occupancy = monitoring::Sampler<1>::New(
+    {"/tensorflow/data/iterator/buffer_occupancy",
+     "The fraction of the output buffer of a parallel dataset iterator that "
+     "is full when an element is consumed.",
+     "dataset"},
+    {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0});
+
+}  // namespace
+
+IteratorStats::IteratorStats(const string& dataset_name)
+    : elements_(iterator_elements->GetCell(dataset_name)),
+      bytes_(iterator_bytes->GetCell(dataset_name)),
+      self_time_usecs_(iterator_self_time_usecs->GetCell(dataset_name)),
+      buffer_occupancy_(iterator_buffer_occupancy->GetCell(dataset_name)) {}
+
+// static
+IteratorStats* IteratorStats::Get(const string& dataset_name) {
+  static mutex* mu = new mutex;
+  static auto* stats = new std::unordered_map<string, IteratorStats*>;
+  mutex_lock l(*mu);
+  IteratorStats*& result = (*stats)[dataset_name];
+  if (result == nullptr) {
+    result = new IteratorStats(dataset_name);
+  }
+  return result;
+}
+
+void IteratorStats::RecordGetNext(const std::vector<Tensor>* out_tensors,
+                                  int64 self_time_usecs) {
+  if (out_tensors != nullptr) {
+    elements_->IncrementBy(1);
+    int64 bytes = 0;
+    for (const Tensor& t : *out_tensors) {
+      bytes += t.TotalBytes();
+    }
+    bytes_->IncrementBy(bytes);
+  }
+  // The clock may go backwards between samples.
+  if (self_time_usecs > 0) {
+    self_time_usecs_->IncrementBy(self_time_usecs);
+  }
+}
+
+void IteratorStats::RecordBufferOccupancy(int64 size, int64 capacity) {
+  if (capacity > 0) {
+    buffer_occupancy_->Add(static_cast<double>(size) / capacity);
+  }
+}
+
+}  // namespace tensorflow
@@ -15,14 +15,21 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATASET_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATASET_H_
 
+#include <atomic>
 #include <memory>
 
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
 class ResourceMgr;
 
+namespace monitoring {
+class CounterCell;
+class SamplerCell;
+}  // namespace monitoring
+
 // A cut-down version of OpKernelContext for running computations in
 // iterators. Note that we cannot simply use OpKernelContext here
 // because we might run computation in an iterator whose lifetime is
@@ -57,6 +64,9 @@ class IteratorContext {
 
     // Function call support.
     std::function<void(std::function<void()>)> runner = nullptr;
+
+    // If true, the iterators record their statistics (see IteratorStats).
+    bool collect_stats = false;
   };
 
   explicit IteratorContext(Params params) : params_(std::move(params)) {}
@@ -71,8 +81,25 @@ class IteratorContext {
 
   ResourceMgr* resource_manager() const { return params_.resource_manager; }
 
+  bool collect_stats() const { return params_.collect_stats; }
+
+  // Iterators that call their inputs from a background thread with their own
+  // context forward the setting of the context that started the thread.
+  void set_collect_stats(bool collect_stats) {
+    params_.collect_stats = collect_stats;
+  }
+
  private:
+  template <class DatasetType>
+  friend class DatasetIterator;
+
   Params params_;
+
+  // When dataset stats are enabled, points at the counter to which the
+  // innermost `DatasetIterator::GetNext()` call on this context adds the
+  // time spent in its children. An IteratorContext is only used by one
+  // thread at a time, so this needs no synchronization.
+  int64* stats_child_time_usecs_ = nullptr;
 };
 
 // Represents the current position in a range of outputs, where the
@@ -136,6 +163,36 @@ class DatasetBase : public ResourceBase {
   virtual const std::vector<PartialTensorShape>& output_shapes() const = 0;
 };
 
+// Per-dataset-type statistics, exported through lib/monitoring under
+// /tensorflow/data/iterator/*, and labelled by the DebugString() of the
+// dataset. They are only collected in the `GetNext()` calls whose
+// IteratorContext has `collect_stats()` set, e.g. by the `collect_stats`
+// attr of the IteratorGetNext op.
+class IteratorStats {
+ public:
+  // Returns the stats for iterators over datasets described by
+  // `dataset_name`. The returned object lives for the lifetime of the
+  // process.
+  static IteratorStats* Get(const string& dataset_name);
+
+  // Records a call to `GetNext()` that spent `self_time_usecs` outside
+  // the `GetNext()` calls of its input iterators. `out_tensors` is the
+  // element produced, or nullptr if the call did not produce one.
+  void RecordGetNext(const std::vector<Tensor>* out_tensors,
+                     int64 self_time_usecs);
+
+  // Records that `size` of the `capacity` slots in a buffer are full.
+  void RecordBufferOccupancy(int64 size, int64 capacity);
+
+ private:
+  explicit IteratorStats(const string& dataset_name);
+
+  monitoring::CounterCell* const elements_;
+  monitoring::CounterCell* const bytes_;
+  monitoring::CounterCell* const self_time_usecs_;
+  monitoring::SamplerCell* const buffer_occupancy_;
+};
+
 // Represents an iterator that is associated with a particular parent dataset.
 template <class DatasetType>
 class DatasetIterator : public IteratorBase {
@@ -157,9 +214,70 @@ class DatasetIterator : public IteratorBase {
     return dataset_->output_shapes();
   }
 
+  // Calls `GetNextInternal()`, and records its stats if `ctx` collects
+  // them.
+  Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                 bool* end_of_sequence) final {
+    if (!ctx->collect_stats()) {
+      return GetNextInternal(ctx, out_tensors, end_of_sequence);
+    }
+    return GetNextWithStats(ctx, out_tensors, end_of_sequence);
+  }
+
+ protected:
+  // Implements `IteratorBase::GetNext()` for this iterator.
+  virtual Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) = 0;
+
+  // Parallel stages call this to record how full their buffer of
+  // produced elements is when an element is consumed.
+  void RecordBufferOccupancy(int64 size, int64 capacity) {
+    IteratorStats* stats = stats_.load(std::memory_order_acquire);
+    if (stats != nullptr) {
+      stats->RecordBufferOccupancy(size, capacity);
+    }
+  }
+
  private:
+  // Looks up the stats of this iterator on its first call that collects
+  // them. Concurrent first calls get the same object.
+  IteratorStats* GetStats() {
+    IteratorStats* stats = stats_.load(std::memory_order_acquire);
+    if (stats == nullptr) {
+      // NOTE: ResourceBase::DebugString() is not const, but the
+      // datasets' implementations just describe their construction
+      // parameters.
+      stats = IteratorStats::Get(
+          const_cast<DatasetType*>(dataset_)->DebugString());
+      stats_.store(stats, std::memory_order_release);
+    }
+    return stats;
+  }
+
+  Status GetNextWithStats(IteratorContext* ctx,
+                          std::vector<Tensor>* out_tensors,
+                          bool* end_of_sequence) {
+    int64* parent_child_time_usecs = ctx->stats_child_time_usecs_;
+    int64 child_time_usecs = 0;
+    ctx->stats_child_time_usecs_ = &child_time_usecs;
+    const uint64 start_usecs = Env::Default()->NowMicros();
+    Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+    const int64 time_usecs = Env::Default()->NowMicros() - start_usecs;
+    ctx->stats_child_time_usecs_ = parent_child_time_usecs;
+    if (parent_child_time_usecs != nullptr) {
+      *parent_child_time_usecs += time_usecs;
+    }
+    GetStats()->RecordGetNext(
+        s.ok() && !*end_of_sequence ? out_tensors : nullptr,
+        time_usecs - child_time_usecs);
+    return s;
+  }
+
   const DatasetType* const dataset_;  // Owns one reference on the
                                       // shared dataset resource.
+  // Not owned. Null until the first call that collects stats.
+  std::atomic<IteratorStats*> stats_{nullptr};
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,171 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/dataset.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A dataset of `count` int64 scalars, which sleeps for `sleep_usecs`
+// in each call to GetNext() before reading from `input` (if any).
+class TestDataset : public DatasetBase {
+ public:
+  TestDataset(const string& name, int64 count, int64 sleep_usecs,
+              const DatasetBase* input)
+      : name_(name),
+        count_(count),
+        sleep_usecs_(sleep_usecs),
+        input_(input),
+        dtypes_({DT_INT64}),
+        shapes_({PartialTensorShape({})}) {}
+
+  std::unique_ptr<IteratorBase> MakeIterator() const override {
+    return std::unique_ptr<IteratorBase>(new Iterator(this));
+  }
+
+  const DataTypeVector& output_dtypes() const override { return dtypes_; }
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return shapes_;
+  }
+
+  string DebugString() override { return name_; }
+
+ private:
+  class Iterator : public DatasetIterator<TestDataset> {
+   public:
+    explicit Iterator(const TestDataset* dataset)
+        : DatasetIterator<TestDataset>(dataset),
+          input_impl_(dataset->input_ ? dataset->input_->MakeIterator()
+                                      : nullptr) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      Env::Default()->SleepForMicroseconds(dataset()->sleep_usecs_);
+      if (input_impl_) {
+        std::vector<Tensor> input_tensors;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &input_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          return Status::OK();
+        }
+      }
+      if (next_ == dataset()->count_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      Tensor t(DT_INT64, TensorShape({}));
+      t.scalar<int64>()() = next_++;
+      out_tensors->push_back(std::move(t));
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
+   private:
+    const std::unique_ptr<IteratorBase> input_impl_;
+    int64 next_ = 0;
+  };
+
+  const string name_;
+  const int64 count_;
+  const int64 sleep_usecs_;
+  const DatasetBase* const input_;
+  const DataTypeVector dtypes_;
+  const std::vector<PartialTensorShape> shapes_;
+};
+
+// Returns the value of the point of the counter metric "name" with the
+// given dataset label, or 0 if there is no such point.
+int64 CounterValue(const string& name, const string& dataset) {
+  std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  auto it = metrics->point_set_map.find(name);
+  if (it == metrics->point_set_map.end()) return 0;
+  for (const auto& point : it->second->points) {
+    if (point->labels.size() == 1 && point->labels[0].value == dataset) {
+      return point->int64_value;
+    }
+  }
+  return 0;
+}
+
+TEST(DatasetIteratorTest, Stats) {
+  TestDataset* inner = new TestDataset("StatsTest::Inner", 3, 20000, nullptr);
+  core::ScopedUnref unref_inner(inner);
+  TestDataset* outer = new TestDataset("StatsTest::Outer", 10, 0, inner);
+  core::ScopedUnref unref_outer(outer);
+  std::unique_ptr<IteratorBase> iterator = outer->MakeIterator();
+
+  IteratorContext::Params params;
+  params.env = Env::Default();
+  params.collect_stats = true;
+  IteratorContext ctx(std::move(params));
+  int num_elements = 0;
+  while (true) {
+    std::vector<Tensor> out_tensors;
+    bool end_of_sequence;
+    TF_ASSERT_OK(iterator->GetNext(&ctx, &out_tensors, &end_of_sequence));
+    if (end_of_sequence) break;
+    ++num_elements;
+  }
+  EXPECT_EQ(3, num_elements);
+
+  EXPECT_EQ(3, CounterValue("/tensorflow/data/iterator/elements",
+                            "StatsTest::Inner"));
+  EXPECT_EQ(3, CounterValue("/tensorflow/data/iterator/elements",
+                            "StatsTest::Outer"));
+  EXPECT_EQ(
+      3 * static_cast<int64>(sizeof(int64)),
+      CounterValue("/tensorflow/data/iterator/bytes", "StatsTest::Outer"));
+
+  // The inner iterator slept for 20ms in each of its four calls, and the
+  // outer iterator's self time excludes them.
+  const int64 inner_usecs = CounterValue(
+      "/tensorflow/data/iterator/self_time_usecs", "StatsTest::Inner");
+  const int64 outer_usecs = CounterValue(
+      "/tensorflow/data/iterator/self_time_usecs", "StatsTest::Outer");
+  EXPECT_GE(inner_usecs, 4 * 20000);
+  EXPECT_LT(outer_usecs, inner_usecs / 2);
+}
+
+TEST(DatasetIteratorTest, NoStatsUnlessCollected) {
+  TestDataset* dataset = new TestDataset("NoStatsTest", 3, 0, nullptr);
+  core::ScopedUnref unref_dataset(dataset);
+  std::unique_ptr<IteratorBase> iterator = dataset->MakeIterator();
+
+  IteratorContext::Params params;
+  params.env = Env::Default();
+  IteratorContext ctx(std::move(params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence;
+  TF_ASSERT_OK(iterator->GetNext(&ctx, &out_tensors, &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  EXPECT_EQ(0,
+            CounterValue("/tensorflow/data/iterator/elements", "NoStatsTest"));
+}
+
+}  // namespace
+}  // namespace tensorflow
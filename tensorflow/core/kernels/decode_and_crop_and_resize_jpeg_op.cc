@@ -0,0 +1,257 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// The source pixels and weight of one output coordinate, in the coordinates
+// of the decoded window.
+struct CachedInterpolation {
+  int64 lower;
+  int64 upper;
+  float lerp;
+};
+
+// Returns the largest ratio the scaled IDCT of libjpeg supports that still
+// leaves at least out_size pixels of the crop in each dimension.
+int ChooseRatio(int64 crop_height, int64 crop_width, int64 out_height,
+                int64 out_width) {
+  for (int ratio : {8, 4, 2}) {
+    if (crop_height >= out_height * ratio && crop_width >= out_width * ratio) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// Computes for each of the out_size outputs the pixels to interpolate of the
+// image scaled down by ratio, and returns in *window_begin and *window_end
+// the range of the scaled pixels used. The outputs sample the crop of
+// crop_size pixels at crop_begin of the original image like ResizeBilinear
+// would, clamped to the scaled pixels that overlap the crop, and a pixel of
+// the scaled image is at the center of the ratio pixels of the original
+// image it averages.
+void ComputeInterpolation(int64 crop_begin, int64 crop_size, int64 out_size,
+                          int ratio, bool align_corners,
+                          std::vector<CachedInterpolation>* interpolation,
+                          int64* window_begin, int64* window_end) {
+  const float scale = CalculateResizeScale(crop_size, out_size, align_corners);
+  const int64 scaled_begin = crop_begin / ratio;
+  const int64 scaled_last = (crop_begin + crop_size - 1) / ratio;
+  interpolation->resize(out_size);
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in = (crop_begin + i * scale - 0.5f * (ratio - 1)) / ratio;
+    const float clamped =
+        std::min(std::max(in, static_cast<float>(scaled_begin)),
+                 static_cast<float>(scaled_last));
+    CachedInterpolation& entry = (*interpolation)[i];
+    entry.lower = static_cast<int64>(clamped);
+    entry.upper = std::min(entry.lower + 1, scaled_last);
+    entry.lerp = clamped - entry.lower;
+  }
+  *window_begin = interpolation->front().lower;
+  *window_end = interpolation->back().upper + 1;
+  for (CachedInterpolation& entry : *interpolation) {
+    entry.lower -= *window_begin;
+    entry.upper -= *window_begin;
+  }
+}
+
+// Decodes the crop of a JPEG image, and resizes it with bilinear
+// interpolation to float. The image is decoded at the smallest scale that
+// keeps the crop at least as large as the output, and only the part of it
+// that the interpolation reads is decoded.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+
+    // The same default as DecodeJpeg.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<string>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(crop_window.shape()) &&
+                    crop_window.NumElements() == 4,
+                errors::InvalidArgument(
+                    "crop_window must be 1-D with 4 elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument(
+                    "size must be 1-D with 2 elements, got shape ",
+                    size.shape().DebugString()));
+
+    const auto crop_window_vec = crop_window.vec<int32>();
+    const int64 crop_y = crop_window_vec(0);
+    const int64 crop_x = crop_window_vec(1);
+    const int64 crop_height = crop_window_vec(2);
+    const int64 crop_width = crop_window_vec(3);
+    const auto size_vec = size.vec<int32>();
+    const int64 out_height = size_vec(0);
+    const int64 out_width = size_vec(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int width, height;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   nullptr),
+                errors::InvalidArgument("Invalid JPEG header, size ",
+                                        input.size()));
+    OP_REQUIRES(
+        context,
+        crop_y >= 0 && crop_x >= 0 && crop_height > 0 && crop_width > 0 &&
+            crop_y + crop_height <= height && crop_x + crop_width <= width,
+        errors::InvalidArgument("crop_window [", crop_y, ", ", crop_x, ", ",
+                                crop_height, ", ", crop_width,
+                                "] is not within the image of size ", height,
+                                "x", width));
+
+    // Use the scaled IDCT of libjpeg, at the size it scales the image to.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ChooseRatio(crop_height, crop_width, out_height, out_width);
+    std::vector<CachedInterpolation> ys, xs;
+    int64 window_y_begin, window_y_end, window_x_begin, window_x_end;
+    ComputeInterpolation(crop_y, crop_height, out_height, flags.ratio,
+                         align_corners_, &ys, &window_y_begin, &window_y_end);
+    ComputeInterpolation(crop_x, crop_width, out_width, flags.ratio,
+                         align_corners_, &xs, &window_x_begin, &window_x_end);
+    flags.crop = true;
+    flags.crop_y = window_y_begin;
+    flags.crop_x = window_x_begin;
+    flags.crop_height = window_y_end - window_y_begin;
+    flags.crop_width = window_x_end - window_x_begin;
+
+    // Decode the window, allocating the tensors once the number of channels
+    // is known.
+    Tensor window;
+    Tensor* output = nullptr;
+    OP_REQUIRES(
+        context,
+        jpeg::Uncompress(
+            input.data(), input.size(), flags, nullptr /* nwarn */,
+            [=, &window, &output](int window_width, int window_height,
+                                  int channels) -> uint8* {
+              Status status = context->allocate_temp(
+                  DT_UINT8,
+                  TensorShape({window_height, window_width, channels}),
+                  &window);
+              if (status.ok()) {
+                status = context->allocate_output(
+                    0, TensorShape({out_height, out_width, channels}),
+                    &output);
+              }
+              if (!status.ok()) {
+                VLOG(1) << status;
+                context->SetStatus(status);
+                return nullptr;
+              }
+              return window.flat<uint8>().data();
+            }),
+        errors::InvalidArgument("Invalid JPEG data, size ", input.size()));
+
+    const int channels = window.dim_size(2);
+    const int64 in_row_size = window.dim_size(1) * channels;
+    const uint8* const window_data = window.flat<uint8>().data();
+    float* output_data = output->flat<float>().data();
+    for (int64 y = 0; y < out_height; ++y) {
+      const uint8* const top = window_data + ys[y].lower * in_row_size;
+      const uint8* const bottom = window_data + ys[y].upper * in_row_size;
+      const float y_lerp = ys[y].lerp;
+      for (int64 x = 0; x < out_width; ++x) {
+        const int64 left = xs[x].lower * channels;
+        const int64 right = xs[x].upper * channels;
+        const float x_lerp = xs[x].lerp;
+        for (int c = 0; c < channels; ++c) {
+          const float top_left(top[left + c]);
+          const float top_right(top[right + c]);
+          const float bottom_left(bottom[left + c]);
+          const float bottom_right(bottom[right + c]);
+          const float top_value = top_left + (top_right - top_left) * x_lerp;
+          const float bottom_value =
+              bottom_left + (bottom_right - bottom_left) * x_lerp;
+          *output_data++ = top_value + (bottom_value - top_value) * y_lerp;
+        }
+      }
+    }
+  }
+
+ private:
+  int channels_;
+  bool align_corners_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <string.h>
+#include <deque>
+#include <limits>
 #include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -21,9 +24,66 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Finds the first of up to four bytes in [begin, end), eight bytes at a
+// time. The CSV fields are mostly scanned for their end, so this is where the
+// parser spends its time.
+class ByteFinder {
+ public:
+  ByteFinder(char a, char b, char c, char d)
+      : a_(a), b_(b), c_(c), d_(d),
+        a_word_(Broadcast(a)), b_word_(Broadcast(b)), c_word_(Broadcast(c)),
+        d_word_(Broadcast(d)) {}
+
+  // Returns a pointer to the first of the bytes, or end if there is none.
+  const char* Find(const char* begin, const char* end) const {
+    const char* p = begin;
+    for (; end - p >= static_cast<ptrdiff_t>(sizeof(uint64)); p += 8) {
+      uint64 word;
+      memcpy(&word, p, sizeof(word));
+      if (HasZeroByte(word ^ a_word_) | HasZeroByte(word ^ b_word_) |
+          HasZeroByte(word ^ c_word_) | HasZeroByte(word ^ d_word_)) {
+        break;
+      }
+    }
+    for (; p < end; ++p) {
+      const char byte = *p;
+      if (byte == a_ || byte == b_ || byte == c_ || byte == d_) return p;
+    }
+    return end;
+  }
+
+ private:
+  static uint64 Broadcast(char byte) {
+    return 0x0101010101010101ULL * static_cast<uint8>(byte);
+  }
+
+  // Nonzero if and only if one of the bytes of word is zero.
+  static uint64 HasZeroByte(uint64 word) {
+    return (word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL;
+  }
+
+  const char a_, b_, c_, d_;
+  const uint64 a_word_, b_word_, c_word_, d_word_;
+};
+
+// The buffers reused by one thread to parse its records. The fields point
+// into the records, or into the unescaped buffers for the quoted fields with
+// escaped quotes.
+struct ParseBuffers {
+  std::vector<StringPiece> fields;
+  std::deque<string> unescaped;
+  size_t num_unescaped = 0;
+};
+
+}  // namespace
+
 class DecodeCSVOp : public OpKernel {
  public:
   explicit DecodeCSVOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -64,177 +124,216 @@ class DecodeCSVOp : public OpKernel {
       Tensor* out = nullptr;
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
+    if (records_size == 0) return;
+
+    // The records are parsed in parallel. Like when parsing them in order,
+    // the error reported is the one of the first record that has an error.
+    mutex mu;
+    int64 error_record = records_size;
+    Status error;
+    auto parse_records = [&](int64 begin, int64 end) {
+      ParseBuffers buffers;
+      for (int64 i = begin; i < end; ++i) {
+        Status s = ParseRecord(records_t(i), i, record_defaults, &output,
+                               &buffers);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < error_record) {
+            error_record = i;
+            error = s;
+          }
+          return;
+        }
+      }
+    };
 
+    // Parsing costs a few cycles per byte, and converting the fields more.
+    int64 total_bytes = 0;
     for (int64 i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
-
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32 value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int32: ", fields[f]));
-              output[f]->flat<int32>()(i) = value;
+      total_bytes += records_t(i).size();
+    }
+    const int64 cost_per_record =
+        10 * total_bytes / records_size + 100 * out_type_.size();
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, records_size,
+          cost_per_record, parse_records);
+    OP_REQUIRES_OK(ctx, error);
+  }
+
+ private:
+  std::vector<DataType> out_type_;
+  char delim_;
+  bool use_quote_delim_;
+
+  // Parses record i into the outputs.
+  Status ParseRecord(StringPiece record, int64 i,
+                     const OpInputList& record_defaults, OpOutputList* output,
+                     ParseBuffers* buffers) const {
+    TF_RETURN_IF_ERROR(ExtractFields(record, buffers));
+    const std::vector<StringPiece>& fields = buffers->fields;
+    if (fields.size() != out_type_.size()) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", fields.size(),
+                                     " in record ", i);
+    }
+
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const StringPiece field = fields[f];
+      // If this field is empty, check if default is given:
+      // If yes, use default value; Otherwise report error.
+      if (field.empty() && record_defaults[f].NumElements() != 1) {
+        return errors::InvalidArgument("Field ", f,
+                                       " is required but missing in record ",
+                                       i, "!");
+      }
+      const DataType& dtype = out_type_[f];
+      switch (dtype) {
+        case DT_INT32: {
+          if (field.empty()) {
+            (*output)[f]->flat<int32>()(i) =
+                record_defaults[f].flat<int32>()(0);
+          } else {
+            int32 value;
+            if (!strings::safe_strto32(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int32: ", field);
             }
-            break;
+            (*output)[f]->flat<int32>()(i) = value;
           }
-          case DT_INT64: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int64>()(i) = record_defaults[f].flat<int64>()(0);
-            } else {
-              int64 value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int64: ", fields[f]));
-              output[f]->flat<int64>()(i) = value;
+          break;
+        }
+        case DT_INT64: {
+          if (field.empty()) {
+            (*output)[f]->flat<int64>()(i) =
+                record_defaults[f].flat<int64>()(0);
+          } else {
+            int64 value;
+            if (!strings::safe_strto64(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int64: ", field);
             }
-            break;
+            (*output)[f]->flat<int64>()(i) = value;
           }
-          case DT_FLOAT: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f].c_str(), &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid float: ", fields[f]));
-              output[f]->flat<float>()(i) = value;
+          break;
+        }
+        case DT_FLOAT: {
+          if (field.empty()) {
+            (*output)[f]->flat<float>()(i) =
+                record_defaults[f].flat<float>()(0);
+          } else {
+            float value;
+            if (!strings::safe_strtof(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid float: ", field);
             }
-            break;
+            (*output)[f]->flat<float>()(i) = value;
           }
-          case DT_STRING: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<string>()(i) =
-                  record_defaults[f].flat<string>()(0);
-            } else {
-              output[f]->flat<string>()(i) = fields[f];
-            }
-            break;
+          break;
+        }
+        case DT_STRING: {
+          if (field.empty()) {
+            (*output)[f]->flat<string>()(i) =
+                record_defaults[f].flat<string>()(0);
+          } else {
+            (*output)[f]->flat<string>()(i).assign(field.data(), field.size());
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          break;
         }
+        default:
+          return errors::InvalidArgument("csv: data type ", dtype,
+                                         " not supported in field ", f);
       }
     }
+    return Status::OK();
   }
 
- private:
-  std::vector<DataType> out_type_;
-  char delim_;
-  bool use_quote_delim_;
-
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64 current_idx = 0;
+  // Splits input into buffers->fields, unescaping the quoted fields.
+  Status ExtractFields(StringPiece input, ParseBuffers* buffers) const {
+    std::vector<StringPiece>* result = &buffers->fields;
+    result->clear();
+    buffers->num_unescaped = 0;
+    // The bytes that end an unquoted field, or are invalid in it.
+    const ByteFinder field_end(delim_, use_quote_delim_ ? '"' : delim_, '\n',
+                               '\r');
+    const char* const data = input.data();
+    const size_t size = input.size();
+    size_t current_idx = 0;
     if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
-        if (input[current_idx] == '\n' || input[current_idx] == '\r') {
+      while (current_idx < size) {
+        if (data[current_idx] == '\n' || data[current_idx] == '\r') {
           current_idx++;
           continue;
         }
 
         bool quoted = false;
-        if (use_quote_delim_ && input[current_idx] == '"') {
+        if (use_quote_delim_ && data[current_idx] == '"') {
           quoted = true;
           current_idx++;
         }
 
         // This is the body of the field;
-        string field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            field += input[current_idx];
-            current_idx++;
+          const size_t begin = current_idx;
+          current_idx = field_end.Find(data + begin, data + size) - data;
+          if (current_idx < size && data[current_idx] != delim_) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
           }
+          result->emplace_back(data + begin, current_idx - begin);
 
           // Go to next field or the end
           current_idx++;
-        } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              field += input[current_idx];
+        } else {
+          // Quoted field needs to be ended with '"' and delim or end. The
+          // field is copied only if it has escaped quotes.
+          const size_t begin = current_idx;
+          string* unescaped = nullptr;
+          auto is_field_end = [this, data](size_t idx) {
+            return data[idx] == '"' && data[idx + 1] == delim_;
+          };
+          while (current_idx < size - 1 && !is_field_end(current_idx)) {
+            if (data[current_idx] != '"') {
+              if (unescaped != nullptr) unescaped->push_back(data[current_idx]);
               current_idx++;
             } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              field += '"';
+              if (data[current_idx + 1] != '"') {
+                return errors::InvalidArgument(
+                    "Quote inside a string has to be "
+                    "escaped by another quote");
+              }
+              if (unescaped == nullptr) {
+                if (buffers->num_unescaped == buffers->unescaped.size()) {
+                  buffers->unescaped.emplace_back();
+                }
+                unescaped = &buffers->unescaped[buffers->num_unescaped++];
+                unescaped->assign(data + begin, current_idx - begin);
+              }
+              unescaped->push_back('"');
               current_idx += 2;
             }
           }
 
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
+          if (!(current_idx < size && data[current_idx] == '"' &&
+                (current_idx == size - 1 || data[current_idx + 1] == delim_))) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote "
+                "followed by delim or end");
+          }
+          if (unescaped != nullptr) {
+            result->emplace_back(*unescaped);
+          } else {
+            result->emplace_back(data + begin, current_idx - begin);
+          }
 
           current_idx += 2;
         }
-
-        result->push_back(field);
       }
 
       // Check if the last field is missing
-      if (input[input.size() - 1] == delim_) result->push_back(string());
+      if (data[size - 1] == delim_) result->emplace_back();
     }
+    return Status::OK();
   }
 };
 
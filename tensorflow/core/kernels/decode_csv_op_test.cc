@@ -0,0 +1,149 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class DecodeCSVOpTest : public OpsTestBase {
+ protected:
+  // Decodes records of an int32, a float and a string field, the last two
+  // with defaults.
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("decode_csv", "DecodeCSV")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput({DT_INT32, DT_FLOAT, DT_STRING}))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddInputs(const std::vector<string>& records) {
+    AddInputFromArray<string>(
+        TensorShape({static_cast<int64>(records.size())}), records);
+    AddInputFromArray<int32>(TensorShape({0}), {});
+    AddInputFromArray<float>(TensorShape({1}), {-1.0f});
+    AddInputFromArray<string>(TensorShape({1}), {"default"});
+  }
+};
+
+TEST_F(DecodeCSVOpTest, ManyRecords) {
+  // Enough records to be split among the threads.
+  const int kNumRecords = 10000;
+  std::vector<string> records;
+  Tensor expected_ints(DT_INT32, TensorShape({kNumRecords}));
+  Tensor expected_floats(DT_FLOAT, TensorShape({kNumRecords}));
+  Tensor expected_strings(DT_STRING, TensorShape({kNumRecords}));
+  for (int i = 0; i < kNumRecords; ++i) {
+    expected_ints.vec<int32>()(i) = i - 5000;
+    switch (i % 3) {
+      case 0:
+        records.push_back(strings::StrCat(i - 5000, ",", i, ".5,abc", i));
+        expected_floats.vec<float>()(i) = i + 0.5f;
+        expected_strings.vec<string>()(i) = strings::StrCat("abc", i);
+        break;
+      case 1:
+        // Empty fields take the defaults.
+        records.push_back(strings::StrCat(i - 5000, ",,"));
+        expected_floats.vec<float>()(i) = -1.0f;
+        expected_strings.vec<string>()(i) = "default";
+        break;
+      case 2:
+        // Quoted fields, with escaped quotes and delimiters.
+        records.push_back(
+            strings::StrCat("\"", i - 5000, "\",\"", i, "\",\"a\"\"b,", i,
+                            "\"\"\""));
+        expected_floats.vec<float>()(i) = i;
+        expected_strings.vec<string>()(i) = strings::StrCat("a\"b,", i, "\"");
+        break;
+    }
+  }
+  MakeOp();
+  AddInputs(records);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(expected_ints, *GetOutput(0));
+  test::ExpectTensorEqual<float>(expected_floats, *GetOutput(1));
+  test::ExpectTensorEqual<string>(expected_strings, *GetOutput(2));
+}
+
+TEST_F(DecodeCSVOpTest, FirstErrorIsReported) {
+  // The records are parsed in parallel, but the error is the one of the first
+  // invalid record.
+  const int kNumRecords = 10000;
+  std::vector<string> records(kNumRecords, "1,2.0,a");
+  records[1234] = "x,2.0,a";
+  records[5678] = "1,2.0";
+  records[9999] = ",2.0,a";
+  MakeOp();
+  AddInputs(records);
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString())
+                  .contains("Field 0 in record 1234 is not a valid int32: x"))
+      << s;
+}
+
+static Graph* DecodeCSV(int num_records, int num_fields, DataType dtype) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor records(DT_STRING, TensorShape({num_records}));
+  for (int i = 0; i < num_records; ++i) {
+    string& record = records.vec<string>()(i);
+    for (int f = 0; f < num_fields; ++f) {
+      if (f > 0) record += ",";
+      strings::StrAppend(&record, (i * 31 + f * 17) % 100000, ".", f);
+    }
+  }
+  std::vector<NodeBuilder::NodeOut> defaults;
+  for (int f = 0; f < num_fields; ++f) {
+    defaults.emplace_back(
+        test::graph::Constant(g, Tensor(dtype, TensorShape({0}))));
+  }
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DecodeCSV")
+                  .Input(test::graph::Constant(g, records))
+                  .Input(defaults)
+                  .Finalize(g, &ret));
+  return g;
+}
+
+#define BM_DecodeCSV(B, F, T)                                                \
+  static void BM_DecodeCSV_##B##_##F##_##T(int iters) {                      \
+    testing::UseRealTime();                                                  \
+    testing::ItemsProcessed(static_cast<int64>(iters) * B);                  \
+    test::Benchmark("cpu", DecodeCSV(B, F, DT_##T)).Run(iters);              \
+  }                                                                          \
+  BENCHMARK(BM_DecodeCSV_##B##_##F##_##T);
+
+BM_DecodeCSV(100, 20, FLOAT);
+BM_DecodeCSV(10000, 20, FLOAT);
+BM_DecodeCSV(10000, 20, STRING);
+BM_DecodeCSV(10000, 200, FLOAT);
+
+#undef BM_DecodeCSV
+
+}  // namespace
+}  // namespace tensorflow
@@ -94,6 +94,11 @@ struct Conv2DArgs {
         out_depth(0) {}
 };
 
+// Returns true if DeepConv2D implements convolutions of these strides and
+// filter sizes, whether or not it is enabled and faster.
+bool DeepConv2DSupports(int stride_rows, int stride_cols, int filter_rows,
+                        int filter_cols);
+
 // Returns true if convolution operation specified by function arguments
 // can use DeepConv2D implementation, and false otherwise.
 // May return false based on parameters, cost, or whether feature is disabled.
@@ -650,6 +650,10 @@ struct DepthwiseConv2dGPULaunch {
         args.depth_multiplier == 1) {
       LaunchDepthwiseConv2dGPU<T, 3, 3, 1>(d, args, input, filter, output,
                                            data_format);
+    } else if (args.filter_rows == 5 && args.filter_cols == 5 &&
+               args.depth_multiplier == 1) {
+      LaunchDepthwiseConv2dGPU<T, 5, 5, 1>(d, args, input, filter, output,
+                                           data_format);
     } else {
       LaunchDepthwiseConv2dGPU<T, -1, -1, -1>(d, args, input, filter, output,
                                               data_format);
@@ -1191,6 +1195,9 @@ struct DepthwiseConv2dBackpropInputGPULaunch {
       if (args.filter_rows == 3 && args.filter_cols == 3) {
         LaunchDepthwiseConv2dBackpropInputGPU<T, 3, 3, 1>(
             d, args, out_backprop, filter, in_backprop, data_format);
+      } else if (args.filter_rows == 5 && args.filter_cols == 5) {
+        LaunchDepthwiseConv2dBackpropInputGPU<T, 5, 5, 1>(
+            d, args, out_backprop, filter, in_backprop, data_format);
       } else {
         LaunchDepthwiseConv2dBackpropInputGPU<T, -1, -1, 1>(
             d, args, out_backprop, filter, in_backprop, data_format);
@@ -1833,15 +1840,253 @@ void LaunchDepthwiseConv2dBackpropFilterGPU(const GpuDevice& d,
   }
 }
 
+// CUDA kernel to compute the depthwise convolution backward w.r.t. filter in
+// NHWC format, for a filter of known size. Rather than adding every product
+// to the filter gradient with an atomic, each thread accumulates the gradient
+// of all the filter elements of one output depth in registers, over a strided
+// range of output pixels. The partial sums of the threads in a block are then
+// reduced in shared memory, so that only one atomic per filter element and
+// block goes to global memory.
+// The threads along blockDim.x handle consecutive depths, so that the loads
+// from both tensors are coalesced. The shared memory must hold
+// kKnownFilterWidth * kKnownFilterHeight values per thread.
+template <typename T, int kKnownFilterWidth, int kKnownFilterHeight>
+__global__ void __launch_bounds__(1024, 2)
+    DepthwiseConv2dBackpropFilterGPUKernelNHWCReduce(const DepthwiseArgs args,
+                                                     const T* out_backprop,
+                                                     const T* input,
+                                                     T* filter_backprop) {
+  static_assert(kKnownFilterWidth > 0 && kKnownFilterHeight > 0,
+                "The filter size must be known at compile time.");
+  const int kFilterPixels = kKnownFilterWidth * kKnownFilterHeight;
+  extern __shared__ __align__(sizeof(T)) unsigned char shared_memory[];
+  T* const shared_data = reinterpret_cast<T*>(shared_memory);
+
+  const int in_rows = args.in_rows;
+  const int in_cols = args.in_cols;
+  const int in_depth = args.in_depth;
+  const int depth_multiplier = args.depth_multiplier;
+  const int stride = args.stride;
+  const int pad_rows = args.pad_rows;
+  const int pad_cols = args.pad_cols;
+  const int out_rows = args.out_rows;
+  const int out_cols = args.out_cols;
+  const int out_depth = args.out_depth;
+  const int out_pixels = args.batch * out_rows * out_cols;
+
+  const int out_d = blockIdx.x * blockDim.x + threadIdx.x;
+  const int in_d = out_d / depth_multiplier;
+  const bool depth_in_range = out_d < out_depth;
+
+  T partial_sums[kFilterPixels];
+  UNROLL for (int i = 0; i < kFilterPixels; ++i) { partial_sums[i] = T(0); }
+
+  if (depth_in_range) {
+    for (int p = blockIdx.y * blockDim.y + threadIdx.y; p < out_pixels;
+         p += gridDim.y * blockDim.y) {
+      const int out_c = p % out_cols;
+      const int out_r = (p / out_cols) % out_rows;
+      const int b = p / out_cols / out_rows;
+      const T out_bp = ldg(out_backprop + out_d + out_depth * p);
+      const int in_r_start = out_r * stride - pad_rows;
+      const int in_c_start = out_c * stride - pad_cols;
+      UNROLL for (int f_r = 0; f_r < kKnownFilterHeight; ++f_r) {
+        const int in_r = in_r_start + f_r;
+        if (in_r < 0 || in_r >= in_rows) continue;
+        // Avoid repeated computation.
+        const int input_offset_temp = in_cols * (in_r + in_rows * b);
+        UNROLL for (int f_c = 0; f_c < kKnownFilterWidth; ++f_c) {
+          const int in_c = in_c_start + f_c;
+          if (in_c >= 0 && in_c < in_cols) {
+            const int input_offset =
+                in_d + in_depth * (in_c + input_offset_temp);
+            partial_sums[f_r * kKnownFilterWidth + f_c] +=
+                ldg(input + input_offset) * out_bp;
+          }
+        }
+      }
+    }
+  }
+
+  // Sum up the partial results of the threads with the same depth.
+  const int block_size = blockDim.x * blockDim.y;
+  const int thread_idx = threadIdx.y * blockDim.x + threadIdx.x;
+  UNROLL for (int i = 0; i < kFilterPixels; ++i) {
+    shared_data[i * block_size + thread_idx] = partial_sums[i];
+  }
+  __syncthreads();
+
+  if (depth_in_range) {
+    for (int i = threadIdx.y; i < kFilterPixels; i += blockDim.y) {
+      const T* const sum_ptr = shared_data + i * block_size + threadIdx.x;
+      T sum = T(0);
+      for (int j = 0; j < blockDim.y; ++j) {
+        sum += sum_ptr[j * blockDim.x];
+      }
+      // The filter gradient is laid out as [filter_pixels, out_depth].
+      CudaAtomicAdd(filter_backprop + out_d + out_depth * i, sum);
+    }
+  }
+}
+
+// CUDA kernel to compute the depthwise convolution backward w.r.t. filter in
+// NCHW format, for a filter of known size. Each block works on one depth,
+// given by blockIdx.x, and its threads accumulate the gradient of all the
+// filter elements in registers over a strided range of the pixels of that
+// depth. The partial sums are reduced in each warp with shuffles, and then
+// across the warps of the block in shared memory, before one atomic per
+// filter element and block adds them to global memory.
+// blockDim.x must be a multiple of the warp size, and the shared memory must
+// hold kKnownFilterWidth * kKnownFilterHeight values per warp.
+template <typename T, int kKnownFilterWidth, int kKnownFilterHeight>
+__global__ void __launch_bounds__(1024, 2)
+    DepthwiseConv2dBackpropFilterGPUKernelNCHWReduce(const DepthwiseArgs args,
+                                                     const T* out_backprop,
+                                                     const T* input,
+                                                     T* filter_backprop) {
+  static_assert(kKnownFilterWidth > 0 && kKnownFilterHeight > 0,
+                "The filter size must be known at compile time.");
+  const int kFilterPixels = kKnownFilterWidth * kKnownFilterHeight;
+  extern __shared__ __align__(sizeof(T)) unsigned char shared_memory[];
+  T* const shared_data = reinterpret_cast<T*>(shared_memory);
+
+  const int in_rows = args.in_rows;
+  const int in_cols = args.in_cols;
+  const int in_depth = args.in_depth;
+  const int stride = args.stride;
+  const int pad_rows = args.pad_rows;
+  const int pad_cols = args.pad_cols;
+  const int out_rows = args.out_rows;
+  const int out_cols = args.out_cols;
+  const int out_depth = args.out_depth;
+  const int out_pixels = args.batch * out_rows * out_cols;
+
+  const int out_d = blockIdx.x;
+  const int in_d = out_d / args.depth_multiplier;
+
+  T partial_sums[kFilterPixels];
+  UNROLL for (int i = 0; i < kFilterPixels; ++i) { partial_sums[i] = T(0); }
+
+  for (int p = blockIdx.y * blockDim.x + threadIdx.x; p < out_pixels;
+       p += gridDim.y * blockDim.x) {
+    const int out_c = p % out_cols;
+    const int out_r = (p / out_cols) % out_rows;
+    const int b = p / out_cols / out_rows;
+    const int out_backprop_offset =
+        out_c + out_cols * (out_r + out_rows * (out_d + out_depth * b));
+    const T out_bp = ldg(out_backprop + out_backprop_offset);
+    const int in_r_start = out_r * stride - pad_rows;
+    const int in_c_start = out_c * stride - pad_cols;
+    // Avoid repeated computation.
+    const int input_offset_temp = in_rows * (in_d + in_depth * b);
+    UNROLL for (int f_r = 0; f_r < kKnownFilterHeight; ++f_r) {
+      const int in_r = in_r_start + f_r;
+      if (in_r < 0 || in_r >= in_rows) continue;
+      UNROLL for (int f_c = 0; f_c < kKnownFilterWidth; ++f_c) {
+        const int in_c = in_c_start + f_c;
+        if (in_c >= 0 && in_c < in_cols) {
+          const int input_offset = in_c + in_cols * (in_r + input_offset_temp);
+          partial_sums[f_r * kKnownFilterWidth + f_c] +=
+              ldg(input + input_offset) * out_bp;
+        }
+      }
+    }
+  }
+
+  const int lane = threadIdx.x % warpSize;
+  const int warp = threadIdx.x / warpSize;
+  UNROLL for (int i = 0; i < kFilterPixels; ++i) {
+    T val = partial_sums[i];
+    for (int delta = warpSize / 2; delta > 0; delta /= 2) {
+      val += CudaShuffleDown(val, delta);
+    }
+    if (lane == 0) {
+      shared_data[warp * kFilterPixels + i] = val;
+    }
+  }
+  __syncthreads();
+
+  const int num_warps = blockDim.x / warpSize;
+  for (int i = threadIdx.x; i < kFilterPixels; i += blockDim.x) {
+    T sum = T(0);
+    for (int j = 0; j < num_warps; ++j) {
+      sum += shared_data[j * kFilterPixels + i];
+    }
+    // The filter gradient is laid out as [filter_pixels, out_depth].
+    CudaAtomicAdd(filter_backprop + out_d + out_depth * i, sum);
+  }
+}
+
+// Launches the backward filter kernels for a filter of known size: the
+// 'Small' variant if the image allows it, else the one that reduces the
+// gradient within each block.
+template <typename T, int kKnownFilterWidth, int kKnownFilterHeight>
+void LaunchDepthwiseConv2dBackpropFilterGPUReduce(
+    const GpuDevice& d, const DepthwiseArgs args, const T* out_backprop,
+    const T* input, T* filter_backprop, TensorFormat data_format) {
+  if (TryLaunchDepthwiseConv2dBackpropFilterGPUSmall<T, kKnownFilterWidth,
+                                                     kKnownFilterHeight>(
+          d, args, out_backprop, input, filter_backprop, data_format)) {
+    return;
+  }
+  const int filter_pixels = kKnownFilterWidth * kKnownFilterHeight;
+  const int out_pixels = args.batch * args.out_rows * args.out_cols;
+  // Every block adds one atomic per filter element and depth it covers, so
+  // the pixels are only split across as many blocks as it takes to fill the
+  // device.
+  const int max_threads =
+      d.getNumCudaMultiProcessors() * d.maxCudaThreadsPerMultiProcessor();
+  if (data_format == FORMAT_NHWC) {
+    // One warp of consecutive depths per row of the block.
+    const int block_slices = 32;
+    int block_rows = 8;
+    while (block_rows > 1 &&
+           block_slices * block_rows * filter_pixels * sizeof(T) >
+               d.sharedMemPerBlock()) {
+      block_rows /= 2;
+    }
+    const int block_size = block_slices * block_rows;
+    const int shared_memory_size = block_size * filter_pixels * sizeof(T);
+    const int depth_blocks = (args.out_depth + block_slices - 1) / block_slices;
+    const int pixel_blocks = std::max(
+        1, std::min((max_threads / block_size + depth_blocks - 1) /
+                        depth_blocks,
+                    (out_pixels + block_rows - 1) / block_rows));
+    dim3 block_dim = dim3(block_slices, block_rows);
+    dim3 grid_dim = dim3(depth_blocks, std::min(pixel_blocks, 65535));
+    DepthwiseConv2dBackpropFilterGPUKernelNHWCReduce<T, kKnownFilterWidth,
+                                                     kKnownFilterHeight>
+        <<<grid_dim, block_dim, shared_memory_size, d.stream()>>>(
+            args, out_backprop, input, filter_backprop);
+  } else if (data_format == FORMAT_NCHW) {
+    const int block_size = 256;
+    const int num_warps = block_size / 32;
+    const int shared_memory_size = num_warps * filter_pixels * sizeof(T);
+    const int pixel_blocks = std::max(
+        1, std::min((max_threads / block_size + args.out_depth - 1) /
+                        args.out_depth,
+                    (out_pixels + block_size - 1) / block_size));
+    dim3 grid_dim = dim3(args.out_depth, std::min(pixel_blocks, 65535));
+    DepthwiseConv2dBackpropFilterGPUKernelNCHWReduce<T, kKnownFilterWidth,
+                                                     kKnownFilterHeight>
+        <<<grid_dim, block_size, shared_memory_size, d.stream()>>>(
+            args, out_backprop, input, filter_backprop);
+  } else {
+    assert(false && "Incorrect data format");
+  }
+}
+
 // A simple launch pad to launch the Cuda kernel for depthwise convolution.
 template <typename T>
 struct DepthwiseConv2dBackpropFilterGPULaunch {
   static void Run(const GpuDevice& d, const DepthwiseArgs args,
                   const T* out_backprop, const T* input, T* filter_backprop,
                   TensorFormat data_format) {
-    if (args.filter_rows == 3 && args.filter_cols == 3 &&
-        args.depth_multiplier == 1) {
-      LaunchDepthwiseConv2dBackpropFilterGPU<T, 3, 3, 1>(
+    if (args.filter_rows == 3 && args.filter_cols == 3) {
+      LaunchDepthwiseConv2dBackpropFilterGPUReduce<T, 3, 3>(
+          d, args, out_backprop, input, filter_backprop, data_format);
+    } else if (args.filter_rows == 5 && args.filter_cols == 5) {
+      LaunchDepthwiseConv2dBackpropFilterGPUReduce<T, 5, 5>(
           d, args, out_backprop, input, filter_backprop, data_format);
     } else {
       LaunchDepthwiseConv2dBackpropFilterGPU<T, -1, -1, -1>(
@@ -188,8 +188,8 @@ class FakeQuantWithMinMaxVarsOp : public OpKernel {
     const Tensor& max = context->input(2);
 
     Tensor* output;
-    OP_REQUIRES_OK(context,
-                   context->allocate_output(0, input.shape(), &output));
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
 
     FakeQuantWithMinMaxVarsFunctor<Device> functor;
     functor(context->eigen_device<Device>(), input.flat<float>(),
@@ -322,8 +322,8 @@ class FakeQuantWithMinMaxVarsPerChannelOp : public OpKernel {
                                 " was ", max.dim_size(0)));
 
     Tensor* output;
-    OP_REQUIRES_OK(context,
-                   context->allocate_output(0, input.shape(), &output));
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
 
     switch (input.dims()) {
       case 4: {
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -105,6 +107,24 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // Splits the batch into elements before taking mu_, so that the copies
+  // don't hold up other enqueue and dequeue attempts.
+  auto elements =
+      std::make_shared<std::vector<std::vector<PersistentTensor>>>(
+          num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    (*elements)[i].resize(batch_size);
+    for (int64 index = 0; index < batch_size; ++index) {
+      Status s = GetElementComponentFromBatch(tuple, index, i, ctx,
+                                              &(*elements)[i][index]);
+      if (!s.ok()) {
+        ctx->SetStatus(s);
+        callback();
+        return;
+      }
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -115,7 +135,8 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     if (!already_cancelled) {
       enqueue_attempts_.emplace_back(
           batch_size, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          [elements, batch_size, this](Attempt* attempt)
+              EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             if (closed_) {
               attempt->context->SetStatus(
                   errors::Cancelled("FIFOQueue '", name_, "' is closed."));
@@ -124,14 +145,9 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
             RunResult result = kNoProgress;
             while (queues_[0].size() < static_cast<size_t>(capacity_)) {
               result = kProgress;
-              const int64 index =
-                  tuple[0].dim_size(0) - attempt->elements_requested;
+              const int64 index = batch_size - attempt->elements_requested;
               for (int i = 0; i < num_components(); ++i) {
-                PersistentTensor element;
-                attempt->context->SetStatus(GetElementComponentFromBatch(
-                    tuple, index, i, attempt->context, &element));
-                if (!attempt->context->status().ok()) return kComplete;
-                queues_[i].push_back(element);
+                queues_[i].push_back(std::move((*elements)[i][index]));
               }
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
@@ -304,6 +320,11 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                   }
                 }
 
+                if (attempt->tuple.empty() &&
+                    queue_size >= attempt->elements_requested) {
+                  return DequeueBatchLocked(attempt, callback);
+                }
+
                 RunResult result = kNoProgress;
                 for (; queue_size > 0; --queue_size) {
                   if (attempt->tuple.empty()) {
@@ -323,19 +344,22 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                     }
                   }
                   result = kProgress;
-                  Tuple tuple;
-                  DequeueLocked(attempt->context, &tuple);
                   const int64 index = attempt->tuple[0].dim_size(0) -
                                       attempt->elements_requested;
+                  // Copies every component before popping any of them, so
+                  // that a failed copy leaves the element in the queue.
                   for (int i = 0; i < num_components(); ++i) {
                     attempt->context->SetStatus(CopyElementToSlice(
-                        tuple[i], &attempt->tuple[i], index));
+                        *queues_[i][0].AccessTensor(attempt->context),
+                        &attempt->tuple[i], index));
                     if (!attempt->context->status().ok()) return kComplete;
                   }
-                  tuple.clear();
+                  for (int i = 0; i < num_components(); ++i) {
+                    queues_[i].pop_front();
+                  }
                   --attempt->elements_requested;
                   if (attempt->elements_requested == 0) {
-                    tuple = attempt->tuple;
+                    Tuple tuple = attempt->tuple;
                     attempt->done_callback = [callback, tuple]() {
                       callback(tuple);
                     };
@@ -354,6 +378,51 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
   }
 }
 
+QueueBase::RunResult FIFOQueue::DequeueBatchLocked(
+    Attempt* attempt, CallbackWithTuple callback) {
+  OpKernelContext* ctx = attempt->context;
+  const int64 num_elements = attempt->elements_requested;
+  Tuple batch;
+  batch.reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    Tensor component;
+    ctx->SetStatus(ctx->allocate_temp(
+        component_dtypes_[i], ManyOutShape(i, num_elements), &component));
+    if (!ctx->status().ok()) return kComplete;
+    batch.emplace_back(component);
+  }
+  // Only the element handles are moved under mu_.
+  auto elements =
+      std::make_shared<std::vector<std::vector<PersistentTensor>>>(
+          num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    auto begin = queues_[i].begin();
+    (*elements)[i].assign(std::make_move_iterator(begin),
+                          std::make_move_iterator(begin + num_elements));
+    queues_[i].erase(begin, begin + num_elements);
+  }
+  attempt->elements_requested = 0;
+
+  // done_callback runs outside mu_, so the copies into the batch don't hold
+  // up other attempts.
+  attempt->done_callback = [ctx, batch, elements, callback]() {
+    Tuple tuple = batch;  // Shares the buffers of batch.
+    for (size_t i = 0; i < elements->size(); ++i) {
+      for (size_t index = 0; index < (*elements)[i].size(); ++index) {
+        Status s = CopyElementToSlice(*(*elements)[i][index].AccessTensor(ctx),
+                                      &tuple[i], index);
+        if (!s.ok()) {
+          ctx->SetStatus(s);
+          callback(Tuple());
+          return;
+        }
+      }
+    }
+    callback(tuple);
+  };
+  return kComplete;
+}
+
 Status FIFOQueue::MatchesNodeDef(const NodeDef& node_def) {
   if (!MatchesNodeDefOp(node_def, "FIFOQueue").ok() &&
       !MatchesNodeDefOp(node_def, "FIFOQueueV2").ok()) {
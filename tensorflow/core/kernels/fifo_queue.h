@@ -60,6 +60,12 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Dequeues attempt->elements_requested elements, which must be available,
+  // into a batch for 'callback'. The elements are copied into the batch by
+  // attempt->done_callback, outside mu_.
+  RunResult DequeueBatchLocked(Attempt* attempt, CallbackWithTuple callback)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64 index,
                                              int component,
                                              OpKernelContext* ctx,
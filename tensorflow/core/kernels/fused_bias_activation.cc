@@ -0,0 +1,66 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fused_bias_activation.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+
+namespace tensorflow {
+
+Status FusedBiasActivationOps::Init(OpKernelConstruction* context) {
+  std::vector<string> fused_ops;
+  TF_RETURN_IF_ERROR(context->GetAttr("fused_ops", &fused_ops));
+  TF_RETURN_IF_ERROR(context->GetAttr("num_args", &num_args_));
+  TF_RETURN_IF_ERROR(context->GetAttr("epsilon", &epsilon_));
+
+  const auto unsupported = [&fused_ops]() {
+    return errors::Unimplemented("Unsupported fused ops: [",
+                                 str_util::Join(fused_ops, ", "), "]");
+  };
+  if (fused_ops.empty() || fused_ops.size() > 2) {
+    return unsupported();
+  }
+  int expected_num_args;
+  if (fused_ops[0] == "BiasAdd") {
+    batch_norm_ = false;
+    expected_num_args = 1;
+  } else if (fused_ops[0] == "FusedBatchNorm") {
+    batch_norm_ = true;
+    expected_num_args = 4;
+  } else {
+    return unsupported();
+  }
+  activation_ = functor::FusedActivation::kNone;
+  if (fused_ops.size() == 2) {
+    if (fused_ops[1] == "Relu") {
+      activation_ = functor::FusedActivation::kRelu;
+    } else if (fused_ops[1] == "Relu6") {
+      activation_ = functor::FusedActivation::kRelu6;
+    } else if (fused_ops[1] == "Elu") {
+      activation_ = functor::FusedActivation::kElu;
+    } else {
+      return unsupported();
+    }
+  }
+  if (num_args_ != expected_num_args) {
+    return errors::InvalidArgument("Fused ", fused_ops[0], " expects ",
+                                   expected_num_args, " arguments, got ",
+                                   num_args_);
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
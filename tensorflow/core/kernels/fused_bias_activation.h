@@ -0,0 +1,118 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_FUSED_BIAS_ACTIVATION_H_
+#define TENSORFLOW_KERNELS_FUSED_BIAS_ACTIVATION_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/fused_bias_activation_functor.h"
+
+namespace tensorflow {
+
+#if GOOGLE_CUDA
+namespace functor {
+// Forward declarations of the functor specializations for GPU.
+#define DECLARE_GPU_SPEC(T)                                                   \
+  template <>                                                                 \
+  void FusedBiasActivation<Eigen::GpuDevice, T>::operator()(                  \
+      const Eigen::GpuDevice& d, typename TTypes<T, 3>::Tensor output,        \
+      typename TTypes<T>::ConstVec scale, typename TTypes<T>::ConstVec offset, \
+      FusedActivation activation);                                            \
+  extern template struct FusedBiasActivation<Eigen::GpuDevice, T>;            \
+                                                                              \
+  template <>                                                                 \
+  void FusedBatchNormScaleOffset<Eigen::GpuDevice, T>::operator()(            \
+      const Eigen::GpuDevice& d, typename TTypes<T>::ConstVec scale,          \
+      typename TTypes<T>::ConstVec offset, typename TTypes<T>::ConstVec mean, \
+      typename TTypes<T>::ConstVec variance, T epsilon,                       \
+      typename TTypes<T>::Vec fused_scale,                                    \
+      typename TTypes<T>::Vec fused_offset);                                  \
+  extern template struct FusedBatchNormScaleOffset<Eigen::GpuDevice, T>;
+
+DECLARE_GPU_SPEC(float);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+#endif  // GOOGLE_CUDA
+
+// The ops fused after the convolution of _FusedConv2D or the matrix
+// multiplication of _FusedMatMul, from their `fused_ops`, `num_args` and
+// `epsilon` attributes: a BiasAdd or an inference FusedBatchNorm, optionally
+// followed by a Relu, Relu6 or Elu.
+class FusedBiasActivationOps {
+ public:
+  // Parses the attributes of the fused op.
+  Status Init(OpKernelConstruction* context);
+
+  // Applies the fused ops in place to `output`, whose shape is viewed as
+  // [outer, channels, inner]. Their arguments are the inputs of the kernel
+  // from `first_arg` on.
+  template <typename Device, typename T>
+  void Apply(OpKernelContext* context, int first_arg, int64 outer,
+             int64 channels, int64 inner, Tensor* output) const {
+    if (output->NumElements() == 0) {
+      return;
+    }
+    for (int i = 0; i < num_args_; ++i) {
+      const Tensor& arg = context->input(first_arg + i);
+      OP_REQUIRES(context,
+                  TensorShapeUtils::IsVector(arg.shape()) &&
+                      arg.dim_size(0) == channels,
+                  errors::InvalidArgument(
+                      "Fused argument ", i, " must be a vector of size ",
+                      channels, ": ", arg.shape().DebugString()));
+    }
+    const Device& d = context->eigen_device<Device>();
+    auto output_3d = output->shaped<T, 3>({outer, channels, inner});
+    if (!batch_norm_) {
+      typename TTypes<T>::ConstVec no_scale(nullptr, 0);
+      functor::FusedBiasActivation<Device, T>()(
+          d, output_3d, no_scale, context->input(first_arg).vec<T>(),
+          activation_);
+      return;
+    }
+    Tensor scale;
+    OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
+                                                   TensorShape({channels}),
+                                                   &scale));
+    Tensor offset;
+    OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
+                                                   TensorShape({channels}),
+                                                   &offset));
+    functor::FusedBatchNormScaleOffset<Device, T>()(
+        d, context->input(first_arg).vec<T>(),
+        context->input(first_arg + 1).vec<T>(),
+        context->input(first_arg + 2).vec<T>(),
+        context->input(first_arg + 3).vec<T>(), static_cast<T>(epsilon_),
+        scale.vec<T>(), offset.vec<T>());
+    functor::FusedBiasActivation<Device, T>()(
+        d, output_3d, const_cast<const Tensor&>(scale).vec<T>(),
+        const_cast<const Tensor&>(offset).vec<T>(), activation_);
+  }
+
+ private:
+  // Whether the first fused op is a FusedBatchNorm rather than a BiasAdd.
+  bool batch_norm_ = false;
+  functor::FusedActivation activation_ = functor::FusedActivation::kNone;
+  int num_args_ = 0;
+  float epsilon_ = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_FUSED_BIAS_ACTIVATION_H_
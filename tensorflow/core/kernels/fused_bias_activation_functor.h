@@ -0,0 +1,133 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_FUSED_BIAS_ACTIVATION_FUNCTOR_H_
+#define TENSORFLOW_KERNELS_FUSED_BIAS_ACTIVATION_FUNCTOR_H_
+// Functor definitions for the ops fused by _FusedConv2D and _FusedMatMul,
+// must be compilable by nvcc.
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The activation applied after the bias or the batch normalization.
+enum class FusedActivation { kNone, kRelu, kRelu6, kElu };
+
+namespace internal {
+
+// Assigns activation(x) to output.
+template <typename Device, typename T, typename Output, typename Input>
+void AssignActivation(const Device& d, Output output, const Input& x,
+                      FusedActivation activation) {
+  switch (activation) {
+    case FusedActivation::kNone:
+      output.device(d) = x;
+      break;
+    case FusedActivation::kRelu:
+      output.device(d) = x.cwiseMax(static_cast<T>(0));
+      break;
+    case FusedActivation::kRelu6:
+      output.device(d) =
+          x.cwiseMax(static_cast<T>(0)).cwiseMin(static_cast<T>(6));
+      break;
+    case FusedActivation::kElu:
+      output.device(d) = (x < static_cast<T>(0))
+                             .select(x.exp() - static_cast<T>(1), x);
+      break;
+  }
+}
+
+// Computes activation(output * scale + offset) in place, with scale and
+// offset reshaped to vector_shape and broadcast by bcast.
+template <typename Device, typename T, int NDIMS>
+void ScaleOffsetActivation(
+    const Device& d, typename TTypes<T, NDIMS>::Tensor output,
+    typename TTypes<T>::ConstVec scale, typename TTypes<T>::ConstVec offset,
+    FusedActivation activation,
+    const Eigen::DSizes<Eigen::Index, NDIMS>& vector_shape,
+    const Eigen::DSizes<Eigen::Index, NDIMS>& bcast) {
+  const auto offset_bcast = offset.reshape(vector_shape).broadcast(bcast);
+  if (scale.size() > 0) {
+    const auto scale_bcast = scale.reshape(vector_shape).broadcast(bcast);
+    AssignActivation<Device, T>(d, output, output * scale_bcast + offset_bcast,
+                                activation);
+  } else {
+    AssignActivation<Device, T>(d, output, output + offset_bcast, activation);
+  }
+}
+
+}  // namespace internal
+
+// Functor used by _FusedConv2D and _FusedMatMul to apply their bias or batch
+// normalization and their activation to their output in place, in a single
+// pass over the output.
+template <typename Device, typename T>
+struct FusedBiasActivation {
+  // Computes activation(output * scale + offset), or activation(output +
+  // offset) if scale is empty.
+  //
+  // output: [outer, channels, inner].
+  // scale:  [channels] or empty.
+  // offset: [channels].
+  void operator()(const Device& d, typename TTypes<T, 3>::Tensor output,
+                  typename TTypes<T>::ConstVec scale,
+                  typename TTypes<T>::ConstVec offset,
+                  FusedActivation activation) {
+    const Eigen::Index outer = output.dimension(0);
+    const Eigen::Index channels = output.dimension(1);
+    const Eigen::Index inner = output.dimension(2);
+    if (inner == 1) {
+      // The channels are the innermost dimension, which broadcasts faster as
+      // a matrix.
+      typename TTypes<T>::Matrix matrix(output.data(), outer, channels);
+      internal::ScaleOffsetActivation<Device, T, 2>(
+          d, matrix, scale, offset, activation,
+          Eigen::DSizes<Eigen::Index, 2>(1, channels),
+          Eigen::DSizes<Eigen::Index, 2>(outer, 1));
+    } else {
+      internal::ScaleOffsetActivation<Device, T, 3>(
+          d, output, scale, offset, activation,
+          Eigen::DSizes<Eigen::Index, 3>(1, channels, 1),
+          Eigen::DSizes<Eigen::Index, 3>(outer, 1, inner));
+    }
+  }
+};
+
+// Functor used by _FusedConv2D to fold the inference batch normalization into
+// a scale and an offset by channel.
+template <typename Device, typename T>
+struct FusedBatchNormScaleOffset {
+  // Computes fused_scale = scale / sqrt(variance + epsilon) and
+  // fused_offset = offset - mean * fused_scale.
+  //
+  // All the vectors have the same size.
+  void operator()(const Device& d, typename TTypes<T>::ConstVec scale,
+                  typename TTypes<T>::ConstVec offset,
+                  typename TTypes<T>::ConstVec mean,
+                  typename TTypes<T>::ConstVec variance, T epsilon,
+                  typename TTypes<T>::Vec fused_scale,
+                  typename TTypes<T>::Vec fused_offset) {
+    fused_scale.device(d) =
+        scale * (variance + variance.constant(epsilon)).rsqrt();
+    fused_offset.device(d) = offset - mean * fused_scale;
+  }
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_FUSED_BIAS_ACTIVATION_FUNCTOR_H_
@@ -16,28 +16,46 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_KERNELS_GATHER_FUNCTOR_H_
 
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
 namespace functor {
 
-// Helper method to copy using memcpy.
+// How many indices ahead of the copy the rows of params are prefetched, and
+// how many bytes of each row. Gathering from large tables is bound by the
+// latency of the loads, which prefetching far enough ahead hides.
+constexpr int kGatherPrefetchDistance = 8;
+constexpr size_t kGatherPrefetchBytes = 256;
+
+// Helper method to copy using memcpy the slices of params for the indices
+// [begin, end) to out. Returns the first bad index in that range, or -1.
 template <typename T, typename Index, typename SliceIndex,
           SliceIndex static_slice_elems>
 SliceIndex HandleCopies(typename TTypes<T>::ConstMatrix params,
                         typename TTypes<Index>::ConstFlat indices,
                         SliceIndex slice_elems,
-                        typename TTypes<T>::Matrix out) {
-  const SliceIndex first_dim_size =
-      static_cast<SliceIndex>(indices.dimension(0));
+                        typename TTypes<T>::Matrix out, SliceIndex begin,
+                        SliceIndex end) {
   const Index limit = static_cast<Index>(params.dimension(0));
   T* out_base = &out(0, 0);
   const T* params_base = &params(0, 0);
@@ -47,11 +65,22 @@ SliceIndex HandleCopies(typename TTypes<T>::ConstMatrix params,
   }
   // Compute slice_bytes here so that static knowledge is available
   const size_t slice_bytes = slice_elems * sizeof(T);
-  for (SliceIndex i = 0; i < first_dim_size; i++) {
-    const SliceIndex j = i + 1;
-    if (j < first_dim_size) {
-      port::prefetch<port::PREFETCH_HINT_T0>(&params(indices(j), 0));
-      port::prefetch<port::PREFETCH_HINT_T0>(&out(j, 0));
+  const size_t prefetch_bytes = std::min(slice_bytes, kGatherPrefetchBytes);
+  for (SliceIndex i = begin; i < end; i++) {
+    const SliceIndex j = i + kGatherPrefetchDistance;
+    if (j < end) {
+      // Only a hint, so a bad index is skipped here and reported below.
+      const Index next = indices(j);
+      if (FastBoundsCheck(next, limit)) {
+        const char* row =
+            reinterpret_cast<const char*>(params_base + next * slice_elems);
+        for (size_t b = 0; b < prefetch_bytes; b += 64) {
+          port::prefetch<port::PREFETCH_HINT_T0>(row + b);
+        }
+      }
+    }
+    if (i + 1 < end) {
+      port::prefetch<port::PREFETCH_HINT_T0>(&out(i + 1, 0));
     }
     // Grab the index and check its validity.  An earlier version of the
     // code checked it and then grabbed it from memory a second time, which
@@ -71,28 +100,107 @@ SliceIndex HandleCopies(typename TTypes<T>::ConstMatrix params,
   return -1;
 }
 
+// Copies row "from" of "src" to row "to" of "out".
+template <typename T, typename Matrix>
+inline void CopySlice(const Matrix& src, int64 from,
+                      typename TTypes<T>::Matrix out, int64 to) {
+  if (is_simple_type<T>::value) {
+    memcpy(&out(to, 0), &src(from, 0), out.dimension(1) * sizeof(T));
+  } else {
+    out.template chip<0>(to) = src.template chip<0>(from);
+  }
+}
+
+// Returns true if TF_GATHER_DEDUPLICATE_INDICES is set to true, in which case
+// the CPU gathers read each distinct row of params only once. It saves memory
+// bandwidth when the ids repeat a lot, e.g. for the embeddings of the popular
+// items in recommendation models, but the hashing of the indices costs more
+// than it saves when they do not.
+inline bool GatherDeduplicateIndices() {
+  static const bool deduplicate = [] {
+    bool value;
+    Status status =
+        ReadBoolFromEnvVar("TF_GATHER_DEDUPLICATE_INDICES", false, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return value;
+  }();
+  return deduplicate;
+}
+
 template <typename T, typename Index>
 struct GatherFunctorCPU {
+  // Gathers on the calling thread.
   int64 operator()(typename TTypes<T>::ConstMatrix params,
                    typename TTypes<Index>::ConstFlat indices,
                    typename TTypes<T>::Matrix out) {
+    auto serial = [](int64 total, int64 bytes_per_unit,
+                     const std::function<void(int64, int64)>& work) {
+      work(0, total);
+    };
+    return Gather(params, indices, out, serial, false /* deduplicate */);
+  }
+
+  // Shards the gather over the threads of "d", an Eigen::ThreadPoolDevice.
+  // A template so that only the translation units instantiating it need
+  // EIGEN_USE_THREADS.
+  template <typename Device>
+  int64 operator()(const Device& d, typename TTypes<T>::ConstMatrix params,
+                   typename TTypes<Index>::ConstFlat indices,
+                   typename TTypes<T>::Matrix out, bool deduplicate) {
+    auto parallel = [&d](int64 total, int64 bytes_per_unit,
+                         const std::function<void(int64, int64)>& work) {
+      d.parallelFor(total,
+                    Eigen::TensorOpCost(bytes_per_unit, bytes_per_unit, 0),
+                    work);
+    };
+    return Gather(params, indices, out, parallel, deduplicate);
+  }
+
+ private:
+  // Calls "shard(total, bytes_per_unit, work)" to run "work" on the ranges
+  // of [0, total), possibly in parallel.
+  template <typename Sharder>
+  static int64 Gather(typename TTypes<T>::ConstMatrix params,
+                      typename TTypes<Index>::ConstFlat indices,
+                      typename TTypes<T>::Matrix out, Sharder shard,
+                      bool deduplicate) {
     const int64 N = indices.size();
     const int64 slice_size = out.size() / N;
-    int64 bad_i;
+    const int64 slice_bytes = slice_size * sizeof(T);
+    if (deduplicate) {
+      return GatherDeduplicated(params, indices, out, shard);
+    }
+
+    // The first bad index found by any shard.
+    std::atomic<int64> bad_i(N);
+    auto record_bad = [&bad_i](int64 i) {
+      int64 current = bad_i.load();
+      while (i < current && !bad_i.compare_exchange_weak(current, i)) {
+      }
+    };
 
     bool use_large = (slice_size > std::numeric_limits<int32>::max() ||
                       params.size() > std::numeric_limits<int32>::max() ||
                       N > std::numeric_limits<int32>::max());
-#define CALL(elems)                                                   \
-  do {                                                                \
-    if (use_large) {                                                  \
-      bad_i = HandleCopies<T, Index, int64, elems>(params, indices,   \
-                                                   slice_size, out);  \
-    } else {                                                          \
-      const int32 small_slice = static_cast<int32>(slice_size);       \
-      bad_i = HandleCopies<T, Index, int32, elems>(params, indices,   \
-                                                   small_slice, out); \
-    }                                                                 \
+#define CALL(elems)                                                        \
+  do {                                                                     \
+    if (use_large) {                                                       \
+      shard(N, slice_bytes, [&](int64 begin, int64 end) {                  \
+        const int64 bad = HandleCopies<T, Index, int64, elems>(            \
+            params, indices, slice_size, out, begin, end);                 \
+        if (bad >= 0) record_bad(bad);                                     \
+      });                                                                  \
+    } else {                                                               \
+      const int32 small_slice = static_cast<int32>(slice_size);            \
+      shard(N, slice_bytes, [&](int64 begin, int64 end) {                  \
+        const int32 bad = HandleCopies<T, Index, int32, elems>(            \
+            params, indices, small_slice, out, static_cast<int32>(begin),  \
+            static_cast<int32>(end));                                      \
+        if (bad >= 0) record_bad(bad);                                     \
+      });                                                                  \
+    }                                                                      \
   } while (0)
 
     if (slice_size == 10)
@@ -103,7 +211,49 @@ struct GatherFunctorCPU {
       CALL(-1);
 #undef CALL
 
-    return bad_i;
+    return bad_i.load() < N ? bad_i.load() : -1;
+  }
+
+  // Copies each distinct row of params once, and the repeated ones from the
+  // first row of out they were copied to.
+  template <typename Sharder>
+  static int64 GatherDeduplicated(typename TTypes<T>::ConstMatrix params,
+                                  typename TTypes<Index>::ConstFlat indices,
+                                  typename TTypes<T>::Matrix out,
+                                  Sharder shard) {
+    const int64 N = indices.size();
+    const int64 slice_bytes = (out.size() / N) * sizeof(T);
+    const Index limit = static_cast<Index>(params.dimension(0));
+    // For each position, the first position with the same index, and the
+    // distinct indices with their first positions.
+    std::vector<int64> first(N);
+    std::vector<std::pair<int64, Index>> distinct;
+    std::unordered_map<Index, int64> positions;
+    for (int64 i = 0; i < N; ++i) {
+      const Index index = internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      auto inserted = positions.insert({index, i});
+      first[i] = inserted.first->second;
+      if (inserted.second) distinct.emplace_back(i, index);
+    }
+    const int64 num_distinct = distinct.size();
+    shard(num_distinct, slice_bytes, [&](int64 begin, int64 end) {
+      for (int64 k = begin; k < end; ++k) {
+        if (k + kGatherPrefetchDistance < end) {
+          port::prefetch<port::PREFETCH_HINT_T0>(
+              &params(distinct[k + kGatherPrefetchDistance].second, 0));
+        }
+        CopySlice<T>(params, distinct[k].second, out, distinct[k].first);
+      }
+    });
+    if (num_distinct < N) {
+      shard(N, slice_bytes, [&](int64 begin, int64 end) {
+        for (int64 i = begin; i < end; ++i) {
+          if (first[i] != i) CopySlice<T>(out, first[i], out, i);
+        }
+      });
+    }
+    return -1;
   }
 };
 
@@ -119,7 +269,8 @@ struct GatherFunctor<CPUDevice, T, Index> {
   int64 operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix params,
                    typename TTypes<Index>::ConstFlat indices,
                    typename TTypes<T>::Matrix out) {
-    return GatherFunctorCPU<T, Index>()(params, indices, out);
+    return GatherFunctorCPU<T, Index>()(d, params, indices, out,
+                                        GatherDeduplicateIndices());
   }
 };
 
@@ -13,10 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
 #include <functional>
 #include <memory>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/eigen_thread_pool.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -26,11 +29,15 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/gather_functor.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -150,6 +157,87 @@ TEST_F(GatherOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(GatherOpTest, ManyRepeatedIndices) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // Enough lookups to be sharded, repeating the ids.
+  const int kRows = 100;
+  const int kDim = 3;
+  const int kNumIndices = 10000;
+  std::vector<float> params(kRows * kDim);
+  for (int i = 0; i < params.size(); ++i) params[i] = i;
+  std::vector<int32> indices(kNumIndices);
+  std::vector<float> expected_values;
+  for (int i = 0; i < kNumIndices; ++i) {
+    indices[i] = (i * 37) % kRows;
+    for (int j = 0; j < kDim; ++j) {
+      expected_values.push_back(indices[i] * kDim + j);
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kDim}), params);
+  AddInputFromArray<int32>(TensorShape({kNumIndices}), indices);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kNumIndices, kDim}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+// The op only deduplicates when TF_GATHER_DEDUPLICATE_INDICES is set, so
+// the mode is tested on the functor.
+class GatherFunctorTest : public ::testing::Test {
+ protected:
+  GatherFunctorTest()
+      : threadpool_(Env::Default(), "test", 4 /* num_threads */),
+        wrapper_(&threadpool_),
+        device_(&wrapper_, 4 /* num_threads */) {}
+
+  template <typename T>
+  int64 Gather(const Tensor& params, const Tensor& indices, Tensor* out,
+               bool deduplicate) {
+    return functor::GatherFunctorCPU<T, int32>()(
+        device_, params.matrix<T>(), indices.flat<int32>(), out->matrix<T>(),
+        deduplicate);
+  }
+
+  thread::ThreadPool threadpool_;
+  EigenThreadPoolWrapper wrapper_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+TEST_F(GatherFunctorTest, Deduplicate) {
+  Tensor params(DT_STRING, TensorShape({50, 2}));
+  auto params_flat = params.flat<string>();
+  for (int i = 0; i < params_flat.size(); ++i) {
+    params_flat(i) = strings::StrCat(i);
+  }
+  Tensor indices(DT_INT32, TensorShape({1000}));
+  auto indices_flat = indices.flat<int32>();
+  for (int i = 0; i < indices_flat.size(); ++i) {
+    indices_flat(i) = (i * i) % 50;
+  }
+  Tensor expected(DT_STRING, TensorShape({1000, 2}));
+  Tensor out(DT_STRING, TensorShape({1000, 2}));
+  EXPECT_EQ(-1, Gather<string>(params, indices, &expected, false));
+  EXPECT_EQ(-1, Gather<string>(params, indices, &out, true));
+  test::ExpectTensorEqual<string>(expected, out);
+}
+
+TEST_F(GatherFunctorTest, FirstBadIndex) {
+  Tensor params(DT_FLOAT, TensorShape({50, 2}));
+  params.flat<float>().setZero();
+  Tensor indices(DT_INT32, TensorShape({1000}));
+  auto indices_flat = indices.flat<int32>();
+  for (int i = 0; i < indices_flat.size(); ++i) {
+    indices_flat(i) = i % 50;
+  }
+  indices_flat(900) = 50;
+  indices_flat(600) = -1;
+  Tensor out(DT_FLOAT, TensorShape({1000, 2}));
+  EXPECT_EQ(600, Gather<float>(params, indices, &out, false));
+  EXPECT_EQ(600, Gather<float>(params, indices, &out, true));
+}
+
 constexpr int kLookups = 2000;
 
 template <typename Index>
@@ -0,0 +1,68 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_GROUP_BY_INDEX_H_
+#define TENSORFLOW_KERNELS_GROUP_BY_INDEX_H_
+
+#include <limits>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+// Returns true if the rows of a scatter of "size" slices of "row_size"
+// elements into "num_rows" rows should be grouped with GroupByIndex and
+// reduced once per row, rather than updated with one atomic operation per
+// element. When there are at least as many slices as rows some rows are
+// bound to repeat, and the atomics on them serialize; "slow_atomics" (e.g.
+// for half, which is emulated with a compare-and-swap loop) makes the
+// grouping pay off for fewer repeats. Small scatters are left alone, since
+// the grouping launches a handful of kernels of its own.
+inline bool ShouldGroupByIndex(int64 size, int64 num_rows, int64 row_size,
+                               bool slow_atomics) {
+  const int64 kMinElements = 1 << 15;
+  if (size > std::numeric_limits<int32>::max() ||
+      num_rows > std::numeric_limits<int32>::max() ||
+      size * row_size < kMinElements) {
+    return false;
+  }
+  return num_rows <= (slow_atomics ? 4 : 1) * size;
+}
+
+namespace functor {
+
+// Sorts the positions of "indices" by the row they index, with a counting
+// sort. On return, "row_counts" and "row_starts" are int32 vectors of
+// "num_rows" elements, and "positions" an int32 vector of indices.size()
+// elements, such that the positions i with indices(i) == r are
+//   positions(row_starts(r)), ..., positions(row_starts(r) + row_counts(r) - 1)
+// in no particular order. Indices outside [0, num_rows) are dropped.
+// REQUIRES: indices.size() and num_rows fit in an int32.
+template <typename Device, typename Index>
+struct GroupByIndex {
+  Status operator()(OpKernelContext* ctx, const Device& d,
+                    typename TTypes<Index>::ConstFlat indices, Index num_rows,
+                    Tensor* row_counts, Tensor* row_starts, Tensor* positions);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_GROUP_BY_INDEX_H_
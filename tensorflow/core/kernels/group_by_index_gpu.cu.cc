@@ -0,0 +1,186 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/group_by_index.h"
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// The scan of the row counts runs in tiles of one element per thread of a
+// block, and needs a warp per lane of the first warp.
+const int kScanBlockSize = 1024;
+const int kWarpSize = 32;
+static_assert(kScanBlockSize == kWarpSize * kWarpSize,
+              "The scan sums the warps of a block in one warp.");
+
+// Adds one to the count of the row of each index.
+template <typename Index>
+__global__ void CountRowsKernel(const int32 size, const Index* indices,
+                                const Index num_rows, int32* row_counts) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    const Index row = indices[i];
+    if (row >= 0 && row < num_rows) {
+      CudaAtomicAdd(row_counts + row, 1);
+    }
+  }
+}
+
+// Returns the sum of "value" over the threads of the block up to and
+// including this one, and sets "total" to the sum over the whole block.
+// Must be called by all the threads of a block of kScanBlockSize.
+__device__ int32 BlockInclusiveSum(int32 value, int32* total) {
+  __shared__ int32 warp_sums[kScanBlockSize / kWarpSize];
+  const int lane = threadIdx.x % kWarpSize;
+  const int warp = threadIdx.x / kWarpSize;
+  for (int delta = 1; delta < kWarpSize; delta *= 2) {
+    const int32 other = CudaShuffleUp(value, delta);
+    if (lane >= delta) value += other;
+  }
+  if (lane == kWarpSize - 1) warp_sums[warp] = value;
+  __syncthreads();
+  if (warp == 0) {
+    int32 warp_sum = warp_sums[lane];
+    for (int delta = 1; delta < kWarpSize; delta *= 2) {
+      const int32 other = CudaShuffleUp(warp_sum, delta);
+      if (lane >= delta) warp_sum += other;
+    }
+    warp_sums[lane] = warp_sum;
+  }
+  __syncthreads();
+  if (warp > 0) value += warp_sums[warp - 1];
+  *total = warp_sums[kScanBlockSize / kWarpSize - 1];
+  // So that the next call doesn't overwrite the sums before they are read.
+  __syncthreads();
+  return value;
+}
+
+// Turns the counts into the starts of the rows within their tile of
+// kScanBlockSize rows, and writes the total count of each tile.
+__global__ void ScanTilesKernel(const int32 num_rows, const int32* row_counts,
+                                int32* row_starts, int32* tile_sums) {
+  const int32 row = blockIdx.x * kScanBlockSize + threadIdx.x;
+  const int32 count = row < num_rows ? row_counts[row] : 0;
+  int32 total;
+  const int32 end = BlockInclusiveSum(count, &total);
+  if (row < num_rows) row_starts[row] = end - count;
+  if (threadIdx.x == 0) tile_sums[blockIdx.x] = total;
+}
+
+// Turns the counts of the tiles into their starts, in a single block.
+__global__ void ScanTileSumsKernel(const int32 num_tiles, int32* tile_sums) {
+  int32 carry = 0;
+  for (int32 base = 0; base < num_tiles; base += kScanBlockSize) {
+    const int32 tile = base + threadIdx.x;
+    const int32 count = tile < num_tiles ? tile_sums[tile] : 0;
+    int32 total;
+    const int32 end = BlockInclusiveSum(count, &total);
+    if (tile < num_tiles) tile_sums[tile] = carry + end - count;
+    carry += total;
+  }
+}
+
+__global__ void AddTileStartsKernel(const int32 num_rows,
+                                    const int32* tile_sums,
+                                    int32* row_starts) {
+  const int32 row = blockIdx.x * kScanBlockSize + threadIdx.x;
+  if (row < num_rows) row_starts[row] += tile_sums[blockIdx.x];
+}
+
+// Writes each position into the slots of its row, counting the rows again
+// to hand out the slots.
+template <typename Index>
+__global__ void PlacePositionsKernel(const int32 size, const Index* indices,
+                                     const Index num_rows,
+                                     const int32* row_starts,
+                                     int32* row_counts, int32* positions) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    const Index row = indices[i];
+    if (row >= 0 && row < num_rows) {
+      positions[row_starts[row] + CudaAtomicAdd(row_counts + row, 1)] = i;
+    }
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename Index>
+struct GroupByIndex<GPUDevice, Index> {
+  Status operator()(OpKernelContext* ctx, const GPUDevice& d,
+                    typename TTypes<Index>::ConstFlat indices, Index num_rows,
+                    Tensor* row_counts, Tensor* row_starts,
+                    Tensor* positions) {
+    const int32 size = static_cast<int32>(indices.size());
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT32, TensorShape({num_rows}), row_counts));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT32, TensorShape({num_rows}), row_starts));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT32, TensorShape({size}), positions));
+    if (num_rows == 0) return Status::OK();
+    int32* counts = row_counts->flat<int32>().data();
+    int32* starts = row_starts->flat<int32>().data();
+    const size_t rows_bytes = num_rows * sizeof(int32);
+    d.memset(counts, 0, rows_bytes);
+    if (size == 0) {
+      d.memset(starts, 0, rows_bytes);
+      return Status::OK();
+    }
+
+    CudaLaunchConfig config = GetCudaLaunchConfig(size, d);
+    CountRowsKernel<Index>
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+            size, indices.data(), num_rows, counts);
+
+    const int32 num_tiles =
+        (static_cast<int32>(num_rows) + kScanBlockSize - 1) / kScanBlockSize;
+    Tensor tile_sums;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DT_INT32, TensorShape({num_tiles}), &tile_sums));
+    int32* tiles = tile_sums.flat<int32>().data();
+    ScanTilesKernel<<<num_tiles, kScanBlockSize, 0, d.stream()>>>(
+        num_rows, counts, starts, tiles);
+    ScanTileSumsKernel<<<1, kScanBlockSize, 0, d.stream()>>>(num_tiles,
+                                                              tiles);
+    AddTileStartsKernel<<<num_tiles, kScanBlockSize, 0, d.stream()>>>(
+        num_rows, tiles, starts);
+
+    d.memset(counts, 0, rows_bytes);
+    PlacePositionsKernel<Index>
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+            size, indices.data(), num_rows, starts, counts,
+            positions->flat<int32>().data());
+    return Status::OK();
+  }
+};
+
+template struct GroupByIndex<GPUDevice, int32>;
+template struct GroupByIndex<GPUDevice, int64>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -15,9 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/hexagon/graph_transfer_utils.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "tensorflow/cc/framework/scope.h"
 #include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 namespace tensorflow {
 
@@ -25,6 +32,23 @@ namespace tensorflow {
 constexpr auto AddOutputTensorShapeTypeByTensorShapeMap =
     &RemoteFusedGraphExecuteUtils::AddOutputTensorShapeTypeByTensorShapeMap;
 
+namespace {
+
+// Returns the size of the given output in bytes, or 0 if it's unknown.
+int64 GetOutputBytes(const Node& node, const int port) {
+  std::vector<DataType> data_types;
+  std::vector<TensorShape> shapes;
+  if (!RemoteFusedGraphExecuteUtils::GetOutputTensorShapeType(
+           node.attrs(), &data_types, &shapes)
+           .ok() ||
+      port >= data_types.size()) {
+    return 0;
+  }
+  return shapes.at(port).num_elements() * DataTypeSize(data_types.at(port));
+}
+
+}  // namespace
+
 /* static */ std::priority_queue<std::tuple<float, int, string>>
 GraphTransferUtils::GetTopNFloatResults(const float* const data,
                                         const string* const labels,
@@ -161,4 +185,127 @@ GraphTransferUtils::BuildRemoteFusedGraphExecuteInfo(
   return fusedGraphDef;
 }
 
+/* static */ Status GraphTransferUtils::BuildPartitionedFusedGraphDef(
+    const IGraphTransferOpsDefinitions& ops_definitions,
+    const string& remote_graph_execute_name_prefix,
+    const std::vector<std::pair<string, Tensor>>& inputs,
+    const std::vector<string>& outputs, const int min_fused_node_count,
+    const float min_work_to_transfer_ratio, const GraphDef& original_def,
+    GraphDef* fused_def) {
+  // Types and shapes of all tensors are needed to build placeholders of
+  // the fused subgraphs, and to estimate their costs.
+  GraphDef graph_def = original_def;
+  TF_RETURN_IF_ERROR(RemoteFusedGraphExecuteUtils::BuildAndAddTensorShapes(
+      inputs, /*dry_run_inference=*/true, &graph_def));
+
+  Graph graph(OpRegistry::Global());
+  ShapeRefiner shape_refiner(graph.versions().producer(), graph.op_registry());
+  TF_RETURN_IF_ERROR(ImportGraphDef({}, graph_def, &graph, &shape_refiner));
+
+  std::unordered_set<string> output_node_names;
+  for (const string& output : outputs) {
+    output_node_names.emplace(ParseTensorName(output).first.ToString());
+  }
+
+  std::unordered_map<string, const Node*> node_map;
+  std::unordered_set<string> supported_node_names;
+  for (const Node* node : graph.nodes()) {
+    if (!node->IsOp()) {
+      continue;
+    }
+    node_map.emplace(node->name(), node);
+    if (RemoteFusedGraphExecuteUtils::IsInputNode(inputs, node->name()) ||
+        node->type_string() == "Placeholder" ||
+        ops_definitions.GetOpIdFor(node->type_string(), {}) ==
+            IGraphTransferOpsDefinitions::INVALID_OP_ID) {
+      continue;
+    }
+    // A graph output in a fused subgraph is replaced by an identity node
+    // forwarding its only output.
+    const bool is_output = output_node_names.count(node->name()) > 0;
+    if (is_output && node->num_outputs() != 1) {
+      continue;
+    }
+    // Control dependencies are not kept across the border of a fused
+    // subgraph, and unused nodes would only become extra outputs.
+    bool has_control_edge = false;
+    bool has_consumer = false;
+    for (const Edge* edge : node->in_edges()) {
+      has_control_edge |= edge->IsControlEdge() && !edge->src()->IsSource();
+    }
+    for (const Edge* edge : node->out_edges()) {
+      has_control_edge |= edge->IsControlEdge() && !edge->dst()->IsSink();
+      has_consumer |= !edge->dst()->IsSink();
+    }
+    if (has_control_edge || (!has_consumer && !is_output)) {
+      continue;
+    }
+    supported_node_names.emplace(node->name());
+  }
+
+  std::vector<std::unordered_set<string>> partitions;
+  TF_RETURN_IF_ERROR(RemoteFusedGraphExecuteUtils::PartitionNodes(
+      supported_node_names, graph_def, &partitions));
+
+  // Each fused subgraph costs a round trip of its border tensors, so
+  // subgraphs doing too little work for their transfers are left on CPU.
+  std::vector<std::unordered_set<string>> fused_partitions;
+  for (const std::unordered_set<string>& partition : partitions) {
+    int fused_node_count = 0;
+    int64 work_bytes = 0;
+    int64 transfer_bytes = 0;
+    std::unordered_set<string> transferred_tensors;
+    const auto add_transfer = [&transferred_tensors, &transfer_bytes](
+        const Node& node, const int port) {
+      if (transferred_tensors.emplace(strings::StrCat(node.name(), ":", port))
+              .second) {
+        transfer_bytes += GetOutputBytes(node, port);
+      }
+    };
+    for (const string& node_name : partition) {
+      const Node* node = node_map.at(node_name);
+      if (!node->IsConstant()) {
+        ++fused_node_count;
+        for (int i = 0; i < node->num_outputs(); ++i) {
+          work_bytes += GetOutputBytes(*node, i);
+        }
+      }
+      for (const Edge* edge : node->in_edges()) {
+        if (!edge->IsControlEdge() &&
+            partition.count(edge->src()->name()) <= 0) {
+          add_transfer(*edge->src(), edge->src_output());
+        }
+      }
+      for (const Edge* edge : node->out_edges()) {
+        if (!edge->IsControlEdge() &&
+            partition.count(edge->dst()->name()) <= 0) {
+          add_transfer(*node, edge->src_output());
+        }
+      }
+      if (output_node_names.count(node_name) > 0) {
+        add_transfer(*node, 0);
+      }
+    }
+    const bool fused =
+        fused_node_count >= min_fused_node_count &&
+        work_bytes >= min_work_to_transfer_ratio * transfer_bytes;
+    LOG(INFO) << (fused ? "Fusing" : "Leaving on CPU") << " a subgraph of "
+              << partition.size() << " nodes (" << fused_node_count
+              << " non-const), " << work_bytes << " bytes of work, "
+              << transfer_bytes << " bytes of transfer";
+    if (fused) {
+      fused_partitions.emplace_back(partition);
+    }
+  }
+
+  std::vector<string> input_names;
+  for (const std::pair<string, Tensor>& input : inputs) {
+    input_names.emplace_back(input.first);
+  }
+  return RemoteFusedGraphExecuteUtils::FuseRemoteGraphByPartitions(
+      graph_def, input_names, outputs, remote_graph_execute_name_prefix,
+      fused_partitions, "build_hexagon_remote_fused_graph_executor",
+      /*require_shape_type=*/true, fused_def);
+}
+
 }  // namespace tensorflow
@@ -44,6 +44,20 @@ class GraphTransferUtils {
       const std::vector<std::pair<string, Tensor>>& inputs,
       const std::vector<string>& outputs, GraphDef* original_def);
 
+  // Fuse subgraphs of nodes supported by ops_definitions into
+  // RemoteFusedGraphExecute nodes, and leave the other nodes on CPU.
+  // A subgraph is fused only if it has at least min_fused_node_count nodes
+  // other than Const, and the bytes of the tensors produced inside of it are
+  // at least min_work_to_transfer_ratio times the bytes of the tensors
+  // transferred to and from it.
+  static Status BuildPartitionedFusedGraphDef(
+      const IGraphTransferOpsDefinitions& ops_definitions,
+      const string& remote_graph_execute_name_prefix,
+      const std::vector<std::pair<string, Tensor>>& inputs,
+      const std::vector<string>& outputs, const int min_fused_node_count,
+      const float min_work_to_transfer_ratio, const GraphDef& original_def,
+      GraphDef* fused_def);
+
  private:
   static RemoteFusedGraphExecuteInfo BuildRemoteFusedGraphExecuteInfo(
       const GraphDef& graph_def,
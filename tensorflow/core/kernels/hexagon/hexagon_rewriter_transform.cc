@@ -29,6 +29,11 @@ rewrite_quantized_stripped_model_for_hexagon(
 input_shape0="1,299,299,3" \
 input_type0="float" \
 )'
+
+To keep ops the hexagon runtime doesn't support on CPU, and offload only the
+subgraphs around them that are worth the transfer, use
+partition_quantized_stripped_model_for_hexagon with the same arguments, and
+optionally min_fused_node_count and min_work_to_transfer_ratio.
 */
 
 #include "tensorflow/core/kernels/hexagon/graph_transfer_utils.h"
@@ -40,13 +45,12 @@ namespace graph_transforms {
 constexpr const char* const INPUT_SHAPE_PREFIX = "input_shape";
 constexpr const char* const INPUT_TYPE_PREFIX = "input_type";
 
-Status RewriteQuantizedStrippedModelForHexagon(
-    const GraphDef& input_graph_def, const TransformFuncContext& context,
-    GraphDef* output_graph_def) {
-  LOG(INFO) << "Transforming quantized stripped model to a remote fused "
-               "graph execute op...";
-  std::vector<std::pair<string, Tensor>> inputs;
-  std::vector<string> outputs;
+constexpr const char* const MIN_FUSED_NODE_COUNT = "min_fused_node_count";
+constexpr const char* const MIN_WORK_TO_TRANSFER_RATIO =
+    "min_work_to_transfer_ratio";
+
+static Status GetInputs(const TransformFuncContext& context,
+                        std::vector<std::pair<string, Tensor>>* inputs) {
   for (auto i = 0; static_cast<size_t>(i) < context.input_names.size(); ++i) {
     const string& input_name = context.input_names.at(i);
 
@@ -69,8 +73,19 @@ Status RewriteQuantizedStrippedModelForHexagon(
               << ", shape = " << shape_string
               << ", type = " << data_type_string;
 
-    inputs.emplace_back(input_name, Tensor(data_type, TensorShape(dims)));
+    inputs->emplace_back(input_name, Tensor(data_type, TensorShape(dims)));
   }
+  return Status::OK();
+}
+
+Status RewriteQuantizedStrippedModelForHexagon(
+    const GraphDef& input_graph_def, const TransformFuncContext& context,
+    GraphDef* output_graph_def) {
+  LOG(INFO) << "Transforming quantized stripped model to a remote fused "
+               "graph execute op...";
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> outputs;
+  TF_RETURN_IF_ERROR(GetInputs(context, &inputs));
 
   for (const string& output_name : context.output_names) {
     outputs.emplace_back(output_name);
@@ -85,5 +100,29 @@ Status RewriteQuantizedStrippedModelForHexagon(
 REGISTER_GRAPH_TRANSFORM("rewrite_quantized_stripped_model_for_hexagon",
                          RewriteQuantizedStrippedModelForHexagon);
 
+Status PartitionQuantizedStrippedModelForHexagon(
+    const GraphDef& input_graph_def, const TransformFuncContext& context,
+    GraphDef* output_graph_def) {
+  LOG(INFO) << "Transforming quantized stripped model to remote fused "
+               "graph execute ops for supported subgraphs...";
+  std::vector<std::pair<string, Tensor>> inputs;
+  TF_RETURN_IF_ERROR(GetInputs(context, &inputs));
+
+  int32 min_fused_node_count;
+  TF_RETURN_IF_ERROR(context.GetOneInt32Parameter(MIN_FUSED_NODE_COUNT, 1,
+                                                  &min_fused_node_count));
+  float min_work_to_transfer_ratio;
+  TF_RETURN_IF_ERROR(context.GetOneFloatParameter(
+      MIN_WORK_TO_TRANSFER_RATIO, 1.0f, &min_work_to_transfer_ratio));
+
+  return GraphTransferUtils::BuildPartitionedFusedGraphDef(
+      HexagonOpsDefinitions::getInstance(), "remote_fused_graph_execute_node",
+      inputs, context.output_names, min_fused_node_count,
+      min_work_to_transfer_ratio, input_graph_def, output_graph_def);
+}
+
+REGISTER_GRAPH_TRANSFORM("partition_quantized_stripped_model_for_hexagon",
+                         PartitionQuantizedStrippedModelForHexagon);
+
 }  // namespace graph_transforms
 }  // namespace tensorflow
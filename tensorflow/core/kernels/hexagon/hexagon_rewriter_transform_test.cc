@@ -35,6 +35,9 @@ namespace graph_transforms {
 Status RewriteQuantizedStrippedModelForHexagon(
     const GraphDef& input_graph_def, const TransformFuncContext& context,
     GraphDef* output_graph_def);
+Status PartitionQuantizedStrippedModelForHexagon(
+    const GraphDef& input_graph_def, const TransformFuncContext& context,
+    GraphDef* output_graph_def);
 
 namespace {
 
@@ -76,6 +79,68 @@ TEST(HexagonRewriteTransformTest, BasicRun) {
   EXPECT_EQ(2, result.node_size());
 }
 
+TEST(HexagonRewriteTransformTest, PartitionRun) {
+  Scope root = tensorflow::Scope::NewRootScope();
+
+  // Create a graph that calculates tanh(placeholder + a) * b, where tanh is
+  // not supported by hexagon.
+  Output placeholder =
+      ops::Placeholder(root.WithOpName("placeholder"), DT_FLOAT);
+
+  Tensor a_data(DT_FLOAT, TensorShape({1, 1, 1, 1}));
+  test::FillIota<float>(&a_data, 1.0f);
+  Output a_const = ops::Const(root.WithOpName("a"), Input::Initializer(a_data));
+
+  Output add = ops::Add(root.WithOpName("add"), placeholder, a_const);
+
+  Output tanh = ops::Tanh(root.WithOpName("tanh"), add);
+
+  Tensor b_data(DT_FLOAT, TensorShape({1, 1, 1, 1}));
+  test::FillIota<float>(&b_data, 1.0f);
+  Output b_const = ops::Const(root.WithOpName("b"), Input::Initializer(b_data));
+
+  Output mul = ops::Mul(root.WithOpName("output"), tanh, b_const);
+
+  GraphDef graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+
+  TransformFuncContext context;
+  context.input_names = {"placeholder"};
+  context.output_names = {"output"};
+  context.params.insert(std::pair<string, std::vector<string>>(
+      {"input_shape0", {string("1,1,1,1")}}));
+  context.params.insert(std::pair<string, std::vector<string>>(
+      {"input_type0", {string("float")}}));
+
+  // Each of add and mul produces less than it transfers, so by default
+  // nothing is fused.
+  GraphDef result;
+  TF_ASSERT_OK(
+      PartitionQuantizedStrippedModelForHexagon(graph_def, context, &result));
+  EXPECT_EQ(6, result.node_size());
+
+  // Without the transfer cost, "a" + "add" and "b" + "output" are fused
+  // separately, leaving placeholder, 2 fused nodes, tanh and an identity
+  // node forwarding the output.
+  context.params.insert(std::pair<string, std::vector<string>>(
+      {"min_work_to_transfer_ratio", {string("0")}}));
+  result.Clear();
+  TF_ASSERT_OK(
+      PartitionQuantizedStrippedModelForHexagon(graph_def, context, &result));
+  EXPECT_EQ(5, result.node_size());
+  int fused_node_count = 0;
+  for (const NodeDef& node : result.node()) {
+    if (node.op() == "RemoteFusedGraphExecute") {
+      ++fused_node_count;
+    } else {
+      EXPECT_TRUE(node.name() == "placeholder" || node.name() == "tanh" ||
+                  node.name() == "output")
+          << node.name();
+    }
+  }
+  EXPECT_EQ(2, fused_node_count);
+}
+
 }  // namespace
 }  // namespace graph_transforms
 }  // namespace tensorflow
@@ -160,9 +160,15 @@ class MakeIteratorOp : public OpKernel {
   }
 };
 
-class OneShotIteratorOp : public OpKernel {
+class OneShotIteratorOp : public AsyncOpKernel {
  public:
-  explicit OneShotIteratorOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+  explicit OneShotIteratorOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        thread_pool_(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(),
+            strings::StrCat("one_shot_iterator_initialization_thread_",
+                            SanitizeThreadSuffix(def().name())),
+            1 /* num_threads */, false /* low_latency_hint */)) {
     string shared_name;
     OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name));
     OP_REQUIRES(ctx, shared_name.empty(),
@@ -190,99 +196,162 @@ class OneShotIteratorOp : public OpKernel {
   // does not provide access to the `OpKernelContext*` and we need this
   // to invoke the factory function, it's not possible to implement
   // this kernel by implementing `CreateResource()`.
-  void Compute(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    if (iterator_resource_ == nullptr) {
-      ResourceMgr* mgr = ctx->resource_manager();
-      OP_REQUIRES_OK(ctx, cinfo_.Init(mgr, def()));
-
-      // Create an IteratorResource that will hold the iterator for this op.
-      IteratorResource* resource;
-      OP_REQUIRES_OK(
-          ctx,
-          mgr->LookupOrCreate<IteratorResource>(
-              cinfo_.container(), cinfo_.name(), &resource,
-              [this](IteratorResource** ret) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-                *ret = new IteratorResource(output_dtypes_, output_shapes_);
-                return Status::OK();
-              }));
-      Status s = VerifyTypesMatch(output_dtypes_, resource->output_dtypes());
-      s.Update(
-          VerifyShapesCompatible(output_shapes_, resource->output_shapes()));
-      if (TF_PREDICT_FALSE(!s.ok())) {
-        resource->Unref();
-        ctx->SetStatus(s);
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    {
+      mutex_lock l(mu_);
+      if (!initialization_finished_) {
+        // Running the factory function blocks until it completes, and
+        // the function itself may need an inter-op thread pool thread,
+        // so the first call initializes the iterator on the owned
+        // thread pool. Concurrent calls wait for it to finish, without
+        // holding a thread.
+        if (!initialization_started_) {
+          initialization_started_ = true;
+          thread_pool_->Schedule([this, ctx, done]() { Init(ctx, done); });
+        } else {
+          done_callbacks_.emplace_back(ctx, std::move(done));
+        }
         return;
       }
-      iterator_resource_ = resource;
-
-      // Call the dataset_factory_func_ to create a new dataset,
-      // over which this op will iterate.
-      FunctionLibraryRuntime::Handle f_handle;
-      OP_REQUIRES_OK(ctx,
-                     ctx->function_library()->Instantiate(
-                         dataset_factory_func_->name(),
-                         AttrSlice(&dataset_factory_func_->attr()), &f_handle));
-      FunctionLibraryRuntime::Options opts;
-      opts.cancellation_manager = ctx->cancellation_manager();
-      // Choose a step ID that is guaranteed not to clash with any
-      // Session-generated step ID. DirectSession only generates
-      // non-negative step IDs (contiguous, starting from 0), and
-      // MasterSession generates 56-bit random step IDs whose MSB is
-      // always 0, so a negative random step ID should suffice.
-      opts.step_id = -std::abs(static_cast<int64>(random::New64()));
-      ScopedStepContainer step_container(
-          opts.step_id, [ctx](const string& name) {
-            ctx->resource_manager()->Cleanup(name).IgnoreError();
-          });
-      opts.step_container = &step_container;
-      opts.runner = ctx->runner();
-      Notification n;
-      Status factory_status;
-      std::vector<Tensor> return_values;
-      ctx->function_library()->Run(opts, f_handle, {}, &return_values,
-                                   [&n, &factory_status](Status s) {
-                                     factory_status.Update(s);
-                                     n.Notify();
-                                   });
-      n.WaitForNotification();
-      OP_REQUIRES_OK(ctx, factory_status);
-      OP_REQUIRES(
-          ctx,
-          return_values.size() == 1 &&
-              return_values[0].dtype() == DT_RESOURCE &&
-              TensorShapeUtils::IsScalar(return_values[0].shape()),
-          errors::InvalidArgument("The `dataset_factory` function must return "
-                                  "a single scalar of dtype DT_RESOURCE."));
-
-      // Retrieve the dataset that was created in the factory function.
-      DatasetBase* dataset;
-      const ResourceHandle& dataset_resource =
-          return_values[0].flat<ResourceHandle>()(0);
-      OP_REQUIRES_OK(ctx, LookupResource(ctx, dataset_resource, &dataset));
-      core::ScopedUnref unref_dataset(dataset);
-
-      // Create an iterator for the dataset that was created in the
-      // factory function. This transfers ownership of the dataset to
-      // the iterator, so we can delete it from the resource manager.
-      OP_REQUIRES_OK(ctx,
-                     iterator_resource_->set_iterator(dataset->MakeIterator()));
-      OP_REQUIRES_OK(ctx, DeleteResource<DatasetBase>(ctx, dataset_resource));
     }
-    Tensor* handle;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &handle));
-    handle->scalar<ResourceHandle>()() = MakeResourceHandle<IteratorResource>(
-        ctx, cinfo_.container(), cinfo_.name());
+    ProduceOutput(ctx, done);
   }
 
  private:
+  void Init(OpKernelContext* ctx, const DoneCallback& done) {
+    IteratorResource* iterator = nullptr;
+    ContainerInfo cinfo;
+    Status s = TryInit(ctx, &iterator, &cinfo);
+
+    std::vector<std::pair<OpKernelContext*, DoneCallback>> callbacks_to_run;
+    {
+      mutex_lock l(mu_);
+      if (iterator != nullptr) {
+        iterator_resource_ = iterator;
+        cinfo_ = cinfo;
+      }
+      initialization_status_ = s;
+      initialization_finished_ = true;
+      std::swap(done_callbacks_, callbacks_to_run);
+    }
+
+    for (auto&& ctx_done : callbacks_to_run) {
+      ProduceOutput(ctx_done.first, ctx_done.second);
+    }
+    ProduceOutput(ctx, done);
+  }
+
+  // Creates the IteratorResource for this op, and runs the
+  // `dataset_factory` function to create the iterator that it holds.
+  // Sets `*iterator` if the resource was created, even if a later
+  // step fails, so that the destructor can delete it.
+  Status TryInit(OpKernelContext* ctx, IteratorResource** iterator,
+                 ContainerInfo* cinfo) {
+    ResourceMgr* mgr = ctx->resource_manager();
+    TF_RETURN_IF_ERROR(cinfo->Init(mgr, def()));
+
+    // Create an IteratorResource that will hold the iterator for this op.
+    IteratorResource* resource;
+    TF_RETURN_IF_ERROR(mgr->LookupOrCreate<IteratorResource>(
+        cinfo->container(), cinfo->name(), &resource,
+        [this](IteratorResource** ret) {
+          *ret = new IteratorResource(output_dtypes_, output_shapes_);
+          return Status::OK();
+        }));
+    Status s = VerifyTypesMatch(output_dtypes_, resource->output_dtypes());
+    s.Update(VerifyShapesCompatible(output_shapes_, resource->output_shapes()));
+    if (TF_PREDICT_FALSE(!s.ok())) {
+      resource->Unref();
+      return s;
+    }
+    *iterator = resource;
+
+    // Call the dataset_factory_func_ to create a new dataset,
+    // over which this op will iterate.
+    FunctionLibraryRuntime::Handle f_handle;
+    TF_RETURN_IF_ERROR(ctx->function_library()->Instantiate(
+        dataset_factory_func_->name(),
+        AttrSlice(&dataset_factory_func_->attr()), &f_handle));
+    FunctionLibraryRuntime::Options opts;
+    opts.cancellation_manager = ctx->cancellation_manager();
+    // Choose a step ID that is guaranteed not to clash with any
+    // Session-generated step ID. DirectSession only generates
+    // non-negative step IDs (contiguous, starting from 0), and
+    // MasterSession generates 56-bit random step IDs whose MSB is
+    // always 0, so a negative random step ID should suffice.
+    opts.step_id = -std::abs(static_cast<int64>(random::New64()));
+    ScopedStepContainer step_container(
+        opts.step_id, [ctx](const string& name) {
+          ctx->resource_manager()->Cleanup(name).IgnoreError();
+        });
+    opts.step_container = &step_container;
+    opts.runner = ctx->runner();
+    Notification n;
+    Status factory_status;
+    std::vector<Tensor> return_values;
+    ctx->function_library()->Run(opts, f_handle, {}, &return_values,
+                                 [&n, &factory_status](Status s) {
+                                   factory_status.Update(s);
+                                   n.Notify();
+                                 });
+    n.WaitForNotification();
+    TF_RETURN_IF_ERROR(factory_status);
+    if (return_values.size() != 1 || return_values[0].dtype() != DT_RESOURCE ||
+        !TensorShapeUtils::IsScalar(return_values[0].shape())) {
+      return errors::InvalidArgument(
+          "The `dataset_factory` function must return "
+          "a single scalar of dtype DT_RESOURCE.");
+    }
+
+    // Retrieve the dataset that was created in the factory function.
+    DatasetBase* dataset;
+    const ResourceHandle& dataset_resource =
+        return_values[0].flat<ResourceHandle>()(0);
+    TF_RETURN_IF_ERROR(LookupResource(ctx, dataset_resource, &dataset));
+    core::ScopedUnref unref_dataset(dataset);
+
+    // Create an iterator for the dataset that was created in the
+    // factory function. This transfers ownership of the dataset to
+    // the iterator, so we can delete it from the resource manager.
+    TF_RETURN_IF_ERROR(resource->set_iterator(dataset->MakeIterator()));
+    return DeleteResource<DatasetBase>(ctx, dataset_resource);
+  }
+
+  void ProduceOutput(OpKernelContext* ctx, const DoneCallback& done) {
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = initialization_status_;
+    }
+    OP_REQUIRES_OK_ASYNC(ctx, s, done);
+    Tensor* handle;
+    OP_REQUIRES_OK_ASYNC(ctx, ctx->allocate_output(0, TensorShape({}), &handle),
+                         done);
+    {
+      mutex_lock l(mu_);
+      handle->scalar<ResourceHandle>()() = MakeResourceHandle<IteratorResource>(
+          ctx, cinfo_.container(), cinfo_.name());
+    }
+    done();
+  }
+
   const NameAttrList* dataset_factory_func_;
   DataTypeVector output_dtypes_;
   std::vector<PartialTensorShape> output_shapes_;
 
   mutex mu_;
   ContainerInfo cinfo_ GUARDED_BY(mu_);
-  IteratorResource* iterator_resource_ = nullptr;
+  IteratorResource* iterator_resource_ GUARDED_BY(mu_) = nullptr;
+
+  bool initialization_started_ GUARDED_BY(mu_) = false;
+  bool initialization_finished_ GUARDED_BY(mu_) = false;
+  Status initialization_status_ GUARDED_BY(mu_);
+  std::vector<std::pair<OpKernelContext*, DoneCallback>> done_callbacks_
+      GUARDED_BY(mu_);
+
+  // Declared last, so that a running initialization finishes before
+  // the state it uses is destroyed.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
 };
 
 class IteratorGetNextOp : public AsyncOpKernel {
@@ -293,12 +362,14 @@ class IteratorGetNextOp : public AsyncOpKernel {
             ctx->env(), ThreadOptions(),
             strings::StrCat("iterator_get_next_thread_",
                             SanitizeThreadSuffix(def().name())),
-            1 /* num_threads */, false /* low_latency_hint */)) {}
+            1 /* num_threads */, false /* low_latency_hint */)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("collect_stats", &collect_stats_));
+  }
 
   void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
     IteratorResource* iterator;
-    OP_REQUIRES_OK(ctx,
-                   LookupResource(ctx, HandleFromInput(ctx, 0), &iterator));
+    OP_REQUIRES_OK_ASYNC(
+        ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &iterator), done);
 
     // The call to `iterator->GetNext()` may block and depend on an
     // inter-op thread pool thread, so we issue the call from the
@@ -314,6 +385,7 @@ class IteratorGetNextOp : public AsyncOpKernel {
       params.step_id = ctx->step_id();
       params.resource_manager = ctx->resource_manager();
       params.runner = *(ctx->runner());
+      params.collect_stats = collect_stats_;
       IteratorContext iter_ctx(std::move(params));
 
       OP_REQUIRES_OK_ASYNC(
@@ -332,6 +404,7 @@ class IteratorGetNextOp : public AsyncOpKernel {
   }
 
  private:
+  bool collect_stats_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
 };
 
@@ -16,24 +16,187 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// The entries of a mutable hash table, split by the hash of their keys into
+// shards that are locked independently. Steps that look up and insert keys
+// concurrently only contend on the shards they both touch, and a batch of keys
+// takes the lock of each shard it touches once. With a single shard, every
+// batch is applied atomically.
+template <class K, class V>
+class ShardedMap {
+ public:
+  typedef gtl::FlatMap<K, V, LookupTableHash<K>> Map;
+
+  explicit ShardedMap(int num_shards)
+      : num_shards_(num_shards), shards_(new MapShard[num_shards]) {}
+
+  size_t size() const {
+    size_t size = 0;
+    for (int s = 0; s < num_shards_; ++s) {
+      mutex_lock l(shards_[s].mu);
+      size += shards_[s].map.size();
+    }
+    return size;
+  }
+
+  // Calls fn(i, map) for every key i of "keys", where "map" is the shard of
+  // keys(i), with the lock of the shard held. The keys of a shard are visited
+  // in order.
+  template <typename Fn>
+  void ForEachKey(const typename TTypes<K>::ConstFlat& keys, Fn fn) {
+    const int64 n = keys.size();
+    if (num_shards_ == 1) {
+      mutex_lock l(shards_[0].mu);
+      VisitKeys(keys, nullptr, 0, n, &shards_[0].map, &fn);
+      return;
+    }
+    // Sorts the positions of the keys by shard, keeping their order.
+    std::vector<int> shard_of(n);
+    std::vector<int64> starts(num_shards_ + 1, 0);
+    for (int64 i = 0; i < n; ++i) {
+      shard_of[i] = ShardOf(keys(i));
+      ++starts[shard_of[i] + 1];
+    }
+    for (int s = 0; s < num_shards_; ++s) {
+      starts[s + 1] += starts[s];
+    }
+    std::vector<int64> order(n);
+    std::vector<int64> next(starts.begin(), starts.end() - 1);
+    for (int64 i = 0; i < n; ++i) {
+      order[next[shard_of[i]]++] = i;
+    }
+    for (int s = 0; s < num_shards_; ++s) {
+      if (starts[s] == starts[s + 1]) continue;
+      mutex_lock l(shards_[s].mu);
+      VisitKeys(keys, order.data(), starts[s], starts[s + 1], &shards_[s].map,
+                &fn);
+    }
+  }
+
+  // Like ForEachKey, but clears the table first, and holds the locks of all
+  // the shards throughout.
+  template <typename Fn>
+  void ClearAndForEachKey(const typename TTypes<K>::ConstFlat& keys,
+                          Fn fn) NO_THREAD_SAFETY_ANALYSIS {
+    // The other methods hold at most one lock at a time, so taking them all
+    // can not deadlock.
+    for (int s = 0; s < num_shards_; ++s) {
+      shards_[s].mu.lock();
+      shards_[s].map.clear();
+    }
+    for (int64 i = 0; i < keys.size(); ++i) {
+      fn(i, &shards_[ShardOf(keys(i))].map);
+    }
+    for (int s = num_shards_ - 1; s >= 0; --s) {
+      shards_[s].mu.unlock();
+    }
+  }
+
+  // Copies the entries out of the table: calls allocate(n) once to allocate
+  // the outputs for n entries, then write(i, key, value) for each i in
+  // [0, n). The shards are copied in parallel on the CPU worker threads of
+  // "ctx", each with its lock held. With more than one shard, the entries
+  // of different shards may be copied at different times.
+  template <typename Allocate, typename Write>
+  Status Export(OpKernelContext* ctx, Allocate allocate, Write write) {
+    const DeviceBase::CpuWorkerThreads& workers =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_shard =
+        std::max<int64>(1, size() / num_shards_) * kExportCostPerEntry;
+    std::vector<std::vector<std::pair<K, V>>> entries(num_shards_);
+    Shard(workers.num_threads, workers.workers, num_shards_, cost_per_shard,
+          [this, &entries](int64 begin, int64 end) {
+            for (int64 s = begin; s < end; ++s) {
+              mutex_lock l(shards_[s].mu);
+              Map& map = shards_[s].map;
+              entries[s].reserve(map.size());
+              for (auto it = map.begin(); it != map.end(); ++it) {
+                entries[s].emplace_back(it->first, it->second);
+              }
+            }
+          });
+
+    std::vector<int64> offsets(num_shards_ + 1, 0);
+    for (int s = 0; s < num_shards_; ++s) {
+      offsets[s + 1] = offsets[s] + entries[s].size();
+    }
+    TF_RETURN_IF_ERROR(allocate(offsets[num_shards_]));
+    Shard(workers.num_threads, workers.workers, num_shards_, cost_per_shard,
+          [&entries, &offsets, &write](int64 begin, int64 end) {
+            for (int64 s = begin; s < end; ++s) {
+              for (size_t j = 0; j < entries[s].size(); ++j) {
+                write(offsets[s] + j, entries[s][j].first,
+                      entries[s][j].second);
+              }
+            }
+          });
+    return Status::OK();
+  }
+
+ private:
+  // Rough cost, in cycles, of copying an entry out of a shard.
+  static constexpr int64 kExportCostPerEntry = 100;
+
+  struct MapShard {
+    mutable mutex mu;
+    Map map GUARDED_BY(mu);
+  };
+
+  int ShardOf(const K& key) const {
+    // gtl::FlatMap picks the buckets of the keys from the low bits of their
+    // hash, so the shards are picked from the high ones.
+    const size_t h = LookupTableHash<K>()(key);
+    return static_cast<int>((h >> (sizeof(size_t) * 4)) % num_shards_);
+  }
+
+  // Calls (*fn)(i, map) for the positions i = order[p] (or p, if "order" is
+  // null) for p in [begin, end), prefetching the buckets of the keys ahead.
+  template <typename Fn>
+  static void VisitKeys(const typename TTypes<K>::ConstFlat& keys,
+                        const int64* order, int64 begin, int64 end, Map* map,
+                        Fn* fn) {
+    for (int64 p = begin; p < end; ++p) {
+      const int64 ahead = p + kFindPrefetchDistance;
+      if (ahead < end) {
+        map->prefetch_value(keys(order ? order[ahead] : ahead));
+      }
+      (*fn)(order ? order[p] : p, map);
+    }
+  }
+
+  const int num_shards_;
+  std::unique_ptr<MapShard[]> shards_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedMap);
+};
+
+template <class K, class V>
+constexpr int64 ShardedMap<K, V>::kExportCostPerEntry;
+
+// Lookup table that wraps a gtl::FlatMap, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// With the attr "num_shards" greater than 1, the table is split into that
+// many shards locked independently, and a Find may see part of a concurrent
+// Insert.
 //
 // Sample use case:
 //
@@ -46,26 +209,24 @@ namespace lookup {
 template <class K, class V>
 class MutableHashTableOfScalars final : public LookupInterface {
  public:
-  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
-
-  size_t size() const override {
-    mutex_lock l(mu_);
-    return table_.size();
+  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {
+    int num_shards;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_shards", &num_shards));
+    table_.reset(new Table(num_shards));
   }
 
+  size_t size() const override { return table_->size(); }
+
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
+    table_->ForEachKey(key_values, [&](int64 i, typename Table::Map* map) {
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
-          default_val);
-    }
-
+          *map, SubtleMustCopyUnlessStringOrFloat(key_values(i)), default_val);
+    });
     return Status::OK();
   }
 
@@ -73,14 +234,14 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    auto insert = [&](int64 i, typename Table::Map* map) {
+      (*map)[SubtleMustCopyUnlessStringOrFloat(key_values(i))] =
+          SubtleMustCopyUnlessStringOrFloat(value_values(i));
+    };
     if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_,
-                          SubtleMustCopyUnlessStringOrFloat(key_values(i)),
-                          SubtleMustCopyUnlessStringOrFloat(value_values(i)));
+      table_->ClearAndForEachKey(key_values, insert);
+    } else {
+      table_->ForEachKey(key_values, insert);
     }
     return Status::OK();
   }
@@ -96,24 +257,25 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    int64 size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
-    }
-    return Status::OK();
+    K* keys_data = nullptr;
+    V* values_data = nullptr;
+    auto allocate = [ctx, &keys_data, &values_data](int64 size) -> Status {
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      keys_data = keys->flat<K>().data();
+      values_data = values->flat<V>().data();
+      return Status::OK();
+    };
+    return table_->Export(
+        ctx, allocate,
+        [&keys_data, &values_data](int64 i, const K& key, const V& value) {
+          keys_data[i] = key;
+          values_data[i] = value;
+        });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -125,12 +287,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
  private:
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  typedef ShardedMap<K, V> Table;
+  std::unique_ptr<Table> table_;
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a gtl::FlatMap. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -142,12 +303,12 @@ class MutableHashTableOfTensors final : public LookupInterface {
         ctx, TensorShapeUtils::IsVector(value_shape_),
         errors::InvalidArgument("Default value must be a vector, got shape ",
                                 value_shape_.DebugString()));
+    int num_shards;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_shards", &num_shards));
+    table_.reset(new Table(num_shards));
   }
 
-  size_t size() const override {
-    mutex_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_->size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -156,10 +317,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto value_values = value->flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec = gtl::FindOrNull(
-          table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)));
+    table_->ForEachKey(key_values, [&](int64 i, typename Table::Map* map) {
+      const ValueArray* value_vec = gtl::FindOrNull(
+          *map, SubtleMustCopyUnlessStringOrFloat(key_values(i)));
       if (value_vec != nullptr) {
         for (int64 j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -169,8 +329,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
           value_values(i, j) = default_flat(j);
         }
       }
-    }
-
+    });
     return Status::OK();
   }
 
@@ -179,18 +338,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
+    auto insert = [&](int64 i, typename Table::Map* map) {
       ValueArray value_vec;
       for (int64 j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(
-          &table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)), value_vec);
+      (*map)[SubtleMustCopyUnlessStringOrFloat(key_values(i))] =
+          std::move(value_vec);
+    };
+    if (clear) {
+      table_->ClearAndForEachKey(key_values, insert);
+    } else {
+      table_->ForEachKey(key_values, insert);
     }
     return Status::OK();
   }
@@ -206,29 +366,29 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    int64 size = table_.size();
-    int64 value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->matrix<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64 j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
-      }
-    }
-    return Status::OK();
+    const int64 value_dim = value_shape_.dim_size(0);
+    K* keys_data = nullptr;
+    V* values_data = nullptr;
+    auto allocate = [ctx, value_dim, &keys_data,
+                     &values_data](int64 size) -> Status {
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      keys_data = keys->flat<K>().data();
+      values_data = values->flat<V>().data();
+      return Status::OK();
+    };
+    return table_->Export(
+        ctx, allocate, [value_dim, &keys_data, &values_data](
+                           int64 i, const K& key, const ValueArray& value) {
+          keys_data[i] = key;
+          for (int64 j = 0; j < value_dim; j++) {
+            values_data[i * value_dim + j] = value[j];
+          }
+        });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -240,11 +400,11 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
  private:
-  TensorShape value_shape_;
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
-  mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ GUARDED_BY(mu_);
+  typedef ShardedMap<K, ValueArray> Table;
+
+  TensorShape value_shape_;
+  std::unique_ptr<Table> table_;
 };
 
 namespace {
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <type_traits>
+#include <vector>
+
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -25,7 +28,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
@@ -141,7 +147,34 @@ inline const double SubtleMustCopyUnlessStringOrFloat(const double value) {
   return value;
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// How many keys ahead of the one being looked up the hash tables prefetch the
+// bucket of in Find. The bucket of a random key is almost always a cache miss.
+constexpr int64 kFindPrefetchDistance = 8;
+
+// Hash of the keys of the flat lookup tables. gtl::FlatMap picks the bucket
+// and the marker of a key from different bits of its hash, so integer keys
+// go through a 64-bit finalizer rather than the identity std::hash uses.
+template <typename T>
+struct LookupTableHash {
+  size_t operator()(const T& key) const {
+    uint64 h = static_cast<uint64>(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+};
+
+template <>
+struct LookupTableHash<string> {
+  size_t operator()(const string& key) const {
+    return static_cast<size_t>(Hash64(key));
+  }
+};
+
+// Lookup table that wraps a gtl::FlatMap, where the key and value data type
 // is specified.
 //
 // This table is recommended for any variations to key values.
@@ -149,11 +182,16 @@ inline const double SubtleMustCopyUnlessStringOrFloat(const double value) {
 // For look up, the table is required to be initialized (allocated
 // and populated). Once the table is marked as initialized it becomes read-only.
 //
+// The entries are stored inline in an open-addressing array, rather than in
+// one heap node each. String keys can be replaced by their 64-bit fingerprint
+// with the attr "fingerprint_keys", which bounds the memory of an entry, at
+// the cost of a (tiny) chance that two keys collide and share a value.
+//
 // Sample use case:
 //
 // HashTable<int64, int64> table;  // int64 -> int64.
 // table.Prepare(10); // Prepare the underlying data structure, the number of
-//                    // elements is required by interface, but not used.
+//                    // elements is used to size it, if known.
 // // Populate the table, elements could be added in one or multiple calls.
 // table.Insert(key_tensor, value_tensor); // Populate the table.
 // ...
@@ -164,7 +202,18 @@ inline const double SubtleMustCopyUnlessStringOrFloat(const double value) {
 template <class K, class V>
 class HashTable : public InitializableLookupTable {
  public:
-  HashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+  HashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    // HashTable is also created by kernels of other ops, which do not have
+    // the attr.
+    if (kernel->def().attr().count("fingerprint_keys") > 0) {
+      OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "fingerprint_keys",
+                                      &fingerprint_keys_));
+    }
+    OP_REQUIRES(ctx, (!fingerprint_keys_ || std::is_same<K, string>::value),
+                errors::InvalidArgument(
+                    "fingerprint_keys is only supported for string keys, got ",
+                    DataTypeString(DataTypeToEnum<K>::v())));
+  }
 
   size_t size() const override {
     // return the size of the table only if it's initialized, otherwise 0.
@@ -172,6 +221,7 @@ class HashTable : public InitializableLookupTable {
       return 0;
     }
     std::atomic_thread_fence(std::memory_order_acquire);
+    if (fingerprint_table_) return fingerprint_table_->size();
     return table_ ? table_->size() : 0;
   }
 
@@ -180,35 +230,39 @@ class HashTable : public InitializableLookupTable {
   DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
 
  protected:
-  Status DoPrepare(size_t unused) override {
+  Status DoPrepare(size_t expected_num_elements) override {
     if (is_initialized_) {
       return errors::Aborted("HashTable already initialized.");
     }
-    if (!table_) {
-      table_ = std::unique_ptr<std::unordered_map<K, V>>(
-          new std::unordered_map<K, V>());
+    // The initializers pass -1 when they do not know the number of elements.
+    const int64 expected = static_cast<int64>(expected_num_elements);
+    if (fingerprint_keys_) {
+      if (!fingerprint_table_) {
+        fingerprint_table_.reset(new FingerprintMap);
+      }
+      if (expected > 0) fingerprint_table_->reserve(expected);
+    } else {
+      if (!table_) {
+        table_.reset(new Map);
+      }
+      if (expected > 0) table_->reserve(expected);
     }
     return Status::OK();
   };
 
   Status DoInsert(const Tensor& keys, const Tensor& values) override {
-    if (!table_) {
-      return errors::FailedPrecondition("HashTable is not prepared.");
-    }
-
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      const K key = SubtleMustCopyUnlessStringOrFloat(key_values(i));
-      const V value = SubtleMustCopyUnlessStringOrFloat(value_values(i));
-      const V& previous_value = gtl::LookupOrInsert(table_.get(), key, value);
-      if (previous_value != value) {
-        return errors::FailedPrecondition(
-            "HashTable has different value for same key. Key ", key, " has ",
-            previous_value, " and trying to add value ", value);
-      }
+    if (fingerprint_table_) {
+      const std::vector<uint64> fingerprints = Fingerprints(key_values);
+      return InsertAll(fingerprint_table_.get(), fingerprints.data(),
+                       key_values, value_values);
     }
-    return Status::OK();
+    if (!table_) {
+      return errors::FailedPrecondition("HashTable is not prepared.");
+    }
+    return InsertAll(table_.get(), key_values.data(), key_values,
+                     value_values);
   }
 
   Status DoFind(const Tensor& key, Tensor* value,
@@ -217,25 +271,89 @@ class HashTable : public InitializableLookupTable {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          *table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
-          default_val);
+    if (fingerprint_table_) {
+      const std::vector<uint64> fingerprints = Fingerprints(key_values);
+      FindAll(*fingerprint_table_, fingerprints.data(), key_values.size(),
+              default_val, &value_values);
+    } else {
+      FindAll(*table_, key_values.data(), key_values.size(), default_val,
+              &value_values);
     }
     return Status::OK();
   }
 
   int64 MemoryUsed() const override {
-    if (table_) {
-      const int64 num_elements = table_->size();
-      return num_elements * (sizeof(K) + sizeof(V));
+    // Every bucket holds a key, a value and a one byte marker, whether it is
+    // used or not.
+    if (fingerprint_table_) {
+      return fingerprint_table_->bucket_count() *
+             (sizeof(uint64) + sizeof(V) + 1);
+    } else if (table_) {
+      return table_->bucket_count() * (sizeof(K) + sizeof(V) + 1);
     } else {
       return 0;
     }
   }
 
  private:
-  std::unique_ptr<std::unordered_map<K, V>> table_;
+  typedef gtl::FlatMap<K, V, LookupTableHash<K>> Map;
+  typedef gtl::FlatMap<uint64, V, LookupTableHash<uint64>> FingerprintMap;
+
+  static std::vector<uint64> Fingerprints(
+      const typename TTypes<K>::ConstFlat& keys) {
+    std::vector<uint64> fingerprints(keys.size());
+    for (int64 i = 0; i < keys.size(); ++i) {
+      fingerprints[i] = Fingerprint(keys(i));
+    }
+    return fingerprints;
+  }
+
+  static uint64 Fingerprint(const string& key) { return Fingerprint64(key); }
+
+  // Never called, the constructor only allows fingerprints of strings.
+  template <typename T>
+  static uint64 Fingerprint(const T& key) {
+    return static_cast<uint64>(key);
+  }
+
+  // Inserts keys[i] -> values(i) in "table". "original_keys" are the keys the
+  // user passed, for the error messages.
+  template <typename TableMap, typename TableKey>
+  static Status InsertAll(TableMap* table, const TableKey* keys,
+                          const typename TTypes<K>::ConstFlat& original_keys,
+                          const typename TTypes<V>::ConstFlat& values) {
+    for (int64 i = 0; i < original_keys.size(); ++i) {
+      const TableKey key = SubtleMustCopyUnlessStringOrFloat(keys[i]);
+      const V value = SubtleMustCopyUnlessStringOrFloat(values(i));
+      auto inserted = table->insert({key, value});
+      const V& previous_value = inserted.first->second;
+      if (previous_value != value) {
+        return errors::FailedPrecondition(
+            "HashTable has different value for same key. Key ",
+            original_keys(i), " has ", previous_value,
+            " and trying to add value ", value);
+      }
+    }
+    return Status::OK();
+  }
+
+  template <typename TableMap, typename TableKey>
+  static void FindAll(const TableMap& table, const TableKey* keys, int64 n,
+                      const V& default_val,
+                      typename TTypes<V>::Flat* values) {
+    for (int64 i = 0; i < n; ++i) {
+      if (i + kFindPrefetchDistance < n) {
+        table.prefetch_value(keys[i + kFindPrefetchDistance]);
+      }
+      (*values)(i) = gtl::FindWithDefault(
+          table, SubtleMustCopyUnlessStringOrFloat(keys[i]), default_val);
+    }
+  }
+
+  bool fingerprint_keys_ = false;
+  // Exactly one of them is set once the table is prepared.
+  std::unique_ptr<Map> table_;
+  std::unique_ptr<FingerprintMap> fingerprint_table_;
 };
 
 }  // namespace lookup
@@ -0,0 +1,466 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/lookup_table_op.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Yields a single batch of keys and values.
+class TensorIterator
+    : public lookup::InitializableLookupTable::InitTableIterator {
+ public:
+  TensorIterator(const Tensor& keys, const Tensor& values)
+      : keys_(keys), values_(values) {}
+
+  void Next() override { valid_ = false; }
+  bool Valid() const override { return valid_; }
+  const Tensor& keys() const override { return keys_; }
+  const Tensor& values() const override { return values_; }
+  Status status() const override {
+    return valid_ ? Status::OK() : errors::OutOfRange("No more data.");
+  }
+  int64 total_size() const override { return keys_.NumElements(); }
+
+ private:
+  Tensor keys_;
+  Tensor values_;
+  bool valid_ = true;
+};
+
+class HashTableOpTest : public OpsTestBase {
+ protected:
+  // Creates a table with a HashTableV2 op. The caller owns a reference to
+  // "*table".
+  Status MakeTable(DataType key_dtype, DataType value_dtype,
+                   bool fingerprint_keys, lookup::LookupInterface** table) {
+    NodeDefBuilder builder("table", "HashTableV2");
+    builder.Attr("key_dtype", key_dtype)
+        .Attr("value_dtype", value_dtype)
+        .Attr("fingerprint_keys", fingerprint_keys);
+    return CreateTable(&builder, table);
+  }
+
+  // Creates a table of scalars with a MutableHashTableV2 op, shared under
+  // "shared_name" so that it outlives the op.
+  Status MakeMutableTable(DataType key_dtype, DataType value_dtype,
+                          int num_shards, const string& shared_name,
+                          lookup::LookupInterface** table) {
+    NodeDefBuilder builder("table", "MutableHashTableV2");
+    builder.Attr("key_dtype", key_dtype)
+        .Attr("value_dtype", value_dtype)
+        .Attr("num_shards", num_shards)
+        .Attr("shared_name", shared_name);
+    return CreateTable(&builder, table);
+  }
+
+  Status CreateTable(NodeDefBuilder* builder,
+                     lookup::LookupInterface** table) {
+    TF_RETURN_IF_ERROR(builder->Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    // Drops the inputs of the ops run before.
+    inputs_.clear();
+    TF_RETURN_IF_ERROR(RunOpKernel());
+    handle_ = GetOutput(0)->scalar<ResourceHandle>()();
+    return device_->resource_manager()->Lookup(handle_.container(),
+                                               handle_.name(), table);
+  }
+
+  // Runs a LookupTableExportV2 op on the last table created, and returns the
+  // pairs it outputs in order.
+  template <typename K, typename V>
+  Status Export(std::vector<std::pair<K, V>>* entries) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("export", "LookupTableExportV2")
+                           .Input(FakeInput(DT_RESOURCE))
+                           .Attr("Tkeys", DataTypeToEnum<K>::v())
+                           .Attr("Tvalues", DataTypeToEnum<V>::v())
+                           .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    inputs_.clear();
+    AddInputFromArray<ResourceHandle>(TensorShape({}), {handle_});
+    TF_RETURN_IF_ERROR(RunOpKernel());
+    const auto keys = GetOutput(0)->flat<K>();
+    const auto values = GetOutput(1)->flat<V>();
+    entries->clear();
+    for (int64 i = 0; i < keys.size(); ++i) {
+      entries->emplace_back(keys(i), values(i));
+    }
+    std::sort(entries->begin(), entries->end());
+    return Status::OK();
+  }
+
+  static Status Initialize(lookup::LookupInterface* table, const Tensor& keys,
+                           const Tensor& values) {
+    TensorIterator iter(keys, values);
+    return table->GetInitializableLookupTable()->Initialize(iter);
+  }
+
+  Status Find(lookup::LookupInterface* table, const Tensor& keys,
+              const Tensor& default_value, Tensor* values) {
+    *values = Tensor(default_value.dtype(), keys.shape());
+    return table->Find(context_.get(), keys, values, default_value);
+  }
+
+  ResourceHandle handle_;
+};
+
+TEST_F(HashTableOpTest, Int64Keys) {
+  lookup::LookupInterface* table = nullptr;
+  TF_ASSERT_OK(MakeTable(DT_INT64, DT_INT64, false, &table));
+  core::ScopedUnref unref(table);
+
+  Tensor keys(DT_INT64, TensorShape({1000}));
+  Tensor values(DT_INT64, TensorShape({1000}));
+  for (int64 i = 0; i < keys.NumElements(); ++i) {
+    // Keys with the same low bits exercise the hash.
+    keys.flat<int64>()(i) = i << 32;
+    values.flat<int64>()(i) = i;
+  }
+  TF_ASSERT_OK(Initialize(table, keys, values));
+  EXPECT_EQ(1000, table->size());
+
+  Tensor out;
+  TF_ASSERT_OK(Find(table, keys, test::AsScalar<int64>(-1), &out));
+  test::ExpectTensorEqual<int64>(values, out);
+
+  TF_ASSERT_OK(Find(table, test::AsTensor<int64>({1, 5LL << 32, -1}),
+                    test::AsScalar<int64>(-1), &out));
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({-1, 5, -1}), out);
+}
+
+TEST_F(HashTableOpTest, StringKeys) {
+  for (bool fingerprint_keys : {false, true}) {
+    lookup::LookupInterface* table = nullptr;
+    TF_ASSERT_OK(MakeTable(DT_STRING, DT_INT64, fingerprint_keys, &table));
+    core::ScopedUnref unref(table);
+
+    TF_ASSERT_OK(Initialize(table, test::AsTensor<string>({"a", "b", "c"}),
+                            test::AsTensor<int64>({0, 1, 2})));
+    EXPECT_EQ(3, table->size());
+
+    Tensor out;
+    TF_ASSERT_OK(Find(table, test::AsTensor<string>({"c", "d", "a", ""}),
+                      test::AsScalar<int64>(-1), &out));
+    test::ExpectTensorEqual<int64>(test::AsTensor<int64>({2, -1, 0, -1}),
+                                   out);
+  }
+}
+
+TEST_F(HashTableOpTest, FingerprintsUseLessMemory) {
+  Tensor keys(DT_STRING, TensorShape({100}));
+  Tensor values(DT_INT64, TensorShape({100}));
+  for (int64 i = 0; i < keys.NumElements(); ++i) {
+    keys.flat<string>()(i) = strings::StrCat("key_", i);
+    values.flat<int64>()(i) = i;
+  }
+  int64 memory_used[2];
+  for (bool fingerprint_keys : {false, true}) {
+    lookup::LookupInterface* table = nullptr;
+    TF_ASSERT_OK(MakeTable(DT_STRING, DT_INT64, fingerprint_keys, &table));
+    core::ScopedUnref unref(table);
+    TF_ASSERT_OK(Initialize(table, keys, values));
+    memory_used[fingerprint_keys] = table->MemoryUsed();
+  }
+  EXPECT_GT(memory_used[0], memory_used[1]);
+}
+
+TEST_F(HashTableOpTest, FingerprintsNeedStringKeys) {
+  lookup::LookupInterface* table = nullptr;
+  Status s = MakeTable(DT_INT64, DT_INT64, true, &table);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(HashTableOpTest, DifferentValueForSameKey) {
+  lookup::LookupInterface* table = nullptr;
+  TF_ASSERT_OK(MakeTable(DT_STRING, DT_INT64, false, &table));
+  core::ScopedUnref unref(table);
+  Status s = Initialize(table, test::AsTensor<string>({"a", "b", "a"}),
+                        test::AsTensor<int64>({0, 1, 2}));
+  EXPECT_TRUE(errors::IsFailedPrecondition(s)) << s;
+  EXPECT_TRUE(StringPiece(s.error_message()).contains("Key a has 0")) << s;
+}
+
+TEST_F(HashTableOpTest, MutableTableShards) {
+  for (int num_shards : {1, 7}) {
+    const string shared_name = strings::StrCat("table_", num_shards);
+    lookup::LookupInterface* table = nullptr;
+    TF_ASSERT_OK(
+        MakeMutableTable(DT_INT64, DT_FLOAT, num_shards, shared_name, &table));
+    core::ScopedUnref unref(table);
+
+    Tensor keys(DT_INT64, TensorShape({1000}));
+    Tensor values(DT_FLOAT, TensorShape({1000}));
+    for (int64 i = 0; i < keys.NumElements(); ++i) {
+      keys.flat<int64>()(i) = i;
+      values.flat<float>()(i) = i;
+    }
+    TF_ASSERT_OK(table->Insert(context_.get(), keys, values));
+    // Overwrites the odd keys, in a batch with repeated keys: the last
+    // value of a key wins.
+    TF_ASSERT_OK(table->Insert(context_.get(),
+                               test::AsTensor<int64>({1, 3, 1, 5}),
+                               test::AsTensor<float>({-1, -3, -10, -5})));
+    EXPECT_EQ(1000, table->size());
+
+    Tensor out;
+    TF_ASSERT_OK(Find(table, test::AsTensor<int64>({0, 1, 2, 3, 5, 1000}),
+                      test::AsScalar<float>(-100), &out));
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({0, -10, 2, -3, -5, -100}), out);
+
+    std::vector<std::pair<int64, float>> entries;
+    TF_ASSERT_OK((Export<int64, float>(&entries)));
+    ASSERT_EQ(1000, entries.size());
+    EXPECT_EQ(std::make_pair(int64{1}, -10.0f), entries[1]);
+    EXPECT_EQ(std::make_pair(int64{999}, 999.0f), entries[999]);
+
+    TF_ASSERT_OK(table->ImportValues(context_.get(),
+                                     test::AsTensor<int64>({7, 8}),
+                                     test::AsTensor<float>({70, 80})));
+    EXPECT_EQ(2, table->size());
+    TF_ASSERT_OK((Export<int64, float>(&entries)));
+    EXPECT_EQ((std::vector<std::pair<int64, float>>{{7, 70}, {8, 80}}),
+              entries);
+  }
+}
+
+TEST_F(HashTableOpTest, MutableTableConcurrentFindAndInsert) {
+  lookup::LookupInterface* table = nullptr;
+  TF_ASSERT_OK(MakeMutableTable(DT_STRING, DT_INT64, 16, "table", &table));
+  core::ScopedUnref unref(table);
+
+  const int kNumThreads = 8;
+  const int kNumKeys = 2000;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([this, table, t]() {
+        // Every thread inserts its own keys, and looks up those of the
+        // previous thread.
+        Tensor keys(DT_STRING, TensorShape({kNumKeys}));
+        Tensor other_keys(DT_STRING, TensorShape({kNumKeys}));
+        Tensor values(DT_INT64, TensorShape({kNumKeys}));
+        for (int i = 0; i < kNumKeys; ++i) {
+          keys.flat<string>()(i) = strings::StrCat(t, "/", i);
+          other_keys.flat<string>()(i) =
+              strings::StrCat((t + kNumThreads - 1) % kNumThreads, "/", i);
+          values.flat<int64>()(i) = i;
+        }
+        TF_CHECK_OK(table->Insert(context_.get(), keys, values));
+        Tensor out(DT_INT64, TensorShape({kNumKeys}));
+        TF_CHECK_OK(table->Find(context_.get(), other_keys, &out,
+                                test::AsScalar<int64>(-1)));
+        for (int i = 0; i < kNumKeys; ++i) {
+          const int64 value = out.flat<int64>()(i);
+          CHECK(value == -1 || value == i) << value;
+        }
+      });
+    }
+  }
+  EXPECT_EQ(kNumThreads * kNumKeys, table->size());
+  Tensor out;
+  TF_ASSERT_OK(Find(table, test::AsTensor<string>({"3/17", "7/1999", "8/0"}),
+                    test::AsScalar<int64>(-1), &out));
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({17, 1999, -1}), out);
+}
+
+class HashTableBM : public HashTableOpTest {
+ public:
+  void TestBody() override {}
+  using HashTableOpTest::Find;
+  using HashTableOpTest::Initialize;
+  using HashTableOpTest::MakeMutableTable;
+  using HashTableOpTest::MakeTable;
+
+  OpKernelContext* context() { return context_.get(); }
+};
+
+template <typename K>
+K BenchmarkKey(int64 i);
+
+template <>
+int64 BenchmarkKey<int64>(int64 i) {
+  return i * 7919;
+}
+
+template <>
+string BenchmarkKey<string>(int64 i) {
+  return strings::StrCat("some/longer/vocabulary/entry/", i);
+}
+
+// Builds a table of "num_keys" keys, and its "num_queries" queries, half of
+// which are missing.
+template <typename K>
+void MakeBenchmarkTable(HashTableBM* bm, int num_keys, int64 num_queries,
+                        bool fingerprint_keys, lookup::LookupInterface** table,
+                        Tensor* queries) {
+  TF_CHECK_OK(bm->MakeTable(DataTypeToEnum<K>::v(), DT_INT64,
+                            fingerprint_keys, table));
+  Tensor keys(DataTypeToEnum<K>::v(), TensorShape({num_keys}));
+  Tensor values(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    keys.flat<K>()(i) = BenchmarkKey<K>(i);
+    values.flat<int64>()(i) = i;
+  }
+  TF_CHECK_OK(HashTableBM::Initialize(*table, keys, values));
+
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  *queries = Tensor(DataTypeToEnum<K>::v(), TensorShape({num_queries}));
+  for (int64 i = 0; i < num_queries; ++i) {
+    queries->flat<K>()(i) = BenchmarkKey<K>(rnd.Uniform64(2 * num_keys));
+  }
+}
+
+template <typename K>
+void BM_HashTableFind(int iters, int num_keys, bool fingerprint_keys) {
+  testing::StopTiming();
+  const int64 kNumQueries = 100000;
+  HashTableBM bm;
+  lookup::LookupInterface* table = nullptr;
+  Tensor queries;
+  MakeBenchmarkTable<K>(&bm, num_keys, kNumQueries, fingerprint_keys, &table,
+                        &queries);
+  core::ScopedUnref unref(table);
+  testing::SetLabel(strings::StrCat("memory_used=", table->MemoryUsed()));
+
+  Tensor out;
+  const Tensor default_value = test::AsScalar<int64>(-1);
+  testing::ItemsProcessed(static_cast<int64>(iters) * kNumQueries);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(bm.Find(table, queries, default_value, &out));
+  }
+}
+
+template <typename K>
+void BM_HashTableInitialize(int iters, int num_keys, bool fingerprint_keys) {
+  testing::StopTiming();
+  int64 memory_used = 0;
+  for (int i = 0; i < iters; ++i) {
+    HashTableBM bm;
+    lookup::LookupInterface* table = nullptr;
+    Tensor queries;
+    testing::StartTiming();
+    MakeBenchmarkTable<K>(&bm, num_keys, 0, fingerprint_keys, &table,
+                          &queries);
+    testing::StopTiming();
+    memory_used = table->MemoryUsed();
+    table->Unref();
+  }
+  testing::SetLabel(strings::StrCat("memory_used=", memory_used));
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_keys);
+}
+
+#define BM_HASH_TABLE(NAME, K, FINGERPRINT_KEYS)                            \
+  static void BM_HashTableFind_##NAME(int iters, int num_keys) {            \
+    BM_HashTableFind<K>(iters, num_keys, FINGERPRINT_KEYS);                 \
+  }                                                                         \
+  BENCHMARK(BM_HashTableFind_##NAME)->Arg(1000)->Arg(1 << 20);              \
+  static void BM_HashTableInitialize_##NAME(int iters, int num_keys) {      \
+    BM_HashTableInitialize<K>(iters, num_keys, FINGERPRINT_KEYS);           \
+  }                                                                         \
+  BENCHMARK(BM_HashTableInitialize_##NAME)->Arg(1000)->Arg(1 << 20);
+
+BM_HASH_TABLE(Int64, int64, false);
+BM_HASH_TABLE(String, string, false);
+BM_HASH_TABLE(StringFingerprint, string, true);
+
+#undef BM_HASH_TABLE
+
+// Runs "num_threads" concurrent steps per iteration, all of which look up a
+// batch of keys in a mutable table, and one in four of which also inserts one.
+void BM_MutableHashTableConcurrent(int iters, int num_threads,
+                                   int num_shards) {
+  testing::StopTiming();
+  const int64 kNumKeys = 1 << 20;
+  const int64 kBatchSize = 1000;
+  HashTableBM bm;
+  lookup::LookupInterface* table = nullptr;
+  TF_CHECK_OK(
+      bm.MakeMutableTable(DT_INT64, DT_INT64, num_shards, "table", &table));
+  core::ScopedUnref unref(table);
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  for (int64 i = 0; i < kNumKeys; ++i) {
+    keys.flat<int64>()(i) = BenchmarkKey<int64>(i);
+  }
+  TF_CHECK_OK(table->Insert(bm.context(), keys, keys));
+
+  std::vector<Tensor> batches;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int t = 0; t < num_threads; ++t) {
+    Tensor batch(DT_INT64, TensorShape({kBatchSize}));
+    for (int64 i = 0; i < kBatchSize; ++i) {
+      batch.flat<int64>()(i) = BenchmarkKey<int64>(rnd.Uniform64(kNumKeys));
+    }
+    batches.push_back(batch);
+  }
+  const Tensor default_value = test::AsScalar<int64>(-1);
+  thread::ThreadPool pool(Env::Default(), "benchmark", num_threads);
+
+  testing::UseRealTime();
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_threads *
+                          kBatchSize);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&bm, &batches, &counter, &default_value, table, t]() {
+        Tensor out(DT_INT64, TensorShape({kBatchSize}));
+        TF_CHECK_OK(
+            table->Find(bm.context(), batches[t], &out, default_value));
+        if (t % 4 == 0) {
+          TF_CHECK_OK(table->Insert(bm.context(), batches[t], out));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_MutableHashTableConcurrent)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(32, 1)
+    ->ArgPair(4, 64)
+    ->ArgPair(16, 64)
+    ->ArgPair(32, 64);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,362 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/random.h"
+
+#include "tensorflow/core/kernels/captured_function.h"
+#include "tensorflow/core/kernels/dataset_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class MapAndBatchDatasetOp : public OpKernel {
+ public:
+  explicit MapAndBatchDatasetOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx), graph_def_version_(ctx->graph_def_version()) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &input));
+    core::ScopedUnref unref_input(input);
+
+    OpInputList inputs;
+    OP_REQUIRES_OK(ctx, ctx->input_list("other_arguments", &inputs));
+    std::vector<Tensor> other_arguments;
+    other_arguments.reserve(inputs.size());
+    for (const Tensor& t : inputs) {
+      other_arguments.push_back(t);
+    }
+
+    const Tensor* batch_size_t;
+    OP_REQUIRES_OK(ctx, ctx->input("batch_size", &batch_size_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(batch_size_t->shape()),
+                errors::InvalidArgument("batch_size must be a scalar"));
+    const int64 batch_size = batch_size_t->flat<int64>()(0);
+    OP_REQUIRES(
+        ctx, batch_size > 0,
+        errors::InvalidArgument("batch_size must be greater than zero."));
+
+    const Tensor* num_threads_t;
+    OP_REQUIRES_OK(ctx, ctx->input("num_threads", &num_threads_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(num_threads_t->shape()),
+                errors::InvalidArgument("num_threads must be a scalar"));
+    const int32 num_threads = num_threads_t->flat<int32>()(0);
+    OP_REQUIRES(
+        ctx, num_threads > 0,
+        errors::InvalidArgument("num_threads must be greater than zero."));
+
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
+                                                 std::move(other_arguments),
+                                                 &captured_func));
+
+    // As in ParallelMapDatasetOp, the map function runs after the
+    // IteratorContext of the GetNext() call that started it may have
+    // gone, so it runs with the params captured from this kernel's
+    // context.
+    IteratorContext::Params params;
+    params.env = ctx->env();
+    params.resource_manager = ctx->resource_manager();
+    params.runner = *(ctx->runner());
+
+    DatasetBase* dataset =
+        new Dataset(input, batch_size, num_threads, std::move(params),
+                    output_types_, output_shapes_, std::move(captured_func));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->flat<ResourceHandle>()(0) = handle;
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(const DatasetBase* input, int64 batch_size, int32 num_threads,
+            IteratorContext::Params ctx_params,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes,
+            std::unique_ptr<CapturedFunction> captured_func)
+        : input_(input),
+          batch_size_(batch_size),
+          num_threads_(num_threads),
+          ctx_params_(std::move(ctx_params)),
+          output_types_(output_types),
+          output_shapes_(output_shapes),
+          captured_func_(std::move(captured_func)) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override { return "MapAndBatchDatasetOp::Dataset"; }
+
+   private:
+    // The iterator keeps enough batches in flight to give every thread
+    // work. Each call of the map function copies its return values into
+    // its slice of the batch as soon as it finishes, so the unbatched
+    // return values are released immediately, and the copies run in
+    // parallel on the map threads rather than serially in GetNext().
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset),
+            iter_ctx_(dataset->ctx_params_),
+            input_impl_(dataset->input_->MakeIterator()),
+            max_batch_results_((dataset->num_threads_ + dataset->batch_size_ -
+                                1) / dataset->batch_size_ +
+                               1) {}
+
+      ~Iterator() override {
+        // Wait for the outstanding calls, which refer to the batches.
+        mutex_lock l(mu_);
+        for (const auto& result : batch_results_) {
+          mutex_lock result_l(result->mu);
+          while (result->num_calls > 0) {
+            result->cond_var.wait(result_l);
+          }
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureThreadPoolStarted(ctx);
+
+        // Start batches until enough are in flight, or the input is
+        // exhausted.
+        while (!end_of_input_ && batch_results_.size() < max_batch_results_) {
+          StartBatch(ctx);
+        }
+
+        if (batch_results_.empty()) {
+          DCHECK(end_of_input_);
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        // Wait for the oldest batch to be complete.
+        std::unique_ptr<BatchResult> result = std::move(batch_results_.front());
+        batch_results_.pop_front();
+        mutex_lock result_l(result->mu);
+        while (result->num_calls > 0) {
+          result->cond_var.wait(result_l);
+        }
+        *end_of_sequence = false;
+        if (result->status.ok()) {
+          *out_tensors = std::move(result->output);
+        }
+        return result->status;
+      }
+
+     private:
+      // The state of one batch.
+      struct BatchResult {
+        mutex mu;
+        condition_variable cond_var;
+        // The input elements of the batch.
+        std::vector<std::vector<Tensor>> inputs;
+        // The first error from getting the input elements or from any of
+        // the calls.
+        Status status GUARDED_BY(mu);
+        // One tensor per component of the output, allocated when the
+        // first call returns.
+        std::vector<Tensor> output GUARDED_BY(mu);
+        // The number of calls that have not finished.
+        int64 num_calls GUARDED_BY(mu) = 0;
+      };
+
+      void EnsureThreadPoolStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!thread_pool_) {
+          // Choose a step ID that is guaranteed not to clash with any
+          // Session-generated step ID. DirectSession only generates
+          // non-negative step IDs (contiguous, starting from 0), and
+          // MasterSession generates 56-bit random step IDs whose MSB
+          // is always 0, so a negative random step ID should suffice.
+          f_opts_.step_id = -std::abs(static_cast<int64>(random::New64()));
+          f_opts_.runner = iter_ctx_.runner();
+          iter_ctx_.set_collect_stats(ctx->collect_stats());
+          // The calls block until the map function is done, so they must
+          // not run on the inter-op threads that the function's kernels
+          // run on.
+          thread_pool_.reset(new thread::ThreadPool(
+              ctx->env(), "map_and_batch", dataset()->num_threads_));
+        }
+      }
+
+      // Reads the input elements of the next batch, and schedules a call
+      // of the map function for each of them.
+      void StartBatch(IteratorContext* ctx) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::unique_ptr<BatchResult> result(new BatchResult);
+        result->inputs.reserve(dataset()->batch_size_);
+        Status s;
+        for (int64 i = 0; i < dataset()->batch_size_; ++i) {
+          std::vector<Tensor> input_element;
+          s = input_impl_->GetNext(ctx, &input_element, &end_of_input_);
+          if (!s.ok() || end_of_input_) {
+            break;
+          }
+          result->inputs.push_back(std::move(input_element));
+        }
+
+        if (!s.ok()) {
+          // Drop the elements read so far, and report the error in place
+          // of the batch.
+          end_of_input_ = false;
+          mutex_lock result_l(result->mu);
+          result->status = s;
+        } else if (result->inputs.empty()) {
+          return;
+        } else {
+          BatchResult* const r = result.get();
+          const int64 num_elements = r->inputs.size();
+          {
+            mutex_lock result_l(r->mu);
+            r->num_calls = num_elements;
+          }
+          for (int64 i = 0; i < num_elements; ++i) {
+            thread_pool_->Schedule([this, r, i]() { CallFunction(r, i); });
+          }
+        }
+        batch_results_.push_back(std::move(result));
+      }
+
+      void CallFunction(BatchResult* result, int64 offset) {
+        std::vector<Tensor> return_values;
+        Status s = dataset()->captured_func_->Run(
+            f_opts_, result->inputs[offset], &return_values);
+        // Release the input element as soon as it is no longer needed.
+        result->inputs[offset].clear();
+        if (s.ok()) {
+          s = CopyToBatch(result, offset, return_values);
+        }
+
+        mutex_lock l(result->mu);
+        result->status.Update(s);
+        if (--result->num_calls == 0) {
+          result->cond_var.notify_all();
+        }
+      }
+
+      // Copies `return_values` into the `offset`^th slice of the output
+      // of `result`, allocating the output if it does not exist yet.
+      Status CopyToBatch(BatchResult* result, int64 offset,
+                         const std::vector<Tensor>& return_values) {
+        const DataTypeVector& output_dtypes = dataset()->output_dtypes();
+        if (return_values.size() != output_dtypes.size()) {
+          return errors::InvalidArgument(
+              "The map function returned ", return_values.size(),
+              " components, but the dataset has ", output_dtypes.size(), ".");
+        }
+        // Tensors share their buffers, so the copies made here alias the
+        // output, and can be written without holding the lock.
+        std::vector<Tensor> output;
+        {
+          mutex_lock l(result->mu);
+          if (result->output.empty()) {
+            const int64 num_elements = result->inputs.size();
+            for (size_t i = 0; i < return_values.size(); ++i) {
+              TensorShape component_shape({num_elements});
+              component_shape.AppendShape(return_values[i].shape());
+              result->output.emplace_back(cpu_allocator(), output_dtypes[i],
+                                          component_shape);
+            }
+          }
+          output = result->output;
+        }
+        for (size_t i = 0; i < return_values.size(); ++i) {
+          const Tensor& value = return_values[i];
+          if (value.dtype() != output_dtypes[i]) {
+            return errors::InvalidArgument(
+                "The map function returned a ", DataTypeString(value.dtype()),
+                " in component ", i, ", but the dataset expects ",
+                DataTypeString(output_dtypes[i]), ".");
+          }
+          TensorShape slice_shape = output[i].shape();
+          slice_shape.RemoveDim(0);
+          if (value.shape() != slice_shape) {
+            return errors::InvalidArgument(
+                "Cannot batch tensors with different shapes in component ", i,
+                ". First element had shape ", slice_shape.DebugString(),
+                " and element ", offset, " had shape ",
+                value.shape().DebugString(), ".");
+          }
+          TF_RETURN_IF_ERROR(
+              dataset::CopyElementToSlice(value, &output[i], offset));
+        }
+        return Status::OK();
+      }
+
+      // Only accessed by the calls, after the thread pool has started.
+      IteratorContext iter_ctx_;
+      FunctionLibraryRuntime::Options f_opts_;
+      mutex mu_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      const size_t max_batch_results_;
+      bool end_of_input_ GUARDED_BY(mu_) = false;
+      std::deque<std::unique_ptr<BatchResult>> batch_results_ GUARDED_BY(mu_);
+      std::unique_ptr<thread::ThreadPool> thread_pool_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const int64 batch_size_;
+    const int32 num_threads_;
+    const IteratorContext::Params ctx_params_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+  };
+
+  const int graph_def_version_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const NameAttrList* func_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("MapAndBatchDataset").Device(DEVICE_CPU),
+                        MapAndBatchDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
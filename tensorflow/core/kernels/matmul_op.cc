@@ -19,10 +19,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/matmul_op.h"
 
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/fused_bias_activation.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "cuda/include/cuda.h"
@@ -310,6 +313,30 @@ class MatMulOp : public OpKernel {
   bool transpose_b_;
 };
 
+// A MatMul followed by a BiasAdd and optionally an activation, which are
+// applied in place to the product in a single pass.
+template <typename Device, typename T, bool USE_CUBLAS>
+class FusedMatMulOp : public MatMulOp<Device, T, USE_CUBLAS> {
+ public:
+  explicit FusedMatMulOp(OpKernelConstruction* ctx)
+      : MatMulOp<Device, T, USE_CUBLAS>(ctx) {
+    OP_REQUIRES_OK(ctx, fused_ops_.Init(ctx));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    MatMulOp<Device, T, USE_CUBLAS>::Compute(ctx);
+    if (!ctx->status().ok()) {
+      return;
+    }
+    Tensor* out = ctx->mutable_output(0);
+    fused_ops_.Apply<Device, T>(ctx, 2, out->dim_size(0), out->dim_size(1), 1,
+                                out);
+  }
+
+ private:
+  FusedBiasActivationOps fused_ops_;
+};
+
 namespace functor {
 
 // Partial specialization MatMulFunctor<Device=CPUDevice, T>.
@@ -340,6 +367,54 @@ struct MatMulFunctor<SYCLDevice, T> {
 
 }  // end namespace functor
 
+// bfloat16 is only a storage format: the operands are widened to float,
+// multiplied with float accumulation, and the product is truncated back. The
+// conversions are sharded over the worker threads, since for the large
+// weights this is meant for they read as much memory as the product.
+template <>
+struct LaunchMatMulCPU<bfloat16> {
+  static void launch(
+      OpKernelContext* ctx, OpKernel* kernel, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      Tensor* out) {
+    Tensor a_float;
+    Tensor b_float;
+    Tensor out_float;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_temp(DT_FLOAT, out->shape(), &out_float));
+    ToFloat(ctx, a, &a_float);
+    ToFloat(ctx, b, &b_float);
+    LaunchMatMulCPU<float>::launch(ctx, kernel, a_float, b_float, dim_pair,
+                                   &out_float);
+    const float* src = out_float.flat<float>().data();
+    bfloat16* dst = out->flat<bfloat16>().data();
+    ParallelConvert(ctx, out->NumElements(),
+                    [src, dst](int64 begin, int64 end) {
+                      FloatToBFloat16(src + begin, dst + begin, end - begin);
+                    });
+  }
+
+ private:
+  static void ToFloat(OpKernelContext* ctx, const Tensor& in, Tensor* out) {
+    const bfloat16* src = in.flat<bfloat16>().data();
+    float* dst = out->flat<float>().data();
+    ParallelConvert(ctx, in.NumElements(), [src, dst](int64 begin, int64 end) {
+      BFloat16ToFloat(src + begin, dst + begin, end - begin);
+    });
+  }
+
+  static void ParallelConvert(OpKernelContext* ctx, int64 size,
+                              const std::function<void(int64, int64)>& work) {
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    // A few cycles per element, mostly spent waiting on memory.
+    const int64 kCostPerElement = 4;
+    Shard(worker_threads->num_threads, worker_threads->workers, size,
+          kCostPerElement, work);
+  }
+};
+
 #define REGISTER_CPU(T)                                                        \
   REGISTER_KERNEL_BUILDER(                                                     \
       Name("MatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"),                \
@@ -373,9 +448,17 @@ TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU);
 TF_CALL_complex128(REGISTER_CPU);
 #endif
+TF_CALL_bfloat16(REGISTER_CPU);
+
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedMatMul").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    FusedMatMulOp<CPUDevice, float, false /* cublas, ignored for CPU */>);
 
 #if GOOGLE_CUDA
 TF_CALL_float(REGISTER_GPU);
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedMatMul").Device(DEVICE_GPU).TypeConstraint<float>("T"),
+    FusedMatMulOp<GPUDevice, float, true /* cublas, true by default */>);
 TF_CALL_double(REGISTER_GPU);
 TF_CALL_complex64(REGISTER_GPU);
 TF_CALL_complex128(REGISTER_GPU);
@@ -14,12 +14,67 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class FusedMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool transpose_b, const std::vector<string>& fused_ops) {
+    TF_EXPECT_OK(NodeDefBuilder("fused_matmul_op", "_FusedMatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(1, DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("transpose_b", transpose_b)
+                     .Attr("num_args", 1)
+                     .Attr("fused_ops", fused_ops)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedMatMulOpTest, BiasAdd) {
+  MakeOp(false, {"BiasAdd"});
+  // | 1 2 |   | 1 0 -1 |   | 3 2 -1 |
+  // | 3 4 | x | 1 1  0 | = | 7 4 -3 |
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, -1, 1, 1, 0});
+  AddInputFromArray<float>(TensorShape({3}), {-5, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {-2, 2, 0, 2, 4, -2});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedMatMulOpTest, TransposedBiasAddRelu) {
+  MakeOp(true, {"BiasAdd", "Relu"});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 1, 0, 1, -1, 0});
+  AddInputFromArray<float>(TensorShape({3}), {-5, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {0, 2, 0, 2, 4, 0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedMatMulOpTest, WrongBiasSize) {
+  MakeOp(false, {"BiasAdd"});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, -1, 1, 1, 0});
+  AddInputFromArray<float>(TensorShape({2}), {-5, 0});
+  EXPECT_EQ(error::INVALID_ARGUMENT, RunOpKernel().code());
+}
+
 template <typename T>
 static Graph* Matmul(int m, int k, int n, bool transpose_a, bool transpose_b,
                      DataType type) {
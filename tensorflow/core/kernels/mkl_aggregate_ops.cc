@@ -0,0 +1,137 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+#ifdef INTEL_MKL
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+#include "third_party/mkl/include/mkl_dnn.h"
+#include "third_party/mkl/include/mkl_dnn_types.h"
+#include "tensorflow/core/util/mkl_util.h"
+
+namespace tensorflow {
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Adds the inputs element wise. When all the inputs are Mkl tensors with the
+// same Mkl layout, the sum is computed directly on their buffers and keeps
+// that layout, so an AddN between two Mkl ops (e.g., a residual connection)
+// does not need conversions to and from the TensorFlow layout. Otherwise the
+// Mkl inputs are converted, and the sum is a TensorFlow tensor.
+template <typename Device, typename T>
+class MklAddNOp : public OpKernel {
+ public:
+  explicit MklAddNOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    OpInputList inputs;
+    GetMklInputList(context, "inputs", &inputs);
+    const int N = inputs.size();
+    MklShapeList input_shapes(N);
+    GetMklShapeList(context, "inputs", &input_shapes);
+
+    if (N == 1) {
+      ForwarMklTensorInToOut(context, 0, 0);
+      return;
+    }
+
+    bool same_mkl_layout = AreAllMklTensors(input_shapes);
+    for (int i = 1; same_mkl_layout && i < N; ++i) {
+      same_mkl_layout = HaveSameMklLayout(input_shapes[0], input_shapes[i]);
+    }
+
+    std::vector<Tensor> values;
+    Tensor* output = nullptr;
+    if (same_mkl_layout) {
+      VLOG(1) << "_MklAddNOp: Adding inputs in Mkl layout";
+      for (int i = 0; i < N; ++i) {
+        values.push_back(inputs[i]);
+      }
+      // The sum has the layout of the inputs, so its Mkl shape is that of
+      // the first input.
+      OpInputList mkl_inputs;
+      GetMklInputList(context, "mkl_inputs", &mkl_inputs);
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(
+                         GetTensorDataIndex(0, context->num_outputs()),
+                         inputs[0].shape(), &output));
+      context->set_output(GetTensorMetaDataIndex(0, context->num_outputs()),
+                          mkl_inputs[0]);
+    } else {
+      VLOG(1) << "_MklAddNOp: Not all inputs have the same Mkl layout, "
+              << "converting them to TensorFlow layout";
+      for (int i = 0; i < N; ++i) {
+        if (input_shapes[i].IsMklTensor()) {
+          values.push_back(
+              ConvertMklToTF<T>(context, inputs[i], input_shapes[i]));
+        } else {
+          values.push_back(inputs[i]);
+        }
+      }
+      for (int i = 1; i < N; ++i) {
+        OP_REQUIRES(context, values[0].shape() == values[i].shape(),
+                    errors::InvalidArgument(
+                        "Inputs to operation ", name(), " of type ",
+                        type_string(),
+                        " must have the same size and shape.  Input 0: ",
+                        values[0].shape().DebugString(), " != input ", i, ": ",
+                        values[i].shape().DebugString()));
+      }
+      MklShape output_mkl_shape;
+      output_mkl_shape.SetMklTensor(false);
+      AllocateOutputSetMklShape(context, 0, &output, values[0].shape(),
+                                output_mkl_shape);
+      if (!context->status().ok()) return;
+    }
+
+    const CPUDevice& d = context->eigen_device<CPUDevice>();
+    auto sum = output->flat<T>();
+    sum.device(d) = values[0].flat<T>() + values[1].flat<T>();
+    for (int i = 2; i < N; ++i) {
+      sum.device(d) += values[i].flat<T>();
+    }
+  }
+
+ private:
+  // Returns true if the buffers of Mkl tensors with shapes 'a' and 'b' hold
+  // the same elements at the same positions. Comparing the layouts is not
+  // enough: the mapping from TensorFlow to Mkl dimensions must match too.
+  static bool HaveSameMklLayout(const MklShape& a, const MklShape& b) {
+    if (a.GetDimension() != b.GetDimension()) return false;
+    for (size_t i = 0; i < a.GetDimension(); ++i) {
+      if (a.tf_dim_idx(i) != b.tf_dim_idx(i)) return false;
+    }
+    return dnnLayoutCompare_F32(a.GetMklLayout(), b.GetMklLayout());
+  }
+};
+
+/* Use optimized AddN for float type only */
+#define REGISTER_MKL_CPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(Name("_MklAddN")                          \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<T>("T")               \
+                              .Label(mkl_op_registry::kMklOpLabel), \
+                          MklAddNOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_MKL_CPU);
+#undef REGISTER_MKL_CPU
+}  // namespace tensorflow
+#endif  // INTEL_MKL
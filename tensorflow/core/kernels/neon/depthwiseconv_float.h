@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_NEON_DEPTHWISECONV_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_NEON_DEPTHWISECONV_H_
 
+#include <vector>
+
 #include "public/gemmlowp.h"
 #include "tensorflow/core/kernels/neon/types.h"
 
@@ -418,6 +420,109 @@ struct FloatDepthwiseConvKernel<true, 0, 2> {
     }
   }
 };
+template <>
+struct FloatDepthwiseConvKernel<false, 4, 1> {
+  static void Run(int num_output_pixels, int input_depth, int depth_multiplier,
+                  const float* input_ptr, int input_ptr_increment,
+                  const float* filter_ptr, float* acc_buffer_ptr) {
+    // Load the filters
+    const float32x4_t filter = vld1q_f32(filter_ptr);
+    int outp = 0;
+    // Handle 4 output pixels at a time.
+    for (; outp <= num_output_pixels - 4; outp += 4) {
+      // Load the inputs
+      float32x4_t input[4];
+      for (int i = 0; i < 4; i++) {
+        input[i] = vld1q_f32(input_ptr + 4 * i);
+      }
+      input_ptr += 16;
+      // Load the accumulators from acc_buffer
+      float32x4_t acc[4];
+      for (int i = 0; i < 4; i++) {
+        acc[i] = vld1q_f32(acc_buffer_ptr + 4 * i);
+      }
+      // Multiply-accumulate
+      for (int i = 0; i < 4; i++) {
+        acc[i] = vmlaq_f32(acc[i], input[i], filter);
+      }
+      // Store the accumulators back to acc_buffer
+      for (int i = 0; i < 4; i++) {
+        vst1q_f32(acc_buffer_ptr + 4 * i, acc[i]);
+      }
+      acc_buffer_ptr += 16;
+    }
+    // Handle one output pixel at a time.
+    for (; outp < num_output_pixels; outp++) {
+      // Load the inputs
+      const float32x4_t input = vld1q_f32(input_ptr);
+      input_ptr += 4;
+      // Load the accumulators from acc_buffer
+      float32x4_t acc = vld1q_f32(acc_buffer_ptr);
+      // Multiply-accumulate
+      acc = vmlaq_f32(acc, input, filter);
+      // Store the accumulators back to acc_buffer
+      vst1q_f32(acc_buffer_ptr, acc);
+      acc_buffer_ptr += 4;
+    }
+  }
+};
+
+template <>
+struct FloatDepthwiseConvKernel<true, 0, 4> {
+  static void Run(int num_output_pixels, int input_depth, int depth_multiplier,
+                  const float* input_ptr, int input_ptr_increment,
+                  const float* filter_ptr, float* acc_buffer_ptr) {
+    // Handle one output pixel at a time.
+    for (int outp = 0; outp < num_output_pixels; outp++) {
+      const float* local_filter_ptr = filter_ptr;
+      const float* local_input_ptr = input_ptr;
+      int ic = 0;
+      // Handle 4 input channels at a time.
+      for (; ic <= input_depth - 4; ic += 4) {
+        // Load the filters
+        float32x4_t filter[4];
+        for (int i = 0; i < 4; i++) {
+          filter[i] = vld1q_f32(local_filter_ptr + 4 * i);
+        }
+        local_filter_ptr += 16;
+        // Load the inputs
+        const float32x4_t input = vld1q_f32(local_input_ptr);
+        local_input_ptr += 4;
+        // Load the accumulators from acc_buffer
+        float32x4_t acc[4];
+        for (int i = 0; i < 4; i++) {
+          acc[i] = vld1q_f32(acc_buffer_ptr + 4 * i);
+        }
+        // Multiply-accumulate
+        acc[0] = vmlaq_lane_f32(acc[0], filter[0], vget_low_f32(input), 0);
+        acc[1] = vmlaq_lane_f32(acc[1], filter[1], vget_low_f32(input), 1);
+        acc[2] = vmlaq_lane_f32(acc[2], filter[2], vget_high_f32(input), 0);
+        acc[3] = vmlaq_lane_f32(acc[3], filter[3], vget_high_f32(input), 1);
+        // Store the accumulators back to acc_buffer
+        for (int i = 0; i < 4; i++) {
+          vst1q_f32(acc_buffer_ptr + 4 * i, acc[i]);
+        }
+        acc_buffer_ptr += 16;
+      }
+      // Handle one input channel at a time.
+      for (; ic < input_depth; ic++) {
+        // Load the filters
+        const float32x4_t filter = vld1q_f32(local_filter_ptr);
+        local_filter_ptr += 4;
+        // Load the inputs
+        const float input_val = *local_input_ptr++;
+        // Load the accumulators from acc_buffer
+        float32x4_t acc = vld1q_f32(acc_buffer_ptr);
+        // Multiply-accumulate
+        acc = vmlaq_n_f32(acc, filter, input_val);
+        // Store the accumulators back to acc_buffer
+        vst1q_f32(acc_buffer_ptr, acc);
+        acc_buffer_ptr += 4;
+      }
+      input_ptr += input_ptr_increment;
+    }
+  }
+};
 #endif
 
 // Accumulates the effect of one row of the filter, on a segment of one row
@@ -572,15 +677,18 @@ void DepthwiseConv(const float* input_data, const Dims<4>& input_dims,
   const int output_width = ArraySize(output_dims, 1);
   DCHECK(output_depth == input_depth * depth_multiplier);
 
+  // The accumulators for a whole output pixel must fit in acc_buffer; deeper
+  // outputs, which are rare, use a heap buffer holding one pixel.
   static const int kAccBufferMaxSize = 1024;
-  float acc_buffer[kAccBufferMaxSize];
-  DCHECK_GE(kAccBufferMaxSize, output_depth)
-      << "Too small kAccBufferMaxSize for this model!";
-  const int kOutputPixelsInAccBuffer = kAccBufferMaxSize / output_depth;
-  const int kAccBufferActualSize = kOutputPixelsInAccBuffer * output_depth;
-  DCHECK_LE(kOutputPixelsInAccBuffer * output_depth, kAccBufferActualSize);
-  DCHECK_LE(kAccBufferActualSize, kAccBufferMaxSize);
-  DCHECK_GE(kOutputPixelsInAccBuffer, 1);
+  float stack_acc_buffer[kAccBufferMaxSize];
+  std::vector<float> heap_acc_buffer;
+  float* acc_buffer = stack_acc_buffer;
+  if (output_depth > kAccBufferMaxSize) {
+    heap_acc_buffer.resize(output_depth);
+    acc_buffer = heap_acc_buffer.data();
+  }
+  const int kOutputPixelsInAccBuffer =
+      std::max(1, kAccBufferMaxSize / output_depth);
 
   // row_accum_func will point to the core accumulation function to be used
   // for this DepthwiseConv op.
@@ -604,21 +712,25 @@ void DepthwiseConv(const float* input_data, const Dims<4>& input_dims,
       input_depth * fixed_depth_multiplier <= kMaxUnrolling) {
     fixed_input_depth = input_depth;
   }
-#define TF_NEON_USE_DEPTHWISECONV_KERNEL(ALLOW_STRIDED, FIXED_INPUT_DEPTH, \
-                                         FIXED_DEPTH_MULTIPLIER)           \
-  if ((stride == 1 || ALLOW_STRIDED) &&                                    \
-      fixed_input_depth == FIXED_INPUT_DEPTH &&                            \
-      fixed_depth_multiplier == FIXED_DEPTH_MULTIPLIER) {                  \
-    row_accum_func =                                                       \
-        FloatDepthwiseConvAccumRow<ALLOW_STRIDED, FIXED_INPUT_DEPTH,       \
-                                   FIXED_DEPTH_MULTIPLIER>;                \
+  // A kernel with FIXED_INPUT_DEPTH 0 handles any input depth, so it is used
+  // unless a kernel for the fixed input depth, listed after it, overrides it.
+#define TF_NEON_USE_DEPTHWISECONV_KERNEL(ALLOW_STRIDED, FIXED_INPUT_DEPTH,    \
+                                         FIXED_DEPTH_MULTIPLIER)              \
+  if ((stride == 1 || ALLOW_STRIDED) &&                                       \
+      (FIXED_INPUT_DEPTH == 0 || fixed_input_depth == FIXED_INPUT_DEPTH) &&   \
+      fixed_depth_multiplier == FIXED_DEPTH_MULTIPLIER) {                     \
+    row_accum_func =                                                          \
+        FloatDepthwiseConvAccumRow<ALLOW_STRIDED, FIXED_INPUT_DEPTH,          \
+                                   FIXED_DEPTH_MULTIPLIER>;                   \
   }
 
 #ifdef USE_NEON
   TF_NEON_USE_DEPTHWISECONV_KERNEL(true, 0, 1)
   TF_NEON_USE_DEPTHWISECONV_KERNEL(true, 0, 8)
+  TF_NEON_USE_DEPTHWISECONV_KERNEL(true, 0, 4)
   TF_NEON_USE_DEPTHWISECONV_KERNEL(true, 0, 2)
   TF_NEON_USE_DEPTHWISECONV_KERNEL(false, 8, 1)
+  TF_NEON_USE_DEPTHWISECONV_KERNEL(false, 4, 1)
   TF_NEON_USE_DEPTHWISECONV_KERNEL(false, 2, 1)
 #endif  // USE_NEON
 
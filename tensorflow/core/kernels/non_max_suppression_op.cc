@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/non_max_suppression_op.h"
 
+#include <limits>
+#include <queue>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -56,15 +59,6 @@ static inline void ParseAndCheckBoxSizes(OpKernelContext* context,
               errors::InvalidArgument("scores has incompatible shape"));
 }
 
-static inline void DecreasingArgSort(const std::vector<float>& values,
-                                     std::vector<int>* indices) {
-  indices->resize(values.size());
-  for (int i = 0; i < values.size(); ++i) (*indices)[i] = i;
-  std::sort(
-      indices->begin(), indices->end(),
-      [&values](const int i, const int j) { return values[i] > values[j]; });
-}
-
 // Compute intersection-over-union overlap between boxes i and j.
 static inline float ComputeIOU(typename TTypes<float, 2>::ConstTensor boxes,
                                int i, int j) {
@@ -90,6 +84,57 @@ static inline float ComputeIOU(typename TTypes<float, 2>::ConstTensor boxes,
   return intersection_area / (area_i + area_j - intersection_area);
 }
 
+// Greedily selects up to 'max_output_size' of the 'num_boxes' boxes, in
+// decreasing order of score, skipping the boxes whose IOU with a box already
+// selected is above 'iou_threshold', and the boxes whose score is not above
+// 'score_threshold'. The score of box i is scores[i * scores_stride]. Ties are
+// broken toward the lower index.
+//
+// The candidates are kept in a heap rather than sorted, and are only compared
+// with the selected boxes, so selecting k boxes costs O(n + k log n) heap
+// operations and at most n * k IOU computations.
+void SelectBoxes(typename TTypes<float, 2>::ConstTensor boxes,
+                 const float* scores, int scores_stride, int num_boxes,
+                 int max_output_size, float iou_threshold,
+                 float score_threshold, std::vector<int>* selected) {
+  struct Candidate {
+    int box_index;
+    float score;
+  };
+  auto cmp = [](const Candidate& a, const Candidate& b) {
+    return a.score < b.score ||
+           (a.score == b.score && a.box_index > b.box_index);
+  };
+  std::vector<Candidate> candidates;
+  candidates.reserve(num_boxes);
+  for (int i = 0; i < num_boxes; ++i) {
+    const float score = scores[static_cast<int64>(i) * scores_stride];
+    if (score > score_threshold) {
+      candidates.push_back({i, score});
+    }
+  }
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(cmp)> queue(
+      cmp, std::move(candidates));
+
+  selected->clear();
+  while (selected->size() < max_output_size && !queue.empty()) {
+    const Candidate next = queue.top();
+    queue.pop();
+    // Boxes selected last are the likeliest to overlap the candidate, which
+    // the heap yields in the same score order.
+    bool suppressed = false;
+    for (int j = static_cast<int>(selected->size()) - 1; j >= 0; --j) {
+      if (ComputeIOU(boxes, next.box_index, (*selected)[j]) > iou_threshold) {
+        suppressed = true;
+        break;
+      }
+    }
+    if (!suppressed) {
+      selected->push_back(next.box_index);
+    }
+  }
+}
+
 void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& boxes,
                            const Tensor& scores, const Tensor& max_output_size,
                            const float iou_threshold) {
@@ -105,32 +150,10 @@ void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& boxes,
   const int output_size = std::min(max_output_size.scalar<int>()(), num_boxes);
   typename TTypes<float, 2>::ConstTensor boxes_data = boxes.tensor<float, 2>();
 
-  std::vector<float> scores_data(num_boxes);
-  std::copy_n(scores.flat<float>().data(), num_boxes, scores_data.begin());
-  std::vector<int> sorted_indices;
-  DecreasingArgSort(scores_data, &sorted_indices);
-
-  std::vector<bool> active(num_boxes, true);
   std::vector<int> selected;
-  int num_active = active.size();
-  for (int i = 0; i < num_boxes; ++i) {
-    if (num_active == 0 || selected.size() >= output_size) break;
-    if (active[i]) {
-      selected.push_back(sorted_indices[i]);
-    } else {
-      continue;
-    }
-    for (int j = i + 1; j < num_boxes; ++j) {
-      if (active[j]) {
-        float iou =
-            ComputeIOU(boxes_data, sorted_indices[i], sorted_indices[j]);
-        if (iou > iou_threshold) {
-          active[j] = false;
-          num_active--;
-        }
-      }
-    }
-  }
+  SelectBoxes(boxes_data, scores.flat<float>().data(), 1, num_boxes,
+              output_size, iou_threshold,
+              -std::numeric_limits<float>::infinity(), &selected);
 
   // Allocate output tensor
   Tensor* output = nullptr;
@@ -201,10 +224,108 @@ class NonMaxSuppressionV2Op : public OpKernel {
   }
 };
 
+template <typename Device>
+class BatchedNonMaxSuppressionOp : public OpKernel {
+ public:
+  explicit BatchedNonMaxSuppressionOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    // boxes: [batch_size, num_boxes, 4]
+    const Tensor& boxes = context->input(0);
+    // scores: [batch_size, num_boxes, num_classes]
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, boxes.dims() == 3 && boxes.dim_size(2) == 4,
+                errors::InvalidArgument(
+                    "boxes must be 3-D with 4 columns, got shape ",
+                    boxes.shape().DebugString()));
+    OP_REQUIRES(context, scores.dims() == 3,
+                errors::InvalidArgument("scores must be 3-D, got shape ",
+                                        scores.shape().DebugString()));
+    OP_REQUIRES(context,
+                scores.dim_size(0) == boxes.dim_size(0) &&
+                    scores.dim_size(1) == boxes.dim_size(1),
+                errors::InvalidArgument(
+                    "scores has incompatible shape ",
+                    scores.shape().DebugString(), " for boxes of shape ",
+                    boxes.shape().DebugString()));
+    OP_REQUIRES(context,
+                FastBoundsCheck(boxes.dim_size(1),
+                                std::numeric_limits<int>::max()),
+                errors::InvalidArgument("too many boxes"));
+    for (int i = 2; i < 5; ++i) {
+      const TensorShape& shape = context->input(i).shape();
+      OP_REQUIRES(context, TensorShapeUtils::IsScalar(shape),
+                  errors::InvalidArgument(
+                      "max_output_size_per_class, iou_threshold and "
+                      "score_threshold must be 0-D, got shape ",
+                      shape.DebugString()));
+    }
+    const int max_output_size = context->input(2).scalar<int>()();
+    const float iou_threshold = context->input(3).scalar<float>()();
+    const float score_threshold = context->input(4).scalar<float>()();
+    OP_REQUIRES(context, max_output_size >= 0,
+                errors::InvalidArgument(
+                    "max_output_size_per_class must be non-negative"));
+    OP_REQUIRES(context, iou_threshold >= 0 && iou_threshold <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1]"));
+
+    const int64 batch_size = boxes.dim_size(0);
+    const int num_boxes = boxes.dim_size(1);
+    const int64 num_classes = scores.dim_size(2);
+
+    Tensor* selected_indices = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({batch_size, num_classes,
+                                                max_output_size}),
+                                &selected_indices));
+    Tensor* num_selected = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({batch_size, num_classes}),
+                                &num_selected));
+    auto selected_indices_data = selected_indices->tensor<int, 3>();
+    auto num_selected_data = num_selected->matrix<int>();
+    const float* boxes_data = boxes.flat<float>().data();
+    const float* scores_data = scores.flat<float>().data();
+
+    // Every (image, class) pair is an independent selection.
+    auto select = [&](int64 begin, int64 end) {
+      std::vector<int> selected;
+      for (int64 i = begin; i < end; ++i) {
+        const int64 b = i / num_classes;
+        const int64 c = i % num_classes;
+        typename TTypes<float, 2>::ConstTensor image_boxes(
+            boxes_data + b * num_boxes * 4, num_boxes, 4);
+        SelectBoxes(image_boxes, scores_data + b * num_boxes * num_classes + c,
+                    num_classes, num_boxes, max_output_size, iou_threshold,
+                    score_threshold, &selected);
+        num_selected_data(b, c) = selected.size();
+        for (int k = 0; k < max_output_size; ++k) {
+          selected_indices_data(b, c, k) =
+              k < selected.size() ? selected[k] : -1;
+        }
+      }
+    };
+    // Each selection compares every box with at most max_output_size
+    // selected boxes.
+    const int64 kCostPerIOU = 20;
+    const int64 cost_per_selection =
+        kCostPerIOU * num_boxes * std::max(1, std::min(max_output_size,
+                                                       num_boxes));
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * num_classes, cost_per_selection, select);
+  }
+};
+
 REGISTER_KERNEL_BUILDER(Name("NonMaxSuppression").Device(DEVICE_CPU),
                         NonMaxSuppressionOp<CPUDevice>);
 
 REGISTER_KERNEL_BUILDER(Name("NonMaxSuppressionV2").Device(DEVICE_CPU),
                         NonMaxSuppressionV2Op<CPUDevice>);
 
+REGISTER_KERNEL_BUILDER(Name("BatchedNonMaxSuppression").Device(DEVICE_CPU),
+                        BatchedNonMaxSuppressionOp<CPUDevice>);
+
 }  // namespace tensorflow
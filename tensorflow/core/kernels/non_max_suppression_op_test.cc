@@ -335,4 +335,86 @@ TEST_F(NonMaxSuppressionV2OpTest, TestEmptyInput) {
   test::ExpectTensorEqual<int>(expected, *GetOutput(0));
 }
 
+//
+// BatchedNonMaxSuppressionOp Tests
+//
+
+class BatchedNonMaxSuppressionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_EXPECT_OK(NodeDefBuilder("batched_non_max_suppression_op",
+                                "BatchedNonMaxSuppression")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+
+  // Adds a batch of two images: the three clusters of the tests above, with
+  // two classes, and six identical boxes with the same scores.
+  void AddBoxesAndScores() {
+    AddInputFromArray<float>(
+        TensorShape({2, 6, 4}),
+        {0, 0,  1, 1,  0, 0.1f,  1, 1.1f,  0, -0.1f, 1, 0.9f,
+         0, 10, 1, 11, 0, 10.1f, 1, 11.1f, 0, 100,  1, 101,
+         0, 0,  1, 1,  0, 0,     1, 1,     0, 0,     1, 1,
+         0, 0,  1, 1,  0, 0,     1, 1,     0, 0,     1, 1});
+    AddInputFromArray<float>(TensorShape({2, 6, 2}),
+                             {.9f,  .1f, .75f, .2f, .6f, .3f,
+                              .95f, .4f, .5f,  .5f, .3f, .6f,
+                              .9f,  .9f, .9f,  .9f, .9f, .9f,
+                              .9f,  .9f, .9f,  .9f, .9f, .9f});
+  }
+};
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestSelectPerImageAndClass) {
+  MakeOp();
+  AddBoxesAndScores();
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT32, TensorShape({2, 2, 3}));
+  test::FillValues<int>(&expected, {3, 0, 5, 5, 4, 2, 0, -1, -1, 0, -1, -1});
+  test::ExpectTensorEqual<int>(expected, *GetOutput(0));
+  Tensor expected_num(allocator(), DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int>(&expected_num, {3, 3, 1, 1});
+  test::ExpectTensorEqual<int>(expected_num, *GetOutput(1));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestScoreThreshold) {
+  MakeOp();
+  AddBoxesAndScores();
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {.35f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT32, TensorShape({2, 2, 3}));
+  test::FillValues<int>(&expected, {3, 0, -1, 5, 4, -1, 0, -1, -1, 0, -1, -1});
+  test::ExpectTensorEqual<int>(expected, *GetOutput(0));
+  Tensor expected_num(allocator(), DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int>(&expected_num, {2, 2, 1, 1});
+  test::ExpectTensorEqual<int>(expected_num, *GetOutput(1));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestInconsistentBoxAndScoreShapes) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 2, 4}), {0, 0, 1, 1, 0, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({1, 3, 1}), {.9f, .8f, .7f});
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.f});
+  Status s = RunOpKernel();
+
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(
+      StringPiece(s.ToString()).contains("scores has incompatible shape"))
+      << s;
+}
+
 }  // namespace tensorflow
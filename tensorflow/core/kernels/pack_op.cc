@@ -83,6 +83,19 @@ class PackOp : public OpKernel {
       return;
     }
 
+    // Packing along the first dimension tensors that are adjacent in memory,
+    // e.g. the outputs of an Unpack along it, needs no copy.
+    if (axis == 0) {
+      std::vector<const Tensor*> slices;
+      slices.reserve(num);
+      for (int i = 0; i < num; ++i) slices.push_back(&values[i]);
+      Tensor output;
+      if (Tensor::FromAdjacentSlices(slices, output_shape, &output)) {
+        c->set_output(0, output);
+        return;
+      }
+    }
+
     // Allocate output
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
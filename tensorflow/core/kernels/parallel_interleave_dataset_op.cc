@@ -0,0 +1,448 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/kernels/dataset.h"
+
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+
+#include "tensorflow/core/kernels/captured_function.h"
+#include "tensorflow/core/kernels/dataset_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class ParallelInterleaveDatasetOp : public OpKernel {
+ public:
+  explicit ParallelInterleaveDatasetOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx), graph_def_version_(ctx->graph_def_version()) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &input));
+    core::ScopedUnref unref_input(input);
+
+    OpInputList inputs;
+    OP_REQUIRES_OK(ctx, ctx->input_list("other_arguments", &inputs));
+    std::vector<Tensor> other_arguments;
+    other_arguments.reserve(inputs.size());
+    for (const Tensor& t : inputs) {
+      other_arguments.push_back(t);
+    }
+
+    const Tensor* cycle_length_t;
+    OP_REQUIRES_OK(ctx, ctx->input("cycle_length", &cycle_length_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(cycle_length_t->shape()),
+                errors::InvalidArgument("cycle_length must be a scalar"));
+    const int64 cycle_length = cycle_length_t->flat<int64>()(0);
+    OP_REQUIRES(
+        ctx, cycle_length > 0,
+        errors::InvalidArgument("cycle_length must be greater than zero."));
+
+    const Tensor* block_length_t;
+    OP_REQUIRES_OK(ctx, ctx->input("block_length", &block_length_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(block_length_t->shape()),
+                errors::InvalidArgument("block_length must be a scalar"));
+    const int64 block_length = block_length_t->flat<int64>()(0);
+    OP_REQUIRES(
+        ctx, block_length > 0,
+        errors::InvalidArgument("block_length must be greater than zero."));
+
+    const Tensor* sloppy_t;
+    OP_REQUIRES_OK(ctx, ctx->input("sloppy", &sloppy_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(sloppy_t->shape()),
+                errors::InvalidArgument("sloppy must be a scalar"));
+    const bool sloppy = sloppy_t->flat<bool>()(0);
+
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
+                                                 std::move(other_arguments),
+                                                 &captured_func));
+
+    // As in ParallelMapDatasetOp, the worker threads outlive the
+    // IteratorContext of any single GetNext() call, so they run with the
+    // params captured from this kernel's context.
+    IteratorContext::Params params;
+    params.env = ctx->env();
+    params.resource_manager = ctx->resource_manager();
+    params.runner = *(ctx->runner());
+
+    DatasetBase* dataset = new Dataset(
+        input, std::move(captured_func), cycle_length, block_length, sloppy,
+        std::move(params), output_types_, output_shapes_);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->flat<ResourceHandle>()(0) = handle;
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(const DatasetBase* input,
+            std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
+            int64 block_length, bool sloppy,
+            IteratorContext::Params ctx_params,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : input_(input),
+          captured_func_(std::move(captured_func)),
+          cycle_length_(cycle_length),
+          block_length_(block_length),
+          sloppy_(sloppy),
+          ctx_params_(std::move(ctx_params)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return "ParallelInterleaveDatasetOp::Dataset";
+    }
+
+   private:
+    // The iterator runs the same cycle as InterleaveDataset, but each
+    // input element is opened and read by a dedicated worker thread,
+    // which buffers up to `block_length` outputs ahead of the consumer.
+    //
+    // There are `cycle_length` workers. Every worker is either reading
+    // the element in one slot of the cycle, or reading the next element
+    // that will be opened in the cycle (these are kept in input order in
+    // `future_elements_`), or idle because the input is exhausted. A
+    // worker whose element is exhausted is immediately given the next
+    // input element, so that opening an element (e.g. a remote file)
+    // overlaps with reading the others.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset),
+            iter_ctx_(dataset->ctx_params_),
+            input_impl_(dataset->input_->MakeIterator()),
+            current_elements_(dataset->cycle_length_, -1),
+            workers_(dataset->cycle_length_) {}
+
+      ~Iterator() override {
+        // Signal the worker threads, if any, so that they terminate.
+        // We will then join those threads when we delete
+        // `this->worker_threads_`.
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureWorkerThreadsStarted(ctx, &l);
+
+        while (!cancelled_ && (num_open_ > 0 || !future_elements_.empty() ||
+                               num_inputs_in_flight_ > 0)) {
+          const int64 worker_index = current_elements_[cycle_index_];
+          if (worker_index < 0) {
+            if (!future_elements_.empty()) {
+              // Open the next element in the current slot of the cycle.
+              current_elements_[cycle_index_] = future_elements_.front();
+              future_elements_.pop_front();
+              ++num_open_;
+            } else if (num_open_ == 0) {
+              // Another call is getting the next input element.
+              cond_var_.wait(l);
+            } else {
+              AdvanceToNextInCycle();
+            }
+            continue;
+          }
+
+          WorkerState* worker = &workers_[worker_index];
+          if (!worker->outputs.empty()) {
+            // Forward the status from producing the subelement, and (if
+            // we successfully got a subelement) the output values.
+            Status s = worker->outputs.front().status;
+            if (s.ok()) {
+              *out_tensors = std::move(worker->outputs.front().output);
+            }
+            worker->outputs.pop_front();
+            AdvancePosition();
+            *end_of_sequence = false;
+
+            // Wake the worker, in case it has been waiting for space in
+            // its buffer.
+            cond_var_.notify_all();
+            return s;
+          }
+
+          if (!worker->is_producing) {
+            // We have reached the end of the current element, so give its
+            // worker the next input element and move on to the next
+            // element in the cycle.
+            current_elements_[cycle_index_] = -1;
+            --num_open_;
+            AdvanceToNextInCycle();
+            AssignInputElement(ctx, worker_index, &l);
+            continue;
+          }
+
+          // The current element has no output yet. In sloppy mode, take
+          // the next one in the cycle that does, rather than waiting.
+          if (dataset()->sloppy_ && SkipToReadyElement()) {
+            continue;
+          }
+          cond_var_.wait(l);
+        }
+
+        if (cancelled_) {
+          return errors::Cancelled(
+              "ParallelInterleaveDatasetOp::Dataset::Iterator::GetNext");
+        }
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+     private:
+      struct OutputElement {
+        // The worker sets `status` if opening the input element or
+        // getting its next subelement fails.
+        Status status;
+        // The subelement.
+        std::vector<Tensor> output;
+      };
+
+      struct WorkerState {
+        // The input element that the worker will open next. Valid while
+        // `has_input` is true.
+        std::vector<Tensor> input;
+        bool has_input = false;
+        // True from when an input element is assigned until the worker
+        // has produced all of its subelements.
+        bool is_producing = false;
+        // Subelements that have been produced but not yet consumed.
+        std::deque<OutputElement> outputs;
+      };
+
+      void EnsureWorkerThreadsStarted(IteratorContext* ctx, mutex_lock* l)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (worker_threads_.empty()) {
+          iter_ctx_.set_collect_stats(ctx->collect_stats());
+          for (int64 i = 0; i < dataset()->cycle_length_; ++i) {
+            worker_threads_.emplace_back(ctx->env()->StartThread(
+                {}, "interleave_worker_thread",
+                [this, i]() { WorkerThread(i); }));
+          }
+          for (int64 i = 0; i < dataset()->cycle_length_; ++i) {
+            AssignInputElement(ctx, i, l);
+          }
+        }
+      }
+
+      // Gives the next input element, if any, to the idle worker
+      // `worker_index`, and appends it to `future_elements_`. If getting
+      // the input element fails, the worker's element consists of just
+      // that error, so that it is returned in input order.
+      //
+      // Getting the input element can block, e.g. on a slow input
+      // pipeline, so `*l` is released meanwhile and the workers keep
+      // filling their buffers. `input_mu_` keeps the concurrent calls in
+      // input order.
+      void AssignInputElement(IteratorContext* ctx, int64 worker_index,
+                              mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        ++num_inputs_in_flight_;
+        l->unlock();
+        mutex_lock input_l(input_mu_);
+        std::vector<Tensor> input;
+        bool end_of_input = end_of_input_;
+        Status s;
+        if (!end_of_input) {
+          s = input_impl_->GetNext(ctx, &input, &end_of_input);
+        }
+        l->lock();
+        --num_inputs_in_flight_;
+        WorkerState* worker = &workers_[worker_index];
+        if (!s.ok()) {
+          worker->outputs.emplace_back();
+          worker->outputs.back().status = s;
+          future_elements_.push_back(worker_index);
+        } else if (!end_of_input) {
+          worker->input = std::move(input);
+          worker->has_input = true;
+          worker->is_producing = true;
+          future_elements_.push_back(worker_index);
+        }
+        end_of_input_ = end_of_input;
+        cond_var_.notify_all();
+      }
+
+      // Moves `cycle_index_` to the next open element in the cycle that
+      // has an output or is exhausted. Returns false if there is none.
+      bool SkipToReadyElement() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        for (int64 i = 1; i < dataset()->cycle_length_; ++i) {
+          const int64 index = (cycle_index_ + i) % dataset()->cycle_length_;
+          const int64 worker_index = current_elements_[index];
+          if (worker_index >= 0 && (!workers_[worker_index].outputs.empty() ||
+                                    !workers_[worker_index].is_producing)) {
+            cycle_index_ = index;
+            block_index_ = 0;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void AdvanceToNextInCycle() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        block_index_ = 0;
+        cycle_index_ = (cycle_index_ + 1) % dataset()->cycle_length_;
+      }
+
+      void AdvancePosition() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        ++block_index_;
+        if (block_index_ == dataset()->block_length_) {
+          AdvanceToNextInCycle();
+        }
+      }
+
+      void WorkerThread(int64 worker_index) {
+        WorkerState* worker = &workers_[worker_index];
+        while (true) {
+          // 1. Wait for an input element.
+          std::vector<Tensor> input;
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ && !worker->has_input) {
+              cond_var_.wait(l);
+            }
+            if (cancelled_) {
+              return;
+            }
+            std::swap(input, worker->input);
+            worker->has_input = false;
+          }
+
+          // 2. Open the element, and read its subelements into the
+          // worker's buffer until it is exhausted.
+          std::unique_ptr<IteratorBase> iterator;
+          Status s = dataset::MakeIteratorFromInputElement(
+              &iter_ctx_, input, dataset()->captured_func_.get(), &iterator);
+          bool end_of_element = !s.ok();
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            worker->outputs.emplace_back();
+            worker->outputs.back().status = s;
+          }
+          while (!end_of_element) {
+            {
+              mutex_lock l(mu_);
+              while (!cancelled_ &&
+                     static_cast<int64>(worker->outputs.size()) >=
+                         dataset()->block_length_) {
+                cond_var_.wait(l);
+              }
+              if (cancelled_) {
+                return;
+              }
+            }
+
+            OutputElement element;
+            element.status =
+                iterator->GetNext(&iter_ctx_, &element.output, &end_of_element);
+            if (element.status.ok() && end_of_element) {
+              break;
+            }
+            mutex_lock l(mu_);
+            worker->outputs.push_back(std::move(element));
+            cond_var_.notify_all();
+          }
+
+          // 3. Signal that the element is exhausted.
+          {
+            mutex_lock l(mu_);
+            worker->is_producing = false;
+            cond_var_.notify_all();
+          }
+        }
+      }
+
+      // Only accessed by the worker threads, after they have started.
+      IteratorContext iter_ctx_;
+      // Acquired before `mu_`, by the calls getting input elements.
+      mutex input_mu_ ACQUIRED_BEFORE(mu_);
+      mutex mu_;
+      condition_variable cond_var_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(input_mu_);
+      bool end_of_input_ GUARDED_BY(input_mu_) = false;
+      // The number of AssignInputElement() calls getting an input element.
+      int64 num_inputs_in_flight_ GUARDED_BY(mu_) = 0;
+      // The worker reading the element in each slot of the cycle, or -1.
+      std::vector<int64> current_elements_ GUARDED_BY(mu_);
+      // Workers that have been given an input element that is not yet in
+      // the cycle, in input order.
+      std::deque<int64> future_elements_ GUARDED_BY(mu_);
+      std::vector<WorkerState> workers_ GUARDED_BY(mu_);
+      int64 num_open_ GUARDED_BY(mu_) = 0;
+      int64 cycle_index_ GUARDED_BY(mu_) = 0;
+      int64 block_index_ GUARDED_BY(mu_) = 0;
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      // Declared last, so that the threads are joined before the state
+      // they use is destroyed.
+      std::vector<std::unique_ptr<Thread>> worker_threads_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+    const int64 cycle_length_;
+    const int64 block_length_;
+    const bool sloppy_;
+    const IteratorContext::Params ctx_params_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  const int graph_def_version_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const NameAttrList* func_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ParallelInterleaveDataset").Device(DEVICE_CPU),
+                        ParallelInterleaveDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
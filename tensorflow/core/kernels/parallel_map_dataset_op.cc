@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 #include "tensorflow/core/kernels/captured_function.h"
 
@@ -29,6 +30,10 @@ namespace {
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
+// The value of `num_threads` that asks the iterator to tune its
+// parallelism and buffer size at runtime.
+const int32 kAutoTune = -1;
+
 class ParallelMapDatasetOp : public OpKernel {
  public:
   explicit ParallelMapDatasetOp(OpKernelConstruction* ctx)
@@ -56,9 +61,10 @@ class ParallelMapDatasetOp : public OpKernel {
     OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(num_threads_t->shape()),
                 errors::InvalidArgument("num_threads must be a scalar"));
     const int32 num_threads = num_threads_t->flat<int32>()(0);
-    OP_REQUIRES(
-        ctx, num_threads > 0,
-        errors::InvalidArgument("num_threads must be greater than zero."));
+    OP_REQUIRES(ctx, num_threads > 0 || num_threads == kAutoTune,
+                errors::InvalidArgument(
+                    "num_threads must be greater than zero, or -1 to tune "
+                    "the parallelism automatically."));
 
     const Tensor* output_buffer_size_t;
     OP_REQUIRES_OK(ctx,
@@ -73,7 +79,8 @@ class ParallelMapDatasetOp : public OpKernel {
     // seems like this constraint would make it easier to (i)
     // constrain the memory usage of the iterator, and (ii) enforce a
     // consistent ordering between input and output.
-    OP_REQUIRES(ctx, output_buffer_size >= num_threads,
+    OP_REQUIRES(ctx,
+                num_threads == kAutoTune || output_buffer_size >= num_threads,
                 errors::InvalidArgument(
                     "output_buffer_size (", output_buffer_size,
                     ") must be greater than or equal to num_threads (",
@@ -147,8 +154,18 @@ class ParallelMapDatasetOp : public OpKernel {
      public:
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset),
+            autotune_(dataset->num_threads_ == kAutoTune),
+            // When autotuning, the parallelism is bounded by the CPU
+            // budget and by `output_buffer_size`, if it is positive.
+            max_parallelism_(autotune_ ? MaxAutoTunedParallelism(dataset)
+                                       : dataset->num_threads_),
+            max_buffer_size_(autotune_ && dataset->output_buffer_size_ <= 0
+                                 ? 2 * max_parallelism_
+                                 : dataset->output_buffer_size_),
             iter_ctx_(dataset->ctx_params_),
-            input_impl_(dataset->input_->MakeIterator()) {}
+            input_impl_(dataset->input_->MakeIterator()),
+            parallelism_(autotune_ ? 1 : max_parallelism_),
+            buffer_size_(autotune_ ? BufferSizeFor(1) : max_buffer_size_) {}
 
       ~Iterator() override {
         // Signal the mapper threads, if any, so that they terminate.
@@ -167,18 +184,27 @@ class ParallelMapDatasetOp : public OpKernel {
         }
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(output_mu_);
         TF_RETURN_IF_ERROR(EnsureMapperThreadsStarted(ctx));
+        // The buffer includes the elements that are still being produced.
+        RecordBufferOccupancy(output_buffer_.size(), buffer_size_);
+        ++num_calls_;
+        if (output_buffer_.size() >= buffer_size_) {
+          ++num_calls_with_full_buffer_;
+        }
 
         while (true) {
           // 1. Wait until the next element in the output queue has
           // been produced, or we are shutting down.
-          while (
-              !cancelled_ && active_threads_ > 0 &&
-              (output_buffer_.empty() || !output_buffer_.front().is_produced)) {
-            cond_var_.wait(l);
+          if (ShouldWait()) {
+            const uint64 start_usecs = Env::Default()->NowMicros();
+            do {
+              cond_var_.wait(l);
+            } while (ShouldWait());
+            consumer_wait_usecs_ += Env::Default()->NowMicros() - start_usecs;
           }
 
           if (cancelled_) {
@@ -196,10 +222,14 @@ class ParallelMapDatasetOp : public OpKernel {
             }
             output_buffer_.pop_front();
             *end_of_sequence = false;
+            if (autotune_) {
+              MaybeTune();
+            }
 
-            // Wake one of the producing threads, in case they have been
-            // waiting for space in the queue.
-            cond_var_.notify_one();
+            // Wake the producing threads, in case they have been waiting
+            // for space in the queue. They share `cond_var_` with
+            // the consumers, so notifying one might not wake a producer.
+            cond_var_.notify_all();
             return s;
           } else if (active_threads_ == 0) {
             *end_of_sequence = true;
@@ -224,6 +254,13 @@ class ParallelMapDatasetOp : public OpKernel {
         std::vector<Tensor> output_value;
       };
 
+      // Returns true if the consumer must wait for the element at the
+      // front of the output queue to be produced.
+      bool ShouldWait() EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
+        return !cancelled_ && active_threads_ > 0 &&
+               (output_buffer_.empty() || !output_buffer_.front().is_produced);
+      }
+
       Status EnsureMapperThreadsStarted(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
         if (mapper_threads_.empty()) {
@@ -234,9 +271,13 @@ class ParallelMapDatasetOp : public OpKernel {
           // is always 0, so a negative random step ID should suffice.
           f_opts_.step_id = -std::abs(static_cast<int64>(random::New64()));
           f_opts_.runner = iter_ctx_.runner();
+          iter_ctx_.set_collect_stats(ctx->collect_stats());
 
-          active_threads_ = dataset()->num_threads_;
-          for (int i = 0; i < dataset()->num_threads_; ++i) {
+          // When autotuning, the threads beyond `parallelism_` stay
+          // idle until the tuner raises it.
+          active_threads_ = max_parallelism_;
+          tuning_period_start_usecs_ = Env::Default()->NowMicros();
+          for (int i = 0; i < max_parallelism_; ++i) {
             mapper_threads_.emplace_back(
                 std::unique_ptr<Thread>(ctx->env()->StartThread(
                     {}, "mapper_thread", [this]() { MapperThread(); })));
@@ -269,7 +310,8 @@ class ParallelMapDatasetOp : public OpKernel {
               // prevent another MapperThread from overtaking us.
               mutex_lock output_lock(output_mu_);
               while (!cancelled_ &&
-                     output_buffer_.size() == dataset()->output_buffer_size_) {
+                     (output_buffer_.size() >= buffer_size_ ||
+                      num_in_flight_ >= parallelism_)) {
                 cond_var_.wait(output_lock);
               }
 
@@ -280,12 +322,14 @@ class ParallelMapDatasetOp : public OpKernel {
 
               output_buffer_.push_back(OutputQueueElement());
               output_queue_element_ = &output_buffer_.back();
+              ++num_in_flight_;
             }
 
             bool end_of_sequence;
             s = input_impl_->GetNext(&iter_ctx_, &input_args, &end_of_sequence);
             if (s.ok() && end_of_sequence) {
               mutex_lock output_lock(output_mu_);
+              --num_in_flight_;
               --active_threads_;
               if (active_threads_ == 0) {
                 cond_var_.notify_all();
@@ -305,11 +349,75 @@ class ParallelMapDatasetOp : public OpKernel {
             output_queue_element_->output_status.Update(s);
             output_queue_element_->is_produced = true;
             std::swap(output_queue_element_->output_value, output_value);
+            --num_in_flight_;
             cond_var_.notify_all();
           }
         }
       }
 
+      static int32 MaxAutoTunedParallelism(const Dataset* dataset) {
+        int32 result = port::NumSchedulableCPUs();
+        if (dataset->output_buffer_size_ > 0 &&
+            dataset->output_buffer_size_ < result) {
+          result = static_cast<int32>(dataset->output_buffer_size_);
+        }
+        return std::max(result, 1);
+      }
+
+      // The buffer must hold at least one element per in-flight call,
+      // and a second one per call lets the producers run ahead of a
+      // consumer that is briefly slow.
+      int64 BufferSizeFor(int32 parallelism) const {
+        return std::min<int64>(2 * static_cast<int64>(parallelism),
+                               max_buffer_size_);
+      }
+
+      // Adjusts `parallelism_` and `buffer_size_` after each period of
+      // `kTuningPeriodUsecs`. If the consumer spent more than
+      // `kRaiseWaitFraction` of the period waiting for elements, the
+      // producers are the bottleneck, so we allow one more in-flight
+      // call, up to the CPU budget. If the consumer never waited and
+      // always found the buffer full, the producers spent time blocked,
+      // so we allow one fewer call and the iterator does not hold on to
+      // more CPU than it needs.
+      void MaybeTune() EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
+        const uint64 now_usecs = Env::Default()->NowMicros();
+        const uint64 period_usecs = now_usecs - tuning_period_start_usecs_;
+        if (period_usecs < kTuningPeriodUsecs) {
+          return;
+        }
+        const double wait_fraction =
+            static_cast<double>(consumer_wait_usecs_) / period_usecs;
+        int32 new_parallelism = parallelism_;
+        if (wait_fraction > kRaiseWaitFraction &&
+            parallelism_ < max_parallelism_) {
+          ++new_parallelism;
+        } else if (consumer_wait_usecs_ == 0 &&
+                   num_calls_with_full_buffer_ == num_calls_ &&
+                   parallelism_ > 1) {
+          --new_parallelism;
+        }
+        if (new_parallelism != parallelism_) {
+          VLOG(2) << "ParallelMapDataset iterator " << this
+                  << ": consumer waited for " << wait_fraction * 100
+                  << "% of the last period; changing parallelism from "
+                  << parallelism_ << " to " << new_parallelism;
+          parallelism_ = new_parallelism;
+          buffer_size_ = BufferSizeFor(parallelism_);
+        }
+        consumer_wait_usecs_ = 0;
+        num_calls_ = 0;
+        num_calls_with_full_buffer_ = 0;
+        tuning_period_start_usecs_ = now_usecs;
+      }
+
+      static constexpr uint64 kTuningPeriodUsecs = 50000;  // 50 ms.
+      static constexpr double kRaiseWaitFraction = 0.05;
+
+      const bool autotune_;
+      const int32 max_parallelism_;
+      const int64 max_buffer_size_;
+
       IteratorContext iter_ctx_;
       mutex input_mu_;
       const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(input_mu_);
@@ -321,6 +429,18 @@ class ParallelMapDatasetOp : public OpKernel {
           GUARDED_BY(output_mu_);
       bool cancelled_ GUARDED_BY(output_mu_) = false;
       int32 active_threads_ GUARDED_BY(output_mu_);
+
+      // The maximum number of concurrent calls to the map function and
+      // the maximum number of buffered elements. These are fixed unless
+      // `autotune_` is true.
+      int32 parallelism_ GUARDED_BY(output_mu_);
+      int64 buffer_size_ GUARDED_BY(output_mu_);
+      int32 num_in_flight_ GUARDED_BY(output_mu_) = 0;
+      // Statistics for the current tuning period.
+      uint64 consumer_wait_usecs_ GUARDED_BY(output_mu_) = 0;
+      int64 num_calls_ GUARDED_BY(output_mu_) = 0;
+      int64 num_calls_with_full_buffer_ GUARDED_BY(output_mu_) = 0;
+      uint64 tuning_period_start_usecs_ GUARDED_BY(output_mu_) = 0;
     };
 
     const DatasetBase* const input_;
@@ -0,0 +1,220 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/dataset.h"
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/util/example_proto_fast_parsing.h"
+#include "tensorflow/core/util/example_proto_helper.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class ParseExampleDatasetOp : public OpKernel {
+ public:
+  explicit ParseExampleDatasetOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, attrs_.Init(ctx));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &input));
+    core::ScopedUnref unref_input(input);
+
+    const Tensor* num_threads_t;
+    OP_REQUIRES_OK(ctx, ctx->input("num_threads", &num_threads_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(num_threads_t->shape()),
+                errors::InvalidArgument("num_threads must be a scalar"));
+    const int32 num_threads = num_threads_t->flat<int32>()(0);
+    OP_REQUIRES(
+        ctx, num_threads > 0,
+        errors::InvalidArgument("num_threads must be greater than zero."));
+
+    OpInputList sparse_keys;
+    OpInputList dense_keys;
+    OpInputList dense_defaults;
+    OP_REQUIRES_OK(ctx, ctx->input_list("sparse_keys", &sparse_keys));
+    OP_REQUIRES_OK(ctx, ctx->input_list("dense_keys", &dense_keys));
+    OP_REQUIRES_OK(ctx, ctx->input_list("dense_defaults", &dense_defaults));
+
+    // The same checks as the ParseExample kernel makes on its defaults.
+    for (int d = 0; d < attrs_.num_dense; ++d) {
+      const Tensor& def_value = dense_defaults[d];
+      if (attrs_.variable_length[d]) {
+        OP_REQUIRES(ctx, def_value.NumElements() == 1,
+                    errors::InvalidArgument(
+                        "dense_shape[", d, "] is a variable length shape: ",
+                        attrs_.dense_shapes[d].DebugString(),
+                        ", therefore def_value[", d,
+                        "] must contain a single element (the padding "
+                        "element).  But its shape is: ",
+                        def_value.shape().DebugString()));
+      } else if (def_value.NumElements() > 0) {
+        OP_REQUIRES(ctx,
+                    attrs_.dense_shapes[d].IsCompatibleWith(def_value.shape()),
+                    errors::InvalidArgument(
+                        "def_value[", d,
+                        "].shape() == ", def_value.shape().DebugString(),
+                        " is not compatible with dense_shapes_[", d,
+                        "] == ", attrs_.dense_shapes[d].DebugString()));
+      }
+      OP_REQUIRES(ctx, def_value.dtype() == attrs_.dense_types[d],
+                  errors::InvalidArgument(
+                      "dense_defaults[", d, "].dtype() == ",
+                      DataTypeString(def_value.dtype()), " != dense_types_[", d,
+                      "] == ", DataTypeString(attrs_.dense_types[d])));
+    }
+
+    example::FastParseExampleConfig config;
+    for (int d = 0; d < attrs_.num_dense; ++d) {
+      config.dense.push_back({dense_keys[d].scalar<string>()(),
+                              attrs_.dense_types[d], attrs_.dense_shapes[d],
+                              dense_defaults[d], attrs_.variable_length[d],
+                              attrs_.elements_per_stride[d]});
+    }
+    for (int d = 0; d < attrs_.num_sparse; ++d) {
+      config.sparse.push_back(
+          {sparse_keys[d].scalar<string>()(), attrs_.sparse_types[d]});
+    }
+
+    DatasetBase* dataset =
+        new Dataset(ctx->env(), input, std::move(config), num_threads,
+                    output_types_, output_shapes_);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->flat<ResourceHandle>()(0) = handle;
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(Env* env, const DatasetBase* input,
+            example::FastParseExampleConfig config, int32 num_threads,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : input_(input),
+          config_(std::move(config)),
+          thread_pool_(new thread::ThreadPool(env, "parse_example_dataset",
+                                             num_threads)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override { return "ParseExampleDatasetOp::Dataset"; }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset),
+            input_impl_(dataset->input_->MakeIterator()) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::vector<Tensor> input_element;
+        {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &input_element, end_of_sequence));
+          if (*end_of_sequence) {
+            return Status::OK();
+          }
+        }
+
+        if (input_element.size() != 1 ||
+            input_element[0].dtype() != DT_STRING ||
+            !TensorShapeUtils::IsVector(input_element[0].shape())) {
+          return errors::InvalidArgument(
+              "ParseExampleDataset expects each input element to be a vector "
+              "of serialized Example protos.");
+        }
+
+        // Parse the batch outside the lock, so that concurrent GetNext()
+        // calls parse their batches in parallel.
+        auto serialized_t = input_element[0].flat<string>();
+        gtl::ArraySlice<string> serialized(serialized_t.data(),
+                                           serialized_t.size());
+        example::Result result;
+        TF_RETURN_IF_ERROR(example::FastParseExample(
+            dataset()->config_, serialized, {}, dataset()->thread_pool_.get(),
+            &result));
+
+        // Each sparse feature contributes its indices, values and shape, in
+        // that order, followed by the values of each dense feature.
+        out_tensors->clear();
+        out_tensors->reserve(dataset()->output_types_.size());
+        for (size_t d = 0; d < result.sparse_values.size(); ++d) {
+          out_tensors->push_back(std::move(result.sparse_indices[d]));
+          out_tensors->push_back(std::move(result.sparse_values[d]));
+          out_tensors->push_back(std::move(result.sparse_shapes[d]));
+        }
+        for (Tensor& t : result.dense_values) {
+          out_tensors->push_back(std::move(t));
+        }
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const example::FastParseExampleConfig config_;
+    // Shards each batch across its threads. Shared by all iterators.
+    const std::unique_ptr<thread::ThreadPool> thread_pool_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  ParseSingleExampleAttrs attrs_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ParseExampleDataset").Device(DEVICE_CPU),
+                        ParseExampleDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 
@@ -26,9 +27,30 @@ namespace {
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following ops.
 
+// Maps the `file_size` bytes of `filename` into memory, if its file
+// system supports that. Leaves `*region` empty if it does not, in which
+// case the caller should fall back to reading the file through a buffer.
+Status MaybeMapFile(Env* env, const string& filename, uint64 file_size,
+                    std::unique_ptr<ReadOnlyMemoryRegion>* region) {
+  region->reset();
+  // Mapping an empty file fails, and there is nothing to read anyway.
+  if (file_size == 0) {
+    return Status::OK();
+  }
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, region);
+  if (errors::IsUnimplemented(s)) {
+    VLOG(1) << "Falling back to buffered reads of " << filename << ": " << s;
+    region->reset();
+    return Status::OK();
+  }
+  return s;
+}
+
 class TextLineDatasetOp : public OpKernel {
  public:
-  using OpKernel::OpKernel;
+  explicit TextLineDatasetOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_mmap", &use_mmap_));
+  }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* filenames_tensor;
@@ -43,7 +65,7 @@ class TextLineDatasetOp : public OpKernel {
       filenames.push_back(filenames_tensor->flat<string>()(i));
     }
 
-    DatasetBase* dataset = new Dataset(std::move(filenames));
+    DatasetBase* dataset = new Dataset(std::move(filenames), use_mmap_);
     Tensor* output = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
     ResourceHandle handle = MakeResourceHandle<DatasetBase>(
@@ -55,8 +77,8 @@ class TextLineDatasetOp : public OpKernel {
  private:
   class Dataset : public DatasetBase {
    public:
-    explicit Dataset(std::vector<string> filenames)
-        : filenames_(std::move(filenames)) {}
+    Dataset(std::vector<string> filenames, bool use_mmap)
+        : filenames_(std::move(filenames)), use_mmap_(use_mmap) {}
 
     std::unique_ptr<IteratorBase> MakeIterator() const override {
       return std::unique_ptr<IteratorBase>(new Iterator(this));
@@ -81,18 +103,48 @@ class TextLineDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
-          // We are currently processing a file, so try to read the next line.
-          if (input_buffer_) {
-            string line_contents;
-            Status s = input_buffer_->ReadLine(&line_contents);
+          // We are currently processing a mapped file, so find the next
+          // line in it. This matches `io::InputBuffer::ReadLine()`.
+          if (region_) {
+            const char* data = static_cast<const char*>(region_->data());
+            const uint64 size = region_->length();
+            if (region_pos_ < size) {
+              const char* begin = data + region_pos_;
+              const char* newline = static_cast<const char*>(
+                  memchr(begin, '\n', size - region_pos_));
+              const char* end = newline != nullptr ? newline : data + size;
+              region_pos_ = end - data + (newline != nullptr ? 1 : 0);
+              if (end > begin && end[-1] == '\r') {
+                --end;
+              }
+              if (newline != nullptr || end > begin) {
+                // Produce the line as output, constructing the string
+                // directly from the mapped bytes.
+                Tensor line_tensor(cpu_allocator(), DT_STRING, {});
+                line_tensor.scalar<string>()().assign(begin, end - begin);
+                out_tensors->emplace_back(std::move(line_tensor));
+                *end_of_sequence = false;
+                return Status::OK();
+              }
+            }
+
+            // We have reached the end of the current file, so maybe
+            // move on to next file.
+            region_.reset();
+            ++current_file_index_;
+          } else if (input_buffer_) {
+            // We are currently processing a file, so try to read the next
+            // line.
+            Tensor line_tensor(cpu_allocator(), DT_STRING, {});
+            Status s =
+                input_buffer_->ReadLine(&line_tensor.scalar<string>()());
             if (s.ok()) {
               // Produce the line as output.
-              Tensor line_tensor(cpu_allocator(), DT_STRING, {});
-              line_tensor.scalar<string>()() = line_contents;
               out_tensors->emplace_back(std::move(line_tensor));
               *end_of_sequence = false;
               return Status::OK();
@@ -115,8 +167,18 @@ class TextLineDatasetOp : public OpKernel {
           }
 
           // Actually move on to next file.
-          TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
-              dataset()->filenames_[current_file_index_], &file_));
+          const string& filename = dataset()->filenames_[current_file_index_];
+          if (dataset()->use_mmap_) {
+            uint64 file_size;
+            TF_RETURN_IF_ERROR(ctx->env()->GetFileSize(filename, &file_size));
+            TF_RETURN_IF_ERROR(
+                MaybeMapFile(ctx->env(), filename, file_size, &region_));
+            if (region_) {
+              region_pos_ = 0;
+              continue;
+            }
+          }
+          TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(filename, &file_));
           input_buffer_.reset(new io::InputBuffer(file_.get(), kBufferSize));
         } while (true);
       }
@@ -131,10 +193,17 @@ class TextLineDatasetOp : public OpKernel {
       std::unique_ptr<RandomAccessFile> file_
           GUARDED_BY(mu_);  // must outlive input_buffer_
       std::unique_ptr<io::InputBuffer> input_buffer_ GUARDED_BY(mu_);
+      // Set instead of `file_` and `input_buffer_` when the current file
+      // is memory-mapped.
+      std::unique_ptr<ReadOnlyMemoryRegion> region_ GUARDED_BY(mu_);
+      uint64 region_pos_ GUARDED_BY(mu_) = 0;
     };
 
     const std::vector<string> filenames_;
+    const bool use_mmap_;
   };
+
+  bool use_mmap_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TextLineDataset").Device(DEVICE_CPU),
@@ -142,7 +211,10 @@ REGISTER_KERNEL_BUILDER(Name("TextLineDataset").Device(DEVICE_CPU),
 
 class FixedLengthRecordDatasetOp : public OpKernel {
  public:
-  using OpKernel::OpKernel;
+  explicit FixedLengthRecordDatasetOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_mmap", &use_mmap_));
+  }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* filenames_tensor;
@@ -176,7 +248,7 @@ class FixedLengthRecordDatasetOp : public OpKernel {
     const int64 footer_bytes = footer_bytes_tensor->scalar<int64>()();
 
     DatasetBase* dataset = new Dataset(std::move(filenames), header_bytes,
-                                       record_bytes, footer_bytes);
+                                       record_bytes, footer_bytes, use_mmap_);
     Tensor* output = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
     ResourceHandle handle = MakeResourceHandle<DatasetBase>(
@@ -188,12 +260,13 @@ class FixedLengthRecordDatasetOp : public OpKernel {
  private:
   class Dataset : public DatasetBase {
    public:
-    explicit Dataset(std::vector<string> filenames, int64 header_bytes,
-                     int64 record_bytes, int64 footer_bytes)
+    Dataset(std::vector<string> filenames, int64 header_bytes,
+            int64 record_bytes, int64 footer_bytes, bool use_mmap)
         : filenames_(std::move(filenames)),
           header_bytes_(header_bytes),
           record_bytes_(record_bytes),
-          footer_bytes_(footer_bytes) {}
+          footer_bytes_(footer_bytes),
+          use_mmap_(use_mmap) {}
 
     std::unique_ptr<IteratorBase> MakeIterator() const override {
       return std::unique_ptr<IteratorBase>(new Iterator(this));
@@ -220,21 +293,49 @@ class FixedLengthRecordDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
-          // We are currently processing a file, so try to read the next record.
-          if (input_buffer_) {
+          // We are currently processing a mapped file, so produce the next
+          // record from it.
+          if (region_) {
+            DCHECK_GE(file_pos_limit_, 0);
+            if (region_pos_ < file_pos_limit_) {
+              if (region_pos_ + dataset()->record_bytes_ >
+                  static_cast<int64>(region_->length())) {
+                return errors::OutOfRange(
+                    "Reached the end of ",
+                    dataset()->filenames_[current_file_index_],
+                    " in the middle of a record.");
+              }
+              // Produce the record as output, constructing the string
+              // directly from the mapped bytes.
+              Tensor record_tensor(cpu_allocator(), DT_STRING, {});
+              record_tensor.scalar<string>()().assign(
+                  static_cast<const char*>(region_->data()) + region_pos_,
+                  dataset()->record_bytes_);
+              region_pos_ += dataset()->record_bytes_;
+              out_tensors->emplace_back(std::move(record_tensor));
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+
+            // We have reached the end of the current file, so maybe
+            // move on to next file.
+            region_.reset();
+            ++current_file_index_;
+          } else if (input_buffer_) {
+            // We are currently processing a file, so try to read the next
+            // record.
             const int64 current_pos = input_buffer_->Tell();
             DCHECK_GE(file_pos_limit_, 0);
             if (current_pos < file_pos_limit_) {
-              string record;
-              TF_RETURN_IF_ERROR(
-                  input_buffer_->ReadNBytes(dataset()->record_bytes_, &record));
-              // Produce the record as output.
               Tensor record_tensor(cpu_allocator(), DT_STRING, {});
-              record_tensor.scalar<string>()() = record;
+              TF_RETURN_IF_ERROR(input_buffer_->ReadNBytes(
+                  dataset()->record_bytes_, &record_tensor.scalar<string>()()));
+              // Produce the record as output.
               out_tensors->emplace_back(std::move(record_tensor));
               *end_of_sequence = false;
               return Status::OK();
@@ -254,12 +355,19 @@ class FixedLengthRecordDatasetOp : public OpKernel {
           }
 
           // Actually move on to next file.
+          const string& filename = dataset()->filenames_[current_file_index_];
           uint64 file_size;
-          TF_RETURN_IF_ERROR(ctx->env()->GetFileSize(
-              dataset()->filenames_[current_file_index_], &file_size));
+          TF_RETURN_IF_ERROR(ctx->env()->GetFileSize(filename, &file_size));
           file_pos_limit_ = file_size - dataset()->footer_bytes_;
-          TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
-              dataset()->filenames_[current_file_index_], &file_));
+          if (dataset()->use_mmap_) {
+            TF_RETURN_IF_ERROR(
+                MaybeMapFile(ctx->env(), filename, file_size, &region_));
+            if (region_) {
+              region_pos_ = dataset()->header_bytes_;
+              continue;
+            }
+          }
+          TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(filename, &file_));
           input_buffer_.reset(new io::InputBuffer(file_.get(), kBufferSize));
           TF_RETURN_IF_ERROR(
               input_buffer_->SkipNBytes(dataset()->header_bytes_));
@@ -277,13 +385,20 @@ class FixedLengthRecordDatasetOp : public OpKernel {
           GUARDED_BY(mu_);  // must outlive input_buffer_
       std::unique_ptr<io::InputBuffer> input_buffer_ GUARDED_BY(mu_);
       int64 file_pos_limit_ GUARDED_BY(mu_) = -1;
+      // Set instead of `file_` and `input_buffer_` when the current file
+      // is memory-mapped.
+      std::unique_ptr<ReadOnlyMemoryRegion> region_ GUARDED_BY(mu_);
+      int64 region_pos_ GUARDED_BY(mu_) = 0;
     };
 
     const std::vector<string> filenames_;
     const int64 header_bytes_;
     const int64 record_bytes_;
     const int64 footer_bytes_;
+    const bool use_mmap_;
   };
+
+  bool use_mmap_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("FixedLengthRecordDataset").Device(DEVICE_CPU),
@@ -356,8 +471,9 @@ class TFRecordDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
           // We are currently processing a file, so try to read the next record.
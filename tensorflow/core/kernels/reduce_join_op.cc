@@ -25,7 +25,6 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
-#include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
 
@@ -172,8 +171,21 @@ class ReduceJoinOp : public OpKernel {
         curr_strings[reduction_index] =
             input_flat(output_full_index + reduction_full_index);
       }
-      output_flat(output_index) =
-          str_util::Join(curr_strings, separator_.c_str());
+      // Size the output once up front, instead of letting it grow with
+      // every piece that's appended.
+      size_t output_size = 0;
+      for (const StringPiece& piece : curr_strings) {
+        output_size += piece.size();
+      }
+      if (reduction_iter_size > 0) {
+        output_size += separator_.size() * (reduction_iter_size - 1);
+      }
+      string& output = output_flat(output_index);
+      output.reserve(output_size);
+      for (int64 i = 0; i < reduction_iter_size; ++i) {
+        if (i > 0) output.append(separator_);
+        output.append(curr_strings[i].data(), curr_strings[i].size());
+      }
     }
   }
 
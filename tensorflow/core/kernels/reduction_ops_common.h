@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/reduction_ops.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/kernels/x86_cwise_kernels.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
@@ -274,6 +275,50 @@ struct ReduceFunctorBase {
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
         : ReduceFunctorBase<CPUDevice, Reducer>{};
+
+// Float sums to a scalar and along the rows or the columns of a matrix use
+// the kernels of x86_cwise_kernels.h when they are enabled.
+template <>
+struct ReduceFunctor<CPUDevice, Eigen::internal::SumReducer<float>>
+    : ReduceFunctorBase<CPUDevice, Eigen::internal::SumReducer<float>> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(const CPUDevice& d, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Eigen::internal::SumReducer<float>& reducer) {
+    if (!x86::CwiseKernelsEnabled() || !X86Sum(d, out, in, reduction_axes)) {
+      ReduceEigenImpl(d, out, in, reduction_axes, reducer);
+    }
+  }
+
+ private:
+  template <typename ReductionAxes>
+  static bool X86Sum(const CPUDevice& d, TTypes<float, 0>::Tensor out,
+                     TTypes<float, 1>::ConstTensor in,
+                     const ReductionAxes& reduction_axes) {
+    out() = x86::SumFloat(d, in.data(), in.size());
+    return true;
+  }
+
+  template <typename ReductionAxes>
+  static bool X86Sum(const CPUDevice& d, TTypes<float, 1>::Tensor out,
+                     TTypes<float, 2>::ConstTensor in,
+                     const ReductionAxes& reduction_axes) {
+    if (Eigen::internal::array_get<0>(reduction_axes) == 0) {
+      x86::ColumnSumsFloat(d, in.data(), in.dimension(0), in.dimension(1),
+                           out.data());
+    } else {
+      x86::RowSumsFloat(d, in.data(), in.dimension(0), in.dimension(1),
+                        out.data());
+    }
+    return true;
+  }
+
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool X86Sum(const CPUDevice& d, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes) {
+    return false;
+  }
+};
 #if TENSORFLOW_USE_SYCL
 template <typename Reducer>
 struct ReduceFunctor<SYCLDevice, Reducer>
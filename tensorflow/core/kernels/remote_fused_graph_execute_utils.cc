@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/remote_fused_graph_execute_utils.h"
 
 #include <algorithm>
+#include <map>
 #include <queue>
 #include <utility>
 
@@ -760,14 +761,15 @@ RemoteFusedGraphExecuteUtils::BuildRemoteFusedGraphExecuteOpNode(
     // Determine one cluster border
     std::vector<string>& border_inputs = std::get<1>(ci);
     std::vector<string>& border_outputs = std::get<2>(ci);
-    for (const string& node_name : node_names) {
+    const std::unordered_set<string>& cluster_node_names = std::get<0>(ci);
+    for (const string& node_name : cluster_node_names) {
       Node* node = FindMutableNodeByName(node_name, &graph);
       CHECK_NOTNULL(node);
-      int input_count = 0;
       for (const Edge* in_edge : node->in_edges()) {
         const Node* src_node = in_edge->src();
         const bool src_is_outside =
-            node_names.count(src_node->name()) <= 0 && !src_node->IsSource();
+            cluster_node_names.count(src_node->name()) <= 0 &&
+            !src_node->IsSource();
         if (src_is_outside) {
           const string src_name =
               strings::StrCat(src_node->name(), ":", in_edge->src_output());
@@ -778,16 +780,14 @@ RemoteFusedGraphExecuteUtils::BuildRemoteFusedGraphExecuteOpNode(
               border_inputs.end()) {
             border_inputs.emplace_back(src_name);
           }
-        } else {
-          ++input_count;
         }
       }
-      CHECK(input_count == 0 || input_count == node->in_edges().size());
 
       for (const Edge* out_edge : node->out_edges()) {
         const Node* dst_node = out_edge->dst();
         CHECK_NOTNULL(dst_node);
-        const bool dst_is_outside = node_names.count(dst_node->name()) <= 0;
+        const bool dst_is_outside =
+            cluster_node_names.count(dst_node->name()) <= 0;
         const string dst_name =
             strings::StrCat(node->name(), ":", out_edge->src_output());
         if (dst_is_outside) {
@@ -1001,9 +1001,9 @@ RemoteFusedGraphExecuteUtils::BuildRemoteFusedGraphExecuteOpNode(
             << "Num outputs should be 1 for " << output << ".";
         graph.RemoveNode(original_output_node);
         Node* new_node;
-        TF_RETURN_IF_ERROR(BuildIdentityOpNode(output_name,
-                                               remote_fused_graph_node_name, i,
-                                               DT_FLOAT, &graph, &new_node));
+        TF_RETURN_IF_ERROR(BuildIdentityOpNode(
+            output_name, remote_fused_graph_node_name, i,
+            fused_node->output_type(i), &graph, &new_node));
         CHECK_NOTNULL(new_node);
       }
     }
@@ -1035,17 +1035,133 @@ RemoteFusedGraphExecuteUtils::BuildRemoteFusedGraphExecuteOpNode(
   TF_RETURN_IF_ERROR(RemoteFusedGraphExecuteUtils::ClusterizeNodes(
       subgraph_nodes, input_graph_def, &ci_vec));
 
-  for (int i = 0; i < ci_vec.size(); ++i) {
-    const string remote_fused_graph_node_name =
-        strings::StrCat(remote_fused_graph_node_name_prefix, "/", i);
-    TF_RETURN_IF_ERROR(FuseCluster(input_graph_def, inputs, outputs,
-                                   remote_fused_graph_node_name, ci_vec.at(i),
-                                   remote_fused_graph_executor_name,
-                                   require_shape_type, output_graph_def));
+  std::vector<std::unordered_set<string>> clusters;
+  for (const ClusterInfo& ci : ci_vec) {
+    clusters.emplace_back(std::get<0>(ci));
+  }
+  return FusePartitions(input_graph_def, inputs, outputs,
+                        remote_fused_graph_node_name_prefix, clusters,
+                        remote_fused_graph_executor_name, require_shape_type,
+                        output_graph_def);
+}
+
+/* static */ Status RemoteFusedGraphExecuteUtils::PartitionNodes(
+    const std::unordered_set<string>& node_names, const GraphDef& graph_def,
+    std::vector<std::unordered_set<string>>* partitions) {
+  CHECK_NOTNULL(partitions);
+  Graph graph(OpRegistry::Global());
+  ShapeRefiner shape_refiner(graph.versions().producer(), graph.op_registry());
+  TF_RETURN_IF_ERROR(ImportGraphDef({}, graph_def, &graph, &shape_refiner));
+
+  const auto has_inputs = [](const Node* node) {
+    for (const Edge* edge : node->in_edges()) {
+      if (!edge->src()->IsSource()) {
+        return true;
+      }
+    }
+    return false;
+  };
+  const auto is_partitioned = [&node_names, &has_inputs](const Node* node) {
+    return node_names.count(node->name()) > 0 && has_inputs(node);
+  };
+
+  // The depth of a node is the largest number of times a path to the node
+  // crosses the border between given nodes and the others.  Depths never
+  // decrease along an edge, and a path which leaves given nodes and comes
+  // back crosses the border twice.  Therefore, given nodes connected by
+  // edges between the same depth can be fused together.  Nodes without
+  // inputs can't be in the middle of a path, so they are skipped here.
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> depths(graph.num_node_ids(), 0);
+  for (const Node* node : order) {
+    const bool fused = node_names.count(node->name()) > 0;
+    int depth = 0;
+    for (const Edge* edge : node->in_edges()) {
+      const Node* src_node = edge->src();
+      if (!has_inputs(src_node)) {
+        continue;
+      }
+      const bool src_fused = node_names.count(src_node->name()) > 0;
+      depth = std::max(depth,
+                       depths[src_node->id()] + (src_fused != fused ? 1 : 0));
+    }
+    depths[node->id()] = depth;
+  }
+
+  std::vector<int> partition_ids(graph.num_node_ids(), -1);
+  for (const Node* node : graph.nodes()) {
+    if (!is_partitioned(node) || partition_ids[node->id()] >= 0) {
+      continue;
+    }
+    const int partition_id = partitions->size();
+    partitions->emplace_back();
+    std::deque<const Node*> queue;
+    queue.push_back(node);
+    partition_ids[node->id()] = partition_id;
+    while (!queue.empty()) {
+      const Node* current = queue.front();
+      queue.pop_front();
+      partitions->back().emplace(current->name());
+      std::vector<const Node*> neighbors;
+      for (const Edge* edge : current->in_edges()) {
+        neighbors.emplace_back(edge->src());
+      }
+      for (const Edge* edge : current->out_edges()) {
+        neighbors.emplace_back(edge->dst());
+      }
+      for (const Node* neighbor : neighbors) {
+        if (is_partitioned(neighbor) && partition_ids[neighbor->id()] < 0 &&
+            depths[neighbor->id()] == depths[current->id()]) {
+          partition_ids[neighbor->id()] = partition_id;
+          queue.push_back(neighbor);
+        }
+      }
+    }
+  }
+
+  // Place nodes without inputs with their consumers.
+  for (const Node* node : graph.nodes()) {
+    if (!node->IsOp() || node_names.count(node->name()) <= 0 ||
+        has_inputs(node)) {
+      continue;
+    }
+    int partition_id = -1;
+    for (const Edge* edge : node->out_edges()) {
+      const Node* dst_node = edge->dst();
+      if (dst_node->IsSink()) {
+        continue;
+      }
+      const int dst_partition_id = partition_ids[dst_node->id()];
+      if (dst_partition_id < 0 ||
+          (partition_id >= 0 && partition_id != dst_partition_id)) {
+        partition_id = -1;
+        break;
+      }
+      partition_id = dst_partition_id;
+    }
+    if (partition_id >= 0) {
+      partitions->at(partition_id).emplace(node->name());
+    }
   }
   return Status::OK();
 }
 
+/* static */ Status RemoteFusedGraphExecuteUtils::FuseRemoteGraphByPartitions(
+    const GraphDef& input_graph_def, const std::vector<string>& inputs,
+    const std::vector<string>& outputs,
+    const string& remote_fused_graph_node_name_prefix,
+    const std::vector<std::unordered_set<string>>& partitions,
+    const string& remote_fused_graph_executor_name,
+    const bool require_shape_type, GraphDef* output_graph_def) {
+  GraphDef graph_def = input_graph_def;
+  TF_RETURN_IF_ERROR(ForwardPartitionInputs(partitions, &graph_def));
+  return FusePartitions(graph_def, inputs, outputs,
+                        remote_fused_graph_node_name_prefix, partitions,
+                        remote_fused_graph_executor_name, require_shape_type,
+                        output_graph_def);
+}
+
 /* static */ Status RemoteFusedGraphExecuteUtils::FuseRemoteGraphByBorder(
     const GraphDef& input_graph_def, const std::vector<string>& inputs,
     const std::vector<string>& outputs,
@@ -1280,6 +1396,111 @@ RemoteFusedGraphExecuteUtils::FuseRemoteGraphByPlacedArguments(
   return true;
 }
 
+/* static */ Status RemoteFusedGraphExecuteUtils::ForwardPartitionInputs(
+    const std::vector<std::unordered_set<string>>& partitions,
+    GraphDef* graph_def) {
+  std::unordered_map<string, int> partition_ids;
+  for (int i = 0; i < partitions.size(); ++i) {
+    for (const string& node_name : partitions.at(i)) {
+      partition_ids.emplace(node_name, i);
+    }
+  }
+
+  Graph graph(OpRegistry::Global());
+  ShapeRefiner shape_refiner(graph.versions().producer(), graph.op_registry());
+  TF_RETURN_IF_ERROR(ImportGraphDef({}, *graph_def, &graph, &shape_refiner));
+
+  std::vector<const Edge*> forwarded_edges;
+  for (const Edge* edge : graph.edges()) {
+    if (edge->IsControlEdge()) {
+      continue;
+    }
+    const auto dst_it = partition_ids.find(edge->dst()->name());
+    if (dst_it == partition_ids.end()) {
+      continue;
+    }
+    const auto src_it = partition_ids.find(edge->src()->name());
+    if (src_it == partition_ids.end() ? edge->src()->num_outputs() == 1
+                                      : src_it->second == dst_it->second) {
+      continue;
+    }
+    forwarded_edges.emplace_back(edge);
+  }
+
+  // One identity node per forwarded output, shared by all of its consumers.
+  std::map<std::pair<string, int>, Node*> identity_nodes;
+  for (const Edge* edge : forwarded_edges) {
+    Node* src_node = edge->src();
+    Node* dst_node = edge->dst();
+    const int src_port = edge->src_output();
+    const int dst_port = edge->dst_input();
+    Node*& identity_node =
+        identity_nodes[std::make_pair(src_node->name(), src_port)];
+    if (identity_node == nullptr) {
+      TF_RETURN_IF_ERROR(BuildIdentityOpNode(
+          strings::StrCat(src_node->name(), "/remote_fused_graph_input_",
+                          src_port),
+          src_node->name(), src_port, src_node->output_type(src_port), &graph,
+          &identity_node));
+      std::vector<DataType> data_types;
+      std::vector<TensorShape> shapes;
+      if (GetOutputTensorShapeType(src_node->attrs(), &data_types, &shapes)
+              .ok() &&
+          src_port < data_types.size()) {
+        identity_node->AddAttr(ATTR_OUTPUT_DATA_TYPES,
+                               DataTypeVector{data_types.at(src_port)});
+        identity_node->AddAttr(ATTR_OUTPUT_SHAPES,
+                               std::vector<TensorShape>{shapes.at(src_port)});
+      }
+    }
+    graph.RemoveEdge(edge);
+    graph.AddEdge(identity_node, 0, dst_node, dst_port);
+  }
+
+  graph_def->Clear();
+  graph.ToGraphDef(graph_def);
+  return Status::OK();
+}
+
+/* static */ Status RemoteFusedGraphExecuteUtils::FusePartitions(
+    const GraphDef& input_graph_def, const std::vector<string>& inputs,
+    const std::vector<string>& outputs,
+    const string& remote_fused_graph_node_name_prefix,
+    const std::vector<std::unordered_set<string>>& partitions,
+    const string& remote_fused_graph_executor_name,
+    const bool require_shape_type, GraphDef* output_graph_def) {
+  GraphDef graph_def = input_graph_def;
+  int fused_node_count = 0;
+  for (const std::unordered_set<string>& partition : partitions) {
+    // Nodes which no output depends on are stripped by fusing other
+    // partitions.
+    std::unordered_set<string> node_names;
+    for (const NodeDef& node_def : graph_def.node()) {
+      if (partition.count(node_def.name()) > 0) {
+        node_names.emplace(node_def.name());
+      }
+    }
+    if (node_names.empty()) {
+      continue;
+    }
+    std::vector<ClusterInfo> ci_vec;
+    TF_RETURN_IF_ERROR(ClusterizeNodes(node_names, graph_def, &ci_vec));
+    for (const ClusterInfo& ci : ci_vec) {
+      const string remote_fused_graph_node_name = strings::StrCat(
+          remote_fused_graph_node_name_prefix, "/", fused_node_count);
+      ++fused_node_count;
+      GraphDef fused_graph_def;
+      TF_RETURN_IF_ERROR(FuseCluster(graph_def, inputs, outputs,
+                                     remote_fused_graph_node_name, ci,
+                                     remote_fused_graph_executor_name,
+                                     require_shape_type, &fused_graph_def));
+      graph_def.Swap(&fused_graph_def);
+    }
+  }
+  *output_graph_def = graph_def;
+  return Status::OK();
+}
+
 /* static */ Status RemoteFusedGraphExecuteUtils::ReplaceInputNodeByPlaceHolder(
     const string& input, const DataType type, const TensorShape& shape,
     GraphDef* graph_def) {
@@ -220,6 +220,27 @@ class RemoteFusedGraphExecuteUtils {
       const string& remote_fused_graph_executor_name,
       const bool require_shape_type, GraphDef* output_graph_def);
 
+  // Split given nodes into partitions that can each be fused into one
+  // RemoteFusedGraphExecuteOp node.  No path between two nodes of a
+  // partition goes through a node outside of it, so fusing partitions
+  // never creates a cycle.  Nodes without inputs, e.g. Const, join the
+  // partition of their consumers if all of them are in the same one.
+  static Status PartitionNodes(
+      const std::unordered_set<string>& node_names, const GraphDef& graph_def,
+      std::vector<std::unordered_set<string>>* partitions);
+
+  // Fuse each of given partitions into its own RemoteFusedGraphExecuteOp
+  // node.  Nodes outside of the partitions are left as they are.
+  // CAVEAT: Partitions must not create a cycle, e.g. ones obtained by
+  // PartitionNodes.
+  static Status FuseRemoteGraphByPartitions(
+      const GraphDef& input_graph_def, const std::vector<string>& inputs,
+      const std::vector<string>& outputs,
+      const string& remote_fused_graph_node_name_prefix,
+      const std::vector<std::unordered_set<string>>& partitions,
+      const string& remote_fused_graph_executor_name,
+      const bool require_shape_type, GraphDef* output_graph_def);
+
   // Fuse subgraph of specified border
   static Status FuseRemoteGraphByBorder(
       const GraphDef& input_graph_def, const std::vector<string>& inputs,
@@ -253,6 +274,24 @@ class RemoteFusedGraphExecuteUtils {
   static void EmplaceTensorShapeType(const string& name, const Tensor& tensor,
                                      TensorShapeMap* tensor_shape_map);
 
+  // Insert identity nodes between partitions, and after nodes with multiple
+  // outputs feeding a partition, so that every border input of a partition
+  // is a single output node outside of all partitions.
+  static Status ForwardPartitionInputs(
+      const std::vector<std::unordered_set<string>>& partitions,
+      GraphDef* graph_def);
+
+  // Fuse partitions one by one.  Each partition must be fused from the
+  // graph in which the previous ones have been fused, because their border
+  // nodes are replaced.
+  static Status FusePartitions(
+      const GraphDef& input_graph_def, const std::vector<string>& inputs,
+      const std::vector<string>& outputs,
+      const string& remote_fused_graph_node_name_prefix,
+      const std::vector<std::unordered_set<string>>& partitions,
+      const string& remote_fused_graph_executor_name,
+      const bool require_shape_type, GraphDef* output_graph_def);
+
   static Status ReplaceInputNodeByPlaceHolder(const string& input,
                                               const DataType type,
                                               const TensorShape& shape,
@@ -79,6 +79,21 @@ class FuseRemoteGraphMultipleAddOpsTest : public ::testing::Test {
         /*require_shape_type=*/false, &result_graph_def_);
   }
 
+  Status FuseByPartitions() {
+    GraphDef graph_def_with_shapetype = graph_def_;
+    TF_RETURN_IF_ERROR(RemoteFusedGraphExecuteUtils::BuildAndAddTensorShapes(
+        input_tensors_, /*dry_run_inference*/ true, &graph_def_with_shapetype));
+
+    std::vector<std::unordered_set<string>> partitions;
+    TF_RETURN_IF_ERROR(RemoteFusedGraphExecuteUtils::PartitionNodes(
+        subgraph_node_names_, graph_def_with_shapetype, &partitions));
+    return RemoteFusedGraphExecuteUtils::FuseRemoteGraphByPartitions(
+        graph_def_with_shapetype, inputs_, outputs_,
+        "remote_fused_graph_node_names", partitions,
+        "remote_graph_executor_name",
+        /*require_shape_type=*/true, &result_graph_def_);
+  }
+
   Status BuildAndAddTensorShape() {
     return RemoteFusedGraphExecuteUtils::BuildAndAddTensorShapes(
         input_tensors_, /*dry_run_inference=*/true, &graph_def_);
@@ -485,6 +500,35 @@ TEST(RemoteFusedGraphExecuteUtils, ClusterizeNodes) {
   ASSERT_EQ(2, ci_vec.size());
 }
 
+TEST(RemoteFusedGraphExecuteUtils, PartitionNodes) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(
+      RemoteFusedGraphExecuteOpTestUtils::BuildMultipleAddGraph(&graph_def));
+
+  std::vector<std::unordered_set<string>> partitions;
+  TF_ASSERT_OK(RemoteFusedGraphExecuteUtils::PartitionNodes(
+      {"A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K"}, graph_def,
+      &partitions));
+  ASSERT_EQ(1, partitions.size());
+  EXPECT_EQ(11, partitions.at(0).size()) << IterToString(partitions.at(0));
+
+  // Without "I", "J" and "K" can't be fused with "G", because "G" -> "I" ->
+  // "J" would leave the fused node and come back.  "C" is also used by "I",
+  // so it's left out.
+  partitions.clear();
+  TF_ASSERT_OK(RemoteFusedGraphExecuteUtils::PartitionNodes(
+      {"A", "B", "C", "D", "E", "F", "G", "H", "J", "K"}, graph_def,
+      &partitions));
+  ASSERT_EQ(3, partitions.size());
+  std::set<std::set<string>> partition_set;
+  for (const std::unordered_set<string>& partition : partitions) {
+    partition_set.emplace(partition.begin(), partition.end());
+  }
+  EXPECT_EQ(1, partition_set.count({"A", "B", "F", "H"}));
+  EXPECT_EQ(1, partition_set.count({"D", "E", "G"}));
+  EXPECT_EQ(1, partition_set.count({"J", "K"}));
+}
+
 TEST(RemoteFusedGraphExecuteUtils, BuildSubgraphDefByInOut) {
   GraphDef graph_def;
   TF_ASSERT_OK(
@@ -649,6 +693,20 @@ TEST_F(FuseRemoteGraphMultipleAddOpsTest, FuseSubgraphByNodes_ABCDEFGHIJK) {
       << SummarizeGraphDef(result_graph_def_);
 }
 
+TEST_F(FuseRemoteGraphMultipleAddOpsTest, FuseSubgraphByPartitions) {
+  subgraph_node_names_ = {"A", "B", "C", "D", "E", "F", "G", "H", "J", "K"};
+
+  TF_ASSERT_OK(FuseByPartitions());
+
+  EXPECT_EQ(11, graph_def_.node_size());
+  // "A", "C", "I", "K", three RFGs and two identities forwarding "G" and "H"
+  // to the RFG of "J" and "K".
+  EXPECT_EQ(9, result_graph_def_.node_size())
+      << "=== Before: \n"
+      << SummarizeGraphDef(graph_def_) << "\n\n\n=== After: \n"
+      << SummarizeGraphDef(result_graph_def_);
+}
+
 TEST_F(FuseRemoteGraphMultipleAddOpsTest, PlaceAndFuse_H) {
   subgraph_node_names_ = {"H"};
 
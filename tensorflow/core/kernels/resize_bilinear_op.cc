@@ -100,16 +100,53 @@ inline float compute_lerp(const float top_left, const float top_right,
   return top + (bottom - top) * y_lerp;
 }
 
+// Interpolates the input row 'in_row' along x: out[x * channels + c] is the
+// lerp of the two input pixels around x. These are the "top" and "bottom"
+// values of output rows whose lower or upper source row is 'in_row'.
+template <typename T>
+void interpolate_row(const T* in_row, const int64 out_width,
+                     const int channels, const CachedInterpolation* xs,
+                     float* out) {
+  if (channels == 3) {
+    for (int64 x = 0; x < out_width; ++x) {
+      const int64 xs_lower = xs[x].lower;
+      const int64 xs_upper = xs[x].upper;
+      const float xs_lerp = xs[x].lerp;
+      const float left0(in_row[xs_lower + 0]);
+      const float right0(in_row[xs_upper + 0]);
+      const float left1(in_row[xs_lower + 1]);
+      const float right1(in_row[xs_upper + 1]);
+      const float left2(in_row[xs_lower + 2]);
+      const float right2(in_row[xs_upper + 2]);
+      out[x * 3 + 0] = left0 + (right0 - left0) * xs_lerp;
+      out[x * 3 + 1] = left1 + (right1 - left1) * xs_lerp;
+      out[x * 3 + 2] = left2 + (right2 - left2) * xs_lerp;
+    }
+  } else {
+    for (int64 x = 0; x < out_width; ++x) {
+      const int64 xs_lower = xs[x].lower;
+      const int64 xs_upper = xs[x].upper;
+      const float xs_lerp = xs[x].lerp;
+      for (int c = 0; c < channels; ++c) {
+        const float left(in_row[xs_lower + c]);
+        const float right(in_row[xs_upper + c]);
+        out[x * channels + c] = left + (right - left) * xs_lerp;
+      }
+    }
+  }
+}
+
 template <typename T>
 void resize_image(
-    typename TTypes<T, 4>::ConstTensor images, const int batch_size,
-    const int64 in_height, const int64 in_width, const int64 out_height,
-    const int64 out_width, const int channels,
+    const CPUDevice& d, typename TTypes<T, 4>::ConstTensor images,
+    const int batch_size, const int64 in_height, const int64 in_width,
+    const int64 out_height, const int64 out_width, const int channels,
     const std::vector<CachedInterpolation>& xs,
     const std::vector<CachedInterpolation>& ys,
     typename TTypes<float, 4>::Tensor output) TF_ATTRIBUTE_NOINLINE;
 template <typename T>
-void resize_image(typename TTypes<T, 4>::ConstTensor images,
+void resize_image(const CPUDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
                   const int batch_size, const int64 in_height,
                   const int64 in_width, const int64 out_height,
                   const int64 out_width, const int channels,
@@ -117,83 +154,54 @@ void resize_image(typename TTypes<T, 4>::ConstTensor images,
                   const std::vector<CachedInterpolation>& ys,
                   typename TTypes<float, 4>::Tensor output) {
   const int64 in_row_size = in_width * channels;
-  const int64 in_batch_num_values = in_height * in_row_size;
   const int64 out_row_size = out_width * channels;
 
-  const T* input_b_ptr = images.data();
   const CachedInterpolation* xs = xs_vec.data();
 
-  if (channels == 3) {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64 y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-        const float ys_lerp = ys[y].lerp;
-        for (int64 x = 0; x < out_width; ++x) {
-          const int64 xs_lower = xs[x].lower;
-          const int64 xs_upper = xs[x].upper;
-          const float xs_lerp = xs[x].lerp;
-
-          // Read channel 0.
-          const float top_left0(ys_input_lower_ptr[xs_lower + 0]);
-          const float top_right0(ys_input_lower_ptr[xs_upper + 0]);
-          const float bottom_left0(ys_input_upper_ptr[xs_lower + 0]);
-          const float bottom_right0(ys_input_upper_ptr[xs_upper + 0]);
-
-          // Read channel 1.
-          const float top_left1(ys_input_lower_ptr[xs_lower + 1]);
-          const float top_right1(ys_input_lower_ptr[xs_upper + 1]);
-          const float bottom_left1(ys_input_upper_ptr[xs_lower + 1]);
-          const float bottom_right1(ys_input_upper_ptr[xs_upper + 1]);
-
-          // Read channel 2.
-          const float top_left2(ys_input_lower_ptr[xs_lower + 2]);
-          const float top_right2(ys_input_lower_ptr[xs_upper + 2]);
-          const float bottom_left2(ys_input_upper_ptr[xs_lower + 2]);
-          const float bottom_right2(ys_input_upper_ptr[xs_upper + 2]);
-
-          // Compute output.
-          output_y_ptr[x * channels + 0] =
-              compute_lerp(top_left0, top_right0, bottom_left0, bottom_right0,
-                           xs_lerp, ys_lerp);
-          output_y_ptr[x * channels + 1] =
-              compute_lerp(top_left1, top_right1, bottom_left1, bottom_right1,
-                           xs_lerp, ys_lerp);
-          output_y_ptr[x * channels + 2] =
-              compute_lerp(top_left2, top_right2, bottom_left2, bottom_right2,
-                           xs_lerp, ys_lerp);
-        }
-        output_y_ptr += out_row_size;
-      }
-      input_b_ptr += in_batch_num_values;
-    }
-  } else {
-    float* output_y_ptr = output.data();
-    for (int b = 0; b < batch_size; ++b) {
-      for (int64 y = 0; y < out_height; ++y) {
-        const T* ys_input_lower_ptr = input_b_ptr + ys[y].lower * in_row_size;
-        const T* ys_input_upper_ptr = input_b_ptr + ys[y].upper * in_row_size;
-        const float ys_lerp = ys[y].lerp;
-        for (int64 x = 0; x < out_width; ++x) {
-          auto xs_lower = xs[x].lower;
-          auto xs_upper = xs[x].upper;
-          auto xs_lerp = xs[x].lerp;
-          for (int c = 0; c < channels; ++c) {
-            const float top_left(ys_input_lower_ptr[xs_lower + c]);
-            const float top_right(ys_input_lower_ptr[xs_upper + c]);
-            const float bottom_left(ys_input_upper_ptr[xs_lower + c]);
-            const float bottom_right(ys_input_upper_ptr[xs_upper + c]);
-            output_y_ptr[x * channels + c] =
-                compute_lerp(top_left, top_right, bottom_left, bottom_right,
-                             xs_lerp, ys_lerp);
-          }
-        }
-        output_y_ptr += out_row_size;
+  // The output is computed as the lerp along y of two input rows that were
+  // first interpolated along x. That takes the same operations in the same
+  // order as interpolating every output pixel from its four input pixels,
+  // but the rows interpolated along x are shared by consecutive output rows,
+  // and the lerp along y runs over contiguous rows, where it vectorizes. The
+  // output rows of all images are sharded over the threads.
+  auto resize_rows = [&](int64 begin, int64 end) {
+    // The last two input rows interpolated along x, by index in the batch.
+    std::vector<float> buffer(2 * out_row_size);
+    float* rows[2] = {buffer.data(), buffer.data() + out_row_size};
+    int64 row_indices[2] = {-1, -1};
+    auto get_row = [&](int64 row_index, int keep) {
+      for (int i = 0; i < 2; ++i) {
+        if (row_indices[i] == row_index) return i;
       }
-      input_b_ptr += in_batch_num_values;
+      const int i = 1 - keep;
+      interpolate_row<T>(images.data() + row_index * in_row_size, out_width,
+                         channels, xs, rows[i]);
+      row_indices[i] = row_index;
+      return i;
+    };
+
+    for (int64 i = begin; i < end; ++i) {
+      const int64 b = i / out_height;
+      const int64 y = i % out_height;
+      const int64 lower = b * in_height + ys[y].lower;
+      const int64 upper = b * in_height + ys[y].upper;
+      // Keep the row for 'upper' while fetching the row for 'lower'.
+      const int top = get_row(lower, row_indices[0] == upper ? 0 : 1);
+      const int bottom = get_row(upper, top);
+      typename TTypes<float>::UnalignedConstVec top_row(rows[top],
+                                                        out_row_size);
+      typename TTypes<float>::UnalignedConstVec bottom_row(rows[bottom],
+                                                           out_row_size);
+      typename TTypes<float>::UnalignedVec output_row(
+          output.data() + i * out_row_size, out_row_size);
+      output_row = top_row + (bottom_row - top_row) * ys[y].lerp;
     }
-  }
+  };
+  // Every output row reads up to two input rows and interpolates them.
+  const Eigen::TensorOpCost cost(2 * in_row_size * sizeof(T),
+                                 out_row_size * sizeof(float),
+                                 out_row_size * 9);
+  d.parallelFor(batch_size * out_height, cost, resize_rows);
 }
 
 }  // namespace
@@ -215,7 +223,7 @@ struct ResizeBilinear<CPUDevice, T> {
 
     // Handle no-op resizes efficiently.
     if (out_height == in_height && out_width == in_width) {
-      output = images.template cast<float>();
+      output.device(d) = images.template cast<float>();
       return;
     }
 
@@ -233,7 +241,7 @@ struct ResizeBilinear<CPUDevice, T> {
       xs[i].upper *= channels;
     }
 
-    resize_image<T>(images, batch_size, in_height, in_width, out_height,
+    resize_image<T>(d, images, batch_size, in_height, in_width, out_height,
                     out_width, channels, xs, ys, output);
   }
 };
@@ -374,6 +374,7 @@ class ResourceGatherOp : public OpKernel {
 // Registration of the CPU implementations.
 TF_CALL_ALL_TYPES(REGISTER_GATHER_CPU);
 TF_CALL_QUANTIZED_TYPES(REGISTER_GATHER_CPU);
+TF_CALL_bfloat16(REGISTER_GATHER_CPU);
 
 #undef REGISTER_GATHER_CPU
 #undef REGISTER_GATHER_ALL_INDICES
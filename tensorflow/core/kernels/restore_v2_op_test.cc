@@ -48,15 +48,23 @@ class RestoreV2OpTest : public OpsTestBase {
  protected:
   // Makes an operation to restore two tensors
   void MakeRestoreOp(DataType dt) {
-    TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
-                     .Input(FakeInput())    // prefix
-                     .Input(FakeInput())    // tensor_names
-                     .Input(FakeInput())    // shape_and_slices
-                     .Attr("dtypes", {dt})  // dtypes
-                     .Finalize(node_def()));
+    NodeDefBuilder builder("myop", "RestoreV2");
+    builder.Input(FakeInput())  // prefix
+        .Input(FakeInput())     // tensor_names
+        .Input(FakeInput())     // shape_and_slices
+        .Attr("dtypes", {dt});  // dtypes
+    if (!restore_label_.empty()) {
+      builder.Attr("_kernel", restore_label_);
+    }
+    TF_ASSERT_OK(builder.Finalize(node_def()));
     TF_ASSERT_OK(InitOp());
   }
 
+  // The kernel label of the restore op.
+  string restore_label_;
+  // The data_alignment attr of the SaveV2 op.
+  int save_data_alignment_ = 1;
+
   void RunTest(StringPiece save_op_to_use) {
     const string filename =
         io::JoinPath(testing::TmpDir(), "tensor_simple-", save_op_to_use);
@@ -70,15 +78,17 @@ class RestoreV2OpTest : public OpsTestBase {
       // Initialize an operation.
       NodeDef save;
       if (save_op_to_use != "Save") {
-        TF_ASSERT_OK(
-            NodeDefBuilder("myop", save_op_to_use)
-                .Input(FakeInput())  // prefix
-                .Input(FakeInput())  // tensor_names
-                .Input(FakeInput())  // shape_and_slices
-                .Input(FakeInput({DT_BOOL, DT_INT32, DT_FLOAT, DT_DOUBLE,
-                                  DT_QINT8, DT_QINT32, DT_UINT8, DT_INT8,
-                                  DT_INT16, DT_COMPLEX64, DT_HALF}))  // tensors
-                .Finalize(&save));
+        NodeDefBuilder builder("myop", save_op_to_use);
+        builder.Input(FakeInput())  // prefix
+            .Input(FakeInput())     // tensor_names
+            .Input(FakeInput())     // shape_and_slices
+            .Input(FakeInput({DT_BOOL, DT_INT32, DT_FLOAT, DT_DOUBLE,
+                              DT_QINT8, DT_QINT32, DT_UINT8, DT_INT8,
+                              DT_INT16, DT_COMPLEX64, DT_HALF}));  // tensors
+        if (save_data_alignment_ != 1) {
+          builder.Attr("data_alignment", save_data_alignment_);
+        }
+        TF_ASSERT_OK(builder.Finalize(&save));
       } else {
         TF_ASSERT_OK(
             NodeDefBuilder("myop", save_op_to_use)
@@ -352,6 +362,12 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 // For backward compatibility.
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
+// The tensors alias the mapped data file, in which the data is aligned.
+TEST_F(RestoreV2OpTest, MappedRestoreAfterSaveV2) {
+  save_data_alignment_ = 64;
+  restore_label_ = "mmap";
+  RunTest("SaveV2");
+}
 
 }  // namespace
 }  // namespace tensorflow
@@ -234,17 +234,21 @@ void RestoreTensor(OpKernelContext* context,
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes, bool use_mmap) {
   const string& prefix_string = prefix.scalar<string>()();
   const auto& tensor_names_flat = tensor_names.flat<string>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
 
-  BundleReader reader(Env::Default(), prefix_string);
+  BundleReader::Options options;
+  options.use_mmap = use_mmap;
+  BundleReader reader(Env::Default(), prefix_string, options);
   TF_RETURN_IF_ERROR(reader.status());
 
   // TODO(zongheng): potential optimization: one Seek() in first lookup.
-  // TODO(zongheng): consider measuring speed and issuing concurrent lookups
-  // within a fixed memory budget.
+  // The full tensors are restored together at the end, so that they are read
+  // concurrently.
+  std::vector<string> full_tensor_names;
+  std::vector<Tensor*> full_tensors;
   TensorShape restored_full_shape;
   Tensor* restored_tensor = nullptr;
   for (size_t i = 0; i < tensor_names_flat.size(); ++i) {
@@ -257,7 +261,15 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(i, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+      if (use_mmap) {
+        // A mapped lookup doesn't wait on reads, and an output that aliases
+        // the mapping frees its allocation right away rather than once all
+        // the outputs are allocated.
+        TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+      } else {
+        full_tensor_names.push_back(tensor_name);
+        full_tensors.push_back(restored_tensor);
+      }
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
@@ -287,7 +299,7 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
           DataTypeString(restored_tensor->dtype()));
     }
   }
-  return Status::OK();
+  return reader.LookupMany(full_tensor_names, full_tensors);
 }
 
 }  // namespace tensorflow
@@ -56,6 +56,9 @@ void RestoreTensor(OpKernelContext* context,
 //
 // "context" is only used for allocating outputs.  In particular, the inputs are
 // explicitly provided and not accessed via the "input(i)" methods.
+// With "use_mmap", the data files are mapped in memory and the full tensors
+// whose data is aligned in them alias the read-only mapping, as described by
+// BundleReader::Options::use_mmap.
 // REQUIRES:
 //   * "prefix" has 1 element, DT_STRING.
 //   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
@@ -63,7 +66,8 @@ void RestoreTensor(OpKernelContext* context,
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes);
+                        gtl::ArraySlice<DataType> dtypes,
+                        bool use_mmap = false);
 
 }  // namespace tensorflow
 
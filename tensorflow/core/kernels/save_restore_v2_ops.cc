@@ -15,23 +15,31 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -85,12 +93,178 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// The number of data files SaveV2 writes concurrently, for the tensors of
+// "total_bytes" bytes.  At most "max_num_shards", with no shard under
+// kMinShardBytes so that small checkpoints stay in a single file.
+int SaveV2NumShards(int64 total_bytes, int max_num_shards) {
+  const int64 kMinShardBytes = 32 << 20;
+  return static_cast<int>(std::max<int64>(
+      1, std::min<int64>(max_num_shards, total_bytes / kMinShardBytes)));
+}
+
+// A tensor to save, in full or as a slice of a full tensor.
+struct TensorToSave {
+  string name;
+  Tensor tensor;
+  bool is_slice = false;
+  TensorShape full_shape;
+  TensorSlice slice;
+};
+
+// Writes "tensors" to the V2 checkpoint "prefix", with "writer_options" but
+// with no more shards than SaveV2NumShards() allows.
+Status WriteTensors(const string& prefix,
+                    const std::vector<TensorToSave>& tensors,
+                    const BundleWriter::Options& writer_options) {
+  int64 total_bytes = 0;
+  for (const TensorToSave& to_save : tensors) {
+    total_bytes += to_save.tensor.TotalBytes();
+  }
+  BundleWriter::Options options = writer_options;
+  options.num_shards = SaveV2NumShards(total_bytes, writer_options.num_shards);
+
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix
+          << ", num_shards: " << options.num_shards;
+
+  for (const TensorToSave& to_save : tensors) {
+    if (to_save.is_slice) {
+      TF_RETURN_IF_ERROR(writer.AddSlice(to_save.name, to_save.full_shape,
+                                         to_save.slice, to_save.tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(to_save.name, to_save.tensor));
+    }
+  }
+  return writer.Finish();
+}
+
+// Runs the asynchronous checkpoint writes of a resource manager, i.e. of a
+// device of a session, in the order in which they are scheduled, on one
+// background thread. The writes of other devices are not ordered with them.
+// The writes scheduled are finished on destruction.
+class AsyncSaveQueue : public ResourceBase {
+ public:
+  AsyncSaveQueue() {}
+
+  ~AsyncSaveQueue() override {
+    {
+      mutex_lock l(mu_);
+      stopping_ = true;
+      cond_.notify_all();
+    }
+    // Joins the thread once it has run the remaining writes.
+    thread_.reset();
+  }
+
+  string DebugString() override { return "AsyncSaveQueue"; }
+
+  // Schedules "write" after the writes scheduled before.
+  void Schedule(std::function<Status()> write) {
+    mutex_lock l(mu_);
+    if (thread_ == nullptr) {
+      thread_.reset(Env::Default()->StartThread(
+          ThreadOptions(), "async_save", [this]() { Run(); }));
+    }
+    writes_.push_back(std::move(write));
+    ++num_scheduled_;
+    cond_.notify_all();
+  }
+
+  // Waits for the writes scheduled before, and returns the first error of the
+  // writes done since the previous call.
+  Status Wait() {
+    mutex_lock l(mu_);
+    const int64 num_to_wait = num_scheduled_;
+    while (num_done_ < num_to_wait) {
+      cond_.wait(l);
+    }
+    Status status = status_;
+    status_ = Status::OK();
+    return status;
+  }
+
+ private:
+  void Run() {
+    while (true) {
+      std::function<Status()> write;
+      {
+        mutex_lock l(mu_);
+        while (writes_.empty() && !stopping_) {
+          cond_.wait(l);
+        }
+        if (writes_.empty()) return;
+        write = std::move(writes_.front());
+        writes_.pop_front();
+      }
+      const Status status = write();
+      if (!status.ok()) LOG(ERROR) << "Asynchronous save failed: " << status;
+      mutex_lock l(mu_);
+      status_.Update(status);
+      ++num_done_;
+      cond_.notify_all();
+    }
+  }
+
+  mutex mu_;
+  condition_variable cond_;
+  std::deque<std::function<Status()>> writes_ GUARDED_BY(mu_);
+  int64 num_scheduled_ GUARDED_BY(mu_) = 0;
+  int64 num_done_ GUARDED_BY(mu_) = 0;
+  // The first error since the last call to Wait().
+  Status status_ GUARDED_BY(mu_);
+  bool stopping_ GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncSaveQueue);
+};
+
+// Looks up the AsyncSaveQueue of the resource manager of "context", creating
+// it on first use. The caller owns a reference on "*queue".
+Status LookupAsyncSaveQueue(OpKernelContext* context, AsyncSaveQueue** queue) {
+  ResourceMgr* rm = context->resource_manager();
+  return rm->LookupOrCreate<AsyncSaveQueue>(
+      rm->default_container(), "_async_save_queue", queue,
+      [](AsyncSaveQueue** queue) {
+        *queue = new AsyncSaveQueue;
+        return Status::OK();
+      });
+}
+
+// Merges the V2 checkpoints "input_prefixes" into "merged_prefix".  If
+// "delete_old_dirs", attempts to delete the directories of the inputs.
+Status MergeCheckpoints(const std::vector<string>& input_prefixes,
+                        const string& merged_prefix, bool delete_old_dirs) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(
+      tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
+
+  if (delete_old_dirs) {
+    const string& merged_dir = io::Dirname(merged_prefix).ToString();
+    for (const string& input_prefix : input_prefixes) {
+      const string& dirname = io::Dirname(input_prefix).ToString();
+      if (dirname == merged_dir) continue;
+      Status status = env->DeleteDir(dirname);
+      // For sharded save, only the first delete will go through and all
+      // others will hit NotFound.  Use vlog to be less verbose.
+      if (!status.ok()) VLOG(1) << status;
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("async_write", &async_write_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_shards",
+                                             &writer_options_.num_shards));
+    OP_REQUIRES_OK(context, context->GetAttr("data_alignment",
+                                             &writer_options_.data_alignment));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -98,6 +272,7 @@ class SaveV2 : public OpKernel {
     const Tensor& shape_and_slices = context->input(2);
     ValidateInputs(true /* is save op */, context, prefix, tensor_names,
                    shape_and_slices);
+    if (!context->status().ok()) return;
 
     const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
     const int num_tensors = static_cast<int>(tensor_names.NumElements());
@@ -105,44 +280,73 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<string>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<TensorToSave> tensors(num_tensors);
+    int64 total_bytes = 0;
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      TensorToSave* to_save = &tensors[i];
+      to_save->name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
+      total_bytes += tensor.TotalBytes();
+      if (!async_write_) to_save->tensor = tensor;
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
         TensorShape slice_shape;
+        to_save->is_slice = true;
+        to_save->slice = TensorSlice(tensor.dims());
 
         OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
+                                    shape_spec, &to_save->full_shape,
+                                    &to_save->slice, &slice_shape));
         OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
       }
     }
-    OP_REQUIRES_OK(context, writer.Finish());
+    if (!async_write_) {
+      OP_REQUIRES_OK(context,
+                     WriteTensors(prefix_string, tensors, writer_options_));
+      return;
+    }
+
+    // Snapshots the tensors, which may be updated once the op returns.
+    const DeviceBase::CpuWorkerThreads* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_tensors,
+          total_bytes / std::max(1, num_tensors),
+          [context, &tensors](int64 start, int64 limit) {
+            for (int64 i = start; i < limit; ++i) {
+              tensors[i].tensor =
+                  tensor::DeepCopy(context->input(i + kFixedInputs));
+            }
+          });
+    AsyncSaveQueue* queue;
+    OP_REQUIRES_OK(context, LookupAsyncSaveQueue(context, &queue));
+    core::ScopedUnref unref(queue);
+    const BundleWriter::Options writer_options = writer_options_;
+    queue->Schedule([prefix_string, tensors, writer_options]() {
+      return WriteTensors(prefix_string, tensors, writer_options);
+    });
   }
+
+ private:
+  // Whether to write the checkpoint in the background.
+  bool async_write_;
+  BundleWriter::Options writer_options_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
  public:
-  explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
+  explicit RestoreV2(OpKernelConstruction* context)
+      : RestoreV2(context, false /* use_mmap */) {}
+
+  RestoreV2(OpKernelConstruction* context, bool use_mmap)
+      : OpKernel(context), use_mmap_(use_mmap) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
   }
 
@@ -174,16 +378,32 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, prefix, tensor_names,
+                                    shape_and_slices, dtypes_, use_mmap_));
   }
 
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  const bool use_mmap_;
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
+// With the "mmap" label, RestoreV2 maps the data files of V2 checkpoints in
+// memory, and the full tensors whose data is aligned in them alias the
+// read-only mapping.  The processes restoring the same checkpoint then share
+// one copy of these tensors in the page cache.  The restored values, and the
+// variables they are assigned to, must never be written, e.g. those of a model
+// loaded only for inference.
+class MappedRestoreV2 : public RestoreV2 {
+ public:
+  explicit MappedRestoreV2(OpKernelConstruction* context)
+      : RestoreV2(context, true /* use_mmap */) {}
+};
+REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU).Label("mmap"),
+                        MappedRestoreV2);
+
 // The final step in saving sharded V2 checkpoints: merges metadata files.
 class MergeV2Checkpoints : public OpKernel {
  public:
@@ -191,6 +411,7 @@ class MergeV2Checkpoints : public OpKernel {
       : OpKernel(context) {
     OP_REQUIRES_OK(context,
                    context->GetAttr("delete_old_dirs", &delete_old_dirs_));
+    OP_REQUIRES_OK(context, context->GetAttr("async_write", &async_write_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -206,31 +427,50 @@ class MergeV2Checkpoints : public OpKernel {
                     "Input destination_prefix should be a scalar tensor, got ",
                     destination_prefix.shape().DebugString(), " instead."));
 
-    const gtl::ArraySlice<string> input_prefixes =
-        gtl::ArraySlice<string>(checkpoint_prefixes.flat<string>());
-    Env* env = Env::Default();
+    const auto& input_prefixes_flat = checkpoint_prefixes.flat<string>();
+    const std::vector<string> input_prefixes(
+        input_prefixes_flat.data(),
+        input_prefixes_flat.data() + input_prefixes_flat.size());
     const string& merged_prefix = destination_prefix.scalar<string>()();
-    OP_REQUIRES_OK(
-        context, tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
-
-    if (delete_old_dirs_) {
-      const string& merged_dir = io::Dirname(merged_prefix).ToString();
-      for (const string& input_prefix : input_prefixes) {
-        const string& dirname = io::Dirname(input_prefix).ToString();
-        if (dirname == merged_dir) continue;
-        Status status = env->DeleteDir(dirname);
-        // For sharded save, only the first delete will go through and all
-        // others will hit NotFound.  Use vlog to be less verbose.
-        if (!status.ok()) VLOG(1) << status;
-      }
+    if (!async_write_) {
+      OP_REQUIRES_OK(context, MergeCheckpoints(input_prefixes, merged_prefix,
+                                               delete_old_dirs_));
+      return;
     }
+    AsyncSaveQueue* queue;
+    OP_REQUIRES_OK(context, LookupAsyncSaveQueue(context, &queue));
+    core::ScopedUnref unref(queue);
+    const bool delete_old_dirs = delete_old_dirs_;
+    queue->Schedule(
+        [input_prefixes, merged_prefix, delete_old_dirs]() {
+          return MergeCheckpoints(input_prefixes, merged_prefix,
+                                  delete_old_dirs);
+        });
   }
 
  private:
   // On merge, whether or not to delete the input (temporary) directories.
   bool delete_old_dirs_;
+  // Whether to merge in the background.
+  bool async_write_;
 };
 REGISTER_KERNEL_BUILDER(Name("MergeV2Checkpoints").Device(DEVICE_CPU),
                         MergeV2Checkpoints);
 
+// Waits for the asynchronous writes of SaveV2 and MergeV2Checkpoints.
+class WaitForAsyncSaves : public OpKernel {
+ public:
+  explicit WaitForAsyncSaves(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    AsyncSaveQueue* queue;
+    OP_REQUIRES_OK(context, LookupAsyncSaveQueue(context, &queue));
+    core::ScopedUnref unref(queue);
+    OP_REQUIRES_OK(context, queue->Wait());
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("WaitForAsyncSaves").Device(DEVICE_CPU),
+                        WaitForAsyncSaves);
+
 }  // namespace tensorflow
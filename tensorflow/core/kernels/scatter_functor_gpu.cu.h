@@ -20,7 +20,11 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <type_traits>
+
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/group_by_index.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/cuda_kernel_helper.h"
@@ -68,6 +72,45 @@ __global__ void ScatterOpCustomKernel(
   }
 }
 
+// Alternative to ScatterOpCustomKernel for the ADD and SUB of indices that
+// repeat a lot: it processes the 'params_size' elements of 'params', sums
+// the updates that functor::GroupByIndex grouped under each row into a
+// register, and updates each element of the rows that are indexed once,
+// instead of with one atomic operation per update.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+__global__ void ScatterOpGroupedKernel(T* params, const T* updates,
+                                       const int32* row_counts,
+                                       const int32* row_starts,
+                                       const int32* positions,
+                                       Index params_size, Index update_block) {
+  CUDA_1D_KERNEL_LOOP(params_i, params_size) {
+    const int param_first_index = params_i / update_block;
+    const int32 count = ldg(row_counts + param_first_index);
+    if (count == 0) {
+      continue;
+    }
+    const int32 start = ldg(row_starts + param_first_index);
+    const int update_offset = params_i % update_block;
+    T sum = T(0);
+    for (int32 i = start; i < start + count; ++i) {
+      const Index indices_i = ldg(positions + i);
+      sum += ldg(updates + indices_i * update_block + update_offset);
+    }
+    switch (op) {
+      case scatter_op::UpdateOp::ADD: {
+        params[params_i] += sum;
+        break;
+      }
+      case scatter_op::UpdateOp::SUB: {
+        params[params_i] -= sum;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
 namespace functor {
 // Specialization for a GPU device.
 template <typename T, typename Index, scatter_op::UpdateOp op>
@@ -82,6 +125,27 @@ struct ScatterFunctor<GPUDevice, T, Index, op> {
     const Index first_dim_size = params.dimension(0);
     const Index indices_size = indices.size();
     const Index updates_size = updates.size();
+    if ((op == scatter_op::UpdateOp::ADD || op == scatter_op::UpdateOp::SUB) &&
+        indices_size > 0 &&
+        ShouldGroupByIndex(indices_size, first_dim_size,
+                           updates_size / indices_size,
+                           std::is_same<T, Eigen::half>::value)) {
+      Tensor row_counts, row_starts, positions;
+      Status s = GroupByIndex<GPUDevice, Index>()(
+          c, d, indices, first_dim_size, &row_counts, &row_starts, &positions);
+      if (!s.ok()) {
+        c->SetStatus(s);
+        return -1;
+      }
+      const Index params_size = params.size();
+      CudaLaunchConfig config = GetCudaLaunchConfig(params_size, d);
+      ScatterOpGroupedKernel<T, Index, op>
+          <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+              params.data(), updates.data(), row_counts.flat<int32>().data(),
+              row_starts.flat<int32>().data(), positions.flat<int32>().data(),
+              params_size, updates_size / indices_size);
+      return -1;
+    }
     CudaLaunchConfig config = GetCudaLaunchConfig(updates_size, d);
     ScatterOpCustomKernel<T, Index, op>
         <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
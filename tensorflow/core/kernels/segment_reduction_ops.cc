@@ -18,6 +18,8 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -229,8 +232,58 @@ REGISTER_COMPLEX_CPU_KERNELS_ALL(complex128);
 
 namespace functor {
 
+// Calls "reduce(j, i)" for each input row "i" of output row "j =
+// segment_ids(i)", splitting the output rows among the threads of the CPU
+// device of "ctx". The input rows of each output row are visited in their
+// order, so the result is the same as that of a single loop over them, no
+// matter how many threads there are. "row_cost" is the cost of one call.
+template <typename Index, typename Reducer>
+static void ParallelReduceUnsortedSegments(
+    OpKernelContext* ctx, const Index output_rows,
+    const TensorShape& segment_ids_shape,
+    typename TTypes<Index>::ConstFlat segment_ids, const int64 row_cost,
+    Reducer reduce) {
+  const int64 N = segment_ids.dimension(0);
+  // Groups the input rows by output row with a counting sort, which also
+  // checks the segment ids, before any thread starts.
+  std::vector<Index> ids(N);
+  std::vector<int64> row_start(output_rows + 1, 0);
+  for (int64 i = 0; i < N; ++i) {
+    Index j = internal::SubtleMustCopy(segment_ids(i));
+    OP_REQUIRES(ctx, FastBoundsCheck(j, output_rows),
+                errors::InvalidArgument(
+                    "segment_ids", SliceDebugString(segment_ids_shape, i),
+                    " = ", j, " is out of range [0, ", output_rows, ")"));
+    ids[i] = j;
+    ++row_start[j + 1];
+  }
+  for (Index j = 0; j < output_rows; ++j) {
+    row_start[j + 1] += row_start[j];
+  }
+  std::vector<int64> rows(N);
+  {
+    std::vector<int64> next(row_start.begin(), row_start.end() - 1);
+    for (int64 i = 0; i < N; ++i) {
+      rows[next[ids[i]]++] = i;
+    }
+  }
+
+  auto work = [&row_start, &rows, &reduce](int64 start, int64 limit) {
+    for (int64 j = start; j < limit; ++j) {
+      for (int64 k = row_start[j]; k < row_start[j + 1]; ++k) {
+        reduce(static_cast<Index>(j), rows[k]);
+      }
+    }
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  const int64 cost_per_output_row =
+      (N / std::max<int64>(output_rows, 1) + 1) * row_cost;
+  Shard(worker_threads.num_threads, worker_threads.workers, output_rows,
+        cost_per_output_row, work);
+}
+
 // UnsortedSegmentSumFunctor implementation for CPUDevice.
-// todo: Remove duplicate code in UnsortedSegmentSumFunctor and UnsortedSegmentMaxFunctor.
 template <typename T, typename Index>
 struct UnsortedSegmentSumFunctor<CPUDevice, T, Index>
     : UnsortedSegmentBaseFunctor<CPUDevice, T, Index> {
@@ -239,20 +292,17 @@ struct UnsortedSegmentSumFunctor<CPUDevice, T, Index>
                   typename TTypes<Index>::ConstFlat segment_ids,
                   const Index data_size, const T* data,
                   typename TTypes<T, 2>::Tensor output) override {
-    output.setZero();
+    output.device(d) = output.constant(T(0));
     if (data_size == 0) {
       return;
     }
     const int64 N = segment_ids.dimension(0);
     auto data_flat = typename TTypes<T, 2>::ConstTensor(data, N, data_size / N);
-    for (int64 i = 0; i < N; ++i) {
-      Index j = internal::SubtleMustCopy(segment_ids(i));
-      OP_REQUIRES(ctx, FastBoundsCheck(j, output_rows),
-                  errors::InvalidArgument(
-                      "segment_ids", SliceDebugString(segment_ids_shape, i),
-                      " = ", j, " is out of range [0, ", output_rows, ")"));
-      output.template chip<0>(j) += data_flat.template chip<0>(i);
-    }
+    ParallelReduceUnsortedSegments<Index>(
+        ctx, output_rows, segment_ids_shape, segment_ids, data_size / N,
+        [&output, &data_flat](Index j, int64 i) {
+          output.template chip<0>(j) += data_flat.template chip<0>(i);
+        });
   }
 };
 // UnsortedSegmentMaxFunctor implementation for CPUDevice.
@@ -264,21 +314,18 @@ struct UnsortedSegmentMaxFunctor<CPUDevice, T, Index>
                   typename TTypes<Index>::ConstFlat segment_ids,
                   const Index data_size, const T* data,
                   typename TTypes<T, 2>::Tensor output) override {
-    output.setConstant(std::numeric_limits<T>::lowest());
+    output.device(d) = output.constant(std::numeric_limits<T>::lowest());
     if (data_size == 0) {
       return;
     }
     const int64 N = segment_ids.dimension(0);
     auto data_flat = typename TTypes<T, 2>::ConstTensor(data, N, data_size / N);
-    for (int64 i = 0; i < N; ++i) {
-      Index j = internal::SubtleMustCopy(segment_ids(i));
-      OP_REQUIRES(ctx, FastBoundsCheck(j, output_rows),
-                  errors::InvalidArgument(
-                      "segment_ids", SliceDebugString(segment_ids_shape, i),
-                      " = ", j, " is out of range [0, ", output_rows, ")"));
-      output.template chip<0>(j) =
-          data_flat.template chip<0>(i).cwiseMax(output.template chip<0>(j));
-    }
+    ParallelReduceUnsortedSegments<Index>(
+        ctx, output_rows, segment_ids_shape, segment_ids, data_size / N,
+        [&output, &data_flat](Index j, int64 i) {
+          output.template chip<0>(j) = data_flat.template chip<0>(i).cwiseMax(
+              output.template chip<0>(j));
+        });
   }
 };
 }  // namespace functor
@@ -415,8 +462,9 @@ TF_CALL_complex128(REGISTER_GPU_UNSORTED_KERNELS_ALL);
 
 // Same as SegmentReductionOp but takes as input a "sparse" tensor, represented
 // by two dense tensors, one containing the data, and the other containing
-// indices into the data.
-template <typename Device, class T>
+// indices into the data. The rows of the data are read in place and added up
+// into their output rows, the segments split among the CPU worker threads.
+template <typename Device, class T, typename Index>
 class SparseSegmentReductionOpBase : public OpKernel {
  public:
   explicit SparseSegmentReductionOpBase(OpKernelConstruction* context,
@@ -468,12 +516,13 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
+    // Finds the segments first, so that they can be reduced in parallel.
+    std::vector<Segment> segments;
+    int64 start = 0;
     // Index from which the output is not initialized.
     OutputRow uninitialized_index = 0;
     OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    for (int64 end = 1; end <= num_indices; ++end) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
@@ -481,7 +530,6 @@ class SparseSegmentReductionOpBase : public OpKernel {
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
         if (out_index == next_index) {
-          ++end;
           continue;
         }
         // We have a new segment here.  Verify that the segment ids are growing.
@@ -505,25 +553,52 @@ class SparseSegmentReductionOpBase : public OpKernel {
         gap_slice.setConstant(default_value_);
       }
 
-      auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
-          Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset, "] == ",
-                      indices_vec(start + bad_offset), " out of range [0, ",
-                      input_flat.dimension(0), ")"));
-
-      if (end >= num_indices) break;
+      segments.push_back({out_index, start, end});
       start = end;
-      ++end;
       uninitialized_index = out_index + 1;
       out_index = next_index;
     }
+
+    // The position of the first index out of range, if any.
+    std::atomic<int64> bad_position(num_indices);
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const Segment& segment = segments[s];
+        auto out = output_flat.template chip<0>(segment.out_index);
+        const int64 bad_offset = Reduce(input_flat, indices_vec, segment.start,
+                                        segment.end - segment.start, out);
+        if (bad_offset >= 0) {
+          int64 bad = bad_position.load();
+          while (segment.start + bad_offset < bad &&
+                 !bad_position.compare_exchange_weak(
+                     bad, segment.start + bad_offset)) {
+          }
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    // Every segment loads its rows and adds them up.
+    const int64 cost_per_segment =
+        (num_indices / segments.size() + 1) * num_col * 2;
+    Shard(worker_threads.num_threads, worker_threads.workers, segments.size(),
+          cost_per_segment, reduce_segments);
+
+    const int64 bad = bad_position.load();
+    OP_REQUIRES(context, bad == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad, "] == ", indices_vec(bad),
+                    " out of range [0, ", input_flat.dimension(0), ")"));
   }
 
  private:
-  typedef int32 Index;
+  // The positions [start, end) of the indices added up into output row
+  // out_index.
+  struct Segment {
+    int32 out_index;
+    int64 start;
+    int64 end;
+  };
 
   int64 Reduce(const typename TTypes<T>::ConstMatrix& input_flat,
                const typename TTypes<Index>::ConstVec& indices_vec, int64 start,
@@ -657,64 +732,74 @@ class SparseSegmentReductionOpBase : public OpKernel {
   const T default_value_;
 };
 
-template <typename Device, class T>
+template <typename Device, class T, typename Index>
 class SparseSegmentReductionMeanOp
-    : public SparseSegmentReductionOpBase<Device, T> {
+    : public SparseSegmentReductionOpBase<Device, T, Index> {
  public:
   explicit SparseSegmentReductionMeanOp(OpKernelConstruction* context)
-      : SparseSegmentReductionOpBase<Device, T>(context, true /*is_mean*/,
-                                                false /*is_sqrtn*/,
-                                                T(0) /* default_value */) {}
+      : SparseSegmentReductionOpBase<Device, T, Index>(
+            context, true /*is_mean*/, false /*is_sqrtn*/,
+            T(0) /* default_value */) {}
 };
 
-template <typename Device, class T>
+template <typename Device, class T, typename Index>
 class SparseSegmentReductionSqrtNOp
-    : public SparseSegmentReductionOpBase<Device, T> {
+    : public SparseSegmentReductionOpBase<Device, T, Index> {
  public:
   explicit SparseSegmentReductionSqrtNOp(OpKernelConstruction* context)
-      : SparseSegmentReductionOpBase<Device, T>(context, false /*is_mean*/,
-                                                true /*is_sqrtn*/,
-                                                T(0) /* default_value */) {}
+      : SparseSegmentReductionOpBase<Device, T, Index>(
+            context, false /*is_mean*/, true /*is_sqrtn*/,
+            T(0) /* default_value */) {}
 };
 
-template <typename Device, class T>
+template <typename Device, class T, typename Index>
 class SparseSegmentReductionSumOp
-    : public SparseSegmentReductionOpBase<Device, T> {
+    : public SparseSegmentReductionOpBase<Device, T, Index> {
  public:
   explicit SparseSegmentReductionSumOp(OpKernelConstruction* context)
-      : SparseSegmentReductionOpBase<Device, T>(context, false /*is_mean*/,
-                                                false /*is_sqrtn*/,
-                                                T(0) /* default_value */) {}
+      : SparseSegmentReductionOpBase<Device, T, Index>(
+            context, false /*is_mean*/, false /*is_sqrtn*/,
+            T(0) /* default_value */) {}
 };
 
-#define REGISTER_CPU_SPARSE_KERNELS(type)                     \
-  REGISTER_KERNEL_BUILDER(Name("SparseSegmentSum")            \
-                              .Device(DEVICE_CPU)             \
-                              .TypeConstraint<type>("T")      \
-                              .TypeConstraint<int32>("Tidx"), \
-                          SparseSegmentReductionSumOp<CPUDevice, type>);
-
-TF_CALL_REAL_NUMBER_TYPES(REGISTER_CPU_SPARSE_KERNELS);
+#define REGISTER_CPU_SPARSE_KERNELS(type, index_type)                    \
+  REGISTER_KERNEL_BUILDER(Name("SparseSegmentSum")                       \
+                              .Device(DEVICE_CPU)                        \
+                              .TypeConstraint<type>("T")                 \
+                              .TypeConstraint<index_type>("Tidx"),       \
+                          SparseSegmentReductionSumOp<CPUDevice, type,   \
+                                                      index_type>);
+#define REGISTER_CPU_SPARSE_KERNELS_ALL(type) \
+  REGISTER_CPU_SPARSE_KERNELS(type, int32);   \
+  REGISTER_CPU_SPARSE_KERNELS(type, int64);
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_CPU_SPARSE_KERNELS_ALL);
+#undef REGISTER_CPU_SPARSE_KERNELS_ALL
 #undef REGISTER_CPU_SPARSE_KERNELS
 
-#define REGISTER_CPU_SPARSE_KERNELS(type)                     \
-  REGISTER_KERNEL_BUILDER(Name("SparseSegmentMean")           \
-                              .Device(DEVICE_CPU)             \
-                              .TypeConstraint<type>("T")      \
-                              .TypeConstraint<int32>("Tidx"), \
-                          SparseSegmentReductionMeanOp<CPUDevice, type>);
-REGISTER_CPU_SPARSE_KERNELS(float);
-REGISTER_CPU_SPARSE_KERNELS(double);
+#define REGISTER_CPU_SPARSE_KERNELS(type, index_type)                    \
+  REGISTER_KERNEL_BUILDER(Name("SparseSegmentMean")                      \
+                              .Device(DEVICE_CPU)                        \
+                              .TypeConstraint<type>("T")                 \
+                              .TypeConstraint<index_type>("Tidx"),       \
+                          SparseSegmentReductionMeanOp<CPUDevice, type,  \
+                                                       index_type>);
+REGISTER_CPU_SPARSE_KERNELS(float, int32);
+REGISTER_CPU_SPARSE_KERNELS(float, int64);
+REGISTER_CPU_SPARSE_KERNELS(double, int32);
+REGISTER_CPU_SPARSE_KERNELS(double, int64);
 #undef REGISTER_CPU_SPARSE_KERNELS
 
-#define REGISTER_CPU_SPARSE_KERNELS(type)                     \
-  REGISTER_KERNEL_BUILDER(Name("SparseSegmentSqrtN")          \
-                              .Device(DEVICE_CPU)             \
-                              .TypeConstraint<type>("T")      \
-                              .TypeConstraint<int32>("Tidx"), \
-                          SparseSegmentReductionSqrtNOp<CPUDevice, type>);
-REGISTER_CPU_SPARSE_KERNELS(float);
-REGISTER_CPU_SPARSE_KERNELS(double);
+#define REGISTER_CPU_SPARSE_KERNELS(type, index_type)                    \
+  REGISTER_KERNEL_BUILDER(Name("SparseSegmentSqrtN")                     \
+                              .Device(DEVICE_CPU)                        \
+                              .TypeConstraint<type>("T")                 \
+                              .TypeConstraint<index_type>("Tidx"),       \
+                          SparseSegmentReductionSqrtNOp<CPUDevice, type, \
+                                                        index_type>);
+REGISTER_CPU_SPARSE_KERNELS(float, int32);
+REGISTER_CPU_SPARSE_KERNELS(float, int64);
+REGISTER_CPU_SPARSE_KERNELS(double, int32);
+REGISTER_CPU_SPARSE_KERNELS(double, int64);
 #undef REGISTER_CPU_SPARSE_KERNELS
 
 template <class T>
@@ -19,7 +19,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 
+#include <type_traits>
+
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/group_by_index.h"
 #include "tensorflow/core/util/cuda_kernel_helper.h"
 
 namespace tensorflow {
@@ -78,6 +82,56 @@ __global__ void UnsortedSegmentSumCustomKernel(
   }
 }
 
+// Helper for UnsortedSegmentSumGroupedKernel that adds value into sum.
+template <typename T>
+static __device__ __forceinline__ void AddInto(T* sum, const T& value) {
+  *sum += value;
+}
+
+// Specializations of AddInto for complex types, which have no arithmetic on
+// the device. As in AccumulateInto, the components are added individually.
+template <>
+__device__ __forceinline__ void AddInto(std::complex<float>* sum,
+                                        const std::complex<float>& value) {
+  auto sum_scalar = reinterpret_cast<float*>(sum);
+  sum_scalar[0] += value.real();
+  sum_scalar[1] += value.imag();
+}
+
+template <>
+__device__ __forceinline__ void AddInto(std::complex<double>* sum,
+                                        const std::complex<double>& value) {
+  auto sum_scalar = reinterpret_cast<double*>(sum);
+  sum_scalar[0] += value.real();
+  sum_scalar[1] += value.imag();
+}
+
+// Alternative to UnsortedSegmentSumCustomKernel for segment ids that repeat
+// a lot: it processes the 'output_total_size' elements of the output, and
+// sums the input rows that functor::GroupByIndex grouped under each output
+// row into a register, so every output element is written once instead of
+// being the target of one atomic add per input row. Output rows without
+// any segment id are set to zero.
+template <typename T, typename Index>
+__global__ void UnsortedSegmentSumGroupedKernel(
+    const Index output_total_size, const Index inner_dim_size,
+    const int32* row_counts, const int32* row_starts, const int32* positions,
+    const T* input, T* output) {
+  CUDA_1D_KERNEL_LOOP(output_index, output_total_size) {
+    const Index output_segment_index = output_index / inner_dim_size;
+    const Index segment_offset = output_index % inner_dim_size;
+    const int32 start = ldg(row_starts + output_segment_index);
+    const int32 end = start + ldg(row_counts + output_segment_index);
+    T sum = T(0);
+    for (int32 i = start; i < end; ++i) {
+      const Index input_segment_index = ldg(positions + i);
+      AddInto<T>(&sum, ldg(input + input_segment_index * inner_dim_size +
+                               segment_offset));
+    }
+    output[output_index] = sum;
+  }
+}
+
 namespace functor {
 
 // UnsortedSegmentSumFunctor implementation for GPUDevice.
@@ -91,6 +145,26 @@ struct UnsortedSegmentSumFunctor<GPUDevice, T, Index>: UnsortedSegmentBaseFuncto
     if (output.size() == 0) {
       return;
     }
+    if (data_size > 0 && segment_ids_shape.num_elements() > 0) {
+      const Index input_outer_dim_size = segment_ids.dimension(0);
+      const Index input_inner_dim_size = data_size / input_outer_dim_size;
+      if (ShouldGroupByIndex(input_outer_dim_size, output_rows,
+                             input_inner_dim_size,
+                             std::is_same<T, Eigen::half>::value)) {
+        Tensor row_counts, row_starts, positions;
+        OP_REQUIRES_OK(ctx, GroupByIndex<GPUDevice, Index>()(
+                                ctx, d, segment_ids, output_rows, &row_counts,
+                                &row_starts, &positions));
+        CudaLaunchConfig config = GetCudaLaunchConfig(output.size(), d);
+        UnsortedSegmentSumGroupedKernel<T, Index>
+            <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+                output.size(), input_inner_dim_size,
+                row_counts.flat<int32>().data(),
+                row_starts.flat<int32>().data(),
+                positions.flat<int32>().data(), data, output.data());
+        return;
+      }
+    }
     // Set 'output' to zeros.
     CudaLaunchConfig config = GetCudaLaunchConfig(output.size(), d);
     SetZero<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
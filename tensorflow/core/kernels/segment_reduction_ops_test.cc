@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -166,4 +167,112 @@ static void BM_SparseSegmentMeanGrad_High(int iters, int size) {
 BENCHMARK(BM_SparseSegmentMeanGrad_Low)->Arg(1000)->Arg(100000);
 BENCHMARK(BM_SparseSegmentMeanGrad_High)->Arg(1000)->Arg(100000);
 
+// Sums "num_rows" rows of 64 floats into "num_segments" rows chosen at
+// random, as the gradient of a gather from an embedding table does.
+static void UnsortedSegmentSumHelper(int iters, int num_rows,
+                                     int num_segments) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  const int kDim = 64;
+  Tensor data(DT_FLOAT, TensorShape({num_rows, kDim}));
+  data.flat<float>().setRandom();
+  Tensor segment_ids(DT_INT32, TensorShape({num_rows}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_rows; ++i) {
+    segment_ids.flat<int32>()(i) = rnd.Uniform(num_segments);
+  }
+  Tensor num_segments_t(DT_INT32, TensorShape({}));
+  num_segments_t.scalar<int32>()() = num_segments;
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UnsortedSegmentSum")
+                  .Input(test::graph::Constant(g, data))
+                  .Input(test::graph::Constant(g, segment_ids))
+                  .Input(test::graph::Constant(g, num_segments_t))
+                  .Finalize(g, &node));
+
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * num_rows * kDim *
+                          sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_UnsortedSegmentSum(int iters, int num_rows, int num_segments) {
+  return UnsortedSegmentSumHelper(iters, num_rows, num_segments);
+}
+
+BENCHMARK(BM_UnsortedSegmentSum)
+    ->ArgPair(1000, 100)
+    ->ArgPair(100000, 1000)
+    ->ArgPair(100000, 100000)
+    ->ArgPair(1000000, 10000);
+
+// Combines the embeddings of "batch_size" examples of 20 ids each, either
+// with SparseSegmentSum straight on the embedding table, or on the rows first
+// gathered by Unique and Gather.
+static void EmbeddingBagHelper(int iters, bool gather_first, int batch_size) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  const int kVocabSize = 100000;
+  const int kDim = 64;
+  const int kIdsPerExample = 20;
+  const int num_ids = batch_size * kIdsPerExample;
+
+  Tensor params(DT_FLOAT, TensorShape({kVocabSize, kDim}));
+  params.flat<float>().setRandom();
+  Tensor ids(DT_INT64, TensorShape({num_ids}));
+  Tensor segments(DT_INT32, TensorShape({num_ids}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_ids; ++i) {
+    ids.flat<int64>()(i) = rnd.Uniform(kVocabSize);
+    segments.flat<int32>()(i) = i / kIdsPerExample;
+  }
+
+  Node* params_node = test::graph::Constant(g, params);
+  Node* ids_node = test::graph::Constant(g, ids);
+  Node* segments_node = test::graph::Constant(g, segments);
+  Node* node;
+  if (gather_first) {
+    Node* unique;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                    .Input(ids_node)
+                    .Finalize(g, &unique));
+    Node* gather;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Gather")
+                    .Input(params_node)
+                    .Input(unique, 0)
+                    .Finalize(g, &gather));
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                    .Input(gather)
+                    .Input(unique, 1)
+                    .Input(segments_node)
+                    .Finalize(g, &node));
+  } else {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                    .Input(params_node)
+                    .Input(ids_node)
+                    .Input(segments_node)
+                    .Finalize(g, &node));
+  }
+
+  testing::UseRealTime();
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_ids);
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_EmbeddingBag_InPlace(int iters, int batch_size) {
+  return EmbeddingBagHelper(iters, false, batch_size);
+}
+
+static void BM_EmbeddingBag_GatherFirst(int iters, int batch_size) {
+  return EmbeddingBagHelper(iters, true, batch_size);
+}
+
+BENCHMARK(BM_EmbeddingBag_InPlace)->Arg(32)->Arg(1024);
+BENCHMARK(BM_EmbeddingBag_GatherFirst)->Arg(32)->Arg(1024);
+
 }  // namespace tensorflow
@@ -114,8 +114,9 @@ class ShuffleDatasetOp : public OpKernel {
         parent_generator_ = random::PhiloxRandom(seed, seed2);
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         while (!end_of_input_sequence_ &&
                buffer_.size() < dataset()->buffer_size_) {
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/x86_cwise_kernels.h"
 
 namespace tensorflow {
 
@@ -45,6 +46,20 @@ struct SoftmaxFunctorBase {
 template <typename T>
 struct SoftmaxFunctor<CPUDevice, T> : SoftmaxFunctorBase<CPUDevice, T> {};
 
+// Uses the kernel of x86_cwise_kernels.h for float when it is enabled.
+template <>
+struct SoftmaxFunctor<CPUDevice, float> : SoftmaxFunctorBase<CPUDevice, float> {
+  void operator()(const CPUDevice& d, TTypes<float>::ConstMatrix logits,
+                  TTypes<float>::Matrix softmax, const bool log) {
+    if (x86::CwiseKernelsEnabled()) {
+      x86::SoftmaxFloat(d, logits.data(), softmax.data(), logits.dimension(0),
+                        logits.dimension(1), log);
+    } else {
+      SoftmaxFunctorBase<CPUDevice, float>::operator()(d, logits, softmax, log);
+    }
+  }
+};
+
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T>
 struct SoftmaxFunctor<SYCLDevice, T> : SoftmaxFunctorBase<SYCLDevice, T> {};
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SPARSE_CONDITIONAL_ACCUMULATOR_H_
 #define TENSORFLOW_KERNELS_SPARSE_CONDITIONAL_ACCUMULATOR_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/kernels/typed_conditional_accumulator_base.h"
 
 namespace tensorflow {
@@ -42,6 +45,15 @@ namespace tensorflow {
  * SparseConditionalAccumulator is the datatype-dependent templated sub-class of
  * ConditionalAccumulatorBase. It implements the virtual arithmetic methods that
  * are used by for aggregating, averaging, allocating, returning indexed slices.
+ *
+ * By default the accumulated gradient is kept as indexed slices, and each new
+ * gradient is merged into it, so every ApplyGrad copies the whole sum so far
+ * while holding mu_. With dense_accumulation, which requires a fully defined
+ * shape, the sum is kept in a dense tensor of that shape instead. A gradient
+ * is then validated under mu_ but added to its rows outside it, under one of
+ * kNumStripes locks picked by row index, so that the gradients of different
+ * workers are added in parallel and each one costs only its own size. The
+ * rows touched in a step are zeroed again when the average is taken.
  */
 template <typename Device, typename T>
 class SparseConditionalAccumulator
@@ -50,10 +62,11 @@ class SparseConditionalAccumulator
  public:
   SparseConditionalAccumulator(const DataType& dtype,
                                const PartialTensorShape& shape,
-                               const string& name)
+                               const string& name, bool dense_accumulation)
       : TypedConditionalAccumulatorBase<
             std::tuple<const Tensor*, const Tensor*, const Tensor*>>(
-            dtype, shape, name) {
+            dtype, shape, name),
+        dense_accumulation_(dense_accumulation) {
     accum_idx_vec_ = nullptr;
     count_element_ = nullptr;
     accum_val_ = nullptr;
@@ -67,6 +80,37 @@ class SparseConditionalAccumulator
     // Do not delete accum_val_! Will be automatically garbage collected
   };
 
+  void TryApplyGrad(int64 local_step, OpKernelContext* ctx) override {
+    if (!dense_accumulation_) {
+      typedef TypedConditionalAccumulatorBase<
+          std::tuple<const Tensor*, const Tensor*, const Tensor*>>
+          Base;
+      Base::TryApplyGrad(local_step, ctx);
+      return;
+    }
+    if (DropIfStale(local_step)) return;
+    std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad = nullptr;
+    bool is_valid = false;
+    {
+      mutex_lock l(mu_);
+      if (local_step < current_global_step_) {
+        num_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      is_valid = GetAndValidateTensorInputForApplyGrad(ctx, &grad) &&
+                 ValidateAndAllocateDenseAccum(ctx, grad);
+      if (is_valid) ++num_applying_;
+    }
+    if (is_valid) {
+      AddToDenseAccum(grad);
+      mutex_lock l(mu_);
+      --num_applying_;
+      ++counter_;
+    }
+    CleanUpGradTensor(grad);
+    FlushUnlocked();
+  }
+
  protected:
   std::vector<int64>* accum_idx_vec_ = nullptr;
   std::vector<int>* count_element_ = nullptr;
@@ -320,6 +364,8 @@ class SparseConditionalAccumulator
 
   void DivideAccumGradByCounter(OpKernelContext* ctx) override
       EXCLUSIVE_LOCKS_REQUIRED(this->mu_) {
+    // The dense sum is averaged as it's copied out in SetOutput.
+    if (dense_accumulation_) return;
     const int64 nnz = count_element_->size();
     auto accum_flat = accum_val_->flat_outer_dims<T>();
     std::vector<T> count_typet;
@@ -346,6 +392,7 @@ class SparseConditionalAccumulator
   }
 
   bool SetOutput(OpKernelContext* ctx) override {
+    if (dense_accumulation_) return SetDenseOutput(ctx);
     bool is_successful = true;
     if (is_successful) is_successful = ReturnIdxTensor(ctx);
     if (is_successful) is_successful = ReturnValTensor(ctx);
@@ -407,6 +454,123 @@ class SparseConditionalAccumulator
   }
 
  private:
+  static constexpr int kNumStripes = 64;
+
+  // Checks the gradient against the dense accumulator, which is allocated
+  // and zeroed on first use.
+  bool ValidateAndAllocateDenseAccum(
+      OpKernelContext* ctx,
+      std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad)
+      EXCLUSIVE_LOCKS_REQUIRED(this->mu_) {
+    const Tensor* grad_idx = std::get<0>(*grad);
+    const Tensor* grad_val = std::get<1>(*grad);
+    OP_REQUIRES_BOOLEAN(
+        ctx, grad_val->dims() == shape_.dims(),
+        errors::InvalidArgument("Shape mismatch: expected values rank ",
+                                shape_.dims(), ", got ", grad_val->dims()));
+    const auto grad_idx_vec = grad_idx->vec<int64>();
+    for (int64 i = 0; i < grad_idx_vec.dimension(0); ++i) {
+      OP_REQUIRES_BOOLEAN(
+          ctx, grad_idx_vec(i) >= 0,
+          errors::InvalidArgument("Index of slice ", i, " is negative: ",
+                                  grad_idx_vec(i)));
+    }
+    if (accum_val_ == nullptr) {
+      TensorShape accum_shape;
+      OP_REQUIRES_BOOLEAN(ctx, shape_.AsTensorShape(&accum_shape),
+                          errors::Internal("Accumulator shape ",
+                                           shape_.DebugString(),
+                                           " is not fully defined"));
+      OP_REQUIRES_OK_BOOLEAN(
+          ctx, ctx->allocate_persistent(dtype_, accum_shape,
+                                        accum_val_persistent_, &accum_val_));
+      accum_val_->flat<T>().setZero();
+      dense_counts_.assign(accum_shape.dim_size(0), 0);
+    }
+    return true;
+  }
+
+  void AddToDenseAccum(
+      std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad) {
+    const auto grad_idx = std::get<0>(*grad)->vec<int64>();
+    const auto grad_flat = std::get<1>(*grad)->flat_outer_dims<T>();
+    const int64 num_col = grad_flat.dimension(1);
+    T* accum_data = accum_val_->flat<T>().data();
+    for (int64 i = 0; i < grad_idx.dimension(0); ++i) {
+      const int64 row = grad_idx(i);
+      const int stripe = row % kNumStripes;
+      mutex_lock l(stripe_mu_[stripe]);
+      if (dense_counts_[row]++ == 0) {
+        touched_rows_[stripe].push_back(row);
+      }
+      T* accum_row = accum_data + row * num_col;
+      const T* grad_row = grad_flat.data() + i * num_col;
+      for (int64 j = 0; j < num_col; ++j) {
+        accum_row[j] += grad_row[j];
+      }
+    }
+  }
+
+  // Returns the average of the touched rows, in increasing row order, and
+  // zeroes them for the next step. Called with no gradients being added.
+  bool SetDenseOutput(OpKernelContext* ctx)
+      EXCLUSIVE_LOCKS_REQUIRED(this->mu_) {
+    std::vector<int64> rows;
+    for (int i = 0; i < kNumStripes; ++i) {
+      rows.insert(rows.end(), touched_rows_[i].begin(),
+                  touched_rows_[i].end());
+    }
+    const int64 num_rows = dense_counts_.size();
+    if (static_cast<int64>(rows.size()) * 16 >= num_rows) {
+      // When most of the rows are touched, one pass over the counts finds
+      // them in order, more cheaply than sorting them.
+      rows.clear();
+      for (int64 row = 0; row < num_rows; ++row) {
+        if (dense_counts_[row] > 0) rows.push_back(row);
+      }
+    } else {
+      std::sort(rows.begin(), rows.end());
+    }
+    const int64 nnz = rows.size();
+
+    Tensor* idx_tensor;
+    OP_REQUIRES_OK_BOOLEAN(ctx, ctx->allocate_output(0, {nnz}, &idx_tensor));
+    TensorShape val_shape;
+    shape_.AsTensorShape(&val_shape);
+    val_shape.set_dim(0, nnz);
+    Tensor* val_tensor;
+    OP_REQUIRES_OK_BOOLEAN(ctx,
+                           ctx->allocate_output(1, val_shape, &val_tensor));
+    Tensor* shape_tensor;
+    OP_REQUIRES_OK_BOOLEAN(
+        ctx, ctx->allocate_output(2, {shape_.dims()}, &shape_tensor));
+
+    auto idx_vec = idx_tensor->vec<int64>();
+    auto val_flat = val_tensor->flat_outer_dims<T>();
+    const int64 num_col = val_flat.dimension(1);
+    T* accum_data = accum_val_->flat<T>().data();
+    for (int64 i = 0; i < nnz; ++i) {
+      const int64 row = rows[i];
+      idx_vec(i) = row;
+      const T count = TypeConverter<T, int>::ConvertUToT(dense_counts_[row]);
+      T* accum_row = accum_data + row * num_col;
+      T* val_row = val_flat.data() + i * num_col;
+      for (int64 j = 0; j < num_col; ++j) {
+        val_row[j] = accum_row[j] / count;
+        accum_row[j] = T(0);
+      }
+      dense_counts_[row] = 0;
+    }
+    for (int i = 0; i < kNumStripes; ++i) {
+      touched_rows_[i].clear();
+    }
+    auto shape_vec = shape_tensor->vec<int64>();
+    for (int64 i = 0; i < shape_.dims(); ++i) {
+      shape_vec(i) = shape_.dim_size(i);
+    }
+    return true;
+  }
+
   inline int cmp(std::vector<int64>* a_idx, const Tensor* b_idx,
                  const int64 a_row, const int64 b_row) {
     const int64 a = a_idx->at(a_row);
@@ -454,6 +618,15 @@ class SparseConditionalAccumulator
     return true;
   }
 
+  const bool dense_accumulation_;
+  // With dense_accumulation, the number of gradients added to each row
+  // of accum_val_ in this step, and per stripe, the rows whose count is
+  // nonzero. The entries of a row are guarded by stripe_mu_[row %
+  // kNumStripes].
+  std::vector<int> dense_counts_;
+  std::vector<int64> touched_rows_[kNumStripes];
+  mutex stripe_mu_[kNumStripes];
+
   TF_DISALLOW_COPY_AND_ASSIGN(SparseConditionalAccumulator);
 };
 
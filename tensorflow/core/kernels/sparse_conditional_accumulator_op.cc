@@ -28,19 +28,30 @@ template <typename Device, typename T>
 class SparseConditionalAccumulatorOp : public ConditionalAccumulatorBaseOp {
  public:
   explicit SparseConditionalAccumulatorOp(OpKernelConstruction* context)
-      : ConditionalAccumulatorBaseOp(context) {}
+      : ConditionalAccumulatorBaseOp(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dense_accumulation",
+                                             &dense_accumulation_));
+    OP_REQUIRES(context, !dense_accumulation_ || (shape_.IsFullyDefined() &&
+                                                  shape_.dims() > 0),
+                errors::InvalidArgument(
+                    "dense_accumulation requires a fully defined shape of "
+                    "rank at least 1, got ",
+                    shape_.DebugString()));
+  }
 
  protected:
   Creator GetCreator() const override {
     return [this](ConditionalAccumulatorBase** ret) {
       SparseConditionalAccumulator<Device, T>* accumulator =
-          new SparseConditionalAccumulator<Device, T>(dtype_, shape_,
-                                                      cinfo_.name());
+          new SparseConditionalAccumulator<Device, T>(
+              dtype_, shape_, cinfo_.name(), dense_accumulation_);
       *ret = accumulator;
       return Status::OK();
     };
   }
 
+  bool dense_accumulation_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(SparseConditionalAccumulatorOp);
 };
 
@@ -253,62 +253,88 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
     const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
     const int lhs_index_a = ADJ_A ? 1 : 0;
     const int rhs_index_a = ADJ_A ? 0 : 1;
+    const int64 out_rows = out.dimension(0);
+
+    // Convert A to CSR over the rows of the output, so that the rows can be
+    // computed in parallel. The indices are copied once and the copies are
+    // used after the bounds checks. The counting sort is stable, so the
+    // products are summed into each output element in the order of a.
+    std::vector<Tindices> a_rows(nnz);
+    std::vector<Tindices> a_cols(nnz);
+    std::vector<int64> row_starts(out_rows + 1, 0);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+      if (!FastBoundsCheck(k, lhs_right)) {
+        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+      }
+      if (!FastBoundsCheck(m, out_rows)) {
+        return MOutOfBoundsError(m, i, lhs_index_a, out_rows);
+      }
+      a_rows[i] = m;
+      a_cols[i] = k;
+      ++row_starts[m + 1];
+    }
+    for (int64 m = 0; m < out_rows; ++m) {
+      row_starts[m + 1] += row_starts[m];
+    }
+    std::vector<Tindices> csr_cols(nnz);
+    std::vector<T> csr_values(nnz);
+    {
+      std::vector<int64> next(row_starts.begin(), row_starts.end() - 1);
+      for (std::size_t i = 0; i < nnz; ++i) {
+        const int64 j = next[a_rows[i]]++;
+        csr_cols[j] = a_cols[i];
+        csr_values[j] = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+      }
+    }
 
-    out.setZero();
-
-    // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-    // approach that achieves the performance of the single threaded
-    // one.  Perhaps Eigen threadpool implementation is just too slow?
+    const double nnz_per_row = static_cast<double>(nnz) / out_rows;
+    const Eigen::TensorOpCost cost(nnz_per_row * rhs_right * sizeof(T),
+                                   rhs_right * sizeof(T),
+                                   nnz_per_row * rhs_right * 2);
 
     if (rhs_right < kNumVectorize) {
-      // Disable vectorization if the RHS of output is too small
+      // The rows of the output are too short to vectorize, so every output
+      // element is computed as an inner product of a sparse row of A and a
+      // column of B, accumulated in a register.
       auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
-
-      for (std::size_t i = 0; i < nnz; ++i) {
-        const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-        const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-        if (!FastBoundsCheck(k, lhs_right)) {
-          return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-        }
-        if (!FastBoundsCheck(m, out.dimension(0))) {
-          return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-        }
-        const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-        for (std::size_t n = 0; n < rhs_right; ++n) {
-          const T b_value = maybe_adjoint_b(k, n);
-          out(m, n) += a_value * b_value;
+      d.parallelFor(out_rows, cost, [&](int64 begin, int64 end) {
+        for (int64 m = begin; m < end; ++m) {
+          for (std::size_t n = 0; n < rhs_right; ++n) {
+            T sum(0);
+            for (int64 j = row_starts[m]; j < row_starts[m + 1]; ++j) {
+              sum += csr_values[j] * maybe_adjoint_b(csr_cols[j], n);
+            }
+            out(m, n) = sum;
+          }
         }
-      }
+      });
     } else {
-      // Vectorization via Eigen.
-      const int b_chip_index = ADJ_B ? 1 : 0;
-
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
-    }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k) * a_value;                  \
-  }
-
+      // Every output row is a sum of the rows of B selected by the nonzeros
+      // of a row of A, scaled by them: a sequence of vectorized AXPYs over
+      // contiguous rows.
+      const T* b_data = b.data();
+      Eigen::Tensor<T, 2, Eigen::RowMajor> b_adjoint;
       if (ADJ_B) {
-        // Perform transpose and conjugation on B once, since we chip out B's
-        // columns in the nnz loop.
-        Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
-        Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
-            b.swap_layout().shuffle(shuffle).conjugate();
-        LOOP_NNZ(col_major_conj_b);
-      } else {
-        LOOP_NNZ(b);
+        // Perform transpose and conjugation on B once, since every AXPY reads
+        // a column of B.
+        Eigen::array<int, 2> shuffle{{1, 0}};
+        b_adjoint.resize(lhs_right, rhs_right);
+        b_adjoint.device(d) = b.shuffle(shuffle).conjugate();
+        b_data = b_adjoint.data();
       }
-#undef LOOP_NNZ
+      d.parallelFor(out_rows, cost, [&](int64 begin, int64 end) {
+        for (int64 m = begin; m < end; ++m) {
+          typename TTypes<T>::UnalignedVec out_row(&out(m, 0), rhs_right);
+          out_row.setZero();
+          for (int64 j = row_starts[m]; j < row_starts[m + 1]; ++j) {
+            typename TTypes<T>::UnalignedConstVec b_row(
+                b_data + csr_cols[j] * rhs_right, rhs_right);
+            out_row += b_row * csr_values[j];
+          }
+        }
+      });
     }
     return Status::OK();
   }
@@ -13,10 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <atomic>
 #include <deque>
 #include <numeric>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -39,10 +41,17 @@ class Buffer : public ResourceBase {
   std::size_t capacity_;
   std::size_t memory_limit_;
   std::size_t current_bytes_;
+  // Room reserved by Reserve() for tuples yet to be inserted. Their bytes
+  // are included in current_bytes_.
+  std::size_t num_reserved_;
+  std::size_t reserved_bytes_;
   mutex mu_;
   condition_variable non_empty_cond_var_;
   condition_variable full_cond_var_;
   std::deque<Tuple> buf_ GUARDED_BY(mu_);
+  // The error of a tuple that failed to be inserted after its room was
+  // reserved. The operations on the buffer fail with it until Clear().
+  Status status_ GUARDED_BY(mu_);
 
 
  private:
@@ -66,7 +75,7 @@ class Buffer : public ResourceBase {
   }
 
   bool IsCapacityFull() {
-    return buf_.size() >= capacity_;
+    return buf_.size() + num_reserved_ >= capacity_;
   }
 
   bool WouldExceedMemoryLimit(std::size_t bytes) {
@@ -75,25 +84,16 @@ class Buffer : public ResourceBase {
 
   std::size_t GetTupleBytes(const Tuple & tuple)
   {
-    return std::accumulate(tuple.begin(), tuple.end(), 0,
+    return std::accumulate(tuple.begin(), tuple.end(), std::size_t(0),
       [](const std::size_t & lhs, const Tensor & rhs) {
         return lhs + rhs.TotalBytes();
     });
   }
 
- public:
-  // public methods
-  explicit Buffer(std::size_t capacity, std::size_t memory_limit) :
-      capacity_(capacity),
-      memory_limit_(memory_limit),
-      current_bytes_(0) {}
-
-  // the Buffer takes ownership of the Tuple
-  Status Put(Tuple* tuple) {
-    mutex_lock l(mu_);
-
-    std::size_t tuple_bytes = GetTupleBytes(*tuple);
-
+  // Waits until there is room for a tuple of "tuple_bytes" bytes, and
+  // accounts for them.
+  Status WaitForRoom(mutex_lock& l, std::size_t tuple_bytes) {
+    TF_RETURN_IF_ERROR(status_);
     // Sanity check so that we don't block for ever below
     if(memory_limit_ > 0 && tuple_bytes > memory_limit_) {
       return Status(errors::ResourceExhausted("Attempted to insert "
@@ -112,13 +112,33 @@ class Buffer : public ResourceBase {
         bool capacity_valid = capacity_ > 0 ? !IsCapacityFull() : true;
 
         // Stop waiting upon success for both conditions
-        return capacity_valid && memory_limit_valid;
+        return (capacity_valid && memory_limit_valid) || !status_.ok();
       });
+      TF_RETURN_IF_ERROR(status_);
     }
 
     // Update bytes in the Staging Area
     current_bytes_ += tuple_bytes;
 
+    return Status::OK();
+  }
+
+ public:
+  // public methods
+  explicit Buffer(std::size_t capacity, std::size_t memory_limit) :
+      capacity_(capacity),
+      memory_limit_(memory_limit),
+      current_bytes_(0),
+      num_reserved_(0),
+      reserved_bytes_(0) {}
+
+  // the Buffer takes ownership of the Tuple
+  Status Put(Tuple* tuple) {
+    mutex_lock l(mu_);
+
+    std::size_t tuple_bytes = GetTupleBytes(*tuple);
+    TF_RETURN_IF_ERROR(WaitForRoom(l, tuple_bytes));
+
     // Store tuple
     buf_.push_back(std::move(*tuple));
 
@@ -130,14 +150,53 @@ class Buffer : public ResourceBase {
     return Status::OK();
   }
 
+  // Reserves room for a tuple of "tuple_bytes" bytes, blocking like Put()
+  // until there is some. The tuple is then inserted by PutReserved(), or
+  // the room released by CancelReserved().
+  Status Reserve(std::size_t tuple_bytes) {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(WaitForRoom(l, tuple_bytes));
+    ++num_reserved_;
+    reserved_bytes_ += tuple_bytes;
+    return Status::OK();
+  }
+
+  // Inserts a tuple that room was reserved for.
+  void PutReserved(Tuple* tuple) {
+    mutex_lock l(mu_);
+    --num_reserved_;
+    reserved_bytes_ -= GetTupleBytes(*tuple);
+    buf_.push_back(std::move(*tuple));
+
+    l.unlock();
+    non_empty_cond_var_.notify_one();
+  }
+
+  // Releases the room reserved for a tuple of "tuple_bytes" bytes, which
+  // failed to be inserted with the error "s". The tuple is lost, so the
+  // following operations fail with "s" until the buffer is cleared.
+  void CancelReserved(std::size_t tuple_bytes, const Status& s) {
+    mutex_lock l(mu_);
+    --num_reserved_;
+    reserved_bytes_ -= tuple_bytes;
+    current_bytes_ -= tuple_bytes;
+    status_.Update(s);
+
+    l.unlock();
+    non_empty_cond_var_.notify_all();
+    full_cond_var_.notify_all();
+  }
+
+
   // Get tuple at front of the buffer
-  void Get(Tuple* tuple) {  // TODO(zhifengc): Support cancellation.
+  Status Get(Tuple* tuple) {  // TODO(zhifengc): Support cancellation.
     mutex_lock l(mu_);
 
     // Wait for data if the buffer is empty
     non_empty_cond_var_.wait(l, [this]() {
-      return !buf_.empty();
+      return !buf_.empty() || !status_.ok();
     });
+    TF_RETURN_IF_ERROR(status_);
 
     // Move data into the output tuple
     *tuple = std::move(buf_.front());
@@ -147,6 +206,7 @@ class Buffer : public ResourceBase {
     current_bytes_ -= GetTupleBytes(*tuple);
 
     notify_inserters_if_bounded(l);
+    return Status::OK();
   }
 
   // Return tuple at index
@@ -155,8 +215,9 @@ class Buffer : public ResourceBase {
 
     // Wait if the requested index is not available
     non_empty_cond_var_.wait(l, [index, this]() {
-      return index < this->buf_.size();
+      return index < this->buf_.size() || !status_.ok();
     });
+    TF_RETURN_IF_ERROR(status_);
 
     // Place tensors in the output tuple
     for(const auto & tensor: buf_[index]) {
@@ -175,7 +236,8 @@ class Buffer : public ResourceBase {
   void Clear() {
     mutex_lock l(mu_);
     buf_.clear();
-    current_bytes_ = 0;
+    current_bytes_ = reserved_bytes_;
+    status_ = Status::OK();
 
     notify_inserters_if_bounded(l);
   }
@@ -231,6 +293,108 @@ class StageOp : public OpKernel {
 REGISTER_KERNEL_BUILDER(Name("Stage").Device(DEVICE_CPU), StageOp);
 #if GOOGLE_CUDA
 REGISTER_KERNEL_BUILDER(Name("Stage").Device(DEVICE_GPU), StageOp);
+
+// Stages tensors from host memory in a staging area on a GPU, selected by
+// the "prefetch" label. The tensors are copied into pinned buffers and
+// from there to the GPU on its host-to-device stream, and the op finishes
+// as soon as the copies are enqueued: room for the element is reserved
+// first, and the element is inserted once the copies have completed. So
+// a put that runs in the same step as the get of the previous element
+// overlaps its transfer with the step instead of delaying it. If a copy
+// fails, the element is lost, and the following operations on the staging
+// area fail with the error of the copy until it is cleared.
+class PrefetchStageOp : public OpKernel {
+ public:
+  explicit PrefetchStageOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    std::size_t tuple_bytes = 0;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      OP_REQUIRES(ctx, DataTypeCanUseMemcpy(ctx->input(i).dtype()),
+                  errors::InvalidArgument(
+                      "Cannot prefetch tensors of type ",
+                      DataTypeString(ctx->input(i).dtype()), " to a GPU"));
+      tuple_bytes += ctx->input(i).TotalBytes();
+    }
+    Buffer* buf = nullptr;
+    OP_REQUIRES_OK(ctx, GetBuffer(ctx, def(), &buf));
+    core::ScopedUnref scope(buf);
+    OP_REQUIRES_OK(ctx, buf->Reserve(tuple_bytes));
+
+    Device* device = static_cast<Device*>(ctx->device());
+    AllocatorAttributes pinned_attr;
+    pinned_attr.set_on_host(true);
+    pinned_attr.set_gpu_compatible(true);
+    Allocator* pinned_allocator = device->GetAllocator(pinned_attr);
+    Allocator* gpu_allocator = device->GetAllocator(AllocatorAttributes());
+
+    // Owns the tensors until all the copies are done.
+    struct Prefetch {
+      std::vector<Tensor> pinned;
+      Buffer::Tuple tuple;
+      std::atomic<int> pending;
+      mutex mu;
+      Status status GUARDED_BY(mu);
+    };
+    Prefetch* prefetch = new Prefetch;
+    prefetch->pending = ctx->num_inputs();
+    prefetch->pinned.reserve(ctx->num_inputs());
+    prefetch->tuple.reserve(ctx->num_inputs());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      const Tensor& input = ctx->input(i);
+      prefetch->pinned.emplace_back(pinned_allocator, input.dtype(),
+                                    input.shape());
+      StringPiece src = input.tensor_data();
+      if (!src.empty()) {
+        memcpy(const_cast<char*>(prefetch->pinned[i].tensor_data().data()),
+               src.data(), src.size());
+      }
+      prefetch->tuple.emplace_back(gpu_allocator, input.dtype(),
+                                   input.shape());
+    }
+
+    buf->Ref();
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      ctx->op_device_context()->CopyCPUTensorToDevice(
+          &prefetch->pinned[i], device, &prefetch->tuple[i],
+          [buf, prefetch, tuple_bytes](const Status& s) {
+            if (!s.ok()) {
+              mutex_lock l(prefetch->mu);
+              prefetch->status.Update(s);
+            }
+            if (--prefetch->pending > 0) return;
+            Status status;
+            {
+              mutex_lock l(prefetch->mu);
+              status = prefetch->status;
+            }
+            if (status.ok()) {
+              buf->PutReserved(&prefetch->tuple);
+            } else {
+              buf->CancelReserved(
+                  tuple_bytes,
+                  Status(status.code(),
+                         strings::StrCat("Failed to prefetch tensors to the "
+                                         "GPU: ",
+                                         status.error_message())));
+            }
+            buf->Unref();
+            delete prefetch;
+          });
+    }
+    if (ctx->num_inputs() == 0) {
+      buf->PutReserved(&prefetch->tuple);
+      buf->Unref();
+      delete prefetch;
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("Stage")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("values")
+                            .Label("prefetch"),
+                        PrefetchStageOp);
 #endif
 #ifdef TENSORFLOW_USE_SYCL
 REGISTER_KERNEL_BUILDER(Name("Stage").Device(DEVICE_SYCL), StageOp);
@@ -248,7 +412,7 @@ class UnstageOp : public OpKernel {
     core::ScopedUnref scope(buf);
     Buffer::Tuple tuple;
 
-    buf->Get(&tuple);
+    OP_REQUIRES_OK(ctx, buf->Get(&tuple));
 
     OP_REQUIRES(ctx, tuple.size() == (size_t)ctx->num_outputs(),
         errors::InvalidArgument("Mismatch stage/unstage: ", tuple.size(),
@@ -16,27 +16,42 @@ limitations under the License.
 // See docs in ../ops/string_ops.cc.
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
 
 namespace tensorflow {
 
 namespace {
 
-std::vector<string> Split(const string& str, const string& delimiter) {
-  if (!delimiter.empty()) {
-    return str_util::Split(str, delimiter, str_util::SkipEmpty());
+// Appends the tokens of "str" to "tokens" as views into "str", and returns
+// how many there were. Like str_util::Split with SkipEmpty, but without
+// building a string for every token.
+int64 Split(const string& str, const string& delimiter,
+            std::vector<StringPiece>* tokens) {
+  if (delimiter.empty()) {
+    for (size_t i = 0; i < str.size(); ++i) {
+      tokens->emplace_back(str.data() + i, 1);
+    }
+    return str.size();
   }
-  std::vector<string> char_vector(str.size());
-  for (size_t i = 0; i < str.size(); ++i) {
-    char_vector[i] = str[i];
+  int64 num_tokens = 0;
+  size_t token_start = 0;
+  for (size_t i = 0; i <= str.size(); ++i) {
+    if (i == str.size() || delimiter.find(str[i]) != string::npos) {
+      if (i > token_start) {
+        tokens->emplace_back(str.data() + token_start, i - token_start);
+        ++num_tokens;
+      }
+      token_start = i + 1;
+    }
   }
-  return char_vector;
+  return num_tokens;
 }
 
 }  // namespace
@@ -64,7 +79,9 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<string>();
     const string& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<string> tokens;
+    // The tokens point into the input, so each one is copied only once, into
+    // the output.
+    std::vector<StringPiece> tokens;
     // Guess that we'll be unpacking a handful of tokens per example.
     static constexpr int kReserveSize = 4;
     tokens.reserve(batch_size * kReserveSize);
@@ -73,12 +90,10 @@ class StringSplitOp : public OpKernel {
     int64 max_num_entries = 0;
     std::vector<int64> num_indices(batch_size);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<string> parts = Split(input_vec(i), delimiter);
-      int64 n_entries = parts.size();
+      int64 n_entries = Split(input_vec(i), delimiter, &tokens);
       num_indices[i] = n_entries;
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -100,7 +115,7 @@ class StringSplitOp : public OpKernel {
       for (size_t j = 0; j < num_indices[i]; ++j) {
         sp_indices(c, 0) = i;
         sp_indices(c, 1) = j;
-        sp_tokens(c) = tokens[c];
+        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
         ++c;
       }
     }
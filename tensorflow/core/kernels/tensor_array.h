@@ -110,6 +110,9 @@ TF_CALL_complex128(TENSOR_ARRAY_SET_ZERO_GPU);
 //   * Deep copies of PersistentTensors are rarely made.  The only
 //     time they are made is when WriteOrAggregate is called at least twice
 //     on the same index with the flag multiple_writes_aggregate = True.
+//   * Scatter, Unpack and Split store views of their input's buffer when
+//     the elements are aligned, and Gather, Pack and Concat of elements that
+//     are still adjacent in one buffer return a view of it, without copying.
 //   * Reading and Writing to the array is protected by a mutex.
 //     All operations on a TensorArray are thread-safe.
 //   * A TensorArray may be preemptively closed, which releases all
@@ -95,6 +95,24 @@ Status SetupFlowControlInputs(OpKernelContext* ctx, bool set_output) {
   return Status::OK();
 }
 
+namespace {
+
+// Sets '*element' to rows [start, limit) of 'value', with shape 'shape',
+// without copying them, as Split does for its outputs. Returns false if the
+// rows are empty or not aligned well enough for kernels to read them, in
+// which case the caller must copy them.
+bool AliasRows(const Tensor& value, int64 start, int64 limit,
+               const TensorShape& shape, PersistentTensor* element) {
+  if (shape.num_elements() == 0) return false;
+  Tensor rows = value.Slice(start, limit);
+  Tensor aliased;
+  if (!rows.IsAligned() || !aliased.CopyFrom(rows, shape)) return false;
+  *element = PersistentTensor(aliased);
+  return true;
+}
+
+}  // namespace
+
 // CREATION *******************************************************************
 
 // Virtual class for shared behavior between TensorArrayOp and
@@ -629,6 +647,28 @@ class TensorArrayPackOrGatherOp : public OpKernel {
     TensorShape output_shape(value_0_t->shape());
     output_shape.InsertDim(0, num_indices);
 
+    std::vector<const Tensor*> value_tensors;
+    value_tensors.reserve(num_indices);
+    value_tensors.push_back(value_0_t);
+    for (int i = 1; i < num_indices; ++i) {
+      const Tensor* value_t = values[i].AccessTensor(ctx);
+      OP_REQUIRES(
+          ctx, value_0_t->shape() == value_t->shape(),
+          errors::InvalidArgument(
+              "TensorArray has inconsistent shapes.  Index 0 has shape: ",
+              value_0_t->shape().DebugString(), " but index ", i,
+              " has shape: ", value_t->shape().DebugString()));
+      value_tensors.push_back(value_t);
+    }
+
+    // Elements that are still adjacent in one buffer, e.g. the range of a
+    // TensorArray filled by Unpack or Scatter, need no copy.
+    Tensor aliased;
+    if (Tensor::FromAdjacentSlices(value_tensors, output_shape, &aliased)) {
+      ctx->set_output(0, aliased);
+      return;
+    }
+
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output_tensor));
 
@@ -641,19 +681,7 @@ class TensorArrayPackOrGatherOp : public OpKernel {
     input_tensors_flat.reserve(num_indices);
     auto output_flat =
         output_tensor->shaped<T, 2>({1, output_shape.num_elements()});
-
-    // Insert the first value
-    input_tensors_flat.emplace_back(new ConstMatrix(
-        value_0_t->shaped<T, 2>({1, value_0_t->NumElements()})));
-
-    for (int i = 1; i < num_indices; ++i) {
-      const Tensor* value_t = values[i].AccessTensor(ctx);
-      OP_REQUIRES(
-          ctx, value_0_t->shape() == value_t->shape(),
-          errors::InvalidArgument(
-              "TensorArray has inconsistent shapes.  Index 0 has shape: ",
-              value_0_t->shape().DebugString(), " but index ", i,
-              " has shape: ", value_t->shape().DebugString()));
+    for (const Tensor* value_t : value_tensors) {
       input_tensors_flat.emplace_back(
           new ConstMatrix(value_t->shaped<T, 2>({1, value_t->NumElements()})));
     }
@@ -875,6 +903,14 @@ class TensorArrayConcatOp : public OpKernel {
       }
     }
 
+    // Elements that are still adjacent in one buffer, e.g. those written by
+    // Split, need no copy.
+    Tensor aliased;
+    if (Tensor::FromAdjacentSlices(value_tensors, output_shape, &aliased)) {
+      ctx->set_output(0, aliased);
+      return;
+    }
+
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output_tensor));
     ConstMatrixVector input_tensors_flat;
@@ -1087,6 +1123,11 @@ class TensorArrayUnpackOrScatterOp : public OpKernel {
     for (int i = 0; i < num_values; ++i) {
       Tensor* tensor_value_i;
       PersistentTensor persistent_tensor;
+      if (AliasRows(*tensor_value, i, i + 1, element_shape,
+                    &persistent_tensor)) {
+        write_values.push_back(persistent_tensor);
+        continue;
+      }
       OP_REQUIRES_OK(
           ctx, ctx->allocate_persistent(tensor_array->ElemType(), element_shape,
                                         &persistent_tensor, &tensor_value_i));
@@ -1276,6 +1317,11 @@ class TensorArraySplitOp : public OpKernel {
       Eigen::DSizes<Eigen::DenseIndex, 3> indices{0, previous_length, 0};
       Eigen::DSizes<Eigen::DenseIndex, 3> sizes{1, tensor_lengths_t(i),
                                                 elements_per_row};
+      if (AliasRows(*tensor_value, previous_length, cumulative_lengths[i],
+                    element_shapes[i], &persistent_tensor)) {
+        write_values.push_back(persistent_tensor);
+        continue;
+      }
 
       OP_REQUIRES_OK(ctx, ctx->allocate_persistent(
                               tensor_array->ElemType(), element_shapes[i],
@@ -17,6 +17,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,9 +26,75 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// The top k of up to this many are kept in a heap, above it they are
+// selected with std::nth_element. The heap only does work for the elements
+// that enter it, which are few when k is small compared to the row, while
+// selection is linear in the row whatever k.
+constexpr int kMaxHeapTopK = 256;
+
+// Rows are split in blocks of at least this many columns when there are
+// fewer rows than threads.
+constexpr int64 kMinTopKBlockCols = 1 << 15;
+
+namespace {
+
+// An element of a row and its column. The larger of two elements comes
+// first, and the one of lower column in case of ties.
+template <typename T>
+struct TopKEntry {
+  T value;
+  int32 index;
+};
+
+template <typename T>
+struct TopKGreater {
+  bool operator()(const TopKEntry<T>& a, const TopKEntry<T>& b) const {
+    return a.value > b.value || (a.value == b.value && a.index < b.index);
+  }
+};
+
+// Keeps the "k" first of "*entries", sorted if "sorted".
+template <typename T>
+void SelectTopK(int k, bool sorted, std::vector<TopKEntry<T>>* entries) {
+  if (k < static_cast<int64>(entries->size())) {
+    std::nth_element(entries->begin(), entries->begin() + k, entries->end(),
+                     TopKGreater<T>());
+    entries->resize(k);
+  }
+  if (sorted) {
+    std::sort(entries->begin(), entries->end(), TopKGreater<T>());
+  }
+}
+
+// Sets "*top" to the "k" first of the elements of "row" in columns
+// ["begin", "end"), or all of them if fewer, sorted if "sorted".
+template <typename T>
+void TopKOfColumns(const T* row, int32 begin, int32 end, int k, bool sorted,
+                   std::vector<TopKEntry<T>>* top) {
+  top->clear();
+  if (k <= kMaxHeapTopK) {
+    gtl::TopN<TopKEntry<T>, TopKGreater<T>> filter(k);
+    for (int32 c = begin; c < end; ++c) {
+      filter.push({row[c], c});
+    }
+    std::unique_ptr<std::vector<TopKEntry<T>>> extracted(
+        sorted ? filter.Extract() : filter.ExtractUnsorted());
+    top->swap(*extracted);
+  } else {
+    top->reserve(end - begin);
+    for (int32 c = begin; c < end; ++c) {
+      top->push_back({row[c], c});
+    }
+    SelectTopK(k, sorted, top);
+  }
+}
+
+}  // namespace
+
 template <typename T>
 class TopK : public OpKernel {
  public:
@@ -76,32 +144,67 @@ class TopK : public OpKernel {
 
     auto values = values_out->flat_inner_dims<T>();
     auto indices = indices_out->flat_inner_dims<int32>();
-    gtl::TopN<std::pair<T, int32>> filter(k);
-    for (int r = 0; r < num_rows; r++) {
-      for (int32 c = 0; c < num_cols; ++c) {
-        // The second element is the negated index, so that lower-index elements
-        // are considered larger than higher-index elements in case of ties.
-        filter.push(std::make_pair(input(r, c), -c));
+    auto write_row = [&values, &indices](
+        int64 r, const std::vector<TopKEntry<T>>& top) {
+      for (size_t i = 0; i < top.size(); ++i) {
+        values(r, i) = top[i].value;
+        indices(r, i) = top[i].index;
       }
-
-      int32 i = 0;
-      if (sorted_ && k > 1) {
-        std::unique_ptr<std::vector<std::pair<T, int32>>> top_k(
-            filter.Extract());
-        for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-             ++top_k_it, ++i) {
-          values(r, i) = top_k_it->first;
-          indices(r, i) = -top_k_it->second;
+    };
+
+    // Splits the rows in blocks of columns when there are too few rows to
+    // keep the threads busy, and there are many more columns than k in a
+    // block. The top k of a row are then the top k of those of its blocks.
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    int64 num_blocks = 1;
+    if (num_rows > 0 && num_rows < worker_threads.num_threads) {
+      num_blocks = std::min<int64>(
+          {worker_threads.num_threads / num_rows, num_cols / kMinTopKBlockCols,
+           num_cols / (4 * static_cast<int64>(k))});
+      num_blocks = std::max<int64>(num_blocks, 1);
+    }
+    const bool sorted = sorted_ && k > 1;
+    const int64 cost_per_col = k <= kMaxHeapTopK ? 10 : 20;
+    if (num_blocks == 1) {
+      auto work = [&input, num_cols, k, sorted, &write_row](int64 start,
+                                                            int64 limit) {
+        std::vector<TopKEntry<T>> top;
+        for (int64 r = start; r < limit; ++r) {
+          TopKOfColumns(&input(r, 0), 0, num_cols, k, sorted, &top);
+          write_row(r, top);
         }
-      } else {
-        for (auto top_k_it = filter.unsorted_begin();
-             top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-          values(r, i) = top_k_it->first;
-          indices(r, i) = -top_k_it->second;
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            num_cols * cost_per_col, work);
+      return;
+    }
+
+    const int64 block_cols = (num_cols + num_blocks - 1) / num_blocks;
+    std::vector<std::vector<TopKEntry<T>>> block_top(num_rows * num_blocks);
+    auto block_work = [&](int64 start, int64 limit) {
+      for (int64 b = start; b < limit; ++b) {
+        const int64 r = b / num_blocks;
+        const int64 begin = (b % num_blocks) * block_cols;
+        const int64 end = std::min<int64>(num_cols, begin + block_cols);
+        TopKOfColumns(&input(r, 0), begin, end, k, false, &block_top[b]);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_blocks, block_cols * cost_per_col, block_work);
+    auto merge_work = [&](int64 start, int64 limit) {
+      for (int64 r = start; r < limit; ++r) {
+        std::vector<TopKEntry<T>>& top = block_top[r * num_blocks];
+        for (int64 b = 1; b < num_blocks; ++b) {
+          const auto& other = block_top[r * num_blocks + b];
+          top.insert(top.end(), other.begin(), other.end());
         }
+        SelectTopK(k, sorted, &top);
+        write_row(r, top);
       }
-      filter.Reset();
-    }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          num_blocks * k * cost_per_col, merge_work);
   }
 
  private:
@@ -0,0 +1,130 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TopKOpTest : public OpsTestBase {
+ protected:
+  // Runs TopKV2 on "num_rows" rows of "num_cols" small random integers, so
+  // that there are many ties, and checks it against a stable sort of each
+  // row.
+  void Check(int num_rows, int num_cols, int k, bool sorted) {
+    inputs_.clear();
+    TF_ASSERT_OK(NodeDefBuilder("top_k", "TopKV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("sorted", sorted)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    random::PhiloxRandom philox(301, 17);
+    random::SimplePhilox rnd(&philox);
+    std::vector<float> input(num_rows * num_cols);
+    for (float& x : input) x = rnd.Uniform(1000);
+    AddInputFromArray<float>(TensorShape({num_rows, num_cols}), input);
+    AddInputFromArray<int32>(TensorShape({}), {k});
+    TF_ASSERT_OK(RunOpKernel());
+
+    auto values = GetOutput(0)->matrix<float>();
+    auto indices = GetOutput(1)->matrix<int32>();
+    for (int r = 0; r < num_rows; ++r) {
+      const float* row = &input[r * num_cols];
+      std::vector<int32> expected(num_cols);
+      std::iota(expected.begin(), expected.end(), 0);
+      std::stable_sort(expected.begin(), expected.end(),
+                       [row](int32 a, int32 b) { return row[a] > row[b]; });
+      expected.resize(k);
+      std::vector<int32> actual(&indices(r, 0), &indices(r, 0) + k);
+      if (!sorted) {
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+      }
+      ASSERT_EQ(expected, actual) << "row " << r;
+      for (int i = 0; i < k; ++i) {
+        EXPECT_EQ(row[indices(r, i)], values(r, i));
+      }
+    }
+  }
+};
+
+TEST_F(TopKOpTest, SmallK) {
+  Check(7, 1000, 5, true);
+  Check(7, 1000, 5, false);
+}
+
+TEST_F(TopKOpTest, LargeK) {
+  Check(5, 3000, 1000, true);
+  Check(5, 3000, 1000, false);
+  Check(3, 2000, 2000, true);
+}
+
+TEST_F(TopKOpTest, WideRow) {
+  Check(1, 300000, 10, true);
+  Check(1, 300000, 1000, true);
+  Check(2, 300000, 1000, false);
+}
+
+static Graph* TopK(int num_rows, int num_cols, int k) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({num_rows, num_cols}));
+  input.flat<float>().setRandom();
+  Tensor k_tensor(DT_INT32, TensorShape({}));
+  k_tensor.scalar<int32>()() = k;
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "TopKV2")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, k_tensor))
+                  .Finalize(g, &node));
+  return g;
+}
+
+#define BM_TopK(R, C, K)                                              \
+  static void BM_TopK_##R##_##C##_##K(int iters) {                    \
+    testing::UseRealTime();                                           \
+    testing::ItemsProcessed(static_cast<int64>(iters) * R * C);       \
+    test::Benchmark("cpu", TopK(R, C, K)).Run(iters);                 \
+  }                                                                   \
+  BENCHMARK(BM_TopK_##R##_##C##_##K);
+
+// Beam search over a large vocabulary.
+BM_TopK(1, 1000000, 10);
+BM_TopK(1, 1000000, 1000);
+BM_TopK(8, 1000000, 1000);
+BM_TopK(128, 100000, 10);
+BM_TopK(128, 100000, 2000);
+BM_TopK(1024, 1000, 100);
+
+#undef BM_TopK
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
+
+#include <algorithm>
+
 #include "tensorflow/core/kernels/variable_ops.h"
 
 namespace tensorflow {
@@ -45,23 +48,19 @@ std::vector<mutex_lock> MaybeLockVariableInputMutexesInOrder(
     return locks;
   }
   std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
   for (auto input : input_ids) {
     mutex* mutex = GetTrainingVariableMutex(ctx, input);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
+    if (mutex != nullptr) {
       mutexes.push_back(mutex);
     }
   }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
-
-  for (auto input : acquire_order) {
-    mutex* mu = GetTrainingVariableMutex(ctx, input);
-    if (mu != nullptr) {
-      locks.emplace_back(*mu);
-    }
+  // The MultiApply ops lock the variables of many inputs, so sort instead of
+  // searching for the duplicates.
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
+  locks.reserve(mutexes.size());
+  for (mutex* mu : mutexes) {
+    locks.emplace_back(*mu);
   }
   return locks;
 }
@@ -17,11 +17,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_ops.h"
 #include <algorithm>
+#include <numeric>
+#include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -234,9 +237,9 @@ struct ApplyFtrl<CPUDevice, T> {
   }
 };
 
-template <typename T>
-struct ApplyMomentum<CPUDevice, T> {
-  void operator()(const CPUDevice& d, typename TTypes<T>::Flat var,
+template <typename Device, typename T>
+struct ApplyMomentumNonCuda {
+  void operator()(const Device& d, typename TTypes<T>::Flat var,
                   typename TTypes<T>::Flat accum,
                   typename TTypes<T>::ConstScalar lr,
                   typename TTypes<T>::ConstFlat grad,
@@ -250,6 +253,9 @@ struct ApplyMomentum<CPUDevice, T> {
   }
 };
 
+template <typename T>
+struct ApplyMomentum<CPUDevice, T> : ApplyMomentumNonCuda<CPUDevice, T> {};
+
 template <typename Device, typename T>
 struct ApplyAdamNonCuda {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -1228,6 +1234,77 @@ REGISTER_KERNELS(CPU, double);
 
 namespace {
 
+// Checks that the indices of a sparse update of a variable with
+// first_dim_size rows are in range, and copies them so that they cannot
+// change while the rows are updated.
+template <typename Tindex>
+Status CopySparseIndices(const Tensor& indices, Tindex first_dim_size,
+                         std::vector<Tindex>* copy) {
+  auto indices_vec = indices.vec<Tindex>();
+  copy->resize(indices_vec.size());
+  for (int64 i = 0; i < indices_vec.size(); ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+    (*copy)[i] = index;
+  }
+  return Status::OK();
+}
+
+// Calls update(i, indices[i]) for each i, splitting the calls among the CPU
+// worker threads. cost_per_update is the cost of a call in cycles.
+//
+// Unless hogwild is true, all the updates of a row are made by the same
+// thread in the order of i, so the result is the same as when updating in
+// order: the updates are bucketed by row first, which takes two passes over
+// the indices. If hogwild is true the updates are split among the threads as
+// they are, and the updates of duplicate indices race.
+template <typename Tindex, typename Update>
+void ParallelSparseUpdate(OpKernelContext* ctx,
+                          const std::vector<Tindex>& indices,
+                          int64 cost_per_update, bool hogwild,
+                          const Update& update) {
+  const int64 n = indices.size();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  const int num_threads = worker_threads->num_threads;
+  // Below this cost the updates are not worth splitting.
+  const int64 kMinParallelCost = 10000;
+  if (num_threads <= 1 || n * cost_per_update < kMinParallelCost) {
+    for (int64 i = 0; i < n; ++i) update(i, indices[i]);
+    return;
+  }
+  if (hogwild) {
+    Shard(num_threads, worker_threads->workers, n, cost_per_update,
+          [&indices, &update](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) update(i, indices[i]);
+          });
+    return;
+  }
+
+  // Sort the updates by bucket of rows, keeping them in order in a bucket.
+  // There are more buckets than threads to balance skewed indices.
+  const int64 num_buckets = std::min<int64>(n, 4 * num_threads);
+  std::vector<int64> bucket_begin(num_buckets + 1, 0);
+  for (const Tindex index : indices) ++bucket_begin[index % num_buckets + 1];
+  for (int64 b = 0; b < num_buckets; ++b) {
+    bucket_begin[b + 1] += bucket_begin[b];
+  }
+  std::vector<int64> order(n);
+  std::vector<int64> bucket_end(bucket_begin.begin(), bucket_begin.end() - 1);
+  for (int64 i = 0; i < n; ++i) {
+    order[bucket_end[indices[i] % num_buckets]++] = i;
+  }
+  Shard(num_threads, worker_threads->workers, num_buckets,
+        cost_per_update * n / num_buckets,
+        [&indices, &update, &bucket_begin, &order](int64 begin, int64 end) {
+          for (int64 k = bucket_begin[begin]; k < bucket_begin[end]; ++k) {
+            update(order[k], indices[order[k]]);
+          }
+        });
+}
+
 template <typename T>
 inline T FtrlCompute(const T& accum, const T& linear, const T& lr, const T& l1,
                      const T& l2, const T& lr_power) {
@@ -1252,6 +1329,7 @@ class SparseApplyAdagradOp : public OpKernel {
  public:
   explicit SparseApplyAdagradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("hogwild", &hogwild_));
   }
 
   void Compute(OpKernelContext* ctx) override NO_THREAD_SAFETY_ANALYSIS {
@@ -1306,47 +1384,35 @@ class SparseApplyAdagradOp : public OpKernel {
                     "Inner dimension should be greater than zero."));
 
     if (N > 0) {
+      std::vector<Tindex> rows;
+      OP_REQUIRES_OK(ctx, CopySparseIndices<Tindex>(
+                              indices, var.dim_size(0), &rows));
+      T lr_scalar = lr.scalar<T>()();
       if (inner_dim > 1) {
-        const Tindex first_dim_size = var.dim_size(0);
-        auto indices_vec = indices.vec<Tindex>();
         auto var_flat = var.flat_outer_dims<T>();
         auto accum_flat = accum.flat_outer_dims<T>();
         auto grad_flat = grad.flat_outer_dims<T>();
-        T lr_scalar = lr.scalar<T>()();
 
-        // Note(yonghui): It might be worth multi-threading square() and
-        // rsqrt().
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
-                      errors::InvalidArgument(
-                          strings::StrCat("Index ", index, " at offset ", i,
-                                          " in indices is out of range")));
+        auto update = [&](int64 i, Tindex index) {
           auto a = accum_flat.template chip<0>(index);
           auto g = grad_flat.template chip<0>(i);
           auto v = var_flat.template chip<0>(index);
           a += g.square();
           v -= g.constant(lr_scalar) * g * a.rsqrt();
-        }
+        };
+        ParallelSparseUpdate(ctx, rows, 10 * inner_dim, hogwild_, update);
       } else {
-        auto indices_vec = indices.vec<Tindex>();
         auto var_flat = var.flat<T>();
         auto accum_flat = accum.flat<T>();
         auto grad_flat = grad.flat<T>();
-        T lr_scalar = lr.scalar<T>()();
-        const Tindex first_dim_size = accum_flat.size();
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
-                      errors::InvalidArgument(
-                          strings::StrCat("Index ", index, " at offset ", i,
-                                          " in indices is out of range")));
+        auto update = [&](int64 i, Tindex index) {
           T& a = accum_flat(index);
           const T& g = grad_flat(i);
           a += g * g;
           var_flat(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
-        }
+        };
+        ParallelSparseUpdate(ctx, rows, 20, hogwild_, update);
       }
     }
 
@@ -1355,6 +1421,7 @@ class SparseApplyAdagradOp : public OpKernel {
 
  private:
   bool use_exclusive_lock_;
+  bool hogwild_;
 };
 
 #define REGISTER_KERNELS(T, Tindices)                                \
@@ -1971,6 +2038,7 @@ class SparseApplyFtrlOp : public OpKernel {
  public:
   explicit SparseApplyFtrlOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("hogwild", &hogwild_));
   }
 
   void Compute(OpKernelContext* ctx) override NO_THREAD_SAFETY_ANALYSIS {
@@ -2062,24 +2130,20 @@ class SparseApplyFtrlOp : public OpKernel {
                     "Inner dimension should be greater than zero."));
 
     if (N > 0) {
+      std::vector<Tindex> rows;
+      OP_REQUIRES_OK(ctx, CopySparseIndices<Tindex>(
+                              indices, var.dim_size(0), &rows));
+      T lr_scalar = lr.scalar<T>()();
+      T l1_scalar = l1.scalar<T>()();
+      T l2_scalar = l2.scalar<T>()();
+      T lr_power_scalar = lr_power.scalar<T>()();
       if (inner_dim > 1) {
-        const Tindex first_dim_size = var.dim_size(0);
-        auto indices_vec = indices.vec<Tindex>();
         auto var_flat = var.flat_outer_dims<T>();
         auto accum_flat = accum.flat_outer_dims<T>();
         auto linear_flat = linear.flat_outer_dims<T>();
         auto grad_flat = grad.flat_outer_dims<T>();
-        T lr_scalar = lr.scalar<T>()();
-        T l1_scalar = l1.scalar<T>()();
-        T l2_scalar = l2.scalar<T>()();
-        T lr_power_scalar = lr_power.scalar<T>()();
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
-                      errors::InvalidArgument(
-                          strings::StrCat("Index ", index, " at offset ", i,
-                                          " in indices is out of range")));
+        auto update = [&](int64 i, Tindex index) {
           auto accum = accum_flat.template chip<0>(index);
           auto linear = linear_flat.template chip<0>(index);
           auto grad = grad_flat.template chip<0>(i);
@@ -2109,25 +2173,15 @@ class SparseApplyFtrlOp : public OpKernel {
           var = (linear.abs() > linear.constant(l1_scalar))
                     .select(var, var.constant(static_cast<T>(0)));
           accum += grad.square();
-        }
+        };
+        ParallelSparseUpdate(ctx, rows, 40 * inner_dim, hogwild_, update);
       } else {
-        auto indices_vec = indices.vec<Tindex>();
         auto var_flat = var.flat<T>();
         auto accum_flat = accum.flat<T>();
         auto linear_flat = linear.flat<T>();
         auto grad_flat = grad.flat<T>();
-        T lr_scalar = lr.scalar<T>()();
-        T l1_scalar = l1.scalar<T>()();
-        T l2_scalar = l2.scalar<T>()();
-        T lr_power_scalar = lr_power.scalar<T>()();
-        const Tindex first_dim_size = accum_flat.size();
 
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
-                      errors::InvalidArgument(
-                          strings::StrCat("Index ", index, " at offset ", i,
-                                          " in indices is out of range")));
+        auto update = [&](int64 i, Tindex index) {
           T& a = accum_flat(index);
           T& l = linear_flat(index);
           T& v = var_flat(index);
@@ -2142,7 +2196,8 @@ class SparseApplyFtrlOp : public OpKernel {
                           lr_power_scalar);
           a = updated_a;
           l = updated_l;
-        }
+        };
+        ParallelSparseUpdate(ctx, rows, 60, hogwild_, update);
       }
     }
 
@@ -2151,6 +2206,7 @@ class SparseApplyFtrlOp : public OpKernel {
 
  private:
   bool use_exclusive_lock_;
+  bool hogwild_;
 };
 
 #define REGISTER_KERNELS(T, Tindices)                                 \
@@ -2655,6 +2711,316 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace {
+
+// The CPU kernels of the MultiApply ops split the variables into blocks of at
+// most this many elements, so that one parallel loop covers all of them.
+const int64 kMultiApplyBlockSize = 16 << 10;
+
+// Calls update(i, begin, size) for the blocks of the elements of vars[i], for
+// each i, from the CPU worker threads. cost_per_element is the cost of
+// updating an element in cycles.
+template <typename Update>
+void ShardVariableBlocks(OpKernelContext* ctx, const std::vector<Tensor>& vars,
+                         int64 cost_per_element, const Update& update) {
+  struct Block {
+    int var;
+    int64 begin;
+    int64 size;
+  };
+  std::vector<Block> blocks;
+  int64 num_elements = 0;
+  for (int i = 0; i < vars.size(); ++i) {
+    const int64 size = vars[i].NumElements();
+    for (int64 begin = 0; begin < size; begin += kMultiApplyBlockSize) {
+      blocks.push_back(
+          {i, begin, std::min(kMultiApplyBlockSize, size - begin)});
+    }
+    num_elements += size;
+  }
+  if (blocks.empty()) return;
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, blocks.size(),
+        cost_per_element * num_elements / blocks.size(),
+        [&blocks, &update](int64 begin, int64 end) {
+          for (int64 b = begin; b < end; ++b) {
+            update(blocks[b].var, blocks[b].begin, blocks[b].size);
+          }
+        });
+}
+
+template <typename T>
+typename TTypes<T>::Flat FlatBlock(Tensor* t, int64 begin, int64 size) {
+  return typename TTypes<T>::Flat(t->flat<T>().data() + begin, size);
+}
+
+template <typename T>
+typename TTypes<T>::ConstFlat ConstFlatBlock(const Tensor& t, int64 begin,
+                                             int64 size) {
+  return typename TTypes<T>::ConstFlat(t.flat<T>().data() + begin, size);
+}
+
+// Gets the variables of the lists of num_vars ref inputs that the inputs of a
+// MultiApply op start with, list l into *lists[l]. names are the names of the
+// lists, the first one being the variables that the others are the slots of.
+Status GetMultiApplyVariables(OpKernelContext* ctx, int num_vars,
+                              bool lock_held,
+                              const std::vector<const char*>& names,
+                              const std::vector<std::vector<Tensor>*>& lists) {
+  for (int l = 0; l < lists.size(); ++l) {
+    lists[l]->resize(num_vars);
+    for (int i = 0; i < num_vars; ++i) {
+      const int input = l * num_vars + i;
+      Tensor* t = &(*lists[l])[i];
+      TF_RETURN_IF_ERROR(GetInputTensorFromVariable(ctx, input, lock_held, t));
+      if (!t->IsInitialized()) {
+        return errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ",
+            ctx->op_kernel().def().input(input));
+      }
+      const Tensor& var = (*lists[0])[i];
+      if (!var.shape().IsSameSize(t->shape())) {
+        return errors::InvalidArgument(
+            names[0], " and ", names[l], " ", i, " do not have the same shape",
+            var.shape().DebugString(), " ", t->shape().DebugString());
+      }
+    }
+  }
+  return Status::OK();
+}
+
+// Gets the num_vars gradients at first_input, and checks that they have the
+// shapes of the variables.
+Status GetMultiApplyGradients(OpKernelContext* ctx, int first_input,
+                              const std::vector<Tensor>& vars,
+                              std::vector<Tensor>* grads) {
+  for (int i = 0; i < vars.size(); ++i) {
+    const Tensor& grad = ctx->input(first_input + i);
+    if (!vars[i].shape().IsSameSize(grad.shape())) {
+      return errors::InvalidArgument(
+          "var and grad ", i, " do not have the same shape",
+          vars[i].shape().DebugString(), " ", grad.shape().DebugString());
+    }
+    grads->push_back(grad);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+namespace functor {
+
+// Updates the variables one after the other, with a kernel of the device
+// for each.
+template <typename Device, typename T>
+struct MultiApplyMomentum {
+  void operator()(OpKernelContext* ctx, std::vector<Tensor>* var,
+                  std::vector<Tensor>* accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const std::vector<Tensor>& grad,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov) {
+    const Device& d = ctx->template eigen_device<Device>();
+    for (int i = 0; i < var->size(); ++i) {
+      ApplyMomentum<Device, T>()(d, (*var)[i].flat<T>(), (*accum)[i].flat<T>(),
+                                 lr, grad[i].flat<T>(), momentum, use_nesterov);
+    }
+  }
+};
+
+template <typename T>
+struct MultiApplyMomentum<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, std::vector<Tensor>* var,
+                  std::vector<Tensor>* accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const std::vector<Tensor>& grad,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov) {
+    ShardVariableBlocks(ctx, *var, 5, [&](int i, int64 begin, int64 size) {
+      ApplyMomentumNonCuda<Eigen::DefaultDevice, T>()(
+          Eigen::DefaultDevice(), FlatBlock<T>(&(*var)[i], begin, size),
+          FlatBlock<T>(&(*accum)[i], begin, size), lr,
+          ConstFlatBlock<T>(grad[i], begin, size), momentum, use_nesterov);
+    });
+  }
+};
+
+template <typename Device, typename T>
+struct MultiApplyAdam {
+  void operator()(OpKernelContext* ctx, std::vector<Tensor>* var,
+                  std::vector<Tensor>* m, std::vector<Tensor>* v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<Tensor>& grad, bool use_nesterov) {
+    const Device& d = ctx->template eigen_device<Device>();
+    for (int i = 0; i < var->size(); ++i) {
+      ApplyAdam<Device, T>()(d, (*var)[i].flat<T>(), (*m)[i].flat<T>(),
+                             (*v)[i].flat<T>(), beta1_power, beta2_power, lr,
+                             beta1, beta2, epsilon, grad[i].flat<T>(),
+                             use_nesterov);
+    }
+  }
+};
+
+template <typename T>
+struct MultiApplyAdam<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, std::vector<Tensor>* var,
+                  std::vector<Tensor>* m, std::vector<Tensor>* v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<Tensor>& grad, bool use_nesterov) {
+    ShardVariableBlocks(ctx, *var, 20, [&](int i, int64 begin, int64 size) {
+      ApplyAdamNonCuda<Eigen::DefaultDevice, T>()(
+          Eigen::DefaultDevice(), FlatBlock<T>(&(*var)[i], begin, size),
+          FlatBlock<T>(&(*m)[i], begin, size),
+          FlatBlock<T>(&(*v)[i], begin, size), beta1_power, beta2_power,
+          lr, beta1, beta2, epsilon,
+          ConstFlatBlock<T>(grad[i], begin, size), use_nesterov);
+    });
+  }
+};
+
+}  // namespace functor
+
+template <typename Device, typename T>
+class MultiApplyMomentumOp : public OpKernel {
+ public:
+  explicit MultiApplyMomentumOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> ref_inputs(2 * n);
+    std::iota(ref_inputs.begin(), ref_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      ref_inputs);
+
+    std::vector<Tensor> var, accum;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables(ctx, n, use_exclusive_lock_,
+                                               {"var", "accum"},
+                                               {&var, &accum}));
+    const Tensor& lr = ctx->input(2 * n);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    std::vector<Tensor> grad;
+    OP_REQUIRES_OK(ctx, GetMultiApplyGradients(ctx, 2 * n + 1, var, &grad));
+    const Tensor& momentum = ctx->input(3 * n + 1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(momentum.shape()),
+                errors::InvalidArgument("momentum is not a scalar: ",
+                                        momentum.shape().DebugString()));
+
+    functor::MultiApplyMomentum<Device, T>()(ctx, &var, &accum, lr.scalar<T>(),
+                                             grad, momentum.scalar<T>(),
+                                             use_nesterov_);
+    for (int i = 0; i < n; ++i) {
+      MaybeForwardRefInputToRefOutput(ctx, i, i);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+template <typename Device, typename T>
+class MultiApplyAdamOp : public OpKernel {
+ public:
+  explicit MultiApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> ref_inputs(3 * n);
+    std::iota(ref_inputs.begin(), ref_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      ref_inputs);
+
+    std::vector<Tensor> var, m, v;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables(ctx, n, use_exclusive_lock_,
+                                               {"var", "m", "v"},
+                                               {&var, &m, &v}));
+
+    const Tensor& beta1_power = ctx->input(3 * n);
+    const Tensor& beta2_power = ctx->input(3 * n + 1);
+    const Tensor& lr = ctx->input(3 * n + 2);
+    const Tensor& beta1 = ctx->input(3 * n + 3);
+    const Tensor& beta2 = ctx->input(3 * n + 4);
+    const Tensor& epsilon = ctx->input(3 * n + 5);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    std::vector<Tensor> grad;
+    OP_REQUIRES_OK(ctx, GetMultiApplyGradients(ctx, 3 * n + 6, var, &grad));
+
+    functor::MultiApplyAdam<Device, T>()(
+        ctx, &var, &m, &v, beta1_power.scalar<T>(), beta2_power.scalar<T>(),
+        lr.scalar<T>(), beta1.scalar<T>(), beta2.scalar<T>(),
+        epsilon.scalar<T>(), grad, use_nesterov_);
+    for (int i = 0; i < n; ++i) {
+      MaybeForwardRefInputToRefOutput(ctx, i, i);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                                              \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("MultiApplyMomentum").Device(DEVICE_##D).TypeConstraint<T>("T"), \
+      MultiApplyMomentumOp<D##Device, T>);                                  \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("MultiApplyAdam").Device(DEVICE_##D).TypeConstraint<T>("T"),     \
+      MultiApplyAdamOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA
+// The GPU kernels launch the ApplyMomentum and ApplyAdam kernels declared
+// above for each variable.
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyRMSPropOp : public OpKernel {
  public:
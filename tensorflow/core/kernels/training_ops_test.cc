@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -117,6 +118,59 @@ static void BM_Adagrad(int iters, int params) {
 }
 BENCHMARK(BM_Adagrad)->Arg(128 << 10)->Arg(256 << 10);
 
+// Updates num_updates rows of 64 floats spread over a variable of n rows, with
+// the worker threads of the device.
+static void SparseAdagrad(int32 n, int32 num_updates, bool hogwild,
+                          Graph** init_g, Graph** train_g) {
+  const TensorShape shape({n, 64});
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = test::graph::Var(g, DT_FLOAT, shape);
+    auto accum = test::graph::Var(g, DT_FLOAT, shape);
+    Tensor zeros(DT_FLOAT, shape);
+    zeros.flat<float>().setZero();
+    auto zero = test::graph::Constant(g, zeros);
+    test::graph::Assign(g, var, zero);
+    test::graph::Assign(g, accum, zero);
+    *init_g = g;
+  }
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    auto var = test::graph::Var(g, DT_FLOAT, shape);
+    auto accum = test::graph::Var(g, DT_FLOAT, shape);
+    Tensor grad(DT_FLOAT, TensorShape({num_updates, 64}));
+    grad.flat<float>().setRandom();
+    Tensor indices(DT_INT32, TensorShape({num_updates}));
+    for (int32 i = 0; i < num_updates; ++i) {
+      indices.flat<int32>()(i) = (i * 7919) % n;
+    }
+    Node* ret;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseApplyAdagrad")
+                    .Input(var)
+                    .Input(accum)
+                    .Input(Scalar(g, 0.01))
+                    .Input(test::graph::Constant(g, grad))
+                    .Input(test::graph::Constant(g, indices))
+                    .Attr("hogwild", hogwild)
+                    .Finalize(g, &ret));
+    *train_g = g;
+  }
+}
+
+static void BM_SparseAdagrad(int iters, int num_updates, int hogwild) {
+  const int64 tot = static_cast<int64>(iters) * num_updates;
+  testing::UseRealTime();
+  testing::ItemsProcessed(tot);
+  Graph* init;
+  Graph* train;
+  SparseAdagrad(64 << 10, num_updates, hogwild, &init, &train);
+  test::Benchmark("cpu", train, nullptr, init).Run(iters);
+}
+BENCHMARK(BM_SparseAdagrad)
+    ->ArgPair(1 << 10, 0)
+    ->ArgPair(16 << 10, 0)
+    ->ArgPair(16 << 10, 1);
+
 static void Momentum(int32 n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
@@ -17,32 +17,176 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/transpose_functor.h"
 
+#include <algorithm>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
 namespace tensorflow {
 namespace internal {
 
+// The number of elements along each side of the tiles transposed by
+// TransposeBlocked: the rows of a tile span one cache line.
+template <typename T>
+constexpr int64 TransposeBlockSize() {
+  return sizeof(T) >= 8 ? 8 : 64 / sizeof(T);
+}
+
+// Copies the "rows" x "cols" tile at "src", whose rows are "src_stride"
+// elements apart, to its transpose at "dst", whose rows are "dst_stride"
+// elements apart.
+template <typename T>
+inline void TransposeTile(const T* src, int64 src_stride, T* dst,
+                          int64 dst_stride, int64 rows, int64 cols) {
+  for (int64 r = 0; r < rows; ++r) {
+    for (int64 c = 0; c < cols; ++c) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+}
+
+// Same for a full "kBlock" x "kBlock" tile. The constant bounds let the
+// compiler unroll the loops and vectorize them.
+template <int64 kBlock, typename T>
+inline void TransposeTile(const T* src, int64 src_stride, T* dst,
+                          int64 dst_stride) {
+  for (int64 r = 0; r < kBlock; ++r) {
+    for (int64 c = 0; c < kBlock; ++c) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+}
+
+// A dimension iterated over by ForEachUnit, and how far the source and
+// destination move along it.
+struct TransposeLoopDim {
+  int64 count;
+  int64 src_step;
+  int64 dst_step;
+};
+
+typedef gtl::InlinedVector<TransposeLoopDim, 8> TransposeLoopDimsVec;
+
+// Calls "fn(src_offset, dst_offset, coords)" for the units [begin, end) of
+// the row-major iteration space "dims". The offsets are updated as the
+// coordinates advance, so only the first unit costs a division per dim.
+template <typename Fn>
+void ForEachUnit(const TransposeLoopDimsVec& dims, int64 begin, int64 end,
+                 Fn fn) {
+  const int n = dims.size();
+  TransposeDimsVec coords(n);
+  int64 src = 0;
+  int64 dst = 0;
+  int64 t = begin;
+  for (int i = n - 1; i >= 0; --i) {
+    coords[i] = t % dims[i].count;
+    t /= dims[i].count;
+    src += coords[i] * dims[i].src_step;
+    dst += coords[i] * dims[i].dst_step;
+  }
+  for (int64 unit = begin; unit < end; ++unit) {
+    fn(src, dst, coords);
+    for (int i = n - 1; i >= 0; --i) {
+      src += dims[i].src_step;
+      dst += dims[i].dst_step;
+      if (++coords[i] < dims[i].count) break;
+      src -= dims[i].count * dims[i].src_step;
+      dst -= dims[i].count * dims[i].dst_step;
+      coords[i] = 0;
+    }
+  }
+}
+
+// Transposes the tensor of shape "in_dims" at "in" into "out" according to
+// "perm", sharding the work over the threads of "d".
+//
+// If the innermost dimension stays innermost, the rows along it are copied
+// as they are. Otherwise, the output dimension that is innermost in the
+// input and the innermost output dimension are transposed tile by tile,
+// so that both the reads and the writes of a tile stay in cache.
+//
+// The dimensions are expected to be reduced by ReduceTransposeDimensions.
 template <typename Device, typename T>
-void TransposeSimple(const Device& d, const Tensor& in,
-                     const gtl::ArraySlice<int32> perm, Tensor* out) {
-  const int ndims = in.dims();
-  gtl::InlinedVector<int64, 8> in_strides(ndims);
-  ComputeStride(in.shape(), in_strides.data());
-  gtl::InlinedVector<int64, 8> out_strides(ndims);
-  ComputeStride(out->shape(), out_strides.data());
-  const int64 nelem = in.NumElements();
-  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
-  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
-
-  // TODO(zhifengc): Shard by range.
-  // TODO(zhifengc): Avoids the division.
-  for (int64 o_idx = 0; o_idx < nelem; ++o_idx) {
-    int64 i_idx = 0;
-    int64 t = o_idx;
-    for (int i = 0; i < ndims; ++i) {
-      i_idx += (t / out_strides[i]) * in_strides[perm[i]];
-      t = t % out_strides[i];
+void TransposeBlocked(const Device& d, const T* in,
+                      const TransposeDimsVec& in_dims,
+                      const TransposePermsVec& perm, T* out) {
+  const int ndims = perm.size();
+  TransposeDimsVec in_strides(ndims);
+  int64 nelem = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    in_strides[i] = nelem;
+    nelem *= in_dims[i];
+  }
+  if (nelem == 0) return;
+  TransposeDimsVec out_dims(ndims);
+  TransposeDimsVec out_strides(ndims);
+  int64 stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_dims[i] = in_dims[perm[i]];
+    out_strides[i] = stride;
+    stride *= out_dims[i];
+  }
+
+  const int inner = ndims - 1;
+  TransposeLoopDimsVec loop_dims;
+  if (perm[inner] == inner) {
+    const int64 row_size = out_dims[inner];
+    for (int i = 0; i < inner; ++i) {
+      loop_dims.push_back({out_dims[i], in_strides[perm[i]], out_strides[i]});
     }
-    q[o_idx] = p[i_idx];
+    auto work = [&loop_dims, in, out, row_size](int64 begin, int64 end) {
+      ForEachUnit(loop_dims, begin, end,
+                  [in, out, row_size](int64 src, int64 dst,
+                                      const TransposeDimsVec& coords) {
+                    std::copy(in + src, in + src + row_size, out + dst);
+                  });
+    };
+    d.parallelFor(nelem / row_size,
+                  Eigen::TensorOpCost(row_size * sizeof(T),
+                                      row_size * sizeof(T), 0),
+                  work);
+    return;
   }
+
+  // The output dimension along which the input is contiguous, which is
+  // transposed with the innermost output dimension.
+  const int k = std::find(perm.begin(), perm.end(), inner) - perm.begin();
+  constexpr int64 kBlock = TransposeBlockSize<T>();
+  int64 num_units = 1;
+  for (int i = 0; i < inner; ++i) {
+    if (i == k) {
+      loop_dims.push_back({(out_dims[k] + kBlock - 1) / kBlock, kBlock,
+                           kBlock * out_strides[k]});
+    } else {
+      loop_dims.push_back({out_dims[i], in_strides[perm[i]], out_strides[i]});
+    }
+    num_units *= loop_dims.back().count;
+  }
+  const int64 size_k = out_dims[k];
+  const int64 size_inner = out_dims[inner];
+  const int64 src_stride = in_strides[perm[inner]];
+  const int64 dst_stride = out_strides[k];
+  auto work = [=, &loop_dims](int64 begin, int64 end) {
+    ForEachUnit(loop_dims, begin, end, [=](int64 src, int64 dst,
+                                           const TransposeDimsVec& coords) {
+      const int64 block_k = std::min(kBlock, size_k - coords[k] * kBlock);
+      for (int64 j = 0; j < size_inner; j += kBlock) {
+        const int64 block_inner = std::min(kBlock, size_inner - j);
+        const T* src_tile = in + src + j * src_stride;
+        T* dst_tile = out + dst + j;
+        if (block_k == kBlock && block_inner == kBlock) {
+          TransposeTile<kBlock>(src_tile, src_stride, dst_tile, dst_stride);
+        } else {
+          TransposeTile(src_tile, src_stride, dst_tile, dst_stride,
+                        block_inner, block_k);
+        }
+      }
+    });
+  };
+  const int64 unit_size = kBlock * size_inner;
+  d.parallelFor(num_units,
+                Eigen::TensorOpCost(unit_size * sizeof(T),
+                                    unit_size * sizeof(T), unit_size),
+                work);
 }
 
 template <typename Device, typename T, int NDIMS>
@@ -67,23 +211,14 @@ template <typename T>
 struct Transpose<CPUDevice, T> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
-    switch (in.dims()) {
-      case 2:
-        internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, out);
-        break;
-      case 3:
-        internal::TransposeUsingEigen<CPUDevice, T, 3>(d, in, perm, out);
-        break;
-      case 4:
-        internal::TransposeUsingEigen<CPUDevice, T, 4>(d, in, perm, out);
-        break;
-      case 5:
-        internal::TransposeUsingEigen<CPUDevice, T, 5>(d, in, perm, out);
-        break;
-      default:
-        internal::TransposeSimple<CPUDevice, T>(d, in, perm, out);
-        break;
-    }
+    internal::TransposePermsVec new_perm;
+    internal::TransposeDimsVec new_dims;
+    internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm,
+                                        &new_dims);
+    internal::TransposeBlocked<CPUDevice, T>(
+        d, reinterpret_cast<const T*>(in.tensor_data().data()), new_dims,
+        new_perm,
+        reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data())));
   }
 };
 
@@ -0,0 +1,192 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/common_runtime/eigen_thread_pool.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+TensorShape PermutedShape(const TensorShape& shape,
+                          const std::vector<int32>& perm) {
+  TensorShape out;
+  for (int32 d : perm) out.AddDim(shape.dim_size(d));
+  return out;
+}
+
+// Element-by-element transpose, to check the others against.
+template <typename T>
+Tensor ReferenceTranspose(const Tensor& in, const std::vector<int32>& perm) {
+  Tensor out(in.dtype(), PermutedShape(in.shape(), perm));
+  const int ndims = in.dims();
+  std::vector<int64> in_strides(ndims);
+  std::vector<int64> out_strides(ndims);
+  internal::ComputeStride(in.shape(), in_strides.data());
+  internal::ComputeStride(out.shape(), out_strides.data());
+  auto x = in.flat<T>();
+  auto y = out.flat<T>();
+  for (int64 o = 0; o < out.NumElements(); ++o) {
+    int64 i = 0;
+    int64 t = o;
+    for (int d = 0; d < ndims; ++d) {
+      i += (t / out_strides[d]) * in_strides[perm[d]];
+      t %= out_strides[d];
+    }
+    y(o) = x(i);
+  }
+  return out;
+}
+
+class TransposeFunctorTest : public ::testing::Test {
+ protected:
+  TransposeFunctorTest()
+      : threadpool_(Env::Default(), "test", 4 /* num_threads */),
+        wrapper_(&threadpool_),
+        device_(&wrapper_, 4 /* num_threads */) {}
+
+  template <typename T>
+  void Check(const TensorShape& shape, const std::vector<int32>& perm) {
+    Tensor in(DataTypeToEnum<T>::v(), shape);
+    auto x = in.flat<T>();
+    for (int64 i = 0; i < x.size(); ++i) {
+      x(i) = static_cast<T>(i * 7 + 1);
+    }
+    Tensor out(in.dtype(), PermutedShape(shape, perm));
+    TF_ASSERT_OK(DoTranspose(device_, in, perm, &out));
+    test::ExpectTensorEqual<T>(ReferenceTranspose<T>(in, perm), out);
+  }
+
+  thread::ThreadPool threadpool_;
+  EigenThreadPoolWrapper wrapper_;
+  CPUDevice device_;
+};
+
+TEST_F(TransposeFunctorTest, Matrix) {
+  // Not multiples of the tile sizes.
+  Check<uint8>({130, 67}, {1, 0});
+  Check<uint16>({33, 65}, {1, 0});
+  Check<float>({17, 100}, {1, 0});
+  Check<double>({9, 31}, {1, 0});
+  Check<complex128>({5, 19}, {1, 0});
+  Check<float>({1, 100}, {1, 0});
+}
+
+TEST_F(TransposeFunctorTest, KeepsInnermostDimension) {
+  Check<float>({3, 40, 50}, {1, 0, 2});
+  Check<uint8>({2, 3, 4, 5}, {2, 0, 1, 3});
+}
+
+TEST_F(TransposeFunctorTest, HigherRanks) {
+  Check<uint8>({5, 70, 30}, {2, 0, 1});
+  Check<double>({4, 9, 11, 13}, {1, 3, 0, 2});
+  Check<uint16>({3, 2, 4, 5, 6, 7}, {5, 3, 1, 0, 4, 2});
+  Check<float>({2, 3, 4, 5, 6, 7, 2}, {6, 0, 1, 2, 3, 5, 4});
+}
+
+TEST_F(TransposeFunctorTest, Strings) {
+  Tensor in(DT_STRING, TensorShape({3, 20, 9}));
+  auto x = in.flat<string>();
+  for (int64 i = 0; i < x.size(); ++i) {
+    x(i) = strings::StrCat("s", i);
+  }
+  const std::vector<int32> perm = {2, 0, 1};
+  Tensor out(DT_STRING, PermutedShape(in.shape(), perm));
+  TF_ASSERT_OK(DoTranspose(device_, in, perm, &out));
+  test::ExpectTensorEqual<string>(ReferenceTranspose<string>(in, perm), out);
+}
+
+TEST_F(TransposeFunctorTest, Empty) {
+  Check<float>({0, 5, 3}, {2, 0, 1});
+}
+
+enum class TransposeImpl { kDoTranspose, kEigenShuffle };
+
+template <typename T, int NDIMS>
+void RunTransposeBenchmark(int iters, TransposeImpl impl,
+                           const TensorShape& shape,
+                           const std::vector<int32>& perm) {
+  testing::StopTiming();
+  const int num_threads = port::NumSchedulableCPUs();
+  thread::ThreadPool threadpool(Env::Default(), "benchmark", num_threads);
+  EigenThreadPoolWrapper wrapper(&threadpool);
+  CPUDevice device(&wrapper, num_threads);
+  Tensor in(DataTypeToEnum<T>::v(), shape);
+  in.flat<T>().setZero();
+  Tensor out(in.dtype(), PermutedShape(shape, perm));
+  Eigen::array<int, NDIMS> p;
+  for (int i = 0; i < NDIMS; ++i) p[i] = perm[i];
+
+  testing::BytesProcessed(static_cast<int64>(iters) * in.TotalBytes() * 2);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    if (impl == TransposeImpl::kDoTranspose) {
+      TF_CHECK_OK(DoTranspose(device, in, perm, &out));
+    } else {
+      out.tensor<T, NDIMS>().device(device) =
+          in.tensor<T, NDIMS>().shuffle(p);
+    }
+  }
+}
+
+#define BM_TRANSPOSE(NAME, T, NDIMS, SHAPE, PERM)                          \
+  static void BM_Transpose_##NAME(int iters) {                            \
+    RunTransposeBenchmark<T, NDIMS>(iters, TransposeImpl::kDoTranspose,   \
+                                    TensorShape(SHAPE), PERM);            \
+  }                                                                       \
+  BENCHMARK(BM_Transpose_##NAME);                                         \
+  static void BM_EigenShuffle_##NAME(int iters) {                         \
+    RunTransposeBenchmark<T, NDIMS>(iters, TransposeImpl::kEigenShuffle,  \
+                                    TensorShape(SHAPE), PERM);            \
+  }                                                                       \
+  BENCHMARK(BM_EigenShuffle_##NAME);
+
+#define SHAPE(...) \
+  { __VA_ARGS__ }
+#define PERM(...) \
+  std::vector<int32> { __VA_ARGS__ }
+
+BM_TRANSPOSE(Float2D, float, 2, SHAPE(1024, 1024), PERM(1, 0));
+BM_TRANSPOSE(Uint8_2D, uint8, 2, SHAPE(2048, 2048), PERM(1, 0));
+BM_TRANSPOSE(Float3D, float, 3, SHAPE(64, 256, 256), PERM(0, 2, 1));
+BM_TRANSPOSE(Half3D, Eigen::half, 3, SHAPE(64, 256, 256), PERM(2, 0, 1));
+BM_TRANSPOSE(Float4DNHWCToNCHW, float, 4, SHAPE(32, 56, 56, 64),
+             PERM(0, 3, 1, 2));
+BM_TRANSPOSE(Uint8_5D, uint8, 5, SHAPE(16, 16, 16, 16, 64),
+             PERM(4, 2, 0, 3, 1));
+BM_TRANSPOSE(Float6D, float, 6, SHAPE(8, 8, 8, 8, 8, 32),
+             PERM(5, 1, 3, 0, 2, 4));
+
+#undef PERM
+#undef SHAPE
+#undef BM_TRANSPOSE
+
+}  // namespace
+}  // namespace tensorflow
@@ -49,9 +49,14 @@ class TypedConditionalAccumulatorBase : public ConditionalAccumulatorBase {
    * ctx:        Context in which the op is executed.
    */
   void TryApplyGrad(int64 local_step, OpKernelContext* ctx) override {
+    // A stale gradient is dropped right away, without queueing up on mu_
+    // behind the gradients being added.
+    if (DropIfStale(local_step)) return;
     {
       mutex_lock l(mu_);
-      if (local_step >= current_global_step_) {
+      if (local_step < current_global_step_) {
+        num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      } else {
         GradientTensorType* grad = nullptr;
         bool is_valid = GetAndValidateTensorInputForApplyGrad(ctx, &grad);
         if (is_valid) {
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <functional>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -21,11 +24,39 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+// Inputs with fewer elements than twice this are made unique by a single
+// thread. Larger ones are split into partitions of at least this many
+// elements, each made unique by its own thread.
+constexpr int64 kMinUniquePartitionSize = 1 << 15;
+
+// std::hash is the identity on integers, which gtl::FlatMap does not expect:
+// it takes its buckets from the middle bits and its partitions here from the
+// high bits. Mixes the bits with the finalizer of MurmurHash3.
+template <typename T>
+struct UniqueHash {
+  uint64 operator()(const T& key) const {
+    uint64 h = static_cast<uint64>(std::hash<T>()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
+template <>
+struct UniqueHash<string> {
+  uint64 operator()(const string& key) const { return Hash64(key); }
+};
+
 template <typename T>
 class UniqueOp : public OpKernel {
  public:
@@ -50,7 +81,16 @@ class UniqueOp : public OpKernel {
                                 {0}, 1, input.shape(), &idx));
     auto idx_vec = idx->template vec<int32>();
 
-    gtl::FlatMap<T, int32> uniq(N);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 num_partitions = std::min<int64>(
+        worker_threads.num_threads, N / kMinUniquePartitionSize);
+    if (num_partitions > 1) {
+      ParallelUnique(context, Tin, idx_vec, num_partitions);
+      return;
+    }
+
+    gtl::FlatMap<T, int32, UniqueHash<T>> uniq(N);
     for (int64 i = 0, j = 0; i < N; ++i) {
       auto it = uniq.insert(std::make_pair(Tin(i), j));
       idx_vec(i) = it.first->second;
@@ -78,6 +118,143 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Runs "fn(p)" for each of the "num_partitions" partitions, each on its
+  // own thread.
+  static void ForEachPartition(const DeviceBase::CpuWorkerThreads& workers,
+                               int64 num_partitions, int64 cost_per_partition,
+                               const std::function<void(int64)>& fn) {
+    Shard(workers.num_threads, workers.workers, num_partitions,
+          cost_per_partition, [&fn](int64 start, int64 limit) {
+            for (int64 p = start; p < limit; ++p) fn(p);
+          });
+  }
+
+  // Same as the serial loop of Compute, with the elements hash partitioned
+  // so that the partitions are made unique in parallel. The elements of each
+  // partition are visited in their order, and the unique elements are then
+  // numbered in the order of their first occurrence over all partitions,
+  // so the outputs are exactly those of the serial loop.
+  void ParallelUnique(OpKernelContext* context,
+                      typename TTypes<T>::ConstVec Tin,
+                      typename TTypes<int32>::Vec idx_vec,
+                      int64 num_partitions) {
+    const DeviceBase::CpuWorkerThreads& workers =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 N = Tin.size();
+    const int64 cost_per_partition = 100 * (N / num_partitions);
+    const UniqueHash<T> hasher;
+
+    // Groups the positions of the elements by partition. Each of as many
+    // chunks of the input as partitions counts its elements per partition,
+    // and then scatters their positions in order after those of the chunks
+    // before it.
+    const int64 chunk_size = (N + num_partitions - 1) / num_partitions;
+    std::vector<int32> partition_of(N);
+    std::vector<int64> offsets(num_partitions * num_partitions, 0);
+    ForEachPartition(
+        workers, num_partitions, cost_per_partition, [&](int64 chunk) {
+          int64* counts = &offsets[chunk * num_partitions];
+          const int64 limit = std::min(N, (chunk + 1) * chunk_size);
+          for (int64 i = chunk * chunk_size; i < limit; ++i) {
+            const uint64 h = hasher(Tin(i)) >> 32;
+            const int32 p = static_cast<int32>((h * num_partitions) >> 32);
+            partition_of[i] = p;
+            ++counts[p];
+          }
+        });
+    // Partition "p" starts at partition_start[p], and its elements from
+    // chunk "c" at offsets[c * num_partitions + p].
+    std::vector<int64> partition_start(num_partitions + 1, 0);
+    for (int64 p = 0, total = 0; p < num_partitions; ++p) {
+      partition_start[p] = total;
+      for (int64 c = 0; c < num_partitions; ++c) {
+        const int64 count = offsets[c * num_partitions + p];
+        offsets[c * num_partitions + p] = total;
+        total += count;
+      }
+    }
+    partition_start[num_partitions] = N;
+    std::vector<int32> positions(N);
+    ForEachPartition(
+        workers, num_partitions, cost_per_partition, [&](int64 chunk) {
+          int64* next = &offsets[chunk * num_partitions];
+          const int64 limit = std::min(N, (chunk + 1) * chunk_size);
+          for (int64 i = chunk * chunk_size; i < limit; ++i) {
+            positions[next[partition_of[i]]++] = static_cast<int32>(i);
+          }
+        });
+
+    // Makes each partition unique, numbering its unique elements in the
+    // order of their first occurrence, which are marked in "rank". "idx" may
+    // be forwarded from the input, so each element is read before its index
+    // is written, and the unique elements are kept aside.
+    std::vector<std::vector<int32>> firsts(num_partitions);
+    std::vector<std::vector<T>> uniq_values(num_partitions);
+    std::vector<int32> rank(N, 0);
+    ForEachPartition(
+        workers, num_partitions, cost_per_partition, [&](int64 p) {
+          const int64 start = partition_start[p];
+          const int64 limit = partition_start[p + 1];
+          gtl::FlatMap<T, int32, UniqueHash<T>> uniq(limit - start);
+          std::vector<int32>& first = firsts[p];
+          for (int64 k = start; k < limit; ++k) {
+            const int32 i = positions[k];
+            auto it = uniq.insert(
+                std::make_pair(Tin(i), static_cast<int32>(first.size())));
+            if (it.second) {
+              first.push_back(i);
+              uniq_values[p].push_back(it.first->first);
+              rank[i] = 1;
+            }
+            idx_vec(i) = it.first->second;
+          }
+        });
+
+    // The rank of a first occurrence among all of them is its index in the
+    // output.
+    int64 uniq_size = 0;
+    for (int64 i = 0; i < N; ++i) {
+      const int32 is_first = rank[i];
+      rank[i] = static_cast<int32>(uniq_size);
+      uniq_size += is_first;
+    }
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({uniq_size}), &output));
+    auto output_vec = output->template vec<T>();
+    Tensor* count_output = nullptr;
+    if (num_outputs() > 2) {
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &count_output));
+    }
+
+    // Renumbers the elements of each partition. The unique elements of the
+    // partitions are disjoint, so are the outputs they write.
+    ForEachPartition(
+        workers, num_partitions, cost_per_partition, [&](int64 p) {
+          const std::vector<int32>& first = firsts[p];
+          std::vector<int32> global_index(first.size());
+          for (size_t l = 0; l < first.size(); ++l) {
+            global_index[l] = rank[first[l]];
+            output_vec(global_index[l]) = uniq_values[p][l];
+          }
+          for (int64 k = partition_start[p]; k < partition_start[p + 1];
+               ++k) {
+            const int32 i = positions[k];
+            idx_vec(i) = global_index[idx_vec(i)];
+          }
+          if (count_output != nullptr) {
+            auto count_output_vec = count_output->template vec<int32>();
+            for (int32 index : global_index) count_output_vec(index) = 0;
+            for (int64 k = partition_start[p]; k < partition_start[p + 1];
+                 ++k) {
+              count_output_vec(idx_vec(positions[k]))++;
+            }
+          }
+        });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
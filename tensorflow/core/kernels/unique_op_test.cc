@@ -53,6 +53,30 @@ static void BM_Unique_INT32(int iters, int dim) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+// Ids drawn from "dim / 4" values, as are the ids of a batch of sparse
+// features.
+static void BM_Unique_INT64(int iters, int dim) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  auto input_flat = input.flat<int64>();
+  for (int i = 0; i < dim; ++i) {
+    input_flat(i) = std::rand() % (dim / 4 + 1);
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UniqueWithCounts")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -98,6 +122,13 @@ BENCHMARK(BM_Unique_INT32)
     ->Arg(64 * 1024)
     ->Arg(256 * 1024);
 
+BENCHMARK(BM_Unique_INT64)
+    ->Arg(1024)
+    ->Arg(64 * 1024)
+    ->Arg(256 * 1024)
+    ->Arg(1024 * 1024)
+    ->Arg(4 * 1024 * 1024);
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
@@ -43,8 +43,9 @@ class WindowDataset : public DatasetBase {
     explicit Iterator(const WindowDataset* dataset)
         : DatasetIterator<WindowDataset>(dataset) {}
 
-    Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                   bool* end_of_sequence) override {
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
       mutex_lock l(mu_);
       if (i_ == dataset()->elements_.size()) {
         *end_of_sequence = true;
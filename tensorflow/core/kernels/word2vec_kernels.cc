@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/guarded_philox_random.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -288,60 +289,73 @@ class NegTrainOp : public OpKernel {
                 errors::InvalidArgument("vocab_size mismatches: ", vocab_size,
                                         " vs. ", sampler_->num()));
 
-    // Gradient accumulator for v_in.
-    Tensor buf(DT_FLOAT, TensorShape({dims}));
-    auto Tbuf = buf.flat<float>();
-
-    // Scalar buffer to hold sigmoid(+/- dot).
-    Tensor g_buf(DT_FLOAT, TensorShape({}));
-    auto g = g_buf.scalar<float>();
-
-    // The following loop needs 2 random 32-bit values per negative
-    // sample.  We reserve 8 values per sample just in case the
-    // underlying implementation changes.
-    auto rnd = base_.ReserveSamples32(batch_size * num_samples_ * 8);
-    random::SimplePhilox srnd(&rnd);
-
-    for (int64 i = 0; i < batch_size; ++i) {
-      const int32 example = Texamples(i);
-      DCHECK(0 <= example && example < vocab_size) << example;
-      const int32 label = Tlabels(i);
-      DCHECK(0 <= label && label < vocab_size) << label;
-      auto v_in = Tw_in.chip<0>(example);
-
-      // Positive: example predicts label.
-      //   forward: x = v_in' * v_out
-      //            l = log(sigmoid(x))
-      //   backward: dl/dx = g = sigmoid(-x)
-      //             dl/d(v_in) = g * v_out'
-      //             dl/d(v_out) = v_in' * g
-      {
-        auto v_out = Tw_out.chip<0>(label);
-        auto dot = (v_in * v_out).sum();
-        g = (dot.exp() + 1.f).inverse();
-        Tbuf = v_out * (g() * lr);
-        v_out += v_in * (g() * lr);
-      }
+    // The examples are sharded across the intra-op threads, which update
+    // w_in and w_out without locking, Hogwild style: two threads rarely
+    // update the same embedding at once, and a lost update is just noise in
+    // the SGD step.
+    auto train = [this, &Tw_in, &Tw_out, &Texamples, &Tlabels, lr, vocab_size,
+                  dims](int64 start, int64 limit) {
+      // Gradient accumulator for v_in.
+      Tensor buf(DT_FLOAT, TensorShape({dims}));
+      auto Tbuf = buf.flat<float>();
+
+      // Scalar buffer to hold sigmoid(+/- dot).
+      Tensor g_buf(DT_FLOAT, TensorShape({}));
+      auto g = g_buf.scalar<float>();
+
+      // The following loop needs 2 random 32-bit values per negative
+      // sample.  We reserve 8 values per sample just in case the
+      // underlying implementation changes.
+      auto rnd = base_.ReserveSamples32((limit - start) * num_samples_ * 8);
+      random::SimplePhilox srnd(&rnd);
+
+      for (int64 i = start; i < limit; ++i) {
+        const int32 example = Texamples(i);
+        DCHECK(0 <= example && example < vocab_size) << example;
+        const int32 label = Tlabels(i);
+        DCHECK(0 <= label && label < vocab_size) << label;
+        auto v_in = Tw_in.chip<0>(example);
+
+        // Positive: example predicts label.
+        //   forward: x = v_in' * v_out
+        //            l = log(sigmoid(x))
+        //   backward: dl/dx = g = sigmoid(-x)
+        //             dl/d(v_in) = g * v_out'
+        //             dl/d(v_out) = v_in' * g
+        {
+          auto v_out = Tw_out.chip<0>(label);
+          auto dot = (v_in * v_out).sum();
+          g = (dot.exp() + 1.f).inverse();
+          Tbuf = v_out * (g() * lr);
+          v_out += v_in * (g() * lr);
+        }
 
-      // Negative samples:
-      //   forward: x = v_in' * v_sample
-      //            l = log(sigmoid(-x))
-      //   backward: dl/dx = g = -sigmoid(x)
-      //             dl/d(v_in) = g * v_out'
-      //             dl/d(v_out) = v_in' * g
-      for (int j = 0; j < num_samples_; ++j) {
-        const int sample = sampler_->Sample(&srnd);
-        if (sample == label) continue;  // Skip.
-        auto v_sample = Tw_out.chip<0>(sample);
-        auto dot = (v_in * v_sample).sum();
-        g = -((-dot).exp() + 1.f).inverse();
-        Tbuf += v_sample * (g() * lr);
-        v_sample += v_in * (g() * lr);
-      }
+        // Negative samples:
+        //   forward: x = v_in' * v_sample
+        //            l = log(sigmoid(-x))
+        //   backward: dl/dx = g = -sigmoid(x)
+        //             dl/d(v_in) = g * v_out'
+        //             dl/d(v_out) = v_in' * g
+        for (int j = 0; j < num_samples_; ++j) {
+          const int sample = sampler_->Sample(&srnd);
+          if (sample == label) continue;  // Skip.
+          auto v_sample = Tw_out.chip<0>(sample);
+          auto dot = (v_in * v_sample).sum();
+          g = -((-dot).exp() + 1.f).inverse();
+          Tbuf += v_sample * (g() * lr);
+          v_sample += v_in * (g() * lr);
+        }
 
-      // Applies the gradient on v_in.
-      v_in += Tbuf;
-    }
+        // Applies the gradient on v_in.
+        v_in += Tbuf;
+      }
+    };
+    // Each example takes num_samples_ + 1 dot products and updates of
+    // size dims.
+    const int64 cost_per_example = (num_samples_ + 1) * dims * 6;
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_example, train);
   }
 
  private:
@@ -0,0 +1,392 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/x86_cwise_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+
+// The kernels are compiled with the target attribute of their instruction
+// set, which needs a compiler that knows about its intrinsics. There is no
+// point in them when the build already targets the instruction set.
+#if defined(__x86_64__) && defined(__clang__)
+#define TF_X86_CWISE_CLANG_AT_LEAST(major, minor) \
+  (__clang_major__ > (major) ||                   \
+   (__clang_major__ == (major) && __clang_minor__ >= (minor)))
+#define TF_X86_CWISE_AVX2 TF_X86_CWISE_CLANG_AT_LEAST(3, 8)
+#define TF_X86_CWISE_AVX512 TF_X86_CWISE_CLANG_AT_LEAST(3, 9)
+#elif defined(__x86_64__) && defined(__GNUC__)
+#define TF_X86_CWISE_GCC_AT_LEAST(major, minor) \
+  (__GNUC__ > (major) || (__GNUC__ == (major) && __GNUC_MINOR__ >= (minor)))
+#define TF_X86_CWISE_AVX2 TF_X86_CWISE_GCC_AT_LEAST(4, 9)
+#define TF_X86_CWISE_AVX512 TF_X86_CWISE_GCC_AT_LEAST(5, 0)
+#else
+#define TF_X86_CWISE_AVX2 0
+#define TF_X86_CWISE_AVX512 0
+#endif
+
+#if TF_X86_CWISE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace x86 {
+namespace {
+
+std::atomic<int> g_max_cwise_isa(static_cast<int>(CwiseIsa::kAvx512));
+
+// The kernels of one instruction set. Each works on contiguous elements on
+// the calling thread; the functions of x86_cwise_kernels.h split the work.
+struct CwiseKernels {
+  void (*add)(const float* x, const float* y, float* z, int64 n);
+  void (*mul)(const float* x, const float* y, float* z, int64 n);
+  void (*add_scalar)(const float* x, float y, float* z, int64 n);
+  void (*mul_scalar)(const float* x, float y, float* z, int64 n);
+  void (*tanh)(const float* x, float* y, int64 n);
+  void (*sigmoid)(const float* x, float* y, int64 n);
+  float (*sum)(const float* x, int64 n);
+  void (*row_sums)(const float* x, int64 rows, int64 cols, float* sums);
+  void (*column_sums)(const float* x, int64 rows, int64 cols, int64 stride,
+                      float* sums);
+  void (*bias_add)(const float* x, const float* bias, float* y, int64 rows,
+                   int64 cols);
+  void (*softmax)(const float* logits, float* y, int64 rows, int64 cols,
+                  bool log);
+};
+
+#if TF_X86_CWISE_AVX2
+namespace avx2 {
+
+#define TF_X86_CWISE_TARGET __attribute__((target("avx2,fma")))
+
+typedef __m256 Vec;
+constexpr int64 kWidth = 8;
+
+TF_X86_CWISE_TARGET inline Vec Load(const float* p) {
+  return _mm256_loadu_ps(p);
+}
+TF_X86_CWISE_TARGET inline void Store(float* p, Vec v) {
+  _mm256_storeu_ps(p, v);
+}
+TF_X86_CWISE_TARGET inline Vec Set1(float x) { return _mm256_set1_ps(x); }
+TF_X86_CWISE_TARGET inline Vec Zero() { return _mm256_setzero_ps(); }
+TF_X86_CWISE_TARGET inline Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+// As the instructions, Max and Min return b if either is NaN.
+TF_X86_CWISE_TARGET inline Vec Max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+// a * b + c.
+TF_X86_CWISE_TARGET inline Vec Fmadd(Vec a, Vec b, Vec c) {
+  return _mm256_fmadd_ps(a, b, c);
+}
+TF_X86_CWISE_TARGET inline Vec Floor(Vec a) { return _mm256_floor_ps(a); }
+TF_X86_CWISE_TARGET inline Vec Abs(Vec a) {
+  return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+// a < b ? x : y.
+TF_X86_CWISE_TARGET inline Vec SelectLess(Vec a, Vec b, Vec x, Vec y) {
+  return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+}
+// 2^n for the integral n in [-126, 127], 0 for -127 and infinity for 128.
+TF_X86_CWISE_TARGET inline Vec Pow2(Vec n) {
+  const __m256i biased =
+      _mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(biased, 23));
+}
+TF_X86_CWISE_TARGET inline float ReduceAdd(Vec a) {
+  __m128 sum =
+      _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+  return _mm_cvtss_f32(sum);
+}
+TF_X86_CWISE_TARGET inline float ReduceMax(Vec a) {
+  __m128 max =
+      _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+  max = _mm_max_ss(max, _mm_movehdup_ps(max));
+  return _mm_cvtss_f32(max);
+}
+
+#include "tensorflow/core/kernels/x86_cwise_kernels_impl.h"
+
+#undef TF_X86_CWISE_TARGET
+
+}  // namespace avx2
+#endif  // TF_X86_CWISE_AVX2
+
+#if TF_X86_CWISE_AVX512
+namespace avx512 {
+
+#define TF_X86_CWISE_TARGET __attribute__((target("avx512f,avx2,fma")))
+
+typedef __m512 Vec;
+constexpr int64 kWidth = 16;
+
+TF_X86_CWISE_TARGET inline Vec Load(const float* p) {
+  return _mm512_loadu_ps(p);
+}
+TF_X86_CWISE_TARGET inline void Store(float* p, Vec v) {
+  _mm512_storeu_ps(p, v);
+}
+TF_X86_CWISE_TARGET inline Vec Set1(float x) { return _mm512_set1_ps(x); }
+TF_X86_CWISE_TARGET inline Vec Zero() { return _mm512_setzero_ps(); }
+TF_X86_CWISE_TARGET inline Vec Add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Div(Vec a, Vec b) { return _mm512_div_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Max(Vec a, Vec b) { return _mm512_max_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Min(Vec a, Vec b) { return _mm512_min_ps(a, b); }
+TF_X86_CWISE_TARGET inline Vec Fmadd(Vec a, Vec b, Vec c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+TF_X86_CWISE_TARGET inline Vec Floor(Vec a) {
+  return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+TF_X86_CWISE_TARGET inline Vec Abs(Vec a) {
+  return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a),
+                                              _mm512_set1_epi32(0x7fffffff)));
+}
+TF_X86_CWISE_TARGET inline Vec SelectLess(Vec a, Vec b, Vec x, Vec y) {
+  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), y, x);
+}
+TF_X86_CWISE_TARGET inline Vec Pow2(Vec n) {
+  const __m512i biased =
+      _mm512_add_epi32(_mm512_cvttps_epi32(n), _mm512_set1_epi32(127));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(biased, 23));
+}
+// The halves of the vector, through the 64-bit extract of AVX-512F.
+TF_X86_CWISE_TARGET inline __m256 High(Vec a) {
+  return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1));
+}
+TF_X86_CWISE_TARGET inline float ReduceAdd(Vec a) {
+  return avx2::ReduceAdd(_mm256_add_ps(_mm512_castps512_ps256(a), High(a)));
+}
+TF_X86_CWISE_TARGET inline float ReduceMax(Vec a) {
+  return avx2::ReduceMax(_mm256_max_ps(_mm512_castps512_ps256(a), High(a)));
+}
+
+#include "tensorflow/core/kernels/x86_cwise_kernels_impl.h"
+
+#undef TF_X86_CWISE_TARGET
+
+}  // namespace avx512
+#endif  // TF_X86_CWISE_AVX512
+
+CwiseIsa EnabledCwiseIsa() {
+  static const CwiseIsa supported = SupportedCwiseIsa();
+  return static_cast<CwiseIsa>(
+      std::min(static_cast<int>(supported), g_max_cwise_isa.load()));
+}
+
+const CwiseKernels& EnabledKernels() {
+  switch (EnabledCwiseIsa()) {
+#if TF_X86_CWISE_AVX512
+    case CwiseIsa::kAvx512:
+      return avx512::kKernels;
+#endif
+#if TF_X86_CWISE_AVX2
+    case CwiseIsa::kAvx2:
+      return avx2::kKernels;
+#endif
+    default:
+      LOG(FATAL) << "The x86 cwise kernels are not supported or are disabled.";
+  }
+}
+
+// Elementwise ops are split among the threads in blocks of kBlock elements, a
+// multiple of the widest vectors, so that a tail is only left at the end.
+constexpr int64 kBlock = 64;
+
+// Calls fn(begin, end) in parallel on ranges that cover [0, n), for an op that
+// reads "inputs" floats and writes one per element in "cycles" cycles.
+template <typename Fn>
+void ParallelForElements(const Eigen::ThreadPoolDevice& d, int64 n, int inputs,
+                         double cycles, const Fn& fn) {
+  const Eigen::TensorOpCost cost(inputs * sizeof(float) * kBlock,
+                                 sizeof(float) * kBlock, cycles * kBlock);
+  d.parallelFor((n + kBlock - 1) / kBlock, cost,
+                [n, &fn](int64 first, int64 last) {
+                  fn(first * kBlock, std::min(n, last * kBlock));
+                });
+}
+
+// Sums are computed by blocks of kSumBlock elements, whatever the number of
+// threads, so that the result does not depend on it.
+constexpr int64 kSumBlock = 1 << 14;
+
+}  // namespace
+
+CwiseIsa SupportedCwiseIsa() {
+#if TF_X86_CWISE_AVX512 && !defined(__AVX512F__)
+  if (port::TestCPUFeature(port::AVX512F)) {
+    return CwiseIsa::kAvx512;
+  }
+#endif
+#if TF_X86_CWISE_AVX2 && !defined(__AVX512F__) && \
+    !(defined(__AVX2__) && defined(__FMA__))
+  if (port::TestCPUFeature(port::AVX2) && port::TestCPUFeature(port::FMA)) {
+    return CwiseIsa::kAvx2;
+  }
+#endif
+  return CwiseIsa::kNone;
+}
+
+void SetMaxCwiseIsa(CwiseIsa isa) { g_max_cwise_isa = static_cast<int>(isa); }
+
+bool CwiseKernelsEnabled() { return EnabledCwiseIsa() != CwiseIsa::kNone; }
+
+void AddFloat(const Eigen::ThreadPoolDevice& d, const float* x, const float* y,
+              float* z, int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  ParallelForElements(d, n, 2, 0.25, [&](int64 begin, int64 end) {
+    kernels.add(x + begin, y + begin, z + begin, end - begin);
+  });
+}
+
+void MulFloat(const Eigen::ThreadPoolDevice& d, const float* x, const float* y,
+              float* z, int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  ParallelForElements(d, n, 2, 0.25, [&](int64 begin, int64 end) {
+    kernels.mul(x + begin, y + begin, z + begin, end - begin);
+  });
+}
+
+void AddScalarFloat(const Eigen::ThreadPoolDevice& d, const float* x, float y,
+                    float* z, int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  ParallelForElements(d, n, 1, 0.25, [&](int64 begin, int64 end) {
+    kernels.add_scalar(x + begin, y, z + begin, end - begin);
+  });
+}
+
+void MulScalarFloat(const Eigen::ThreadPoolDevice& d, const float* x, float y,
+                    float* z, int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  ParallelForElements(d, n, 1, 0.25, [&](int64 begin, int64 end) {
+    kernels.mul_scalar(x + begin, y, z + begin, end - begin);
+  });
+}
+
+void TanhFloat(const Eigen::ThreadPoolDevice& d, const float* x, float* y,
+               int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  ParallelForElements(d, n, 1, 2, [&](int64 begin, int64 end) {
+    kernels.tanh(x + begin, y + begin, end - begin);
+  });
+}
+
+void SigmoidFloat(const Eigen::ThreadPoolDevice& d, const float* x, float* y,
+                  int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  ParallelForElements(d, n, 1, 2.5, [&](int64 begin, int64 end) {
+    kernels.sigmoid(x + begin, y + begin, end - begin);
+  });
+}
+
+float SumFloat(const Eigen::ThreadPoolDevice& d, const float* x, int64 n) {
+  const CwiseKernels& kernels = EnabledKernels();
+  const int64 num_blocks = (n + kSumBlock - 1) / kSumBlock;
+  if (num_blocks <= 1) return kernels.sum(x, n);
+  std::vector<float> block_sums(num_blocks);
+  const Eigen::TensorOpCost cost(kSumBlock * sizeof(float), sizeof(float),
+                                 kSumBlock * 0.125);
+  d.parallelFor(num_blocks, cost, [&](int64 first, int64 last) {
+    for (int64 b = first; b < last; ++b) {
+      const int64 begin = b * kSumBlock;
+      block_sums[b] = kernels.sum(x + begin, std::min(kSumBlock, n - begin));
+    }
+  });
+  return kernels.sum(block_sums.data(), num_blocks);
+}
+
+void RowSumsFloat(const Eigen::ThreadPoolDevice& d, const float* x, int64 rows,
+                  int64 cols, float* sums) {
+  const CwiseKernels& kernels = EnabledKernels();
+  const Eigen::TensorOpCost cost(cols * sizeof(float), sizeof(float),
+                                 cols * 0.125);
+  d.parallelFor(rows, cost, [&](int64 first, int64 last) {
+    kernels.row_sums(x + first * cols, last - first, cols, sums + first);
+  });
+}
+
+void ColumnSumsFloat(const Eigen::ThreadPoolDevice& d, const float* x,
+                     int64 rows, int64 cols, float* sums) {
+  const CwiseKernels& kernels = EnabledKernels();
+  // Wide matrices are split by columns. The others are summed by blocks of
+  // rows of about kSumBlock elements into a matrix of block sums, whose
+  // columns are then summed.
+  const int64 block_rows = std::max<int64>(1, kSumBlock / cols);
+  if (block_rows == 1 || rows <= block_rows) {
+    const Eigen::TensorOpCost cost(rows * sizeof(float) * kBlock,
+                                   sizeof(float) * kBlock,
+                                   rows * 0.125 * kBlock);
+    d.parallelFor((cols + kBlock - 1) / kBlock, cost,
+                  [&](int64 first, int64 last) {
+                    const int64 begin = first * kBlock;
+                    const int64 end = std::min(cols, last * kBlock);
+                    kernels.column_sums(x + begin, rows, end - begin, cols,
+                                        sums + begin);
+                  });
+    return;
+  }
+  const int64 num_blocks = (rows + block_rows - 1) / block_rows;
+  std::vector<float> block_sums(num_blocks * cols);
+  const Eigen::TensorOpCost cost(block_rows * cols * sizeof(float),
+                                 cols * sizeof(float),
+                                 block_rows * cols * 0.125);
+  d.parallelFor(num_blocks, cost, [&](int64 first, int64 last) {
+    for (int64 b = first; b < last; ++b) {
+      const int64 begin = b * block_rows;
+      kernels.column_sums(x + begin * cols,
+                          std::min(block_rows, rows - begin), cols, cols,
+                          &block_sums[b * cols]);
+    }
+  });
+  kernels.column_sums(block_sums.data(), num_blocks, cols, cols, sums);
+}
+
+void BiasAddFloat(const Eigen::ThreadPoolDevice& d, const float* x,
+                  const float* bias, float* y, int64 rows, int64 cols) {
+  const CwiseKernels& kernels = EnabledKernels();
+  const Eigen::TensorOpCost cost(2 * cols * sizeof(float), cols * sizeof(float),
+                                 cols * 0.25);
+  d.parallelFor(rows, cost, [&](int64 first, int64 last) {
+    kernels.bias_add(x + first * cols, bias, y + first * cols, last - first,
+                     cols);
+  });
+}
+
+void SoftmaxFloat(const Eigen::ThreadPoolDevice& d, const float* logits,
+                  float* y, int64 rows, int64 cols, bool log) {
+  const CwiseKernels& kernels = EnabledKernels();
+  const Eigen::TensorOpCost cost(2 * cols * sizeof(float),
+                                 2 * cols * sizeof(float), cols * 3);
+  d.parallelFor(rows, cost, [&](int64 first, int64 last) {
+    kernels.softmax(logits + first * cols, y + first * cols, last - first, cols,
+                    log);
+  });
+}
+
+}  // namespace x86
+}  // namespace tensorflow
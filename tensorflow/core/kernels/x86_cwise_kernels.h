@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_X86_CWISE_KERNELS_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_X86_CWISE_KERNELS_H_
+
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace x86 {
+
+// Vectorized float kernels for the hottest elementwise ops and reductions on
+// CPU. Eigen only uses the vector instructions the build targets, which for a
+// generic x86-64 binary is SSE2. These kernels are compiled for wider vector
+// instruction sets whatever the target flags of the build, and the widest one
+// the CPU supports is picked at runtime. The work is split on the threads of
+// the Eigen device like Eigen does.
+//
+// The results may differ from Eigen's in the last bits: sums are accumulated
+// in a different order, and tanh and exp use the same approximations as
+// Eigen's but with fused multiply-adds.
+
+// The instruction sets with kernels, from the least to the most capable.
+enum class CwiseIsa {
+  kNone = 0,
+  kAvx2 = 1,    // 256-bit vectors, with FMA.
+  kAvx512 = 2,  // 512-bit vectors (AVX-512F).
+};
+
+// Returns the most capable of the instruction sets above that both the CPU
+// and the compiler support, or kNone if the build already targets it, in
+// which case Eigen is as fast.
+CwiseIsa SupportedCwiseIsa();
+
+// Limits the kernels used to those of "isa" and below. kNone disables them.
+// Unlimited by default.
+void SetMaxCwiseIsa(CwiseIsa isa);
+
+// Returns true if the kernels are supported and enabled. Use this call
+// before calling any of the functions below, which log a FATAL error
+// otherwise.
+bool CwiseKernelsEnabled();
+
+// z[i] = x[i] + y[i] and z[i] = x[i] * y[i] for i in [0, n). The output may
+// alias the inputs.
+void AddFloat(const Eigen::ThreadPoolDevice& d, const float* x, const float* y,
+              float* z, int64 n);
+void MulFloat(const Eigen::ThreadPoolDevice& d, const float* x, const float* y,
+              float* z, int64 n);
+
+// z[i] = x[i] + y and z[i] = x[i] * y for i in [0, n).
+void AddScalarFloat(const Eigen::ThreadPoolDevice& d, const float* x, float y,
+                    float* z, int64 n);
+void MulScalarFloat(const Eigen::ThreadPoolDevice& d, const float* x, float y,
+                    float* z, int64 n);
+
+// y[i] = tanh(x[i]) and y[i] = 1 / (1 + exp(-x[i])) for i in [0, n).
+void TanhFloat(const Eigen::ThreadPoolDevice& d, const float* x, float* y,
+               int64 n);
+void SigmoidFloat(const Eigen::ThreadPoolDevice& d, const float* x, float* y,
+                  int64 n);
+
+// Returns the sum of x[0, n). The result does not depend on the number of
+// threads.
+float SumFloat(const Eigen::ThreadPoolDevice& d, const float* x, int64 n);
+
+// Sums the row-major matrix x[rows, cols] along its rows into sums[rows], or
+// along its columns into sums[cols].
+void RowSumsFloat(const Eigen::ThreadPoolDevice& d, const float* x, int64 rows,
+                  int64 cols, float* sums);
+void ColumnSumsFloat(const Eigen::ThreadPoolDevice& d, const float* x,
+                     int64 rows, int64 cols, float* sums);
+
+// y[i, j] = x[i, j] + bias[j] for the row-major matrices x and y of "rows"
+// rows and "cols" columns. y may alias x.
+void BiasAddFloat(const Eigen::ThreadPoolDevice& d, const float* x,
+                  const float* bias, float* y, int64 rows, int64 cols);
+
+// Computes the softmax, or log softmax if "log" is true, of each row of the
+// row-major matrix logits[rows, cols] into y.
+void SoftmaxFloat(const Eigen::ThreadPoolDevice& d, const float* logits,
+                  float* y, int64 rows, int64 cols, bool log);
+
+}  // namespace x86
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_KERNELS_X86_CWISE_KERNELS_H_
@@ -0,0 +1,277 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// The kernels of x86_cwise_kernels.cc, written in terms of the vector type
+// Vec of kWidth floats and of its operations. This file is included once per
+// instruction set, in a namespace that defines them, with
+// TF_X86_CWISE_TARGET set to the target attribute of the instruction set.
+// It has no include guard on purpose.
+
+// Loads the first n < kWidth elements of p, and "pad" in the other lanes.
+TF_X86_CWISE_TARGET inline Vec LoadTail(const float* p, int64 n, float pad) {
+  float buffer[kWidth];
+  for (int64 i = 0; i < kWidth; ++i) buffer[i] = i < n ? p[i] : pad;
+  return Load(buffer);
+}
+
+// Stores the first n < kWidth lanes of v to p.
+TF_X86_CWISE_TARGET inline void StoreTail(float* p, Vec v, int64 n) {
+  float buffer[kWidth];
+  Store(buffer, v);
+  for (int64 i = 0; i < n; ++i) p[i] = buffer[i];
+}
+
+// tanh(x), with the rational approximation of Eigen on the clamp of x to
+// [-7.998, 7.998], out of which the result rounds to +-1.
+TF_X86_CWISE_TARGET inline Vec Tanh(Vec a) {
+  const Vec x = Min(Set1(7.99881172180175781f),
+                    Max(Set1(-7.99881172180175781f), a));
+  const Vec x2 = Mul(x, x);
+  Vec p = Fmadd(x2, Set1(-2.76076847742355e-16f), Set1(2.00018790482477e-13f));
+  p = Fmadd(x2, p, Set1(-8.60467152213735e-11f));
+  p = Fmadd(x2, p, Set1(5.12229709037114e-08f));
+  p = Fmadd(x2, p, Set1(1.48572235717979e-05f));
+  p = Fmadd(x2, p, Set1(6.37261928875436e-04f));
+  p = Fmadd(x2, p, Set1(4.89352455891786e-03f));
+  p = Mul(x, p);
+  Vec q = Fmadd(x2, Set1(1.19825839466702e-06f), Set1(1.18534705686654e-04f));
+  q = Fmadd(x2, q, Set1(2.26843463243900e-03f));
+  q = Fmadd(x2, q, Set1(4.89352518554385e-03f));
+  // tanh(x) rounds to x close to 0, where the approximation is less precise.
+  return SelectLess(Abs(a), Set1(0.0004f), a, Div(p, q));
+}
+
+// exp(x), with the Cephes polynomial that Eigen uses: exp(x) = 2^n exp(r)
+// with n = round(x / log(2)) and r = x - n log(2).
+TF_X86_CWISE_TARGET inline Vec Exp(Vec a) {
+  Vec x = Min(Set1(88.3762626647950f), Max(Set1(-88.3762626647949f), a));
+  const Vec n = Floor(Fmadd(x, Set1(1.44269504088896341f), Set1(0.5f)));
+  // log(2) in two parts, the first of which has few enough bits that n times
+  // it is exact.
+  x = Fmadd(n, Set1(-0.693359375f), x);
+  x = Fmadd(n, Set1(2.12194440e-4f), x);
+  const Vec x2 = Mul(x, x);
+  Vec y = Fmadd(Set1(1.9875691500e-4f), x, Set1(1.3981999507e-3f));
+  y = Fmadd(y, x, Set1(8.3334519073e-3f));
+  y = Fmadd(y, x, Set1(4.1665795894e-2f));
+  y = Fmadd(y, x, Set1(1.6666665459e-1f));
+  y = Fmadd(y, x, Set1(5.0000001201e-1f));
+  y = Add(Fmadd(y, x2, x), Set1(1.0f));
+  return Mul(y, Pow2(n));
+}
+
+TF_X86_CWISE_TARGET inline Vec Sigmoid(Vec x) {
+  const Vec one = Set1(1.0f);
+  return Div(one, Add(one, Exp(Sub(Zero(), x))));
+}
+
+struct AddOp {
+  TF_X86_CWISE_TARGET Vec operator()(Vec x, Vec y) const { return Add(x, y); }
+};
+
+struct MulOp {
+  TF_X86_CWISE_TARGET Vec operator()(Vec x, Vec y) const { return Mul(x, y); }
+};
+
+struct TanhOp {
+  TF_X86_CWISE_TARGET Vec operator()(Vec x) const { return Tanh(x); }
+};
+
+struct SigmoidOp {
+  TF_X86_CWISE_TARGET Vec operator()(Vec x) const { return Sigmoid(x); }
+};
+
+template <typename Op>
+TF_X86_CWISE_TARGET inline void BinaryKernel(const float* x, const float* y,
+                                             float* z, int64 n) {
+  const Op op;
+  int64 i = 0;
+  for (; i + kWidth <= n; i += kWidth) {
+    Store(z + i, op(Load(x + i), Load(y + i)));
+  }
+  if (i < n) {
+    StoreTail(z + i, op(LoadTail(x + i, n - i, 0), LoadTail(y + i, n - i, 0)),
+              n - i);
+  }
+}
+
+template <typename Op>
+TF_X86_CWISE_TARGET inline void BinaryScalarKernel(const float* x, float y,
+                                                   float* z, int64 n) {
+  const Op op;
+  const Vec y_vec = Set1(y);
+  int64 i = 0;
+  for (; i + kWidth <= n; i += kWidth) {
+    Store(z + i, op(Load(x + i), y_vec));
+  }
+  if (i < n) StoreTail(z + i, op(LoadTail(x + i, n - i, 0), y_vec), n - i);
+}
+
+template <typename Op>
+TF_X86_CWISE_TARGET inline void UnaryKernel(const float* x, float* y,
+                                            int64 n) {
+  const Op op;
+  int64 i = 0;
+  for (; i + kWidth <= n; i += kWidth) {
+    Store(y + i, op(Load(x + i)));
+  }
+  if (i < n) StoreTail(y + i, op(LoadTail(x + i, n - i, 0)), n - i);
+}
+
+TF_X86_CWISE_TARGET void AddKernel(const float* x, const float* y, float* z,
+                                   int64 n) {
+  BinaryKernel<AddOp>(x, y, z, n);
+}
+
+TF_X86_CWISE_TARGET void MulKernel(const float* x, const float* y, float* z,
+                                   int64 n) {
+  BinaryKernel<MulOp>(x, y, z, n);
+}
+
+TF_X86_CWISE_TARGET void AddScalarKernel(const float* x, float y, float* z,
+                                         int64 n) {
+  BinaryScalarKernel<AddOp>(x, y, z, n);
+}
+
+TF_X86_CWISE_TARGET void MulScalarKernel(const float* x, float y, float* z,
+                                         int64 n) {
+  BinaryScalarKernel<MulOp>(x, y, z, n);
+}
+
+TF_X86_CWISE_TARGET void TanhKernel(const float* x, float* y, int64 n) {
+  UnaryKernel<TanhOp>(x, y, n);
+}
+
+TF_X86_CWISE_TARGET void SigmoidKernel(const float* x, float* y, int64 n) {
+  UnaryKernel<SigmoidOp>(x, y, n);
+}
+
+// Accumulates in four vectors, to hide the latency of the additions.
+TF_X86_CWISE_TARGET float SumKernel(const float* x, int64 n) {
+  Vec sum0 = Zero(), sum1 = Zero(), sum2 = Zero(), sum3 = Zero();
+  int64 i = 0;
+  for (; i + 4 * kWidth <= n; i += 4 * kWidth) {
+    sum0 = Add(sum0, Load(x + i));
+    sum1 = Add(sum1, Load(x + i + kWidth));
+    sum2 = Add(sum2, Load(x + i + 2 * kWidth));
+    sum3 = Add(sum3, Load(x + i + 3 * kWidth));
+  }
+  for (; i + kWidth <= n; i += kWidth) sum0 = Add(sum0, Load(x + i));
+  if (i < n) sum1 = Add(sum1, LoadTail(x + i, n - i, 0));
+  return ReduceAdd(Add(Add(sum0, sum1), Add(sum2, sum3)));
+}
+
+TF_X86_CWISE_TARGET void RowSumsKernel(const float* x, int64 rows, int64 cols,
+                                       float* sums) {
+  for (int64 r = 0; r < rows; ++r) sums[r] = SumKernel(x + r * cols, cols);
+}
+
+// Sums the columns [0, cols) of the rows of x, which are "stride" apart, into
+// sums[0, cols), four vectors of columns at a time.
+TF_X86_CWISE_TARGET void ColumnSumsKernel(const float* x, int64 rows,
+                                          int64 cols, int64 stride,
+                                          float* sums) {
+  int64 c = 0;
+  for (; c + 4 * kWidth <= cols; c += 4 * kWidth) {
+    Vec sum0 = Zero(), sum1 = Zero(), sum2 = Zero(), sum3 = Zero();
+    for (int64 r = 0; r < rows; ++r) {
+      const float* p = x + r * stride + c;
+      sum0 = Add(sum0, Load(p));
+      sum1 = Add(sum1, Load(p + kWidth));
+      sum2 = Add(sum2, Load(p + 2 * kWidth));
+      sum3 = Add(sum3, Load(p + 3 * kWidth));
+    }
+    Store(sums + c, sum0);
+    Store(sums + c + kWidth, sum1);
+    Store(sums + c + 2 * kWidth, sum2);
+    Store(sums + c + 3 * kWidth, sum3);
+  }
+  for (; c < cols; c += kWidth) {
+    const int64 n = cols - c < kWidth ? cols - c : kWidth;
+    Vec sum = Zero();
+    for (int64 r = 0; r < rows; ++r) {
+      const float* p = x + r * stride + c;
+      sum = Add(sum, n == kWidth ? Load(p) : LoadTail(p, n, 0));
+    }
+    if (n == kWidth) {
+      Store(sums + c, sum);
+    } else {
+      StoreTail(sums + c, sum, n);
+    }
+  }
+}
+
+TF_X86_CWISE_TARGET void BiasAddKernel(const float* x, const float* bias,
+                                       float* y, int64 rows, int64 cols) {
+  for (int64 r = 0; r < rows; ++r, x += cols, y += cols) {
+    BinaryKernel<AddOp>(x, bias, y, cols);
+  }
+}
+
+TF_X86_CWISE_TARGET void SoftmaxKernel(const float* logits, float* y,
+                                       int64 rows, int64 cols, bool log) {
+  const float kInfinity = std::numeric_limits<float>::infinity();
+  for (int64 r = 0; r < rows; ++r, logits += cols, y += cols) {
+    int64 c;
+    Vec max = Set1(-kInfinity);
+    for (c = 0; c + kWidth <= cols; c += kWidth) {
+      max = Max(max, Load(logits + c));
+    }
+    if (c < cols) max = Max(max, LoadTail(logits + c, cols - c, -kInfinity));
+    const Vec row_max = Set1(ReduceMax(max));
+
+    // The padding of the tail is -infinity, whose exp is 0.
+    Vec sum = Zero();
+    for (c = 0; c + kWidth <= cols; c += kWidth) {
+      const Vec e = Exp(Sub(Load(logits + c), row_max));
+      if (!log) Store(y + c, e);
+      sum = Add(sum, e);
+    }
+    if (c < cols) {
+      const Vec e =
+          Exp(Sub(LoadTail(logits + c, cols - c, -kInfinity), row_max));
+      if (!log) StoreTail(y + c, e, cols - c);
+      sum = Add(sum, e);
+    }
+
+    if (log) {
+      const Vec log_sum = Set1(std::log(ReduceAdd(sum)));
+      for (c = 0; c + kWidth <= cols; c += kWidth) {
+        Store(y + c, Sub(Sub(Load(logits + c), row_max), log_sum));
+      }
+      if (c < cols) {
+        StoreTail(y + c,
+                  Sub(Sub(LoadTail(logits + c, cols - c, 0), row_max), log_sum),
+                  cols - c);
+      }
+    } else {
+      const Vec inverse_sum = Set1(1.0f / ReduceAdd(sum));
+      for (c = 0; c + kWidth <= cols; c += kWidth) {
+        Store(y + c, Mul(Load(y + c), inverse_sum));
+      }
+      if (c < cols) {
+        StoreTail(y + c, Mul(LoadTail(y + c, cols - c, 0), inverse_sum),
+                  cols - c);
+      }
+    }
+  }
+}
+
+const CwiseKernels kKernels = {AddKernel,        MulKernel,
+                               AddScalarKernel,  MulScalarKernel,
+                               TanhKernel,       SigmoidKernel,
+                               SumKernel,        RowSumsKernel,
+                               ColumnSumsKernel, BiasAddKernel,
+                               SoftmaxKernel};
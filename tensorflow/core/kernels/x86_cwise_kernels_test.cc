@@ -0,0 +1,212 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/x86_cwise_kernels.h"
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns a tensor of "shape" with random floats in [low, high).
+Tensor Random(const TensorShape& shape, float low, float high) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor t(DT_FLOAT, shape);
+  auto flat = t.flat<float>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    flat(i) = low + (high - low) * rnd.RandFloat();
+  }
+  return t;
+}
+
+Tensor Int32(const std::vector<int32>& values) {
+  Tensor t(DT_INT32, TensorShape({static_cast<int64>(values.size())}));
+  for (size_t i = 0; i < values.size(); ++i) t.vec<int32>()(i) = values[i];
+  return t;
+}
+
+class X86CwiseKernelsTest : public OpsTestBase {
+ protected:
+  ~X86CwiseKernelsTest() override {
+    x86::SetMaxCwiseIsa(x86::CwiseIsa::kAvx512);
+  }
+
+  // Runs the op of "builder" on "inputs" with Eigen, then with the kernels of
+  // each instruction set the CPU supports, and checks that the results match.
+  void Check(NodeDefBuilder* builder, const std::vector<Tensor>& inputs,
+             double rtol = 1e-6) {
+    TF_ASSERT_OK(builder->Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    Tensor expected;
+    const int supported = static_cast<int>(x86::SupportedCwiseIsa());
+    for (int isa = static_cast<int>(x86::CwiseIsa::kNone); isa <= supported;
+         ++isa) {
+      x86::SetMaxCwiseIsa(static_cast<x86::CwiseIsa>(isa));
+      inputs_.clear();
+      for (const Tensor& input : inputs) {
+        if (input.dtype() == DT_FLOAT) {
+          AddInputFromArray<float>(
+              input.shape(), gtl::ArraySlice<float>(input.flat<float>().data(),
+                                                    input.NumElements()));
+        } else {
+          AddInputFromArray<int32>(
+              input.shape(), gtl::ArraySlice<int32>(input.flat<int32>().data(),
+                                                    input.NumElements()));
+        }
+      }
+      TF_ASSERT_OK(RunOpKernel());
+      if (isa == static_cast<int>(x86::CwiseIsa::kNone)) {
+        expected = *GetOutput(0);
+      } else {
+        test::ExpectClose(expected, *GetOutput(0), rtol, rtol);
+      }
+    }
+  }
+
+  void CheckBinary(const string& op, const Tensor& x, const Tensor& y) {
+    NodeDefBuilder builder("binary", op);
+    builder.Input(FakeInput(DT_FLOAT)).Input(FakeInput(DT_FLOAT));
+    Check(&builder, {x, y});
+  }
+
+  void CheckUnary(const string& op, const Tensor& x) {
+    NodeDefBuilder builder("unary", op);
+    builder.Input(FakeInput(DT_FLOAT));
+    Check(&builder, {x});
+  }
+
+  void CheckSum(const Tensor& x, const std::vector<int32>& axes) {
+    NodeDefBuilder builder("sum", "Sum");
+    builder.Input(FakeInput(DT_FLOAT)).Input(FakeInput(DT_INT32));
+    Check(&builder, {x, Int32(axes)}, 1e-4);
+  }
+};
+
+TEST_F(X86CwiseKernelsTest, Add) {
+  CheckBinary("Add", Random({100003}, -10, 10), Random({100003}, -10, 10));
+  CheckBinary("Add", Random({7, 9}, -10, 10), Random({}, -10, 10));
+  CheckBinary("Add", Random({}, -10, 10), Random({5}, -10, 10));
+}
+
+TEST_F(X86CwiseKernelsTest, Mul) {
+  CheckBinary("Mul", Random({100003}, -10, 10), Random({100003}, -10, 10));
+  CheckBinary("Mul", Random({7, 9}, -10, 10), Random({}, -10, 10));
+  CheckBinary("Mul", Random({}, -10, 10), Random({5}, -10, 10));
+}
+
+TEST_F(X86CwiseKernelsTest, TanhAndSigmoid) {
+  for (const string& op : {"Tanh", "Sigmoid"}) {
+    CheckUnary(op, Random({100003}, -20, 20));
+    CheckUnary(op, Random({3, 11}, -0.01, 0.01));
+    const float inf = std::numeric_limits<float>::infinity();
+    Tensor special(DT_FLOAT, TensorShape({6}));
+    test::FillValues<float>(&special, {-inf, -100, -0.0f, 0, 100, inf});
+    CheckUnary(op, special);
+  }
+}
+
+TEST_F(X86CwiseKernelsTest, Sum) {
+  CheckSum(Random({1}, -1, 1), {0});
+  CheckSum(Random({100003}, -1, 1), {0});
+  // Along rows.
+  CheckSum(Random({300, 1001}, -1, 1), {1});
+  // Along columns, of narrow and wide matrices.
+  CheckSum(Random({3001, 37}, -1, 1), {0});
+  CheckSum(Random({7, 70001}, -1, 1), {0});
+}
+
+TEST_F(X86CwiseKernelsTest, Softmax) {
+  for (const string& op : {"Softmax", "LogSoftmax"}) {
+    CheckUnary(op, Random({13, 1001}, -10, 10));
+    CheckUnary(op, Random({2, 3}, -10, 10));
+  }
+}
+
+TEST_F(X86CwiseKernelsTest, BiasAdd) {
+  CheckBinary("BiasAdd", Random({2, 3, 5, 67}, -10, 10), Random({67}, -1, 1));
+  CheckBinary("BiasAdd", Random({1000, 3}, -10, 10), Random({3}, -1, 1));
+}
+
+static void RunBenchmark(int iters, bool use_kernels, int64 items, Graph* g) {
+  x86::SetMaxCwiseIsa(use_kernels ? x86::CwiseIsa::kAvx512
+                                  : x86::CwiseIsa::kNone);
+  testing::UseRealTime();
+  testing::ItemsProcessed(static_cast<int64>(iters) * items);
+  test::Benchmark("cpu", g).Run(iters);
+  x86::SetMaxCwiseIsa(x86::CwiseIsa::kAvx512);
+}
+
+static Graph* UnaryGraph(const string& op, int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, op,
+                     test::graph::Constant(g, Random({rows, cols}, -5, 5)));
+  return g;
+}
+
+static Graph* BinaryGraph(const string& op, int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const TensorShape y_shape = op == "BiasAdd" ? TensorShape({cols})
+                                              : TensorShape({rows, cols});
+  test::graph::Binary(g, op,
+                      test::graph::Constant(g, Random({rows, cols}, -5, 5)),
+                      test::graph::Constant(g, Random(y_shape, -5, 5)));
+  return g;
+}
+
+static Graph* SumGraph(int rows, int cols, int axis) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(g, "Sum",
+                      test::graph::Constant(g, Random({rows, cols}, -5, 5)),
+                      test::graph::Constant(g, Int32({axis})));
+  return g;
+}
+
+#define BM_X86Cwise(NAME, GRAPH, ROWS, COLS)                                   \
+  static void BM_X86Cwise_##NAME##_##ROWS##_##COLS(int iters) {                \
+    RunBenchmark(iters, true, static_cast<int64>(ROWS) * COLS, GRAPH);         \
+  }                                                                            \
+  BENCHMARK(BM_X86Cwise_##NAME##_##ROWS##_##COLS);                             \
+  static void BM_Eigen_##NAME##_##ROWS##_##COLS(int iters) {                   \
+    RunBenchmark(iters, false, static_cast<int64>(ROWS) * COLS, GRAPH);        \
+  }                                                                            \
+  BENCHMARK(BM_Eigen_##NAME##_##ROWS##_##COLS);
+
+BM_X86Cwise(Add, BinaryGraph("Add", 1024, 1024), 1024, 1024);
+BM_X86Cwise(Mul, BinaryGraph("Mul", 1024, 1024), 1024, 1024);
+BM_X86Cwise(Tanh, UnaryGraph("Tanh", 1024, 1024), 1024, 1024);
+BM_X86Cwise(Sigmoid, UnaryGraph("Sigmoid", 1024, 1024), 1024, 1024);
+BM_X86Cwise(SumRows, SumGraph(1024, 1024, 1), 1024, 1024);
+BM_X86Cwise(SumColumns, SumGraph(1024, 1024, 0), 1024, 1024);
+BM_X86Cwise(Softmax, UnaryGraph("Softmax", 128, 10000), 128, 10000);
+BM_X86Cwise(BiasAdd, BinaryGraph("BiasAdd", 4096, 256), 4096, 256);
+
+#undef BM_X86Cwise
+
+}  // namespace
+}  // namespace tensorflow
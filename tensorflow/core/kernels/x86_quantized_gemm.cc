@@ -0,0 +1,345 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/x86_quantized_gemm.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+// The kernels are compiled with the target attribute of their instruction
+// set, which needs a compiler that knows about its intrinsics.
+#if defined(__x86_64__) && defined(__clang__)
+#define TF_X86_GEMM_CLANG_AT_LEAST(major, minor) \
+  (__clang_major__ > (major) ||                  \
+   (__clang_major__ == (major) && __clang_minor__ >= (minor)))
+#define TF_X86_GEMM_AVX2 TF_X86_GEMM_CLANG_AT_LEAST(3, 8)
+#define TF_X86_GEMM_AVX512 TF_X86_GEMM_CLANG_AT_LEAST(3, 9)
+#define TF_X86_GEMM_AVX512_VNNI TF_X86_GEMM_CLANG_AT_LEAST(6, 0)
+#elif defined(__x86_64__) && defined(__GNUC__)
+#define TF_X86_GEMM_GCC_AT_LEAST(major, minor) \
+  (__GNUC__ > (major) || (__GNUC__ == (major) && __GNUC_MINOR__ >= (minor)))
+#define TF_X86_GEMM_AVX2 TF_X86_GEMM_GCC_AT_LEAST(4, 9)
+#define TF_X86_GEMM_AVX512 TF_X86_GEMM_GCC_AT_LEAST(5, 0)
+#define TF_X86_GEMM_AVX512_VNNI TF_X86_GEMM_GCC_AT_LEAST(8, 0)
+#else
+#define TF_X86_GEMM_AVX2 0
+#define TF_X86_GEMM_AVX512 0
+#define TF_X86_GEMM_AVX512_VNNI 0
+#endif
+
+#if TF_X86_GEMM_AVX2
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace x86 {
+namespace {
+
+std::atomic<int> g_max_isa(static_cast<int>(Isa::kAvx512Vnni));
+
+// The result is computed in tiles of kTileRows rows and Kernel::kCols
+// columns, each of which accumulates over the whole depth in registers.
+constexpr int kTileRows = 4;
+
+// The operands are packed so that the kernels read them sequentially:
+//  - the rows of a, zero padded to kTileRows rows and to a multiple of
+//    Kernel::kDepthGroup deep;
+//  - the columns of b in panels of Kernel::kCols, in which the kDepthGroup
+//    consecutive elements of each column are interleaved with those of the
+//    other columns.
+// The padding is all zeros in a, so it does not contribute to the sums.
+
+#if TF_X86_GEMM_AVX2
+// Multiplies pairs of 16-bit elements and adds them up into 32 bits with
+// vpmaddwd, without the saturation of the 8-bit multiply-adds.
+struct Avx2Kernel {
+  typedef int16 PackedA;
+  typedef int16 PackedB;
+  static constexpr int kCols = 16;
+  static constexpr int kDepthGroup = 2;
+  static constexpr bool kSignedB = false;
+
+  __attribute__((target("avx2"))) static void Run(const PackedA* a, int depth,
+                                                   const PackedB* b,
+                                                   int32* tile) {
+    __m256i acc[kTileRows][2];
+    for (int r = 0; r < kTileRows; ++r) {
+      acc[r][0] = _mm256_setzero_si256();
+      acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int l = 0; l < depth; l += kDepthGroup, b += kCols * kDepthGroup) {
+      const __m256i b0 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+      const __m256i b1 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16));
+      for (int r = 0; r < kTileRows; ++r) {
+        int32 a_pair;
+        memcpy(&a_pair, a + r * depth + l, sizeof(a_pair));
+        const __m256i a_r = _mm256_set1_epi32(a_pair);
+        acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(a_r, b0));
+        acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(a_r, b1));
+      }
+    }
+    for (int r = 0; r < kTileRows; ++r) {
+      __m256i* out = reinterpret_cast<__m256i*>(tile + r * kCols);
+      _mm256_storeu_si256(out, acc[r][0]);
+      _mm256_storeu_si256(out + 1, acc[r][1]);
+    }
+  }
+};
+#endif  // TF_X86_GEMM_AVX2
+
+#if TF_X86_GEMM_AVX512
+// Same as Avx2Kernel, on vectors twice as wide.
+struct Avx512Kernel {
+  typedef int16 PackedA;
+  typedef int16 PackedB;
+  static constexpr int kCols = 32;
+  static constexpr int kDepthGroup = 2;
+  static constexpr bool kSignedB = false;
+
+  __attribute__((target("avx512f,avx512bw"))) static void Run(
+      const PackedA* a, int depth, const PackedB* b, int32* tile) {
+    __m512i acc[kTileRows][2];
+    for (int r = 0; r < kTileRows; ++r) {
+      acc[r][0] = _mm512_setzero_si512();
+      acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int l = 0; l < depth; l += kDepthGroup, b += kCols * kDepthGroup) {
+      const __m512i b0 = _mm512_loadu_si512(b);
+      const __m512i b1 = _mm512_loadu_si512(b + 32);
+      for (int r = 0; r < kTileRows; ++r) {
+        int32 a_pair;
+        memcpy(&a_pair, a + r * depth + l, sizeof(a_pair));
+        const __m512i a_r = _mm512_set1_epi32(a_pair);
+        acc[r][0] = _mm512_add_epi32(acc[r][0], _mm512_madd_epi16(a_r, b0));
+        acc[r][1] = _mm512_add_epi32(acc[r][1], _mm512_madd_epi16(a_r, b1));
+      }
+    }
+    for (int r = 0; r < kTileRows; ++r) {
+      _mm512_storeu_si512(tile + r * kCols, acc[r][0]);
+      _mm512_storeu_si512(tile + r * kCols + 16, acc[r][1]);
+    }
+  }
+};
+#endif  // TF_X86_GEMM_AVX512
+
+#if TF_X86_GEMM_AVX512_VNNI
+// Adds up four products of 8-bit elements into 32 bits with vpdpbusd. Its
+// second operand is signed, so b is packed offset by -128, which adds
+// -128 * sum(a[i, l]) : l in [0, k) to each result. QuantizedGemm adds it
+// back with the offsets.
+struct Avx512VnniKernel {
+  typedef uint8 PackedA;
+  typedef int8 PackedB;
+  static constexpr int kCols = 32;
+  static constexpr int kDepthGroup = 4;
+  static constexpr bool kSignedB = true;
+
+  __attribute__((target("avx512f,avx512bw,avx512vnni"))) static void Run(
+      const PackedA* a, int depth, const PackedB* b, int32* tile) {
+    __m512i acc[kTileRows][2];
+    for (int r = 0; r < kTileRows; ++r) {
+      acc[r][0] = _mm512_setzero_si512();
+      acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int l = 0; l < depth; l += kDepthGroup, b += kCols * kDepthGroup) {
+      const __m512i b0 = _mm512_loadu_si512(b);
+      const __m512i b1 = _mm512_loadu_si512(b + 64);
+      for (int r = 0; r < kTileRows; ++r) {
+        int32 a_quad;
+        memcpy(&a_quad, a + r * depth + l, sizeof(a_quad));
+        const __m512i a_r = _mm512_set1_epi32(a_quad);
+        acc[r][0] = _mm512_dpbusd_epi32(acc[r][0], a_r, b0);
+        acc[r][1] = _mm512_dpbusd_epi32(acc[r][1], a_r, b1);
+      }
+    }
+    for (int r = 0; r < kTileRows; ++r) {
+      _mm512_storeu_si512(tile + r * kCols, acc[r][0]);
+      _mm512_storeu_si512(tile + r * kCols + 16, acc[r][1]);
+    }
+  }
+};
+#endif  // TF_X86_GEMM_AVX512_VNNI
+
+int RoundUp(int value, int multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+template <class Kernel>
+void Gemm(const DeviceBase::CpuWorkerThreads& workers, bool transpose_a,
+          bool transpose_b, const uint8* a_data, const uint8* b_data,
+          int32* c_data, int m, int n, int k, int offset_a, int offset_b,
+          int lda, int ldb, int ldc) {
+  const int kCols = Kernel::kCols;
+  const int depth = RoundUp(k, Kernel::kDepthGroup);
+  const int num_row_tiles = RoundUp(m, kTileRows) / kTileRows;
+  const int num_col_tiles = RoundUp(n, kCols) / kCols;
+
+  std::vector<typename Kernel::PackedA> packed_a(
+      static_cast<int64>(num_row_tiles) * kTileRows * depth, 0);
+  std::vector<int32> a_row_sums(m);
+  auto pack_a = [&](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      typename Kernel::PackedA* row = &packed_a[i * depth];
+      int32 sum = 0;
+      for (int l = 0; l < k; ++l) {
+        const uint8 value =
+            transpose_a ? a_data[l * lda + i] : a_data[i * lda + l];
+        row[l] = value;
+        sum += value;
+      }
+      a_row_sums[i] = sum;
+    }
+  };
+  Shard(workers.num_threads, workers.workers, m, 2 * k, pack_a);
+
+  std::vector<typename Kernel::PackedB> packed_b(
+      static_cast<int64>(num_col_tiles) * kCols * depth, 0);
+  std::vector<int32> b_col_sums(n);
+  auto pack_b = [&](int64 start, int64 limit) {
+    for (int64 t = start; t < limit; ++t) {
+      typename Kernel::PackedB* panel = &packed_b[t * kCols * depth];
+      const int cols = std::min<int>(kCols, n - t * kCols);
+      for (int c = 0; c < cols; ++c) {
+        const int j = t * kCols + c;
+        int32 sum = 0;
+        for (int l = 0; l < k; ++l) {
+          const uint8 value =
+              transpose_b ? b_data[j * ldb + l] : b_data[l * ldb + j];
+          const int group = l / Kernel::kDepthGroup;
+          panel[(group * kCols + c) * Kernel::kDepthGroup +
+                l % Kernel::kDepthGroup] =
+              Kernel::kSignedB ? static_cast<int32>(value) - 128 : value;
+          sum += value;
+        }
+        b_col_sums[j] = sum;
+      }
+    }
+  };
+  Shard(workers.num_threads, workers.workers, num_col_tiles, 2 * k * kCols,
+        pack_b);
+
+  // sum((a + offset_a) * (b + offset_b)) adds the sums of the rows of a and
+  // of the columns of b to the products of the kernels.
+  const int32 a_row_sum_scale = offset_b + (Kernel::kSignedB ? 128 : 0);
+  const int32 constant = k * offset_a * offset_b;
+  auto multiply = [&](int64 start, int64 limit) {
+    int32 tile[kTileRows * Kernel::kCols];
+    for (int64 t = start; t < limit; ++t) {
+      const int row_tile = t / num_col_tiles;
+      const int col_tile = t % num_col_tiles;
+      Kernel::Run(&packed_a[static_cast<int64>(row_tile) * kTileRows * depth],
+                  depth,
+                  &packed_b[static_cast<int64>(col_tile) * kCols * depth],
+                  tile);
+      const int i0 = row_tile * kTileRows;
+      const int j0 = col_tile * kCols;
+      const int rows = std::min(kTileRows, m - i0);
+      const int cols = std::min(kCols, n - j0);
+      for (int r = 0; r < rows; ++r) {
+        const int32 row_term = a_row_sum_scale * a_row_sums[i0 + r] + constant;
+        int32* c_row = c_data + static_cast<int64>(i0 + r) * ldc + j0;
+        for (int c = 0; c < cols; ++c) {
+          c_row[c] = tile[r * kCols + c] + row_term +
+                     offset_a * b_col_sums[j0 + c];
+        }
+      }
+    }
+  };
+  Shard(workers.num_threads, workers.workers,
+        static_cast<int64>(num_row_tiles) * num_col_tiles,
+        2 * depth * kTileRows * kCols, multiply);
+}
+
+}  // namespace
+
+Isa SupportedIsa() {
+#if TF_X86_GEMM_AVX512_VNNI
+  if (port::TestCPUFeature(port::AVX512BW) &&
+      port::TestCPUFeature(port::AVX512_VNNI)) {
+    return Isa::kAvx512Vnni;
+  }
+#endif
+#if TF_X86_GEMM_AVX512
+  if (port::TestCPUFeature(port::AVX512BW)) {
+    return Isa::kAvx512;
+  }
+#endif
+#if TF_X86_GEMM_AVX2
+  if (port::TestCPUFeature(port::AVX2)) {
+    return Isa::kAvx2;
+  }
+#endif
+  return Isa::kNone;
+}
+
+void SetMaxIsa(Isa isa) { g_max_isa = static_cast<int>(isa); }
+
+namespace {
+
+Isa EnabledIsa() {
+  static const Isa supported = SupportedIsa();
+  return static_cast<Isa>(
+      std::min(static_cast<int>(supported), g_max_isa.load()));
+}
+
+}  // namespace
+
+bool IsSupportedAndEnabled() { return EnabledIsa() != Isa::kNone; }
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+  const DeviceBase::CpuWorkerThreads& workers =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const uint8* a = &a_data->value;
+  const uint8* b = &b_data->value;
+  int32* c = &c_data->value;
+  switch (EnabledIsa()) {
+#if TF_X86_GEMM_AVX512_VNNI
+    case Isa::kAvx512Vnni:
+      Gemm<Avx512VnniKernel>(workers, transpose_a, transpose_b, a, b, c, m, n,
+                             k, offset_a, offset_b, lda, ldb, ldc);
+      return;
+#endif
+#if TF_X86_GEMM_AVX512
+    case Isa::kAvx512:
+      Gemm<Avx512Kernel>(workers, transpose_a, transpose_b, a, b, c, m, n, k,
+                         offset_a, offset_b, lda, ldb, ldc);
+      return;
+#endif
+#if TF_X86_GEMM_AVX2
+    case Isa::kAvx2:
+      Gemm<Avx2Kernel>(workers, transpose_a, transpose_b, a, b, c, m, n, k,
+                       offset_a, offset_b, lda, ldb, ldc);
+      return;
+#endif
+    default:
+      break;
+  }
+  LOG(FATAL) << "QuantizedGemm: x86 codepath not supported.";
+}
+
+}  // namespace x86
+}  // namespace tensorflow
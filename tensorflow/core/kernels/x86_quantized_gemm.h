@@ -0,0 +1,67 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_X86_QUANTIZED_GEMM_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_X86_QUANTIZED_GEMM_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace x86 {
+
+// Optimized x86 kernels for quantized eight-bit matrix multiplication. The
+// instruction set is picked at runtime from those of the CPU, so the kernels
+// are compiled in whatever the target flags of the build.
+
+// The instruction sets with a kernel, from the least to the most capable.
+enum class Isa {
+  kNone = 0,
+  kAvx2 = 1,        // 16-bit multiply-adds on 256-bit vectors.
+  kAvx512 = 2,      // 16-bit multiply-adds on 512-bit vectors (AVX-512BW).
+  kAvx512Vnni = 3,  // 8-bit dot products on 512-bit vectors.
+};
+
+// Returns the most capable of the instruction sets above that both the CPU
+// and the compiler support.
+Isa SupportedIsa();
+
+// Limits the kernels used to those of "isa" and below. kNone disables the
+// codepath. Unlimited by default.
+void SetMaxIsa(Isa isa);
+
+// Returns true if the codepath is supported and is enabled. Use this call
+// before calling QuantizedGemm, which logs a FATAL error otherwise.
+bool IsSupportedAndEnabled();
+
+// Calculates the quantized matrix multiplication:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] + offset_a) * (b_data[l, j] + offset_b)) : l in [0, k)
+//
+// with the same layouts as meta::QuantizedGemm. The result is computed on the
+// worker threads of "context".
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc);
+
+}  // namespace x86
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_KERNELS_X86_QUANTIZED_GEMM_H_
@@ -0,0 +1,174 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/x86_quantized_gemm.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/reference_gemm.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class X86QuantizedGemmTest : public OpsTestBase {
+ protected:
+  ~X86QuantizedGemmTest() override { x86::SetMaxIsa(x86::Isa::kAvx512Vnni); }
+
+  // Runs QuantizedMatMul on random matrices with nonzero offsets, and checks
+  // it against ReferenceGemm.
+  void Check(int m, int n, int k, bool transpose_a, bool transpose_b) {
+    inputs_.clear();
+    TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    random::PhiloxRandom philox(301, 17);
+    random::SimplePhilox rnd(&philox);
+    std::vector<quint8> a(m * k);
+    std::vector<quint8> b(k * n);
+    for (quint8& x : a) x = static_cast<uint8>(rnd.Uniform(256));
+    for (quint8& x : b) x = static_cast<uint8>(rnd.Uniform(256));
+    const float min_a = -1.0f, max_a = 2.0f;
+    const float min_b = -3.0f, max_b = 1.0f;
+    AddInputFromArray<quint8>(
+        transpose_a ? TensorShape({k, m}) : TensorShape({m, k}), a);
+    AddInputFromArray<quint8>(
+        transpose_b ? TensorShape({n, k}) : TensorShape({k, n}), b);
+    AddInputFromArray<float>(TensorShape({1}), {min_a});
+    AddInputFromArray<float>(TensorShape({1}), {max_a});
+    AddInputFromArray<float>(TensorShape({1}), {min_b});
+    AddInputFromArray<float>(TensorShape({1}), {max_b});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_QINT32, TensorShape({m, n}));
+    ReferenceGemm<quint8, quint8, qint32>(
+        transpose_a, transpose_b, false, m, n, k, a.data(),
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_a, max_a),
+        transpose_a ? m : k, b.data(),
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_b, max_b),
+        transpose_b ? k : n, expected.flat<qint32>().data(), 0, 0, 1, n);
+    test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
+  }
+
+  // Runs "Check" on shapes that are and are not multiples of the tiles, for
+  // each instruction set the CPU supports.
+  void CheckAllIsas() {
+    const int supported = static_cast<int>(x86::SupportedIsa());
+    for (int isa = static_cast<int>(x86::Isa::kAvx2); isa <= supported;
+         ++isa) {
+      x86::SetMaxIsa(static_cast<x86::Isa>(isa));
+      for (bool transpose_a : {false, true}) {
+        for (bool transpose_b : {false, true}) {
+          Check(1, 1, 1, transpose_a, transpose_b);
+          Check(4, 32, 8, transpose_a, transpose_b);
+          Check(7, 45, 33, transpose_a, transpose_b);
+          Check(65, 3, 130, transpose_a, transpose_b);
+        }
+      }
+    }
+  }
+};
+
+TEST_F(X86QuantizedGemmTest, MatchesReference) { CheckAllIsas(); }
+
+TEST_F(X86QuantizedGemmTest, Disabled) {
+  x86::SetMaxIsa(x86::Isa::kNone);
+  EXPECT_FALSE(x86::IsSupportedAndEnabled());
+  // Falls back to gemmlowp.
+  Check(7, 45, 33, false, true);
+}
+
+static Graph* QuantizedMatMul(int m, int n, int k) {
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor a(DT_QUINT8, TensorShape({m, k}));
+  Tensor b(DT_QUINT8, TensorShape({k, n}));
+  for (Tensor* t : {&a, &b}) {
+    auto flat = t->flat<quint8>();
+    for (int64 i = 0; i < flat.size(); ++i) {
+      flat(i) = static_cast<uint8>(rnd.Uniform(256));
+    }
+  }
+  auto range = [g](float value) {
+    Tensor t(DT_FLOAT, TensorShape({1}));
+    t.flat<float>()(0) = value;
+    return test::graph::Constant(g, t);
+  };
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "QuantizedMatMul")
+                  .Input(test::graph::Constant(g, a))
+                  .Input(test::graph::Constant(g, b))
+                  .Input(range(-1.0f))
+                  .Input(range(1.0f))
+                  .Input(range(-1.0f))
+                  .Input(range(1.0f))
+                  .Attr("Toutput", DT_QINT32)
+                  .Finalize(g, &node));
+  return g;
+}
+
+static void RunQuantizedMatMulBenchmark(int iters, x86::Isa isa, int m, int n,
+                                        int k) {
+  x86::SetMaxIsa(isa);
+  testing::UseRealTime();
+  testing::ItemsProcessed(static_cast<int64>(iters) * m * n * k * 2);
+  test::Benchmark("cpu", QuantizedMatMul(m, n, k)).Run(iters);
+  x86::SetMaxIsa(x86::Isa::kAvx512Vnni);
+}
+
+#define BM_QuantizedMatMul(M, N, K)                                          \
+  static void BM_QuantizedMatMul_##M##_##N##_##K(int iters) {                \
+    RunQuantizedMatMulBenchmark(iters, x86::Isa::kAvx512Vnni, M, N, K);      \
+  }                                                                          \
+  BENCHMARK(BM_QuantizedMatMul_##M##_##N##_##K);                             \
+  static void BM_QuantizedMatMulGemmlowp_##M##_##N##_##K(int iters) {        \
+    RunQuantizedMatMulBenchmark(iters, x86::Isa::kNone, M, N, K);            \
+  }                                                                          \
+  BENCHMARK(BM_QuantizedMatMulGemmlowp_##M##_##N##_##K);
+
+BM_QuantizedMatMul(1, 1024, 1024);
+BM_QuantizedMatMul(64, 1024, 1024);
+BM_QuantizedMatMul(512, 512, 512);
+BM_QuantizedMatMul(3136, 64, 576);  // 3x3 conv of 56x56x64 after im2col.
+
+#undef BM_QuantizedMatMul
+
+}  // namespace
+}  // namespace tensorflow
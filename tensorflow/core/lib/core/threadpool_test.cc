@@ -119,6 +119,21 @@ TEST(ThreadPool, ParallelForWithWorkerId) {
   }
 }
 
+TEST(ThreadPool, HighLatencyHint) {
+  // A pool whose idle threads never spin still runs all the work.
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads += 7) {
+    std::atomic<int> done(0);
+    {
+      ThreadPool pool(Env::Default(), ThreadOptions(), "test", num_threads,
+                      false /* low_latency_hint */);
+      for (int i = 0; i < 100; ++i) {
+        pool.Schedule([&done]() { done.fetch_add(1); });
+      }
+    }
+    EXPECT_EQ(100, done.load());
+  }
+}
+
 static void BM_Sequential(int iters) {
   ThreadPool pool(Env::Default(), "test", kNumThreads);
   // Decrement count sequentially until 0.
@@ -167,5 +182,45 @@ static void BM_Parallel(int iters) {
 }
 BENCHMARK(BM_Parallel);
 
+// Measures the latency of handing a closure to an otherwise idle pool and
+// being notified that it ran, as the executor does when it schedules a ready
+// node. 'arg' selects the low_latency_hint, which lets idle threads spin
+// before they block.
+static void BM_HandoffLatency(int iters, int low_latency_hint) {
+  ThreadPool pool(Env::Default(), ThreadOptions(), "test", 4,
+                  low_latency_hint != 0);
+  mutex mu;
+  condition_variable cv;
+  bool ran = false;
+  for (int i = 0; i < iters; ++i) {
+    pool.Schedule([&mu, &cv, &ran]() {
+      mutex_lock l(mu);
+      ran = true;
+      cv.notify_one();
+    });
+    mutex_lock l(mu);
+    while (!ran) {
+      cv.wait(l);
+    }
+    ran = false;
+  }
+}
+BENCHMARK(BM_HandoffLatency)->Arg(0)->Arg(1);
+
+// Same as above, but the closure signals completion through an atomic flag
+// the scheduling thread spins on, so only the pool's wake-up is measured.
+static void BM_HandoffLatencySpinningCaller(int iters, int low_latency_hint) {
+  ThreadPool pool(Env::Default(), ThreadOptions(), "test", 4,
+                  low_latency_hint != 0);
+  std::atomic<bool> ran(false);
+  for (int i = 0; i < iters; ++i) {
+    pool.Schedule([&ran]() { ran.store(true, std::memory_order_release); });
+    while (!ran.load(std::memory_order_acquire)) {
+    }
+    ran.store(false, std::memory_order_relaxed);
+  }
+}
+BENCHMARK(BM_HandoffLatencySpinningCaller)->Arg(0)->Arg(1);
+
 }  // namespace thread
 }  // namespace tensorflow
@@ -0,0 +1,127 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/block_zlib_inputstream.h"
+#include "tensorflow/core/lib/io/block_zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+
+static std::vector<int> BlockSizes() { return {1, 10, 100, 1000, 100000}; }
+
+static std::vector<int> NumThreads() { return {0, 1, 4}; }
+
+static string GenTestString(int size) {
+  string result;
+  for (int i = 0; i < size; ++i) {
+    result.push_back('a' + (i * 7 + i / 100) % 26);
+  }
+  return result;
+}
+
+static void WriteBlocks(const string& fname, const string& data,
+                        int block_size, int num_writes) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file_writer;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file_writer));
+  BlockZlibOutputBuffer out(
+      file_writer.get(), block_size,
+      ZlibCompressionOptions::DEFAULT().compression_level);
+  for (int i = 0; i < num_writes; ++i) {
+    TF_CHECK_OK(out.Append(data));
+  }
+  TF_CHECK_OK(out.Close());
+  TF_CHECK_OK(file_writer->Close());
+}
+
+TEST(BlockZlibBuffers, ReadAll) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/block_zlib_buffers_test";
+  const string data = GenTestString(5000);
+  for (auto block_size : BlockSizes()) {
+    WriteBlocks(fname, data, block_size, 3);
+    for (auto num_threads : NumThreads()) {
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &file_reader));
+      BlockZlibInputStream in(file_reader.get(), num_threads, 8);
+      string result;
+      TF_EXPECT_OK(in.ReadNBytes(data.size(), &result));
+      EXPECT_EQ(data, result);
+      TF_EXPECT_OK(in.ReadNBytes(2 * data.size(), &result));
+      EXPECT_EQ(strings::StrCat(data, data), result);
+      EXPECT_EQ(3 * data.size(), in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+      EXPECT_EQ("", result);
+    }
+  }
+}
+
+TEST(BlockZlibBuffers, ReadPastEnd) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/block_zlib_buffers_test";
+  const string data = GenTestString(100);
+  WriteBlocks(fname, data, 30, 1);
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file_reader));
+  BlockZlibInputStream in(file_reader.get(), 2, 2);
+  string result;
+  TF_EXPECT_OK(in.ReadNBytes(40, &result));
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(100, &result)));
+  EXPECT_EQ(data.substr(40), result);
+  EXPECT_EQ(100, in.Tell());
+
+  TF_EXPECT_OK(in.Reset());
+  EXPECT_EQ(0, in.Tell());
+  TF_EXPECT_OK(in.ReadNBytes(100, &result));
+  EXPECT_EQ(data, result);
+}
+
+TEST(BlockZlibBuffers, Corruption) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/block_zlib_buffers_test";
+  const string data = GenTestString(1000);
+  WriteBlocks(fname, data, 100, 1);
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+
+  // Flips a byte of the compressed data of the last block, and truncates
+  // the file in the middle of the last block.
+  for (bool truncate : {false, true}) {
+    string corrupted = contents;
+    if (truncate) {
+      corrupted.resize(corrupted.size() - 10);
+    } else {
+      corrupted[corrupted.size() - 10] ^= 1;
+    }
+    TF_CHECK_OK(WriteStringToFile(env, fname, corrupted));
+    for (auto num_threads : NumThreads()) {
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &file_reader));
+      BlockZlibInputStream in(file_reader.get(), num_threads, 4);
+      string result;
+      // The blocks before the last one are read.
+      TF_EXPECT_OK(in.ReadNBytes(900, &result));
+      EXPECT_EQ(data.substr(0, 900), result);
+      EXPECT_EQ(error::DATA_LOSS, in.ReadNBytes(100, &result).code());
+    }
+  }
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,194 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_zlib_inputstream.h"
+
+#include <zlib.h>
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+
+namespace {
+
+// The sizes of the header and the footer of a block.
+constexpr size_t kHeaderSize = 2 * sizeof(uint64) + sizeof(uint32);
+constexpr size_t kFooterSize = sizeof(uint32);
+
+}  // namespace
+
+struct BlockZlibInputStream::Block {
+  uint64 offset;
+  uint64 compressed_size;
+  uint64 uncompressed_size;
+
+  // Notified when `status` and `data` are set.
+  Notification done;
+  Status status;
+  string data;
+};
+
+BlockZlibInputStream::BlockZlibInputStream(RandomAccessFile* file,
+                                           int num_threads,
+                                           int max_prefetched_blocks)
+    : file_(file),
+      max_prefetched_blocks_(
+          num_threads > 0 ? std::max(max_prefetched_blocks, 1) : 1) {
+  if (num_threads > 0) {
+    threads_.reset(new thread::ThreadPool(Env::Default(), "block_zlib_input",
+                                          num_threads));
+  }
+}
+
+BlockZlibInputStream::~BlockZlibInputStream() {
+  // Waits for the pending reads, which use `file_`.
+  threads_.reset();
+}
+
+Status BlockZlibInputStream::ReadNBytes(int64 bytes_to_read,
+                                        string* result) {
+  result->clear();
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->reserve(bytes_to_read);
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (pos_ == current_block_.size()) {
+      TF_RETURN_IF_ERROR(NextBlock());
+    }
+    const size_t n =
+        std::min(static_cast<size_t>(bytes_to_read) - result->size(),
+                 current_block_.size() - pos_);
+    result->append(current_block_.data() + pos_, n);
+    pos_ += n;
+    bytes_read_ += n;
+  }
+  return Status::OK();
+}
+
+int64 BlockZlibInputStream::Tell() const { return bytes_read_; }
+
+Status BlockZlibInputStream::Reset() {
+  // The pending reads own their blocks, so they can complete after the
+  // blocks are dropped.
+  pending_blocks_.clear();
+  next_header_offset_ = 0;
+  header_status_ = Status::OK();
+  current_block_.clear();
+  pos_ = 0;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+Status BlockZlibInputStream::NextBlock() {
+  do {
+    PrefetchBlocks();
+    if (pending_blocks_.empty()) {
+      return header_status_;
+    }
+    std::shared_ptr<Block> block = pending_blocks_.front();
+    pending_blocks_.pop_front();
+    block->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->status);
+    current_block_.swap(block->data);
+    pos_ = 0;
+    // BlockZlibOutputBuffer does not write empty blocks, but they are
+    // valid.
+  } while (current_block_.empty());
+  // Keeps the pool busy while the current block is read.
+  PrefetchBlocks();
+  return Status::OK();
+}
+
+void BlockZlibInputStream::PrefetchBlocks() {
+  while (header_status_.ok() &&
+         pending_blocks_.size() < static_cast<size_t>(max_prefetched_blocks_)) {
+    char scratch[kHeaderSize];
+    StringPiece header;
+    Status s = file_->Read(next_header_offset_, kHeaderSize, &header, scratch);
+    if (header.empty() && (s.ok() || errors::IsOutOfRange(s))) {
+      header_status_ = errors::OutOfRange("eof");
+      return;
+    }
+    if (header.size() != kHeaderSize) {
+      header_status_ =
+          s.ok() || errors::IsOutOfRange(s)
+              ? errors::DataLoss("truncated block at ", next_header_offset_)
+              : s;
+      return;
+    }
+    const uint32 masked_crc =
+        core::DecodeFixed32(header.data() + 2 * sizeof(uint64));
+    if (crc32c::Unmask(masked_crc) !=
+        crc32c::Value(header.data(), 2 * sizeof(uint64))) {
+      header_status_ =
+          errors::DataLoss("corrupted block at ", next_header_offset_);
+      return;
+    }
+
+    std::shared_ptr<Block> block = std::make_shared<Block>();
+    block->offset = next_header_offset_;
+    block->compressed_size = core::DecodeFixed64(header.data());
+    block->uncompressed_size =
+        core::DecodeFixed64(header.data() + sizeof(uint64));
+    next_header_offset_ += kHeaderSize + block->compressed_size + kFooterSize;
+    pending_blocks_.push_back(block);
+    if (threads_) {
+      threads_->Schedule([this, block]() { ReadBlock(block.get()); });
+    } else {
+      ReadBlock(block.get());
+    }
+  }
+}
+
+void BlockZlibInputStream::ReadBlock(Block* block) {
+  const uint64 data_offset = block->offset + kHeaderSize;
+  const size_t expected = block->compressed_size + kFooterSize;
+  string compressed(expected, '\0');
+  StringPiece data;
+  Status s = file_->Read(data_offset, expected, &data, &compressed[0]);
+  if (data.size() != expected) {
+    block->status = s.ok() || errors::IsOutOfRange(s)
+                        ? errors::DataLoss("truncated block at ", block->offset)
+                        : s;
+  } else if (crc32c::Unmask(core::DecodeFixed32(
+                 data.data() + block->compressed_size)) !=
+             crc32c::Value(data.data(), block->compressed_size)) {
+    // The checksum covers the whole compressed block in a single pass.
+    block->status = errors::DataLoss("corrupted block at ", block->offset);
+  } else {
+    block->data.resize(block->uncompressed_size);
+    uLongf uncompressed_size = block->uncompressed_size;
+    const int error = uncompress(
+        reinterpret_cast<Bytef*>(&block->data[0]), &uncompressed_size,
+        reinterpret_cast<const Bytef*>(data.data()), block->compressed_size);
+    if (error != Z_OK || uncompressed_size != block->uncompressed_size) {
+      block->data.clear();
+      block->status = errors::DataLoss("uncompress() failed with error ",
+                                       error, " for block at ", block->offset);
+    }
+  }
+  block->done.Notify();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_BLOCK_ZLIB_INPUTSTREAM_H_
+#define TENSORFLOW_LIB_IO_BLOCK_ZLIB_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// A BlockZlibInputStream reads the blocks written by a BlockZlibOutputBuffer
+// (see block_zlib_outputbuffer.h for the format) and returns their
+// decompressed contents.
+//
+// If `num_threads` > 0, up to `max_prefetched_blocks` blocks ahead of the
+// one being read are read, checksummed and decompressed in parallel on a
+// pool of `num_threads` threads. Otherwise the blocks are read on the
+// calling thread when they are needed.
+//
+// A given instance of a BlockZlibInputStream is NOT safe for concurrent use
+// by multiple threads.
+class BlockZlibInputStream : public InputStreamInterface {
+ public:
+  // Creates a BlockZlibInputStream for `file`, which must remain live while
+  // the stream is in use. Does *not* take ownership of `file`.
+  BlockZlibInputStream(RandomAccessFile* file, int num_threads,
+                       int max_prefetched_blocks);
+
+  ~BlockZlibInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If a block is corrupted or truncated.
+  // others:       If reading from the file failed.
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct Block;
+
+  // Makes the next block the current one.
+  Status NextBlock();
+
+  // Reads the headers of the next blocks and schedules their reads, until
+  // `max_prefetched_blocks_` are pending or the end of the file.
+  void PrefetchBlocks();
+
+  // Reads, checks and decompresses `block`.
+  void ReadBlock(Block* block);
+
+  RandomAccessFile* const file_;  // Not owned
+  const int max_prefetched_blocks_;
+  std::unique_ptr<thread::ThreadPool> threads_;
+
+  // The blocks whose headers have been read, in file order. They are shared
+  // with the threads that read them.
+  std::deque<std::shared_ptr<Block>> pending_blocks_;
+  // The offset in the file of the next block header to read.
+  uint64 next_header_offset_ = 0;
+  // The status of reading the block headers. OUT_OF_RANGE at the end of the
+  // file.
+  Status header_status_;
+
+  // The decompressed contents of the current block, and the position of the
+  // next byte to read in it.
+  string current_block_;
+  size_t pos_ = 0;
+  // The number of bytes read from the stream.
+  int64 bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockZlibInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_BLOCK_ZLIB_INPUTSTREAM_H_
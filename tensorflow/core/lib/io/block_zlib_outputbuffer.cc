@@ -0,0 +1,125 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_zlib_outputbuffer.h"
+
+#include <zlib.h>
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+BlockZlibOutputBuffer::BlockZlibOutputBuffer(WritableFile* file,
+                                             size_t block_size,
+                                             int compression_level)
+    : file_(file),
+      block_size_(block_size),
+      compression_level_(compression_level) {
+  CHECK_GT(block_size_, 0);
+}
+
+BlockZlibOutputBuffer::~BlockZlibOutputBuffer() {
+  if (!closed_ && !buffer_.empty()) {
+    LOG(WARNING)
+        << "BlockZlibOutputBuffer::Close() not called. Possible data loss";
+  }
+}
+
+Status BlockZlibOutputBuffer::Append(const StringPiece& data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append on a closed buffer.");
+  }
+  StringPiece input = data;
+  if (!buffer_.empty()) {
+    const size_t n = std::min(block_size_ - buffer_.size(), input.size());
+    buffer_.append(input.data(), n);
+    input.remove_prefix(n);
+    if (buffer_.size() < block_size_) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(WriteBlock(buffer_));
+    buffer_.clear();
+  }
+  // The full blocks of `data` are compressed without copying them.
+  while (input.size() >= block_size_) {
+    TF_RETURN_IF_ERROR(WriteBlock(StringPiece(input.data(), block_size_)));
+    input.remove_prefix(block_size_);
+  }
+  buffer_.append(input.data(), input.size());
+  return Status::OK();
+}
+
+Status BlockZlibOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("Flush on a closed buffer.");
+  }
+  if (!buffer_.empty()) {
+    TF_RETURN_IF_ERROR(WriteBlock(buffer_));
+    buffer_.clear();
+  }
+  return Status::OK();
+}
+
+Status BlockZlibOutputBuffer::Close() {
+  if (closed_) {
+    return errors::FailedPrecondition("Close on a closed buffer.");
+  }
+  if (!buffer_.empty()) {
+    TF_RETURN_IF_ERROR(WriteBlock(buffer_));
+    buffer_.clear();
+  }
+  closed_ = true;
+  return Status::OK();
+}
+
+Status BlockZlibOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status BlockZlibOutputBuffer::WriteBlock(StringPiece data) {
+  uLongf compressed_size = compressBound(data.size());
+  string compressed(compressed_size, '\0');
+  const int error =
+      compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                reinterpret_cast<const Bytef*>(data.data()), data.size(),
+                compression_level_);
+  if (error != Z_OK) {
+    return errors::DataLoss("compress2() failed with error ", error);
+  }
+  compressed.resize(compressed_size);
+
+  char header[2 * sizeof(uint64) + sizeof(uint32)];
+  core::EncodeFixed64(header, compressed.size());
+  core::EncodeFixed64(header + sizeof(uint64), data.size());
+  core::EncodeFixed32(
+      header + 2 * sizeof(uint64),
+      crc32c::Mask(crc32c::Value(header, 2 * sizeof(uint64))));
+  char footer[sizeof(uint32)];
+  core::EncodeFixed32(footer, crc32c::Mask(crc32c::Value(compressed.data(),
+                                                         compressed.size())));
+
+  TF_RETURN_IF_ERROR(file_->Append(StringPiece(header, sizeof(header))));
+  TF_RETURN_IF_ERROR(file_->Append(compressed));
+  return file_->Append(StringPiece(footer, sizeof(footer)));
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,90 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_BLOCK_ZLIB_OUTPUTBUFFER_H_
+#define TENSORFLOW_LIB_IO_BLOCK_ZLIB_OUTPUTBUFFER_H_
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// A BlockZlibOutputBuffer writes its input as a sequence of blocks that are
+// compressed independently with zlib (http://www.zlib.net/), so that they
+// can be decompressed in parallel by a BlockZlibInputStream. Each block is
+// stored as:
+//
+//   uint64    length of the compressed data
+//   uint64    length of the uncompressed data
+//   uint32    masked crc of the two lengths
+//   byte      compressed data[length]
+//   uint32    masked crc of the compressed data
+//
+// The concatenation of the uncompressed blocks is the input of the buffer.
+// Blocks hold `block_size` bytes of input, except the ones written by
+// `Flush()` and `Close()`.
+//
+// A given instance of a BlockZlibOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class BlockZlibOutputBuffer : public WritableFile {
+ public:
+  // Creates a BlockZlibOutputBuffer for `file` that compresses blocks of
+  // `block_size` bytes with the zlib `compression_level`. Does not take
+  // ownership of `file`.
+  BlockZlibOutputBuffer(WritableFile* file, size_t block_size,
+                        int compression_level);
+
+  ~BlockZlibOutputBuffer();
+
+  // Adds `data` to the current block, and writes the blocks that are full.
+  Status Append(const StringPiece& data) override;
+
+  // Writes the current block, if it is not empty. Does *not* flush `file`.
+  Status Flush() override;
+
+  // Writes the current block, if it is not empty. `file` is not closed.
+  //
+  // After calling this, any further calls to `Append()`, `Flush()` or
+  // `Close()` will fail.
+  Status Close() override;
+
+  // Writes the current block, if it is not empty, and syncs `file`.
+  Status Sync() override;
+
+ private:
+  // Compresses `data` and writes it to `file_` as a block.
+  Status WriteBlock(StringPiece data);
+
+  WritableFile* file_;  // Not owned
+  const size_t block_size_;
+  const int compression_level_;
+  bool closed_ = false;
+
+  // The input that is not written yet, less than `block_size_` bytes.
+  string buffer_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockZlibOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_BLOCK_ZLIB_OUTPUTBUFFER_H_
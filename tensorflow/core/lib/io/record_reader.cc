@@ -27,6 +27,15 @@ limitations under the License.
 namespace tensorflow {
 namespace io {
 
+namespace {
+
+// The default number of threads and prefetched blocks for block zlib
+// compressed files.
+constexpr int kDefaultNumBlockThreads = 4;
+constexpr int kDefaultMaxPrefetchedBlocks = 8;
+
+}  // namespace
+
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
@@ -45,6 +54,15 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kBlockZlib) {
+    options.compression_type = io::RecordReaderOptions::BLOCK_ZLIB_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
+#else
+    options.num_block_threads = kDefaultNumBlockThreads;
+    options.max_prefetched_blocks = kDefaultMaxPrefetchedBlocks;
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -65,6 +83,16 @@ RecordReader::RecordReader(RandomAccessFile* file,
     zlib_input_stream_.reset(new ZlibInputStream(
         random_input_stream_.get(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options));
+    input_stream_ = zlib_input_stream_.get();
+#endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordReaderOptions::BLOCK_ZLIB_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    block_zlib_input_stream_.reset(new BlockZlibInputStream(
+        file, options.num_block_threads, options.max_prefetched_blocks));
+    input_stream_ = block_zlib_input_stream_.get();
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -74,6 +102,7 @@ RecordReader::RecordReader(RandomAccessFile* file,
 }
 
 RecordReader::~RecordReader() {
+  block_zlib_input_stream_.reset(nullptr);
   zlib_input_stream_.reset(nullptr);
   random_input_stream_.reset(nullptr);
 }
@@ -91,15 +120,15 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
   storage->resize(expected);
 
 #if !defined(IS_SLIM_BUILD)
-  if (zlib_input_stream_) {
-    // If we have a zlib compressed buffer, we assume that the
+  if (input_stream_) {
+    // If we have a compressed input stream, we assume that the
     // file is being read sequentially, and we use the underlying
     // implementation to read the data.
     //
     // No checks are done to validate that the file is being read
     // sequentially.  At some point the zlib input buffer may support
     // seeking, possibly inefficiently.
-    TF_RETURN_IF_ERROR(zlib_input_stream_->ReadNBytes(expected, storage));
+    TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(expected, storage));
 
     if (storage->size() != expected) {
       if (storage->empty()) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/block_zlib_inputstream.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -34,7 +35,11 @@ namespace io {
 
 class RecordReaderOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    BLOCK_ZLIB_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
   static RecordReaderOptions CreateRecordReaderOptions(
@@ -44,6 +49,13 @@ class RecordReaderOptions {
   // Options specific to zlib compression.
   ZlibCompressionOptions zlib_options;
 #endif  // IS_SLIM_BUILD
+
+  // Options specific to block zlib compression: the number of threads that
+  // read and decompress blocks in parallel ahead of the records, and the
+  // number of blocks they read ahead. If `num_block_threads` is 0, the
+  // blocks are read and decompressed on the calling thread.
+  int num_block_threads = 0;
+  int max_prefetched_blocks = 0;
 };
 
 class RecordReader {
@@ -69,6 +81,10 @@ class RecordReader {
 #if !defined(IS_SLIM_BUILD)
   std::unique_ptr<RandomAccessInputStream> random_input_stream_;
   std::unique_ptr<ZlibInputStream> zlib_input_stream_;
+  std::unique_ptr<BlockZlibInputStream> block_zlib_input_stream_;
+  // The stream the records are read from sequentially, if the file is
+  // compressed.
+  InputStreamInterface* input_stream_ = nullptr;
 #endif  // IS_SLIM_BUILD
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordReader);
@@ -24,7 +24,9 @@ namespace tensorflow {
 namespace io {
 namespace {
 bool IsZlibCompressed(RecordWriterOptions options) {
-  return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
+  return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION ||
+         options.compression_type ==
+             RecordWriterOptions::BLOCK_ZLIB_COMPRESSION;
 }
 }  // namespace
 
@@ -46,6 +48,14 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kBlockZlib) {
+    options.compression_type = io::RecordWriterOptions::BLOCK_ZLIB_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
+#else
+    options.zlib_options = io::ZlibCompressionOptions::DEFAULT();
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -57,7 +67,14 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
     : dest_(dest), options_(options) {
-  if (IsZlibCompressed(options)) {
+  if (options.compression_type == RecordWriterOptions::BLOCK_ZLIB_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    dest_ = new BlockZlibOutputBuffer(dest, options.block_size,
+                                      options.zlib_options.compression_level);
+#endif  // IS_SLIM_BUILD
+  } else if (IsZlibCompressed(options)) {
 // We don't have zlib available on all embedded platforms, so fail.
 #if defined(IS_SLIM_BUILD)
     LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
@@ -159,8 +159,30 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
     return nullptr;
   }
 
+  // The size of the output, which is the crop window if there is one.
+  JDIMENSION target_output_width = cinfo.output_width;
+  JDIMENSION target_output_height = cinfo.output_height;
+  if (flags.crop) {
+    if (flags.crop_x < 0 || flags.crop_y < 0 || flags.crop_width <= 0 ||
+        flags.crop_height <= 0 ||
+        static_cast<JDIMENSION>(flags.crop_x + flags.crop_width) >
+            cinfo.output_width ||
+        static_cast<JDIMENSION>(flags.crop_y + flags.crop_height) >
+            cinfo.output_height) {
+      LOG(ERROR) << "Invalid crop window: x=" << flags.crop_x
+                 << ", y=" << flags.crop_y << ", w=" << flags.crop_width
+                 << ", h=" << flags.crop_height
+                 << " for image_width: " << cinfo.output_width
+                 << " and image_height: " << cinfo.output_height;
+      jpeg_destroy_decompress(&cinfo);
+      return nullptr;
+    }
+    target_output_width = flags.crop_width;
+    target_output_height = flags.crop_height;
+  }
+
   // check for compatible stride
-  const int min_stride = cinfo.output_width * components * sizeof(JSAMPLE);
+  const int min_stride = target_output_width * components * sizeof(JSAMPLE);
   if (stride == 0) {
     stride = min_stride;
   } else if (stride < min_stride) {
@@ -170,34 +192,65 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   }
 
   // Remember stride and height for use in Uncompress
-  argball->height_ = cinfo.output_height;
+  argball->height_ = target_output_height;
   argball->stride_ = stride;
 
   uint8* const dstdata = argball->allocate_output_(
-      cinfo.output_width, cinfo.output_height, components);
+      target_output_width, target_output_height, components);
   if (dstdata == nullptr) {
     jpeg_destroy_decompress(&cinfo);
     return nullptr;
   }
   JSAMPLE* output_line = static_cast<JSAMPLE*>(dstdata);
 
-  // Temporary buffer used for CMYK -> RGB conversion.
+  // When cropping, libjpeg-turbo only decodes the iMCU columns of the crop
+  // window and skips the scanlines above it. The scanlines may then start
+  // left of the window, and are cropped on copy. Other versions of libjpeg
+  // decode the whole scanlines, and those above the window are discarded.
+  JDIMENSION skipped_columns = 0;
+  bool truncated = false;
+  if (flags.crop) {
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && \
+    LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+    JDIMENSION xoffset = flags.crop_x;
+    JDIMENSION width = flags.crop_width;
+    jpeg_crop_scanline(&cinfo, &xoffset, &width);
+    skipped_columns = flags.crop_x - xoffset;
+    truncated = jpeg_skip_scanlines(&cinfo, flags.crop_y) !=
+                static_cast<JDIMENSION>(flags.crop_y);
+#else
+    skipped_columns = flags.crop_x;
+#endif
+  }
+
+  // Temporary buffer used for cropping the scanlines and for CMYK -> RGB
+  // conversion.
   const bool use_cmyk = (cinfo.out_color_space == JCS_CMYK);
-  tempdata = use_cmyk ? new JSAMPLE[cinfo.output_width * 4] : nullptr;
+  const bool use_tempdata = use_cmyk || flags.crop;
+  tempdata = use_tempdata
+                 ? new JSAMPLE[cinfo.output_width * cinfo.output_components]
+                 : nullptr;
+  while (flags.crop && !truncated &&
+         cinfo.output_scanline < static_cast<JDIMENSION>(flags.crop_y)) {
+    truncated = jpeg_read_scanlines(&cinfo, &tempdata, 1) == 0;
+  }
 
   // If there is an error reading a line, this aborts the reading.
   // Save the fraction of the image that has been read.
-  argball->height_read_ = cinfo.output_height;
-  while (cinfo.output_scanline < cinfo.output_height) {
+  argball->height_read_ = target_output_height;
+  for (JDIMENSION line = 0; line < target_output_height; ++line) {
     int num_lines_read = 0;
-    if (cinfo.out_color_space == JCS_CMYK) {
+    if (truncated) {
+      // The scanlines above the crop window could not be read.
+    } else if (use_cmyk) {
       num_lines_read = jpeg_read_scanlines(&cinfo, &tempdata, 1);
       // Convert CMYK to RGB
-      for (size_t i = 0; i < cinfo.output_width; ++i) {
-        int c = tempdata[4 * i + 0];
-        int m = tempdata[4 * i + 1];
-        int y = tempdata[4 * i + 2];
-        int k = tempdata[4 * i + 3];
+      const JSAMPLE* cmyk = tempdata + skipped_columns * 4;
+      for (size_t i = 0; i < target_output_width; ++i) {
+        int c = cmyk[4 * i + 0];
+        int m = cmyk[4 * i + 1];
+        int y = cmyk[4 * i + 2];
+        int k = cmyk[4 * i + 3];
         int r, g, b;
         if (cinfo.saw_Adobe_marker) {
           r = (k * c) / 255;
@@ -212,6 +265,9 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
         output_line[3 * i + 1] = g;
         output_line[3 * i + 2] = b;
       }
+    } else if (use_tempdata) {
+      num_lines_read = jpeg_read_scanlines(&cinfo, &tempdata, 1);
+      memcpy(output_line, tempdata + skipped_columns * components, min_stride);
     } else {
       num_lines_read = jpeg_read_scanlines(&cinfo, &output_line, 1);
     }
@@ -220,11 +276,10 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
       LOG(ERROR) << "Premature end of JPEG data. Stopped at line "
                  << cinfo.output_scanline << "/" << cinfo.output_height;
       if (!flags.try_recover_truncated_jpeg) {
-        argball->height_read_ = cinfo.output_scanline;
+        argball->height_read_ = line;
         error = JPEGERRORS_UNEXPECTED_END_OF_DATA;
       } else {
-        for (size_t line = cinfo.output_scanline; line < cinfo.output_height;
-             ++line) {
+        for (; line < target_output_height; ++line) {
           if (line == 0) {
             // If even the first line is missing, fill with black color
             memset(output_line, 0, min_stride);
@@ -235,7 +290,7 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
           output_line += stride;
         }
         argball->height_read_ =
-            cinfo.output_height;  // consider all lines as read
+            target_output_height;  // consider all lines as read
         // prevent error-on-exit in libjpeg:
         cinfo.output_scanline = cinfo.output_height;
       }
@@ -254,17 +309,17 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   if (components == 4) {
     // Start on the last line.
     JSAMPLE* scanlineptr = static_cast<JSAMPLE*>(
-        dstdata + static_cast<int64>(cinfo.output_height - 1) * stride);
+        dstdata + static_cast<int64>(target_output_height - 1) * stride);
     const JSAMPLE kOpaque = -1;  // All ones appropriate for JSAMPLE.
-    const int right_rgb = (cinfo.output_width - 1) * 3;
-    const int right_rgba = (cinfo.output_width - 1) * 4;
+    const int right_rgb = (target_output_width - 1) * 3;
+    const int right_rgba = (target_output_width - 1) * 4;
 
-    for (int y = cinfo.output_height; y-- > 0;) {
+    for (int y = target_output_height; y-- > 0;) {
       // We do all the transformations in place, going backwards for each row.
       const JSAMPLE* rgb_pixel = scanlineptr + right_rgb;
       JSAMPLE* rgba_pixel = scanlineptr + right_rgba;
       scanlineptr -= stride;
-      for (int x = cinfo.output_width; x-- > 0;
+      for (int x = target_output_width; x-- > 0;
            rgba_pixel -= 4, rgb_pixel -= 3) {
         // We copy the 3 bytes at rgb_pixel into the 4 bytes at rgba_pixel
         // The "a" channel is set to be opaque.
@@ -309,7 +364,12 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   // Handle errors in JPEG
   switch (error) {
     case JPEGERRORS_OK:
-      jpeg_finish_decompress(&cinfo);
+      if (cinfo.output_scanline < cinfo.output_height) {
+        // The scanlines below the crop window are not decoded at all.
+        jpeg_abort(reinterpret_cast<j_common_ptr>(&cinfo));
+      } else {
+        jpeg_finish_decompress(&cinfo);
+      }
       break;
     case JPEGERRORS_UNEXPECTED_END_OF_DATA:
     case JPEGERRORS_BAD_PARAM:
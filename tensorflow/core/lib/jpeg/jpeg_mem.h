@@ -61,6 +61,17 @@ struct UncompressFlags {
   //
   // Setting this has a quality/speed trade-off implication.
   J_DCT_METHOD dct_method = JDCT_DEFAULT;
+
+  // If true, only the crop window [crop_x, crop_x + crop_width) x
+  // [crop_y, crop_y + crop_height) of the image is output, in the coordinates
+  // of the image scaled by ratio. The window must be within the image. The
+  // scanlines below the window are not decoded, nor with libjpeg-turbo are
+  // those above it and the iMCU columns out of it.
+  bool crop = false;
+  int crop_x = 0;
+  int crop_y = 0;
+  int crop_width = 0;
+  int crop_height = 0;
 };
 
 // Uncompress some raw JPEG data given by the pointer srcdata and the length
@@ -95,6 +95,97 @@ TEST(JpegMemTest, Jpeg) {
   TestJPEG(env, data_path + "jpeg_merge_test1_cmyk.jpg");
 }
 
+void TestCropAndDecodeJpeg(Env* env, const string& jpegfile) {
+  string jpeg;
+  ReadFileToStringOrDie(env, jpegfile, &jpeg);
+  const int fsize = jpeg.size();
+  const uint8* const temp = bit_cast<const uint8*>(jpeg.data());
+
+  for (int ratio : {1, 2, 4}) {
+    for (bool fancy_upscaling : {false, true}) {
+      UncompressFlags flags;
+      flags.components = 3;
+      flags.ratio = ratio;
+      flags.fancy_upscaling = fancy_upscaling;
+      int w, h, c;
+      std::unique_ptr<uint8[]> full(
+          Uncompress(temp, fsize, flags, &w, &h, &c, nullptr));
+      CHECK(full != nullptr);
+
+      const int windows[][4] = {{0, 0, w, h},          {0, 0, 1, 1},
+                                {w - 1, h - 1, 1, 1},  {w / 3, h / 5, 9, 7},
+                                {5, h / 2, w - 5, 3},  {w / 2, 0, 1, h},
+                                {3, 1, w / 2, h / 2}};
+      for (const auto& window : windows) {
+        flags.crop = true;
+        flags.crop_x = window[0];
+        flags.crop_y = window[1];
+        flags.crop_width = window[2];
+        flags.crop_height = window[3];
+        int crop_w, crop_h, crop_c;
+        std::unique_ptr<uint8[]> cropped(
+            Uncompress(temp, fsize, flags, &crop_w, &crop_h, &crop_c, nullptr));
+        CHECK(cropped != nullptr);
+        CHECK_EQ(crop_w, flags.crop_width);
+        CHECK_EQ(crop_h, flags.crop_height);
+        CHECK_EQ(crop_c, 3);
+        // With fancy upscaling, libjpeg-turbo upsamples the chroma at the
+        // edges of the decoded iMCU columns slightly differently, so only
+        // the average error is bounded then.
+        const uint8* const full_window =
+            full.get() + (flags.crop_y * w + flags.crop_x) * 3;
+        const int totalerr = ComputeSumAbsoluteDifference(
+            cropped.get(), full_window, crop_w, crop_h, crop_w * 3, w * 3);
+        if (fancy_upscaling) {
+          CHECK_LE(totalerr, 3 * crop_w * crop_h * 3) << jpegfile;
+        } else {
+          CHECK_EQ(totalerr, 0) << jpegfile;
+        }
+      }
+
+      // Windows that are empty or out of the image are rejected.
+      const int bad_windows[][4] = {
+          {0, 0, 0, 1}, {-1, 0, 1, 1}, {0, 0, w + 1, 1}, {0, h, 1, 1}};
+      for (const auto& window : bad_windows) {
+        flags.crop_x = window[0];
+        flags.crop_y = window[1];
+        flags.crop_width = window[2];
+        flags.crop_height = window[3];
+        std::unique_ptr<uint8[]> cropped(
+            Uncompress(temp, fsize, flags, &w, &h, &c, nullptr));
+        CHECK(cropped == nullptr);
+      }
+    }
+  }
+
+  // The lines of the window missing from truncated data are filled in when
+  // recovering.
+  UncompressFlags flags;
+  flags.components = 3;
+  flags.crop = true;
+  flags.crop_x = 10;
+  flags.crop_y = 100;
+  flags.crop_width = 50;
+  flags.crop_height = 100;
+  int w, h, c;
+  std::unique_ptr<uint8[]> cropped(
+      Uncompress(temp, fsize / 2, flags, &w, &h, &c, nullptr));
+  CHECK(cropped == nullptr);
+  flags.try_recover_truncated_jpeg = true;
+  cropped.reset(Uncompress(temp, fsize / 2, flags, &w, &h, &c, nullptr));
+  CHECK(cropped != nullptr);
+  CHECK_EQ(w, 50);
+  CHECK_EQ(h, 100);
+}
+
+TEST(JpegMemTest, CropAndDecodeJpeg) {
+  Env* env = Env::Default();
+  const string data_path = kTestData;
+
+  TestCropAndDecodeJpeg(env, data_path + "jpeg_merge_test1.jpg");
+  TestCropAndDecodeJpeg(env, data_path + "jpeg_merge_test1_cmyk.jpg");
+}
+
 TEST(JpegMemTest, Jpeg2) {
   // create known data, for size in_w x in_h
   const int in_w = 256;
@@ -18,6 +18,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_MOBILE_SAMPLER_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_MOBILE_SAMPLER_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
@@ -25,6 +27,13 @@ limitations under the License.
 namespace tensorflow {
 namespace monitoring {
 
+// Null implementation of the bucket helper; see sampler.h.
+inline std::vector<double> ExponentialBuckets(double scale,
+                                              double growth_factor,
+                                              int bucket_count) {
+  return {};
+}
+
 // SamplerCell which has a null implementation.
 class SamplerCell {
  public:
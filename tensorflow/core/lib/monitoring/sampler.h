@@ -25,6 +25,7 @@ limitations under the License.
 
 #include <float.h>
 #include <map>
+#include <vector>
 
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
@@ -65,6 +66,13 @@ class SamplerCell {
   TF_DISALLOW_COPY_AND_ASSIGN(SamplerCell);
 };
 
+// Returns "bucket_count" bucket limits growing geometrically from "scale",
+// i.e. scale * growth_factor^i for i in [0, bucket_count).
+//
+// REQUIRES: scale > 0, growth_factor > 1, bucket_count > 0.
+std::vector<double> ExponentialBuckets(double scale, double growth_factor,
+                                       int bucket_count);
+
 // A stateful class for updating a cumulative histogram metric.
 //
 // This class encapsulates a set of histograms (or a single histogram for a
@@ -158,6 +166,22 @@ inline HistogramProto SamplerCell::value() const {
   return pb;
 }
 
+inline std::vector<double> ExponentialBuckets(double scale,
+                                              double growth_factor,
+                                              int bucket_count) {
+  CHECK_GT(scale, 0.0);
+  CHECK_GT(growth_factor, 1.0);
+  CHECK_GT(bucket_count, 0);
+  std::vector<double> bucket_limits;
+  bucket_limits.reserve(bucket_count);
+  double bound = scale;
+  for (int i = 0; i < bucket_count; ++i) {
+    bucket_limits.push_back(bound);
+    bound *= growth_factor;
+  }
+  return bucket_limits;
+}
+
 template <int NumLabels>
 Sampler<NumLabels>* Sampler<NumLabels>::New(
     const MetricDef<MetricKind::kCumulative, HistogramProto, NumLabels>&
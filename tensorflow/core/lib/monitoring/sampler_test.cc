@@ -87,6 +87,11 @@ TEST(UnlabeledSamplerTest, BucketBoundaries) {
   EqHistograms(expected, cell->value());
 }
 
+TEST(ExponentialBucketsTest, GrowsGeometrically) {
+  const std::vector<double> expected = {2.0, 6.0, 18.0, 54.0};
+  EXPECT_EQ(expected, ExponentialBuckets(2.0, 3.0, 4));
+}
+
 }  // namespace
 }  // namespace monitoring
 }  // namespace tensorflow
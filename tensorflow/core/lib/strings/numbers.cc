@@ -18,6 +18,7 @@ limitations under the License.
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <algorithm>
 #include <cmath>
 #include <locale>
@@ -323,6 +324,31 @@ bool safe_strtod(const char* str, double* value) {
   return *str != '\0' && *endptr == '\0';
 }
 
+namespace {
+
+// Calls convert on a NUL-terminated copy of str, on the stack if it is short.
+template <typename T>
+bool SafeStrToFloatingPoint(StringPiece str, T* value,
+                            bool (*convert)(const char*, T*)) {
+  char buffer[64];
+  if (str.size() < sizeof(buffer)) {
+    memcpy(buffer, str.data(), str.size());
+    buffer[str.size()] = '\0';
+    return convert(buffer, value);
+  }
+  return convert(str.ToString().c_str(), value);
+}
+
+}  // namespace
+
+bool safe_strtof(StringPiece str, float* value) {
+  return SafeStrToFloatingPoint(str, value, safe_strtof);
+}
+
+bool safe_strtod(StringPiece str, double* value) {
+  return SafeStrToFloatingPoint(str, value, safe_strtod);
+}
+
 char* FloatToBuffer(float value, char* buffer) {
   // FLT_DIG is 6 for IEEE-754 floats, which are used on almost all
   // platforms these days.  Just in case some system exists where FLT_DIG
@@ -122,6 +122,11 @@ bool safe_strtof(const char* str, float* value);
 // Values may be rounded on over- and underflow.
 bool safe_strtod(const char* str, double* value);
 
+// Same as above for strings that need not be NUL-terminated. Short strings
+// are converted without allocating memory.
+bool safe_strtof(StringPiece str, float* value);
+bool safe_strtod(StringPiece str, double* value);
+
 // Converts from an int64 to a human readable string representing the
 // same number, using decimal powers.  e.g. 1200000 -> "1.20M".
 string HumanReadableNum(int64 value);
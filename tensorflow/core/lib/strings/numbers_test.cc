@@ -278,6 +278,15 @@ TEST(safe_strtof, Float) {
   EXPECT_EQ(-42.0f, result);
 
   EXPECT_FALSE(safe_strtof("-infinity is awesome", &result));
+
+  // Strings that are not NUL-terminated, short and long.
+  EXPECT_TRUE(safe_strtof(StringPiece("1.5,2.5", 3), &result));
+  EXPECT_EQ(1.5f, result);
+  EXPECT_FALSE(safe_strtof(StringPiece("1.5,2.5", 4), &result));
+  EXPECT_FALSE(safe_strtof(StringPiece(), &result));
+  const string long_float = "0." + string(100, '0') + "1e100";
+  EXPECT_TRUE(safe_strtof(StringPiece(long_float), &result));
+  EXPECT_FLOAT_EQ(1e-1f, result);
 }
 
 TEST(safe_strtod, Double) {
@@ -296,6 +305,14 @@ TEST(safe_strtod, Double) {
 
   EXPECT_TRUE(safe_strtod("1e-325", &result));
   EXPECT_EQ(0, result);
+
+  // Strings that are not NUL-terminated, short and long.
+  EXPECT_TRUE(safe_strtod(StringPiece("0.25 x", 5), &result));
+  EXPECT_EQ(0.25, result);
+  EXPECT_FALSE(safe_strtod(StringPiece("0.25 x", 6), &result));
+  const string long_double = "0." + string(100, '0') + "1e100";
+  EXPECT_TRUE(safe_strtod(StringPiece(long_double), &result));
+  EXPECT_DOUBLE_EQ(1e-1, result);
 }
 
 }  // namespace strings
@@ -198,7 +198,10 @@ REGISTER_OP("Enter")
     .Attr("is_constant: bool = false")
     .Attr("parallel_iterations: int = 10")
     .SetShapeFn([](InferenceContext* c) {
-      c->set_output(0, c->UnknownShape());
+      // A constant Enter forwards the same tensor to all the iterations.
+      bool is_constant;
+      TF_RETURN_IF_ERROR(c->GetAttr("is_constant", &is_constant));
+      c->set_output(0, is_constant ? c->input(0) : c->UnknownShape());
 
       // Handle resource shape / dtype, if present.
       auto* handle_data = c->input_handle_shapes_and_types(0);
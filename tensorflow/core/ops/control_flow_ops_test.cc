@@ -49,6 +49,27 @@ TEST(ControlFlowOpsTest, Merge_ShapeFn) {
   INFER_OK(op, "[2,1];[2,1];[2,1]", "in0;[]");
 }
 
+TEST(ControlFlowOpsTest, Enter_ShapeFn) {
+  ShapeInferenceTestOp op("Enter");
+
+  // The shape of the loop variables can change between the iterations.
+  TF_ASSERT_OK(NodeDefBuilder("test", "Enter")
+                   .Input("a", 0, DT_FLOAT)
+                   .Attr("frame_name", "loop")
+                   .Attr("is_constant", false)
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "[2,1]", "?");
+
+  // The constants keep the shape of their input.
+  TF_ASSERT_OK(NodeDefBuilder("test", "Enter")
+                   .Input("a", 0, DT_FLOAT)
+                   .Attr("frame_name", "loop")
+                   .Attr("is_constant", true)
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "?", "in0");
+  INFER_OK(op, "[2,1]", "in0");
+}
+
 TEST(ControlFlowOpsTest, RefSelect_ShapeFn) {
   ShapeInferenceTestOp op("RefSelect");
 
@@ -988,6 +988,7 @@ REGISTER_OP("SparseConditionalAccumulator")
     .Attr("shape: shape")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
+    .Attr("dense_accumulation: bool = false")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       c->set_output(0, c->Vector(2));
@@ -1010,6 +1011,10 @@ container: If non-empty, this accumulator is placed in the given container.
   Otherwise, a default container is used.
 shared_name: If non-empty, this accumulator will be shared under the given name
   across multiple sessions.
+dense_accumulation: If true, the sum is kept in a dense tensor of the given
+  shape, which must be fully defined, and gradients applied concurrently are
+  added to it in parallel. This is faster when many large sparse gradients are
+  aggregated per step, at the cost of the memory of one dense gradient.
 )doc");
 
 REGISTER_OP("SparseAccumulatorApplyGradient")
@@ -151,9 +151,80 @@ up to `num_threads` threads to process elements from `input_dataset`
 in parallel.
 
 num_threads: The number of threads to use to process elements from
-  `input_dataset`.
+  `input_dataset`. If -1, each iterator starts with one call of `f` in
+  flight and adjusts the number of concurrent calls (up to the number of
+  schedulable CPUs) and the size of its buffer at runtime, based on how long
+  its consumer waits for elements.
 output_buffer_size: The maximum number of output elements to buffer in an
-  iterator over this dataset.
+  iterator over this dataset. If `num_threads` is -1, a value less than or
+  equal to zero means twice the maximum number of concurrent calls.
+)doc");
+
+REGISTER_OP("MapAndBatchDataset")
+    .Input("input_dataset: resource")
+    .Input("other_arguments: Targuments")
+    .Input("batch_size: int64")
+    .Input("num_threads: int32")
+    .Output("handle: resource")
+    .Attr("f: func")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that applies `f` to the outputs of `input_dataset` and then
+batches `batch_size` of them.
+
+Unlike a "ParallelMapDataset" followed by a "BatchDataset", this dataset
+copies the outputs of each call of `f` into its slice of the batch as soon as
+the call finishes, using up to `num_threads` threads.
+
+batch_size: A scalar representing the number of elements to accumulate in a
+  batch.
+num_threads: The number of threads to use to process elements from
+  `input_dataset`.
+)doc");
+
+REGISTER_OP("ParseExampleDataset")
+    .Input("input_dataset: resource")
+    .Input("num_threads: int32")
+    .Input("sparse_keys: Nsparse * string")
+    .Input("dense_keys: Ndense * string")
+    .Input("dense_defaults: Tdense")
+    .Output("handle: resource")
+    .Attr("Nsparse: int >= 0")  // Inferred from sparse_keys
+    .Attr("Ndense: int >= 0")   // Inferred from dense_keys
+    .Attr("sparse_types: list({float,int64,string}) >= 0")
+    .Attr("Tdense: list({float,int64,string}) >= 0")
+    .Attr("dense_shapes: list(shape) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that parses batches of serialized `Example` protos from
+`input_dataset`.
+
+Each element of `input_dataset` must be a vector of serialized `Example`
+protos. Each element of this dataset contains the outputs of the ParseExample
+op applied to that vector: the indices, values and shape of each sparse
+feature in turn, followed by the values of each dense feature. The examples in
+a batch are parsed in parallel, using up to `num_threads` threads.
+
+num_threads: The number of threads to use to parse each batch.
+sparse_keys: A list of Nsparse string Tensors (scalars).
+  The keys expected in the Examples' features associated with sparse values.
+dense_keys: A list of Ndense string Tensors (scalars).
+  The keys expected in the Examples' features associated with dense values.
+dense_defaults: A list of Ndense Tensors (some may be empty).
+  dense_defaults[j] provides default values
+  when the example's feature_map lacks dense_key[j].  If an empty Tensor is
+  provided for dense_defaults[j], then the Feature dense_keys[j] is required.
+sparse_types: A list of Nsparse types; the data types of data in each Feature
+  given in sparse_keys.
+Tdense: A list of Ndense types; the data types of data in each Feature given
+  in dense_keys.
+dense_shapes: A list of Ndense shapes; the shapes of data in each Feature
+  given in dense_keys.
 )doc");
 
 REGISTER_OP("FlatMapDataset")
@@ -177,6 +248,64 @@ f: A function mapping elements of `input_dataset`, concatenated with
   `output_types` and `output_shapes`.
 )doc");
 
+REGISTER_OP("InterleaveDataset")
+    .Input("input_dataset: resource")
+    .Input("other_arguments: Targuments")
+    .Input("cycle_length: int64")
+    .Input("block_length: int64")
+    .Output("handle: resource")
+    .Attr("f: func")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that applies `f` to the outputs of `input_dataset`.
+
+Unlike FlatMapDataset, InterleaveDataset keeps `cycle_length` of the
+datasets returned by `f` open at a time, and cycles through them, taking
+`block_length` consecutive elements from each in turn.
+
+f: A function mapping elements of `input_dataset`, concatenated with
+  `other_arguments`, to a Dataset resource that contains elements matching
+  `output_types` and `output_shapes`.
+cycle_length: The number of datasets returned by `f` to read from at a time.
+block_length: The number of consecutive elements to take from each dataset
+  before moving on to the next one in the cycle.
+)doc");
+
+REGISTER_OP("ParallelInterleaveDataset")
+    .Input("input_dataset: resource")
+    .Input("other_arguments: Targuments")
+    .Input("cycle_length: int64")
+    .Input("block_length: int64")
+    .Input("sloppy: bool")
+    .Output("handle: resource")
+    .Attr("f: func")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that applies `f` to the outputs of `input_dataset`.
+
+Like InterleaveDataset, but each of the `cycle_length` datasets returned by
+`f` is read by its own background thread, which buffers up to
+`block_length` elements ahead of the consumer. The next input elements are
+opened as soon as a thread becomes free.
+
+f: A function mapping elements of `input_dataset`, concatenated with
+  `other_arguments`, to a Dataset resource that contains elements matching
+  `output_types` and `output_shapes`.
+cycle_length: The number of datasets returned by `f` to read from
+  concurrently.
+block_length: The number of consecutive elements to take from each dataset
+  before moving on to the next one in the cycle.
+sloppy: If false, the elements are produced in the same order as by
+  InterleaveDataset. If true, a dataset whose next element is not ready is
+  skipped in favor of the next one in the cycle that has an element ready.
+)doc");
+
 REGISTER_OP("GroupByWindowDataset")
     .Input("input_dataset: resource")
     .Input("key_func_other_arguments: Tkey_func_other_arguments")
@@ -326,9 +455,47 @@ seed: A scalar seed for the random number generator. If either seed or
 seed2: A second scalar seed to avoid seed collision.
 )doc");
 
+REGISTER_OP("PrefetchDataset")
+    .Input("input_dataset: resource")
+    .Input("buffer_size: int64")
+    .Output("handle: resource")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that asynchronously prefetches elements from `input_dataset`.
+
+An iterator over this dataset reads from an iterator over `input_dataset` on
+a background thread, so that producing the next element overlaps with the
+computation that consumes the current one.
+
+buffer_size: The maximum number of elements to buffer in an iterator over
+  this dataset.
+)doc");
+
+REGISTER_OP("CacheDataset")
+    .Input("input_dataset: resource")
+    .Input("filename: string")
+    .Output("handle: resource")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that caches elements from `input_dataset`.
+
+The first iterator that reads `input_dataset` to the end fills the cache, and
+iterators created after that read the elements from the cache instead of
+from `input_dataset`.
+
+filename: A path on the filesystem where the elements are cached as a tensor
+  bundle. If the bundle already exists, it is used as the cache. If
+  `filename` is the empty string, the elements are cached in memory.
+)doc");
+
 REGISTER_OP("TextLineDataset")
     .Input("filenames: string")
     .Output("handle: resource")
+    .Attr("use_mmap: bool = false")
     .SetShapeFn(shape_inference::ScalarShape)  // TODO(mrry): validate
                                                // that `filenames` is
                                                // a scalar or a
@@ -338,6 +505,9 @@ Creates a dataset that emits the lines of one or more text files.
 
 filenames: A scalar or a vector containing the name(s) of the file(s) to be
   read.
+use_mmap: If true, read each file through a read-only memory mapping when its
+  file system supports one, instead of through a buffer. A file must not be
+  truncated while it is mapped.
 )doc");
 
 REGISTER_OP("FixedLengthRecordDataset")
@@ -346,6 +516,7 @@ REGISTER_OP("FixedLengthRecordDataset")
     .Input("record_bytes: int64")
     .Input("footer_bytes: int64")
     .Output("handle: resource")
+    .Attr("use_mmap: bool = false")
     .SetShapeFn(shape_inference::ScalarShape)
     .Doc(R"doc(
 Creates a dataset that emits the records from one or more binary files.
@@ -357,6 +528,9 @@ header_bytes: A scalar representing the number of bytes to skip at the
 record_bytes: A scalar representing the number of bytes in each record.
 footer_bytes: A scalar representing the number of bytes to skip at the end
   of a file.
+use_mmap: If true, read each file through a read-only memory mapping when its
+  file system supports one, instead of through a buffer. A file must not be
+  truncated while it is mapped.
 )doc");
 
 REGISTER_OP("TFRecordDataset")
@@ -439,6 +613,7 @@ REGISTER_OP("IteratorGetNext")
     .Output("components: output_types")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
+    .Attr("collect_stats: bool = false")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
@@ -459,6 +634,9 @@ REGISTER_OP("IteratorGetNext")
     })
     .Doc(R"doc(
 Gets the next output from the given iterator.
+
+collect_stats: If true, the iterator and its inputs record their statistics,
+  exported under /tensorflow/data/iterator/, in this call.
 )doc");
 
 REGISTER_OP("IteratorDispose")
@@ -369,6 +369,80 @@ dct_method: string specifying a hint about the algorithm used for
 image: 3-D with shape `[height, width, channels]`..
 )doc");
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndCropAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Attr("align_corners: bool = false")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      ShapeHandle crop_window;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &crop_window));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(crop_window, 0), 4, &unused_dim));
+      int32 channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels < 0) {
+        return errors::InvalidArgument("channels must be non-negative, got ",
+                                       channels);
+      }
+      DimensionHandle channels_dim =
+          channels == 0 ? c->UnknownDim() : c->MakeDim(channels);
+      ShapeHandle size;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &size));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(size, 0), 2, &unused_dim));
+      ShapeHandle image;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(2, &image));
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(image, c->Vector(channels_dim), &image));
+      c->set_output(0, image);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Decode a crop of a JPEG-encoded image and resize it to a float tensor.
+
+This is equivalent to, but much faster than, `DecodeJpeg` followed by a crop
+and `ResizeBilinear`.  When the crop is at least twice as large as `size`, the
+image is decoded at 1/2, 1/4 or 1/8 of its size with the scaled IDCT of libjpeg,
+picking the smallest that still leaves as many pixels as `size` in the crop.
+Only the part of the crop that the interpolation reads is decoded: the
+scanlines below it are not decoded at all.
+
+When the image is decoded at a smaller size, the output is interpolated from
+the average of the pixels of each block of the scaled IDCT, so it differs
+slightly from the resized crop of the full image.
+
+contents: 0-D.  The JPEG-encoded image.
+crop_window: 1-D.  The crop window: [crop_y, crop_x, crop_height, crop_width],
+  in pixels of the full image.  It must be within the image.
+size: 1-D of 2 elements: `new_height, new_width`.  The size of the output.
+channels: Number of color channels for the decoded image.
+fancy_upscaling: If true use a slower but nicer upscaling of the
+  chroma planes (yuv420/422 only).
+try_recover_truncated:  If true try to recover an image from truncated input.
+acceptable_fraction: The minimum required fraction of lines before a truncated
+  input is accepted.
+dct_method: string specifying a hint about the algorithm used for
+  decompression.  Defaults to "" which maps to a system-specific
+  default.  Currently valid values are ["INTEGER_FAST",
+  "INTEGER_ACCURATE"].  The hint may be ignored (e.g., the internal
+  jpeg library changes to a version that does not have that specific
+  option.)
+align_corners: If true, rescale the crop by (new_height - 1) /
+  (crop_height - 1), which exactly aligns the 4 corners of the crop and the
+  output. If false, rescale by new_height / crop_height. Treat similarly the
+  width dimension.
+image: 3-D with shape `[new_height, new_width, channels]`.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -1074,4 +1148,69 @@ selected_indices: A 1-D integer tensor of shape `[M]` representing the selected
   indices from the boxes tensor, where `M <= max_output_size`.
 )doc");
 
+REGISTER_OP("BatchedNonMaxSuppression")
+    .Input("boxes: float")
+    .Input("scores: float")
+    .Input("max_output_size_per_class: int32")
+    .Input("iou_threshold: float")
+    .Input("score_threshold: float")
+    .Output("selected_indices: int32")
+    .Output("num_selected: int32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle boxes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &boxes));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 2), 4, &unused_dim));
+      ShapeHandle scores;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 3, &scores));
+      DimensionHandle batch_size;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 0), c->Dim(scores, 0), &batch_size));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 1), c->Dim(scores, 1), &unused_dim));
+      ShapeHandle unused;
+      for (int i = 2; i < 5; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      DimensionHandle max_output_size;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &max_output_size));
+      DimensionHandle num_classes = c->Dim(scores, 2);
+      c->set_output(0,
+                    c->MakeShape({batch_size, num_classes, max_output_size}));
+      c->set_output(1, c->Matrix(batch_size, num_classes));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Greedily selects, for every image and class of a batch, a subset of bounding
+boxes in descending order of score, pruning away boxes that have high
+intersection-over-union (IOU) overlap with previously selected boxes of the
+same image and class.
+
+This performs the selection of `NonMaxSuppressionV2` independently for each
+image and class, with all classes of an image sharing the same boxes; boxes
+whose score for a class is not above `score_threshold` are never selected for
+it. The selections for different images and classes run in parallel.
+
+  selected_indices, num_selected = tf.image.batched_non_max_suppression(
+      boxes, scores, max_output_size_per_class, iou_threshold,
+      score_threshold)
+
+boxes: A 3-D float tensor of shape `[batch_size, num_boxes, 4]`, the boxes of
+  every image as `[y1, x1, y2, x2]`, as for `NonMaxSuppressionV2`.
+scores: A 3-D float tensor of shape `[batch_size, num_boxes, num_classes]`
+  representing the score of every box for every class.
+max_output_size_per_class: A scalar integer tensor representing the maximum
+  number of boxes to be selected for each image and class.
+iou_threshold: A 0-D float tensor representing the threshold for deciding
+  whether boxes overlap too much with respect to IOU.
+score_threshold: A 0-D float tensor; boxes with a score not above it are
+  discarded before the selection.
+selected_indices: A 3-D integer tensor of shape
+  `[batch_size, num_classes, max_output_size_per_class]`. Row `[b, c]` holds
+  the indices, in the boxes of image `b`, of the boxes selected for class `c`
+  in descending order of score, padded with -1.
+num_selected: A 2-D integer tensor of shape `[batch_size, num_classes]`, the
+  number of boxes selected for each image and class.
+)doc");
+
 }  // namespace tensorflow
@@ -90,6 +90,47 @@ TEST(ImageOpsTest, DecodeImage_ShapeFn) {
   }
 }
 
+TEST(ImageOpsTest, DecodeAndCropAndResizeJpeg_ShapeFn) {
+  ShapeInferenceTestOp op("DecodeAndCropAndResizeJpeg");
+  op.input_tensors.resize(3);
+  TF_ASSERT_OK(NodeDefBuilder("test", "DecodeAndCropAndResizeJpeg")
+                   .Input({"a", 0, DT_STRING})
+                   .Input({"b", 0, DT_INT32})
+                   .Input({"c", 0, DT_INT32})
+                   .Finalize(&op.node_def));
+
+  // Rank and size checks.
+  INFER_ERROR("Shape must be rank 0 but is rank 1", op, "[1];?;?");
+  INFER_ERROR("Dimension must be 4 but is 3", op, "[];[3];?");
+  INFER_ERROR("Shape must be rank 1 but is rank 0", op, "[];?;[]");
+  INFER_ERROR("Dimension must be 2 but is 3", op, "[];?;[3]");
+
+  // When the size tensor is not a constant, the size is unknown.
+  INFER_OK(op, "[];[4];[2]", "[?,?,?]");
+
+  Tensor size_tensor = test::AsTensor<int32>({20, 30});
+  op.input_tensors[2] = &size_tensor;
+  INFER_OK(op, "[];[4];[2]", "[20,30,?]");
+
+  // Set the channel and so that part of output shape is known.
+  TF_ASSERT_OK(NodeDefBuilder("test", "DecodeAndCropAndResizeJpeg")
+                   .Input({"a", 0, DT_STRING})
+                   .Input({"b", 0, DT_INT32})
+                   .Input({"c", 0, DT_INT32})
+                   .Attr("channels", 3)
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "[];[4];[2]", "[20,30,3]");
+
+  // Negative channel value is rejected.
+  TF_ASSERT_OK(NodeDefBuilder("test", "DecodeAndCropAndResizeJpeg")
+                   .Input({"a", 0, DT_STRING})
+                   .Input({"b", 0, DT_INT32})
+                   .Input({"c", 0, DT_INT32})
+                   .Attr("channels", -1)
+                   .Finalize(&op.node_def));
+  INFER_ERROR("channels must be non-negative, got -1", op, "[];[4];[2]");
+}
+
 TEST(ImageOpsTest, EncodeImage_ShapeFn) {
   for (const char* op_name : {"EncodeJpeg", "EncodePng"}) {
     ShapeInferenceTestOp op(op_name);
@@ -225,4 +266,23 @@ TEST(ImageOpsTest, RandomCrop_ShapeFn) {
   INFER_OK(op, "[?,?,?];[2]", "[10,20,d0_2]");
 }
 
+TEST(ImageOpsTest, BatchedNonMaxSuppression_ShapeFn) {
+  ShapeInferenceTestOp op("BatchedNonMaxSuppression");
+  op.input_tensors.resize(5);
+
+  // Inputs are boxes, scores, max_output_size_per_class, iou_threshold and
+  // score_threshold.
+  INFER_OK(op, "?;?;?;?;?", "[?,?,?];[?,?]");
+  INFER_OK(op, "[2,10,4];[?,?,3];[];[];[]", "[d0_0,d1_2,?];[d0_0,d1_2]");
+  INFER_ERROR("Shape must be rank 3 but is rank 2", op, "[10,4];?;?;?;?");
+  INFER_ERROR("Dimension must be 4 but is 3", op, "[2,10,3];?;?;?;?");
+  INFER_ERROR("Dimensions must be equal, but are 10 and 9", op,
+              "[2,10,4];[2,9,1];?;?;?");
+  INFER_ERROR("Shape must be rank 0 but is rank 1", op, "?;?;[1];?;?");
+
+  Tensor max_output_size = test::AsScalar<int32>(5);
+  op.input_tensors[2] = &max_output_size;
+  INFER_OK(op, "[2,10,4];[2,10,3];[];[];[]", "[d0_0,d1_2,5];[d0_0,d1_2]");
+}
+
 }  // end namespace tensorflow
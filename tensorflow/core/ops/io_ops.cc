@@ -62,6 +62,9 @@ REGISTER_OP("SaveV2")
     .Input("shape_and_slices: string")
     .Input("tensors: dtypes")
     .Attr("dtypes: list(type)")
+    .Attr("async_write: bool = false")
+    .Attr("num_shards: int >= 1 = 1")
+    .Attr("data_alignment: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle unused;
@@ -94,6 +97,16 @@ tensor_names: shape {N}. The names of the tensors to be saved.
 shape_and_slices: shape {N}.  The slice specs of the tensors to be saved.
   Empty strings indicate that they are non-partitioned tensors.
 tensors: `N` tensors to save.
+async_write: If true, copies the tensors and writes the checkpoint after the op
+  returns, in the background and in order with the other asynchronous writes of
+  the device.  Errors are returned by WaitForAsyncSaves.
+num_shards: The maximum number of data files to split the tensors among, which
+  are written concurrently.  Each data file holds at least 32MB, so that small
+  checkpoints stay in a single file.
+data_alignment: The alignment in bytes of the data of the non-string tensors in
+  the data files.  The tensors restored by the "mmap" kernel of RestoreV2 only
+  alias the mapped files when their data is aligned like the allocations of
+  TensorFlow, which an alignment of 64 always ensures.
 )doc");
 
 REGISTER_OP("RestoreV2")
@@ -143,6 +156,7 @@ REGISTER_OP("MergeV2Checkpoints")
     .Input("checkpoint_prefixes: string")
     .Input("destination_prefix: string")
     .Attr("delete_old_dirs: bool = true")
+    .Attr("async_write: bool = false")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle unused;
@@ -165,6 +179,22 @@ checkpoint_prefixes: prefixes of V2 checkpoints to merge.
 destination_prefix: scalar.  The desired final prefix.  Allowed to be the same
   as one of the checkpoint_prefixes.
 delete_old_dirs: see above.
+async_write: If true, merges in the background after the asynchronous writes of
+  the device scheduled before, such as those of SaveV2 with async_write.
+  Errors are returned by WaitForAsyncSaves.  The writes of the other devices
+  are not waited for: the checkpoints written on them must be waited for by
+  a WaitForAsyncSaves on each of them, as control inputs.
+)doc");
+
+REGISTER_OP("WaitForAsyncSaves")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Waits for the asynchronous checkpoint writes scheduled before on the device.
+
+These are the writes of SaveV2 and MergeV2Checkpoints with async_write.  Returns
+the first error of those writes not yet returned by a previous
+WaitForAsyncSaves, if any.
 )doc");
 
 REGISTER_OP("Save")
@@ -312,6 +312,7 @@ REGISTER_OP("HashTable")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("fingerprint_keys: bool = false")
     .SetIsStateful()
     .SetShapeFn(TwoElementOutput)
     .Doc(R"doc(
@@ -330,6 +331,10 @@ use_node_name_sharing: If true and shared_name is empty, the table is shared
   using the node name.
 key_dtype: Type of the table keys.
 value_dtype: Type of the table values.
+fingerprint_keys: If true, the table stores the 64-bit fingerprints of the
+  keys instead of the keys, which bounds the memory used per entry. Two keys
+  with the same fingerprint are then the same key. Only string keys are
+  supported.
 )doc");
 
 REGISTER_OP("HashTableV2")
@@ -339,6 +344,7 @@ REGISTER_OP("HashTableV2")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("fingerprint_keys: bool = false")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput)
     .Doc(R"doc(
@@ -357,6 +363,10 @@ use_node_name_sharing: If true and shared_name is empty, the table is shared
   using the node name.
 key_dtype: Type of the table keys.
 value_dtype: Type of the table values.
+fingerprint_keys: If true, the table stores the 64-bit fingerprints of the
+  keys instead of the keys, which bounds the memory used per entry. Two keys
+  with the same fingerprint are then the same key. Only string keys are
+  supported.
 )doc");
 
 REGISTER_OP("MutableHashTable")
@@ -366,6 +376,7 @@ REGISTER_OP("MutableHashTable")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("num_shards: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn(TwoElementOutput)
     .Doc(R"doc(
@@ -384,6 +395,10 @@ use_node_name_sharing: If true and shared_name is empty, the table is shared
   using the node name.
 key_dtype: Type of the table keys.
 value_dtype: Type of the table values.
+num_shards: The number of shards the table is split into, each with its own
+  lock. Lookups and inserts then only contend when they touch the same shard,
+  but a lookup may see part of a concurrent insert, and the export of a table
+  is not a snapshot of all its shards at once.
 )doc");
 
 REGISTER_OP("MutableHashTableV2")
@@ -393,6 +408,7 @@ REGISTER_OP("MutableHashTableV2")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("num_shards: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput)
     .Doc(R"doc(
@@ -411,6 +427,10 @@ use_node_name_sharing: If true and shared_name is empty, the table is shared
   using the node name.
 key_dtype: Type of the table keys.
 value_dtype: Type of the table values.
+num_shards: The number of shards the table is split into, each with its own
+  lock. Lookups and inserts then only contend when they touch the same shard,
+  but a lookup may see part of a concurrent insert, and the export of a table
+  is not a snapshot of all its shards at once.
 )doc");
 
 REGISTER_OP("MutableHashTableOfTensors")
@@ -421,6 +441,7 @@ REGISTER_OP("MutableHashTableOfTensors")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
     .Attr("value_shape: shape = {}")
+    .Attr("num_shards: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn(TwoElementOutput)
     .Doc(R"doc(
@@ -437,6 +458,10 @@ shared_name: If non-empty, this table is shared under the given name across
   multiple sessions.
 key_dtype: Type of the table keys.
 value_dtype: Type of the table values.
+num_shards: The number of shards the table is split into, each with its own
+  lock. Lookups and inserts then only contend when they touch the same shard,
+  but a lookup may see part of a concurrent insert, and the export of a table
+  is not a snapshot of all its shards at once.
 )doc");
 
 REGISTER_OP("MutableHashTableOfTensorsV2")
@@ -447,6 +472,7 @@ REGISTER_OP("MutableHashTableOfTensorsV2")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
     .Attr("value_shape: shape = {}")
+    .Attr("num_shards: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput)
     .Doc(R"doc(
@@ -463,6 +489,10 @@ shared_name: If non-empty, this table is shared under the given name across
   multiple sessions.
 key_dtype: Type of the table keys.
 value_dtype: Type of the table values.
+num_shards: The number of shards the table is split into, each with its own
+  lock. Lookups and inserts then only contend when they touch the same shard,
+  but a lookup may see part of a concurrent insert, and the export of a table
+  is not a snapshot of all its shards at once.
 )doc");
 
 REGISTER_OP("MutableDenseHashTable")
@@ -47,6 +47,34 @@ Add all input tensors element wise.
 inputs: Must all be the same size and shape.
 )doc");
 
+#ifdef INTEL_MKL
+REGISTER_OP("_MklAddN")
+    .Input("inputs: N * T")
+    .Input("mkl_inputs: N * uint8")
+    .Output("sum: T")
+    .Output("mkl_sum: uint8")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .SetShapeFn([](InferenceContext* c) {
+      const int N = c->num_inputs() / 2;
+      ShapeHandle cur = c->input(N - 1);
+      for (int i = N - 2; i >= 0; --i) {
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(c->Merge(c->input(i), cur, &cur),
+                                        "From merging shape ", i,
+                                        " with other shapes.");
+      }
+      c->set_output(0, cur);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+MKL version of AddN operator. Adds the inputs element wise in their Mkl
+layout when they all share one, so that the sum stays in that layout.
+
+NOTE Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to invoke these operators.
+)doc");
+#endif
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("BatchMatMul")
@@ -1073,7 +1101,7 @@ REGISTER_OP("MatMul")
     .Output("product: T")
     .Attr("transpose_a: bool = false")
     .Attr("transpose_b: bool = false")
-    .Attr("T: {half, float, double, int32, complex64, complex128}")
+    .Attr("T: {bfloat16, half, float, double, int32, complex64, complex128}")
     .SetShapeFn(shape_inference::MatMulShape)
     .Doc(R"doc(
 Multiply the matrix "a" by the matrix "b".
@@ -1090,6 +1118,28 @@ transpose_a: If true, "a" is transposed before multiplication.
 transpose_b: If true, "b" is transposed before multiplication.
 )doc");
 
+REGISTER_OP("_FusedMatMul")
+    .Input("a: T")
+    .Input("b: T")
+    .Input("args: num_args * T")
+    .Output("product: T")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string) = []")
+    .Attr("epsilon: float = 0.0001")
+    .SetShapeFn(shape_inference::MatMulShape)
+    .Doc(R"doc(
+MatMul followed by the ops in `fused_ops`, applied to the product in place.
+
+`fused_ops` is a BiasAdd, optionally followed by a Relu, Relu6 or Elu. `args`
+holds the bias.
+
+NOTE Do not invoke this operator directly in Python. The remapper graph
+rewrite pass is expected to create these operators.
+)doc");
+
 REGISTER_OP("SparseMatMul")
     .Input("a: Ta")
     .Input("b: Tb")
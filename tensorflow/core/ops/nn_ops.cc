@@ -552,6 +552,31 @@ data_format: Specify the data format of the input and output data. With the
         [batch, channels, height, width].
 )doc");
 
+REGISTER_OP("_FusedConv2D")
+    .Input("input: T")
+    .Input("filter: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 0")
+    .Attr("strides: list(int)")
+    .Attr("use_cudnn_on_gpu: bool = true")
+    .Attr(GetPaddingAttrString())
+    .Attr(GetConvnetDataFormatAttrString())
+    .Attr("fused_ops: list(string) = []")
+    .Attr("epsilon: float = 0.0001")
+    .SetShapeFn(shape_inference::Conv2DShape)
+    .Doc(R"doc(
+Conv2D followed by the ops in `fused_ops`, applied to the output in place.
+
+`fused_ops` is a BiasAdd or an inference FusedBatchNorm, optionally followed
+by a Relu, Relu6 or Elu. `args` holds the bias, or the scale, offset, mean and
+variance of the batch normalization, whose variance_epsilon is `epsilon`.
+
+NOTE Do not invoke this operator directly in Python. The remapper graph
+rewrite pass is expected to create these operators.
+)doc");
+
 REGISTER_OP("Conv2DBackpropInput")
     .Input("input_sizes: int32")
     .Input("filter: T")
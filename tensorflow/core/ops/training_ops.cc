@@ -543,6 +543,7 @@ REGISTER_OP("SparseApplyAdagrad")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("hogwild: bool = false")
     .SetShapeFn([](InferenceContext* c) {
       return ApplyAdagradShapeFn(c, true /* sparse */);
     })
@@ -562,6 +563,9 @@ out: Same as "var".
 use_locking: If `True`, updating of the var and accum tensors will be protected
   by a lock; otherwise the behavior is undefined, but may exhibit less
   contention.
+hogwild: If `True`, the rows are updated by several threads without
+  synchronization, and the updates of duplicate indices may be lost.
+  Otherwise the result is the same as when updating the rows in order.
 )doc");
 
 REGISTER_OP("ResourceSparseApplyAdagrad")
@@ -573,6 +577,7 @@ REGISTER_OP("ResourceSparseApplyAdagrad")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("hogwild: bool = false")
     .SetShapeFn([](InferenceContext* c) {
       return ApplyAdagradShapeFn(c, true /* sparse */);
     })
@@ -591,6 +596,9 @@ indices: A vector of indices into the first dimension of var and accum.
 use_locking: If `True`, updating of the var and accum tensors will be protected
   by a lock; otherwise the behavior is undefined, but may exhibit less
   contention.
+hogwild: If `True`, the rows are updated by several threads without
+  synchronization, and the updates of duplicate indices may be lost.
+  Otherwise the result is the same as when updating the rows in order.
 )doc");
 
 static Status ApplyAdagradDAShapeFn(InferenceContext* c, bool sparse) {
@@ -879,6 +887,7 @@ REGISTER_OP("SparseApplyFtrl")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("hogwild: bool = false")
     .SetShapeFn([](InferenceContext* c) {
       return ApplyFtrlShapeFn(c, true /* sparse */);
     })
@@ -905,6 +914,9 @@ out: Same as "var".
 use_locking: If `True`, updating of the var and accum tensors will be protected
   by a lock; otherwise the behavior is undefined, but may exhibit less
   contention.
+hogwild: If `True`, the rows are updated by several threads without
+  synchronization, and the updates of duplicate indices may be lost.
+  Otherwise the result is the same as when updating the rows in order.
 )doc");
 
 REGISTER_OP("ResourceApplyFtrl")
@@ -956,6 +968,7 @@ REGISTER_OP("ResourceSparseApplyFtrl")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("hogwild: bool = false")
     .SetShapeFn([](InferenceContext* c) {
       return ApplyFtrlShapeFn(c, true /* sparse */);
     })
@@ -981,6 +994,9 @@ lr_power: Scaling factor. Must be a scalar.
 use_locking: If `True`, updating of the var and accum tensors will be protected
   by a lock; otherwise the behavior is undefined, but may exhibit less
   contention.
+hogwild: If `True`, the rows are updated by several threads without
+  synchronization, and the updates of duplicate indices may be lost.
+  Otherwise the result is the same as when updating the rows in order.
 )doc");
 
 static Status ApplyMomentumShapeFn(InferenceContext* c, bool sparse) {
@@ -1140,6 +1156,53 @@ var - lr * momentum * accum, so in the end, the var you get is actually
 var - lr * momentum * accum.
 )doc");
 
+static Status MultiApplyMomentumShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2 * n), 0, &unused));      // lr
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3 * n + 1), 0, &unused));  // momentum
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = c->input(i);                                     // var
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(n + i), &s));            // accum
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(2 * n + 1 + i), &s));    // grad
+    c->set_output(i, s);
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("MultiApplyMomentum")
+    .Input("var: Ref(N * T)")
+    .Input("accum: Ref(N * T)")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Output("out: Ref(N * T)")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(MultiApplyMomentumShapeFn)
+    .Doc(R"doc(
+Update each '*var[i]' according to the momentum scheme, like ApplyMomentum.
+
+Updating the variables in one op saves the overhead of running one op by
+variable, and the CPU kernel splits all the updates among its threads at once.
+
+var: Should be from Variables.
+accum: Should be from Variables, of the shapes of var.
+lr: Scaling factor. Must be a scalar.
+grad: The gradients of var.
+momentum: Momentum. Must be a scalar.
+out: Same as "var".
+use_locking: If `True`, updating of the var and accum tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, the tensor passed to compute grad will be
+var - lr * momentum * accum, so in the end, the var you get is actually
+var - lr * momentum * accum.
+)doc");
+
 static Status ApplyAdamShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
@@ -1243,6 +1306,64 @@ use_locking: If `True`, updating of the var, m, and v tensors will be protected
 use_nesterov: If `True`, uses the nesterov update.
 )doc");
 
+static Status MultiApplyAdamShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+  for (int i = 3 * n; i < 3 * n + 6; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = c->input(i);                                   // var
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(n + i), &s));          // m
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(2 * n + i), &s));      // v
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(3 * n + 6 + i), &s));  // grad
+    c->set_output(i, s);
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("MultiApplyAdam")
+    .Input("var: Ref(N * T)")
+    .Input("m: Ref(N * T)")
+    .Input("v: Ref(N * T)")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Output("out: Ref(N * T)")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(MultiApplyAdamShapeFn)
+    .Doc(R"doc(
+Update each '*var[i]' according to the Adam algorithm, like ApplyAdam.
+
+Updating the variables in one op saves the overhead of running one op by
+variable, and the CPU kernel splits all the updates among its threads at once.
+
+var: Should be from Variables.
+m: Should be from Variables, of the shapes of var.
+v: Should be from Variables, of the shapes of var.
+beta1_power: Must be a scalar.
+beta2_power: Must be a scalar.
+lr: Scaling factor. Must be a scalar.
+beta1: Momentum factor. Must be a scalar.
+beta2: Momentum factor. Must be a scalar.
+epsilon: Ridge term. Must be a scalar.
+grad: The gradients of var.
+out: Same as "var".
+use_locking: If `True`, updating of the var, m, and v tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, uses the nesterov update.
+)doc");
+
 static Status ApplyRMSPropShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
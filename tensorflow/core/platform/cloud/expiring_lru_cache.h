@@ -0,0 +1,125 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_EXPIRING_LRU_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_EXPIRING_LRU_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief An LRU cache of string keys to values that expire after a while.
+///
+/// The cache holds at most `max_entries` entries, and an entry is returned
+/// by lookups for `max_age` seconds after it was inserted. If `max_age` is 0,
+/// the cache is disabled and nothing is inserted.
+///
+/// This class is thread safe.
+template <typename T>
+class ExpiringLRUCache {
+ public:
+  ExpiringLRUCache(uint64 max_age, size_t max_entries,
+                   Env* env = Env::Default())
+      : max_age_(max_age), max_entries_(max_entries), env_(env) {}
+
+  /// Inserts `value` for `key`, replacing any previous value.
+  void Insert(const string& key, const T& value) {
+    if (max_age_ == 0 || max_entries_ == 0) {
+      return;
+    }
+    mutex_lock lock(mu_);
+    Delete_Locked(key);
+    lru_list_.push_front(key);
+    Entry entry{env_->NowSeconds(), value, lru_list_.begin()};
+    cache_.emplace(key, std::move(entry));
+    while (cache_.size() > max_entries_) {
+      Delete_Locked(lru_list_.back());
+    }
+  }
+
+  /// Looks up `key` and sets `value` if there is an entry that is not
+  /// expired. Returns whether there is one.
+  bool Lookup(const string& key, T* value) {
+    if (max_age_ == 0) {
+      return false;
+    }
+    mutex_lock lock(mu_);
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+      return false;
+    }
+    if (env_->NowSeconds() - it->second.timestamp > max_age_) {
+      Delete_Locked(key);
+      return false;
+    }
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_iterator);
+    *value = it->second.value;
+    return true;
+  }
+
+  /// Removes the entry of `key`, if any.
+  void Delete(const string& key) {
+    mutex_lock lock(mu_);
+    Delete_Locked(key);
+  }
+
+  /// Removes all the entries.
+  void Clear() {
+    mutex_lock lock(mu_);
+    cache_.clear();
+    lru_list_.clear();
+  }
+
+  uint64 max_age() const { return max_age_; }
+  size_t max_entries() const { return max_entries_; }
+
+ private:
+  struct Entry {
+    /// The time the entry was inserted, in seconds.
+    uint64 timestamp;
+    T value;
+    /// The position of the key in the LRU list.
+    std::list<string>::iterator lru_iterator;
+  };
+
+  void Delete_Locked(string key) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    // The key is copied since it may be an element of the LRU list.
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+      return;
+    }
+    lru_list_.erase(it->second.lru_iterator);
+    cache_.erase(it);
+  }
+
+  const uint64 max_age_;
+  const size_t max_entries_;
+  Env* const env_;
+
+  mutex mu_;
+  std::map<string, Entry> cache_ GUARDED_BY(mu_);
+  /// The keys of the entries, most recently used first.
+  std::list<string> lru_list_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_EXPIRING_LRU_CACHE_H_
@@ -0,0 +1,91 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/expiring_lru_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// An Env whose time is set by the test.
+class FakeEnv : public EnvWrapper {
+ public:
+  FakeEnv() : EnvWrapper(Env::Default()) {}
+
+  uint64 NowSeconds() override { return now_; }
+
+  uint64 now_ = 1;
+};
+
+TEST(ExpiringLRUCacheTest, MaxAge) {
+  FakeEnv env;
+  ExpiringLRUCache<int> cache(2, 10, &env);
+  int value = 0;
+  EXPECT_FALSE(cache.Lookup("a", &value));
+  cache.Insert("a", 1);
+  env.now_ += 1;
+  cache.Insert("b", 2);
+  env.now_ += 1;
+  EXPECT_TRUE(cache.Lookup("a", &value));
+  EXPECT_EQ(1, value);
+  // "a" expires, but not "b".
+  env.now_ += 1;
+  EXPECT_FALSE(cache.Lookup("a", &value));
+  EXPECT_TRUE(cache.Lookup("b", &value));
+  EXPECT_EQ(2, value);
+  // Inserting again refreshes the entry.
+  cache.Insert("a", 3);
+  env.now_ += 2;
+  EXPECT_TRUE(cache.Lookup("a", &value));
+  EXPECT_EQ(3, value);
+}
+
+TEST(ExpiringLRUCacheTest, MaxEntries) {
+  ExpiringLRUCache<int> cache(100, 2);
+  int value = 0;
+  cache.Insert("a", 1);
+  cache.Insert("b", 2);
+  // "a" becomes the most recently used, so "c" evicts "b".
+  EXPECT_TRUE(cache.Lookup("a", &value));
+  cache.Insert("c", 3);
+  EXPECT_TRUE(cache.Lookup("a", &value));
+  EXPECT_FALSE(cache.Lookup("b", &value));
+  EXPECT_TRUE(cache.Lookup("c", &value));
+  EXPECT_EQ(3, value);
+}
+
+TEST(ExpiringLRUCacheTest, Delete) {
+  ExpiringLRUCache<int> cache(100, 10);
+  int value = 0;
+  cache.Insert("a", 1);
+  cache.Insert("b", 2);
+  cache.Delete("a");
+  cache.Delete("c");
+  EXPECT_FALSE(cache.Lookup("a", &value));
+  EXPECT_TRUE(cache.Lookup("b", &value));
+  cache.Clear();
+  EXPECT_FALSE(cache.Lookup("b", &value));
+}
+
+TEST(ExpiringLRUCacheTest, Disabled) {
+  ExpiringLRUCache<int> cache(0, 10);
+  int value = 0;
+  cache.Insert("a", 1);
+  EXPECT_FALSE(cache.Lookup("a", &value));
+}
+
+}  // namespace
+}  // namespace tensorflow
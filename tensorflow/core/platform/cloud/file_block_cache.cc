@@ -0,0 +1,212 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include <algorithm>
+#include <cstring>
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The number of threads that fetch the blocks of a read in parallel.
+constexpr int kNumFetchThreads = 8;
+
+auto* block_cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/core/platform/cloud/block_cache_hits",
+    "The number of blocks read from the file block caches.");
+
+auto* block_cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/core/platform/cloud/block_cache_misses",
+    "The number of blocks fetched into the file block caches.");
+
+}  // namespace
+
+FileBlockCache::FileBlockCache(size_t block_size, uint64 max_bytes,
+                               uint64 max_staleness,
+                               BlockFetcher block_fetcher, Env* env)
+    : block_size_(block_size),
+      max_bytes_(max_bytes),
+      max_staleness_(max_staleness),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  CHECK_GT(block_size_, 0);
+  fetch_threads_.reset(
+      new thread::ThreadPool(env_, "file_block_cache", kNumFetchThreads));
+}
+
+Status FileBlockCache::Read(const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return Status::OK();
+  }
+  // Look up all the blocks of the read first, so that they are not evicted
+  // before they are copied to the buffer.
+  std::vector<Key> keys;
+  std::vector<std::shared_ptr<Block>> blocks;
+  for (size_t pos = offset - offset % block_size_; pos < offset + n;
+       pos += block_size_) {
+    keys.emplace_back(filename, pos);
+    blocks.push_back(Lookup(keys.back()));
+  }
+  std::vector<Status> statuses(blocks.size());
+  if (blocks.size() == 1) {
+    statuses[0] = MaybeFetch(keys[0], blocks[0]);
+  } else {
+    BlockingCounter counter(blocks.size() - 1);
+    for (size_t i = 1; i < blocks.size(); ++i) {
+      fetch_threads_->Schedule(
+          [this, i, &keys, &blocks, &statuses, &counter]() {
+            statuses[i] = MaybeFetch(keys[i], blocks[i]);
+            counter.DecrementCount();
+          });
+    }
+    statuses[0] = MaybeFetch(keys[0], blocks[0]);
+    counter.Wait();
+  }
+
+  size_t copied = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    const size_t pos = keys[i].second;
+    mutex_lock lock(blocks[i]->mu);
+    const std::vector<char>& data = blocks[i]->data;
+    const size_t begin = std::max(offset, pos) - pos;
+    const size_t end = std::min(offset + n - pos, data.size());
+    if (begin < end) {
+      std::memcpy(buffer + copied, data.data() + begin, end - begin);
+      copied += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block is the last one of the file.
+      break;
+    }
+  }
+  *bytes_transferred = copied;
+  return Status::OK();
+}
+
+std::shared_ptr<FileBlockCache::Block> FileBlockCache::Lookup(const Key& key) {
+  mutex_lock lock(mu_);
+  auto entry = block_map_.find(key);
+  if (entry != block_map_.end()) {
+    const std::shared_ptr<Block>& block = entry->second;
+    if (max_staleness_ == 0 || block->timestamp == 0 ||
+        env_->NowSeconds() - block->timestamp <= max_staleness_) {
+      lru_list_.splice(lru_list_.begin(), lru_list_, block->lru_iterator);
+      return block;
+    }
+    // The file may have changed since the block was fetched, so the other
+    // blocks of the file are stale too.
+    RemoveFile_Locked(key.first);
+  }
+  std::shared_ptr<Block> block = std::make_shared<Block>();
+  lru_list_.push_front(key);
+  block->lru_iterator = lru_list_.begin();
+  block_map_.emplace(key, block);
+  return block;
+}
+
+Status FileBlockCache::MaybeFetch(const Key& key,
+                                  const std::shared_ptr<Block>& block) {
+  mutex_lock block_lock(block->mu);
+  if (block->fetched) {
+    block_cache_hits->GetCell()->IncrementBy(1);
+    mutex_lock lock(mu_);
+    ++hits_;
+    return Status::OK();
+  }
+  // The block is fetched under its lock, so that other reads of the block
+  // wait for this fetch instead of fetching it again.
+  Status status = block_fetcher_(key.first, key.second, block_size_,
+                                 &block->data);
+  if (!status.ok()) {
+    block->data.clear();
+    // Drops the empty block, so that failed fetches do not accumulate in
+    // the cache. The reads waiting for the block fetch it again.
+    mutex_lock lock(mu_);
+    auto entry = block_map_.find(key);
+    if (entry != block_map_.end() && entry->second == block) {
+      RemoveBlock(entry);
+    }
+    return status;
+  }
+  block->fetched = true;
+  block_cache_misses->GetCell()->IncrementBy(1);
+
+  mutex_lock lock(mu_);
+  ++misses_;
+  block->timestamp = env_->NowSeconds();
+  auto entry = block_map_.find(key);
+  if (entry != block_map_.end() && entry->second == block) {
+    // The block was not evicted or removed while it was fetched.
+    block->size = block->data.size();
+    cache_size_ += block->size;
+    Trim();
+  }
+  return Status::OK();
+}
+
+void FileBlockCache::Trim() {
+  while (cache_size_ > max_bytes_ && !lru_list_.empty()) {
+    RemoveBlock(block_map_.find(lru_list_.back()));
+  }
+}
+
+void FileBlockCache::RemoveBlock(BlockMap::iterator entry) {
+  cache_size_ -= entry->second->size;
+  lru_list_.erase(entry->second->lru_iterator);
+  block_map_.erase(entry);
+}
+
+void FileBlockCache::RemoveFile(const string& filename) {
+  mutex_lock lock(mu_);
+  RemoveFile_Locked(filename);
+}
+
+void FileBlockCache::RemoveFile_Locked(const string& filename) {
+  auto entry = block_map_.lower_bound(Key(filename, 0));
+  while (entry != block_map_.end() && entry->first.first == filename) {
+    RemoveBlock(entry++);
+  }
+}
+
+void FileBlockCache::Flush() {
+  mutex_lock lock(mu_);
+  block_map_.clear();
+  lru_list_.clear();
+  cache_size_ = 0;
+}
+
+size_t FileBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+int64 FileBlockCache::hits() const {
+  mutex_lock lock(mu_);
+  return hits_;
+}
+
+int64 FileBlockCache::misses() const {
+  mutex_lock lock(mu_);
+  return misses_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,148 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief An LRU block cache of file contents, keyed by {filename, offset}.
+///
+/// The cache is meant to be shared by the read-only random access files of a
+/// remote filesystem, such as GCS. The contents of a file are fetched in
+/// blocks of `block_size` bytes by the block fetcher, and the blocks that a
+/// read needs and that are not in the cache are fetched in parallel. A block
+/// is fetched once even if it is read by several threads at the same time.
+///
+/// This class is thread safe.
+class FileBlockCache {
+ public:
+  /// The callback executed when a block is not found in the cache, and needs
+  /// to be fetched from the backing filesystem. This callback is provided
+  /// when the cache is constructed. The `out` buffer is filled with at most
+  /// `n` bytes of the file starting at `offset`, and fewer bytes only at the
+  /// end of the file. It may be called concurrently.
+  typedef std::function<Status(const string& filename, size_t offset,
+                               size_t n, std::vector<char>* out)>
+      BlockFetcher;
+
+  /// Blocks are evicted once the total size of the cache exceeds `max_bytes`.
+  /// If `max_staleness` is positive, the blocks of a file are discarded when
+  /// one is read more than `max_staleness` seconds after it was fetched.
+  FileBlockCache(size_t block_size, uint64 max_bytes, uint64 max_staleness,
+                 BlockFetcher block_fetcher, Env* env = Env::Default());
+
+  /// Reads `n` bytes from `filename` starting at `offset` into `buffer`, and
+  /// sets `bytes_transferred` to the number of bytes read, which is smaller
+  /// than `n` only at the end of the file.
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred);
+
+  /// Removes all the cached blocks of `filename`.
+  void RemoveFile(const string& filename) LOCKS_EXCLUDED(mu_);
+
+  /// Removes all the cached blocks.
+  void Flush() LOCKS_EXCLUDED(mu_);
+
+  size_t block_size() const { return block_size_; }
+  uint64 max_bytes() const { return max_bytes_; }
+  uint64 max_staleness() const { return max_staleness_; }
+
+  /// The total size of the cached blocks, in bytes.
+  size_t CacheSize() const LOCKS_EXCLUDED(mu_);
+
+  /// The number of blocks that reads found in the cache, and that were
+  /// fetched, since the cache was constructed.
+  int64 hits() const LOCKS_EXCLUDED(mu_);
+  int64 misses() const LOCKS_EXCLUDED(mu_);
+
+ private:
+  /// A block of a file, identified by the filename and the offset of the
+  /// block in the file.
+  typedef std::pair<string, size_t> Key;
+
+  /// A cached block. The block is fetched and read under its own mutex, so
+  /// that reads of other blocks are not blocked by the fetch. The mutex of a
+  /// block may be held when acquiring `mu_`, but not the other way around.
+  struct Block {
+    mutex mu;
+    /// Whether the block was fetched successfully.
+    bool fetched GUARDED_BY(mu) = false;
+    /// The contents of the block.
+    std::vector<char> data GUARDED_BY(mu);
+    /// The members below are guarded by `mu_` of the cache.
+    ///
+    /// The time the block was fetched in seconds, or 0 if it was not.
+    uint64 timestamp = 0;
+    /// The size of the block once fetched, as counted in `cache_size_`.
+    size_t size = 0;
+    /// The position of the block in the LRU list.
+    std::list<Key>::iterator lru_iterator;
+  };
+  typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
+
+  /// Returns the block for `key`, and adds an empty one to the cache if there
+  /// is none.
+  std::shared_ptr<Block> Lookup(const Key& key) LOCKS_EXCLUDED(mu_);
+
+  /// Fetches the block for `key` unless it was fetched already.
+  Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
+      LOCKS_EXCLUDED(mu_);
+
+  /// Evicts the least recently used blocks until the cache fits `max_bytes_`.
+  void Trim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Removes a block from the cache.
+  void RemoveBlock(BlockMap::iterator entry) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void RemoveFile_Locked(const string& filename) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const size_t block_size_;
+  const uint64 max_bytes_;
+  const uint64 max_staleness_;
+  const BlockFetcher block_fetcher_;
+  Env* const env_;
+
+  /// The threads that fetch the blocks of a read in parallel.
+  std::unique_ptr<thread::ThreadPool> fetch_threads_;
+
+  mutable mutex mu_;
+  /// The cached blocks, ordered by key so that the blocks of a file are
+  /// adjacent.
+  BlockMap block_map_ GUARDED_BY(mu_);
+  /// The keys of the cached blocks, most recently used first.
+  std::list<Key> lru_list_ GUARDED_BY(mu_);
+  /// The total size of the fetched blocks in the cache.
+  size_t cache_size_ GUARDED_BY(mu_) = 0;
+  int64 hits_ GUARDED_BY(mu_) = 0;
+  int64 misses_ GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
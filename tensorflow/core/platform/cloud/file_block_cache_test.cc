@@ -0,0 +1,222 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include <cstring>
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// The contents of every file: the byte at offset i is 'a' + i % 26, up to
+// kFileSize bytes.
+constexpr size_t kFileSize = 100;
+
+Status FetchFileContents(const string& filename, size_t offset, size_t n,
+                         std::vector<char>* out) {
+  out->clear();
+  for (size_t i = offset; i < std::min(offset + n, kFileSize); ++i) {
+    out->push_back('a' + i % 26);
+  }
+  return Status::OK();
+}
+
+string ExpectedContents(size_t offset, size_t n) {
+  string contents;
+  for (size_t i = offset; i < std::min(offset + n, kFileSize); ++i) {
+    contents.push_back('a' + i % 26);
+  }
+  return contents;
+}
+
+string ReadCache(FileBlockCache* cache, const string& filename, size_t offset,
+                 size_t n) {
+  std::vector<char> buffer(n);
+  size_t bytes_transferred;
+  TF_EXPECT_OK(
+      cache->Read(filename, offset, n, buffer.data(), &bytes_transferred));
+  return string(buffer.data(), bytes_transferred);
+}
+
+// An Env whose time is set by the test.
+class FakeEnv : public EnvWrapper {
+ public:
+  FakeEnv() : EnvWrapper(Env::Default()) {}
+
+  uint64 NowSeconds() override { return now_; }
+
+  uint64 now_ = 1;
+};
+
+TEST(FileBlockCacheTest, Read) {
+  int num_fetches = 0;
+  FileBlockCache cache(16, 1024, 0,
+                       [&num_fetches](const string& filename, size_t offset,
+                                      size_t n, std::vector<char>* out) {
+                         ++num_fetches;
+                         EXPECT_EQ(0, offset % 16);
+                         EXPECT_EQ(16, n);
+                         return FetchFileContents(filename, offset, n, out);
+                       });
+  // Reads within a block, across blocks, and past the end of the file.
+  EXPECT_EQ(ExpectedContents(3, 5), ReadCache(&cache, "a", 3, 5));
+  EXPECT_EQ(ExpectedContents(10, 30), ReadCache(&cache, "a", 10, 30));
+  EXPECT_EQ(ExpectedContents(90, 20), ReadCache(&cache, "a", 90, 20));
+  EXPECT_EQ("", ReadCache(&cache, "a", 100, 10));
+  EXPECT_EQ(ExpectedContents(0, 0), ReadCache(&cache, "a", 0, 0));
+  // Blocks 0, 1 and 2, then 5 and 6, then 6 again.
+  EXPECT_EQ(5, cache.misses());
+  EXPECT_EQ(2, cache.hits());
+  EXPECT_EQ(5, num_fetches);
+  EXPECT_EQ(68, cache.CacheSize());
+
+  // The cached blocks are read again without fetching them.
+  EXPECT_EQ(ExpectedContents(0, 100), ReadCache(&cache, "a", 0, 100));
+  EXPECT_EQ(7, num_fetches);
+  EXPECT_EQ(100, cache.CacheSize());
+}
+
+TEST(FileBlockCacheTest, Evict) {
+  std::vector<std::pair<string, size_t>> fetches;
+  FileBlockCache cache(
+      16, 32, 0, [&fetches](const string& filename, size_t offset, size_t n,
+                            std::vector<char>* out) {
+        fetches.emplace_back(filename, offset);
+        return FetchFileContents(filename, offset, n, out);
+      });
+  ReadCache(&cache, "a", 0, 1);
+  ReadCache(&cache, "b", 0, 1);
+  // Block 0 of "a" becomes the most recently used, so "c" evicts "b".
+  ReadCache(&cache, "a", 0, 1);
+  ReadCache(&cache, "c", 0, 1);
+  EXPECT_EQ(32, cache.CacheSize());
+  ReadCache(&cache, "a", 0, 1);
+  ReadCache(&cache, "b", 0, 1);
+  const std::vector<std::pair<string, size_t>> expected_fetches = {
+      {"a", 0}, {"b", 0}, {"c", 0}, {"b", 0}};
+  EXPECT_EQ(expected_fetches, fetches);
+}
+
+TEST(FileBlockCacheTest, RemoveFile) {
+  int num_fetches = 0;
+  FileBlockCache cache(16, 1024, 0,
+                       [&num_fetches](const string& filename, size_t offset,
+                                      size_t n, std::vector<char>* out) {
+                         ++num_fetches;
+                         return FetchFileContents(filename, offset, n, out);
+                       });
+  ReadCache(&cache, "a", 0, 20);
+  ReadCache(&cache, "b", 0, 20);
+  EXPECT_EQ(4, num_fetches);
+  cache.RemoveFile("a");
+  EXPECT_EQ(32, cache.CacheSize());
+  ReadCache(&cache, "a", 0, 20);
+  ReadCache(&cache, "b", 0, 20);
+  EXPECT_EQ(6, num_fetches);
+  cache.Flush();
+  EXPECT_EQ(0, cache.CacheSize());
+  ReadCache(&cache, "b", 0, 1);
+  EXPECT_EQ(7, num_fetches);
+}
+
+TEST(FileBlockCacheTest, MaxStaleness) {
+  FakeEnv env;
+  int num_fetches = 0;
+  FileBlockCache cache(16, 1024, 2,
+                       [&num_fetches](const string& filename, size_t offset,
+                                      size_t n, std::vector<char>* out) {
+                         ++num_fetches;
+                         return FetchFileContents(filename, offset, n, out);
+                       },
+                       &env);
+  ReadCache(&cache, "a", 0, 1);
+  env.now_ += 2;
+  ReadCache(&cache, "a", 16, 1);
+  ReadCache(&cache, "a", 0, 1);
+  EXPECT_EQ(2, num_fetches);
+  // Block 0 is stale: both blocks of the file are fetched again.
+  env.now_ += 1;
+  ReadCache(&cache, "a", 0, 1);
+  ReadCache(&cache, "a", 16, 1);
+  EXPECT_EQ(4, num_fetches);
+}
+
+TEST(FileBlockCacheTest, FetchError) {
+  bool fail = true;
+  FileBlockCache cache(16, 1024, 0,
+                       [&fail](const string& filename, size_t offset, size_t n,
+                               std::vector<char>* out) {
+                         if (fail) {
+                           return errors::Unavailable("Fetch failed.");
+                         }
+                         return FetchFileContents(filename, offset, n, out);
+                       });
+  char buffer[20];
+  size_t bytes_transferred;
+  EXPECT_EQ(error::UNAVAILABLE,
+            cache.Read("a", 0, 20, buffer, &bytes_transferred).code());
+  EXPECT_EQ(0, cache.CacheSize());
+  // The failed blocks are fetched again.
+  fail = false;
+  EXPECT_EQ(ExpectedContents(0, 20), ReadCache(&cache, "a", 0, 20));
+}
+
+TEST(FileBlockCacheTest, ParallelFetches) {
+  // Each fetch waits for the fetches of all the blocks of the read, which
+  // only completes if they are made in parallel.
+  BlockingCounter fetches(4);
+  FileBlockCache cache(16, 1024, 0,
+                       [&fetches](const string& filename, size_t offset,
+                                  size_t n, std::vector<char>* out) {
+                         fetches.DecrementCount();
+                         fetches.Wait();
+                         return FetchFileContents(filename, offset, n, out);
+                       });
+  EXPECT_EQ(ExpectedContents(0, 64), ReadCache(&cache, "a", 0, 64));
+}
+
+TEST(FileBlockCacheTest, ConcurrentReadsFetchOnce) {
+  int num_fetches = 0;
+  Notification fetch_started;
+  Notification finish_fetch;
+  FileBlockCache cache(16, 1024, 0,
+                       [&](const string& filename, size_t offset, size_t n,
+                           std::vector<char>* out) {
+                         ++num_fetches;
+                         fetch_started.Notify();
+                         finish_fetch.WaitForNotification();
+                         return FetchFileContents(filename, offset, n, out);
+                       });
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "reader", [&cache]() {
+        EXPECT_EQ(ExpectedContents(0, 8), ReadCache(&cache, "a", 0, 8));
+      }));
+  fetch_started.WaitForNotification();
+  std::unique_ptr<Thread> other_thread(
+      Env::Default()->StartThread(ThreadOptions(), "other_reader", [&cache]() {
+        EXPECT_EQ(ExpectedContents(8, 8), ReadCache(&cache, "a", 8, 8));
+      }));
+  finish_fetch.Notify();
+  thread.reset();
+  other_thread.reset();
+  EXPECT_EQ(1, num_fetches);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -27,12 +27,14 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
 #include "tensorflow/core/platform/cloud/retrying_utils.h"
 #include "tensorflow/core/platform/cloud/time_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -54,10 +56,76 @@ constexpr uint64 kUploadRetryDelayMicros = 1000000L;
 constexpr uint64 HTTP_CODE_RESUME_INCOMPLETE = 308;
 // The environment variable that overrides the size of the readahead buffer.
 constexpr char kReadaheadBufferSize[] = "GCS_READAHEAD_BUFFER_SIZE_BYTES";
+// The environment variables that override the block size and the maximum size
+// of the block cache, in megabytes. The readahead buffers are used instead of
+// the cache if its maximum size is 0.
+constexpr char kBlockSize[] = "GCS_READ_CACHE_BLOCK_SIZE_MB";
+constexpr uint64 kDefaultBlockSize = 16 * 1024 * 1024;
+constexpr char kMaxCacheSize[] = "GCS_READ_CACHE_MAX_SIZE_MB";
+constexpr uint64 kDefaultMaxCacheSize = 256 * 1024 * 1024;
+// The environment variable that overrides the maximum staleness of the cached
+// blocks, in seconds.
+constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
+constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variables that override the maximum age, in seconds, and
+// the maximum number of entries of the stat cache.
+constexpr char kStatCacheMaxAge[] = "GCS_STAT_CACHE_MAX_AGE";
+constexpr uint64 kStatCacheDefaultMaxAge = 5;
+constexpr char kStatCacheMaxEntries[] = "GCS_STAT_CACHE_MAX_ENTRIES";
+constexpr uint64 kStatCacheDefaultMaxEntries = 1024;
+// The environment variables that override the minimum size of the files
+// uploaded as composite objects, and the size of their components, in
+// megabytes. Composite uploads are disabled if the minimum size is 0, which
+// is the default: the temporary components are billed as objects, and a
+// composite object has no MD5 hash for the clients to check.
+constexpr char kCompositeUploadThreshold[] =
+    "GCS_COMPOSITE_UPLOAD_THRESHOLD_MB";
+constexpr uint64 kDefaultCompositeUploadThreshold = 0;
+constexpr char kCompositeUploadChunkSize[] =
+    "GCS_COMPOSITE_UPLOAD_CHUNK_SIZE_MB";
+constexpr uint64 kDefaultCompositeUploadChunkSize = 32 * 1024 * 1024;
+// The number of threads that upload the components of composite uploads.
+constexpr int kNumUploadThreads = 8;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
+// The maximum number of components of a GCS composite object.
+constexpr size_t kMaxComposeComponents = 1024;
+// The components of a composite upload double in size every
+// kComponentsPerChunkSize components, so that the files of up to
+// 2^16 - 1 times that many chunks stay within kMaxComposeComponents.
+constexpr size_t kComponentsPerChunkSize = kMaxComposeComponents / 16;
+// The prefix of the temporary objects of the composite uploads in the bucket.
+// The objects under it are not listed by GetChildren() and the like.
+constexpr char kCompositeUploadPrefix[] = ".tf_composite_uploads/";
+
+// Returns true if `name` is a temporary object of a composite upload, or its
+// folder, and is not to be listed under `object_prefix`.
+bool IsHiddenObject(const string& name, const string& object_prefix) {
+  return StringPiece(name).starts_with(kCompositeUploadPrefix) &&
+         !StringPiece(object_prefix).starts_with(kCompositeUploadPrefix);
+}
 
 // The file statistics returned by Stat() for directories.
 const FileStatistics DIRECTORY_STAT(0, 0, true);
 
+// Sets `value` to the value of the environment variable `name` if it is set
+// to a number, and otherwise leaves it unchanged. Like the readahead buffer
+// size, the caches are configured by environment variables because the
+// filesystem is created by the registry, which no session options reach.
+void GetEnvVar(const char* name, uint64* value) {
+  const char* env_value = std::getenv(name);
+  if (env_value == nullptr) {
+    return;
+  }
+  uint64 parsed_value;
+  if (!strings::safe_strtou64(env_value, &parsed_value)) {
+    LOG(WARNING) << "Ignoring " << name << "=" << env_value
+                 << ", which is not a non-negative integer.";
+    return;
+  }
+  *value = parsed_value;
+}
+
 Status GetTmpFilename(string* filename) {
   if (!filename) {
     return errors::Internal("'filename' cannot be nullptr.");
@@ -300,22 +368,74 @@ class GcsRandomAccessFile : public RandomAccessFile {
   mutable size_t buffer_start_offset_ GUARDED_BY(mu_) = 0;
 };
 
+/// A GCS-based implementation of a random access file that reads through the
+/// block cache shared by the files of the filesystem.
+class GcsCachedRandomAccessFile : public RandomAccessFile {
+ public:
+  GcsCachedRandomAccessFile(const string& filename,
+                            FileBlockCache* file_block_cache)
+      : filename_(filename), file_block_cache_(file_block_cache) {}
+
+  /// Thread-safe.
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(file_block_cache_->Read(filename_, offset, n, scratch,
+                                               &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      // This is not an error per se. The RandomAccessFile interface expects
+      // that Read returns OutOfRange if fewer bytes were read than requested.
+      return errors::OutOfRange("EOF reached, ", bytes_transferred,
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
+    return Status::OK();
+  }
+
+ private:
+  string filename_;
+  FileBlockCache* file_block_cache_;
+};
+
+/// The options of the parallel composite uploads of GcsWritableFile.
+struct CompositeUploadOptions {
+  /// The minimum size of the files uploaded as composite objects, or 0 if
+  /// composite uploads are disabled.
+  uint64 threshold = 0;
+  /// The size of the components.
+  uint64 chunk_size = 0;
+  /// The threads that upload the components.
+  thread::ThreadPool* threads = nullptr;
+};
+
 /// \brief GCS-based implementation of a writeable file.
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
 /// tmp file and copies it to GCS on flush/close.
+///
+/// With composite uploads, once the file reaches the threshold size, every
+/// chunk of the file is uploaded as a temporary component object as soon as
+/// it is written, in parallel with the other chunks and with the writes. On
+/// flush/close, the rest of the file is uploaded and the components are
+/// composed into the object by GCS. The components are deleted on close.
+/// They are named under kCompositeUploadPrefix, which the listings skip.
 class GcsWritableFile : public WritableFile {
  public:
   GcsWritableFile(const string& bucket, const string& object,
                   AuthProvider* auth_provider,
                   HttpRequest::Factory* http_request_factory,
-                  int64 initial_retry_delay_usec)
+                  int64 initial_retry_delay_usec,
+                  std::function<void()> file_cache_erase,
+                  const CompositeUploadOptions& composite_upload)
       : bucket_(bucket),
         object_(object),
         auth_provider_(auth_provider),
         http_request_factory_(http_request_factory),
         sync_needed_(true),
-        initial_retry_delay_usec_(initial_retry_delay_usec) {
+        initial_retry_delay_usec_(initial_retry_delay_usec),
+        file_cache_erase_(std::move(file_cache_erase)),
+        composite_upload_(composite_upload) {
     if (GetTmpFilename(&tmp_content_filename_).ok()) {
       outfile_.open(tmp_content_filename_,
                     std::ofstream::binary | std::ofstream::app);
@@ -331,19 +451,28 @@ class GcsWritableFile : public WritableFile {
                   AuthProvider* auth_provider,
                   const string& tmp_content_filename,
                   HttpRequest::Factory* http_request_factory,
-                  int64 initial_retry_delay_usec)
+                  int64 initial_retry_delay_usec,
+                  std::function<void()> file_cache_erase,
+                  const CompositeUploadOptions& composite_upload)
       : bucket_(bucket),
         object_(object),
         auth_provider_(auth_provider),
         http_request_factory_(http_request_factory),
         sync_needed_(true),
-        initial_retry_delay_usec_(initial_retry_delay_usec) {
+        initial_retry_delay_usec_(initial_retry_delay_usec),
+        file_cache_erase_(std::move(file_cache_erase)),
+        composite_upload_(composite_upload) {
     tmp_content_filename_ = tmp_content_filename;
     outfile_.open(tmp_content_filename_,
                   std::ofstream::binary | std::ofstream::app);
   }
 
-  ~GcsWritableFile() override { Close().IgnoreError(); }
+  ~GcsWritableFile() override {
+    Close().IgnoreError();
+    // Close() deletes the components unless it fails.
+    WaitForComponentUploads();
+    DeleteComponents();
+  }
 
   Status Append(const StringPiece& data) override {
     TF_RETURN_IF_ERROR(CheckWritable());
@@ -353,7 +482,7 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
-    return Status::OK();
+    return ScheduleComponentUploads(false /* final */);
   }
 
   Status Close() override {
@@ -361,6 +490,7 @@ class GcsWritableFile : public WritableFile {
       TF_RETURN_IF_ERROR(Sync());
       outfile_.close();
       std::remove(tmp_content_filename_.c_str());
+      DeleteComponents();
     }
     return Status::OK();
   }
@@ -373,6 +503,8 @@ class GcsWritableFile : public WritableFile {
       return Status::OK();
     }
     Status status = SyncImpl();
+    // The object may have been replaced even if the upload failed.
+    file_cache_erase_();
     if (status.ok()) {
       sync_needed_ = false;
     }
@@ -392,6 +524,13 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    if (composite_upload_.threshold > 0) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+      if (file_size >= composite_upload_.threshold || HasComponents()) {
+        return ComposeUpload();
+      }
+    }
     string session_uri;
     TF_RETURN_IF_ERROR(CreateNewUploadSession(&session_uri));
     uint64 already_uploaded = 0;
@@ -558,6 +697,286 @@ class GcsWritableFile : public WritableFile {
     return Status::OK();
   }
 
+  /// A component of a composite upload: a temporary object with the bytes
+  /// [offset, offset + size) of the file.
+  struct Component {
+    string object;
+    uint64 offset;
+    uint64 size;
+    bool uploading = false;
+    bool uploaded = false;
+    Status status;
+  };
+
+  /// \brief Schedules the uploads of the parts of the file that have no
+  /// component yet.
+  ///
+  /// The complete chunks are scheduled once the file reaches the threshold
+  /// size, and the rest of the file too if `final` is true. The last
+  /// component allowed by GCS is only scheduled when `final` is true, and
+  /// then has the rest of the file.
+  Status ScheduleComponentUploads(bool final) {
+    if (composite_upload_.threshold == 0) {
+      return Status::OK();
+    }
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    if (!final && file_size < composite_upload_.threshold) {
+      return Status::OK();
+    }
+    mutex_lock lock(mu_);
+    if (!HasChunkToUpload(file_size, final)) {
+      return Status::OK();
+    }
+    // The components are read from the temporary file by the upload threads.
+    outfile_.flush();
+    if (!outfile_.good()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    if (upload_id_.empty()) {
+      upload_id_ = strings::StrCat(strings::Hex(random::New64()));
+    }
+    while (HasChunkToUpload(file_size, final)) {
+      Component component;
+      component.object = TemporaryObject(strings::StrCat(components_.size()));
+      component.offset = components_end_;
+      component.size = components_.size() + 1 < kMaxComposeComponents
+                           ? std::min(NextChunkSize(),
+                                      file_size - components_end_)
+                           : file_size - components_end_;
+      components_end_ += component.size;
+      components_.push_back(component);
+      ScheduleComponentUpload(components_.size() - 1);
+    }
+    return Status::OK();
+  }
+
+  /// Returns the size of the next component of the file, if not the last.
+  uint64 NextChunkSize() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return composite_upload_.chunk_size
+           << (components_.size() / kComponentsPerChunkSize);
+  }
+
+  /// Returns true if the file of size `file_size` has a part that is to be
+  /// uploaded as a new component.
+  bool HasChunkToUpload(uint64 file_size, bool final)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (components_end_ >= file_size) return false;
+    if (final) return true;
+    return components_.size() + 1 < kMaxComposeComponents &&
+           file_size - components_end_ >= NextChunkSize();
+  }
+
+  /// Returns the name of the temporary object `name` of the upload of the
+  /// file, which is hidden from the listings of the bucket.
+  string TemporaryObject(const string& name) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return strings::StrCat(kCompositeUploadPrefix, object_, ".", upload_id_,
+                           "/", name);
+  }
+
+  /// Schedules the upload of a component that is not uploaded or uploading.
+  void ScheduleComponentUpload(size_t index) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Component* component = &components_[index];
+    component->uploading = true;
+    const string object = component->object;
+    const uint64 offset = component->offset;
+    const uint64 size = component->size;
+    composite_upload_.threads->Schedule([this, index, object, offset, size]() {
+      const Status status = UploadComponent(object, offset, size);
+      mutex_lock lock(mu_);
+      components_[index].uploading = false;
+      components_[index].uploaded = status.ok();
+      components_[index].status = status;
+      uploads_done_.notify_all();
+    });
+  }
+
+  /// Uploads the bytes [offset, offset + size) of the file to `object`.
+  Status UploadComponent(const string& object, uint64 offset, uint64 size) {
+    std::vector<char> buffer(size);
+    std::ifstream infile(tmp_content_filename_, std::ifstream::binary);
+    infile.seekg(offset);
+    infile.read(buffer.data(), size);
+    if (!infile.good()) {
+      return errors::Internal(
+          "Could not read from the internal temporary file.");
+    }
+    return RetryingUtils::CallWithRetries(
+        [&object, &buffer, this]() {
+          string auth_token;
+          TF_RETURN_IF_ERROR(
+              AuthProvider::GetToken(auth_provider_, &auth_token));
+
+          std::vector<char> output_buffer;
+          std::unique_ptr<HttpRequest> request(
+              http_request_factory_->Create());
+          TF_RETURN_IF_ERROR(request->Init());
+          TF_RETURN_IF_ERROR(request->SetUri(strings::StrCat(
+              kGcsUploadUriBase, "b/", bucket_, "/o?uploadType=media&name=",
+              request->EscapeString(object))));
+          TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+          TF_RETURN_IF_ERROR(
+              request->SetPostFromBuffer(buffer.data(), buffer.size()));
+          TF_RETURN_IF_ERROR(request->SetResultBuffer(&output_buffer));
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                          "gs://", bucket_, "/", object);
+          return Status::OK();
+        },
+        initial_retry_delay_usec_);
+  }
+
+  /// Uploads the components of the file that are not uploaded yet, and
+  /// composes the object from all the components.
+  Status ComposeUpload() {
+    TF_RETURN_IF_ERROR(ScheduleComponentUploads(true /* final */));
+    std::vector<string> sources;
+    {
+      mutex_lock lock(mu_);
+      // Upload again the components whose upload failed in a previous
+      // attempt.
+      for (size_t i = 0; i < components_.size(); ++i) {
+        if (!components_[i].uploaded && !components_[i].uploading) {
+          ScheduleComponentUpload(i);
+        }
+      }
+      WaitForComponentUploads_Locked(&lock);
+      for (const Component& component : components_) {
+        TF_RETURN_IF_ERROR(component.status);
+        sources.push_back(component.object);
+      }
+    }
+
+    // A compose request has a limited number of sources, so the components
+    // are composed in order into an intermediate object, kMaxComposeSources
+    // at a time, each intermediate object being the first source of the next.
+    string composed;
+    size_t next = 0;
+    for (int i = 0;; ++i) {
+      const size_t num_sources =
+          (composed.empty() ? 0 : 1) + sources.size() - next;
+      if (num_sources <= kMaxComposeSources) break;
+      std::vector<string> group;
+      if (!composed.empty()) group.push_back(composed);
+      while (group.size() < kMaxComposeSources) {
+        group.push_back(sources[next++]);
+      }
+      string intermediate;
+      {
+        mutex_lock lock(mu_);
+        intermediate = TemporaryObject(strings::StrCat("composed-", i));
+      }
+      const Status status = ComposeObject(group, intermediate);
+      if (!composed.empty()) DeleteObject(composed);
+      if (!status.ok()) return status;
+      composed = intermediate;
+    }
+    std::vector<string> group;
+    if (!composed.empty()) group.push_back(composed);
+    group.insert(group.end(), sources.begin() + next, sources.end());
+    const Status status = ComposeObject(group, object_);
+    if (!composed.empty()) DeleteObject(composed);
+    return status;
+  }
+
+  /// Composes `sources` into `destination`.
+  Status ComposeObject(const std::vector<string>& sources,
+                       const string& destination) {
+    Json::Value request_body;
+    for (const string& source : sources) {
+      Json::Value source_object;
+      source_object["name"] = source;
+      request_body["sourceObjects"].append(source_object);
+    }
+    request_body["destination"]["contentType"] = "application/octet-stream";
+    const string body = Json::FastWriter().write(request_body);
+    return RetryingUtils::CallWithRetries(
+        [&destination, &body, this]() {
+          string auth_token;
+          TF_RETURN_IF_ERROR(
+              AuthProvider::GetToken(auth_provider_, &auth_token));
+
+          std::vector<char> output_buffer;
+          std::unique_ptr<HttpRequest> request(
+              http_request_factory_->Create());
+          TF_RETURN_IF_ERROR(request->Init());
+          TF_RETURN_IF_ERROR(request->SetUri(
+              strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                              request->EscapeString(destination), "/compose")));
+          TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+          TF_RETURN_IF_ERROR(
+              request->AddHeader("Content-Type", "application/json"));
+          TF_RETURN_IF_ERROR(
+              request->SetPostFromBuffer(body.data(), body.size()));
+          TF_RETURN_IF_ERROR(request->SetResultBuffer(&output_buffer));
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                          "gs://", bucket_, "/", destination);
+          return Status::OK();
+        },
+        initial_retry_delay_usec_);
+  }
+
+  /// Deletes a temporary object, logging failures.
+  void DeleteObject(const string& object) {
+    const Status status = RetryingUtils::DeleteWithRetries(
+        [&object, this]() {
+          string auth_token;
+          TF_RETURN_IF_ERROR(
+              AuthProvider::GetToken(auth_provider_, &auth_token));
+          std::unique_ptr<HttpRequest> request(
+              http_request_factory_->Create());
+          TF_RETURN_IF_ERROR(request->Init());
+          TF_RETURN_IF_ERROR(request->SetUri(
+              strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                              request->EscapeString(object))));
+          TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+          TF_RETURN_IF_ERROR(request->SetDeleteRequest());
+          return request->Send();
+        },
+        initial_retry_delay_usec_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Could not delete the temporary object gs://" << bucket_
+                   << "/" << object << ": " << status;
+    }
+  }
+
+  bool HasComponents() {
+    mutex_lock lock(mu_);
+    return !components_.empty();
+  }
+
+  void WaitForComponentUploads() {
+    mutex_lock lock(mu_);
+    WaitForComponentUploads_Locked(&lock);
+  }
+
+  void WaitForComponentUploads_Locked(mutex_lock* lock)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (size_t i = 0; i < components_.size(); ++i) {
+      while (components_[i].uploading) {
+        uploads_done_.wait(*lock);
+      }
+    }
+  }
+
+  /// Deletes the uploaded components.
+  void DeleteComponents() {
+    std::vector<string> objects;
+    {
+      mutex_lock lock(mu_);
+      for (const Component& component : components_) {
+        if (component.uploaded) {
+          objects.push_back(component.object);
+        }
+      }
+      components_.clear();
+      components_end_ = 0;
+    }
+    for (const string& object : objects) {
+      DeleteObject(object);
+    }
+  }
+
   string GetGcsPath() const {
     return strings::StrCat("gs://", bucket_, "/", object_);
   }
@@ -570,6 +989,19 @@ class GcsWritableFile : public WritableFile {
   HttpRequest::Factory* http_request_factory_;
   bool sync_needed_;  // whether there is buffered data that needs to be synced
   int64 initial_retry_delay_usec_;
+  // Removes the object from the caches of the filesystem once it is uploaded.
+  std::function<void()> file_cache_erase_;
+
+  const CompositeUploadOptions composite_upload_;
+  mutex mu_;
+  // Notified when the upload of a component completes.
+  condition_variable uploads_done_;
+  // The components of the file, in the order of their offsets.
+  std::vector<Component> components_ GUARDED_BY(mu_);
+  // The end of the last component in the file.
+  uint64 components_end_ GUARDED_BY(mu_) = 0;
+  // A random identifier of the names of the components.
+  string upload_id_ GUARDED_BY(mu_);
 };
 
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
@@ -589,13 +1021,42 @@ GcsFileSystem::GcsFileSystem()
     : auth_provider_(new GoogleAuthProvider()),
       http_request_factory_(new HttpRequest::Factory()) {
   // Apply the sys env override for the readahead buffer size if it's provided.
-  const char* readahead_buffer_size = std::getenv(kReadaheadBufferSize);
-  if (readahead_buffer_size) {
-    uint64 value;
-    if (strings::safe_strtou64(readahead_buffer_size, &value)) {
-      read_ahead_bytes_ = value;
-    }
+  uint64 value = read_ahead_bytes_;
+  GetEnvVar(kReadaheadBufferSize, &value);
+  read_ahead_bytes_ = value;
+
+  // Apply the overrides for the caches.
+  uint64 block_size = kDefaultBlockSize;
+  value = 0;
+  GetEnvVar(kBlockSize, &value);
+  if (value > 0) {
+    block_size = value * 1024 * 1024;
+  }
+  uint64 max_bytes = kDefaultMaxCacheSize;
+  value = max_bytes / (1024 * 1024);
+  GetEnvVar(kMaxCacheSize, &value);
+  max_bytes = value * 1024 * 1024;
+  uint64 max_staleness = kDefaultMaxStaleness;
+  GetEnvVar(kMaxStaleness, &max_staleness);
+  uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
+  GetEnvVar(kStatCacheMaxAge, &stat_cache_max_age);
+  uint64 stat_cache_max_entries = kStatCacheDefaultMaxEntries;
+  GetEnvVar(kStatCacheMaxEntries, &stat_cache_max_entries);
+  InitCaches(block_size, max_bytes, max_staleness, stat_cache_max_age,
+             stat_cache_max_entries);
+
+  // Apply the overrides for the composite uploads.
+  uint64 threshold = kDefaultCompositeUploadThreshold;
+  value = threshold / (1024 * 1024);
+  GetEnvVar(kCompositeUploadThreshold, &value);
+  threshold = value * 1024 * 1024;
+  uint64 chunk_size = kDefaultCompositeUploadChunkSize;
+  value = 0;
+  GetEnvVar(kCompositeUploadChunkSize, &value);
+  if (value > 0) {
+    chunk_size = value * 1024 * 1024;
   }
+  InitCompositeUploads(threshold, chunk_size);
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -605,12 +1066,92 @@ GcsFileSystem::GcsFileSystem(
     : auth_provider_(std::move(auth_provider)),
       http_request_factory_(std::move(http_request_factory)),
       read_ahead_bytes_(read_ahead_bytes),
-      initial_retry_delay_usec_(initial_retry_delay_usec) {}
+      initial_retry_delay_usec_(initial_retry_delay_usec) {
+  InitCaches(read_ahead_bytes, 0, 0, 0, 0);
+}
+
+GcsFileSystem::GcsFileSystem(
+    std::unique_ptr<AuthProvider> auth_provider,
+    std::unique_ptr<HttpRequest::Factory> http_request_factory,
+    size_t block_size, uint64 max_bytes, uint64 max_staleness,
+    uint64 stat_cache_max_age, size_t stat_cache_max_entries,
+    uint64 composite_upload_threshold, size_t composite_upload_chunk_size,
+    int64 initial_retry_delay_usec)
+    : auth_provider_(std::move(auth_provider)),
+      http_request_factory_(std::move(http_request_factory)),
+      read_ahead_bytes_(block_size),
+      initial_retry_delay_usec_(initial_retry_delay_usec) {
+  InitCaches(block_size, max_bytes, max_staleness, stat_cache_max_age,
+             stat_cache_max_entries);
+  InitCompositeUploads(composite_upload_threshold, composite_upload_chunk_size);
+}
+
+void GcsFileSystem::InitCaches(size_t block_size, uint64 max_bytes,
+                               uint64 max_staleness, uint64 stat_cache_max_age,
+                               size_t stat_cache_max_entries) {
+  if (block_size > 0 && max_bytes > 0) {
+    file_block_cache_.reset(new FileBlockCache(
+        block_size, max_bytes, max_staleness,
+        [this](const string& filename, size_t offset, size_t n,
+               std::vector<char>* out) {
+          return LoadBufferFromGCS(filename, offset, n, out);
+        }));
+  }
+  stat_cache_.reset(new ExpiringLRUCache<FileStatistics>(
+      stat_cache_max_age, stat_cache_max_entries));
+}
+
+void GcsFileSystem::InitCompositeUploads(uint64 threshold,
+                                         size_t chunk_size) {
+  if (threshold > 0 && chunk_size > 0) {
+    composite_upload_threshold_ = threshold;
+    composite_upload_chunk_size_ = chunk_size;
+    upload_threads_.reset(new thread::ThreadPool(
+        Env::Default(), "gcs_composite_upload", kNumUploadThreads));
+  }
+}
+
+Status GcsFileSystem::LoadBufferFromGCS(const string& filename, size_t offset,
+                                        size_t n, std::vector<char>* out) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseGcsPath(filename, false, &bucket, &object));
+
+  string auth_token;
+  TF_RETURN_IF_ERROR(AuthProvider::GetToken(auth_provider_.get(), &auth_token));
+
+  std::unique_ptr<HttpRequest> request(http_request_factory_->Create());
+  TF_RETURN_IF_ERROR(request->Init());
+  TF_RETURN_IF_ERROR(
+      request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket,
+                                      "/", request->EscapeString(object))));
+  TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+  TF_RETURN_IF_ERROR(request->SetRange(offset, offset + n - 1));
+  out->reserve(n);
+  TF_RETURN_IF_ERROR(request->SetResultBuffer(out));
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when reading ", filename);
+  return Status::OK();
+}
+
+void GcsFileSystem::ClearFileCaches(const string& filename) {
+  if (file_block_cache_) {
+    file_block_cache_->RemoveFile(filename);
+  }
+  stat_cache_->Delete(filename);
+}
 
 Status GcsFileSystem::NewRandomAccessFile(
     const string& fname, std::unique_ptr<RandomAccessFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  if (file_block_cache_) {
+    if (file_block_cache_->max_staleness() == 0) {
+      // The file may have changed since its blocks were cached.
+      file_block_cache_->RemoveFile(fname);
+    }
+    result->reset(
+        new GcsCachedRandomAccessFile(fname, file_block_cache_.get()));
+    return Status::OK();
+  }
   result->reset(new GcsRandomAccessFile(bucket, object, auth_provider_.get(),
                                         http_request_factory_.get(),
                                         read_ahead_bytes_));
@@ -621,9 +1162,14 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
                                       std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
-  result->reset(new GcsWritableFile(bucket, object, auth_provider_.get(),
-                                    http_request_factory_.get(),
-                                    initial_retry_delay_usec_));
+  CompositeUploadOptions composite_upload;
+  composite_upload.threshold = composite_upload_threshold_;
+  composite_upload.chunk_size = composite_upload_chunk_size_;
+  composite_upload.threads = upload_threads_.get();
+  result->reset(new GcsWritableFile(
+      bucket, object, auth_provider_.get(), http_request_factory_.get(),
+      initial_retry_delay_usec_, [this, fname]() { ClearFileCaches(fname); },
+      composite_upload));
   return Status::OK();
 }
 
@@ -661,9 +1207,14 @@ Status GcsFileSystem::NewAppendableFile(const string& fname,
   // Create a writable file and pass the old content to it.
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  CompositeUploadOptions composite_upload;
+  composite_upload.threshold = composite_upload_threshold_;
+  composite_upload.chunk_size = composite_upload_chunk_size_;
+  composite_upload.threads = upload_threads_.get();
   result->reset(new GcsWritableFile(
       bucket, object, auth_provider_.get(), old_content_filename,
-      http_request_factory_.get(), initial_retry_delay_usec_));
+      http_request_factory_.get(), initial_retry_delay_usec_,
+      [this, fname]() { ClearFileCaches(fname); }, composite_upload));
   return Status::OK();
 }
 
@@ -732,6 +1283,10 @@ Status GcsFileSystem::StatForObject(const string& bucket, const string& object,
   if (object.empty()) {
     return errors::InvalidArgument("'object' must be a non-empty string.");
   }
+  const string fname = strings::StrCat("gs://", bucket, "/", object);
+  if (stat_cache_->Lookup(fname, stat)) {
+    return Status::OK();
+  }
 
   string auth_token;
   TF_RETURN_IF_ERROR(AuthProvider::GetToken(auth_provider_.get(), &auth_token));
@@ -762,6 +1317,7 @@ Status GcsFileSystem::StatForObject(const string& bucket, const string& object,
 
   stat->is_directory = false;
 
+  stat_cache_->Insert(fname, *stat);
   return Status::OK();
 }
 
@@ -903,6 +1459,9 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
         }
         string name;
         TF_RETURN_IF_ERROR(GetStringValue(item, "name", &name));
+        if (IsHiddenObject(name, object_prefix)) {
+          continue;
+        }
         // The names should be relative to the 'dirname'. That means the
         // 'object_prefix', which is part of 'dirname', should be removed from
         // the beginning of 'name'.
@@ -935,6 +1494,9 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
               "response.");
         }
         const string& prefix_str = prefix.asString();
+        if (IsHiddenObject(prefix_str, object_prefix)) {
+          continue;
+        }
         StringPiece relative_path(prefix_str);
         if (!relative_path.Consume(object_prefix)) {
           return errors::Internal(
@@ -1004,7 +1566,10 @@ Status GcsFileSystem::DeleteFile(const string& fname) {
       kGcsUriBase, "b/", bucket, "/o/", request->EscapeString(object))));
   TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
   TF_RETURN_IF_ERROR(request->SetDeleteRequest());
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when deleting ", fname);
+  const Status status = request->Send();
+  // The object may have been deleted even if the request failed.
+  ClearFileCaches(fname);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(status, " when deleting ", fname);
   return Status::OK();
 }
 
@@ -1098,8 +1663,11 @@ Status GcsFileSystem::RenameObject(const string& src, const string& target) {
   TF_RETURN_IF_ERROR(request->SetPostEmptyBody());
   std::vector<char> output_buffer;
   TF_RETURN_IF_ERROR(request->SetResultBuffer(&output_buffer));
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when renaming ", src,
-                                  " to ", target);
+  const Status status = request->Send();
+  // The target may have been replaced even if the request failed.
+  ClearFileCaches(target);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(status, " when renaming ", src, " to ",
+                                  target);
 
   Json::Value root;
   StringPiece response_piece =
@@ -19,7 +19,10 @@ limitations under the License.
 #include <string>
 #include <vector>
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/auth_provider.h"
+#include "tensorflow/core/platform/cloud/expiring_lru_cache.h"
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/http_request.h"
 #include "tensorflow/core/platform/cloud/retrying_file_system.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -36,6 +39,36 @@ class GcsFileSystem : public FileSystem {
   GcsFileSystem(std::unique_ptr<AuthProvider> auth_provider,
                 std::unique_ptr<HttpRequest::Factory> http_request_factory,
                 size_t read_ahead_bytes, int64 initial_retry_delay_usec);
+  /// \brief Constructs a filesystem reading through caches.
+  ///
+  /// The random access files read through a block cache of at most
+  /// `max_bytes` bytes shared by all the files, in blocks of `block_size`
+  /// bytes. The cache is disabled if `max_bytes` is 0, in which case each file
+  /// reads ahead `block_size` bytes into its own buffer. If `max_staleness`
+  /// is 0, the cached blocks of a file are discarded when the file is opened,
+  /// otherwise when they are older than `max_staleness` seconds.
+  ///
+  /// The statistics of at most `stat_cache_max_entries` objects are cached
+  /// for `stat_cache_max_age` seconds. The stat cache is disabled if
+  /// `stat_cache_max_age` is 0.
+  ///
+  /// Both caches are updated by the writes, deletions and renames made
+  /// through this filesystem, but not by those made by other clients.
+  ///
+  /// The writable files of at least `composite_upload_threshold` bytes are
+  /// uploaded as components of `composite_upload_chunk_size` bytes, which are
+  /// uploaded in parallel while the file is written, and are composed into
+  /// the object when the file is synced. The components are temporary objects
+  /// under a hidden prefix of the bucket, and grow in size with their number
+  /// so that the object stays within the 1024 components allowed by GCS.
+  /// Composite uploads are disabled if `composite_upload_threshold` is 0.
+  GcsFileSystem(std::unique_ptr<AuthProvider> auth_provider,
+                std::unique_ptr<HttpRequest::Factory> http_request_factory,
+                size_t block_size, uint64 max_bytes, uint64 max_staleness,
+                uint64 stat_cache_max_age, size_t stat_cache_max_entries,
+                uint64 composite_upload_threshold,
+                size_t composite_upload_chunk_size,
+                int64 initial_retry_delay_usec);
 
   Status NewRandomAccessFile(
       const string& filename,
@@ -76,6 +109,10 @@ class GcsFileSystem : public FileSystem {
                            int64* undeleted_dirs) override;
   size_t get_readahead_buffer_size() const { return read_ahead_bytes_; }
 
+  /// The block cache shared by the random access files, or nullptr if it is
+  /// disabled.
+  FileBlockCache* file_block_cache() const { return file_block_cache_.get(); }
+
  private:
   /// \brief Checks if the bucket exists. Returns OK if the check succeeded.
   ///
@@ -108,6 +145,21 @@ class GcsFileSystem : public FileSystem {
                        FileStatistics* stat);
   Status RenameObject(const string& src, const string& target);
 
+  /// Fetches at most `n` bytes of `filename` starting at `offset` into `out`,
+  /// for the block cache.
+  Status LoadBufferFromGCS(const string& filename, size_t offset, size_t n,
+                           std::vector<char>* out);
+
+  /// Removes the cached blocks and statistics of `filename`.
+  void ClearFileCaches(const string& filename);
+
+  /// Creates the caches for the given options, or disables them.
+  void InitCaches(size_t block_size, uint64 max_bytes, uint64 max_staleness,
+                  uint64 stat_cache_max_age, size_t stat_cache_max_entries);
+
+  /// Creates the threads of the composite uploads, unless they are disabled.
+  void InitCompositeUploads(uint64 threshold, size_t chunk_size);
+
   std::unique_ptr<AuthProvider> auth_provider_;
   std::unique_ptr<HttpRequest::Factory> http_request_factory_;
 
@@ -118,6 +170,20 @@ class GcsFileSystem : public FileSystem {
   // The initial delay for exponential backoffs when retrying failed calls.
   const int64 initial_retry_delay_usec_ = 1000000L;
 
+  // The block cache shared by the random access files, if enabled.
+  std::unique_ptr<FileBlockCache> file_block_cache_;
+
+  // The statistics of the objects, keyed by GCS path.
+  std::unique_ptr<ExpiringLRUCache<FileStatistics>> stat_cache_;
+
+  // The minimum size of the files uploaded as composite objects, or 0 if
+  // composite uploads are disabled, and the size of their components.
+  uint64 composite_upload_threshold_ = 0;
+  size_t composite_upload_chunk_size_ = 0;
+
+  // The threads that upload the components of the composite uploads.
+  std::unique_ptr<thread::ThreadPool> upload_threads_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GcsFileSystem);
 };
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/gcs_file_system.h"
+#include <algorithm>
 #include <fstream>
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/cloud/http_request_fake.h"
@@ -30,6 +31,65 @@ class FakeAuthProvider : public AuthProvider {
   }
 };
 
+// A request that records its URI, body and method when it is sent, for the
+// requests that are made concurrently in an unspecified order.
+class RecordingHttpRequest : public HttpRequest {
+ public:
+  RecordingHttpRequest(mutex* mu, std::vector<string>* requests)
+      : mu_(mu), requests_(requests) {}
+
+  Status Init() override { return Status::OK(); }
+  Status SetUri(const string& uri) override {
+    request_ = uri + request_;
+    return Status::OK();
+  }
+  Status AddHeader(const string& name, const string& value) override {
+    return Status::OK();
+  }
+  Status AddAuthBearerHeader(const string& auth_token) override {
+    return Status::OK();
+  }
+  Status SetDeleteRequest() override {
+    request_ += " Delete";
+    return Status::OK();
+  }
+  Status SetPostFromBuffer(const char* buffer, size_t size) override {
+    request_ += strings::StrCat(" Post body: ", StringPiece(buffer, size));
+    return Status::OK();
+  }
+  Status SetResultBuffer(std::vector<char>* buffer) override {
+    buffer->clear();
+    return Status::OK();
+  }
+  Status Send() override {
+    mutex_lock lock(*mu_);
+    requests_->push_back(request_);
+    return Status::OK();
+  }
+  string EscapeString(const string& str) override { return str; }
+
+ private:
+  mutex* mu_;
+  std::vector<string>* requests_;
+  string request_;
+};
+
+class RecordingHttpRequestFactory : public HttpRequest::Factory {
+ public:
+  HttpRequest* Create() override {
+    return new RecordingHttpRequest(&mu_, &requests_);
+  }
+
+  std::vector<string> requests() {
+    mutex_lock lock(mu_);
+    return requests_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<string> requests_;
+};
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_NoReadAhead) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -192,6 +252,63 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_WithReadAhead) {
   EXPECT_EQ("0123", result);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_WithBlockCache) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-8\n",
+           "012345678"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 9-17\n",
+           "9abc"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-8\n",
+           "01234567x")});
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(
+                       new FakeHttpRequestFactory(&requests)),
+                   9 /* block size */, 18 /* max bytes */,
+                   0 /* max staleness */, 0 /* stat cache max age */,
+                   0 /* stat cache max entries */,
+                   0 /* composite upload threshold */,
+                   0 /* composite upload chunk size */,
+                   0 /* initial retry delay */);
+
+  char scratch[100];
+  StringPiece result;
+  {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_EXPECT_OK(
+        fs.NewRandomAccessFile("gs://bucket/random_access.txt", &file));
+
+    // The first block is fetched once, and read twice.
+    TF_EXPECT_OK(file->Read(0, 4, &result, scratch));
+    EXPECT_EQ("0123", result);
+    TF_EXPECT_OK(file->Read(4, 4, &result, scratch));
+    EXPECT_EQ("4567", result);
+
+    // The second block is the last one of the file.
+    EXPECT_EQ(errors::Code::OUT_OF_RANGE,
+              file->Read(9, 5, &result, scratch).code());
+    EXPECT_EQ("9abc", result);
+    EXPECT_EQ(13, fs.file_block_cache()->CacheSize());
+  }
+  {
+    // Opening the file again discards its cached blocks, since the maximum
+    // staleness is 0.
+    std::unique_ptr<RandomAccessFile> file;
+    TF_EXPECT_OK(
+        fs.NewRandomAccessFile("gs://bucket/random_access.txt", &file));
+    TF_EXPECT_OK(file->Read(5, 4, &result, scratch));
+    EXPECT_EQ("567x", result);
+  }
+}
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_NoObjectName) {
   std::vector<HttpRequest*> requests;
   GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
@@ -431,6 +548,109 @@ TEST(GcsFileSystemTest, NewWritableFile_UploadReturns410) {
       << status;
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_CompositeUpload) {
+  RecordingHttpRequestFactory* factory = new RecordingHttpRequestFactory;
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(factory),
+                   0 /* block size */, 0 /* max bytes */,
+                   0 /* max staleness */, 0 /* stat cache max age */,
+                   0 /* stat cache max entries */,
+                   8 /* composite upload threshold */,
+                   4 /* composite upload chunk size */,
+                   0 /* initial retry delay */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/file.txt", &file));
+  TF_EXPECT_OK(file->Append("cont"));
+  TF_EXPECT_OK(file->Append("ent1"));
+  TF_EXPECT_OK(file->Append("XY"));
+  TF_EXPECT_OK(file->Close());
+
+  // The components are uploaded in any order, then composed and deleted.
+  std::vector<string> requests = factory->requests();
+  ASSERT_EQ(7, requests.size());
+  const string upload_prefix =
+      "https://www.googleapis.com/upload/storage/v1/b/bucket/"
+      "o?uploadType=media&name=";
+  const string object_prefix = ".tf_composite_uploads/path/file.txt.";
+  ASSERT_TRUE(StringPiece(requests[0])
+                  .starts_with(strings::StrCat(upload_prefix, object_prefix)));
+  // The components are named after a random upload id.
+  const size_t id_end = requests[0].find(
+      '/', upload_prefix.size() + object_prefix.size());
+  ASSERT_NE(string::npos, id_end);
+  const string component_prefix = requests[0].substr(
+      upload_prefix.size(), id_end + 1 - upload_prefix.size());
+  std::sort(requests.begin(), requests.begin() + 3);
+  EXPECT_EQ(strings::StrCat(upload_prefix, component_prefix,
+                            "0 Post body: cont"),
+            requests[0]);
+  EXPECT_EQ(strings::StrCat(upload_prefix, component_prefix,
+                            "1 Post body: ent1"),
+            requests[1]);
+  EXPECT_EQ(strings::StrCat(upload_prefix, component_prefix,
+                            "2 Post body: XY"),
+            requests[2]);
+  EXPECT_EQ(strings::StrCat(
+                "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                "path/file.txt/compose Post body: "
+                "{\"destination\":{\"contentType\":"
+                "\"application/octet-stream\"},\"sourceObjects\":["
+                "{\"name\":\"",
+                component_prefix, "0\"},{\"name\":\"", component_prefix,
+                "1\"},{\"name\":\"", component_prefix, "2\"}]}\n"),
+            requests[3]);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(strings::StrCat("https://www.googleapis.com/storage/v1/b/bucket/"
+                              "o/",
+                              component_prefix, i, " Delete"),
+              requests[4 + i]);
+  }
+}
+
+TEST(GcsFileSystemTest, NewWritableFile_CompositeUpload_ManyComponents) {
+  RecordingHttpRequestFactory* factory = new RecordingHttpRequestFactory;
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(factory),
+                   0 /* block size */, 0 /* max bytes */,
+                   0 /* max staleness */, 0 /* stat cache max age */,
+                   0 /* stat cache max entries */,
+                   1 /* composite upload threshold */,
+                   1 /* composite upload chunk size */,
+                   0 /* initial retry delay */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/file.txt", &file));
+  TF_EXPECT_OK(file->Append(string(70, 'x')));
+  TF_EXPECT_OK(file->Close());
+
+  // The first 64 components have 1 byte and the next ones 2 bytes. The first
+  // 32 components are composed into an intermediate object, which is composed
+  // with the next 31 into another one, which is composed with the last 4 into
+  // the file.
+  int num_uploads = 0;
+  int num_composes = 0;
+  int num_deletes = 0;
+  string last_compose;
+  for (const string& request : factory->requests()) {
+    if (StringPiece(request).starts_with(
+            "https://www.googleapis.com/upload/storage/v1/b/bucket/o?")) {
+      ++num_uploads;
+    } else if (StringPiece(request).contains("/compose ")) {
+      ++num_composes;
+      last_compose = request;
+    } else if (StringPiece(request).ends_with(" Delete")) {
+      ++num_deletes;
+    }
+  }
+  EXPECT_EQ(67, num_uploads);
+  EXPECT_EQ(3, num_composes);
+  EXPECT_EQ(69, num_deletes);
+  EXPECT_TRUE(StringPiece(last_compose)
+                  .starts_with("https://www.googleapis.com/storage/v1/b/"
+                               "bucket/o/file.txt/compose "));
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_NoObjectName) {
   std::vector<HttpRequest*> requests;
   GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
@@ -725,6 +945,25 @@ TEST(GcsFileSystemTest, GetChildren_Root) {
   EXPECT_EQ(0, children.size());
 }
 
+TEST(GcsFileSystemTest, GetChildren_HidesCompositeUploads) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
+      "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F\n"
+      "Auth Token: fake_token\n",
+      "{\"items\": [ "
+      "  { \"name\": \"file1.txt\" }],"
+      "\"prefixes\": [\".tf_composite_uploads/\", \"subpath/\"]}")});
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(
+                       new FakeHttpRequestFactory(&requests)),
+                   0 /* read ahead bytes */, 0 /* initial retry delay */);
+
+  std::vector<string> children;
+  TF_EXPECT_OK(fs.GetChildren("gs://bucket", &children));
+
+  EXPECT_EQ(std::vector<string>({"file1.txt", "subpath/"}), children);
+}
+
 TEST(GcsFileSystemTest, GetChildren_Empty) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
       "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
@@ -1217,6 +1456,57 @@ TEST(GcsFileSystemTest, Stat_Object) {
   EXPECT_FALSE(stat.is_directory);
 }
 
+TEST(GcsFileSystemTest, Stat_Cache) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "file.txt?fields=size%2Cupdated\n"
+           "Auth Token: fake_token\n",
+           strings::StrCat("{\"size\": \"1010\","
+                           "\"updated\": \"2016-04-29T23:15:24.896Z\"}")),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b"
+                           "/bucket/o/file.txt\n"
+                           "Auth Token: fake_token\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "file.txt?fields=size%2Cupdated\n"
+           "Auth Token: fake_token\n",
+           "", errors::NotFound("404"), 404),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
+           "fields=items%2Fname%2CnextPageToken&prefix=file.txt%2F"
+           "&maxResults=1\n"
+           "Auth Token: fake_token\n",
+           "{}")});
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(
+                       new FakeHttpRequestFactory(&requests)),
+                   0 /* block size */, 0 /* max bytes */,
+                   0 /* max staleness */, 3600 /* stat cache max age */,
+                   10 /* stat cache max entries */,
+                   0 /* composite upload threshold */,
+                   0 /* composite upload chunk size */,
+                   0 /* initial retry delay */);
+
+  // The second lookup is served by the cache.
+  for (int i = 0; i < 2; ++i) {
+    FileStatistics stat;
+    TF_EXPECT_OK(fs.Stat("gs://bucket/file.txt", &stat));
+    EXPECT_EQ(1010, stat.length);
+    uint64 file_size;
+    TF_EXPECT_OK(fs.GetFileSize("gs://bucket/file.txt", &file_size));
+    EXPECT_EQ(1010, file_size);
+  }
+
+  // The deletion removes the file from the cache.
+  TF_EXPECT_OK(fs.DeleteFile("gs://bucket/file.txt"));
+  FileStatistics stat;
+  EXPECT_EQ(errors::Code::NOT_FOUND,
+            fs.Stat("gs://bucket/file.txt", &stat).code());
+}
+
 TEST(GcsFileSystemTest, Stat_Folder) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -1626,5 +1916,32 @@ TEST(GcsFileSystemTest, OverrideReadaheadBufferSize) {
   EXPECT_EQ(123456789L, fs2.get_readahead_buffer_size());
 }
 
+TEST(GcsFileSystemTest, OverrideBlockCache) {
+  GcsFileSystem fs1;
+  ASSERT_NE(nullptr, fs1.file_block_cache());
+  EXPECT_EQ(16 * 1024 * 1024, fs1.file_block_cache()->block_size());
+  EXPECT_EQ(256 * 1024 * 1024, fs1.file_block_cache()->max_bytes());
+
+  setenv("GCS_READ_CACHE_BLOCK_SIZE_MB", "2", 1);
+  setenv("GCS_READ_CACHE_MAX_SIZE_MB", "10", 1);
+  GcsFileSystem fs2;
+  ASSERT_NE(nullptr, fs2.file_block_cache());
+  EXPECT_EQ(2 * 1024 * 1024, fs2.file_block_cache()->block_size());
+  EXPECT_EQ(10 * 1024 * 1024, fs2.file_block_cache()->max_bytes());
+
+  setenv("GCS_READ_CACHE_MAX_SIZE_MB", "0", 1);
+  GcsFileSystem fs3;
+  EXPECT_EQ(nullptr, fs3.file_block_cache());
+
+  // Values that are not numbers are ignored.
+  setenv("GCS_READ_CACHE_MAX_SIZE_MB", "lots", 1);
+  GcsFileSystem fs4;
+  ASSERT_NE(nullptr, fs4.file_block_cache());
+  EXPECT_EQ(256 * 1024 * 1024, fs4.file_block_cache()->max_bytes());
+
+  unsetenv("GCS_READ_CACHE_BLOCK_SIZE_MB");
+  unsetenv("GCS_READ_CACHE_MAX_SIZE_MB");
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -34,6 +34,21 @@ constexpr bool kLittleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
 // software can change it dynamically.
 int NumSchedulableCPUs();
 
+// Returns the number of NUMA nodes on this host, or 1 if the topology
+// cannot be determined. Nodes are numbered from 0 up to the highest online
+// node, so the ids of offline nodes below it are counted too.
+int NUMANumNodes();
+
+// Returns the number of CPUs of NUMA node "node" on which this process may
+// be scheduled, or NumSchedulableCPUs() if the topology cannot be
+// determined.
+int NUMANumSchedulableCPUs(int node);
+
+// Restricts the calling thread to the CPUs of NUMA node "node". Returns
+// false if this is not supported or fails, in which case the affinity of
+// the thread is unchanged.
+bool NUMASetThreadNodeAffinity(int node);
+
 // Mostly ISA related features that we care about
 enum CPUFeature {
   // Do not change numeric assignments.
@@ -88,6 +103,7 @@ enum CPUFeature {
   AVX512IFMA = 35,     // Integer multiply-add
   AVX512_4VNNIW = 36,  // Integer neural network
   AVX512_4FMAPS = 37,  // Floating point neural network
+  AVX512_VNNI = 38,    // Integer dot products (Cascade Lake and later)
 };
 
 // Checks whether the current processor supports one of the features above.
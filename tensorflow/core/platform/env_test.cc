@@ -82,6 +82,34 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadMany) {
+  const string filename = io::JoinPath(BaseDir(), "read_many");
+  const string input = CreateTestFile(env_, filename, 100);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  string scratch(40, 0);
+  std::vector<RandomAccessFile::ReadRequest> requests(3);
+  requests[0].offset = 50;
+  requests[0].n = 10;
+  requests[0].scratch = &scratch[0];
+  requests[1].offset = 0;
+  requests[1].n = 20;
+  requests[1].scratch = &scratch[10];
+  // Reads past EOF, like Read().
+  requests[2].offset = 95;
+  requests[2].n = 10;
+  requests[2].scratch = &scratch[30];
+  f->ReadMany(&requests);
+
+  TF_EXPECT_OK(requests[0].status);
+  EXPECT_EQ(input.substr(50, 10), requests[0].result);
+  TF_EXPECT_OK(requests[1].status);
+  EXPECT_EQ(input.substr(0, 20), requests[1].result);
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+  EXPECT_EQ(input.substr(95), requests[2].result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1}) {
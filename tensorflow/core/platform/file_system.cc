@@ -72,6 +72,13 @@ Status FileSystem::IsDirectory(const string& name) {
 
 RandomAccessFile::~RandomAccessFile() {}
 
+void RandomAccessFile::ReadMany(std::vector<ReadRequest>* requests) const {
+  for (ReadRequest& request : *requests) {
+    request.status =
+        Read(request.offset, request.n, &request.result, request.scratch);
+  }
+}
+
 WritableFile::~WritableFile() {}
 
 FileSystemRegistry::~FileSystemRegistry() {}
@@ -235,6 +235,27 @@ class RandomAccessFile {
   virtual Status Read(uint64 offset, size_t n, StringPiece* result,
                       char* scratch) const = 0;
 
+  /// \brief A range of the file to read with `ReadMany()`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+
+    /// Set by `ReadMany()` as by `Read()`.
+    StringPiece result;
+    Status status;
+  };
+
+  /// \brief Reads each of `*requests` as if by `Read()`, and stores each
+  /// result and status in its request.
+  ///
+  /// Unlike a sequence of `Read()` calls, this lets implementations have
+  /// all the ranges in flight at once. The default implementation reads
+  /// them one after another.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadMany(std::vector<ReadRequest>* requests) const;
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
@@ -33,6 +33,25 @@ void* Malloc(size_t size);
 void* Realloc(void* ptr, size_t size);
 void Free(void* ptr);
 
+// Allocates "size" bytes whose pages are preferably placed on NUMA node
+// "node". Falls back to AlignedMalloc where this is not supported.
+// `minimum_alignment` must be a power of 2 no larger than the page size.
+// The memory must be released with NUMAFree, passing the same size.
+void* NUMAMalloc(int node, size_t size, int minimum_alignment);
+void NUMAFree(void* ptr, size_t size);
+
+// Allocates "size" bytes backed by 2MB huge pages where the platform
+// supports them, which saves TLB misses when large buffers are accessed.
+// Explicit huge pages are used if the system has any reserved, transparent
+// huge pages otherwise. The pages are preferably placed on NUMA node "node",
+// unless it is negative. The size is rounded up to whole huge pages, so this
+// is meant for large regions, not for individual buffers. Falls back to
+// NUMAMalloc where huge pages are not supported. `minimum_alignment` must be
+// a power of 2 no larger than the page size. The memory must be released
+// with HugePageFree, passing the same size.
+void* HugePageMalloc(int node, size_t size, int minimum_alignment);
+void HugePageFree(void* ptr, size_t size);
+
 // Tries to release num_bytes of free memory back to the operating
 // system for reuse.  Use this routine with caution -- to get this
 // memory back may require faulting pages back in by the OS, and
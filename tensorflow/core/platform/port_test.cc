@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string.h>
 #include <condition_variable>
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
@@ -33,6 +34,33 @@ TEST(Port, AlignedMalloc) {
   }
 }
 
+TEST(Port, NUMAMalloc) {
+  const int num_nodes = NUMANumNodes();
+  EXPECT_GE(num_nodes, 1);
+  for (int node = 0; node < num_nodes; ++node) {
+    EXPECT_GE(NUMANumSchedulableCPUs(node), 1);
+    const size_t size = 1 << 20;
+    char* p = static_cast<char*>(NUMAMalloc(node, size, 64));
+    ASSERT_TRUE(p != nullptr) << "NUMAMalloc(" << node << ")";
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0);
+    memset(p, 0, size);
+    NUMAFree(p, size);
+  }
+}
+
+TEST(Port, HugePageMalloc) {
+  for (int node = -1; node < NUMANumNodes(); ++node) {
+    // Not a multiple of the huge page size.
+    const size_t size = (3 << 20) + 100;
+    char* p = static_cast<char*>(HugePageMalloc(node, size, 64));
+    ASSERT_TRUE(p != nullptr) << "HugePageMalloc(" << node << ")";
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0);
+    memset(p, 1, size);
+    EXPECT_EQ(1, p[size - 1]);
+    HugePageFree(p, size);
+  }
+}
+
 TEST(ConditionVariable, WaitForMilliseconds_Timeout) {
   mutex m;
   mutex_lock l(m);
@@ -24,11 +24,15 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #if defined(__linux__) && !defined(__ANDROID__)
 #include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <algorithm>
+#include <vector>
 #ifdef SNAPPY
 #include "snappy.h"
 #endif
@@ -66,6 +70,194 @@ int NumSchedulableCPUs() {
   return kDefaultCores;
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// Reads the sysfs file "path", which holds a list of ranges such as
+// "0-7,16-23", into "*ids".
+bool ReadSysfsIdList(const char* path, std::vector<int>* ids) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+  ids->clear();
+  int first, last;
+  while (fscanf(f, "%d", &first) == 1) {
+    last = first;
+    int c = fgetc(f);
+    if (c == '-') {
+      if (fscanf(f, "%d", &last) != 1) break;
+      c = fgetc(f);
+    }
+    for (int id = first; id <= last; ++id) ids->push_back(id);
+    if (c != ',') break;
+  }
+  fclose(f);
+  return true;
+}
+
+// Reads the CPUs of NUMA node "node" from sysfs into "*cpus".
+bool ReadNUMANodeCPUs(int node, cpu_set_t* cpus) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+           node);
+  std::vector<int> cpu_ids;
+  if (!ReadSysfsIdList(path, &cpu_ids)) return false;
+  CPU_ZERO(cpus);
+  for (int cpu : cpu_ids) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, cpus);
+  }
+  return true;
+}
+
+}  // namespace
+#endif
+
+int NUMANumNodes() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  // Node ids need not be contiguous, e.g. after a node was taken offline,
+  // so count up to the highest online one.
+  static const int num_nodes = [] {
+    int n = 0;
+    std::vector<int> online;
+    if (ReadSysfsIdList("/sys/devices/system/node/online", &online)) {
+      for (int node : online) n = std::max(n, node + 1);
+    }
+    return n > 0 ? n : 1;
+  }();
+  return num_nodes;
+#else
+  return 1;
+#endif
+}
+
+int NUMANumSchedulableCPUs(int node) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t node_cpus, schedulable;
+  if (ReadNUMANodeCPUs(node, &node_cpus) &&
+      sched_getaffinity(0, sizeof(cpu_set_t), &schedulable) == 0) {
+    CPU_AND(&node_cpus, &node_cpus, &schedulable);
+    const int count = CPU_COUNT(&node_cpus);
+    if (count > 0) return count;
+  }
+#endif
+  return NumSchedulableCPUs();
+}
+
+bool NUMASetThreadNodeAffinity(int node) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t cpus;
+  if (!ReadNUMANodeCPUs(node, &cpus)) return false;
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &cpus) == 0) return true;
+  perror("sched_setaffinity");
+#endif
+  return false;
+}
+
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+namespace {
+
+// Makes "node" the preferred NUMA node of the pages in [ptr, ptr + size).
+// Pages are placed when first touched, so it is enough to set the policy
+// before returning the memory. MPOL_PREFERRED still falls back to other
+// nodes when this one is full.
+void PreferNUMANode(void* ptr, size_t size, int node) {
+  const int kMPolPreferred = 1;
+  // The kernel reads the mask as an array of longs, one bit per node.
+  const int kBitsPerWord = sizeof(unsigned long) * 8;  // NOLINT
+  std::vector<unsigned long> node_mask(node / kBitsPerWord + 1);  // NOLINT
+  node_mask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+  if (syscall(SYS_mbind, ptr, size, kMPolPreferred, node_mask.data(),
+              node_mask.size() * kBitsPerWord, 0) != 0) {
+    perror("mbind");
+  }
+}
+
+}  // namespace
+#endif
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+  if (NUMANumNodes() > 1) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return nullptr;
+    PreferNUMANode(ptr, size, node);
+    return ptr;
+  }
+#endif
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void NUMAFree(void* ptr, size_t size) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+  if (NUMANumNodes() > 1) {
+    munmap(ptr, size);
+    return;
+  }
+#endif
+  AlignedFree(ptr);
+}
+
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+constexpr size_t kHugePageSize = 2 << 20;
+
+size_t RoundUpToHugePages(size_t size) {
+  return (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+}
+
+}  // namespace
+#endif
+
+void* HugePageMalloc(int node, size_t size, int minimum_alignment) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  const size_t rounded_size = RoundUpToHugePages(size);
+  void* ptr = MAP_FAILED;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  // Fails right away unless enough 2MB pages are reserved in the hugetlbfs
+  // pool, e.g. through /proc/sys/vm/nr_hugepages.
+  ptr = mmap(nullptr, rounded_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT),
+             -1, 0);
+#endif
+  if (ptr == MAP_FAILED) {
+    // Transparent huge pages only back ranges aligned to the huge page size,
+    // so map one extra page and trim the range to an aligned one.
+    const size_t mapped_size = rounded_size + kHugePageSize;
+    char* base = static_cast<char*>(mmap(nullptr, mapped_size,
+                                         PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (base == MAP_FAILED) return nullptr;
+    char* aligned = reinterpret_cast<char*>(
+        RoundUpToHugePages(reinterpret_cast<uintptr_t>(base)));
+    if (aligned > base) munmap(base, aligned - base);
+    char* end = aligned + rounded_size;
+    if (end < base + mapped_size) munmap(end, base + mapped_size - end);
+    ptr = aligned;
+#ifdef MADV_HUGEPAGE
+    // Fails harmlessly when transparent huge pages are disabled.
+    madvise(ptr, rounded_size, MADV_HUGEPAGE);
+#endif
+  }
+#ifdef SYS_mbind
+  if (node >= 0 && NUMANumNodes() > 1) {
+    PreferNUMANode(ptr, rounded_size, node);
+  }
+#endif
+  return ptr;
+#else
+  return NUMAMalloc(node < 0 ? 0 : node, size, minimum_alignment);
+#endif
+}
+
+void HugePageFree(void* ptr, size_t size) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  munmap(ptr, RoundUpToHugePages(size));
+#else
+  NUMAFree(ptr, size);
+#endif
+}
+
 void* AlignedMalloc(size_t size, int minimum_alignment) {
 #if defined(__ANDROID__)
   return memalign(minimum_alignment, size);
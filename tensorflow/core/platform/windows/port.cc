@@ -56,6 +56,24 @@ int NumSchedulableCPUs() {
   return system_info.dwNumberOfProcessors;
 }
 
+int NUMANumNodes() { return 1; }
+
+int NUMANumSchedulableCPUs(int node) { return NumSchedulableCPUs(); }
+
+bool NUMASetThreadNodeAffinity(int node) { return false; }
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void NUMAFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
+void* HugePageMalloc(int node, size_t size, int minimum_alignment) {
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void HugePageFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
 void* AlignedMalloc(size_t size, int minimum_alignment) {
 #ifdef TENSORFLOW_USE_JEMALLOC
   void* ptr = NULL;
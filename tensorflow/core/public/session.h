@@ -171,6 +171,37 @@ class Session {
                       const std::vector<string>& output_names,
                       std::vector<Tensor>* outputs);
 
+  /// \brief Identifies a feed/fetch/target signature set up by
+  /// `MakeCallable()`.
+  typedef int64 CallableHandle;
+
+  /// \brief Resolves `feed_names`, `fetch_names` and `target_names` once
+  /// and returns in `out_handle` a handle for running that subgraph
+  /// repeatedly with `RunCallable()`, with the given `run_options`.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status MakeCallable(const RunOptions& run_options,
+                              const std::vector<string>& feed_names,
+                              const std::vector<string>& fetch_names,
+                              const std::vector<string>& target_names,
+                              CallableHandle* out_handle);
+
+  /// \brief Runs the subgraph of `handle`. `feed_tensors` are given in the
+  /// order of the `feed_names` passed to `MakeCallable()`, and
+  /// `fetch_tensors` is filled in the order of its `fetch_names`.
+  /// `fetch_tensors` and `run_metadata` may be nullptr.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallable(CallableHandle handle,
+                             const std::vector<Tensor>& feed_tensors,
+                             std::vector<Tensor>* fetch_tensors,
+                             RunMetadata* run_metadata);
+
+  /// \brief Releases the resources associated with `handle`.
+  ///
+  /// REQUIRES: No call to `RunCallable()` with `handle` is in progress or
+  /// made afterwards.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status ReleaseCallable(CallableHandle handle);
+
   /// \brief List devices in the session.
   ///
   /// Retrieves the list of available devices within the session, and populates
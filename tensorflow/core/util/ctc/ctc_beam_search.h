@@ -87,6 +87,8 @@ class CTCBeamSearchDecoder : public CTCDecoder {
         beam_width_(beam_width),
         leaves_(beam_width),
         beam_scorer_(CHECK_NOTNULL(scorer)) {
+    leaves_.reserve(beam_width);
+    branches_.reserve(beam_width);
     Reset();
   }
 
@@ -121,6 +123,14 @@ class CTCBeamSearchDecoder : public CTCDecoder {
                   std::vector<float>* log_probs, bool merge_repeated) const;
 
  private:
+  // Moves the leaves, sorted in decreasing newp order, to branches_, and
+  // empties leaves_. Unlike TopN::Extract(), keeps the capacity of both.
+  void ExtractLeavesToBranches();
+
+  // Gives 'entry' its num_classes_ - 1 children, reusing a vector of entries
+  // released by Reset() if there is one.
+  void PopulateChildren(BeamEntry* entry);
+
   int beam_width_;
 
   // Label selection is designed to avoid possibly very expensive scorer calls,
@@ -140,6 +150,17 @@ class CTCBeamSearchDecoder : public CTCDecoder {
   std::unique_ptr<BeamEntry> beam_root_;
   BaseBeamScorer<CTCBeamState>* beam_scorer_;
 
+  // Scratch space reused across steps, so that Step() allocates only when the
+  // beam grows new children.
+  std::vector<BeamEntry*> branches_;
+  Eigen::ArrayXf input_;
+  std::vector<float> input_copy_;
+
+  // Children vectors of the beam entries of previous decodes, all of size
+  // num_classes_ - 1, handed out again by PopulateChildren(). Element
+  // addresses are stable, as the vectors are only ever moved.
+  std::vector<std::vector<BeamEntry>> children_pool_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(CTCBeamSearchDecoder);
 };
 
@@ -174,10 +195,8 @@ Status CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Decode(
     }  // for (int t...
 
     // O(n * log(n))
-    std::unique_ptr<std::vector<BeamEntry*>> branches(leaves_.Extract());
-    leaves_.Reset();
-    for (int i = 0; i < branches->size(); ++i) {
-      BeamEntry* entry = (*branches)[i];
+    ExtractLeavesToBranches();
+    for (BeamEntry* entry : branches_) {
       beam_scorer_->ExpandStateEnd(&entry->state);
       entry->newp.total +=
           beam_scorer_->GetStateEndExpansionScore(entry->state);
@@ -206,18 +225,19 @@ template <typename CTCBeamState, typename CTCBeamComparer>
 template <typename Vector>
 void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Step(
     const Vector& raw_input) {
-  Eigen::ArrayXf input = raw_input;
+  input_ = raw_input;
+  Eigen::ArrayXf& input = input_;
   // Remove the max for stability when performing log-prob calculations.
   input -= input.maxCoeff();
 
   // Minimum allowed input value for label selection:
   float label_selection_input_min = -std::numeric_limits<float>::infinity();
   if (label_selection_size_ > 0 && label_selection_size_ < input.size()) {
-    std::vector<float> input_copy(input.data(), input.data() + input.size());
-    std::nth_element(input_copy.begin(),
-                     input_copy.begin() + label_selection_size_ - 1,
-                     input_copy.end(), [](float a, float b) { return a > b; });
-    label_selection_input_min = input_copy[label_selection_size_ - 1];
+    input_copy_.assign(input.data(), input.data() + input.size());
+    std::nth_element(input_copy_.begin(),
+                     input_copy_.begin() + label_selection_size_ - 1,
+                     input_copy_.end(), [](float a, float b) { return a > b; });
+    label_selection_input_min = input_copy_[label_selection_size_ - 1];
   }
   if (label_selection_margin_ >= 0) {
     // max element is 0, per normalization above
@@ -228,15 +248,14 @@ void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Step(
   // Extract the beams sorted in decreasing new probability
   CHECK_EQ(num_classes_, input.size());
 
-  std::unique_ptr<std::vector<BeamEntry*>> branches(leaves_.Extract());
-  leaves_.Reset();
+  ExtractLeavesToBranches();
 
-  for (BeamEntry* b : *branches) {
+  for (BeamEntry* b : branches_) {
     // P(.. @ t) becomes the new P(.. @ t-1)
     b->oldp = b->newp;
   }
 
-  for (BeamEntry* b : *branches) {
+  for (BeamEntry* b : branches_) {
     if (b->parent != nullptr) {  // if not the root
       if (b->parent->Active()) {
         // If last two sequence characters are identical:
@@ -270,7 +289,7 @@ void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Step(
   // originally in descending newp order and we copied newp to oldp.
 
   // Grow new leaves
-  for (BeamEntry* b : *branches) {
+  for (BeamEntry* b : branches_) {
     // A new leaf (represented by its BeamProbability) is a candidate
     // iff its total probability is nonzero and either the beam list
     // isn't full, or the lowest probability entry in the beam has a
@@ -286,7 +305,7 @@ void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Step(
     }
 
     if (!b->HasChildren()) {
-      b->PopulateChildren(num_classes_ - 1);
+      PopulateChildren(b);
     }
 
     for (BeamEntry& c : *b->Children()) {
@@ -333,9 +352,26 @@ template <typename CTCBeamState, typename CTCBeamComparer>
 void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Reset() {
   leaves_.Reset();
 
-  // This beam root, and all of its children, will be in memory until
-  // the next reset.
-  beam_root_.reset(new BeamEntry(nullptr, -1, num_classes_ - 1, -1));
+  // Release the children of the previous beam tree to the pool. The tree can
+  // be as deep as the longest sequence, so walk it without recursion.
+  if (beam_root_ != nullptr) {
+    std::vector<BeamEntry*> to_release = {beam_root_.get()};
+    while (!to_release.empty()) {
+      BeamEntry* entry = to_release.back();
+      to_release.pop_back();
+      if (!entry->HasChildren()) continue;
+      for (BeamEntry& child : entry->children) {
+        to_release.push_back(&child);
+      }
+      children_pool_.emplace_back();
+      children_pool_.back().swap(entry->children);
+    }
+  }
+
+  // This beam root, and all of its children, will be in use until the next
+  // reset.
+  beam_root_.reset(new BeamEntry);
+  PopulateChildren(beam_root_.get());
   beam_root_->newp.total = 0.0;  // ln(1)
   beam_root_->newp.blank = 0.0;  // ln(1)
 
@@ -346,6 +382,35 @@ void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Reset() {
   beam_scorer_->InitializeState(&beam_root_->state);
 }
 
+template <typename CTCBeamState, typename CTCBeamComparer>
+void CTCBeamSearchDecoder<CTCBeamState,
+                          CTCBeamComparer>::ExtractLeavesToBranches() {
+  leaves_.ExtractNondestructive(&branches_);
+  leaves_.Reset();
+}
+
+template <typename CTCBeamState, typename CTCBeamComparer>
+void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::PopulateChildren(
+    BeamEntry* entry) {
+  CHECK(!entry->HasChildren());
+  if (children_pool_.empty()) {
+    entry->PopulateChildren(num_classes_ - 1);
+    return;
+  }
+  entry->children.swap(children_pool_.back());
+  children_pool_.pop_back();
+  // Reinitialize the reused entries as PopulateChildren() constructs them.
+  int ci = 0;
+  for (BeamEntry& c : entry->children) {
+    c.parent = entry;
+    c.label = ci;
+    c.oldp.Reset();
+    c.newp.Reset();
+    c.state = CTCBeamState();
+    ++ci;
+  }
+}
+
 template <typename CTCBeamState, typename CTCBeamComparer>
 Status CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::TopPaths(
     int n, std::vector<std::vector<int>>* paths, std::vector<float>* log_probs,
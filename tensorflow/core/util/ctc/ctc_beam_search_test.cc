@@ -221,6 +221,70 @@ TEST(CtcBeamSearch, AllBeamElementsHaveFiniteScores) {
   }
 }
 
+TEST(CtcBeamSearch, DecodingReusesBeamEntriesAcrossBatchEntries) {
+  const int batch_size = 3;
+  const int timesteps = 5;
+  const int top_paths = 3;
+  const int num_classes = 6;
+
+  // The decoder resets its beam between batch entries, handing the beam
+  // entries of one entry out again for the next one; the entries must not
+  // carry any state over.
+  CTCBeamSearchDecoder<>::DefaultBeamScorer default_scorer;
+  CTCBeamSearchDecoder<> decoder(num_classes, 10 * top_paths, &default_scorer,
+                                 batch_size);
+
+  // The first and last batch entries are the same; the middle one has the
+  // probabilities of labels 1 and 3 on labels 2 and 4.
+  int sequence_lengths[batch_size] = {timesteps, timesteps, timesteps};
+  const float entry_probs[timesteps][num_classes] = {
+      {0, 0.6, 0, 0.4, 0, 0},
+      {0, 0.5, 0, 0.5, 0, 0},
+      {0, 0.4, 0, 0.6, 0, 0},
+      {0, 0.4, 0, 0.6, 0, 0},
+      {0, 0.4, 0, 0.6, 0, 0}};
+  // The inputs are column-major (batch_size, num_classes) matrices.
+  float input_data_mat[timesteps][num_classes][batch_size];
+  for (int t = 0; t < timesteps; ++t) {
+    for (int c = 0; c < num_classes; ++c) {
+      const int shifted_c = (c == 0 || c == num_classes - 1) ? c : c - 1;
+      input_data_mat[t][c][0] = std::log(entry_probs[t][c]);
+      input_data_mat[t][c][1] = std::log(entry_probs[t][shifted_c]);
+      input_data_mat[t][c][2] = std::log(entry_probs[t][c]);
+    }
+  }
+
+  std::vector<CTCDecoder::Output> expected_output = {
+      {{1, 3}, {1, 3, 1}, {3, 1, 3}},
+      {{2, 4}, {2, 4, 2}, {4, 2, 4}},
+      {{1, 3}, {1, 3, 1}, {3, 1, 3}},
+  };
+
+  Eigen::Map<const Eigen::ArrayXi> seq_len(&sequence_lengths[0], batch_size);
+  std::vector<Eigen::Map<const Eigen::MatrixXf>> inputs;
+  inputs.reserve(timesteps);
+  for (int t = 0; t < timesteps; ++t) {
+    inputs.emplace_back(&input_data_mat[t][0][0], batch_size, num_classes);
+  }
+
+  std::vector<CTCDecoder::Output> outputs(top_paths);
+  for (CTCDecoder::Output& output : outputs) {
+    output.resize(batch_size);
+  }
+  float score[batch_size][top_paths] = {{0.0}};
+  Eigen::Map<Eigen::MatrixXf> scores(&score[0][0], batch_size, top_paths);
+
+  EXPECT_TRUE(decoder.Decode(seq_len, inputs, &outputs, &scores).ok());
+  for (int b = 0; b < batch_size; ++b) {
+    for (int path = 0; path < top_paths; ++path) {
+      EXPECT_EQ(outputs[path][b], expected_output[b][path]);
+    }
+  }
+  for (int path = 0; path < top_paths; ++path) {
+    EXPECT_EQ(scores(0, path), scores(2, path));
+  }
+}
+
 // A beam decoder to test label selection. It simply models N labels with
 // rapidly dropping off log-probability.
 
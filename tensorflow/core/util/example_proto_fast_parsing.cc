@@ -213,6 +213,12 @@ class Feature {
 using FeatureMapEntry = std::pair<StringPiece, Feature>;
 using Example = std::vector<FeatureMapEntry>;
 
+// A feature list name and its serialized FeatureList. The steps are only
+// split out for the feature lists that are in the config.
+using FeatureListMapEntry = std::pair<StringPiece, StringPiece>;
+using FeatureLists = std::vector<FeatureListMapEntry>;
+using FeatureList = std::vector<Feature>;
+
 }  // namespace parsed
 
 inline bool SkipExtraneousTag(protobuf::io::CodedInputStream* stream) {
@@ -320,6 +326,68 @@ bool ParseExample(StringPiece serialized, parsed::Example* example) {
   return ParseExample(&stream, example);
 }
 
+bool ParseFeatureListMapEntry(protobuf::io::CodedInputStream* stream,
+                              parsed::FeatureListMapEntry* feature_list_entry) {
+  DCHECK(stream != nullptr);
+  DCHECK(feature_list_entry != nullptr);
+  uint32 length;
+  if (!stream->ReadVarint32(&length)) return false;
+  auto limit = stream->PushLimit(length);
+  if (!stream->ExpectTag(kDelimitedTag(1))) return false;
+  if (!ParseString(stream, &feature_list_entry->first)) return false;
+  if (!stream->ExpectTag(kDelimitedTag(2))) return false;
+  if (!ParseString(stream, &feature_list_entry->second)) return false;
+  if (!stream->ExpectAtEnd()) return false;
+  stream->PopLimit(limit);
+  return true;
+}
+
+// Collects the feature_lists map entries of a serialized SequenceExample.
+// The context is skipped: it has the same wire format as the features of an
+// Example and is parsed by ParseExample.
+bool ParseSequenceExampleFeatureLists(StringPiece serialized,
+                                      parsed::FeatureLists* feature_lists) {
+  DCHECK(feature_lists != nullptr);
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  // Like in ParseExample, concatenated SequenceExample protos are merged.
+  while (!stream.ExpectAtEnd()) {
+    if (!stream.ExpectTag(kDelimitedTag(2))) {
+      if (!SkipExtraneousTag(&stream)) return false;
+      continue;
+    }
+    uint32 length;
+    if (!stream.ReadVarint32(&length)) return false;
+    auto limit = stream.PushLimit(length);
+    while (!stream.ExpectAtEnd()) {
+      parsed::FeatureListMapEntry feature_list_entry;
+      if (!stream.ExpectTag(kDelimitedTag(1))) return false;
+      if (!ParseFeatureListMapEntry(&stream, &feature_list_entry)) {
+        return false;
+      }
+      feature_lists->push_back(feature_list_entry);
+    }
+    stream.PopLimit(limit);
+  }
+  return true;
+}
+
+bool ParseFeatureList(StringPiece serialized,
+                      parsed::FeatureList* feature_list) {
+  DCHECK(feature_list != nullptr);
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  while (!stream.ExpectAtEnd()) {
+    if (!stream.ExpectTag(kDelimitedTag(1))) return false;
+    StringPiece feature;
+    if (!ParseString(&stream, &feature)) return false;
+    feature_list->emplace_back(feature);
+  }
+  return true;
+}
+
 }  // namespace
 
 bool TestFastParse(const string& serialized, Example* example) {
@@ -425,6 +493,8 @@ struct SeededHasher {
   uint64 seed{0xDECAFCAFFE};
 };
 
+using ConfigIndex = PresizedCuckooMap<std::pair<size_t, Type>>;
+
 template <typename T>
 class LimitedArraySlice {
  public:
@@ -450,8 +520,8 @@ class LimitedArraySlice {
 Status FastParseSerializedExample(
     const string& serialized_example, const string& example_name,
     const size_t example_index, const Config& config,
-    const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
-    SeededHasher hasher, std::vector<Tensor>* output_dense,
+    const ConfigIndex& config_index, SeededHasher hasher,
+    std::vector<Tensor>* output_dense,
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse) {
   DCHECK(output_dense != nullptr);
@@ -833,6 +903,61 @@ void FillAndCopyVarLen(
   }
 }
 
+// Indexes the feature names of dense and sparse by their hash, reseeding
+// hasher until there are no collisions.
+template <typename DenseConfig, typename SparseConfig>
+Status BuildConfigIndex(const std::vector<DenseConfig>& dense,
+                        const std::vector<SparseConfig>& sparse,
+                        SeededHasher* hasher, ConfigIndex* config_index) {
+  const size_t config_size = dense.size() + sparse.size();
+  bool ok = true;
+  for (size_t i = 0; i < 1000; ++i) {
+    for (size_t d = 0; d < dense.size(); ++d) {
+      ok &= config_index->InsertUnique((*hasher)(dense[d].feature_name),
+                                       {d, Type::Dense});
+    }
+    for (size_t d = 0; d < sparse.size(); ++d) {
+      ok &= config_index->InsertUnique((*hasher)(sparse[d].feature_name),
+                                       {d, Type::Sparse});
+    }
+    if (ok) break;
+    LOG(WARNING) << "Collision found. This should happen only if you have "
+                    "around 2^32 entries in your config.";
+    hasher->seed++;
+    config_index->Clear(config_size);
+  }
+  if (!ok) {
+    return errors::Internal(
+        "Could not avoid collision. This should not happen.");
+  }
+  return Status::OK();
+}
+
+// Returns the number of minibatches to split serialized into.
+// In main regime make each minibatch around kMiniBatchSizeBytes bytes.
+// Apply 'special logic' below for small and big regimes.
+size_t NumMiniBatches(gtl::ArraySlice<string> serialized) {
+  // This parameter affects performance in a big and data-dependent way.
+  const size_t kMiniBatchSizeBytes = 50000;
+
+  size_t result = 0;
+  size_t minibatch_bytes = 0;
+  for (size_t i = 0; i < serialized.size(); i++) {
+    if (minibatch_bytes == 0) {  // start minibatch
+      result++;
+    }
+    minibatch_bytes += serialized[i].size() + 1;
+    if (minibatch_bytes > kMiniBatchSizeBytes) {
+      minibatch_bytes = 0;
+    }
+  }
+  // 'special logic'
+  const size_t min_minibatches = std::min<size_t>(8, serialized.size());
+  const size_t max_minibatches = 64;
+  return std::max<size_t>(min_minibatches,
+                          std::min<size_t>(max_minibatches, result));
+}
+
 }  // namespace
 
 Status FastParseExample(const Config& config,
@@ -848,30 +973,11 @@ Status FastParseExample(const Config& config,
     TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
   }
 
-  size_t config_size = config.dense.size() + config.sparse.size();
   SeededHasher hasher;
   // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
+  ConfigIndex config_index(config.dense.size() + config.sparse.size());
+  TF_RETURN_IF_ERROR(
+      BuildConfigIndex(config.dense, config.sparse, &hasher, &config_index));
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse have to be buffered).
@@ -886,30 +992,8 @@ Status FastParseExample(const Config& config,
     fixed_dense_values[d] = Tensor(config.dense[d].dtype, out_shape);
   }
 
-  // This parameter affects performance in a big and data-dependent way.
-  const size_t kMiniBatchSizeBytes = 50000;
-
   // Calculate number of minibatches.
-  // In main regime make each minibatch around kMiniBatchSizeBytes bytes.
-  // Apply 'special logic' below for small and big regimes.
-  const size_t num_minibatches = [&] {
-    size_t result = 0;
-    size_t minibatch_bytes = 0;
-    for (size_t i = 0; i < serialized.size(); i++) {
-      if (minibatch_bytes == 0) {  // start minibatch
-        result++;
-      }
-      minibatch_bytes += serialized[i].size() + 1;
-      if (minibatch_bytes > kMiniBatchSizeBytes) {
-        minibatch_bytes = 0;
-      }
-    }
-    // 'special logic'
-    const size_t min_minibatches = std::min<size_t>(8, serialized.size());
-    const size_t max_minibatches = 64;
-    return std::max<size_t>(min_minibatches,
-                            std::min<size_t>(max_minibatches, result));
-  }();
+  const size_t num_minibatches = NumMiniBatches(serialized);
 
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
     return (serialized.size() * minibatch) / num_minibatches;
@@ -1098,5 +1182,459 @@ Status FastParseExample(const Config& config,
   return Status::OK();
 }
 
+// -----------------------------------------------------------------------------
+
+namespace {
+
+using SequenceConfig = FastParseSequenceExampleConfig;
+
+// The steps of the configured feature lists of one SequenceExample, indexed
+// like config.feature_list_dense and config.feature_list_sparse. Missing
+// feature lists have no steps.
+struct ExampleFeatureLists {
+  std::vector<parsed::FeatureList> dense;
+  std::vector<parsed::FeatureList> sparse;
+};
+
+// The name of the Feature.kind field that holds values of dtype.
+StringPiece FeatureKindName(DataType dtype) {
+  switch (dtype) {
+    case DT_INT64:
+      return "int64_list";
+    case DT_FLOAT:
+      return "float_list";
+    case DT_STRING:
+      return "bytes_list";
+    default:
+      return "";  // kind is not set.
+  }
+}
+
+// Finds the feature lists of serialized_example that are in the config and
+// splits them into steps. The values are parsed later, once the outputs of
+// the whole batch are allocated.
+Status ScanSerializedSequenceExample(const string& serialized_example,
+                                     const string& example_name,
+                                     const SequenceConfig& config,
+                                     const ConfigIndex& config_index,
+                                     SeededHasher hasher,
+                                     ExampleFeatureLists* output) {
+  DCHECK(output != nullptr);
+  parsed::FeatureLists feature_lists;
+  if (!ParseSequenceExampleFeatureLists(serialized_example, &feature_lists)) {
+    return errors::InvalidArgument("Could not parse example input, value: '",
+                                   serialized_example, "'");
+  }
+  output->dense.resize(config.feature_list_dense.size());
+  output->sparse.resize(config.feature_list_sparse.size());
+  std::vector<bool> dense_found(config.feature_list_dense.size(), false);
+  std::vector<bool> sparse_found(config.feature_list_sparse.size(), false);
+
+  // This is a logic that standard protobuf parsing is implementing.
+  // I.e. last entry in the map overwrites all the previous ones.
+  for (auto it = feature_lists.rbegin(); it != feature_lists.rend(); ++it) {
+    const StringPiece feature_name = it->first;
+
+    std::pair<size_t, Type> d_and_type;
+    if (!config_index.Find(hasher(feature_name), &d_and_type)) continue;
+
+    const size_t d = d_and_type.first;
+    const bool is_dense = d_and_type.second == Type::Dense;
+
+    {
+      // Testing for PresizedCuckooMap collision.
+      const string& config_feature_name =
+          is_dense ? config.feature_list_dense[d].feature_name
+                   : config.feature_list_sparse[d].feature_name;
+      if (feature_name != config_feature_name) continue;
+    }
+
+    std::vector<bool>& found = is_dense ? dense_found : sparse_found;
+    if (found[d]) continue;
+    found[d] = true;
+
+    parsed::FeatureList* steps =
+        is_dense ? &output->dense[d] : &output->sparse[d];
+    if (!ParseFeatureList(it->second, steps)) {
+      return errors::InvalidArgument(
+          "Name: ", example_name, ", Feature list: ", feature_name,
+          ".  Can't parse serialized SequenceExample.");
+    }
+  }
+
+  for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+    if (dense_found[d] || config.feature_list_dense[d].allow_missing) continue;
+    return errors::InvalidArgument(
+        "Name: ", example_name, ", Feature list '",
+        config.feature_list_dense[d].feature_name,
+        "' is required but could not be found.  Did you mean to include it in "
+        "feature_list_dense_missing_assumed_empty or "
+        "feature_list_dense_defaults?");
+  }
+  return Status::OK();
+}
+
+// Parses the steps found by ScanSerializedSequenceExample. Dense feature
+// lists are written straight into row example_index of output_dense, with the
+// steps after the end of the list padded with zeros. Sparse feature lists are
+// appended to output_sparse, with one example_end_indices entry per step.
+Status FastParseSequenceExampleFeatureLists(
+    const string& example_name, const size_t example_index,
+    const SequenceConfig& config, const std::vector<size_t>& max_steps,
+    ExampleFeatureLists* feature_lists, std::vector<Tensor>* output_dense,
+    std::vector<SparseBuffer>* output_sparse) {
+  DCHECK(feature_lists != nullptr);
+  DCHECK(output_dense != nullptr);
+  DCHECK(output_sparse != nullptr);
+
+  auto step_error = [&](StringPiece feature_name, size_t step,
+                        StringPiece suffix) {
+    return errors::InvalidArgument("Name: ", example_name,
+                                   ", Feature list: ", feature_name,
+                                   ", Index: ", step, ".  ", suffix);
+  };
+
+  auto parse_error = [&](StringPiece feature_name, size_t step) {
+    return step_error(feature_name, step,
+                      "Can't parse serialized SequenceExample.");
+  };
+
+  auto type_error = [&](StringPiece feature_name, size_t step,
+                        DataType expected_dtype, DataType example_dtype) {
+    return step_error(
+        feature_name, step,
+        strings::StrCat("Data types don't match. Expected type: ",
+                        DataTypeString(expected_dtype),
+                        "  Feature is: ", FeatureKindName(example_dtype)));
+  };
+
+  for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+    const SequenceConfig::FeatureListDense& c = config.feature_list_dense[d];
+    parsed::FeatureList& steps = feature_lists->dense[d];
+    Tensor& out = (*output_dense)[d];
+
+    const std::size_t num_elements = c.elements_per_stride;
+    const std::size_t offset = example_index * max_steps[d] * num_elements;
+
+    auto shape_error = [&](size_t step, size_t size, StringPiece type_str) {
+      return errors::InvalidArgument(
+          "Name: ", example_name, ", Key: ", c.feature_name, ", Index: ", step,
+          ".  Number of ", type_str,
+          " values != expected.  "
+          "values size: ",
+          size, " but output shape: ", c.shape.DebugString());
+    };
+
+    for (size_t t = 0; t < steps.size(); ++t) {
+      parsed::Feature& feature = steps[t];
+      DataType example_dtype;
+      TF_RETURN_IF_ERROR(feature.ParseDataType(&example_dtype));
+      if (example_dtype != c.dtype) {
+        return type_error(c.feature_name, t, c.dtype, example_dtype);
+      }
+
+      const std::size_t step_offset = offset + t * num_elements;
+      switch (c.dtype) {
+        case DT_INT64: {
+          auto out_p = out.flat<int64>().data() + step_offset;
+          LimitedArraySlice<int64> slice(out_p, num_elements);
+          if (!feature.ParseInt64List(&slice)) {
+            return parse_error(c.feature_name, t);
+          }
+          if (slice.EndDistance() != 0) {
+            return shape_error(t, num_elements - slice.EndDistance(), "int64");
+          }
+          break;
+        }
+        case DT_FLOAT: {
+          auto out_p = out.flat<float>().data() + step_offset;
+          LimitedArraySlice<float> slice(out_p, num_elements);
+          if (!feature.ParseFloatList(&slice)) {
+            return parse_error(c.feature_name, t);
+          }
+          if (slice.EndDistance() != 0) {
+            return shape_error(t, num_elements - slice.EndDistance(), "float");
+          }
+          break;
+        }
+        case DT_STRING: {
+          auto out_p = out.flat<string>().data() + step_offset;
+          LimitedArraySlice<string> slice(out_p, num_elements);
+          if (!feature.ParseBytesList(&slice)) {
+            return parse_error(c.feature_name, t);
+          }
+          if (slice.EndDistance() != 0) {
+            return shape_error(t, num_elements - slice.EndDistance(), "bytes");
+          }
+          break;
+        }
+        default:
+          CHECK(false) << "Should not happen.";
+      }
+    }
+
+    // Pad the steps after the end of this feature list.
+    const std::size_t pad_begin = offset + steps.size() * num_elements;
+    const std::size_t pad_end = offset + max_steps[d] * num_elements;
+    switch (c.dtype) {
+      case DT_INT64: {
+        auto out_p = out.flat<int64>().data();
+        std::fill(out_p + pad_begin, out_p + pad_end, 0);
+        break;
+      }
+      case DT_FLOAT: {
+        auto out_p = out.flat<float>().data();
+        std::fill(out_p + pad_begin, out_p + pad_end, 0.0f);
+        break;
+      }
+      case DT_STRING: {
+        // Strings are constructed empty.
+        break;
+      }
+      default:
+        CHECK(false) << "Should not happen.";
+    }
+  }
+
+  for (size_t d = 0; d < config.feature_list_sparse.size(); ++d) {
+    const SequenceConfig::FeatureListSparse& c = config.feature_list_sparse[d];
+    parsed::FeatureList& steps = feature_lists->sparse[d];
+    SparseBuffer& out = (*output_sparse)[d];
+
+    for (size_t t = 0; t < steps.size(); ++t) {
+      parsed::Feature& feature = steps[t];
+      DataType example_dtype;
+      TF_RETURN_IF_ERROR(feature.ParseDataType(&example_dtype));
+      if (example_dtype != DT_INVALID && example_dtype != c.dtype) {
+        return type_error(c.feature_name, t, c.dtype, example_dtype);
+      }
+
+      switch (c.dtype) {
+        case DT_INT64: {
+          if (example_dtype != DT_INVALID) {
+            if (!feature.ParseInt64List(&out.int64_list)) {
+              return parse_error(c.feature_name, t);
+            }
+          }
+          out.example_end_indices.push_back(out.int64_list.size());
+          break;
+        }
+        case DT_FLOAT: {
+          if (example_dtype != DT_INVALID) {
+            if (!feature.ParseFloatList(&out.float_list)) {
+              return parse_error(c.feature_name, t);
+            }
+          }
+          out.example_end_indices.push_back(out.float_list.size());
+          break;
+        }
+        case DT_STRING: {
+          if (example_dtype != DT_INVALID) {
+            if (!feature.ParseBytesList(&out.bytes_list)) {
+              return parse_error(c.feature_name, t);
+            }
+          }
+          out.example_end_indices.push_back(out.bytes_list.size());
+          break;
+        }
+        default:
+          CHECK(false) << "Should not happen.";
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+}  // namespace
+
+Status FastParseSequenceExample(const SequenceConfig& config,
+                                gtl::ArraySlice<string> serialized,
+                                gtl::ArraySlice<string> example_names,
+                                thread::ThreadPool* thread_pool,
+                                SequenceResult* result) {
+  DCHECK(result != nullptr);
+  // The context has the same wire format as the features of an Example, and
+  // ParseExample skips the feature lists as unknown fields.
+  TF_RETURN_IF_ERROR(FastParseExample(config.context, serialized,
+                                      example_names, thread_pool,
+                                      &result->context));
+
+  // Check config so we can safely CHECK(false) in switches on config.*.dtype
+  for (auto& c : config.feature_list_sparse) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+  for (auto& c : config.feature_list_dense) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+
+  SeededHasher hasher;
+  // Build config index.
+  ConfigIndex config_index(config.feature_list_dense.size() +
+                           config.feature_list_sparse.size());
+  TF_RETURN_IF_ERROR(BuildConfigIndex(config.feature_list_dense,
+                                      config.feature_list_sparse, &hasher,
+                                      &config_index));
+
+  const size_t batch_size = serialized.size();
+  const size_t num_minibatches = NumMiniBatches(serialized);
+
+  auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
+    return (batch_size * minibatch) / num_minibatches;
+  };
+
+  // Split the feature lists of every example into steps, in parallel.
+  std::vector<ExampleFeatureLists> feature_lists(batch_size);
+  std::vector<Status> status_of_minibatch(num_minibatches);
+  auto ScanMiniBatch = [&](size_t minibatch) {
+    size_t start = first_example_of_minibatch(minibatch);
+    size_t end = first_example_of_minibatch(minibatch + 1);
+    for (size_t e = start; e < end; ++e) {
+      status_of_minibatch[minibatch] = ScanSerializedSequenceExample(
+          serialized[e],
+          (!example_names.empty() ? example_names[e] : "<unknown>"), config,
+          config_index, hasher, &feature_lists[e]);
+      if (!status_of_minibatch[minibatch].ok()) break;
+    }
+  };
+
+  ParallelFor(ScanMiniBatch, num_minibatches, thread_pool);
+
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  // Now that the longest feature lists are known, allocate the dense output.
+  std::vector<size_t> max_steps(config.feature_list_dense.size(), 0);
+  for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+    Tensor lengths(DT_INT64, TensorShape({static_cast<int64>(batch_size)}));
+    auto lengths_t = lengths.vec<int64>();
+    for (size_t e = 0; e < batch_size; ++e) {
+      const size_t num_steps = feature_lists[e].dense[d].size();
+      lengths_t(e) = num_steps;
+      max_steps[d] = std::max(max_steps[d], num_steps);
+    }
+    TensorShape values_shape;
+    values_shape.AddDim(batch_size);
+    values_shape.AddDim(max_steps[d]);
+    values_shape.AppendShape(config.feature_list_dense[d].shape);
+    result->feature_list_dense_values.emplace_back(
+        config.feature_list_dense[d].dtype, values_shape);
+    result->feature_list_dense_lengths.push_back(std::move(lengths));
+  }
+
+  // Parse the steps in parallel.
+  std::vector<std::vector<SparseBuffer>> sparse_buffers(num_minibatches);
+  auto ProcessMiniBatch = [&](size_t minibatch) {
+    sparse_buffers[minibatch].resize(config.feature_list_sparse.size());
+    size_t start = first_example_of_minibatch(minibatch);
+    size_t end = first_example_of_minibatch(minibatch + 1);
+    for (size_t e = start; e < end; ++e) {
+      status_of_minibatch[minibatch] = FastParseSequenceExampleFeatureLists(
+          (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
+          max_steps, &feature_lists[e], &result->feature_list_dense_values,
+          &sparse_buffers[minibatch]);
+      if (!status_of_minibatch[minibatch].ok()) break;
+    }
+  };
+
+  ParallelFor(ProcessMiniBatch, num_minibatches, thread_pool);
+
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  // Merge SparseBuffers from all minibatches for every sparse feature list.
+  for (size_t d = 0; d < config.feature_list_sparse.size(); ++d) {
+    size_t total_num_features = 0;
+    size_t max_num_features = 0;
+    for (auto& sparse_values_tmp : sparse_buffers) {
+      size_t step_begin = 0;
+      for (size_t step_end : sparse_values_tmp[d].example_end_indices) {
+        max_num_features = std::max(max_num_features, step_end - step_begin);
+        step_begin = step_end;
+      }
+      total_num_features += step_begin;
+    }
+    size_t max_num_steps = 0;
+    for (const ExampleFeatureLists& example_feature_lists : feature_lists) {
+      max_num_steps =
+          std::max(max_num_steps, example_feature_lists.sparse[d].size());
+    }
+
+    TensorShape indices_shape;
+    indices_shape.AddDim(total_num_features);
+    indices_shape.AddDim(3);
+    result->feature_list_sparse_indices.emplace_back(DT_INT64, indices_shape);
+    Tensor* indices = &result->feature_list_sparse_indices.back();
+
+    TensorShape values_shape;
+    values_shape.AddDim(total_num_features);
+    result->feature_list_sparse_values.emplace_back(
+        config.feature_list_sparse[d].dtype, values_shape);
+    Tensor* values = &result->feature_list_sparse_values.back();
+
+    result->feature_list_sparse_shapes.emplace_back(DT_INT64,
+                                                    TensorShape({3}));
+    auto shapes_shape_t =
+        result->feature_list_sparse_shapes.back().vec<int64>();
+    shapes_shape_t(0) = batch_size;
+    shapes_shape_t(1) = max_num_steps;
+    shapes_shape_t(2) = max_num_features;
+
+    int64* ix_p = indices->flat<int64>().data();
+    size_t offset = 0;
+    for (size_t i = 0; i < sparse_buffers.size(); ++i) {
+      const SparseBuffer& buffer = sparse_buffers[i][d];
+
+      // Update indices.
+      size_t delta = 0;
+      size_t step_index = 0;
+      size_t start = first_example_of_minibatch(i);
+      size_t end = first_example_of_minibatch(i + 1);
+      for (size_t e = start; e < end; ++e) {
+        const size_t num_steps = feature_lists[e].sparse[d].size();
+        for (size_t t = 0; t < num_steps; ++t, ++step_index) {
+          const size_t step_end = buffer.example_end_indices[step_index];
+          for (size_t feature_index = 0; delta < step_end;
+               ++feature_index, ++delta) {
+            // Columns: example index, step, the feature index in the step.
+            *ix_p = e;
+            *(ix_p + 1) = t;
+            *(ix_p + 2) = feature_index;
+            ix_p += 3;
+          }
+        }
+      }
+      DCHECK_EQ(step_index, buffer.example_end_indices.size());
+
+      // Copy values over.
+      switch (config.feature_list_sparse[d].dtype) {
+        case DT_INT64: {
+          std::copy(buffer.int64_list.begin(), buffer.int64_list.end(),
+                    values->flat<int64>().data() + offset);
+          break;
+        }
+        case DT_FLOAT: {
+          std::copy(buffer.float_list.begin(), buffer.float_list.end(),
+                    values->flat<float>().data() + offset);
+          break;
+        }
+        case DT_STRING: {
+          std::move(buffer.bytes_list.begin(), buffer.bytes_list.end(),
+                    values->flat<string>().data() + offset);
+          break;
+        }
+        default:
+          CHECK(false) << "Should not happen.";
+      }
+
+      offset += delta;
+    }
+  }
+
+  return Status::OK();
+}
+
 }  // namespace example
 }  // namespace tensorflow
@@ -79,6 +79,62 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<string> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
+// FastParseSequenceExampleConfig defines how to parse features in
+// SequenceExample. context is parsed exactly like the features of an Example.
+// Every step of a feature list is a Feature of the config's dtype. Feature
+// lists and context features are looked up independently, so the same
+// feature_name may appear in both.
+struct FastParseSequenceExampleConfig {
+  struct FeatureListDense {
+    string feature_name;
+    DataType dtype;
+    // The shape of a single step.
+    TensorShape shape;
+    std::size_t elements_per_stride;
+    // If false, an example without this feature list is an error.
+    bool allow_missing;
+  };
+
+  struct FeatureListSparse {
+    string feature_name;
+    DataType dtype;
+  };
+
+  FastParseExampleConfig context;
+  std::vector<FeatureListDense> feature_list_dense;
+  std::vector<FeatureListSparse> feature_list_sparse;
+};
+
+// The output of FastParseSequenceExample for a batch of batch_size examples.
+struct SequenceResult {
+  // The context features, exactly as FastParseExample returns them.
+  Result context;
+  // [batch_size, max_steps] + shape tensors, where max_steps is the length of
+  // the longest feature list in the batch. Shorter feature lists are padded
+  // with zeros (empty strings).
+  std::vector<Tensor> feature_list_dense_values;
+  // [batch_size] int64 tensors with the number of steps of every example.
+  std::vector<Tensor> feature_list_dense_lengths;
+  // Sparse tensors with [example, step, index] indices and a
+  // [batch_size, max_steps, max_values_per_step] dense shape.
+  std::vector<Tensor> feature_list_sparse_indices;
+  std::vector<Tensor> feature_list_sparse_values;
+  std::vector<Tensor> feature_list_sparse_shapes;
+};
+
+// Parses a batch of serialized SequenceExample protos and converts them into
+// result according to given config. Like FastParseExample it scans the wire
+// format without building protos and parses minibatches of examples in
+// parallel on thread_pool. Dense feature lists are written directly into the
+// output tensors.
+// Given example names have to either be empty or the same size as serialized.
+// example_names are used only for error messages.
+Status FastParseSequenceExample(const FastParseSequenceExampleConfig& config,
+                                gtl::ArraySlice<string> serialized,
+                                gtl::ArraySlice<string> example_names,
+                                thread::ThreadPool* thread_pool,
+                                SequenceResult* result);
+
 // This function parses serialized Example and populates given example.
 // It uses the same specialized parser as FastParseExample which is efficient.
 // But then constructs Example which is relatively slow.
@@ -16,8 +16,11 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -372,6 +375,174 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+TEST(TestFastParseSequenceExample, Empty) {
+  SequenceResult result;
+  FastParseSequenceExampleConfig config;
+  config.feature_list_dense.push_back(
+      {"dense", DT_FLOAT, TensorShape({2}), 2, false});
+  config.feature_list_sparse.push_back({"sparse", DT_STRING});
+  Status status = FastParseSequenceExample(config, gtl::ArraySlice<string>(),
+                                           gtl::ArraySlice<string>(), nullptr,
+                                           &result);
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(TensorShape({0, 0, 2}),
+            result.feature_list_dense_values[0].shape());
+  EXPECT_EQ(TensorShape({0, 3}),
+            result.feature_list_sparse_indices[0].shape());
+}
+
+// Adds a feature list with one step for each vector in steps.
+void AddInt64FeatureList(const string& key,
+                         const std::vector<std::vector<int64>>& steps,
+                         SequenceExample* example) {
+  auto& feature_list =
+      (*example->mutable_feature_lists()->mutable_feature_list())[key];
+  for (const auto& values : steps) {
+    auto* int64_list = feature_list.add_feature()->mutable_int64_list();
+    for (const int64 value : values) int64_list->add_value(value);
+  }
+}
+
+class FastParseSequenceExampleTest : public ::testing::Test {
+ protected:
+  FastParseSequenceExampleTest() {
+    config_.context.dense.push_back({"context_dense", DT_FLOAT,
+                                     PartialTensorShape({1}),
+                                     Tensor(DT_FLOAT, TensorShape({0})), false,
+                                     1});
+    config_.context.sparse.push_back({"context_sparse", DT_INT64});
+    config_.feature_list_dense.push_back(
+        {"dense", DT_INT64, TensorShape({2}), 2, true});
+    config_.feature_list_sparse.push_back({"sparse", DT_INT64});
+  }
+
+  Status Parse(const std::vector<SequenceExample>& examples,
+               SequenceResult* result) {
+    std::vector<string> serialized;
+    for (const auto& example : examples) {
+      serialized.push_back(Serialize(example));
+    }
+    return FastParseSequenceExample(config_, serialized, {}, &thread_pool_,
+                                    result);
+  }
+
+  FastParseSequenceExampleConfig config_;
+  thread::ThreadPool thread_pool_{Env::Default(), "parse", 2};
+};
+
+TEST_F(FastParseSequenceExampleTest, Batch) {
+  std::vector<SequenceExample> examples(3);
+  for (auto& example : examples) {
+    (*example.mutable_context()->mutable_feature())["context_dense"]
+        .mutable_float_list()
+        ->add_value(examples.size());
+  }
+  (*examples[0].mutable_context()->mutable_feature())["context_sparse"]
+      .mutable_int64_list()
+      ->add_value(7);
+  AddInt64FeatureList("dense", {{1, 2}, {3, 4}}, &examples[0]);
+  AddInt64FeatureList("sparse", {{5}, {}, {6, 7, 8}}, &examples[0]);
+  AddInt64FeatureList("dense", {{5, 6}, {7, 8}, {9, 10}}, &examples[2]);
+  AddInt64FeatureList("sparse", {{9, 10}}, &examples[2]);
+  // The feature list of another name is ignored.
+  AddInt64FeatureList("unused", {{11}}, &examples[1]);
+
+  SequenceResult result;
+  TF_ASSERT_OK(Parse(examples, &result));
+
+  EXPECT_EQ(TensorShape({3, 1}), result.context.dense_values[0].shape());
+  EXPECT_EQ(3.0f, result.context.dense_values[0].matrix<float>()(1, 0));
+  EXPECT_EQ(1, result.context.sparse_values[0].NumElements());
+
+  const Tensor& dense = result.feature_list_dense_values[0];
+  ASSERT_EQ(TensorShape({3, 3, 2}), dense.shape());
+  EXPECT_EQ(std::vector<int64>({1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 0, 5, 6, 7,
+                                8, 9, 10}),
+            std::vector<int64>(dense.flat<int64>().data(),
+                               dense.flat<int64>().data() + 18));
+  const auto lengths = result.feature_list_dense_lengths[0].vec<int64>();
+  EXPECT_EQ(2, lengths(0));
+  EXPECT_EQ(0, lengths(1));
+  EXPECT_EQ(3, lengths(2));
+
+  const auto indices = result.feature_list_sparse_indices[0].matrix<int64>();
+  ASSERT_EQ(6, indices.dimension(0));
+  const std::vector<std::vector<int64>> expected_indices = {
+      {0, 0, 0}, {0, 2, 0}, {0, 2, 1}, {0, 2, 2}, {2, 0, 0}, {2, 0, 1}};
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(expected_indices[i], std::vector<int64>({indices(i, 0),
+                                                       indices(i, 1),
+                                                       indices(i, 2)}));
+  }
+  const auto values = result.feature_list_sparse_values[0].vec<int64>();
+  EXPECT_EQ(std::vector<int64>({5, 6, 7, 8, 9, 10}),
+            std::vector<int64>(values.data(), values.data() + 6));
+  const auto shape = result.feature_list_sparse_shapes[0].vec<int64>();
+  EXPECT_EQ(3, shape(0));
+  EXPECT_EQ(3, shape(1));
+  EXPECT_EQ(3, shape(2));
+}
+
+TEST_F(FastParseSequenceExampleTest, LastFeatureListWins) {
+  std::vector<SequenceExample> examples(2);
+  (*examples[0].mutable_context()->mutable_feature())["context_dense"]
+      .mutable_float_list()
+      ->add_value(1.0f);
+  AddInt64FeatureList("dense", {{1, 2}}, &examples[0]);
+  AddInt64FeatureList("dense", {{3, 4}, {5, 6}}, &examples[1]);
+  // Concatenated protos are merged, and the feature lists of the second one
+  // replace those of the first one.
+  SequenceResult result;
+  TF_ASSERT_OK(FastParseSequenceExample(
+      config_, {Serialize(examples[0]) + Serialize(examples[1])}, {}, nullptr,
+      &result));
+  const Tensor& dense = result.feature_list_dense_values[0];
+  ASSERT_EQ(TensorShape({1, 2, 2}), dense.shape());
+  EXPECT_EQ(3, dense.flat<int64>()(0));
+  EXPECT_EQ(6, dense.flat<int64>()(3));
+}
+
+TEST_F(FastParseSequenceExampleTest, Errors) {
+  SequenceExample example;
+  (*example.mutable_context()->mutable_feature())["context_dense"]
+      .mutable_float_list()
+      ->add_value(1.0f);
+  SequenceResult result;
+
+  // Wrong number of values in a step.
+  AddInt64FeatureList("dense", {{1, 2}, {3}}, &example);
+  Status status = Parse({example}, &result);
+  EXPECT_TRUE(StringPiece(status.error_message())
+                  .contains("Key: dense, Index: 1.  Number of int64 values "
+                            "!= expected.  values size: 1"))
+      << status;
+
+  // Wrong data type in a step.
+  (*example.mutable_feature_lists()->mutable_feature_list())["dense"]
+      .mutable_feature(1)
+      ->mutable_float_list()
+      ->add_value(3.0f);
+  status = Parse({example}, &result);
+  EXPECT_TRUE(StringPiece(status.error_message())
+                  .contains("Feature list: dense, Index: 1.  Data types don't "
+                            "match. Expected type: int64  Feature is: "
+                            "float_list"))
+      << status;
+
+  // Missing required feature list.
+  config_.feature_list_dense[0].allow_missing = false;
+  example.mutable_feature_lists()->clear_feature_list();
+  status = Parse({example}, &result);
+  EXPECT_TRUE(StringPiece(status.error_message())
+                  .contains("Feature list 'dense' is required"))
+      << status;
+
+  // Not a SequenceExample.
+  status = FastParseSequenceExample(config_, {"\x12\x05"}, {}, nullptr,
+                                    &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
 }  // namespace
 
 }  // namespace example
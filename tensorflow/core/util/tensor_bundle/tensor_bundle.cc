@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <set>
 #include <utility>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_shape.pb_text.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -34,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_slice_util.h"
 
@@ -42,7 +47,11 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+
+// The minimum consumer version of the delta bundles, which older readers would
+// otherwise read without their base.
+const int kTensorBundleDeltaMinConsumer = 2;
 
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
@@ -185,8 +194,8 @@ Status WriteStringTensor(const Tensor& val, FileOutputBuffer* out,
   return Status::OK();
 }
 
-// Reads file[offset:offset+size) into destination[0:size).  Each Read() copies
-// at most "buffer_size" bytes.
+// Reads file[offset:offset+size) into destination[0:size), in reads of at
+// most "buffer_size" bytes issued together with ReadMany().
 //
 // REQUIRES: "file" contains at least "offset + size" bytes.
 // REQUIRES: "destination" contains at least "size" bytes.
@@ -196,29 +205,35 @@ Status ReadInputByChunk(const RandomAccessFile* file, size_t offset,
   if (size == 0) return Status::OK();
   CHECK_GT(size, 0);
   CHECK_GT(buffer_size, 0);
-  size_t bytes_read = 0;
-  StringPiece result;
-
-  while (bytes_read < size) {
-    const size_t desired_bytes = std::min(buffer_size, size - bytes_read);
-    Status status = file->Read(offset + bytes_read, desired_bytes, &result,
-                               destination + bytes_read);
-
-    if (!status.ok()) {
-      return status;
-    } else if (result.size() != desired_bytes) {
-      return errors::DataLoss("Requested ", desired_bytes, " bytes but read ",
+
+  // Issues all the chunks at once, so the file can have them in flight
+  // together.
+  std::vector<RandomAccessFile::ReadRequest> requests;
+  requests.reserve((size + buffer_size - 1) / buffer_size);
+  for (size_t start = 0; start < size; start += buffer_size) {
+    RandomAccessFile::ReadRequest request;
+    request.offset = offset + start;
+    request.n = std::min(buffer_size, size - start);
+    request.scratch = destination + start;
+    requests.push_back(request);
+  }
+  file->ReadMany(&requests);
+
+  for (const RandomAccessFile::ReadRequest& request : requests) {
+    const StringPiece& result = request.result;
+    if (!request.status.ok()) {
+      return request.status;
+    } else if (result.size() != request.n) {
+      return errors::DataLoss("Requested ", request.n, " bytes but read ",
                               result.size(), " bytes.");
-    } else if (result.data() == destination + bytes_read) {
+    } else if (result.data() == request.scratch) {
       // Data is already in the correct location.
     } else {
       // memmove is guaranteed to handle overlaps safely (although the src and
       // dst buffers should not overlap for this function).
-      memmove(destination + bytes_read, result.data(), result.size());
+      memmove(request.scratch, result.data(), result.size());
     }
-    bytes_read += result.size();
   }
-  CHECK_EQ(bytes_read, size);
   return Status::OK();
 }
 
@@ -265,10 +280,142 @@ table::Options TableBuilderOptions() {
   return o;
 }
 
+// Appends the data of "val" to shard "shard_id", of which "out" holds the first
+// "*size" bytes, and records its location and checksum in "entry".  Pads the
+// data of non-string tensors to a multiple of "alignment" bytes in the file.
+Status AppendTensor(const Tensor& val, int32 shard_id, int alignment,
+                    FileOutputBuffer* out, int64* size,
+                    BundleEntryProto* entry) {
+  if (val.dtype() != DT_STRING && alignment > 1 && *size % alignment != 0) {
+    const string padding(alignment - *size % alignment, '\0');
+    TF_RETURN_IF_ERROR(out->Append(padding));
+    *size += padding.size();
+  }
+  entry->set_shard_id(shard_id);
+  entry->set_offset(*size);
+
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->clear_crc32c();
+  if (val.dtype() != DT_STRING) {
+    TF_RETURN_IF_ERROR(WriteTensor(val, out, &data_bytes_written));
+    crc32c = out->crc32c();
+  } else {
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, out, &data_bytes_written, &crc32c));
+  }
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return Status::OK();
+}
+
+// Writes "tensors" to the data file "filename" of shard "shard_id", through a
+// temporary file renamed on success.
+Status WriteDataShard(
+    Env* env, const string& filename, int32 shard_id, int alignment,
+    const std::vector<std::pair<BundleEntryProto*, const Tensor*>>& tensors) {
+  const string tmp_path =
+      strings::StrCat(filename, ".tempstate", random::New64());
+  std::unique_ptr<WritableFile> wrapper;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_path, &wrapper));
+  VLOG(1) << "Writing " << tensors.size() << " tensors to file " << tmp_path;
+  FileOutputBuffer out(wrapper.release(), 8 << 20 /* 8MB write buffer */);
+  int64 size = 0;
+  Status status;
+  for (const auto& tensor : tensors) {
+    status = AppendTensor(*tensor.second, shard_id, alignment, &out, &size,
+                          tensor.first);
+    if (!status.ok()) break;
+  }
+  status.Update(out.Close());
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  return env->RenameFile(tmp_path, filename);
+}
+
+// Copies the intersection of the slices "src_slice" and "dst_slice" of a tensor
+// of shape "full_shape" from "src" to "dst", which hold those slices.
+Status CopySliceData(const TensorShape& full_shape,
+                     const TensorSlice& src_slice, const TensorSlice& dst_slice,
+                     const Tensor& src, Tensor* dst) {
+  switch (src.dtype()) {
+#define HANDLE_COPY(T)                                                    \
+  case DataTypeToEnum<T>::value:                                          \
+    CHECK(CopyDataFromTensorSliceToTensorSlice(                           \
+        full_shape, src_slice, dst_slice, src.flat<T>().data(),           \
+        dst->flat<T>().data()));                                          \
+    break;
+
+    HANDLE_COPY(float)
+    HANDLE_COPY(double)
+    HANDLE_COPY(int32)
+    HANDLE_COPY(uint8)
+    HANDLE_COPY(int16)
+    HANDLE_COPY(int8)
+    HANDLE_COPY(complex64)
+    HANDLE_COPY(complex128)
+    HANDLE_COPY(int64)
+    HANDLE_COPY(bool)
+    HANDLE_COPY(qint32)
+    HANDLE_COPY(quint8)
+    HANDLE_COPY(qint8)
+    default:
+      return errors::InvalidArgument("Dtype ", DataTypeString(src.dtype()),
+                                     " not supported.");
+  }
+#undef HANDLE_COPY
+  return Status::OK();
+}
+
+// Returns a DataLoss error unless "actual_crc32c" matches the stored checksum
+// of "entry".
+Status VerifyChecksum(const BundleEntryProto& entry, uint32 actual_crc32c) {
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  return Status::OK();
+}
+
+// Allocates the buffer of one tensor at a given address of a mapped data file,
+// which it keeps mapped until the tensor is deallocated.
+class MappedTensorAllocator : public Allocator {
+ public:
+  MappedTensorAllocator(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        const char* data)
+      : region_(std::move(region)), data_(data) {}
+
+  string Name() override { return "MappedTensorAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    DCHECK_EQ(reinterpret_cast<intptr_t>(data_) % alignment, 0);
+    DCHECK_LE(data_ + num_bytes,
+              static_cast<const char*>(region_->data()) + region_->length());
+    return const_cast<char*>(data_);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    DCHECK_EQ(ptr, data_);
+    delete this;
+  }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorAllocator);
+};
+
 }  // namespace
 
-BundleWriter::BundleWriter(Env* env, StringPiece prefix)
+BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     : env_(env),
+      options_(options),
       prefix_(prefix.ToString()),
       tmp_metadata_path_(strings::StrCat(MetaFilename(prefix_), ".tempstate",
                                          random::New64())),
@@ -280,7 +427,10 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix)
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
-  const string filename = DataFilename(prefix_, 0, 1);
+  status_ = Status::OK();
+  // The data files of a sharded write are created by Finish(), once their
+  // number is known.
+  if (options_.num_shards > 1) return;
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(tmp_data_path_, &wrapper);
   if (!status_.ok()) return;
@@ -302,25 +452,14 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
-
-  // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->clear_crc32c();
-  if (val.dtype() != DT_STRING) {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
-  } else {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
+  if (options_.num_shards > 1) {
+    pending_.emplace_back(key_string, val);
+    return status_;
   }
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-  }
+  // Updates the data file.
+  status_ = AppendTensor(val, 0, options_.data_alignment, out_.get(), &size_,
+                         entry);
   return status_;
 }
 
@@ -367,7 +506,59 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
 
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
+Status BundleWriter::WriteShards(int* num_shards) {
+  // Every data file holds at least one tensor, as MergeBundles() expects.
+  *num_shards = std::max<int>(
+      1, std::min<int64>(options_.num_shards, pending_.size()));
+
+  // Assigns the largest tensors first, each to the shard with the fewest bytes.
+  std::vector<const std::pair<string, Tensor>*> by_size;
+  for (const auto& p : pending_) by_size.push_back(&p);
+  std::stable_sort(by_size.begin(), by_size.end(),
+                   [](const std::pair<string, Tensor>* a,
+                      const std::pair<string, Tensor>* b) {
+                     return a->second.TotalBytes() > b->second.TotalBytes();
+                   });
+  std::vector<std::vector<const std::pair<string, Tensor>*>> shards(
+      *num_shards);
+  std::vector<int64> shard_bytes(*num_shards, 0);
+  for (const auto* p : by_size) {
+    const int shard = std::min_element(shard_bytes.begin(), shard_bytes.end()) -
+                      shard_bytes.begin();
+    shards[shard].push_back(p);
+    // Counts a tensor as at least one byte, so that empty ones are spread too.
+    shard_bytes[shard] += std::max<int64>(1, p->second.TotalBytes());
+  }
+
+  std::vector<Status> statuses(*num_shards);
+  {
+    thread::ThreadPool pool(env_, "bundle_writer", *num_shards);
+    for (int i = 0; i < *num_shards; ++i) {
+      // Writes each shard in key order, the order in which they are read.
+      std::sort(shards[i].begin(), shards[i].end(),
+                [](const std::pair<string, Tensor>* a,
+                   const std::pair<string, Tensor>* b) {
+                  return a->first < b->first;
+                });
+      std::vector<std::pair<BundleEntryProto*, const Tensor*>> tensors;
+      for (const auto* p : shards[i]) {
+        tensors.emplace_back(&entries_[p->first], &p->second);
+      }
+      const string filename = DataFilename(prefix_, i, *num_shards);
+      pool.Schedule([this, i, filename, tensors, &statuses]() {
+        statuses[i] = WriteDataShard(env_, filename, i,
+                                     options_.data_alignment, tensors);
+      });
+    }
+  }
+  pending_.clear();
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  return status;
+}
+
 Status BundleWriter::Finish() {
+  int num_shards = 1;
   if (out_) {
     status_.Update(out_->Close());
     out_ = nullptr;
@@ -377,6 +568,8 @@ Status BundleWriter::Finish() {
     } else {
       Env::Default()->DeleteFile(tmp_data_path_).IgnoreError();
     }
+  } else if (status_.ok() && options_.num_shards > 1) {
+    status_ = WriteShards(&num_shards);
   }
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
@@ -391,12 +584,16 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    if (!options_.base_prefix.empty()) {
+      header.set_base_prefix(options_.base_prefix);
+      version->set_min_consumer(kTensorBundleDeltaMinConsumer);
+    }
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -432,6 +629,8 @@ struct MergeState {
   bool seen_first_bundle = false;
   BundleHeaderProto_Endianness endianness;
   VersionDef version;
+  // The bundles of a merge are either all deltas over the same base, or none.
+  string base_prefix;
 
   // Tensor key -> BundleEntryProto.
   std::map<string, BundleEntryProto> entries;
@@ -473,6 +672,7 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
       merge_state->version = header.version();
+      merge_state->base_prefix = header.base_prefix();
     } else {
       // Validates "endianness".
       if (merge_state->endianness != header.endianness()) {
@@ -488,6 +688,11 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
             "Merging bundles with different format versions: merged ",
             merge_version, " vs. curr ", curr_version);
       }
+      if (merge_state->base_prefix != header.base_prefix()) {
+        return errors::InvalidArgument(
+            "Merging bundles with different bases: merged ",
+            merge_state->base_prefix, " vs. curr ", header.base_prefix());
+      }
     }
     num_shards = header.num_shards();
     iter->Next();
@@ -571,6 +776,7 @@ Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
+    header.set_base_prefix(merge.base_prefix);
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
     for (const auto& p : merge.entries) {
@@ -589,10 +795,63 @@ Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
   return status;
 }
 
+Status CompactBundle(Env* env, StringPiece prefix,
+                     StringPiece compacted_prefix) {
+  // The keys of the tensors of the bundle and its bases, without the keys of
+  // the stored slices.
+  std::set<string> keys;
+  string bundle_prefix = prefix.ToString();
+  while (!bundle_prefix.empty()) {
+    BundleReader reader(env, bundle_prefix);
+    TF_RETURN_IF_ERROR(reader.status());
+    for (reader.Seek(kHeaderEntryKey), reader.Next(); reader.Valid();
+         reader.Next()) {
+      const string key = reader.key().ToString();
+      string name;
+      TensorSlice slice;
+      if (!checkpoint::DecodeTensorNameSlice(key, &name, &slice).ok()) {
+        keys.insert(key);
+      }
+    }
+    bundle_prefix = reader.base_prefix();
+  }
+
+  BundleReader reader(env, prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  BundleWriter writer(env, compacted_prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const string& key : keys) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(key, &dtype, &shape));
+    std::vector<TensorSlice> slices;
+    TF_RETURN_IF_ERROR(reader.LookupTensorSlices(key, &slices));
+    if (slices.empty()) {
+      Tensor val(dtype, shape);
+      TF_RETURN_IF_ERROR(reader.Lookup(key, &val));
+      TF_RETURN_IF_ERROR(writer.Add(key, val));
+      continue;
+    }
+    for (const TensorSlice& slice : slices) {
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &slice_shape));
+      Tensor val(dtype, slice_shape);
+      TF_RETURN_IF_ERROR(reader.LookupSlice(key, slice, &val));
+      TF_RETURN_IF_ERROR(writer.AddSlice(key, shape, slice, val));
+    }
+  }
+  return writer.Finish();
+}
+
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+BundleReader::BundleReader(Env* env, StringPiece prefix, const Options& options)
+    : BundleReader(env, prefix, options, nullptr) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix, const Options& options,
+                           std::set<string>* delta_prefixes)
     : env_(env),
+      options_(options),
       prefix_(prefix.ToString()),
       metadata_(nullptr),
       table_(nullptr),
@@ -634,6 +893,22 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok() || header.base_prefix().empty()) return;
+
+  base_prefix_ = header.base_prefix();
+  // The prefixes of this bundle and of the deltas based on it, which must not
+  // be bases of this bundle.
+  std::set<string> prefixes;
+  if (delta_prefixes == nullptr) delta_prefixes = &prefixes;
+  delta_prefixes->insert(prefix_);
+  if (delta_prefixes->count(base_prefix_) > 0) {
+    status_ = CorruptFileError(
+        errors::DataLoss("Bundle ", base_prefix_, " is its own base"),
+        filename, "cycle of base prefixes");
+    return;
+  }
+  base_.reset(new BundleReader(env_, base_prefix_, options_, delta_prefixes));
+  status_ = base_->status();
 }
 
 BundleReader::~BundleReader() {
@@ -700,42 +975,19 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file =
-        new io::InputBuffer(file.release(), 256 << 10 /* 256KB buffer */);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
-
-  TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
-  uint32 actual_crc32c = 0;
+  TF_RETURN_IF_ERROR(OpenShard(entry.shard_id()));
   if (DataTypeCanUseMemcpy(entry.dtype())) {
-    // Important: ReadInputByChunk() bounds the readahead as min(buffer, actual
-    // bytes needed).  This is critical when reading small tensors, so we don't
-    // rely on io::InputBuffer's blind buffering here.
-    char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
-    TF_RETURN_IF_ERROR(ReadInputByChunk(buffered_file->file(), entry.offset(),
-                                        entry.size(), 8 << 20 /* 8MB buffer */,
-                                        backing_buffer));
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    TF_RETURN_IF_ERROR(ReadNumericValue(entry, ret));
   } else {
     // Relies on io::InputBuffer's buffering, because we issue many neighboring
     // reads for a single string tensor.
+    io::InputBuffer* buffered_file = data_[entry.shard_id()];
+    TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
+    uint32 actual_crc32c = 0;
     TF_RETURN_IF_ERROR(ReadStringTensor(
         buffered_file, ret->NumElements(), entry.offset(), entry.size(),
         GetStringBackingBuffer(*ret), &actual_crc32c));
-  }
-  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
-    return errors::DataLoss(
-        "Checksum does not match: stored ",
-        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
-        " vs. calculated on the restored bytes ", actual_crc32c);
+    TF_RETURN_IF_ERROR(VerifyChecksum(entry, actual_crc32c));
   }
 
   *val = *ret;
@@ -743,25 +995,164 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return Status::OK();
 }
 
+Status BundleReader::OpenShard(int32 shard_id) {
+  if (data_[shard_id] == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_[shard_id] =
+        new io::InputBuffer(file.release(), 256 << 10 /* 256KB buffer */);
+  }
+  if (options_.use_mmap && regions_[shard_id] == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, shard_id, num_shards_), &region));
+    regions_[shard_id] = std::move(region);
+  }
+  return Status::OK();
+}
+
+Status BundleReader::ReadNumericValue(const BundleEntryProto& entry,
+                                      Tensor* val) const {
+  char* backing_buffer = const_cast<char*>((val->tensor_data().data()));
+  if (options_.use_mmap) {
+    const std::shared_ptr<ReadOnlyMemoryRegion>& region =
+        regions_.at(entry.shard_id());
+    if (entry.offset() + entry.size() > region->length()) {
+      return errors::DataLoss("Requested ", entry.size(), " bytes at offset ",
+                              entry.offset(), " but the data file has ",
+                              region->length(), " bytes.");
+    }
+    const char* data =
+        static_cast<const char*>(region->data()) + entry.offset();
+    TF_RETURN_IF_ERROR(
+        VerifyChecksum(entry, crc32c::Value(data, entry.size())));
+    const bool aligned =
+        reinterpret_cast<intptr_t>(data) % Allocator::kAllocatorAlignment == 0;
+    if (entry.size() > 0 && aligned) {
+      *val = Tensor(new MappedTensorAllocator(region, data), entry.dtype(),
+                    val->shape());
+    } else {
+      memcpy(backing_buffer, data, entry.size());
+    }
+    return Status::OK();
+  }
+
+  // Important: ReadInputByChunk() bounds the readahead as min(buffer, actual
+  // bytes needed).  This is critical when reading small tensors, so we don't
+  // rely on io::InputBuffer's blind buffering here.
+  TF_RETURN_IF_ERROR(ReadInputByChunk(data_.at(entry.shard_id())->file(),
+                                      entry.offset(), entry.size(),
+                                      8 << 20 /* 8MB buffer */,
+                                      backing_buffer));
+  return VerifyChecksum(entry, crc32c::Value(backing_buffer, entry.size()));
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status status = GetBundleEntryProto(key, &entry);
+  if (base_ != nullptr && errors::IsNotFound(status)) {
+    return base_->Lookup(key, val);
+  }
+  TF_RETURN_IF_ERROR(status);
 
   if (entry.slices().empty()) {
     return GetValue(entry, val);
-  } else {
-    return GetSliceValue(
-        key, entry,
-        /* a full slice */ TensorSlice(TensorShape(entry.shape()).dims()), val);
   }
+  const TensorSlice full_slice(TensorShape(entry.shape()).dims());
+  if (base_ != nullptr) {
+    return GetDeltaSliceValue(key, entry, full_slice, val);
+  }
+  return GetSliceValue(key, entry, full_slice, val);
+}
+
+Status BundleReader::LookupMany(gtl::ArraySlice<string> keys,
+                                gtl::ArraySlice<Tensor*> vals) {
+  CHECK_EQ(keys.size(), vals.size());
+  // Looks up the entries and opens their data files first, so that the reads
+  // only share the data files.
+  std::vector<std::pair<BundleEntryProto, Tensor*>> reads;
+  std::vector<string> base_keys;
+  std::vector<Tensor*> base_vals;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    BundleEntryProto entry;
+    Status status = GetBundleEntryProto(keys[i], &entry);
+    if (base_ != nullptr && errors::IsNotFound(status)) {
+      base_keys.push_back(keys[i]);
+      base_vals.push_back(vals[i]);
+      continue;
+    }
+    TF_RETURN_IF_ERROR(status);
+    if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype())) {
+      TF_RETURN_IF_ERROR(Lookup(keys[i], vals[i]));
+      continue;
+    }
+    if (vals[i]->NumElements() == 0) {
+      *vals[i] = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
+    if (entry.size() != vals[i]->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", vals[i]->TotalBytes());
+    }
+    TF_RETURN_IF_ERROR(OpenShard(entry.shard_id()));
+    reads.emplace_back(entry, vals[i]);
+  }
+  if (!base_keys.empty()) {
+    TF_RETURN_IF_ERROR(base_->LookupMany(base_keys, base_vals));
+  }
+  if (reads.empty()) return Status::OK();
+
+  // Starts with the largest reads, which each thread takes in turn.
+  std::sort(reads.begin(), reads.end(),
+            [](const std::pair<BundleEntryProto, Tensor*>& a,
+               const std::pair<BundleEntryProto, Tensor*>& b) {
+              return a.first.size() > b.first.size();
+            });
+  const int kMaxReadThreads = 16;
+  int num_threads = std::min(kMaxReadThreads, port::NumSchedulableCPUs());
+  num_threads = std::max(1, std::min<int>(num_threads, reads.size()));
+  mutex mu;
+  size_t next_read = 0;
+  Status status;
+  {
+    thread::ThreadPool pool(env_, "bundle_reader", num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([this, &reads, &mu, &next_read, &status]() {
+        while (true) {
+          size_t i;
+          {
+            mutex_lock l(mu);
+            if (next_read == reads.size() || !status.ok()) return;
+            i = next_read++;
+          }
+          Status s = ReadNumericValue(reads[i].first, reads[i].second);
+          if (!s.ok()) {
+            mutex_lock l(mu);
+            status.Update(s);
+          }
+        }
+      });
+    }
+  }
+  return status;
 }
 
 Status BundleReader::LookupTensorSlices(StringPiece key,
                                         std::vector<TensorSlice>* slices) {
   slices->clear();
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status status = GetBundleEntryProto(key, &entry);
+  // The slices of a delta are replacements, those of the base partition the
+  // tensor.
+  if (base_ != nullptr && (errors::IsNotFound(status) ||
+                           (status.ok() && !entry.slices().empty()))) {
+    return base_->LookupTensorSlices(key, slices);
+  }
+  TF_RETURN_IF_ERROR(status);
   slices->reserve(entry.slices_size());
   for (const auto& slice : entry.slices()) {
     slices->emplace_back(slice);
@@ -773,10 +1164,55 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
                                  const TensorSlice& slice_spec, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(full_tensor_key, &entry));
+  Status status = GetBundleEntryProto(full_tensor_key, &entry);
+  if (base_ != nullptr && errors::IsNotFound(status)) {
+    return base_->LookupSlice(full_tensor_key, slice_spec, val);
+  }
+  TF_RETURN_IF_ERROR(status);
+  if (base_ != nullptr && !entry.slices().empty()) {
+    return GetDeltaSliceValue(full_tensor_key, entry, slice_spec, val);
+  }
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
+Status BundleReader::GetDeltaSliceValue(StringPiece full_tensor_key,
+                                        const BundleEntryProto& delta_entry,
+                                        const TensorSlice& slice_spec,
+                                        Tensor* val) {
+  DCHECK(base_ != nullptr);
+  DCHECK_GT(delta_entry.slices_size(), 0);
+  const TensorShape full_shape(delta_entry.shape());
+  DataType base_dtype;
+  TensorShape base_shape;
+  TF_RETURN_IF_ERROR(
+      base_->LookupDtypeAndShape(full_tensor_key, &base_dtype, &base_shape));
+  if (base_dtype != delta_entry.dtype() || base_shape != full_shape) {
+    return errors::InvalidArgument(
+        "Tensor ", full_tensor_key, " of the delta bundle ", prefix_, " is ",
+        DataTypeString(delta_entry.dtype()), " ", full_shape.DebugString(),
+        " but ", DataTypeString(base_dtype), " ", base_shape.DebugString(),
+        " in its base");
+  }
+  TF_RETURN_IF_ERROR(base_->LookupSlice(full_tensor_key, slice_spec, val));
+
+  // Replaces the intersections with the stored slices of the delta.
+  const string full_tensor_key_string = full_tensor_key.ToString();
+  for (const TensorSliceProto& slice_proto : delta_entry.slices()) {
+    const TensorSlice stored_slice(slice_proto);
+    if (!stored_slice.Intersect(slice_spec, nullptr)) continue;
+    BundleEntryProto stored_slice_entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(
+        checkpoint::EncodeTensorNameSlice(full_tensor_key_string, stored_slice),
+        &stored_slice_entry));
+    Tensor stored_slice_tensor(stored_slice_entry.dtype(),
+                               TensorShape(stored_slice_entry.shape()));
+    TF_RETURN_IF_ERROR(GetValue(stored_slice_entry, &stored_slice_tensor));
+    TF_RETURN_IF_ERROR(CopySliceData(full_shape, stored_slice, slice_spec,
+                                     stored_slice_tensor, val));
+  }
+  return Status::OK();
+}
+
 Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
                                    const BundleEntryProto& full_tensor_entry,
                                    const TensorSlice& slice_spec, Tensor* val) {
@@ -860,46 +1296,26 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
     if (!status_.ok()) return status_;
 
     // Copies the intersection over.
-    const DataType common_dtype = full_tensor_entry.dtype();
-    switch (common_dtype) {
-#define HANDLE_COPY(T)                                                 \
-  case DataTypeToEnum<T>::value:                                       \
-    CHECK(CopyDataFromTensorSliceToTensorSlice(                        \
-        full_shape, stored_slice, slice_spec,                          \
-        stored_slice_tensor.flat<T>().data(), val->flat<T>().data())); \
-    break;
-
-      HANDLE_COPY(float)
-      HANDLE_COPY(double)
-      HANDLE_COPY(int32)
-      HANDLE_COPY(uint8)
-      HANDLE_COPY(int16)
-      HANDLE_COPY(int8)
-      HANDLE_COPY(complex64)
-      HANDLE_COPY(complex128)
-      HANDLE_COPY(int64)
-      HANDLE_COPY(bool)
-      HANDLE_COPY(qint32)
-      HANDLE_COPY(quint8)
-      HANDLE_COPY(qint8)
-      default:
-        return errors::InvalidArgument("Dtype ", DataTypeString(common_dtype),
-                                       " not supported.");
-    }
-#undef HANDLE_COPY
+    TF_RETURN_IF_ERROR(CopySliceData(full_shape, stored_slice, slice_spec,
+                                     stored_slice_tensor, val));
   }
   return Status::OK();
 }
 
 bool BundleReader::Contains(StringPiece key) {
   Seek(key);
-  return Valid() && (this->key() == key);
+  if (Valid() && (this->key() == key)) return true;
+  return base_ != nullptr && base_->Contains(key);
 }
 
 Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
                                          TensorShape* shape) {
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status status = GetBundleEntryProto(key, &entry);
+  if (base_ != nullptr && errors::IsNotFound(status)) {
+    return base_->LookupDtypeAndShape(key, dtype, shape);
+  }
+  TF_RETURN_IF_ERROR(status);
   *dtype = entry.dtype();
   *shape = TensorShape(entry.shape());
   return Status::OK();
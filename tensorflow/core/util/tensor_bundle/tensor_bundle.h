@@ -57,6 +57,12 @@ limitations under the License.
 //        "/fs/model/train/ckpt-step/tmp/worker1-step"},
 //       "/fs/model/train/ckpt-step/ckpt" /* merged prefix */);
 //
+// A bundle can also be a delta over a base bundle, written with
+// BundleWriter::Options::base_prefix, that only holds the tensors or the
+// slices of tensors that changed since the base.  BundleReader composes the
+// base and the deltas on lookup, and CompactBundle() writes them back into a
+// single bundle.
+//
 
 #ifndef TENSORFLOW_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 #define TENSORFLOW_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
@@ -64,8 +70,12 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -91,6 +101,8 @@ class FileOutputBuffer;
 // History:
 // 0. Any tensor bundles produced before this field was added.
 // 1. Added this field (2016-09-14).
+// 2. Added BundleHeaderProto.base_prefix, for the delta bundles, which require
+//    this version.
 extern const int kTensorBundleMinProducer;
 extern const int kTensorBundleMinConsumer;
 extern const int kTensorBundleVersion;
@@ -107,7 +119,24 @@ extern const char* const kHeaderEntryKey;
 // All threads accessing the same BundleWriter must synchronize.
 class BundleWriter {
  public:
-  BundleWriter(Env* env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // The maximum number of data files the tensors are split among.  With more
+    // than one, Add() only records the tensors, and Finish() writes the data
+    // files concurrently, balancing their sizes.  The added tensors must then
+    // not be modified before Finish() returns.
+    int num_shards = 1;
+    // The alignment in bytes of the data of the non-string tensors in the data
+    // files, which lets BundleReader::Options::use_mmap alias the tensors with
+    // an alignment of at least Allocator::kAllocatorAlignment.
+    int data_alignment = 1;
+    // If non-empty, the bundle is a delta over the bundle of this prefix.  The
+    // slices added with AddSlice() then replace those of the base tensors, e.g.
+    // the rows of an embedding updated since the base was written.
+    string base_prefix;
+  };
+  BundleWriter(Env* env, StringPiece prefix,
+               const Options& options = Options());
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
@@ -139,13 +168,20 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // Writes the tensors in pending_ to data files written concurrently, and
+  // returns the number of data files in *num_shards.
+  Status WriteShards(int* num_shards);
+
   Env* const env_;  // Not owned.
+  const Options options_;
   const string prefix_;
   const string tmp_metadata_path_;
   const string tmp_data_path_;
   std::unique_ptr<FileOutputBuffer> out_;
   int64 size_;  // Number of bytes written into out_.
   std::map<string, BundleEntryProto> entries_;
+  // With options_.num_shards > 1, the keys and tensors to write in Finish().
+  std::vector<std::pair<string, Tensor>> pending_;
   Status status_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
@@ -167,19 +203,41 @@ class BundleWriter {
 Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
                     StringPiece merged_prefix);
 
+// Writes the tensors of the bundle "prefix", composed with its base bundles if
+// it is a delta, to the bundle "compacted_prefix", which has no base.  The
+// partitioned tensors keep their slices.
+Status CompactBundle(Env* env, StringPiece prefix,
+                     StringPiece compacted_prefix);
+
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // Whether to map the data files in memory rather than reading them.  The
+    // non-string tensors whose data is suitably aligned in the files then
+    // alias the read-only mapping instead of being copied, so they must not be
+    // modified.  Only for local files, e.g. to load a model for inference.
+    bool use_mmap = false;
+  };
+
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
   // the metadata).
   Status status() const { return status_; }
 
+  // The prefix of the base bundle if this bundle is a delta, or the empty
+  // string.  The lookups of a delta bundle return the tensors composed with
+  // the base bundle, which must then be readable.  The iteration functions
+  // Seek(), Next(), etc., only visit the entries of this bundle.
+  const string& base_prefix() const { return base_prefix_; }
+
   // Queries whether the bundle contains an entry keyed by "key".  Calls Seek()
   // internally, so this call invalidates the reader's current position.
   // REQUIRES: status().ok()
@@ -210,6 +268,14 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensors keyed by "keys" into "vals", which follow the comment
+  // of "Lookup()".  The non-string tensors that are not partitioned are read
+  // concurrently, which is faster than successive calls to "Lookup()" for many
+  // or large tensors.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(gtl::ArraySlice<string> keys,
+                    gtl::ArraySlice<Tensor*> vals) TF_MUST_USE_RESULT;
+
   // Looks up the slices of the tensor keyed by "key".  On OK, "slices"
   // is non-empty if and only if the tensor is a partitioned tensor.
   //
@@ -247,6 +313,12 @@ class BundleReader {
   string DebugString();
 
  private:
+  // Opens the bundle at "prefix", which is the base of the chain of deltas
+  // "delta_prefixes" if it is non-null. Fails with DataLoss if the base of
+  // the bundle is on the chain.
+  BundleReader(Env* const env, StringPiece prefix, const Options& options,
+               std::set<string>* delta_prefixes);
+
   // Seeks for "key" and reads the metadata proto.
   // On non-OK return, clears "entry" for the caller.
   // REQUIRES: status().ok()
@@ -258,6 +330,15 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Opens the data file of shard "shard_id" if it has not been opened.
+  Status OpenShard(int32 shard_id) TF_MUST_USE_RESULT;
+
+  // Reads the non-string tensor value described by "entry" into "val", which
+  // has the stored dtype and shape.  Safe to call concurrently.
+  // REQUIRES: OpenShard(entry.shard_id()) returned OK
+  Status ReadNumericValue(const BundleEntryProto& entry,
+                          Tensor* val) const TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -266,7 +347,17 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads the slice described by "slice_spec" of the tensor of the base bundle
+  // with the slices stored in this delta bundle for "full_tensor_key", as
+  // described by "delta_entry".
+  // REQUIRES: base_ != nullptr && delta_entry.slices_size() > 0
+  Status GetDeltaSliceValue(StringPiece full_tensor_key,
+                            const BundleEntryProto& delta_entry,
+                            const TensorSlice& slice_spec,
+                            Tensor* val) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
+  const Options options_;
   const string prefix_;
 
   Status status_;
@@ -275,6 +366,9 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // With options_.use_mmap, the mapped data files, shared with the tensors that
+  // alias them.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>> regions_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -284,6 +378,10 @@ class BundleReader {
   // the header entry in the metadata table.
   int num_shards_;
 
+  // For a delta bundle, the prefix of and the reader for the base bundle.
+  string base_prefix_;
+  std::unique_ptr<BundleReader> base_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
 };
 
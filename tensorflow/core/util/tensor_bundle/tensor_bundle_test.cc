@@ -413,6 +413,221 @@ TEST(TensorBundleTest, StringTensors) {
   }
 }
 
+TEST(TensorBundleTest, ShardedWrite) {
+  Env* env = Env::Default();
+  BundleWriter::Options options;
+  options.num_shards = 3;
+  {
+    BundleWriter writer(env, Prefix("sharded"), options);
+    TF_ASSERT_OK(writer.status());
+    TF_EXPECT_OK(writer.Add("big", Constant<float>(1.5, TensorShape({1000}))));
+    TF_EXPECT_OK(writer.Add("strs", test::AsTensor<string>({"hello", "x01"})));
+    for (int i = 0; i < 4; ++i) {
+      TF_EXPECT_OK(
+          writer.Add(strings::StrCat("small", i), Constant_2x3<int>(i)));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("sharded"), i, 3)));
+  }
+  {
+    BundleReader reader(env, Prefix("sharded"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ(AllTensorKeys(&reader),
+              std::vector<string>({"big", "small0", "small1", "small2",
+                                   "small3", "strs"}));
+    Expect<float>(&reader, "big", Constant<float>(1.5, TensorShape({1000})));
+    Expect<string>(&reader, "strs", test::AsTensor<string>({"hello", "x01"}));
+    for (int i = 0; i < 4; ++i) {
+      Expect<int>(&reader, strings::StrCat("small", i), Constant_2x3<int>(i));
+    }
+  }
+
+  // With fewer tensors than shards, no data file is empty.
+  {
+    BundleWriter writer(env, Prefix("few"), options);
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("few"), 0, 2)));
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("few"), 1, 2)));
+
+  // Sharded bundles merge like the others.
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("sharded"), Prefix("few")},
+                            Prefix("merged_sharded")));
+  {
+    BundleReader reader(env, Prefix("merged_sharded"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ(8, AllTensorKeys(&reader).size());
+    Expect<float>(&reader, "a", Constant_2x3<float>(1.));
+    Expect<float>(&reader, "b", Constant_2x3<float>(2.));
+    Expect<float>(&reader, "big", Constant<float>(1.5, TensorShape({1000})));
+    Expect<int>(&reader, "small3", Constant_2x3<int>(3));
+  }
+}
+
+TEST(TensorBundleTest, LookupMany) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("many"));
+    TF_EXPECT_OK(writer.Add("big", Constant<float>(1.5, TensorShape({1000}))));
+    TF_EXPECT_OK(writer.Add("strs", test::AsTensor<string>({"hello", "x01"})));
+    for (int i = 0; i < 10; ++i) {
+      TF_EXPECT_OK(
+          writer.Add(strings::StrCat("small", i), Constant_2x3<int>(i)));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("many"));
+  TF_ASSERT_OK(reader.status());
+  std::vector<string> keys = {"strs", "big"};
+  std::vector<Tensor> vals = {Tensor(DT_STRING, TensorShape({2})),
+                              Tensor(DT_FLOAT, TensorShape({1000}))};
+  for (int i = 0; i < 10; ++i) {
+    keys.push_back(strings::StrCat("small", i));
+    vals.emplace_back(DT_INT32, TensorShape({2, 3}));
+  }
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+  TF_ASSERT_OK(reader.LookupMany(keys, val_ptrs));
+  test::ExpectTensorEqual<string>(test::AsTensor<string>({"hello", "x01"}),
+                                  vals[0]);
+  test::ExpectTensorEqual<float>(Constant<float>(1.5, TensorShape({1000})),
+                                 vals[1]);
+  for (int i = 0; i < 10; ++i) {
+    test::ExpectTensorEqual<int>(Constant_2x3<int>(i), vals[i + 2]);
+  }
+
+  Tensor missing(DT_FLOAT, TensorShape({2, 3}));
+  EXPECT_TRUE(errors::IsNotFound(
+      reader.LookupMany({"big", "missing"}, {&vals[1], &missing})));
+}
+
+TEST(TensorBundleTest, Mmap) {
+  for (int alignment : {1, 64}) {
+    const string prefix = Prefix(strings::StrCat("mmap", alignment));
+    {
+      BundleWriter::Options options;
+      options.data_alignment = alignment;
+      BundleWriter writer(Env::Default(), prefix, options);
+      TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+      TF_EXPECT_OK(writer.Add("b", test::AsTensor<string>({"hello"})));
+      TF_EXPECT_OK(writer.Add("c", Constant<double>(2.5, TensorShape({100}))));
+      TF_ASSERT_OK(writer.Finish());
+    }
+    Tensor a, c;
+    {
+      BundleReader::Options options;
+      options.use_mmap = true;
+      BundleReader reader(Env::Default(), prefix, options);
+      TF_ASSERT_OK(reader.status());
+      Expect<string>(&reader, "b", test::AsTensor<string>({"hello"}));
+      TF_ASSERT_OK(reader.Lookup("a", &a));
+      TF_ASSERT_OK(reader.Lookup("c", &c));
+    }
+    // The tensors remain valid after the reader is destroyed.
+    test::ExpectTensorEqual<float>(Constant_2x3<float>(1.), a);
+    test::ExpectTensorEqual<double>(Constant<double>(2.5, TensorShape({100})),
+                                    c);
+  }
+}
+
+TEST(TensorBundleTest, Delta) {
+  Env* env = Env::Default();
+  // The base holds a 4x3 "embedding", a partitioned 4x3 "part" and a scalar.
+  {
+    BundleWriter writer(env, Prefix("base"));
+    TF_EXPECT_OK(
+        writer.Add("embedding", Constant<float>(0., TensorShape({4, 3}))));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("0,2:-"),
+                                 Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("2,2:-"),
+                                 Constant_2x3<float>(2.)));
+    TF_EXPECT_OK(writer.Add("step", test::AsScalar<int64>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // The first delta updates row 1 of "embedding" and row 3 of "part".
+  BundleWriter::Options options;
+  options.base_prefix = Prefix("base");
+  {
+    BundleWriter writer(env, Prefix("delta1"), options);
+    TF_EXPECT_OK(writer.AddSlice("embedding", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant<float>(5., TensorShape({1, 3}))));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("3,1:-"),
+                                 Constant<float>(6., TensorShape({1, 3}))));
+    TF_EXPECT_OK(writer.Add("step", test::AsScalar<int64>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // The second delta updates rows 1 and 2 of "embedding".
+  options.base_prefix = Prefix("delta1");
+  {
+    BundleWriter writer(env, Prefix("delta2"), options);
+    TF_EXPECT_OK(writer.AddSlice("embedding", TensorShape({4, 3}),
+                                 TensorSlice::ParseOrDie("2,1:-"),
+                                 Constant<float>(7., TensorShape({1, 3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  auto ExpectComposed = [](BundleReader* reader) {
+    Expect<float>(reader, "embedding",
+                  test::AsTensor<float>({0, 0, 0, 5, 5, 5, 7, 7, 7, 0, 0, 0},
+                                        TensorShape({4, 3})));
+    Expect<float>(reader, "part",
+                  test::AsTensor<float>({1, 1, 1, 1, 1, 1, 2, 2, 2, 6, 6, 6},
+                                        TensorShape({4, 3})));
+    Expect<int64>(reader, "step", test::AsScalar<int64>(2));
+
+    Tensor slice(DT_FLOAT, TensorShape({2, 3}));
+    TF_ASSERT_OK(reader->LookupSlice(
+        "part", TensorSlice::ParseOrDie("2,2:-"), &slice));
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({2, 2, 2, 6, 6, 6}, TensorShape({2, 3})), slice);
+    std::vector<TensorSlice> slices;
+    TF_ASSERT_OK(reader->LookupTensorSlices("part", &slices));
+    EXPECT_EQ(2, slices.size());
+  };
+  {
+    BundleReader reader(env, Prefix("delta2"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ(Prefix("delta1"), reader.base_prefix());
+    EXPECT_TRUE(reader.Contains("step"));
+    ExpectComposed(&reader);
+  }
+
+  // Compacts the deltas into a bundle without base.
+  TF_ASSERT_OK(CompactBundle(env, Prefix("delta2"), Prefix("compacted")));
+  {
+    BundleReader reader(env, Prefix("compacted"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ("", reader.base_prefix());
+    EXPECT_EQ(AllTensorKeys(&reader).size(), 5);  // 3 tensors and 2 slices.
+    ExpectComposed(&reader);
+  }
+}
+
+TEST(TensorBundleTest, DeltaBundleCycle) {
+  Env* env = Env::Default();
+  // "cycle_a" and "cycle_b" are the bases of each other.
+  for (const auto& prefixes : {std::make_pair("cycle_a", "cycle_b"),
+                               std::make_pair("cycle_b", "cycle_a")}) {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix(prefixes.second);
+    BundleWriter writer(env, Prefix(prefixes.first), options);
+    TF_EXPECT_OK(writer.Add("step", test::AsScalar<int64>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(env, Prefix("cycle_a"));
+  EXPECT_TRUE(errors::IsDataLoss(reader.status()));
+  EXPECT_TRUE(StringPiece(reader.status().ToString())
+                  .contains("cycle of base prefixes"))
+      << reader.status();
+}
+
 TEST(TensorBundleTest, DirectoryStructure) {
   Env* env = Env::Default();
   // Writes two bundles.
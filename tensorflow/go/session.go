@@ -95,6 +95,77 @@ func (s *Session) Run(feeds map[Output]*Tensor, fetches []Output, targets []*Ope
 	return c.toGo(), nil
 }
 
+// Runner runs a Session with a fixed set of feeds, fetches and targets, which
+// are converted for the C library once, by NewRunner, rather than on every
+// call to Run. It is meant for running the same computation many times, for
+// example to serve a model. A Runner allows concurrent calls to Run.
+type Runner struct {
+	session *Session
+	feeds   []C.TF_Output
+	fetches []C.TF_Output
+	targets []*C.TF_Operation
+}
+
+// NewRunner returns a Runner for the supplied feeds, fetches and targets,
+// which have the same meaning as in Session.Run.
+func (s *Session) NewRunner(feeds, fetches []Output, targets []*Operation) *Runner {
+	r := &Runner{
+		session: s,
+		feeds:   make([]C.TF_Output, len(feeds)),
+		fetches: make([]C.TF_Output, len(fetches)),
+		targets: make([]*C.TF_Operation, len(targets)),
+	}
+	for i, o := range feeds {
+		r.feeds[i] = o.c()
+	}
+	for i, o := range fetches {
+		r.fetches[i] = o.c()
+	}
+	for i, t := range targets {
+		r.targets[i] = t.c
+	}
+	return r
+}
+
+// Run runs the graph with feeds[i] as the value of the i-th feed passed to
+// NewRunner, and returns the fetched Tensors in the order of the fetches passed
+// to NewRunner.
+func (r *Runner) Run(feeds []*Tensor) ([]*Tensor, error) {
+	if len(feeds) != len(r.feeds) {
+		return nil, fmt.Errorf("got %d feeds, want %d", len(feeds), len(r.feeds))
+	}
+	s := r.session
+	s.mu.Lock()
+	if s.c == nil {
+		s.mu.Unlock()
+		return nil, errors.New("session is closed")
+	}
+	s.wg.Add(1)
+	s.mu.Unlock()
+	defer s.wg.Done()
+
+	c := &cRunArgs{
+		feeds:        r.feeds,
+		feedTensors:  make([]*C.TF_Tensor, len(feeds)),
+		fetches:      r.fetches,
+		fetchTensors: make([]*C.TF_Tensor, len(r.fetches)),
+		targets:      r.targets,
+	}
+	for i, t := range feeds {
+		c.feedTensors[i] = t.c
+	}
+	status := newStatus()
+	C.TF_SessionRun(s.c, nil,
+		ptrOutput(c.feeds), ptrTensor(c.feedTensors), C.int(len(c.feeds)),
+		ptrOutput(c.fetches), ptrTensor(c.fetchTensors), C.int(len(c.fetches)),
+		ptrOperation(c.targets), C.int(len(c.targets)),
+		nil, status.c)
+	if err := status.Err(); err != nil {
+		return nil, err
+	}
+	return c.toGo(), nil
+}
+
 // PartialRun enables incremental evaluation of graphs.
 //
 // PartialRun allows the caller to pause the evaluation of a graph, run
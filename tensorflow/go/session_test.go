@@ -74,6 +74,35 @@ func TestSessionRunNeg(t *testing.T) {
 	}
 }
 
+func TestRunnerRunNeg(t *testing.T) {
+	graph, inp, out := createTestGraph(t, Float)
+	s, err := NewSession(graph, &SessionOptions{})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer s.Close()
+	r := s.NewRunner([]Output{inp}, []Output{out}, nil)
+	for _, input := range []float32{1, -2, 3} {
+		t1, err := NewTensor(input)
+		if err != nil {
+			t.Fatal(err)
+		}
+		output, err := r.Run([]*Tensor{t1})
+		if err != nil {
+			t.Fatal(err)
+		}
+		if len(output) != 1 {
+			t.Fatalf("got %d outputs, want 1", len(output))
+		}
+		if got, want := output[0].Value(), -input; got != want {
+			t.Errorf("got %v, want %v", got, want)
+		}
+	}
+	if _, err := r.Run(nil); err == nil {
+		t.Error("Run() with too few feeds succeeded")
+	}
+}
+
 func TestSessionRunConcat(t *testing.T) {
 	// Runs the Concat operation on two matrices: m1 and m2, along the
 	// first dimension (dim1).
@@ -115,6 +115,10 @@ public final class Session implements AutoCloseable {
    * evaluate the {@link Tensor}s to fetch. The {@link #feed(String,int,Tensor)} call allows callers
    * to override the value of {@link Tensor}s in the graph by substituing the provided {@link
    * Tensor}s for the outputs of the operations provided to {@link #feed(String,int,Tensor)}.
+   *
+   * <p>A Runner can be run repeatedly. The operations it feeds, fetches and targets are resolved
+   * once, on the first run after they change, so a Runner that is reused with new values from
+   * {@link #setFeed(int,Tensor)} only passes the new Tensors to the native library on each run.
    */
   public final class Runner {
     /**
@@ -143,6 +147,7 @@ public final class Session implements AutoCloseable {
       if (op != null) {
         inputs.add(op.output(index));
         inputTensors.add(t);
+        resolved = false;
       }
       return this;
     }
@@ -154,6 +159,17 @@ public final class Session implements AutoCloseable {
     public Runner feed(Output o, Tensor t) {
       inputs.add(o);
       inputTensors.add(t);
+      resolved = false;
+      return this;
+    }
+
+    /**
+     * Replace the Tensor provided by the {@code index}-th call to {@code feed} with {@code t}.
+     *
+     * @throws IndexOutOfBoundsException if fewer than {@code index + 1} feeds have been added.
+     */
+    public Runner setFeed(int index, Tensor t) {
+      inputTensors.set(index, t);
       return this;
     }
 
@@ -181,6 +197,7 @@ public final class Session implements AutoCloseable {
       Operation op = operationByName(operation);
       if (op != null) {
         outputs.add(op.output(index));
+        resolved = false;
       }
       return this;
     }
@@ -188,6 +205,7 @@ public final class Session implements AutoCloseable {
     /** Makes {@link #run()} return the Tensor referred to by {@code output}. */
     public Runner fetch(Output output) {
       outputs.add(output);
+      resolved = false;
       return this;
     }
 
@@ -198,6 +216,7 @@ public final class Session implements AutoCloseable {
       Operation op = operationByName(operation);
       if (op != null) {
         targets.add(op);
+        resolved = false;
       }
       return this;
     }
@@ -207,6 +226,7 @@ public final class Session implements AutoCloseable {
      */
     public Runner addTarget(Operation operation) {
       targets.add(operation);
+      resolved = false;
       return this;
     }
 
@@ -257,22 +277,17 @@ public final class Session implements AutoCloseable {
       return runHelper(true);
     }
 
-    private Run runHelper(boolean wantMetadata) {
-      long[] inputTensorHandles = new long[inputTensors.size()];
-      long[] inputOpHandles = new long[inputs.size()];
-      int[] inputOpIndices = new int[inputs.size()];
-      long[] outputOpHandles = new long[outputs.size()];
-      int[] outputOpIndices = new int[outputs.size()];
-      long[] targetOpHandles = new long[targets.size()];
-      long[] outputTensorHandles = new long[outputs.size()];
+    // Converts the feeds, fetches and targets to the arguments of Session.run().
+    private void resolve() {
+      inputOpHandles = new long[inputs.size()];
+      inputOpIndices = new int[inputs.size()];
+      outputOpHandles = new long[outputs.size()];
+      outputOpIndices = new int[outputs.size()];
+      targetOpHandles = new long[targets.size()];
 
       // It's okay to use Operation.getUnsafeNativeHandle() here since the safety depends on the
       // validity of the Graph and graphRef ensures that.
       int idx = 0;
-      for (Tensor t : inputTensors) {
-        inputTensorHandles[idx++] = t.getNativeHandle();
-      }
-      idx = 0;
       for (Output o : inputs) {
         inputOpHandles[idx] = o.op().getUnsafeNativeHandle();
         inputOpIndices[idx] = o.index();
@@ -288,6 +303,19 @@ public final class Session implements AutoCloseable {
       for (Operation op : targets) {
         targetOpHandles[idx++] = op.getUnsafeNativeHandle();
       }
+      resolved = true;
+    }
+
+    private Run runHelper(boolean wantMetadata) {
+      if (!resolved) {
+        resolve();
+      }
+      long[] inputTensorHandles = new long[inputTensors.size()];
+      long[] outputTensorHandles = new long[outputs.size()];
+      int idx = 0;
+      for (Tensor t : inputTensors) {
+        inputTensorHandles[idx++] = t.getNativeHandle();
+      }
       Reference runRef = new Reference();
       byte[] metadata = null;
       try {
@@ -374,6 +402,14 @@ public final class Session implements AutoCloseable {
     private ArrayList<Output> outputs = new ArrayList<Output>();
     private ArrayList<Operation> targets = new ArrayList<Operation>();
     private byte[] runOptions = null;
+
+    // The arguments of Session.run() for the feeds, fetches and targets, valid if resolved is true.
+    private boolean resolved = false;
+    private long[] inputOpHandles;
+    private int[] inputOpIndices;
+    private long[] outputOpHandles;
+    private int[] outputOpIndices;
+    private long[] targetOpHandles;
   }
 
   /** Create a Runner to execute graph operations and evaluate Tensors. */
@@ -199,6 +199,45 @@ public final class Tensor implements AutoCloseable {
     return t;
   }
 
+  /**
+   * Create a Tensor that uses the memory of a direct buffer instead of copying it.
+   *
+   * <p>The tensor's data is the content of {@code data} from its current position to its limit,
+   * encoded as per {@link #create(DataType, long[], ByteBuffer)}. Primitive types must be in
+   * native byte order. The buffer is kept alive until TensorFlow no longer uses its memory, which
+   * may be after {@link #close()} if, for example, a {@link Session} stored the value in a
+   * variable. The contents of the buffer must not be modified until then.
+   *
+   * <p>Data that does not satisfy TensorFlow's memory alignment preferences is copied, in which
+   * case this method behaves like {@link #create(DataType, long[], ByteBuffer)}.
+   *
+   * @param dataType the tensor datatype.
+   * @param shape the tensor shape.
+   * @param data a direct buffer containing the tensor data.
+   * @throws IllegalArgumentException If {@code data} is not a direct buffer, or if the tensor
+   *     datatype or shape is not compatible with the buffer
+   */
+  public static Tensor wrap(DataType dataType, long[] shape, ByteBuffer data) {
+    if (!data.isDirect()) {
+      throw new IllegalArgumentException("Tensor.wrap() requires a direct ByteBuffer");
+    }
+    final int nbytes = data.remaining();
+    if (dataType != DataType.STRING) {
+      final int expected = numElements(shape) * elemByteSize(dataType);
+      if (nbytes != expected) {
+        throw new IllegalArgumentException(
+            String.format(
+                "ByteBuffer with %d bytes is not compatible with a %s Tensor with shape %s",
+                nbytes, dataType.toString(), Arrays.toString(shape)));
+      }
+    }
+    Tensor t = new Tensor();
+    t.dtype = dataType;
+    t.shapeCopy = Arrays.copyOf(shape, shape.length);
+    t.nativeHandle = allocateDirect(t.dtype.c(), t.shapeCopy, data.slice());
+    return t;
+  }
+
   // Helper function to allocate a Tensor for the create() methods that create a Tensor from
   // a java.nio.Buffer.
   private static Tensor allocateForBuffer(DataType dataType, long[] shape, int nBuffered) {
@@ -596,6 +635,8 @@ public final class Tensor implements AutoCloseable {
 
   private static native long allocateScalarBytes(byte[] value);
 
+  private static native long allocateDirect(int dtype, long[] shape, ByteBuffer data);
+
   private static native void delete(long handle);
 
   private static native ByteBuffer buffer(long handle);
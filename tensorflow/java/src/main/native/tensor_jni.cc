@@ -213,6 +213,33 @@ size_t readNDArray(JNIEnv* env, TF_DataType dtype, const char* src,
     return sz;
   }
 }
+
+// Keeps the direct ByteBuffer whose memory backs a TF_Tensor alive.
+struct DirectBufferRef {
+  JavaVM* vm;
+  jobject buffer;  // A global reference.
+};
+
+// The TF_Tensor deallocator of Tensor.allocateDirect. It may be called from a
+// TensorFlow thread that is not attached to the JVM.
+void releaseDirectBuffer(void* data, size_t len, void* arg) {
+  DirectBufferRef* ref = static_cast<DirectBufferRef*>(arg);
+  JNIEnv* env = nullptr;
+  bool attached = false;
+  if (ref->vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) ==
+      JNI_EDETACHED) {
+    if (ref->vm->AttachCurrentThread(reinterpret_cast<void**>(&env),
+                                     nullptr) != JNI_OK) {
+      // Leak the reference rather than crash.
+      delete ref;
+      return;
+    }
+    attached = true;
+  }
+  env->DeleteGlobalRef(ref->buffer);
+  if (attached) ref->vm->DetachCurrentThread();
+  delete ref;
+}
 }  // namespace
 
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
@@ -284,6 +311,40 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateScalarBytes(
   return reinterpret_cast<jlong>(t);
 }
 
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateDirect(
+    JNIEnv* env, jclass clazz, jint dtype, jlongArray shape, jobject buffer) {
+  void* data = env->GetDirectBufferAddress(buffer);
+  const jlong len = env->GetDirectBufferCapacity(buffer);
+  if (data == nullptr || len < 0) {
+    throwException(env, kIllegalArgumentException,
+                   "unable to access the memory of the direct ByteBuffer");
+    return 0;
+  }
+  DirectBufferRef* ref = new DirectBufferRef;
+  if (env->GetJavaVM(&ref->vm) != JNI_OK) {
+    delete ref;
+    throwException(env, kIllegalStateException, "unable to get the JavaVM");
+    return 0;
+  }
+  ref->buffer = env->NewGlobalRef(buffer);
+
+  const int num_dims = static_cast<int>(env->GetArrayLength(shape));
+  std::unique_ptr<int64_t[]> dims(new int64_t[num_dims]);
+  if (num_dims > 0) {
+    jlong* jdims = env->GetLongArrayElements(shape, nullptr);
+    for (int i = 0; i < num_dims; ++i) {
+      dims[i] = static_cast<int64_t>(jdims[i]);
+    }
+    env->ReleaseLongArrayElements(shape, jdims, JNI_ABORT);
+  }
+  // TF_NewTensor calls releaseDirectBuffer right away if it had to copy the
+  // data for alignment.
+  TF_Tensor* t = TF_NewTensor(static_cast<TF_DataType>(dtype), dims.get(),
+                              num_dims, data, static_cast<size_t>(len),
+                              releaseDirectBuffer, ref);
+  return reinterpret_cast<jlong>(t);
+}
+
 JNIEXPORT void JNICALL Java_org_tensorflow_Tensor_delete(JNIEnv* env,
                                                          jclass clazz,
                                                          jlong handle) {
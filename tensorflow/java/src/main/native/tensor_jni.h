@@ -38,6 +38,16 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv *, jclass,
 JNIEXPORT jlong JNICALL
 Java_org_tensorflow_Tensor_allocateScalarBytes(JNIEnv *, jclass, jbyteArray);
 
+/*
+ * Class:     org_tensorflow_Tensor
+ * Method:    allocateDirect
+ * Signature: (I[JLjava/nio/ByteBuffer;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateDirect(JNIEnv *,
+                                                                  jclass, jint,
+                                                                  jlongArray,
+                                                                  jobject);
+
 /*
  * Class:     org_tensorflow_Tensor
  * Method:    delete
@@ -62,6 +62,26 @@ public class SessionTest {
     }
   }
 
+  @Test
+  public void runRepeatedlyWithNewFeeds() {
+    try (Graph g = new Graph();
+        Session s = new Session(g)) {
+      TestUtil.transpose_A_times_X(g, new int[][] {{2}, {3}});
+      try (Tensor x1 = Tensor.create(new int[][] {{5}, {7}});
+          Tensor x2 = Tensor.create(new int[][] {{1}, {1}})) {
+        Session.Runner runner = s.runner().feed("X", x1).fetch("Y");
+        try (Tensor y = runner.run().get(0)) {
+          final int[][] expected = {{31}};
+          assertArrayEquals(expected, y.copyTo(new int[1][1]));
+        }
+        try (Tensor y = runner.setFeed(0, x2).run().get(0)) {
+          final int[][] expected = {{5}};
+          assertArrayEquals(expected, y.copyTo(new int[1][1]));
+        }
+      }
+    }
+  }
+
   @Test
   public void runUsingColonSeparatedNames() {
     try (Graph g = new Graph();
@@ -87,6 +87,33 @@ public class TensorTest {
     }
   }
 
+  @Test
+  public void wrapDirectBuffer() {
+    ByteBuffer buf = ByteBuffer.allocateDirect(4 * 4).order(ByteOrder.nativeOrder());
+    buf.asFloatBuffer().put(new float[] {1, 2, 3, 4});
+    try (Tensor t = Tensor.wrap(DataType.FLOAT, new long[] {2, 2}, buf)) {
+      assertEquals(DataType.FLOAT, t.dataType());
+      final float[][] expected = {{1, 2}, {3, 4}};
+      float[][] got = t.copyTo(new float[2][2]);
+      assertArrayEquals(expected[0], got[0], 0);
+      assertArrayEquals(expected[1], got[1], 0);
+    }
+  }
+
+  @Test
+  public void failWrapOnHeapOrMismatchedBuffer() {
+    try (Tensor t = Tensor.wrap(DataType.FLOAT, new long[] {2}, ByteBuffer.allocate(8))) {
+      fail("wrapped a heap ByteBuffer");
+    } catch (IllegalArgumentException e) {
+      // The expected exception.
+    }
+    try (Tensor t = Tensor.wrap(DataType.FLOAT, new long[] {3}, ByteBuffer.allocateDirect(8))) {
+      fail("wrapped a ByteBuffer with too few bytes");
+    } catch (IllegalArgumentException e) {
+      // The expected exception.
+    }
+  }
+
   @Test
   public void createFromBufferWithNonNativeByteOrder() {
     double[] doubles = {1d, 2d, 3d, 4d};
@@ -527,6 +527,28 @@ class ConcatOpTest(test.TestCase):
       output = gen_array_ops._concat_v2([t1, t2], 0).eval()
       self.assertFalse(output)  # Checks that output is empty
 
+  def testConcatOfSplit(self):
+    # Concatenating the outputs of a split along the first dimension in order
+    # aliases them instead of copying, which must give the same result as the
+    # copying cases: out of order, along another axis or with other tensors.
+    x = np.random.rand(8, 4, 3).astype(np.float32)
+    with self.test_session(use_gpu=True):
+      parts = array_ops.split(x, 4, 0)
+      other = constant_op.constant(np.ones([1, 4, 3], np.float32))
+      in_order, reversed_order, with_other, stacked = [
+          t.eval()
+          for t in (array_ops.concat(parts, 0),
+                    array_ops.concat(parts[::-1], 0),
+                    array_ops.concat(parts[:2] + [other] + parts[2:], 0),
+                    array_ops.stack(array_ops.unstack(x), 0))
+      ]
+      self.assertAllEqual(x, in_order)
+      self.assertAllEqual(
+          np.concatenate(np.split(x, 4, 0)[::-1], 0), reversed_order)
+      self.assertAllEqual(
+          np.concatenate([x[:4], np.ones([1, 4, 3]), x[4:]], 0), with_other)
+      self.assertAllEqual(x, stacked)
+
   def testConcatInvalidAxis(self):
     with self.assertRaises(ValueError):
       with self.test_session(use_gpu=True):
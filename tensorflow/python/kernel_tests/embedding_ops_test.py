@@ -31,6 +31,7 @@ from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import data_flow_ops
 from tensorflow.python.ops import embedding_ops
 from tensorflow.python.ops import gradient_checker
+from tensorflow.python.ops import gradients_impl
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import partitioned_variables
 from tensorflow.python.ops import state_ops
@@ -624,13 +625,15 @@ class EmbeddingLookupSparseTest(test.TestCase):
     grouped_ignored_weights = self._GroupByBatchEntry(
         np.ones(np.sum(vals_per_batch_entry)), vals_per_batch_entry)
 
-    for num_shards, combiner, dtype, ignore_weights in itertools.product(
-        [1, 5], ["sum", "mean", "sqrtn"], [dtypes.float32, dtypes.float64],
-        [True, False]):
+    for num_shards, combiner, dtype, ignore_weights, on_cpu in (
+        itertools.product([1, 5], ["sum", "mean", "sqrtn"],
+                          [dtypes.float32, dtypes.float64], [True, False],
+                          [True, False])):
 
       with self.test_session():
-        p, params, feed_dict = _EmbeddingParams(
-            num_shards, vocab_size, shape=param_shape, dtype=dtype)
+        with ops.device("/cpu:0" if on_cpu else None):
+          p, params, feed_dict = _EmbeddingParams(
+              num_shards, vocab_size, shape=param_shape, dtype=dtype)
         embedding_sum = embedding_ops.embedding_lookup_sparse(
             p,
             sp_ids,
@@ -663,12 +666,14 @@ class EmbeddingLookupSparseTest(test.TestCase):
     sp_ids, sp_weights, _, _, _ = (
         self._RandomIdsAndWeights(batch_size, vocab_size))
 
-    for num_shards, combiner, dtype, ignore_weights in itertools.product(
-        [1, 3], ["sum", "mean", "sqrtn"], [dtypes.float32, dtypes.float64],
-        [True, False]):
+    for num_shards, combiner, dtype, ignore_weights, on_cpu in (
+        itertools.product([1, 3], ["sum", "mean", "sqrtn"],
+                          [dtypes.float32, dtypes.float64], [True, False],
+                          [True, False])):
       with self.test_session():
-        x, params, _ = _EmbeddingParams(
-            num_shards, vocab_size, shape=param_shape, dtype=dtype)
+        with ops.device("/cpu:0" if on_cpu else None):
+          x, params, _ = _EmbeddingParams(
+              num_shards, vocab_size, shape=param_shape, dtype=dtype)
 
         y = embedding_ops.embedding_lookup_sparse(
             x,
@@ -683,6 +688,27 @@ class EmbeddingLookupSparseTest(test.TestCase):
             x, x_shape, y, y_shape, x_init_value=x_init_value)
       self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
 
+  def testGradientsOfTableOnCpuAreSparse(self):
+    with self.test_session():
+      with ops.device("/cpu:0"):
+        x = variables.Variable(array_ops.ones([10, 3]))
+      sp_ids = sparse_tensor.SparseTensor(
+          constant_op.constant([[0, 0], [0, 1], [1, 0]], dtypes.int64),
+          constant_op.constant([1, 4, 1], dtypes.int64),
+          constant_op.constant([2, 2], dtypes.int64))
+      variables.global_variables_initializer().run()
+      for combiner, scale in [("sum", 1.0), ("mean", 0.5), ("sqrtn", 0.5**0.5)]:
+        y = embedding_ops.embedding_lookup_sparse(
+            x, sp_ids, None, combiner=combiner)
+        # The rows are added up straight out of the table.
+        self.assertNotIn("Unique",
+                         [op.type for op in y.graph.get_operations()])
+        grad, = gradients_impl.gradients(y, [x])
+        self.assertIsInstance(grad, ops.IndexedSlices)
+        grad_value = grad.values.eval()
+        self.assertAllEqual([1, 4, 1], grad.indices.eval())
+        self.assertAllClose([[scale] * 3, [scale] * 3, [1.0] * 3], grad_value)
+
   def testIncompatibleShapes(self):
     with self.test_session():
       x, _, _ = _EmbeddingParams(1, 10, dtype=dtypes.float32)
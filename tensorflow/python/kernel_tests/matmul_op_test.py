@@ -22,6 +22,7 @@ import operator
 import numpy as np
 
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
@@ -207,6 +208,41 @@ class MatMulInfixOperatorTest(test_lib.TestCase):
       self.assertAllEqual(c.eval(), d.eval())
 
 
+class MatMulBfloat16Test(test_lib.TestCase):
+
+  def testMatchesFloat32(self):
+    np.random.seed(1)
+    for transpose_a in [False, True]:
+      for transpose_b in [False, True]:
+        # A vector times a matrix, and a larger product.
+        for m, k, n in [(1, 7, 5), (9, 33, 17)]:
+          a_np = np.random.uniform(-1, 1, [m, k]).astype(np.float32)
+          b_np = np.random.uniform(-1, 1, [k, n]).astype(np.float32)
+          if transpose_a:
+            a_np = a_np.T
+          if transpose_b:
+            b_np = b_np.T
+          with self.test_session(use_gpu=False):
+            a = math_ops.cast(a_np, dtypes.bfloat16)
+            b = math_ops.cast(b_np, dtypes.bfloat16)
+            product = math_ops.matmul(
+                a, b, transpose_a=transpose_a, transpose_b=transpose_b)
+            self.assertEqual(dtypes.bfloat16, product.dtype)
+            self.assertEqual("MatMul", product.op.type)
+            expected = math_ops.matmul(
+                math_ops.cast(a, dtypes.float32),
+                math_ops.cast(b, dtypes.float32),
+                transpose_a=transpose_a,
+                transpose_b=transpose_b)
+            # The product is accumulated in float32, and only loses the
+            # precision of its conversion to bfloat16.
+            self.assertAllClose(
+                expected.eval(),
+                math_ops.cast(product, dtypes.float32).eval(),
+                rtol=1e-2,
+                atol=1e-2)
+
+
 if __name__ == "__main__":
   sizes = [1, 3, 5]
   trans_options = [[False, False], [True, False], [False, True]]
@@ -141,6 +141,31 @@ class ScatterTest(test.TestCase):
   def testRepeatIndicesDiv(self):
     self._VariableRankTests(state_ops.scatter_div, True)
 
+  def _HotRowsTest(self, tf_scatter, vtype, itype):
+    # Many more updates than rows, so that the rows are grouped before they
+    # are updated on a GPU.
+    np.random.seed(8)
+    with self.test_session(use_gpu=True):
+      indices = np.random.randint(16, size=4096).astype(itype)
+      updates = _AsType(np.random.randn(4096, 32), vtype)
+      old = _AsType(np.random.randn(16, 32), vtype)
+      new = old.copy()
+      _TF_OPS_TO_NUMPY[tf_scatter](new, indices, updates)
+      ref = variables.Variable(old)
+      ref.initializer.run()
+      tf_scatter(ref, indices, updates).eval()
+      self.assertAllClose(ref.eval(), new)
+
+  def testHotRowsAdd(self):
+    for vtype in (np.float32, np.float64):
+      for itype in (np.int32, np.int64):
+        self._HotRowsTest(state_ops.scatter_add, vtype, itype)
+
+  def testHotRowsSub(self):
+    for vtype in (np.float32, np.float64):
+      for itype in (np.int32, np.int64):
+        self._HotRowsTest(state_ops.scatter_sub, vtype, itype)
+
   def testBooleanScatterUpdate(self):
     if not test.is_gpu_available():
       with self.test_session(use_gpu=False) as session:
@@ -256,6 +256,23 @@ class UnsortedSegmentSumTest(SegmentReductionHelper):
         self.assertAllClose(np_ans, tf_ans)
         self.assertShapeEqual(np_ans, s)
 
+  def testHotSegments(self):
+    # Many more segment ids than segments, so that the rows of each segment
+    # are grouped before they are summed on a GPU. Segment 9 is empty.
+    np.random.seed(8)
+    indices = np.random.randint(9, size=4096)
+    num_segments = 10
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64,
+                  dtypes_lib.complex64]:
+      with self.test_session(use_gpu=True):
+        tf_x, np_x = self._input([4096, 16], dtype=dtype)
+        np_ans = self._segmentReduce(
+            indices, np_x, np.add, op2=None, num_out_rows=num_segments)
+        s = math_ops.unsorted_segment_sum(
+            data=tf_x, segment_ids=indices, num_segments=num_segments)
+        tf_ans = s.eval()
+      self.assertAllClose(np_ans, tf_ans, rtol=1e-5, atol=1e-3)
+
   def testGradientSegmentSum(self):
     num_cols = 2
     indices_flat = np.array([0, 4, 0, 8, 3, 8, 4, 7, 7, 3])
@@ -310,6 +327,25 @@ class UnsortedSegmentSumTest(SegmentReductionHelper):
       self.assertAllClose(unsorted_jacob_t, sorted_jacob_t)
       self.assertAllClose(unsorted_jacob_n, sorted_jacob_n)
 
+  def testManyRows(self):
+    # Enough rows for the CPU kernels to split the segments among threads.
+    np.random.seed(7)
+    num_segments = 300
+    indices = np.random.randint(0, num_segments, size=20000)
+    np_x = np.random.randint(-100, 100, size=(20000, 8)).astype(np.float64)
+    np_sum = np.zeros((num_segments, 8))
+    np.add.at(np_sum, indices, np_x)
+    np_max = np.full((num_segments, 8), np.finfo(np.float64).min)
+    np.maximum.at(np_max, indices, np_x)
+    with self.test_session(use_gpu=False):
+      s = math_ops.unsorted_segment_sum(np_x, indices, num_segments)
+      m = math_ops.unsorted_segment_max(np_x, indices, num_segments)
+      tf_sum, tf_max = s.eval(), m.eval()
+      self.assertAllEqual(np_sum, tf_sum)
+      self.assertAllEqual(np_max, tf_max)
+      # The result does not depend on how the work was split.
+      self.assertAllEqual(tf_sum, s.eval())
+
   def testBadIndices(self):
     # Note: GPU kernel does not return the out-of-range error needed for this
     # test, so this test is marked as cpu-only.
@@ -253,6 +253,59 @@ class IndexedSlicesConditionalAccumulatorTest(test.TestCase):
           np.array([[expected_val, 0], [0, expected_val]]).astype(np.float32),
           val, sess)
 
+  def testDenseAccumulationParallelApplyGrad(self):
+    with self.test_session() as sess:
+      q = data_flow_ops.SparseConditionalAccumulator(
+          dtypes_lib.float32,
+          name="Q",
+          shape=tensor_shape.TensorShape([6, 2]),
+          dense_accumulation=True)
+      rng = np.random.RandomState(0)
+      grads = []
+      accum_ops = []
+      for _ in range(10):
+        x = np.zeros([6, 2], dtype=np.float32)
+        rows = rng.choice(5, size=3, replace=False)
+        x[rows] = rng.rand(3, 2).astype(np.float32) + 1
+        grads.append(x)
+        accum_ops.append(
+            q.apply_indexed_slices_grad(_indexedslice(x), local_step=0))
+      takeg_t = q.take_indexed_slices_grad(10)
+
+      threads = [
+          self.checkedThread(target=sess.run, args=(o,)) for o in accum_ops
+      ]
+      for thread in threads:
+        thread.start()
+      for thread in threads:
+        thread.join()
+      val = sess.run(takeg_t)
+
+      # Each row is averaged over the gradients that touched it.
+      total = np.sum(grads, axis=0)
+      counts = np.sum([np.any(g != 0, axis=1) for g in grads], axis=0)
+      expected_indices = np.nonzero(counts)[0]
+      self.assertAllEqual(expected_indices, val.indices)
+      self.assertAllClose(
+          total[expected_indices] / counts[expected_indices, None], val.values)
+      self.assertAllEqual([6, 2], val.dense_shape)
+
+      # The sum starts over at the next step.
+      sess.run(
+          q.apply_grad([5], np.array([[1, 2]]).astype(np.float32),
+                       local_step=1))
+      val = sess.run(q.take_indexed_slices_grad(1))
+      self.assertAllEqual([5], val.indices)
+      self.assertAllEqual([[1, 2]], val.values)
+
+  def testDenseAccumulationRequiresShape(self):
+    with self.test_session():
+      q = data_flow_ops.SparseConditionalAccumulator(
+          dtypes_lib.float32, name="Q", shape=[None, 2],
+          dense_accumulation=True)
+      with self.assertRaisesOpError("requires a fully defined shape"):
+        q.num_accumulated().eval()
+
   def testParallelTakeGrad(self):
     with self.test_session() as sess:
       q = data_flow_ops.SparseConditionalAccumulator(
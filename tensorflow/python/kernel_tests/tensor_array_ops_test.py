@@ -1121,6 +1121,25 @@ class TensorArrayTest(test.TestCase):
       grad = gradients_impl.gradients(ys=[r], xs=[x])
       self.assertAllEqual(np.array([1.0, 1.0, 1.0]), sess.run(grad)[0])
 
+  def testTensorArrayUnpackAndSplitRoundTrip(self):
+    # Rows of 16 floats are aligned, so the elements can share the input's
+    # buffer and stacking or concatenating all of them in order need not copy.
+    with self.test_session(use_gpu=True) as sess:
+      x = np.arange(64, dtype=np.float32).reshape(4, 16)
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=4, clear_after_read=False)
+      w0 = ta.unstack(x)
+      stacked = w0.stack()
+      reversed_rows = w0.gather([3, 2, 1, 0])
+      ta_split = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=2, clear_after_read=False)
+      concatenated = ta_split.split(x, lengths=[1, 3]).concat()
+      d_stacked, d_reversed, d_concatenated = sess.run(
+          [stacked, reversed_rows, concatenated])
+      self.assertAllEqual(x, d_stacked)
+      self.assertAllEqual(x[::-1], d_reversed)
+      self.assertAllEqual(x, d_concatenated)
+
   def _testTensorArrayEvalEmpty(self):
     with self.test_session(use_gpu=True):
       ta = tensor_array_ops.TensorArray(
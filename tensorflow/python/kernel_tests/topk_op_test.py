@@ -68,6 +68,29 @@ class TopKTest(test.TestCase):
         3, [[0.2, 0.3, 0.4], [0.2, 0.3, 0.3]], [[2, 1, 3], [3, 1, 2]],
         sorted=False)
 
+  def _validateTopKAgainstSort(self, inputs, k, sorted=True):
+    # Stable, so that ties are broken by the lower index as top_k does.
+    np_indices = np.argsort(-inputs, axis=-1, kind="mergesort")[..., :k]
+    with self.test_session():
+      values_op, indices_op = nn_ops.top_k(inputs, k, sorted=sorted)
+      values, indices = values_op.eval(), indices_op.eval()
+    if not sorted:
+      np_indices = np.sort(np_indices, axis=-1)
+      indices = np.sort(indices, axis=-1)
+    self.assertAllEqual(np_indices, indices)
+    if sorted:
+      self.assertAllEqual(np.sort(inputs, axis=-1)[..., ::-1][..., :k], values)
+
+  def testTopLargeK(self):
+    inputs = np.random.randint(0, 1000, size=(4, 5000)).astype(np.float32)
+    self._validateTopKAgainstSort(inputs, 2000)
+    self._validateTopKAgainstSort(inputs, 2000, sorted=False)
+
+  def testTopKWideRow(self):
+    inputs = np.random.randint(0, 1000, size=(1, 200000)).astype(np.float32)
+    self._validateTopKAgainstSort(inputs, 10)
+    self._validateTopKAgainstSort(inputs, 1000)
+
   def testTop3Vector(self):
     inputs = [3, 6, 15, 18, 6, 12, 1, 17, 3, 0, 4, 19, 1, 6]
     self._validateTopK(inputs, 3, [19, 18, 17], [11, 3, 7])
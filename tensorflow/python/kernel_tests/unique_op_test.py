@@ -81,6 +81,21 @@ class UniqueWithCountsTest(test.TestCase):
       v = [1 if x[i] == value.decode('ascii') else 0 for i in range(7000)]
       self.assertEqual(count, sum(v))
 
+  def testInt64ManyElements(self):
+    # Enough elements for the CPU kernel to split them among threads.
+    x = np.random.randint(0, high=50000, size=300000).astype(np.int64)
+    with self.test_session() as sess:
+      y, idx, count = array_ops.unique_with_counts(x)
+      tf_y, tf_idx, tf_count = sess.run([y, idx, count])
+
+    np_y, np_first, np_count = np.unique(
+        x, return_index=True, return_counts=True)
+    # The unique elements come in the order of their first occurrence.
+    order = np.argsort(np_first)
+    self.assertAllEqual(np_y[order], tf_y)
+    self.assertAllEqual(np_count[order], tf_count)
+    self.assertAllEqual(x, tf_y[tf_idx])
+
 
 if __name__ == '__main__':
   test.main()
@@ -1207,15 +1207,21 @@ class SparseConditionalAccumulator(ConditionalAccumulatorBase):
     shared_name: Optional. If non-empty, this accumulator will be shared under
       the given name across multiple sessions.
     name: Optional name for the accumulator.
+    dense_accumulation: Optional. If True, the sum is kept in a dense tensor of
+      `shape`, which must be fully defined, and concurrently applied gradients
+      are added to it in parallel. Useful when many workers push large sparse
+      gradients, at the cost of the memory of one dense gradient.
   """
 
   def __init__(self,
                dtype,
                shape=None,
                shared_name=None,
-               name="sparse_conditional_accumulator"):
+               name="sparse_conditional_accumulator",
+               dense_accumulation=False):
     accumulator_ref = gen_data_flow_ops.sparse_conditional_accumulator(
-        dtype=dtype, shape=shape, shared_name=shared_name, name=name)
+        dtype=dtype, shape=shape, shared_name=shared_name, name=name,
+        dense_accumulation=dense_accumulation)
     super(SparseConditionalAccumulator,
           self).__init__(dtype, shape, accumulator_ref)
 
@@ -1585,10 +1591,16 @@ class StagingArea(BaseStagingArea):
   All get() and peek() commands block if the the requested data
   is not present in the Staging Area.
 
+  A staging area on a GPU can prefetch its elements from host memory:
+  then put() returns as soon as the copies to the GPU are enqueued, and
+  get() waits for them to complete. Running the put() of the next element
+  in the same step as the get() of the current one hides the transfer
+  behind the step; the capacity bounds the number of elements in flight.
+
   """
 
   def __init__(self, dtypes, shapes=None, names=None, shared_name=None,
-                  capacity=0, memory_limit=0):
+                  capacity=0, memory_limit=0, prefetch_to_device=False):
     """Constructs a staging area object.
 
     The two optional lists, `shapes` and `names`, must be of the same length
@@ -1618,6 +1630,10 @@ class StagingArea(BaseStagingArea):
       shared_name: (Optional.) A name to be used for the shared object. By
         passing the same name to two different python objects they will share
         the underlying staging area. Must be a string.
+      prefetch_to_device: (Optional.) If True, `put` reads its values from
+        host memory and copies them to the staging area asynchronously,
+        through pinned buffers. The staging area must be on a GPU, and the
+        values of numeric types.
 
     Raises:
       ValueError: If one of the arguments is invalid.
@@ -1626,6 +1642,7 @@ class StagingArea(BaseStagingArea):
     super(StagingArea, self).__init__(dtypes, shapes,
                                           names, shared_name,
                                           capacity, memory_limit)
+    self._prefetch_to_device = prefetch_to_device
 
   def put(self, values, name=None):
     """Create an op that places a value into the staging area.
@@ -1651,7 +1668,11 @@ class StagingArea(BaseStagingArea):
                   if isinstance(values, (list, tuple)) else None)
       vals, _ = self._check_put_dtypes(values, indices)
 
-      with ops.colocate_with(self._coloc_op):
+      label_map = {"Stage": "prefetch"} if self._prefetch_to_device else {}
+      # pylint: disable=protected-access
+      with ops.colocate_with(self._coloc_op), \
+          ops.get_default_graph()._kernel_label_map(label_map):
+        # pylint: enable=protected-access
         op = gen_data_flow_ops.stage(values=vals, shared_name=self._name,
                                      name=scope, capacity=self._capacity,
                                      memory_limit=self._memory_limit)
@@ -21,6 +21,7 @@ from __future__ import print_function
 from six.moves import xrange  # pylint: disable=redefined-builtin
 
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import device as pydev
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
@@ -219,6 +220,26 @@ def embedding_lookup(params, ids, partition_strategy="mod", name=None,
       return maybe_normalize(ret)
 
 
+def _combines_rows_in_place(params, max_norm):
+  """Whether embedding_lookup_sparse adds up the rows of `params` in place.
+
+  The SparseSegment reductions only run on the CPU, so they read the table in
+  place only when it is placed on the CPU. Elsewhere, the rows are gathered
+  first so that only they are copied to the host.
+
+  Args:
+    params: The list of the tensors of the embedding table.
+    max_norm: The `max_norm` argument of embedding_lookup_sparse.
+
+  Returns:
+    True if the rows can be read in place.
+  """
+  if len(params) != 1 or max_norm is not None:
+    return False
+  device = params[0].device or ""
+  return pydev.DeviceSpec.from_string(device).device_type == "CPU"
+
+
 def embedding_lookup_sparse(params, sp_ids, sp_weights,
                             partition_strategy="mod",
                             name=None,
@@ -325,6 +346,18 @@ def embedding_lookup_sparse(params, sp_ids, sp_weights,
       segment_ids = math_ops.cast(segment_ids, dtypes.int32)
 
     ids = sp_ids.values
+    if ignore_weights and _combines_rows_in_place(params, max_norm):
+      # Adds up the rows straight out of the table, instead of gathering them
+      # into a tensor first.
+      if combiner == "sum":
+        return math_ops.sparse_segment_sum(params[0], ids, segment_ids,
+                                           name=name)
+      elif combiner == "mean":
+        return math_ops.sparse_segment_mean(params[0], ids, segment_ids,
+                                            name=name)
+      else:
+        return math_ops.sparse_segment_sqrt_n(params[0], ids, segment_ids,
+                                              name=name)
     if ignore_weights:
       ids, idx = array_ops.unique(ids)
     else:
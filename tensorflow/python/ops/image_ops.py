@@ -21,6 +21,7 @@ See the @{$python/image} guide.
 @@decode_bmp
 @@decode_gif
 @@decode_jpeg
+@@decode_and_crop_and_resize_jpeg
 @@encode_jpeg
 @@decode_png
 @@encode_png
@@ -61,6 +62,7 @@ See the @{$python/image} guide.
 @@draw_bounding_boxes
 @@non_max_suppression
 @@non_max_suppression_v2
+@@batched_non_max_suppression
 @@sample_distorted_bounding_box
 @@total_variation
 """
@@ -53,6 +53,7 @@ ops.NotDifferentiable('SampleDistortedBoundingBox')
 ops.NotDifferentiable('ExtractGlimpse')
 ops.NotDifferentiable('NonMaxSuppression')
 ops.NotDifferentiable('NonMaxSuppressionV2')
+ops.NotDifferentiable('BatchedNonMaxSuppression')
 
 
 def _assert(cond, ex_type, msg):
@@ -2422,6 +2422,76 @@ class JpegTest(test_util.TensorFlowTestCase):
                          [None, None, channels or None])
 
 
+class DecodeAndCropAndResizeJpegTest(test_util.TensorFlowTestCase):
+
+  def _decodeCropAndResize(self, path, crop_window, size, align_corners):
+    # The fused op and the unfused ops it replaces.
+    jpeg = io_ops.read_file(path)
+    fused = image_ops.decode_and_crop_and_resize_jpeg(
+        jpeg, crop_window, size, fancy_upscaling=False,
+        align_corners=align_corners)
+    y, x, height, width = crop_window
+    image = image_ops.decode_jpeg(jpeg, fancy_upscaling=False)
+    crop = array_ops.expand_dims(image[y:y + height, x:x + width], 0)
+    unfused = image_ops.resize_bilinear(
+        crop, size, align_corners=align_corners)[0]
+    return fused, unfused
+
+  def testCropAndResize(self):
+    # Without downscaling in the decoder, the fused op decodes the same pixels
+    # as the full decode.
+    path = ("tensorflow/core/lib/jpeg/testdata/"
+            "jpeg_merge_test1.jpg")
+    for crop_window, size in [((0, 0, 256, 128), (256, 128)),
+                              ((10, 20, 100, 60), (100, 60)),
+                              ((5, 5, 20, 20), (50, 40)),
+                              ((100, 50, 1, 1), (3, 3)),
+                              ((33, 7, 90, 101), (60, 70))]:
+      for align_corners in False, True:
+        with self.test_session() as sess:
+          fused, unfused = self._decodeCropAndResize(path, crop_window, size,
+                                                     align_corners)
+          fused, unfused = sess.run([fused, unfused])
+          self.assertEqual(fused.shape, size + (3,))
+          self.assertAllClose(fused, unfused, atol=1e-3)
+
+  def testDownscaledCropAndResize(self):
+    # When the crop is much larger than the output, the image is decoded at a
+    # smaller size, which averages the pixels.
+    base = "tensorflow/core/lib/jpeg/testdata"
+    for filename in "jpeg_merge_test1.jpg", "jpeg_merge_test1_cmyk.jpg":
+      for crop_window, size in [((10, 20, 100, 60), (30, 20)),
+                                ((50, 3, 77, 101), (9, 12))]:
+        for align_corners in False, True:
+          with self.test_session() as sess:
+            fused, unfused = self._decodeCropAndResize(
+                os.path.join(base, filename), crop_window, size,
+                align_corners)
+            fused, unfused = sess.run([fused, unfused])
+            self.assertEqual(fused.shape, size + (3,))
+            self.assertLess(np.abs(fused - unfused).mean(), 3)
+
+  def testInvalidCropWindow(self):
+    path = ("tensorflow/core/lib/jpeg/testdata/"
+            "jpeg_merge_test1.jpg")
+    with self.test_session():
+      jpeg = io_ops.read_file(path)
+      for crop_window in (0, 0, 257, 128), (-1, 0, 10, 10), (0, 0, 0, 10):
+        image = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg, crop_window, (10, 10))
+        with self.assertRaisesOpError("is not within the image"):
+          image.eval()
+
+  def testShape(self):
+    with self.test_session():
+      jpeg = constant_op.constant("nonsense")
+      for channels in 0, 1, 3:
+        image = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg, [0, 0, 10, 10], [20, 30], channels=channels)
+        self.assertEqual(image.get_shape().as_list(),
+                         [20, 30, channels or None])
+
+
 class PngTest(test_util.TensorFlowTestCase):
 
   def testExisting(self):
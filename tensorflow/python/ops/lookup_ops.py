@@ -244,7 +244,12 @@ class HashTable(InitializableLookupTableBase):
   ```
   """
 
-  def __init__(self, initializer, default_value, shared_name=None, name=None):
+  def __init__(self,
+               initializer,
+               default_value,
+               shared_name=None,
+               name=None,
+               fingerprint_keys=False):
     """Creates a non-initialized `HashTable` object.
 
     Creates a table, the type of its keys and values are specified by the
@@ -259,6 +264,10 @@ class HashTable(InitializableLookupTableBase):
       shared_name: If non-empty, this table will be shared under
         the given name across multiple sessions.
       name: A name for the operation (optional).
+      fingerprint_keys: If true, store the 64-bit fingerprints of the keys
+        instead of the keys, to save memory on large vocabularies. Two keys
+        with the same fingerprint are then looked up as the same key. Only
+        string keys are supported.
 
     Returns:
       A `HashTable` object.
@@ -270,6 +279,7 @@ class HashTable(InitializableLookupTableBase):
           shared_name=shared_name,
           key_dtype=initializer.key_dtype,
           value_dtype=initializer.value_dtype,
+          fingerprint_keys=fingerprint_keys,
           name=scope)
       # pylint: enable=protected-access
 
@@ -163,29 +163,57 @@ def _SegmentMeanGrad(op, grad):
   return array_ops.gather(scaled_grad, op.inputs[1]), None
 
 
+def _SparseSegmentReductionGrad(op, grad, scale_fn=None):
+  """Gradient of the data of a sparse segment reduction, as IndexedSlices.
+
+  Every index gets the gradient of its segment, multiplied by
+  `scale_fn(count)` when given, where count is the size of the segment. The
+  gradient of a large table, such as an embedding, thus stays sparse.
+
+  Args:
+    op: The SparseSegment{Sum,Mean,SqrtN} op.
+    grad: The gradient of its output.
+    scale_fn: None, or a function of the sizes of the segments returning the
+      factor of their gradients.
+
+  Returns:
+    An `IndexedSlices`.
+  """
+  segment_ids = op.inputs[2]
+  if scale_fn is not None:
+    counts = math_ops.segment_sum(
+        array_ops.ones_like(segment_ids, dtype=grad.dtype), segment_ids)
+    scale = scale_fn(math_ops.maximum(counts, 1))
+    # Reshape the factors to allow broadcast.
+    scale = array_ops.reshape(
+        scale,
+        array_ops.concat([
+            array_ops.shape(scale),
+            array_ops.ones([array_ops.rank(grad) - 1], dtype=dtypes.int32)
+        ], 0))
+    grad *= scale
+  return ops.IndexedSlices(
+      array_ops.gather(grad, segment_ids), op.inputs[1],
+      array_ops.shape(op.inputs[0]))
+
+
 @ops.RegisterGradient("SparseSegmentSum")
 def _SparseSegmentSumGrad(op, grad):
   """Gradient for SparseSegmentSum."""
-  input_rows = array_ops.shape(op.inputs[0])[0]
-  return (math_ops.unsorted_segment_sum(
-      array_ops.gather(grad, op.inputs[2]), op.inputs[1], input_rows), None,
-          None)
+  return (_SparseSegmentReductionGrad(op, grad), None, None)
 
 
 @ops.RegisterGradient("SparseSegmentMean")
 def _SparseSegmentMeanGrad(op, grad):
   """Gradient for SparseSegmentMean."""
-  dim0 = array_ops.shape(op.inputs[0])[0]
-  return (math_ops.sparse_segment_mean_grad(grad, op.inputs[1], op.inputs[2],
-                                            dim0), None, None)
+  return (_SparseSegmentReductionGrad(op, grad, math_ops.reciprocal), None,
+          None)
 
 
 @ops.RegisterGradient("SparseSegmentSqrtN")
 def _SparseSegmentSqrtNGrad(op, grad):
   """Gradient for SparseSegmentSqrtN."""
-  dim0 = array_ops.shape(op.inputs[0])[0]
-  return (math_ops.sparse_segment_sqrt_n_grad(grad, op.inputs[1], op.inputs[2],
-                                              dim0), None, None)
+  return (_SparseSegmentReductionGrad(op, grad, math_ops.rsqrt), None, None)
 
 
 def _SegmentMinOrMaxGrad(op, grad, is_sorted):
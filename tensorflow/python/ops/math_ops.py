@@ -1808,8 +1808,8 @@ def matmul(a,
     use_sparse_matmul = (a.dtype in sparse_matmul_types and
                          b.dtype in sparse_matmul_types and
                          (a_is_sparse or b_is_sparse))
-    if dtypes.bfloat16 in (a.dtype, b.dtype):
-      # matmul currently doesn't handle bfloat16 inputs.
+    if dtypes.bfloat16 in (a.dtype, b.dtype) and a.dtype != b.dtype:
+      # matmul doesn't handle mixed bfloat16 and float32 inputs.
       use_sparse_matmul = True
     if use_sparse_matmul:
       return sparse_matmul(
@@ -22,6 +22,7 @@ from __future__ import print_function
 import collections
 import os.path
 import re
+import threading
 import time
 import uuid
 
@@ -177,8 +178,14 @@ class BaseSaverBuilder(object):
       return resource_variable_ops.assign_variable_op(
           self.handle_op, restored_tensor)
 
-  def __init__(self, write_version=saver_pb2.SaverDef.V2):
+  def __init__(self, write_version=saver_pb2.SaverDef.V2, async_write=False,
+               num_data_shards=1, data_alignment=1):
     self._write_version = write_version
+    self._async_write = async_write
+    self._num_data_shards = num_data_shards
+    self._data_alignment = data_alignment
+    # The save ops with async_write added by the last build().
+    self._async_save_ops = []
 
   def save_op(self, filename_tensor, saveables):
     """Create an Op to save 'saveables'.
@@ -215,8 +222,15 @@ class BaseSaverBuilder(object):
     elif self._write_version == saver_pb2.SaverDef.V2:
       # "filename_tensor" is interpreted *NOT AS A FILENAME*, but as a prefix
       # of a V2 checkpoint: e.g. "/fs/train/ckpt-<step>/tmp/worker<i>-<step>".
+      kwargs = {}
+      if self._async_write:
+        kwargs["async_write"] = True
+      if self._num_data_shards > 1:
+        kwargs["num_shards"] = self._num_data_shards
+      if self._data_alignment > 1:
+        kwargs["data_alignment"] = self._data_alignment
       return io_ops.save_v2(filename_tensor, tensor_names, tensor_slices,
-                            tensors)
+                            tensors, **kwargs)
     else:
       raise RuntimeError("Unexpected write_version: " + self._write_version)
 
@@ -274,8 +288,43 @@ class BaseSaverBuilder(object):
       A tensor with the filename used to save.
     """
     save = self.save_op(filename_tensor, saveables)
+    if self._async_write:
+      self._async_save_ops.append(save)
     return control_flow_ops.with_dependencies([save], filename_tensor)
 
+  def _AddWaitForAsyncSavesOps(self, save_ops):
+    """Add ops to wait for the asynchronous writes of some save ops.
+
+    Each device queues its own asynchronous writes, so there is one wait op per
+    save op, colocated with it.
+
+    Args:
+      save_ops: A list of the save ops added with `async_write`.
+
+    Returns:
+      A list of WaitForAsyncSaves operations.
+    """
+    waits = []
+    for save in save_ops:
+      with ops.colocate_with(save):
+        waits.append(io_ops.wait_for_async_saves())
+    return waits
+
+  def wait_for_async_saves_op(self):
+    """Create an Op to wait for the asynchronous writes of the last build().
+
+    This waits on every device that saved with `async_write`, which includes
+    the device that merged the shards.
+
+    Returns:
+      An Operation that waits for the writes and raises their first error, or
+      None if no save op was added with `async_write`.
+    """
+    if not self._async_save_ops:
+      return None
+    return control_flow_ops.group(
+        *self._AddWaitForAsyncSavesOps(self._async_save_ops))
+
   def _AddShardedSaveOpsForV2(self, checkpoint_prefix, per_device):
     """Add ops to save the params per shard, for the V2 format.
 
@@ -339,8 +388,19 @@ class BaseSaverBuilder(object):
       with ops.device(last_device):
         # V2 format write path consists of a metadata merge step.  Once merged,
         # attempts to delete the temporary directory, "<user-fed prefix>_temp".
-        merge_step = gen_io_ops.merge_v2_checkpoints(
-            sharded_prefixes, checkpoint_prefix, delete_old_dirs=True)
+        if self._async_write:
+          # The merge is queued after the shard written on the last device,
+          # but each device queues its own writes: the shards written on the
+          # other devices have to be waited for.
+          shard_save_ops = self._async_save_ops[-num_shards:]
+          with ops.control_dependencies(
+              self._AddWaitForAsyncSavesOps(shard_save_ops[:-1])):
+            merge_step = gen_io_ops.merge_v2_checkpoints(
+                sharded_prefixes, checkpoint_prefix, delete_old_dirs=True,
+                async_write=True)
+        else:
+          merge_step = gen_io_ops.merge_v2_checkpoints(
+              sharded_prefixes, checkpoint_prefix, delete_old_dirs=True)
         with ops.control_dependencies([merge_step]):
           # Returns the prefix "<user-fed prefix>" only.  DOES NOT include the
           # sharded spec suffix.
@@ -670,6 +730,7 @@ class BaseSaverBuilder(object):
     saveables = self._ValidateAndSliceInputs(names_to_saveables)
     if max_to_keep is None:
       max_to_keep = 0
+    self._async_save_ops = []
 
     with ops.name_scope(name, "save",
                         [saveable.op for saveable in saveables]) as name:
@@ -1034,7 +1095,10 @@ class Saver(object):
                write_version=saver_pb2.SaverDef.V2,
                pad_step_number=False,
                save_relative_paths=False,
-               filename=None):
+               filename=None,
+               async_write=False,
+               num_data_shards=1,
+               data_alignment=1):
     """Creates a `Saver`.
 
     The constructor adds ops to save and restore variables.
@@ -1112,6 +1176,17 @@ class Saver(object):
         checkpoint directory and reload from the copied directory.
       filename: If known at graph construction time, filename used for variable
         loading/saving.
+      async_write: If `True`, `save()` returns once the variables are copied,
+        and the checkpoint is written in the background.  Only for the V2
+        format, in-process sessions and the default builder.  Call
+        `wait_for_async_save()` to wait for the write to complete.
+      num_data_shards: The maximum number of data files that each save of the
+        V2 format splits the variables of a device among, and writes
+        concurrently.  Each file holds at least 32MB of variables.
+      data_alignment: The alignment in bytes of the variables in the data files
+        of the V2 format.  Use 64 for checkpoints whose variables are to be
+        restored from memory mappings of the files, e.g. by
+        `LoadSavedModel()` with `map_variables`.
 
     Raises:
       TypeError: If `var_list` is invalid.
@@ -1136,6 +1211,17 @@ class Saver(object):
     self._write_version = write_version
     self._pad_step_number = pad_step_number
     self._filename = filename
+    self._async_write = async_write
+    self._num_data_shards = num_data_shards
+    self._data_alignment = data_alignment
+    self._wait_for_async_saves_op = None
+    self._async_save_thread = None
+    self._async_save_error = None
+    # The arguments of _RecordCheckpoint() for the checkpoint being written in
+    # the background, if it is to be recorded.
+    self._async_save_record = None
+    if async_write and write_version != saver_pb2.SaverDef.V2:
+      raise ValueError("async_write requires the V2 checkpoint format.")
     if not defer_build:
       self.build()
     if self.saver_def:
@@ -1150,7 +1236,10 @@ class Saver(object):
     self._is_built = True
     if not self.saver_def:
       if self._builder is None:
-        self._builder = BaseSaverBuilder(self._write_version)
+        self._builder = BaseSaverBuilder(
+            self._write_version, async_write=self._async_write,
+            num_data_shards=self._num_data_shards,
+            data_alignment=self._data_alignment)
       if self._var_list is None:
         # pylint: disable=protected-access
         self._var_list = variables._all_saveable_objects()
@@ -1170,6 +1259,8 @@ class Saver(object):
           name=self._name,
           restore_sequentially=self._restore_sequentially,
           filename=self._filename)
+      if self._async_write:
+        self._wait_for_async_saves_op = self._builder.wait_for_async_saves_op()
     elif self.saver_def and self._name:
       # Since self._name is used as a name_scope by builder(), we are
       # overloading the use of this field to represent the "import_scope" as
@@ -1399,7 +1490,10 @@ class Saver(object):
     save must also have been initialized.
 
     The method returns the path of the newly created checkpoint file.  This
-    path can be passed directly to a call to `restore()`.
+    path can be passed directly to a call to `restore()`.  With `async_write`,
+    the checkpoint is written in the background, and can be restored and is
+    recorded in the checkpoint state file once `wait_for_async_save()` or the
+    next `save()` returns.
 
     Args:
       sess: A Session to use to save the variables.
@@ -1467,21 +1561,27 @@ class Saver(object):
       raise TypeError("'sess' must be a Session; %s" % sess)
 
     save_path_parent = os.path.dirname(save_path)
+    async_write = self._async_write and self._wait_for_async_saves_op
     if not self._is_empty:
       try:
+        if async_write:
+          # Writes at most one checkpoint in the background at a time.
+          self.wait_for_async_save()
         model_checkpoint_path = sess.run(
             self.saver_def.save_tensor_name,
             {self.saver_def.filename_tensor_name: checkpoint_file})
         model_checkpoint_path = compat.as_str(model_checkpoint_path)
-        if write_state:
-          self._MaybeDeleteOldCheckpoints(
-              model_checkpoint_path, meta_graph_suffix=meta_graph_suffix)
-          _update_checkpoint_state(
-              save_dir=save_path_parent,
-              model_checkpoint_path=model_checkpoint_path,
-              all_model_checkpoint_paths=self.last_checkpoints,
-              latest_filename=latest_filename,
-              save_relative_paths=self._save_relative_paths)
+        if async_write:
+          if write_state:
+            self._async_save_record = (model_checkpoint_path,
+                                       meta_graph_suffix, save_path_parent,
+                                       latest_filename)
+          self._async_save_thread = threading.Thread(
+              target=self._WaitForAsyncWrite, args=(sess,))
+          self._async_save_thread.start()
+        elif write_state:
+          self._RecordCheckpoint(model_checkpoint_path, meta_graph_suffix,
+                                 save_path_parent, latest_filename)
       except (errors.FailedPreconditionError, errors.NotFoundError) as exc:
         if not gfile.IsDirectory(save_path_parent):
           exc = ValueError(
@@ -1500,6 +1600,46 @@ class Saver(object):
     else:
       return model_checkpoint_path
 
+  def _RecordCheckpoint(self, model_checkpoint_path, meta_graph_suffix,
+                        save_path_parent, latest_filename):
+    """Adds a saved checkpoint to the checkpoint state file."""
+    self._MaybeDeleteOldCheckpoints(
+        model_checkpoint_path, meta_graph_suffix=meta_graph_suffix)
+    _update_checkpoint_state(
+        save_dir=save_path_parent,
+        model_checkpoint_path=model_checkpoint_path,
+        all_model_checkpoint_paths=self.last_checkpoints,
+        latest_filename=latest_filename,
+        save_relative_paths=self._save_relative_paths)
+
+  def _WaitForAsyncWrite(self, sess):
+    """Waits for a background write, on the thread started by `save()`."""
+    try:
+      sess.run(self._wait_for_async_saves_op)
+    except Exception as e:  # pylint: disable=broad-except
+      self._async_save_error = e
+
+  def wait_for_async_save(self):
+    """Waits for the checkpoint written in the background by `save()`.
+
+    Only needed with `async_write`.  Once it returns, the checkpoint is
+    complete and recorded in the checkpoint state file, which is only updated
+    by this method and the next `save()`, on the calling thread.  The session
+    passed to `save()` must still be open.
+
+    Raises:
+      The error of the background write, if any.
+    """
+    if self._async_save_thread is not None:
+      self._async_save_thread.join()
+      self._async_save_thread = None
+    record, self._async_save_record = self._async_save_record, None
+    if self._async_save_error is not None:
+      error, self._async_save_error = self._async_save_error, None
+      raise error
+    if record is not None:
+      self._RecordCheckpoint(*record)
+
   def export_meta_graph(self,
                         filename=None,
                         collection_list=None,
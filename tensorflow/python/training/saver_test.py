@@ -563,6 +563,30 @@ class SaverTest(test.TestCase):
   def testSaveWithGlobalStepWithPadding(self):
     self.testSaveWithGlobalStep(pad_step_number=True)
 
+  def testAsyncWrite(self):
+    for sharded in [False, True]:
+      save_dir = os.path.join(self.get_temp_dir(), "async_write_%s" % sharded)
+      save_path = os.path.join(save_dir, "ckpt")
+      with self.test_session(graph=ops_lib.Graph()) as sess:
+        v0 = variables.Variable(10.0, name="v0")
+        v1 = variables.Variable([1.0, 2.0], name="v1")
+        save = saver_module.Saver(
+            {"v0": v0, "v1": v1}, sharded=sharded, async_write=True)
+        variables.global_variables_initializer().run()
+        val = save.save(sess, save_path, global_step=1)
+        # The save snapshots the variables before it returns.
+        sess.run(v0.assign(20.0))
+        val2 = save.save(sess, save_path, global_step=2)
+        save.wait_for_async_save()
+        self.assertEqual(val2, saver_module.latest_checkpoint(save_dir))
+        self.assertEqual([val, val2], save.last_checkpoints)
+
+        save.restore(sess, val)
+        self.assertEqual(10.0, v0.eval())
+        self.assertAllEqual([1.0, 2.0], v1.eval())
+        save.restore(sess, val2)
+        self.assertEqual(20.0, v0.eval())
+
   def testSaveToNonexistingPath(self):
     file_io.write_string_to_file(
         os.path.join(self.get_temp_dir(), "actually_a_file"), "")
@@ -636,6 +660,48 @@ class SaveRestoreShardedTest(test.TestCase):
     gfile.MakeDirs(test_dir)
     return test_dir
 
+  def testAsyncWrite(self):
+    save_dir = self._get_test_dir("sharded_async_write")
+    save_path = os.path.join(save_dir, "ckpt")
+
+    with session.Session(
+        target="",
+        config=config_pb2.ConfigProto(device_count={"CPU": 2})) as sess:
+      with sess.graph.device("/cpu:0"):
+        v0 = variables.Variable(10.0, name="v0")
+      with sess.graph.device("/cpu:1"):
+        v1 = variables.Variable(20.0, name="v1")
+      save = saver_module.Saver(
+          {"v0": v0, "v1": v1}, sharded=True, async_write=True)
+
+      # The merge, on the last device, waits for the shard of the other one.
+      merge = [op for op in sess.graph.get_operations()
+               if op.type == "MergeV2Checkpoints"]
+      self.assertEqual(1, len(merge))
+      self.assertEqual("/device:CPU:1", merge[0].device)
+      merge_waits = [op for op in merge[0].control_inputs
+                     if op.type == "WaitForAsyncSaves"]
+      self.assertEqual(["/device:CPU:0"], [op.device for op in merge_waits])
+      # The saver also waits on both devices.
+      waits = [op for op in sess.graph.get_operations()
+               if op.type == "WaitForAsyncSaves"]
+      self.assertEqual(["/device:CPU:0", "/device:CPU:0", "/device:CPU:1"],
+                       sorted(op.device for op in waits))
+
+      variables.global_variables_initializer().run()
+      val = save.save(sess, save_path, global_step=1)
+      sess.run([v0.assign(11.0), v1.assign(21.0)])
+      val2 = save.save(sess, save_path, global_step=2)
+      save.wait_for_async_save()
+      self.assertEqual(val2, saver_module.latest_checkpoint(save_dir))
+
+      save.restore(sess, val)
+      self.assertEqual(10.0, v0.eval())
+      self.assertEqual(20.0, v1.eval())
+      save.restore(sess, val2)
+      self.assertEqual(11.0, v0.eval())
+      self.assertEqual(21.0, v1.eval())
+
   def testBasics(self):
     save_path = os.path.join(self.get_temp_dir(), "sharded_basics")
 
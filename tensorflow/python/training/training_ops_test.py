@@ -241,6 +241,88 @@ class TrainingOpsTest(TensorFlowTestCase):
       indices = np.array([0, 2]).astype(index_type)
       self._testTypesForSparseFtrl(x, y, z, lr, grad, indices)
 
+  def testSparseApplyAdagradDuplicateIndices(self):
+    # Enough updates to be split among threads. The updates of each row are
+    # made in order, as when they are made one after the other.
+    np.random.seed(1)
+    x = np.random.rand(50, 2).astype(np.float32)
+    y = np.random.rand(50, 2).astype(np.float32) + 1.0
+    lr = np.array(0.1).astype(np.float32)
+    indices = np.random.randint(0, 50, size=1000).astype(np.int32)
+    grad = np.random.rand(1000, 2).astype(np.float32)
+    expected_var = np.copy(x)
+    expected_accum = np.copy(y)
+    for (i, index) in enumerate(indices):
+      expected_accum[index] += grad[i] * grad[i]
+      expected_var[index] -= lr * grad[i] / np.sqrt(expected_accum[index])
+    with self.test_session(use_gpu=False):
+      var = variables.Variable(x)
+      accum = variables.Variable(y)
+      variables.global_variables_initializer().run()
+      training_ops.sparse_apply_adagrad(var, accum, lr, grad, indices).eval()
+      self.assertAllClose(expected_var, var.eval())
+      self.assertAllClose(expected_accum, accum.eval())
+
+  def testSparseApplyAdagradHogwild(self):
+    # Without duplicate indices the result does not depend on the order of
+    # the updates.
+    np.random.seed(1)
+    x = np.random.rand(1000, 2).astype(np.float32)
+    y = np.random.rand(1000, 2).astype(np.float32) + 1.0
+    lr = np.array(0.1).astype(np.float32)
+    indices = np.random.permutation(1000).astype(np.int64)
+    grad = np.random.rand(1000, 2).astype(np.float32)
+    with self.test_session(use_gpu=False):
+      var = variables.Variable(x)
+      accum = variables.Variable(y)
+      variables.global_variables_initializer().run()
+      training_ops.sparse_apply_adagrad(
+          var, accum, lr, grad, indices, hogwild=True).eval()
+      expected_accum = np.copy(y)
+      expected_accum[indices] += grad * grad
+      expected_var = np.copy(x)
+      expected_var[indices] -= lr * grad / np.sqrt(expected_accum[indices])
+      self.assertAllClose(expected_var, var.eval())
+      self.assertAllClose(expected_accum, accum.eval())
+
+  def testSparseApplyAdagradOutOfRangeIndex(self):
+    x = np.arange(10).astype(np.float32).reshape([5, 2])
+    y = np.ones([5, 2]).astype(np.float32)
+    with self.test_session(use_gpu=False):
+      var = variables.Variable(x)
+      accum = variables.Variable(y)
+      variables.global_variables_initializer().run()
+      update = training_ops.sparse_apply_adagrad(
+          var, accum, 0.1, np.ones([3, 2]).astype(np.float32),
+          np.array([0, 5, 1]).astype(np.int32))
+      with self.assertRaisesOpError(
+          "Index 5 at offset 1 in indices is out of range"):
+        update.eval()
+      # No row is updated when an index is out of range.
+      self.assertAllClose(x, var.eval())
+      self.assertAllClose(y, accum.eval())
+
+  def testMultiApplyMomentum(self):
+    # Variables of different sizes, one large enough to be split in blocks.
+    np.random.seed(1)
+    sizes = [3, 1, 40000]
+    xs = [np.random.rand(n).astype(np.float32) for n in sizes]
+    ys = [np.random.rand(n).astype(np.float32) for n in sizes]
+    grads = [np.random.rand(n).astype(np.float32) for n in sizes]
+    lr = np.array(0.1).astype(np.float32)
+    momentum = np.array(0.9).astype(np.float32)
+    with self.test_session(use_gpu=False):
+      var = [variables.Variable(x) for x in xs]
+      accum = [variables.Variable(y) for y in ys]
+      variables.global_variables_initializer().run()
+      training_ops.multi_apply_momentum(var, accum, lr, grads,
+                                        momentum)[0].op.run()
+      for i in range(len(sizes)):
+        expected_accum = ys[i] * momentum + grads[i]
+        expected_var = xs[i] - lr * expected_accum
+        self.assertAllClose(expected_var, var[i].eval())
+        self.assertAllClose(expected_accum, accum[i].eval())
+
   def testApplyAdam(self):
     for dtype, use_gpu in itertools.product(
         [np.float16, np.float32, np.float64], [False, True]):
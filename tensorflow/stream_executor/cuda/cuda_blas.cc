@@ -265,6 +265,10 @@ PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSgemmEx)
 
 #if CUDA_VERSION >= 8000
 PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasGemmEx)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasDgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasCgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasZgemmStridedBatched)
 #endif
 
 }  // namespace wrap
@@ -376,14 +380,17 @@ CUDABlas::~CUDABlas() {
   if (blas_ != nullptr) {
     wrap::cublasDestroy(parent_, blas_);
   }
+  for (auto &stream_handle : stream_handles_) {
+    wrap::cublasDestroy(parent_, stream_handle.second->handle);
+  }
 }
 
-bool CUDABlas::SetStream(Stream *stream) {
+bool CUDABlas::SetStream(Stream *stream, cublasHandle_t handle) {
   CHECK(stream != nullptr);
   CHECK(AsCUDAStreamValue(stream) != nullptr);
-  CHECK(blas_ != nullptr);
+  CHECK(handle != nullptr);
   cublasStatus_t ret =
-      wrap::cublasSetStream(parent_, blas_, AsCUDAStreamValue(stream));
+      wrap::cublasSetStream(parent_, handle, AsCUDAStreamValue(stream));
   if (ret != CUBLAS_STATUS_SUCCESS) {
     LOG(ERROR) << "failed to set stream for cuBLAS calls: " << ToString(ret);
     return false;
@@ -392,6 +399,39 @@ bool CUDABlas::SetStream(Stream *stream) {
   return true;
 }
 
+CUDABlas::StreamHandle *CUDABlas::GetStreamHandle(Stream *stream) {
+  CHECK(stream != nullptr);
+  void *cuda_stream = AsCUDAStreamValue(stream);
+  CHECK(cuda_stream != nullptr);
+
+  mutex_lock lock{mu_};
+  auto it = stream_handles_.find(cuda_stream);
+  if (it != stream_handles_.end()) {
+    return it->second.get();
+  }
+
+  cublasHandle_t handle = blas_;
+  if (handle != nullptr) {
+    blas_ = nullptr;
+  } else {
+    cublasStatus_t ret = wrap::cublasCreate(parent_, &handle);
+    if (ret != CUBLAS_STATUS_SUCCESS) {
+      LOG(ERROR) << "failed to create cublas handle: " << ToString(ret);
+      return nullptr;
+    }
+  }
+  if (!SetStream(stream, handle)) {
+    wrap::cublasDestroy(parent_, handle);
+    return nullptr;
+  }
+
+  std::unique_ptr<StreamHandle> stream_handle{new StreamHandle};
+  stream_handle->handle = handle;
+  StreamHandle *result = stream_handle.get();
+  stream_handles_.emplace(cuda_stream, std::move(stream_handle));
+  return result;
+}
+
 namespace {
 
 // Helper functions transforming blas arguments into cuBLAS arguments.
@@ -525,20 +565,19 @@ template <typename FuncT, typename... Args>
 bool CUDABlas::DoBlasInternalImpl(FuncT cublas_func, Stream *stream,
                                   bool pointer_mode_host, bool err_on_failure,
                                   Args... args) {
-  mutex_lock lock{mu_};
-
-  CHECK(blas_ != nullptr);
-  if (!SetStream(stream)) {
+  StreamHandle *stream_handle = GetStreamHandle(stream);
+  if (stream_handle == nullptr) {
     return false;
   }
+  mutex_lock lock{stream_handle->mu};
 
-  ScopedCublasPointerMode pointer_mode{parent_, blas_};
+  ScopedCublasPointerMode pointer_mode{parent_, stream_handle->handle};
   if (!pointer_mode.Init(pointer_mode_host ? CUBLAS_POINTER_MODE_HOST
                                            : CUBLAS_POINTER_MODE_DEVICE)) {
     return false;
   }
 
-  cublasStatus_t ret = cublas_func(parent_, blas_, args...);
+  cublasStatus_t ret = cublas_func(parent_, stream_handle->handle, args...);
   if (err_on_failure && ret != CUBLAS_STATUS_SUCCESS) {
     LOG(ERROR) << "failed to run cuBLAS routine " << cublas_func.kName << ": "
                << ToString(ret);
@@ -2130,6 +2169,114 @@ bool CUDABlas::DoBlasGemmBatched(
   return status.ok();
 }
 
+template <typename T>
+bool CUDABlas::DoBlasGemmStridedBatchedFallback(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, T alpha, const DeviceMemory<T> &a, int lda,
+    int64 stride_a, const DeviceMemory<T> &b, int ldb, int64 stride_b, T beta,
+    DeviceMemory<T> *c, int ldc, int64 stride_c, int batch_count,
+    ScratchAllocator *scratch_allocator) {
+  std::vector<DeviceMemory<T>> a_matrices, b_matrices, c_matrices;
+  std::vector<DeviceMemory<T> *> a_ptrs, b_ptrs, c_ptrs;
+  a_matrices.reserve(batch_count);
+  b_matrices.reserve(batch_count);
+  c_matrices.reserve(batch_count);
+  T *a_base = const_cast<T *>(CUDAMemory(a));
+  T *b_base = const_cast<T *>(CUDAMemory(b));
+  T *c_base = CUDAMemoryMutable(c);
+  for (int i = 0; i < batch_count; ++i) {
+    a_matrices.emplace_back(DeviceMemoryBase(a_base + i * stride_a));
+    b_matrices.emplace_back(DeviceMemoryBase(b_base + i * stride_b));
+    c_matrices.emplace_back(DeviceMemoryBase(c_base + i * stride_c));
+    a_ptrs.push_back(&a_matrices.back());
+    b_ptrs.push_back(&b_matrices.back());
+    c_ptrs.push_back(&c_matrices.back());
+  }
+  return DoBlasGemmBatched(stream, transa, transb, m, n, k, alpha, a_ptrs, lda,
+                           b_ptrs, ldb, beta, c_ptrs, ldc, batch_count,
+                           scratch_allocator);
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, float alpha, const DeviceMemory<float> &a, int lda,
+    int64 stride_a, const DeviceMemory<float> &b, int ldb, int64 stride_b,
+    float beta, DeviceMemory<float> *c, int ldc, int64 stride_c,
+    int batch_count, ScratchAllocator *scratch_allocator) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasSgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
+      CUDAMemory(a), lda, stride_a, CUDAMemory(b), ldb, stride_b, &beta,
+      CUDAMemoryMutable(c), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedFallback(
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count, scratch_allocator);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, double alpha, const DeviceMemory<double> &a, int lda,
+    int64 stride_a, const DeviceMemory<double> &b, int ldb, int64 stride_b,
+    double beta, DeviceMemory<double> *c, int ldc, int64 stride_c,
+    int batch_count, ScratchAllocator *scratch_allocator) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasDgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
+      CUDAMemory(a), lda, stride_a, CUDAMemory(b), ldb, stride_b, &beta,
+      CUDAMemoryMutable(c), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedFallback(
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count, scratch_allocator);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, std::complex<float> alpha,
+    const DeviceMemory<std::complex<float>> &a, int lda, int64 stride_a,
+    const DeviceMemory<std::complex<float>> &b, int ldb, int64 stride_b,
+    std::complex<float> beta, DeviceMemory<std::complex<float>> *c, int ldc,
+    int64 stride_c, int batch_count, ScratchAllocator *scratch_allocator) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasCgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k,
+      CUDAComplex(&alpha), CUDAComplex(CUDAMemory(a)), lda, stride_a,
+      CUDAComplex(CUDAMemory(b)), ldb, stride_b, CUDAComplex(&beta),
+      CUDAComplex(CUDAMemoryMutable(c)), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedFallback(
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count, scratch_allocator);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, std::complex<double> alpha,
+    const DeviceMemory<std::complex<double>> &a, int lda, int64 stride_a,
+    const DeviceMemory<std::complex<double>> &b, int ldb, int64 stride_b,
+    std::complex<double> beta, DeviceMemory<std::complex<double>> *c, int ldc,
+    int64 stride_c, int batch_count, ScratchAllocator *scratch_allocator) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasZgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k,
+      CUDAComplex(&alpha), CUDAComplex(CUDAMemory(a)), lda, stride_a,
+      CUDAComplex(CUDAMemory(b)), ldb, stride_b, CUDAComplex(&beta),
+      CUDAComplex(CUDAMemoryMutable(c)), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedFallback(
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count, scratch_allocator);
+#endif
+}
+
 bool CUDABlas::DoBlasHemm(Stream *stream, blas::Side side,
                           blas::UpperLower uplo, uint64 m, uint64 n,
                           std::complex<float> alpha,
@@ -20,6 +20,9 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_BLAS_H_
 #define TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_BLAS_H_
 
+#include <map>
+#include <memory>
+
 #include "tensorflow/stream_executor/blas.h"
 #include "tensorflow/stream_executor/lib/stringpiece.h"
 #include "tensorflow/stream_executor/platform/mutex.h"
@@ -45,10 +48,10 @@ class CUDAExecutor;
 //
 // This satisfies the platform-agnostic BlasSupport interface.
 //
-// Note that the cuBLAS handle that this encapsulates is implicitly tied to the
-// context (and, as a result, the device) that the parent CUDAExecutor is tied
-// to. This simply happens as an artifact of creating the cuBLAS handle when a
-// CUDA context is active.
+// Note that the cuBLAS handles that this encapsulates are implicitly tied to
+// the context (and, as a result, the device) that the parent CUDAExecutor is
+// tied to. This simply happens as an artifact of creating the cuBLAS handles
+// when a CUDA context is active.
 //
 // Thread-safe post-initialization.
 class CUDABlas : public blas::BlasSupport {
@@ -58,18 +61,37 @@ class CUDABlas : public blas::BlasSupport {
   // Allocates a cuBLAS handle.
   bool Init();
 
-  // Releases the cuBLAS handle, if present.
+  // Releases the cuBLAS handles, if present.
   ~CUDABlas() override;
 
   TENSORFLOW_STREAM_EXECUTOR_GPU_BLAS_SUPPORT_OVERRIDES
 
  private:
-  // Tells cuBLAS to enqueue the BLAS operation onto a particular Stream.
+  // A cuBLAS handle which enqueues onto one stream.
+  struct StreamHandle {
+    // Guards the use of the handle, since changes of its state, e.g. the
+    // pointer mode, must not interleave between threads.
+    mutex mu;
+
+    // Immutable post-initialization.
+    cublasHandle_t handle;
+  };
+
+  // Tells cuBLAS to enqueue the BLAS operations of handle onto a particular
+  // Stream.
   //
   // cuBLAS is stateful, and only be associated with one stream (in order to
-  // enqueue dispatch) at a given time. As a result, this generally must be
-  // invoked before calling into cuBLAS.
-  bool SetStream(Stream *stream) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // enqueue dispatch) at a given time. As a result, this must be invoked
+  // before calling into cuBLAS with a new handle.
+  bool SetStream(Stream *stream, cublasHandle_t handle);
+
+  // Returns the handle which enqueues onto stream, creating it on first use,
+  // or nullptr if it can't be created.
+  //
+  // Each stream has its own handle, so the BLAS operations on different
+  // streams don't serialize on one mutex, and the stream of a handle is set
+  // only once.
+  StreamHandle *GetStreamHandle(Stream *stream) LOCKS_EXCLUDED(mu_);
 
   // A helper function that calls the real cuBLAS function together with error
   // handling.
@@ -112,6 +134,17 @@ class CUDABlas : public blas::BlasSupport {
       const port::ArraySlice<DeviceMemory<T> *> &c_array, int ldc,
       int batch_count, ScratchAllocator *scratch_allocator);
 
+  // A helper function to implement DoBlasGemmStridedBatched with
+  // DoBlasGemmBatched, for the versions of cuBLAS without
+  // cublas<T>gemmStridedBatched.
+  template <typename T>
+  bool DoBlasGemmStridedBatchedFallback(
+      Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+      uint64 n, uint64 k, T alpha, const DeviceMemory<T> &a, int lda,
+      int64 stride_a, const DeviceMemory<T> &b, int ldb, int64 stride_b,
+      T beta, DeviceMemory<T> *c, int ldc, int64 stride_c, int batch_count,
+      ScratchAllocator *scratch_allocator);
+
   // Helper function for implementing DoBlasGemmWithAlgorithm.
   //
   // We take alpha and beta by const reference because T might be Eigen::half,
@@ -129,16 +162,23 @@ class CUDABlas : public blas::BlasSupport {
                                    blas::AlgorithmType algorithm,
                                    blas::ProfileResult *output_profile_result);
 
-  // mutex that guards the cuBLAS handle for this device.
+  // mutex that guards the cuBLAS handles for this device.
   mutex mu_;
 
   // CUDAExecutor which instantiated this CUDABlas.
   // Immutable post-initialization.
   CUDAExecutor *parent_;
 
-  // cuBLAS library handle on the device.
+  // cuBLAS library handle created by Init, which is not bound to a stream
+  // yet. It is given to the first stream.
   cublasHandle_t blas_ GUARDED_BY(mu_);
 
+  // cuBLAS library handles on the device, keyed by the CUstream they enqueue
+  // onto. Entries are never removed, since there are only a few streams per
+  // device.
+  std::map<void *, std::unique_ptr<StreamHandle>> stream_handles_
+      GUARDED_BY(mu_);
+
   SE_DISALLOW_COPY_AND_ASSIGN(CUDABlas);
 };
 
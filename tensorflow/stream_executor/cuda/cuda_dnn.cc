@@ -243,13 +243,28 @@ CUDNN_DNN_ROUTINE_EACH_R5(PERFTOOLS_GPUTOOLS_CUDNN_WRAP)
 // clang-format off
 #if CUDNN_VERSION >= 6000
 #define CUDNN_DNN_ROUTINE_EACH_R6(__macro)                    \
-  __macro(cudnnConvolutionBiasActivationForward)
+  __macro(cudnnConvolutionBiasActivationForward)              \
+  __macro(cudnnSetRNNDescriptor_v6)                           \
+  __macro(cudnnCreatePersistentRNNPlan)                       \
+  __macro(cudnnSetPersistentRNNPlan)                          \
+  __macro(cudnnDestroyPersistentRNNPlan)
 
 // clang-format on
 CUDNN_DNN_ROUTINE_EACH_R6(PERFTOOLS_GPUTOOLS_CUDNN_WRAP)
 #undef CUDNN_DNN_ROUTINE_EACH_R6
 #endif
 
+// APIs in R7
+// clang-format off
+#if CUDNN_VERSION >= 7000
+#define CUDNN_DNN_ROUTINE_EACH_R7(__macro)                    \
+  __macro(cudnnSetRNNMatrixMathType)
+
+// clang-format on
+CUDNN_DNN_ROUTINE_EACH_R7(PERFTOOLS_GPUTOOLS_CUDNN_WRAP)
+#undef CUDNN_DNN_ROUTINE_EACH_R7
+#endif
+
 #undef CUDNN_DNN_ROUTINE_EACH
 
 }  // namespace wrap
@@ -585,6 +600,70 @@ class ScopedConvolutionDescriptor {
   SE_DISALLOW_COPY_AND_ASSIGN(ScopedConvolutionDescriptor);
 };
 
+namespace {
+
+// The number of cudnn descriptors of each kind kept by CudnnSupport. A full
+// cache is simply cleared, which is rare since models use few shapes.
+constexpr size_t kMaxCachedDescriptors = 256;
+
+// Returns the descriptor for key in cache, made by create if it's missing.
+template <typename Descriptor, typename CreateFunc>
+std::shared_ptr<Descriptor> GetCachedDescriptor(
+    const string& key, CreateFunc create,
+    std::unordered_map<string, std::shared_ptr<Descriptor>>* cache) {
+  auto it = cache->find(key);
+  if (it != cache->end()) {
+    return it->second;
+  }
+  if (cache->size() >= kMaxCachedDescriptors) {
+    cache->clear();
+  }
+  std::shared_ptr<Descriptor> descriptor{create()};
+  cache->emplace(key, descriptor);
+  return descriptor;
+}
+
+}  // namespace
+
+std::shared_ptr<ScopedTensorDescriptor> CudnnSupport::GetTensorDescriptor(
+    const BatchDescriptor& batch_descriptor, int cudnn_type) {
+  return GetCachedDescriptor(
+      port::StrCat(batch_descriptor.ToShortString(), "/", cudnn_type),
+      [this, &batch_descriptor, cudnn_type]() {
+        return new ScopedTensorDescriptor{
+            parent_, batch_descriptor,
+            static_cast<cudnnDataType_t>(cudnn_type)};
+      },
+      &tensor_descriptors_);
+}
+
+std::shared_ptr<ScopedFilterDescriptor> CudnnSupport::GetFilterDescriptor(
+    const FilterDescriptor& filter_descriptor,
+    const BatchDescriptor& batch_descriptor, int cudnn_type) {
+  // The batch descriptor doesn't change the cudnn filter descriptor.
+  return GetCachedDescriptor(
+      port::StrCat(filter_descriptor.ToShortString(), "/", cudnn_type),
+      [this, &filter_descriptor, &batch_descriptor, cudnn_type]() {
+        return new ScopedFilterDescriptor{
+            parent_, filter_descriptor, batch_descriptor,
+            static_cast<cudnnDataType_t>(cudnn_type)};
+      },
+      &filter_descriptors_);
+}
+
+std::shared_ptr<ScopedConvolutionDescriptor>
+CudnnSupport::GetConvolutionDescriptor(
+    const ConvolutionDescriptor& convolution_descriptor, int cudnn_type) {
+  return GetCachedDescriptor(
+      port::StrCat(convolution_descriptor.ToShortString(), "/", cudnn_type),
+      [this, &convolution_descriptor, cudnn_type]() {
+        return new ScopedConvolutionDescriptor{
+            parent_, convolution_descriptor,
+            static_cast<cudnnDataType_t>(cudnn_type)};
+      },
+      &convolution_descriptors_);
+}
+
 // Turns a PoolingDescriptor structure into a cudnn pooling descriptor handle
 // within a scope.
 class ScopedPoolingDescriptor {
@@ -966,6 +1045,7 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
                      cudnnRNNInputMode_t input_mode,
                      cudnnDirectionMode_t direction_mode,
                      cudnnRNNMode_t rnn_mode, cudnnDataType_t data_type,
+                     dnn::RnnAlgorithm algorithm, bool use_tensor_op_math,
                      float dropout, uint64 seed,
                      ScratchAllocator* state_allocator)
       : parent_(parent),
@@ -976,7 +1056,17 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
         input_mode_(input_mode),
         direction_mode_(direction_mode),
         rnn_mode_(rnn_mode),
-        data_type_(data_type) {
+        data_type_(data_type),
+        algorithm_(algorithm) {
+#if CUDNN_VERSION < 6000
+    if (algorithm != dnn::RnnAlgorithm::kRnnStandard) {
+      SetFailure(port::Status(
+          port::error::UNIMPLEMENTED,
+          port::StrCat("Persistent RNN algorithms need at least Cudnn 6.0. ",
+                       "Current Cudnn version: ", CUDNN_VERSION, ". ")));
+      return;
+    }
+#endif  // CUDNN_VERSION
     // Create the dropout handle.
     cudnn_dropout_desc_.reset(new CudnnDropoutDescriptor(
         parent, cudnn_handle, dropout, seed, state_allocator));
@@ -988,12 +1078,34 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
     // Create the RNN handle
     cudnnStatus_t status = wrap::cudnnCreateRNNDescriptor(parent_, &rnn_desc_);
     CUDNN_RETURN_IF_FAIL(status, "Unable to create RNN descriptor");
+#if CUDNN_VERSION >= 6000
+    status = wrap::cudnnSetRNNDescriptor_v6(
+        parent, cudnn_handle /*handle*/, rnn_desc_ /*rnnDesc*/,
+        hidden_size /*hiddenSize*/, num_layers /*numLayers*/,
+        dropout_handle() /*dropoutDesc*/, input_mode /*inputMode*/,
+        direction_mode /*direction*/, rnn_mode /*mode*/,
+        static_cast<cudnnRNNAlgo_t>(algorithm) /*algo*/,
+        data_type /*dataType*/);
+#else
     status = wrap::cudnnSetRNNDescriptor(
         parent, rnn_desc_ /*rnnDesc*/, hidden_size /*hiddenSize*/,
         num_layers /*numLayers*/, dropout_handle() /*dropoutDesc*/,
         input_mode /*inputMode*/, direction_mode /*direction*/,
         rnn_mode /*mode*/, data_type /*dataType*/);
+#endif  // CUDNN_VERSION
     CUDNN_RETURN_IF_FAIL(status, "Unable to update RNN descriptor");
+#if CUDNN_VERSION >= 7000
+    if (use_tensor_op_math) {
+      status = wrap::cudnnSetRNNMatrixMathType(
+          parent, rnn_desc_ /*rnnDesc*/, CUDNN_TENSOR_OP_MATH /*mType*/);
+      CUDNN_RETURN_IF_FAIL(status, "Unable to set RNN math type");
+    }
+#else
+    // Tensor Core operations only exist from Cudnn 7.0 on, so the regular
+    // math is the only choice here.
+    VLOG_IF(1, use_tensor_op_math)
+        << "Tensor op math needs at least Cudnn 7.0, using regular math.";
+#endif  // CUDNN_VERSION
 
     // Create the params handle.
     cudnn_params_desc_.reset(
@@ -1004,6 +1116,13 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
     }
   }
   ~CudnnRnnDescriptor() override {
+#if CUDNN_VERSION >= 6000
+    if (persistent_plan_) {
+      cudnnStatus_t status =
+          wrap::cudnnDestroyPersistentRNNPlan(parent_, persistent_plan_);
+      CUDNN_RETURN_IF_FAIL(status, "Unable to destroy persistent RNN plan");
+    }
+#endif  // CUDNN_VERSION
     if (rnn_desc_) {
       cudnnStatus_t status =
           wrap::cudnnDestroyRNNDescriptor(parent_, rnn_desc_);
@@ -1021,6 +1140,11 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
   cudnnDirectionMode_t direction_mode() const { return direction_mode_; }
   cudnnRNNMode_t rnn_mode() const { return rnn_mode_; }
   cudnnDataType_t data_type() const { return data_type_; }
+  dnn::RnnAlgorithm algorithm() const { return algorithm_; }
+  // A kRnnPersistDynamic model runs with a plan that is built for one batch
+  // size. Rebuilds the plan when batch_size differs from the last call; the
+  // caller must hold the mutex of the dnn handle.
+  bool UpdatePersistentPlan(int batch_size) const;
   int64 ParamsSizeInBytes() const override {
     return cudnn_params_desc_->params_size_in_bytes();
   }
@@ -1051,6 +1175,12 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
   cudnnDirectionMode_t direction_mode_;
   cudnnRNNMode_t rnn_mode_;
   cudnnDataType_t data_type_;
+  dnn::RnnAlgorithm algorithm_;
+#if CUDNN_VERSION >= 6000
+  // Guarded by the mutex of the dnn handle, see UpdatePersistentPlan.
+  mutable cudnnPersistentRNNPlan_t persistent_plan_ = nullptr;
+  mutable int persistent_plan_batch_size_ = 0;
+#endif  // CUDNN_VERSION
   port::Status status_;
   std::unique_ptr<CudnnDropoutDescriptor> cudnn_dropout_desc_;
   std::unique_ptr<CudnnRnnParamsDescriptor> cudnn_params_desc_;
@@ -1160,6 +1290,41 @@ CudnnRnnParamsDescriptor::CudnnRnnParamsDescriptor(
   }
 }
 
+bool CudnnRnnDescriptor::UpdatePersistentPlan(int batch_size) const {
+#if CUDNN_VERSION >= 6000
+  if (algorithm_ != dnn::RnnAlgorithm::kRnnPersistDynamic ||
+      (persistent_plan_ && persistent_plan_batch_size_ == batch_size)) {
+    return true;
+  }
+  cudnnStatus_t status;
+  if (persistent_plan_) {
+    status = wrap::cudnnDestroyPersistentRNNPlan(parent_, persistent_plan_);
+    persistent_plan_ = nullptr;
+    if (status != CUDNN_STATUS_SUCCESS) {
+      LOG(ERROR) << "Unable to destroy persistent RNN plan: "
+                 << ToString(status);
+      return false;
+    }
+  }
+  status = wrap::cudnnCreatePersistentRNNPlan(
+      parent_, rnn_desc_ /*rnnDesc*/, batch_size /*minibatch*/,
+      data_type_ /*dataType*/, &persistent_plan_ /*plan*/);
+  if (status != CUDNN_STATUS_SUCCESS) {
+    persistent_plan_ = nullptr;
+    LOG(ERROR) << "Unable to create persistent RNN plan: " << ToString(status);
+    return false;
+  }
+  status = wrap::cudnnSetPersistentRNNPlan(parent_, rnn_desc_ /*rnnDesc*/,
+                                           persistent_plan_ /*plan*/);
+  if (status != CUDNN_STATUS_SUCCESS) {
+    LOG(ERROR) << "Unable to set persistent RNN plan: " << ToString(status);
+    return false;
+  }
+  persistent_plan_batch_size_ = batch_size;
+#endif  // CUDNN_VERSION
+  return true;
+}
+
 int CudnnRnnParamsDescriptor::GetRegionCountPerLayer() const {
   auto rnn_mode = rnn_desc_->rnn_mode();
   switch (rnn_mode) {
@@ -1422,7 +1587,8 @@ bool CudnnSupport::DoRnnForwardImpl(
     const CudnnRnnStateTensorDescriptor& output_c_desc,
     DeviceMemory<T>* output_c_data, bool is_training,
     ScratchAllocator* reserve_space_allocator,
-    ScratchAllocator* workspace_allocator) {
+    ScratchAllocator* workspace_allocator,
+    dnn::ProfileResult* output_profile_result) {
   // extract model parameters
   RnnModelDims model_dims;
   bool res = ExtractAndCheckRnnForward(
@@ -1437,6 +1603,12 @@ bool CudnnSupport::DoRnnForwardImpl(
 
   // check params size
   mutex_lock lock{dnn_handle_mutex_};
+  cudnnStatus_t status = wrap::cudnnSetStream(parent_, ToHandle(dnn_handle_),
+                                              AsCUDAStreamValue(stream));
+  if (status != CUDNN_STATUS_SUCCESS) {
+    LOG(ERROR) << "Failed to set stream for cudnn handle: " << ToString(status);
+    return false;
+  }
 
   if (!CheckRNNParameterSize(parent_, ToHandle(dnn_handle_), rnn_desc,
                              input_desc)) {
@@ -1444,6 +1616,11 @@ bool CudnnSupport::DoRnnForwardImpl(
     return false;
   }
 
+  if (!rnn_desc.UpdatePersistentPlan(model_dims.batch_size)) {
+    LOG(ERROR) << "Unable to update the persistent RNN plan";
+    return false;
+  }
+
   // create the workspace
   DeviceMemory<uint8> workspace;
   if (!CreateRnnWorkspace(stream, parent_, ToHandle(dnn_handle_), rnn_desc,
@@ -1457,7 +1634,7 @@ bool CudnnSupport::DoRnnForwardImpl(
   DeviceMemory<uint8> reserve_space;
   if (is_training) {
     size_t reserve_space_size_in_bytes = 0;
-    cudnnStatus_t status = wrap::cudnnGetRNNTrainingReserveSize(
+    status = wrap::cudnnGetRNNTrainingReserveSize(
         parent_, ToHandle(dnn_handle_) /*handle*/,
         rnn_desc.handle() /*rnnDesc*/, model_dims.seq_length /*seqLength*/,
         input_desc.handles() /*xDesc*/,
@@ -1478,9 +1655,22 @@ bool CudnnSupport::DoRnnForwardImpl(
     }
   }
 
+  const bool is_profiling = output_profile_result != nullptr;
+  std::unique_ptr<CUDATimer> timer;
+  if (is_profiling) {
+    timer.reset(new CUDATimer(parent_));
+    if (!timer->Init()) {
+      return false;
+    }
+    if (!timer->Start(AsCUDAStream(stream))) {
+      timer->Destroy();
+      return false;
+    }
+  }
+
   // make the forward call
   if (!is_training) {
-    cudnnStatus_t status = wrap::cudnnRNNForwardInference(
+    status = wrap::cudnnRNNForwardInference(
         parent_, ToHandle(dnn_handle_) /*handle*/,
         rnn_desc.handle() /*rnnDesc*/, model_dims.seq_length /*seqLength*/,
         input_desc.handles() /*xDesc*/, input_data.opaque() /*x*/,
@@ -1492,13 +1682,8 @@ bool CudnnSupport::DoRnnForwardImpl(
         output_c_desc.handle() /*cyDesc*/, output_c_data->opaque() /*cy*/,
         workspace.opaque() /*workspace*/,
         workspace.size() /*workSpaceSizeInBytes*/);
-    if (status != CUDNN_STATUS_SUCCESS) {
-      LOG(ERROR) << "Failed to call cudnnRNNForwardInference: "
-                 << ToString(status);
-      return false;
-    }
   } else {
-    cudnnStatus_t status = wrap::cudnnRNNForwardTraining(
+    status = wrap::cudnnRNNForwardTraining(
         parent_, ToHandle(dnn_handle_) /*handle*/,
         rnn_desc.handle() /*rnnDesc*/, model_dims.seq_length /*seqLength*/,
         input_desc.handles() /*xDesc*/, input_data.opaque() /*x*/,
@@ -1512,11 +1697,32 @@ bool CudnnSupport::DoRnnForwardImpl(
         workspace.size() /*workSpaceSizeInBytes*/,
         reserve_space.opaque() /*reserveSpace*/,
         reserve_space.size() /*reserveSpaceSizeInBytes*/);
-    if (status != CUDNN_STATUS_SUCCESS) {
-      LOG(ERROR) << "Failed to call cudnnRNNForwardTraining"
-                 << ToString(status);
+  }
+
+  if (is_profiling) {
+    if (!timer->Stop(AsCUDAStream(stream))) {
+      timer->Destroy();
       return false;
     }
+    if (status == CUDNN_STATUS_SUCCESS) {
+      output_profile_result->set_is_valid(true);
+      output_profile_result->set_algorithm(
+          static_cast<dnn::AlgorithmType>(rnn_desc.algorithm()));
+      output_profile_result->set_elapsed_time_in_ms(
+          timer->GetElapsedMilliseconds());
+    }
+    timer->Destroy();
+  }
+
+  if (status != CUDNN_STATUS_SUCCESS) {
+    // Silently return when we are profiling.
+    if (!is_profiling) {
+      LOG(ERROR) << "Failed to call "
+                 << (is_training ? "cudnnRNNForwardTraining: "
+                                 : "cudnnRNNForwardInference: ")
+                 << ToString(status);
+    }
+    return false;
   }
 
   return true;
@@ -1537,13 +1743,13 @@ bool CudnnSupport::DoRnnBackwardImpl(
     const DeviceMemory<T>& output_h_data,
     const CudnnRnnStateTensorDescriptor& output_c_desc,
     const DeviceMemory<T>& output_c_data,
-    const DeviceMemory<float>& output_backprop_data,
-    const DeviceMemory<float>& output_h_backprop_data,
-    const DeviceMemory<float>& output_c_backprop_data,
-    DeviceMemory<float>* input_backprop_data,
-    DeviceMemory<float>* input_h_backprop_data,
-    DeviceMemory<float>* input_c_backprop_data,
-    DeviceMemory<float>* params_backprop_data,
+    const DeviceMemory<T>& output_backprop_data,
+    const DeviceMemory<T>& output_h_backprop_data,
+    const DeviceMemory<T>& output_c_backprop_data,
+    DeviceMemory<T>* input_backprop_data,
+    DeviceMemory<T>* input_h_backprop_data,
+    DeviceMemory<T>* input_c_backprop_data,
+    DeviceMemory<T>* params_backprop_data,
     DeviceMemory<uint8>* reserve_space_data,
     ScratchAllocator* workspace_allocator) {
   // extract model parameters
@@ -1559,6 +1765,12 @@ bool CudnnSupport::DoRnnBackwardImpl(
 
   // check params size
   mutex_lock lock{dnn_handle_mutex_};
+  cudnnStatus_t status = wrap::cudnnSetStream(parent_, ToHandle(dnn_handle_),
+                                              AsCUDAStreamValue(stream));
+  if (status != CUDNN_STATUS_SUCCESS) {
+    LOG(ERROR) << "Failed to set stream for cudnn handle: " << ToString(status);
+    return false;
+  }
 
   if (!CheckRNNParameterSize(parent_, ToHandle(dnn_handle_), rnn_desc,
                              input_desc)) {
@@ -1566,6 +1778,11 @@ bool CudnnSupport::DoRnnBackwardImpl(
     return false;
   }
 
+  if (!rnn_desc.UpdatePersistentPlan(model_dims.batch_size)) {
+    LOG(ERROR) << "Unable to update the persistent RNN plan";
+    return false;
+  }
+
   // create the workspace
   DeviceMemory<uint8> workspace;
   if (!CreateRnnWorkspace(stream, parent_, ToHandle(dnn_handle_), rnn_desc,
@@ -1575,7 +1792,7 @@ bool CudnnSupport::DoRnnBackwardImpl(
   }
 
   // make the backward data call
-  cudnnStatus_t status = wrap::cudnnRNNBackwardData(
+  status = wrap::cudnnRNNBackwardData(
       parent_, ToHandle(dnn_handle_) /*handle*/, rnn_desc.handle() /*rnnDesc*/,
       model_dims.seq_length /*seqLength*/, output_desc.handles() /*yDesc*/,
       output_data.opaque() /*y*/, output_desc.handles() /*dyDesc*/,
@@ -1632,7 +1849,9 @@ CudnnSupport::createRnnDescriptor(int num_layers, int hidden_size,
                                   int input_size, dnn::RnnInputMode input_mode,
                                   dnn::RnnDirectionMode direction_mode,
                                   dnn::RnnMode rnn_mode,
-                                  dnn::DataType data_type, float dropout,
+                                  dnn::DataType data_type,
+                                  dnn::RnnAlgorithm algorithm,
+                                  bool use_tensor_op_math, float dropout,
                                   uint64 seed,
                                   ScratchAllocator* state_allocator) {
 #if CUDNN_VERSION >= 5000
@@ -1640,8 +1859,8 @@ CudnnSupport::createRnnDescriptor(int num_layers, int hidden_size,
   std::unique_ptr<CudnnRnnDescriptor> rnn_desc(new CudnnRnnDescriptor(
       parent_, ToHandle(dnn_handle_), num_layers, hidden_size, input_size,
       ToCudnnRnnInputMode(input_mode), ToCudnnRnnDirectionMode(direction_mode),
-      ToCudnnRnnMode(rnn_mode), ToCudnnDataType(data_type), dropout, seed,
-      state_allocator));
+      ToCudnnRnnMode(rnn_mode), ToCudnnDataType(data_type), algorithm,
+      use_tensor_op_math, dropout, seed, state_allocator));
   if (!rnn_desc->ok()) {
     return rnn_desc->Status();
   }
@@ -1716,7 +1935,8 @@ bool CudnnSupport::DoRnnForward(
     const dnn::RnnStateTensorDescriptor& output_c_desc,
     DeviceMemory<float>* output_c_data, bool is_training,
     ScratchAllocator* reserve_space_allocator,
-    ScratchAllocator* workspace_allocator) {
+    ScratchAllocator* workspace_allocator,
+    dnn::ProfileResult* output_profile_result) {
 #if CUDNN_VERSION >= 5000
   const CudnnRnnDescriptor& cudnn_rnn_desc =
       static_cast<const CudnnRnnDescriptor&>(rnn_desc);
@@ -1737,7 +1957,53 @@ bool CudnnSupport::DoRnnForward(
       stream, cudnn_rnn_desc, cudnn_input_desc, input_data, cudnn_input_h_desc,
       input_h_data, cudnn_input_c_desc, input_c_data, params, cudnn_output_desc,
       output_data, cudnn_output_h_desc, output_h_data, cudnn_output_c_desc,
-      output_c_data, is_training, reserve_space_allocator, workspace_allocator);
+      output_c_data, is_training, reserve_space_allocator, workspace_allocator,
+      output_profile_result);
+#else
+  return false;
+#endif  // CUDNN_VERSION
+}
+
+bool CudnnSupport::DoRnnForward(
+    Stream* stream, const dnn::RnnDescriptor& rnn_desc,
+    const dnn::RnnSequenceTensorDescriptor& input_desc,
+    const DeviceMemory<Eigen::half>& input_data,
+    const dnn::RnnStateTensorDescriptor& input_h_desc,
+    const DeviceMemory<Eigen::half>& input_h_data,
+    const dnn::RnnStateTensorDescriptor& input_c_desc,
+    const DeviceMemory<Eigen::half>& input_c_data,
+    const DeviceMemory<Eigen::half>& params,
+    const dnn::RnnSequenceTensorDescriptor& output_desc,
+    DeviceMemory<Eigen::half>* output_data,
+    const dnn::RnnStateTensorDescriptor& output_h_desc,
+    DeviceMemory<Eigen::half>* output_h_data,
+    const dnn::RnnStateTensorDescriptor& output_c_desc,
+    DeviceMemory<Eigen::half>* output_c_data, bool is_training,
+    ScratchAllocator* reserve_space_allocator,
+    ScratchAllocator* workspace_allocator,
+    dnn::ProfileResult* output_profile_result) {
+#if CUDNN_VERSION >= 5000
+  const CudnnRnnDescriptor& cudnn_rnn_desc =
+      static_cast<const CudnnRnnDescriptor&>(rnn_desc);
+  const CudnnRnnSequenceTensorDescriptor& cudnn_input_desc =
+      static_cast<const CudnnRnnSequenceTensorDescriptor&>(input_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_input_h_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(input_h_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_input_c_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(input_c_desc);
+  const CudnnRnnSequenceTensorDescriptor& cudnn_output_desc =
+      static_cast<const CudnnRnnSequenceTensorDescriptor&>(output_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_output_h_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(output_h_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_output_c_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(output_c_desc);
+
+  return DoRnnForwardImpl<Eigen::half>(
+      stream, cudnn_rnn_desc, cudnn_input_desc, input_data, cudnn_input_h_desc,
+      input_h_data, cudnn_input_c_desc, input_c_data, params, cudnn_output_desc,
+      output_data, cudnn_output_h_desc, output_h_data, cudnn_output_c_desc,
+      output_c_data, is_training, reserve_space_allocator, workspace_allocator,
+      output_profile_result);
 #else
   return false;
 #endif  // CUDNN_VERSION
@@ -1795,6 +2061,59 @@ bool CudnnSupport::DoRnnBackward(
 #endif  // CUDNN_VERSION
 }
 
+bool CudnnSupport::DoRnnBackward(
+    Stream* stream, const dnn::RnnDescriptor& rnn_desc,
+    const dnn::RnnSequenceTensorDescriptor& input_desc,
+    const DeviceMemory<Eigen::half>& input_data,
+    const dnn::RnnStateTensorDescriptor& input_h_desc,
+    const DeviceMemory<Eigen::half>& input_h_data,
+    const dnn::RnnStateTensorDescriptor& input_c_desc,
+    const DeviceMemory<Eigen::half>& input_c_data,
+    const DeviceMemory<Eigen::half>& params,
+    const dnn::RnnSequenceTensorDescriptor& output_desc,
+    const DeviceMemory<Eigen::half>& output_data,
+    const dnn::RnnStateTensorDescriptor& output_h_desc,
+    const DeviceMemory<Eigen::half>& output_h_data,
+    const dnn::RnnStateTensorDescriptor& output_c_desc,
+    const DeviceMemory<Eigen::half>& output_c_data,
+    const DeviceMemory<Eigen::half>& output_backprop_data,
+    const DeviceMemory<Eigen::half>& output_h_backprop_data,
+    const DeviceMemory<Eigen::half>& output_c_backprop_data,
+    DeviceMemory<Eigen::half>* input_backprop_data,
+    DeviceMemory<Eigen::half>* input_h_backprop_data,
+    DeviceMemory<Eigen::half>* input_c_backprop_data,
+    DeviceMemory<Eigen::half>* params_backprop_data,
+    DeviceMemory<uint8>* reserve_space_data,
+    ScratchAllocator* workspace_allocator) {
+#if CUDNN_VERSION >= 5000
+  const CudnnRnnDescriptor& cudnn_rnn_desc =
+      static_cast<const CudnnRnnDescriptor&>(rnn_desc);
+  const CudnnRnnSequenceTensorDescriptor& cudnn_input_desc =
+      static_cast<const CudnnRnnSequenceTensorDescriptor&>(input_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_input_h_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(input_h_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_input_c_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(input_c_desc);
+  const CudnnRnnSequenceTensorDescriptor& cudnn_output_desc =
+      static_cast<const CudnnRnnSequenceTensorDescriptor&>(output_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_output_h_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(output_h_desc);
+  const CudnnRnnStateTensorDescriptor& cudnn_output_c_desc =
+      static_cast<const CudnnRnnStateTensorDescriptor&>(output_c_desc);
+
+  return DoRnnBackwardImpl<Eigen::half>(
+      stream, cudnn_rnn_desc, cudnn_input_desc, input_data, cudnn_input_h_desc,
+      input_h_data, cudnn_input_c_desc, input_c_data, params, cudnn_output_desc,
+      output_data, cudnn_output_h_desc, output_h_data, cudnn_output_c_desc,
+      output_c_data, output_backprop_data, output_h_backprop_data,
+      output_c_backprop_data, input_backprop_data, input_h_backprop_data,
+      input_c_backprop_data, params_backprop_data, reserve_space_data,
+      workspace_allocator);
+#else
+  return false;
+#endif  // CUDNN_VERSION
+}
+
 template <class T>
 bool CudnnSupport::DoConvolveImpl(
     Stream* stream, int cudnn_type,  // Actually cudnnDataType_t.
@@ -1807,20 +2126,20 @@ bool CudnnSupport::DoConvolveImpl(
     ScratchAllocator* scratch_allocator,
     const dnn::AlgorithmConfig& algorithm_config,
     dnn::ProfileResult* output_profile_result) {
-  ScopedTensorDescriptor input_nd{parent_, batch_descriptor,
-      static_cast<cudnnDataType_t>(cudnn_type)};
-  ScopedTensorDescriptor output_nd{parent_, output_descriptor,
-      static_cast<cudnnDataType_t>(cudnn_type)};
-  ScopedFilterDescriptor filter{parent_, filter_descriptor, batch_descriptor,
-      static_cast<cudnnDataType_t>(cudnn_type)};
+  mutex_lock lock{dnn_handle_mutex_};
+  std::shared_ptr<ScopedTensorDescriptor> input_nd =
+      GetTensorDescriptor(batch_descriptor, cudnn_type);
+  std::shared_ptr<ScopedTensorDescriptor> output_nd =
+      GetTensorDescriptor(output_descriptor, cudnn_type);
+  std::shared_ptr<ScopedFilterDescriptor> filter =
+      GetFilterDescriptor(filter_descriptor, batch_descriptor, cudnn_type);
   // TODO(sesse): Figure out under what circumstances cuDNN would
   // accept CUDNN_DATA_HALF here; probably related to compute capability
   // and cuDNN version; at least cuDNN 4 on TITAN X only supports
   // CUDNN_DATA_FLOAT even for half input.
-  ScopedConvolutionDescriptor conv{parent_, convolution_descriptor,
-      CUDNN_DATA_FLOAT};
+  std::shared_ptr<ScopedConvolutionDescriptor> conv =
+      GetConvolutionDescriptor(convolution_descriptor, CUDNN_DATA_FLOAT);
 
-  mutex_lock lock{dnn_handle_mutex_};
   auto status = wrap::cudnnSetStream(parent_, ToHandle(dnn_handle_),
                                      AsCUDAStreamValue(stream));
   if (status != CUDNN_STATUS_SUCCESS) {
@@ -1853,8 +2172,8 @@ bool CudnnSupport::DoConvolveImpl(
 
           cudnnConvolutionFwdAlgo_t algo_to_use;
           status = wrap::cudnnGetConvolutionForwardAlgorithm(
-              parent_, ToHandle(dnn_handle_), input_nd.handle(),
-              filter.handle(), conv.handle(), output_nd.handle(),
+              parent_, ToHandle(dnn_handle_), input_nd->handle(),
+              filter->handle(), conv->handle(), output_nd->handle(),
               /*preference=*/preference,
               /*memoryLimitInBytes=*/memory_limit_bytes,
               /*algo=*/&algo_to_use);
@@ -1870,9 +2189,9 @@ bool CudnnSupport::DoConvolveImpl(
     if (scratch_allocator != nullptr) {
       size_t size_in_bytes;
       status = wrap::cudnnGetConvolutionForwardWorkspaceSize(
-          parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd.handle(),
-          /*filterDesc=*/filter.handle(), /*convDesc=*/conv.handle(),
-          /*destDesc=*/output_nd.handle(), /*algo=*/algo,
+          parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd->handle(),
+          /*filterDesc=*/filter->handle(), /*convDesc=*/conv->handle(),
+          /*destDesc=*/output_nd->handle(), /*algo=*/algo,
           /*sizeInBytes=*/&size_in_bytes);
       if (status == CUDNN_STATUS_SUCCESS && size_in_bytes != 0) {
         auto allocated =
@@ -1894,9 +2213,9 @@ bool CudnnSupport::DoConvolveImpl(
 
     size_t size_in_bytes;
     status = wrap::cudnnGetConvolutionForwardWorkspaceSize(
-        parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd.handle(),
-        /*filterDesc=*/filter.handle(), /*convDesc=*/conv.handle(),
-        /*destDesc=*/output_nd.handle(), /*algo=*/algo,
+        parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd->handle(),
+        /*filterDesc=*/filter->handle(), /*convDesc=*/conv->handle(),
+        /*destDesc=*/output_nd->handle(), /*algo=*/algo,
         /*sizeInBytes=*/&size_in_bytes);
     if (status != CUDNN_STATUS_SUCCESS) {
       if (is_profiling) {
@@ -1982,25 +2301,25 @@ bool CudnnSupport::DoConvolveImpl(
                                                output_descriptor.value_max()};
     status = wrap::cudnnConvolutionBiasActivationForward(
         parent_, ToHandle(dnn_handle_),
-        /*alpha1=*/&alpha, /*srcDesc=*/input_nd.handle(),
-        /*srcData=*/input_data.opaque(), /*filterDesc=*/filter.handle(),
-        /*filterData=*/filter_data.opaque(), /*convDesc=*/conv.handle(),
+        /*alpha1=*/&alpha, /*srcDesc=*/input_nd->handle(),
+        /*srcData=*/input_data.opaque(), /*filterDesc=*/filter->handle(),
+        /*filterData=*/filter_data.opaque(), /*convDesc=*/conv->handle(),
         /*algo=*/algo, /*workSpace=*/scratch.opaque(),
         /*workSpaceSizeInBytes=*/scratch.size(), /*alpha2=*/&beta,
-        /*zDesc=*/output_nd.handle(), /*z=*/nullptr,
+        /*zDesc=*/output_nd->handle(), /*z=*/nullptr,
         /*biasDesc=*/bias_descriptor.handle(),
         /*bias=*/biases.opaque(), /*activationDesc=*/activation_desc.handle(),
-        /*destDesc=*/output_nd.handle(), /*destData=*/output_data->opaque());
+        /*destDesc=*/output_nd->handle(), /*destData=*/output_data->opaque());
 #endif  // CUDNN_VERSION < 6000
   } else {
     status = wrap::cudnnConvolutionForward(
         parent_, ToHandle(dnn_handle_),
-        /*alpha=*/&alpha, /*srcDesc=*/input_nd.handle(),
-        /*srcData=*/input_data.opaque(), /*filterDesc=*/filter.handle(),
-        /*filterData=*/filter_data.opaque(), /*convDesc=*/conv.handle(),
+        /*alpha=*/&alpha, /*srcDesc=*/input_nd->handle(),
+        /*srcData=*/input_data.opaque(), /*filterDesc=*/filter->handle(),
+        /*filterData=*/filter_data.opaque(), /*convDesc=*/conv->handle(),
         /*algo=*/algo, /*workSpace=*/scratch.opaque(),
         /*workSpaceSizeInBytes=*/scratch.size(), /*beta=*/&beta,
-        /*destDesc=*/output_nd.handle(), /*destData=*/output_data->opaque());
+        /*destDesc=*/output_nd->handle(), /*destData=*/output_data->opaque());
   }
   if (is_profiling) {
     if (!timer->Stop(AsCUDAStream(stream))) {
@@ -2459,18 +2778,18 @@ bool CudnnSupport::DoConvolveBackwardDataImpl(
       stream, cudnn_type, &output_descriptor, backward_output_data,
       &transform_scratch);
 
-  ScopedTensorDescriptor out_back_nd{parent_, output_descriptor,
-                                     static_cast<cudnnDataType_t>(cudnn_type)};
-  ScopedTensorDescriptor in_back_nd{parent_, input_descriptor,
-                                    static_cast<cudnnDataType_t>(cudnn_type)};
-  ScopedFilterDescriptor filter{parent_, filter_descriptor, input_descriptor,
-                                static_cast<cudnnDataType_t>(cudnn_type)};
+  std::shared_ptr<ScopedTensorDescriptor> out_back_nd =
+      GetTensorDescriptor(output_descriptor, cudnn_type);
+  std::shared_ptr<ScopedTensorDescriptor> in_back_nd =
+      GetTensorDescriptor(input_descriptor, cudnn_type);
+  std::shared_ptr<ScopedFilterDescriptor> filter =
+      GetFilterDescriptor(filter_descriptor, input_descriptor, cudnn_type);
   // TODO(sesse): Figure out under what circumstances cuDNN would
   // accept CUDNN_DATA_HALF here; probably related to compute capability
   // and cuDNN version; at least cuDNN 4 on TITAN X only supports
   // CUDNN_DATA_FLOAT even for half input.
-  ScopedConvolutionDescriptor conv{parent_, convolution_descriptor,
-                                   CUDNN_DATA_FLOAT};
+  std::shared_ptr<ScopedConvolutionDescriptor> conv =
+      GetConvolutionDescriptor(convolution_descriptor, CUDNN_DATA_FLOAT);
 
   const bool is_profiling = output_profile_result != nullptr;
   cudnnConvolutionBwdDataAlgo_t algo;
@@ -2495,10 +2814,10 @@ bool CudnnSupport::DoConvolveBackwardDataImpl(
       cudnnConvolutionBwdDataAlgo_t algo_to_use;
       cudnnStatus_t status = wrap::cudnnGetConvolutionBackwardDataAlgorithm(
           parent_, ToHandle(dnn_handle_),
-          /*filterDesc=*/filter.handle(),
-          /*diffDesc=*/out_back_nd.handle(),
-          /*convDesc=*/conv.handle(),
-          /*gradDesc=*/in_back_nd.handle(),
+          /*filterDesc=*/filter->handle(),
+          /*diffDesc=*/out_back_nd->handle(),
+          /*convDesc=*/conv->handle(),
+          /*gradDesc=*/in_back_nd->handle(),
           /*preference=*/preference,
           /*memoryLimitInBytes=*/memory_limit_bytes,
           /*algo=*/&algo_to_use);
@@ -2514,10 +2833,10 @@ bool CudnnSupport::DoConvolveBackwardDataImpl(
       size_t size_in_bytes;
       status = wrap::cudnnGetConvolutionBackwardDataWorkspaceSize(
           parent_, ToHandle(dnn_handle_),
-          /*filterDesc=*/filter.handle(),
-          /*diffDesc=*/out_back_nd.handle(),
-          /*convDesc=*/conv.handle(),
-          /*gradDesc=*/in_back_nd.handle(),
+          /*filterDesc=*/filter->handle(),
+          /*diffDesc=*/out_back_nd->handle(),
+          /*convDesc=*/conv->handle(),
+          /*gradDesc=*/in_back_nd->handle(),
           /*algo=*/algo,
           /*sizeInBytes=*/&size_in_bytes);
       if (status == CUDNN_STATUS_SUCCESS && size_in_bytes != 0) {
@@ -2540,10 +2859,10 @@ bool CudnnSupport::DoConvolveBackwardDataImpl(
     size_t size_in_bytes;
     status = wrap::cudnnGetConvolutionBackwardDataWorkspaceSize(
         parent_, ToHandle(dnn_handle_),
-        /*filterDesc=*/filter.handle(),
-        /*diffDesc=*/out_back_nd.handle(),
-        /*convDesc=*/conv.handle(),
-        /*gradDesc=*/in_back_nd.handle(),
+        /*filterDesc=*/filter->handle(),
+        /*diffDesc=*/out_back_nd->handle(),
+        /*convDesc=*/conv->handle(),
+        /*gradDesc=*/in_back_nd->handle(),
         /*algo=*/algo,
         /*sizeInBytes=*/&size_in_bytes);
     if (status != CUDNN_STATUS_SUCCESS) {
@@ -2594,16 +2913,16 @@ bool CudnnSupport::DoConvolveBackwardDataImpl(
 #endif
       parent_, ToHandle(dnn_handle_),
       /*alpha=*/&alpha,
-      /*filterDesc=*/filter.handle(),
+      /*filterDesc=*/filter->handle(),
       /*filterData=*/filter_data.opaque(),
-      /*diffDesc=*/out_back_nd.handle(),
+      /*diffDesc=*/out_back_nd->handle(),
       /*diffData=*/backward_output_data.opaque(),
-      /*convDesc=*/conv.handle(),
+      /*convDesc=*/conv->handle(),
       /*algo=*/algo,
       /*workSpace=*/scratch.opaque(),
       /*workSpaceSizeInBytes=*/scratch.size(),
       /*beta=*/&beta,
-      /*gradDesc=*/in_back_nd.handle(),
+      /*gradDesc=*/in_back_nd->handle(),
       /*gradData=*/backward_input_data->opaque());
   if (is_profiling) {
     timer->Stop(AsCUDAStream(stream));
@@ -2695,18 +3014,18 @@ bool CudnnSupport::DoConvolveBackwardFilterImpl(
       &output_descriptor, backward_output_data,
       &transform_scratch);
 
-  ScopedTensorDescriptor out_back_nd{parent_, output_descriptor,
-        static_cast<cudnnDataType_t>(cudnn_type)};
-  ScopedTensorDescriptor input_nd{parent_, input_descriptor,
-          static_cast<cudnnDataType_t>(cudnn_type)};
-  ScopedFilterDescriptor filter{parent_, filter_descriptor, input_descriptor,
-        static_cast<cudnnDataType_t>(cudnn_type)};
+  std::shared_ptr<ScopedTensorDescriptor> out_back_nd =
+      GetTensorDescriptor(output_descriptor, cudnn_type);
+  std::shared_ptr<ScopedTensorDescriptor> input_nd =
+      GetTensorDescriptor(input_descriptor, cudnn_type);
+  std::shared_ptr<ScopedFilterDescriptor> filter =
+      GetFilterDescriptor(filter_descriptor, input_descriptor, cudnn_type);
   // TODO(sesse): Figure out under what circumstances cuDNN would
   // accept CUDNN_DATA_HALF here; probably related to compute capability
   // and cuDNN version; at least cuDNN 4 on TITAN X only supports
   // CUDNN_DATA_FLOAT even for half input.
-  ScopedConvolutionDescriptor conv{parent_, convolution_descriptor,
-      CUDNN_DATA_FLOAT};
+  std::shared_ptr<ScopedConvolutionDescriptor> conv =
+      GetConvolutionDescriptor(convolution_descriptor, CUDNN_DATA_FLOAT);
 
   const bool is_profiling = output_profile_result != nullptr;
   cudnnConvolutionBwdFilterAlgo_t algo;
@@ -2735,10 +3054,10 @@ bool CudnnSupport::DoConvolveBackwardFilterImpl(
       cudnnConvolutionBwdFilterAlgo_t algo_to_use;
       cudnnStatus_t status = wrap::cudnnGetConvolutionBackwardFilterAlgorithm(
           parent_, ToHandle(dnn_handle_),
-          /*srcDesc=*/input_nd.handle(),
-          /*diffDesc=*/out_back_nd.handle(),
-          /*convDesc=*/conv.handle(),
-          /*gradDesc=*/filter.handle(),
+          /*srcDesc=*/input_nd->handle(),
+          /*diffDesc=*/out_back_nd->handle(),
+          /*convDesc=*/conv->handle(),
+          /*gradDesc=*/filter->handle(),
           /*preference=*/preference,
           /*memoryLimitInBytes=*/memory_limit_bytes,
           /*algo=*/&algo_to_use);
@@ -2753,9 +3072,9 @@ bool CudnnSupport::DoConvolveBackwardFilterImpl(
     if (scratch_allocator != nullptr) {
       size_t size_in_bytes;
       status = wrap::cudnnGetConvolutionBackwardFilterWorkspaceSize(
-          parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd.handle(),
-          /*diffDesc=*/out_back_nd.handle(), /*convDesc=*/conv.handle(),
-          /*gradDesc=*/filter.handle(), /*algo=*/algo,
+          parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd->handle(),
+          /*diffDesc=*/out_back_nd->handle(), /*convDesc=*/conv->handle(),
+          /*gradDesc=*/filter->handle(), /*algo=*/algo,
           /*sizeInBytes=*/&size_in_bytes);
       if (status == CUDNN_STATUS_SUCCESS && size_in_bytes != 0) {
         auto allocated =
@@ -2777,9 +3096,9 @@ bool CudnnSupport::DoConvolveBackwardFilterImpl(
 
     size_t size_in_bytes;
     status = wrap::cudnnGetConvolutionBackwardFilterWorkspaceSize(
-        parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd.handle(),
-        /*diffDesc=*/out_back_nd.handle(), /*convDesc=*/conv.handle(),
-        /*gradDesc=*/filter.handle(), /*algo=*/algo,
+        parent_, ToHandle(dnn_handle_), /*srcDesc=*/input_nd->handle(),
+        /*diffDesc=*/out_back_nd->handle(), /*convDesc=*/conv->handle(),
+        /*gradDesc=*/filter->handle(), /*algo=*/algo,
         /*sizeInBytes=*/&size_in_bytes);
     if (status != CUDNN_STATUS_SUCCESS) {
       if (is_profiling) {
@@ -2829,16 +3148,16 @@ bool CudnnSupport::DoConvolveBackwardFilterImpl(
   status = wrap::cudnnConvolutionBackwardFilter_v3(
 #endif
       parent_, ToHandle(dnn_handle_), /*alpha=*/&alpha,
-      /*srcDesc=*/input_nd.handle(),
+      /*srcDesc=*/input_nd->handle(),
       /*srcData=*/input_data.opaque(),
-      /*diffDesc=*/out_back_nd.handle(),
+      /*diffDesc=*/out_back_nd->handle(),
       /*diffData=*/backward_output_data.opaque(),
-      /*convDesc=*/conv.handle(),
+      /*convDesc=*/conv->handle(),
       /*algo=*/algo,
       /*workSpace=*/scratch.opaque(),
       /*workSpaceSizeInBytes=*/scratch.size(),
       /*beta=*/&beta,
-      /*gradDesc=*/filter.handle(),
+      /*gradDesc=*/filter->handle(),
       /*gradData=*/backward_filter_data->opaque());
   if (is_profiling) {
     timer->Stop(AsCUDAStream(stream));
@@ -19,6 +19,9 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_DNN_H_
 #define TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_DNN_H_
 
+#include <memory>
+#include <unordered_map>
+
 #include "tensorflow/stream_executor/dnn.h"
 #include "tensorflow/stream_executor/lib/status.h"
 #include "tensorflow/stream_executor/platform/mutex.h"
@@ -34,6 +37,9 @@ class CUDAExecutor;
 class CudnnRnnDescriptor;
 class CudnnRnnSequenceTensorDescriptor;
 class CudnnRnnStateTensorDescriptor;
+class ScopedConvolutionDescriptor;
+class ScopedFilterDescriptor;
+class ScopedTensorDescriptor;
 
 // Opaque and unique identifier for the cuDNN plugin.
 extern const PluginId kCuDnnPlugin;
@@ -50,7 +56,8 @@ class CudnnSupport : public dnn::DnnSupport {
   port::StatusOr<std::unique_ptr<dnn::RnnDescriptor>> createRnnDescriptor(
       int num_layers, int hidden_size, int input_size,
       dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
-      dnn::RnnMode rnn_mode, dnn::DataType data_type, float dropout,
+      dnn::RnnMode rnn_mode, dnn::DataType data_type,
+      dnn::RnnAlgorithm algorithm, bool use_tensor_op_math, float dropout,
       uint64 seed, ScratchAllocator* state_allocator) override;
 
   port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
@@ -77,7 +84,26 @@ class CudnnSupport : public dnn::DnnSupport {
                     const dnn::RnnStateTensorDescriptor& output_c_desc,
                     DeviceMemory<float>* output_c_data, bool is_training,
                     ScratchAllocator* reserve_space_allocator,
-                    ScratchAllocator* workspace_allocator) override;
+                    ScratchAllocator* workspace_allocator,
+                    dnn::ProfileResult* output_profile_result) override;
+
+  bool DoRnnForward(Stream* stream, const dnn::RnnDescriptor& rnn_desc,
+                    const dnn::RnnSequenceTensorDescriptor& input_desc,
+                    const DeviceMemory<Eigen::half>& input_data,
+                    const dnn::RnnStateTensorDescriptor& input_h_desc,
+                    const DeviceMemory<Eigen::half>& input_h_data,
+                    const dnn::RnnStateTensorDescriptor& input_c_desc,
+                    const DeviceMemory<Eigen::half>& input_c_data,
+                    const DeviceMemory<Eigen::half>& params,
+                    const dnn::RnnSequenceTensorDescriptor& output_desc,
+                    DeviceMemory<Eigen::half>* output_data,
+                    const dnn::RnnStateTensorDescriptor& output_h_desc,
+                    DeviceMemory<Eigen::half>* output_h_data,
+                    const dnn::RnnStateTensorDescriptor& output_c_desc,
+                    DeviceMemory<Eigen::half>* output_c_data, bool is_training,
+                    ScratchAllocator* reserve_space_allocator,
+                    ScratchAllocator* workspace_allocator,
+                    dnn::ProfileResult* output_profile_result) override;
 
   bool DoRnnBackward(Stream* stream, const dnn::RnnDescriptor& rnn_desc,
                      const dnn::RnnSequenceTensorDescriptor& input_desc,
@@ -103,6 +129,31 @@ class CudnnSupport : public dnn::DnnSupport {
                      DeviceMemory<uint8>* reserve_space_data,
                      ScratchAllocator* workspace_allocator) override;
 
+  bool DoRnnBackward(
+      Stream* stream, const dnn::RnnDescriptor& rnn_desc,
+      const dnn::RnnSequenceTensorDescriptor& input_desc,
+      const DeviceMemory<Eigen::half>& input_data,
+      const dnn::RnnStateTensorDescriptor& input_h_desc,
+      const DeviceMemory<Eigen::half>& input_h_data,
+      const dnn::RnnStateTensorDescriptor& input_c_desc,
+      const DeviceMemory<Eigen::half>& input_c_data,
+      const DeviceMemory<Eigen::half>& params,
+      const dnn::RnnSequenceTensorDescriptor& output_desc,
+      const DeviceMemory<Eigen::half>& output_data,
+      const dnn::RnnStateTensorDescriptor& output_h_desc,
+      const DeviceMemory<Eigen::half>& output_h_data,
+      const dnn::RnnStateTensorDescriptor& output_c_desc,
+      const DeviceMemory<Eigen::half>& output_c_data,
+      const DeviceMemory<Eigen::half>& output_backprop_data,
+      const DeviceMemory<Eigen::half>& output_h_backprop_data,
+      const DeviceMemory<Eigen::half>& output_c_backprop_data,
+      DeviceMemory<Eigen::half>* input_backprop_data,
+      DeviceMemory<Eigen::half>* input_h_backprop_data,
+      DeviceMemory<Eigen::half>* input_c_backprop_data,
+      DeviceMemory<Eigen::half>* params_backprop_data,
+      DeviceMemory<uint8>* reserve_space_data,
+      ScratchAllocator* workspace_allocator) override;
+
   bool GetConvolveAlgorithms(
       bool with_winograd_nonfused,
       std::vector<dnn::AlgorithmType>* out_algorithms) override;
@@ -462,6 +513,33 @@ class CudnnSupport : public dnn::DnnSupport {
   // single cuda_dnn translation unit.
   void* dnn_handle_ GUARDED_BY(dnn_handle_mutex_);
 
+  // cudnn descriptors of recent convolutions, keyed by the descriptors and
+  // data types they're built from, so that they aren't created and
+  // destroyed in every call. The descriptors are shared, so that callers
+  // keep them alive even if the cache is cleared.
+  std::unordered_map<string, std::shared_ptr<ScopedTensorDescriptor>>
+      tensor_descriptors_ GUARDED_BY(dnn_handle_mutex_);
+  std::unordered_map<string, std::shared_ptr<ScopedFilterDescriptor>>
+      filter_descriptors_ GUARDED_BY(dnn_handle_mutex_);
+  std::unordered_map<string, std::shared_ptr<ScopedConvolutionDescriptor>>
+      convolution_descriptors_ GUARDED_BY(dnn_handle_mutex_);
+
+  // Return the cached cudnn descriptor for the given descriptor and data
+  // type, or a new one.
+  std::shared_ptr<ScopedTensorDescriptor> GetTensorDescriptor(
+      const dnn::BatchDescriptor& batch_descriptor,
+      int cudnn_type)  // Actually cudnnDataType_t.
+      EXCLUSIVE_LOCKS_REQUIRED(dnn_handle_mutex_);
+  std::shared_ptr<ScopedFilterDescriptor> GetFilterDescriptor(
+      const dnn::FilterDescriptor& filter_descriptor,
+      const dnn::BatchDescriptor& batch_descriptor,
+      int cudnn_type)  // Actually cudnnDataType_t.
+      EXCLUSIVE_LOCKS_REQUIRED(dnn_handle_mutex_);
+  std::shared_ptr<ScopedConvolutionDescriptor> GetConvolutionDescriptor(
+      const dnn::ConvolutionDescriptor& convolution_descriptor,
+      int cudnn_type)  // Actually cudnnDataType_t.
+      EXCLUSIVE_LOCKS_REQUIRED(dnn_handle_mutex_);
+
   // NOTE(keveman): Temporary data layout transformation until cuDNN supports
   // kBatchYXDepth for backward pass. This function allocates temporary memory,
   // lays out the source data into the temporary but in the kBatchDepthXY
@@ -578,7 +656,8 @@ class CudnnSupport : public dnn::DnnSupport {
                         const CudnnRnnStateTensorDescriptor& output_c_desc,
                         DeviceMemory<T>* output_c_data, bool is_training,
                         ScratchAllocator* reserve_space_allocator,
-                        ScratchAllocator* workspace_allocator);
+                        ScratchAllocator* workspace_allocator,
+                        dnn::ProfileResult* output_profile_result);
 
   template <class T>
   bool DoRnnBackwardImpl(Stream* stream, const CudnnRnnDescriptor& rnn_desc,
@@ -595,13 +674,13 @@ class CudnnSupport : public dnn::DnnSupport {
                          const DeviceMemory<T>& output_h_data,
                          const CudnnRnnStateTensorDescriptor& output_c_desc,
                          const DeviceMemory<T>& output_c_data,
-                         const DeviceMemory<float>& output_backprop_data,
-                         const DeviceMemory<float>& output_h_backprop_data,
-                         const DeviceMemory<float>& output_c_backprop_data,
-                         DeviceMemory<float>* input_backprop_data,
-                         DeviceMemory<float>* input_h_backprop_data,
-                         DeviceMemory<float>* input_c_backprop_data,
-                         DeviceMemory<float>* params_backprop_data,
+                         const DeviceMemory<T>& output_backprop_data,
+                         const DeviceMemory<T>& output_h_backprop_data,
+                         const DeviceMemory<T>& output_c_backprop_data,
+                         DeviceMemory<T>* input_backprop_data,
+                         DeviceMemory<T>* input_h_backprop_data,
+                         DeviceMemory<T>* input_c_backprop_data,
+                         DeviceMemory<T>* params_backprop_data,
                          DeviceMemory<uint8>* reserve_space_data,
                          ScratchAllocator* workspace_allocator);
 
@@ -107,6 +107,18 @@ class CUDADriver {
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1g89b3f154e17cc89b6eea277dbdf5c93a
   static void DeviceDeallocate(CudaContext* context, void *location);
 
+  // Allocates a unified memory space of size bytes associated with the given
+  // context via cuMemAllocManaged, and advises the driver to keep it on
+  // "device" when possible. Unified memory can exceed the memory of the
+  // device; pages are migrated between the host and the device on access.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1gb347ded34dc326af404aa02af5388a32
+  static void *UnifiedMemoryAllocate(CudaContext* context, CUdevice device,
+                                     uint64 bytes);
+
+  // Deallocates a unified memory space allocated by UnifiedMemoryAllocate,
+  // via cuMemFree.
+  static void UnifiedMemoryDeallocate(CudaContext* context, void *location);
+
   // Allocates page-locked and CUDA-registered memory on the host via
   // cuMemAllocHost.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1gdd8311286d2c2691605362c689bc64e0
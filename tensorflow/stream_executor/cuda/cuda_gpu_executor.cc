@@ -339,8 +339,32 @@ bool CUDAExecutor::GetKernelMetadata(CUDAKernel *cuda_kernel,
 bool CUDAExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
                           const BlockDim &block_dims, const KernelBase &kernel,
                           const KernelArgsArrayBase &args) {
-  CHECK_EQ(kernel.Arity(), args.number_of_arguments());
+  return LaunchOnStream(GetCudaContext(stream), AsCUDAStreamValue(stream),
+                        thread_dims, block_dims, kernel, args);
+}
+
+bool CUDAExecutor::LaunchBatch(Stream *stream,
+                               port::ArraySlice<KernelLaunch> launches) {
+  CudaContext *context = GetCudaContext(stream);
   CUstream custream = AsCUDAStreamValue(stream);
+  // Keeps the context current across the launches, so that each
+  // CUDADriver::LaunchKernel finds it already active.
+  ScopedActivateContext activation{context};
+  for (const KernelLaunch &launch : launches) {
+    if (!LaunchOnStream(context, custream, launch.thread_dims,
+                        launch.block_dims, *launch.kernel, *launch.args)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CUDAExecutor::LaunchOnStream(CudaContext *context, CUstream custream,
+                                  const ThreadDim &thread_dims,
+                                  const BlockDim &block_dims,
+                                  const KernelBase &kernel,
+                                  const KernelArgsArrayBase &args) {
+  CHECK_EQ(kernel.Arity(), args.number_of_arguments());
   const CUDAKernel *cuda_kernel = AsCUDAKernel(&kernel);
   CUfunction cufunc = cuda_kernel->AsCUDAFunctionValue();
 
@@ -364,7 +388,7 @@ bool CUDAExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
 
   void **kernel_params = const_cast<void **>(args.argument_addresses().data());
 
-  if (!CUDADriver::LaunchKernel(GetCudaContext(stream), cufunc, block_dims.x,
+  if (!CUDADriver::LaunchKernel(context, cufunc, block_dims.x,
                                 block_dims.y, block_dims.z, thread_dims.x,
                                 thread_dims.y, thread_dims.z,
                                 args.number_of_shared_bytes(), custream,
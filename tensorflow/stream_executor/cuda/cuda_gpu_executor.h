@@ -67,6 +67,9 @@ class CUDAExecutor : public internal::StreamExecutorInterface {
               const BlockDim &block_dims, const KernelBase &k,
               const KernelArgsArrayBase &args) override;
 
+  bool LaunchBatch(Stream *stream,
+                   port::ArraySlice<KernelLaunch> launches) override;
+
   void *Allocate(uint64 size) override;
 
   void *AllocateSubBuffer(DeviceMemoryBase *mem, uint64 offset_bytes,
@@ -78,6 +81,14 @@ class CUDAExecutor : public internal::StreamExecutorInterface {
   // internally sets up buffers for DMA operations (and page locks them).
   // There's no external interface for us to otherwise control these DMA
   // settings.
+  void *UnifiedMemoryAllocate(uint64 size) override {
+    return CUDADriver::UnifiedMemoryAllocate(context_, device_, size);
+  }
+
+  void UnifiedMemoryDeallocate(void *location) override {
+    return CUDADriver::UnifiedMemoryDeallocate(context_, location);
+  }
+
   void *HostMemoryAllocate(uint64 size) override {
     return CUDADriver::HostAllocate(context_, size);
   }
@@ -207,6 +218,13 @@ class CUDAExecutor : public internal::StreamExecutorInterface {
   CudaContext* cuda_context();
 
  private:
+  // Launches kernel on custream, in context, which the caller has already
+  // looked up for the stream. Shared by Launch and LaunchBatch.
+  bool LaunchOnStream(CudaContext *context, CUstream custream,
+                      const ThreadDim &thread_dims, const BlockDim &block_dims,
+                      const KernelBase &kernel,
+                      const KernelArgsArrayBase &args);
+
   // Attempts to find a more specific version of the file indicated by
   // filename by looking for compute-capability-specific suffixed versions; i.e.
   // looking for "foo.ptx" will check to see if "foo.ptx.cc30.ptx" is present if
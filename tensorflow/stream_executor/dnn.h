@@ -128,6 +128,16 @@ enum class RnnDirectionMode {
   kRnnBidirectional = 1,
 };
 
+// Specifies the algorithm used to compute a RNN model. The persistent
+// algorithms keep the recurrent weights on chip across the time steps, which
+// is much faster for small batches. The static variant is compiled once for
+// all batch sizes, the dynamic one builds a plan for each batch size.
+enum class RnnAlgorithm {
+  kRnnStandard = 0,
+  kRnnPersistStatic = 1,
+  kRnnPersistDynamic = 2,
+};
+
 // Relevant to DepthToSpace and SpaceToDepth. This is the write layout when
 // performing depth to space and the read layout when performing space to depth.
 // It's specified with most-major dimension first and most-minor dimension last.
@@ -1802,6 +1812,9 @@ class DnnSupport {
   //    bidirectional.
   //  rnn_mode: an enum to specify the type of model to build.
   //  data_type: an enum to specify the data types used in this model.
+  //  algorithm: an enum to specify the algorithm that computes this model.
+  //  use_tensor_op_math: whether the matrix multiplications may use Tensor
+  //    Core operations, where they are supported.
   //  dropout: the dropout threshold between layers. When it is 0., no dropout
   //    is added.
   //  seed: a seed for initializing the dropout layers.
@@ -1813,6 +1826,7 @@ class DnnSupport {
                       dnn::RnnInputMode input_mode,
                       dnn::RnnDirectionMode direction_mode,
                       dnn::RnnMode rnn_mode, dnn::DataType data_type,
+                      dnn::RnnAlgorithm algorithm, bool use_tensor_op_math,
                       float dropout, uint64 seed,
                       ScratchAllocator* state_allocator) {
     return port::Status{port::error::UNIMPLEMENTED,
@@ -1872,6 +1886,9 @@ class DnnSupport {
   //  workspace_allocator: an allocator to create temporary workspace used in
   //    this kernel. The caller is responsible for retaining the memory long
   //    enough for the lifespan of this operation, and recycles aftewards.
+  //  output_profile_result: if not null, the elapsed time of the operation is
+  //    stored here, and failures are not logged so that the caller can try
+  //    other algorithms.
   virtual bool DoRnnForward(Stream* stream, const dnn::RnnDescriptor& rnn_desc,
                             const dnn::RnnSequenceTensorDescriptor& input_desc,
                             const DeviceMemory<float>& input_data,
@@ -1888,7 +1905,29 @@ class DnnSupport {
                             DeviceMemory<float>* output_c_data,
                             bool is_training,
                             ScratchAllocator* reserve_space_allocator,
-                            ScratchAllocator* workspace_allocator) {
+                            ScratchAllocator* workspace_allocator,
+                            dnn::ProfileResult* output_profile_result) {
+    return false;
+  }
+
+  virtual bool DoRnnForward(
+      Stream* stream, const dnn::RnnDescriptor& rnn_desc,
+      const dnn::RnnSequenceTensorDescriptor& input_desc,
+      const DeviceMemory<Eigen::half>& input_data,
+      const dnn::RnnStateTensorDescriptor& input_h_desc,
+      const DeviceMemory<Eigen::half>& input_h_data,
+      const dnn::RnnStateTensorDescriptor& input_c_desc,
+      const DeviceMemory<Eigen::half>& input_c_data,
+      const DeviceMemory<Eigen::half>& params,
+      const dnn::RnnSequenceTensorDescriptor& output_desc,
+      DeviceMemory<Eigen::half>* output_data,
+      const dnn::RnnStateTensorDescriptor& output_h_desc,
+      DeviceMemory<Eigen::half>* output_h_data,
+      const dnn::RnnStateTensorDescriptor& output_c_desc,
+      DeviceMemory<Eigen::half>* output_c_data, bool is_training,
+      ScratchAllocator* reserve_space_allocator,
+      ScratchAllocator* workspace_allocator,
+      dnn::ProfileResult* output_profile_result) {
     return false;
   }
 
@@ -1960,6 +1999,33 @@ class DnnSupport {
     return false;
   }
 
+  virtual bool DoRnnBackward(
+      Stream* stream, const dnn::RnnDescriptor& rnn_desc,
+      const dnn::RnnSequenceTensorDescriptor& input_desc,
+      const DeviceMemory<Eigen::half>& input_data,
+      const dnn::RnnStateTensorDescriptor& input_h_desc,
+      const DeviceMemory<Eigen::half>& input_h_data,
+      const dnn::RnnStateTensorDescriptor& input_c_desc,
+      const DeviceMemory<Eigen::half>& input_c_data,
+      const DeviceMemory<Eigen::half>& params,
+      const dnn::RnnSequenceTensorDescriptor& output_desc,
+      const DeviceMemory<Eigen::half>& output_data,
+      const dnn::RnnStateTensorDescriptor& output_h_desc,
+      const DeviceMemory<Eigen::half>& output_h_data,
+      const dnn::RnnStateTensorDescriptor& output_c_desc,
+      const DeviceMemory<Eigen::half>& output_c_data,
+      const DeviceMemory<Eigen::half>& output_backprop_data,
+      const DeviceMemory<Eigen::half>& output_h_backprop_data,
+      const DeviceMemory<Eigen::half>& output_c_backprop_data,
+      DeviceMemory<Eigen::half>* input_backprop_data,
+      DeviceMemory<Eigen::half>* input_h_backprop_data,
+      DeviceMemory<Eigen::half>* input_c_backprop_data,
+      DeviceMemory<Eigen::half>* params_backprop_data,
+      DeviceMemory<uint8>* reserve_space_data,
+      ScratchAllocator* workspace_allocator) {
+    return false;
+  }
+
   // Transforms a tensor into another tensor with a different layout and/or data
   // type.
   //
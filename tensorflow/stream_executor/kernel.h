@@ -77,6 +77,7 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/kernel_cache_config.h"
+#include "tensorflow/stream_executor/launch_dim.h"
 #include "tensorflow/stream_executor/lib/array_slice.h"
 #include "tensorflow/stream_executor/lib/inlined_vector.h"
 #include "tensorflow/stream_executor/lib/stringpiece.h"
@@ -433,6 +434,14 @@ class KernelArgsArray : public KernelArgsArrayBase {
     total_shared_memory_bytes_ += number_of_bytes;
   }
 
+  // Removes all the arguments, so that the array can be packed again for
+  // another launch.
+  void clear() {
+    total_shared_memory_bytes_ = 0;
+    number_of_argument_addresses_ = 0;
+    number_of_shared_memory_arguments_ = 0;
+  }
+
   // Gets the number of arguments added so far, including shared memory
   // arguments.
   size_t number_of_arguments() const override {
@@ -485,6 +494,17 @@ class KernelArgsArray : public KernelArgsArrayBase {
   size_t number_of_shared_memory_arguments_;
 };
 
+// One kernel launch in a sequence passed to Stream::ThenLaunchBatch. The
+// kernel and args are borrowed, and must stay alive until the batch has been
+// enqueued. A sequence can be built once and enqueued many times; to change
+// the arguments of a launch, clear() its args and pack them again.
+struct KernelLaunch {
+  ThreadDim thread_dims;
+  BlockDim block_dims;
+  const KernelBase *kernel;
+  const KernelArgsArrayBase *args;
+};
+
 // Typed variant of KernelBase, like a typed device function pointer. See the
 // file comment for details and example usage.
 //
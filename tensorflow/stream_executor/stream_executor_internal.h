@@ -169,10 +169,25 @@ class StreamExecutorInterface {
                       const KernelArgsArrayBase &args) {
     return false;
   }
+  virtual bool LaunchBatch(Stream *stream,
+                           port::ArraySlice<KernelLaunch> launches) {
+    for (const KernelLaunch &launch : launches) {
+      if (!Launch(stream, launch.thread_dims, launch.block_dims,
+                  *launch.kernel, *launch.args)) {
+        return false;
+      }
+    }
+    return true;
+  }
   virtual void *Allocate(uint64 size) = 0;
   virtual void *AllocateSubBuffer(DeviceMemoryBase *parent, uint64 offset,
                                   uint64 size) = 0;
   virtual void Deallocate(DeviceMemoryBase *mem) = 0;
+  // Allocates unified memory space of the given size, if supported.
+  virtual void *UnifiedMemoryAllocate(uint64 size) { return nullptr; }
+  // Deallocates unified memory space previously allocated with
+  // UnifiedMemoryAllocate.
+  virtual void UnifiedMemoryDeallocate(void *mem) {}
   virtual void *HostMemoryAllocate(uint64 size) = 0;
   virtual void HostMemoryDeallocate(void *mem) = 0;
   virtual bool HostMemoryRegister(void *mem, uint64 size) = 0;
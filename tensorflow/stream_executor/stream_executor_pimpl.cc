@@ -100,16 +100,18 @@ class ScopedTracer {
                BeginArgsT... begin_args)
       : stream_exec_(stream_exec),
         complete_call_(complete_call),
-        result_(result) {
-    if (stream_exec_->tracing_enabled_) {
+        result_(result),
+        traced_(false) {
+    if (stream_exec_->TracingActive()) {
       correlation_id_ =
           correlation_id_generator.fetch_add(1, std::memory_order_relaxed) - 1;
+      traced_ = true;
       Trace(begin_call, begin_args...);
     }
   }
 
   ~ScopedTracer() {
-    if (stream_exec_->tracing_enabled_) {
+    if (traced_) {
       Trace(complete_call_, result_);
     }
   }
@@ -131,6 +133,10 @@ class ScopedTracer {
   CompleteCallT complete_call_;
   const ReturnT* result_;
   int64 correlation_id_;
+
+  // Whether the begin call was traced, so that the complete call is traced
+  // too, even if the listeners change in between.
+  bool traced_;
 };
 
 template <typename BeginCallT, typename CompleteCallT, typename ReturnT,
@@ -160,7 +166,8 @@ StreamExecutor::StreamExecutor(PlatformKind platform_kind,
       background_threads_(new port::ThreadPool(
           port::Env::Default(), "stream_executor", kNumBackgroundThreads)),
       live_stream_count_(0),
-      tracing_enabled_(false) {
+      tracing_enabled_(false),
+      listener_count_(0) {
   CheckPlatformKindIsValid(platform_kind);
 }
 
@@ -173,7 +180,8 @@ StreamExecutor::StreamExecutor(
       background_threads_(new port::ThreadPool(
           port::Env::Default(), "stream_executor", kNumBackgroundThreads)),
       live_stream_count_(0),
-      tracing_enabled_(false) {
+      tracing_enabled_(false),
+      listener_count_(0) {
   if (port::Lowercase(platform_->Name()) == "cuda") {
     platform_kind_ = PlatformKind::kCuda;
   } else if (port::Lowercase(platform_->Name()) == "opencl") {
@@ -330,8 +338,9 @@ port::StatusOr<std::unique_ptr<dnn::RnnDescriptor>>
 StreamExecutor::createRnnDescriptor(
     int num_layers, int hidden_size, int input_size,
     dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
-    dnn::RnnMode rnn_mode, dnn::DataType data_type, float dropout, uint64 seed,
-    ScratchAllocator *state_allocator) {
+    dnn::RnnMode rnn_mode, dnn::DataType data_type,
+    dnn::RnnAlgorithm algorithm, bool use_tensor_op_math, float dropout,
+    uint64 seed, ScratchAllocator *state_allocator) {
   dnn::DnnSupport *dnn_support = AsDnn();
   if (!dnn_support) {
     return port::Status(port::error::UNKNOWN,
@@ -339,7 +348,7 @@ StreamExecutor::createRnnDescriptor(
   }
   return dnn_support->createRnnDescriptor(
       num_layers, hidden_size, input_size, input_mode, direction_mode, rnn_mode,
-      data_type, dropout, seed, state_allocator);
+      data_type, algorithm, use_tensor_op_math, dropout, seed, state_allocator);
 }
 
 port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
@@ -418,6 +427,18 @@ bool StreamExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
   return implementation_->Launch(stream, thread_dims, block_dims, kernel, args);
 }
 
+bool StreamExecutor::LaunchBatch(Stream *stream,
+                                 port::ArraySlice<KernelLaunch> launches) {
+  if (TracingActive()) {
+    for (const KernelLaunch &launch : launches) {
+      SubmitTrace(&TraceListener::LaunchSubmit, stream, launch.thread_dims,
+                  launch.block_dims, *launch.kernel, *launch.args);
+    }
+  }
+
+  return implementation_->LaunchBatch(stream, launches);
+}
+
 bool StreamExecutor::BlockHostUntilDone(Stream *stream) {
   bool result;
   SCOPED_TRACE(TraceListener::BlockHostUntilDone, &result, stream);
@@ -440,6 +461,20 @@ bool StreamExecutor::GetSymbol(const string &symbol_name, void **mem,
   return implementation_->GetSymbol(symbol_name, mem, bytes);
 }
 
+void *StreamExecutor::UnifiedMemoryAllocate(uint64 bytes) {
+  void *buffer = implementation_->UnifiedMemoryAllocate(bytes);
+  VLOG(1) << "Called StreamExecutor::UnifiedMemoryAllocate(size=" << bytes
+          << ") returns " << buffer << StackTraceIfVLOG10();
+  return buffer;
+}
+
+void StreamExecutor::UnifiedMemoryDeallocate(void *location) {
+  VLOG(1) << "Called StreamExecutor::UnifiedMemoryDeallocate(location="
+          << location << ")" << StackTraceIfVLOG10();
+
+  return implementation_->UnifiedMemoryDeallocate(location);
+}
+
 void *StreamExecutor::HostMemoryAllocate(uint64 size) {
   void *buffer = implementation_->HostMemoryAllocate(size);
   VLOG(1) << "Called StreamExecutor::HostMemoryAllocate(size=" << size
@@ -729,6 +764,7 @@ void StreamExecutor::RegisterTraceListener(TraceListener *listener) {
                 << listener;
     } else {
       listeners_.insert(listener);
+      listener_count_.store(listeners_.size(), std::memory_order_relaxed);
     }
   }
 
@@ -743,6 +779,7 @@ bool StreamExecutor::UnregisterTraceListener(TraceListener *listener) {
       return false;
     }
     listeners_.erase(listener);
+    listener_count_.store(listeners_.size(), std::memory_order_relaxed);
   }
 
   implementation_->UnregisterTraceListener(listener);
@@ -751,7 +788,7 @@ bool StreamExecutor::UnregisterTraceListener(TraceListener *listener) {
 
 template <typename TraceCallT, typename... ArgsT>
 void StreamExecutor::SubmitTrace(TraceCallT trace_call, ArgsT &&... args) {
-  if (tracing_enabled_) {
+  if (TracingActive()) {
     {
       // instance tracers held in a block to limit the lock lifetime.
       shared_lock lock{mu_};
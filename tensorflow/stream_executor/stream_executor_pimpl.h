@@ -184,6 +184,15 @@ class StreamExecutor {
   // Note: this will only be populated if --check_gpu_leaks flag is activated.
   void GetMemAllocs(std::map<void *, AllocRecord> *records_out);
 
+  // Allocates unified memory of "bytes", which is accessible from the host
+  // and the device, and may exceed the memory of the device. Returns
+  // nullptr if the platform does not support unified memory or the
+  // allocation fails.
+  void *UnifiedMemoryAllocate(uint64 bytes);
+
+  // Deallocates unified memory allocated by UnifiedMemoryAllocate().
+  void UnifiedMemoryDeallocate(void *location);
+
   // Allocates a region of host memory and registers it with the platform API.
   // Memory allocated in this manner (or allocated and registered with
   // HostMemoryRegister() is required for use in asynchronous memcpy operations,
@@ -364,7 +373,8 @@ class StreamExecutor {
   port::StatusOr<std::unique_ptr<dnn::RnnDescriptor>> createRnnDescriptor(
       int num_layers, int hidden_size, int input_size,
       dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
-      dnn::RnnMode rnn_mode, dnn::DataType data_type, float dropout,
+      dnn::RnnMode rnn_mode, dnn::DataType data_type,
+      dnn::RnnAlgorithm algorithm, bool use_tensor_op_math, float dropout,
       uint64 seed, ScratchAllocator *state_allocator);
 
   // Create a RNN sequence descriptor that specifies either the input or output
@@ -403,6 +413,12 @@ class StreamExecutor {
               const BlockDim &block_dims, const KernelBase &kernel,
               const KernelArgsArrayBase &args);
 
+  // Launches each of the kernels in 'launches', in order, with already-packed
+  // args. This is called by Stream::ThenLaunchBatch(), and lets the platform
+  // do the per-stream setup once for the whole sequence. Returns false, at
+  // the first launch that fails; the launches before it stay enqueued.
+  bool LaunchBatch(Stream *stream, port::ArraySlice<KernelLaunch> launches);
+
   // Gets-or-creates (creates with memoization) a FftSupport datatype that can
   // be used to execute FFT routines on the current platform.
   //
@@ -568,6 +584,14 @@ class StreamExecutor {
   template <typename TraceCallT, typename... ArgsT>
   void SubmitTrace(TraceCallT trace_call, ArgsT&&... args);
 
+  // Returns true if there are trace calls to make: tracing is enabled and at
+  // least one listener is registered. This is checked without taking mu_, so
+  // that untraced calls on hot paths such as Launch() don't contend on it.
+  bool TracingActive() const {
+    return tracing_enabled_ &&
+           listener_count_.load(std::memory_order_relaxed) > 0;
+  }
+
   // Reader/writer lock for class-static StreamExecutor members.
   static mutex static_mu_;
 
@@ -648,6 +672,9 @@ class StreamExecutor {
   // The set of TraceListeners registered for this StreamExecutor.
   std::set<TraceListener*> listeners_ GUARDED_BY(mu_);
 
+  // The size of listeners_, readable without holding mu_.
+  std::atomic_int_fast32_t listener_count_;
+
   SE_DISALLOW_COPY_AND_ASSIGN(StreamExecutor);
 };
 
@@ -788,6 +815,15 @@ inline Stream &Stream::ThenLaunch(ThreadDim thread_dims, BlockDim block_dims,
   return *this;
 }
 
+template <typename... Params, typename... Args>
+inline void Stream::PackKernelArgs(
+    const TypedKernel<Params...> &kernel,
+    KernelArgsArray<sizeof...(Params)> *kernel_args, Args &... args) {
+  KernelInvocationChecker<std::tuple<Params...>,
+                          std::tuple<Args...>>::CheckAllStaticAssert();
+  kernel.PackParams(kernel_args, args...);
+}
+
 }  // namespace gputools
 }  // namespace perftools
 
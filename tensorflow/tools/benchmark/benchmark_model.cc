@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/tools/benchmark/benchmark_model.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -37,32 +38,41 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
 #include "tensorflow/core/util/reporter.h"
 #include "tensorflow/core/util/stat_summarizer.h"
 
 namespace tensorflow {
 namespace benchmark_model {
 
-Status InitializeSession(int num_threads, const string& graph,
-                         std::unique_ptr<Session>* session,
-                         std::unique_ptr<GraphDef>* graph_def) {
-  LOG(INFO) << "Loading TensorFlow.";
+namespace {
 
+SessionOptions MakeSessionOptions(int num_threads, int num_inter_op_threads) {
   tensorflow::SessionOptions options;
   tensorflow::ConfigProto& config = options.config;
   if (num_threads > 0) {
     config.set_intra_op_parallelism_threads(num_threads);
   }
+  if (num_inter_op_threads > 0) {
+    config.set_inter_op_parallelism_threads(num_inter_op_threads);
+  }
   LOG(INFO) << "Got config, " << config.device_count_size() << " devices";
+  return options;
+}
 
+// Reads the GraphDef in file 'graph' of options.env and creates a session
+// for it.
+Status CreateSessionFromFile(const SessionOptions& options, const string& graph,
+                             std::unique_ptr<Session>* session,
+                             std::unique_ptr<GraphDef>* graph_def) {
   session->reset(tensorflow::NewSession(options));
   graph_def->reset(new GraphDef());
-  tensorflow::GraphDef tensorflow_graph;
-  Status s = ReadBinaryProto(Env::Default(), graph, graph_def->get());
+  Status s = ReadBinaryProto(options.env, graph, graph_def->get());
   if (!s.ok()) {
     LOG(ERROR) << "Could not create TensorFlow Graph: " << s;
     return s;
@@ -77,6 +87,50 @@ Status InitializeSession(int num_threads, const string& graph,
   return Status::OK();
 }
 
+}  // namespace
+
+Status InitializeSession(int num_threads, const string& graph,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def) {
+  return InitializeSession(num_threads, -1, graph, session, graph_def);
+}
+
+Status InitializeSession(int num_threads, int num_inter_op_threads,
+                         const string& graph,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def) {
+  LOG(INFO) << "Loading TensorFlow.";
+  return CreateSessionFromFile(
+      MakeSessionOptions(num_threads, num_inter_op_threads), graph, session,
+      graph_def);
+}
+
+Status InitializeMemmappedSession(int num_threads, int num_inter_op_threads,
+                                  const string& graph,
+                                  std::unique_ptr<MemmappedEnv>* memmapped_env,
+                                  std::unique_ptr<Session>* session,
+                                  std::unique_ptr<GraphDef>* graph_def) {
+  LOG(INFO) << "Loading TensorFlow from memmapped file.";
+  memmapped_env->reset(new MemmappedEnv(Env::Default()));
+  Status s = (*memmapped_env)->InitializeFromFile(graph);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not map " << graph << ": " << s;
+    return s;
+  }
+
+  SessionOptions options =
+      MakeSessionOptions(num_threads, num_inter_op_threads);
+  options.env = memmapped_env->get();
+  // Constant folding would copy the weights out of the mapped file, paging
+  // all of them in and keeping them resident.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  return CreateSessionFromFile(
+      options, MemmappedFileSystem::kMemmappedPackageDefaultGraphDef, session,
+      graph_def);
+}
+
 template <class T>
 void InitializeTensor(const std::vector<float>& initialization_values,
                       Tensor* input_tensor) {
@@ -288,6 +342,69 @@ Status TimeMultipleRuns(double sleep_seconds, int num_runs,
   return Status::OK();
 }
 
+Status TimeConcurrentRuns(int num_clients, float target_qps, int num_runs,
+                          const std::vector<InputLayerInfo>& inputs,
+                          const std::vector<string>& outputs, Session* session,
+                          histogram::Histogram* latencies_us,
+                          int64* wall_time_us) {
+  LOG(INFO) << "Running benchmark for " << num_runs << " iterations from "
+            << num_clients << " clients, "
+            << (target_qps > 0 ? strings::StrCat("at ", target_qps, " qps")
+                               : string("back to back"));
+
+  Env* env = Env::Default();
+  mutex mu;
+  int next_run = 0;
+  Status status;
+  const int64 start_time = env->NowMicros();
+  auto client = [&]() {
+    for (;;) {
+      int run;
+      {
+        mutex_lock l(mu);
+        if (next_run >= num_runs || !status.ok()) {
+          return;
+        }
+        run = next_run++;
+      }
+      // In open loop mode, a run that starts late because all the clients
+      // were busy has the delay added to its latency, or a stall would only
+      // show up as the single slow run that caused it.
+      int64 queueing_time = 0;
+      if (target_qps > 0) {
+        const int64 due_time =
+            start_time + static_cast<int64>(run * 1000000.0 / target_qps);
+        const int64 now = env->NowMicros();
+        if (due_time > now) {
+          env->SleepForMicroseconds(due_time - now);
+        } else {
+          queueing_time = now - due_time;
+        }
+      }
+      int64 time;
+      Status run_status =
+          RunBenchmark(inputs, outputs, session, nullptr, &time);
+      mutex_lock l(mu);
+      if (!run_status.ok()) {
+        LOG(INFO) << "Failed on run " << run;
+        status.Update(run_status);
+        return;
+      }
+      latencies_us->Add(queueing_time + time);
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> clients;
+    for (int i = 0; i < num_clients; ++i) {
+      clients.emplace_back(env->StartThread(
+          ThreadOptions(), strings::StrCat("benchmark_client_", i), client));
+    }
+    // The Thread destructors wait for the clients to finish.
+  }
+  *wall_time_us = env->NowMicros() - start_time;
+  return status;
+}
+
 int Main(int argc, char** argv) {
   string graph = "/data/local/tmp/tensorflow_inception_graph.pb";
   string input_layer_string = "input:0";
@@ -311,9 +428,17 @@ int Main(int argc, char** argv) {
   bool show_summary = true;
   bool show_flops = false;
   int warmup_runs = 2;
+  int inter_op_threads = -1;
+  int num_clients = 0;
+  float target_qps = 0;
+  string latency_output = "";
+  bool memmapped_graph = false;
 
   std::vector<Flag> flag_list = {
       Flag("graph", &graph, "graph file name"),
+      Flag("memmapped_graph", &memmapped_graph,
+           "whether the graph file is in the memmapped format written by "
+           "convert_graphdef_memmapped_format"),
       Flag("input_layer", &input_layer_string, "input layer names"),
       Flag("input_layer_shape", &input_layer_shape_string, "input layer shape"),
       Flag("input_layer_type", &input_layer_type_string, "input layer type"),
@@ -323,6 +448,13 @@ int Main(int argc, char** argv) {
       Flag("num_runs", &num_runs, "number of runs"),
       Flag("run_delay", &run_delay, "delay between runs in seconds"),
       Flag("num_threads", &num_threads, "number of threads"),
+      Flag("inter_op_threads", &inter_op_threads, "number of inter-op threads"),
+      Flag("num_clients", &num_clients,
+           "number of concurrent clients; 0 times the runs one at a time"),
+      Flag("target_qps", &target_qps,
+           "rate at which the clients start runs; 0 runs them back to back"),
+      Flag("latency_output", &latency_output,
+           "file to write the latency percentiles to, as JSON"),
       Flag("benchmark_name", &benchmark_name, "benchmark name"),
       Flag("output_prefix", &output_prefix, "benchmark output prefix"),
       Flag("show_sizes", &show_sizes, "whether to show sizes"),
@@ -380,6 +512,7 @@ int Main(int argc, char** argv) {
   }
 
   LOG(INFO) << "Graph: [" << graph << "]";
+  LOG(INFO) << "Memmapped graph: [" << memmapped_graph << "]";
   LOG(INFO) << "Input layers: [" << input_layer_string << "]";
   LOG(INFO) << "Input shapes: [" << input_layer_shape_string << "]";
   LOG(INFO) << "Input types: [" << input_layer_type_string << "]";
@@ -387,16 +520,25 @@ int Main(int argc, char** argv) {
   LOG(INFO) << "Num runs: [" << num_runs << "]";
   LOG(INFO) << "Inter-run delay (seconds): [" << run_delay << "]";
   LOG(INFO) << "Num threads: [" << num_threads << "]";
+  LOG(INFO) << "Inter-op threads: [" << inter_op_threads << "]";
+  LOG(INFO) << "Num clients: [" << num_clients << "]";
+  LOG(INFO) << "Target qps: [" << target_qps << "]";
   LOG(INFO) << "Benchmark name: [" << benchmark_name << "]";
   LOG(INFO) << "Output prefix: [" << output_prefix << "]";
   LOG(INFO) << "Show sizes: [" << show_sizes << "]";
   LOG(INFO) << "Warmup runs: [" << warmup_runs << "]";
 
+  // Declared first so that it outlives the session reading from it.
+  std::unique_ptr<MemmappedEnv> memmapped_env;
   std::unique_ptr<Session> session;
   std::unique_ptr<StatSummarizer> stats;
   std::unique_ptr<GraphDef> graph_def;
   Status initialize_status =
-      InitializeSession(num_threads, graph, &session, &graph_def);
+      memmapped_graph
+          ? InitializeMemmappedSession(num_threads, inter_op_threads, graph,
+                                       &memmapped_env, &session, &graph_def)
+          : InitializeSession(num_threads, inter_op_threads, graph, &session,
+                              &graph_def);
   if (!initialize_status.ok()) {
     return -1;
   }
@@ -454,6 +596,45 @@ int Main(int argc, char** argv) {
     }
   }
 
+  // With concurrent clients, report the latency distribution and throughput
+  // under load instead of the per-run timings.
+  if (num_clients > 0) {
+    histogram::Histogram latencies_us;
+    int64 load_time_us = 0;
+    Status load_status =
+        TimeConcurrentRuns(num_clients, target_qps, num_runs, inputs,
+                           output_layers, session.get(), &latencies_us,
+                           &load_time_us);
+    if (!load_status.ok()) {
+      LOG(ERROR) << "Timing failed with " << load_status;
+      return -1;
+    }
+    const double achieved_qps =
+        num_runs / std::max(load_time_us / 1000000.0, 1e-6);
+    const string report = strings::StrCat(
+        "{\"num_clients\": ", num_clients, ", \"target_qps\": ", target_qps,
+        ", \"intra_op_threads\": ", num_threads,
+        ", \"inter_op_threads\": ", inter_op_threads,
+        ", \"num_runs\": ", num_runs, ", \"qps\": ", achieved_qps,
+        ", \"mean_us\": ", latencies_us.Average(),
+        ", \"p50_us\": ", latencies_us.Percentile(50),
+        ", \"p90_us\": ", latencies_us.Percentile(90),
+        ", \"p99_us\": ", latencies_us.Percentile(99),
+        ", \"p999_us\": ", latencies_us.Percentile(99.9), "}\n");
+    LOG(INFO) << "Latencies in us:\n" << latencies_us.ToString();
+    LOG(INFO) << "Load report: " << report;
+    if (!latency_output.empty()) {
+      Status write_status =
+          WriteStringToFile(Env::Default(), latency_output, report);
+      if (!write_status.ok()) {
+        LOG(ERROR) << "Writing " << latency_output << " failed with "
+                   << write_status;
+        return -1;
+      }
+    }
+    return 0;
+  }
+
   // Capture overall inference time without stat logging overhead. This is the
   // timing data that can be compared to other libaries.
   int64 no_stat_time_us = 0;
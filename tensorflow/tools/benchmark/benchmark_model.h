@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
 #include "tensorflow/core/util/stat_summarizer.h"
 
 namespace tensorflow {
@@ -35,6 +37,23 @@ Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
                          std::unique_ptr<GraphDef>* graph_def);
 
+// As above, also setting the number of inter-op threads. Thread counts that
+// aren't positive leave the session's default.
+Status InitializeSession(int num_threads, int num_inter_op_threads,
+                         const string& graph,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def);
+
+// Loads a model converted by convert_graphdef_memmapped_format into a new
+// session. Its ImmutableConst ops use the weights in place in the mapped
+// file, so only the pages of the weights that are used get read.
+// '*memmapped_env' must outlive the session.
+Status InitializeMemmappedSession(int num_threads, int num_inter_op_threads,
+                                  const string& graph,
+                                  std::unique_ptr<MemmappedEnv>* memmapped_env,
+                                  std::unique_ptr<Session>* session,
+                                  std::unique_ptr<GraphDef>* graph_def);
+
 // Does a single run of the model that's been loaded into the given session.
 Status RunBenchmark(const std::vector<InputLayerInfo>& inputs,
                     const std::vector<string>& outputs, Session* session,
@@ -46,6 +65,19 @@ Status TimeMultipleRuns(double sleep_seconds, int num_runs,
                         const std::vector<string>& outputs, Session* session,
                         StatSummarizer* stats, int64* total_time_us);
 
+// Runs the model 'num_runs' times in total from 'num_clients' concurrent
+// threads, and adds the latency of every run, in microseconds, to
+// 'latencies_us'. If 'target_qps' is positive, runs are started at that rate
+// (open loop) and a run's latency also counts the time it waited for a free
+// client past its start time; otherwise each client starts its next run as
+// soon as the previous one is done (closed loop). '*wall_time_us' is set to
+// the time taken by all the runs.
+Status TimeConcurrentRuns(int num_clients, float target_qps, int num_runs,
+                          const std::vector<InputLayerInfo>& inputs,
+                          const std::vector<string>& outputs, Session* session,
+                          histogram::Histogram* latencies_us,
+                          int64* wall_time_us);
+
 // Handles all setup and argument parsing.
 int Main(int argc, char** argv);
 
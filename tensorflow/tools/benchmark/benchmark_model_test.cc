@@ -16,12 +16,16 @@ limitations under the License.
 #include "tensorflow/tools/benchmark/benchmark_model.h"
 
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
 
 namespace tensorflow {
 namespace {
@@ -66,5 +70,104 @@ TEST(BenchmarkModelTest, InitializeAndRun) {
       0.0, 10, {input}, {output_name}, session.get(), stats.get(), &time));
 }
 
+TEST(BenchmarkModelTest, InitializeMemmappedAndRun) {
+  const string dir = testing::TmpDir();
+  const string filename = io::JoinPath(dir, "memmapped_graph");
+
+  benchmark_model::InputLayerInfo input;
+  input.shape = TensorShape({20, 10});
+  input.data_type = DT_FLOAT;
+  Tensor constant_tensor(DT_FLOAT, TensorShape({10, 20}));
+  test::FillFn<float>(&constant_tensor, [](int) -> float { return 3.0; });
+  const string region_name =
+      strings::StrCat(MemmappedFileSystem::kMemmappedPackagePrefix, "weights");
+
+  auto root = Scope::NewRootScope().ExitOnError();
+  auto placeholder =
+      ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape(input.shape));
+  input.name = placeholder.node()->name();
+  auto weights = ops::ImmutableConst(root, DT_FLOAT, constant_tensor.shape(),
+                                     region_name);
+  auto m = ops::MatMul(root, placeholder, weights);
+  const string output_name = m.node()->name();
+
+  GraphDef graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+  MemmappedFileSystemWriter writer;
+  TF_ASSERT_OK(writer.InitializeToFile(Env::Default(), filename));
+  TF_ASSERT_OK(writer.SaveTensor(constant_tensor, region_name));
+  TF_ASSERT_OK(writer.SaveProtobuf(
+      graph_def, MemmappedFileSystem::kMemmappedPackageDefaultGraphDef));
+  TF_ASSERT_OK(writer.FlushAndClose());
+
+  std::unique_ptr<MemmappedEnv> memmapped_env;
+  std::unique_ptr<Session> session;
+  std::unique_ptr<GraphDef> loaded_graph_def;
+  TF_ASSERT_OK(benchmark_model::InitializeMemmappedSession(
+      1, -1, filename, &memmapped_env, &session, &loaded_graph_def));
+  EXPECT_EQ(graph_def.node_size(), loaded_graph_def->node_size());
+  int64 time;
+  TF_ASSERT_OK(benchmark_model::TimeMultipleRuns(
+      0.0, 2, {input}, {output_name}, session.get(), nullptr, &time));
+
+  // A plain GraphDef isn't a memmapped package.
+  const string filename_pb = io::JoinPath(dir, "not_memmapped.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), filename_pb, graph_def));
+  EXPECT_FALSE(benchmark_model::InitializeMemmappedSession(
+                   1, -1, filename_pb, &memmapped_env, &session,
+                   &loaded_graph_def)
+                   .ok());
+}
+
+TEST(BenchmarkModelTest, ConcurrentRuns) {
+  const string dir = testing::TmpDir();
+  const string filename_pb = io::JoinPath(dir, "concurrent_graphdef.pb");
+
+  benchmark_model::InputLayerInfo input;
+  input.shape = TensorShape({20, 10});
+  input.data_type = DT_FLOAT;
+  Tensor constant_tensor(DT_FLOAT, TensorShape({10, 20}));
+  test::FillFn<float>(&constant_tensor, [](int) -> float { return 3.0; });
+
+  auto root = Scope::NewRootScope().ExitOnError();
+  auto placeholder =
+      ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape(input.shape));
+  input.name = placeholder.node()->name();
+  auto m = ops::MatMul(root, placeholder, constant_tensor);
+  const string output_name = m.node()->name();
+
+  GraphDef graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), filename_pb, graph_def));
+
+  std::unique_ptr<Session> session;
+  std::unique_ptr<GraphDef> loaded_graph_def;
+  TF_ASSERT_OK(benchmark_model::InitializeSession(1, 2, filename_pb, &session,
+                                                  &loaded_graph_def));
+  for (const float target_qps : {0.0f, 1000.0f}) {
+    histogram::Histogram latencies_us;
+    int64 wall_time_us;
+    TF_ASSERT_OK(benchmark_model::TimeConcurrentRuns(
+        3, target_qps, 20, {input}, {output_name}, session.get(),
+        &latencies_us, &wall_time_us));
+    HistogramProto proto;
+    latencies_us.EncodeToProto(&proto, false);
+    EXPECT_EQ(20, proto.num());
+    EXPECT_GE(latencies_us.Percentile(99), latencies_us.Percentile(50));
+    if (target_qps > 0) {
+      // The last run doesn't start before it's due, 19ms in.
+      EXPECT_GE(wall_time_us, 19000);
+    }
+  }
+
+  // Errors from any client are returned.
+  histogram::Histogram latencies_us;
+  int64 wall_time_us;
+  EXPECT_FALSE(benchmark_model::TimeConcurrentRuns(
+                   2, 0, 5, {input}, {"no_such_node"}, session.get(),
+                   &latencies_us, &wall_time_us)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,311 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <deque>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+namespace {
+
+// Returns true if the node is a Const holding a single float, and sets
+// 'value' to it.
+bool GetScalarFloatConst(const NodeDef* node, float* value) {
+  if ((node == nullptr) || (node->op() != "Const")) {
+    return false;
+  }
+  const Tensor tensor = GetNodeTensorAttr(*node, "value");
+  if ((tensor.dtype() != DT_FLOAT) || (tensor.NumElements() != 1)) {
+    return false;
+  }
+  *value = tensor.flat<float>()(0);
+  return true;
+}
+
+NodeDef MakeScalarFloatConst(const string& name, float value) {
+  NodeDef const_node;
+  const_node.set_op("Const");
+  const_node.set_name(name);
+  SetNodeAttr("dtype", DT_FLOAT, &const_node);
+  Tensor const_tensor(DT_FLOAT, {});
+  const_tensor.flat<float>()(0) = value;
+  SetNodeTensorAttr<float>("value", const_tensor, &const_node);
+  return const_node;
+}
+
+}  // namespace
+
+// Finds the float ops that sit between two eight-bit sections of the graph,
+// where the data is converted by a Dequantize and then back again by a
+// QuantizeV2. Each of these round trips costs two full passes over the data,
+// so these are the first places to look at when an eight-bit graph is slower
+// than the float version.
+void FindFloatIslands(const GraphDef& graph_def,
+                      std::vector<const NodeDef*>* island_nodes) {
+  std::map<string, const NodeDef*> node_map;
+  MapNamesToNodes(graph_def, &node_map);
+  std::map<string, std::vector<const NodeDef*>> outputs_map;
+  MapNodesToOutputs(graph_def, &outputs_map);
+
+  // Everything fed by a Dequantize, stopping at the next QuantizeV2.
+  std::set<string> after_dequantize;
+  std::deque<const NodeDef*> queue;
+  for (const NodeDef& node : graph_def.node()) {
+    if (node.op() == "Dequantize") {
+      queue.push_back(&node);
+    }
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    for (const NodeDef* output_node : outputs_map[node->name()]) {
+      if ((output_node->op() == "QuantizeV2") ||
+          after_dequantize.count(output_node->name())) {
+        continue;
+      }
+      after_dequantize.insert(output_node->name());
+      queue.push_back(output_node);
+    }
+  }
+
+  // Everything feeding the data input of a QuantizeV2, stopping at the
+  // previous Dequantize. The min and max inputs are skipped, since those are
+  // part of the conversion itself.
+  std::set<string> before_quantize;
+  for (const NodeDef& node : graph_def.node()) {
+    if ((node.op() == "QuantizeV2") && (node.input_size() > 0)) {
+      const string input_name = NodeNameFromInput(node.input(0));
+      if (node_map.count(input_name) &&
+          !before_quantize.count(input_name)) {
+        before_quantize.insert(input_name);
+        queue.push_back(node_map[input_name]);
+      }
+    }
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    if (node->op() == "Dequantize") {
+      continue;
+    }
+    for (const string& input : node->input()) {
+      if (input.empty() || (input[0] == '^')) {
+        continue;
+      }
+      const string input_name = NodeNameFromInput(input);
+      if (node_map.count(input_name) && !before_quantize.count(input_name)) {
+        before_quantize.insert(input_name);
+        queue.push_back(node_map[input_name]);
+      }
+    }
+  }
+
+  for (const NodeDef& node : graph_def.node()) {
+    if ((node.op() != "Dequantize") && (node.op() != "Const") &&
+        after_dequantize.count(node.name()) &&
+        before_quantize.count(node.name())) {
+      island_nodes->push_back(&node);
+    }
+  }
+}
+
+// Quantized activation ops only clamp their input, so when they're fed by a
+// Requantize with a constant output range (as set up by the fallback_min and
+// fallback_max arguments to quantize_nodes, or by
+// freeze_requantization_ranges), the clamp can be done by the Requantize
+// itself, by narrowing the range it's asked for. Values below zero then
+// saturate to zero, and the whole eight-bit range is spent on the values the
+// activation can actually produce. Once that's done, the float ops left
+// between eight-bit sections are logged, since those are the conversions that
+// still cost time.
+Status FoldQuantizedActivations(const GraphDef& input_graph_def,
+                                const TransformFuncContext& context,
+                                GraphDef* output_graph_def) {
+  std::set<string> graph_outputs;
+  for (const string& output_name : context.output_names) {
+    graph_outputs.insert(NodeNameFromInput(output_name));
+  }
+  std::map<string, const NodeDef*> node_map;
+  MapNamesToNodes(input_graph_def, &node_map);
+  std::map<string, std::vector<const NodeDef*>> outputs_map;
+  MapNodesToOutputs(input_graph_def, &outputs_map);
+
+  // quantize_nodes leaves behind float conversions that nothing needs any
+  // more, until strip_unused_nodes is run, so only count the uses by nodes
+  // that the outputs depend on.
+  std::set<string> live_nodes;
+  std::deque<string> queue(graph_outputs.begin(), graph_outputs.end());
+  while (!queue.empty()) {
+    const string node_name = queue.front();
+    queue.pop_front();
+    if (live_nodes.count(node_name) || !node_map.count(node_name)) {
+      continue;
+    }
+    live_nodes.insert(node_name);
+    for (const string& input : node_map[node_name]->input()) {
+      queue.push_back(NodeNameFromInput(input));
+    }
+  }
+
+  // Maps the names of the activations that can be folded to their new
+  // Requantize versions. The original Requantizes are left in place for any
+  // other users, and are removed by strip_unused_nodes otherwise.
+  std::map<string, std::vector<NodeDef>> replacements;
+  for (const NodeDef& node : input_graph_def.node()) {
+    if ((node.op() != "QuantizedRelu") && (node.op() != "QuantizedRelu6")) {
+      continue;
+    }
+    if (node.input_size() < 3) {
+      continue;
+    }
+    // All three inputs must come from the same Requantize, in order.
+    const string requantize_name = NodeNameFromInput(node.input(0));
+    if (!node_map.count(requantize_name)) {
+      continue;
+    }
+    const NodeDef& requantize_node = *node_map[requantize_name];
+    if (requantize_node.op() != "Requantize") {
+      continue;
+    }
+    bool inputs_match = true;
+    for (int i = 0; i < 3; ++i) {
+      if (CanonicalInputName(node.input(i)) !=
+          strings::StrCat(requantize_name, ":", i)) {
+        inputs_match = false;
+      }
+    }
+    if (!inputs_match) {
+      continue;
+    }
+    // If anything else uses the unclamped values, they have to be kept.
+    if (graph_outputs.count(requantize_name)) {
+      continue;
+    }
+    bool has_other_outputs = false;
+    for (const NodeDef* output_node : outputs_map[requantize_name]) {
+      if ((output_node->name() != node.name()) &&
+          (graph_outputs.empty() || live_nodes.count(output_node->name()))) {
+        has_other_outputs = true;
+      }
+    }
+    if (has_other_outputs) {
+      continue;
+    }
+    // The requested range has to be known ahead of time. The dynamic ranges
+    // from RequantizationRange ops can be frozen into constants by running
+    // freeze_requantization_ranges first.
+    float requested_min;
+    float requested_max;
+    if ((requantize_node.input_size() < 5) ||
+        !GetScalarFloatConst(
+            node_map[NodeNameFromInput(requantize_node.input(3))],
+            &requested_min) ||
+        !GetScalarFloatConst(
+            node_map[NodeNameFromInput(requantize_node.input(4))],
+            &requested_max)) {
+      continue;
+    }
+    DataType activation_type = DT_QUINT8;
+    if (node.attr().count("out_type")) {
+      activation_type = node.attr().at("out_type").type();
+    }
+    if (!requantize_node.attr().count("out_type") ||
+        (requantize_node.attr().at("out_type").type() != activation_type)) {
+      continue;
+    }
+    // Requantize requires a lowest value that's zero or below, so zero is the
+    // only choice that clamps.
+    const float folded_min = 0.0f;
+    float folded_max = requested_max;
+    if (node.op() == "QuantizedRelu6") {
+      folded_max = std::min(folded_max, 6.0f);
+    }
+    if ((requested_min > 0.0f) || (folded_max <= folded_min)) {
+      continue;
+    }
+
+    std::vector<NodeDef>& new_nodes = replacements[node.name()];
+    new_nodes.push_back(MakeScalarFloatConst(
+        node.name() + "/requested_output_min", folded_min));
+    new_nodes.push_back(MakeScalarFloatConst(
+        node.name() + "/requested_output_max", folded_max));
+
+    NodeDef folded_node = requantize_node;
+    folded_node.set_name(node.name());
+    folded_node.mutable_input()->Clear();
+    AddNodeInput(requantize_node.input(0), &folded_node);
+    AddNodeInput(requantize_node.input(1), &folded_node);
+    AddNodeInput(requantize_node.input(2), &folded_node);
+    AddNodeInput(new_nodes[0].name(), &folded_node);
+    AddNodeInput(new_nodes[1].name(), &folded_node);
+    // Keep any control dependencies of both of the original nodes.
+    for (const NodeDef* original_node : {&requantize_node, &node}) {
+      for (const string& input : original_node->input()) {
+        if (!input.empty() && (input[0] == '^')) {
+          AddNodeInput(input, &folded_node);
+        }
+      }
+    }
+    new_nodes.push_back(folded_node);
+  }
+
+  output_graph_def->Clear();
+  for (const NodeDef& node : input_graph_def.node()) {
+    if (replacements.count(node.name())) {
+      for (const NodeDef& new_node : replacements[node.name()]) {
+        *(output_graph_def->mutable_node()->Add()) = new_node;
+      }
+    } else {
+      *(output_graph_def->mutable_node()->Add()) = node;
+    }
+  }
+  if (!replacements.empty()) {
+    LOG(INFO) << "Folded " << replacements.size()
+              << " quantized activations into Requantize ops";
+  }
+
+  std::vector<const NodeDef*> island_nodes;
+  FindFloatIslands(*output_graph_def, &island_nodes);
+  if (!island_nodes.empty()) {
+    std::map<string, int> op_counts;
+    for (const NodeDef* island_node : island_nodes) {
+      ++op_counts[island_node->op()];
+      VLOG(1) << "Float op between eight-bit sections: "
+              << island_node->name() << " (" << island_node->op() << ")";
+    }
+    std::vector<string> op_summaries;
+    for (const std::pair<const string, int>& op_count : op_counts) {
+      op_summaries.push_back(
+          strings::StrCat(op_count.first, " x", op_count.second));
+    }
+    LOG(INFO) << island_nodes.size()
+              << " float ops are left between eight-bit sections: "
+              << str_util::Join(op_summaries, ", ");
+  }
+
+  return Status::OK();
+}
+
+REGISTER_GRAPH_TRANSFORM("fold_quantized_activations",
+                         FoldQuantizedActivations);
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
@@ -0,0 +1,240 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/nn_ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Declare here, so we don't need a public header.
+Status QuantizeNodes(const GraphDef& input_graph_def,
+                     const TransformFuncContext& context,
+                     GraphDef* output_graph_def);
+Status FoldQuantizedActivations(const GraphDef& input_graph_def,
+                                const TransformFuncContext& context,
+                                GraphDef* output_graph_def);
+void FindFloatIslands(const GraphDef& graph_def,
+                      std::vector<const NodeDef*>* island_nodes);
+
+class FoldQuantizedActivationsTest : public ::testing::Test {
+ protected:
+  // Builds input -> Conv2D -> BiasAdd -> activation -> MaxPool, where the
+  // activation is picked by 'activation_op'.
+  void BuildConvChain(const string& activation_op, bool extra_output,
+                      GraphDef* graph_def) {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor input_data(DT_FLOAT, TensorShape({1, 4, 4, 2}));
+    test::FillValues<float>(
+        &input_data, {1.0f,  -2.0f, 3.0f,  -4.0f, 5.0f,  -6.0f, 7.0f,  -8.0f,
+                      -1.0f, 2.0f,  -3.0f, 4.0f,  -5.0f, 6.0f,  -7.0f, 8.0f,
+                      2.0f,  -1.0f, 4.0f,  -3.0f, 6.0f,  -5.0f, 8.0f,  -7.0f,
+                      -2.0f, 1.0f,  -4.0f, 3.0f,  -6.0f, 5.0f,  -8.0f, 7.0f});
+    Output input_op =
+        Const(root.WithOpName("input_op"), Input::Initializer(input_data));
+
+    Tensor weights_data(DT_FLOAT, TensorShape({1, 2, 2, 2}));
+    test::FillValues<float>(&weights_data, {1.0f, -0.5f, 0.5f, 1.0f, -1.0f,
+                                            0.25f, 0.75f, -0.25f});
+    Output weights_op =
+        Const(root.WithOpName("weights_op"), Input::Initializer(weights_data));
+
+    Output conv_op = Conv2D(root.WithOpName("conv_op"), input_op, weights_op,
+                            {1, 1, 1, 1}, "VALID");
+
+    Tensor bias_data(DT_FLOAT, TensorShape({2}));
+    test::FillValues<float>(&bias_data, {0.5f, -1.0f});
+    Output bias_op =
+        Const(root.WithOpName("bias_op"), Input::Initializer(bias_data));
+
+    Output bias_add_op = BiasAdd(root.WithOpName("bias_add_op"), conv_op,
+                                 bias_op);
+
+    Output activation;
+    if (activation_op == "Relu6") {
+      activation = Relu6(root.WithOpName("activation_op"), bias_add_op);
+    } else {
+      activation = Relu(root.WithOpName("activation_op"), bias_add_op);
+    }
+
+    MaxPool(root.WithOpName("max_pool_op"), activation, {1, 2, 2, 1},
+            {1, 1, 1, 1}, "VALID");
+
+    if (extra_output) {
+      Tanh(root.WithOpName("tanh_op"), bias_add_op);
+    }
+
+    TF_ASSERT_OK(root.ToGraphDef(graph_def));
+  }
+
+  void RunGraph(const GraphDef& graph_def,
+                const std::vector<string>& output_names,
+                std::vector<Tensor>* outputs) {
+    std::unique_ptr<Session> session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session->Create(graph_def));
+    TF_ASSERT_OK(session->Run({}, output_names, {}, outputs));
+  }
+
+  void TestFoldActivation(const string& activation_op) {
+    GraphDef float_graph_def;
+    BuildConvChain(activation_op, false, &float_graph_def);
+    const std::vector<string> output_names = {"max_pool_op"};
+
+    TransformFuncContext context;
+    context.output_names = output_names;
+    context.params["fallback_min"] = {"-20"};
+    context.params["fallback_max"] = {"20"};
+    GraphDef quantized_graph_def;
+    TF_ASSERT_OK(QuantizeNodes(float_graph_def, context, &quantized_graph_def));
+
+    GraphDef folded_graph_def;
+    TF_ASSERT_OK(FoldQuantizedActivations(quantized_graph_def, context,
+                                          &folded_graph_def));
+
+    // The activation should now be a Requantize straight from the BiasAdd,
+    // with the range clamped to what the activation can produce.
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(folded_graph_def, &node_map);
+    ASSERT_EQ(1, node_map.count("activation_op/eightbit"));
+    const NodeDef& folded_node = *node_map["activation_op/eightbit"];
+    EXPECT_EQ("Requantize", folded_node.op());
+    EXPECT_EQ("bias_add_op/eightbit:0", folded_node.input(0));
+    ASSERT_EQ(1, node_map.count(NodeNameFromInput(folded_node.input(3))));
+    ASSERT_EQ(1, node_map.count(NodeNameFromInput(folded_node.input(4))));
+    const Tensor folded_min = GetNodeTensorAttr(
+        *node_map[NodeNameFromInput(folded_node.input(3))], "value");
+    const Tensor folded_max = GetNodeTensorAttr(
+        *node_map[NodeNameFromInput(folded_node.input(4))], "value");
+    EXPECT_EQ(0.0f, folded_min.flat<float>()(0));
+    EXPECT_EQ(activation_op == "Relu6" ? 6.0f : 20.0f,
+              folded_max.flat<float>()(0));
+
+    std::vector<Tensor> float_outputs;
+    RunGraph(float_graph_def, output_names, &float_outputs);
+    std::vector<Tensor> folded_outputs;
+    RunGraph(folded_graph_def, output_names, &folded_outputs);
+    test::ExpectTensorNear<float>(float_outputs[0], folded_outputs[0], 1.0);
+  }
+
+  void TestFoldRelu() { TestFoldActivation("Relu"); }
+
+  void TestFoldRelu6() { TestFoldActivation("Relu6"); }
+
+  void TestKeepSharedRequantize() {
+    GraphDef float_graph_def;
+    BuildConvChain("Relu", true, &float_graph_def);
+    const std::vector<string> output_names = {"max_pool_op", "tanh_op"};
+
+    TransformFuncContext context;
+    context.output_names = output_names;
+    context.params["fallback_min"] = {"-20"};
+    context.params["fallback_max"] = {"20"};
+    GraphDef quantized_graph_def;
+    TF_ASSERT_OK(QuantizeNodes(float_graph_def, context, &quantized_graph_def));
+
+    GraphDef folded_graph_def;
+    TF_ASSERT_OK(FoldQuantizedActivations(quantized_graph_def, context,
+                                          &folded_graph_def));
+
+    // The unclamped BiasAdd result is also used by the Tanh, so the Relu has
+    // to stay.
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(folded_graph_def, &node_map);
+    ASSERT_EQ(1, node_map.count("activation_op/eightbit"));
+    EXPECT_EQ("QuantizedRelu", node_map["activation_op/eightbit"]->op());
+  }
+
+  void TestKeepDynamicRange() {
+    GraphDef float_graph_def;
+    BuildConvChain("Relu", false, &float_graph_def);
+
+    TransformFuncContext context;
+    context.output_names = {"max_pool_op"};
+    GraphDef quantized_graph_def;
+    TF_ASSERT_OK(QuantizeNodes(float_graph_def, context, &quantized_graph_def));
+
+    GraphDef folded_graph_def;
+    TF_ASSERT_OK(FoldQuantizedActivations(quantized_graph_def, context,
+                                          &folded_graph_def));
+
+    // Without a constant range there's nothing to narrow.
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(folded_graph_def, &node_map);
+    ASSERT_EQ(1, node_map.count("activation_op/eightbit"));
+    EXPECT_EQ("QuantizedRelu", node_map["activation_op/eightbit"]->op());
+  }
+
+  void TestFindFloatIslands() {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor a_data(DT_FLOAT, TensorShape({2, 2}));
+    test::FillValues<float>(&a_data, {1.0f, -2.0f, 3.0f, -4.0f});
+    Output a_const = Const(root.WithOpName("a"), Input::Initializer(a_data));
+    Tensor b_data(DT_FLOAT, TensorShape({2, 2}));
+    test::FillValues<float>(&b_data, {0.5f, 1.0f, -1.0f, 2.0f});
+    Output b_const = Const(root.WithOpName("b"), Input::Initializer(b_data));
+
+    Output first_matmul =
+        MatMul(root.WithOpName("first_matmul"), a_const, b_const);
+    Output tanh_op = Tanh(root.WithOpName("tanh_op"), first_matmul);
+    Output second_matmul =
+        MatMul(root.WithOpName("second_matmul"), tanh_op, b_const);
+    Sigmoid(root.WithOpName("sigmoid_op"), second_matmul);
+
+    GraphDef float_graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&float_graph_def));
+
+    TransformFuncContext context;
+    context.output_names = {"sigmoid_op"};
+    GraphDef quantized_graph_def;
+    TF_ASSERT_OK(QuantizeNodes(float_graph_def, context, &quantized_graph_def));
+
+    // The Tanh is a round trip through float, but the final Sigmoid only
+    // leaves eight bit for good.
+    std::vector<const NodeDef*> island_nodes;
+    FindFloatIslands(quantized_graph_def, &island_nodes);
+    ASSERT_EQ(1, island_nodes.size());
+    EXPECT_EQ("tanh_op", island_nodes[0]->name());
+  }
+};
+
+TEST_F(FoldQuantizedActivationsTest, TestFoldRelu) { TestFoldRelu(); }
+
+TEST_F(FoldQuantizedActivationsTest, TestFoldRelu6) { TestFoldRelu6(); }
+
+TEST_F(FoldQuantizedActivationsTest, TestKeepSharedRequantize) {
+  TestKeepSharedRequantize();
+}
+
+TEST_F(FoldQuantizedActivationsTest, TestKeepDynamicRange) {
+  TestKeepDynamicRange();
+}
+
+TEST_F(FoldQuantizedActivationsTest, TestFindFloatIslands) {
+  TestFindFloatIslands();
+}
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
@@ -0,0 +1,79 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Flags the benchmarks that got significantly slower between two commits.
+
+Run a benchmark target (e.g. one of :kernel_benchmarks) a few times on each
+commit with --test_log_output_dir, then pass the results of each commit:
+
+  compare_benchmarks --baseline=before1.json,before2.json,before3.json \
+      --candidate=after1.json,after2.json,after3.json
+
+Exits with status 1 if any benchmark regressed.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import sys
+
+from tensorflow.python.platform import app
+from tensorflow.tools.test import compare_benchmarks_lib
+
+FLAGS = None
+
+
+def main(unused_args):
+  comparisons = compare_benchmarks_lib.compare(
+      compare_benchmarks_lib.load_results(FLAGS.baseline.split(",")),
+      compare_benchmarks_lib.load_results(FLAGS.candidate.split(",")),
+      threshold=FLAGS.threshold,
+      alpha=FLAGS.alpha)
+  print("%-60s %14s %14s %8s %8s" % ("Benchmark", "Baseline (ns)",
+                                     "Candidate (ns)", "Change", "p"))
+  for c in comparisons:
+    print("%-60s %14.0f %14.0f %+7.1f%% %8s%s" %
+          (c.name, c.baseline_mean * 1e9, c.candidate_mean * 1e9,
+           c.change * 100, "-" if c.p_value is None else "%.4f" % c.p_value,
+           "  REGRESSED" if c.regressed else ""))
+  if any(c.regressed for c in comparisons):
+    sys.exit(1)
+
+
+if __name__ == "__main__":
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      "--baseline",
+      type=str,
+      default="",
+      help="Comma-separated result files of the baseline runs.")
+  parser.add_argument(
+      "--candidate",
+      type=str,
+      default="",
+      help="Comma-separated result files of the runs to check.")
+  parser.add_argument(
+      "--threshold",
+      type=float,
+      default=0.05,
+      help="Relative slowdown below which changes are ignored.")
+  parser.add_argument(
+      "--alpha",
+      type=float,
+      default=0.01,
+      help="Significance level of the test for a change in the mean.")
+  FLAGS, unparsed = parser.parse_known_args()
+  app.run(main=main, argv=[sys.argv[0]] + unparsed)
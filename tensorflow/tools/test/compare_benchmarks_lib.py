@@ -0,0 +1,153 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Library for comparing benchmark results across runs."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import collections
+import math
+
+from google.protobuf import json_format
+from google.protobuf import text_format
+
+from tensorflow.core.util import test_log_pb2
+from tensorflow.python.platform import gfile
+
+Comparison = collections.namedtuple(
+    "Comparison", ["name", "baseline_mean", "candidate_mean", "change",
+                   "p_value", "regressed"])
+
+
+def load_results(paths):
+  """Reads the per-iteration wall times of the benchmarks in some results.
+
+  Args:
+    paths: Paths of TestResults written by run_and_gather_logs, either as JSON
+      or as a text proto. Typically several runs of the same targets.
+
+  Returns:
+    A dict from benchmark name to the list of its wall times per iteration, in
+    seconds, one per run that has it.
+  """
+  times = collections.defaultdict(list)
+  for path in paths:
+    content = gfile.GFile(path, "r").read()
+    results = test_log_pb2.TestResults()
+    if content.lstrip().startswith("{"):
+      json_format.Parse(content, results)
+    else:
+      text_format.Merge(content, results)
+    for entry in results.entries.entry:
+      iters = max(entry.iters, 1)
+      times[entry.name].append(entry.wall_time / iters)
+  return dict(times)
+
+
+def _mean_and_variance(values):
+  mean = sum(values) / len(values)
+  variance = sum((v - mean)**2 for v in values) / (len(values) - 1)
+  return mean, variance
+
+
+def _incomplete_beta_fraction(a, b, x):
+  """Continued fraction for the regularized incomplete beta function."""
+  tiny = 1e-30
+  c = 1.0
+  d = 1.0 - (a + b) * x / (a + 1.0)
+  d = 1.0 / (d if abs(d) > tiny else tiny)
+  fraction = d
+  for m in range(1, 200):
+    for numerator in (m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m)),
+                      -(a + m) * (a + b + m) * x / ((a + 2 * m) *
+                                                    (a + 2 * m + 1))):
+      d = 1.0 + numerator * d
+      d = 1.0 / (d if abs(d) > tiny else tiny)
+      c = 1.0 + numerator / c
+      c = c if abs(c) > tiny else tiny
+      fraction *= c * d
+    if abs(c * d - 1.0) < 1e-12:
+      break
+  return fraction
+
+
+def _regularized_incomplete_beta(a, b, x):
+  if x <= 0.0:
+    return 0.0
+  if x >= 1.0:
+    return 1.0
+  front = math.exp(
+      math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) +
+      b * math.log(1.0 - x))
+  # The continued fraction converges quickly only on this side of the mean.
+  if x < (a + 1.0) / (a + b + 2.0):
+    return front * _incomplete_beta_fraction(a, b, x) / a
+  return 1.0 - front * _incomplete_beta_fraction(b, a, 1.0 - x) / b
+
+
+def welch_t_test(a, b):
+  """Returns the two-sided p-value of Welch's t-test on two samples.
+
+  Args:
+    a: A list of at least two values.
+    b: A list of at least two values.
+
+  Returns:
+    The probability of a difference of means at least as large as the one
+    observed, if both samples came from distributions with the same mean.
+  """
+  mean_a, var_a = _mean_and_variance(a)
+  mean_b, var_b = _mean_and_variance(b)
+  se_a = var_a / len(a)
+  se_b = var_b / len(b)
+  if se_a + se_b == 0:
+    return 1.0 if mean_a == mean_b else 0.0
+  t = (mean_a - mean_b) / math.sqrt(se_a + se_b)
+  dof = (se_a + se_b)**2 / (se_a**2 / (len(a) - 1) + se_b**2 / (len(b) - 1))
+  return _regularized_incomplete_beta(dof / 2.0, 0.5, dof / (dof + t * t))
+
+
+def compare(baseline, candidate, threshold=0.05, alpha=0.01):
+  """Compares the benchmarks that ran in both a baseline and a candidate.
+
+  A benchmark regressed if its mean time per iteration grew by more than
+  'threshold', and, when both sides have at least two runs of it, Welch's
+  t-test rejects equal means at level 'alpha'. With a single run on either
+  side the change can't be tested, and its p-value is None.
+
+  Args:
+    baseline: A dict from benchmark name to times, as from load_results.
+    candidate: Same as baseline, for the runs to check.
+    threshold: The relative slowdown below which changes are ignored.
+    alpha: The significance level of the t-test.
+
+  Returns:
+    A list of Comparisons, sorted by benchmark name.
+  """
+  comparisons = []
+  for name in sorted(set(baseline) & set(candidate)):
+    base = baseline[name]
+    cand = candidate[name]
+    base_mean = sum(base) / len(base)
+    cand_mean = sum(cand) / len(cand)
+    change = (cand_mean - base_mean) / base_mean if base_mean > 0 else 0.0
+    p_value = None
+    if len(base) > 1 and len(cand) > 1:
+      p_value = welch_t_test(base, cand)
+    regressed = change > threshold and (p_value is None or p_value < alpha)
+    comparisons.append(
+        Comparison(name, base_mean, cand_mean, change, p_value, regressed))
+  return comparisons
@@ -0,0 +1,92 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for compare_benchmarks_lib."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from google.protobuf import json_format
+
+from tensorflow.core.util import test_log_pb2
+from tensorflow.python.platform import gfile
+from tensorflow.python.platform import test
+from tensorflow.tools.test import compare_benchmarks_lib
+
+
+class CompareBenchmarksTest(test.TestCase):
+
+  def _write_results(self, name, wall_times):
+    results = test_log_pb2.TestResults()
+    for benchmark, wall_time in wall_times.items():
+      entry = results.entries.entry.add()
+      entry.name = benchmark
+      entry.iters = 10
+      entry.wall_time = wall_time
+    path = os.path.join(self.get_temp_dir(), name)
+    gfile.GFile(path, "w").write(json_format.MessageToJson(results))
+    return path
+
+  def testLoadResults(self):
+    paths = [
+        self._write_results("run1.json", {"BM_a": 1.0, "BM_b": 2.0}),
+        self._write_results("run2.json", {"BM_a": 3.0}),
+    ]
+    times = compare_benchmarks_lib.load_results(paths)
+    self.assertAllClose([0.1, 0.3], times["BM_a"])
+    self.assertAllClose([0.2], times["BM_b"])
+
+  def testWelchTTest(self):
+    self.assertGreater(
+        compare_benchmarks_lib.welch_t_test([1.0, 1.1, 0.9], [1.0, 1.1, 0.9]),
+        0.99)
+    # The means differ by about as much as the samples spread: p = 0.071.
+    p = compare_benchmarks_lib.welch_t_test([0.0, 1.0, 2.0, 3.0],
+                                            [2.0 + x for x in [0, 1, 2, 3]])
+    self.assertNear(0.071, p, 0.001)
+    self.assertLess(
+        compare_benchmarks_lib.welch_t_test([1.0, 1.1, 0.9, 1.05],
+                                            [1.3, 1.25, 1.4, 1.35]), 0.01)
+
+  def testCompare(self):
+    baseline = {
+        "BM_noisy": [1.0, 2.0, 1.5],
+        "BM_same": [1.0, 1.01, 0.99],
+        "BM_slower": [1.0, 1.01, 0.99],
+        "BM_single": [1.0],
+        "BM_only_baseline": [1.0],
+    }
+    candidate = {
+        "BM_noisy": [1.3, 2.4, 1.8],
+        "BM_same": [1.0, 1.01, 0.99],
+        "BM_slower": [1.2, 1.21, 1.19],
+        "BM_single": [1.5],
+    }
+    comparisons = compare_benchmarks_lib.compare(baseline, candidate)
+    self.assertEqual(["BM_noisy", "BM_same", "BM_single", "BM_slower"],
+                     [c.name for c in comparisons])
+    regressed = {c.name: c.regressed for c in comparisons}
+    self.assertFalse(regressed["BM_noisy"])
+    self.assertFalse(regressed["BM_same"])
+    self.assertTrue(regressed["BM_single"])
+    self.assertTrue(regressed["BM_slower"])
+    self.assertIsNone(comparisons[2].p_value)
+    self.assertAllClose(0.2, comparisons[3].change)
+
+
+if __name__ == "__main__":
+  test.main()